@@ -0,0 +1,88 @@
+/**
+ * @file ann_benchmark.cpp
+ *
+ * Benchmarks of the forward and backward passes of a feedforward network, for
+ * each kind of hidden activation layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/methods/ann/layer/layer.hpp>
+#include <mlpack/methods/ann/ffn.hpp>
+
+#include "benchmark_utility.hpp"
+
+using namespace mlpack;
+using namespace mlpack::ann;
+using namespace mlpack::benchmarks;
+
+//! The number of classes of the networks.
+static const size_t numClasses = 10;
+
+/**
+ * Build a network with range(1) inputs, a hidden layer of range(2) units with
+ * the given activation, and a log-softmax output, and a batch of range(0)
+ * random points and labels for it.
+ */
+template<typename LayerType>
+static void BuildNetwork(benchmark::State& state,
+                         FFN<NegativeLogLikelihood<>>& model,
+                         arma::mat& inputs,
+                         arma::mat& targets)
+{
+  model.Add<Linear<>>(state.range(1), state.range(2));
+  model.Add<LayerType>();
+  model.Add<Linear<>>(state.range(2), numClasses);
+  model.Add<LogSoftMax<>>();
+
+  inputs = RandomDataset(state.range(0), state.range(1));
+  targets = arma::floor(arma::randu<arma::mat>(1, state.range(0)) *
+      numClasses) + 1;
+}
+
+/**
+ * Pass a batch through the network.
+ */
+template<typename LayerType>
+static void FFNForward(benchmark::State& state)
+{
+  FFN<NegativeLogLikelihood<>> model;
+  arma::mat inputs, targets, results;
+  BuildNetwork<LayerType>(state, model, inputs, targets);
+
+  while (state.KeepRunning())
+    model.Forward(inputs, results);
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Pass a batch through the network, and compute the gradient of the loss.
+ */
+template<typename LayerType>
+static void FFNForwardBackward(benchmark::State& state)
+{
+  FFN<NegativeLogLikelihood<>> model;
+  arma::mat inputs, targets, results, gradients;
+  BuildNetwork<LayerType>(state, model, inputs, targets);
+
+  while (state.KeepRunning())
+  {
+    model.Forward(inputs, results);
+    benchmark::DoNotOptimize(model.Backward(targets, gradients));
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define MLPACK_LAYER_BENCHMARK(LAYER) \
+    BENCHMARK_TEMPLATE(FFNForward, LAYER)->Args({ 1, 100, 100 })-> \
+        Args({ 64, 100, 100 })->Args({ 64, 784, 500 }); \
+    BENCHMARK_TEMPLATE(FFNForwardBackward, LAYER)->Args({ 1, 100, 100 })-> \
+        Args({ 64, 100, 100 })->Args({ 64, 784, 500 })
+
+MLPACK_LAYER_BENCHMARK(SigmoidLayer<>);
+MLPACK_LAYER_BENCHMARK(TanHLayer<>);
+MLPACK_LAYER_BENCHMARK(ReLULayer<>);
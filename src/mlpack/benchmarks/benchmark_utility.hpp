@@ -0,0 +1,37 @@
+/**
+ * @file benchmark_utility.hpp
+ *
+ * Helpers shared by the mlpack microbenchmarks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BENCHMARKS_BENCHMARK_UTILITY_HPP
+#define MLPACK_BENCHMARKS_BENCHMARK_UTILITY_HPP
+
+#include <mlpack/core.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace mlpack {
+namespace benchmarks {
+
+/**
+ * Generate a uniform random dataset.  The seed is fixed, so that every run of a
+ * benchmark uses the same data.
+ *
+ * @param points Number of points.
+ * @param dimensionality Dimensionality of the points.
+ */
+inline arma::mat RandomDataset(const size_t points, const size_t dimensionality)
+{
+  math::RandomSeed(42);
+  return arma::randu<arma::mat>(dimensionality, points);
+}
+
+} // namespace benchmarks
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file data_benchmark.cpp
+ *
+ * Benchmarks of CSV parsing with data::Load() and of model serialization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/xml_oarchive.hpp>
+
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+#include "benchmark_utility.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmarks;
+using namespace mlpack::neighbor;
+
+/**
+ * Load a CSV file of range(0) points of range(1) dimensions.  The file is
+ * written to the working directory first.
+ */
+static void LoadCSV(benchmark::State& state)
+{
+  const std::string filename = "mlpack_benchmark_dataset.csv";
+  data::Save(filename, RandomDataset(state.range(0), state.range(1)), true);
+
+  arma::mat dataset;
+  while (state.KeepRunning())
+    data::Load(filename, dataset, true);
+
+  std::remove(filename.c_str());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Serialize a kd-tree kNN model on range(0) points of range(1) dimensions to
+ * memory, with the given archive type.
+ */
+template<typename ArchiveType>
+static void SerializeKNN(benchmark::State& state)
+{
+  KNN knn(RandomDataset(state.range(0), state.range(1)));
+  size_t bytes = 0;
+
+  while (state.KeepRunning())
+  {
+    std::ostringstream stream;
+    {
+      ArchiveType ar(stream);
+      ar << data::CreateNVP(knn, "knn");
+    }
+    bytes = stream.tellp();
+  }
+
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+/**
+ * Deserialize a kd-tree kNN model on range(0) points of range(1) dimensions
+ * from memory, with the given archive types.
+ */
+template<typename OutputArchiveType, typename InputArchiveType>
+static void DeserializeKNN(benchmark::State& state)
+{
+  std::ostringstream stream;
+  {
+    KNN knn(RandomDataset(state.range(0), state.range(1)));
+    OutputArchiveType ar(stream);
+    ar << data::CreateNVP(knn, "knn");
+  }
+  const std::string serialized = stream.str();
+
+  while (state.KeepRunning())
+  {
+    std::istringstream input(serialized);
+    InputArchiveType ar(input);
+    KNN knn;
+    ar >> data::CreateNVP(knn, "knn");
+  }
+
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+BENCHMARK(LoadCSV)->Args({ 10000, 10 })->Args({ 100000, 10 })->
+    Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(SerializeKNN, boost::archive::binary_oarchive)->
+    Args({ 100000, 10 })->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(SerializeKNN, boost::archive::xml_oarchive)->
+    Args({ 100000, 10 })->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(DeserializeKNN, boost::archive::binary_oarchive,
+    boost::archive::binary_iarchive)->Args({ 100000, 10 })->
+    Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(DeserializeKNN, boost::archive::xml_oarchive,
+    boost::archive::xml_iarchive)->Args({ 100000, 10 })->
+    Unit(benchmark::kMillisecond);
@@ -0,0 +1,60 @@
+/**
+ * @file kmeans_benchmark.cpp
+ *
+ * Benchmarks of each Lloyd iteration step type of KMeans.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/methods/kmeans/kmeans.hpp>
+#include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
+#include <mlpack/methods/kmeans/elkan_kmeans.hpp>
+#include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/yinyang_kmeans.hpp>
+#include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
+#include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
+
+#include "benchmark_utility.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmarks;
+using namespace mlpack::kmeans;
+
+/**
+ * Run 10 iterations of k-means on a dataset with range(0) points of range(1)
+ * dimensions, with range(2) clusters.  Every run starts from the same
+ * centroids.
+ */
+template<template<typename, typename> class LloydStepType>
+static void KMeansIterations(benchmark::State& state)
+{
+  const arma::mat dataset = RandomDataset(state.range(0), state.range(1));
+  const arma::mat initialCentroids = dataset.cols(0, state.range(2) - 1);
+
+  KMeans<metric::EuclideanDistance, SampleInitialization, AllowEmptyClusters,
+      LloydStepType> kmeans(10);
+  arma::mat centroids;
+
+  while (state.KeepRunning())
+  {
+    centroids = initialCentroids;
+    kmeans.Cluster(dataset, state.range(2), centroids, true);
+  }
+
+  state.SetItemsProcessed(state.iterations() * 10 * dataset.n_cols);
+}
+
+#define MLPACK_KMEANS_BENCHMARK(STEP) \
+    BENCHMARK_TEMPLATE(KMeansIterations, STEP)->Args({ 10000, 5, 10 })-> \
+        Args({ 10000, 50, 100 })->Unit(benchmark::kMillisecond)
+
+MLPACK_KMEANS_BENCHMARK(NaiveKMeans);
+MLPACK_KMEANS_BENCHMARK(ElkanKMeans);
+MLPACK_KMEANS_BENCHMARK(HamerlyKMeans);
+MLPACK_KMEANS_BENCHMARK(YinyangKMeans);
+MLPACK_KMEANS_BENCHMARK(PellegMooreKMeans);
+MLPACK_KMEANS_BENCHMARK(DefaultDualTreeKMeans);
+MLPACK_KMEANS_BENCHMARK(MiniBatchKMeans);
@@ -0,0 +1,60 @@
+/**
+ * @file lsh_benchmark.cpp
+ *
+ * Benchmarks of the training and the search of LSHSearch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/methods/lsh/lsh_search.hpp>
+
+#include "benchmark_utility.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmarks;
+using namespace mlpack::neighbor;
+
+/**
+ * Hash a dataset with range(0) points of range(1) dimensions into range(2)
+ * tables of 10 projections.
+ */
+static void LSHTraining(benchmark::State& state)
+{
+  const arma::mat dataset = RandomDataset(state.range(0), state.range(1));
+  LSHSearch<> lsh;
+
+  while (state.KeepRunning())
+    lsh.Train(dataset, 10, state.range(2));
+
+  state.SetItemsProcessed(state.iterations() * dataset.n_cols);
+}
+
+/**
+ * Search the 5 approximate nearest neighbors of every point of a dataset with
+ * range(0) points of range(1) dimensions, in range(2) tables of 10
+ * projections.
+ */
+static void LSHSearchAll(benchmark::State& state)
+{
+  // The reference set is not copied, so it has to outlive the model.
+  const arma::mat dataset = RandomDataset(state.range(0), state.range(1));
+  LSHSearch<> lsh(dataset, 10, state.range(2));
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  while (state.KeepRunning())
+  {
+    lsh.DistanceEvaluations() = 0;
+    lsh.Search(5, neighbors, distances);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["distance_evaluations"] = lsh.DistanceEvaluations();
+}
+
+BENCHMARK(LSHTraining)->Args({ 10000, 10, 10 })->Args({ 10000, 10, 30 })->
+    Unit(benchmark::kMillisecond);
+BENCHMARK(LSHSearchAll)->Args({ 10000, 10, 10 })->Args({ 10000, 10, 30 })->
+    Unit(benchmark::kMillisecond);
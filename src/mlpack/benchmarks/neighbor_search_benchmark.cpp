@@ -0,0 +1,84 @@
+/**
+ * @file neighbor_search_benchmark.cpp
+ *
+ * Benchmarks of tree construction and dual-tree k-nearest-neighbor search, for
+ * each kind of tree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+#include "benchmark_utility.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmarks;
+using namespace mlpack::neighbor;
+using namespace mlpack::tree;
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+using KNNType = NeighborSearch<NearestNeighborSort, metric::EuclideanDistance,
+    arma::mat, TreeType>;
+
+/**
+ * Build the tree on a dataset with range(0) points of range(1) dimensions.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+static void TreeConstruction(benchmark::State& state)
+{
+  typedef typename KNNType<TreeType>::Tree Tree;
+  const arma::mat dataset = RandomDataset(state.range(0), state.range(1));
+
+  while (state.KeepRunning())
+  {
+    std::vector<size_t> oldFromNew;
+    Tree* tree = BuildTree<Tree>(dataset, oldFromNew);
+    benchmark::DoNotOptimize(tree);
+    delete tree;
+  }
+
+  state.SetItemsProcessed(state.iterations() * dataset.n_cols);
+}
+
+/**
+ * Search the 5 nearest neighbors of every point of a dataset with range(0)
+ * points of range(1) dimensions, with the dual-tree algorithm.  The tree is
+ * built beforehand.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+static void DualTreeKNN(benchmark::State& state)
+{
+  KNNType<TreeType> knn(RandomDataset(state.range(0), state.range(1)));
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  while (state.KeepRunning())
+    knn.Search(5, neighbors, distances);
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["base_cases"] = knn.BaseCases();
+  state.counters["scores"] = knn.Scores();
+}
+
+#define MLPACK_TREE_BENCHMARK(TREE) \
+    BENCHMARK_TEMPLATE(TreeConstruction, TREE)->Args({ 10000, 3 })-> \
+        Args({ 10000, 10 })->Args({ 100000, 3 })-> \
+        Unit(benchmark::kMillisecond); \
+    BENCHMARK_TEMPLATE(DualTreeKNN, TREE)->Args({ 10000, 3 })-> \
+        Args({ 10000, 10 })->Unit(benchmark::kMillisecond)
+
+MLPACK_TREE_BENCHMARK(KDTree);
+MLPACK_TREE_BENCHMARK(BallTree);
+MLPACK_TREE_BENCHMARK(StandardCoverTree);
+MLPACK_TREE_BENCHMARK(RTree);
+MLPACK_TREE_BENCHMARK(RStarTree);
+MLPACK_TREE_BENCHMARK(UBTree);
+MLPACK_TREE_BENCHMARK(Octree);
@@ -0,0 +1,121 @@
+/**
+ * @file optimizer_benchmark.cpp
+ *
+ * Benchmarks of the optimizers on the test functions of the gradient descent,
+ * L-BFGS and SGD optimizers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core/optimizers/adam/adam.hpp>
+#include <mlpack/core/optimizers/gradient_descent/gradient_descent.hpp>
+#include <mlpack/core/optimizers/gradient_descent/test_function.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+
+#include "benchmark_utility.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmarks;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+
+/**
+ * Optimize the given function from its initial point with the given optimizer,
+ * recording the final objective.
+ */
+template<typename OptimizerType, typename FunctionType>
+static void Optimize(benchmark::State& state,
+                     OptimizerType& optimizer,
+                     FunctionType& function)
+{
+  double objective = 0.0;
+  while (state.KeepRunning())
+  {
+    arma::mat coordinates = function.GetInitialPoint();
+    objective = optimizer.Optimize(function, coordinates);
+  }
+
+  state.counters["objective"] = objective;
+}
+
+static void GradientDescentGDTestFunction(benchmark::State& state)
+{
+  GDTestFunction f;
+  GradientDescent optimizer(0.01, 5000000, 1e-9);
+  Optimize(state, optimizer, f);
+}
+
+static void GradientDescentRosenbrock(benchmark::State& state)
+{
+  RosenbrockFunction f;
+  GradientDescent optimizer(0.001, 10000, 1e-15);
+  Optimize(state, optimizer, f);
+}
+
+static void LBFGSRosenbrock(benchmark::State& state)
+{
+  RosenbrockFunction f;
+  L_BFGS optimizer;
+  optimizer.MaxIterations() = 10000;
+  Optimize(state, optimizer, f);
+}
+
+static void LBFGSWood(benchmark::State& state)
+{
+  WoodFunction f;
+  L_BFGS optimizer;
+  optimizer.MaxIterations() = 10000;
+  Optimize(state, optimizer, f);
+}
+
+/**
+ * Optimize a generalized Rosenbrock function of range(0) dimensions.
+ */
+static void LBFGSGeneralizedRosenbrock(benchmark::State& state)
+{
+  GeneralizedRosenbrockFunction f(state.range(0));
+  L_BFGS optimizer;
+  optimizer.MaxIterations() = 10000;
+  Optimize(state, optimizer, f);
+}
+
+static void SGDTestFunctionSGD(benchmark::State& state)
+{
+  SGDTestFunction f;
+  StandardSGD optimizer(0.0003, 5000000, 1e-9, true);
+  Optimize(state, optimizer, f);
+}
+
+/**
+ * Run 100000 iterations of SGD on a generalized Rosenbrock function of range(0)
+ * dimensions.
+ */
+static void SGDGeneralizedRosenbrock(benchmark::State& state)
+{
+  GeneralizedRosenbrockFunction f(state.range(0));
+  StandardSGD optimizer(0.001, 100000, 1e-15, true);
+  Optimize(state, optimizer, f);
+}
+
+static void AdamSGDTestFunction(benchmark::State& state)
+{
+  SGDTestFunction f;
+  Adam optimizer(1e-3, 0.9, 0.999, 1e-8, 5000000, 1e-9, true);
+  Optimize(state, optimizer, f);
+}
+
+BENCHMARK(GradientDescentGDTestFunction)->Unit(benchmark::kMillisecond);
+BENCHMARK(GradientDescentRosenbrock)->Unit(benchmark::kMillisecond);
+BENCHMARK(LBFGSRosenbrock)->Unit(benchmark::kMillisecond);
+BENCHMARK(LBFGSWood)->Unit(benchmark::kMillisecond);
+BENCHMARK(LBFGSGeneralizedRosenbrock)->Arg(10)->Arg(100)->
+    Unit(benchmark::kMillisecond);
+BENCHMARK(SGDTestFunctionSGD)->Unit(benchmark::kMillisecond);
+BENCHMARK(SGDGeneralizedRosenbrock)->Arg(10)->Arg(100)->
+    Unit(benchmark::kMillisecond);
+BENCHMARK(AdamSGDTestFunction)->Unit(benchmark::kMillisecond);
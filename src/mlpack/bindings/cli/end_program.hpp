@@ -3,7 +3,8 @@
  * @author Ryan Curtin
  * @author Matthew Amidon
  *
- * Terminate the program; handle --verbose option; print output parameters.
+ * Terminate the program; handle --verbose and --profile_file options; print
+ * output parameters.
  */
 #ifndef MLPACK_BINDINGS_CLI_END_PROGRAM_HPP
 #define MLPACK_BINDINGS_CLI_END_PROGRAM_HPP
@@ -23,6 +24,20 @@ inline void EndProgram()
   // Stop the CLI timers.
   CLI::GetSingleton().timer.StopAllTimers();
 
+  // Write the profile, if requested.
+  if (CLI::HasParam("profile_file"))
+  {
+    const std::string& profileFile = CLI::GetParam<std::string>("profile_file");
+    try
+    {
+      CLI::GetSingleton().timer.WriteProfile(profileFile);
+    }
+    catch (std::runtime_error& e)
+    {
+      Log::Fatal << e.what() << std::endl;
+    }
+  }
+
   // Print any output.
   const std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
   std::map<std::string, util::ParamData>::const_iterator it =
@@ -66,6 +81,19 @@ inline void EndProgram()
       Log::Info << "  " << it2.first << ": ";
       CLI::GetSingleton().timer.PrintTimer(it2.first);
     }
+
+    if (MemoryTracker::Enabled())
+    {
+      Log::Info << "Program memory:" << std::endl;
+      Log::Info << "  peak: " << MemoryTracker::PeakBytes() << " bytes"
+          << std::endl;
+      for (auto it2 : CLI::GetSingleton().timer.GetAllMemory())
+      {
+        Log::Info << "  " << it2.first << ": peak " << it2.second.peakBytes
+            << " bytes, allocated " << it2.second.allocatedBytes << " bytes in "
+            << it2.second.allocations << " allocations" << std::endl;
+      }
+    }
   }
 }
 
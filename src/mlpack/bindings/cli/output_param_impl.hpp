@@ -9,6 +9,7 @@
 
 #include "output_param.hpp"
 #include <mlpack/core/data/save.hpp>
+#include <mlpack/core/data/batch_writer.hpp>
 #include <iostream>
 
 namespace mlpack {
@@ -55,10 +56,36 @@ void OutputParamImpl(
 
   if (output.n_elem > 0 && filename != "")
   {
-      if (arma::is_Row<T>::value || arma::is_Col<T>::value)
-        data::Save(filename, output, false);
-      else
-        data::Save(filename, output, false, !data.noTranspose);
+    // Formatting large matrices as text takes long, so the points of CSV and
+    // raw ASCII files (each line is a column of the matrix) are formatted in
+    // parallel by a BatchWriter.
+    const std::string extension = data::Extension(filename);
+    if ((extension == "csv" || extension == "txt") &&
+        !arma::is_Col<T>::value && !data.noTranspose)
+    {
+      Timer::Start("saving_data");
+      try
+      {
+        data::BatchWriter<typename T::elem_type> writer(filename,
+            output.n_rows);
+        writer.WriteBatch(output);
+        writer.Close();
+      }
+      catch (std::exception& e)
+      {
+        Log::Warn << "Cannot save to '" << filename << "': " << e.what()
+            << std::endl;
+      }
+      Timer::Stop("saving_data");
+    }
+    else if (arma::is_Row<T>::value || arma::is_Col<T>::value)
+    {
+      data::Save(filename, output, false);
+    }
+    else
+    {
+      data::Save(filename, output, false, !data.noTranspose);
+    }
   }
 }
 
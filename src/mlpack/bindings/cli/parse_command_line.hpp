@@ -22,22 +22,33 @@ PARAM_STRING_IN("info", "Get help on a specific module or option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_STRING_IN("profile_file", "If specified, a profile of the timers and "
+    "method counters is written to this file at the end of execution, in "
+    "Chrome Trace Event JSON format.", "", "");
+PARAM_INT_IN("threads", "Maximum number of threads to use (0 uses all "
+    "available threads).  Only has an effect if mlpack was compiled with "
+    "OpenMP.", "", 0);
+PARAM_FLAG("deterministic", "If set, parallel sums are computed in a fixed "
+    "order, so that the results do not depend on the number of threads or on "
+    "their scheduling (this may be slower).", "");
+PARAM_STRING_IN("batch_file", "If specified, the program is run once for each "
+    "line of this file, with the options on that line (given as on the command "
+    "line) and the other options given on the command line.", "", "");
 
 /**
- * Parse the command line, setting all of the options inside of the CLI object
- * to their appropriate given values.
+ * Build the boost::program_options description of all of the parameters inside
+ * of the CLI object, and the map from the names the user passes on the command
+ * line to the names of the parameters.
+ *
+ * @param desc Description to add the parameters to.
+ * @param boostNameMap Map to add the names of the parameters to.
  */
-void ParseCommandLine(int argc, char** argv)
+void BuildOptions(boost::program_options::options_description& desc,
+                  std::map<std::string, std::string>& boostNameMap)
 {
-  // First, we need to build the boost::program_options variables for parsing.
-  using namespace boost::program_options;
-  options_description desc;
-  variables_map vmap;
-
   // Go through list of options in order to add them.
   std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
   typedef std::map<std::string, util::ParamData>::const_iterator IteratorType;
-  std::map<std::string, std::string> boostNameMap;
   for (IteratorType it = parameters.begin(); it != parameters.end(); ++it)
   {
     // Add the parameter to desc.
@@ -51,6 +62,26 @@ void ParseCommandLine(int argc, char** argv)
         (void*) &boostName);
     boostNameMap[boostName] = d.name;
   }
+}
+
+/**
+ * Parse the given options (as they would be given on the command line, without
+ * the program name), setting all of the options inside of the CLI object to
+ * their appropriate given values.  The description only has to be built once
+ * (with BuildOptions()) for any number of sets of options.
+ *
+ * @param desc Description of all of the parameters.
+ * @param boostNameMap Map from the names on the command line to the names of
+ *     the parameters.
+ * @param args Options to parse.
+ */
+void ParseOptions(const boost::program_options::options_description& desc,
+                  const std::map<std::string, std::string>& boostNameMap,
+                  const std::vector<std::string>& args)
+{
+  using namespace boost::program_options;
+  variables_map vmap;
+  std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
 
   // TODO: we have to mark somehow that we parsed.
   CLI::GetSingleton().didParse = true;
@@ -58,7 +89,8 @@ void ParseCommandLine(int argc, char** argv)
   // Parse the command line, then place the values in the right place.
   try
   {
-    basic_parsed_options<char> bpo(parse_command_line(argc, argv, desc));
+    basic_parsed_options<char> bpo(
+        command_line_parser(args).options(desc).run());
 
     // Iterate over all the options, looking for duplicate parameters.  If we
     // find any, remove the duplicates.  Note that vector options can have
@@ -111,7 +143,7 @@ void ParseCommandLine(int argc, char** argv)
     // boost::program_options would have already thrown an exception.  Because
     // some names may be mapped, we have to look through each ParamData object
     // and get its boost name.
-    const std::string identifier = boostNameMap[i->first];
+    const std::string& identifier = boostNameMap.at(i->first);
     util::ParamData& param = parameters[identifier];
     param.wasPassed = true;
     CLI::GetSingleton().functionMap[param.tname]["SetParam"](param,
@@ -169,7 +201,32 @@ void ParseCommandLine(int argc, char** argv)
     Log::Info.ignoreInput = false;
   }
 
-  // Now, issue an error if we forgot any required options.
+  // Limit the number of threads of all parallel regions.
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be "
+        << "non-negative." << std::endl;
+  }
+  #ifndef HAS_OPENMP
+    if (threads > 1)
+    {
+      Log::Warn << "--threads ignored because mlpack was compiled without "
+          << "OpenMP support." << std::endl;
+    }
+  #endif
+  SetThreadLimit((size_t) threads);
+  SetDeterministicReductions(CLI::HasParam("deterministic"));
+
+  // Record the timeline of the timers for the profile.
+  if (CLI::HasParam("profile_file"))
+    Timer::EnableTracing();
+
+  // Now, issue an error if we forgot any required options.  With a batch file,
+  // they can be given on each of its lines instead.
+  if (CLI::HasParam("batch_file"))
+    return;
+
   for (std::map<std::string, util::ParamData>::const_iterator iter =
        parameters.begin(); iter != parameters.end(); ++iter)
   {
@@ -189,6 +246,25 @@ void ParseCommandLine(int argc, char** argv)
   }
 }
 
+/**
+ * Parse the command line, setting all of the options inside of the CLI object
+ * to their appropriate given values.
+ */
+void ParseCommandLine(int argc, char** argv)
+{
+  // First, we need to build the boost::program_options variables for parsing.
+  boost::program_options::options_description desc;
+  std::map<std::string, std::string> boostNameMap;
+  BuildOptions(desc, boostNameMap);
+
+  // The program name is not an option.
+  std::vector<std::string> args;
+  if (argc > 1)
+    args.assign(argv + 1, argv + argc);
+
+  ParseOptions(desc, boostNameMap, args);
+}
+
 } // namespace cli
 } // namespace bindings
 } // namespace mlpack
@@ -0,0 +1,127 @@
+/**
+ * @file run_batch.hpp
+ *
+ * Run a command-line program once for each line of the file given with
+ * --batch_file, in the same process.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_CLI_RUN_BATCH_HPP
+#define MLPACK_BINDINGS_CLI_RUN_BATCH_HPP
+
+#include <mlpack/core.hpp>
+#include <boost/program_options.hpp>
+#include "parse_command_line.hpp"
+#include "end_program.hpp"
+
+namespace mlpack {
+namespace bindings {
+namespace cli {
+
+/**
+ * Run the program once for each line of the file given with --batch_file.
+ * Each line holds the options of one run, as they would be given on the
+ * command line; empty lines and lines starting with '#' are skipped.  The
+ * options given on the command line itself (other than --batch_file) are used
+ * for every run.  Before each run, all of the parameters are reset to their
+ * default values and the timers are restarted, so that no run sees the options
+ * or the results of the previous one.  The description of the parameters is
+ * only built once for all of the runs, and anything the program keeps between
+ * calls (like the loaded shared libraries) is only set up once, which makes
+ * many short runs much cheaper than one process for each of them.
+ *
+ * @param argc Number of command-line arguments (as given to main()).
+ * @param argv Command-line arguments (as given to main()).
+ * @param defaults The parameters, before the command line was parsed.
+ * @param programMain Function that runs the program (usually mlpackMain()).
+ */
+void RunBatch(int argc,
+              char** argv,
+              const std::map<std::string, util::ParamData>& defaults,
+              void (*programMain)())
+{
+  using namespace boost::program_options;
+
+  const std::string batchFile = CLI::GetParam<std::string>("batch_file");
+  std::ifstream stream(batchFile);
+  if (!stream.is_open())
+  {
+    Log::Fatal << "Cannot open batch file '" << batchFile << "'!"
+        << std::endl;
+  }
+
+  // Build the description from the default values, once for all runs.
+  CLI::Parameters() = defaults;
+  options_description desc;
+  std::map<std::string, std::string> boostNameMap;
+  BuildOptions(desc, boostNameMap);
+
+  // Collect the options of the command line that are used for every run.
+  std::vector<std::string> commonArgs;
+  if (argc > 1)
+  {
+    basic_parsed_options<char> bpo(command_line_parser(
+        std::vector<std::string>(argv + 1, argv + argc)).options(desc).run());
+    for (size_t i = 0; i < bpo.options.size(); ++i)
+    {
+      if (bpo.options[i].string_key != "batch_file")
+      {
+        commonArgs.insert(commonArgs.end(),
+            bpo.options[i].original_tokens.begin(),
+            bpo.options[i].original_tokens.end());
+      }
+    }
+  }
+
+  const bool infoIgnored = Log::Info.ignoreInput;
+  std::string line;
+  size_t lineNumber = 0;
+  while (std::getline(stream, line))
+  {
+    ++lineNumber;
+    const std::vector<std::string> lineArgs = split_unix(line);
+    if (lineArgs.empty() || lineArgs[0][0] == '#')
+      continue;
+
+    std::vector<std::string> args(commonArgs);
+    args.insert(args.end(), lineArgs.begin(), lineArgs.end());
+
+    // Start from the default values of the parameters, and fresh timers.
+    CLI::Parameters() = defaults;
+    Log::Info.ignoreInput = infoIgnored;
+    Timer::ResetAll();
+    Timer::DisableTracing();
+    Timer::Start("total_time");
+
+    try
+    {
+      ParseOptions(desc, boostNameMap, args);
+      if (CLI::HasParam("batch_file"))
+      {
+        Log::Fatal << "--batch_file cannot be given in a batch file."
+            << std::endl;
+      }
+
+      Log::Info << "Running line " << lineNumber << " of batch file '"
+          << batchFile << "'." << std::endl;
+
+      Timer::EnableTiming();
+      programMain();
+      EndProgram();
+    }
+    catch (std::exception& e)
+    {
+      Log::Fatal << "Run on line " << lineNumber << " of batch file '"
+          << batchFile << "' failed: " << e.what() << std::endl;
+    }
+  }
+}
+
+} // namespace cli
+} // namespace bindings
+} // namespace mlpack
+
+#endif
@@ -35,6 +35,12 @@ cdef extern from "<mlpack/core/util/cli.hpp>" namespace "mlpack" nogil:
     @staticmethod
     void ClearSettings() nogil except +
 
+    @staticmethod
+    void RestoreContext(string) nogil except +
+
+    @staticmethod
+    void ClearContext() nogil except +
+
 cdef extern from "<mlpack/bindings/python/mlpack/cli_util.hpp>" \
     namespace "mlpack::util" nogil:
   void SetParam[T](string, const T&) nogil except +
@@ -44,6 +50,10 @@ cdef extern from "<mlpack/bindings/python/mlpack/cli_util.hpp>" \
   void DisableBacktrace() nogil except +
   void ResetTimers() nogil except +
   void EnableTimers() nogil except +
+  void StartProfiling() nogil except +
+  void WriteProfile() nogil except +
+  void StartThreadLimit() nogil except +
+  void EndThreadLimit() nogil except +
 
 cdef extern from "<mlpack/bindings/python/mlpack/move.hpp>" \
     namespace "mlpack::util" nogil:
@@ -16,6 +16,8 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/data/dataset_mapper.hpp>
 
+#include <memory>
+
 namespace mlpack {
 namespace util {
 
@@ -125,6 +127,68 @@ inline void EnableTimers()
   Timer::EnableTiming();
 }
 
+/**
+ * Record the timeline of the timers, if a profile was requested.  The timers
+ * are reset first, so the profile only holds this call (and any calls running
+ * at the same time in other threads).
+ */
+inline void StartProfiling()
+{
+  if (CLI::HasParam("profile_file"))
+  {
+    ResetTimers();
+    Timer::EnableTracing();
+  }
+}
+
+/**
+ * Write the profile of the timers, if one was requested.
+ */
+inline void WriteProfile()
+{
+  if (CLI::HasParam("profile_file"))
+  {
+    Timer::DisableTracing();
+    CLI::GetSingleton().timer.WriteProfile(
+        CLI::GetParam<std::string>("profile_file"));
+  }
+}
+
+//! The thread limit of the binding call running in the calling thread.
+inline std::unique_ptr<ScopedThreadLimit>& CallThreadLimit()
+{
+  static thread_local std::unique_ptr<ScopedThreadLimit> limit;
+  return limit;
+}
+
+/**
+ * Limit the number of threads of the parallel regions started by the calling
+ * thread, if a limit was given.  The limit only applies to this call, so
+ * concurrent calls from other threads can have their own.
+ */
+inline void StartThreadLimit()
+{
+  CallThreadLimit().reset();
+  if (CLI::HasParam("threads"))
+  {
+    const int threads = CLI::GetParam<int>("threads");
+    if (threads < 0)
+    {
+      throw std::invalid_argument("threads: the number of threads must be "
+          "non-negative");
+    }
+    CallThreadLimit().reset(new ScopedThreadLimit((size_t) threads));
+  }
+}
+
+/**
+ * Remove the limit on the number of threads of the call, if one was given.
+ */
+inline void EndThreadLimit()
+{
+  CallThreadLimit().reset();
+}
+
 } // namespace util
 } // namespace mlpack
 
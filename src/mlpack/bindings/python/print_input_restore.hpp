@@ -0,0 +1,91 @@
+/**
+ * @file print_input_restore.hpp
+ *
+ * Print the code in a Python binding .pyx file that gives the input models back
+ * to their Python objects after the call.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_PYTHON_PRINT_INPUT_RESTORE_HPP
+#define MLPACK_BINDINGS_PYTHON_PRINT_INPUT_RESTORE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "strip_type.hpp"
+
+namespace mlpack {
+namespace bindings {
+namespace python {
+
+/**
+ * Only models are moved out of their Python objects, so nothing needs to be
+ * given back for any other type.
+ */
+template<typename T>
+void PrintInputRestore(
+    const util::ParamData& /* d */,
+    const size_t /* indent */,
+    const typename boost::disable_if<data::HasSerialize<T>>::type* = 0)
+{
+  // Do nothing.
+}
+
+/**
+ * Print the code that moves a serializable model back into the Python object
+ * it came from, so that the object can be passed to more calls without the
+ * model being copied or rebuilt.  If the program consumed the model (usually
+ * to give it back as an output model), the object holds the moved-from model
+ * until the output processing replaces it.
+ */
+template<typename T>
+void PrintInputRestore(
+    const util::ParamData& d,
+    const size_t indent,
+    const typename boost::enable_if<data::HasSerialize<T>>::type* = 0)
+{
+  std::string strippedType, printedType, defaultsType;
+  StripType(d.cppType, strippedType, printedType, defaultsType);
+
+  const std::string prefix(indent, ' ');
+
+  /**
+   * This gives us code like:
+   *
+   * if param_name is not None:
+   *   MoveToPtr[Model]((<ModelType?> param_name).modelptr,
+   *       CLI.GetParam[Model]('param_name'))
+   */
+  std::string innerPrefix = prefix;
+  if (!d.required)
+  {
+    std::cout << prefix << "if " << d.name << " is not None:" << std::endl;
+    innerPrefix += "  ";
+  }
+  std::cout << innerPrefix << "MoveToPtr[" << strippedType << "]((<"
+      << strippedType << "Type?> " << d.name << ").modelptr, CLI.GetParam["
+      << strippedType << "]('" << d.name << "'))" << std::endl;
+}
+
+/**
+ * Print the code to give the input back to its Python object after the call,
+ * if that is needed for the type.
+ *
+ * @param d Parameter data struct.
+ * @param input Pointer to size_t holding the indentation.
+ * @param output Unused parameter.
+ */
+template<typename T>
+void PrintInputRestore(const util::ParamData& d,
+                       const void* input,
+                       void* /* output */)
+{
+  PrintInputRestore<T>(d, *((size_t*) input));
+}
+
+} // namespace python
+} // namespace bindings
+} // namespace mlpack
+
+#endif
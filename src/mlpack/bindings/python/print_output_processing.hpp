@@ -9,6 +9,7 @@
 #define MLPACK_BINDINGS_PYTHON_PRINT_OUTPUT_PROCESSING_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
 #include "get_arma_type.hpp"
 #include "get_numpy_type_char.hpp"
 #include "get_cython_type.hpp"
@@ -152,7 +153,39 @@ void PrintOutputProcessing(
   std::string strippedType, printedType, defaultsType;
   StripType(d.cppType, strippedType, printedType, defaultsType);
 
-  const std::string prefix(indent, ' ');
+  std::string prefix(indent, ' ');
+
+  // By convention, a program that is given an input model gives the same model
+  // back as its output model.  In that case the output is moved into the
+  // object of the input model, and that object is returned, so that the Python
+  // handle of the model stays valid across calls.
+  const std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
+  const bool sharedHandle = (d.name == "output_model") &&
+      (parameters.count("input_model") > 0) &&
+      (parameters.at("input_model").cppType == d.cppType);
+  if (sharedHandle)
+  {
+    /**
+     * This gives us code like:
+     *
+     * if input_model is not None:
+     *   MoveToPtr[Model]((<ModelType?> input_model).modelptr,
+     *       CLI.GetParam[Model]('output_model'))
+     *   result['output_model'] = input_model
+     * else:
+     */
+    std::cout << prefix << "if input_model is not None:" << std::endl;
+    std::cout << prefix << "  MoveToPtr[" << strippedType << "]((<"
+        << strippedType << "Type?> input_model).modelptr, CLI.GetParam["
+        << strippedType << "]('" << d.name << "'))" << std::endl;
+    if (onlyOutput)
+      std::cout << prefix << "  result = input_model" << std::endl;
+    else
+      std::cout << prefix << "  result['" << d.name << "'] = input_model"
+          << std::endl;
+    std::cout << prefix << "else:" << std::endl;
+    prefix += "  ";
+  }
 
   if (onlyOutput)
   {
@@ -72,8 +72,10 @@ void PrintPYX(const ProgramDoc& programInfo,
   cout << "cimport arma_numpy" << endl;
   cout << "from cli cimport CLI" << endl;
   cout << "from cli cimport SetParam, SetParamWithInfo" << endl;
-  cout << "from cli cimport EnableVerbose, DisableBacktrace, ResetTimers, "
-      << "EnableTimers" << endl;
+  cout << "from cli cimport EnableVerbose, DisableBacktrace, EnableTimers"
+      << endl;
+  cout << "from cli cimport StartProfiling, WriteProfile" << endl;
+  cout << "from cli cimport StartThreadLimit, EndThreadLimit" << endl;
   cout << "from cli cimport MoveFromPtr, MoveToPtr" << endl;
   cout << "from matrix_utils import to_matrix, to_matrix_with_info" << endl;
   cout << endl;
@@ -169,13 +171,14 @@ void PrintPYX(const ProgramDoc& programInfo,
       << "returned." << endl;
   cout << "  \"\"\"" << endl;
 
-  // Reset any timers and disable backtraces.
-  cout << "  ResetTimers()" << endl;
+  // Enable timers and disable backtraces.  The timers are not reset here,
+  // since other threads may be running bindings.
   cout << "  EnableTimers()" << endl;
   cout << "  DisableBacktrace()" << endl;
 
-  // Restore the parameters.
-  cout << "  CLI.RestoreSettings(\"" << programInfo.programName << "\")";
+  // Restore the parameters into a context of this thread, so that concurrent
+  // calls from other Python threads do not see them.
+  cout << "  CLI.RestoreContext(\"" << programInfo.programName << "\")";
 
   // Do any input processing.
   for (size_t i = 0; i < inputOptions.size(); ++i)
@@ -197,7 +200,26 @@ void PrintPYX(const ProgramDoc& programInfo,
 
   // Call the method.
   cout << "  # Call the mlpack program." << endl;
-  cout << "  mlpackMain()" << endl;
+  cout << "  StartProfiling()" << endl;
+  cout << "  StartThreadLimit()" << endl;
+  cout << "  try:" << endl;
+  cout << "    with nogil:" << endl;
+  cout << "      mlpackMain()" << endl;
+  cout << "  finally:" << endl;
+  cout << "    EndThreadLimit()" << endl;
+  cout << "  WriteProfile()" << endl;
+  cout << endl;
+
+  // Give the input models back to their Python objects.
+  cout << "  # Give the input models back to their objects." << endl;
+  for (size_t i = 0; i < inputOptions.size(); ++i)
+  {
+    const util::ParamData& d = parameters.at(inputOptions[i]);
+
+    size_t indent = 2;
+    CLI::GetSingleton().functionMap[d.tname]["PrintInputRestore"](d,
+        (void*) &indent, NULL);
+  }
 
   // Do any output processing and return.
   cout << "  # Initialize result dictionary." << endl;
@@ -215,7 +237,7 @@ void PrintPYX(const ProgramDoc& programInfo,
 
   // Clear the parameters.
   cout << endl;
-  cout << "  CLI.ClearSettings()" << endl;
+  cout << "  CLI.ClearContext()" << endl;
   cout << endl;
 
   cout << "  return result" << endl;
@@ -4,6 +4,7 @@ test_python_binding.py
 
 Test that passing types to Python bindings works successfully.
 """
+import threading
 import unittest
 import pandas as pd
 import numpy as np
@@ -345,5 +346,49 @@ class TestPythonBinding(unittest.TestCase):
 
     self.assertEqual(output2['model_bw_out'], 20.0)
 
+  def testModelReuse(self):
+    """
+    Make sure that a model handle can be passed to several calls, since the
+    model is given back to it after each call.
+    """
+    output = test_python_binding(string_in='hello',
+                                 int_in=12,
+                                 double_in=4.0,
+                                 build_model=True)
+    model = output['model_out']
+
+    for i in range(3):
+      output2 = test_python_binding(string_in='hello',
+                                    int_in=12,
+                                    double_in=4.0,
+                                    model_in=model)
+
+      self.assertEqual(output2['model_bw_out'], 20.0)
+
+  def testConcurrentCalls(self):
+    """
+    Run the binding from several threads at once, with different parameters,
+    and make sure that each call gets its own results.
+    """
+    results = [None] * 8
+    def run(i):
+      results[i] = test_python_binding(string_in='hello',
+                                       int_in=12 + (i % 2),
+                                       double_in=4.0,
+                                       flag1=True)
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(8)]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+
+    for i in range(8):
+      self.assertEqual(results[i]['string_out'], 'hello2')
+      if i % 2 == 0:
+        self.assertEqual(results[i]['int_out'], 13)
+      else:
+        self.assertNotEqual(results[i]['int_out'], 13)
+
 if __name__ == '__main__':
   unittest.main()
@@ -88,6 +88,7 @@
  * - mlpack_perceptron
  * - mlpack_radical
  * - mlpack_range_search
+ * - mlpack_search_benchmark
  * - mlpack_softmax_regression
  * - mlpack_sparse_coding
  *
@@ -236,6 +237,7 @@
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/deprecated.hpp>
+#include <mlpack/core/util/reduction_partials.hpp>
 #include <mlpack/core/data/load.hpp>
 #include <mlpack/core/data/save.hpp>
 #include <mlpack/core/data/normalize_labels.hpp>
@@ -247,6 +249,7 @@
 #include <mlpack/core/math/round.hpp>
 #include <mlpack/core/dists/discrete_distribution.hpp>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
 #include <mlpack/core/dists/laplace_distribution.hpp>
 #include <mlpack/core/dists/gamma_distribution.hpp>
 
@@ -267,6 +270,7 @@
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
 #include <mlpack/core/kernels/spherical_kernel.hpp>
 #include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 
 // Use OpenMP if compiled with -DHAS_OPENMP.
 #ifdef HAS_OPENMP
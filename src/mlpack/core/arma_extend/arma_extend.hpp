@@ -39,6 +39,14 @@
     #endif
 #endif
 
+// Count the memory allocated for Armadillo objects, if requested (see
+// MemoryTracker).
+#ifdef MLPACK_TRACK_MEMORY
+  #include <mlpack/core/util/memory_tracker.hpp>
+  #define ARMA_ALIEN_MEM_ALLOC_FUNCTION ::mlpack::MemoryTracker::Allocate
+  #define ARMA_ALIEN_MEM_FREE_FUNCTION ::mlpack::MemoryTracker::Free
+#endif
+
 // Make sure that U64 and S64 support is enabled.
 #ifndef ARMA_USE_U64S64
   #define ARMA_USE_U64S64
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_CV_CV_BASE_HPP
 
 #include <mlpack/core/cv/meta_info_extractor.hpp>
+#include <mlpack/core/cv/warm_start_traits.hpp>
 
 namespace mlpack {
 namespace cv {
@@ -98,6 +99,51 @@ class CVBase
                     const WeightsType& weights,
                     const MLAlgorithmArgs&... args);
 
+  /**
+   * Train MLAlgorithm for the given fold.  If warm starts are enabled (see
+   * WarmStart()), the model is trained starting from the solution of the last
+   * model trained for the same fold.  PrepareWarmStart() must have been called
+   * with more folds than the given one then.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm TrainFold(const size_t fold,
+                        const MatType& xs,
+                        const PredictionsType& ys,
+                        const MLAlgorithmArgs&... args);
+
+  /**
+   * Train MLAlgorithm for the given fold with weights.  Weighted models are
+   * always trained from scratch.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm TrainFold(const size_t fold,
+                        const MatType& xs,
+                        const PredictionsType& ys,
+                        const WeightsType& weights,
+                        const MLAlgorithmArgs&... args);
+
+  /**
+   * Get whether the models of each fold are warm-started from the last model
+   * of the same fold.  This has no effect unless MLAlgorithm supports warm
+   * starts (see WarmStartTraits).
+   */
+  bool WarmStart() const { return warmStart; }
+  //! Modify whether the models of each fold are warm-started.
+  bool& WarmStart() { return warmStart; }
+
+  /**
+   * Make room for the last models of the given number of folds.  The models
+   * that are already kept are not forgotten.
+   */
+  void PrepareWarmStart(const size_t numFolds)
+  {
+    if (warmStartModels.size() < numFolds)
+      warmStartModels.resize(numFolds);
+  }
+
+  //! Forget the last models of all folds.
+  void ResetWarmStart() { warmStartModels.clear(); }
+
  private:
   static_assert(MIE::IsSupported,
       "The given MLAlgorithm is not supported by MetaInfoExtractor");
@@ -109,6 +155,56 @@ class CVBase
   //! A variable for storing the numClasses parameter if it is passed.
   size_t numClasses;
 
+  //! Whether the models of each fold are warm-started.
+  bool warmStart;
+  //! The last model trained for each fold (shared between copies).
+  std::vector<std::shared_ptr<const MLAlgorithm>> warmStartModels;
+
+  /**
+   * Train MLAlgorithm from scratch, as warm starts are not supported.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm WarmTrain(std::false_type /* supported */,
+                        const MLAlgorithm& previous,
+                        const MatType& xs,
+                        const PredictionsType& ys,
+                        const MLAlgorithmArgs&... args);
+
+  /**
+   * Train MLAlgorithm starting from the previous model with WarmStartTraits,
+   * passing numClasses if MLAlgorithm takes it.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm WarmTrain(std::true_type /* supported */,
+                        const MLAlgorithm& previous,
+                        const MatType& xs,
+                        const PredictionsType& ys,
+                        const MLAlgorithmArgs&... args);
+
+  /**
+   * Call WarmStartTraits::Train() if MLAlgorithm doesn't take the numClasses
+   * parameter.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm WarmTrainModel(std::false_type /* takesNumClasses */,
+                             std::true_type /* supported */,
+                             const MLAlgorithm& previous,
+                             const MatType& xs,
+                             const PredictionsType& ys,
+                             const MLAlgorithmArgs&... args);
+
+  /**
+   * Call WarmStartTraits::Train() with numClasses if MLAlgorithm takes the
+   * numClasses parameter.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm WarmTrainModel(std::true_type /* takesNumClasses */,
+                             std::true_type /* supported */,
+                             const MLAlgorithm& previous,
+                             const MatType& xs,
+                             const PredictionsType& ys,
+                             const MLAlgorithmArgs&... args);
+
   /**
    * Assert there is an equal number of data points and predictions.
    */
@@ -23,7 +23,8 @@ CVBase<MLAlgorithm,
        MatType,
        PredictionsType,
        WeightsType>::CVBase() :
-    isDatasetInfoPassed(false)
+    isDatasetInfoPassed(false),
+    warmStart(false)
 {
   static_assert(!MIE::TakesNumClasses,
       "The given MLAlgorithm requires the numClasses parameter");
@@ -38,7 +39,8 @@ CVBase<MLAlgorithm,
        PredictionsType,
        WeightsType>::CVBase(const size_t numClasses) :
     isDatasetInfoPassed(false),
-    numClasses(numClasses)
+    numClasses(numClasses),
+    warmStart(false)
 {
   static_assert(MIE::TakesNumClasses,
       "The given MLAlgorithm does not take the numClasses parameter");
@@ -55,7 +57,8 @@ CVBase<MLAlgorithm,
                             const size_t numClasses) :
     datasetInfo(datasetInfo),
     isDatasetInfoPassed(true),
-    numClasses(numClasses)
+    numClasses(numClasses),
+    warmStart(false)
 {
   static_assert(MIE::TakesNumClasses,
       "The given MLAlgorithm does not take the numClasses parameter");
@@ -94,6 +97,130 @@ MLAlgorithm CVBase<MLAlgorithm,
   return TrainModel(xs, ys, weights, args...);
 }
 
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::TrainFold(const size_t fold,
+                                           const MatType& xs,
+                                           const PredictionsType& ys,
+                                           const MLAlgorithmArgs&... args)
+{
+  using Supported =
+      std::integral_constant<bool, WarmStartTraits<MLAlgorithm>::Supported>;
+
+  if (!warmStart || !Supported::value)
+    return TrainModel(xs, ys, args...);
+
+  // Each fold only touches its own model, so that the folds can be trained in
+  // parallel.
+  std::shared_ptr<const MLAlgorithm>& previous = warmStartModels.at(fold);
+  MLAlgorithm model = previous ?
+      WarmTrain(Supported(), *previous, xs, ys, args...) :
+      TrainModel(xs, ys, args...);
+  previous = std::make_shared<const MLAlgorithm>(model);
+
+  return model;
+}
+
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::TrainFold(const size_t /* fold */,
+                                           const MatType& xs,
+                                           const PredictionsType& ys,
+                                           const WeightsType& weights,
+                                           const MLAlgorithmArgs&... args)
+{
+  return TrainModel(xs, ys, weights, args...);
+}
+
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::WarmTrain(
+    std::false_type /* supported */,
+    const MLAlgorithm& /* previous */,
+    const MatType& xs,
+    const PredictionsType& ys,
+    const MLAlgorithmArgs&... args)
+{
+  return TrainModel(xs, ys, args...);
+}
+
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::WarmTrain(
+    std::true_type supported,
+    const MLAlgorithm& previous,
+    const MatType& xs,
+    const PredictionsType& ys,
+    const MLAlgorithmArgs&... args)
+{
+  return WarmTrainModel(
+      std::integral_constant<bool, MIE::TakesNumClasses>(), supported,
+      previous, xs, ys, args...);
+}
+
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::WarmTrainModel(
+    std::false_type /* takesNumClasses */,
+    std::true_type /* supported */,
+    const MLAlgorithm& previous,
+    const MatType& xs,
+    const PredictionsType& ys,
+    const MLAlgorithmArgs&... args)
+{
+  return WarmStartTraits<MLAlgorithm>::Train(previous, xs, ys, args...);
+}
+
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::WarmTrainModel(
+    std::true_type /* takesNumClasses */,
+    std::true_type /* supported */,
+    const MLAlgorithm& previous,
+    const MatType& xs,
+    const PredictionsType& ys,
+    const MLAlgorithmArgs&... args)
+{
+  return WarmStartTraits<MLAlgorithm>::Train(previous, xs, ys, numClasses,
+      args...);
+}
+
 template<typename MLAlgorithm,
          typename MatType,
          typename PredictionsType,
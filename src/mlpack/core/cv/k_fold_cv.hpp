@@ -14,6 +14,7 @@
 
 #include <mlpack/core/cv/meta_info_extractor.hpp>
 #include <mlpack/core/cv/cv_base.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace cv {
@@ -40,6 +41,15 @@ namespace cv {
  * double softmaxAccuracy = cv.Evaluate(lambda);
  * @endcode
  *
+ * KFoldCV holds one copy of the data.  The data is rotated in place before
+ * each fold, so that the training subset and the validation subset of each
+ * fold are contiguous, and the models are trained and evaluated on aliases of
+ * them rather than on copies.  When the folds are trained in parallel (see
+ * NumThreads()), the data is not rotated, and only the subsets that wrap
+ * around the end of the data are copied.  The data is taken by value, so it
+ * can be moved into the KFoldCV object with std::move() to avoid that copy
+ * too, in which case the data is never copied at all.
+ *
  * @tparam MLAlgorithm A machine learning algorithm.
  * @tparam Metric A metric to assess the quality of a trained model.
  * @tparam MatType The type of data.
@@ -71,8 +81,8 @@ class KFoldCV
    *     for regression algorithms) for each data point.
    */
   KFoldCV(const size_t k,
-          const MatType& xs,
-          const PredictionsType& ys);
+          MatType xs,
+          PredictionsType ys);
 
   /**
    * This constructor can be used for multiclass classification algorithms.
@@ -83,8 +93,8 @@ class KFoldCV
    * @param numClasses Number of classes in the dataset.
    */
   KFoldCV(const size_t k,
-          const MatType& xs,
-          const PredictionsType& ys,
+          MatType xs,
+          PredictionsType ys,
           const size_t numClasses);
 
   /**
@@ -98,9 +108,9 @@ class KFoldCV
    * @param numClasses Number of classes in the dataset.
    */
   KFoldCV(const size_t k,
-          const MatType& xs,
+          MatType xs,
           const data::DatasetInfo& datasetInfo,
-          const PredictionsType& ys,
+          PredictionsType ys,
           const size_t numClasses);
 
   /**
@@ -114,9 +124,9 @@ class KFoldCV
    * @param weights Observation weights (for boosting).
    */
   KFoldCV(const size_t k,
-          const MatType& xs,
-          const PredictionsType& ys,
-          const WeightsType& weights);
+          MatType xs,
+          PredictionsType ys,
+          WeightsType weights);
 
   /**
    * This constructor can be used for multiclass classification algorithms that
@@ -129,10 +139,10 @@ class KFoldCV
    * @param weights Observation weights (for boosting).
    */
   KFoldCV(const size_t k,
-          const MatType& xs,
-          const PredictionsType& ys,
+          MatType xs,
+          PredictionsType ys,
           const size_t numClasses,
-          const WeightsType& weights);
+          WeightsType weights);
 
   /**
    * This constructor can be used for multiclass classification algorithms that
@@ -146,11 +156,20 @@ class KFoldCV
    * @param weights Observation weights (for boosting).
    */
   KFoldCV(const size_t k,
-          const MatType& xs,
+          MatType xs,
           const data::DatasetInfo& datasetInfo,
-          const PredictionsType& ys,
+          PredictionsType ys,
           const size_t numClasses,
-          const WeightsType& weights);
+          WeightsType weights);
+
+  /**
+   * Copy the given KFoldCV object, including its data and the model from the
+   * last run (if any), so that the copy can be used independently, for example
+   * from another thread.
+   *
+   * @param other KFoldCV object to copy.
+   */
+  KFoldCV(const KFoldCV& other);
 
   /**
    * Run k-fold cross-validation.
@@ -164,6 +183,43 @@ class KFoldCV
   //! Access and modify a model from the last run of k-fold cross-validation.
   MLAlgorithm& Model();
 
+  //! Get the proportion of each training subset that is used for training.
+  double TrainingFraction() const { return trainingFraction; }
+  /**
+   * Modify the proportion (between 0 and 1) of each training subset that is
+   * used for training; the validation subsets are not affected.  Only the
+   * first points of each training subset are used, so the data should be
+   * shuffled.  The default value is 1.
+   */
+  double& TrainingFraction() { return trainingFraction; }
+
+  //! Get the number of threads used to train the folds.
+  size_t NumThreads() const { return numThreads; }
+  /**
+   * Modify the number of threads used to train the folds (0 means as many as
+   * are allowed; see ParallelThreads()).  Inside of a parallel region, such as
+   * a parallel grid search of HyperParameterTuner, the folds are always
+   * trained one after another.  Each fold draws its random numbers from its
+   * own stream, so the results do not depend on the number of threads.
+   */
+  size_t& NumThreads() { return numThreads; }
+
+  /**
+   * Get whether the model of each fold is trained starting from the solution
+   * of the last model of the same fold.  This only has an effect when
+   * MLAlgorithm supports warm starts (see WarmStartTraits).
+   */
+  bool WarmStart() const { return base.WarmStart(); }
+  /**
+   * Modify whether the model of each fold is trained starting from the
+   * solution of the last model of the same fold.  This is used by
+   * HyperParameterTuner for sweeps over regularization paths.
+   */
+  bool& WarmStart() { return base.WarmStart(); }
+
+  //! Forget the last models, so that the next models are trained from scratch.
+  void ResetWarmStart() { base.ResetWarmStart(); }
+
  private:
   //! A short alias for CVBase.
   using Base = CVBase<MLAlgorithm, MatType, PredictionsType, WeightsType>;
@@ -174,19 +230,28 @@ class KFoldCV
   //! The number of bins in the dataset.
   const size_t k;
 
-  //! The extended (by repeating the first k - 2 bins) data points.
+  //! The data points (rotated by offset columns).
   MatType xs;
-  //! The extended (by repeating the first k - 2 bins) predictions.
+  //! The predictions (rotated by offset columns).
   PredictionsType ys;
-  //! The extended (by repeating the first k - 2 bins) weights.
+  //! The weights (rotated by offset columns).
   WeightsType weights;
 
+  //! The index of the original data point that is the first column now.
+  size_t offset;
+
   //! The size of each bin in terms of data points.
   size_t binSize;
 
   //! The size of each training subset in terms of data points.
   size_t trainingSubsetSize;
 
+  //! The proportion of each training subset that is used for training.
+  double trainingFraction;
+
+  //! The number of threads used to train the folds.
+  size_t numThreads;
+
   //! A pointer to a model from the last run of k-fold cross-validation.
   std::unique_ptr<MLAlgorithm> modelPtr;
 
@@ -196,8 +261,8 @@ class KFoldCV
    */
   KFoldCV(Base&& base,
           const size_t k,
-          const MatType& xs,
-          const PredictionsType& ys);
+          MatType xs,
+          PredictionsType ys);
 
   /**
    * Assert the k parameter and data consistency and initialize fields required
@@ -205,16 +270,29 @@ class KFoldCV
    */
   KFoldCV(Base&& base,
           const size_t k,
-          const MatType& xs,
-          const PredictionsType& ys,
-          const WeightsType& weights);
+          MatType xs,
+          PredictionsType ys,
+          WeightsType weights);
+
+  /**
+   * Move the given source into the given destination matrix, and initialize
+   * the sizes of the bins and the training subsets.
+   */
+  template<typename DataType>
+  void InitKFoldCVMat(DataType& source, DataType& destination);
 
   /**
-   * Initialize the given destination matrix with the given source joined with
-   * its first k - 2 bins.
+   * Rotate the data points, predictions and weights in place so that the
+   * training subset of the ith fold starts at the first column.
+   */
+  void RotateToFold(const size_t i);
+
+  /**
+   * Rotate the columns of the given matrix in place by the given number of
+   * columns to the left.
    */
   template<typename DataType>
-  void InitKFoldCVMat(const DataType& source, DataType& destination);
+  static void RotateColumns(DataType& m, const size_t cols);
 
   /**
    * Train and run evaluation in the case of non-weighted learning.
@@ -234,26 +312,52 @@ class KFoldCV
   double TrainAndEvaluate(const MLAlgorithmArgs& ...mlAlgorithmArgs);
 
   /**
-   * Calculate the index of the first column of the ith validation subset.
+   * Calculate the index of the first column of the ith validation subset, once
+   * the data is rotated for the ith fold.
    *
    * We take the ith validation subset after the ith training subset if
-   * i < k - 1 and before it otherwise.
+   * i < k - 1 and before it otherwise (in the original data, extended by
+   * repeating its first k - 2 bins).
    */
   inline size_t ValidationSubsetFirstCol(const size_t i);
 
   /**
-   * Get the ith training subset from a variable of a matrix type.
+   * Calculate the number of data points of each training subset that are used
+   * for training according to the training fraction.
+   */
+  inline size_t NumberOfTrainingPoints() const;
+
+  /**
+   * Get the training subset of the current fold from a variable of a matrix
+   * type.
+   */
+  template<typename ElementType>
+  inline arma::Mat<ElementType> GetTrainingSubset(arma::Mat<ElementType>& m);
+
+  /**
+   * Get the training subset of the current fold from a variable of a row type.
+   */
+  template<typename ElementType>
+  inline arma::Row<ElementType> GetTrainingSubset(arma::Row<ElementType>& r);
+
+  /**
+   * Get the given number of columns of the given matrix from the given first
+   * column, wrapping around to the first column of the matrix.  The columns
+   * are an alias, unless they wrap around, in which case they are copied.
    */
   template<typename ElementType>
-  inline arma::Mat<ElementType> GetTrainingSubset(arma::Mat<ElementType>& m,
-                                                  const size_t i);
+  static arma::Mat<ElementType> GetColumns(arma::Mat<ElementType>& m,
+                                           const size_t first,
+                                           const size_t count);
 
   /**
-   * Get the ith training subset from a variable of a row type.
+   * Get the given number of elements of the given row from the given first
+   * element, wrapping around to the first element of the row.
    */
   template<typename ElementType>
-  inline arma::Row<ElementType> GetTrainingSubset(arma::Row<ElementType>& r,
-                                                  const size_t i);
+  static arma::Row<ElementType> GetColumns(arma::Row<ElementType>& r,
+                                           const size_t first,
+                                           const size_t count);
 
   /**
    * Get the ith validation subset from a variable of a matrix type.
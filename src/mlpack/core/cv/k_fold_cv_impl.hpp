@@ -25,9 +25,9 @@ KFoldCV<MLAlgorithm,
         MatType,
         PredictionsType,
         WeightsType>::KFoldCV(const size_t k,
-                              const MatType& xs,
-                              const PredictionsType& ys) :
-    KFoldCV(Base(), k, xs, ys)
+                              MatType xs,
+                              PredictionsType ys) :
+    KFoldCV(Base(), k, std::move(xs), std::move(ys))
 { /* Nothing left to do. */ }
 
 template<typename MLAlgorithm,
@@ -40,10 +40,10 @@ KFoldCV<MLAlgorithm,
         MatType,
         PredictionsType,
         WeightsType>::KFoldCV(const size_t k,
-                              const MatType& xs,
-                              const PredictionsType& ys,
+                              MatType xs,
+                              PredictionsType ys,
                               const size_t numClasses) :
-    KFoldCV(Base(numClasses), k, xs, ys)
+    KFoldCV(Base(numClasses), k, std::move(xs), std::move(ys))
 { /* Nothing left to do. */ }
 
 template<typename MLAlgorithm,
@@ -56,11 +56,11 @@ KFoldCV<MLAlgorithm,
         MatType,
         PredictionsType,
         WeightsType>::KFoldCV(const size_t k,
-                              const MatType& xs,
+                              MatType xs,
                               const data::DatasetInfo& datasetInfo,
-                              const PredictionsType& ys,
+                              PredictionsType ys,
                               const size_t numClasses) :
-    KFoldCV(Base(datasetInfo, numClasses), k, xs, ys)
+    KFoldCV(Base(datasetInfo, numClasses), k, std::move(xs), std::move(ys))
 { /* Nothing left to do. */ }
 
 template<typename MLAlgorithm,
@@ -73,10 +73,10 @@ KFoldCV<MLAlgorithm,
         MatType,
         PredictionsType,
         WeightsType>::KFoldCV(const size_t k,
-                              const MatType& xs,
-                              const PredictionsType& ys,
-                              const WeightsType& weights) :
-    KFoldCV(Base(), k, xs, ys, weights)
+                              MatType xs,
+                              PredictionsType ys,
+                              WeightsType weights) :
+    KFoldCV(Base(), k, std::move(xs), std::move(ys), std::move(weights))
 { /* Nothing left to do. */ }
 
 template<typename MLAlgorithm,
@@ -89,11 +89,12 @@ KFoldCV<MLAlgorithm,
         MatType,
         PredictionsType,
         WeightsType>::KFoldCV(const size_t k,
-                              const MatType& xs,
-                              const PredictionsType& ys,
+                              MatType xs,
+                              PredictionsType ys,
                               const size_t numClasses,
-                              const WeightsType& weights) :
-    KFoldCV(Base(numClasses), k, xs, ys, weights)
+                              WeightsType weights) :
+    KFoldCV(Base(numClasses), k, std::move(xs),
+        std::move(ys), std::move(weights))
 { /* Nothing left to do. */ }
 
 template<typename MLAlgorithm,
@@ -106,12 +107,13 @@ KFoldCV<MLAlgorithm,
         MatType,
         PredictionsType,
         WeightsType>::KFoldCV(const size_t k,
-                              const MatType& xs,
+                              MatType xs,
                               const data::DatasetInfo& datasetInfo,
-                              const PredictionsType& ys,
+                              PredictionsType ys,
                               const size_t numClasses,
-                              const WeightsType& weights) :
-    KFoldCV(Base(datasetInfo, numClasses), k, xs, ys, weights)
+                              WeightsType weights) :
+    KFoldCV(Base(datasetInfo, numClasses), k, std::move(xs),
+        std::move(ys), std::move(weights))
 { /* Nothing left to do. */ }
 
 template<typename MLAlgorithm,
@@ -125,9 +127,13 @@ KFoldCV<MLAlgorithm,
         PredictionsType,
         WeightsType>::KFoldCV(Base&& base,
                               const size_t k,
-                              const MatType& xs,
-                              const PredictionsType& ys) :
-  base(std::move(base)), k(k)
+                              MatType xs,
+                              PredictionsType ys) :
+  base(std::move(base)),
+  k(k),
+  offset(0),
+  trainingFraction(1.0),
+  numThreads(0)
 {
   if (k < 2)
     throw std::invalid_argument("KFoldCV: k should not be less than 2");
@@ -149,16 +155,39 @@ KFoldCV<MLAlgorithm,
         PredictionsType,
         WeightsType>::KFoldCV(Base&& base,
                               const size_t k,
-                              const MatType& xs,
-                              const PredictionsType& ys,
-                              const WeightsType& weights) :
-    KFoldCV(std::move(base), k, xs, ys)
+                              MatType xs,
+                              PredictionsType ys,
+                              WeightsType weights) :
+    KFoldCV(std::move(base), k, std::move(xs), std::move(ys))
 {
-  Base::AssertWeightsConsistency(xs, weights);
+  Base::AssertWeightsConsistency(this->xs, weights);
 
   InitKFoldCVMat(weights, this->weights);
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+KFoldCV<MLAlgorithm,
+        Metric,
+        MatType,
+        PredictionsType,
+        WeightsType>::KFoldCV(const KFoldCV& other) :
+    base(other.base),
+    k(other.k),
+    xs(other.xs),
+    ys(other.ys),
+    weights(other.weights),
+    offset(other.offset),
+    binSize(other.binSize),
+    trainingSubsetSize(other.trainingSubsetSize),
+    trainingFraction(other.trainingFraction),
+    numThreads(other.numThreads),
+    modelPtr(other.modelPtr ? new MLAlgorithm(*other.modelPtr) : nullptr)
+{ /* Nothing left to do. */ }
+
 template<typename MLAlgorithm,
          typename Metric,
          typename MatType,
@@ -202,14 +231,55 @@ void KFoldCV<MLAlgorithm,
              Metric,
              MatType,
              PredictionsType,
-             WeightsType>::InitKFoldCVMat(const DataType& source,
+             WeightsType>::InitKFoldCVMat(DataType& source,
                                           DataType& destination)
 {
   binSize = source.n_cols / k;
   trainingSubsetSize = binSize * (k - 1);
 
-  destination = (k == 2) ? source : arma::join_rows(source,
-      source.cols(0, trainingSubsetSize - binSize - 1));
+  destination = std::move(source);
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+void KFoldCV<MLAlgorithm,
+             Metric,
+             MatType,
+             PredictionsType,
+             WeightsType>::RotateToFold(const size_t i)
+{
+  const size_t n = xs.n_cols;
+  const size_t newOffset = (binSize * i) % n;
+  const size_t cols = (newOffset + n - offset) % n;
+  if (cols == 0)
+    return;
+
+  RotateColumns(xs, cols);
+  RotateColumns(ys, cols);
+  if (weights.n_elem > 0)
+    RotateColumns(weights, cols);
+
+  offset = newOffset;
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename DataType>
+void KFoldCV<MLAlgorithm,
+             Metric,
+             MatType,
+             PredictionsType,
+             WeightsType>::RotateColumns(DataType& m, const size_t cols)
+{
+  // The columns are contiguous, so this is a rotation of the elements.
+  std::rotate(m.memptr(), m.memptr() + cols * m.n_rows,
+      m.memptr() + m.n_elem);
 }
 
 template<typename MLAlgorithm,
@@ -225,11 +295,45 @@ double KFoldCV<MLAlgorithm,
                 WeightsType>::TrainAndEvaluate(const MLAlgorithmArgs&... args)
 {
   arma::vec evaluations(k);
+  base.PrepareWarmStart(k);
+
+  // Each fold draws its random numbers from its own stream, so the results do
+  // not depend on the number of threads.
+  const uint64_t seed = math::RandomStreamSeed();
+  const size_t threads = ParallelThreads(numThreads);
+  if (threads > 1)
+  {
+    // The folds are trained at once, so the data stays in its original order.
+    RotateToFold(0);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+    for (omp_size_t i = 0; i < (omp_size_t) k; ++i)
+    {
+      math::RandomStream stream(seed, i);
+      math::RandomStreamScope scope(stream);
+
+      const size_t first = binSize * i;
+      MLAlgorithm&& model = base.TrainFold(i,
+          GetColumns(xs, first, NumberOfTrainingPoints()),
+          GetColumns(ys, first, NumberOfTrainingPoints()), args...);
+      evaluations(i) = Metric::Evaluate(model,
+          GetColumns(xs, ValidationSubsetFirstCol(i), binSize),
+          GetColumns(ys, ValidationSubsetFirstCol(i), binSize));
+      if ((size_t) i == k - 1)
+        modelPtr.reset(new MLAlgorithm(std::move(model)));
+    }
+
+    return arma::mean(evaluations);
+  }
 
   for (size_t i = 0; i < k; ++i)
   {
-    MLAlgorithm&& model  = base.Train(GetTrainingSubset(xs, i),
-        GetTrainingSubset(ys, i), args...);
+    math::RandomStream stream(seed, i);
+    math::RandomStreamScope scope(stream);
+
+    RotateToFold(i);
+    MLAlgorithm&& model  = base.TrainFold(i, GetTrainingSubset(xs),
+        GetTrainingSubset(ys), args...);
     evaluations(i) = Metric::Evaluate(model, GetValidationSubset(xs, i),
         GetValidationSubset(ys, i));
     if (i == k - 1)
@@ -252,13 +356,49 @@ double KFoldCV<MLAlgorithm,
                 WeightsType>::TrainAndEvaluate(const MLAlgorithmArgs&... args)
 {
   arma::vec evaluations(k);
+  base.PrepareWarmStart(k);
+
+  // As in the non-weighted case, each fold has its own random stream.
+  const uint64_t seed = math::RandomStreamSeed();
+  const size_t threads = ParallelThreads(numThreads);
+  if (threads > 1)
+  {
+    RotateToFold(0);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+    for (omp_size_t i = 0; i < (omp_size_t) k; ++i)
+    {
+      math::RandomStream stream(seed, i);
+      math::RandomStreamScope scope(stream);
+
+      const size_t first = binSize * i;
+      const size_t points = NumberOfTrainingPoints();
+      MLAlgorithm&& model = (weights.n_elem > 0) ?
+          base.Train(GetColumns(xs, first, points),
+              GetColumns(ys, first, points),
+              GetColumns(weights, first, points), args...) :
+          base.TrainFold(i, GetColumns(xs, first, points),
+              GetColumns(ys, first, points), args...);
+      evaluations(i) = Metric::Evaluate(model,
+          GetColumns(xs, ValidationSubsetFirstCol(i), binSize),
+          GetColumns(ys, ValidationSubsetFirstCol(i), binSize));
+      if ((size_t) i == k - 1)
+        modelPtr.reset(new MLAlgorithm(std::move(model)));
+    }
+
+    return arma::mean(evaluations);
+  }
 
   for (size_t i = 0; i < k; ++i)
   {
+    math::RandomStream stream(seed, i);
+    math::RandomStreamScope scope(stream);
+
+    RotateToFold(i);
     MLAlgorithm&& model = (weights.n_elem > 0) ?
-        base.Train(GetTrainingSubset(xs, i), GetTrainingSubset(ys, i),
-            GetTrainingSubset(weights, i), args...) :
-        base.Train(GetTrainingSubset(xs, i), GetTrainingSubset(ys, i),
+        base.Train(GetTrainingSubset(xs), GetTrainingSubset(ys),
+            GetTrainingSubset(weights), args...) :
+        base.TrainFold(i, GetTrainingSubset(xs), GetTrainingSubset(ys),
             args...);
     evaluations(i) = Metric::Evaluate(model, GetValidationSubset(xs, i),
         GetValidationSubset(ys, i));
@@ -280,7 +420,29 @@ size_t KFoldCV<MLAlgorithm,
                PredictionsType,
                WeightsType>::ValidationSubsetFirstCol(const size_t i)
 {
-  return (i < k - 1) ? (binSize * i + trainingSubsetSize) : (binSize * (i - 1));
+  // The columns of the extended data wrap around to the original data.
+  const size_t n = xs.n_cols;
+  const size_t first = (i < k - 1) ? (binSize * i + trainingSubsetSize) :
+      (binSize * (i - 1));
+  return (first % n + n - offset) % n;
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+size_t KFoldCV<MLAlgorithm,
+               Metric,
+               MatType,
+               PredictionsType,
+               WeightsType>::NumberOfTrainingPoints() const
+{
+  if (trainingFraction >= 1.0)
+    return trainingSubsetSize;
+
+  return std::max((size_t) round(trainingSubsetSize * trainingFraction),
+      (size_t) 1);
 }
 
 template<typename MLAlgorithm,
@@ -294,11 +456,10 @@ arma::Mat<ElementType> KFoldCV<MLAlgorithm,
                                MatType,
                                PredictionsType,
                                WeightsType>::GetTrainingSubset(
-    arma::Mat<ElementType>& m,
-    const size_t i)
+    arma::Mat<ElementType>& m)
 {
-  return arma::Mat<ElementType>(m.colptr(binSize * i), m.n_rows,
-      trainingSubsetSize, false, true);
+  return arma::Mat<ElementType>(m.memptr(), m.n_rows,
+      NumberOfTrainingPoints(), false, true);
 }
 
 template<typename MLAlgorithm,
@@ -312,11 +473,59 @@ arma::Row<ElementType> KFoldCV<MLAlgorithm,
                                MatType,
                                PredictionsType,
                                WeightsType>::GetTrainingSubset(
+    arma::Row<ElementType>& r)
+{
+  return arma::Row<ElementType>(r.memptr(), NumberOfTrainingPoints(), false,
+      true);
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename ElementType>
+arma::Mat<ElementType> KFoldCV<MLAlgorithm,
+                               Metric,
+                               MatType,
+                               PredictionsType,
+                               WeightsType>::GetColumns(
+    arma::Mat<ElementType>& m,
+    const size_t first,
+    const size_t count)
+{
+  const size_t n = m.n_cols;
+  if (first + count <= n)
+  {
+    return arma::Mat<ElementType>(m.colptr(first), m.n_rows, count, false,
+        true);
+  }
+
+  return arma::join_rows(m.cols(first, n - 1),
+      m.cols(0, first + count - n - 1));
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename ElementType>
+arma::Row<ElementType> KFoldCV<MLAlgorithm,
+                               Metric,
+                               MatType,
+                               PredictionsType,
+                               WeightsType>::GetColumns(
     arma::Row<ElementType>& r,
-    const size_t i)
+    const size_t first,
+    const size_t count)
 {
-  return arma::Row<ElementType>(r.colptr(binSize * i), trainingSubsetSize,
-      false, true);
+  const size_t n = r.n_elem;
+  if (first + count <= n)
+    return arma::Row<ElementType>(r.colptr(first), count, false, true);
+
+  return arma::join_rows(r.cols(first, n - 1),
+      r.cols(0, first + count - n - 1));
 }
 
 template<typename MLAlgorithm,
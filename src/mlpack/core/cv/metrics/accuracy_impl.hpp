@@ -12,6 +12,7 @@
 #ifndef MLPACK_CORE_CV_METRICS_ACCURACY_IMPL_HPP
 #define MLPACK_CORE_CV_METRICS_ACCURACY_IMPL_HPP
 
+#include <mlpack/core/cv/metrics/confusion_accumulator.hpp>
 #include <mlpack/core/cv/metrics/facilities.hpp>
 
 namespace mlpack {
@@ -24,11 +25,10 @@ double Accuracy::Evaluate(MLAlgorithm& model,
 {
   AssertSizes(data, labels, "Accuracy::Evaluate()");
 
-  arma::Row<size_t> predictedLabels;
-  model.Classify(data, predictedLabels);
-  size_t amountOfCorrectPredictions = arma::sum(predictedLabels == labels);
+  ConfusionAccumulator accumulator;
+  accumulator.Add(model, data, labels);
 
-  return (double) amountOfCorrectPredictions / labels.n_elem;
+  return accumulator.Accuracy();
 }
 
 } // namespace cv
@@ -0,0 +1,155 @@
+/**
+ * @file confusion_accumulator.hpp
+ *
+ * Definition of the ConfusionAccumulator class, which accumulates the
+ * confusion matrix of a classifier over batches of test items.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_METRICS_CONFUSION_ACCUMULATOR_HPP
+#define MLPACK_CORE_CV_METRICS_CONFUSION_ACCUMULATOR_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/cv/metrics/average_strategy.hpp>
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * ConfusionAccumulator counts, for each pair of a true label and a predicted
+ * label, how many test items have been seen.  Batches of test items can be
+ * added one after another, and accumulators that were filled separately (for
+ * example, by different threads; see AccumulateBlocks()) can be merged, so
+ * that a validation set never has to be classified all at once.  All the
+ * classification metrics (Accuracy, Precision, Recall and F1) can then be
+ * computed from the same prediction pass.
+ *
+ * @code
+ * ConfusionAccumulator accumulator;
+ * for (size_t i = 0; i < numBatches; ++i)
+ *   accumulator.Add(model, batches[i], batchLabels[i]);
+ *
+ * const double accuracy = accumulator.Accuracy();
+ * const double f1 = accumulator.F1<Macro>();
+ * @endcode
+ *
+ * The results are the same as with the corresponding metric classes on all of
+ * the test items at once.
+ */
+class ConfusionAccumulator
+{
+ public:
+  /**
+   * Create an empty accumulator.  The number of classes grows with the labels
+   * that are added, so it does not have to be known in advance.
+   *
+   * @param numClasses Number of classes to reserve room for.
+   */
+  ConfusionAccumulator(const size_t numClasses = 0) :
+      counts(numClasses, numClasses, arma::fill::zeros)
+  { }
+
+  /**
+   * Add the given true labels and the labels predicted for them.
+   *
+   * @param labels Ground truth (correct) labels of the test items.
+   * @param predictions Predicted labels of the test items.
+   */
+  void Add(const arma::Row<size_t>& labels,
+           const arma::Row<size_t>& predictions);
+
+  /**
+   * Classify the given test items with the given model, and add the
+   * predictions.
+   *
+   * @param model A classification model.
+   * @param data Column-major data containing test items.
+   * @param labels Ground truth (correct) labels for the test items.
+   */
+  template<typename MLAlgorithm, typename DataType>
+  void Add(MLAlgorithm& model,
+           const DataType& data,
+           const arma::Row<size_t>& labels);
+
+  /**
+   * Add the counts of the given accumulator to this one.
+   *
+   * @param other Accumulator to merge into this one.
+   */
+  void Merge(const ConfusionAccumulator& other);
+
+  //! Forget all of the added test items.
+  void Reset() { counts.zeros(); }
+
+  //! Get the number of classes seen so far (labels or predictions).
+  size_t NumClasses() const { return counts.n_rows; }
+
+  //! Get the number of test items added so far.
+  size_t Count() const { return arma::accu(counts); }
+
+  /**
+   * Get the confusion matrix: the element (i, j) is the number of test items
+   * with the true label i that were predicted as j.
+   */
+  const arma::Mat<size_t>& Counts() const { return counts; }
+
+  //! Get the proportion of correctly labeled test items.
+  double Accuracy() const;
+
+  /**
+   * Get the precision with the given average strategy (see Precision).
+   *
+   * @tparam AS An average strategy.
+   * @tparam PositiveClass The label of the positives, for AS = Binary.
+   */
+  template<AverageStrategy AS, size_t PositiveClass = 1>
+  double Precision() const;
+
+  /**
+   * Get the recall with the given average strategy (see Recall).
+   *
+   * @tparam AS An average strategy.
+   * @tparam PositiveClass The label of the positives, for AS = Binary.
+   */
+  template<AverageStrategy AS, size_t PositiveClass = 1>
+  double Recall() const;
+
+  /**
+   * Get the F1 score with the given average strategy (see F1).
+   *
+   * @tparam AS An average strategy.
+   * @tparam PositiveClass The label of the positives, for AS = Binary.
+   */
+  template<AverageStrategy AS, size_t PositiveClass = 1>
+  double F1() const;
+
+ private:
+  //! The confusion matrix (true labels by rows, predictions by columns).
+  arma::Mat<size_t> counts;
+
+  //! Make room for the given number of classes.
+  void Grow(const size_t numClasses);
+
+  //! Get the number of classes that appear among the true labels.
+  size_t NumLabelClasses() const;
+
+  //! Get the precision of the given class.
+  double ClassPrecision(const size_t c) const;
+
+  //! Get the recall of the given class.
+  double ClassRecall(const size_t c) const;
+
+  //! Get the F1 score of the given class.
+  double ClassF1(const size_t c) const;
+};
+
+} // namespace cv
+} // namespace mlpack
+
+// Include implementation.
+#include "confusion_accumulator_impl.hpp"
+
+#endif
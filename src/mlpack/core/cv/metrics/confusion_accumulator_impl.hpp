@@ -0,0 +1,168 @@
+/**
+ * @file confusion_accumulator_impl.hpp
+ *
+ * Implementation of the ConfusionAccumulator class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_METRICS_CONFUSION_ACCUMULATOR_IMPL_HPP
+#define MLPACK_CORE_CV_METRICS_CONFUSION_ACCUMULATOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "confusion_accumulator.hpp"
+
+#include <mlpack/core/cv/metrics/facilities.hpp>
+
+namespace mlpack {
+namespace cv {
+
+inline void ConfusionAccumulator::Add(const arma::Row<size_t>& labels,
+                                      const arma::Row<size_t>& predictions)
+{
+  if (labels.n_elem != predictions.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "ConfusionAccumulator::Add(): number of labels (" << labels.n_elem
+        << ") does not match number of predictions (" << predictions.n_elem
+        << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (labels.n_elem == 0)
+    return;
+
+  Grow(std::max(arma::max(labels), arma::max(predictions)) + 1);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    ++counts(labels[i], predictions[i]);
+}
+
+template<typename MLAlgorithm, typename DataType>
+void ConfusionAccumulator::Add(MLAlgorithm& model,
+                               const DataType& data,
+                               const arma::Row<size_t>& labels)
+{
+  AssertSizes(data, labels, "ConfusionAccumulator::Add()");
+
+  arma::Row<size_t> predictions;
+  model.Classify(data, predictions);
+  Add(labels, predictions);
+}
+
+inline void ConfusionAccumulator::Merge(const ConfusionAccumulator& other)
+{
+  Grow(other.counts.n_rows);
+  counts.submat(0, 0, arma::size(other.counts)) += other.counts;
+}
+
+inline double ConfusionAccumulator::Accuracy() const
+{
+  return (double) arma::trace(counts) / Count();
+}
+
+template<AverageStrategy AS, size_t PositiveClass>
+double ConfusionAccumulator::Precision() const
+{
+  if (AS == Binary)
+    return ClassPrecision(PositiveClass);
+
+  // Microaveraged precision turns out to be just accuracy.
+  if (AS == Micro)
+    return Accuracy();
+
+  const size_t numClasses = NumLabelClasses();
+  arma::vec precisions(numClasses);
+  for (size_t c = 0; c < numClasses; ++c)
+    precisions(c) = ClassPrecision(c);
+
+  return arma::mean(precisions);
+}
+
+template<AverageStrategy AS, size_t PositiveClass>
+double ConfusionAccumulator::Recall() const
+{
+  if (AS == Binary)
+    return ClassRecall(PositiveClass);
+
+  // Microaveraged recall is really the same as accuracy.
+  if (AS == Micro)
+    return Accuracy();
+
+  const size_t numClasses = NumLabelClasses();
+  arma::vec recalls(numClasses);
+  for (size_t c = 0; c < numClasses; ++c)
+    recalls(c) = ClassRecall(c);
+
+  return arma::mean(recalls);
+}
+
+template<AverageStrategy AS, size_t PositiveClass>
+double ConfusionAccumulator::F1() const
+{
+  if (AS == Binary)
+    return ClassF1(PositiveClass);
+
+  // Microaveraged F1 is the same as microaveraged precision and recall.
+  if (AS == Micro)
+    return Accuracy();
+
+  const size_t numClasses = NumLabelClasses();
+  arma::vec f1s(numClasses);
+  for (size_t c = 0; c < numClasses; ++c)
+    f1s(c) = ClassF1(c);
+
+  return arma::mean(f1s);
+}
+
+inline void ConfusionAccumulator::Grow(const size_t numClasses)
+{
+  if (numClasses <= counts.n_rows)
+    return;
+
+  const size_t oldClasses = counts.n_rows;
+  counts.resize(numClasses, numClasses);
+  counts.tail_rows(numClasses - oldClasses).zeros();
+  counts.tail_cols(numClasses - oldClasses).zeros();
+}
+
+inline size_t ConfusionAccumulator::NumLabelClasses() const
+{
+  // This is the largest true label plus one, as for the metric classes.
+  for (size_t c = counts.n_rows; c > 0; --c)
+    if (arma::accu(counts.row(c - 1)) > 0)
+      return c;
+
+  return 0;
+}
+
+inline double ConfusionAccumulator::ClassPrecision(const size_t c) const
+{
+  if (c >= counts.n_rows)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  return double(counts(c, c)) / arma::accu(counts.col(c));
+}
+
+inline double ConfusionAccumulator::ClassRecall(const size_t c) const
+{
+  if (c >= counts.n_rows)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  return double(counts(c, c)) / arma::accu(counts.row(c));
+}
+
+inline double ConfusionAccumulator::ClassF1(const size_t c) const
+{
+  const double precision = ClassPrecision(c);
+  const double recall = ClassRecall(c);
+
+  return (precision + recall == 0.0) ? 0.0 :
+      2.0 * precision * recall / (precision + recall);
+}
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
@@ -62,43 +62,6 @@ class F1
    * to maximize the metric.
    */
   static const bool NeedsMinimization = false;
-
- private:
-  /**
-   * Run classification and calculate F1 for binary classification.
-   */
-  template<AverageStrategy _AS,
-           typename MLAlgorithm,
-           typename DataType,
-           typename = std::enable_if_t<_AS == Binary>>
-  static double Evaluate(MLAlgorithm& model,
-                        const DataType& data,
-                        const arma::Row<size_t>& labels);
-
-  /**
-   * Run classification and calculate microaveraged F1.
-   */
-  template<AverageStrategy _AS,
-           typename MLAlgorithm,
-           typename DataType,
-           typename = std::enable_if_t<_AS == Micro>,
-           typename = void>
-  static double Evaluate(MLAlgorithm& model,
-                        const DataType& data,
-                        const arma::Row<size_t>& labels);
-
-  /**
-   * Run classification and calculate macroaveraged F1.
-   */
-  template<AverageStrategy _AS,
-           typename MLAlgorithm,
-           typename DataType,
-           typename = std::enable_if_t<_AS == Macro>,
-           typename = void,
-           typename = void>
-  static double Evaluate(MLAlgorithm& model,
-                        const DataType& data,
-                        const arma::Row<size_t>& labels);
 };
 
 } // namespace cv
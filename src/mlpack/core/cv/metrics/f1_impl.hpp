@@ -12,7 +12,7 @@
 #ifndef MLPACK_CORE_CV_METRICS_F1_IMPL_HPP
 #define MLPACK_CORE_CV_METRICS_F1_IMPL_HPP
 
-#include <mlpack/core/cv/metrics/accuracy.hpp>
+#include <mlpack/core/cv/metrics/confusion_accumulator.hpp>
 #include <mlpack/core/cv/metrics/facilities.hpp>
 
 namespace mlpack {
@@ -24,73 +24,12 @@ double F1<AS, PC>::Evaluate(MLAlgorithm& model,
                             const DataType& data,
                             const arma::Row<size_t>& labels)
 {
-  return Evaluate<AS>(model, data, labels);
-}
-
-template<AverageStrategy AS, size_t PC /* PositiveClass */>
-template<AverageStrategy _AS, typename MLAlgorithm, typename DataType, typename>
-double F1<AS, PC>::Evaluate(MLAlgorithm& model,
-                            const DataType& data,
-                            const arma::Row<size_t>& labels)
-{
-  AssertSizes(data, labels, "F1<Binary>::Evaluate()");
-
-  arma::Row<size_t> predictedLabels;
-  model.Classify(data, predictedLabels);
-
-  size_t tp = arma::sum((labels == PC) % (predictedLabels == PC));
-  size_t numberOfPositivePredictions = arma::sum(predictedLabels == PC);
-  size_t numberOfPositiveClassInstances = arma::sum(labels == PC);
-
-  double precision = double(tp) / numberOfPositivePredictions;
-  double recall = double(tp) / numberOfPositiveClassInstances;
-
-  return (precision + recall == 0.0) ? 0.0 :
-      2.0 * precision * recall / (precision + recall);
-}
-
-template<AverageStrategy AS, size_t PC /* PositiveClass */>
-template<AverageStrategy _AS, typename MLAlgorithm, typename DataType, typename,
-    typename>
-double F1<AS, PC>::Evaluate(MLAlgorithm& model,
-                            const DataType& data,
-                            const arma::Row<size_t>& labels)
-{
-  AssertSizes(data, labels, "F1<Micro>::Evaluate()");
-
-  // Microaveraged F1 is really the same as microaveraged precision and
-  // microaveraged recall, which are in turn the same as accuracy.
-  return Accuracy::Evaluate(model, data, labels);
-}
-
-template<AverageStrategy AS, size_t PC /* PositiveClass */>
-template<AverageStrategy _AS, typename MLAlgorithm, typename DataType, typename,
-    typename, typename>
-double F1<AS, PC>::Evaluate(MLAlgorithm& model,
-                            const DataType& data,
-                            const arma::Row<size_t>& labels)
-{
-  AssertSizes(data, labels, "F1<Macro>::Evaluate()");
-
-  arma::Row<size_t> predictedLabels;
-  model.Classify(data, predictedLabels);
-
-  size_t numClasses = arma::max(labels) + 1;
-
-  arma::vec f1s = arma::vec(numClasses);
-  for (size_t c = 0; c < numClasses; ++c)
-  {
-    size_t tp = arma::sum((labels == c) % (predictedLabels == c));
-    size_t numberOfPositivePredictions = arma::sum(predictedLabels == c);
-    size_t numberOfClassInstances = arma::sum(labels == c);
+  AssertSizes(data, labels, "F1::Evaluate()");
 
-    double precision = double(tp) / numberOfPositivePredictions;
-    double recall = double(tp) / numberOfClassInstances;
-    f1s(c) = (precision + recall == 0.0) ? 0.0 :
-        2.0 * precision * recall / (precision + recall);
-  }
+  ConfusionAccumulator accumulator;
+  accumulator.Add(model, data, labels);
 
-  return arma::mean(f1s);
+  return accumulator.F1<AS, PC>();
 }
 
 } // namespace cv
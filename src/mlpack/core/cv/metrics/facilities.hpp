@@ -40,6 +40,64 @@ void AssertSizes(const DataType& data,
   }
 }
 
+/**
+ * Add the test items of the given blocks of columns (see
+ * data::MatrixColumnBlocks) to the given accumulator (ConfusionAccumulator or
+ * RegressionAccumulator), predicting with the given model.  The blocks are read
+ * and predicted in parallel, each thread adding to its own accumulator, and the
+ * accumulators are merged at the end, so only one block per thread is held in
+ * memory at once.  Classify() or Predict() of the model must be safe to call
+ * from several threads at once then, which is the case for the const methods
+ * of the mlpack models.
+ *
+ * @param accumulator Accumulator to add the test items to.
+ * @param model A classification or regression model.
+ * @param blocks Blocks of the column-major test items (of double elements).
+ * @param labels Ground truth (correct) labels or responses of all test items.
+ */
+template<typename AccumulatorType,
+         typename MLAlgorithm,
+         typename BlocksType,
+         typename LabelsType>
+void AccumulateBlocks(AccumulatorType& accumulator,
+                      MLAlgorithm& model,
+                      const BlocksType& blocks,
+                      const LabelsType& labels)
+{
+  if (blocks.Cols() != labels.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "AccumulateBlocks(): number of points (" << blocks.Cols() << ") "
+        << "does not match number of labels (" << labels.n_cols << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Each chunk is a range of the blocks.
+  ReductionPartials<AccumulatorType> partials(blocks.NumBlocks(),
+      AccumulatorType(), 0, 1);
+
+  #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads())
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
+  {
+    AccumulatorType& chunkAccumulator = partials.Partial(chunk);
+    arma::mat block;
+    for (size_t b = partials.Begin(chunk); b < partials.End(chunk); ++b)
+    {
+      blocks.ReadBlock(b, block);
+      const size_t begin = b * blocks.BlockSize();
+      const LabelsType blockLabels = labels.cols(begin,
+          begin + block.n_cols - 1);
+      chunkAccumulator.Add(model, block, blockLabels);
+    }
+  }
+
+  AccumulatorType blocksAccumulator;
+  partials.Reduce(blocksAccumulator,
+      [](AccumulatorType& a, const AccumulatorType& b) { a.Merge(b); });
+  accumulator.Merge(blocksAccumulator);
+}
+
 } // namespace cv
 } // namespace mlpack
 
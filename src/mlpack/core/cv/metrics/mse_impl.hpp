@@ -12,6 +12,8 @@
 #ifndef MLPACK_CORE_CV_METRICS_MSE_IMPL_HPP
 #define MLPACK_CORE_CV_METRICS_MSE_IMPL_HPP
 
+#include <mlpack/core/cv/metrics/regression_accumulator.hpp>
+
 namespace mlpack {
 namespace cv {
 
@@ -29,11 +31,10 @@ double MSE::Evaluate(MLAlgorithm& model,
     throw std::invalid_argument(oss.str());
   }
 
-  ResponsesType predictedResponses;
-  model.Predict(data, predictedResponses);
-  double sum = arma::accu(arma::square(responses - predictedResponses));
+  RegressionAccumulator accumulator;
+  accumulator.Add(model, data, responses);
 
-  return sum / responses.n_elem;
+  return accumulator.MSE();
 }
 
 } // namespace cv
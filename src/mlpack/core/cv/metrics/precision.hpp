@@ -65,43 +65,6 @@ class Precision
    * to maximize the metric.
    */
   static const bool NeedsMinimization = false;
-
- private:
-  /**
-   * Run classification and calculate precision for binary classification.
-   */
-  template<AverageStrategy _AS,
-           typename MLAlgorithm,
-           typename DataType,
-           typename = std::enable_if_t<_AS == Binary>>
-  static double Evaluate(MLAlgorithm& model,
-                        const DataType& data,
-                        const arma::Row<size_t>& labels);
-
-  /**
-   * Run classification and calculate microaveraged precision.
-   */
-  template<AverageStrategy _AS,
-           typename MLAlgorithm,
-           typename DataType,
-           typename = std::enable_if_t<_AS == Micro>,
-           typename = void>
-  static double Evaluate(MLAlgorithm& model,
-                        const DataType& data,
-                        const arma::Row<size_t>& labels);
-
-  /**
-   * Run classification and calculate macroaveraged precision.
-   */
-  template<AverageStrategy _AS,
-           typename MLAlgorithm,
-           typename DataType,
-           typename = std::enable_if_t<_AS == Macro>,
-           typename = void,
-           typename = void>
-  static double Evaluate(MLAlgorithm& model,
-                        const DataType& data,
-                        const arma::Row<size_t>& labels);
 };
 
 } // namespace cv
@@ -12,7 +12,7 @@
 #ifndef MLPACK_CORE_CV_METRICS_RECALL_IMPL_HPP
 #define MLPACK_CORE_CV_METRICS_RECALL_IMPL_HPP
 
-#include <mlpack/core/cv/metrics/accuracy.hpp>
+#include <mlpack/core/cv/metrics/confusion_accumulator.hpp>
 #include <mlpack/core/cv/metrics/facilities.hpp>
 
 namespace mlpack {
@@ -24,62 +24,12 @@ double Recall<AS, PC>::Evaluate(MLAlgorithm& model,
                                 const DataType& data,
                                 const arma::Row<size_t>& labels)
 {
-  return Evaluate<AS>(model, data, labels);
-}
-
-template<AverageStrategy AS, size_t PC /* PositiveClass */>
-template<AverageStrategy _AS, typename MLAlgorithm, typename DataType, typename>
-double Recall<AS, PC>::Evaluate(MLAlgorithm& model,
-                                const DataType& data,
-                                const arma::Row<size_t>& labels)
-{
-  AssertSizes(data, labels, "Recall<Binary>::Evaluate()");
-
-  arma::Row<size_t> predictedLabels;
-  model.Classify(data, predictedLabels);
-
-  size_t tp = arma::sum((labels == PC) % (predictedLabels == PC));
-  size_t numberOfPositiveClassInstances = arma::sum(labels == PC);
-
-  return double(tp) / numberOfPositiveClassInstances;
-}
-
-template<AverageStrategy AS, size_t PC /* PositiveClass */>
-template<AverageStrategy _AS, typename MLAlgorithm, typename DataType, typename,
-    typename>
-double Recall<AS, PC>::Evaluate(MLAlgorithm& model,
-                                const DataType& data,
-                                const arma::Row<size_t>& labels)
-{
-  AssertSizes(data, labels, "Recall<Micro>::Evaluate()");
-
-  // Microaveraged recall is really the same as accuracy.
-  return Accuracy::Evaluate(model, data, labels);
-}
-
-template<AverageStrategy AS, size_t PC /* PositiveClass */>
-template<AverageStrategy _AS, typename MLAlgorithm, typename DataType, typename,
-    typename, typename>
-double Recall<AS, PC>::Evaluate(MLAlgorithm& model,
-                                const DataType& data,
-                                const arma::Row<size_t>& labels)
-{
-  AssertSizes(data, labels, "Recall<Macro>::Evaluate()");
-
-  arma::Row<size_t> predictedLabels;
-  model.Classify(data, predictedLabels);
-
-  size_t numClasses = arma::max(labels) + 1;
+  AssertSizes(data, labels, "Recall::Evaluate()");
 
-  arma::vec recalls = arma::vec(numClasses);
-  for (size_t c = 0; c < numClasses; ++c)
-  {
-    size_t tp = arma::sum((labels == c) % (predictedLabels == c));
-    size_t numberOfClassInstances = arma::sum(labels == c);
-    recalls(c) = double(tp) / numberOfClassInstances;
-  }
+  ConfusionAccumulator accumulator;
+  accumulator.Add(model, data, labels);
 
-  return arma::mean(recalls);
+  return accumulator.Recall<AS, PC>();
 }
 
 } // namespace cv
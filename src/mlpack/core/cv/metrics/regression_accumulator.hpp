@@ -0,0 +1,94 @@
+/**
+ * @file regression_accumulator.hpp
+ *
+ * Definition of the RegressionAccumulator class, which accumulates the moments
+ * of the residuals of a regression model over batches of test items.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_METRICS_REGRESSION_ACCUMULATOR_HPP
+#define MLPACK_CORE_CV_METRICS_REGRESSION_ACCUMULATOR_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * RegressionAccumulator keeps the number, the sum and the sum of squares of
+ * the residuals (responses minus predictions) of the test items that have been
+ * added.  As ConfusionAccumulator does for classifiers, it can be fed batches
+ * of test items and merged with other accumulators, so that the MSE of a
+ * validation set can be computed in constant memory.
+ */
+class RegressionAccumulator
+{
+ public:
+  //! Create an empty accumulator.
+  RegressionAccumulator() : count(0), sum(0.0), squaredSum(0.0) { }
+
+  /**
+   * Add the given responses and the responses predicted for them.
+   *
+   * @param responses Ground truth (correct) responses of the test items.
+   * @param predictions Predicted responses of the test items.
+   */
+  template<typename ResponsesType>
+  void Add(const ResponsesType& responses, const ResponsesType& predictions);
+
+  /**
+   * Predict the responses to the given test items with the given model, and
+   * add the predictions.
+   *
+   * @param model A regression model.
+   * @param data Column-major data containing test items.
+   * @param responses Ground truth (correct) responses for the test items.
+   */
+  template<typename MLAlgorithm, typename DataType, typename ResponsesType>
+  void Add(MLAlgorithm& model,
+           const DataType& data,
+           const ResponsesType& responses);
+
+  /**
+   * Add the moments of the given accumulator to this one.
+   *
+   * @param other Accumulator to merge into this one.
+   */
+  void Merge(const RegressionAccumulator& other)
+  {
+    count += other.count;
+    sum += other.sum;
+    squaredSum += other.squaredSum;
+  }
+
+  //! Forget all of the added test items.
+  void Reset() { count = 0; sum = squaredSum = 0.0; }
+
+  //! Get the number of responses added so far.
+  size_t Count() const { return count; }
+
+  //! Get the mean squared error.
+  double MSE() const { return squaredSum / count; }
+
+  //! Get the mean of the residuals (the bias of the predictions, negated).
+  double MeanResidual() const { return sum / count; }
+
+ private:
+  //! The number of responses.
+  size_t count;
+  //! The sum of the residuals.
+  double sum;
+  //! The sum of the squared residuals.
+  double squaredSum;
+};
+
+} // namespace cv
+} // namespace mlpack
+
+// Include implementation.
+#include "regression_accumulator_impl.hpp"
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file regression_accumulator_impl.hpp
+ *
+ * Implementation of the RegressionAccumulator class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_METRICS_REGRESSION_ACCUMULATOR_IMPL_HPP
+#define MLPACK_CORE_CV_METRICS_REGRESSION_ACCUMULATOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "regression_accumulator.hpp"
+
+namespace mlpack {
+namespace cv {
+
+template<typename ResponsesType>
+void RegressionAccumulator::Add(const ResponsesType& responses,
+                                const ResponsesType& predictions)
+{
+  if (responses.n_elem != predictions.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "RegressionAccumulator::Add(): number of responses ("
+        << responses.n_elem << ") does not match number of predictions ("
+        << predictions.n_elem << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  count += responses.n_elem;
+  sum += arma::accu(responses - predictions);
+  squaredSum += arma::accu(arma::square(responses - predictions));
+}
+
+template<typename MLAlgorithm, typename DataType, typename ResponsesType>
+void RegressionAccumulator::Add(MLAlgorithm& model,
+                                const DataType& data,
+                                const ResponsesType& responses)
+{
+  if (data.n_cols != responses.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "RegressionAccumulator::Add(): number of points (" << data.n_cols
+        << ") does not match number of responses (" << responses.n_cols
+        << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  ResponsesType predictions;
+  model.Predict(data, predictions);
+  Add(responses, predictions);
+}
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
@@ -198,6 +198,15 @@ class SimpleCV
            const size_t numClasses,
            WeightsInType&& weights);
 
+  /**
+   * Copy the given SimpleCV object, including its data and the last trained
+   * model (if any), so that the copy can be used independently, for example
+   * from another thread.
+   *
+   * @param other SimpleCV object to copy.
+   */
+  SimpleCV(const SimpleCV& other);
+
   /**
    * Train on the training set and assess performance on the validation set by
    * using the class Metric.
@@ -211,6 +220,32 @@ class SimpleCV
   //! Access and modify the last trained model.
   MLAlgorithm& Model();
 
+  //! Get the proportion of the training set that is used for training.
+  double TrainingFraction() const { return trainingFraction; }
+  /**
+   * Modify the proportion (between 0 and 1) of the training set that is used
+   * for training; the validation set is not affected.  Only the first points
+   * of the training set are used, so the data should be shuffled.  The default
+   * value is 1.
+   */
+  double& TrainingFraction() { return trainingFraction; }
+
+  /**
+   * Get whether the model is trained starting from the solution of the last
+   * model.  This only has an effect when MLAlgorithm supports warm starts (see
+   * WarmStartTraits).
+   */
+  bool WarmStart() const { return base.WarmStart(); }
+  /**
+   * Modify whether the model is trained starting from the solution of the last
+   * model.  This is used by HyperParameterTuner for sweeps over
+   * regularization paths.
+   */
+  bool& WarmStart() { return base.WarmStart(); }
+
+  //! Forget the last model, so that the next model is trained from scratch.
+  void ResetWarmStart() { base.ResetWarmStart(); }
+
  private:
   //! A short alias for CVBase.
   using Base = CVBase<MLAlgorithm, MatType, PredictionsType, WeightsType>;
@@ -237,6 +272,9 @@ class SimpleCV
   //! The validation predictions.
   PredictionsType validationYs;
 
+  //! The proportion of the training set that is used for training.
+  double trainingFraction;
+
   //! The pointer to the last trained model.
   std::unique_ptr<MLAlgorithm> modelPtr;
 
@@ -269,6 +307,12 @@ class SimpleCV
    */
   size_t CalculateAndAssertNumberOfTrainingPoints(const double validationSize);
 
+  /**
+   * Calculate the number of training points that are used for training
+   * according to the training fraction.
+   */
+  size_t NumberOfUsedTrainingPoints() const;
+
   /**
    * Get the specified submatrix without coping the data.
    */
@@ -143,7 +143,8 @@ SimpleCV<MLAlgorithm,
                                 PIT&& ys) :
     base(std::move(base)),
     xs(std::forward<MIT>(xs)),
-    ys(std::forward<PIT>(ys))
+    ys(std::forward<PIT>(ys)),
+    trainingFraction(1.0)
 {
   Base::AssertDataConsistency(this->xs, this->ys);
 
@@ -182,6 +183,35 @@ SimpleCV<MLAlgorithm,
   trainingWeights = GetSubset(this->weights, 0, trainingXs.n_cols - 1);
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+SimpleCV<MLAlgorithm,
+         Metric,
+         MatType,
+         PredictionsType,
+         WeightsType>::SimpleCV(const SimpleCV& other) :
+    base(other.base),
+    xs(other.xs),
+    ys(other.ys),
+    weights(other.weights),
+    trainingFraction(other.trainingFraction),
+    modelPtr(other.modelPtr ? new MLAlgorithm(*other.modelPtr) : nullptr)
+{
+  // The training and validation sets refer to the data of this object.
+  const size_t numberOfTrainingPoints = other.trainingXs.n_cols;
+
+  trainingXs = GetSubset(xs, 0, numberOfTrainingPoints - 1);
+  trainingYs = GetSubset(ys, 0, numberOfTrainingPoints - 1);
+  if (weights.n_elem > 0)
+    trainingWeights = GetSubset(weights, 0, numberOfTrainingPoints - 1);
+
+  validationXs = GetSubset(xs, numberOfTrainingPoints, xs.n_cols - 1);
+  validationYs = GetSubset(ys, numberOfTrainingPoints, xs.n_cols - 1);
+}
+
 template<typename MLAlgorithm,
          typename Metric,
          typename MatType,
@@ -243,6 +273,24 @@ size_t SimpleCV<MLAlgorithm,
   return trainingPoints;
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+size_t SimpleCV<MLAlgorithm,
+                Metric,
+                MatType,
+                PredictionsType,
+                WeightsType>::NumberOfUsedTrainingPoints() const
+{
+  if (trainingFraction >= 1.0)
+    return trainingXs.n_cols;
+
+  return std::max((size_t) round(trainingXs.n_cols * trainingFraction),
+      (size_t) 1);
+}
+
 template<typename MLAlgorithm,
          typename Metric,
          typename MatType,
@@ -293,7 +341,11 @@ double SimpleCV<MLAlgorithm,
                 PredictionsType,
                 WeightsType>::TrainAndEvaluate(const MLAlgorithmArgs&... args)
 {
-  modelPtr.reset(new MLAlgorithm(base.Train(trainingXs, trainingYs, args...)));
+  const size_t n = NumberOfUsedTrainingPoints();
+  base.PrepareWarmStart(1);
+  modelPtr.reset(new MLAlgorithm(base.TrainFold(0,
+      GetSubset(trainingXs, 0, n - 1), GetSubset(trainingYs, 0, n - 1),
+      args...)));
 
   return Metric::Evaluate(*modelPtr, validationXs, validationYs);
 }
@@ -310,12 +362,18 @@ double SimpleCV<MLAlgorithm,
                 PredictionsType,
                 WeightsType>::TrainAndEvaluate(const MLAlgorithmArgs&... args)
 {
+  const size_t n = NumberOfUsedTrainingPoints();
   if (trainingWeights.n_elem > 0)
-    modelPtr.reset(new MLAlgorithm(
-        base.Train(trainingXs, trainingYs, trainingWeights, args...)));
+    modelPtr.reset(new MLAlgorithm(base.Train(GetSubset(trainingXs, 0, n - 1),
+        GetSubset(trainingYs, 0, n - 1), GetSubset(trainingWeights, 0, n - 1),
+        args...)));
   else
-    modelPtr.reset(new MLAlgorithm(
-        base.Train(trainingXs, trainingYs, args...)));
+  {
+    base.PrepareWarmStart(1);
+    modelPtr.reset(new MLAlgorithm(base.TrainFold(0,
+        GetSubset(trainingXs, 0, n - 1), GetSubset(trainingYs, 0, n - 1),
+        args...)));
+  }
 
   return Metric::Evaluate(*modelPtr, validationXs, validationYs);
 }
@@ -0,0 +1,55 @@
+/**
+ * @file warm_start_traits.hpp
+ *
+ * Definition of the WarmStartTraits class, which tells whether a model can be
+ * trained starting from the solution of a previously trained model.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_WARM_START_TRAITS_HPP
+#define MLPACK_CORE_CV_WARM_START_TRAITS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * WarmStartTraits tells whether the given MLAlgorithm can be trained starting
+ * from the solution of a previously trained model, usually one trained on the
+ * same data with slightly different hyper-parameters (see the WarmStart()
+ * parameter of HyperParameterTuner).  By default models are always trained
+ * from scratch.  An iterative model opts in by specializing this class next to
+ * its definition, with the members
+ *
+ * @code
+ * static const bool Supported = true;
+ *
+ * // Train a model with the given data and constructor arguments, starting
+ * // from the solution of the previous model (if it fits the data).
+ * template<typename MatType, typename PredictionsType, typename... Args>
+ * static MLAlgorithm Train(const MLAlgorithm& previous,
+ *                          const MatType& xs,
+ *                          const PredictionsType& ys,
+ *                          const Args&... args);
+ * @endcode
+ *
+ * The arguments after ys are the ones the trained model would otherwise be
+ * constructed with (including numClasses, for classifiers that take it).
+ *
+ * @tparam MLAlgorithm A machine learning algorithm.
+ */
+template<typename MLAlgorithm>
+struct WarmStartTraits
+{
+  //! Whether MLAlgorithm can be trained from a previous solution.
+  static const bool Supported = false;
+};
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
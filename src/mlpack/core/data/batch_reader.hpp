@@ -0,0 +1,220 @@
+/**
+ * @file batch_reader.hpp
+ *
+ * Definition of the BatchReader class, which reads a dataset from a file in
+ * batches of points, so that datasets larger than the memory can be used with
+ * models that are trained incrementally.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_READER_HPP
+#define MLPACK_CORE_DATA_BATCH_READER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "dataset_mapper.hpp"
+#include "extension.hpp"
+#include "hdf5_dataset.hpp"
+#include "load_arff.hpp"
+#include "load_csv.hpp"
+#include "load_parquet.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Read a dataset from a file in batches of a fixed number of points, with
+ * memory usage that does not depend on the size of the file.  The points are
+ * the columns of the batches, as with data::Load() (which transposes by
+ * default), and strings are mapped with a DatasetMapper the same way
+ * data::Load() maps them.  This allows models that can be trained on one point
+ * or one batch at a time (like HoeffdingTree, NaiveBayesClassifier or models
+ * trained with SGD on each batch) to be trained on datasets that do not fit in
+ * memory.
+ *
+ * The supported types of files are:
+ *
+ *  - CSV, denoted by .csv or .txt, and TSV, denoted by .tsv; each line is a
+ *    point, as for data::Load()
+ *  - ARFF, denoted by .arff
+ *  - Armadillo binary (arma_binary), denoted by .bin, as saved by data::Save()
+ *    (so each row of the stored matrix is a point)
+ *  - Apache Parquet, denoted by .parquet, if mlpack is built with Arrow
+ *    support (see ParquetFile); the file is read one row group at a time
+ *  - HDF5, denoted by .h5, .hdf5, .hdf or .he5, if Armadillo is built with
+ *    HDF5 support, as saved by data::Save() (see HDF5Dataset); each batch is
+ *    read as one hyperslab
+ *
+ * If no DatasetMapper with the right dimensionality is given, one is created:
+ * for CSV files whose MapPolicy needs a first pass (like IncrementPolicy), this
+ * takes one pass over the whole file, line by line, to find the types of the
+ * dimensions.  To load a test set with the mappings of a training set, pass
+ * the DatasetMapper of the training set.
+ *
+ * @code
+ * // The last dimension of the file holds the labels.
+ * data::BatchReader<> reader("train.csv", 10000);
+ * NaiveBayesClassifier<> nbc(reader.Dimensionality() - 1, numClasses);
+ * arma::mat batch;
+ * while (reader.NextBatch(batch))
+ * {
+ *   for (size_t i = 0; i < batch.n_cols; ++i)
+ *   {
+ *     nbc.Train(batch.col(i).head(batch.n_rows - 1),
+ *         (size_t) batch(batch.n_rows - 1, i));
+ *   }
+ * }
+ * @endcode
+ *
+ * @tparam eT Element type of the batches.
+ * @tparam PolicyType Mapping policy of the DatasetMapper.
+ */
+template<typename eT = double, typename PolicyType = IncrementPolicy>
+class BatchReader
+{
+ public:
+  /**
+   * Open the given file for reading in batches, and read its header.  A
+   * std::runtime_error is thrown if the file cannot be opened or read, and a
+   * std::invalid_argument if the dimensionality of the given DatasetMapper
+   * does not match the one of the file.
+   *
+   * @param filename Name of the file to read.
+   * @param batchSize Number of points of each batch.
+   * @param info DatasetMapper to map strings with; if its dimensionality is 0,
+   *     a new one is created for the file.
+   */
+  BatchReader(const std::string& filename,
+              const size_t batchSize = 1024,
+              const DatasetMapper<PolicyType>& info =
+                  DatasetMapper<PolicyType>());
+
+  /**
+   * Read the next batch of points from the file.  The batch has BatchSize()
+   * points, except for the last batch of the file, which may have fewer.  If
+   * there are no points left, the batch is set to have no columns and false is
+   * returned.
+   *
+   * @param batch Matrix to read the points into.
+   * @return Whether any point was read.
+   */
+  bool NextBatch(arma::Mat<eT>& batch);
+
+  /**
+   * Go back to the first point of the file, for example to take another pass
+   * over the data.  The mappings of the DatasetMapper are kept.
+   */
+  void Reset();
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return info.Dimensionality(); }
+
+  //! Get the number of points of each batch.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points of each batch.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of points read since the start (or the last Reset()).
+  size_t PointsRead() const { return pointsRead; }
+
+  //! Get the DatasetMapper of the file.
+  const DatasetMapper<PolicyType>& Info() const { return info; }
+  //! Modify the DatasetMapper of the file (be careful!).
+  DatasetMapper<PolicyType>& Info() { return info; }
+
+ private:
+  //! Set up the DatasetMapper of a CSV file.
+  void InitializeCSV();
+
+  //! Read the header of an Armadillo binary file.
+  void InitializeBinary();
+
+  //! Check the dimensionality of a given DatasetMapper, or create a new one.
+  void InitializeInfo(const size_t dimensionality);
+
+  //! Read the next batch of a CSV file.
+  size_t NextCSVBatch(arma::Mat<eT>& batch);
+
+  //! Read the next batch of an ARFF file.
+  size_t NextARFFBatch(arma::Mat<eT>& batch);
+
+  //! Read the next batch of an Armadillo binary file.
+  size_t NextBinaryBatch(arma::Mat<eT>& batch);
+
+  //! Read the next batch of a Parquet file.
+  size_t NextParquetBatch(arma::Mat<eT>& batch);
+
+  //! Read the next batch of an HDF5 file.
+  size_t NextHDF5Batch(arma::Mat<eT>& batch);
+
+  //! Return whether the file is an HDF5 file.
+  bool IsHDF5() const
+  {
+    return (extension == "h5" || extension == "hdf5" || extension == "hdf" ||
+        extension == "he5");
+  }
+
+  //! Convert the elements in the buffer to the given row of the batch.
+  template<typename StoredType>
+  void ConvertRow(arma::Mat<eT>& batch, const size_t row);
+
+  //! The name of the file.
+  std::string filename;
+  //! The extension of the file.
+  std::string extension;
+  //! The stream of the file.
+  std::ifstream stream;
+  //! The position of the first point in the file.
+  std::streampos dataStart;
+
+  //! The number of points of each batch.
+  size_t batchSize;
+  //! The number of points read since the start.
+  size_t pointsRead;
+  //! The number of lines read since the start of the data (text files).
+  size_t linesRead;
+
+  //! The DatasetMapper of the file.
+  DatasetMapper<PolicyType> info;
+
+  //! The tokenizer of CSV files.
+  std::unique_ptr<LoadCSV> csv;
+  //! The number of lines of the header of ARFF files.
+  size_t headerLines;
+
+  //! The element type code (like "FN008") of Armadillo binary files.
+  std::string elementType;
+  //! The size of an element of Armadillo binary files.
+  size_t elementSize;
+  //! The number of points in Armadillo binary files.
+  size_t numPoints;
+  //! The buffer to read one dimension of a batch of binary files into.
+  std::vector<char> buffer;
+
+#ifdef HAS_ARROW
+  //! The Parquet file.
+  std::unique_ptr<ParquetFile> parquet;
+#endif
+  //! The current row group of Parquet files.
+  arma::Mat<eT> rowGroup;
+  //! The index of the next point of the current row group.
+  size_t rowGroupPoint;
+  //! The index of the next row group.
+  size_t nextRowGroup;
+
+#ifdef ARMA_USE_HDF5
+  //! The dataset of HDF5 files.
+  std::unique_ptr<HDF5Dataset<eT>> hdf5;
+#endif
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_reader_impl.hpp"
+
+#endif
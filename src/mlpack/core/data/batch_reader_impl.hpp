@@ -0,0 +1,407 @@
+/**
+ * @file batch_reader_impl.hpp
+ *
+ * Implementation of the BatchReader class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_READER_IMPL_HPP
+#define MLPACK_CORE_DATA_BATCH_READER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_reader.hpp"
+
+#include <boost/algorithm/string/trim.hpp>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT, typename PolicyType>
+BatchReader<eT, PolicyType>::BatchReader(
+    const std::string& filename,
+    const size_t batchSize,
+    const DatasetMapper<PolicyType>& info) :
+    filename(filename),
+    extension(Extension(filename)),
+    batchSize(batchSize),
+    pointsRead(0),
+    linesRead(0),
+    info(info),
+    headerLines(0),
+    elementSize(0),
+    numPoints(0),
+    rowGroupPoint(0),
+    nextRowGroup(0)
+{
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("BatchReader::BatchReader(): the batch size "
+        "must be positive");
+  }
+
+  // Binary mode keeps the positions of text files consistent too.
+  stream.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    throw std::runtime_error("BatchReader::BatchReader(): cannot open file '" +
+        filename + "'");
+  }
+
+  if (extension == "csv" || extension == "tsv" || extension == "txt")
+  {
+    InitializeCSV();
+  }
+  else if (extension == "arff")
+  {
+    headerLines = LoadARFFHeader(stream, this->info);
+  }
+  else if (extension == "bin")
+  {
+    InitializeBinary();
+  }
+  else if (extension == "parquet")
+  {
+#ifdef HAS_ARROW
+    parquet.reset(new ParquetFile(filename));
+    parquet->InitializeInfo(this->info);
+#else
+    throw std::runtime_error("BatchReader::BatchReader(): cannot read '" +
+        filename + "' as Parquet data, since mlpack was compiled without "
+        "Arrow support (USE_ARROW)");
+#endif
+  }
+  else if (IsHDF5())
+  {
+#ifdef ARMA_USE_HDF5
+    hdf5.reset(new HDF5Dataset<eT>(filename));
+    InitializeInfo(hdf5->Dimensionality());
+#else
+    throw std::runtime_error("BatchReader::BatchReader(): cannot read '" +
+        filename + "' as HDF5 data, since Armadillo was compiled without "
+        "HDF5 support");
+#endif
+  }
+  else
+  {
+    throw std::runtime_error("BatchReader::BatchReader(): unable to detect "
+        "type of '" + filename + "'; incorrect extension?");
+  }
+
+  dataStart = stream.tellg();
+}
+
+template<typename eT, typename PolicyType>
+bool BatchReader<eT, PolicyType>::NextBatch(arma::Mat<eT>& batch)
+{
+  size_t points;
+  if (extension == "arff")
+    points = NextARFFBatch(batch);
+  else if (extension == "bin")
+    points = NextBinaryBatch(batch);
+  else if (extension == "parquet")
+    points = NextParquetBatch(batch);
+  else if (IsHDF5())
+    points = NextHDF5Batch(batch);
+  else
+    points = NextCSVBatch(batch);
+
+  // The last batch may be smaller.
+  if (points < batch.n_cols)
+    batch.resize(batch.n_rows, points);
+
+  pointsRead += points;
+  return (points > 0);
+}
+
+template<typename eT, typename PolicyType>
+void BatchReader<eT, PolicyType>::Reset()
+{
+  stream.clear();
+  stream.seekg(dataStart);
+  pointsRead = 0;
+  linesRead = 0;
+  rowGroup.reset();
+  rowGroupPoint = 0;
+  nextRowGroup = 0;
+}
+
+template<typename eT, typename PolicyType>
+void BatchReader<eT, PolicyType>::InitializeCSV()
+{
+  csv.reset(new LoadCSV(filename, 1));
+
+  // The number of tokens of the first line is the dimensionality.
+  std::string line;
+  size_t dimensionality = 0;
+  if (std::getline(stream, line))
+  {
+    auto ignoreToken = [](const char*, const char*, const size_t) { };
+    dimensionality = csv->ForEachToken(line.data(), line.data() + line.size(),
+        ignoreToken);
+  }
+  stream.clear();
+  stream.seekg(0);
+
+  const bool newInfo = (info.Dimensionality() == 0);
+  InitializeInfo(dimensionality);
+
+  // Take the first pass over the file for a new DatasetMapper, if its policy
+  // needs one.
+  if (newInfo && PolicyType::NeedsFirstPass)
+  {
+    std::string token;
+    auto firstPassMap = [&](const char* begin, const char* end,
+        const size_t index)
+    {
+      // Lines with too many tokens are reported when they are read.
+      if (index >= dimensionality)
+        return;
+
+      token.assign(begin, end);
+      info.template MapFirstPass<eT>(token, index);
+    };
+
+    while (std::getline(stream, line))
+      csv->ForEachToken(line.data(), line.data() + line.size(), firstPassMap);
+
+    stream.clear();
+    stream.seekg(0);
+  }
+}
+
+template<typename eT, typename PolicyType>
+void BatchReader<eT, PolicyType>::InitializeBinary()
+{
+  std::string header;
+  size_t rows = 0;
+  size_t cols = 0;
+  stream >> header >> rows >> cols;
+  // Skip the newline after the size.
+  stream.get();
+
+  const std::string prefix = "ARMA_MAT_BIN_";
+  if (stream.fail() || header.compare(0, prefix.size(), prefix) != 0)
+  {
+    throw std::runtime_error("BatchReader::BatchReader(): '" + filename +
+        "' is not an Armadillo binary file; only arma_binary files can be read "
+        "in batches");
+  }
+
+  elementType = header.substr(prefix.size());
+  if (elementType == "IU001" || elementType == "IS001")
+    elementSize = 1;
+  else if (elementType == "IU002" || elementType == "IS002")
+    elementSize = 2;
+  else if (elementType == "IU004" || elementType == "IS004" ||
+      elementType == "FN004")
+    elementSize = 4;
+  else if (elementType == "IU008" || elementType == "IS008" ||
+      elementType == "FN008")
+    elementSize = 8;
+  else
+  {
+    throw std::runtime_error("BatchReader::BatchReader(): unsupported element "
+        "type '" + elementType + "' in '" + filename + "'");
+  }
+
+  // The matrix was transposed when it was saved, so each row is a point.
+  numPoints = rows;
+  InitializeInfo(cols);
+}
+
+template<typename eT, typename PolicyType>
+void BatchReader<eT, PolicyType>::InitializeInfo(const size_t dimensionality)
+{
+  if (info.Dimensionality() == 0)
+  {
+    // Keep the policy of the given DatasetMapper.
+    PolicyType policy(info.Policy());
+    info = DatasetMapper<PolicyType>(policy, dimensionality);
+  }
+  else if (info.Dimensionality() != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "BatchReader::BatchReader(): given DatasetInfo has dimensionality "
+        << info.Dimensionality() << ", but data has dimensionality "
+        << dimensionality;
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename eT, typename PolicyType>
+size_t BatchReader<eT, PolicyType>::NextCSVBatch(arma::Mat<eT>& batch)
+{
+  batch.set_size(info.Dimensionality(), batchSize);
+
+  size_t points = 0;
+  std::string line;
+  std::string token;
+  auto parseToken = [&](const char* begin, const char* end, const size_t index)
+  {
+    if (index >= batch.n_rows)
+      return;
+
+    token.assign(begin, end);
+    batch(index, points) = info.template MapString<eT>(token, index);
+  };
+
+  while (points < batchSize && std::getline(stream, line))
+  {
+    const size_t tokens = csv->ForEachToken(line.data(),
+        line.data() + line.size(), parseToken);
+
+    // Make sure we got the right number of dimensions.
+    if (tokens != batch.n_rows)
+    {
+      std::ostringstream oss;
+      oss << "BatchReader::NextBatch(): wrong number of dimensions (" << tokens
+          << ") on line " << linesRead << "; should be " << batch.n_rows
+          << " dimensions.";
+      throw std::runtime_error(oss.str());
+    }
+
+    ++linesRead;
+    ++points;
+  }
+
+  return points;
+}
+
+template<typename eT, typename PolicyType>
+size_t BatchReader<eT, PolicyType>::NextARFFBatch(arma::Mat<eT>& batch)
+{
+  batch.set_size(info.Dimensionality(), batchSize);
+
+  size_t points = 0;
+  std::string line;
+  while (points < batchSize && std::getline(stream, line))
+  {
+    const size_t lineNumber = headerLines + linesRead++;
+
+    // Skip empty lines and comments.
+    boost::trim(line);
+    if (line.empty() || line[0] == '%')
+      continue;
+
+    LoadARFFLine(line, batch, points, info, lineNumber);
+    ++points;
+  }
+
+  return points;
+}
+
+template<typename eT, typename PolicyType>
+size_t BatchReader<eT, PolicyType>::NextBinaryBatch(arma::Mat<eT>& batch)
+{
+  const size_t points = std::min(batchSize, numPoints - pointsRead);
+  batch.set_size(info.Dimensionality(), points);
+  buffer.resize(points * elementSize);
+  if (points == 0)
+    return 0;
+
+  // The dimensions are stored one after another, so one contiguous range of
+  // each dimension is read.
+  for (size_t d = 0; d < batch.n_rows; ++d)
+  {
+    stream.clear();
+    stream.seekg(dataStart + std::streamoff((d * numPoints + pointsRead) *
+        elementSize));
+    stream.read(buffer.data(), std::streamsize(buffer.size()));
+    if (!stream)
+    {
+      throw std::runtime_error("BatchReader::NextBatch(): '" + filename +
+          "' is truncated");
+    }
+
+    if (elementType == "IU001")
+      ConvertRow<uint8_t>(batch, d);
+    else if (elementType == "IS001")
+      ConvertRow<int8_t>(batch, d);
+    else if (elementType == "IU002")
+      ConvertRow<uint16_t>(batch, d);
+    else if (elementType == "IS002")
+      ConvertRow<int16_t>(batch, d);
+    else if (elementType == "IU004")
+      ConvertRow<uint32_t>(batch, d);
+    else if (elementType == "IS004")
+      ConvertRow<int32_t>(batch, d);
+    else if (elementType == "FN004")
+      ConvertRow<float>(batch, d);
+    else if (elementType == "IU008")
+      ConvertRow<uint64_t>(batch, d);
+    else if (elementType == "IS008")
+      ConvertRow<int64_t>(batch, d);
+    else
+      ConvertRow<double>(batch, d);
+  }
+
+  return points;
+}
+
+template<typename eT, typename PolicyType>
+size_t BatchReader<eT, PolicyType>::NextParquetBatch(arma::Mat<eT>& batch)
+{
+  batch.set_size(info.Dimensionality(), batchSize);
+
+  size_t points = 0;
+#ifdef HAS_ARROW
+  while (points < batchSize)
+  {
+    // Read the next row group when the current one is used up.
+    if (rowGroupPoint == rowGroup.n_cols)
+    {
+      if (nextRowGroup == parquet->NumRowGroups())
+        break;
+
+      parquet->ReadRowGroup(nextRowGroup++, rowGroup, info);
+      rowGroupPoint = 0;
+      continue;
+    }
+
+    const size_t count = std::min(batchSize - points,
+        (size_t) rowGroup.n_cols - rowGroupPoint);
+    batch.cols(points, points + count - 1) = rowGroup.cols(rowGroupPoint,
+        rowGroupPoint + count - 1);
+    points += count;
+    rowGroupPoint += count;
+  }
+#endif
+
+  return points;
+}
+
+template<typename eT, typename PolicyType>
+size_t BatchReader<eT, PolicyType>::NextHDF5Batch(arma::Mat<eT>& batch)
+{
+  size_t points = 0;
+#ifdef ARMA_USE_HDF5
+  points = std::min(batchSize, hdf5->NumPoints() - pointsRead);
+  hdf5->ReadPoints(pointsRead, points, batch);
+#else
+  batch.set_size(info.Dimensionality(), 0);
+#endif
+
+  return points;
+}
+
+template<typename eT, typename PolicyType>
+template<typename StoredType>
+void BatchReader<eT, PolicyType>::ConvertRow(arma::Mat<eT>& batch,
+                                             const size_t row)
+{
+  for (size_t i = 0; i < batch.n_cols; ++i)
+  {
+    StoredType value;
+    std::memcpy(&value, buffer.data() + i * sizeof(StoredType),
+        sizeof(StoredType));
+    batch(row, i) = eT(value);
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file batch_writer.hpp
+ *
+ * Definition of the BatchWriter class, which writes a dataset to a file in
+ * batches of points, formatting the points of each batch in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_WRITER_HPP
+#define MLPACK_CORE_DATA_BATCH_WRITER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "extension.hpp"
+#include "hdf5_dataset.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Write a dataset to a file in batches of points, so that results (like the
+ * neighbors found for a large set of query points) can be written while the
+ * next batches are computed, without keeping all of them in memory.  The
+ * points are the columns of the batches, and the files can be loaded with
+ * data::Load() (which transposes by default), just like files saved with
+ * data::Save().
+ *
+ * The supported types of files are:
+ *
+ *  - CSV, denoted by .csv, raw ASCII, denoted by .txt, and TSV, denoted by
+ *    .tsv; each line is a point.  The lines of each batch are formatted in
+ *    parallel with OpenMP, and then written in order.  Integers are written as
+ *    integers, and floating-point numbers with as many digits as it takes to
+ *    read back the same value.
+ *  - Armadillo binary (arma_binary), denoted by .bin, as saved by data::Save()
+ *  - HDF5, denoted by .h5, .hdf5, .hdf or .he5, if Armadillo is built with
+ *    HDF5 support (see HDF5Dataset)
+ *
+ * The points of binary files are stored one dimension after another, so the
+ * total number of points must be given for them; each batch is then written
+ * to its place in the file.  Text files can be written without knowing the
+ * number of points.
+ *
+ * @code
+ * data::BatchReader<> reader("queries.csv", 10000);
+ * data::BatchWriter<size_t> writer("neighbors.csv", k);
+ * arma::mat batch;
+ * while (reader.NextBatch(batch))
+ * {
+ *   arma::Mat<size_t> neighbors;
+ *   arma::mat distances;
+ *   knn.Search(batch, k, neighbors, distances);
+ *   writer.WriteBatch(neighbors);
+ * }
+ * writer.Close();
+ * @endcode
+ *
+ * @tparam eT Element type of the batches.
+ */
+template<typename eT = double>
+class BatchWriter
+{
+ public:
+  /**
+   * Create the given file (an existing file is replaced) for writing points of
+   * the given dimensionality in batches.  A std::runtime_error is thrown if
+   * the file cannot be created or its type is not supported, and a
+   * std::invalid_argument if the number of points of a binary file is not
+   * given.
+   *
+   * @param filename Name of the file to write.
+   * @param dimensionality Dimensionality of the points.
+   * @param numPoints Total number of points that will be written, or 0 if it
+   *     is not known (only for text files).
+   */
+  BatchWriter(const std::string& filename,
+              const size_t dimensionality,
+              const size_t numPoints = 0);
+
+  //! The file cannot be shared.
+  BatchWriter(const BatchWriter&) = delete;
+  BatchWriter& operator=(const BatchWriter&) = delete;
+
+  //! Close the file, if Close() was not called.
+  ~BatchWriter();
+
+  /**
+   * Write the points of the given batch (one per column) after the points
+   * that were already written.  A std::invalid_argument is thrown if the
+   * dimensionality of the batch is wrong or if there are more points than
+   * the number of points given to the constructor, and a std::runtime_error
+   * if the file cannot be written.
+   *
+   * @param batch Points to write.
+   */
+  void WriteBatch(const arma::Mat<eT>& batch);
+
+  /**
+   * Close the file.  A std::runtime_error is thrown if the file cannot be
+   * written, or if the number of points given to the constructor has not been
+   * reached.
+   */
+  void Close();
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return dimensionality; }
+
+  //! Get the total number of points, or 0 if it is not known.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the number of points written so far.
+  size_t PointsWritten() const { return pointsWritten; }
+
+ private:
+  //! Write a batch to a text file.
+  void WriteTextBatch(const arma::Mat<eT>& batch);
+
+  //! Write a batch to an Armadillo binary file.
+  void WriteBinaryBatch(const arma::Mat<eT>& batch);
+
+  //! Format the given column of the batch as a line of a text file.
+  void FormatLine(const arma::Mat<eT>& batch,
+                  const size_t col,
+                  std::string& line) const;
+
+  //! Return whether the file is an HDF5 file.
+  bool IsHDF5() const
+  {
+    return (extension == "h5" || extension == "hdf5" || extension == "hdf" ||
+        extension == "he5");
+  }
+
+  //! The name of the file.
+  std::string filename;
+  //! The extension of the file.
+  std::string extension;
+  //! The stream of the file.
+  std::ofstream stream;
+  //! The position of the first element in binary files.
+  std::streampos dataStart;
+  //! The separator of the elements of a line in text files.
+  char separator;
+
+  //! The dimensionality of the points.
+  size_t dimensionality;
+  //! The total number of points, or 0 if it is not known.
+  size_t numPoints;
+  //! The number of points written so far.
+  size_t pointsWritten;
+  //! Whether the file was closed.
+  bool closed;
+
+  //! The formatted lines of the current batch of text files.
+  std::vector<std::string> lines;
+  //! The buffer of one dimension of a batch of binary files.
+  std::vector<eT> buffer;
+
+#ifdef ARMA_USE_HDF5
+  //! The HDF5 dataset.
+  std::unique_ptr<HDF5Dataset<eT>> hdf5;
+#endif
+}; // class BatchWriter
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_writer_impl.hpp"
+
+#endif
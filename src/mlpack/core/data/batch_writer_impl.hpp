@@ -0,0 +1,273 @@
+/**
+ * @file batch_writer_impl.hpp
+ *
+ * Implementation of the BatchWriter class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_WRITER_IMPL_HPP
+#define MLPACK_CORE_DATA_BATCH_WRITER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_writer.hpp"
+
+#include <cstdio>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+BatchWriter<eT>::BatchWriter(const std::string& filename,
+                             const size_t dimensionality,
+                             const size_t numPoints) :
+    filename(filename),
+    extension(Extension(filename)),
+    separator(','),
+    dimensionality(dimensionality),
+    numPoints(numPoints),
+    pointsWritten(0),
+    closed(false)
+{
+  if (extension == "csv" || extension == "tsv" || extension == "txt")
+  {
+    if (extension == "tsv")
+      separator = '\t';
+    else if (extension == "txt")
+      separator = ' ';
+
+    stream.open(filename.c_str(), std::ios::out | std::ios::trunc |
+        std::ios::binary);
+    if (!stream.is_open())
+    {
+      throw std::runtime_error("BatchWriter::BatchWriter(): cannot open file '"
+          + filename + "' for writing");
+    }
+    return;
+  }
+
+  if (extension != "bin" && !IsHDF5())
+  {
+    throw std::runtime_error("BatchWriter::BatchWriter(): cannot determine "
+        "type of '" + filename + "'; incorrect extension?");
+  }
+
+  if (numPoints == 0)
+  {
+    throw std::invalid_argument("BatchWriter::BatchWriter(): the number of "
+        "points must be given to write '" + filename + "' in batches");
+  }
+
+  if (extension == "bin")
+  {
+    stream.open(filename.c_str(), std::ios::out | std::ios::trunc |
+        std::ios::binary);
+    if (!stream.is_open())
+    {
+      throw std::runtime_error("BatchWriter::BatchWriter(): cannot open file '"
+          + filename + "' for writing");
+    }
+
+    // The matrix is stored transposed, as data::Save() does, so each row is a
+    // point.
+    stream << arma::diskio::gen_bin_header(arma::Mat<eT>()) << '\n';
+    stream << numPoints << ' ' << dimensionality << '\n';
+    dataStart = stream.tellp();
+
+    // Give the file its full size, so that the batches can be written to their
+    // places.
+    const size_t bytes = numPoints * dimensionality * sizeof(eT);
+    if (bytes > 0)
+    {
+      stream.seekp(dataStart + std::streamoff(bytes - 1));
+      stream.put(0);
+    }
+
+    if (!stream)
+    {
+      throw std::runtime_error("BatchWriter::BatchWriter(): cannot write to '"
+          + filename + "'");
+    }
+  }
+  else
+  {
+#ifdef ARMA_USE_HDF5
+    hdf5.reset(new HDF5Dataset<eT>(filename, dimensionality, numPoints));
+#else
+    throw std::runtime_error("BatchWriter::BatchWriter(): cannot write '" +
+        filename + "' as HDF5 data, since Armadillo was compiled without HDF5 "
+        "support");
+#endif
+  }
+}
+
+template<typename eT>
+BatchWriter<eT>::~BatchWriter()
+{
+  if (!closed)
+    stream.close();
+}
+
+template<typename eT>
+void BatchWriter<eT>::WriteBatch(const arma::Mat<eT>& batch)
+{
+  if (closed)
+  {
+    throw std::runtime_error("BatchWriter::WriteBatch(): '" + filename +
+        "' was already closed");
+  }
+
+  if (batch.n_rows != dimensionality && batch.n_cols > 0)
+  {
+    std::ostringstream oss;
+    oss << "BatchWriter::WriteBatch(): the batch has dimensionality "
+        << batch.n_rows << ", but the points of '" << filename << "' have "
+        << "dimensionality " << dimensionality;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (numPoints > 0 && pointsWritten + batch.n_cols > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "BatchWriter::WriteBatch(): cannot write " << batch.n_cols
+        << " more points to '" << filename << "', which has " << numPoints
+        << " points of which " << pointsWritten << " were written";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (batch.n_cols == 0)
+    return;
+
+  if (extension == "bin")
+  {
+    WriteBinaryBatch(batch);
+  }
+  else if (IsHDF5())
+  {
+#ifdef ARMA_USE_HDF5
+    hdf5->WritePoints(pointsWritten, batch);
+#endif
+  }
+  else
+  {
+    WriteTextBatch(batch);
+  }
+
+  pointsWritten += batch.n_cols;
+}
+
+template<typename eT>
+void BatchWriter<eT>::Close()
+{
+  if (closed)
+    return;
+
+  closed = true;
+  stream.close();
+#ifdef ARMA_USE_HDF5
+  hdf5.reset();
+#endif
+
+  if (stream.fail())
+  {
+    throw std::runtime_error("BatchWriter::Close(): cannot write to '" +
+        filename + "'");
+  }
+
+  if (numPoints > 0 && pointsWritten != numPoints)
+  {
+    std::ostringstream oss;
+    oss << "BatchWriter::Close(): only " << pointsWritten << " of the "
+        << numPoints << " points of '" << filename << "' were written";
+    throw std::runtime_error(oss.str());
+  }
+}
+
+template<typename eT>
+void BatchWriter<eT>::WriteTextBatch(const arma::Mat<eT>& batch)
+{
+  // Formatting the numbers takes much longer than writing them, so the lines
+  // are formatted in parallel and then written in order.
+  if (lines.size() < batch.n_cols)
+    lines.resize(batch.n_cols);
+
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) batch.n_cols; ++i)
+    FormatLine(batch, (size_t) i, lines[i]);
+
+  for (size_t i = 0; i < batch.n_cols; ++i)
+    stream.write(lines[i].data(), std::streamsize(lines[i].size()));
+
+  if (!stream)
+  {
+    throw std::runtime_error("BatchWriter::WriteBatch(): cannot write to '" +
+        filename + "'");
+  }
+}
+
+template<typename eT>
+void BatchWriter<eT>::WriteBinaryBatch(const arma::Mat<eT>& batch)
+{
+  // The dimensions are stored one after another, so the batch takes one
+  // contiguous range of each dimension.
+  buffer.resize(batch.n_cols);
+  for (size_t d = 0; d < batch.n_rows; ++d)
+  {
+    for (size_t i = 0; i < batch.n_cols; ++i)
+      buffer[i] = batch(d, i);
+
+    stream.seekp(dataStart + std::streamoff((d * numPoints + pointsWritten) *
+        sizeof(eT)));
+    stream.write(reinterpret_cast<const char*>(buffer.data()),
+        std::streamsize(buffer.size() * sizeof(eT)));
+  }
+
+  if (!stream)
+  {
+    throw std::runtime_error("BatchWriter::WriteBatch(): cannot write to '" +
+        filename + "'");
+  }
+}
+
+template<typename eT>
+void BatchWriter<eT>::FormatLine(const arma::Mat<eT>& batch,
+                                 const size_t col,
+                                 std::string& line) const
+{
+  line.clear();
+  char number[32];
+  for (size_t r = 0; r < batch.n_rows; ++r)
+  {
+    if (r > 0)
+      line += separator;
+
+    const eT value = batch(r, col);
+    int length;
+    if (std::is_floating_point<eT>::value)
+    {
+      length = std::snprintf(number, sizeof(number), "%.*g",
+          std::numeric_limits<eT>::max_digits10, (double) value);
+    }
+    else if (std::is_signed<eT>::value)
+    {
+      length = std::snprintf(number, sizeof(number), "%lld",
+          (long long) value);
+    }
+    else
+    {
+      length = std::snprintf(number, sizeof(number), "%llu",
+          (unsigned long long) value);
+    }
+
+    line.append(number, (size_t) length);
+  }
+
+  line += '\n';
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -86,6 +86,58 @@ void Binarize(const arma::Mat<T>& input,
     output(dimension, i) = input(dimension, i) > threshold;
 }
 
+/**
+ * Given a dataset and threshold, set values greater than threshold to 1 and
+ * values less than or equal to the threshold to 0, in place.  This overload
+ * applies the changes to all dimensions, without allocating a second matrix.
+ *
+ * @code
+ * arma::Mat<double> data = loadData();
+ *
+ * // Binarize the whole matrix in place, with a threshold of 0.5.
+ * Binarize<double>(data, 0.5);
+ * @endcode
+ *
+ * @param data Matrix to binarize.
+ * @param threshold Threshold can by any number.
+ */
+template<typename T>
+void Binarize(arma::Mat<T>& data, const double threshold)
+{
+  T *ptr = data.memptr();
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_elem; ++i)
+    ptr[i] = ptr[i] > threshold;
+}
+
+/**
+ * Given a dataset and threshold, set values greater than threshold to 1 and
+ * values less than or equal to the threshold to 0, in place.  This overload
+ * takes a dimension and only applies the changes to (and only touches) that
+ * dimension, so the rest of the matrix is not copied.
+ *
+ * @code
+ * arma::Mat<double> data = loadData();
+ *
+ * // Binarize the first dimension in place, with a threshold of 0.5.
+ * Binarize<double>(data, 0.5, 0);
+ * @endcode
+ *
+ * @param data Matrix to binarize.
+ * @param threshold Threshold can by any number.
+ * @param dimension Feature to apply the Binarize function.
+ */
+template<typename T>
+void Binarize(arma::Mat<T>& data,
+              const double threshold,
+              const size_t dimension)
+{
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+    data(dimension, i) = data(dimension, i) > threshold;
+}
+
 } // namespace data
 } // namespace mlpack
 
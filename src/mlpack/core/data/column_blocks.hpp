@@ -0,0 +1,220 @@
+/**
+ * @file column_blocks.hpp
+ *
+ * Definition of the MatrixColumnBlocks and HDF5ColumnBlocks classes, which
+ * give access to a matrix one block of columns at a time, and of matrix
+ * products computed in parallel passes over those blocks.  They are used to
+ * decompose matrices that are memory-mapped or stored in HDF5 files, without
+ * holding more than a few blocks of columns in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_COLUMN_BLOCKS_HPP
+#define MLPACK_CORE_DATA_COLUMN_BLOCKS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "hdf5_dataset.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The blocks of columns of a matrix in memory, or of a memory-mapped matrix
+ * (see MappedMatrix).  Each block is copied out of the matrix when it is read,
+ * so for a mapped matrix only the pages of the blocks being used have to be in
+ * memory.
+ *
+ * Any class with the same methods (Rows(), Cols(), BlockSize(), NumBlocks()
+ * and ReadBlock(), which may be called by several threads at once) can be used
+ * with the ColumnBlock*() functions below.  The matrices given to those
+ * functions must have the element type of the blocks.
+ *
+ * @code
+ * data::MappedMatrix<> mapped("data.bin");
+ * data::MatrixColumnBlocks<> blocks(mapped.Matrix(), 10000);
+ *
+ * svd::RandomizedSVD rsvd;
+ * arma::mat u, v;
+ * arma::vec s;
+ * rsvd.ApplyBlocks(blocks, u, s, v, 20);
+ * @endcode
+ *
+ * @tparam eT Element type of the matrix.
+ */
+template<typename eT = double>
+class MatrixColumnBlocks
+{
+ public:
+  /**
+   * Split the given matrix into blocks of the given number of columns.  The
+   * matrix is not copied, so it must outlive this object.
+   *
+   * @param matrix Matrix to split.
+   * @param blockSize Number of columns of each block (the last one may have
+   *     less).
+   */
+  MatrixColumnBlocks(const arma::Mat<eT>& matrix,
+                     const size_t blockSize = 4096) :
+      matrix(matrix),
+      blockSize(blockSize)
+  {
+    if (blockSize == 0)
+    {
+      throw std::invalid_argument("MatrixColumnBlocks: the block size must be "
+          "positive");
+    }
+  }
+
+  //! Get the number of rows of the matrix.
+  size_t Rows() const { return matrix.n_rows; }
+  //! Get the number of columns of the matrix.
+  size_t Cols() const { return matrix.n_cols; }
+  //! Get the number of columns of each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Get the number of blocks.
+  size_t NumBlocks() const
+  { return (matrix.n_cols + blockSize - 1) / blockSize; }
+
+  /**
+   * Copy the columns of the given block into the given matrix.
+   *
+   * @param block Index of the block.
+   * @param columns Matrix to store the columns in.
+   */
+  void ReadBlock(const size_t block, arma::Mat<eT>& columns) const
+  {
+    const size_t begin = block * blockSize;
+    const size_t end = std::min((size_t) matrix.n_cols, begin + blockSize) - 1;
+    columns = matrix.cols(begin, end);
+  }
+
+ private:
+  //! The matrix.
+  const arma::Mat<eT>& matrix;
+  //! The number of columns of each block.
+  size_t blockSize;
+};
+
+#ifdef ARMA_USE_HDF5
+
+/**
+ * The blocks of columns (points) of a dataset in an HDF5 file (see
+ * HDF5Dataset).  Each block is read from the file when it is needed; the
+ * dataset should be chunked by a divisor of the block size, so that each block
+ * is read from its own chunks.
+ *
+ * @tparam eT Element type of the points in memory.
+ */
+template<typename eT = double>
+class HDF5ColumnBlocks
+{
+ public:
+  /**
+   * Split the points of the given dataset into blocks of the given number of
+   * points.  The dataset must outlive this object.
+   *
+   * @param dataset Dataset to split.
+   * @param blockSize Number of points of each block (the last one may have
+   *     less).
+   */
+  HDF5ColumnBlocks(const HDF5Dataset<eT>& dataset,
+                   const size_t blockSize = 4096) :
+      dataset(dataset),
+      blockSize(blockSize)
+  {
+    if (blockSize == 0)
+    {
+      throw std::invalid_argument("HDF5ColumnBlocks: the block size must be "
+          "positive");
+    }
+  }
+
+  //! Get the number of rows (dimensionality) of the matrix.
+  size_t Rows() const { return dataset.Dimensionality(); }
+  //! Get the number of columns (points) of the matrix.
+  size_t Cols() const { return dataset.NumPoints(); }
+  //! Get the number of columns of each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Get the number of blocks.
+  size_t NumBlocks() const { return (Cols() + blockSize - 1) / blockSize; }
+
+  /**
+   * Read the points of the given block into the given matrix.
+   *
+   * @param block Index of the block.
+   * @param columns Matrix to store the points in.
+   */
+  void ReadBlock(const size_t block, arma::Mat<eT>& columns) const
+  {
+    const size_t begin = block * blockSize;
+    dataset.ReadPoints(begin, std::min(blockSize, Cols() - begin), columns);
+  }
+
+ private:
+  //! The dataset.
+  const HDF5Dataset<eT>& dataset;
+  //! The number of points of each block.
+  size_t blockSize;
+};
+
+#endif
+
+/**
+ * Compute the sum of the columns of a matrix, in one pass over its blocks.
+ *
+ * @param blocks Blocks of the matrix.
+ * @param sums Vector to store the sum of each row in.
+ */
+template<typename BlocksType, typename eT>
+void ColumnBlockSums(const BlocksType& blocks, arma::Col<eT>& sums);
+
+/**
+ * Compute A * x, for the matrix A of the given blocks, in one pass over the
+ * blocks.  x must have one row per column of A.
+ *
+ * @param blocks Blocks of the matrix A.
+ * @param x Matrix to multiply A with.
+ * @param result Matrix to store A * x in.
+ */
+template<typename BlocksType, typename eT>
+void ColumnBlockMultiply(const BlocksType& blocks,
+                         const arma::Mat<eT>& x,
+                         arma::Mat<eT>& result);
+
+/**
+ * Compute A^T * y, for the matrix A of the given blocks, in one pass over the
+ * blocks.  y must have one row per row of A.
+ *
+ * @param blocks Blocks of the matrix A.
+ * @param y Matrix to multiply A^T with.
+ * @param result Matrix to store A^T * y in.
+ */
+template<typename BlocksType, typename eT>
+void ColumnBlockTransMultiply(const BlocksType& blocks,
+                              const arma::Mat<eT>& y,
+                              arma::Mat<eT>& result);
+
+/**
+ * Compute A * A^T * y, for the matrix A of the given blocks, in one pass over
+ * the blocks (A^T * y is never formed).  y must have one row per row of A.
+ *
+ * @param blocks Blocks of the matrix A.
+ * @param y Matrix to multiply A * A^T with.
+ * @param result Matrix to store A * A^T * y in.
+ */
+template<typename BlocksType, typename eT>
+void ColumnBlockGramMultiply(const BlocksType& blocks,
+                             const arma::Mat<eT>& y,
+                             arma::Mat<eT>& result);
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "column_blocks_impl.hpp"
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file column_blocks_impl.hpp
+ *
+ * Implementation of the matrix products computed in passes over blocks of
+ * columns.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_COLUMN_BLOCKS_IMPL_HPP
+#define MLPACK_CORE_DATA_COLUMN_BLOCKS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "column_blocks.hpp"
+
+namespace mlpack {
+namespace data {
+
+template<typename BlocksType, typename eT>
+void ColumnBlockSums(const BlocksType& blocks, arma::Col<eT>& sums)
+{
+  sums.zeros(blocks.Rows());
+
+  #pragma omp parallel
+  {
+    arma::Col<eT> localSums(blocks.Rows(), arma::fill::zeros);
+    arma::Mat<eT> columns;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) blocks.NumBlocks(); ++b)
+    {
+      blocks.ReadBlock(b, columns);
+      localSums += arma::sum(columns, 1);
+    }
+
+    #pragma omp critical
+    sums += localSums;
+  }
+}
+
+template<typename BlocksType, typename eT>
+void ColumnBlockMultiply(const BlocksType& blocks,
+                         const arma::Mat<eT>& x,
+                         arma::Mat<eT>& result)
+{
+  if (x.n_rows != blocks.Cols())
+  {
+    std::ostringstream oss;
+    oss << "ColumnBlockMultiply(): the matrix has " << blocks.Cols()
+        << " columns, but the other matrix has " << x.n_rows << " rows";
+    throw std::invalid_argument(oss.str());
+  }
+
+  result.zeros(blocks.Rows(), x.n_cols);
+
+  // Each thread sums the products of its blocks with the rows of x that they
+  // multiply.
+  #pragma omp parallel
+  {
+    arma::Mat<eT> localResult(blocks.Rows(), x.n_cols, arma::fill::zeros);
+    arma::Mat<eT> columns;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) blocks.NumBlocks(); ++b)
+    {
+      blocks.ReadBlock(b, columns);
+      const size_t begin = b * blocks.BlockSize();
+      localResult += columns * x.rows(begin, begin + columns.n_cols - 1);
+    }
+
+    #pragma omp critical
+    result += localResult;
+  }
+}
+
+template<typename BlocksType, typename eT>
+void ColumnBlockTransMultiply(const BlocksType& blocks,
+                              const arma::Mat<eT>& y,
+                              arma::Mat<eT>& result)
+{
+  if (y.n_rows != blocks.Rows())
+  {
+    std::ostringstream oss;
+    oss << "ColumnBlockTransMultiply(): the matrix has " << blocks.Rows()
+        << " rows, but the other matrix has " << y.n_rows;
+    throw std::invalid_argument(oss.str());
+  }
+
+  result.set_size(blocks.Cols(), y.n_cols);
+
+  // Each block gives its own rows of the result.
+  #pragma omp parallel
+  {
+    arma::Mat<eT> columns;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) blocks.NumBlocks(); ++b)
+    {
+      blocks.ReadBlock(b, columns);
+      const size_t begin = b * blocks.BlockSize();
+      result.rows(begin, begin + columns.n_cols - 1) = columns.t() * y;
+    }
+  }
+}
+
+template<typename BlocksType, typename eT>
+void ColumnBlockGramMultiply(const BlocksType& blocks,
+                             const arma::Mat<eT>& y,
+                             arma::Mat<eT>& result)
+{
+  if (y.n_rows != blocks.Rows())
+  {
+    std::ostringstream oss;
+    oss << "ColumnBlockGramMultiply(): the matrix has " << blocks.Rows()
+        << " rows, but the other matrix has " << y.n_rows;
+    throw std::invalid_argument(oss.str());
+  }
+
+  result.zeros(blocks.Rows(), y.n_cols);
+
+  // A * A^T = sum of B * B^T over the blocks B.
+  #pragma omp parallel
+  {
+    arma::Mat<eT> localResult(blocks.Rows(), y.n_cols, arma::fill::zeros);
+    arma::Mat<eT> columns;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) blocks.NumBlocks(); ++b)
+    {
+      blocks.ReadBlock(b, columns);
+      localResult += columns * (columns.t() * y);
+    }
+
+    #pragma omp critical
+    result += localResult;
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file curve_order.hpp
+ *
+ * Reordering of the columns of a dataset along a space-filling curve (the
+ * Z-order curve or the Hilbert curve), so that points that are close to each
+ * other are also close in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_CURVE_ORDER_HPP
+#define MLPACK_CORE_DATA_CURVE_ORDER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+//! The space-filling curves that a dataset can be ordered along.
+enum CurveType
+{
+  //! The Z-order (Morton) curve, which interleaves the bits of the
+  //! coordinates.
+  Z_ORDER_CURVE,
+  //! The Hilbert curve, which has better locality but is slower to compute.
+  HILBERT_CURVE
+};
+
+/**
+ * Compute the order of the points of the dataset along the given space-filling
+ * curve, without modifying the dataset.  Element i of oldFromNew is the index
+ * of the point that is i'th along the curve.
+ *
+ * The curve covers the bounding box of the dataset: each coordinate is first
+ * scaled to [1, 2), where the representation of a double is linear, and then
+ * the addresses of the UB tree (see bound::addr::PointToAddress()) or the
+ * Hilbert values of the Hilbert R tree (see tree::DiscreteHilbertValue) of the
+ * scaled points are sorted.  Points with the same value keep their order, so
+ * the order does not depend on the number of threads.
+ *
+ * @param dataset Dataset to order (dense; one point per column).
+ * @param oldFromNew Vector to store the order of the points in.
+ * @param curve Curve to order the points along.
+ */
+template<typename MatType>
+void ComputeCurveOrder(const MatType& dataset,
+                       std::vector<size_t>& oldFromNew,
+                       const CurveType curve = HILBERT_CURVE);
+
+/**
+ * Reorder the columns of the dataset along the given space-filling curve (see
+ * ComputeCurveOrder()), so that algorithms that scan the dataset, like naive
+ * k-means or brute-force search, access points that are close to each other
+ * from memory that is close too.  The columns are moved in place.  Results
+ * computed on the reordered dataset can be mapped back to the original order of
+ * the points with UnmapColumns() and UnmapIndices().
+ *
+ * @code
+ * std::vector<size_t> oldFromNew;
+ * data::ReorderByCurve(dataset, oldFromNew);
+ *
+ * arma::Row<size_t> assignments;
+ * kmeans.Cluster(dataset, clusters, assignments);
+ * data::UnmapColumns(assignments, oldFromNew);
+ * @endcode
+ *
+ * @param dataset Dataset to reorder (dense; one point per column).
+ * @param oldFromNew Vector to store the original index of each column in.
+ * @param curve Curve to order the points along.
+ */
+template<typename MatType>
+void ReorderByCurve(MatType& dataset,
+                    std::vector<size_t>& oldFromNew,
+                    const CurveType curve = HILBERT_CURVE);
+
+/**
+ * Move the columns of a matrix that were computed in the order given by
+ * oldFromNew (for instance, the assignments of the points of a reordered
+ * dataset) back to the original order, so that column oldFromNew[i] of the
+ * result is column i of the input.  The columns are moved in place.  This also
+ * undoes ReorderByCurve() on the dataset itself.
+ *
+ * @param data Matrix (or row vector) to reorder, with oldFromNew.size()
+ *     columns.
+ * @param oldFromNew The original index of each column.
+ */
+template<typename MatType>
+void UnmapColumns(MatType& data, const std::vector<size_t>& oldFromNew);
+
+/**
+ * Replace indices of points of a reordered dataset (for instance, the
+ * neighbors found by a search of the reordered dataset) by the original indices
+ * of the points.
+ *
+ * @param indices Indices to map.
+ * @param oldFromNew The original index of each point.
+ */
+inline void UnmapIndices(arma::Mat<size_t>& indices,
+                         const std::vector<size_t>& oldFromNew);
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "curve_order_impl.hpp"
+
+#endif
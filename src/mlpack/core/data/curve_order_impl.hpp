@@ -0,0 +1,196 @@
+/**
+ * @file curve_order_impl.hpp
+ *
+ * Implementation of the reordering of datasets along space-filling curves.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_CURVE_ORDER_IMPL_HPP
+#define MLPACK_CORE_DATA_CURVE_ORDER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "curve_order.hpp"
+
+#include <mlpack/core/tree/address.hpp>
+#include <mlpack/core/tree/rectangle_tree/discrete_hilbert_value.hpp>
+
+namespace mlpack {
+namespace data {
+
+namespace details {
+
+/**
+ * Move the columns of the matrix in place, so that column i becomes what was
+ * column sourceOf[i], by following the cycles of the permutation.
+ */
+template<typename MatType>
+void PermuteColumns(MatType& data, const std::vector<size_t>& sourceOf)
+{
+  static_assert(!arma::is_SpMat<MatType>::value, "the columns of sparse "
+      "matrices cannot be reordered in place");
+
+  std::vector<bool> done(sourceOf.size(), false);
+  arma::Mat<typename MatType::elem_type> first;
+  for (size_t start = 0; start < sourceOf.size(); ++start)
+  {
+    if (done[start] || sourceOf[start] == start)
+      continue;
+
+    first = data.col(start);
+    size_t i = start;
+    while (sourceOf[i] != start)
+    {
+      data.col(i) = data.col(sourceOf[i]);
+      done[i] = true;
+      i = sourceOf[i];
+    }
+
+    data.col(i) = first;
+    done[i] = true;
+  }
+}
+
+} // namespace details
+
+template<typename MatType>
+void ComputeCurveOrder(const MatType& dataset,
+                       std::vector<size_t>& oldFromNew,
+                       const CurveType curve)
+{
+  static_assert(!arma::is_SpMat<MatType>::value, "ComputeCurveOrder() needs a "
+      "dense dataset");
+
+  const size_t n = dataset.n_cols;
+  const size_t d = dataset.n_rows;
+  oldFromNew.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    oldFromNew[i] = i;
+
+  if (n < 2 || d == 0)
+    return;
+
+  // The curve covers the bounding box of the dataset.
+  const arma::vec lo = arma::conv_to<arma::vec>::from(arma::min(dataset, 1));
+  const arma::vec hi = arma::conv_to<arma::vec>::from(arma::max(dataset, 1));
+  arma::vec scale(d);
+  for (size_t k = 0; k < d; ++k)
+    scale[k] = (hi[k] > lo[k]) ? 1.0 / (hi[k] - lo[k]) : 0.0;
+
+  // Each coordinate is scaled to [1, 2), where all doubles have the same
+  // exponent and the mantissa is linear in the value, so the addresses and
+  // Hilbert values are those of a uniform grid.
+  const double below2 = std::nextafter(2.0, 1.0);
+  arma::Mat<uint64_t> keys(d, n);
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+  {
+    arma::vec point(d);
+    for (size_t k = 0; k < d; ++k)
+    {
+      const double t = ((double) dataset(k, i) - lo[k]) * scale[k];
+      point[k] = std::min(1.0 + std::max(0.0, std::min(t, 1.0)), below2);
+    }
+
+    if (curve == Z_ORDER_CURVE)
+    {
+      arma::Col<uint64_t> address(d);
+      bound::addr::PointToAddress(address, point);
+      keys.col(i) = address;
+    }
+    else
+    {
+      keys.col(i) = tree::DiscreteHilbertValue<double>::CalculateValue(point);
+    }
+  }
+
+  // Points with the same key keep their order, so this is a total order and
+  // the result is the same for any split of the sort between threads.
+  auto comparator = [&keys, d](const size_t a, const size_t b)
+  {
+    const uint64_t* keyA = keys.colptr(a);
+    const uint64_t* keyB = keys.colptr(b);
+    for (size_t k = 0; k < d; ++k)
+      if (keyA[k] != keyB[k])
+        return keyA[k] < keyB[k];
+    return a < b;
+  };
+
+  // Sort chunks in parallel, and then merge them pairwise.
+  const size_t threads = ParallelThreads();
+  const size_t chunks = (n >= 100000) ? threads : 1;
+  std::vector<size_t> chunkBegins(chunks + 1);
+  for (size_t c = 0; c <= chunks; ++c)
+    chunkBegins[c] = c * n / chunks;
+
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks; ++c)
+  {
+    std::sort(oldFromNew.begin() + chunkBegins[c],
+        oldFromNew.begin() + chunkBegins[c + 1], comparator);
+  }
+
+  for (size_t width = 1; width < chunks; width *= 2)
+  {
+    const size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+    #pragma omp parallel for num_threads(threads)
+    for (omp_size_t p = 0; p < (omp_size_t) pairs; ++p)
+    {
+      const size_t first = p * 2 * width;
+      if (first + width < chunks)
+      {
+        std::inplace_merge(oldFromNew.begin() + chunkBegins[first],
+            oldFromNew.begin() + chunkBegins[first + width],
+            oldFromNew.begin() + chunkBegins[std::min(first + 2 * width,
+            chunks)], comparator);
+      }
+    }
+  }
+}
+
+template<typename MatType>
+void ReorderByCurve(MatType& dataset,
+                    std::vector<size_t>& oldFromNew,
+                    const CurveType curve)
+{
+  ComputeCurveOrder(dataset, oldFromNew, curve);
+  details::PermuteColumns(dataset, oldFromNew);
+}
+
+template<typename MatType>
+void UnmapColumns(MatType& data, const std::vector<size_t>& oldFromNew)
+{
+  if (data.n_cols != oldFromNew.size())
+  {
+    std::ostringstream oss;
+    oss << "UnmapColumns(): the matrix has " << data.n_cols << " columns, but "
+        << "the mapping has " << oldFromNew.size() << " indices";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Column oldFromNew[i] of the result is column i of the input.
+  std::vector<size_t> newFromOld(oldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    newFromOld[oldFromNew[i]] = i;
+
+  details::PermuteColumns(data, newFromOld);
+}
+
+inline void UnmapIndices(arma::Mat<size_t>& indices,
+                         const std::vector<size_t>& oldFromNew)
+{
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    if (indices[i] >= oldFromNew.size())
+      throw std::invalid_argument("UnmapIndices(): index out of range of the "
+          "mapping");
+    indices[i] = oldFromNew[indices[i]];
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -19,6 +19,7 @@
 #include <unordered_map>
 
 #include "map_policies/increment_policy.hpp"
+#include "map_policies/map_policy_traits.hpp"
 
 namespace mlpack {
 namespace data {
@@ -41,6 +42,15 @@ template<typename PolicyType, typename InputType = std::string>
 class DatasetMapper
 {
  public:
+  //! Whether the mappings are stored by the policy (see MapPolicyTraits).
+  static const bool PolicyOwnsMappings =
+      MapPolicyTraits<PolicyType>::OwnsMappings;
+
+  //! The type UnmapString() returns: a reference to the stored input, or a
+  //! copy of it if the mappings are stored by the policy.
+  using UnmapStringType = typename std::conditional<PolicyOwnsMappings,
+      InputType, const InputType&>::type;
+
   /**
    * Create the DatasetMapper object with the given dimensionality.  Note that
    * the dimensionality cannot be changed later; you will have to create a new
@@ -98,9 +108,9 @@ class DatasetMapper
    * @param unmappingIndex Index of non-unique unmapping (optional).
    */
   template<typename T>
-  const InputType& UnmapString(const T value,
-                               const size_t dimension,
-                               const size_t unmappingIndex = 0) const;
+  UnmapStringType UnmapString(const T value,
+                              const size_t dimension,
+                              const size_t unmappingIndex = 0) const;
 
   /**
    * Get the number of possible unmappings for a string in a given dimension.
@@ -139,6 +149,26 @@ class DatasetMapper
    */
   size_t Dimensionality() const;
 
+  /**
+   * Merge the given DatasetMapper into this one, for example to combine the
+   * mappers that different threads built while loading different parts of a
+   * dataset.  Both must have the same dimensionality.  Each dimension that is
+   * categorical in the other mapper becomes categorical, and the inputs of the
+   * other mapper that are not mapped here yet are mapped, in the order of
+   * their values in the other mapper.  This requires a policy that maps the
+   * inputs of each dimension to 0, 1, 2 and so on (like IncrementPolicy and
+   * InternPolicy).
+   *
+   * remappings[d][v] is set to the value here of the input that the other
+   * mapper maps to v in dimension d, so that data mapped with the other
+   * mapper can be converted.  The remappings of numeric dimensions are empty.
+   *
+   * @param other DatasetMapper to merge into this one.
+   * @param remappings Vector to store the remapping of each dimension into.
+   */
+  void Merge(const DatasetMapper& other,
+             std::vector<std::vector<size_t>>& remappings);
+
   /**
    * Serialize the dataset information.
    */
@@ -147,6 +177,8 @@ class DatasetMapper
   {
     ar & data::CreateNVP(types, "types");
     ar & data::CreateNVP(maps, "maps");
+    SerializePolicy(ar,
+        std::integral_constant<bool, PolicyOwnsMappings>());
   }
 
   //! Return the policy of the mapper.
@@ -182,6 +214,49 @@ class DatasetMapper
   //! policy object tells dataset mapper how the categorical values should be
   //  mapped to the maps object. It is used in MapString() and MapTokens().
   PolicyType policy;
+
+  // The implementations of the queries of the mappings, for mappings stored in
+  // the maps (std::false_type) or by the policy (std::true_type).
+  template<typename T>
+  UnmapStringType UnmapStringImpl(const T value,
+                                  const size_t dimension,
+                                  const size_t unmappingIndex,
+                                  std::false_type) const;
+  template<typename T>
+  UnmapStringType UnmapStringImpl(const T value,
+                                  const size_t dimension,
+                                  const size_t unmappingIndex,
+                                  std::true_type) const;
+
+  template<typename T>
+  size_t NumUnmappingsImpl(const T value,
+                           const size_t dimension,
+                           std::false_type) const;
+  template<typename T>
+  size_t NumUnmappingsImpl(const T value,
+                           const size_t dimension,
+                           std::true_type) const;
+
+  typename PolicyType::MappedType UnmapValueImpl(const InputType& input,
+                                                 const size_t dimension,
+                                                 std::false_type);
+  typename PolicyType::MappedType UnmapValueImpl(const InputType& input,
+                                                 const size_t dimension,
+                                                 std::true_type);
+
+  size_t NumMappingsImpl(const size_t dimension, std::false_type) const;
+  size_t NumMappingsImpl(const size_t dimension, std::true_type) const;
+
+  //! The policy does not need to be serialized if it holds no mappings.
+  template<typename Archive>
+  void SerializePolicy(Archive& /* ar */, std::false_type) { }
+
+  //! Serialize the policy and its mappings.
+  template<typename Archive>
+  void SerializePolicy(Archive& ar, std::true_type)
+  {
+    ar & data::CreateNVP(policy, "policy");
+  }
 };
 
 // Use typedef to provide backward compatibility
@@ -114,10 +114,24 @@ inline bool isnanSafe(const long double& t)
 // Return the input corresponding to a value in a given dimension.
 template<typename PolicyType, typename InputType>
 template<typename T>
-inline const InputType& DatasetMapper<PolicyType, InputType>::UnmapString(
+inline typename DatasetMapper<PolicyType, InputType>::UnmapStringType
+DatasetMapper<PolicyType, InputType>::UnmapString(
     const T value,
     const size_t dimension,
     const size_t unmappingIndex) const
+{
+  return UnmapStringImpl(value, dimension, unmappingIndex,
+      std::integral_constant<bool, PolicyOwnsMappings>());
+}
+
+template<typename PolicyType, typename InputType>
+template<typename T>
+inline typename DatasetMapper<PolicyType, InputType>::UnmapStringType
+DatasetMapper<PolicyType, InputType>::UnmapStringImpl(
+    const T value,
+    const size_t dimension,
+    const size_t unmappingIndex,
+    std::false_type) const
 {
   // If the value is std::numeric_limits<T>::quiet_NaN(), we can't use it as a
   // key---so we will use something else...
@@ -147,11 +161,45 @@ inline const InputType& DatasetMapper<PolicyType, InputType>::UnmapString(
   return maps.at(dimension).second.at(usedValue)[unmappingIndex];
 }
 
+template<typename PolicyType, typename InputType>
+template<typename T>
+inline typename DatasetMapper<PolicyType, InputType>::UnmapStringType
+DatasetMapper<PolicyType, InputType>::UnmapStringImpl(
+    const T value,
+    const size_t dimension,
+    const size_t unmappingIndex,
+    std::true_type) const
+{
+  // Each value has a single unmapping.
+  if (unmappingIndex != 0)
+  {
+    std::ostringstream oss;
+    oss << "DatasetMapper<PolicyType, InputType>::UnmapString(): value '"
+        << value << "' only has 1 unmapping, but unmappingIndex is "
+        << unmappingIndex << "!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  return policy.UnmapString(
+      static_cast<typename PolicyType::MappedType>(value), dimension);
+}
+
 template<typename PolicyType, typename InputType>
 template<typename T>
 inline size_t DatasetMapper<PolicyType, InputType>::NumUnmappings(
     const T value,
     const size_t dimension) const
+{
+  return NumUnmappingsImpl(value, dimension,
+      std::integral_constant<bool, PolicyOwnsMappings>());
+}
+
+template<typename PolicyType, typename InputType>
+template<typename T>
+inline size_t DatasetMapper<PolicyType, InputType>::NumUnmappingsImpl(
+    const T value,
+    const size_t dimension,
+    std::false_type) const
 {
   // If the value is std::numeric_limits<T>::quiet_NaN(), we can't use it as a
   // key---so we will use something else...
@@ -164,12 +212,36 @@ inline size_t DatasetMapper<PolicyType, InputType>::NumUnmappings(
   return maps.at(dimension).second.at(value).size();
 }
 
+template<typename PolicyType, typename InputType>
+template<typename T>
+inline size_t DatasetMapper<PolicyType, InputType>::NumUnmappingsImpl(
+    const T value,
+    const size_t dimension,
+    std::true_type) const
+{
+  // Each mapped value (0, 1, 2 and so on) has a single unmapping.
+  const double v = (double) value;
+  return (v >= 0.0 && v == std::floor(v) &&
+      v < (double) policy.NumMappings(dimension)) ? 1 : 0;
+}
+
 // Return the value corresponding to an input in a given dimension.
 template<typename PolicyType, typename InputType>
 inline typename PolicyType::MappedType
 DatasetMapper<PolicyType, InputType>::UnmapValue(
     const InputType& input,
     const size_t dimension)
+{
+  return UnmapValueImpl(input, dimension,
+      std::integral_constant<bool, PolicyOwnsMappings>());
+}
+
+template<typename PolicyType, typename InputType>
+inline typename PolicyType::MappedType
+DatasetMapper<PolicyType, InputType>::UnmapValueImpl(
+    const InputType& input,
+    const size_t dimension,
+    std::false_type)
 {
   // Throw an exception if the value doesn't exist.
   if (maps[dimension].first.count(input) == 0)
@@ -183,6 +255,16 @@ DatasetMapper<PolicyType, InputType>::UnmapValue(
   return maps[dimension].first.at(input);
 }
 
+template<typename PolicyType, typename InputType>
+inline typename PolicyType::MappedType
+DatasetMapper<PolicyType, InputType>::UnmapValueImpl(
+    const InputType& input,
+    const size_t dimension,
+    std::true_type)
+{
+  return policy.UnmapValue(input, dimension);
+}
+
 // Get the type of a particular dimension.
 template<typename PolicyType, typename InputType>
 inline Datatype DatasetMapper<PolicyType, InputType>::Type(
@@ -212,16 +294,66 @@ inline Datatype& DatasetMapper<PolicyType, InputType>::Type(
 template<typename PolicyType, typename InputType>
 inline size_t
 DatasetMapper<PolicyType, InputType>::NumMappings(const size_t dimension) const
+{
+  return NumMappingsImpl(dimension,
+      std::integral_constant<bool, PolicyOwnsMappings>());
+}
+
+template<typename PolicyType, typename InputType>
+inline size_t DatasetMapper<PolicyType, InputType>::NumMappingsImpl(
+    const size_t dimension,
+    std::false_type) const
 {
   return (maps.count(dimension) == 0) ? 0 : maps.at(dimension).first.size();
 }
 
+template<typename PolicyType, typename InputType>
+inline size_t DatasetMapper<PolicyType, InputType>::NumMappingsImpl(
+    const size_t dimension,
+    std::true_type) const
+{
+  return policy.NumMappings(dimension);
+}
+
 template<typename PolicyType, typename InputType>
 inline size_t DatasetMapper<PolicyType, InputType>::Dimensionality() const
 {
   return types.size();
 }
 
+template<typename PolicyType, typename InputType>
+void DatasetMapper<PolicyType, InputType>::Merge(
+    const DatasetMapper& other,
+    std::vector<std::vector<size_t>>& remappings)
+{
+  if (other.Dimensionality() != Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "DatasetMapper::Merge(): cannot merge a mapper of dimensionality "
+        << other.Dimensionality() << " into a mapper of dimensionality "
+        << Dimensionality();
+    throw std::invalid_argument(oss.str());
+  }
+
+  remappings.clear();
+  remappings.resize(Dimensionality());
+  for (size_t d = 0; d < Dimensionality(); ++d)
+  {
+    if (other.types[d] == Datatype::numeric)
+      continue;
+
+    // Mapping to a categorical dimension always maps the input.
+    types[d] = Datatype::categorical;
+
+    const size_t numMappings = other.NumMappings(d);
+    remappings[d].resize(numMappings);
+    for (size_t v = 0; v < numMappings; ++v)
+    {
+      remappings[d][v] = MapString<size_t>(other.UnmapString(v, d), d);
+    }
+  }
+}
+
 template<typename PolicyType, typename InputType>
 inline const PolicyType& DatasetMapper<PolicyType, InputType>::Policy() const
 {
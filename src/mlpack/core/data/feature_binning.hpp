@@ -0,0 +1,148 @@
+/**
+ * @file feature_binning.hpp
+ *
+ * Definition of the FeatureBinning class, which stores each dimension of a
+ * dataset as the 8-bit index of a quantile bin of the dimension.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_FEATURE_BINNING_HPP
+#define MLPACK_CORE_DATA_FEATURE_BINNING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "dataset_mapper.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The FeatureBinning class splits each numeric dimension of a dataset into at
+ * most 256 bins at quantiles of the dimension, and converts datasets into the
+ * bin index of each element, as an arma::Mat<uint8_t>.  This takes an eighth
+ * of the memory of an arma::mat, and is the way histogram-based tree learners
+ * store their training data; tree::RandomForest and tree::DecisionTree can be
+ * trained on the bins directly, and their split values can then be mapped
+ * back to values of the dimensions (see RandomForest::MapBinnedSplits()), so
+ * that the model classifies the original data.
+ *
+ * The bins of a dimension are given by its edges e_0 < e_1 < ... < e_{m-1},
+ * which are single-precision values: bin b holds the values in (e_{b-1}, e_b],
+ * the first bin holds the values up to e_0 and the last bin (bin m) holds the
+ * values above e_{m-1}.  So a value is in a bin at most b if and only if it is
+ * at most e_b, and a threshold split between the bins b and b + 1 is the same
+ * as a threshold split at e_b on the original values.  The edges are the
+ * quantiles of a strided sample of the points; if a dimension has at most as
+ * many distinct values in the sample as there are bins, each of them has its
+ * own bin.  The categorical dimensions of a DatasetInfo are not binned: their
+ * bin is their category, so they can have at most 256 categories.
+ *
+ * @code
+ * data::FeatureBinning binning;
+ * binning.Fit(dataset);
+ * arma::Mat<uint8_t> bins;
+ * binning.Transform(dataset, bins);
+ *
+ * RandomForest<GiniGain, MultipleRandomDimensionSelect<>,
+ *     HistogramNumericSplit> rf(bins, labels, numClasses, 50);
+ * rf.MapBinnedSplits(binning);
+ * rf.Classify(testData, predictions);
+ * @endcode
+ */
+class FeatureBinning
+{
+ public:
+  /**
+   * Create the binning object; Fit() must be called before Transform().
+   *
+   * @param maxBins The maximum number of bins of each numeric dimension (at
+   *     least 2 and at most 256).
+   */
+  FeatureBinning(const size_t maxBins = 256);
+
+  /**
+   * Compute the bins of each dimension of the given dataset, which are all
+   * numeric.
+   *
+   * @param data Dataset (one point per column).
+   */
+  template<typename MatType>
+  void Fit(const MatType& data);
+
+  /**
+   * Compute the bins of each numeric dimension of the given dataset.  A
+   * std::invalid_argument exception is thrown if a categorical dimension has
+   * more than 256 categories.
+   *
+   * @param data Dataset (one point per column).
+   * @param datasetInfo Type information for each dimension.
+   */
+  template<typename MatType>
+  void Fit(const MatType& data, const DatasetInfo& datasetInfo);
+
+  /**
+   * Convert the given points into the index of the bin of each of their
+   * elements.  The points are converted in parallel.  A std::invalid_argument
+   * exception is thrown if the data does not have the dimensionality of the
+   * data given to Fit().
+   *
+   * @param data Points to convert (one per column).
+   * @param bins Matrix to store the bin indices in.
+   */
+  template<typename MatType>
+  void Transform(const MatType& data, arma::Mat<uint8_t>& bins) const;
+
+  //! Get the maximum number of bins of each numeric dimension.
+  size_t MaxBins() const { return maxBins; }
+  //! Get the number of dimensions.
+  size_t Dimensionality() const { return edges.size(); }
+  //! Get whether the given dimension is categorical.
+  bool Categorical(const size_t dimension) const
+  { return categories[dimension] != 0; }
+  //! Get the number of bins of the given dimension.
+  size_t Bins(const size_t dimension) const
+  {
+    return Categorical(dimension) ? categories[dimension] :
+        edges[dimension].n_elem + 1;
+  }
+  //! Get the edges of the bins of the given dimension (empty if it is
+  //! categorical).
+  const arma::Col<float>& Edges(const size_t dimension) const
+  { return edges[dimension]; }
+
+  /**
+   * Get the value of the given dimension that a threshold split between the
+   * given bin and the next one is the same as (the upper edge of the bin).  No
+   * bounds checking: the bin must not be the last bin of the dimension.
+   */
+  double Threshold(const size_t dimension, const size_t bin) const
+  { return edges[dimension][bin]; }
+
+  //! Serialize the binning.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Compute the bins of each numeric dimension; all dimensions are numeric if
+  //! datasetInfo is NULL.
+  template<typename MatType>
+  void FitImpl(const MatType& data, const DatasetInfo* datasetInfo);
+
+  //! The maximum number of bins of each numeric dimension.
+  size_t maxBins;
+  //! The edges of the bins of each dimension.
+  std::vector<arma::Col<float>> edges;
+  //! The number of categories of each dimension (0 for numeric dimensions).
+  std::vector<size_t> categories;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "feature_binning_impl.hpp"
+
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @file feature_binning_impl.hpp
+ *
+ * Implementation of the FeatureBinning class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_FEATURE_BINNING_IMPL_HPP
+#define MLPACK_CORE_DATA_FEATURE_BINNING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "feature_binning.hpp"
+
+namespace mlpack {
+namespace data {
+
+inline FeatureBinning::FeatureBinning(const size_t maxBins) :
+    maxBins(maxBins)
+{
+  if (maxBins < 2 || maxBins > 256)
+  {
+    std::ostringstream oss;
+    oss << "FeatureBinning::FeatureBinning(): the number of bins (" << maxBins
+        << ") must be between 2 and 256!";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename MatType>
+void FeatureBinning::Fit(const MatType& data)
+{
+  FitImpl(data, NULL);
+}
+
+template<typename MatType>
+void FeatureBinning::Fit(const MatType& data, const DatasetInfo& datasetInfo)
+{
+  if (datasetInfo.Dimensionality() != data.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "FeatureBinning::Fit(): the dataset has " << data.n_rows
+        << " dimensions, but the dataset info has "
+        << datasetInfo.Dimensionality() << "!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  for (size_t d = 0; d < data.n_rows; ++d)
+  {
+    if (datasetInfo.Type(d) == Datatype::categorical &&
+        datasetInfo.NumMappings(d) > 256)
+    {
+      std::ostringstream oss;
+      oss << "FeatureBinning::Fit(): dimension " << d << " has "
+          << datasetInfo.NumMappings(d) << " categories, but at most 256 can "
+          << "be stored in a bin!";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  FitImpl(data, &datasetInfo);
+}
+
+template<typename MatType>
+void FeatureBinning::FitImpl(const MatType& data,
+                             const DatasetInfo* datasetInfo)
+{
+  edges.clear();
+  edges.resize(data.n_rows);
+  categories.assign(data.n_rows, 0);
+
+  // The quantiles are taken from a strided sample with many points per bin.
+  const size_t n = data.n_cols;
+  const size_t sampleSize = std::min(n, 64 * maxBins);
+
+  #pragma omp parallel for schedule(dynamic) num_threads(ParallelThreads())
+  for (omp_size_t d = 0; d < (omp_size_t) data.n_rows; ++d)
+  {
+    if (datasetInfo && datasetInfo->Type(d) == Datatype::categorical)
+    {
+      // A category is stored in the bin with its index; make sure that a
+      // dimension with no categories is still marked as categorical.
+      categories[d] = std::max(datasetInfo->NumMappings(d), (size_t) 1);
+      continue;
+    }
+
+    // The edges are rounded to single precision before the duplicates are
+    // removed, so that they are strictly increasing.
+    std::vector<double> sample(sampleSize);
+    for (size_t i = 0; i < sampleSize; ++i)
+      sample[i] = data(d, (i * n) / sampleSize);
+    std::sort(sample.begin(), sample.end());
+
+    // If there are few distinct values, each of them is an edge; otherwise the
+    // edges are quantiles of the sample.
+    std::vector<float> dimEdges;
+    dimEdges.reserve(maxBins);
+    for (size_t i = 0; i < sampleSize && dimEdges.size() <= maxBins; ++i)
+    {
+      const float edge = (float) sample[i];
+      if (dimEdges.empty() || edge > dimEdges.back())
+        dimEdges.push_back(edge);
+    }
+
+    if (dimEdges.size() > maxBins)
+    {
+      dimEdges.clear();
+      for (size_t b = 0; b + 1 < maxBins; ++b)
+      {
+        const float edge = (float) sample[((b + 1) * sampleSize) / maxBins];
+        if (dimEdges.empty() || edge > dimEdges.back())
+          dimEdges.push_back(edge);
+      }
+    }
+
+    // A last edge at the largest value of the sample would leave the last bin
+    // empty for the sample, so drop it.
+    if (dimEdges.size() > 1 &&
+        (double) dimEdges.back() >= sample[sampleSize - 1])
+      dimEdges.pop_back();
+
+    edges[d] = arma::Col<float>(dimEdges);
+  }
+}
+
+template<typename MatType>
+void FeatureBinning::Transform(const MatType& data,
+                               arma::Mat<uint8_t>& bins) const
+{
+  if (data.n_rows != edges.size())
+  {
+    std::ostringstream oss;
+    oss << "FeatureBinning::Transform(): the data has " << data.n_rows
+        << " dimensions, but the bins were computed for " << edges.size()
+        << " dimensions!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  bins.set_size(data.n_rows, data.n_cols);
+
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    for (size_t d = 0; d < data.n_rows; ++d)
+    {
+      const double value = data(d, i);
+      if (categories[d] != 0)
+      {
+        bins(d, i) = (uint8_t) value;
+        continue;
+      }
+
+      // The bin is the index of the first edge that is not smaller than the
+      // value.
+      const float* dimEdges = edges[d].memptr();
+      size_t first = 0, last = edges[d].n_elem;
+      while (first < last)
+      {
+        const size_t middle = (first + last) / 2;
+        if ((double) dimEdges[middle] < value)
+          first = middle + 1;
+        else
+          last = middle;
+      }
+      bins(d, i) = (uint8_t) first;
+    }
+  }
+}
+
+template<typename Archive>
+void FeatureBinning::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & CreateNVP(maxBins, "maxBins");
+  ar & CreateNVP(categories, "categories");
+
+  size_t dimensionality = edges.size();
+  ar & CreateNVP(dimensionality, "dimensionality");
+  if (Archive::is_loading::value)
+    edges.resize(dimensionality);
+
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    std::ostringstream oss;
+    oss << "edges" << d;
+    ar & CreateNVP(edges[d], oss.str());
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
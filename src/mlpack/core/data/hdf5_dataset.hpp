@@ -0,0 +1,179 @@
+/**
+ * @file hdf5_dataset.hpp
+ *
+ * Definition of the HDF5Dataset class, which reads and writes ranges of points
+ * of a dataset in an HDF5 file without loading the whole dataset.  It is only
+ * available if Armadillo is built with HDF5 support (ARMA_USE_HDF5).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_HDF5_DATASET_HPP
+#define MLPACK_CORE_DATA_HDF5_DATASET_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef ARMA_USE_HDF5
+
+#include <hdf5.h>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A two-dimensional dataset in an HDF5 file, of which ranges of points can be
+ * read and written (as HDF5 hyperslabs) without loading the whole dataset.
+ * The datasets are the ones of Armadillo's hdf5_binary format, so files saved
+ * with data::Save() can be read, and files written with this class can be
+ * loaded with data::Load(); the transpose parameter has the same meaning as
+ * for those functions (by default, each row of the stored matrix is a point).
+ *
+ * Datasets created by this class are chunked by the given number of points, so
+ * that reading or writing a range of points only touches the chunks of those
+ * points.  This can be used to stream a dataset (see BatchReader), to give
+ * each worker thread its own shard of a dataset, or to write results like the
+ * neighbors found by NeighborSearch one range of points at a time.
+ *
+ * HDF5 is usually built without thread safety, so the HDF5 calls of
+ * ReadPoints() and WritePoints() are serialized between OpenMP threads; the
+ * threads can then call them concurrently and work on their points in
+ * parallel.
+ *
+ * @code
+ * data::HDF5Dataset<> input("reference.h5");
+ * data::HDF5Dataset<size_t> output("neighbors.h5", k, input.NumPoints());
+ *
+ * const size_t shards = (input.NumPoints() + 9999) / 10000;
+ * #pragma omp parallel for
+ * for (omp_size_t s = 0; s < (omp_size_t) shards; ++s)
+ * {
+ *   const size_t i = s * 10000;
+ *   arma::mat points;
+ *   input.ReadPoints(i, std::min((size_t) 10000, input.NumPoints() - i),
+ *       points);
+ *   arma::Mat<size_t> neighbors;
+ *   arma::mat distances;
+ *   knn.Search(points, k, neighbors, distances);
+ *   output.WritePoints(i, neighbors);
+ * }
+ * @endcode
+ *
+ * @tparam eT Element type of the points in memory (HDF5 converts from and to
+ *     the type of the file).
+ */
+template<typename eT = double>
+class HDF5Dataset
+{
+ public:
+  /**
+   * Open the given dataset of an HDF5 file.  A std::runtime_error is thrown if
+   * it cannot be opened or is not two-dimensional.
+   *
+   * @param filename Name of the HDF5 file.
+   * @param datasetName Name of the dataset in the file.
+   * @param transpose If true, each row of the stored matrix is a point.
+   * @param writable If true, the points can be written too.
+   */
+  HDF5Dataset(const std::string& filename,
+              const std::string& datasetName = "dataset",
+              const bool transpose = true,
+              const bool writable = false);
+
+  /**
+   * Create a new HDF5 file with a chunked dataset of the given size, with
+   * elements of type eT; an existing file is replaced.  The points can be
+   * written and read.  A std::runtime_error is thrown if the file cannot be
+   * created.
+   *
+   * @param filename Name of the HDF5 file.
+   * @param dimensionality Dimensionality of the points.
+   * @param numPoints Number of points.
+   * @param datasetName Name of the dataset in the file.
+   * @param transpose If true, each row of the stored matrix is a point.
+   * @param chunkPoints Number of points of each chunk.
+   */
+  HDF5Dataset(const std::string& filename,
+              const size_t dimensionality,
+              const size_t numPoints,
+              const std::string& datasetName = "dataset",
+              const bool transpose = true,
+              const size_t chunkPoints = 1024);
+
+  //! Close the dataset and the file.
+  ~HDF5Dataset();
+
+  // The file cannot be shared.
+  HDF5Dataset(const HDF5Dataset& other) = delete;
+  HDF5Dataset& operator=(const HDF5Dataset& other) = delete;
+
+  /**
+   * Read the given range of points into the given matrix, one point per
+   * column.  A std::invalid_argument is thrown if the range is out of bounds,
+   * and a std::runtime_error if it cannot be read.
+   *
+   * @param first Index of the first point to read.
+   * @param count Number of points to read.
+   * @param points Matrix to read the points into.
+   */
+  void ReadPoints(const size_t first,
+                  const size_t count,
+                  arma::Mat<eT>& points) const;
+
+  /**
+   * Write the points of the given matrix (one per column) to the dataset,
+   * starting at the given index.  A std::invalid_argument is thrown if the
+   * points do not fit, and a std::runtime_error if they cannot be written.
+   *
+   * @param first Index of the first point to write.
+   * @param points Points to write.
+   */
+  void WritePoints(const size_t first, const arma::Mat<eT>& points);
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the number of points.
+  size_t NumPoints() const { return numPoints; }
+
+ private:
+  //! Read the size of the opened dataset.
+  void ReadSize();
+
+  /**
+   * Select the hyperslab of the given range of points, and return the file
+   * and memory dataspaces, which the caller must close.
+   */
+  void Select(const size_t first,
+              const size_t count,
+              hid_t& fileSpace,
+              hid_t& memorySpace) const;
+
+  //! Throw a std::runtime_error for the given failed action on the file.
+  void Fail(const std::string& action) const;
+
+  //! The name of the file.
+  std::string filename;
+  //! Whether each row of the stored matrix is a point.
+  bool transpose;
+  //! Whether the points can be written.
+  bool writable;
+  //! The HDF5 file.
+  hid_t file;
+  //! The HDF5 dataset.
+  hid_t dataset;
+  //! The dimensionality of the points.
+  size_t dimensionality;
+  //! The number of points.
+  size_t numPoints;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "hdf5_dataset_impl.hpp"
+
+#endif // ARMA_USE_HDF5
+
+#endif
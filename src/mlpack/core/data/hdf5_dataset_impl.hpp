@@ -0,0 +1,307 @@
+/**
+ * @file hdf5_dataset_impl.hpp
+ *
+ * Implementation of the HDF5Dataset class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_HDF5_DATASET_IMPL_HPP
+#define MLPACK_CORE_DATA_HDF5_DATASET_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hdf5_dataset.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The dataset of a matrix of Armadillo's hdf5_binary format has the dimensions
+ * { n_cols, n_rows }, since HDF5 stores the elements in row-major order.  If
+ * each row of the stored matrix is a point (transpose), the dimensions are
+ * then { dimensionality, numPoints }, and otherwise { numPoints,
+ * dimensionality }.
+ */
+template<typename eT>
+HDF5Dataset<eT>::HDF5Dataset(const std::string& filename,
+                             const std::string& datasetName,
+                             const bool transpose,
+                             const bool writable) :
+    filename(filename),
+    transpose(transpose),
+    writable(writable),
+    file(-1),
+    dataset(-1),
+    dimensionality(0),
+    numPoints(0)
+{
+  #pragma omp critical(mlpack_hdf5)
+  {
+    file = H5Fopen(filename.c_str(), writable ? H5F_ACC_RDWR : H5F_ACC_RDONLY,
+        H5P_DEFAULT);
+    if (file >= 0)
+      dataset = H5Dopen2(file, datasetName.c_str(), H5P_DEFAULT);
+  }
+
+  if (file < 0)
+    Fail("open");
+  if (dataset < 0)
+  {
+    #pragma omp critical(mlpack_hdf5)
+    H5Fclose(file);
+    throw std::runtime_error("HDF5Dataset: cannot open dataset '" +
+        datasetName + "' of '" + filename + "'");
+  }
+
+  ReadSize();
+}
+
+template<typename eT>
+HDF5Dataset<eT>::HDF5Dataset(const std::string& filename,
+                             const size_t dimensionality,
+                             const size_t numPoints,
+                             const std::string& datasetName,
+                             const bool transpose,
+                             const size_t chunkPoints) :
+    filename(filename),
+    transpose(transpose),
+    writable(true),
+    file(-1),
+    dataset(-1),
+    dimensionality(dimensionality),
+    numPoints(numPoints)
+{
+  if (dimensionality == 0 || chunkPoints == 0)
+  {
+    throw std::invalid_argument("HDF5Dataset: the dimensionality and the "
+        "number of points per chunk must be positive");
+  }
+
+  const hsize_t points = (hsize_t) numPoints;
+  const hsize_t dims = (hsize_t) dimensionality;
+  const hsize_t chunk = (hsize_t) std::max(std::min(chunkPoints, numPoints),
+      (size_t) 1);
+  hsize_t sizes[2] = { transpose ? dims : points, transpose ? points : dims };
+  hsize_t chunkSizes[2] = { transpose ? dims : chunk,
+                            transpose ? chunk : dims };
+
+  #pragma omp critical(mlpack_hdf5)
+  {
+    file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT,
+        H5P_DEFAULT);
+    if (file >= 0)
+    {
+      hid_t space = H5Screate_simple(2, sizes, NULL);
+      hid_t properties = H5Pcreate(H5P_DATASET_CREATE);
+      H5Pset_chunk(properties, 2, chunkSizes);
+      hid_t type = arma::hdf5_misc::get_hdf5_type<eT>();
+
+      dataset = H5Dcreate2(file, datasetName.c_str(), type, space, H5P_DEFAULT,
+          properties, H5P_DEFAULT);
+
+      H5Tclose(type);
+      H5Pclose(properties);
+      H5Sclose(space);
+    }
+  }
+
+  if (file < 0)
+    Fail("create");
+  if (dataset < 0)
+  {
+    #pragma omp critical(mlpack_hdf5)
+    H5Fclose(file);
+    throw std::runtime_error("HDF5Dataset: cannot create dataset '" +
+        datasetName + "' of '" + filename + "'");
+  }
+}
+
+template<typename eT>
+HDF5Dataset<eT>::~HDF5Dataset()
+{
+  #pragma omp critical(mlpack_hdf5)
+  {
+    if (dataset >= 0)
+      H5Dclose(dataset);
+    if (file >= 0)
+      H5Fclose(file);
+  }
+}
+
+template<typename eT>
+void HDF5Dataset<eT>::ReadPoints(const size_t first,
+                                 const size_t count,
+                                 arma::Mat<eT>& points) const
+{
+  if (first > numPoints || count > numPoints - first)
+  {
+    std::ostringstream oss;
+    oss << "HDF5Dataset::ReadPoints(): cannot read " << count << " points "
+        << "from point " << first << " of " << numPoints << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  points.set_size(dimensionality, count);
+  if (count == 0)
+    return;
+
+  // If each stored row is a point, the hyperslab is a row-major
+  // { dimensionality, count } array, which is a matrix with a point per row in
+  // column-major order, and has to be transposed.  Otherwise it is a row-major
+  // { count, dimensionality } array, which is a point per column.
+  arma::Mat<eT> buffer;
+  if (transpose)
+    buffer.set_size(count, dimensionality);
+
+  herr_t status = -1;
+  #pragma omp critical(mlpack_hdf5)
+  {
+    hid_t fileSpace, memorySpace;
+    Select(first, count, fileSpace, memorySpace);
+    if (fileSpace >= 0 && memorySpace >= 0)
+    {
+      hid_t type = arma::hdf5_misc::get_hdf5_type<eT>();
+      status = H5Dread(dataset, type, memorySpace, fileSpace, H5P_DEFAULT,
+          transpose ? buffer.memptr() : points.memptr());
+      H5Tclose(type);
+    }
+    if (memorySpace >= 0)
+      H5Sclose(memorySpace);
+    if (fileSpace >= 0)
+      H5Sclose(fileSpace);
+  }
+
+  if (status < 0)
+    Fail("read the points of");
+
+  if (transpose)
+    points = buffer.t();
+}
+
+template<typename eT>
+void HDF5Dataset<eT>::WritePoints(const size_t first,
+                                  const arma::Mat<eT>& points)
+{
+  if (!writable)
+  {
+    throw std::invalid_argument("HDF5Dataset::WritePoints(): '" + filename +
+        "' was not opened for writing");
+  }
+
+  if (points.n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "HDF5Dataset::WritePoints(): the points have dimensionality "
+        << points.n_rows << ", but the dataset has dimensionality "
+        << dimensionality;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t count = points.n_cols;
+  if (first > numPoints || count > numPoints - first)
+  {
+    std::ostringstream oss;
+    oss << "HDF5Dataset::WritePoints(): cannot write " << count << " points "
+        << "from point " << first << " of " << numPoints << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (count == 0)
+    return;
+
+  // See ReadPoints() for the layout of the hyperslab.
+  arma::Mat<eT> buffer;
+  if (transpose)
+    buffer = points.t();
+  const eT* data = transpose ? buffer.memptr() : points.memptr();
+
+  herr_t status = -1;
+  #pragma omp critical(mlpack_hdf5)
+  {
+    hid_t fileSpace, memorySpace;
+    Select(first, count, fileSpace, memorySpace);
+    if (fileSpace >= 0 && memorySpace >= 0)
+    {
+      hid_t type = arma::hdf5_misc::get_hdf5_type<eT>();
+      status = H5Dwrite(dataset, type, memorySpace, fileSpace, H5P_DEFAULT,
+          data);
+      H5Tclose(type);
+    }
+    if (memorySpace >= 0)
+      H5Sclose(memorySpace);
+    if (fileSpace >= 0)
+      H5Sclose(fileSpace);
+  }
+
+  if (status < 0)
+    Fail("write the points to");
+}
+
+template<typename eT>
+void HDF5Dataset<eT>::ReadSize()
+{
+  int rank = -1;
+  hsize_t sizes[2] = { 0, 0 };
+  #pragma omp critical(mlpack_hdf5)
+  {
+    hid_t space = H5Dget_space(dataset);
+    if (space >= 0)
+    {
+      rank = H5Sget_simple_extent_ndims(space);
+      if (rank == 2)
+        H5Sget_simple_extent_dims(space, sizes, NULL);
+      H5Sclose(space);
+    }
+  }
+
+  if (rank != 2)
+  {
+    #pragma omp critical(mlpack_hdf5)
+    {
+      H5Dclose(dataset);
+      H5Fclose(file);
+    }
+    throw std::runtime_error("HDF5Dataset: the dataset of '" + filename +
+        "' is not two-dimensional");
+  }
+
+  dimensionality = (size_t) (transpose ? sizes[0] : sizes[1]);
+  numPoints = (size_t) (transpose ? sizes[1] : sizes[0]);
+}
+
+template<typename eT>
+void HDF5Dataset<eT>::Select(const size_t first,
+                             const size_t count,
+                             hid_t& fileSpace,
+                             hid_t& memorySpace) const
+{
+  const hsize_t dims = (hsize_t) dimensionality;
+  hsize_t start[2] = { transpose ? 0 : (hsize_t) first,
+                       transpose ? (hsize_t) first : 0 };
+  hsize_t sizes[2] = { transpose ? dims : (hsize_t) count,
+                       transpose ? (hsize_t) count : dims };
+
+  memorySpace = -1;
+  fileSpace = H5Dget_space(dataset);
+  if (fileSpace < 0)
+    return;
+  if (H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, start, NULL, sizes,
+      NULL) < 0)
+    return;
+
+  memorySpace = H5Screate_simple(2, sizes, NULL);
+}
+
+template<typename eT>
+void HDF5Dataset<eT>::Fail(const std::string& action) const
+{
+  throw std::runtime_error("HDF5Dataset: cannot " + action + " '" + filename +
+      "'");
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
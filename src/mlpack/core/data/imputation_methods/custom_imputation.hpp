@@ -71,6 +71,37 @@ class CustomImputation
     }
   }
 
+  /**
+   * Replace the mapped values of each of the given dimensions with the
+   * user-defined custom value, in a single pass over the input.  The result is
+   * overwritten to the input, not creating any copy.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value that the user wants to get rid of, for each of
+   *     the given dimensions.
+   * @param dimensions Indices of the dimensions to impute.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    const size_t numPoints = columnMajor ? input.n_cols : input.n_rows;
+
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) numPoints; ++i)
+    {
+      for (size_t d = 0; d < dimensions.size(); ++d)
+      {
+        T& value = columnMajor ? input(dimensions[d], i) :
+            input(i, dimensions[d]);
+        if (value == mappedValues[d] || std::isnan(value))
+          value = customValue;
+      }
+    }
+  }
+
  private:
   //! A user-defined value that the user wants to replace missing values with.
   T customValue;
@@ -66,6 +66,45 @@ class ListwiseDeletion
       input = input.rows(arma::uvec(colsToKeep));
     }
   }
+
+  /**
+   * Remove every row or column that contains the mapped value of any of the
+   * given dimensions.  All the dimensions are checked in a single pass, so
+   * the input is only copied once.  The result is overwritten to the input.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value that the user wants to get rid of, for each of
+   *     the given dimensions.
+   * @param dimensions Indices of the dimensions to check.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    std::vector<arma::uword> colsToKeep;
+
+    const size_t numPoints = columnMajor ? input.n_cols : input.n_rows;
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+      bool keep = true;
+      for (size_t d = 0; d < dimensions.size() && keep; ++d)
+      {
+        const T value = columnMajor ? input(dimensions[d], i) :
+            input(i, dimensions[d]);
+        keep = !(value == mappedValues[d] || std::isnan(value));
+      }
+
+      if (keep)
+        colsToKeep.push_back(i);
+    }
+
+    if (columnMajor)
+      input = input.cols(arma::uvec(colsToKeep));
+    else
+      input = input.rows(arma::uvec(colsToKeep));
+  }
 }; // class ListwiseDeletion
 
 } // namespace data
@@ -96,6 +96,77 @@ class MeanImputation
       input(target.first, target.second) = mean;
     }
   }
+
+  /**
+   * Replace the mapped values of each of the given dimensions with the mean of
+   * the dimension.  The means of all the dimensions are computed in a single
+   * pass over the input, in parallel over blocks of points, and the missing
+   * values are then replaced in a second pass.  The result is overwritten to
+   * the input matrix.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value that the user wants to get rid of, for each of
+   *     the given dimensions.
+   * @param dimensions Indices of the dimensions to impute.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    const size_t numDimensions = dimensions.size();
+    const size_t numPoints = columnMajor ? input.n_cols : input.n_rows;
+
+    // The sums and the numbers of elements (excluding nan or missing target)
+    // of each block of points, which are added up in order.
+    const size_t blocks = std::max(std::min(ParallelThreads(), numPoints),
+        (size_t) 1);
+    arma::mat sums(numDimensions, blocks, arma::fill::zeros);
+    arma::Mat<size_t> elems(numDimensions, blocks, arma::fill::zeros);
+
+    #pragma omp parallel for
+    for (omp_size_t b = 0; b < (omp_size_t) blocks; ++b)
+    {
+      const size_t begin = numPoints * b / blocks;
+      const size_t end = numPoints * (b + 1) / blocks;
+      for (size_t i = begin; i < end; ++i)
+      {
+        for (size_t d = 0; d < numDimensions; ++d)
+        {
+          const T value = columnMajor ? input(dimensions[d], i) :
+              input(i, dimensions[d]);
+          if (!(value == mappedValues[d] || std::isnan(value)))
+          {
+            elems(d, b)++;
+            sums(d, b) += value;
+          }
+        }
+      }
+    }
+
+    const arma::Col<size_t> totalElems = arma::sum(elems, 1);
+    if (arma::any(totalElems == 0))
+      Log::Fatal << "it is impossible to calculate mean; no valid elements in "
+          << "the dimension" << std::endl;
+
+    // calculate means.
+    const arma::vec means = arma::sum(sums, 1) /
+        arma::conv_to<arma::vec>::from(totalElems);
+
+    // Now replace the calculated means to the missing variables.
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) numPoints; ++i)
+    {
+      for (size_t d = 0; d < numDimensions; ++d)
+      {
+        T& value = columnMajor ? input(dimensions[d], i) :
+            input(i, dimensions[d]);
+        if (value == mappedValues[d] || std::isnan(value))
+          value = means[d];
+      }
+    }
+  }
 }; // class MeanImputation
 
 } // namespace data
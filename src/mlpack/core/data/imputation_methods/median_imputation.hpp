@@ -85,6 +85,29 @@ class MedianImputation
        input(target.first, target.second) = median;
     }
   }
+
+  /**
+   * Replace the mapped values of each of the given dimensions with the median
+   * of the dimension.  Each dimension needs a copy of its valid elements, so
+   * the dimensions are imputed one at a time by each thread, in parallel.  The
+   * result is overwritten to the input matrix.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value that the user wants to get rid of, for each of
+   *     the given dimensions.
+   * @param dimensions Indices of the dimensions to impute.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    // Each dimension only reads and writes its own elements.
+    #pragma omp parallel for
+    for (omp_size_t d = 0; d < (omp_size_t) dimensions.size(); ++d)
+      Impute(input, mappedValues[d], dimensions[d], columnMajor);
+  }
 }; // class MedianImputation
 
 } // namespace data
@@ -65,6 +65,32 @@ class Imputer
     strategy.Impute(input, mappedValue, dimension, columnMajor);
   }
 
+  /**
+  * Given an input dataset, replace missing values of each of the given
+  * dimensions with given imputation strategy.  The strategy processes all the
+  * dimensions together, so that the statistics of all of them are computed in
+  * a single pass over the input, instead of one pass per dimension.  This
+  * function does not produce output matrix, but overwrites the result into the
+  * input matrix.
+  *
+  * @param input Input dataset to apply imputation.
+  * @param missingValue User defined missing value; it can be anything.
+  * @param dimensions Dimensions to apply the imputation.
+  */
+  void Impute(arma::Mat<T>& input,
+              const std::string& missingValue,
+              const std::vector<size_t>& dimensions)
+  {
+    std::vector<T> mappedValues(dimensions.size());
+    for (size_t i = 0; i < dimensions.size(); ++i)
+    {
+      mappedValues[i] = static_cast<T>(mapper.UnmapValue(missingValue,
+          dimensions[i]));
+    }
+
+    strategy.Impute(input, mappedValues, dimensions, columnMajor);
+  }
+
   //! Get the strategy
   const StrategyType& Strategy() const { return strategy; }
 
@@ -180,6 +180,9 @@ bool Load(const std::string& filename,
  * - CSV (csv_ascii), denoted by .csv, or optionally .txt
  * - TSV (raw_ascii), denoted by .tsv, .csv, or .txt
  * - ASCII (raw_ascii), denoted by .txt
+ * - ARFF, denoted by .arff
+ * - Apache Parquet, denoted by .parquet, if mlpack is built with Arrow support
+ *   (see ParquetFile)
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
@@ -195,6 +198,10 @@ bool Load(const std::string& filename,
  * The DatasetMapper object passed to this function will be re-created, so any
  * mappings from previous loads will be lost.
  *
+ * If mlpack is built with OpenMP, CSV, TSV and text files are parsed in
+ * parallel by chunks of lines (see LoadCSV); the mappings are the same as the
+ * ones of a serial parse.
+ *
  * @param filename Name of file to load.
  * @param matrix Matrix to load contents of file into.
  * @param info DatasetMapper object to populate with mappings and data types.
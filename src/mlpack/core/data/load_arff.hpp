@@ -54,6 +54,73 @@ void LoadARFF(const std::string& filename,
               arma::Mat<eT>& matrix,
               DatasetMapper<PolicyType>& info);
 
+/**
+ * Load an ARFF dataset into a sparse matrix, using the DatasetInfo structure
+ * for mapping like the LoadARFF() overload above.  Both sparse lines of the
+ * form '{index value, ...}' (as written by Weka for sparse instances) and
+ * dense lines can be given, and their nonzero values are inserted into the
+ * matrix at once.  An exception will be thrown upon failure.
+ *
+ * @param filename Name of ARFF file to load.
+ * @param matrix Sparse matrix to load data into.
+ * @param info DatasetInfo object; can be default-constructed or pre-existing
+ *     from another call to LoadARFF().
+ */
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::SpMat<eT>& matrix,
+              DatasetMapper<PolicyType>& info);
+
+/**
+ * Read the header of an ARFF file, up to and including the @data line, and set
+ * up the given DatasetInfo object (see LoadARFF()) with the types of the
+ * dimensions.  The number of lines read is returned.
+ *
+ * @param ifs Stream of the ARFF file, at its beginning.
+ * @param info DatasetInfo object; can be default-constructed or pre-existing.
+ */
+template<typename PolicyType>
+size_t LoadARFFHeader(std::istream& ifs, DatasetMapper<PolicyType>& info);
+
+/**
+ * Parse one line of the @data section of an ARFF file into the given column of
+ * the matrix, which must have as many rows as the dimensionality of the
+ * DatasetInfo object.  The line is trimmed.  It can be a dense line or a
+ * sparse one (see LoadSparseARFFLine()), whose omitted dimensions are set to
+ * 0.
+ *
+ * @param line Line to parse.
+ * @param matrix Matrix to parse into.
+ * @param row Index of the point (that is, of the column of the matrix).
+ * @param info DatasetInfo object from LoadARFFHeader().
+ * @param lineNumber Number of the line in the file, for error messages.
+ */
+template<typename eT, typename PolicyType>
+void LoadARFFLine(std::string& line,
+                  arma::Mat<eT>& matrix,
+                  const size_t row,
+                  DatasetMapper<PolicyType>& info,
+                  const size_t lineNumber);
+
+/**
+ * Parse one sparse line of the @data section of an ARFF file, of the form
+ * '{index value, index value, ...}' with 0-based indices, into the indices of
+ * the given values of the point; the other dimensions of the point are 0.  The
+ * line must be trimmed.
+ *
+ * @param line Line to parse.
+ * @param indices Set to the dimensions of the given values.
+ * @param values Set to the values of the given dimensions.
+ * @param info DatasetInfo object from LoadARFFHeader().
+ * @param lineNumber Number of the line in the file, for error messages.
+ */
+template<typename eT, typename PolicyType>
+void LoadSparseARFFLine(const std::string& line,
+                        std::vector<size_t>& indices,
+                        std::vector<eT>& values,
+                        DatasetMapper<PolicyType>& info,
+                        const size_t lineNumber);
+
 } // namespace data
 } // namespace mlpack
 
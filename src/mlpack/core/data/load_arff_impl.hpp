@@ -17,18 +17,14 @@
 
 #include <boost/algorithm/string/trim.hpp>
 
+#include <algorithm>
+
 namespace mlpack {
 namespace data {
 
-template<typename eT, typename PolicyType>
-void LoadARFF(const std::string& filename,
-              arma::Mat<eT>& matrix,
-              DatasetMapper<PolicyType>& info)
+template<typename PolicyType>
+size_t LoadARFFHeader(std::istream& ifs, DatasetMapper<PolicyType>& info)
 {
-  // First, open the file.
-  std::ifstream ifs;
-  ifs.open(filename);
-
   std::string line;
   size_t dimensionality = 0;
   std::vector<bool> types;
@@ -124,104 +120,314 @@ void LoadARFF(const std::string& filename,
       info.Type(i) = Datatype::numeric;
   }
 
-  // We need to find out how many lines of data are in the file.
-  std::streampos pos = ifs.tellg();
-  size_t row = 0;
-  while (!ifs.eof())
+  return headerLines;
+}
+
+/**
+ * Read the next comma-separated field of a line of the @data section into the
+ * given string, starting at the given position, which is moved past the
+ * separator.  Quotes are removed, a backslash escapes the next character, and
+ * whitespace around the field is stripped.  False is returned if there are no
+ * more fields.
+ */
+inline bool NextARFFField(const std::string& line,
+                          size_t& pos,
+                          const size_t end,
+                          std::string& field)
+{
+  if (pos > end)
+    return false;
+
+  field.clear();
+  bool quoted = false;
+  while (pos < end)
   {
-    std::getline(ifs, line, '\n');
-    ++row;
+    const char c = line[pos++];
+    if (c == '\\' && pos < end)
+      field.push_back(line[pos++]);
+    else if (c == '"' || c == '\'')
+      quoted = !quoted;
+    else if (c == ',' && !quoted)
+    {
+      boost::trim(field);
+      return true;
+    }
+    else
+      field.push_back(c);
+  }
+
+  // This was the last field, so mark the end of the line as read.
+  pos = end + 1;
+  boost::trim(field);
+  return true;
+}
+
+/**
+ * Convert one field of a line of the @data section to a value of the given
+ * dimension, mapping it with the DatasetInfo object if the dimension is
+ * categorical.  Like reading the value from a stream, anything after a number
+ * (like a trailing comment) is ignored.
+ */
+template<typename eT, typename PolicyType>
+eT ParseARFFField(const std::string& field,
+                  const size_t dimension,
+                  DatasetMapper<PolicyType>& info,
+                  const size_t lineNumber)
+{
+  if (info.Type(dimension) == Datatype::categorical)
+    return info.template MapString<eT>(field, dimension);
+
+  const char* begin = field.c_str();
+  char* parsed;
+  const double val = std::strtod(begin, &parsed);
+  if (parsed == begin)
+  {
+    // If it's '?', we issue a specific error, otherwise we issue a general
+    // error.
+    std::stringstream error;
+    if (field == "?")
+      error << "Missing values ('?') not supported, ";
+    else
+      error << "Parse error ";
+    error << "at line " << lineNumber << " token " << dimension << ": \""
+        << field << "\".";
+    throw std::runtime_error(error.str());
+  }
+
+  return eT(val);
+}
+
+template<typename eT, typename PolicyType>
+void LoadARFFLine(std::string& line,
+                  arma::Mat<eT>& matrix,
+                  const size_t row,
+                  DatasetMapper<PolicyType>& info,
+                  const size_t lineNumber)
+{
+  boost::trim(line);
+  // Each line of the @data section is either a CSV line with a value for each
+  // dimension, or, for sparse data, a list of '{index value, ...}' pairs where
+  // the omitted dimensions are 0.  The '?' representing a missing value is not
+  // allowed, so if that occurs we throw an exception.  We also throw an
+  // exception if any piece of data does not match its type (categorical or
+  // numeric).  The fields are parsed in place, without tokenizing the line
+  // first, and written straight into the column of the point.
+  std::string field;
+  if (!line.empty() && line[0] == '{')
+  {
+    matrix.col(row).zeros();
+
+    std::vector<size_t> indices;
+    std::vector<eT> values;
+    LoadSparseARFFLine(line, indices, values, info, lineNumber);
+    for (size_t i = 0; i < indices.size(); ++i)
+      matrix(indices[i], row) = values[i];
+    return;
   }
-  // Uncount the EOF row.
-  --row;
+
+  size_t col = 0;
+  size_t pos = 0;
+  while (NextARFFField(line, pos, line.size(), field))
+  {
+    // Check that we are not too many columns in.
+    if (col >= matrix.n_rows)
+    {
+      std::stringstream error;
+      error << "Too many columns in line " << lineNumber << ".";
+      throw std::runtime_error(error.str());
+    }
+
+    // We load transposed.
+    matrix(col, row) = ParseARFFField<eT>(field, col, info, lineNumber);
+    ++col;
+  }
+}
+
+template<typename eT, typename PolicyType>
+void LoadSparseARFFLine(const std::string& line,
+                        std::vector<size_t>& indices,
+                        std::vector<eT>& values,
+                        DatasetMapper<PolicyType>& info,
+                        const size_t lineNumber)
+{
+  indices.clear();
+  values.clear();
+
+  const size_t end = line.rfind('}');
+  if (line.empty() || line[0] != '{' || end == std::string::npos)
+  {
+    std::stringstream error;
+    error << "Sparse line " << lineNumber << " is not enclosed in braces.";
+    throw std::runtime_error(error.str());
+  }
+
+  std::string field;
+  size_t pos = 1;
+  while (NextARFFField(line, pos, end, field))
+  {
+    if (field.empty())
+      continue; // An empty list, '{}'.
+
+    // The index is separated from the value by whitespace.
+    const char* begin = field.c_str();
+    char* parsed;
+    const unsigned long long index = std::strtoull(begin, &parsed, 10);
+    const size_t valueStart = field.find_first_not_of(" \t",
+        parsed - begin);
+    if (parsed == begin || parsed - begin == (std::ptrdiff_t) field.size() ||
+        (*parsed != ' ' && *parsed != '\t') || valueStart == std::string::npos)
+    {
+      std::stringstream error;
+      error << "Parse error at line " << lineNumber << ": \"" << field
+          << "\" is not an index and a value.";
+      throw std::runtime_error(error.str());
+    }
+    if (index >= info.Dimensionality())
+    {
+      std::stringstream error;
+      error << "Index " << index << " at line " << lineNumber << " is out of "
+          << "bounds for dimensionality " << info.Dimensionality() << ".";
+      throw std::runtime_error(error.str());
+    }
+
+    indices.push_back((size_t) index);
+    values.push_back(ParseARFFField<eT>(field.substr(valueStart),
+        (size_t) index, info, lineNumber));
+  }
+}
+
+/**
+ * Count the lines of the rest of the given stream, reading it in large blocks,
+ * and seek back to where it was.  A last line without a newline also counts.
+ */
+inline size_t CountARFFLines(std::istream& ifs)
+{
+  const std::streampos pos = ifs.tellg();
+
+  size_t lines = 0;
+  bool lastNewline = true;
+  std::vector<char> buffer(1 << 20);
+  while (ifs)
+  {
+    ifs.read(buffer.data(), buffer.size());
+    const std::streamsize count = ifs.gcount();
+    if (count == 0)
+      break;
+
+    lines += (size_t) std::count(buffer.data(), buffer.data() + count, '\n');
+    lastNewline = (buffer[count - 1] == '\n');
+  }
+  if (!lastNewline)
+    ++lines;
 
   // Since we've hit the EOF, we have to call clear() so we can seek again.
   ifs.clear();
   ifs.seekg(pos);
 
-  // Now, set the size of the matrix.
-  matrix.set_size(dimensionality, row);
+  return lines;
+}
+
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::Mat<eT>& matrix,
+              DatasetMapper<PolicyType>& info)
+{
+  // First, open the file.
+  std::ifstream ifs;
+  ifs.open(filename);
+
+  // Read the header; this also sets up the DatasetMapper.
+  const size_t headerLines = LoadARFFHeader(ifs, info);
+  const size_t dimensionality = info.Dimensionality();
+
+  // The number of lines bounds the number of points, so the matrix is only
+  // allocated once.
+  matrix.set_size(dimensionality, CountARFFLines(ifs));
 
   // Now we are looking at the @data section.
-  row = 0;
-  while (!ifs.eof())
+  std::string line;
+  size_t lineNumber = headerLines;
+  size_t row = 0;
+  while (std::getline(ifs, line))
   {
-    std::getline(ifs, line, '\n');
+    ++lineNumber;
+
+    // Skip empty lines and comments.
     boost::trim(line);
-    // Each line of the @data section must be a CSV (except sparse data, which
-    // we will handle later).  So now we can tokenize the
-    // CSV and parse it.  The '?' representing a missing value is not allowed,
-    // so if that occurs we throw an exception.  We also throw an exception if
-    // any piece of data does not match its type (categorical or numeric).
-
-    // If the first character is {, it is sparse data, and we can just say this
-    // is not handled for now...
-    if (line[0] == '{')
-      throw std::runtime_error("cannot yet parse sparse ARFF data");
+    if (line.empty() || line[0] == '%')
+      continue;
 
-    // Tokenize the line.
-    typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
-    boost::escaped_list_separator<char> sep("\\", ",", "\"");
-    Tokenizer tok(line, sep);
+    LoadARFFLine(line, matrix, row, info, lineNumber);
+    ++row;
+  }
 
-    size_t col = 0;
-    std::stringstream token;
-    for (Tokenizer::iterator it = tok.begin(); it != tok.end(); ++it)
-    {
-      // Check that we are not too many columns in.
-      if (col >= matrix.n_rows)
-      {
-        std::stringstream error;
-        error << "Too many columns in line " << (headerLines + row) << ".";
-        throw std::runtime_error(error.str());
-      }
+  if (row < matrix.n_cols)
+    matrix.resize(dimensionality, row);
+}
 
-      // What should this token be?
-      if (info.Type(col) == Datatype::categorical)
-      {
-        // Strip spaces before mapping.
-        std::string token = *it;
-        boost::trim(token);
-        // We load transposed.
-        matrix(col, row) = info.template MapString<eT>(token, col);
-      }
-      else if (info.Type(col) == Datatype::numeric)
-      {
-        // Attempt to read as numeric.
-        token.clear();
-        token.str(*it);
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::SpMat<eT>& matrix,
+              DatasetMapper<PolicyType>& info)
+{
+  std::ifstream ifs;
+  ifs.open(filename);
 
-        eT val = eT(0);
-        token >> val;
+  const size_t headerLines = LoadARFFHeader(ifs, info);
+  const size_t dimensionality = info.Dimensionality();
 
-        if (token.fail())
-        {
-          // Check for NaN or inf.
-          if (!arma::diskio::convert_naninf(val, token.str()))
-          {
-            // Okay, it's not NaN or inf.  If it's '?', we issue a specific
-            // error, otherwise we issue a general error.
-            std::stringstream error;
-            std::string tokenStr = token.str();
-            boost::trim(tokenStr);
-            if (tokenStr == "?")
-              error << "Missing values ('?') not supported, ";
-            else
-              error << "Parse error ";
-            error << "at line " << (headerLines + row) << " token " << col
-                << ": \"" << tokenStr << "\".";
-            throw std::runtime_error(error.str());
-          }
-        }
+  // Collect the nonzero values of each point, column by column, so that the
+  // matrix can be built with one batch insertion.
+  std::vector<arma::uword> locations;
+  std::vector<eT> nonzeros;
+  std::vector<size_t> indices;
+  std::vector<eT> values;
+  arma::Col<eT> point(dimensionality);
+
+  std::string line;
+  size_t lineNumber = headerLines;
+  size_t row = 0;
+  while (std::getline(ifs, line))
+  {
+    ++lineNumber;
+
+    boost::trim(line);
+    if (line.empty() || line[0] == '%')
+      continue;
 
-        // If we made it to here, we have a value.
-        matrix(col, row) = val; // We load transposed.
+    if (line[0] == '{')
+    {
+      LoadSparseARFFLine(line, indices, values, info, lineNumber);
+    }
+    else
+    {
+      // A dense line can be mixed with sparse lines.
+      arma::Mat<eT> column(point.memptr(), dimensionality, 1, false, true);
+      LoadARFFLine(line, column, 0, info, lineNumber);
+      indices.clear();
+      values.clear();
+      for (size_t i = 0; i < dimensionality; ++i)
+      {
+        indices.push_back(i);
+        values.push_back(point[i]);
       }
+    }
 
-      ++col;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      if (values[i] == eT(0))
+        continue;
+      locations.push_back(indices[i]);
+      locations.push_back(row);
+      nonzeros.push_back(values[i]);
     }
     ++row;
   }
+
+  arma::umat locationMatrix(locations.data(), 2, nonzeros.size(), false,
+      true);
+  arma::Col<eT> valueVector(nonzeros.data(), nonzeros.size(), false, true);
+  matrix = arma::SpMat<eT>(locationMatrix, valueVector, dimensionality, row);
 }
 
 } // namespace data
@@ -5,10 +5,13 @@ using namespace boost::spirit;
 namespace mlpack {
 namespace data {
 
-LoadCSV::LoadCSV(const std::string& file) :
+LoadCSV::LoadCSV(const std::string& file, const size_t numThreads) :
   extension(Extension(file)),
   filename(file),
-  inFile(file)
+  inFile(file),
+  numThreads(numThreads),
+  separator((extension == "csv" || extension == "txt") ? ',' : '\t'),
+  spaceSeparated(extension == "txt")
 {
   // Attempt to open stream.
   CheckOpen();
@@ -58,5 +61,23 @@ void LoadCSV::CheckOpen()
   inFile.unsetf(std::ios::skipws);
 }
 
+std::vector<size_t> LoadCSV::ChunkBoundaries(const char* data,
+                                             const size_t size,
+                                             const size_t chunks)
+{
+  std::vector<size_t> boundaries(1, 0);
+  for (size_t i = 1; i < chunks; ++i)
+  {
+    // Move the boundary behind the next newline, so that it starts a line.
+    const size_t start = std::max((size / chunks) * i, boundaries.back());
+    const char* newline = (const char*) std::memchr(data + start, '\n',
+        size - start);
+    boundaries.push_back((newline == NULL) ? size : (newline - data) + 1);
+  }
+  boundaries.push_back(size);
+
+  return boundaries;
+}
+
 } // namespace data
 } // namespace mlpack
@@ -18,12 +18,14 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/util/log.hpp>
 
+#include <cstring>
 #include <set>
 #include <string>
 
 #include "extension.hpp"
 #include "format.hpp"
 #include "dataset_mapper.hpp"
+#include "mapped_file.hpp"
 
 namespace mlpack {
 namespace data {
@@ -32,6 +34,11 @@ namespace data {
  *Load the csv file.This class use boost::spirit
  *to implement the parser, please refer to following link
  *http://theboostcpplibraries.com/boost.spirit for quick review.
+ *
+ * If more than one thread is used, the file is instead mapped into memory and
+ * split into chunks of whole lines, which are parsed in parallel (see
+ * ParallelParse()).  The result is the same as the one of the boost::spirit
+ * parser.
  */
 class LoadCSV
 {
@@ -39,8 +46,12 @@ class LoadCSV
   /**
    * Construct the LoadCSV object on the given file.  This will construct the
    * rules necessary for loading and attempt to open the file.
+   *
+   * @param file Name of the file to load.
+   * @param numThreads Number of threads to parse the file with (0 means the
+   *     number of threads OpenMP uses by default).
    */
-  LoadCSV(const std::string& file);
+  LoadCSV(const std::string& file, const size_t numThreads = 0);
 
   /**
    * Load the file into the given matrix with the given DatasetMapper object.
@@ -58,7 +69,9 @@ class LoadCSV
   {
     CheckOpen();
 
-    if (transpose)
+    if (Threads() > 1)
+      ParallelParse(inout, infoSet, transpose);
+    else if (transpose)
       TransposeParse(inout, infoSet);
     else
       NonTransposeParse(inout, infoSet);
@@ -204,6 +217,22 @@ class LoadCSV
     }
   }
 
+  /**
+   * Split the given line into tokens with the same rules as the boost::spirit
+   * parser, and call the given function on each token, with the beginning and
+   * end of the (trimmed) token and its index in the line.  The number of
+   * tokens is returned.
+   */
+  template<typename TokenFunction>
+  size_t ForEachToken(const char* begin,
+                      const char* end,
+                      TokenFunction& f) const;
+
+  //! Get the number of threads to parse with (0 means the OpenMP default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads to parse with (0 means the OpenMP default).
+  size_t& NumThreads() { return numThreads; }
+
  private:
   using iter_type = boost::iterator_range<std::string::iterator>;
 
@@ -357,6 +386,71 @@ class LoadCSV
     }
   }
 
+  /**
+   * Parse the file with several threads.  The file is mapped into memory and
+   * split into one chunk of whole lines per thread.  The chunks are parsed in
+   * parallel in three passes: a first pass for the DatasetMapper (if
+   * MapPolicy::NeedsFirstPass is true), after which the dimension types of all
+   * chunks are merged; a pass that maps the strings of each chunk with its own
+   * copy of the DatasetMapper, after which the new mappings of the chunks are
+   * added to the DatasetMapper in the order of the file; and a pass that fills
+   * the matrix.  So the mappings do not depend on the number of threads, they
+   * are the same as the ones of the serial parser.
+   *
+   * This requires that MapString() only changes the DatasetMapper when it
+   * creates a new mapping, and that only the dimension types are changed by
+   * the first pass, which is true for IncrementPolicy and MissingPolicy.
+   *
+   * @param inout Matrix to load into.
+   * @param infoSet DatasetMapper to load with.
+   * @param transpose If true, each line of the file is a column of the matrix.
+   */
+  template<typename T, typename PolicyType>
+  void ParallelParse(arma::Mat<T>& inout,
+                     DatasetMapper<PolicyType>& infoSet,
+                     const bool transpose);
+
+  /**
+   * Call the given function on each line of the given part of the file, with
+   * the beginning and end of the line (without the newline) and the index of
+   * the line in the part.
+   */
+  template<typename LineFunction>
+  static void ForEachLine(const char* begin,
+                          const char* end,
+                          LineFunction& f);
+
+  /**
+   * Split the given file contents into the given number of chunks of whole
+   * lines, and return the offsets of the chunk boundaries (including 0 and the
+   * size).
+   */
+  static std::vector<size_t> ChunkBoundaries(const char* data,
+                                             const size_t size,
+                                             const size_t chunks);
+
+  //! Remove whitespace from either side of the given characters.
+  static void Trim(const char*& begin, const char*& end)
+  {
+    while (begin != end && IsSpace(*begin))
+      ++begin;
+    while (begin != end && IsSpace(*(end - 1)))
+      --end;
+  }
+
+  //! Return whether the given character is whitespace (like boost::trim()).
+  static bool IsSpace(const char c)
+  {
+    return (c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+        c == '\r');
+  }
+
+  //! Get the number of threads to use.
+  size_t Threads() const
+  {
+    return ParallelThreads(numThreads);
+  }
+
   //! Spirit rule for parsing.
   boost::spirit::qi::rule<std::string::iterator, iter_type()> stringRule;
   //! Spirit rule for delimiters (i.e. ',' for CSVs).
@@ -368,9 +462,18 @@ class LoadCSV
   std::string filename;
   //! Opened stream for reading.
   std::ifstream inFile;
+  //! The number of threads to parse with.
+  size_t numThreads;
+  //! The character that separates tokens (',' or '\t'), except for text files.
+  char separator;
+  //! Whether tokens are separated by spaces only (text files).
+  bool spaceSeparated;
 };
 
 } // namespace data
 } // namespace mlpack
 
+// Include implementation of the parallel parser.
+#include "load_csv_impl.hpp"
+
 #endif
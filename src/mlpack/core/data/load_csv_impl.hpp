@@ -0,0 +1,298 @@
+/**
+ * @file load_csv_impl.hpp
+ *
+ * Implementation of the parallel parser of LoadCSV, which parses chunks of a
+ * memory-mapped file in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_CSV_IMPL_HPP
+#define MLPACK_CORE_DATA_LOAD_CSV_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "load_csv.hpp"
+
+namespace mlpack {
+namespace data {
+
+template<typename LineFunction>
+void LoadCSV::ForEachLine(const char* begin,
+                          const char* end,
+                          LineFunction& f)
+{
+  size_t line = 0;
+  while (begin != end)
+  {
+    const char* lineEnd = (const char*) std::memchr(begin, '\n', end - begin);
+    if (lineEnd == NULL)
+      lineEnd = end;
+
+    f(begin, lineEnd, line++);
+    begin = (lineEnd == end) ? end : lineEnd + 1;
+  }
+}
+
+template<typename TokenFunction>
+size_t LoadCSV::ForEachToken(const char* begin,
+                             const char* end,
+                             TokenFunction& f) const
+{
+  // Remove whitespace from either side.
+  Trim(begin, end);
+
+  size_t tokens = 0;
+  while (true)
+  {
+    // A token is everything up to a space, a newline or the separator; it may
+    // be empty.
+    const char* tokenEnd = begin;
+    while (tokenEnd != end && *tokenEnd != ' ' && *tokenEnd != '\r' &&
+        *tokenEnd != '\n' && *tokenEnd != separator)
+      ++tokenEnd;
+
+    const char* tokenBegin = begin;
+    const char* trimmedEnd = tokenEnd;
+    Trim(tokenBegin, trimmedEnd);
+    f(tokenBegin, trimmedEnd, tokens++);
+
+    // Now extract the delimiter: any number of spaces for text files, and
+    // otherwise the separator with possibly spaces on either side.  If there
+    // is none, the rest of the line is ignored, like qi::parse() does.
+    begin = tokenEnd;
+    while (begin != end && *begin == ' ')
+      ++begin;
+
+    if (spaceSeparated)
+    {
+      if (begin == tokenEnd)
+        return tokens;
+    }
+    else
+    {
+      if (begin == end || *begin != separator)
+        return tokens;
+
+      ++begin;
+      while (begin != end && *begin == ' ')
+        ++begin;
+    }
+  }
+}
+
+template<typename T, typename PolicyType>
+void LoadCSV::ParallelParse(arma::Mat<T>& inout,
+                            DatasetMapper<PolicyType>& infoSet,
+                            const bool transpose)
+{
+  MappedFile file(filename);
+  const char* data = file.Data();
+  if (file.Size() == 0)
+  {
+    // The serial parser only resets the DatasetMapper if the file has a line
+    // to take the size from, or if it is not transposed.
+    if (!transpose)
+      infoSet = DatasetMapper<PolicyType>(0);
+    inout.set_size(0, 0);
+    return;
+  }
+
+  const size_t threads = Threads();
+  const std::vector<size_t> boundaries = ChunkBoundaries(data, file.Size(),
+      threads);
+  const size_t numChunks = boundaries.size() - 1;
+
+  // Count the lines of each chunk, so that each chunk knows the index of its
+  // first line.
+  std::vector<size_t> firstLine(numChunks + 1, 0);
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+  {
+    size_t lines = 0;
+    auto countLine = [&lines](const char*, const char*, const size_t)
+    {
+      ++lines;
+    };
+    ForEachLine(data + boundaries[c], data + boundaries[c + 1], countLine);
+    firstLine[c + 1] = lines;
+  }
+  for (size_t c = 0; c < numChunks; ++c)
+    firstLine[c + 1] += firstLine[c];
+
+  // The number of tokens of the first line gives the other dimension of the
+  // matrix.
+  const char* firstLineEnd = (const char*) std::memchr(data, '\n',
+      file.Size());
+  if (firstLineEnd == NULL)
+    firstLineEnd = data + file.Size();
+  auto ignoreToken = [](const char*, const char*, const size_t) { };
+  const size_t lineTokens = ForEachToken(data, firstLineEnd, ignoreToken);
+
+  const size_t rows = transpose ? lineTokens : firstLine[numChunks];
+  const size_t cols = transpose ? firstLine[numChunks] : lineTokens;
+  infoSet = DatasetMapper<PolicyType>(rows);
+
+  // The first error of each chunk; the first one in the file is thrown.
+  std::vector<std::string> errors(numChunks);
+
+  if (PolicyType::NeedsFirstPass)
+  {
+    // Run the first pass of each chunk on its own copy of the DatasetMapper,
+    // and then merge the dimension types of the copies.
+    std::vector<DatasetMapper<PolicyType>> chunkInfo(numChunks, infoSet);
+
+    #pragma omp parallel for num_threads(threads) schedule(static)
+    for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+    {
+      DatasetMapper<PolicyType>& info = chunkInfo[c];
+      std::string token;
+      auto firstPassLine = [&](const char* begin, const char* end,
+          const size_t line)
+      {
+        auto firstPassMap = [&](const char* tokenBegin, const char* tokenEnd,
+            const size_t index)
+        {
+          // Lines with too many tokens are reported by the next pass.
+          if (transpose && index >= rows)
+            return;
+
+          token.assign(tokenBegin, tokenEnd);
+          info.template MapFirstPass<T>(token,
+              transpose ? index : firstLine[c] + line);
+        };
+        ForEachToken(begin, end, firstPassMap);
+      };
+
+      try
+      {
+        ForEachLine(data + boundaries[c], data + boundaries[c + 1],
+            firstPassLine);
+      }
+      catch (std::exception& e)
+      {
+        errors[c] = e.what();
+      }
+    }
+
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+      if (!errors[c].empty())
+        throw std::runtime_error(errors[c]);
+
+      for (size_t d = 0; d < rows; ++d)
+        if (chunkInfo[c].Type(d) == Datatype::categorical)
+          infoSet.Type(d) = Datatype::categorical;
+    }
+  }
+
+  // Now map the strings of each chunk with its own copy of the DatasetMapper,
+  // and keep the strings that got a new mapping, in the order of the chunk.
+  std::vector<std::vector<std::pair<size_t, std::string>>> newMappings(
+      numChunks);
+
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+  {
+    DatasetMapper<PolicyType> info(infoSet);
+    std::string token;
+    auto mapLine = [&](const char* begin, const char* end, const size_t line)
+    {
+      auto mapToken = [&](const char* tokenBegin, const char* tokenEnd,
+          const size_t index)
+      {
+        // Lines with the wrong number of tokens are reported below.
+        if (index >= (transpose ? rows : cols))
+          return;
+
+        token.assign(tokenBegin, tokenEnd);
+        const size_t dimension = transpose ? index : firstLine[c] + line;
+        const size_t mappings = info.NumMappings(dimension);
+        info.template MapString<T>(token, dimension);
+        if (info.NumMappings(dimension) != mappings)
+          newMappings[c].push_back(std::make_pair(dimension, token));
+      };
+
+      const size_t tokens = ForEachToken(begin, end, mapToken);
+
+      // Make sure we got the right number of dimensions.
+      if (tokens != (transpose ? rows : cols))
+      {
+        std::ostringstream oss;
+        oss << "LoadCSV::ParallelParse(): wrong number of dimensions ("
+            << tokens << ") on line " << firstLine[c] + line << "; should be "
+            << (transpose ? rows : cols) << " dimensions.";
+        throw std::runtime_error(oss.str());
+      }
+    };
+
+    try
+    {
+      ForEachLine(data + boundaries[c], data + boundaries[c + 1], mapLine);
+    }
+    catch (std::exception& e)
+    {
+      errors[c] = e.what();
+    }
+  }
+
+  // Add the new mappings in the order of the file; strings that are already
+  // mapped by an earlier chunk keep their mapping.  This gives each string
+  // the mapping the serial parser gives it.
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    if (!errors[c].empty())
+      throw std::runtime_error(errors[c]);
+
+    for (size_t i = 0; i < newMappings[c].size(); ++i)
+    {
+      infoSet.template MapString<T>(newMappings[c][i].second,
+          newMappings[c][i].first);
+    }
+    newMappings[c].clear();
+  }
+
+  // Every string is mapped now, so MapString() only looks the mappings up,
+  // and the chunks can be parsed into the matrix with the same DatasetMapper.
+  inout.set_size(rows, cols);
+
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+  {
+    std::string token;
+    auto parseLine = [&](const char* begin, const char* end, const size_t line)
+    {
+      const size_t lineIndex = firstLine[c] + line;
+      auto parseToken = [&](const char* tokenBegin, const char* tokenEnd,
+          const size_t index)
+      {
+        token.assign(tokenBegin, tokenEnd);
+        if (transpose)
+          inout(index, lineIndex) = infoSet.template MapString<T>(token, index);
+        else
+          inout(lineIndex, index) = infoSet.template MapString<T>(token,
+              lineIndex);
+      };
+      ForEachToken(begin, end, parseToken);
+    };
+
+    try
+    {
+      ForEachLine(data + boundaries[c], data + boundaries[c + 1], parseLine);
+    }
+    catch (std::exception& e)
+    {
+      errors[c] = e.what();
+    }
+  }
+
+  for (size_t c = 0; c < numChunks; ++c)
+    if (!errors[c].empty())
+      throw std::runtime_error(errors[c]);
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -27,6 +27,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include "load_arff.hpp"
+#include "load_parquet.hpp"
 
 namespace mlpack {
 namespace data {
@@ -371,6 +372,45 @@ bool Load(const std::string& filename,
       return false;
     }
   }
+  else if (extension == "parquet")
+  {
+#ifdef HAS_ARROW
+    Log::Info << "Loading '" << filename << "' as Parquet dataset.  "
+        << std::flush;
+    try
+    {
+      ParquetFile file(filename);
+      file.Read(matrix, info);
+
+      // Each row of the file is a point, so we have to un-transpose if
+      // necessary.
+      if (!transpose)
+        inplace_transpose(matrix);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+#else
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Attempted to load '" << filename << "' as Parquet data, "
+          << "but mlpack was compiled without Arrow support (USE_ARROW).  "
+          << "Load failed." << std::endl;
+    else
+      Log::Warn << "Attempted to load '" << filename << "' as Parquet data, "
+          << "but mlpack was compiled without Arrow support (USE_ARROW).  "
+          << "Load failed." << std::endl;
+
+    return false;
+#endif
+  }
   else
   {
     // The type is unknown.
@@ -0,0 +1,101 @@
+/**
+ * @file load_parquet.cpp
+ *
+ * Implementation of the ParquetFile class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "load_parquet.hpp"
+
+#ifdef HAS_ARROW
+
+#include <parquet/file_reader.h>
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+ParquetFile::ParquetFile(const std::string& filename,
+                         const std::vector<size_t>& selectedColumns) :
+    filename(filename)
+{
+  parquet::arrow::FileReaderBuilder builder;
+  Check(builder.OpenFile(filename, true), "cannot open");
+
+  const parquet::SchemaDescriptor* schema =
+      builder.raw_reader()->metadata()->schema();
+  const size_t numColumns = (size_t) schema->num_columns();
+  for (size_t i = 0; i < selectedColumns.size(); ++i)
+  {
+    if (selectedColumns[i] >= numColumns)
+    {
+      std::ostringstream oss;
+      oss << "ParquetFile::ParquetFile(): column " << selectedColumns[i]
+          << " selected, but '" << filename << "' only has " << numColumns
+          << " columns";
+      throw std::invalid_argument(oss.str());
+    }
+
+    columns.push_back((int) selectedColumns[i]);
+  }
+
+  if (selectedColumns.empty())
+  {
+    for (size_t i = 0; i < numColumns; ++i)
+      columns.push_back((int) i);
+  }
+
+  // String columns are read as dictionaries, so that each string only has to
+  // be mapped once per row group.
+  parquet::ArrowReaderProperties properties;
+  properties.set_use_threads(true);
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    const bool isString = (schema->Column(columns[i])->physical_type() ==
+        parquet::Type::BYTE_ARRAY);
+    categorical.push_back(isString);
+    if (isString)
+      properties.set_read_dictionary(columns[i], true);
+  }
+
+  Check(builder.properties(properties)->Build(&reader), "cannot read");
+}
+
+size_t ParquetFile::NumRows() const
+{
+  return (size_t) reader->parquet_reader()->metadata()->num_rows();
+}
+
+size_t ParquetFile::NumRowGroups() const
+{
+  return (size_t) reader->num_row_groups();
+}
+
+bool ParquetFile::IsNumeric(const arrow::Type::type type)
+{
+  return (type == arrow::Type::BOOL || type == arrow::Type::INT8 ||
+      type == arrow::Type::INT16 || type == arrow::Type::INT32 ||
+      type == arrow::Type::INT64 || type == arrow::Type::UINT8 ||
+      type == arrow::Type::UINT16 || type == arrow::Type::UINT32 ||
+      type == arrow::Type::UINT64 || type == arrow::Type::FLOAT ||
+      type == arrow::Type::DOUBLE);
+}
+
+bool ParquetFile::IsString(const arrow::Type::type type)
+{
+  return (type == arrow::Type::STRING || type == arrow::Type::BINARY);
+}
+
+void ParquetFile::Check(const arrow::Status& status,
+                        const std::string& action) const
+{
+  if (!status.ok())
+  {
+    throw std::runtime_error("ParquetFile: " + action + " '" + filename +
+        "': " + status.ToString());
+  }
+}
+
+#endif // HAS_ARROW
@@ -0,0 +1,160 @@
+/**
+ * @file load_parquet.hpp
+ *
+ * Definition of the ParquetFile class, which loads columns of Apache Parquet
+ * files with Apache Arrow.  It is only available if mlpack is built with Arrow
+ * support (the USE_ARROW CMake option).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_PARQUET_HPP
+#define MLPACK_CORE_DATA_LOAD_PARQUET_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "dataset_mapper.hpp"
+
+#ifdef HAS_ARROW
+
+#include <arrow/api.h>
+#include <parquet/arrow/reader.h>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A Parquet file, of which selected columns can be read into a matrix, either
+ * all at once or one row group at a time.  Each row of the file is a point, so
+ * each selected column is a dimension of the matrix (like data::Load() does
+ * with CSV files by default).
+ *
+ * Numeric and boolean columns are read as numeric dimensions; null values are
+ * read as NaN.  String (and binary) columns are categorical dimensions, which
+ * are mapped with the DatasetMapper in the order the strings appear in.
+ * Dictionary-encoded columns are read without decoding them, so each string of
+ * the dictionary of a row group is only mapped once.  Other types (like nested
+ * columns) are not supported.
+ *
+ * Arrow reads the columns with several threads, and the numeric columns are
+ * converted to the matrix in parallel with OpenMP.
+ *
+ * @code
+ * data::ParquetFile file("features.parquet", { 0, 2, 3 });
+ * arma::mat dataset;
+ * data::DatasetInfo info;
+ * file.Read(dataset, info);
+ * @endcode
+ */
+class ParquetFile
+{
+ public:
+  /**
+   * Open the given Parquet file; the file is memory-mapped.  A
+   * std::runtime_error is thrown if it cannot be opened, and a
+   * std::invalid_argument if a selected column does not exist.
+   *
+   * @param filename Name of the file to open.
+   * @param columns Indices of the columns to read (all columns, if empty).
+   */
+  ParquetFile(const std::string& filename,
+              const std::vector<size_t>& columns = std::vector<size_t>());
+
+  /**
+   * Read the selected columns of all rows of the file into the given matrix.
+   * The DatasetMapper is set up for the dimensions first: if its
+   * dimensionality is 0, it is re-created; otherwise its dimensionality has to
+   * be the number of selected columns (or a std::invalid_argument is thrown),
+   * so that the mappings of a training set can be used for a test set.
+   *
+   * @param matrix Matrix to read into.
+   * @param info DatasetMapper to map strings with.
+   */
+  template<typename eT, typename PolicyType>
+  void Read(arma::Mat<eT>& matrix, DatasetMapper<PolicyType>& info);
+
+  /**
+   * Read the selected columns of the rows of the given row group into the
+   * given matrix.  The DatasetMapper is set up like with Read().
+   *
+   * @param rowGroup Index of the row group to read.
+   * @param matrix Matrix to read into.
+   * @param info DatasetMapper to map strings with.
+   */
+  template<typename eT, typename PolicyType>
+  void ReadRowGroup(const size_t rowGroup,
+                    arma::Mat<eT>& matrix,
+                    DatasetMapper<PolicyType>& info);
+
+  /**
+   * Set up the given DatasetMapper for the selected columns (see Read()).
+   *
+   * @param info DatasetMapper to set up.
+   */
+  template<typename PolicyType>
+  void InitializeInfo(DatasetMapper<PolicyType>& info) const;
+
+  //! Get the number of selected columns (the dimensionality of the matrix).
+  size_t Dimensionality() const { return columns.size(); }
+  //! Get the number of rows of the file.
+  size_t NumRows() const;
+  //! Get the number of row groups of the file.
+  size_t NumRowGroups() const;
+
+ private:
+  //! Convert the columns of the given table to the matrix.
+  template<typename eT, typename PolicyType>
+  void Convert(const arrow::Table& table,
+               arma::Mat<eT>& matrix,
+               DatasetMapper<PolicyType>& info) const;
+
+  //! Convert a numeric column to the given dimension of the matrix.
+  template<typename eT>
+  static void ConvertNumeric(const arrow::ChunkedArray& column,
+                             arma::Mat<eT>& matrix,
+                             const size_t dimension);
+
+  //! Copy the values of a numeric array to the matrix.
+  template<typename ArrayType, typename eT>
+  static void CopyValues(const arrow::Array& array,
+                         arma::Mat<eT>& matrix,
+                         const size_t dimension,
+                         const size_t firstPoint);
+
+  //! Map a string column to the given dimension of the matrix.
+  template<typename eT, typename PolicyType>
+  static void ConvertStrings(const arrow::ChunkedArray& column,
+                             arma::Mat<eT>& matrix,
+                             const size_t dimension,
+                             DatasetMapper<PolicyType>& info);
+
+  //! Return whether columns of the given type can be read as numeric.
+  static bool IsNumeric(const arrow::Type::type type);
+
+  //! Return whether columns of the given type can be read as strings.
+  static bool IsString(const arrow::Type::type type);
+
+  //! Throw a std::runtime_error if the given status is not OK.
+  void Check(const arrow::Status& status, const std::string& action) const;
+
+  //! The name of the file.
+  std::string filename;
+  //! The Arrow reader of the file.
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  //! The indices of the selected columns.
+  std::vector<int> columns;
+  //! Whether each selected column holds strings.
+  std::vector<bool> categorical;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "load_parquet_impl.hpp"
+
+#endif // HAS_ARROW
+
+#endif
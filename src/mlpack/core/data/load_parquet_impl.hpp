@@ -0,0 +1,239 @@
+/**
+ * @file load_parquet_impl.hpp
+ *
+ * Implementation of the templated functions of the ParquetFile class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_PARQUET_IMPL_HPP
+#define MLPACK_CORE_DATA_LOAD_PARQUET_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "load_parquet.hpp"
+
+namespace mlpack {
+namespace data {
+
+template<typename eT, typename PolicyType>
+void ParquetFile::Read(arma::Mat<eT>& matrix, DatasetMapper<PolicyType>& info)
+{
+  std::shared_ptr<arrow::Table> table;
+  Check(reader->ReadTable(columns, &table), "cannot read");
+  Convert(*table, matrix, info);
+}
+
+template<typename eT, typename PolicyType>
+void ParquetFile::ReadRowGroup(const size_t rowGroup,
+                               arma::Mat<eT>& matrix,
+                               DatasetMapper<PolicyType>& info)
+{
+  if (rowGroup >= NumRowGroups())
+  {
+    std::ostringstream oss;
+    oss << "ParquetFile::ReadRowGroup(): row group " << rowGroup << " of '"
+        << filename << "' requested, but it only has " << NumRowGroups()
+        << " row groups";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::shared_ptr<arrow::Table> table;
+  Check(reader->ReadRowGroup((int) rowGroup, columns, &table),
+      "cannot read a row group of");
+  Convert(*table, matrix, info);
+}
+
+template<typename PolicyType>
+void ParquetFile::InitializeInfo(DatasetMapper<PolicyType>& info) const
+{
+  if (info.Dimensionality() == 0)
+  {
+    info = DatasetMapper<PolicyType>(columns.size());
+  }
+  else if (info.Dimensionality() != columns.size())
+  {
+    std::ostringstream oss;
+    oss << "ParquetFile::InitializeInfo(): given DatasetInfo has "
+        << "dimensionality " << info.Dimensionality() << ", but data has "
+        << "dimensionality " << columns.size();
+    throw std::invalid_argument(oss.str());
+  }
+
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    if (categorical[i])
+      info.Type(i) = Datatype::categorical;
+    else
+      info.Type(i) = Datatype::numeric;
+  }
+}
+
+template<typename eT, typename PolicyType>
+void ParquetFile::Convert(const arrow::Table& table,
+                          arma::Mat<eT>& matrix,
+                          DatasetMapper<PolicyType>& info) const
+{
+  InitializeInfo(info);
+
+  // Make sure all columns can be converted before converting any of them.
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    const arrow::Type::type type = table.column((int) i)->type()->id();
+    const bool supported = categorical[i] ? (IsString(type) ||
+        type == arrow::Type::DICTIONARY) : IsNumeric(type);
+    if (!supported)
+    {
+      std::ostringstream oss;
+      oss << "ParquetFile::Read(): column " << columns[i] << " of '"
+          << filename << "' has the unsupported type "
+          << table.column((int) i)->type()->ToString();
+      throw std::runtime_error(oss.str());
+    }
+  }
+
+  matrix.set_size(columns.size(), table.num_rows());
+
+  // The numeric columns are independent, so they are converted in parallel.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) columns.size(); ++i)
+  {
+    if (!categorical[i])
+      ConvertNumeric(*table.column((int) i), matrix, i);
+  }
+
+  // All dimensions share the maps of the DatasetMapper, so the strings are
+  // mapped serially.
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    if (categorical[i])
+      ConvertStrings(*table.column((int) i), matrix, i, info);
+  }
+}
+
+template<typename eT>
+void ParquetFile::ConvertNumeric(const arrow::ChunkedArray& column,
+                                 arma::Mat<eT>& matrix,
+                                 const size_t dimension)
+{
+  size_t firstPoint = 0;
+  for (int c = 0; c < column.num_chunks(); ++c)
+  {
+    const arrow::Array& array = *column.chunk(c);
+    switch (array.type_id())
+    {
+      case arrow::Type::BOOL:
+        CopyValues<arrow::BooleanArray>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::INT8:
+        CopyValues<arrow::Int8Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::INT16:
+        CopyValues<arrow::Int16Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::INT32:
+        CopyValues<arrow::Int32Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::INT64:
+        CopyValues<arrow::Int64Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::UINT8:
+        CopyValues<arrow::UInt8Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::UINT16:
+        CopyValues<arrow::UInt16Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::UINT32:
+        CopyValues<arrow::UInt32Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::UINT64:
+        CopyValues<arrow::UInt64Array>(array, matrix, dimension, firstPoint);
+        break;
+      case arrow::Type::FLOAT:
+        CopyValues<arrow::FloatArray>(array, matrix, dimension, firstPoint);
+        break;
+      default:
+        CopyValues<arrow::DoubleArray>(array, matrix, dimension, firstPoint);
+        break;
+    }
+
+    firstPoint += array.length();
+  }
+}
+
+template<typename ArrayType, typename eT>
+void ParquetFile::CopyValues(const arrow::Array& array,
+                             arma::Mat<eT>& matrix,
+                             const size_t dimension,
+                             const size_t firstPoint)
+{
+  const ArrayType& values = static_cast<const ArrayType&>(array);
+  for (int64_t i = 0; i < values.length(); ++i)
+  {
+    matrix(dimension, firstPoint + i) = values.IsNull(i) ?
+        std::numeric_limits<eT>::quiet_NaN() : eT(values.Value(i));
+  }
+}
+
+template<typename eT, typename PolicyType>
+void ParquetFile::ConvertStrings(const arrow::ChunkedArray& column,
+                                 arma::Mat<eT>& matrix,
+                                 const size_t dimension,
+                                 DatasetMapper<PolicyType>& info)
+{
+  size_t firstPoint = 0;
+  for (int c = 0; c < column.num_chunks(); ++c)
+  {
+    const arrow::Array& array = *column.chunk(c);
+    if (array.type_id() == arrow::Type::DICTIONARY)
+    {
+      const arrow::DictionaryArray& encoded =
+          static_cast<const arrow::DictionaryArray&>(array);
+      const arrow::BinaryArray& dictionary =
+          static_cast<const arrow::BinaryArray&>(*encoded.dictionary());
+
+      // Map the strings of the dictionary in the order they appear in, so the
+      // mappings are the same as if the column was not encoded.
+      std::vector<eT> mappings(dictionary.length());
+      std::vector<bool> mapped(dictionary.length(), false);
+      for (int64_t i = 0; i < encoded.length(); ++i)
+      {
+        if (encoded.IsNull(i))
+        {
+          matrix(dimension, firstPoint + i) =
+              info.template MapString<eT>("", dimension);
+          continue;
+        }
+
+        const int64_t index = encoded.GetValueIndex(i);
+        if (!mapped[index])
+        {
+          mappings[index] = info.template MapString<eT>(
+              dictionary.GetString(index), dimension);
+          mapped[index] = true;
+        }
+        matrix(dimension, firstPoint + i) = mappings[index];
+      }
+    }
+    else
+    {
+      // Null values are mapped like empty fields of CSV files.
+      const arrow::BinaryArray& strings =
+          static_cast<const arrow::BinaryArray&>(array);
+      for (int64_t i = 0; i < strings.length(); ++i)
+      {
+        matrix(dimension, firstPoint + i) = info.template MapString<eT>(
+            strings.IsNull(i) ? std::string() : strings.GetString(i),
+            dimension);
+      }
+    }
+
+    firstPoint += array.length();
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,232 @@
+/**
+ * @file intern_policy.hpp
+ *
+ * Definition of InternPolicy, a map policy for DatasetMapper for categorical
+ * dimensions with many distinct strings.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAP_POLICIES_INTERN_POLICY_HPP
+#define MLPACK_CORE_DATA_MAP_POLICIES_INTERN_POLICY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/map_policies/datatype.hpp>
+#include <mlpack/core/data/map_policies/map_policy_traits.hpp>
+#include <mlpack/core/data/map_policies/string_interner.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * InternPolicy is used as a helper class for DatasetMapper.  It maps strings
+ * the same way as IncrementPolicy: a dimension is categorical if any of its
+ * strings cannot be read as a number (or always, if 'forceAllMappings' is
+ * true), and the strings of a categorical dimension are mapped to 0, 1, 2 and
+ * so on, in the order they are first seen.
+ *
+ * Unlike IncrementPolicy, the mappings are not stored in the maps of the
+ * DatasetMapper, but in a StringInterner for each dimension held by the
+ * policy, which stores the strings in a single arena and finds them with an
+ * open addressing hash table.  This uses a fraction of the memory of the
+ * maps, and is faster to build, for dimensions with millions of distinct
+ * strings (like user IDs).  DatasetMapper::UnmapString() then returns a copy
+ * of the string instead of a reference.
+ *
+ * @code
+ * data::DatasetMapper<data::InternPolicy> info;
+ * arma::mat dataset;
+ * data::Load("events.csv", dataset, info);
+ * @endcode
+ *
+ * DatasetMappers built separately (for example, by different threads, each
+ * loading a part of a dataset) can be combined with DatasetMapper::Merge().
+ * Once every string is mapped, MapString() only reads the mappings, so several
+ * threads may map strings with the same DatasetMapper at once (as the parallel
+ * CSV parser does).  New mappings are added by one thread at a time, but they
+ * must not be added while other threads look strings up.
+ */
+class InternPolicy
+{
+ public:
+  InternPolicy(const bool forceAllMappings = false) :
+      forceAllMappings(forceAllMappings) { }
+
+  // typedef of MappedType
+  using MappedType = size_t;
+
+  //! We do need a first pass over the data to set the dimension types right.
+  static const bool NeedsFirstPass = true;
+
+  /**
+   * Determine if the dimension is numeric or categorical.
+   */
+  template<typename T, typename InputType>
+  void MapFirstPass(const InputType& input,
+                    const size_t dim,
+                    std::vector<Datatype>& types)
+  {
+    if (types[dim] == Datatype::categorical)
+    {
+      // No need to check; it's already categorical.
+      return;
+    }
+
+    if (forceAllMappings || !IsNumber<T>(input))
+      types[dim] = Datatype::categorical;
+  }
+
+  /**
+   * Given the input and the dimension to which it belongs, return its numeric
+   * mapping.  If no mapping yet exists, the input is interned for the given
+   * dimension.  The maps of the DatasetMapper are not used.
+   *
+   * @tparam MapType Type of unordered_map that contains mapped value pairs
+   * @param input Input to find/create mapping for.
+   * @param dimension Index of the dimension of the input.
+   * @param maps Unordered map given by the DatasetMapper (unused).
+   * @param types Vector containing the type information about each dimensions.
+   */
+  template<typename MapType, typename T, typename InputType>
+  T MapString(const InputType& input,
+              const size_t dimension,
+              MapType& /* maps */,
+              std::vector<Datatype>& types)
+  {
+    // If we are in a categorical dimension we already know we need to map.
+    if (types[dimension] == Datatype::numeric && !forceAllMappings)
+    {
+      T val;
+      if (IsNumber<T>(input, &val))
+        return val;
+
+      // Otherwise, we must map.
+    }
+
+    // Strings that are already mapped are only looked up.
+    size_t value;
+    if (dimension < interners.size() &&
+        interners[dimension].Find(input, value))
+      return T(value);
+
+    #pragma omp critical(InternPolicyMapString)
+    {
+      if (dimension >= interners.size())
+        interners.resize(dimension + 1);
+
+      // Change type of the feature to categorical.
+      types[dimension] = Datatype::categorical;
+
+      value = interners[dimension].Intern(input);
+    }
+
+    return T(value);
+  }
+
+  //! Get the number of mappings of the given dimension.
+  size_t NumMappings(const size_t dimension) const
+  {
+    return (dimension < interners.size()) ? interners[dimension].Size() : 0;
+  }
+
+  /**
+   * Return the string that is mapped to the given value in the given
+   * dimension.  A std::invalid_argument is thrown if there is no such string.
+   */
+  std::string UnmapString(const MappedType value,
+                          const size_t dimension) const
+  {
+    if (value >= NumMappings(dimension))
+    {
+      std::ostringstream oss;
+      oss << "InternPolicy::UnmapString(): value '" << value << "' unknown "
+          << "for dimension " << dimension;
+      throw std::invalid_argument(oss.str());
+    }
+
+    return interners[dimension].String(value);
+  }
+
+  /**
+   * Return the value the given string is mapped to in the given dimension.  A
+   * std::invalid_argument is thrown if the string is not mapped.
+   */
+  MappedType UnmapValue(const std::string& input,
+                        const size_t dimension) const
+  {
+    size_t value;
+    if (dimension >= interners.size() ||
+        !interners[dimension].Find(input, value))
+    {
+      std::ostringstream oss;
+      oss << "InternPolicy::UnmapValue(): input '" << input << "' unknown "
+          << "for dimension " << dimension;
+      throw std::invalid_argument(oss.str());
+    }
+
+    return value;
+  }
+
+  //! Serialize the policy and its mappings.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(forceAllMappings, "forceAllMappings");
+
+    size_t dimensions = interners.size();
+    ar & data::CreateNVP(dimensions, "dimensions");
+    if (Archive::is_loading::value)
+    {
+      interners.clear();
+      interners.resize(dimensions);
+    }
+
+    for (size_t i = 0; i < dimensions; ++i)
+    {
+      std::ostringstream oss;
+      oss << "interner" << i;
+      ar & data::CreateNVP(interners[i], oss.str());
+    }
+  }
+
+ private:
+  /**
+   * Return whether the given input can be read as a number of type T (into
+   * the given value, if it is not NULL), the same way IncrementPolicy does.
+   */
+  template<typename T, typename InputType>
+  static bool IsNumber(const InputType& input, T* value = NULL)
+  {
+    std::stringstream token;
+    token << input;
+    T val;
+    token >> val;
+
+    if (token.fail() || !token.eof())
+      return false;
+
+    if (value)
+      *value = val;
+    return true;
+  }
+
+  // Whether or not we should map all tokens.
+  bool forceAllMappings;
+
+  //! The strings of each dimension.
+  std::vector<StringInterner> interners;
+}; // class InternPolicy
+
+//! InternPolicy holds its own mappings.
+template<>
+struct MapPolicyTraits<InternPolicy>
+{
+  static const bool OwnsMappings = true;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
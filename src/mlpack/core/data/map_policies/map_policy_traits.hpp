@@ -0,0 +1,48 @@
+/**
+ * @file map_policy_traits.hpp
+ *
+ * A class for template metaprogramming traits for the map policies of
+ * DatasetMapper.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAP_POLICIES_MAP_POLICY_TRAITS_HPP
+#define MLPACK_CORE_DATA_MAP_POLICIES_MAP_POLICY_TRAITS_HPP
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A class to obtain compile-time traits about MapPolicy classes.  If you are
+ * writing your own MapPolicy class, you should make a template specialization
+ * in order to set the values correctly.
+ */
+template<typename PolicyType>
+struct MapPolicyTraits
+{
+  /**
+   * If true, then the policy stores the mappings itself, instead of in the
+   * maps that DatasetMapper passes to MapString(), and DatasetMapper queries
+   * the policy for them.  Such a policy must implement the following
+   * functions:
+   *
+   *   size_t NumMappings(const size_t dimension) const;
+   *   InputType UnmapString(const MappedType value,
+   *                         const size_t dimension) const;
+   *   MappedType UnmapValue(const InputType& input,
+   *                         const size_t dimension) const;
+   *   template<typename Archive>
+   *   void Serialize(Archive& ar, const unsigned int version);
+   *
+   * This defaults to false.
+   */
+  static const bool OwnsMappings = false;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file string_interner.cpp
+ *
+ * Implementation of the StringInterner class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "string_interner.hpp"
+
+namespace mlpack {
+namespace data {
+
+StringInterner::StringInterner() :
+    offsets(1, 0)
+{
+  // Nothing else to do.
+}
+
+size_t StringInterner::Intern(const std::string& str)
+{
+  // Strings that are already there are only looked up, so that Intern() does
+  // not modify the set for them.
+  size_t index;
+  if (Find(str, index))
+    return index;
+
+  // Keep the load factor under 0.7.
+  if (10 * (Size() + 1) > 7 * slots.size())
+    Rehash(2 * slots.size());
+
+  const size_t slot = Slot(str.data(), str.size());
+
+  arena.insert(arena.end(), str.begin(), str.end());
+  offsets.push_back(arena.size());
+  slots[slot] = Size();
+
+  return Size() - 1;
+}
+
+bool StringInterner::Find(const std::string& str, size_t& index) const
+{
+  if (slots.empty())
+    return false;
+
+  const size_t slot = Slot(str.data(), str.size());
+  if (slots[slot] == 0)
+    return false;
+
+  index = slots[slot] - 1;
+  return true;
+}
+
+size_t StringInterner::Slot(const char* str, const size_t length) const
+{
+  const size_t mask = slots.size() - 1;
+  size_t slot = Hash(str, length) & mask;
+  while (slots[slot] != 0)
+  {
+    const size_t index = slots[slot] - 1;
+    const size_t otherLength = offsets[index + 1] - offsets[index];
+    if (otherLength == length &&
+        std::memcmp(arena.data() + offsets[index], str, length) == 0)
+      break;
+
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+void StringInterner::Rehash(size_t numSlots)
+{
+  numSlots = std::max(numSlots, (size_t) 16);
+  while (10 * Size() > 7 * numSlots)
+    numSlots *= 2;
+
+  slots.assign(numSlots, 0);
+  for (size_t i = 0; i < Size(); ++i)
+  {
+    const size_t slot = Slot(arena.data() + offsets[i],
+        offsets[i + 1] - offsets[i]);
+    slots[slot] = i + 1;
+  }
+}
+
+size_t StringInterner::Hash(const char* str, const size_t length)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; ++i)
+  {
+    hash ^= (unsigned char) str[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return (size_t) hash;
+}
+
+} // namespace data
+} // namespace mlpack
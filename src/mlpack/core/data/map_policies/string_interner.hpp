@@ -0,0 +1,99 @@
+/**
+ * @file string_interner.hpp
+ *
+ * Definition of the StringInterner class, which assigns consecutive indices to
+ * distinct strings with little memory per string.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAP_POLICIES_STRING_INTERNER_HPP
+#define MLPACK_CORE_DATA_MAP_POLICIES_STRING_INTERNER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A set of distinct strings, each of which is identified by its index (in the
+ * order the strings were added).  The characters of all strings are stored
+ * back to back in a single arena, and the strings are found through an open
+ * addressing hash table (with linear probing) of their indices.  This takes
+ * at most around 30 bytes per string plus its characters, instead of the
+ * separate allocations of std::string keys and of the nodes of
+ * std::unordered_map, so that columns with millions of distinct strings can be
+ * mapped.
+ */
+class StringInterner
+{
+ public:
+  //! Create an empty set of strings.
+  StringInterner();
+
+  /**
+   * Return the index of the given string, adding it to the set if it is not
+   * there yet.  If the string is already there, the set is not modified, so
+   * that several threads may call Intern() at once for strings that are all
+   * in the set.
+   *
+   * @param str String to find or add.
+   */
+  size_t Intern(const std::string& str);
+
+  /**
+   * Find the index of the given string.  If it is not in the set, false is
+   * returned and index is not modified.
+   *
+   * @param str String to find.
+   * @param index Index of the string, if it is found.
+   */
+  bool Find(const std::string& str, size_t& index) const;
+
+  //! Get the string of the given index.
+  std::string String(const size_t index) const
+  {
+    return std::string(arena.data() + offsets[index],
+        offsets[index + 1] - offsets[index]);
+  }
+
+  //! Get the number of strings.
+  size_t Size() const { return offsets.size() - 1; }
+
+  //! Serialize the strings (the hash table is rebuilt when loading).
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(arena, "arena");
+    ar & data::CreateNVP(offsets, "offsets");
+
+    if (Archive::is_loading::value)
+      Rehash(slots.size());
+  }
+
+ private:
+  //! Find the slot of the given string; it is empty if the string is not in
+  //! the set.
+  size_t Slot(const char* str, const size_t length) const;
+
+  //! Rebuild the hash table with (at least) the given number of slots.
+  void Rehash(size_t numSlots);
+
+  //! The 64-bit FNV-1a hash of the given characters.
+  static size_t Hash(const char* str, const size_t length);
+
+  //! The characters of all strings.
+  std::vector<char> arena;
+  //! The offset of each string in the arena, followed by the arena size.
+  std::vector<size_t> offsets;
+  //! The hash table, holding the index of a string plus one (or zero for an
+  //! empty slot).  Its size is a power of two.
+  std::vector<size_t> slots;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
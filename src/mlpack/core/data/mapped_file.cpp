@@ -0,0 +1,80 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of the MappedFile class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+MappedFile::MappedFile(const std::string& filename) :
+    filename(filename),
+    data(NULL),
+    size(0)
+{
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  struct stat fileInfo;
+  if (fstat(fd, &fileInfo) == -1)
+  {
+    close(fd);
+    throw std::runtime_error("cannot get the size of file '" + filename + "'");
+  }
+
+  size = (size_t) fileInfo.st_size;
+  if (size > 0)
+  {
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+      close(fd);
+      throw std::runtime_error("cannot map file '" + filename + "'");
+    }
+
+    data = static_cast<const char*>(mapping);
+  }
+
+  // The mapping stays valid after the file is closed.
+  close(fd);
+#else
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  stream.seekg(0, std::ios::end);
+  size = (size_t) stream.tellg();
+  stream.seekg(0, std::ios::beg);
+
+  buffer.resize(size);
+  if (size > 0 && !stream.read(buffer.data(), size))
+    throw std::runtime_error("cannot read file '" + filename + "'");
+
+  data = buffer.data();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+  if (data != NULL)
+    munmap(const_cast<char*>(data), size);
+#endif
+}
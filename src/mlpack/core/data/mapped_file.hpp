@@ -0,0 +1,66 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * Definition of the MappedFile class, which maps a file into memory read-only.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A read-only view of the contents of a file.  On POSIX systems the file is
+ * mapped into memory with mmap(), so nothing is read until it is used, and
+ * several processes mapping the same file share one copy of it in the page
+ * cache.  On other systems the file is read into memory instead.
+ *
+ * The MappedFile must outlive any object that points into its contents.
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file into memory.  A std::runtime_error is thrown if the
+   * file cannot be opened or mapped.
+   *
+   * @param filename Name of the file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Unmap the file.
+  ~MappedFile();
+
+  // A mapping cannot be copied.
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  //! Get the contents of the file.
+  const char* Data() const { return data; }
+  //! Get the size of the file in bytes.
+  size_t Size() const { return size; }
+  //! Get the name of the mapped file.
+  const std::string& Filename() const { return filename; }
+
+ private:
+  //! The name of the mapped file.
+  std::string filename;
+  //! The contents of the file.
+  const char* data;
+  //! The size of the file in bytes.
+  size_t size;
+  //! The contents of the file, if it could not be mapped.
+  std::vector<char> buffer;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file mapped_matrix.hpp
+ *
+ * Definition of the MappedMatrix class, which gives read-only access to a
+ * matrix in an Armadillo binary or raw binary file without reading it into
+ * memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+#define MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A read-only matrix whose memory is a memory-mapped Armadillo binary
+ * (arma_binary) or raw binary (raw_binary) file (see MappedFile).  Nothing is
+ * read when the matrix is created, and several processes that map the same
+ * file share one copy of it in the page cache, so a large reference set can
+ * be shared between the worker processes of a machine.
+ *
+ * Matrix() can be passed to anything that only needs const access to the
+ * matrix, like KMeans::Cluster() or NeighborSearch in naive mode; writing into
+ * the matrix is an error.  Since the matrix is used as it is stored, it is not
+ * transposed like with data::Load(), so the file has to be saved without
+ * transposing it, for example with Save() below.
+ *
+ * The elements have to be stored with the type eT, and have to be aligned for
+ * it in the file.  Save() pads the header of the file so that this is always
+ * the case.  The data of other Armadillo binary files may not be aligned; then
+ * it is copied into memory instead (and IsMapped() returns false).
+ *
+ * @code
+ * // Once, in one process:
+ * data::MappedMatrix<>::Save("reference.bin", referenceSet);
+ *
+ * // Then, in each worker process:
+ * data::MappedMatrix<> reference("reference.bin");
+ * arma::Row<size_t> assignments;
+ * KMeans<> k;
+ * k.Cluster(reference.Matrix(), clusters, assignments);
+ * @endcode
+ *
+ * @tparam eT Element type of the matrix.
+ */
+template<typename eT = double>
+class MappedMatrix
+{
+ public:
+  /**
+   * Map the matrix in the given file.  If the file starts with an Armadillo
+   * binary header, the size of the matrix is taken from it, and the header
+   * must be the one of eT elements.  Otherwise the file is raw binary, and the
+   * matrix has the given number of rows (or is one column, if rawRows is 0).
+   * A std::runtime_error is thrown if the file cannot be mapped or does not
+   * hold a matrix of eT elements.
+   *
+   * @param filename Name of the file to map.
+   * @param rawRows Number of rows of the matrix in a raw binary file.
+   */
+  MappedMatrix(const std::string& filename, const size_t rawRows = 0);
+
+  /**
+   * Create another matrix that uses the same mapping.
+   */
+  MappedMatrix(const MappedMatrix& other);
+
+  // The matrix cannot be replaced.
+  MappedMatrix& operator=(const MappedMatrix& other) = delete;
+
+  //! Get the matrix.
+  const arma::Mat<eT>& Matrix() const { return *matrix; }
+
+  //! Get whether the matrix uses the memory of the mapped file.
+  bool IsMapped() const { return mapped; }
+
+  /**
+   * Save the given matrix to an Armadillo binary file that can be loaded by
+   * data::Load(), with its header padded such that the elements can always be
+   * mapped.  The matrix is not transposed.  A std::runtime_error is thrown if
+   * the file cannot be written.
+   *
+   * @param filename Name of the file to write.
+   * @param matrix Matrix to save.
+   */
+  static void Save(const std::string& filename, const arma::Mat<eT>& matrix);
+
+ private:
+  //! The mapped file.
+  std::shared_ptr<MappedFile> file;
+  //! The matrix.
+  std::unique_ptr<arma::Mat<eT>> matrix;
+  //! Whether the matrix uses the memory of the mapped file.
+  bool mapped;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "mapped_matrix_impl.hpp"
+
+#endif
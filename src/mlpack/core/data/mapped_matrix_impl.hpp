@@ -0,0 +1,162 @@
+/**
+ * @file mapped_matrix_impl.hpp
+ *
+ * Implementation of the MappedMatrix class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+#define MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mapped_matrix.hpp"
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix(const std::string& filename,
+                               const size_t rawRows) :
+    file(std::make_shared<MappedFile>(filename)),
+    mapped(true)
+{
+  const char* data = file->Data();
+  const size_t size = file->Size();
+
+  size_t rows = 0;
+  size_t cols = 0;
+  size_t offset = 0;
+  const std::string armaMatBin = "ARMA_MAT_BIN";
+  if (size >= armaMatBin.size() &&
+      std::memcmp(data, armaMatBin.data(), armaMatBin.size()) == 0)
+  {
+    // The header is the element type and the size, each on its own line.
+    const char* headerEnd = (const char*) std::memchr(data, '\n', size);
+    const char* sizeEnd = (headerEnd == NULL) ? NULL :
+        (const char*) std::memchr(headerEnd + 1, '\n',
+        size - (headerEnd + 1 - data));
+    if (sizeEnd == NULL)
+    {
+      throw std::runtime_error("MappedMatrix::MappedMatrix(): '" + filename +
+          "' has a malformed header");
+    }
+
+    const std::string header(data, headerEnd);
+    const std::string expected = arma::diskio::gen_bin_header(arma::Mat<eT>());
+    if (header != expected)
+    {
+      throw std::runtime_error("MappedMatrix::MappedMatrix(): '" + filename +
+          "' has the header " + header + ", but " + expected + " is needed "
+          "for this element type");
+    }
+
+    std::istringstream sizes(std::string(headerEnd + 1, sizeEnd));
+    sizes >> rows >> cols;
+    if (sizes.fail())
+    {
+      throw std::runtime_error("MappedMatrix::MappedMatrix(): '" + filename +
+          "' has a malformed header");
+    }
+
+    offset = (sizeEnd + 1) - data;
+  }
+  else
+  {
+    // A raw binary file holds nothing but the elements.
+    const size_t elements = size / sizeof(eT);
+    rows = (rawRows == 0) ? elements : rawRows;
+    cols = (rawRows == 0) ? 1 : elements / rawRows;
+    if (size != rows * cols * sizeof(eT))
+    {
+      std::ostringstream oss;
+      oss << "MappedMatrix::MappedMatrix(): the size of '" << filename << "' ("
+          << size << " bytes) is not a multiple of a column of " << rows
+          << " elements";
+      throw std::runtime_error(oss.str());
+    }
+  }
+
+  if (offset + rows * cols * sizeof(eT) > size)
+  {
+    throw std::runtime_error("MappedMatrix::MappedMatrix(): '" + filename +
+        "' is truncated");
+  }
+
+  if (rows * cols == 0)
+  {
+    matrix.reset(new arma::Mat<eT>(rows, cols));
+  }
+  else if ((size_t) (data + offset) % alignof(eT) == 0)
+  {
+    // The matrix must not be written to, since the mapping is read-only.
+    matrix.reset(new arma::Mat<eT>(const_cast<eT*>(
+        reinterpret_cast<const eT*>(data + offset)), rows, cols, false, true));
+  }
+  else
+  {
+    Log::Warn << "MappedMatrix::MappedMatrix(): the elements of '" << filename
+        << "' are not aligned, so they are copied into memory; save the "
+        << "matrix with MappedMatrix::Save() to map it." << std::endl;
+
+    matrix.reset(new arma::Mat<eT>(rows, cols));
+    std::memcpy(matrix->memptr(), data + offset, rows * cols * sizeof(eT));
+    mapped = false;
+    file.reset();
+  }
+}
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix(const MappedMatrix& other) :
+    file(other.file),
+    mapped(other.mapped)
+{
+  if (mapped && other.matrix->n_elem > 0)
+  {
+    matrix.reset(new arma::Mat<eT>(const_cast<eT*>(other.matrix->memptr()),
+        other.matrix->n_rows, other.matrix->n_cols, false, true));
+  }
+  else
+  {
+    matrix.reset(new arma::Mat<eT>(*other.matrix));
+  }
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Save(const std::string& filename,
+                            const arma::Mat<eT>& matrix)
+{
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream.is_open())
+  {
+    throw std::runtime_error("MappedMatrix::Save(): cannot open file '" +
+        filename + "'");
+  }
+
+  // Armadillo skips whitespace before the size when it reads the header, so
+  // spaces can pad the header to a multiple of 64 bytes.
+  const std::string header = arma::diskio::gen_bin_header(matrix) + "\n";
+  std::ostringstream sizes;
+  sizes << matrix.n_rows << " " << matrix.n_cols << "\n";
+  const size_t headerSize = header.size() + sizes.str().size();
+  const size_t padding = (64 - headerSize % 64) % 64;
+
+  stream << header << std::string(padding, ' ') << sizes.str();
+  stream.write(reinterpret_cast<const char*>(matrix.memptr()),
+      std::streamsize(matrix.n_elem * sizeof(eT)));
+
+  if (!stream)
+  {
+    throw std::runtime_error("MappedMatrix::Save(): error writing file '" +
+        filename + "'");
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
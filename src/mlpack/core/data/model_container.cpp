@@ -0,0 +1,254 @@
+/**
+ * @file model_container.cpp
+ *
+ * Implementation of the ModelContainer and ModelContainerWriter classes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "model_container.hpp"
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+namespace {
+
+//! The header at the beginning of a model container file.
+struct Header
+{
+  //! "MLPKMDL" and a null character.
+  char magic[8];
+  //! The version of the format.
+  uint32_t version;
+  //! The number of entries.
+  uint32_t numEntries;
+  //! The position of the directory from the beginning of the file.
+  uint64_t directoryOffset;
+};
+
+//! The version of the format written by ModelContainerWriter.
+const uint32_t version = 1;
+
+} // namespace
+
+ModelContainerWriter::ModelContainerWriter(const std::string& filename) :
+    filename(filename),
+    stream(filename.c_str(), std::ios::out | std::ios::binary),
+    position(sizeof(Header)),
+    closed(false)
+{
+  if (!stream.is_open())
+  {
+    throw std::runtime_error("ModelContainerWriter::ModelContainerWriter(): "
+        "cannot open file '" + filename + "'");
+  }
+
+  // The header is written again with the position of the directory by
+  // Close().
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+}
+
+ModelContainerWriter::~ModelContainerWriter()
+{
+  if (closed)
+    return;
+
+  try
+  {
+    Close();
+  }
+  catch (std::exception& e)
+  {
+    Log::Warn << e.what() << std::endl;
+  }
+}
+
+void ModelContainerWriter::AddBlob(const std::string& name,
+                                   const std::string& data)
+{
+  AddEntry(name, ModelContainerEntry::BLOB, 0, 0, 0, data.data(), data.size(),
+      4096);
+}
+
+void ModelContainerWriter::Close()
+{
+  if (closed)
+    return;
+  closed = true;
+
+  const size_t directoryOffset = ((position + 7) / 8) * 8;
+  const std::string padding(directoryOffset - position, '\0');
+  stream.write(padding.data(), padding.size());
+  if (!directory.empty())
+  {
+    stream.write(reinterpret_cast<const char*>(directory.data()),
+        directory.size() * sizeof(ModelContainerEntry));
+  }
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::memcpy(header.magic, "MLPKMDL", 8);
+  header.version = version;
+  header.numEntries = (uint32_t) directory.size();
+  header.directoryOffset = directoryOffset;
+  stream.seekp(0);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  stream.close();
+
+  if (stream.fail())
+  {
+    throw std::runtime_error("ModelContainerWriter::Close(): error writing "
+        "file '" + filename + "'");
+  }
+}
+
+void ModelContainerWriter::AddEntry(const std::string& name,
+                                    const uint32_t type,
+                                    const uint32_t elementCode,
+                                    const size_t rows,
+                                    const size_t cols,
+                                    const char* data,
+                                    const size_t size,
+                                    const size_t alignment)
+{
+  if (closed)
+  {
+    throw std::runtime_error("ModelContainerWriter::AddEntry(): '" + filename +
+        "' is already closed");
+  }
+
+  ModelContainerEntry entry;
+  std::memset(&entry, 0, sizeof(ModelContainerEntry));
+  if (name.empty() || name.size() >= sizeof(entry.name))
+  {
+    throw std::invalid_argument("ModelContainerWriter::AddEntry(): the name "
+        "of an entry must have between 1 and 63 characters");
+  }
+  for (size_t i = 0; i < directory.size(); ++i)
+  {
+    if (name == directory[i].name)
+    {
+      throw std::invalid_argument("ModelContainerWriter::AddEntry(): there is "
+          "already an entry named '" + name + "'");
+    }
+  }
+
+  std::memcpy(entry.name, name.data(), name.size());
+  entry.type = type;
+  entry.elementCode = elementCode;
+  entry.rows = rows;
+  entry.cols = cols;
+  entry.offset = ((position + alignment - 1) / alignment) * alignment;
+  entry.size = size;
+
+  const std::string padding(entry.offset - position, '\0');
+  stream.write(padding.data(), padding.size());
+  stream.write(data, size);
+  if (stream.fail())
+  {
+    throw std::runtime_error("ModelContainerWriter::AddEntry(): error writing "
+        "file '" + filename + "'");
+  }
+
+  position = entry.offset + size;
+  directory.push_back(entry);
+}
+
+ModelContainer::ModelContainer(const std::string& filename) :
+    file(new MappedFile(filename))
+{
+  Header header;
+  if (file->Size() < sizeof(Header))
+  {
+    throw std::runtime_error("ModelContainer::ModelContainer(): '" + filename +
+        "' is not a model container");
+  }
+  std::memcpy(&header, file->Data(), sizeof(Header));
+
+  if (std::memcmp(header.magic, "MLPKMDL", 8) != 0)
+  {
+    throw std::runtime_error("ModelContainer::ModelContainer(): '" + filename +
+        "' is not a model container");
+  }
+  if (header.version != version)
+  {
+    std::ostringstream oss;
+    oss << "ModelContainer::ModelContainer(): '" << filename << "' has format "
+        << "version " << header.version << ", but only version " << version
+        << " is supported";
+    throw std::runtime_error(oss.str());
+  }
+
+  const size_t directorySize = header.numEntries * sizeof(ModelContainerEntry);
+  if (header.directoryOffset > file->Size() ||
+      directorySize > file->Size() - header.directoryOffset)
+  {
+    throw std::runtime_error("ModelContainer::ModelContainer(): '" + filename +
+        "' is truncated");
+  }
+
+  directory.resize(header.numEntries);
+  if (header.numEntries > 0)
+  {
+    std::memcpy(directory.data(), file->Data() + header.directoryOffset,
+        directorySize);
+  }
+
+  for (size_t i = 0; i < directory.size(); ++i)
+  {
+    ModelContainerEntry& entry = directory[i];
+    entry.name[sizeof(entry.name) - 1] = '\0';
+    if (entry.offset > header.directoryOffset ||
+        entry.size > header.directoryOffset - entry.offset ||
+        (entry.type == ModelContainerEntry::MATRIX && entry.rows * entry.cols *
+        (entry.elementCode & 0xff) != entry.size))
+    {
+      throw std::runtime_error("ModelContainer::ModelContainer(): entry '" +
+          std::string(entry.name) + "' of '" + filename + "' is malformed");
+    }
+
+    indices[entry.name] = i;
+  }
+}
+
+bool ModelContainer::HasEntry(const std::string& name) const
+{
+  return (indices.count(name) > 0);
+}
+
+std::vector<std::string> ModelContainer::Names() const
+{
+  std::vector<std::string> names;
+  for (size_t i = 0; i < directory.size(); ++i)
+    names.push_back(directory[i].name);
+  return names;
+}
+
+void ModelContainer::Blob(const std::string& name,
+                          const char*& data,
+                          size_t& size) const
+{
+  const ModelContainerEntry& entry = Find(name, ModelContainerEntry::BLOB);
+  data = file->Data() + entry.offset;
+  size = entry.size;
+}
+
+const ModelContainerEntry& ModelContainer::Find(const std::string& name,
+                                                const uint32_t type) const
+{
+  static const char* typeNames[] = { "matrix", "blob", "object" };
+
+  std::unordered_map<std::string, size_t>::const_iterator it =
+      indices.find(name);
+  if (it == indices.end() || directory[it->second].type != type)
+  {
+    throw std::runtime_error("ModelContainer: '" + file->Filename() + "' has "
+        "no " + typeNames[type] + " named '" + name + "'");
+  }
+
+  return directory[it->second];
+}
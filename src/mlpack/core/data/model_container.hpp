@@ -0,0 +1,287 @@
+/**
+ * @file model_container.hpp
+ *
+ * Definition of the ModelContainer and ModelContainerWriter classes, which
+ * read and write a flat binary file of named matrices, blobs and serialized
+ * objects that can be memory-mapped and loaded lazily.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MODEL_CONTAINER_HPP
+#define MLPACK_CORE_DATA_MODEL_CONTAINER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The record of one entry in the directory of a model container file.  The
+ * records are stored as they are, so that the directory can be read with a
+ * single copy.
+ */
+struct ModelContainerEntry
+{
+  //! The kinds of entries.
+  enum EntryType
+  {
+    MATRIX = 0,
+    BLOB = 1,
+    OBJECT = 2
+  };
+
+  //! The name of the entry, null-terminated.
+  char name[64];
+  //! The kind of the entry (an EntryType).
+  uint32_t type;
+  //! The element type of a matrix (see ElementCode()), or 0.
+  uint32_t elementCode;
+  //! The number of rows of a matrix, or 0.
+  uint64_t rows;
+  //! The number of columns of a matrix, or 0.
+  uint64_t cols;
+  //! The position of the entry from the beginning of the file.
+  uint64_t offset;
+  //! The size of the entry in bytes.
+  uint64_t size;
+
+  //! Get the code that identifies the element type eT of a matrix.
+  template<typename eT>
+  static uint32_t ElementCode()
+  {
+    return (uint32_t) sizeof(eT) |
+        (std::is_floating_point<eT>::value ? 0x100 : 0) |
+        (std::is_signed<eT>::value ? 0x200 : 0);
+  }
+};
+
+/**
+ * A writer for model container files, which ModelContainer can load.  A model
+ * container holds named entries of three kinds:
+ *
+ *  - matrices, whose elements are stored as they are in memory, aligned to a
+ *    page, so that they can be used from the mapped file without a copy;
+ *  - blobs, arbitrary bytes that are also page aligned, like a tree written
+ *    with tree::FlatTreeIndex::Save();
+ *  - objects, any class that can be serialized with data::Save(), stored as a
+ *    boost binary archive that is only deserialized when it is first used.
+ *
+ * Splitting a model into several entries lets a large model (like the
+ * reference set of a neighbor search model, or the trees of a random forest)
+ * be used without deserializing all of it first.  The entries are written to
+ * the file as they are added, and the directory of the entries is written by
+ * Close().
+ *
+ * @code
+ * data::ModelContainerWriter writer("model.mlpk");
+ * writer.AddMatrix("items", cf.ItemMatrix());
+ * writer.AddObject("forest", rf);
+ * writer.Close();
+ * @endcode
+ */
+class ModelContainerWriter
+{
+ public:
+  /**
+   * Create a model container file with the given name.  A std::runtime_error
+   * is thrown if the file cannot be opened.
+   *
+   * @param filename Name of the file to write.
+   */
+  ModelContainerWriter(const std::string& filename);
+
+  //! Write the directory, if Close() was not called.
+  ~ModelContainerWriter();
+
+  // A writer cannot be copied.
+  ModelContainerWriter(const ModelContainerWriter& other) = delete;
+  ModelContainerWriter& operator=(const ModelContainerWriter& other) = delete;
+
+  /**
+   * Add a matrix with the given name.  The matrix is stored as it is (it is
+   * not transposed).
+   *
+   * @param name Name of the entry (at most 63 characters).
+   * @param matrix Matrix to store.
+   */
+  template<typename eT>
+  void AddMatrix(const std::string& name, const arma::Mat<eT>& matrix);
+
+  /**
+   * Add the given bytes with the given name.
+   *
+   * @param name Name of the entry (at most 63 characters).
+   * @param data Bytes to store.
+   */
+  void AddBlob(const std::string& name, const std::string& data);
+
+  /**
+   * Serialize the given object with a boost binary archive and add it with
+   * the given name.
+   *
+   * @param name Name of the entry (at most 63 characters).
+   * @param object Object to store.
+   */
+  template<typename T>
+  void AddObject(const std::string& name, T& object);
+
+  /**
+   * Write the directory of the entries and close the file.  No entries can be
+   * added afterwards.  A std::runtime_error is thrown if the file cannot be
+   * written.
+   */
+  void Close();
+
+ private:
+  /**
+   * Write an entry to the file and add it to the directory.
+   *
+   * @param name Name of the entry.
+   * @param type Kind of the entry.
+   * @param elementCode Element type of a matrix.
+   * @param rows Number of rows of a matrix.
+   * @param cols Number of columns of a matrix.
+   * @param data Contents of the entry.
+   * @param size Size of the contents in bytes.
+   * @param alignment Alignment of the entry in the file.
+   */
+  void AddEntry(const std::string& name,
+                const uint32_t type,
+                const uint32_t elementCode,
+                const size_t rows,
+                const size_t cols,
+                const char* data,
+                const size_t size,
+                const size_t alignment);
+
+  //! The name of the file.
+  std::string filename;
+  //! The file being written.
+  std::ofstream stream;
+  //! The position of the end of the file.
+  size_t position;
+  //! The entries written so far.
+  std::vector<ModelContainerEntry> directory;
+  //! Whether Close() was called.
+  bool closed;
+};
+
+/**
+ * A model container file written by ModelContainerWriter.  The file is mapped
+ * into memory (see MappedFile), and only its directory is read when it is
+ * opened, so opening even a very large model takes about as long as an
+ * open() and an mmap().  A matrix is used directly from the mapping, and an
+ * object is deserialized when it is first requested; to swap a model in a
+ * server, a new ModelContainer can be opened and its entries requested before
+ * the old one is dropped.
+ *
+ * The entries can be requested from several threads at once.  The returned
+ * references stay valid as long as the container.
+ *
+ * @code
+ * data::ModelContainer model("model.mlpk");
+ * const arma::mat& items = model.Matrix<double>("items");
+ * RandomForest<>& rf = model.Object<RandomForest<>>("forest");
+ * @endcode
+ */
+class ModelContainer
+{
+ public:
+  /**
+   * Open the given model container file.  A std::runtime_error is thrown if
+   * the file cannot be mapped or is not a model container.
+   *
+   * @param filename Name of the file to open.
+   */
+  ModelContainer(const std::string& filename);
+
+  // A container cannot be copied.
+  ModelContainer(const ModelContainer& other) = delete;
+  ModelContainer& operator=(const ModelContainer& other) = delete;
+
+  //! Get whether the container has an entry with the given name.
+  bool HasEntry(const std::string& name) const;
+
+  //! Get the names of the entries, in the order they were added.
+  std::vector<std::string> Names() const;
+
+  /**
+   * Get the matrix with the given name, which uses the memory of the mapped
+   * file and must not be modified.  A std::runtime_error is thrown if there is
+   * no such matrix, or if its elements are not of type eT.
+   *
+   * @param name Name of the entry.
+   */
+  template<typename eT>
+  const arma::Mat<eT>& Matrix(const std::string& name) const;
+
+  /**
+   * Get the blob with the given name, which points into the mapped file.  A
+   * std::runtime_error is thrown if there is no such blob.
+   *
+   * @param name Name of the entry.
+   * @param data Set to the beginning of the blob.
+   * @param size Set to the size of the blob in bytes.
+   */
+  void Blob(const std::string& name, const char*& data, size_t& size) const;
+
+  /**
+   * Get the object with the given name, which is deserialized the first time
+   * it is requested.  The same type has to be requested every time.  A
+   * std::runtime_error is thrown if there is no such object or if it cannot be
+   * deserialized as a T.
+   *
+   * @param name Name of the entry.
+   */
+  template<typename T>
+  T& Object(const std::string& name);
+
+  /**
+   * Deserialize the object with the given name into the given object, without
+   * keeping it in the container.
+   *
+   * @param name Name of the entry.
+   * @param object Object to deserialize into.
+   */
+  template<typename T>
+  void LoadObject(const std::string& name, T& object) const;
+
+  //! Get the mapped file.
+  const MappedFile& File() const { return *file; }
+
+ private:
+  /**
+   * Find the entry with the given name, which has to be of the given kind.
+   * A std::runtime_error is thrown otherwise.
+   */
+  const ModelContainerEntry& Find(const std::string& name,
+                                  const uint32_t type) const;
+
+  //! The mapped file.
+  std::unique_ptr<MappedFile> file;
+  //! The entries of the file.
+  std::vector<ModelContainerEntry> directory;
+  //! The indices of the entries, by name.
+  std::unordered_map<std::string, size_t> indices;
+  //! The matrices and objects requested so far, by name.
+  mutable std::unordered_map<std::string, std::shared_ptr<void>> cache;
+  //! The lock for the cache.
+  mutable std::mutex cacheLock;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "model_container_impl.hpp"
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file model_container_impl.hpp
+ *
+ * Implementation of the templated functions of ModelContainer and
+ * ModelContainerWriter.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MODEL_CONTAINER_IMPL_HPP
+#define MLPACK_CORE_DATA_MODEL_CONTAINER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "model_container.hpp"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A read-only stream buffer over memory that is not owned, so that an object
+ * can be deserialized from the mapped file without copying it.
+ */
+class ModelContainerBuffer : public std::streambuf
+{
+ public:
+  ModelContainerBuffer(const char* data, const size_t size)
+  {
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+  }
+};
+
+template<typename eT>
+void ModelContainerWriter::AddMatrix(const std::string& name,
+                                     const arma::Mat<eT>& matrix)
+{
+  AddEntry(name, ModelContainerEntry::MATRIX,
+      ModelContainerEntry::ElementCode<eT>(), matrix.n_rows, matrix.n_cols,
+      reinterpret_cast<const char*>(matrix.memptr()),
+      matrix.n_elem * sizeof(eT), 4096);
+}
+
+template<typename T>
+void ModelContainerWriter::AddObject(const std::string& name, T& object)
+{
+  std::ostringstream oss(std::ios::out | std::ios::binary);
+  {
+    boost::archive::binary_oarchive ar(oss);
+    ar << CreateNVP(object, name);
+  }
+
+  const std::string data = oss.str();
+  AddEntry(name, ModelContainerEntry::OBJECT, 0, 0, 0, data.data(),
+      data.size(), 64);
+}
+
+template<typename eT>
+const arma::Mat<eT>& ModelContainer::Matrix(const std::string& name) const
+{
+  const ModelContainerEntry& entry = Find(name, ModelContainerEntry::MATRIX);
+  if (entry.elementCode != ModelContainerEntry::ElementCode<eT>())
+  {
+    throw std::runtime_error("ModelContainer::Matrix(): the elements of '" +
+        name + "' in '" + file->Filename() + "' are of another type");
+  }
+
+  std::lock_guard<std::mutex> lock(cacheLock);
+  std::shared_ptr<void>& cached = cache[name];
+  if (!cached)
+  {
+    // The matrix must not be written to, since the mapping is read-only.
+    if (entry.rows * entry.cols == 0)
+    {
+      cached = std::make_shared<arma::Mat<eT>>(entry.rows, entry.cols);
+    }
+    else
+    {
+      cached = std::make_shared<arma::Mat<eT>>(const_cast<eT*>(
+          reinterpret_cast<const eT*>(file->Data() + entry.offset)),
+          entry.rows, entry.cols, false, true);
+    }
+  }
+
+  return *static_cast<const arma::Mat<eT>*>(cached.get());
+}
+
+template<typename T>
+T& ModelContainer::Object(const std::string& name)
+{
+  {
+    std::lock_guard<std::mutex> lock(cacheLock);
+    std::unordered_map<std::string, std::shared_ptr<void>>::const_iterator it =
+        cache.find(name);
+    if (it != cache.end())
+      return *static_cast<T*>(it->second.get());
+  }
+
+  // Deserialize without holding the lock, so other entries can be requested
+  // in the meantime.  If another thread deserialized the same object first,
+  // its copy is used.
+  std::shared_ptr<T> object = std::make_shared<T>();
+  LoadObject(name, *object);
+
+  std::lock_guard<std::mutex> lock(cacheLock);
+  std::shared_ptr<void>& cached = cache[name];
+  if (!cached)
+    cached = object;
+
+  return *static_cast<T*>(cached.get());
+}
+
+template<typename T>
+void ModelContainer::LoadObject(const std::string& name, T& object) const
+{
+  const ModelContainerEntry& entry = Find(name, ModelContainerEntry::OBJECT);
+
+  ModelContainerBuffer buffer(file->Data() + entry.offset, entry.size);
+  std::istream stream(&buffer);
+  try
+  {
+    boost::archive::binary_iarchive ar(stream);
+    ar >> CreateNVP(object, name);
+  }
+  catch (boost::archive::archive_exception& e)
+  {
+    throw std::runtime_error("ModelContainer::LoadObject(): cannot load '" +
+        name + "' from '" + file->Filename() + "': " + e.what());
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file process_batches.hpp
+ *
+ * Definition of ProcessBatches(), which reads the batches of a BatchReader,
+ * computes their results and writes them in a pipeline, so that the reading,
+ * the computation and the writing overlap.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_PROCESS_BATCHES_HPP
+#define MLPACK_CORE_DATA_PROCESS_BATCHES_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "batch_reader.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A queue with a bounded number of elements, to pass batches between the
+ * threads of ProcessBatches().  Push() waits while the queue is full, and
+ * Pop() waits while it is empty.  Once the queue is closed, Push() does not
+ * add anything and returns false, and Pop() returns the elements that are
+ * left and then false; so the producer closes the queue when it is done, and
+ * the consumer closes it to make the producer stop.
+ *
+ * @tparam T Type of the elements.
+ */
+template<typename T>
+class BatchQueue
+{
+ public:
+  /**
+   * Create an empty queue.
+   *
+   * @param maxSize Maximum number of elements in the queue.
+   */
+  BatchQueue(const size_t maxSize) : maxSize(maxSize), closed(false) { }
+
+  /**
+   * Add the given element at the end of the queue, waiting while the queue is
+   * full.
+   *
+   * @param element Element to add.
+   * @return false if the queue was closed, and the element was not added.
+   */
+  bool Push(T&& element);
+
+  /**
+   * Take the element at the front of the queue, waiting while the queue is
+   * empty and not closed.
+   *
+   * @param element Set to the element.
+   * @return false if the queue is closed and empty.
+   */
+  bool Pop(T& element);
+
+  //! Close the queue, waking up all waiting threads.
+  void Close();
+
+ private:
+  //! The maximum number of elements.
+  size_t maxSize;
+  //! The elements.
+  std::deque<T> queue;
+  //! Whether the queue was closed.
+  bool closed;
+  //! The mutex that guards the queue.
+  std::mutex mutex;
+  //! Signalled when an element was added or the queue was closed.
+  std::condition_variable notEmpty;
+  //! Signalled when an element was taken or the queue was closed.
+  std::condition_variable notFull;
+}; // class BatchQueue
+
+/**
+ * Process all the batches that are left in the given BatchReader in a
+ * pipeline of three stages: one thread reads the batches, the calling thread
+ * computes the result of each batch, and another thread writes the results,
+ * in the order of the batches.  At most queueSize batches are read ahead of
+ * the computation, and at most queueSize results wait to be written, so the
+ * memory usage does not depend on the size of the file; while a batch is
+ * computed, the next batch is read and the result of the previous one is
+ * written.  This is meant for programs that would otherwise load a large set
+ * of points, compute all results, and then save them (for instance with a
+ * BatchWriter in the writing stage).
+ *
+ * The computation can use OpenMP as usual.  If a stage throws an exception,
+ * the other stages stop after the batch they are working on, and the
+ * exception is rethrown after all threads have finished.
+ *
+ * @code
+ * data::BatchReader<> reader("queries.csv", 10000);
+ * data::BatchWriter<size_t> writer("neighbors.csv", k);
+ * data::ProcessBatches(reader,
+ *     [&](arma::mat& batch, const size_t first)
+ *     {
+ *       arma::Mat<size_t> neighbors;
+ *       arma::mat distances;
+ *       knn.Search(batch, k, neighbors, distances);
+ *       return neighbors;
+ *     },
+ *     [&](arma::Mat<size_t>& neighbors) { writer.WriteBatch(neighbors); });
+ * writer.Close();
+ * @endcode
+ *
+ * @param reader BatchReader to read the batches from.
+ * @param compute Function that is called as compute(batch, first) for each
+ *     batch, where first is the index of the first point of the batch in the
+ *     file; it may modify the batch, and its result is given to write.
+ * @param write Function that is called as write(result) with the result of
+ *     each batch.
+ * @param queueSize Maximum number of batches and results that wait between
+ *     the stages.
+ * @return Number of points that were computed.
+ */
+template<typename eT,
+         typename PolicyType,
+         typename ComputeType,
+         typename WriteType>
+size_t ProcessBatches(BatchReader<eT, PolicyType>& reader,
+                      ComputeType compute,
+                      WriteType write,
+                      const size_t queueSize = 2);
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "process_batches_impl.hpp"
+
+#endif
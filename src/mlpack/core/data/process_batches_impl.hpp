@@ -0,0 +1,153 @@
+/**
+ * @file process_batches_impl.hpp
+ *
+ * Implementation of ProcessBatches() and of the BatchQueue class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_PROCESS_BATCHES_IMPL_HPP
+#define MLPACK_CORE_DATA_PROCESS_BATCHES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "process_batches.hpp"
+
+namespace mlpack {
+namespace data {
+
+template<typename T>
+bool BatchQueue<T>::Push(T&& element)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  notFull.wait(lock, [this] { return closed || queue.size() < maxSize; });
+  if (closed)
+    return false;
+
+  queue.push_back(std::move(element));
+  notEmpty.notify_one();
+  return true;
+}
+
+template<typename T>
+bool BatchQueue<T>::Pop(T& element)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  notEmpty.wait(lock, [this] { return closed || !queue.empty(); });
+  if (queue.empty())
+    return false;
+
+  element = std::move(queue.front());
+  queue.pop_front();
+  notFull.notify_one();
+  return true;
+}
+
+template<typename T>
+void BatchQueue<T>::Close()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  closed = true;
+  notEmpty.notify_all();
+  notFull.notify_all();
+}
+
+template<typename eT,
+         typename PolicyType,
+         typename ComputeType,
+         typename WriteType>
+size_t ProcessBatches(BatchReader<eT, PolicyType>& reader,
+                      ComputeType compute,
+                      WriteType write,
+                      const size_t queueSize)
+{
+  if (queueSize == 0)
+  {
+    throw std::invalid_argument("ProcessBatches(): the queue size must be "
+        "positive");
+  }
+
+  typedef typename std::decay<decltype(compute(
+      std::declval<arma::Mat<eT>&>(), size_t()))>::type ResultType;
+
+  // Each batch is passed with the index of its first point.
+  BatchQueue<std::pair<size_t, arma::Mat<eT>>> batches(queueSize);
+  BatchQueue<ResultType> results(queueSize);
+  std::exception_ptr readError, computeError, writeError;
+
+  std::thread readThread([&]()
+  {
+    try
+    {
+      size_t first = reader.PointsRead();
+      arma::Mat<eT> batch;
+      while (reader.NextBatch(batch))
+      {
+        if (!batches.Push(std::make_pair(first, std::move(batch))))
+          break;
+        first = reader.PointsRead();
+      }
+    }
+    catch (...)
+    {
+      readError = std::current_exception();
+    }
+
+    batches.Close();
+  });
+
+  std::thread writeThread([&]()
+  {
+    try
+    {
+      ResultType result;
+      while (results.Pop(result))
+        write(result);
+    }
+    catch (...)
+    {
+      writeError = std::current_exception();
+    }
+
+    results.Close();
+  });
+
+  size_t points = 0;
+  try
+  {
+    std::pair<size_t, arma::Mat<eT>> batch;
+    while (batches.Pop(batch))
+    {
+      const size_t batchPoints = batch.second.n_cols;
+      if (!results.Push(compute(batch.second, batch.first)))
+        break;
+      points += batchPoints;
+    }
+  }
+  catch (...)
+  {
+    computeError = std::current_exception();
+  }
+
+  // Stop the reading thread if it is still running, and let the writing
+  // thread write the results that are left.
+  batches.Close();
+  results.Close();
+  readThread.join();
+  writeThread.join();
+
+  if (readError)
+    std::rethrow_exception(readError);
+  if (computeError)
+    std::rethrow_exception(computeError);
+  if (writeError)
+    std::rethrow_exception(writeError);
+
+  return points;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,431 @@
+/**
+ * @file query_server.cpp
+ *
+ * Implementation of the QueryServer class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "query_server.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+  #include <cerrno>
+  #include <poll.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+namespace {
+
+//! The size of the header of a request: id, rows and cols.
+const size_t headerSize = 3 * sizeof(uint64_t);
+
+//! Append the bytes of a value to a message.
+template<typename T>
+void Append(std::string& message, const T& value)
+{
+  message.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//! Append a number of indices to a message, as uint64.
+void AppendIndices(std::string& message, const size_t* indices, const size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    Append(message, (uint64_t) indices[i]);
+}
+
+//! Append a number of doubles to a message.
+void AppendDoubles(std::string& message, const double* values, const size_t n)
+{
+  message.append(reinterpret_cast<const char*>(values), n * sizeof(double));
+}
+
+} // anonymous namespace
+
+QueryServer::QueryServer() :
+    listenFd(-1),
+    nextClient(1),
+    inputEnded(false),
+    maxRequestSize(size_t(1) << 30),
+    redirect(new StandardOutputRedirect())
+{
+  Client client;
+  client.inFd = 0;
+  client.outFd = 1;
+  client.pending = 0;
+  clients[0] = client;
+}
+
+QueryServer::QueryServer(const std::string& socketPath) :
+    socketPath(socketPath),
+    listenFd(-1),
+    nextClient(0),
+    inputEnded(false),
+    maxRequestSize(size_t(1) << 30)
+{
+#ifndef _WIN32
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  if (socketPath.size() >= sizeof(address.sun_path))
+    throw std::runtime_error("socket path '" + socketPath + "' is too long");
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, socketPath.c_str());
+
+  listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd == -1)
+    throw std::runtime_error("cannot create socket '" + socketPath + "'");
+
+  unlink(socketPath.c_str());
+  if (bind(listenFd, (struct sockaddr*) &address, sizeof(address)) == -1 ||
+      listen(listenFd, SOMAXCONN) == -1)
+  {
+    close(listenFd);
+    throw std::runtime_error("cannot listen on socket '" + socketPath + "'");
+  }
+#else
+  throw std::runtime_error("cannot serve on socket '" + socketPath + "': "
+      "sockets are not supported on this system");
+#endif
+}
+
+QueryServer::~QueryServer()
+{
+  while (!clients.empty())
+    Drop(clients.begin()->first);
+
+#ifndef _WIN32
+  if (listenFd != -1)
+  {
+    close(listenFd);
+    unlink(socketPath.c_str());
+  }
+#endif
+}
+
+bool QueryServer::Collect(std::vector<Request>& requests,
+                          const size_t maxPoints)
+{
+  requests.clear();
+  size_t points = 0;
+
+  Parse(requests, points, maxPoints);
+  while (requests.empty())
+  {
+    // Without a socket, no more requests can arrive once the input has ended.
+    if (listenFd == -1 && inputEnded)
+      return false;
+
+    Receive(true);
+    Parse(requests, points, maxPoints);
+  }
+
+  // Add any requests that arrived in the meantime, so that they are answered
+  // by the same search.
+  if (points < maxPoints)
+  {
+    Receive(false);
+    Parse(requests, points, maxPoints);
+  }
+
+  return true;
+}
+
+void QueryServer::Respond(const Request& request,
+                          const arma::Mat<size_t>& neighbors,
+                          const arma::mat& distances)
+{
+  std::string message;
+  message.reserve(4 * sizeof(uint64_t) + neighbors.n_elem * sizeof(uint64_t) +
+      distances.n_elem * sizeof(double));
+  Append(message, request.id);
+  Append(message, (uint64_t) 0);
+  Append(message, (uint64_t) neighbors.n_rows);
+  Append(message, (uint64_t) neighbors.n_cols);
+  AppendIndices(message, neighbors.memptr(), neighbors.n_elem);
+  AppendDoubles(message, distances.memptr(), distances.n_elem);
+
+  Send(request.client, message);
+}
+
+void QueryServer::Respond(const Request& request,
+                          const std::vector<std::vector<size_t>>& neighbors,
+                          const std::vector<std::vector<double>>& distances)
+{
+  std::string message;
+  Append(message, request.id);
+  Append(message, (uint64_t) 0);
+  Append(message, (uint64_t) neighbors.size());
+  for (size_t i = 0; i < neighbors.size(); ++i)
+  {
+    Append(message, (uint64_t) neighbors[i].size());
+    AppendIndices(message, neighbors[i].data(), neighbors[i].size());
+    AppendDoubles(message, distances[i].data(), distances[i].size());
+  }
+
+  Send(request.client, message);
+}
+
+void QueryServer::RespondError(const Request& request,
+                               const std::string& message)
+{
+  std::string response;
+  Append(response, request.id);
+  Append(response, (uint64_t) 1);
+  Append(response, (uint64_t) message.size());
+  response.append(message);
+
+  Send(request.client, response);
+}
+
+void QueryServer::Receive(const bool block)
+{
+#ifndef _WIN32
+  std::vector<struct pollfd> fds;
+  std::vector<size_t> fdClients;
+  if (listenFd != -1)
+  {
+    struct pollfd fd = { listenFd, POLLIN, 0 };
+    fds.push_back(fd);
+  }
+  for (std::map<size_t, Client>::iterator it = clients.begin();
+       it != clients.end(); ++it)
+  {
+    if (it->second.inFd == -1)
+      continue;
+
+    struct pollfd fd = { it->second.inFd, POLLIN, 0 };
+    fds.push_back(fd);
+    fdClients.push_back(it->first);
+  }
+
+  if (fds.empty())
+    return;
+
+  // An interrupted wait is treated like one that found nothing.
+  if (poll(fds.data(), fds.size(), block ? -1 : 0) <= 0)
+    return;
+
+  size_t first = 0;
+  if (listenFd != -1)
+  {
+    first = 1;
+    if (fds[0].revents & POLLIN)
+    {
+      const int fd = accept(listenFd, NULL, NULL);
+      if (fd != -1)
+      {
+        #ifdef SO_NOSIGPIPE
+          const int on = 1;
+          setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+        #endif
+
+        Client client;
+        client.inFd = fd;
+        client.outFd = fd;
+        client.pending = 0;
+        clients[nextClient++] = client;
+      }
+    }
+  }
+
+  char buffer[65536];
+  for (size_t i = first; i < fds.size(); ++i)
+  {
+    if (fds[i].revents == 0)
+      continue;
+
+    const size_t id = fdClients[i - first];
+    Client& client = clients[id];
+    const ssize_t bytes = read(client.inFd, buffer, sizeof(buffer));
+    if (bytes > 0)
+    {
+      client.buffer.append(buffer, bytes);
+    }
+    else if (bytes == 0 || (errno != EINTR && errno != EAGAIN))
+    {
+      // The client sends nothing more, but may still wait for responses.
+      if (!client.buffer.empty())
+        Log::Warn << "QueryServer: discarding an incomplete request."
+            << std::endl;
+      client.buffer.clear();
+      client.inFd = -1;
+
+      if (listenFd == -1)
+        inputEnded = true;
+      else if (client.pending == 0)
+        Drop(id);
+    }
+  }
+#else
+  // Without poll(), one request is read at a time, and only when waiting.
+  if (!block || inputEnded)
+    return;
+
+  Client& client = clients[0];
+  char header[headerSize];
+  if (!std::cin.read(header, headerSize))
+  {
+    inputEnded = true;
+    return;
+  }
+
+  uint64_t rows, cols;
+  std::memcpy(&rows, header + sizeof(uint64_t), sizeof(uint64_t));
+  std::memcpy(&cols, header + 2 * sizeof(uint64_t), sizeof(uint64_t));
+  client.buffer.append(header, headerSize);
+  if (rows != 0 && cols > (maxRequestSize - headerSize) / sizeof(double) / rows)
+    return; // Parse() rejects the request.
+
+  std::string body(rows * cols * sizeof(double), '\0');
+  if (!std::cin.read(&body[0], body.size()))
+  {
+    Log::Warn << "QueryServer: discarding an incomplete request." << std::endl;
+    client.buffer.clear();
+    inputEnded = true;
+    return;
+  }
+  client.buffer.append(body);
+#endif
+}
+
+void QueryServer::Parse(std::vector<Request>& requests,
+                        size_t& points,
+                        const size_t maxPoints)
+{
+  std::vector<size_t> malformed;
+  for (std::map<size_t, Client>::iterator it = clients.begin();
+       it != clients.end(); ++it)
+  {
+    Client& client = it->second;
+    size_t offset = 0;
+    while (client.buffer.size() - offset >= headerSize &&
+           (requests.empty() || points < maxPoints))
+    {
+      uint64_t header[3];
+      std::memcpy(header, client.buffer.data() + offset, headerSize);
+      const uint64_t rows = header[1];
+      const uint64_t cols = header[2];
+      if (rows != 0 &&
+          cols > (maxRequestSize - headerSize) / sizeof(double) / rows)
+      {
+        malformed.push_back(it->first);
+        break;
+      }
+
+      const size_t size = headerSize + rows * cols * sizeof(double);
+      if (client.buffer.size() - offset < size)
+        break;
+
+      Request request;
+      request.client = it->first;
+      request.id = header[0];
+      request.points.set_size(rows, cols);
+      std::memcpy(request.points.memptr(), client.buffer.data() + offset +
+          headerSize, rows * cols * sizeof(double));
+      requests.push_back(std::move(request));
+      ++client.pending;
+
+      points += cols;
+      offset += size;
+    }
+
+    client.buffer.erase(0, offset);
+  }
+
+  // Nothing that follows an oversized request can be trusted.
+  for (size_t i = 0; i < malformed.size(); ++i)
+  {
+    Log::Warn << "QueryServer: request is larger than " << maxRequestSize
+        << " bytes; closing the connection." << std::endl;
+    if (listenFd == -1)
+    {
+      inputEnded = true;
+      clients[malformed[i]].inFd = -1;
+      clients[malformed[i]].buffer.clear();
+    }
+    else
+    {
+      Drop(malformed[i]);
+    }
+  }
+}
+
+void QueryServer::Send(const size_t client, const std::string& bytes)
+{
+  std::map<size_t, Client>::iterator it = clients.find(client);
+  if (it == clients.end())
+    return;
+
+#ifndef _WIN32
+  size_t sent = 0;
+  while (sent < bytes.size())
+  {
+    ssize_t result;
+    if (listenFd == -1)
+    {
+      result = write(it->second.outFd, bytes.data() + sent,
+          bytes.size() - sent);
+    }
+    else
+    {
+      #ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+      #else
+        const int flags = 0;
+      #endif
+      result = send(it->second.outFd, bytes.data() + sent, bytes.size() - sent,
+          flags);
+    }
+
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+    {
+      Log::Warn << "QueryServer: cannot send a response; closing the "
+          << "connection." << std::endl;
+      Drop(client);
+      return;
+    }
+
+    sent += result;
+  }
+#else
+  // std::cout is sent to standard error while the server exists.
+  std::fwrite(bytes.data(), 1, bytes.size(), stdout);
+  std::fflush(stdout);
+#endif
+
+  // A client that sends nothing more is dropped once it has all its responses.
+  Client& c = it->second;
+  if (c.pending > 0)
+    --c.pending;
+  if (listenFd != -1 && c.inFd == -1 && c.pending == 0)
+    Drop(client);
+}
+
+void QueryServer::Drop(const size_t client)
+{
+  std::map<size_t, Client>::iterator it = clients.find(client);
+  if (it == clients.end())
+    return;
+
+#ifndef _WIN32
+  // Standard input and output are not ours to close.
+  if (listenFd != -1)
+    close(it->second.outFd);
+#endif
+
+  if (listenFd == -1)
+    inputEnded = true;
+  clients.erase(it);
+}
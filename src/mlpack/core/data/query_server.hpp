@@ -0,0 +1,214 @@
+/**
+ * @file query_server.hpp
+ *
+ * Definition of the QueryServer class, which receives batches of query points
+ * for a long-running search program and sends the results back.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_QUERY_SERVER_HPP
+#define MLPACK_CORE_DATA_QUERY_SERVER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * While an object of this class exists, everything that is written to
+ * std::cout goes to standard error instead, so that the log streams (Log::Info,
+ * Log::Warn and Log::Debug all write to std::cout) cannot corrupt responses
+ * that are written to standard output.  Objects may be nested.
+ */
+class StandardOutputRedirect
+{
+ public:
+  //! Send std::cout to standard error.
+  StandardOutputRedirect() : buffer(std::cout.rdbuf(std::cerr.rdbuf())) { }
+
+  //! Send std::cout where it went before.
+  ~StandardOutputRedirect()
+  {
+    std::cout.flush();
+    std::cout.rdbuf(buffer);
+  }
+
+  StandardOutputRedirect(const StandardOutputRedirect& other) = delete;
+  StandardOutputRedirect& operator=(const StandardOutputRedirect& other) =
+      delete;
+
+ private:
+  //! The buffer std::cout had before.
+  std::streambuf* buffer;
+};
+
+/**
+ * The QueryServer lets a search program load its model once and then answer
+ * any number of query batches.  Requests are read either from standard input
+ * (and answered on standard output) or from the clients of a Unix domain
+ * socket.  All requests that are pending at the same time, from any number of
+ * clients, are handed out together, so that the program can answer them with a
+ * single batched search.
+ *
+ * All values are sent in the byte order of the machine.  A request is
+ *
+ *  - uint64 id: chosen by the client and repeated in the response;
+ *  - uint64 rows, uint64 cols: the size of the query matrix;
+ *  - rows * cols doubles: the query points, in column-major order.
+ *
+ * Every response starts with the uint64 id of the request and a uint64 status.
+ * If the status is 0, the results follow; otherwise a uint64 length and an
+ * error message of that many bytes follow.  The results of a k-nearest-neighbor
+ * search are a uint64 k and a uint64 cols, then the k * cols neighbor indices
+ * as uint64 and the k * cols distances as doubles, both in column-major order.
+ * The results of a range search are a uint64 cols, then for each query point a
+ * uint64 count, count uint64 neighbor indices and count distances as doubles.
+ *
+ * The responses to the requests of one client are sent in the order of the
+ * requests.  The socket is only available on POSIX systems; on other systems
+ * requests on standard input are answered one at a time.
+ */
+class QueryServer
+{
+ public:
+  //! A batch of query points sent by a client.
+  struct Request
+  {
+    //! The client that sent the request.
+    size_t client;
+    //! The id that the client gave the request.
+    uint64_t id;
+    //! The query points.
+    arma::mat points;
+  };
+
+  /**
+   * Serve the requests that are written to standard input.  Nothing but
+   * responses may be written to standard output while the server exists, so
+   * std::cout (and with it the log streams) is sent to standard error until
+   * the server is destroyed (see StandardOutputRedirect).
+   */
+  QueryServer();
+
+  /**
+   * Serve the requests of the clients of a Unix domain socket at the given
+   * path.  A file at that path is replaced.  A std::runtime_error is thrown if
+   * the socket cannot be created.
+   *
+   * @param socketPath Path of the socket.
+   */
+  QueryServer(const std::string& socketPath);
+
+  //! Close the socket and all connections.
+  ~QueryServer();
+
+  // A server cannot be copied.
+  QueryServer(const QueryServer& other) = delete;
+  QueryServer& operator=(const QueryServer& other) = delete;
+
+  /**
+   * Wait for the next requests and return all that are pending, up to the
+   * given number of query points in total (at least one request is returned,
+   * however large it is).  Returns false when no request will arrive anymore,
+   * which happens at the end of standard input.  A socket is served until the
+   * program is stopped.
+   *
+   * @param requests Filled with the pending requests.
+   * @param maxPoints Maximum number of query points to return at once.
+   */
+  bool Collect(std::vector<Request>& requests, const size_t maxPoints);
+
+  /**
+   * Send the results of a k-nearest-neighbor search.  If the client has gone,
+   * nothing is sent.
+   *
+   * @param request Request that is answered.
+   * @param neighbors Indices of the neighbors of each query point.
+   * @param distances Distances to the neighbors of each query point.
+   */
+  void Respond(const Request& request,
+               const arma::Mat<size_t>& neighbors,
+               const arma::mat& distances);
+
+  /**
+   * Send the results of a range search.  If the client has gone, nothing is
+   * sent.
+   *
+   * @param request Request that is answered.
+   * @param neighbors Indices of the neighbors of each query point.
+   * @param distances Distances to the neighbors of each query point.
+   */
+  void Respond(const Request& request,
+               const std::vector<std::vector<size_t>>& neighbors,
+               const std::vector<std::vector<double>>& distances);
+
+  /**
+   * Tell the client that the request could not be answered.
+   *
+   * @param request Request that is answered.
+   * @param message Explanation of the error.
+   */
+  void RespondError(const Request& request, const std::string& message);
+
+  //! Get the largest number of bytes a request may have.
+  size_t MaxRequestSize() const { return maxRequestSize; }
+  //! Modify the largest number of bytes a request may have.
+  size_t& MaxRequestSize() { return maxRequestSize; }
+
+ private:
+  //! A connection to a client.
+  struct Client
+  {
+    //! Descriptor to read requests from.
+    int inFd;
+    //! Descriptor to write responses to.
+    int outFd;
+    //! Bytes received that do not form a complete request yet.
+    std::string buffer;
+    //! The number of requests that have not been answered yet.
+    size_t pending;
+  };
+
+  //! Read what is available on the descriptors, waiting for data if block is
+  //! true.
+  void Receive(const bool block);
+
+  //! Move the complete requests of the clients into requests.
+  void Parse(std::vector<Request>& requests,
+             size_t& points,
+             const size_t maxPoints);
+
+  //! Send the given bytes to a client, dropping the client if that fails.
+  void Send(const size_t client, const std::string& bytes);
+
+  //! Close the connection to a client.
+  void Drop(const size_t client);
+
+  //! The path of the socket, or empty when standard input is served.
+  std::string socketPath;
+  //! Descriptor of the listening socket, or -1.
+  int listenFd;
+  //! The connected clients, by the number given to them.
+  std::map<size_t, Client> clients;
+  //! The number of the next client.
+  size_t nextClient;
+  //! Whether standard input has ended.
+  bool inputEnded;
+  //! The largest number of bytes a request may have.
+  size_t maxRequestSize;
+  //! Sends std::cout to standard error when standard input is served.
+  std::unique_ptr<StandardOutputRedirect> redirect;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_DATA_SPLIT_DATA_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace data {
@@ -192,6 +193,91 @@ Split(const arma::Mat<T>& input,
                          std::move(testData));
 }
 
+/**
+ * Given an input dataset and labels, shuffle the points and labels in place so
+ * that the first points form a training set and the remaining points form a
+ * test set, and return the number of points of the training set.  Unlike
+ * Split(), no copy of the dataset is made, so this can be used on datasets
+ * that fill most of the memory.  Models can be trained and evaluated on
+ * aliases of the two contiguous parts of the dataset, as in the example below.
+ *
+ * @code
+ * arma::mat input = loadData();
+ * arma::Row<size_t> label = loadLabel();
+ *
+ * // Hold out 30% of the data for the test set.
+ * const size_t trainSize = SplitInPlace(input, label, 0.3);
+ *
+ * // Aliases of the training and test sets; input must outlive them.
+ * const arma::mat trainData(input.memptr(), input.n_rows, trainSize, false,
+ *     true);
+ * const arma::mat testData(input.colptr(trainSize), input.n_rows,
+ *     input.n_cols - trainSize, false, true);
+ * const arma::Row<size_t> trainLabel(label.memptr(), trainSize, false, true);
+ * const arma::Row<size_t> testLabel(label.colptr(trainSize),
+ *     label.n_elem - trainSize, false, true);
+ * @endcode
+ *
+ * @param input Input dataset to shuffle in place.
+ * @param inputLabel Input labels to shuffle in place along with the dataset.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ * @return The number of points of the training set.
+ */
+template<typename T, typename U>
+size_t SplitInPlace(arma::Mat<T>& input,
+                    arma::Row<U>& inputLabel,
+                    const double testRatio)
+{
+  if (inputLabel.n_elem != input.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SplitInPlace(): the number of labels (" << inputLabel.n_elem
+        << ") does not match the number of points (" << input.n_cols << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
+
+  // Fisher-Yates shuffle of the points and labels.
+  for (size_t i = input.n_cols; i > 1; --i)
+  {
+    const size_t j = static_cast<size_t>(math::Random() * i);
+    if (j != i - 1)
+    {
+      input.swap_cols(i - 1, j);
+      std::swap(inputLabel[i - 1], inputLabel[j]);
+    }
+  }
+
+  return input.n_cols - testSize;
+}
+
+/**
+ * Given an input dataset, shuffle the points in place so that the first points
+ * form a training set and the remaining points form a test set, and return the
+ * number of points of the training set.  No copy of the dataset is made; see
+ * the overload with labels for an example of the use of the two parts.
+ *
+ * @param input Input dataset to shuffle in place.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ * @return The number of points of the training set.
+ */
+template<typename T>
+size_t SplitInPlace(arma::Mat<T>& input, const double testRatio)
+{
+  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
+
+  // Fisher-Yates shuffle of the points.
+  for (size_t i = input.n_cols; i > 1; --i)
+  {
+    const size_t j = static_cast<size_t>(math::Random() * i);
+    if (j != i - 1)
+      input.swap_cols(i - 1, j);
+  }
+
+  return input.n_cols - testSize;
+}
+
 } // namespace data
 } // namespace mlpack
 
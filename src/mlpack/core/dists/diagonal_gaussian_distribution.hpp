@@ -0,0 +1,175 @@
+/**
+ * @file diagonal_gaussian_distribution.hpp
+ *
+ * Implementation of a multivariate Gaussian distribution with diagonal
+ * covariance.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DISTRIBUTIONS_DIAGONAL_GAUSSIAN_DISTRIBUTION_HPP
+#define MLPACK_CORE_DISTRIBUTIONS_DIAGONAL_GAUSSIAN_DISTRIBUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace distribution {
+
+/**
+ * A single multivariate Gaussian distribution with diagonal covariance.  Only
+ * the variance of each dimension is stored, so evaluating the density of a
+ * point takes O(d) time instead of O(d^2), and no matrix has to be factored
+ * when the covariance changes.  The interface is the same as that of
+ * GaussianDistribution, except that the covariance is a vector holding the
+ * diagonal of the covariance matrix.
+ */
+class DiagonalGaussianDistribution
+{
+ private:
+  //! Mean of the distribution.
+  arma::vec mean;
+  //! Diagonal of the covariance of the distribution (all positive).
+  arma::vec covariance;
+  //! Cached inverse of the covariance.
+  arma::vec invCov;
+  //! Cached logdet(cov).
+  double logDetCov;
+
+  //! log(2pi)
+  static const constexpr double log2pi = 1.83787706640934533908193770912475883;
+
+ public:
+  /**
+   * Default constructor, which creates a Gaussian with zero dimension.
+   */
+  DiagonalGaussianDistribution() : logDetCov(0) { /* nothing to do */ }
+
+  /**
+   * Create a Gaussian distribution with zero mean and identity covariance with
+   * the given dimensionality.
+   */
+  DiagonalGaussianDistribution(const size_t dimension) :
+      mean(arma::zeros<arma::vec>(dimension)),
+      covariance(arma::ones<arma::vec>(dimension)),
+      invCov(arma::ones<arma::vec>(dimension)),
+      logDetCov(0)
+  { /* Nothing to do. */ }
+
+  /**
+   * Create a Gaussian distribution with the given mean and diagonal of the
+   * covariance.  Each element of the covariance must be positive.
+   */
+  DiagonalGaussianDistribution(const arma::vec& mean,
+                               const arma::vec& covariance);
+
+  //! Return the dimensionality of this distribution.
+  size_t Dimensionality() const { return mean.n_elem; }
+
+  /**
+   * Return the probability of the given observation.
+   */
+  double Probability(const arma::vec& observation) const
+  {
+    return exp(LogProbability(observation));
+  }
+
+  /**
+   * Return the log probability of the given observation.
+   */
+  double LogProbability(const arma::vec& observation) const;
+
+  /**
+   * Calculates the probability density function for each data point (column)
+   * in the given matrix.
+   *
+   * @param x List of observations.
+   * @param probabilities Output probabilities for each input observation.
+   */
+  void Probability(const arma::mat& x, arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(x, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  /**
+   * Calculates the log probability density function for each data point
+   * (column) in the given matrix.  This is one pass over the matrix, which
+   * takes O(d) time per point.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each observation.
+   */
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
+  /**
+   * Return a randomly generated observation according to the probability
+   * distribution defined by this object.
+   *
+   * @return Random observation from this Gaussian distribution.
+   */
+  arma::vec Random() const;
+
+  /**
+   * Estimate the Gaussian distribution directly from the given observations.
+   *
+   * @param observations List of observations.
+   */
+  void Train(const arma::mat& observations);
+
+  /**
+   * Estimate the Gaussian distribution from the given observations, taking into
+   * account the probability of each observation actually being from this
+   * distribution.
+   */
+  void Train(const arma::mat& observations,
+             const arma::vec& probabilities);
+
+  /**
+   * Return the mean.
+   */
+  const arma::vec& Mean() const { return mean; }
+
+  /**
+   * Return a modifiable copy of the mean.
+   */
+  arma::vec& Mean() { return mean; }
+
+  /**
+   * Return the diagonal of the covariance matrix.
+   */
+  const arma::vec& Covariance() const { return covariance; }
+
+  /**
+   * Set the diagonal of the covariance.
+   */
+  void Covariance(const arma::vec& covariance);
+
+  void Covariance(arma::vec&& covariance);
+
+  /**
+   * Serialize the distribution.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    using data::CreateNVP;
+
+    // We just need to serialize each of the members.
+    ar & CreateNVP(mean, "mean");
+    ar & CreateNVP(covariance, "covariance");
+    ar & CreateNVP(invCov, "invCov");
+    ar & CreateNVP(logDetCov, "logDetCov");
+  }
+
+ private:
+  //! Compute the cached inverse and log-determinant of the covariance.
+  void InvertCovariance();
+};
+
+} // namespace distribution
+} // namespace mlpack
+
+#endif
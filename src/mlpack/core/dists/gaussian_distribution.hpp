@@ -179,16 +179,14 @@ inline void GaussianDistribution::LogProbability(
     arma::vec& logProbabilities) const
 {
   // Column i of 'diffs' is the difference between x.col(i) and the mean.
-  arma::mat diffs = x - (mean * arma::ones<arma::rowvec>(x.n_cols));
-
-  // Now, we only want to calculate the diagonal elements of (diffs' * cov^-1 *
-  // diffs).  We just don't need any of the other elements.  We can calculate
-  // the right hand part of the equation (instead of the left side) so that
-  // later we are referencing columns, not rows -- that is faster.
-  const arma::mat rhs = -0.5 * invCov * diffs;
-  arma::vec logExponents(diffs.n_cols); // We will now fill this.
-  for (size_t i = 0; i < diffs.n_cols; i++)
-    logExponents(i) = accu(diffs.unsafe_col(i) % rhs.unsafe_col(i));
+  arma::mat diffs = x.each_col() - mean;
+
+  // We only want the diagonal elements of (diffs' * cov^-1 * diffs).  Since
+  // cov = L L', each of them is the squared norm of a column of L^-1 diffs,
+  // so a single triangular solve for all the columns gives all of them.
+  const arma::mat whitened = arma::solve(arma::trimatl(covLower), diffs);
+  const arma::vec logExponents = -0.5 * arma::sum(arma::square(whitened),
+      0).t();
 
   const size_t k = x.n_rows;
 
@@ -61,6 +61,15 @@ class CVFunction
              const double minDelta,
              const BoundArgs&... args);
 
+  /**
+   * Copy the given CVFunction object.  The copy runs cross-validation with its
+   * own copy of the cross-validation object, so the copies can be evaluated
+   * concurrently (see GridSearch).
+   *
+   * @param other CVFunction object to copy.
+   */
+  CVFunction(const CVFunction& other);
+
   /**
    * Run cross-validation with the bound and passed parameters.
    *
@@ -69,6 +78,18 @@ class CVFunction
    */
   double Evaluate(const arma::mat& parameters);
 
+  /**
+   * Run cross-validation with the bound and passed parameters, training only
+   * on the given proportion of each training set (see SuccessiveHalving).  The
+   * result does not change the best model.  A std::invalid_argument exception
+   * is thrown if the budget is not in (0, 1].
+   *
+   * @param parameters Arguments (rather than the bound arguments) that should
+   *     be passed into the Evaluate method of the CVType object.
+   * @param budget The proportion of each training set to train on.
+   */
+  double Evaluate(const arma::mat& parameters, const double budget);
+
   /**
    * Evaluate numerically the gradient of the CVFunction with the given
    * parameters.
@@ -100,8 +121,14 @@ class CVFunction
            bool BoundArgsIndexInRange = (BoundArgIndex < BoundArgsAmount)>
   struct UseBoundArg;
 
-  //! A reference to the cross-validation object.
-  CVType& cv;
+  //! The copy of the cross-validation object owned by this object (if any).
+  std::unique_ptr<CVType> cvCopy;
+
+  //! The cross-validation object.
+  CVType* cv;
+
+  //! If false, the evaluations do not change the best model.
+  bool trackBestModel;
 
   //! The bound arguments.
   BoundArgsTupleType boundArgs;
@@ -49,13 +49,30 @@ CVFunction<CVType, MLAlgorithm, TotalArgs, BoundArgs...>::CVFunction(
     const double relativeDelta,
     const double minDelta,
     const BoundArgs&... args) :
-    cv(cv),
+    cv(&cv),
+    trackBestModel(true),
     boundArgs(args...),
     bestObjective(std::numeric_limits<double>::max()),
     relativeDelta(relativeDelta),
     minDelta(minDelta)
 { /* Nothing left to do. */ }
 
+template<typename CVType,
+         typename MLAlgorithm,
+         size_t TotalArgs,
+         typename... BoundArgs>
+CVFunction<CVType, MLAlgorithm, TotalArgs, BoundArgs...>::CVFunction(
+    const CVFunction& other) :
+    cvCopy(new CVType(*other.cv)),
+    cv(cvCopy.get()),
+    trackBestModel(other.trackBestModel),
+    boundArgs(other.boundArgs),
+    bestObjective(other.bestObjective),
+    bestModel(other.bestModel),
+    relativeDelta(other.relativeDelta),
+    minDelta(other.minDelta)
+{ /* Nothing left to do. */ }
+
 template<typename CVType,
          typename MLAlgorithm,
          size_t TotalArgs,
@@ -66,6 +83,34 @@ double CVFunction<CVType, MLAlgorithm, TotalArgs, BoundArgs...>::Evaluate(
   return Evaluate<0, 0>(parameters);
 }
 
+template<typename CVType,
+         typename MLAlgorithm,
+         size_t TotalArgs,
+         typename... BoundArgs>
+double CVFunction<CVType, MLAlgorithm, TotalArgs, BoundArgs...>::Evaluate(
+    const arma::mat& parameters,
+    const double budget)
+{
+  if (budget <= 0.0 || budget > 1.0)
+  {
+    std::ostringstream oss;
+    oss << "CVFunction::Evaluate(): the budget should be in (0, 1], but "
+        << budget << " was given";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const double trainingFraction = cv->TrainingFraction();
+  cv->TrainingFraction() = budget;
+  trackBestModel = false;
+
+  const double objective = Evaluate<0, 0>(parameters);
+
+  cv->TrainingFraction() = trainingFraction;
+  trackBestModel = true;
+
+  return objective;
+}
+
 template<typename CVType,
          typename MLAlgorithm,
          size_t TotalArgs,
@@ -115,15 +160,15 @@ double CVFunction<CVType, MLAlgorithm, TotalArgs, BoundArgs...>::Evaluate(
     const arma::mat& /* parameters */,
     const Args&... args)
 {
-  double objective = cv.Evaluate(args...);
+  double objective = cv->Evaluate(args...);
 
   // Change the best model if we have got a better score, or if we probably
   // have not assigned any valid (trained) model yet.
-  if (bestObjective > objective ||
-      bestObjective == std::numeric_limits<double>::max())
+  if (trackBestModel && (bestObjective > objective ||
+      bestObjective == std::numeric_limits<double>::max()))
   {
     bestObjective = objective;
-    bestModel = std::move(cv.Model());
+    bestModel = std::move(cv->Model());
   }
 
   return objective;
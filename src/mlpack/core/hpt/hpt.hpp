@@ -13,12 +13,17 @@
 #define MLPACK_CORE_HPT_HPT_HPP
 
 #include <mlpack/core/cv/meta_info_extractor.hpp>
+#include <mlpack/core/cv/warm_start_traits.hpp>
 #include <mlpack/core/hpt/deduce_hp_types.hpp>
 #include <mlpack/core/optimizers/grid_search/grid_search.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 namespace mlpack {
 namespace hpt {
 
+//! Check whether a cross-validation class supports warm starts.
+HAS_MEM_FUNC(ResetWarmStart, HasResetWarmStartCheck);
+
 /**
  * The class HyperParameterTuner for the given MLAlgorithm utilizes the provided
  * Optimizer to find the values of hyper-parameters that optimize the value of
@@ -67,12 +72,37 @@ namespace hpt {
  *     Fixed(useCholesky), lambda1Set, lambda2Set);
  * @endcode
  *
+ * GridSearch and SuccessiveHalving can evaluate sets of hyper-parameters in
+ * parallel (see their NumThreads() parameter, which can be set through
+ * Optimizer()); each thread then uses its own copy of the cross-validation
+ * object, including the data.  SuccessiveHalving trains with most of the sets
+ * of hyper-parameters only on a part of the data, and drops the worse sets
+ * early.
+ *
+ * Models that support warm starts (see cv::WarmStartTraits), such as
+ * LogisticRegression and SoftmaxRegression, can be trained starting from the
+ * solution of the previous set of hyper-parameters for the same fold, when
+ * WarmStart() is set.  The sets of values are then visited from the largest
+ * value to the smallest, so that a sweep over a regularization parameter
+ * follows the regularization path from the most regularized model.  The last
+ * hyper-parameter changes fastest, so it should be the regularization
+ * parameter.  With a parallel GridSearch, each thread follows its own part of
+ * the path.
+ *
+ * @code
+ * HyperParameterTuner<LogisticRegression<>, Accuracy, KFoldCV> hpt3(5, data,
+ *     labels);
+ * hpt3.WarmStart() = true;
+ * arma::vec lambdas = arma::logspace(-4, 1, 30);
+ * std::tie(bestLambda) = hpt3.Optimize(lambdas);
+ * @endcode
+ *
  * @tparam MLAlgorithm A machine learning algorithm.
  * @tparam Metric A metric to assess the quality of a trained model.
  * @tparam CV A cross-validation strategy used to assess a set of
  *     hyper-parameters.
- * @tparam OptimizerType An optimization strategy (GridSearch and
- *     GradientDescent are supported).
+ * @tparam OptimizerType An optimization strategy (GridSearch,
+ *     SuccessiveHalving and GradientDescent are supported).
  * @tparam MatType The type of data.
  * @tparam PredictionsType The type of predictions (should be passed when the
  *     predictions type is a template parameter in Train methods of the given
@@ -151,13 +181,32 @@ class HyperParameterTuner
    */
   double& MinDelta() { return minDelta; }
 
+  /**
+   * Get whether the models are trained starting from the solution of the
+   * previous set of hyper-parameters (see the class documentation).
+   *
+   * The default value is false.
+   */
+  bool WarmStart() const { return warmStart; }
+
+  /**
+   * Modify whether the models are trained starting from the solution of the
+   * previous set of hyper-parameters (see the class documentation).  If the
+   * MLAlgorithm or the CV class does not support warm starts, Optimize() throws
+   * a std::invalid_argument exception.
+   *
+   * The default value is false.
+   */
+  bool& WarmStart() { return warmStart; }
+
   /**
    * Find the best hyper-parameters by using the given Optimizer. For each
    * hyper-parameter one of the following should be passed as an argument.
-   * 1. A set of values to choose from (when using GridSearch as an optimizer).
+   * 1. A set of values to choose from (when using GridSearch or
+   *   SuccessiveHalving as an optimizer).
    *   The set of values should be an STL-compatible container (it should
    *   provide begin() and end() methods returning iterators).
-   * 2. A starting value (when using any other optimizer than GridSearch).
+   * 2. A starting value (when using any other optimizer).
    * 3. A value fixed by using the function mlpack::hpt::Fixed. In this case the
    *   hyper-parameter will not be optimized.
    *
@@ -230,6 +279,28 @@ class HyperParameterTuner
    */
   double minDelta;
 
+  //! Whether the models are warm-started.
+  bool warmStart;
+
+  /**
+   * Pass the warm start setting to the cross-validation object and forget the
+   * models of the last run.
+   */
+  template<typename T = CVType,
+           typename = std::enable_if_t<
+               HasResetWarmStartCheck<T, void(T::*)()>::value>>
+  void InitWarmStart();
+
+  /**
+   * Throw an exception if warm starts are requested, as the cross-validation
+   * class does not support them.
+   */
+  template<typename T = CVType,
+           typename = std::enable_if_t<
+               !HasResetWarmStartCheck<T, void(T::*)()>::value>,
+           typename = void>
+  void InitWarmStart();
+
   /**
    * A type function to check whether the element I of the tuple type is a
    * PreFixedArg.
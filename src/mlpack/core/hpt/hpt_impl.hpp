@@ -32,7 +32,7 @@ HyperParameterTuner<MLAlgorithm,
                     MatType,
                     PredictionsType,
                     WeightsType>::HyperParameterTuner(const CVArgs&... args) :
-    cv(args...), relativeDelta(0.01), minDelta(1e-10) {}
+    cv(args...), relativeDelta(0.01), minDelta(1e-10), warmStart(false) {}
 
 template<typename MLAlgorithm,
          typename Metric,
@@ -60,6 +60,7 @@ TupleOfHyperParameters<Args...> HyperParameterTuner<MLAlgorithm,
   arma::mat bestParameters(numberOfParametersToOptimize, 1);
   const auto argsTuple = std::tie(args...);
 
+  InitWarmStart();
   InitAndOptimize<0>(argsTuple, bestParameters, datasetInfo);
 
   return VectorToTuple<TupleOfHyperParameters<Args...>, 0>(bestParameters);
@@ -174,7 +175,17 @@ void HyperParameterTuner<MLAlgorithm,
 {
   static const size_t dimension =
       I - std::tuple_size<std::tuple<FixedArgs...>>::value;
-  for (auto value : std::get<I>(args))
+  using ValueType = typename std::decay<
+      decltype(*std::begin(std::get<I>(args)))>::type;
+  std::vector<ValueType> values(std::begin(std::get<I>(args)),
+      std::end(std::get<I>(args)));
+
+  // With warm starts, the values are visited from the largest to the smallest,
+  // which follows a regularization path from the most regularized model.
+  if (warmStart)
+    std::sort(values.begin(), values.end(), std::greater<ValueType>());
+
+  for (auto value : values)
     datasetInfo.MapString<size_t>(value, dimension);
 
   if (datasetInfo.NumMappings(dimension) == 0)
@@ -188,6 +199,55 @@ void HyperParameterTuner<MLAlgorithm,
   InitAndOptimize<I + 1>(args, bestParams, datasetInfo, fixedArgs...);
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         template<typename, typename, typename, typename, typename> class CV,
+         typename Optimizer,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename T, typename>
+void HyperParameterTuner<MLAlgorithm,
+                         Metric,
+                         CV,
+                         Optimizer,
+                         MatType,
+                         PredictionsType,
+                         WeightsType>::InitWarmStart()
+{
+  if (warmStart && !mlpack::cv::WarmStartTraits<MLAlgorithm>::Supported)
+  {
+    throw std::invalid_argument("HyperParameterTuner::Optimize(): the given "
+        "MLAlgorithm does not support warm starts");
+  }
+
+  cv.WarmStart() = warmStart;
+  cv.ResetWarmStart();
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         template<typename, typename, typename, typename, typename> class CV,
+         typename Optimizer,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename T, typename, typename>
+void HyperParameterTuner<MLAlgorithm,
+                         Metric,
+                         CV,
+                         Optimizer,
+                         MatType,
+                         PredictionsType,
+                         WeightsType>::InitWarmStart()
+{
+  if (warmStart)
+  {
+    throw std::invalid_argument("HyperParameterTuner::Optimize(): the given "
+        "cross-validation class does not support warm starts");
+  }
+}
+
 template<typename MLAlgorithm,
          typename Metric,
          template<typename, typename, typename, typename, typename> class CV,
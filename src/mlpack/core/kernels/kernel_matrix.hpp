@@ -0,0 +1,283 @@
+/**
+ * @file kernel_matrix.hpp
+ *
+ * Evaluation of a kernel between every point of one set of points and every
+ * point of another set.  Kernels of the inner product or of the squared
+ * distance are evaluated with one matrix multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+#define MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "kernel_traits.hpp"
+#include "linear_kernel.hpp"
+#include "polynomial_kernel.hpp"
+#include "hyperbolic_tangent_kernel.hpp"
+#include "cosine_distance.hpp"
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Compute kernel matrices for the given kernel type; use KernelMatrix() rather
+ * than this class directly.  By default, each pair of points is evaluated with
+ * KernelType::Evaluate(), in parallel with OpenMP.  If
+ * KernelTraits<KernelType>::UsesSquaredDistance is true, all the squared
+ * distances are found with one matrix multiplication, and the kernel is
+ * evaluated on the distances with KernelType::Evaluate(double), which such
+ * kernels must provide (as GaussianKernel and EpanechnikovKernel do).  The
+ * specializations for LinearKernel, PolynomialKernel, HyperbolicTangentKernel
+ * and CosineDistance apply the kernel to the matrix of inner products.
+ *
+ * A specialization must provide the two Evaluate() functions below.
+ *
+ * @tparam KernelType Type of kernel to evaluate.
+ * @tparam UsesSquaredDistance Whether the kernel is a function of the squared
+ *     distance.
+ */
+template<typename KernelType,
+         bool UsesSquaredDistance =
+             KernelTraits<KernelType>::UsesSquaredDistance>
+class KernelMatrixRule
+{
+ public:
+  //! Set result(i, j) to K(a_i, b_j).
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(KernelType& kernel,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& result)
+  {
+    result.set_size(a.n_cols, b.n_cols);
+
+    #pragma omp parallel for schedule(dynamic, 16) if (b.n_cols > 1)
+    for (omp_size_t j = 0; j < (omp_size_t) b.n_cols; ++j)
+      for (size_t i = 0; i < a.n_cols; ++i)
+        result(i, j) = kernel.Evaluate(a.col(i), b.col(j));
+  }
+
+  //! Set result(i, j) to K(x_i, x_j); only half of the pairs are evaluated.
+  template<typename MatType>
+  static void Evaluate(KernelType& kernel,
+                       const MatType& data,
+                       arma::mat& result)
+  {
+    result.set_size(data.n_cols, data.n_cols);
+
+    #pragma omp parallel for schedule(dynamic, 16) if (data.n_cols > 1)
+    for (omp_size_t j = 0; j < (omp_size_t) data.n_cols; ++j)
+      for (size_t i = 0; i <= (size_t) j; ++i)
+        result(i, j) = kernel.Evaluate(data.col(i), data.col(j));
+
+    // Copy to the lower triangular part of the matrix.
+    result = arma::symmatu(result);
+  }
+};
+
+//! Kernels of the squared distance use ||a||^2 + ||b||^2 - 2 a^T b.
+template<typename KernelType>
+class KernelMatrixRule<KernelType, true>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(KernelType& kernel,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& result)
+  {
+    const arma::rowvec aNorms(arma::sum(arma::square(a), 0));
+    const arma::rowvec bNorms(arma::sum(arma::square(b), 0));
+
+    result = -2.0 * (a.t() * b);
+    result.each_col() += aNorms.t();
+    result.each_row() += bNorms;
+    ApplyKernel(kernel, result);
+  }
+
+  template<typename MatType>
+  static void Evaluate(KernelType& kernel,
+                       const MatType& data,
+                       arma::mat& result)
+  {
+    const arma::rowvec norms(arma::sum(arma::square(data), 0));
+
+    result = -2.0 * (data.t() * data);
+    result.each_col() += norms.t();
+    result.each_row() += norms;
+    ApplyKernel(kernel, result);
+  }
+
+ private:
+  //! Replace each squared distance with the kernel value.
+  static void ApplyKernel(KernelType& kernel, arma::mat& result)
+  {
+    #pragma omp parallel for if (result.n_elem > 10000)
+    for (omp_size_t i = 0; i < (omp_size_t) result.n_elem; ++i)
+    {
+      // Rounding can make the squared distance of close points negative.
+      result[i] = kernel.Evaluate(std::sqrt(std::max(result[i], 0.0)));
+    }
+  }
+};
+
+//! The linear kernel is the inner product itself.
+template<>
+class KernelMatrixRule<LinearKernel, false>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(LinearKernel& /* kernel */,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& result)
+  {
+    result = a.t() * b;
+  }
+
+  template<typename MatType>
+  static void Evaluate(LinearKernel& /* kernel */,
+                       const MatType& data,
+                       arma::mat& result)
+  {
+    result = data.t() * data;
+  }
+};
+
+//! The polynomial kernel is applied to each of the inner products.
+template<>
+class KernelMatrixRule<PolynomialKernel, false>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(PolynomialKernel& kernel,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& result)
+  {
+    result = a.t() * b;
+    result += kernel.Offset();
+    result = arma::pow(result, kernel.Degree());
+  }
+
+  template<typename MatType>
+  static void Evaluate(PolynomialKernel& kernel,
+                       const MatType& data,
+                       arma::mat& result)
+  {
+    Evaluate(kernel, data, data, result);
+  }
+};
+
+//! The hyperbolic tangent kernel is applied to each of the inner products.
+template<>
+class KernelMatrixRule<HyperbolicTangentKernel, false>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(HyperbolicTangentKernel& kernel,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& result)
+  {
+    result = a.t() * b;
+    result = arma::tanh(kernel.Scale() * result + kernel.Offset());
+  }
+
+  template<typename MatType>
+  static void Evaluate(HyperbolicTangentKernel& kernel,
+                       const MatType& data,
+                       arma::mat& result)
+  {
+    Evaluate(kernel, data, data, result);
+  }
+};
+
+//! The inner products are divided by the norms of the points; as in
+//! CosineDistance::Evaluate(), the result is 0 if either point is zero.
+template<>
+class KernelMatrixRule<CosineDistance, false>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(CosineDistance& /* kernel */,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& result)
+  {
+    result = a.t() * b;
+
+    arma::vec aNorms(a.n_cols), bNorms(b.n_cols);
+    for (size_t i = 0; i < a.n_cols; ++i)
+      aNorms[i] = arma::norm(a.col(i), 2);
+    for (size_t j = 0; j < b.n_cols; ++j)
+      bNorms[j] = arma::norm(b.col(j), 2);
+
+    for (size_t j = 0; j < result.n_cols; ++j)
+    {
+      for (size_t i = 0; i < result.n_rows; ++i)
+      {
+        const double denominator = aNorms[i] * bNorms[j];
+        result(i, j) = (denominator == 0.0) ? 0.0 :
+            result(i, j) / denominator;
+      }
+    }
+  }
+
+  template<typename MatType>
+  static void Evaluate(CosineDistance& kernel,
+                       const MatType& data,
+                       arma::mat& result)
+  {
+    Evaluate(kernel, data, data, result);
+  }
+};
+
+/**
+ * Compute the kernel between each point of a and each point of b: after the
+ * call, element (i, j) of result holds K(a_i, b_j).  The points may be dense
+ * or sparse.  See KernelMatrixRule for how each kernel is evaluated.
+ *
+ * @code
+ * GaussianKernel kernel(2.0);
+ * arma::mat kernelMatrix;
+ * KernelMatrix(kernel, queries, references, kernelMatrix);
+ * @endcode
+ *
+ * @param kernel Instantiated kernel.
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param result Matrix to store the (a.n_cols x b.n_cols) kernel values in.
+ */
+template<typename KernelType, typename MatTypeA, typename MatTypeB>
+void KernelMatrix(KernelType& kernel,
+                  const MatTypeA& a,
+                  const MatTypeB& b,
+                  arma::mat& result)
+{
+  KernelMatrixRule<KernelType>::Evaluate(kernel, a, b, result);
+}
+
+/**
+ * Compute the symmetric kernel matrix of the given points: after the call,
+ * element (i, j) of result holds K(x_i, x_j).
+ *
+ * @param kernel Instantiated kernel.
+ * @param data Set of points.
+ * @param result Matrix to store the (data.n_cols x data.n_cols) kernel values
+ *     in.
+ */
+template<typename KernelType, typename MatType>
+void KernelMatrix(KernelType& kernel, const MatType& data, arma::mat& result)
+{
+  KernelMatrixRule<KernelType>::Evaluate(kernel, data, result);
+}
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,9 @@
  */
 #include "pspectrum_string_kernel.hpp"
 
+#include <algorithm>
+#include <unordered_map>
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::kernel;
@@ -85,4 +88,39 @@ mlpack::kernel::PSpectrumStringKernel::PSpectrumStringKernel(
   }
 
   Log::Info << "Substring extraction complete." << std::endl;
+
+  BuildHistograms();
+}
+
+/**
+ * Build the sorted histograms of substring identifiers from the counts.
+ */
+void mlpack::kernel::PSpectrumStringKernel::BuildHistograms()
+{
+  // Give each distinct substring the next identifier when it is first seen.
+  std::unordered_map<std::string, size_t> identifiers;
+
+  histograms.resize(counts.size());
+  for (size_t dataset = 0; dataset < counts.size(); ++dataset)
+  {
+    histograms[dataset].resize(counts[dataset].size());
+    for (size_t index = 0; index < counts[dataset].size(); ++index)
+    {
+      const std::map<std::string, int>& mapping = counts[dataset][index];
+      std::vector<std::pair<size_t, int> >& histogram =
+          histograms[dataset][index];
+
+      histogram.clear();
+      histogram.reserve(mapping.size());
+      std::map<std::string, int>::const_iterator it = mapping.begin();
+      for (; it != mapping.end(); ++it)
+      {
+        const size_t identifier = identifiers.insert(std::make_pair(
+            (*it).first, identifiers.size())).first->second;
+        histogram.push_back(std::make_pair(identifier, (*it).second));
+      }
+
+      std::sort(histogram.begin(), histogram.end());
+    }
+  }
 }
@@ -18,6 +18,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mlpack/prereqs.hpp>
@@ -61,6 +62,13 @@ namespace kernel {
  * the data according to the fake data matrix -- resulting in a meaningless
  * tree.  This kernel was originally written for the FastMKS method; so, at the
  * very least, it will work with that.
+ *
+ * At construction, every distinct substring of the datasets is given an
+ * integer identifier, and each string gets a histogram of the identifiers of
+ * its substrings, sorted by identifier.  Evaluate() is then a linear merge of
+ * two integer arrays, without any string comparisons or allocations, so the
+ * kernel can be evaluated concurrently by several threads (for instance by
+ * KernelMatrix()).
  */
 class PSpectrumStringKernel
 {
@@ -92,10 +100,23 @@ class PSpectrumStringKernel
   //! Access the lists of substrings.
   const std::vector<std::vector<std::map<std::string, int> > >& Counts() const
   { return counts; }
-  //! Modify the lists of substrings.
+  //! Modify the lists of substrings.  Evaluate() uses the histograms, so
+  //! call BuildHistograms() after modifying the counts.
   std::vector<std::vector<std::map<std::string, int> > >& Counts()
   { return counts; }
 
+  //! Access the histograms: the sorted (substring identifier, count) pairs of
+  //! each string of each dataset.
+  const std::vector<std::vector<std::vector<std::pair<size_t, int> > > >&
+  Histograms() const { return histograms; }
+
+  /**
+   * Build the histograms that Evaluate() uses from the counts of substrings.
+   * This is done by the constructor, so it only has to be called again after
+   * the counts are modified.
+   */
+  void BuildHistograms();
+
   //! Access the value of p.
   size_t P() const { return p; }
   //! Modify the value of p.
@@ -109,6 +130,10 @@ class PSpectrumStringKernel
   //! is not wonderful...
   std::vector<std::vector<std::map<std::string, int> > > counts;
 
+  //! The counts of substrings of each string, as (substring identifier,
+  //! count) pairs sorted by identifier.
+  std::vector<std::vector<std::vector<std::pair<size_t, int> > > > histograms;
+
   //! The value of p to use in calculation.
   size_t p;
 };
@@ -36,39 +36,35 @@ template<typename VecType>
 double PSpectrumStringKernel::Evaluate(const VecType& a,
                                        const VecType& b) const
 {
-  // Get the map of substrings for the two strings we are interested in.
-  const std::map<std::string, int>& aMap = counts[a[0]][a[1]];
-  const std::map<std::string, int>& bMap = counts[b[0]][b[1]];
+  // Get the histograms of substrings for the two strings we are interested in.
+  const std::vector<std::pair<size_t, int> >& aHist =
+      histograms[(size_t) a[0]][(size_t) a[1]];
+  const std::vector<std::pair<size_t, int> >& bHist =
+      histograms[(size_t) b[0]][(size_t) b[1]];
 
   double eval = 0;
 
-  // Loop through the two maps (which, when iterated through, are sorted
-  // alphabetically).
-  std::map<std::string, int>::const_iterator aIt = aMap.begin();
-  std::map<std::string, int>::const_iterator bIt = bMap.begin();
-
-  while ((aIt != aMap.end()) && (bIt != bMap.end()))
+  // Loop through the two histograms, which are sorted by substring identifier.
+  size_t i = 0, j = 0;
+  while ((i < aHist.size()) && (j < bHist.size()))
   {
-    // Compare alphabetically (this is how std::map is ordered).
-    int result = (*aIt).first.compare((*bIt).first);
-
-    if (result == 0) // The same substring.
+    if (aHist[i].first == bHist[j].first) // The same substring.
     {
-      eval += ((*aIt).second * (*bIt).second);
+      eval += (aHist[i].second * bHist[j].second);
 
       // Now increment both.
-      ++aIt;
-      ++bIt;
+      ++i;
+      ++j;
     }
-    else if (result > 0)
+    else if (aHist[i].first > bHist[j].first)
     {
-      // aIt is "ahead" of bIt (alphabetically); so increment bIt to "catch up".
-      ++bIt;
+      // i is "ahead" of j; so increment j to "catch up".
+      ++j;
     }
     else
     {
-      // bIt is "ahead" of aIt (alphabetically); so increment aIt to "catch up".
-      ++aIt;
+      // j is "ahead" of i; so increment i to "catch up".
+      ++i;
     }
   }
 
@@ -60,7 +60,7 @@ class TriangularKernel
    */
   double Evaluate(const double distance) const
   {
-    return std::max(0.0, (1 - distance) / bandwidth);
+    return std::max(0.0, 1 - distance / bandwidth);
   }
 
   /**
@@ -72,11 +72,11 @@ class TriangularKernel
    */
   double Gradient(const double distance) const
   {
-    if (distance < 1)
+    if (distance < bandwidth)
     {
       return -1.0 / bandwidth;
     }
-    else if (distance > 1)
+    else if (distance > bandwidth)
     {
       return 0;
     }
@@ -0,0 +1,138 @@
+/**
+ * @file moments.hpp
+ *
+ * Definition of the Moments class, which computes the mean, variance, skewness
+ * and kurtosis of a sequence of values in a single pass, and of
+ * DimensionMoments(), which computes them for each dimension of a dataset in
+ * parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_MOMENTS_HPP
+#define MLPACK_CORE_MATH_MOMENTS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace math {
+
+/**
+ * The moments (up to the fourth) of a sequence of values, which are updated
+ * one value at a time with the numerically stable updates of Welford and
+ * Terriberry.  The moments of two sequences can be merged into the moments of
+ * their concatenation, so that the moments of a large sequence can be computed
+ * in parallel over parts of it.  The statistics have the same definitions as
+ * those of the preprocess_describe program.
+ *
+ * For more information, see the following.
+ *
+ * @techreport{pebay2008formulas,
+ *   title       = {Formulas for Robust, One-Pass Parallel Computation of
+ *                  Covariances and Arbitrary-Order Statistical Moments},
+ *   author      = {P{\'e}bay, Philippe},
+ *   institution = {Sandia National Laboratories},
+ *   number      = {SAND2008-6212},
+ *   year        = {2008}
+ * }
+ */
+class Moments
+{
+ public:
+  //! Create the moments of an empty sequence.
+  Moments();
+
+  //! Add the given value to the sequence.
+  void Add(const double value);
+
+  //! Merge the moments of the given sequence, which follows this one.
+  void Merge(const Moments& other);
+
+  //! Get the number of values.
+  size_t Count() const { return count; }
+  //! Get the mean of the values.
+  double Mean() const { return mean; }
+  //! Get the minimum value (DBL_MAX if there are none).
+  double Min() const { return min; }
+  //! Get the maximum value (-DBL_MAX if there are none).
+  double Max() const { return max; }
+
+  //! Get the sum of the squared deviations from the mean.
+  double M2() const { return m2; }
+  //! Get the sum of the cubed deviations from the mean.
+  double M3() const { return m3; }
+  //! Get the sum of the fourth powers of the deviations from the mean.
+  double M4() const { return m4; }
+
+  /**
+   * Get the variance of the values (0 if there are fewer than two).
+   *
+   * @param population If true, the population variance; otherwise, the sample
+   *     variance.
+   */
+  double Variance(const bool population = false) const;
+
+  //! Get the standard deviation of the values (see Variance()).
+  double StandardDeviation(const bool population = false) const
+  {
+    return std::sqrt(Variance(population));
+  }
+
+  /**
+   * Get the skewness of the values.
+   *
+   * @param population If true, the population skewness; otherwise, the sample
+   *     skewness.
+   */
+  double Skewness(const bool population = false) const;
+
+  /**
+   * Get the excess kurtosis of the values.
+   *
+   * @param population If true, the population excess kurtosis; otherwise, the
+   *     sample excess kurtosis.
+   */
+  double Kurtosis(const bool population = false) const;
+
+ private:
+  //! The number of values.
+  size_t count;
+  //! The mean of the values.
+  double mean;
+  //! The sum of the squared deviations from the mean.
+  double m2;
+  //! The sum of the cubed deviations from the mean.
+  double m3;
+  //! The sum of the fourth powers of the deviations from the mean.
+  double m4;
+  //! The minimum value.
+  double min;
+  //! The maximum value.
+  double max;
+};
+
+/**
+ * Compute the moments of each dimension (row) of the given dataset in a
+ * single pass over the data.  The points are split into one contiguous block
+ * per thread, the moments of the blocks are computed in parallel, and they are
+ * then merged in order.
+ *
+ * @param data Dataset (one point per column).
+ * @param moments Vector to store the moments of each dimension into.
+ * @param numThreads Number of threads to use; 0 means the number OpenMP
+ *     chooses.
+ */
+template<typename eT>
+void DimensionMoments(const arma::Mat<eT>& data,
+                      std::vector<Moments>& moments,
+                      const size_t numThreads = 0);
+
+} // namespace math
+} // namespace mlpack
+
+// Include implementation.
+#include "moments_impl.hpp"
+
+#endif
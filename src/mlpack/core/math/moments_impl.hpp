@@ -0,0 +1,146 @@
+/**
+ * @file moments_impl.hpp
+ *
+ * Implementation of the (inlined) Moments class and of DimensionMoments().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_MOMENTS_IMPL_HPP
+#define MLPACK_CORE_MATH_MOMENTS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "moments.hpp"
+
+namespace mlpack {
+namespace math {
+
+inline Moments::Moments() :
+    count(0),
+    mean(0.0),
+    m2(0.0),
+    m3(0.0),
+    m4(0.0),
+    min(std::numeric_limits<double>::max()),
+    max(-std::numeric_limits<double>::max())
+{ /* Nothing to do. */ }
+
+inline void Moments::Add(const double value)
+{
+  const double n1 = (double) count;
+  const double n = (double) ++count;
+  const double delta = value - mean;
+  const double deltaN = delta / n;
+  const double deltaN2 = deltaN * deltaN;
+  const double term = delta * deltaN * n1;
+
+  mean += deltaN;
+  m4 += term * deltaN2 * (n * n - 3 * n + 3) + 6 * deltaN2 * m2 -
+      4 * deltaN * m3;
+  m3 += term * deltaN * (n - 2) - 3 * deltaN * m2;
+  m2 += term;
+
+  min = std::min(min, value);
+  max = std::max(max, value);
+}
+
+inline void Moments::Merge(const Moments& other)
+{
+  if (other.count == 0)
+    return;
+  if (count == 0)
+  {
+    *this = other;
+    return;
+  }
+
+  const double na = (double) count;
+  const double nb = (double) other.count;
+  const double n = na + nb;
+  const double delta = other.mean - mean;
+  const double delta2 = delta * delta;
+
+  // These use the old values of m2 and m3, so m4 is updated first.
+  m4 += other.m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) /
+      (n * n * n) + 6 * delta2 * (na * na * other.m2 + nb * nb * m2) / (n * n) +
+      4 * delta * (na * other.m3 - nb * m3) / n;
+  m3 += other.m3 + delta2 * delta * na * nb * (na - nb) / (n * n) +
+      3 * delta * (na * other.m2 - nb * m2) / n;
+  m2 += other.m2 + delta2 * na * nb / n;
+  mean += delta * nb / n;
+  count += other.count;
+
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+}
+
+inline double Moments::Variance(const bool population) const
+{
+  if (count < 2)
+    return 0.0;
+
+  return m2 / (population ? count : (count - 1));
+}
+
+inline double Moments::Skewness(const bool population) const
+{
+  const double n = (double) count;
+  const double s3 = std::pow(StandardDeviation(population), 3);
+  if (population)
+    return m3 / (n * s3);
+  else
+    return n * m3 / ((n - 1) * (n - 2) * s3);
+}
+
+inline double Moments::Kurtosis(const bool population) const
+{
+  const double n = (double) count;
+  if (population)
+    return n * (m4 / (m2 * m2)) - 3;
+
+  const double s4 = std::pow(StandardDeviation(population), 4);
+  const double norm3 = (3 * (n - 1) * (n - 1)) / ((n - 2) * (n - 3));
+  const double normC = (n * (n + 1)) / ((n - 1) * (n - 2) * (n - 3));
+  return normC * (m4 / s4) - norm3;
+}
+
+template<typename eT>
+void DimensionMoments(const arma::Mat<eT>& data,
+                      std::vector<Moments>& moments,
+                      const size_t numThreads)
+{
+  const size_t threads = ParallelThreads(numThreads);
+  const size_t blocks = std::max(std::min(threads, (size_t) data.n_cols),
+      (size_t) 1);
+
+  // The moments of all dimensions for each block of points, so that each
+  // thread reads its points column by column.
+  std::vector<std::vector<Moments>> blockMoments(blocks,
+      std::vector<Moments>(data.n_rows));
+
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t b = 0; b < (omp_size_t) blocks; ++b)
+  {
+    const size_t begin = data.n_cols * b / blocks;
+    const size_t end = data.n_cols * (b + 1) / blocks;
+    std::vector<Moments>& m = blockMoments[b];
+    for (size_t i = begin; i < end; ++i)
+    {
+      const eT* column = data.colptr(i);
+      for (size_t d = 0; d < data.n_rows; ++d)
+        m[d].Add((double) column[d]);
+    }
+  }
+
+  moments.swap(blockMoments[0]);
+  for (size_t b = 1; b < blocks; ++b)
+    for (size_t d = 0; d < data.n_rows; ++d)
+      moments[d].Merge(blockMoments[b][d]);
+}
+
+} // namespace math
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,11 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/mlpack_export.hpp>
 #include <random>
+#include "random_stream.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace math /** Miscellaneous math routines. */ {
@@ -29,11 +34,18 @@ extern MLPACK_EXPORT std::mt19937 randGen;
 extern MLPACK_EXPORT std::uniform_real_distribution<> randUniformDist;
 // Global normal distribution.
 extern MLPACK_EXPORT std::normal_distribution<> randNormalDist;
+// Seed of the per-thread random streams.
+extern MLPACK_EXPORT uint64_t randStreamSeed;
+// Number of times RandomSeed() was called; the per-thread random streams are
+// seeded again when it changes.
+extern MLPACK_EXPORT size_t randStreamGeneration;
 
 /**
  * Set the random seed used by the random functions (Random() and RandInt()).
  * The seed is casted to a 32-bit integer before being given to the random
  * number generator, but a size_t is taken as a parameter for API consistency.
+ * The per-thread random streams (see ThreadRandomStream()) are also seeded
+ * again.
  *
  * @param seed Seed for the random number generator.
  */
@@ -42,6 +54,117 @@ inline void RandomSeed(const size_t seed)
   randGen.seed((uint32_t) seed);
   srand((unsigned int) seed);
   arma::arma_rng::set_seed(seed);
+  randStreamSeed = (uint64_t) seed;
+  ++randStreamGeneration;
+}
+
+/**
+ * Get the random stream set for the current thread by a RandomStreamScope, or
+ * NULL if there is none.
+ */
+inline RandomStream*& ScopedRandomStream()
+{
+  static thread_local RandomStream* stream = NULL;
+  return stream;
+}
+
+/**
+ * Get the random stream of the current thread: the stream with the index of
+ * the OpenMP thread for the seed given to RandomSeed().  The random functions
+ * use it inside parallel regions that did not set a stream with a
+ * RandomStreamScope, so that the threads never share the global generator.
+ * Since the numbers depend on which thread runs which task, parallel code
+ * that must be reproducible should use a RandomStreamScope for each task.
+ */
+inline RandomStream& ThreadRandomStream()
+{
+  static thread_local RandomStream stream;
+  static thread_local size_t generation = std::numeric_limits<size_t>::max();
+  if (generation != randStreamGeneration)
+  {
+    size_t thread = 0;
+    #ifdef HAS_OPENMP
+    thread = (size_t) omp_get_thread_num();
+    #endif
+    stream.Seed(randStreamSeed, thread);
+    generation = randStreamGeneration;
+  }
+  return stream;
+}
+
+/**
+ * Get the random stream that the random functions should draw from on the
+ * current thread, or NULL if they should use the global generator (outside of
+ * parallel regions, when no RandomStreamScope is active).
+ */
+inline RandomStream* ActiveRandomStream()
+{
+  RandomStream* stream = ScopedRandomStream();
+  #ifdef HAS_OPENMP
+  if (stream == NULL && omp_in_parallel())
+    stream = &ThreadRandomStream();
+  #endif
+  return stream;
+}
+
+/**
+ * While a RandomStreamScope exists, the random functions of the thread that
+ * created it (Random(), RandInt(), RandNormal() and the functions built on
+ * them) draw from the given stream instead of the global generator.  This
+ * makes code that only knows about the global random functions, such as the
+ * dimension selection of decision trees, reproducible and race-free when it
+ * runs in parallel tasks:
+ *
+ * @code
+ * const uint64_t seed = math::RandomStreamSeed();
+ * #pragma omp parallel for
+ * for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+ * {
+ *   math::RandomStream stream(seed, i);
+ *   math::RandomStreamScope scope(stream);
+ *   Task(i); // Every call to math::Random() draws from stream.
+ * }
+ * @endcode
+ *
+ * Scopes can be nested; the previous stream is used again when a scope ends.
+ */
+class RandomStreamScope
+{
+ public:
+  /**
+   * Make the random functions of this thread draw from the given stream.
+   *
+   * @param stream Stream to draw from; it must outlive the scope.
+   */
+  RandomStreamScope(RandomStream& stream) : previous(ScopedRandomStream())
+  {
+    ScopedRandomStream() = &stream;
+  }
+
+  //! Use the previous stream again.
+  ~RandomStreamScope() { ScopedRandomStream() = previous; }
+
+ private:
+  //! A scope cannot be copied.
+  RandomStreamScope(const RandomStreamScope&);
+  //! A scope cannot be copied.
+  RandomStreamScope& operator=(const RandomStreamScope&);
+
+  //! The stream that was used before the scope.
+  RandomStream* previous;
+};
+
+/**
+ * Draw a 64-bit seed for a family of RandomStreams.  Outside parallel
+ * regions this is drawn from the global generator, so it is determined by the
+ * seed given to RandomSeed(), and every call gives a new family of streams.
+ */
+inline uint64_t RandomStreamSeed()
+{
+  if (RandomStream* stream = ActiveRandomStream())
+    return (*stream)();
+  const uint64_t high = (uint64_t) randGen();
+  return (high << 32) | (uint64_t) randGen();
 }
 
 /**
@@ -49,6 +172,8 @@ inline void RandomSeed(const size_t seed)
  */
 inline double Random()
 {
+  if (RandomStream* stream = ActiveRandomStream())
+    return stream->Random();
   return randUniformDist(randGen);
 }
 
@@ -57,7 +182,7 @@ inline double Random()
  */
 inline double Random(const double lo, const double hi)
 {
-  return lo + (hi - lo) * randUniformDist(randGen);
+  return lo + (hi - lo) * Random();
 }
 
 /**
@@ -65,7 +190,7 @@ inline double Random(const double lo, const double hi)
  */
 inline int RandInt(const int hiExclusive)
 {
-  return (int) std::floor((double) hiExclusive * randUniformDist(randGen));
+  return (int) std::floor((double) hiExclusive * Random());
 }
 
 /**
@@ -73,8 +198,7 @@ inline int RandInt(const int hiExclusive)
  */
 inline int RandInt(const int lo, const int hiExclusive)
 {
-  return lo + (int) std::floor((double) (hiExclusive - lo)
-                               * randUniformDist(randGen));
+  return lo + (int) std::floor((double) (hiExclusive - lo) * Random());
 }
 
 /**
@@ -82,6 +206,8 @@ inline int RandInt(const int lo, const int hiExclusive)
  */
 inline double RandNormal()
 {
+  if (RandomStream* stream = ActiveRandomStream())
+    return stream->RandNormal();
   return randNormalDist(randGen);
 }
 
@@ -94,7 +220,7 @@ inline double RandNormal()
  */
 inline double RandNormal(const double mean, const double variance)
 {
-  return variance * randNormalDist(randGen) + mean;
+  return variance * RandNormal() + mean;
 }
 
 /**
@@ -135,6 +261,57 @@ inline void ObtainDistinctSamples(const size_t loInclusive,
   }
 }
 
+/**
+ * Obtains no more than maxNumSamples distinct samples, as the overload above,
+ * but draws them from the given random number generator instead of the global
+ * one.  Because no global state is used, this may be called from several
+ * threads at once, as long as each uses its own generator.
+ *
+ * @param loInclusive The lower bound (inclusive).
+ * @param hiExclusive The high bound (exclusive).
+ * @param maxNumSamples The maximum number of samples to obtain.
+ * @param distinctSamples The samples that will be obtained.
+ * @param rng Random number generator to draw the samples from.
+ */
+template<typename RNGType>
+inline void ObtainDistinctSamples(const size_t loInclusive,
+                                  const size_t hiExclusive,
+                                  const size_t maxNumSamples,
+                                  arma::uvec& distinctSamples,
+                                  RNGType& rng)
+{
+  const size_t samplesRangeSize = hiExclusive - loInclusive;
+
+  if (samplesRangeSize > maxNumSamples)
+  {
+    arma::Col<size_t> samples;
+
+    samples.zeros(samplesRangeSize);
+
+    std::uniform_real_distribution<> dist;
+    for (size_t i = 0; i < maxNumSamples; i++)
+    {
+      size_t sample = (size_t) std::floor((double) samplesRangeSize *
+          dist(rng));
+      // Guard against a result of exactly 1 due to rounding.
+      if (sample == samplesRangeSize)
+        --sample;
+      samples[sample]++;
+    }
+
+    distinctSamples = arma::find(samples > 0);
+
+    if (loInclusive > 0)
+      distinctSamples += loInclusive;
+  }
+  else
+  {
+    distinctSamples.set_size(samplesRangeSize);
+    for (size_t i = 0; i < samplesRangeSize; i++)
+      distinctSamples[i] = loInclusive + i;
+  }
+}
+
 } // namespace math
 } // namespace mlpack
 
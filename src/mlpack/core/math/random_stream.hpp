@@ -0,0 +1,174 @@
+/**
+ * @file random_stream.hpp
+ *
+ * Definition of RandomStream, a counter-based random number generator that
+ * can be split into independent streams, for parallel algorithms.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_RANDOM_STREAM_HPP
+#define MLPACK_CORE_MATH_RANDOM_STREAM_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <random>
+
+namespace mlpack {
+namespace math {
+
+/**
+ * A counter-based random number generator.  The i'th number of a stream is a
+ * hash (the SplitMix64 finalizer) of a key plus i times a constant, and the
+ * key is a hash of a seed and a stream index.  So each (seed, stream) pair
+ * gives its own sequence, the state is only two integers, and any number of
+ * streams can be made from one seed without drawing anything from a shared
+ * generator.  This is what parallel algorithms should use: give each task
+ * (not each thread) the stream of its index, and the results do not depend on
+ * the number of threads or on the scheduling.
+ *
+ * RandomStream satisfies the requirements of a uniform random bit generator,
+ * so it can be used with the distributions of <random> and std::shuffle().
+ *
+ * @code
+ * const uint64_t seed = math::RandomStreamSeed();
+ * #pragma omp parallel for
+ * for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+ * {
+ *   math::RandomStream stream(seed, i);
+ *   result[i] = stream.Random();
+ * }
+ * @endcode
+ */
+class RandomStream
+{
+ public:
+  //! The type of the numbers that are generated.
+  typedef uint64_t result_type;
+
+  /**
+   * Create the stream with the given index for the given seed.
+   *
+   * @param seed Seed of the family of streams.
+   * @param stream Index of the stream.
+   */
+  RandomStream(const uint64_t seed = 0, const uint64_t stream = 0)
+  {
+    Seed(seed, stream);
+  }
+
+  /**
+   * Restart the generator as the stream with the given index for the given
+   * seed.
+   *
+   * @param seed Seed of the family of streams.
+   * @param stream Index of the stream.
+   */
+  void Seed(const uint64_t seed, const uint64_t stream = 0)
+  {
+    key = Mix(Mix(seed) + (stream + 1) * 0xD1B54A32D192ED03ULL);
+    counter = 0;
+    hasNormal = false;
+  }
+
+  /**
+   * Get a stream whose numbers are independent of those of this one, for the
+   * given index.  The new stream depends on the key of this stream, but not
+   * on how many numbers were already generated, so nested parallel loops can
+   * split the stream of their task deterministically.
+   *
+   * @param stream Index of the new stream.
+   */
+  RandomStream Split(const uint64_t stream) const
+  {
+    return RandomStream(key, stream);
+  }
+
+  //! Get the next random number.
+  result_type operator()()
+  {
+    return Mix(key + (++counter) * 0x9E3779B97F4A7C15ULL);
+  }
+
+  //! Skip the given number of random numbers, in constant time.
+  void Discard(const uint64_t n) { counter += n; }
+
+  //! Get the smallest number that can be generated.
+  static constexpr result_type min() { return 0; }
+  //! Get the largest number that can be generated.
+  static constexpr result_type max()
+  { return std::numeric_limits<result_type>::max(); }
+
+  //! Generate a uniform random number in [0, 1).
+  double Random()
+  {
+    // The 53 high bits fill the mantissa of a double.
+    return (double) ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  //! Generate a uniform random number in [lo, hi).
+  double Random(const double lo, const double hi)
+  {
+    return lo + (hi - lo) * Random();
+  }
+
+  //! Generate a uniform random integer in [0, hiExclusive).
+  int RandInt(const int hiExclusive)
+  {
+    return (int) std::floor((double) hiExclusive * Random());
+  }
+
+  //! Generate a uniform random integer in [lo, hiExclusive).
+  int RandInt(const int lo, const int hiExclusive)
+  {
+    return lo + (int) std::floor((double) (hiExclusive - lo) * Random());
+  }
+
+  //! Generate a normally distributed random number with mean 0 and variance 1.
+  double RandNormal()
+  {
+    // The Marsaglia polar method gives two numbers at a time.
+    if (hasNormal)
+    {
+      hasNormal = false;
+      return normal;
+    }
+
+    double u, v, s;
+    do
+    {
+      u = 2.0 * Random() - 1.0;
+      v = 2.0 * Random() - 1.0;
+      s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+
+    const double factor = std::sqrt(-2.0 * std::log(s) / s);
+    normal = v * factor;
+    hasNormal = true;
+    return u * factor;
+  }
+
+ private:
+  //! The SplitMix64 finalizer, a bijective hash of 64-bit integers.
+  static uint64_t Mix(uint64_t z)
+  {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  //! The key of the stream.
+  uint64_t key;
+  //! The number of random numbers generated so far.
+  uint64_t counter;
+  //! Whether a normal number generated by RandNormal() is waiting.
+  bool hasNormal;
+  //! The waiting normal number, if hasNormal is true.
+  double normal;
+};
+
+} // namespace math
+} // namespace mlpack
+
+#endif
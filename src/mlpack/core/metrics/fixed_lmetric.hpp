@@ -0,0 +1,121 @@
+/**
+ * @file fixed_lmetric.hpp
+ *
+ * An L-metric for points of a dimensionality that is known at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_METRICS_FIXED_LMETRIC_HPP
+#define MLPACK_CORE_METRICS_FIXED_LMETRIC_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * The same metric as LMetric<TPower, TTakeRoot>, for dense points with exactly
+ * FixedDim dimensions.  Because the number of dimensions is a compile-time
+ * constant, the loop over the dimensions is unrolled by the compiler, which
+ * matters for low-dimensional data (such as 2-D geospatial data or 3-D point
+ * clouds), where the loop overhead is a large part of each distance
+ * evaluation.  Use it together with the fixed-dimension trees (for instance
+ * tree::KDTree3D); the points are not checked to have FixedDim dimensions
+ * unless debugging is enabled.
+ *
+ * @code
+ * NeighborSearch<NearestNeighborSort, FixedEuclideanDistance<3>, arma::mat,
+ *     tree::KDTree3D> knn(pointCloud);
+ * @endcode
+ *
+ * @tparam FixedDim Dimensionality of the points.
+ * @tparam TPower Power of the metric.
+ * @tparam TTakeRoot Whether or not the root of the sum is taken.
+ */
+template<size_t FixedDim, int TPower, bool TTakeRoot = true>
+class FixedLMetric
+{
+ public:
+  /***
+   * Default constructor does nothing, but is required to satisfy the Metric
+   * policy.
+   */
+  FixedLMetric() { }
+
+  /**
+   * Computes the distance between two dense points with FixedDim dimensions.
+   *
+   * @param a First vector.
+   * @param b Second vector.
+   * @return Distance between vectors a and b.
+   */
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b)
+  {
+    static_assert(!arma::is_arma_sparse_type<VecTypeA>::value &&
+        !arma::is_arma_sparse_type<VecTypeB>::value, "FixedLMetric can only "
+        "be used with dense vectors");
+    Log::Assert(a.n_elem == FixedDim && b.n_elem == FixedDim);
+
+    typedef typename VecTypeA::elem_type ElemType;
+    ElemType sum = 0;
+    for (size_t i = 0; i < FixedDim; ++i)
+    {
+      const ElemType d = std::abs((ElemType) (a[i] - b[i]));
+      if (TPower == 1)
+        sum += d;
+      else if (TPower == 2)
+        sum += d * d;
+      else
+        sum += std::pow(d, (ElemType) TPower);
+    }
+
+    if (!TTakeRoot || TPower == 1)
+      return sum;
+    else if (TPower == 2)
+      return std::sqrt(sum);
+    else
+      return (ElemType) std::pow((double) sum, 1.0 / (double) TPower);
+  }
+
+  /**
+   * Computes the distance between two points; with so few dimensions, the
+   * bound is not used to stop early, and this is the same as Evaluate().
+   */
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type EvaluateBounded(
+      const VecTypeA& a,
+      const VecTypeB& b,
+      const double /* bound */)
+  {
+    return Evaluate(a, b);
+  }
+
+  //! Serialize the metric (nothing to do).
+  template<typename Archive>
+  void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
+
+  //! The power of the metric.
+  static const int Power = TPower;
+  //! Whether or not the root is taken.
+  static const bool TakeRoot = TTakeRoot;
+  //! The dimensionality of the points.
+  static const size_t Dimensionality = FixedDim;
+};
+
+//! The Euclidean distance for points with FixedDim dimensions.
+template<size_t FixedDim>
+using FixedEuclideanDistance = FixedLMetric<FixedDim, 2, true>;
+
+//! The squared Euclidean distance for points with FixedDim dimensions.
+template<size_t FixedDim>
+using FixedSquaredEuclideanDistance = FixedLMetric<FixedDim, 2, false>;
+
+} // namespace metric
+} // namespace mlpack
+
+#endif
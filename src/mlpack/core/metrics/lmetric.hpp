@@ -70,7 +70,12 @@ class LMetric
   LMetric() { }
 
   /**
-   * Computes the distance between two points.
+   * Computes the distance between two points.  If either vector is sparse, the
+   * distance is computed directly from the nonzero elements, without forming
+   * the difference of the vectors: for two sparse vectors, this takes time
+   * proportional to their numbers of nonzeros.  The sparse vectors must allow
+   * iteration over their nonzero elements (arma::sp_vec, arma::sp_rowvec, or a
+   * row or column of an arma::sp_mat).
    *
    * @tparam VecTypeA Type of first vector (generally arma::vec or
    *      arma::sp_vec).
@@ -83,6 +88,28 @@ class LMetric
   static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
                                                const VecTypeB& b);
 
+  /**
+   * Computes the distance between two points, but stops as soon as the
+   * distance is known to be greater than the given bound.  In that case the
+   * value returned is greater than the bound, but smaller than (or equal to)
+   * the distance; otherwise it is the distance, as given by Evaluate().  This
+   * is useful when only distances below a bound matter, such as when a
+   * candidate neighbor has to beat the k'th best one.  Only dense vectors with
+   * contiguous floating-point elements (arma::vec, arma::fvec, rows of those,
+   * and columns of matrices) stop early; for other vectors this is
+   * Evaluate().
+   *
+   * @param a First vector.
+   * @param b Second vector.
+   * @param bound Distance above which the exact distance is not needed.
+   * @return Distance between vectors a and b, or a value between the bound
+   *     and that distance.
+   */
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type EvaluateBounded(const VecTypeA& a,
+                                                      const VecTypeB& b,
+                                                      const double bound);
+
   //! Serialize the metric (nothing to do).
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
@@ -91,6 +118,125 @@ class LMetric
   static const int Power = TPower;
   //! Whether or not the root is taken.
   static const bool TakeRoot = TTakeRoot;
+
+ private:
+  //! Compute the distance between two dense vectors.
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type DenseEvaluate(const VecTypeA& a,
+                                                    const VecTypeB& b);
+
+  /**
+   * Whether the distance between vectors of the given types is computed with
+   * ContiguousSum(): both must have contiguous elements of the same
+   * floating-point type.
+   */
+  template<typename VecTypeA, typename VecTypeB>
+  using UseContiguousSum = std::integral_constant<bool,
+      IsContiguousVector<VecTypeA>::value &&
+      IsContiguousVector<VecTypeB>::value &&
+      std::is_floating_point<typename VecTypeA::elem_type>::value &&
+      std::is_same<typename VecTypeA::elem_type,
+                   typename VecTypeB::elem_type>::value>;
+
+  //! Compute the distance between two sparse vectors.
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type SparseEvaluate(const VecTypeA& a,
+                                                     const VecTypeB& b);
+
+  //! Compute the distance between a dense vector and a sparse vector.
+  template<typename DenseVecType, typename SparseVecType>
+  static typename DenseVecType::elem_type MixedEvaluate(
+      const DenseVecType& a,
+      const SparseVecType& b);
+
+  //! Select the computation depending on which vectors are sparse.
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b,
+                                               std::false_type /* sparseA */,
+                                               std::false_type /* sparseB */)
+  {
+    return Evaluate(a, b, UseContiguousSum<VecTypeA, VecTypeB>());
+  }
+
+  //! Compute the distance between two contiguous dense vectors.
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b,
+                                               std::true_type /* contiguous */)
+  {
+    // Let Armadillo report vectors of different sizes.
+    if (a.n_elem != b.n_elem)
+      return DenseEvaluate(a, b);
+
+    return Finish(ContiguousSum(a.colptr(0), b.colptr(0), a.n_elem,
+        std::numeric_limits<typename VecTypeA::elem_type>::infinity()));
+  }
+
+  //! Compute the distance between two other dense vectors.
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b,
+                                               std::false_type /* contiguous */)
+  { return DenseEvaluate(a, b); }
+
+  //! Compute the distance between two contiguous dense vectors, stopping
+  //! early above the bound.
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type EvaluateBounded(
+      const VecTypeA& a,
+      const VecTypeB& b,
+      const double bound,
+      std::true_type /* contiguous */);
+
+  //! Compute the distance between two other vectors, without stopping early.
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type EvaluateBounded(
+      const VecTypeA& a,
+      const VecTypeB& b,
+      const double /* bound */,
+      std::false_type /* contiguous */)
+  { return Evaluate(a, b); }
+
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b,
+                                               std::true_type /* sparseA */,
+                                               std::true_type /* sparseB */)
+  { return SparseEvaluate(a, b); }
+
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b,
+                                               std::false_type /* sparseA */,
+                                               std::true_type /* sparseB */)
+  { return MixedEvaluate(a, b); }
+
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b,
+                                               std::true_type /* sparseA */,
+                                               std::false_type /* sparseB */)
+  { return MixedEvaluate(b, a); }
+
+  //! Add the term of one coordinate, whose difference is d, to the sum.
+  template<typename ElemType>
+  static void Accumulate(ElemType& sum, const ElemType d);
+
+  //! Turn the sum of the terms of all coordinates into the distance.
+  template<typename ElemType>
+  static ElemType Finish(const ElemType sum);
+
+  /**
+   * Sum the terms of the coordinates of two arrays, in several independent
+   * partial sums so that the loop can be vectorized.  Every few coordinates,
+   * the sum is compared to sumBound, and returned as soon as it is greater.
+   */
+  template<typename ElemType>
+  static ElemType ContiguousSum(const ElemType* a,
+                                const ElemType* b,
+                                const size_t n,
+                                const ElemType sumBound);
 };
 
 // Convenience typedefs.
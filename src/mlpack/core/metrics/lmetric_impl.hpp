@@ -18,12 +18,206 @@
 namespace mlpack {
 namespace metric {
 
-// Unspecialized implementation.  This should almost never be used...
+// Dispatch to the dense, sparse, or mixed computation.
 template<int Power, bool TakeRoot>
 template<typename VecTypeA, typename VecTypeB>
 typename VecTypeA::elem_type LMetric<Power, TakeRoot>::Evaluate(
     const VecTypeA& a,
     const VecTypeB& b)
+{
+  typedef std::integral_constant<bool,
+      arma::is_arma_sparse_type<VecTypeA>::value> SparseA;
+  typedef std::integral_constant<bool,
+      arma::is_arma_sparse_type<VecTypeB>::value> SparseB;
+
+  return Evaluate(a, b, SparseA(), SparseB());
+}
+
+// Stop early only for contiguous dense vectors.
+template<int Power, bool TakeRoot>
+template<typename VecTypeA, typename VecTypeB>
+typename VecTypeA::elem_type LMetric<Power, TakeRoot>::EvaluateBounded(
+    const VecTypeA& a,
+    const VecTypeB& b,
+    const double bound)
+{
+  return EvaluateBounded(a, b, bound, UseContiguousSum<VecTypeA, VecTypeB>());
+}
+
+template<int Power, bool TakeRoot>
+template<typename VecTypeA, typename VecTypeB>
+typename VecTypeA::elem_type LMetric<Power, TakeRoot>::EvaluateBounded(
+    const VecTypeA& a,
+    const VecTypeB& b,
+    const double bound,
+    std::true_type /* contiguous */)
+{
+  typedef typename VecTypeA::elem_type ElemType;
+
+  // Let Armadillo report vectors of different sizes.
+  if (a.n_elem != b.n_elem)
+    return DenseEvaluate(a, b);
+
+  // Bound the sum of the terms instead of the distance.
+  ElemType sumBound;
+  if (!TakeRoot || Power == 1 || Power == INT_MAX)
+    sumBound = (ElemType) bound;
+  else if (Power == 2)
+    sumBound = (ElemType) (bound * bound);
+  else
+    sumBound = (ElemType) std::pow(bound, Power);
+
+  return Finish(ContiguousSum(a.colptr(0), b.colptr(0), a.n_elem, sumBound));
+}
+
+template<int Power, bool TakeRoot>
+template<typename ElemType>
+inline void LMetric<Power, TakeRoot>::Accumulate(ElemType& sum,
+                                                 const ElemType d)
+{
+  // The compiler should remove all but one of these branches.
+  if (Power == INT_MAX)
+    sum = std::max(sum, (ElemType) std::abs(d));
+  else if (Power == 1)
+    sum += std::abs(d);
+  else if (Power == 2)
+    sum += d * d;
+  else
+    sum += std::pow(std::abs(d), Power);
+}
+
+template<int Power, bool TakeRoot>
+template<typename ElemType>
+inline ElemType LMetric<Power, TakeRoot>::Finish(const ElemType sum)
+{
+  if (!TakeRoot || Power == 1 || Power == INT_MAX)
+    return sum;
+  else if (Power == 2)
+    return std::sqrt(sum);
+  else
+    return std::pow(sum, 1.0 / Power);
+}
+
+template<int Power, bool TakeRoot>
+template<typename ElemType>
+ElemType LMetric<Power, TakeRoot>::ContiguousSum(const ElemType* a,
+                                                 const ElemType* b,
+                                                 const size_t n,
+                                                 const ElemType sumBound)
+{
+  // Four partial sums of blocks of 16 coordinates; after each block, compare
+  // with the bound.  The comparison is rare enough not to slow the loop.
+  const size_t blockSize = 16;
+  ElemType sums[4] = { 0, 0, 0, 0 };
+  size_t i = 0;
+  while (i + blockSize <= n)
+  {
+    for (size_t j = 0; j < blockSize; j += 4)
+    {
+      Accumulate(sums[0], (ElemType) (a[i + j] - b[i + j]));
+      Accumulate(sums[1], (ElemType) (a[i + j + 1] - b[i + j + 1]));
+      Accumulate(sums[2], (ElemType) (a[i + j + 2] - b[i + j + 2]));
+      Accumulate(sums[3], (ElemType) (a[i + j + 3] - b[i + j + 3]));
+    }
+    i += blockSize;
+
+    const ElemType sum = (Power == INT_MAX) ?
+        std::max(std::max(sums[0], sums[1]), std::max(sums[2], sums[3])) :
+        (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    if (sum > sumBound)
+      return sum;
+  }
+
+  for (; i < n; ++i)
+    Accumulate(sums[0], (ElemType) (a[i] - b[i]));
+
+  if (Power == INT_MAX)
+    return std::max(std::max(sums[0], sums[1]), std::max(sums[2], sums[3]));
+  else
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+// Merge the nonzero elements of both vectors.  For row and column vectors, the
+// sum of the row and column of an element is its index.
+template<int Power, bool TakeRoot>
+template<typename VecTypeA, typename VecTypeB>
+typename VecTypeA::elem_type LMetric<Power, TakeRoot>::SparseEvaluate(
+    const VecTypeA& a,
+    const VecTypeB& b)
+{
+  typedef typename VecTypeA::elem_type ElemType;
+
+  typename VecTypeA::const_iterator itA = a.begin();
+  typename VecTypeB::const_iterator itB = b.begin();
+  const typename VecTypeA::const_iterator endA = a.end();
+  const typename VecTypeB::const_iterator endB = b.end();
+
+  ElemType sum = 0;
+  while (itA != endA && itB != endB)
+  {
+    const size_t indexA = itA.row() + itA.col();
+    const size_t indexB = itB.row() + itB.col();
+    if (indexA < indexB)
+    {
+      Accumulate(sum, (ElemType) (*itA));
+      ++itA;
+    }
+    else if (indexB < indexA)
+    {
+      Accumulate(sum, (ElemType) (-(*itB)));
+      ++itB;
+    }
+    else
+    {
+      Accumulate(sum, (ElemType) ((*itA) - (*itB)));
+      ++itA;
+      ++itB;
+    }
+  }
+
+  for (; itA != endA; ++itA)
+    Accumulate(sum, (ElemType) (*itA));
+  for (; itB != endB; ++itB)
+    Accumulate(sum, (ElemType) (-(*itB)));
+
+  return Finish(sum);
+}
+
+// Walk through the dense vector once, and subtract the nonzero elements of the
+// sparse vector where they are.
+template<int Power, bool TakeRoot>
+template<typename DenseVecType, typename SparseVecType>
+typename DenseVecType::elem_type LMetric<Power, TakeRoot>::MixedEvaluate(
+    const DenseVecType& a,
+    const SparseVecType& b)
+{
+  typedef typename DenseVecType::elem_type ElemType;
+
+  ElemType sum = 0;
+  size_t i = 0;
+  const typename SparseVecType::const_iterator endB = b.end();
+  for (typename SparseVecType::const_iterator it = b.begin(); it != endB; ++it)
+  {
+    const size_t index = it.row() + it.col();
+    for (; i < index; ++i)
+      Accumulate(sum, (ElemType) a[i]);
+
+    Accumulate(sum, (ElemType) (a[i] - (*it)));
+    ++i;
+  }
+
+  for (; i < a.n_elem; ++i)
+    Accumulate(sum, (ElemType) a[i]);
+
+  return Finish(sum);
+}
+
+// Unspecialized implementation.  This should almost never be used...
+template<int Power, bool TakeRoot>
+template<typename VecTypeA, typename VecTypeB>
+typename VecTypeA::elem_type LMetric<Power, TakeRoot>::DenseEvaluate(
+    const VecTypeA& a,
+    const VecTypeB& b)
 {
   typename VecTypeA::elem_type sum = 0;
   for (size_t i = 0; i < a.n_elem; i++)
@@ -38,7 +232,7 @@ typename VecTypeA::elem_type LMetric<Power, TakeRoot>::Evaluate(
 // L1-metric specializations; the root doesn't matter.
 template<>
 template<typename VecTypeA, typename VecTypeB>
-typename VecTypeA::elem_type LMetric<1, true>::Evaluate(
+typename VecTypeA::elem_type LMetric<1, true>::DenseEvaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
@@ -47,7 +241,7 @@ typename VecTypeA::elem_type LMetric<1, true>::Evaluate(
 
 template<>
 template<typename VecTypeA, typename VecTypeB>
-typename VecTypeA::elem_type LMetric<1, false>::Evaluate(
+typename VecTypeA::elem_type LMetric<1, false>::DenseEvaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
@@ -57,7 +251,7 @@ typename VecTypeA::elem_type LMetric<1, false>::Evaluate(
 // L2-metric specializations.
 template<>
 template<typename VecTypeA, typename VecTypeB>
-typename VecTypeA::elem_type LMetric<2, true>::Evaluate(
+typename VecTypeA::elem_type LMetric<2, true>::DenseEvaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
@@ -66,7 +260,7 @@ typename VecTypeA::elem_type LMetric<2, true>::Evaluate(
 
 template<>
 template<typename VecTypeA, typename VecTypeB>
-typename VecTypeA::elem_type LMetric<2, false>::Evaluate(
+typename VecTypeA::elem_type LMetric<2, false>::DenseEvaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
@@ -76,7 +270,7 @@ typename VecTypeA::elem_type LMetric<2, false>::Evaluate(
 // L3-metric specialization (not very likely to be used, but just in case).
 template<>
 template<typename VecTypeA, typename VecTypeB>
-typename VecTypeA::elem_type LMetric<3, true>::Evaluate(
+typename VecTypeA::elem_type LMetric<3, true>::DenseEvaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
@@ -89,7 +283,7 @@ typename VecTypeA::elem_type LMetric<3, true>::Evaluate(
 
 template<>
 template<typename VecTypeA, typename VecTypeB>
-typename VecTypeA::elem_type LMetric<3, false>::Evaluate(
+typename VecTypeA::elem_type LMetric<3, false>::DenseEvaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
@@ -99,7 +293,7 @@ typename VecTypeA::elem_type LMetric<3, false>::Evaluate(
 // L-infinity (Chebyshev distance) specialization
 template<>
 template<typename VecTypeA, typename VecTypeB>
-typename VecTypeA::elem_type LMetric<INT_MAX, false>::Evaluate(
+typename VecTypeA::elem_type LMetric<INT_MAX, false>::DenseEvaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
@@ -102,6 +102,25 @@ class MahalanobisDistance
    */
   arma::mat& Covariance() { return covariance; }
 
+  /**
+   * Compute a matrix R such that the covariance matrix is R^T R, so that the
+   * Mahalanobis distance between two points a and b is the Euclidean distance
+   * between R a and R b.  R is the Cholesky factor of the covariance matrix if
+   * it is positive definite; otherwise it is taken from the eigendecomposition
+   * of the covariance matrix, with negative eigenvalues (which can only come
+   * from rounding errors, if it is a valid covariance) treated as zero.  Only
+   * the symmetric part of the covariance matrix is used, since it is the only
+   * part that contributes to the distance.
+   *
+   * Points that are transformed once by R can be searched with the Euclidean
+   * distance and any tree type, without the O(d^2) quadratic form of each
+   * evaluation; see neighbor::WhitenedNeighborSearch and
+   * range::WhitenedRangeSearch.
+   *
+   * @return The transformation matrix R.
+   */
+  arma::mat Transformation() const;
+
   //! Serialize the Mahalanobis distance.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
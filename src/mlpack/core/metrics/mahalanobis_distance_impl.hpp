@@ -47,6 +47,39 @@ double MahalanobisDistance<true>::Evaluate(const VecTypeA& a,
   return sqrt(out[0]);
 }
 
+template<bool TakeRoot>
+arma::mat MahalanobisDistance<TakeRoot>::Transformation() const
+{
+  if (covariance.n_rows != covariance.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "MahalanobisDistance::Transformation(): the covariance matrix is "
+        << covariance.n_rows << "x" << covariance.n_cols << ", but it must be "
+        << "square";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const arma::mat symmetric = 0.5 * (covariance + trans(covariance));
+  arma::mat transformation;
+  if (covariance.n_elem == 0 || arma::chol(transformation, symmetric))
+    return transformation;
+
+  // The covariance matrix is not positive definite, so build the factor from
+  // its eigendecomposition instead.
+  arma::vec eigenvalues;
+  arma::mat eigenvectors;
+  if (!arma::eig_sym(eigenvalues, eigenvectors, symmetric))
+  {
+    throw std::runtime_error("MahalanobisDistance::Transformation(): "
+        "eigendecomposition of the covariance matrix failed");
+  }
+
+  for (size_t i = 0; i < eigenvalues.n_elem; ++i)
+    eigenvalues[i] = (eigenvalues[i] > 0.0) ? std::sqrt(eigenvalues[i]) : 0.0;
+
+  return arma::diagmat(eigenvalues) * trans(eigenvectors);
+}
+
 // Serialize the Mahalanobis distance.
 template<bool TakeRoot>
 template<typename Archive>
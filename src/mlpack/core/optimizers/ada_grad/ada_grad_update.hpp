@@ -84,6 +84,29 @@ class AdaGradUpdate
     iterate -= (stepSize * gradient) / (arma::sqrt(squaredGradient) + epsilon);
   }
 
+  /**
+   * Update step for SGD with a sparse gradient.  Only the nonzero coordinates
+   * of the gradient are touched, which gives the same result as the dense
+   * update.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The sparse gradient matrix.
+   */
+  void Update(arma::mat& iterate,
+              const double stepSize,
+              const arma::sp_mat& gradient)
+  {
+    for (arma::sp_mat::const_iterator it = gradient.begin();
+        it != gradient.end(); ++it)
+    {
+      double& squared = squaredGradient(it.row(), it.col());
+      squared += (*it) * (*it);
+      iterate(it.row(), it.col()) -= stepSize * (*it) /
+          (std::sqrt(squared) + epsilon);
+    }
+  }
+
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
   //! Modify the value used to initialise the squared gradient parameter.
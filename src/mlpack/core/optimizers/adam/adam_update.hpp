@@ -72,6 +72,7 @@ class AdamUpdate
   {
     m = arma::zeros<arma::mat>(rows, cols);
     v = arma::zeros<arma::mat>(rows, cols);
+    lastUpdate.reset();
   }
 
   /**
@@ -87,6 +88,8 @@ class AdamUpdate
   {
     // Increment the iteration counter variable.
     ++iteration;
+    if (!lastUpdate.is_empty())
+      lastUpdate.fill(iteration);
 
     // And update the iterate.
     m *= beta1;
@@ -107,6 +110,55 @@ class AdamUpdate
         m / (arma::sqrt(v) + epsilon);
   }
 
+  /**
+   * Lazy update step for Adam with a sparse gradient.  Only the nonzero
+   * coordinates of the gradient are touched: their moments first catch up with
+   * the decay of the iterations in which they were not touched, and then take
+   * the gradient into account as usual.  Unlike in the dense update, the
+   * coordinates that are not touched do not move, so the cost of the step only
+   * depends on the number of nonzeros of the gradient.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The sparse gradient matrix.
+   */
+  void Update(arma::mat& iterate,
+              const double stepSize,
+              const arma::sp_mat& gradient)
+  {
+    // Remember when the moments of each coordinate last decayed.
+    if (lastUpdate.is_empty())
+    {
+      lastUpdate.set_size(arma::size(m));
+      lastUpdate.fill(iteration);
+    }
+
+    ++iteration;
+
+    const double biasCorrection1 = 1.0 - std::pow(beta1, iteration);
+    const double biasCorrection2 = 1.0 - std::pow(beta2, iteration);
+    const double step = stepSize * std::sqrt(biasCorrection2) /
+        biasCorrection1;
+
+    for (arma::sp_mat::const_iterator it = gradient.begin();
+        it != gradient.end(); ++it)
+    {
+      double& first = m(it.row(), it.col());
+      double& second = v(it.row(), it.col());
+      double& last = lastUpdate(it.row(), it.col());
+
+      const double skipped = iteration - last;
+      first *= std::pow(beta1, skipped);
+      first += (1 - beta1) * (*it);
+      second *= std::pow(beta2, skipped);
+      second += (1 - beta2) * (*it) * (*it);
+      last = iteration;
+
+      iterate(it.row(), it.col()) -= step * first / (std::sqrt(second) +
+          epsilon);
+    }
+  }
+
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
   //! Modify the value used to initialise the squared gradient parameter.
@@ -140,6 +192,10 @@ class AdamUpdate
 
   // The number of iterations.
   double iteration;
+
+  // The iteration at which the moments of each coordinate last decayed; only
+  // used for sparse gradients.
+  arma::mat lastUpdate;
 };
 
 } // namespace optimization
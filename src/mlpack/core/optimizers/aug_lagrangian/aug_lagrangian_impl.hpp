@@ -92,7 +92,8 @@ bool AugLagrangian::Optimize(
 
     // Check if we are done with the entire optimization (the threshold we are
     // comparing with is arbitrary).
-    if (std::abs(lastObjective - function.Evaluate(coordinates)) < 1e-10 &&
+    const double objective = function.Evaluate(coordinates);
+    if (std::abs(lastObjective - objective) < 1e-10 &&
         augfunc.Sigma() > 500000)
     {
       lambda = std::move(augfunc.Lambda());
@@ -100,29 +101,26 @@ bool AugLagrangian::Optimize(
       return true;
     }
 
-    lastObjective = function.Evaluate(coordinates);
+    lastObjective = objective;
 
     // Assuming that the optimization has converged to a new set of coordinates,
     // we now update either lambda or sigma.  We update sigma if the penalty
     // term is too high, and we update lambda otherwise.
 
-    // First, calculate the current penalty.
-    double penalty = 0;
+    // First, calculate the current penalty.  The constraints are kept for the
+    // update of lambda.
+    arma::vec constraints(function.NumConstraints());
     for (size_t i = 0; i < function.NumConstraints(); i++)
-    {
-      penalty += std::pow(function.EvaluateConstraint(i, coordinates), 2);
-    }
+      constraints[i] = function.EvaluateConstraint(i, coordinates);
+    const double penalty = arma::dot(constraints, constraints);
 
     Log::Info << "Penalty is " << penalty << " (threshold "
         << penaltyThreshold << ")." << std::endl;
 
     if (penalty < penaltyThreshold) // We update lambda.
     {
-      // We use the update: lambda_{k + 1} = lambda_k - sigma * c(coordinates),
-      // but we have to write a loop to do this for each constraint.
-      for (size_t i = 0; i < function.NumConstraints(); i++)
-        augfunc.Lambda()[i] -= augfunc.Sigma() *
-            function.EvaluateConstraint(i, coordinates);
+      // We use the update: lambda_{k + 1} = lambda_k - sigma * c(coordinates).
+      augfunc.Lambda() -= augfunc.Sigma() * constraints;
 
       // We also update the penalty threshold to be a factor of the current
       // penalty.  TODO: this factor should be a parameter (from CLI).  The
@@ -17,6 +17,7 @@
 #define MLPACK_CORE_OPTIMIZERS_CNE_CNE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -70,6 +71,14 @@ namespace optimization {
  * This class must implement the following function:
  *
  *   double Evaluate(const arma::mat& iterate);
+ *
+ * The crossover and the mutation of the candidates are done in parallel with
+ * OpenMP.  With more than one thread, the candidates are evaluated in parallel
+ * too; Evaluate() must then be safe to call from several threads at once, and
+ * must only depend on the given parameters.  This is the case for example for
+ * LogisticRegressionFunction, but not for FFN, which evaluates the parameters
+ * stored in the network; such functions are evaluated one candidate after the
+ * other, with the candidate stored in the given iterate.
  */
 class CNE
 {
@@ -94,6 +103,9 @@ class CNE
    * @param objectiveChange Minimum change in best fitness values between two
    *     consecutive generations should be greater than threshold. If set to
    *     negative value, objectiveChange is not considered.
+   * @param numThreads Number of threads used to evaluate the candidates (0
+   *     means the OpenMP default).  If it is not 1, Evaluate() has to be
+   *     thread-safe; see above.
    */
   CNE(const size_t populationSize = 500,
       const size_t maxGenerations = 5000,
@@ -101,7 +113,8 @@ class CNE
       const double mutationSize = 0.02,
       const double selectPercent = 0.2,
       const double tolerance = 1e-5,
-      const double objectiveChange = 1e-5);
+      const double objectiveChange = 1e-5,
+      const size_t numThreads = 1);
 
   /**
    * Optimize the given function using CNE. The given
@@ -151,12 +164,23 @@ class CNE
   //! Modify the termination criteria of change in fitness value.
   double& ObjectiveChange() { return objectiveChange; }
 
+  //! Get the number of threads used to evaluate the candidates.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used to evaluate the candidates.
+  size_t& NumThreads() { return numThreads; }
+
  private:
   //! Reproduce candidates to create the next generation.
   void Reproduce();
 
-  //! Modify weights with some noise for the evolution of next generation.
-  void Mutate();
+  /**
+   * Modify the weights of the given candidate with some noise for the
+   * evolution of the next generation.
+   *
+   * @param candidate The candidate to mutate.
+   * @param generator The random number generator to use.
+   */
+  void Mutate(arma::mat& candidate, std::mt19937& generator);
 
   /**
    * Crossover parents and create new childs. Two parents create two new childs.
@@ -169,11 +193,13 @@ class CNE
    * @param dropout2 The place to delete the candidate of the present
    *                 generation and place a child over there for the
    *                 next generation.
+   * @param generator The random number generator to use.
    */
   void Crossover(const size_t mom,
                  const size_t dad,
                  const size_t dropout1,
-                 const size_t dropout2);
+                 const size_t dropout2,
+                 std::mt19937& generator);
 
   //! Population matrix. Each column is a candidate.
   arma::cube population;
@@ -210,6 +236,9 @@ class CNE
 
   //! Store the number of elements in a cube slice or a matrix column.
   size_t elements;
+
+  //! The number of threads used to evaluate the candidates.
+  size_t numThreads;
 };
 
 } // namespace optimization
@@ -27,7 +27,8 @@ CNE::CNE(const size_t populationSize,
          const double mutationSize,
          const double selectPercent,
          const double tolerance,
-         const double objectiveChange) :
+         const double objectiveChange,
+         const size_t numThreads) :
     populationSize(populationSize),
     maxGenerations(maxGenerations),
     mutationProb(mutationProb),
@@ -36,7 +37,8 @@ CNE::CNE(const size_t populationSize,
     tolerance(tolerance),
     objectiveChange(objectiveChange),
     numElite(0),
-    elements(0)
+    elements(0),
+    numThreads(numThreads)
 { /* Nothing to do here. */ }
 
 //! Optimize the function.
@@ -90,13 +92,25 @@ double CNE::Optimize(DecomposableFunctionType& function, arma::mat& iterate)
   for (size_t gen = 1; gen <= maxGenerations; gen++)
   {
     // Calculating fitness values of all candidates.
-    for (size_t i = 0; i < populationSize; i++)
+    if (numThreads == 1)
     {
-       // Select a candidate and insert the parameters in the function.
-       iterate = population.slice(i);
+      for (size_t i = 0; i < populationSize; i++)
+      {
+         // Select a candidate and insert the parameters in the function.
+         iterate = population.slice(i);
 
-       // Find fitness of candidate.
-       fitnessValues[i] = function.Evaluate(iterate);
+         // Find fitness of candidate.
+         fitnessValues[i] = function.Evaluate(iterate);
+      }
+    }
+    else
+    {
+      const size_t threads = ParallelThreads(numThreads);
+
+      // Each candidate is evaluated directly; the function is thread-safe.
+      #pragma omp parallel for num_threads(threads) schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) populationSize; i++)
+        fitnessValues[i] = function.Evaluate(population.slice(i));
     }
 
     Log::Info << "Generation number: " << gen << " best fitness = "
@@ -138,13 +152,24 @@ void CNE::Reproduce()
   // Sort fitness values. Smaller fitness value means better performance.
   index = arma::sort_index(fitnessValues);
 
+  // The parents of each pair of children, and a seed for each pair and each
+  // mutated candidate.  They are all drawn here from the global generator, so
+  // that the result does not depend on the scheduling of the threads.  Each
+  // task has its own stream rather than each thread, since a thread's stream
+  // would give different children for a different number of threads.
+  const size_t numPairs = (populationSize - numElite) / 2;
+  arma::uvec moms(numPairs), dads(numPairs);
+  std::vector<std::mt19937::result_type> seeds(numPairs + populationSize);
+  for (size_t i = 0; i < seeds.size(); ++i)
+    seeds[i] = mlpack::math::randGen();
+
   // First parent.
   size_t mom;
 
   // Second parent.
   size_t dad;
 
-  for (size_t i = numElite; i < populationSize - 1; i++)
+  for (size_t i = numElite; i < populationSize - 1; i += 2)
   {
     // Select 2 different parents from elite group randomly [0, numElite).
     mom = mlpack::math::RandInt(0, numElite);
@@ -163,34 +188,51 @@ void CNE::Reproduce()
       }
     }
 
-    // Parents generate 2 children replacing the dropped-out candidates.
-    // Also finding the index of these candidates in the population matrix.
-    Crossover(index[mom], index[dad], index[i], index[i + 1]);
+    moms[(i - numElite) / 2] = mom;
+    dads[(i - numElite) / 2] = dad;
+  }
+
+  // Parents generate 2 children replacing the dropped-out candidates.  The
+  // parents are elite candidates, which are not replaced, so the pairs can be
+  // created in parallel.  This does not call the function, so it may use all
+  // the threads that are allowed.
+  const size_t threads = ParallelThreads();
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t p = 0; p < (omp_size_t) numPairs; ++p)
+  {
+    const size_t i = numElite + 2 * p;
+    std::mt19937 generator(seeds[p]);
+    Crossover(index[moms[p]], index[dads[p]], index[i], index[i + 1],
+        generator);
   }
 
   // Mutating the weights with small noise values.
   // This is done to bring change in the next generation.
-  Mutate();
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t i = 1; i < (omp_size_t) populationSize; ++i)
+  {
+    std::mt19937 generator(seeds[numPairs + i]);
+    Mutate(population.slice(index(i)), generator);
+  }
 }
 
 //! Crossover parents to create new children.
 void CNE::Crossover(const size_t mom,
                     const size_t dad,
                     const size_t child1,
-                    const size_t child2)
+                    const size_t child2,
+                    std::mt19937& generator)
 {
   // Replace the candidates with parents at their place.
   population.slice(child1) = population.slice(mom);
   population.slice(child2) = population.slice(dad);
 
-  // Preallocate random selection vector (values between 0 and 1).
-  arma::vec selection = arma::randu(elements);
-
   // Randomly alter mom and dad genome weights to get two different children.
+  std::uniform_real_distribution<> selection;
   for (size_t i = 0; i < elements; i++)
   {
     // Using it to alter the weights of the children.
-    if (selection(i) > 0.5)
+    if (selection(generator) > 0.5)
     {
       population.slice(child1)(i) = population.slice(mom)(i);
       population.slice(child2)(i) = population.slice(dad)(i);
@@ -204,15 +246,15 @@ void CNE::Crossover(const size_t mom,
 }
 
 //! Modify weights with some noise for the evolution of next generation.
-void CNE::Mutate()
+void CNE::Mutate(arma::mat& candidate, std::mt19937& generator)
 {
-  // Mutate the whole matrix with the given rate and probability.
-  // The best candidate is not altered.
-  for (size_t i = 1; i < populationSize; i++)
+  // Mutate the weights with the given rate and probability.
+  std::uniform_real_distribution<> mutate;
+  std::normal_distribution<> noise(0.0, mutationSize);
+  for (size_t i = 0; i < candidate.n_elem; ++i)
   {
-    population.slice(index(i)) += (arma::randu(
-        population.n_rows, population.n_cols) < mutationProb) %
-        (mutationSize * arma::randn(population.n_rows, population.n_cols));
+    if (mutate(generator) < mutationProb)
+      candidate[i] += noise(generator);
   }
 }
 
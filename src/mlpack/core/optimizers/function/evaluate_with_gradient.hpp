@@ -0,0 +1,282 @@
+/**
+ * @file evaluate_with_gradient.hpp
+ *
+ * Evaluation of a function and its gradient at the same coordinates.  Many
+ * functions share most of the work between the objective and the gradient; if
+ * the function provides EvaluateWithGradient(), which computes both in one go,
+ * it is used; otherwise Evaluate() and Gradient() are called one after the
+ * other.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_FUNCTION_EVALUATE_WITH_GRADIENT_HPP
+#define MLPACK_CORE_OPTIMIZERS_FUNCTION_EVALUATE_WITH_GRADIENT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/batch_function.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(EvaluateWithGradient, HasEvaluateWithGradientCheck);
+HAS_MEM_FUNC(Gradient, HasSparseGradientCheck);
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateWithGradient(const arma::mat& coordinates,
+ *                             arma::mat& gradient).
+ */
+template<typename FunctionType>
+struct HasEvaluateWithGradient
+{
+  static const bool value =
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&, arma::mat&)>::value ||
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&, arma::mat&) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateWithGradient(const MatType& coordinates, const size_t i,
+ *                             MatType& gradient).
+ */
+template<typename FunctionType, typename MatType = arma::mat>
+struct HasSeparableEvaluateWithGradient
+{
+  static const bool value =
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                MatType&)>::value ||
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const MatType&,
+                                const size_t,
+                                MatType&) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateWithGradient(const arma::mat& coordinates, const size_t begin,
+ *                             arma::mat& gradient, const size_t batchSize).
+ */
+template<typename FunctionType>
+struct HasBatchEvaluateWithGradient
+{
+  static const bool value =
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&,
+                                const size_t,
+                                arma::mat&,
+                                const size_t)>::value ||
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&,
+                                const size_t,
+                                arma::mat&,
+                                const size_t) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * void Gradient(const arma::mat& coordinates, const size_t i,
+ *               arma::sp_mat& gradient).
+ */
+template<typename FunctionType>
+struct HasSparseGradient
+{
+  static const bool value =
+    HasSparseGradientCheck<FunctionType,
+        void(FunctionType::*)(const arma::mat&,
+                              const size_t,
+                              arma::sp_mat&)>::value ||
+    HasSparseGradientCheck<FunctionType,
+        void(FunctionType::*)(const arma::mat&,
+                              const size_t,
+                              arma::sp_mat&) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double EvaluateWithGradient(const arma::mat& coordinates, const size_t i,
+ *                             arma::sp_mat& gradient).
+ */
+template<typename FunctionType>
+struct HasSparseEvaluateWithGradient
+{
+  static const bool value =
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&,
+                                const size_t,
+                                arma::sp_mat&)>::value ||
+    HasEvaluateWithGradientCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&,
+                                const size_t,
+                                arma::sp_mat&) const>::value;
+};
+
+//! Evaluate the function and store its gradient in the given matrix, with
+//! EvaluateWithGradient().
+template<typename FunctionType>
+double EvaluateGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    arma::mat& gradient,
+    const typename std::enable_if_t<
+        HasEvaluateWithGradient<FunctionType>::value>* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, gradient);
+}
+
+//! Evaluate the function and store its gradient in the given matrix, with
+//! Evaluate() and Gradient().
+template<typename FunctionType>
+double EvaluateGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    arma::mat& gradient,
+    const typename std::enable_if_t<
+        !HasEvaluateWithGradient<FunctionType>::value>* = 0)
+{
+  const double objective = function.Evaluate(coordinates);
+  function.Gradient(coordinates, gradient);
+  return objective;
+}
+
+//! Evaluate the separable function i and store its gradient in the given
+//! matrix, with EvaluateWithGradient().  The coordinates may have any element
+//! type (e.g. arma::fmat for a network trained in single precision).
+template<typename FunctionType, typename eT>
+double EvaluateGradient(
+    FunctionType& function,
+    const arma::Mat<eT>& coordinates,
+    const size_t i,
+    arma::Mat<eT>& gradient,
+    const typename std::enable_if_t<HasSeparableEvaluateWithGradient<
+        FunctionType, arma::Mat<eT> >::value>* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, i, gradient);
+}
+
+//! Evaluate the separable function i and store its gradient in the given
+//! matrix, with Evaluate() and Gradient().
+template<typename FunctionType, typename eT>
+double EvaluateGradient(
+    FunctionType& function,
+    const arma::Mat<eT>& coordinates,
+    const size_t i,
+    arma::Mat<eT>& gradient,
+    const typename std::enable_if_t<!HasSeparableEvaluateWithGradient<
+        FunctionType, arma::Mat<eT> >::value>* = 0)
+{
+  const double objective = function.Evaluate(coordinates, i);
+  function.Gradient(coordinates, i, gradient);
+  return objective;
+}
+
+//! Evaluate the separable function i and store its sparse gradient in the
+//! given matrix, with EvaluateWithGradient().
+template<typename FunctionType>
+double EvaluateGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t i,
+    arma::sp_mat& gradient,
+    const typename std::enable_if_t<
+        HasSparseEvaluateWithGradient<FunctionType>::value>* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, i, gradient);
+}
+
+//! Evaluate the separable function i and store its sparse gradient in the
+//! given matrix, with Evaluate() and Gradient().
+template<typename FunctionType>
+double EvaluateGradient(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t i,
+    arma::sp_mat& gradient,
+    const typename std::enable_if_t<
+        !HasSparseEvaluateWithGradient<FunctionType>::value>* = 0)
+{
+  const double objective = function.Evaluate(coordinates, i);
+  function.Gradient(coordinates, i, gradient);
+  return objective;
+}
+
+//! Evaluate the separable functions [begin, begin + batchSize) and store the
+//! sum of their gradients in the given matrix, with the batch overload of
+//! EvaluateWithGradient().
+template<typename FunctionType>
+double EvaluateGradientBatch(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        HasBatchEvaluateWithGradient<FunctionType>::value>* = 0)
+{
+  return function.EvaluateWithGradient(coordinates, begin, gradient,
+      batchSize);
+}
+
+//! Evaluate the separable functions [begin, begin + batchSize) and store the
+//! sum of their gradients in the given matrix, one function at a time with
+//! EvaluateWithGradient().  This is used if the function has no batch
+//! overloads at all.
+template<typename FunctionType>
+double EvaluateGradientBatch(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchEvaluateWithGradient<FunctionType>::value &&
+        HasSeparableEvaluateWithGradient<FunctionType>::value &&
+        !HasBatchEvaluate<FunctionType>::value &&
+        !HasBatchGradient<FunctionType>::value>* = 0)
+{
+  double objective = function.EvaluateWithGradient(coordinates, begin,
+      gradient);
+
+  arma::mat funcGradient;
+  for (size_t i = begin + 1; i < begin + batchSize; ++i)
+  {
+    objective += function.EvaluateWithGradient(coordinates, i, funcGradient);
+    gradient += funcGradient;
+  }
+
+  return objective;
+}
+
+//! Evaluate the separable functions [begin, begin + batchSize) and store the
+//! sum of their gradients in the given matrix, with EvaluateBatch() and
+//! GradientBatch().
+template<typename FunctionType>
+double EvaluateGradientBatch(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchEvaluateWithGradient<FunctionType>::value &&
+        (!HasSeparableEvaluateWithGradient<FunctionType>::value ||
+         HasBatchEvaluate<FunctionType>::value ||
+         HasBatchGradient<FunctionType>::value)>* = 0)
+{
+  const double objective = EvaluateBatch(function, coordinates, begin,
+      batchSize);
+  GradientBatch(function, coordinates, begin, gradient, batchSize);
+  return objective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
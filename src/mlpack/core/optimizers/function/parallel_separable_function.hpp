@@ -0,0 +1,132 @@
+/**
+ * @file parallel_separable_function.hpp
+ *
+ * Definition of the ParallelSeparableFunction class, which evaluates a
+ * separable function and its gradient in parallel, for optimizers that use the
+ * whole function, like L_BFGS and GradientDescent.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_FUNCTION_PARALLEL_SEPARABLE_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_FUNCTION_PARALLEL_SEPARABLE_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/function/evaluate_with_gradient.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * A wrapper for a separable function (a sum of NumFunctions() functions, as
+ * used by SGD) that evaluates the whole function, and its gradient, in
+ * parallel.  The separable functions are split into blocks of consecutive
+ * functions; the blocks are evaluated by several threads (with the batch
+ * overloads of the function, if it has them), and the results of the blocks
+ * are summed up in the order of the blocks.  So the result only depends on the
+ * block size, not on the number of threads or the scheduling.
+ *
+ * The wrapper can be passed to any optimizer that uses Evaluate(), Gradient()
+ * or EvaluateWithGradient() of the whole function, like L_BFGS and
+ * GradientDescent:
+ *
+ * @code
+ * LogisticRegressionFunction<> lrf(data, responses);
+ * ParallelSeparableFunction<LogisticRegressionFunction<>> f(lrf);
+ * arma::mat coordinates = lrf.GetInitialPoint();
+ * L_BFGS lbfgs;
+ * lbfgs.Optimize(f, coordinates);
+ * @endcode
+ *
+ * The wrapped function must be safe to evaluate concurrently at different
+ * separable functions (which is the case for the functions that do not change
+ * any state when they are evaluated), and must implement the following
+ * functions:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * @tparam FunctionType The type of the separable function.
+ */
+template<typename FunctionType>
+class ParallelSeparableFunction
+{
+ public:
+  /**
+   * Wrap the given separable function.  A std::invalid_argument exception is
+   * thrown if the block size is 0.
+   *
+   * @param function The separable function to evaluate.
+   * @param blockSize Number of separable functions in each block.
+   * @param numThreads Number of threads to use (0 means as many as OpenMP uses
+   *     by default).
+   */
+  ParallelSeparableFunction(FunctionType& function,
+                            const size_t blockSize = 1024,
+                            const size_t numThreads = 0);
+
+  /**
+   * Evaluate the whole function at the given coordinates.
+   *
+   * @param coordinates The coordinates to evaluate the function at.
+   */
+  double Evaluate(const arma::mat& coordinates);
+
+  /**
+   * Store the gradient of the whole function at the given coordinates in the
+   * given matrix.
+   *
+   * @param coordinates The coordinates to evaluate the gradient at.
+   * @param gradient Matrix to store the gradient in.
+   */
+  void Gradient(const arma::mat& coordinates, arma::mat& gradient);
+
+  /**
+   * Evaluate the whole function at the given coordinates, and store its
+   * gradient in the given matrix.
+   *
+   * @param coordinates The coordinates to evaluate the function at.
+   * @param gradient Matrix to store the gradient in.
+   */
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              arma::mat& gradient);
+
+  //! Get the number of separable functions.
+  size_t NumFunctions() const { return function.NumFunctions(); }
+
+  //! Get the block size.
+  size_t BlockSize() const { return blockSize; }
+  //! Modify the block size.
+  size_t& BlockSize() { return blockSize; }
+
+  //! Get the number of threads.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads.
+  size_t& NumThreads() { return numThreads; }
+
+ private:
+  //! Get the number of threads to use.
+  size_t Threads() const;
+
+  //! The wrapped separable function.
+  FunctionType& function;
+
+  //! The number of separable functions in each block.
+  size_t blockSize;
+
+  //! The number of threads.
+  size_t numThreads;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_separable_function_impl.hpp"
+
+#endif
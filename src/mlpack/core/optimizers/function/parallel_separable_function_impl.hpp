@@ -0,0 +1,140 @@
+/**
+ * @file parallel_separable_function_impl.hpp
+ *
+ * Implementation of the ParallelSeparableFunction class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_FUNCTION_PARALLEL_SEPARABLE_FUNCTION_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_FUNCTION_PARALLEL_SEPARABLE_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_separable_function.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename FunctionType>
+ParallelSeparableFunction<FunctionType>::ParallelSeparableFunction(
+    FunctionType& function,
+    const size_t blockSize,
+    const size_t numThreads) :
+    function(function),
+    blockSize(blockSize),
+    numThreads(numThreads)
+{
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("ParallelSeparableFunction::"
+        "ParallelSeparableFunction(): the block size must be positive");
+  }
+}
+
+template<typename FunctionType>
+double ParallelSeparableFunction<FunctionType>::Evaluate(
+    const arma::mat& coordinates)
+{
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numBlocks = (numFunctions + blockSize - 1) / blockSize;
+  const size_t threads = Threads();
+
+  arma::vec objectives(numBlocks);
+
+  #pragma omp parallel for num_threads(threads) schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * blockSize;
+    objectives[b] = EvaluateBatch(function, coordinates, begin,
+        std::min(blockSize, numFunctions - begin));
+  }
+
+  double objective = 0;
+  for (size_t b = 0; b < numBlocks; ++b)
+    objective += objectives[b];
+
+  return objective;
+}
+
+template<typename FunctionType>
+void ParallelSeparableFunction<FunctionType>::Gradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient)
+{
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numBlocks = (numFunctions + blockSize - 1) / blockSize;
+  const size_t threads = Threads();
+
+  gradient.zeros(arma::size(coordinates));
+
+  // Only the gradients of one block per thread are held at a time; they are
+  // added in the order of the blocks.
+  std::vector<arma::mat> gradients(threads);
+  for (size_t first = 0; first < numBlocks; first += threads)
+  {
+    const size_t last = std::min(first + threads, numBlocks);
+
+    #pragma omp parallel for num_threads(threads)
+    for (omp_size_t b = first; b < (omp_size_t) last; ++b)
+    {
+      const size_t begin = b * blockSize;
+      GradientBatch(function, coordinates, begin, gradients[b - first],
+          std::min(blockSize, numFunctions - begin));
+    }
+
+    for (size_t b = first; b < last; ++b)
+      gradient += gradients[b - first];
+  }
+}
+
+template<typename FunctionType>
+double ParallelSeparableFunction<FunctionType>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient)
+{
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numBlocks = (numFunctions + blockSize - 1) / blockSize;
+  const size_t threads = Threads();
+
+  double objective = 0;
+  gradient.zeros(arma::size(coordinates));
+
+  // Only the results of one block per thread are held at a time; they are
+  // added in the order of the blocks.
+  std::vector<arma::mat> gradients(threads);
+  arma::vec objectives(threads);
+  for (size_t first = 0; first < numBlocks; first += threads)
+  {
+    const size_t last = std::min(first + threads, numBlocks);
+
+    #pragma omp parallel for num_threads(threads)
+    for (omp_size_t b = first; b < (omp_size_t) last; ++b)
+    {
+      const size_t begin = b * blockSize;
+      objectives[b - first] = EvaluateGradientBatch(function, coordinates,
+          begin, gradients[b - first],
+          std::min(blockSize, numFunctions - begin));
+    }
+
+    for (size_t b = first; b < last; ++b)
+    {
+      objective += objectives[b - first];
+      gradient += gradients[b - first];
+    }
+  }
+
+  return objective;
+}
+
+template<typename FunctionType>
+size_t ParallelSeparableFunction<FunctionType>::Threads() const
+{
+  return ParallelThreads(numThreads);
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
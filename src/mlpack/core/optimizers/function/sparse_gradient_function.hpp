@@ -0,0 +1,129 @@
+/**
+ * @file sparse_gradient_function.hpp
+ *
+ * Definition of the SparseGradientFunction class, which lets SGD-based
+ * optimizers use the sparse gradient of a separable function.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_FUNCTION_SPARSE_GRADIENT_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_FUNCTION_SPARSE_GRADIENT_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/function/evaluate_with_gradient.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * A wrapper for a separable function that can compute a sparse gradient
+ * (with EvaluateWithGradient() for an arma::sp_mat), but does not use it by
+ * default, like FFN.  SGD (and so Adam, AdaGrad and RMSProp) uses sparse
+ * gradients for the wrapper if the update policy supports them, so that a
+ * step only touches the nonzero coordinates of the gradient; for instance,
+ * the columns of a Lookup embedding that the point used:
+ *
+ * @code
+ * FFN<NegativeLogLikelihood<>> model(data, responses);
+ * model.Add<Lookup<>>(vocabularySize, embeddingSize);
+ * // ... more layers ...
+ * model.ResetParameters();
+ *
+ * SparseGradientFunction<FFN<NegativeLogLikelihood<>>> f(model);
+ * Adam adam;
+ * adam.Optimize(f, model.Parameters());
+ * @endcode
+ *
+ * Note that the sparse Adam and RMSProp updates are lazy: coordinates that are
+ * not in the gradient are not updated, unlike with dense gradients.  Dense
+ * gradients are still used with update policies that only support them.
+ *
+ * The wrapped function must implement the following functions:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t i,
+ *                               arma::sp_mat& gradient);
+ *
+ * and, for dense gradients,
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t i,
+ *                               arma::mat& gradient);
+ *
+ * @tparam FunctionType The type of the separable function.
+ */
+template<typename FunctionType>
+class SparseGradientFunction
+{
+ public:
+  /**
+   * Wrap the given separable function.
+   *
+   * @param function The separable function to optimize.
+   */
+  SparseGradientFunction(FunctionType& function) : function(function) { }
+
+  //! Return the number of separable functions.
+  size_t NumFunctions() const { return function.NumFunctions(); }
+
+  //! Evaluate the separable function i at the given coordinates.
+  double Evaluate(const arma::mat& coordinates, const size_t i)
+  {
+    return function.Evaluate(coordinates, i);
+  }
+
+  //! Evaluate the sparse gradient of the separable function i at the given
+  //! coordinates.
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::sp_mat& gradient)
+  {
+    function.EvaluateWithGradient(coordinates, i, gradient);
+  }
+
+  //! Evaluate the separable function i and its sparse gradient at the given
+  //! coordinates.
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              const size_t i,
+                              arma::sp_mat& gradient)
+  {
+    return function.EvaluateWithGradient(coordinates, i, gradient);
+  }
+
+  //! Evaluate the dense gradient of the separable function i at the given
+  //! coordinates.
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::mat& gradient)
+  {
+    function.EvaluateWithGradient(coordinates, i, gradient);
+  }
+
+  //! Evaluate the separable function i and its dense gradient at the given
+  //! coordinates.
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              const size_t i,
+                              arma::mat& gradient)
+  {
+    return function.EvaluateWithGradient(coordinates, i, gradient);
+  }
+
+  //! Get the wrapped function.
+  const FunctionType& Function() const { return function; }
+  //! Modify the wrapped function.
+  FunctionType& Function() { return function; }
+
+ private:
+  //! The wrapped function.
+  FunctionType& function;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_GRADIENT_DESCENT_GRADIENT_DESCENT_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/function/parallel_separable_function.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -45,6 +46,9 @@ namespace optimization {
  *   double Evaluate(const arma::mat& coordinates);
  *   void Gradient(const arma::mat& coordinates,
  *                 arma::mat& gradient);
+ *
+ * A separable function (like the ones SGD uses) can be evaluated over several
+ * threads by wrapping it into a ParallelSeparableFunction.
  */
 class GradientDescent
 {
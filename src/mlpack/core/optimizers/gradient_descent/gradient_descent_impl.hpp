@@ -15,6 +15,8 @@
 // In case it hasn't been included yet.
 #include "gradient_descent.hpp"
 
+#include <mlpack/core/optimizers/function/evaluate_with_gradient.hpp>
+
 namespace mlpack {
 namespace optimization {
 
@@ -23,12 +25,13 @@ template<typename FunctionType>
 double GradientDescent::Optimize(
     FunctionType& function, arma::mat& iterate)
 {
-  // To keep track of where we are and how things are going.
-  double overallObjective = function.Evaluate(iterate);
+  // To keep track of where we are and how things are going.  The gradient is
+  // always computed together with the objective at the current iterate.
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  double overallObjective = EvaluateGradient(function, iterate, gradient);
   double lastObjective = DBL_MAX;
 
   // Now iterate!
-  arma::mat gradient(iterate.n_rows, iterate.n_cols);
   for (size_t i = 1; i != maxIterations; ++i)
   {
     // Output current objective function.
@@ -53,13 +56,11 @@ double GradientDescent::Optimize(
     // Reset the counter variables.
     lastObjective = overallObjective;
 
-    function.Gradient(iterate, gradient);
-
     // And update the iterate.
     iterate -= stepSize * gradient;
 
-    // Now add that to the overall objective function.
-    overallObjective = function.Evaluate(iterate);
+    // Now evaluate the objective and the gradient at the new iterate.
+    overallObjective = EvaluateGradient(function, iterate, gradient);
   }
 
   Log::Info << "Gradient Descent: maximum iterations (" << maxIterations
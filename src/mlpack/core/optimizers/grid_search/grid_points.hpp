@@ -0,0 +1,132 @@
+/**
+ * @file grid_points.hpp
+ *
+ * Auxiliary functions for the grid-based optimizers (GridSearch and
+ * SuccessiveHalving): enumeration of the points of a grid, and evaluation of
+ * a set of points, possibly in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_GRID_SEARCH_GRID_POINTS_HPP
+#define MLPACK_CORE_OPTIMIZERS_GRID_SEARCH_GRID_POINTS_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Get all points of the grid specified by datasetInfo (the possible values of
+ * each dimension), one point per column.  The points are ordered
+ * lexicographically by the indices of the values, so the last dimension
+ * changes fastest.
+ *
+ * @param datasetInfo Type information for each dimension of the dataset. It
+ *     should store possible values for each parameter.
+ */
+inline arma::mat GridPoints(
+    const data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo)
+{
+  const size_t dimensionality = datasetInfo.Dimensionality();
+
+  size_t numPoints = 1;
+  for (size_t i = 0; i < dimensionality; ++i)
+    numPoints *= datasetInfo.NumMappings(i);
+
+  arma::mat points(dimensionality, numPoints);
+  for (size_t p = 0; p < numPoints; ++p)
+  {
+    size_t index = p;
+    for (size_t i = dimensionality; i > 0; --i)
+    {
+      const size_t numValues = datasetInfo.NumMappings(i - 1);
+      points(i - 1, p) = datasetInfo.UnmapString(index % numValues, i - 1);
+      index /= numValues;
+    }
+  }
+
+  return points;
+}
+
+/**
+ * Evaluate a point with Evaluate(point).
+ */
+struct FullBudgetEvaluation
+{
+  template<typename FunctionType>
+  double operator()(FunctionType& function, const arma::mat& point) const
+  {
+    return function.Evaluate(point);
+  }
+};
+
+/**
+ * Evaluate a point with Evaluate(point, budget), which uses only the given
+ * proportion of the full budget (see SuccessiveHalving).
+ */
+struct PartialBudgetEvaluation
+{
+  //! The proportion of the full budget.
+  double budget;
+
+  template<typename FunctionType>
+  double operator()(FunctionType& function, const arma::mat& point) const
+  {
+    return function.Evaluate(point, budget);
+  }
+};
+
+/**
+ * Evaluate the function at each of the given points.  If numThreads is not 1,
+ * the points are distributed over the given number of threads (or over as many
+ * threads as OpenMP uses by default, if numThreads is 0), each of which
+ * evaluates with its own copy of the function; the given function itself is
+ * not evaluated then, and FunctionType must be copy-constructible.
+ *
+ * @param function Function to evaluate.
+ * @param points Points to evaluate the function at, one per column.
+ * @param evaluation The way each point is evaluated (FullBudgetEvaluation or
+ *     PartialBudgetEvaluation).
+ * @param numThreads Number of threads to use.
+ * @return The objective of each point.
+ */
+template<typename FunctionType, typename EvaluationType>
+arma::vec EvaluateGridPoints(FunctionType& function,
+                             const arma::mat& points,
+                             const EvaluationType& evaluation,
+                             const size_t numThreads)
+{
+  arma::vec objectives(points.n_cols);
+
+  if (numThreads == 1)
+  {
+    for (size_t i = 0; i < points.n_cols; ++i)
+      objectives[i] = evaluation(function, points.col(i));
+
+    return objectives;
+  }
+
+  const size_t threads = ParallelThreads(numThreads);
+
+  #pragma omp parallel num_threads(threads)
+  {
+    FunctionType threadFunction(function);
+
+    // The evaluations can take very different times (for example, when the
+    // points are hyper-parameters of a model), so they are handed out
+    // dynamically.
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) points.n_cols; ++i)
+      objectives[i] = evaluation(threadFunction, points.col(i));
+  }
+
+  return objectives;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,8 @@
 
 #include <mlpack/core.hpp>
 
+#include "grid_points.hpp"
+
 namespace mlpack {
 namespace optimization {
 
@@ -25,10 +27,27 @@ namespace optimization {
  * class must implement the following function:
  *
  *   double Evaluate(const arma::mat& coordinates);
+ *
+ * FunctionType must also be copy-constructible, since the points can be
+ * evaluated in parallel; then each thread evaluates the points with its own
+ * copy of the function, and the copies must be safe to evaluate concurrently
+ * (CVFunction, which is used by HyperParameterTuner, is).  When all points are
+ * evaluated, the best point is evaluated once more with the given function, so
+ * that its state (for example, the best model of a CVFunction) is the same as
+ * after a serial run.
  */
 class GridSearch
 {
  public:
+  /**
+   * Construct the grid-search optimizer.
+   *
+   * @param numThreads Number of threads to evaluate the points with (0 means
+   *     as many as OpenMP uses by default).  With 1 thread, the given function
+   *     is evaluated directly.
+   */
+  GridSearch(const size_t numThreads = 1) : numThreads(numThreads) { }
+
   /**
    * Optimize (minimize) the given function by iterating through the all
    * possible combinations of values for the parameters specified in
@@ -46,22 +65,14 @@ class GridSearch
       arma::mat& bestParameters,
       data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo);
 
+  //! Get the number of threads.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads.
+  size_t& NumThreads() { return numThreads; }
+
  private:
-  /**
-   * Iterate through the last (parameterValueCollections.size() - i) dimensions
-   * of the grid and change the arguments bestObjective and bestParameters if
-   * there is something better. The values for the first i dimensions
-   * (parameters) are specified in the first i rows of the currentParameters
-   * argument.
-   */
-  template<typename FunctionType>
-  void Optimize(
-      FunctionType& function,
-      double& bestObjective,
-      arma::mat& bestParameters,
-      arma::vec& currentParameters,
-      data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo,
-      size_t i);
+  //! The number of threads to evaluate the points with.
+  size_t numThreads;
 };
 
 } // namespace optimization
@@ -36,7 +36,6 @@ double GridSearch::Optimize(
 
   double bestObjective = std::numeric_limits<double>::max();
   bestParameters = arma::mat(datasetInfo.Dimensionality(), 1);
-  arma::vec currentParameters = arma::vec(datasetInfo.Dimensionality());
 
   /* Initialize best parameters for the case (very unlikely though) when no set
    * of parameters gives an objective value better than
@@ -44,39 +43,26 @@ double GridSearch::Optimize(
   for (size_t i = 0; i < datasetInfo.Dimensionality(); ++i)
     bestParameters(i, 0) = datasetInfo.UnmapString(0, i);
 
-  Optimize(function, bestObjective, bestParameters, currentParameters,
-      datasetInfo, 0);
+  const arma::mat points = GridPoints(datasetInfo);
+  const arma::vec objectives = EvaluateGridPoints(function, points,
+      FullBudgetEvaluation(), numThreads);
 
-  return bestObjective;
-}
-
-template<typename FunctionType>
-void GridSearch::Optimize(
-    FunctionType& function,
-    double& bestObjective,
-    arma::mat& bestParameters,
-    arma::vec& currentParameters,
-    data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo,
-    size_t i)
-{
-  if (i < datasetInfo.Dimensionality())
+  // Take the first of the best points, as the points are visited in order.
+  for (size_t i = 0; i < points.n_cols; ++i)
   {
-    for (size_t j = 0; j < datasetInfo.NumMappings(i); ++j)
+    if (objectives[i] < bestObjective)
     {
-      currentParameters(i) = datasetInfo.UnmapString(j, i);
-      Optimize(function, bestObjective, bestParameters, currentParameters,
-          datasetInfo, i + 1);
-    }
-  }
-  else
-  {
-    double objective = function.Evaluate(currentParameters);
-    if (objective < bestObjective)
-    {
-      bestObjective = objective;
-      bestParameters = currentParameters;
+      bestObjective = objectives[i];
+      bestParameters = points.col(i);
     }
   }
+
+  // The given function was not used in the parallel case; bring it into the
+  // state of the serial search.
+  if (numThreads != 1)
+    function.Evaluate(bestParameters);
+
+  return bestObjective;
 }
 
 } // namespace optimization
@@ -0,0 +1,193 @@
+/**
+ * @file hogwild_sgd.hpp
+ *
+ * Lock-free parallel stochastic gradient descent for functions with dense
+ * gradients.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_HPP
+#define MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
+#include <mlpack/core/optimizers/parallel_sgd/decay_policies/constant_step.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * An implementation of asynchronous parallel stochastic gradient descent for
+ * functions with dense gradients, in the lock-free HOGWILD! style.  ParallelSGD
+ * needs sparse gradients, because it updates each nonzero component
+ * atomically; HogwildSGD instead lets each thread take its steps on the shared
+ * coordinates without any synchronization.  The steps of the threads may then
+ * overlap and partially overwrite each other, which HOGWILD! shows to be
+ * harmless for the convergence in practice, as long as the steps are small.
+ *
+ * Each pass over the data is split between the threads.  Each thread has its
+ * own copy of the update policy, so policies with state (such as
+ * MomentumUpdate) keep one state per thread, and the step size of each pass is
+ * given by the decay policy (see ConstantStep and ExponentialBackoff).
+ *
+ * Alternatively, the threads can work on their own replicas of the
+ * coordinates, which are averaged every given number of points.  This avoids
+ * the cache-line traffic of the shared coordinates at the cost of slower
+ * mixing.  Each replica is first written by its own thread, so that with
+ * pinned threads (e.g. OMP_PROC_BIND=true) its memory is local to the NUMA node
+ * of the thread.
+ *
+ * For more information, see the following.
+ * @misc{1106.5730,
+ *   Author = {Feng Niu and Benjamin Recht and Christopher Re and Stephen J.
+ *             Wright},
+ *   Title = {HOGWILD!: A Lock-Free Approach to Parallelizing Stochastic
+ *            Gradient Descent},
+ *   Year = {2011},
+ *   Eprint = {arXiv:1106.5730},
+ * }
+ *
+ * For HogwildSGD to work, a DecomposableFunctionType template parameter is
+ * required.  This class must implement the following functions:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * as for SGD (EvaluateWithGradient() is used if it is available), and these
+ * functions must be safe to call from several threads at once, as is the case
+ * for LogisticRegressionFunction and SoftmaxRegressionFunction.  FFN does not
+ * qualify, because its evaluation stores the activations in the network.
+ *
+ * @tparam UpdatePolicyType Update policy used by each thread to take its steps.
+ * @tparam DecayPolicyType Step size policy applied at the start of each pass.
+ */
+template<typename UpdatePolicyType = VanillaUpdate,
+         typename DecayPolicyType = ConstantStep>
+class HogwildSGD
+{
+ public:
+  /**
+   * Construct the HogwildSGD optimizer with the given parameters.  One
+   * iteration is one pass over all functions, split between the threads.
+   *
+   * @param maxIterations Maximum number of passes over the data (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate the algorithm.
+   * @param shuffle If true, the function order is shuffled at every pass;
+   *     otherwise, each thread visits its share in linear order.
+   * @param decayPolicy The step size policy to use.
+   * @param updatePolicy The update policy, which is copied for each thread.
+   * @param averagingInterval If 0, all threads update the same coordinates.
+   *     Otherwise, each thread updates its own replica, and the replicas are
+   *     averaged after each thread has processed this many points.
+   * @param numThreads Number of threads to use (0 means the OpenMP default).
+   * @param resetPolicy If true, the update policies are reset before every
+   *     call to Optimize().
+   */
+  HogwildSGD(const size_t maxIterations = 100,
+             const double tolerance = 1e-5,
+             const bool shuffle = true,
+             const DecayPolicyType& decayPolicy = DecayPolicyType(),
+             const UpdatePolicyType& updatePolicy = UpdatePolicyType(),
+             const size_t averagingInterval = 0,
+             const size_t numThreads = 0,
+             const bool resetPolicy = true);
+
+  /**
+   * Optimize the given function using HogwildSGD.  The given starting point
+   * will be modified to store the finishing point of the algorithm, and the
+   * final objective value is returned.
+   *
+   * @tparam DecomposableFunctionType Type of the function to be optimized.
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  template<typename DecomposableFunctionType>
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  //! Get the maximum number of passes (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of passes (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  //! Get the step size decay policy.
+  const DecayPolicyType& DecayPolicy() const { return decayPolicy; }
+  //! Modify the step size decay policy.
+  DecayPolicyType& DecayPolicy() { return decayPolicy; }
+
+  //! Get the update policy that is copied for each thread.
+  const UpdatePolicyType& UpdatePolicy() const { return updatePolicy; }
+  //! Modify the update policy that is copied for each thread.
+  UpdatePolicyType& UpdatePolicy() { return updatePolicy; }
+
+  //! Get the number of points per thread between the averagings of the
+  //! replicas (0 means that the coordinates are shared).
+  size_t AveragingInterval() const { return averagingInterval; }
+  //! Modify the number of points per thread between the averagings of the
+  //! replicas (0 means that the coordinates are shared).
+  size_t& AveragingInterval() { return averagingInterval; }
+
+  //! Get the number of threads (0 means the OpenMP default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads (0 means the OpenMP default).
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get whether or not the update policies are reset before Optimize().
+  bool ResetPolicy() const { return resetPolicy; }
+  //! Modify whether or not the update policies are reset before Optimize().
+  bool& ResetPolicy() { return resetPolicy; }
+
+ private:
+  //! The maximum number of passes.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled.
+  bool shuffle;
+
+  //! The step size decay policy.
+  DecayPolicyType decayPolicy;
+
+  //! The update policy that is copied for each thread.
+  UpdatePolicyType updatePolicy;
+
+  //! The number of points per thread between the averagings of the replicas.
+  size_t averagingInterval;
+
+  //! The number of threads.
+  size_t numThreads;
+
+  //! Whether the update policies are reset before Optimize().
+  bool resetPolicy;
+
+  //! The update policy of each thread, kept between calls to Optimize().
+  std::vector<UpdatePolicyType> threadPolicies;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "hogwild_sgd_impl.hpp"
+
+#endif
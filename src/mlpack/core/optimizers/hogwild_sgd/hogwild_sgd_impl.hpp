@@ -0,0 +1,183 @@
+/**
+ * @file hogwild_sgd_impl.hpp
+ *
+ * Implementation of lock-free parallel stochastic gradient descent for
+ * functions with dense gradients.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_IMPL_HPP
+
+#include <mlpack/core/optimizers/function/evaluate_with_gradient.hpp>
+
+// In case it hasn't been included yet.
+#include "hogwild_sgd.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename UpdatePolicyType, typename DecayPolicyType>
+HogwildSGD<UpdatePolicyType, DecayPolicyType>::HogwildSGD(
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle,
+    const DecayPolicyType& decayPolicy,
+    const UpdatePolicyType& updatePolicy,
+    const size_t averagingInterval,
+    const size_t numThreads,
+    const bool resetPolicy) :
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle),
+    decayPolicy(decayPolicy),
+    updatePolicy(updatePolicy),
+    averagingInterval(averagingInterval),
+    numThreads(numThreads),
+    resetPolicy(resetPolicy)
+{ /* Nothing to do. */ }
+
+template<typename UpdatePolicyType, typename DecayPolicyType>
+template<typename DecomposableFunctionType>
+double HogwildSGD<UpdatePolicyType, DecayPolicyType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  const size_t threads = std::max(std::min(ParallelThreads(numThreads),
+      numFunctions), (size_t) 1);
+
+  // Give each thread its own update policy.
+  if (resetPolicy || threadPolicies.size() != threads)
+  {
+    threadPolicies.assign(threads, updatePolicy);
+    for (size_t t = 0; t < threads; ++t)
+      threadPolicies[t].Initialize(iterate.n_rows, iterate.n_cols);
+  }
+
+  // Each replica is allocated by its thread, so that it is local to the thread
+  // under the first-touch policy.
+  std::vector<arma::mat> replicas(averagingInterval > 0 ? threads : 0);
+  #pragma omp parallel for num_threads(threads) schedule(static, 1)
+  for (omp_size_t t = 0; t < (omp_size_t) replicas.size(); ++t)
+    replicas[t] = iterate;
+
+  // The number of points that are processed (by all threads together) between
+  // two averagings of the replicas.
+  const size_t roundSize = (averagingInterval == 0) ? numFunctions :
+      std::min(numFunctions, averagingInterval * threads);
+
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numFunctions - 1), numFunctions);
+
+  // Without replicas, all threads update the iterate without synchronization,
+  // which cannot be reproduced; with deterministic reductions, the shares of
+  // the threads are then processed in order by one thread.
+  const size_t updateThreads = (DeterministicReductions() &&
+      averagingInterval == 0) ? 1 : threads;
+
+  // The objectives of the threads are summed in order.
+  arma::vec threadObjectives(threads);
+
+  double overallObjective = DBL_MAX;
+  double lastObjective;
+  for (size_t i = 1; i != maxIterations; ++i)
+  {
+    const double stepSize = decayPolicy.StepSize(i);
+
+    if (shuffle)
+    {
+      std::shuffle(visitationOrder.begin(), visitationOrder.end(),
+          mlpack::math::randGen);
+    }
+
+    // The objective of the pass is the sum of the objectives computed for the
+    // steps, so checking convergence needs no extra pass over the data.
+    lastObjective = overallObjective;
+    overallObjective = 0;
+    for (size_t roundBegin = 0; roundBegin < numFunctions;
+        roundBegin += roundSize)
+    {
+      const size_t roundEnd = std::min(roundBegin + roundSize, numFunctions);
+
+      threadObjectives.zeros();
+
+      #pragma omp parallel for num_threads(updateThreads) schedule(static, 1)
+      for (omp_size_t t = 0; t < (omp_size_t) threads; ++t)
+      {
+        const size_t thread = (size_t) t;
+        arma::mat& threadIterate = (averagingInterval == 0) ? iterate :
+            replicas[thread];
+        const size_t begin = roundBegin +
+            thread * (roundEnd - roundBegin) / threads;
+        const size_t end = roundBegin +
+            (thread + 1) * (roundEnd - roundBegin) / threads;
+
+        arma::mat gradient(iterate.n_rows, iterate.n_cols);
+        for (size_t j = begin; j < end; ++j)
+        {
+          threadObjectives[thread] += EvaluateGradient(function,
+              threadIterate, visitationOrder[j], gradient);
+          threadPolicies[thread].Update(threadIterate, stepSize, gradient);
+        }
+      }
+
+      for (size_t t = 0; t < threads; ++t)
+        overallObjective += threadObjectives[t];
+
+      if (averagingInterval > 0)
+      {
+        iterate = replicas[0];
+        for (size_t t = 1; t < threads; ++t)
+          iterate += replicas[t];
+        iterate /= threads;
+
+        #pragma omp parallel for num_threads(threads) schedule(static, 1)
+        for (omp_size_t t = 0; t < (omp_size_t) threads; ++t)
+          replicas[t] = iterate;
+      }
+    }
+
+    Log::Info << "Hogwild SGD: iteration " << i << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "Hogwild SGD: converged to " << overallObjective
+          << "; terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "Hogwild SGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      break;
+    }
+  }
+
+  // Calculate the final objective.
+  ReductionPartials<double> partials(numFunctions, 0.0, threads);
+  #pragma omp parallel for num_threads(partials.Threads())
+  for (omp_size_t c = 0; c < (omp_size_t) partials.Chunks(); ++c)
+  {
+    double& objective = partials.Partial(c);
+    for (size_t i = partials.Begin(c); i < partials.End(c); ++i)
+      objective += function.Evaluate(iterate, i);
+  }
+
+  partials.Reduce(overallObjective,
+      [](double& a, const double& b) { a += b; });
+
+  return overallObjective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
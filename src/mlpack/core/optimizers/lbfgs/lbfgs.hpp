@@ -14,6 +14,8 @@
 #define MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/function/evaluate_with_gradient.hpp>
+#include <mlpack/core/optimizers/function/parallel_separable_function.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -30,6 +32,17 @@ namespace optimization {
  *  - double Evaluate(const arma::mat& coordinates);
  *  - void Gradient(const arma::mat& coordinates, arma::mat& gradient);
  *  - arma::mat& GetInitialPoint();
+ *
+ * If the function also implements
+ *
+ *  - double EvaluateWithGradient(const arma::mat& coordinates,
+ *                                arma::mat& gradient);
+ *
+ * then that is used instead of separate calls to Evaluate() and Gradient()
+ * wherever both are needed at the same point.
+ *
+ * A separable function (like the ones SGD uses) can be evaluated over several
+ * threads by wrapping it into a ParallelSeparableFunction.
  */
 class L_BFGS
 {
@@ -151,14 +164,16 @@ class L_BFGS
   double maxStep;
 
   /**
-   * Evaluate the function at the given iterate point and store the result if it
-   * is a new minimum.
+   * Evaluate the function and its gradient at the given iterate point and
+   * store the result if it is a new minimum.  If the function provides
+   * EvaluateWithGradient(), both are computed with one call.
    *
    * @return The value of the function.
    */
   template<typename FunctionType>
   double Evaluate(FunctionType& function,
                   const arma::mat& iterate,
+                  arma::mat& gradient,
                   std::pair<arma::mat, double>& minPointIterate);
 
   /**
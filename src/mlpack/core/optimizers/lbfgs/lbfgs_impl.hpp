@@ -17,19 +17,20 @@ namespace mlpack {
 namespace optimization {
 
 /**
- * Evaluate the function at the given iterate point and store the result if
- * it is a new minimum.
+ * Evaluate the function and its gradient at the given iterate point and store
+ * the result if it is a new minimum.
  *
  * @return The value of the function
  */
 template<typename FunctionType>
 double L_BFGS::Evaluate(FunctionType& function,
                         const arma::mat& iterate,
+                        arma::mat& gradient,
                         std::pair<arma::mat, double>& minPointIterate)
 {
-  // Evaluate the function and keep track of the minimum function
-  // value encountered during the optimization.
-  const double functionValue = function.Evaluate(iterate);
+  // Evaluate the function together with its gradient and keep track of the
+  // minimum function value encountered during the optimization.
+  const double functionValue = EvaluateGradient(function, iterate, gradient);
 
   if (functionValue < minPointIterate.second)
   {
@@ -111,8 +112,8 @@ bool L_BFGS::LineSearch(FunctionType& function,
     // point.
     newIterateTmp = iterate;
     newIterateTmp += stepSize * searchDirection;
-    functionValue = Evaluate(function, newIterateTmp, minPointIterate);
-    function.Gradient(newIterateTmp, gradient);
+    functionValue = Evaluate(function, newIterateTmp, gradient,
+        minPointIterate);
     numIterations++;
 
     if (functionValue > initialFunctionValue + stepSize *
@@ -191,29 +192,27 @@ double L_BFGS::Optimize(FunctionType& function, arma::mat& iterate)
   // Whether to optimize until convergence.
   bool optimizeUntilConvergence = (maxIterations == 0);
 
-  // The initial function value.
-  double functionValue = Evaluate(function, iterate, minPointIterate);
-  double prevFunctionValue = functionValue;
-
   // The gradient: the current and the old.
   arma::mat gradient;
   arma::mat oldGradient;
   gradient.zeros(iterate.n_rows, iterate.n_cols);
   oldGradient.zeros(iterate.n_rows, iterate.n_cols);
 
+  // The initial function value and gradient.
+  double functionValue = Evaluate(function, iterate, gradient,
+      minPointIterate);
+  double prevFunctionValue = functionValue;
+
   // The search direction.
   arma::mat searchDirection;
   searchDirection.zeros(iterate.n_rows, iterate.n_cols);
 
-  // The initial gradient value.
-  function.Gradient(iterate, gradient);
-
   // The main optimization loop.
   for (size_t itNum = 0; optimizeUntilConvergence || (itNum != maxIterations);
        ++itNum)
   {
     Log::Debug << "L-BFGS iteration " << itNum << "; objective " <<
-        function.Evaluate(iterate) << ", gradient norm "
+        functionValue << ", gradient norm "
         << arma::norm(gradient, 2) << ", "
         << ((prevFunctionValue - functionValue) /
             std::max(std::max(fabs(prevFunctionValue),
@@ -0,0 +1,137 @@
+/**
+ * @file batch_function.hpp
+ *
+ * Evaluation of a decomposable function and its gradient on a batch of
+ * consecutive separable functions.  If the function provides batch overloads of
+ * Evaluate() and Gradient(), they are used; otherwise the separable functions
+ * are evaluated one at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_BATCH_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_BATCH_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(Evaluate, HasBatchEvaluateCheck);
+HAS_MEM_FUNC(Gradient, HasBatchGradientCheck);
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * double Evaluate(const arma::mat& coordinates, const size_t begin,
+ *                 const size_t batchSize).
+ */
+template<typename FunctionType>
+struct HasBatchEvaluate
+{
+  static const bool value =
+    HasBatchEvaluateCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&,
+                                const size_t,
+                                const size_t)>::value ||
+    HasBatchEvaluateCheck<FunctionType,
+        double(FunctionType::*)(const arma::mat&,
+                                const size_t,
+                                const size_t) const>::value;
+};
+
+/**
+ * 'value' is true if the FunctionType class has a member
+ * void Gradient(const arma::mat& coordinates, const size_t begin,
+ *               arma::mat& gradient, const size_t batchSize).
+ */
+template<typename FunctionType>
+struct HasBatchGradient
+{
+  static const bool value =
+    HasBatchGradientCheck<FunctionType,
+        void(FunctionType::*)(const arma::mat&,
+                              const size_t,
+                              arma::mat&,
+                              const size_t)>::value ||
+    HasBatchGradientCheck<FunctionType,
+        void(FunctionType::*)(const arma::mat&,
+                              const size_t,
+                              arma::mat&,
+                              const size_t) const>::value;
+};
+
+//! Evaluate the separable functions [begin, begin + batchSize) with the batch
+//! overload of Evaluate().
+template<typename FunctionType>
+double EvaluateBatch(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t batchSize,
+    const typename std::enable_if_t<HasBatchEvaluate<FunctionType>::value>* = 0)
+{
+  return function.Evaluate(coordinates, begin, batchSize);
+}
+
+//! Evaluate the separable functions [begin, begin + batchSize) one at a time.
+template<typename FunctionType>
+double EvaluateBatch(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchEvaluate<FunctionType>::value>* = 0)
+{
+  double objective = 0;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+    objective += function.Evaluate(coordinates, i);
+
+  return objective;
+}
+
+//! Store the sum of the gradients of the separable functions
+//! [begin, begin + batchSize) in the given matrix, with the batch overload of
+//! Gradient().
+template<typename FunctionType>
+void GradientBatch(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<HasBatchGradient<FunctionType>::value>* = 0)
+{
+  function.Gradient(coordinates, begin, gradient, batchSize);
+}
+
+//! Store the sum of the gradients of the separable functions
+//! [begin, begin + batchSize) in the given matrix, computing them one at a
+//! time.
+template<typename FunctionType>
+void GradientBatch(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize,
+    const typename std::enable_if_t<
+        !HasBatchGradient<FunctionType>::value>* = 0)
+{
+  function.Gradient(coordinates, begin, gradient);
+
+  arma::mat funcGradient;
+  for (size_t i = begin + 1; i < begin + batchSize; ++i)
+  {
+    function.Gradient(coordinates, i, funcGradient);
+    gradient += funcGradient;
+  }
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
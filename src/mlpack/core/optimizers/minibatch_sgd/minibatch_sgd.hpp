@@ -69,6 +69,22 @@ namespace optimization {
  * function on the first point in the dataset (presumably, the dataset is held
  * internally in the DecomposableFunctionType).
  *
+ * Optionally, the class may also implement
+ *
+ *   double Evaluate(const arma::mat& coordinates,
+ *                   const size_t begin,
+ *                   const size_t batchSize);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 arma::mat& gradient,
+ *                 const size_t batchSize);
+ *
+ * which evaluate the sum of the objectives (or gradients) of the functions
+ * [begin, begin + batchSize) at once.  If they exist, mini-batch SGD evaluates
+ * each mini-batch with a single call (this lets, e.g., FFN pass a whole batch
+ * through the network with matrix-matrix products); otherwise the functions of
+ * a mini-batch are evaluated one at a time.
+ *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  * @tparam update Update policy used during the iterative update process.
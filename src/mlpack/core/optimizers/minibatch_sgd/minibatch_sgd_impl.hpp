@@ -15,6 +15,9 @@
 // In case it hasn't been included yet.
 #include "minibatch_sgd.hpp"
 
+#include "batch_function.hpp"
+#include <mlpack/core/optimizers/function/evaluate_with_gradient.hpp>
+
 namespace mlpack {
 namespace optimization {
 
@@ -73,9 +76,12 @@ double MiniBatchSGDType<
   double overallObjective = 0;
   double lastObjective = DBL_MAX;
 
-  // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
+  // Calculate the first objective function, one mini-batch at a time.
+  for (size_t i = 0; i < numFunctions; i += batchSize)
+  {
+    overallObjective += EvaluateBatch(function, iterate, i,
+        std::min(batchSize, numFunctions - i));
+  }
 
   // Initialize the update policy.
   if (resetPolicy)
@@ -116,53 +122,16 @@ double MiniBatchSGDType<
         visitationOrder = arma::shuffle(visitationOrder);
     }
 
-    // Evaluate the gradient for this mini-batch.
+    // Evaluate the objective and the gradient for this mini-batch, and add the
+    // objective to the overall objective function.  The last batch may not be
+    // a full-size batch.
     const size_t offset = batchSize * visitationOrder[currentBatch];
-    function.Gradient(iterate, offset, gradient);
-    if (visitationOrder[currentBatch] != numBatches - 1)
-    {
-      for (size_t j = 1; j < batchSize; ++j)
-      {
-        arma::mat funcGradient;
-        function.Gradient(iterate, offset + j, funcGradient);
-        gradient += funcGradient;
-      }
-
-      // Now update the iterate.
-      updatePolicy.Update(iterate, stepSize / batchSize, gradient);
-
-      // Add that to the overall objective function.
-      for (size_t j = 0; j < batchSize; ++j)
-        overallObjective += function.Evaluate(iterate, offset + j);
-    }
-    else
-    {
-      // Handle last batch differently: it's not a full-size batch.
-      const size_t lastBatchSize = numFunctions - offset - 1;
-      for (size_t j = 1; j < lastBatchSize; ++j)
-      {
-        arma::mat funcGradient;
-        function.Gradient(iterate, offset + j, funcGradient);
-        gradient += funcGradient;
-      }
-
-      // Ensure the last batch size isn't zero, to avoid division by zero before
-      // updating.
-      if (lastBatchSize > 0)
-      {
-        // Now update the iterate.
-        updatePolicy.Update(iterate, stepSize / lastBatchSize, gradient);
-      }
-      else
-      {
-        // Now update the iterate.
-        updatePolicy.Update(iterate, stepSize, gradient);
-      }
+    const size_t currentBatchSize = std::min(batchSize, numFunctions - offset);
+    overallObjective += EvaluateGradientBatch(function, iterate, offset,
+        gradient, currentBatchSize);
 
-      // Add that to the overall objective function.
-      for (size_t j = 0; j < lastBatchSize; ++j)
-        overallObjective += function.Evaluate(iterate, offset + j);
-    }
+    // Now update the iterate.
+    updatePolicy.Update(iterate, stepSize / currentBatchSize, gradient);
 
     // Now update the learning rate if requested by the user.
     decayPolicy.Update(iterate, stepSize, gradient);
@@ -173,8 +142,11 @@ double MiniBatchSGDType<
 
   // Calculate final objective.
   overallObjective = 0;
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
+  for (size_t i = 0; i < numFunctions; i += batchSize)
+  {
+    overallObjective += EvaluateBatch(function, iterate, i,
+        std::min(batchSize, numFunctions - i));
+  }
 
   return overallObjective;
 }
@@ -0,0 +1,50 @@
+/**
+ * @file local_communicator.hpp
+ *
+ * Definition of the LocalCommunicator class, the communicator of a single
+ * process for ModelAveraging.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_LOCAL_COMMUNICATOR_HPP
+#define MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_LOCAL_COMMUNICATOR_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The communicator of a single process, which is the only node; all
+ * operations leave the given matrices as they are.  This is the default
+ * communicator of ModelAveraging (see MPICommunicator for several processes).
+ * A communicator class must implement the following functions:
+ *
+ *   size_t Rank() const;
+ *   size_t Size() const;
+ *   void AllReduceSum(arma::mat& m);
+ *   void Broadcast(arma::mat& m);
+ */
+class LocalCommunicator
+{
+ public:
+  //! Get the index of this node.
+  size_t Rank() const { return 0; }
+
+  //! Get the number of nodes.
+  size_t Size() const { return 1; }
+
+  //! Replace the given matrix with the sum of the matrices of all nodes.
+  void AllReduceSum(arma::mat& /* m */) { }
+
+  //! Replace the given matrix with the matrix of the first node.
+  void Broadcast(arma::mat& /* m */) { }
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
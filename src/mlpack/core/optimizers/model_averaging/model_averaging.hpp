@@ -0,0 +1,151 @@
+/**
+ * @file model_averaging.hpp
+ *
+ * Distributed optimization by synchronous periodic model averaging.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_MODEL_AVERAGING_HPP
+#define MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_MODEL_AVERAGING_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/batch_function.hpp>
+
+#include "local_communicator.hpp"
+#include "mpi_communicator.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * An optimizer that trains one model on several nodes (for example, MPI
+ * processes on the machines of a cluster), each of which holds a shard of the
+ * data.  Each node runs the given optimizer (usually SGD or MiniBatchSGD) on
+ * its own function for a round, and then the models of all nodes are replaced
+ * by their average, weighted by the number of points of each node.  The rounds
+ * are repeated until the objective of the averaged model over all shards
+ * changes by less than the tolerance, or until the maximum number of rounds.
+ *
+ * The length of a round is the length of one Optimize() call of the given
+ * optimizer, so its MaxIterations() should be set to the number of points each
+ * node visits per round (for example, the number of its points, for one pass
+ * over its data).  To keep the state of the update policy between the rounds,
+ * set its ResetPolicy() to false.
+ *
+ * The nodes communicate through the given communicator: LocalCommunicator is
+ * a single node, and MPICommunicator (if mlpack is built with the USE_MPI CMake
+ * option) connects the processes of an MPI communicator.  Every process has to
+ * call Optimize() with a starting point of the same size; the starting point
+ * of the first process is used.  All processes take the same decisions, since
+ * they are based on the averaged model only, and return the same model.
+ *
+ * @code
+ * MPI_Init(&argc, &argv);
+ *
+ * // Each process loads its own shard of the data.
+ * SoftmaxRegressionFunction f(shardData, shardLabels, numClasses);
+ * StandardSGD sgd(0.01, shardData.n_cols);
+ * ModelAveraging<StandardSGD, MPICommunicator> optimizer(sgd);
+ * arma::mat coordinates = f.GetInitialPoint();
+ * optimizer.Optimize(f, coordinates);
+ *
+ * MPI_Finalize();
+ * @endcode
+ *
+ * For more information, see the following.
+ * @inproceedings{zinkevich2010parallelized,
+ *   title     = {Parallelized Stochastic Gradient Descent},
+ *   author    = {Zinkevich, Martin and Weimer, Markus and Li, Lihong and
+ *                Smola, Alex J.},
+ *   booktitle = {Advances in Neural Information Processing Systems 23},
+ *   pages     = {2595--2603},
+ *   year      = {2010}
+ * }
+ *
+ * For ModelAveraging to work, a DecomposableFunctionType template parameter is
+ * required.  This class must implement the functions the given optimizer needs,
+ * and the following functions:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *
+ * @tparam OptimizerType The optimizer each node runs on its own data.
+ * @tparam CommunicatorType The communicator between the nodes.
+ */
+template<typename OptimizerType,
+         typename CommunicatorType = LocalCommunicator>
+class ModelAveraging
+{
+ public:
+  /**
+   * Construct the model averaging optimizer.
+   *
+   * @param optimizer The optimizer for the rounds of each node.
+   * @param maxRounds Maximum number of rounds (0 means no limit).
+   * @param tolerance Maximum absolute change of the objective of the averaged
+   *     model between two rounds to terminate.
+   * @param communicator The communicator between the nodes.
+   */
+  ModelAveraging(const OptimizerType& optimizer = OptimizerType(),
+                 const size_t maxRounds = 100,
+                 const double tolerance = 1e-5,
+                 const CommunicatorType& communicator = CommunicatorType());
+
+  /**
+   * Optimize the given function, of which this node holds a shard, together
+   * with the other nodes.  The given starting point will be modified to store
+   * the finishing point of the algorithm, and the final objective value over
+   * all shards is returned.
+   *
+   * @tparam DecomposableFunctionType Type of the function to be optimized.
+   * @param function The shard of the function of this node.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point over all shards.
+   */
+  template<typename DecomposableFunctionType>
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  //! Get the optimizer of each node.
+  const OptimizerType& Optimizer() const { return optimizer; }
+  //! Modify the optimizer of each node.
+  OptimizerType& Optimizer() { return optimizer; }
+
+  //! Get the maximum number of rounds (0 indicates no limit).
+  size_t MaxRounds() const { return maxRounds; }
+  //! Modify the maximum number of rounds (0 indicates no limit).
+  size_t& MaxRounds() { return maxRounds; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the communicator.
+  const CommunicatorType& Communicator() const { return communicator; }
+  //! Modify the communicator.
+  CommunicatorType& Communicator() { return communicator; }
+
+ private:
+  //! The optimizer of each node.
+  OptimizerType optimizer;
+
+  //! The maximum number of rounds.
+  size_t maxRounds;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! The communicator between the nodes.
+  CommunicatorType communicator;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "model_averaging_impl.hpp"
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file model_averaging_impl.hpp
+ *
+ * Implementation of distributed optimization by synchronous periodic model
+ * averaging.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_MODEL_AVERAGING_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_MODEL_AVERAGING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "model_averaging.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename OptimizerType, typename CommunicatorType>
+ModelAveraging<OptimizerType, CommunicatorType>::ModelAveraging(
+    const OptimizerType& optimizer,
+    const size_t maxRounds,
+    const double tolerance,
+    const CommunicatorType& communicator) :
+    optimizer(optimizer),
+    maxRounds(maxRounds),
+    tolerance(tolerance),
+    communicator(communicator)
+{ /* Nothing to do. */ }
+
+template<typename OptimizerType, typename CommunicatorType>
+template<typename DecomposableFunctionType>
+double ModelAveraging<OptimizerType, CommunicatorType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate)
+{
+  // All nodes start from the same point.
+  communicator.Broadcast(iterate);
+
+  // The models are weighted by the number of points of each node.
+  const size_t numFunctions = function.NumFunctions();
+  arma::mat totalFunctions(1, 1);
+  totalFunctions(0, 0) = (double) numFunctions;
+  communicator.AllReduceSum(totalFunctions);
+  if (totalFunctions(0, 0) == 0)
+  {
+    throw std::invalid_argument("ModelAveraging::Optimize(): the function has "
+        "no points on any node");
+  }
+
+  double overallObjective = std::numeric_limits<double>::max();
+  double lastObjective = std::numeric_limits<double>::max();
+  for (size_t i = 1; i != maxRounds + 1; ++i)
+  {
+    optimizer.Optimize(function, iterate);
+
+    // Average the models of all nodes.
+    iterate *= (double) numFunctions;
+    communicator.AllReduceSum(iterate);
+    iterate /= totalFunctions(0, 0);
+
+    // The objective of the averaged model over all shards is the same on all
+    // nodes, so they all take the same decisions below.
+    arma::mat objective(1, 1);
+    objective(0, 0) = (numFunctions == 0) ? 0.0 :
+        EvaluateBatch(function, iterate, 0, numFunctions);
+    communicator.AllReduceSum(objective);
+    overallObjective = objective(0, 0);
+
+    Log::Info << "ModelAveraging: round " << i << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "ModelAveraging: converged to " << overallObjective
+          << "; terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "ModelAveraging: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    lastObjective = overallObjective;
+  }
+
+  Log::Info << "ModelAveraging: maximum rounds (" << maxRounds << ") reached; "
+      << "terminating optimization." << std::endl;
+
+  return overallObjective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file mpi_communicator.hpp
+ *
+ * Definition of the MPICommunicator class, which lets ModelAveraging
+ * communicate between MPI processes.  It is only available if mlpack is built
+ * with MPI support (the USE_MPI CMake option).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_MPI_COMMUNICATOR_HPP
+#define MLPACK_CORE_OPTIMIZERS_MODEL_AVERAGING_MPI_COMMUNICATOR_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef HAS_MPI
+
+#include <mpi.h>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * A communicator (see LocalCommunicator) for the processes of an MPI
+ * communicator, each of which is a node.  MPI must be initialized (with
+ * MPI_Init()) before the communicator is used, and every process must call
+ * the operations in the same order.  The matrices must have the same size on
+ * all processes.
+ */
+class MPICommunicator
+{
+ public:
+  /**
+   * Create the communicator for the processes of the given MPI communicator.
+   *
+   * @param comm The MPI communicator.
+   */
+  MPICommunicator(MPI_Comm comm = MPI_COMM_WORLD) : comm(comm) { }
+
+  //! Get the index of this process.
+  size_t Rank() const
+  {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    return (size_t) rank;
+  }
+
+  //! Get the number of processes.
+  size_t Size() const
+  {
+    int size;
+    MPI_Comm_size(comm, &size);
+    return (size_t) size;
+  }
+
+  //! Replace the given matrix with the sum of the matrices of all processes.
+  void AllReduceSum(arma::mat& m)
+  {
+    MPI_Allreduce(MPI_IN_PLACE, m.memptr(), (int) m.n_elem, MPI_DOUBLE,
+        MPI_SUM, comm);
+  }
+
+  //! Replace the given matrix with the matrix of the first process.
+  void Broadcast(arma::mat& m)
+  {
+    MPI_Bcast(m.memptr(), (int) m.n_elem, MPI_DOUBLE, 0, comm);
+  }
+
+  //! Get the MPI communicator.
+  MPI_Comm Comm() const { return comm; }
+
+ private:
+  //! The MPI communicator.
+  MPI_Comm comm;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif // HAS_MPI
+
+#endif
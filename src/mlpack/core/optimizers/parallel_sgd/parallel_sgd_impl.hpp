@@ -45,6 +45,11 @@ double ParallelSGD<DecayPolicyType>::Optimize(
   arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
       (function.NumFunctions() - 1), function.NumFunctions());
 
+  // With deterministic reductions, the shares of all threads are processed in
+  // order by one thread, so that the atomic updates happen in a fixed order.
+  const size_t threads = ParallelThreads();
+  const size_t updateThreads = DeterministicReductions() ? 1 : threads;
+
   // Iterate till the objective is within tolerance or the maximum number of
   // allowed iterations is reached. If maxIterations is 0, this will iterate
   // till convergence.
@@ -85,14 +90,12 @@ double ParallelSGD<DecayPolicyType>::Optimize(
           mlpack::math::randGen);
     }
 
-    #pragma omp parallel
+    #pragma omp parallel for num_threads(updateThreads) schedule(static, 1)
+    for (omp_size_t t = 0; t < (omp_size_t) threads; ++t)
     {
       // Each processor gets a subset of the instances.
       // Each subset is of size threadShareSize
-      size_t threadId = 0;
-      #ifdef HAS_OPENMP
-        threadId = omp_get_thread_num();
-      #endif
+      const size_t threadId = (size_t) t;
 
       for (size_t j = threadId * threadShareSize;
           j < (threadId + 1) * threadShareSize && j < visitationOrder.n_elem;
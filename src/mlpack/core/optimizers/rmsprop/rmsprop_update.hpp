@@ -54,7 +54,8 @@ class RMSPropUpdate
   RMSPropUpdate(const double epsilon = 1e-8,
                 const double alpha = 0.99) :
     epsilon(epsilon),
-    alpha(alpha)
+    alpha(alpha),
+    iteration(0)
   {
     // Nothing to do.
   }
@@ -70,6 +71,9 @@ class RMSPropUpdate
   {
     // Leaky sum of squares of parameter gradient.
     meanSquaredGradient = arma::zeros<arma::mat>(rows, cols);
+
+    iteration = 0;
+    lastUpdate.reset();
   }
 
   /**
@@ -83,12 +87,52 @@ class RMSPropUpdate
               const double stepSize,
               const arma::mat& gradient)
   {
+    ++iteration;
+    if (!lastUpdate.is_empty())
+      lastUpdate.fill(iteration);
+
     meanSquaredGradient *= alpha;
     meanSquaredGradient += (1 - alpha) * (gradient % gradient);
     iterate -= stepSize * gradient / (arma::sqrt(meanSquaredGradient) +
         epsilon);
   }
 
+  /**
+   * Update step for RMSProp with a sparse gradient.  Only the nonzero
+   * coordinates of the gradient are touched; the decay of the other
+   * coordinates is caught up with when they are touched next, so the result is
+   * the same as for the dense update, up to rounding.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The sparse gradient matrix.
+   */
+  void Update(arma::mat& iterate,
+              const double stepSize,
+              const arma::sp_mat& gradient)
+  {
+    // Remember when each coordinate last decayed.
+    if (lastUpdate.is_empty())
+    {
+      lastUpdate.set_size(arma::size(meanSquaredGradient));
+      lastUpdate.fill(iteration);
+    }
+
+    ++iteration;
+    for (arma::sp_mat::const_iterator it = gradient.begin();
+        it != gradient.end(); ++it)
+    {
+      double& meanSquared = meanSquaredGradient(it.row(), it.col());
+      double& last = lastUpdate(it.row(), it.col());
+      meanSquared *= std::pow(alpha, iteration - last);
+      meanSquared += (1 - alpha) * (*it) * (*it);
+      last = iteration;
+
+      iterate(it.row(), it.col()) -= stepSize * (*it) /
+          (std::sqrt(meanSquared) + epsilon);
+    }
+  }
+
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
   //! Modify the value used to initialise the squared gradient parameter.
@@ -108,6 +152,13 @@ class RMSPropUpdate
 
   // Leaky sum of squares of parameter gradient.
   arma::mat meanSquaredGradient;
+
+  // The number of iterations.
+  double iteration;
+
+  // The iteration at which each coordinate last decayed; only used for sparse
+  // gradients.
+  arma::mat lastUpdate;
 };
 
 } // namespace optimization
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_OPTIMIZERS_SA_SA_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 #include "exponential_schedule.hpp"
 
@@ -55,6 +56,19 @@ namespace optimization {
  * which returns the next temperature given current temperature and the value
  * of the function being optimized.
  *
+ * Optionally, several chains can be run at once on separate threads, in the
+ * style of parallel tempering.  Chain k starts at temperature
+ * initT * temperatureRatio^k and is cooled by its own copy of the cooling
+ * schedule.  Every exchangeInterval moves, neighbouring chains swap their
+ * states with the probability
+ * min{1, exp((E_k - E_{k + 1}) (1 / T_k - 1 / T_{k + 1}))}, so good states
+ * found by the hot chains move down to the cold chains.  Each chain has its
+ * own random number generator, seeded from math::randGen, so the result does
+ * not depend on the scheduling of the threads; Evaluate() must be safe to call
+ * from several threads at once.  The optimization ends when the coldest chain
+ * freezes or maxIterations moves per chain are reached, and the best final
+ * state of all chains is returned.
+ *
  * @tparam CoolingScheduleType type for cooling schedule
  */
 template<typename CoolingScheduleType = ExponentialSchedule>
@@ -76,6 +90,12 @@ class SA
    * @param maxMoveCoef Maximum move size.
    * @param initMoveCoef Initial move size.
    * @param gain Proportional control in feedback move control.
+   * @param numChains Number of chains that are run in parallel (1 gives the
+   *    usual single-chain simulated annealing).
+   * @param exchangeInterval Number of moves per chain between two state
+   *    exchanges.
+   * @param temperatureRatio Ratio of the initial temperatures of neighbouring
+   *    chains.
    */
   SA(CoolingScheduleType& coolingSchedule,
      const size_t maxIterations = 1000000,
@@ -86,7 +106,10 @@ class SA
      const size_t maxToleranceSweep = 3,
      const double maxMoveCoef = 20,
      const double initMoveCoef = 0.3,
-     const double gain = 0.3);
+     const double gain = 0.3,
+     const size_t numChains = 1,
+     const size_t exchangeInterval = 1000,
+     const double temperatureRatio = 2.0);
 
   /**
    * Optimize the given function using simulated annealing. The given starting
@@ -136,6 +159,21 @@ class SA
   //! Modify the maximum number of iterations.
   size_t& MaxIterations() { return maxIterations; }
 
+  //! Get the number of chains.
+  size_t NumChains() const { return numChains; }
+  //! Modify the number of chains.
+  size_t& NumChains() { return numChains; }
+
+  //! Get the number of moves per chain between two state exchanges.
+  size_t ExchangeInterval() const { return exchangeInterval; }
+  //! Modify the number of moves per chain between two state exchanges.
+  size_t& ExchangeInterval() { return exchangeInterval; }
+
+  //! Get the ratio of the initial temperatures of neighbouring chains.
+  double TemperatureRatio() const { return temperatureRatio; }
+  //! Modify the ratio of the initial temperatures of neighbouring chains.
+  double& TemperatureRatio() { return temperatureRatio; }
+
  private:
   //! The cooling schedule being used.
   CoolingScheduleType& coolingSchedule;
@@ -157,6 +195,23 @@ class SA
   double initMoveCoef;
   //! Proportional control in feedback move control.
   double gain;
+  //! The number of chains.
+  size_t numChains;
+  //! The number of moves per chain between two state exchanges.
+  size_t exchangeInterval;
+  //! The ratio of the initial temperatures of neighbouring chains.
+  double temperatureRatio;
+
+  /**
+   * Run numChains chains in parallel with state exchanges; see the class
+   * documentation.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  template<typename FunctionType>
+  double OptimizeChains(FunctionType& function, arma::mat& iterate);
 
   /**
    * GenerateMove proposes a move on element iterate(idx), and determines if
@@ -173,6 +228,8 @@ class SA
    * @param idx Current parameter to modify.
    * @param sweepCounter Current counter representing how many sweeps have been
    *      completed.
+   * @param currentTemperature Current temperature of the system.
+   * @param generator Random number generator to use.
    */
   template<typename FunctionType>
   void GenerateMove(FunctionType& function,
@@ -181,7 +238,9 @@ class SA
                     arma::mat& moveSize,
                     double& energy,
                     size_t& idx,
-                    size_t& sweepCounter);
+                    size_t& sweepCounter,
+                    const double currentTemperature,
+                    std::mt19937& generator);
 
   /**
    * MoveControl() uses a proportional feedback control to determine the size
@@ -28,7 +28,10 @@ SA<CoolingScheduleType>::SA(
     const size_t maxToleranceSweep,
     const double maxMoveCoef,
     const double initMoveCoef,
-    const double gain) :
+    const double gain,
+    const size_t numChains,
+    const size_t exchangeInterval,
+    const double temperatureRatio) :
     coolingSchedule(coolingSchedule),
     maxIterations(maxIterations),
     temperature(initT),
@@ -38,9 +41,18 @@ SA<CoolingScheduleType>::SA(
     maxToleranceSweep(maxToleranceSweep),
     maxMoveCoef(maxMoveCoef),
     initMoveCoef(initMoveCoef),
-    gain(gain)
+    gain(gain),
+    numChains(numChains),
+    exchangeInterval(exchangeInterval),
+    temperatureRatio(temperatureRatio)
 {
-  // Nothing to do.
+  if (numChains == 0)
+    throw std::invalid_argument("SA::SA(): the number of chains must be "
+        "positive");
+
+  if (exchangeInterval == 0)
+    throw std::invalid_argument("SA::SA(): the exchange interval must be "
+        "positive");
 }
 
 //! Optimize the function (minimize).
@@ -49,6 +61,9 @@ template<typename FunctionType>
 double SA<CoolingScheduleType>::Optimize(FunctionType& function,
                                          arma::mat& iterate)
 {
+  if (numChains > 1)
+    return OptimizeChains(function, iterate);
+
   const size_t rows = iterate.n_rows;
   const size_t cols = iterate.n_cols;
 
@@ -66,14 +81,14 @@ double SA<CoolingScheduleType>::Optimize(FunctionType& function,
   // Initial moves to get rid of dependency of initial states.
   for (size_t i = 0; i < initMoves; ++i)
     GenerateMove(function, iterate, accept, moveSize, energy, idx,
-        sweepCounter);
+        sweepCounter, temperature, math::randGen);
 
   // Iterating and cooling.
   for (size_t i = 0; i != maxIterations; ++i)
   {
     oldEnergy = energy;
     GenerateMove(function, iterate, accept, moveSize, energy, idx,
-        sweepCounter);
+        sweepCounter, temperature, math::randGen);
     temperature = coolingSchedule.NextTemperature(temperature, energy);
 
     // Determine if the optimization has entered (or continues to be in) a
@@ -98,6 +113,110 @@ double SA<CoolingScheduleType>::Optimize(FunctionType& function,
   return energy;
 }
 
+//! Optimize the function (minimize) with several chains.
+template<typename CoolingScheduleType>
+template<typename FunctionType>
+double SA<CoolingScheduleType>::OptimizeChains(FunctionType& function,
+                                               arma::mat& iterate)
+{
+  // The state of each chain.  Chain 0 is the coldest one.
+  std::vector<arma::mat> iterates(numChains, iterate);
+  std::vector<arma::mat> accepts(numChains,
+      arma::zeros<arma::mat>(iterate.n_rows, iterate.n_cols));
+  std::vector<arma::mat> moveSizes(numChains,
+      initMoveCoef * arma::ones<arma::mat>(iterate.n_rows, iterate.n_cols));
+  std::vector<CoolingScheduleType> schedules(numChains, coolingSchedule);
+  std::vector<std::mt19937> generators(numChains);
+  std::vector<size_t> idxs(numChains, 0), sweepCounters(numChains, 0);
+  std::vector<size_t> frozenCounts(numChains, 0);
+  arma::vec temperatures(numChains), energies(numChains);
+
+  const double initEnergy = function.Evaluate(iterate);
+  for (size_t k = 0; k < numChains; ++k)
+  {
+    generators[k].seed(math::randGen());
+    temperatures[k] = temperature * std::pow(temperatureRatio, (double) k);
+    energies[k] = initEnergy;
+  }
+
+  // Initial moves to get rid of dependency of initial states.
+  #pragma omp parallel for
+  for (omp_size_t k = 0; k < (omp_size_t) numChains; ++k)
+  {
+    for (size_t i = 0; i < initMoves; ++i)
+    {
+      GenerateMove(function, iterates[k], accepts[k], moveSizes[k],
+          energies[k], idxs[k], sweepCounters[k], temperatures[k],
+          generators[k]);
+    }
+  }
+
+  const size_t frozenLimit = maxToleranceSweep * moveCtrlSweep *
+      iterate.n_elem;
+  std::uniform_real_distribution<> uniform;
+  bool frozen = false;
+  size_t i = 0;
+  while (i != maxIterations && !frozen)
+  {
+    // Let each chain make its moves until the next exchange.
+    const size_t moves = std::min(exchangeInterval, maxIterations - i);
+
+    #pragma omp parallel for
+    for (omp_size_t k = 0; k < (omp_size_t) numChains; ++k)
+    {
+      for (size_t j = 0; j < moves; ++j)
+      {
+        const double oldEnergy = energies[k];
+        GenerateMove(function, iterates[k], accepts[k], moveSizes[k],
+            energies[k], idxs[k], sweepCounters[k], temperatures[k],
+            generators[k]);
+        temperatures[k] = schedules[k].NextTemperature(temperatures[k],
+            energies[k]);
+
+        if (std::abs(energies[k] - oldEnergy) < tolerance)
+          ++frozenCounts[k];
+        else
+          frozenCounts[k] = 0;
+      }
+    }
+    i += moves;
+
+    if (frozenCounts[0] >= frozenLimit)
+    {
+      Log::Debug << "SA: coldest chain minimized within tolerance "
+          << tolerance << " for " << maxToleranceSweep << " sweeps after " << i
+          << " iterations; terminating optimization." << std::endl;
+      frozen = true;
+    }
+
+    // Exchange the states of neighbouring chains, alternating between the even
+    // and the odd pairs.
+    const size_t first = (i / exchangeInterval) % 2;
+    for (size_t k = first; k + 1 < numChains; k += 2)
+    {
+      const double criterion = std::exp((energies[k] - energies[k + 1]) *
+          (1.0 / temperatures[k] - 1.0 / temperatures[k + 1]));
+      if (criterion >= 1.0 || uniform(math::randGen) < criterion)
+      {
+        iterates[k].swap(iterates[k + 1]);
+        std::swap(energies[k], energies[k + 1]);
+      }
+    }
+  }
+
+  if (!frozen)
+  {
+    Log::Debug << "SA: maximum iterations (" << maxIterations << ") reached; "
+        << "terminating optimization." << std::endl;
+  }
+
+  arma::uword best;
+  energies.min(best);
+  iterate = iterates[best];
+  temperature = temperatures[0];
+  return energies[best];
+}
+
 /**
  * GenerateMove proposes a move on element iterate(idx), and determines
  * it that move is acceptable or not according to the Metropolis criterion.
@@ -115,7 +234,9 @@ void SA<CoolingScheduleType>::GenerateMove(
     arma::mat& moveSize,
     double& energy,
     size_t& idx,
-    size_t& sweepCounter)
+    size_t& sweepCounter,
+    const double currentTemperature,
+    std::mt19937& generator)
 {
   const double prevEnergy = energy;
   const double prevValue = iterate(idx);
@@ -125,7 +246,8 @@ void SA<CoolingScheduleType>::GenerateMove(
   // MoveControl() is derived for the Laplace distribution.
 
   // Sample from a Laplace distribution with scale parameter moveSize(idx).
-  const double unif = 2.0 * math::Random() - 1.0;
+  std::uniform_real_distribution<> uniform;
+  const double unif = 2.0 * uniform(generator) - 1.0;
   const double move = (unif < 0) ? (moveSize(idx) * std::log(1 + unif)) :
       (-moveSize(idx) * std::log(1 - unif));
 
@@ -133,9 +255,9 @@ void SA<CoolingScheduleType>::GenerateMove(
   energy = function.Evaluate(iterate);
   // According to the Metropolis criterion, accept the move with probability
   // min{1, exp(-(E_new - E_old) / T)}.
-  const double xi = math::Random();
+  const double xi = uniform(generator);
   const double delta = energy - prevEnergy;
-  const double criterion = std::exp(-delta / temperature);
+  const double criterion = std::exp(-delta / currentTemperature);
   if (delta <= 0. || criterion > xi)
   {
     accept(idx) += 1.;
@@ -55,6 +55,25 @@ namespace optimization {
  *  variable and PartialGradient is used to evaluate the partial gradient with
  *  respect to the jth feature.
  *
+ *  Optionally, several coordinates can be updated in each iteration, as in the
+ *  Shotgun algorithm; their partial gradients are computed in parallel at the
+ *  same point, so PartialGradient() must then be safe to call from several
+ *  threads at once.  This gives nearly linear speedups as long as the chosen
+ *  features are only weakly correlated; see
+ *
+ * @code
+ * @inproceedings{Bradley2011,
+ *   author    = {Bradley, Joseph K. and Kyrola, Aapo and Bickson, Danny and
+ *                Guestrin, Carlos},
+ *   title     = {Parallel Coordinate Descent for L1-Regularized Loss
+ *                Minimization},
+ *   booktitle = {Proceedings of the 28th International Conference on Machine
+ *                Learning},
+ *   series    = {ICML '11},
+ *   year      = {2011}
+ * }
+ * @endcode
+ *
  *  @tparam DescentPolicy Descent policy to decide the order in which the
  *      coordinate for descent is selected.
  */
@@ -78,12 +97,16 @@ class SCD
    *    reported and checked for convergence.
    * @param descentPolicy The policy to use for picking up the coordinate to
    *    descend on.
+   * @param parallelUpdates The number of coordinates that are updated in
+   *    parallel in each iteration; the descent policy is asked for this many
+   *    coordinates, and repeated coordinates are only updated once.
    */
   SCD(const double stepSize = 0.01,
       const size_t maxIterations = 100000,
       const double tolerance = 1e-5,
       const size_t updateInterval = 1e3,
-      const DescentPolicyType descentPolicy = DescentPolicyType());
+      const DescentPolicyType descentPolicy = DescentPolicyType(),
+      const size_t parallelUpdates = 1);
 
   /**
    * Optimize the given function using stochastic coordinate descent. The
@@ -118,6 +141,11 @@ class SCD
   //! Modify the update interval for reporting objective.
   size_t& UpdateInterval() { return updateInterval; }
 
+  //! Get the number of coordinates updated in parallel in each iteration.
+  size_t ParallelUpdates() const { return parallelUpdates; }
+  //! Modify the number of coordinates updated in parallel in each iteration.
+  size_t& ParallelUpdates() { return parallelUpdates; }
+
   //! Get the descent policy.
   DescentPolicyType DescentPolicy() const { return descentPolicy; }
   //! Modify the descent policy.
@@ -138,6 +166,9 @@ class SCD
 
   //! The descent policy used to pick the coordinates for the update.
   DescentPolicyType descentPolicy;
+
+  //! The number of coordinates updated in parallel in each iteration.
+  size_t parallelUpdates;
 };
 
 } // namespace optimization
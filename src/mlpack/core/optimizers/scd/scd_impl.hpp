@@ -24,13 +24,21 @@ SCD<DescentPolicyType>::SCD(
     const size_t maxIterations,
     const double tolerance,
     const size_t updateInterval,
-    const DescentPolicyType descentPolicy) :
+    const DescentPolicyType descentPolicy,
+    const size_t parallelUpdates) :
     stepSize(stepSize),
     maxIterations(maxIterations),
     tolerance(tolerance),
     updateInterval(updateInterval),
-    descentPolicy(descentPolicy)
-{ /* Nothing to do */ }
+    descentPolicy(descentPolicy),
+    parallelUpdates(parallelUpdates)
+{
+  if (parallelUpdates == 0)
+  {
+    throw std::invalid_argument("SCD::SCD(): the number of parallel updates "
+        "must be positive");
+  }
+}
 
 //! Optimize the function (minimize).
 template <typename DescentPolicyType>
@@ -42,18 +50,47 @@ double SCD<DescentPolicyType>::Optimize(ResolvableFunctionType& function,
   double lastObjective = DBL_MAX;
 
   arma::sp_mat gradient;
+  std::vector<size_t> features;
+  std::vector<arma::sp_mat> gradients(parallelUpdates);
 
   // Start iterating.
   for (size_t i = 1; i != maxIterations; ++i)
   {
-    // Get the coordinate to descend on.
-    size_t featureIdx = descentPolicy.DescentFeature(i, iterate, function);
+    if (parallelUpdates == 1)
+    {
+      // Get the coordinate to descend on.
+      size_t featureIdx = descentPolicy.DescentFeature(i, iterate, function);
 
-    // Get the partial gradient with respect to this feature.
-    function.PartialGradient(iterate, featureIdx, gradient);
+      // Get the partial gradient with respect to this feature.
+      function.PartialGradient(iterate, featureIdx, gradient);
 
-    // Update the decision variable with the partial gradient.
-    iterate.col(featureIdx) -= stepSize * gradient.col(featureIdx);
+      // Update the decision variable with the partial gradient.
+      iterate.col(featureIdx) -= stepSize * gradient.col(featureIdx);
+    }
+    else
+    {
+      // Get the coordinates to descend on.  The policy sees consecutive
+      // iteration numbers for them, so that CyclicDescent walks through the
+      // features in blocks.
+      features.clear();
+      for (size_t p = 0; p < parallelUpdates; ++p)
+      {
+        features.push_back(descentPolicy.DescentFeature(
+            (i - 1) * parallelUpdates + p + 1, iterate, function));
+      }
+      std::sort(features.begin(), features.end());
+      features.erase(std::unique(features.begin(), features.end()),
+          features.end());
+
+      // Get the partial gradients at the current point in parallel.
+      #pragma omp parallel for
+      for (omp_size_t p = 0; p < (omp_size_t) features.size(); ++p)
+        function.PartialGradient(iterate, features[p], gradients[p]);
+
+      // Now update each of the (distinct) coordinates.
+      for (size_t p = 0; p < features.size(); ++p)
+        iterate.col(features[p]) -= stepSize * gradients[p].col(features[p]);
+    }
 
     // Check for convergence.
     if (i % updateInterval == 0)
@@ -85,8 +85,40 @@ class LRSDPFunction
   //! Return the SDP object representing the problem.
   const SDPType& SDP() const { return sdp; }
 
-  //! Modify the SDP object representing the problem.
-  SDPType& SDP() { return sdp; }
+  //! Modify the SDP object representing the problem.  The packed sparse
+  //! constraints are built again the next time they are needed.
+  SDPType& SDP() { packed = false; return sdp; }
+
+  /**
+   * Pack the nonzero entries of all of the sparse constraint matrices into one
+   * coordinate list, sorted in column-major order, which is what
+   * EvaluateSparseConstraints() and SparseConstraintSum() work on.  This is
+   * done automatically the first time the list is needed after the SDP has been
+   * modified, and by LRSDP::Optimize().  A std::invalid_argument exception is
+   * thrown if the sizes of the sparse constraints do not match the SDP.
+   */
+  void PackConstraints() const;
+
+  /**
+   * Evaluate all of the sparse constraints, Tr(A_i * (R R^T)) - b_i, at the
+   * given coordinates at once.  Only the entries of R R^T at the nonzero
+   * entries of the constraint matrices are computed (in parallel), so R R^T is
+   * never formed.
+   *
+   * @param coordinates The coordinates R.
+   * @param values Vector to store the value of each sparse constraint in.
+   */
+  void EvaluateSparseConstraints(const arma::mat& coordinates,
+                                 arma::vec& values) const;
+
+  /**
+   * Compute sum_i weights_i A_i over the sparse constraints, as one sparse
+   * matrix.
+   *
+   * @param weights The weight of each sparse constraint.
+   * @param sum Matrix to store the sum in.
+   */
+  void SparseConstraintSum(const arma::vec& weights, arma::sp_mat& sum) const;
 
  private:
   //! SDP object representing the problem
@@ -94,6 +126,16 @@ class LRSDPFunction
 
   //! Initial point.
   arma::mat initialPoint;
+
+  //! Whether the packed sparse constraints match the SDP.
+  mutable bool packed;
+  //! The locations of the nonzero entries of the sparse constraints (the rows
+  //! in the first row and the columns in the second), in column-major order.
+  mutable arma::umat packedLocations;
+  //! The values of the nonzero entries of the sparse constraints.
+  mutable arma::vec packedValues;
+  //! The index of the constraint of each nonzero entry.
+  mutable arma::uvec packedConstraints;
 };
 
 // Declare specializations in lrsdp_function.cpp.
@@ -115,6 +157,18 @@ inline void AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::Gradient(
     const arma::mat& coordinates,
     arma::mat& gradient) const;
 
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const;
+
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const;
+
 } // namespace optimization
 } // namespace mlpack
 
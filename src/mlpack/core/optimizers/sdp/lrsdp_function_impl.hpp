@@ -23,7 +23,8 @@ template <typename SDPType>
 LRSDPFunction<SDPType>::LRSDPFunction(const SDPType& sdp,
                                       const arma::mat& initialPoint):
     sdp(sdp),
-    initialPoint(initialPoint)
+    initialPoint(initialPoint),
+    packed(false)
 {
   if (initialPoint.n_rows < initialPoint.n_cols)
     Log::Warn << "LRSDPFunction::LRSDPFunction(): solution matrix will have "
@@ -36,7 +37,8 @@ LRSDPFunction<SDPType>::LRSDPFunction(const size_t numSparseConstraints,
                                       const size_t numDenseConstraints,
                                       const arma::mat& initialPoint):
     sdp(initialPoint.n_rows, numSparseConstraints, numDenseConstraints),
-    initialPoint(initialPoint)
+    initialPoint(initialPoint),
+    packed(false)
 {
   if (initialPoint.n_rows < initialPoint.n_cols)
     Log::Warn << "LRSDPFunction::LRSDPFunction(): solution matrix will have "
@@ -47,8 +49,8 @@ LRSDPFunction<SDPType>::LRSDPFunction(const size_t numSparseConstraints,
 template <typename SDPType>
 double LRSDPFunction<SDPType>::Evaluate(const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
-  return accu(SDP().C() % rrt);
+  // Tr(C * (R R^T)) = Tr((C R)^T R), which does not need R R^T.
+  return accu((SDP().C() * coordinates) % coordinates);
 }
 
 template <typename SDPType>
@@ -64,11 +66,21 @@ double LRSDPFunction<SDPType>::EvaluateConstraint(
     const size_t index,
     const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
   if (index < SDP().NumSparseConstraints())
-    return accu(SDP().SparseA()[index] % rrt) - SDP().SparseB()[index];
+  {
+    // Only the entries of R R^T where A_i is nonzero are needed.
+    const arma::sp_mat& a = SDP().SparseA()[index];
+    double value = 0.0;
+    for (arma::sp_mat::const_iterator it = a.begin(); it != a.end(); ++it)
+    {
+      value += (*it) * arma::dot(coordinates.row(it.row()),
+          coordinates.row(it.col()));
+    }
+    return value - SDP().SparseB()[index];
+  }
   const size_t index1 = index - SDP().NumSparseConstraints();
-  return accu(SDP().DenseA()[index1] % rrt) - SDP().DenseB()[index1];
+  return accu((SDP().DenseA()[index1] * coordinates) % coordinates) -
+      SDP().DenseB()[index1];
 }
 
 template <typename SDPType>
@@ -81,104 +93,164 @@ void LRSDPFunction<SDPType>::GradientConstraint(
       << "for arbitrary optimizers!" << std::endl;
 }
 
-//! Utility function for calculating part of the objective when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
-static inline void
-UpdateObjective(double& objective,
-                const arma::mat& rrt,
-                const std::vector<MatrixType>& ais,
-                const arma::vec& bis,
-                const arma::vec& lambda,
-                const size_t lambdaOffset,
-                const double sigma)
+template <typename SDPType>
+void LRSDPFunction<SDPType>::PackConstraints() const
 {
-  for (size_t i = 0; i < ais.size(); ++i)
+  const std::vector<arma::sp_mat>& sparseA = sdp.SparseA();
+  const size_t n = sdp.N();
+  if (sparseA.size() != sdp.NumSparseConstraints())
   {
-    // Take the trace subtracted by the b_i.
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    objective -= (lambda[lambdaOffset + i] * constraint);
-    objective += (sigma / 2.) * constraint * constraint;
+    std::ostringstream oss;
+    oss << "LRSDPFunction::PackConstraints(): there are " << sparseA.size()
+        << " sparse constraint matrices, but " << sdp.NumSparseConstraints()
+        << " sparse b values";
+    throw std::invalid_argument(oss.str());
+  }
+
+  size_t nonzeros = 0;
+  for (size_t i = 0; i < sparseA.size(); ++i)
+  {
+    if (sparseA[i].n_rows != n || sparseA[i].n_cols != n)
+    {
+      std::ostringstream oss;
+      oss << "LRSDPFunction::PackConstraints(): sparse constraint matrix " << i
+          << " is " << sparseA[i].n_rows << "x" << sparseA[i].n_cols
+          << ", but C is " << n << "x" << n;
+      throw std::invalid_argument(oss.str());
+    }
+    nonzeros += sparseA[i].n_nonzero;
   }
+
+  // Collect the entries of all the constraints, then sort them in column-major
+  // order so that their weighted sum can be built in linear time.
+  arma::umat locations(2, nonzeros);
+  arma::vec values(nonzeros);
+  arma::uvec constraints(nonzeros);
+  arma::uvec keys(nonzeros);
+  size_t k = 0;
+  for (size_t i = 0; i < sparseA.size(); ++i)
+  {
+    for (arma::sp_mat::const_iterator it = sparseA[i].begin();
+         it != sparseA[i].end(); ++it, ++k)
+    {
+      locations(0, k) = it.row();
+      locations(1, k) = it.col();
+      values[k] = *it;
+      constraints[k] = i;
+      keys[k] = it.col() * n + it.row();
+    }
+  }
+
+  const arma::uvec order = arma::stable_sort_index(keys);
+  packedLocations = locations.cols(order);
+  packedValues = values.elem(order);
+  packedConstraints = constraints.elem(order);
+  packed = true;
 }
 
-//! Utility function for calculating part of the gradient when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
-static inline void
-UpdateGradient(arma::mat& s,
-               const arma::mat& rrt,
-               const std::vector<MatrixType>& ais,
-               const arma::vec& bis,
-               const arma::vec& lambda,
-               const size_t lambdaOffset,
-               const double sigma)
+template <typename SDPType>
+void LRSDPFunction<SDPType>::EvaluateSparseConstraints(
+    const arma::mat& coordinates,
+    arma::vec& values) const
 {
-  for (size_t i = 0; i < ais.size(); ++i)
+  if (!packed)
+    PackConstraints();
+
+  // Gather the needed entries of R R^T, as dot products of the columns of R^T,
+  // which are contiguous.
+  const arma::mat rt = trans(coordinates);
+  const size_t rank = rt.n_rows;
+  arma::vec products(packedValues.n_elem);
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t k = 0; k < (omp_size_t) packedValues.n_elem; ++k)
   {
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    const double y = lambda[lambdaOffset + i] - sigma * constraint;
-    s -= y * ais[i];
+    const double* a = rt.colptr(packedLocations(0, k));
+    const double* b = rt.colptr(packedLocations(1, k));
+    double product = 0.0;
+    for (size_t d = 0; d < rank; ++d)
+      product += a[d] * b[d];
+    products[k] = packedValues[k] * product;
   }
+
+  values = -sdp.SparseB();
+  for (size_t k = 0; k < products.n_elem; ++k)
+    values[packedConstraints[k]] += products[k];
 }
 
 template <typename SDPType>
-static inline double
-EvaluateImpl(const LRSDPFunction<SDPType>& function,
-             const arma::mat& coordinates,
-             const arma::vec& lambda,
-             const double sigma)
+void LRSDPFunction<SDPType>::SparseConstraintSum(const arma::vec& weights,
+                                                 arma::sp_mat& sum) const
 {
-  // We can calculate the entire objective in a smart way.
-  // L(R, y, s) = Tr(C * (R R^T)) -
-  //     sum_{i = 1}^{m} (y_i (Tr(A_i * (R R^T)) - b_i)) +
-  //     (sigma / 2) * sum_{i = 1}^{m} (Tr(A_i * (R R^T)) - b_i)^2
-
-  // Let's start with the objective: Tr(C * (R R^T)).
-  // Simple, possibly slow solution-- see below for optimization opportunity
-  //
-  // TODO: Note that Tr(C^T * (R R^T)) = Tr( (CR)^T * R ), so
-  // multiplying C*R first, and then taking the trace dot should be more memory
-  // efficient
-  //
-  // Similarly for the constraints, taking A*R first should be more efficient
-  const arma::mat rrt = coordinates * trans(coordinates);
-  double objective = accu(function.SDP().C() % rrt);
+  if (!packed)
+    PackConstraints();
 
-  // Now each constraint.
-  UpdateObjective(objective, rrt, function.SDP().SparseA(),
-      function.SDP().SparseB(), lambda, 0, sigma);
-  UpdateObjective(objective, rrt, function.SDP().DenseA(),
-      function.SDP().DenseB(), lambda, function.SDP().NumSparseConstraints(),
-      sigma);
+  arma::vec sumValues(packedValues.n_elem);
+  for (size_t k = 0; k < packedValues.n_elem; ++k)
+    sumValues[k] = weights[packedConstraints[k]] * packedValues[k];
 
-  return objective;
+  // The locations are already sorted; entries at the same location are added.
+  sum = arma::sp_mat(true, packedLocations, sumValues, sdp.N(), sdp.N(), false,
+      false);
 }
 
 template <typename SDPType>
-static inline void
-GradientImpl(const LRSDPFunction<SDPType>& function,
+static inline double
+EvaluateImpl(const LRSDPFunction<SDPType>& function,
              const arma::mat& coordinates,
              const arma::vec& lambda,
              const double sigma,
-             arma::mat& gradient)
+             arma::mat* gradient)
 {
-  // We can calculate the gradient in a smart way.
+  // We can calculate the entire objective in a smart way.
+  // L(R, y, s) = Tr(C * (R R^T)) -
+  //     sum_{i = 1}^{m} (y_i (Tr(A_i * (R R^T)) - b_i)) +
+  //     (sigma / 2) * sum_{i = 1}^{m} (Tr(A_i * (R R^T)) - b_i)^2
+  // and the gradient is
   // L'(R, y, s) = 2 * S' * R
   //   with
   // S' = C - sum_{i = 1}^{m} y'_i A_i
-  // y'_i = y_i - sigma * (Trace(A_i * (R R^T)) - b_i)
-  const arma::mat rrt = coordinates * trans(coordinates);
-  arma::mat s(function.SDP().C());
+  // y'_i = y_i - sigma * (Trace(A_i * (R R^T)) - b_i).
+  //
+  // R R^T (and S') are never formed: Tr(C * (R R^T)) = Tr((C R)^T R), the
+  // sparse constraints only need the entries of R R^T where they are nonzero,
+  // and S' R is computed as C R - (sum_i y'_i A_i) R.
+  const arma::mat cr = function.SDP().C() * coordinates;
+  double objective = accu(cr % coordinates);
+  if (gradient)
+    *gradient = 2 * cr;
 
-  UpdateGradient(
-      s, rrt, function.SDP().SparseA(), function.SDP().SparseB(),
-      lambda, 0, sigma);
-  UpdateGradient(
-      s, rrt, function.SDP().DenseA(), function.SDP().DenseB(),
-      lambda, function.SDP().NumSparseConstraints(), sigma);
+  // The sparse constraints are evaluated all at once.
+  const size_t numSparse = function.SDP().NumSparseConstraints();
+  if (numSparse > 0)
+  {
+    arma::vec constraints;
+    function.EvaluateSparseConstraints(coordinates, constraints);
+    const arma::vec sparseLambda = lambda.subvec(0, numSparse - 1);
+    objective -= dot(sparseLambda, constraints);
+    objective += (sigma / 2.) * dot(constraints, constraints);
+
+    if (gradient)
+    {
+      arma::sp_mat ySum;
+      function.SparseConstraintSum(sparseLambda - sigma * constraints, ySum);
+      *gradient -= 2 * (ySum * coordinates);
+    }
+  }
+
+  // Now each dense constraint.
+  for (size_t i = 0; i < function.SDP().NumDenseConstraints(); ++i)
+  {
+    const arma::mat ar = function.SDP().DenseA()[i] * coordinates;
+    const double constraint = accu(ar % coordinates) -
+        function.SDP().DenseB()[i];
+    const double lambdaI = lambda[numSparse + i];
+    objective -= (lambdaI * constraint);
+    objective += (sigma / 2.) * constraint * constraint;
+    if (gradient)
+      *gradient -= 2 * (lambdaI - sigma * constraint) * ar;
+  }
 
-  gradient = 2 * s * coordinates;
+  return objective;
 }
 
 // Template specializations for function and gradient evaluation.
@@ -188,14 +260,16 @@ template <>
 inline double AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::Evaluate(
     const arma::mat& coordinates) const
 {
-  return EvaluateImpl(function, coordinates, lambda, sigma);
+  return EvaluateImpl(function, coordinates, lambda, sigma,
+      (arma::mat*) NULL);
 }
 
 template <>
 inline double AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::Evaluate(
     const arma::mat& coordinates) const
 {
-  return EvaluateImpl(function, coordinates, lambda, sigma);
+  return EvaluateImpl(function, coordinates, lambda, sigma,
+      (arma::mat*) NULL);
 }
 
 template <>
@@ -203,7 +277,7 @@ inline void AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::Gradient(
     const arma::mat& coordinates,
     arma::mat& gradient) const
 {
-  GradientImpl(function, coordinates, lambda, sigma, gradient);
+  EvaluateImpl(function, coordinates, lambda, sigma, &gradient);
 }
 
 template <>
@@ -211,7 +285,25 @@ inline void AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::Gradient(
     const arma::mat& coordinates,
     arma::mat& gradient) const
 {
-  GradientImpl(function, coordinates, lambda, sigma, gradient);
+  EvaluateImpl(function, coordinates, lambda, sigma, &gradient);
+}
+
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  return EvaluateImpl(function, coordinates, lambda, sigma, &gradient);
+}
+
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  return EvaluateImpl(function, coordinates, lambda, sigma, &gradient);
 }
 
 } // namespace optimization
@@ -30,6 +30,9 @@ LRSDP<SDPType>::LRSDP(const size_t numSparseConstraints,
 template <typename SDPType>
 double LRSDP<SDPType>::Optimize(arma::mat& coordinates)
 {
+  // The constraints may have been modified since the last optimization.
+  function.PackConstraints();
+
   augLag.Sigma() = 10;
   augLag.Optimize(function, coordinates, maxIterations);
 
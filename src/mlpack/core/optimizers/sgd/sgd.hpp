@@ -68,6 +68,11 @@ namespace optimization {
  * objective function on the first point in the dataset (presumably, the dataset
  * is held internally in the DecomposableFunctionType).
  *
+ * If the function also provides a Gradient() overload that takes an
+ * arma::sp_mat, and the update policy has an Update() overload for sparse
+ * gradients (as AdamUpdate, AdaGradUpdate and RMSPropUpdate do), the sparse
+ * gradients are used, so that each step only touches the nonzero coordinates.
+ *
  * @tparam UpdatePolicyType update policy used by SGD during the iterative update
  *     process. By default vanilla update policy (see
  *     mlpack::optimization::VanillaUpdate) is used.
@@ -94,13 +99,18 @@ class SGD
    *                     parameters.
    * @param resetPolicy Flag that determines whether update policy parameters
    *                    are reset before every Optimize call.
+   * @param exactObjective If true, the objective is evaluated over all
+   *     functions before the first pass and after the last iteration.  If
+   *     false, only the objectives computed for the gradient steps are used;
+   *     see ExactObjective().
    */
   SGD(const double stepSize = 0.01,
       const size_t maxIterations = 100000,
       const double tolerance = 1e-5,
       const bool shuffle = true,
       const UpdatePolicyType updatePolicy = UpdatePolicyType(),
-      const bool resetPolicy = true);
+      const bool resetPolicy = true,
+      const bool exactObjective = true);
 
   /**
    * Optimize the given function using stochastic gradient descent.  The given
@@ -108,13 +118,15 @@ class SGD
    * algorithm, and the final objective value is returned.
    *
    * @tparam DecomposableFunctionType Type of the function to be optimized.
+   * @tparam eT Element type of the iterate (e.g. float, to optimize a network
+   *     in single precision; the update policy must support it).
    * @param function Function to optimize.
    * @param iterate Starting point (will be modified).
    * @return Objective value of the final point.
    */
-  template<typename DecomposableFunctionType>
+  template<typename DecomposableFunctionType, typename eT>
   double Optimize(DecomposableFunctionType& function,
-                  arma::mat& iterate);
+                  arma::Mat<eT>& iterate);
 
   //! Get the step size.
   double StepSize() const { return stepSize; }
@@ -143,6 +155,19 @@ class SGD
   //! are reset before Optimize call.
   bool& ResetPolicy() { return resetPolicy; }
 
+  /**
+   * Get whether the objective is evaluated over all functions before the first
+   * pass and after the last iteration.  If not, the objective of a pass is the
+   * sum of the objectives computed for its gradient steps (each before its
+   * step), so no extra pass over the data is needed; the first pass is then
+   * not checked for convergence, and the returned objective is that sum for
+   * the last pass, extrapolated to all functions if the pass was incomplete.
+   */
+  bool ExactObjective() const { return exactObjective; }
+  //! Modify whether the objective is evaluated over all functions before the
+  //! first pass and after the last iteration.
+  bool& ExactObjective() { return exactObjective; }
+
   //! Get the update policy.
   const UpdatePolicyType& UpdatePolicy() const { return updatePolicy; }
   //! Modify the update policy.
@@ -168,6 +193,10 @@ class SGD
   //! Flag indicating whether update policy
   //! should be reset before running optimization.
   bool resetPolicy;
+
+  //! Whether the objective is evaluated over all functions before the first
+  //! pass and after the last iteration.
+  bool exactObjective;
 };
 
 using StandardSGD = SGD<VanillaUpdate>;
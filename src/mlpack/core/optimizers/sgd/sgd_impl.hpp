@@ -16,6 +16,8 @@
 
 #include <mlpack/methods/regularized_svd/regularized_svd_function.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/has_sparse_update.hpp>
+#include <mlpack/core/optimizers/function/evaluate_with_gradient.hpp>
 
 // In case it hasn't been included yet.
 #include "sgd.hpp"
@@ -30,21 +32,23 @@ SGD<UpdatePolicyType>::SGD(
     const double tolerance,
     const bool shuffle,
     const UpdatePolicyType updatePolicy,
-    const bool resetPolicy) :
+    const bool resetPolicy,
+    const bool exactObjective) :
     stepSize(stepSize),
     maxIterations(maxIterations),
     tolerance(tolerance),
     shuffle(shuffle),
     updatePolicy(updatePolicy),
-    resetPolicy(resetPolicy)
+    resetPolicy(resetPolicy),
+    exactObjective(exactObjective)
 { /* Nothing to do. */ }
 
 //! Optimize the function (minimize).
 template<typename UpdatePolicyType>
-template<typename DecomposableFunctionType>
+template<typename DecomposableFunctionType, typename eT>
 double SGD<UpdatePolicyType>::Optimize(
     DecomposableFunctionType& function,
-    arma::mat& iterate)
+    arma::Mat<eT>& iterate)
 {
   // Find the number of functions to use.
   const size_t numFunctions = function.NumFunctions();
@@ -62,41 +66,57 @@ double SGD<UpdatePolicyType>::Optimize(
   double overallObjective = 0;
   double lastObjective = DBL_MAX;
 
-  // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
+  // Calculate the first objective function.  Without the exact objective,
+  // the first pass is not checked for convergence.
+  if (exactObjective)
+  {
+    for (size_t i = 0; i < numFunctions; ++i)
+      overallObjective += function.Evaluate(iterate, i);
+  }
 
   // Initialize the update policy.
   if (resetPolicy)
     updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
 
+  // Use sparse gradients if both the function and the update policy support
+  // them.
+  typedef typename std::conditional<
+      HasSparseGradient<DecomposableFunctionType>::value &&
+      HasSparseUpdate<UpdatePolicyType>::value,
+      arma::SpMat<eT>, arma::Mat<eT> >::type GradientType;
+
   // Now iterate!
-  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  GradientType gradient(iterate.n_rows, iterate.n_cols);
   for (size_t i = 1; i != maxIterations; ++i, ++currentFunction)
   {
     // Is this iteration the start of a sequence?
     if ((currentFunction % numFunctions) == 0)
     {
-      // Output current objective function.
-      Log::Info << "SGD: iteration " << i << ", objective " << overallObjective
-          << "." << std::endl;
-
-      if (std::isnan(overallObjective) || std::isinf(overallObjective))
+      if (exactObjective || i > 1)
       {
-        Log::Warn << "SGD: converged to " << overallObjective << "; terminating"
-            << " with failure.  Try a smaller step size?" << std::endl;
-        return overallObjective;
-      }
-
-      if (std::abs(lastObjective - overallObjective) < tolerance)
-      {
-        Log::Info << "SGD: minimized within tolerance " << tolerance << "; "
-            << "terminating optimization." << std::endl;
-        return overallObjective;
+        // Output current objective function.
+        Log::Info << "SGD: iteration " << i << ", objective "
+            << overallObjective << "." << std::endl;
+
+        if (std::isnan(overallObjective) || std::isinf(overallObjective))
+        {
+          Log::Warn << "SGD: converged to " << overallObjective << "; "
+              << "terminating with failure.  Try a smaller step size?"
+              << std::endl;
+          return overallObjective;
+        }
+
+        if (std::abs(lastObjective - overallObjective) < tolerance)
+        {
+          Log::Info << "SGD: minimized within tolerance " << tolerance << "; "
+              << "terminating optimization." << std::endl;
+          return overallObjective;
+        }
+
+        lastObjective = overallObjective;
       }
 
       // Reset the counter variables.
-      lastObjective = overallObjective;
       overallObjective = 0;
       currentFunction = 0;
 
@@ -104,30 +124,24 @@ double SGD<UpdatePolicyType>::Optimize(
         visitationOrder = arma::shuffle(visitationOrder);
     }
 
-    // Evaluate the gradient for this iteration.
-    if (shuffle)
-      function.Gradient(iterate, visitationOrder[currentFunction], gradient);
-    else
-      function.Gradient(iterate, currentFunction, gradient);
+    // Evaluate the objective and the gradient for this iteration, and add the
+    // objective to the overall objective function.
+    const size_t index = shuffle ? visitationOrder[currentFunction] :
+        currentFunction;
+    overallObjective += EvaluateGradient(function, iterate, index, gradient);
 
     // Use the update policy to take a step.
     updatePolicy.Update(iterate, stepSize, gradient);
-
-    // Now add that to the overall objective function.
-    if (shuffle)
-    {
-      overallObjective += function.Evaluate(iterate,
-          visitationOrder[currentFunction]);
-    }
-    else
-    {
-      overallObjective += function.Evaluate(iterate, currentFunction);
-    }
   }
 
   Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
       << "terminating optimization." << std::endl;
 
+  // Without the exact objective, estimate the final objective from the last
+  // (possibly incomplete) pass, unless no step was taken at all.
+  if (!exactObjective && currentFunction > 0)
+    return overallObjective * numFunctions / currentFunction;
+
   // Calculate final objective.
   overallObjective = 0;
   for (size_t i = 0; i < numFunctions; ++i)
@@ -0,0 +1,42 @@
+/**
+ * @file has_sparse_update.hpp
+ *
+ * Detection of update policies that can take a step with a sparse gradient.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SGD_UPDATE_POLICIES_HAS_SPARSE_UPDATE_HPP
+#define MLPACK_CORE_OPTIMIZERS_SGD_UPDATE_POLICIES_HAS_SPARSE_UPDATE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(Update, HasSparseUpdateCheck);
+
+/**
+ * 'value' is true if the UpdatePolicyType class has a member
+ * void Update(arma::mat& iterate, const double stepSize,
+ *             const arma::sp_mat& gradient).
+ * SGD then computes sparse gradients if the function provides them, so that
+ * the cost of each step depends on the nonzeros of the gradient only.
+ */
+template<typename UpdatePolicyType>
+struct HasSparseUpdate
+{
+  static const bool value =
+    HasSparseUpdateCheck<UpdatePolicyType,
+        void(UpdatePolicyType::*)(arma::mat&,
+                                  const double,
+                                  const arma::sp_mat&)>::value;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -50,9 +50,10 @@ class VanillaUpdate
   * @param stepSize Step size to be used for the given iteration.
   * @param gradient The gradient matrix.
   */
-  void Update(arma::mat& iterate,
+  template<typename eT>
+  void Update(arma::Mat<eT>& iterate,
               const double stepSize,
-              const arma::mat& gradient)
+              const arma::Mat<eT>& gradient)
   {
     // Perform the vanilla SGD update.
     iterate -= stepSize * gradient;
@@ -84,8 +84,12 @@ double SnapshotSGDR<UpdatePolicyType>::Optimize(
 
     // Calculate final objective.
     overallObjective = 0;
-    for (size_t i = 0; i < function.NumFunctions(); ++i)
-      overallObjective += function.Evaluate(iterate, i);
+    const size_t numFunctions = function.NumFunctions();
+    for (size_t i = 0; i < numFunctions; i += batchSize)
+    {
+      overallObjective += EvaluateBatch(function, iterate, i,
+          std::min(batchSize, numFunctions - i));
+    }
   }
 
   return overallObjective;
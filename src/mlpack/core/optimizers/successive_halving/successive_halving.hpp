@@ -0,0 +1,127 @@
+/**
+ * @file successive_halving.hpp
+ *
+ * Successive halving, a budget-aware variant of grid-search optimization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SUCCESSIVE_HALVING_SUCCESSIVE_HALVING_HPP
+#define MLPACK_CORE_OPTIMIZERS_SUCCESSIVE_HALVING_SUCCESSIVE_HALVING_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/grid_search/grid_points.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * An optimizer that finds the minimum of a given function over the points of a
+ * multidimensional grid (like GridSearch), but evaluates most of the points
+ * only with a small budget.  First all points are evaluated with the minimum
+ * budget; then only the best 1 / eta of them are kept and evaluated with a
+ * budget eta times as large, and so on, until the full budget is reached.  The
+ * remaining points are evaluated with the full budget, and the best of them is
+ * returned.
+ *
+ * With HyperParameterTuner, the budget is the proportion of each training set
+ * that the models are trained on, so the hyper-parameters that are clearly bad
+ * are dropped after training on small parts of the data.  As only the first
+ * points of each training set are used, the data should be shuffled.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @inproceedings{jamieson2016non,
+ *   title     = {Non-stochastic Best Arm Identification and Hyperparameter
+ *                Optimization},
+ *   author    = {Jamieson, Kevin and Talwalkar, Ameet},
+ *   booktitle = {Proceedings of the 19th International Conference on
+ *                Artificial Intelligence and Statistics (AISTATS)},
+ *   pages     = {240--248},
+ *   year      = {2016}
+ * }
+ * @endcode
+ *
+ * For SuccessiveHalving to work, a FunctionType template parameter is
+ * required. This class must implement the following functions:
+ *
+ *   double Evaluate(const arma::mat& coordinates);
+ *   double Evaluate(const arma::mat& coordinates, const double budget);
+ *
+ * where budget is the proportion (in (0, 1]) of the full budget.  As for
+ * GridSearch, FunctionType must also be copy-constructible, since the points
+ * can be evaluated in parallel.  Only the evaluations with the full budget are
+ * repeated with the given function (for the best point) after a parallel run.
+ */
+class SuccessiveHalving
+{
+ public:
+  /**
+   * Construct the successive halving optimizer.  A std::invalid_argument
+   * exception is thrown if minBudget is not in (0, 1] or eta is not greater
+   * than 1.
+   *
+   * @param minBudget The budget of the first round (the proportion of the full
+   *     budget).
+   * @param eta The factor the number of points is reduced by, and the budget is
+   *     increased by, after each round.
+   * @param numThreads Number of threads to evaluate the points with (0 means
+   *     as many as OpenMP uses by default).  With 1 thread, the given function
+   *     is evaluated directly.
+   */
+  SuccessiveHalving(const double minBudget = 1.0 / 9.0,
+                    const double eta = 3.0,
+                    const size_t numThreads = 1);
+
+  /**
+   * Optimize (minimize) the given function over the all possible combinations
+   * of values for the parameters specified in datasetInfo.
+   *
+   * @param function Function to optimize.
+   * @param bestParameters Variable for storing results.
+   * @param datasetInfo Type information for each dimension of the dataset. It
+   *     should store possible values for each parameter.
+   * @return Objective value (with the full budget) of the final point.
+   */
+  template<typename FunctionType>
+  double Optimize(
+      FunctionType& function,
+      arma::mat& bestParameters,
+      data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo);
+
+  //! Get the budget of the first round.
+  double MinBudget() const { return minBudget; }
+  //! Modify the budget of the first round.
+  double& MinBudget() { return minBudget; }
+
+  //! Get the reduction factor.
+  double Eta() const { return eta; }
+  //! Modify the reduction factor.
+  double& Eta() { return eta; }
+
+  //! Get the number of threads.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads.
+  size_t& NumThreads() { return numThreads; }
+
+ private:
+  //! The budget of the first round.
+  double minBudget;
+
+  //! The reduction factor.
+  double eta;
+
+  //! The number of threads to evaluate the points with.
+  size_t numThreads;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation
+#include "successive_halving_impl.hpp"
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file successive_halving_impl.hpp
+ *
+ * Implementation of successive halving.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SUCCESSIVE_HALVING_SUCCESSIVE_HALVING_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_SUCCESSIVE_HALVING_SUCCESSIVE_HALVING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "successive_halving.hpp"
+
+#include <limits>
+
+namespace mlpack {
+namespace optimization {
+
+inline SuccessiveHalving::SuccessiveHalving(const double minBudget,
+                                            const double eta,
+                                            const size_t numThreads) :
+    minBudget(minBudget),
+    eta(eta),
+    numThreads(numThreads)
+{
+  if (minBudget <= 0.0 || minBudget > 1.0)
+  {
+    throw std::invalid_argument("SuccessiveHalving::SuccessiveHalving(): the "
+        "minimum budget should be in (0, 1]");
+  }
+
+  if (eta <= 1.0)
+  {
+    throw std::invalid_argument("SuccessiveHalving::SuccessiveHalving(): eta "
+        "should be greater than 1");
+  }
+}
+
+template<typename FunctionType>
+double SuccessiveHalving::Optimize(
+    FunctionType& function,
+    arma::mat& bestParameters,
+    data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo)
+{
+  for (size_t i = 0; i < datasetInfo.Dimensionality(); ++i)
+  {
+    if (datasetInfo.Type(i) != data::Datatype::categorical)
+    {
+      std::ostringstream oss;
+      oss << "SuccessiveHalving::Optimize(): the dimension " << i
+          << " is not categorical" << std::endl;
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  double bestObjective = std::numeric_limits<double>::max();
+  bestParameters = arma::mat(datasetInfo.Dimensionality(), 1);
+
+  // In case no point gives an objective value better than
+  // std::numeric_limits<double>::max().
+  for (size_t i = 0; i < datasetInfo.Dimensionality(); ++i)
+    bestParameters(i, 0) = datasetInfo.UnmapString(0, i);
+
+  arma::mat candidates = GridPoints(datasetInfo);
+
+  PartialBudgetEvaluation evaluation;
+  evaluation.budget = minBudget;
+  while (evaluation.budget < 1.0 && candidates.n_cols > 1)
+  {
+    arma::vec objectives = EvaluateGridPoints(function, candidates, evaluation,
+        numThreads);
+
+    // Points that could not be evaluated are the worst ones.
+    for (size_t i = 0; i < objectives.n_elem; ++i)
+    {
+      if (std::isnan(objectives[i]))
+        objectives[i] = std::numeric_limits<double>::max();
+    }
+
+    // Keep the best points in their original order, so that ties are broken
+    // as in GridSearch.
+    const size_t numKept = std::max((size_t) std::ceil(candidates.n_cols / eta),
+        (size_t) 1);
+    const arma::uvec order = arma::stable_sort_index(objectives);
+    candidates = arma::mat(candidates.cols(arma::sort(
+        order.subvec(0, numKept - 1))));
+
+    Log::Info << "SuccessiveHalving: kept " << numKept << " points after "
+        << "evaluating with budget " << evaluation.budget << "." << std::endl;
+
+    evaluation.budget = std::min(evaluation.budget * eta, 1.0);
+  }
+
+  const arma::vec objectives = EvaluateGridPoints(function, candidates,
+      FullBudgetEvaluation(), numThreads);
+  for (size_t i = 0; i < candidates.n_cols; ++i)
+  {
+    if (objectives[i] < bestObjective)
+    {
+      bestObjective = objectives[i];
+      bestParameters = candidates.col(i);
+    }
+  }
+
+  // The given function was not used in the parallel case; bring it into the
+  // state of the serial search.
+  if (numThreads != 1)
+    function.Evaluate(bestParameters);
+
+  return bestObjective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -169,7 +169,8 @@ class BallBound
    * to be the center of all of the given points.
    *
    * @tparam MatType Type of matrix; could be arma::mat, arma::spmat, or a
-   *     vector.
+   *     vector.  Sparse points are not converted to dense vectors; their
+   *     distances to the center are computed from their nonzero elements.
    * @tparam data Data points to add.
    */
   template<typename MatType>
@@ -188,6 +189,15 @@ class BallBound
   //! Serialize the bound.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
+
+ private:
+  //! Expand the bound to include the given dense points.
+  template<typename MatType>
+  void AddPoints(const MatType& data, std::false_type /* sparse */);
+
+  //! Expand the bound to include the given sparse points.
+  template<typename MatType>
+  void AddPoints(const MatType& data, std::true_type /* sparse */);
 };
 
 //! A specialization of BoundTraits for this bound type.
@@ -255,29 +255,72 @@ template<typename MatType>
 const BallBound<MetricType, VecType>&
 BallBound<MetricType, VecType>::operator|=(const MatType& data)
 {
+  AddPoints(data, std::integral_constant<bool,
+      arma::is_arma_sparse_type<MatType>::value>());
+
+  return *this;
+}
+
+template<typename MetricType, typename VecType>
+template<typename MatType>
+void BallBound<MetricType, VecType>::AddPoints(const MatType& data,
+                                               std::false_type /* sparse */)
+{
+  // The points are converted to VecType, since the data may hold a different
+  // element type than the bound.
   if (radius < 0)
   {
-    center = data.col(0);
+    center = arma::conv_to<VecType>::from(data.col(0));
     radius = 0;
   }
 
   // Now iteratively add points.
   for (size_t i = 0; i < data.n_cols; ++i)
   {
-    const ElemType dist = metric->Evaluate(center, (VecType) data.col(i));
+    const VecType point = arma::conv_to<VecType>::from(data.col(i));
+    const ElemType dist = metric->Evaluate(center, point);
 
     // See if the new point lies outside the bound.
     if (dist > radius)
     {
       // Move towards the new point and increase the radius just enough to
       // accommodate the new point.
-      const VecType diff = data.col(i) - center;
+      const VecType diff = point - center;
       center += ((dist - radius) / (2 * dist)) * diff;
       radius = 0.5 * (dist + radius);
     }
   }
+}
 
-  return *this;
+template<typename MetricType, typename VecType>
+template<typename MatType>
+void BallBound<MetricType, VecType>::AddPoints(const MatType& data,
+                                               std::true_type /* sparse */)
+{
+  // Converting each sparse point to a dense vector would take time
+  // proportional to the dimensionality for each point, so the sparse columns
+  // are used directly.  The element types must be the same.
+  if (radius < 0)
+  {
+    center.zeros(data.n_rows);
+    center += data.col(0);
+    radius = 0;
+  }
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    const ElemType dist = metric->Evaluate(center, data.col(i));
+
+    if (dist > radius)
+    {
+      // This is the same step as for dense points, center += t * (point -
+      // center), without forming the difference.
+      const ElemType t = (dist - radius) / (2 * dist);
+      center *= (1 - t);
+      center += t * data.col(i);
+      radius = 0.5 * (dist + radius);
+    }
+  }
 }
 
 //! Serialize the BallBound.
@@ -15,10 +15,23 @@
 
 #include "../statistic.hpp"
 #include "midpoint_split.hpp"
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+/**
+ * The order in which BinarySpaceTree::Freeze() lays out the nodes of a tree in
+ * memory.  A depth-first layout keeps each node next to its left child; a van
+ * Emde Boas layout keeps small subtrees together at every scale, which helps
+ * when the traversal prunes heavily.
+ */
+enum NodeLayout
+{
+  DEPTH_FIRST_LAYOUT,
+  VAN_EMDE_BOAS_LAYOUT
+};
+
 /**
  * A binary space partitioning tree, such as a KD-tree or a ball tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -88,6 +101,11 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! If this is the root of a frozen tree, the contiguous block that holds all
+  //! of the other nodes of the tree (see Freeze()); otherwise NULL.
+  BinarySpaceTree* frozenNodes;
+  //! The number of nodes in frozenNodes.
+  size_t numFrozenNodes;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -102,6 +120,11 @@ class BinarySpaceTree
   template<typename RuleType>
   class BreadthFirstDualTreeTraverser;
 
+  //! A multithreaded dual-tree traverser for binary space trees; see
+  //! parallel_dual_tree_traverser.hpp.
+  template<typename RuleType>
+  class ParallelDualTreeTraverser;
+
   /**
    * Construct this as the root node of a binary space tree using the given
    * dataset.  This will copy the input matrix; if you don't want this, consider
@@ -300,6 +323,23 @@ class BinarySpaceTree
    */
   ~BinarySpaceTree();
 
+  /**
+   * Freeze the tree for fast read-only use: all nodes below the root are moved
+   * into one contiguous block of memory, in either depth-first or van Emde Boas
+   * order, so that traversals touch far fewer cache lines.  The structure of
+   * the tree does not change, so traversers and rules work on a frozen tree as
+   * usual, but the addresses of all nodes (other than the root) change, and
+   * subtrees may no longer be deleted or replaced individually.  The
+   * StatisticType must not hold pointers to the nodes.  This may only be called
+   * on the root of the tree, and can be called more than once.
+   *
+   * @param layout Order of the nodes in memory.
+   */
+  void Freeze(const NodeLayout layout = DEPTH_FIRST_LAYOUT);
+
+  //! Return whether the nodes of this tree are held in one contiguous block.
+  bool IsFrozen() const { return frozenNodes != NULL; }
+
   //! Return the bound object for this node.
   const BoundType<MetricType>& Bound() const { return bound; }
   //! Return the bound object for this node.
@@ -492,6 +532,16 @@ class BinarySpaceTree
   //! Store the center of the bounding region in the given vector.
   void Center(arma::vec& center) const { bound.Center(center); }
 
+  /**
+   * Recompute the bounds, the furthest descendant distances, the parent
+   * distances and the statistics of this node and all of its descendants from
+   * the points they hold, keeping the structure of the tree.  This is meant
+   * for when the points of the dataset have moved a little (through
+   * Dataset()) and building a new tree is not worth it; the tree stays valid
+   * for any movement, but it may prune less when the points have moved far.
+   */
+  void RefitBounds();
+
  private:
   /**
    * Splits the current node, assigning its left and right children recursively.
@@ -514,6 +564,39 @@ class BinarySpaceTree
                  const size_t maxLeafSize,
                  SplitType<BoundType<MetricType>, MatType>& splitter);
 
+  //! Destroy the contiguous block of nodes held by the root of a frozen tree.
+  void ReleaseFrozenNodes();
+
+  //! Collect the nodes of the given subtree in depth-first (pre-)order.
+  static void DepthFirstOrder(BinarySpaceTree* node,
+                              std::vector<BinarySpaceTree*>& order);
+
+  //! Collect the nodes in the top 'height' levels of the given subtree in van
+  //! Emde Boas order.
+  static void VanEmdeBoasOrder(BinarySpaceTree* node,
+                               const size_t height,
+                               std::vector<BinarySpaceTree*>& order);
+
+  //! Compute the number of levels of the given subtree.
+  static size_t Height(const BinarySpaceTree* node);
+
+  /**
+   * Build the children of the current node, which hold the points in
+   * [begin, splitCol) and [splitCol, begin + count).  If the split type allows
+   * it (see SplitTraits) and the node is large, the two children are built in
+   * parallel.
+   *
+   * @param splitCol Index of the first point of the right child.
+   * @param oldFromNew Vector holding permuted indices, or NULL if the mapping
+   *     is not being tracked.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @param splitter Instantiated SplitType object.
+   */
+  void BuildChildren(const size_t splitCol,
+                     std::vector<size_t>* oldFromNew,
+                     const size_t maxLeafSize,
+                     SplitType<BoundType<MetricType>, MatType>& splitter);
+
   /**
    * Update the bound of the current node. This method does not take into
    * account bound-specific properties.
@@ -543,6 +626,10 @@ class BinarySpaceTree
   //! Friend access is given for the default constructor.
   friend class boost::serialization::access;
 
+  //! Friend access is given for loading and saving flat indexes.
+  template<typename TreeType>
+  friend class FlatTreeIndex;
+
  public:
   /**
    * Serialize the tree.
@@ -13,10 +13,16 @@
 
 // In case it wasn't included already for some reason.
 #include "binary_space_tree.hpp"
+#include <mlpack/core/tree/parallel_split_threshold.hpp>
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <queue>
+#include <unordered_map>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace tree {
@@ -40,7 +46,9 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -68,7 +76,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
@@ -102,7 +112,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
@@ -137,7 +149,9 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -165,7 +179,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -199,7 +215,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -238,7 +256,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Perform the actual splitting.
   SplitNode(maxLeafSize, splitter);
@@ -267,7 +287,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -301,7 +323,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -342,7 +366,9 @@ BinarySpaceTree(
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -400,7 +426,9 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    frozenNodes(other.frozenNodes),
+    numFrozenNodes(other.numFrozenNodes)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -412,6 +440,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.frozenNodes = NULL;
+  other.numFrozenNodes = 0;
 
   // Set new parent.
   if (left)
@@ -455,8 +485,15 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
-  delete left;
-  delete right;
+  if (frozenNodes)
+  {
+    ReleaseFrozenNodes();
+  }
+  else
+  {
+    delete left;
+    delete right;
+  }
 
   // If we're the root, delete the matrix.
   if (!parent)
@@ -783,10 +820,7 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
-      maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      splitter, maxLeafSize);
+  BuildChildren(splitCol, NULL, maxLeafSize, splitter);
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -850,10 +884,7 @@ SplitNode(std::vector<size_t>& oldFromNew,
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      oldFromNew, splitter, maxLeafSize);
+  BuildChildren(splitCol, &oldFromNew, maxLeafSize, splitter);
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -869,6 +900,114 @@ SplitNode(std::vector<size_t>& oldFromNew,
   right->ParentDistance() = rightParentDistance;
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BuildChildren(const size_t splitCol,
+              std::vector<size_t>* oldFromNew,
+              const size_t maxLeafSize,
+              SplitType<BoundType<MetricType>, MatType>& splitter)
+{
+  // The two children hold disjoint ranges of points, so they can be built at
+  // the same time, as long as the split type allows it, the dataset is dense
+  // (column swaps in a sparse matrix modify shared storage), and the bound of a
+  // node does not depend on its sibling (as it does for HollowBallBound).
+  // Since the splits are then deterministic, the tree is the same as the
+  // serially built tree.
+  const bool parallel = SplitTraits<Split>::SupportsParallelBuild &&
+      !arma::is_SpMat<MatType>::value &&
+      !std::is_same<BoundType<MetricType>,
+                    bound::HollowBallBound<MetricType>>::value &&
+      (count >= ParallelSplitThreshold);
+
+  if (!parallel)
+  {
+    left = (oldFromNew == NULL) ?
+        new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+            maxLeafSize) :
+        new BinarySpaceTree(this, begin, splitCol - begin, *oldFromNew,
+            splitter, maxLeafSize);
+    right = (oldFromNew == NULL) ?
+        new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+            splitter, maxLeafSize) :
+        new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+            *oldFromNew, splitter, maxLeafSize);
+    return;
+  }
+
+  #ifdef HAS_OPENMP
+  // The first large node starts the team of threads; the children of all
+  // other large nodes are built as tasks run by that team.
+  if (!omp_in_parallel())
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      BuildChildren(splitCol, oldFromNew, maxLeafSize, splitter);
+    }
+    return;
+  }
+  #endif
+
+  #pragma omp task shared(splitter)
+  {
+    left = (oldFromNew == NULL) ?
+        new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+            maxLeafSize) :
+        new BinarySpaceTree(this, begin, splitCol - begin, *oldFromNew,
+            splitter, maxLeafSize);
+  }
+
+  right = (oldFromNew == NULL) ?
+      new BinarySpaceTree(this, splitCol, begin + count - splitCol, splitter,
+          maxLeafSize) :
+      new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+          *oldFromNew, splitter, maxLeafSize);
+
+  // Both children must be finished before the statistic of this node is built.
+  #pragma omp taskwait
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+RefitBounds()
+{
+  // The bound of a node may depend on the bound of its left sibling (see
+  // UpdateBound()), so the bounds are computed from the top down and from left
+  // to right, as when the tree is built.
+  bound = BoundType<MetricType>(dataset->n_rows);
+  UpdateBound(bound);
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+
+  if (left)
+    left->RefitBounds();
+  if (right)
+    right->RefitBounds();
+
+  if (left && right)
+  {
+    arma::vec center, leftCenter, rightCenter;
+    Center(center);
+    left->Center(leftCenter);
+    right->Center(rightCenter);
+
+    left->ParentDistance() = MetricType::Evaluate(center, leftCenter);
+    right->ParentDistance() = MetricType::Evaluate(center, rightCenter);
+  }
+
+  // The statistic of a node may depend on the statistics of its children.
+  stat = StatisticType(*this);
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -909,6 +1048,183 @@ UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate)
     boundToUpdate |= dataset->cols(begin, begin + count - 1);
 }
 
+/**
+ * Move all of the nodes below the root into one contiguous block, in the given
+ * order.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Freeze(const NodeLayout layout)
+{
+  if (parent != NULL)
+    throw std::invalid_argument("BinarySpaceTree::Freeze(): only the root of a "
+        "tree can be frozen");
+
+  if (!left)
+    return; // There is nothing to lay out.
+
+  // Find the order of the nodes.  In both layouts every node comes before its
+  // descendants, so the root is first; it stays where it is.
+  std::vector<BinarySpaceTree*> order;
+  if (layout == VAN_EMDE_BOAS_LAYOUT)
+    VanEmdeBoasOrder(this, Height(this), order);
+  else
+    DepthFirstOrder(this, order);
+  order.erase(order.begin());
+
+  BinarySpaceTree* nodes = static_cast<BinarySpaceTree*>(
+      ::operator new(order.size() * sizeof(BinarySpaceTree)));
+
+  // Move each node into its place.  Since parents are moved before their
+  // children, the children's parent links are already correct after the move,
+  // but the child links of each node still point at the old nodes.
+  std::unordered_map<BinarySpaceTree*, BinarySpaceTree*> newFromOld;
+  newFromOld.reserve(order.size());
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    new (nodes + i) BinarySpaceTree(std::move(*order[i]));
+    newFromOld[order[i]] = nodes + i;
+  }
+
+  left = newFromOld[left];
+  right = newFromOld[right];
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    if (nodes[i].left)
+      nodes[i].left = newFromOld[nodes[i].left];
+    if (nodes[i].right)
+      nodes[i].right = newFromOld[nodes[i].right];
+  }
+
+  // Now get rid of the old (empty) nodes.
+  if (frozenNodes)
+  {
+    for (size_t i = 0; i < numFrozenNodes; ++i)
+      frozenNodes[i].~BinarySpaceTree();
+    ::operator delete(frozenNodes);
+  }
+  else
+  {
+    for (size_t i = 0; i < order.size(); ++i)
+      delete order[i];
+  }
+
+  frozenNodes = nodes;
+  numFrozenNodes = order.size();
+}
+
+//! Destroy the contiguous block of nodes held by the root of a frozen tree.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ReleaseFrozenNodes()
+{
+  // The nodes in the block must not delete their children themselves.
+  for (size_t i = 0; i < numFrozenNodes; ++i)
+  {
+    frozenNodes[i].left = NULL;
+    frozenNodes[i].right = NULL;
+    frozenNodes[i].~BinarySpaceTree();
+  }
+  ::operator delete(frozenNodes);
+
+  frozenNodes = NULL;
+  numFrozenNodes = 0;
+  left = NULL;
+  right = NULL;
+}
+
+//! Collect the nodes of the subtree in depth-first (pre-)order.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DepthFirstOrder(BinarySpaceTree* node, std::vector<BinarySpaceTree*>& order)
+{
+  order.push_back(node);
+  if (node->left)
+    DepthFirstOrder(node->left, order);
+  if (node->right)
+    DepthFirstOrder(node->right, order);
+}
+
+/**
+ * Collect the nodes of the top 'height' levels of the subtree in van Emde Boas
+ * order: the top half of the levels is laid out recursively, followed by each
+ * of the subtrees hanging below it, also laid out recursively.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+VanEmdeBoasOrder(BinarySpaceTree* node,
+                 const size_t height,
+                 std::vector<BinarySpaceTree*>& order)
+{
+  if (height == 1 || node->IsLeaf())
+  {
+    order.push_back(node);
+    return;
+  }
+
+  const size_t topHeight = height / 2;
+  VanEmdeBoasOrder(node, topHeight, order);
+
+  // Find the roots of the bottom subtrees, which are at depth topHeight below
+  // this node.  Any leaf above that depth is already part of the top subtree.
+  std::vector<BinarySpaceTree*> bottomRoots, nextRoots;
+  bottomRoots.push_back(node);
+  for (size_t depth = 0; depth < topHeight; ++depth)
+  {
+    nextRoots.clear();
+    for (size_t i = 0; i < bottomRoots.size(); ++i)
+    {
+      if (bottomRoots[i]->left)
+        nextRoots.push_back(bottomRoots[i]->left);
+      if (bottomRoots[i]->right)
+        nextRoots.push_back(bottomRoots[i]->right);
+    }
+    bottomRoots.swap(nextRoots);
+  }
+
+  for (size_t i = 0; i < bottomRoots.size(); ++i)
+    VanEmdeBoasOrder(bottomRoots[i], height - topHeight, order);
+}
+
+//! Compute the number of levels of the subtree.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+    SplitType>::Height(const BinarySpaceTree* node)
+{
+  size_t height = 0;
+  if (node->left)
+    height = Height(node->left);
+  if (node->right)
+    height = std::max(height, Height(node->right));
+
+  return height + 1;
+}
+
 // Default constructor (private), for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -926,7 +1242,9 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    frozenNodes(NULL),
+    numFrozenNodes(0)
 {
   // Nothing to do.
 }
@@ -949,10 +1267,17 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
-    if (left)
-      delete left;
-    if (right)
-      delete right;
+    if (frozenNodes)
+    {
+      ReleaseFrozenNodes();
+    }
+    else
+    {
+      if (left)
+        delete left;
+      if (right)
+        delete right;
+    }
     if (!parent)
       delete dataset;
   }
@@ -17,19 +17,30 @@
 
 #include <mlpack/prereqs.hpp>
 #include <queue>
+#include <vector>
 
 #include "../binary_space_tree.hpp"
 
 namespace mlpack {
 namespace tree {
 
+/**
+ * A node combination that is waiting in the queue of a query node.  Frames are
+ * plain structs of pointers and numbers (the traversal information of the
+ * rules is too), so they are cheap to copy and move around the heap.
+ */
 template<typename TreeType, typename TraversalInfoType>
 struct QueueFrame
 {
+  //! The query node.
   TreeType* queryNode;
+  //! The reference node.
   TreeType* referenceNode;
+  //! The depth of the query node.
   size_t queryDepth;
+  //! The score of the parent combination.
   double score;
+  //! The traversal information to restore before scoring the combination.
   TraversalInfoType traversalInfo;
 };
 
@@ -46,8 +57,21 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
  public:
   /**
    * Instantiate the dual-tree traverser with the given rule set.
+   *
+   * The frames that wait in the queues of the query nodes take memory that
+   * grows with the number of node combinations that cannot be pruned, which
+   * can be very large for datasets that are not well separated.  Once the
+   * queues hold maxQueueBytes bytes of frames, the traversal sheds the
+   * lowest-priority half of the queue that is being filled by expanding those
+   * frames depth-first (like DualTreeTraverser), so the memory stays bounded;
+   * the results do not change, but fewer combinations may be pruned.
+   *
+   * @param rule Rules to traverse the trees with.
+   * @param maxQueueBytes Largest amount of memory that the queued frames may
+   *     take (0 means no limit).
    */
-  BreadthFirstDualTreeTraverser(RuleType& rule);
+  BreadthFirstDualTreeTraverser(RuleType& rule,
+                                const size_t maxQueueBytes = 1 << 30);
 
   typedef QueueFrame<BinarySpaceTree, typename RuleType::TraversalInfoType>
       QueueFrameType;
@@ -57,12 +81,20 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
    *
    * @param queryNode The query node to be traversed.
    * @param referenceNode The reference node to be traversed.
-   * @param score The score of the current node combination.
    */
   void Traverse(BinarySpaceTree& queryNode,
                 BinarySpaceTree& referenceNode);
+
+  /**
+   * Traverse the combinations of the given queue, which is a heap of frames
+   * (see std::push_heap()) whose query node is the given node, and then the
+   * combinations of the children of the query node.
+   *
+   * @param queryNode The query node of the frames in the queue.
+   * @param referenceQueue Heap of frames, which is emptied.
+   */
   void Traverse(BinarySpaceTree& queryNode,
-                std::priority_queue<QueueFrameType>& referenceQueue);
+                std::vector<QueueFrameType>& referenceQueue);
 
   //! Get the number of prunes.
   size_t NumPrunes() const { return numPrunes; }
@@ -84,7 +116,28 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   //! Modify the number of times a base case was calculated.
   size_t& NumBaseCases() { return numBaseCases; }
 
+  //! Get the largest amount of memory of the queued frames (0 is no limit).
+  size_t MaxQueueBytes() const { return maxQueueBytes; }
+  //! Modify the largest amount of memory of the queued frames (0 is no limit).
+  size_t& MaxQueueBytes() { return maxQueueBytes; }
+
+  //! Get the largest number of frames that were queued at the same time.
+  size_t PeakQueueFrames() const { return peakQueueFrames; }
+  //! Get the number of frames that were expanded depth-first.
+  size_t NumDepthFirstFrames() const { return numDepthFirstFrames; }
+
  private:
+  /**
+   * Add the frame to the given queue.  If the queues hold more frames than the
+   * budget allows after that, the lowest-priority half of the queue (or the
+   * frame itself, if it is alone in its queue) is expanded depth-first.
+   */
+  void Push(std::vector<QueueFrameType>& queue, const QueueFrameType& frame);
+
+  //! Score the combination of the frame and, if it cannot be pruned, traverse
+  //! it depth-first.  The traversal information of the rules is preserved.
+  void DepthFirst(const QueueFrameType& frame);
+
   //! Reference to the rules with which the trees will be traversed.
   RuleType& rule;
 
@@ -103,6 +156,17 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   //! Traversal information, held in the class so that it isn't continually
   //! being reallocated.
   typename RuleType::TraversalInfoType traversalInfo;
+
+  //! The largest amount of memory of the queued frames (0 is no limit).
+  size_t maxQueueBytes;
+  //! The largest number of queued frames, during Traverse().
+  size_t maxQueueFrames;
+  //! The number of frames in all of the queues.
+  size_t queueFrames;
+  //! The largest number of frames that were queued at the same time.
+  size_t peakQueueFrames;
+  //! The number of frames that were expanded depth-first.
+  size_t numDepthFirstFrames;
 };
 
 } // namespace tree
@@ -29,12 +29,18 @@ template<typename MetricType,
 template<typename RuleType>
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 BreadthFirstDualTreeTraverser<RuleType>::BreadthFirstDualTreeTraverser(
-    RuleType& rule) :
+    RuleType& rule,
+    const size_t maxQueueBytes) :
     rule(rule),
     numPrunes(0),
     numVisited(0),
     numScores(0),
-    numBaseCases(0)
+    numBaseCases(0),
+    maxQueueBytes(maxQueueBytes),
+    maxQueueFrames(0),
+    queueFrames(0),
+    peakQueueFrames(0),
+    numDepthFirstFrames(0)
 { /* Nothing to do. */ }
 
 template<typename TreeType, typename TraversalInfoType>
@@ -73,7 +79,13 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
   if (rootScore == DBL_MAX)
     return; // This probably means something is wrong.
 
-  std::priority_queue<QueueFrameType> queue;
+  // Keep at least two frames, so that the budget can always be met by shedding
+  // half of a queue.
+  maxQueueFrames = (maxQueueBytes == 0) ? 0 : std::max((size_t) 2,
+      maxQueueBytes / sizeof(QueueFrameType));
+  queueFrames = 0;
+
+  std::vector<QueueFrameType> queue;
 
   QueueFrameType rootFrame;
   rootFrame.queryNode = &queryRoot;
@@ -82,7 +94,7 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
   rootFrame.score = 0.0;
   rootFrame.traversalInfo = rule.TraversalInfo();
 
-  queue.push(rootFrame);
+  Push(queue, rootFrame);
 
   // Start the traversal.
   Traverse(queryRoot, queue);
@@ -99,17 +111,19 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 BreadthFirstDualTreeTraverser<RuleType>::Traverse(
     BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>&
         queryNode,
-    std::priority_queue<QueueFrameType>& referenceQueue)
+    std::vector<QueueFrameType>& referenceQueue)
 {
   // Store queues for the children.  We will recurse into the children once our
   // queue is empty.
-  std::priority_queue<QueueFrameType> leftChildQueue;
-  std::priority_queue<QueueFrameType> rightChildQueue;
+  std::vector<QueueFrameType> leftChildQueue;
+  std::vector<QueueFrameType> rightChildQueue;
 
   while (!referenceQueue.empty())
   {
-    QueueFrameType currentFrame = referenceQueue.top();
-    referenceQueue.pop();
+    std::pop_heap(referenceQueue.begin(), referenceQueue.end());
+    QueueFrameType currentFrame = referenceQueue.back();
+    referenceQueue.pop_back();
+    --queueFrames;
 
     BinarySpaceTree& queryNode = *currentFrame.queryNode;
     BinarySpaceTree& referenceNode = *currentFrame.referenceNode;
@@ -153,11 +167,11 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
       // We have to recurse down the query node.
       QueueFrameType fl = { queryNode.Left(), &referenceNode, queryDepth + 1,
           score, rule.TraversalInfo() };
-      leftChildQueue.push(fl);
+      Push(leftChildQueue, fl);
 
       QueueFrameType fr = { queryNode.Right(), &referenceNode, queryDepth + 1,
           score, ti };
-      rightChildQueue.push(fr);
+      Push(rightChildQueue, fr);
     }
     else if (queryNode.IsLeaf() && (!referenceNode.IsLeaf()))
     {
@@ -166,11 +180,11 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
       // traversal information correctly.
       QueueFrameType fl = { &queryNode, referenceNode.Left(), queryDepth,
           score, rule.TraversalInfo() };
-      referenceQueue.push(fl);
+      Push(referenceQueue, fl);
 
       QueueFrameType fr = { &queryNode, referenceNode.Right(), queryDepth,
           score, ti };
-      referenceQueue.push(fr);
+      Push(referenceQueue, fr);
     }
     else
     {
@@ -180,19 +194,19 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
       // correctly.
       QueueFrameType fll = { queryNode.Left(), referenceNode.Left(),
           queryDepth + 1, score, rule.TraversalInfo() };
-      leftChildQueue.push(fll);
+      Push(leftChildQueue, fll);
 
       QueueFrameType flr = { queryNode.Left(), referenceNode.Right(),
           queryDepth + 1, score, rule.TraversalInfo() };
-      leftChildQueue.push(flr);
+      Push(leftChildQueue, flr);
 
       QueueFrameType frl = { queryNode.Right(), referenceNode.Left(),
           queryDepth + 1, score, rule.TraversalInfo() };
-      rightChildQueue.push(frl);
+      Push(rightChildQueue, frl);
 
       QueueFrameType frr = { queryNode.Right(), referenceNode.Right(),
           queryDepth + 1, score, rule.TraversalInfo() };
-      rightChildQueue.push(frr);
+      Push(rightChildQueue, frr);
     }
   }
 
@@ -204,6 +218,79 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
     Traverse(*queryNode.Right(), rightChildQueue);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BreadthFirstDualTreeTraverser<RuleType>::Push(
+    std::vector<QueueFrameType>& queue,
+    const QueueFrameType& frame)
+{
+  queue.push_back(frame);
+  std::push_heap(queue.begin(), queue.end());
+  ++queueFrames;
+
+  if (maxQueueFrames != 0 && queueFrames > maxQueueFrames)
+  {
+    // The lowest-priority half of this queue is expanded depth-first.  When the
+    // frame is alone in its queue, the other frames are held by the queues of
+    // the ancestors of its query node, so the frame itself is expanded.
+    const size_t keep = queue.size() / 2;
+    std::nth_element(queue.begin(), queue.begin() + keep, queue.end(),
+        [](const QueueFrameType& a, const QueueFrameType& b) { return b < a; });
+
+    for (size_t i = keep; i < queue.size(); ++i)
+      DepthFirst(queue[i]);
+
+    numDepthFirstFrames += queue.size() - keep;
+    queueFrames -= queue.size() - keep;
+    queue.resize(keep);
+    std::make_heap(queue.begin(), queue.end());
+  }
+
+  peakQueueFrames = std::max(peakQueueFrames, queueFrames);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BreadthFirstDualTreeTraverser<RuleType>::DepthFirst(
+    const QueueFrameType& frame)
+{
+  // The caller may still build frames from the current traversal information.
+  const typename RuleType::TraversalInfoType callerInfo = rule.TraversalInfo();
+
+  rule.TraversalInfo() = frame.traversalInfo;
+  const double score = rule.Score(*frame.queryNode, *frame.referenceNode);
+  ++numScores;
+
+  if (score == DBL_MAX)
+  {
+    ++numPrunes;
+  }
+  else
+  {
+    DualTreeTraverser<RuleType> traverser(rule);
+    traverser.Traverse(*frame.queryNode, *frame.referenceNode);
+
+    numPrunes += traverser.NumPrunes();
+    numVisited += traverser.NumVisited();
+    numScores += traverser.NumScores();
+    numBaseCases += traverser.NumBaseCases();
+  }
+
+  rule.TraversalInfo() = callerInfo;
+}
+
 } // namespace tree
 } // namespace mlpack
 
@@ -17,11 +17,19 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include <mlpack/core/util/sfinae_utility.hpp>
+
 #include "binary_space_tree.hpp"
 
 namespace mlpack {
 namespace tree {
 
+/**
+ * This gives us a HasLeafBaseCasesCheck object that we can use to tell whether
+ * or not a RuleType can compute all base cases between two leaves at once.
+ */
+HAS_MEM_FUNC(LeafBaseCases, HasLeafBaseCasesCheck);
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -69,6 +77,28 @@ class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   size_t& NumBaseCases() { return numBaseCases; }
 
  private:
+  /**
+   * Compute the base cases between two leaves with the LeafBaseCases() method
+   * of the rules, which may be able to compute them all at once.
+   */
+  template<typename Rule = RuleType>
+  void LeafBaseCases(BinarySpaceTree& queryNode,
+                     BinarySpaceTree& referenceNode,
+                     const std::enable_if_t<HasLeafBaseCasesCheck<Rule,
+                         size_t(Rule::*)(BinarySpaceTree&,
+                                         BinarySpaceTree&)>::value>* = 0);
+
+  /**
+   * Compute the base cases between two leaves one pair at a time, for rules
+   * without a LeafBaseCases() method.
+   */
+  template<typename Rule = RuleType>
+  void LeafBaseCases(BinarySpaceTree& queryNode,
+                     BinarySpaceTree& referenceNode,
+                     const std::enable_if_t<!HasLeafBaseCasesCheck<Rule,
+                         size_t(Rule::*)(BinarySpaceTree&,
+                                         BinarySpaceTree&)>::value>* = 0);
+
   //! Reference to the rules with which the trees will be traversed.
   RuleType& rule;
 
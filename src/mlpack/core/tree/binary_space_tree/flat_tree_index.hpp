@@ -0,0 +1,272 @@
+/**
+ * @file flat_tree_index.hpp
+ *
+ * Definition of the FlatTreeIndex class, which stores a BinarySpaceTree in a
+ * flat binary format that can be used directly from a memory-mapped file.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_INDEX_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_INDEX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/hrectbound.hpp>
+#include <mlpack/core/tree/fixed_hrectbound.hpp>
+#include <mlpack/core/tree/ballbound.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * FlatTreeIndex writes a built BinarySpaceTree, together with the permutation
+ * of its points, as one flat block of binary data, and recreates the tree from
+ * such a block without copying the dataset.  When the block lives in a
+ * memory-mapped file (see data::MappedFile), the tree uses the mapped points in
+ * place: loading costs a pass over the nodes only, and several processes can
+ * share one copy of the points through the page cache.
+ *
+ * The block holds a header, the (permuted) points, the old-from-new mapping,
+ * one record per node and the bounds of the nodes.  The points start at a
+ * multiple of 4096 bytes from the beginning of the block, so they are page
+ * aligned if the block is.  The nodes are stored in depth-first order, and the
+ * loaded tree is frozen (see BinarySpaceTree::Freeze()).
+ *
+ * The points can also be left out of the block, so that several indexes of one
+ * dataset (for instance trees of different types or leaf sizes, or models of
+ * different kinds) do not each hold a copy of it.  Such a block is loaded
+ * with the dataset it was built on, in its original order; the tree then gets
+ * its own permuted copy of the points.  The dataset can itself come from a
+ * memory-mapped file (see data::MappedMatrix), which is only read during the
+ * load.
+ *
+ * Only trees on dense matrices (such as arma::mat or arma::fmat) with an
+ * HRectBound or a BallBound (such as KDTree and BallTree) are supported.  The
+ * points are stored with their own element type; the other values of the nodes
+ * are stored as doubles.  The loaded dataset is read-only.
+ *
+ * @code
+ * std::ofstream stream("tree.bin", std::ios::binary);
+ * FlatTreeIndex<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>::Save(
+ *     tree, oldFromNew, stream);
+ * stream.close();
+ *
+ * data::MappedFile file("tree.bin");
+ * std::vector<size_t> loadedOldFromNew;
+ * KDTree<EuclideanDistance, EmptyStatistic, arma::mat>* loadedTree =
+ *     FlatTreeIndex<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>::
+ *     Load(file.Data(), file.Size(), loadedOldFromNew);
+ * @endcode
+ *
+ * @tparam TreeType Type of the BinarySpaceTree.
+ */
+template<typename TreeType>
+class FlatTreeIndex
+{
+ public:
+  /**
+   * Write the tree to the given stream.  Offsets inside the block are relative
+   * to the position of the stream when this is called.
+   *
+   * @param tree Root of the tree to write.
+   * @param oldFromNew Mapping from the indices of the points in the tree to
+   *     their original indices; may be empty.
+   * @param stream Binary stream to write to.
+   * @param savePoints If false, the points are left out of the block, which
+   *     must then be loaded with the dataset of the tree.
+   */
+  static void Save(const TreeType& tree,
+                   const std::vector<size_t>& oldFromNew,
+                   std::ostream& stream,
+                   const bool savePoints = true);
+
+  /**
+   * Recreate a tree from a block written by Save().  The dataset of the tree
+   * points into the block, so the block must outlive the tree and must not be
+   * modified.  A std::runtime_error is thrown if the block is malformed or
+   * does not hold the points.
+   *
+   * @param data Start of the block.
+   * @param size Size of the block in bytes.
+   * @param oldFromNew Filled with the mapping stored in the block.
+   * @return The new tree, which the caller must delete.
+   */
+  static TreeType* Load(const char* data,
+                        const size_t size,
+                        std::vector<size_t>& oldFromNew);
+
+  /**
+   * Recreate a tree from a block written by Save(), with the points taken
+   * from the given dataset instead of from the block; this is how blocks
+   * without points are loaded.  The dataset must be the one the tree was
+   * built on, in its original order (that is, before the tree permuted it).
+   * The tree holds its own permuted copy of the points, so neither the block
+   * nor the dataset are needed once this returns.  A std::invalid_argument is
+   * thrown if the dataset does not have the size of the stored tree, and a
+   * std::runtime_error if the block is malformed.
+   *
+   * @param data Start of the block.
+   * @param size Size of the block in bytes.
+   * @param dataset Points of the tree, in their original order.
+   * @param oldFromNew Filled with the mapping stored in the block.
+   * @return The new tree, which the caller must delete.
+   */
+  static TreeType* Load(const char* data,
+                        const size_t size,
+                        const typename TreeType::Mat& dataset,
+                        std::vector<size_t>& oldFromNew);
+
+  /**
+   * Return whether the given block, written by Save(), holds the points of
+   * the tree.  A std::runtime_error is thrown if the block is not in a known
+   * format.
+   *
+   * @param data Start of the block.
+   * @param size Size of the block in bytes.
+   */
+  static bool HasPoints(const char* data, const size_t size);
+
+ private:
+  //! The type of the elements of the points.
+  typedef typename TreeType::Mat::elem_type PointElemType;
+
+  //! The header at the start of each block.
+  struct Header
+  {
+    //! Identifies the format.
+    char magic[8];
+    //! Version of the format.
+    uint64_t version;
+    //! The kind of bound stored for each node (see BoundKind()).
+    uint64_t boundKind;
+    //! Size in bytes of each element of the points.
+    uint64_t elementSize;
+    //! Dimensionality of the points.
+    uint64_t dimensionality;
+    //! Number of points.
+    uint64_t numPoints;
+    //! Number of nodes.
+    uint64_t numNodes;
+    //! Length of the old-from-new mapping (0 or numPoints).
+    uint64_t mappingLength;
+    //! Offset of the points.
+    uint64_t pointsOffset;
+    //! Offset of the old-from-new mapping.
+    uint64_t mappingOffset;
+    //! Offset of the node records.
+    uint64_t nodesOffset;
+    //! Offset of the bounds.
+    uint64_t boundsOffset;
+    //! Size of the block.
+    uint64_t size;
+    //! Whether the points were left out of the block (always 0 in version 1,
+    //! where this was padding).
+    uint64_t externalPoints;
+  };
+
+  //! The record stored for each node.
+  struct NodeRecord
+  {
+    uint64_t begin;
+    uint64_t count;
+    //! Index of the left child, or NoChild.
+    uint64_t left;
+    //! Index of the right child, or NoChild.
+    uint64_t right;
+    double parentDistance;
+    double furthestDescendantDistance;
+    double minimumBoundDistance;
+    double unused;
+  };
+
+  //! Marks a missing child in a NodeRecord.
+  static const uint64_t NoChild = uint64_t(-1);
+
+  //! Fill the offsets and the size in the header from its other fields.
+  static void LayOut(Header& header);
+
+  //! Read and check the header of a block.
+  static Header ReadHeader(const char* data, const size_t size);
+
+  //! Build the tree described by the block, with the given dataset object,
+  //! which the root takes ownership of once the tree is complete.  If the
+  //! block is malformed, the dataset object is destroyed with the pointer.
+  static TreeType* Build(const char* data,
+                         const Header& header,
+                         std::unique_ptr<typename TreeType::Mat> dataset,
+                         std::vector<size_t>& oldFromNew);
+
+  //! Destroy a tree that Build() could not complete, without destroying the
+  //! dataset object, which is still owned by Build().
+  static void Discard(TreeType* root);
+
+  //! Get the nodes of the tree in depth-first order.
+  static void Nodes(const TreeType& tree, std::vector<const TreeType*>& nodes);
+
+  //! Identify the HRectBound.
+  template<typename MetricType, typename ElemType>
+  static uint64_t BoundKind(const bound::HRectBound<MetricType, ElemType>&)
+  { return 0; }
+  //! Identify the FixedHRectBound, which is stored like an HRectBound.
+  template<size_t FixedDim, typename MetricType, typename ElemType>
+  static uint64_t BoundKind(
+      const bound::FixedHRectBound<FixedDim, MetricType, ElemType>&)
+  { return 0; }
+  //! Identify the BallBound.
+  template<typename MetricType, typename VecType>
+  static uint64_t BoundKind(const bound::BallBound<MetricType, VecType>&)
+  { return 1; }
+
+  //! Number of values stored for a bound of the given kind.
+  static size_t BoundSize(const uint64_t kind, const size_t dimensionality)
+  { return (kind == 0) ? 2 * dimensionality : dimensionality + 1; }
+
+  //! Store the ranges of an HRectBound.
+  template<typename MetricType, typename ElemType>
+  static void WriteBound(const bound::HRectBound<MetricType, ElemType>& b,
+                         std::vector<double>& values);
+  //! Store the ranges of a FixedHRectBound.
+  template<size_t FixedDim, typename MetricType, typename ElemType>
+  static void WriteBound(
+      const bound::FixedHRectBound<FixedDim, MetricType, ElemType>& b,
+      std::vector<double>& values);
+  //! Store the center and radius of a BallBound.
+  template<typename MetricType, typename VecType>
+  static void WriteBound(const bound::BallBound<MetricType, VecType>& b,
+                         std::vector<double>& values);
+
+  //! Restore an HRectBound.
+  template<typename MetricType, typename ElemType>
+  static void ReadBound(bound::HRectBound<MetricType, ElemType>& b,
+                        const size_t dimensionality,
+                        const double* values);
+  //! Restore a FixedHRectBound.
+  template<size_t FixedDim, typename MetricType, typename ElemType>
+  static void ReadBound(
+      bound::FixedHRectBound<FixedDim, MetricType, ElemType>& b,
+      const size_t dimensionality,
+      const double* values);
+  //! Restore a BallBound.
+  template<typename MetricType, typename VecType>
+  static void ReadBound(bound::BallBound<MetricType, VecType>& b,
+                        const size_t dimensionality,
+                        const double* values);
+
+  //! Build the statistic of a node whose children are complete.
+  template<typename StatisticType>
+  static void BuildStatistic(StatisticType& stat, TreeType& node)
+  { stat = StatisticType(node); }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_tree_index_impl.hpp"
+
+#endif
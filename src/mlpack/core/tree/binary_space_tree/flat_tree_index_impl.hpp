@@ -0,0 +1,451 @@
+/**
+ * @file flat_tree_index_impl.hpp
+ *
+ * Implementation of the FlatTreeIndex class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_INDEX_IMPL_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_INDEX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_tree_index.hpp"
+
+#include <cstring>
+#include <stack>
+#include <unordered_map>
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+void FlatTreeIndex<TreeType>::Save(const TreeType& tree,
+                                   const std::vector<size_t>& oldFromNew,
+                                   std::ostream& stream,
+                                   const bool savePoints)
+{
+  static_assert(arma::is_Mat<typename TreeType::Mat>::value,
+      "FlatTreeIndex only supports trees built on dense matrices");
+
+  if (tree.Parent() != NULL)
+    throw std::invalid_argument("FlatTreeIndex::Save(): the given node is not "
+        "the root of a tree");
+
+  const typename TreeType::Mat& dataset = tree.Dataset();
+  if (!oldFromNew.empty() && oldFromNew.size() != dataset.n_cols)
+    throw std::invalid_argument("FlatTreeIndex::Save(): the mapping does not "
+        "have one entry for each point");
+
+  std::vector<const TreeType*> nodes;
+  Nodes(tree, nodes);
+
+  std::unordered_map<const TreeType*, uint64_t> indices;
+  indices.reserve(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i)
+    indices[nodes[i]] = i;
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::memcpy(header.magic, "MLPKFTI", 8);
+  header.version = 2;
+  header.boundKind = BoundKind(tree.Bound());
+  header.elementSize = sizeof(PointElemType);
+  header.dimensionality = dataset.n_rows;
+  header.numPoints = dataset.n_cols;
+  header.numNodes = nodes.size();
+  header.mappingLength = oldFromNew.size();
+  header.externalPoints = savePoints ? 0 : 1;
+  LayOut(header);
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  const std::vector<char> padding(header.pointsOffset - sizeof(Header), 0);
+  stream.write(padding.data(), padding.size());
+
+  if (savePoints)
+  {
+    stream.write(reinterpret_cast<const char*>(dataset.memptr()),
+        dataset.n_elem * sizeof(PointElemType));
+    const std::vector<char> pointsPadding(header.mappingOffset -
+        header.pointsOffset - dataset.n_elem * sizeof(PointElemType), 0);
+    stream.write(pointsPadding.data(), pointsPadding.size());
+  }
+
+  const std::vector<uint64_t> mapping(oldFromNew.begin(), oldFromNew.end());
+  stream.write(reinterpret_cast<const char*>(mapping.data()),
+      mapping.size() * sizeof(uint64_t));
+
+  std::vector<NodeRecord> records(nodes.size());
+  std::vector<double> bounds;
+  bounds.reserve(nodes.size() * BoundSize(header.boundKind, dataset.n_rows));
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    const TreeType& node = *nodes[i];
+    records[i].begin = node.begin;
+    records[i].count = node.count;
+    records[i].left = node.left ? indices[node.left] : NoChild;
+    records[i].right = node.right ? indices[node.right] : NoChild;
+    records[i].parentDistance = node.parentDistance;
+    records[i].furthestDescendantDistance = node.furthestDescendantDistance;
+    records[i].minimumBoundDistance = node.minimumBoundDistance;
+    records[i].unused = 0.0;
+
+    WriteBound(node.bound, bounds);
+  }
+
+  stream.write(reinterpret_cast<const char*>(records.data()),
+      records.size() * sizeof(NodeRecord));
+  stream.write(reinterpret_cast<const char*>(bounds.data()),
+      bounds.size() * sizeof(double));
+
+  if (!stream)
+    throw std::runtime_error("FlatTreeIndex::Save(): error writing the tree");
+}
+
+template<typename TreeType>
+TreeType* FlatTreeIndex<TreeType>::Load(const char* data,
+                                        const size_t size,
+                                        std::vector<size_t>& oldFromNew)
+{
+  static_assert(arma::is_Mat<typename TreeType::Mat>::value,
+      "FlatTreeIndex only supports trees built on dense matrices");
+
+  const Header header = ReadHeader(data, size);
+  if (header.externalPoints)
+    throw std::runtime_error("FlatTreeIndex::Load(): block does not hold the "
+        "points of the tree, so the dataset must be given");
+
+  // The dataset object aliases the points in the block.
+  std::unique_ptr<typename TreeType::Mat> dataset(new typename TreeType::Mat(
+      const_cast<PointElemType*>(reinterpret_cast<const PointElemType*>(data +
+      header.pointsOffset)), header.dimensionality, header.numPoints, false,
+      true));
+
+  return Build(data, header, std::move(dataset), oldFromNew);
+}
+
+template<typename TreeType>
+TreeType* FlatTreeIndex<TreeType>::Load(const char* data,
+                                        const size_t size,
+                                        const typename TreeType::Mat& dataset,
+                                        std::vector<size_t>& oldFromNew)
+{
+  static_assert(arma::is_Mat<typename TreeType::Mat>::value,
+      "FlatTreeIndex only supports trees built on dense matrices");
+
+  const Header header = ReadHeader(data, size);
+  if (dataset.n_rows != header.dimensionality ||
+      dataset.n_cols != header.numPoints)
+  {
+    std::ostringstream oss;
+    oss << "FlatTreeIndex::Load(): the given dataset has size "
+        << dataset.n_rows << "x" << dataset.n_cols << ", but the stored tree "
+        << "was built on a " << header.dimensionality << "x"
+        << header.numPoints << " dataset";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Put the points in the order of the tree.
+  const uint64_t* mapping =
+      reinterpret_cast<const uint64_t*>(data + header.mappingOffset);
+  std::unique_ptr<typename TreeType::Mat> points;
+  if (header.mappingLength == 0)
+  {
+    points.reset(new typename TreeType::Mat(dataset));
+  }
+  else
+  {
+    for (size_t i = 0; i < header.mappingLength; ++i)
+      if (mapping[i] >= header.numPoints)
+        throw std::runtime_error("FlatTreeIndex::Load(): block is malformed");
+
+    points.reset(new typename TreeType::Mat(dataset.n_rows, dataset.n_cols));
+    #pragma omp parallel for num_threads(ParallelThreads())
+    for (omp_size_t i = 0; i < (omp_size_t) points->n_cols; ++i)
+      points->col(i) = dataset.col(mapping[i]);
+  }
+
+  return Build(data, header, std::move(points), oldFromNew);
+}
+
+template<typename TreeType>
+bool FlatTreeIndex<TreeType>::HasPoints(const char* data, const size_t size)
+{
+  return ReadHeader(data, size).externalPoints == 0;
+}
+
+template<typename TreeType>
+typename FlatTreeIndex<TreeType>::Header FlatTreeIndex<TreeType>::ReadHeader(
+    const char* data,
+    const size_t size)
+{
+  if (size < sizeof(Header))
+    throw std::runtime_error("FlatTreeIndex::Load(): block is too small");
+
+  // In blocks of version 1, externalPoints is read from the padding after the
+  // header, which is zero.
+  Header header;
+  std::memcpy(&header, data, sizeof(Header));
+  if (std::memcmp(header.magic, "MLPKFTI", 8) != 0 ||
+      (header.version != 1 && header.version != 2))
+    throw std::runtime_error("FlatTreeIndex::Load(): block does not hold a "
+        "tree in a known format");
+
+  if (header.elementSize != sizeof(PointElemType))
+    throw std::runtime_error("FlatTreeIndex::Load(): block holds points with a "
+        "different element type");
+
+  // The offsets must be exactly the ones Save() would have used.
+  Header expected = header;
+  LayOut(expected);
+  if (header.numNodes == 0 || header.size > size ||
+      std::memcmp(&header, &expected, sizeof(Header)) != 0 ||
+      (header.mappingLength != 0 && header.mappingLength != header.numPoints) ||
+      header.externalPoints > 1 ||
+      (header.version == 1 && header.externalPoints != 0))
+    throw std::runtime_error("FlatTreeIndex::Load(): block is malformed");
+
+  return header;
+}
+
+template<typename TreeType>
+TreeType* FlatTreeIndex<TreeType>::Build(
+    const char* data,
+    const Header& header,
+    std::unique_ptr<typename TreeType::Mat> dataset,
+    std::vector<size_t>& oldFromNew)
+{
+  const size_t dimensionality = header.dimensionality;
+  const size_t numNodes = header.numNodes;
+  const size_t boundSize = BoundSize(header.boundKind, dimensionality);
+  const NodeRecord* records =
+      reinterpret_cast<const NodeRecord*>(data + header.nodesOffset);
+  const double* bounds =
+      reinterpret_cast<const double*>(data + header.boundsOffset);
+
+  // The root owns the block of the other nodes.  The dataset object stays
+  // owned by this function until the whole block has been checked, so that
+  // Discard() can clean up a partly built tree.
+  TreeType* root = new TreeType();
+  if (header.boundKind != BoundKind(root->bound))
+  {
+    Discard(root);
+    throw std::runtime_error("FlatTreeIndex::Load(): block holds a tree with "
+        "a different bound type");
+  }
+
+  if (numNodes > 1)
+  {
+    root->frozenNodes = static_cast<TreeType*>(
+        ::operator new((numNodes - 1) * sizeof(TreeType)));
+    for (size_t i = 0; i < numNodes - 1; ++i)
+      new (root->frozenNodes + i) TreeType();
+    root->numFrozenNodes = numNodes - 1;
+  }
+
+  for (size_t i = 0; i < numNodes; ++i)
+  {
+    const NodeRecord& record = records[i];
+    TreeType& node = (i == 0) ? *root : root->frozenNodes[i - 1];
+
+    // Children always come after their parent, and each node must hold a
+    // valid range of points.
+    if ((record.left != NoChild &&
+         (record.left <= i || record.left >= numNodes)) ||
+        (record.right != NoChild &&
+         (record.right <= i || record.right >= numNodes)) ||
+        (record.left == NoChild && record.right != NoChild) ||
+        record.begin > header.numPoints ||
+        record.count > header.numPoints - record.begin)
+    {
+      Discard(root);
+      throw std::runtime_error("FlatTreeIndex::Load(): block is malformed");
+    }
+
+    node.begin = record.begin;
+    node.count = record.count;
+    node.parentDistance = record.parentDistance;
+    node.furthestDescendantDistance = record.furthestDescendantDistance;
+    node.minimumBoundDistance = record.minimumBoundDistance;
+    node.dataset = dataset.get();
+    ReadBound(node.bound, dimensionality, bounds + i * boundSize);
+
+    if (record.left != NoChild)
+    {
+      node.left = root->frozenNodes + (record.left - 1);
+      node.left->parent = &node;
+    }
+    if (record.right != NoChild)
+    {
+      node.right = root->frozenNodes + (record.right - 1);
+      node.right->parent = &node;
+    }
+  }
+
+  // Every node other than the root must have been reached from its parent.
+  for (size_t i = 0; i < numNodes - 1; ++i)
+  {
+    if (root->frozenNodes[i].parent == NULL)
+    {
+      Discard(root);
+      throw std::runtime_error("FlatTreeIndex::Load(): block is malformed");
+    }
+  }
+
+  // The statistics are built bottom-up, as in the tree constructors.
+  for (size_t i = numNodes; i > 0; --i)
+  {
+    TreeType& node = (i == 1) ? *root : root->frozenNodes[i - 2];
+    BuildStatistic(node.stat, node);
+  }
+
+  const uint64_t* mapping =
+      reinterpret_cast<const uint64_t*>(data + header.mappingOffset);
+  oldFromNew.assign(mapping, mapping + header.mappingLength);
+
+  // The tree is complete, so the root takes over the dataset object.
+  dataset.release();
+  return root;
+}
+
+template<typename TreeType>
+void FlatTreeIndex<TreeType>::Discard(TreeType* root)
+{
+  // Nodes without a parent (the root, and nodes that were never reached from
+  // their parent) would delete the dataset object.
+  root->dataset = NULL;
+  for (size_t i = 0; i < root->numFrozenNodes; ++i)
+    root->frozenNodes[i].dataset = NULL;
+
+  delete root;
+}
+
+template<typename TreeType>
+void FlatTreeIndex<TreeType>::LayOut(Header& header)
+{
+  // The points start on a page boundary.
+  header.pointsOffset = ((sizeof(Header) + 4095) / 4096) * 4096;
+  // The mapping and everything after it are aligned to 8 bytes, which the
+  // points of a single-precision tree may not end on.
+  const size_t pointsSize = header.externalPoints ? 0 :
+      header.dimensionality * header.numPoints * header.elementSize;
+  header.mappingOffset = header.pointsOffset + ((pointsSize + 7) / 8) * 8;
+  header.nodesOffset = header.mappingOffset +
+      header.mappingLength * sizeof(uint64_t);
+  header.boundsOffset = header.nodesOffset +
+      header.numNodes * sizeof(NodeRecord);
+  header.size = header.boundsOffset + header.numNodes *
+      BoundSize(header.boundKind, header.dimensionality) * sizeof(double);
+}
+
+template<typename TreeType>
+void FlatTreeIndex<TreeType>::Nodes(const TreeType& tree,
+                                    std::vector<const TreeType*>& nodes)
+{
+  std::stack<const TreeType*> stack;
+  stack.push(&tree);
+  while (!stack.empty())
+  {
+    const TreeType* node = stack.top();
+    stack.pop();
+    nodes.push_back(node);
+
+    // Push the right child first, so that the left child is visited first.
+    if (node->right)
+      stack.push(node->right);
+    if (node->left)
+      stack.push(node->left);
+  }
+}
+
+template<typename TreeType>
+template<typename MetricType, typename ElemType>
+void FlatTreeIndex<TreeType>::WriteBound(
+    const bound::HRectBound<MetricType, ElemType>& b,
+    std::vector<double>& values)
+{
+  for (size_t d = 0; d < b.Dim(); ++d)
+  {
+    values.push_back(b[d].Lo());
+    values.push_back(b[d].Hi());
+  }
+}
+
+template<typename TreeType>
+template<size_t FixedDim, typename MetricType, typename ElemType>
+void FlatTreeIndex<TreeType>::WriteBound(
+    const bound::FixedHRectBound<FixedDim, MetricType, ElemType>& b,
+    std::vector<double>& values)
+{
+  for (size_t d = 0; d < FixedDim; ++d)
+  {
+    values.push_back(b[d].Lo());
+    values.push_back(b[d].Hi());
+  }
+}
+
+template<typename TreeType>
+template<typename MetricType, typename VecType>
+void FlatTreeIndex<TreeType>::WriteBound(
+    const bound::BallBound<MetricType, VecType>& b,
+    std::vector<double>& values)
+{
+  for (size_t d = 0; d < b.Dim(); ++d)
+    values.push_back(b.Center()[d]);
+  values.push_back(b.Radius());
+}
+
+template<typename TreeType>
+template<typename MetricType, typename ElemType>
+void FlatTreeIndex<TreeType>::ReadBound(
+    bound::HRectBound<MetricType, ElemType>& b,
+    const size_t dimensionality,
+    const double* values)
+{
+  b = bound::HRectBound<MetricType, ElemType>(dimensionality);
+
+  ElemType minWidth = std::numeric_limits<ElemType>::max();
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    b[d] = math::RangeType<ElemType>(values[2 * d], values[2 * d + 1]);
+    minWidth = std::min(minWidth, b[d].Width());
+  }
+  b.MinWidth() = (dimensionality > 0) ? minWidth : 0;
+}
+
+template<typename TreeType>
+template<size_t FixedDim, typename MetricType, typename ElemType>
+void FlatTreeIndex<TreeType>::ReadBound(
+    bound::FixedHRectBound<FixedDim, MetricType, ElemType>& b,
+    const size_t dimensionality,
+    const double* values)
+{
+  // This throws if the index has another dimensionality.
+  b = bound::FixedHRectBound<FixedDim, MetricType, ElemType>(dimensionality);
+
+  for (size_t d = 0; d < FixedDim; ++d)
+    b[d] = math::RangeType<ElemType>(values[2 * d], values[2 * d + 1]);
+  b.MinWidth() = b[0].Width();
+  for (size_t d = 1; d < FixedDim; ++d)
+    b.MinWidth() = std::min(b.MinWidth(), b[d].Width());
+}
+
+template<typename TreeType>
+template<typename MetricType, typename VecType>
+void FlatTreeIndex<TreeType>::ReadBound(
+    bound::BallBound<MetricType, VecType>& b,
+    const size_t dimensionality,
+    const double* values)
+{
+  b = bound::BallBound<MetricType, VecType>(dimensionality);
+  for (size_t d = 0; d < dimensionality; ++d)
+    b.Center()[d] = values[d];
+  b.Radius() = values[dimensionality];
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -16,6 +16,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/perform_split.hpp>
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -119,6 +120,14 @@ class MeanSplit
   }
 };
 
+//! MeanSplit supports parallel builds (see SplitTraits).
+template<typename BoundType, typename MatType>
+class SplitTraits<MeanSplit<BoundType, MatType>>
+{
+ public:
+  static const bool SupportsParallelBuild = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -0,0 +1,132 @@
+/**
+ * @file parallel_dual_tree_traverser.hpp
+ *
+ * Defines the ParallelDualTreeTraverser for the BinarySpaceTree tree type.
+ * This is a nested class of BinarySpaceTree which splits the query tree into a
+ * set of disjoint subtrees and traverses each of those against the reference
+ * tree with the regular depth-first DualTreeTraverser, using several threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "binary_space_tree.hpp"
+#include "dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A dual-tree traverser for binary space trees that uses multiple threads.
+ * The query tree is cut into a number of disjoint subtrees (several per
+ * thread), and each subtree is traversed against the reference node by a
+ * worker running the standard DualTreeTraverser.  Subtrees are handed out
+ * dynamically, so a thread that finishes early picks up the next pending
+ * subtree.
+ *
+ * Each worker receives its own copy of the rules, made with the RuleType copy
+ * constructor.  That copy must share the results of the original rules object
+ * (as, e.g., NeighborSearchRules and RangeSearchRules do), but may hold its
+ * own traversal information and counters.  Because the subtrees are disjoint,
+ * no two workers ever update the results or the statistic of the same query
+ * point or query node.  The statistics of query nodes above the cut are not
+ * updated by the traversal.
+ *
+ * If mlpack was compiled without OpenMP, or only one thread is requested, this
+ * is equivalent to the DualTreeTraverser.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+class BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+                      SplitType>::ParallelDualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel dual-tree traverser with the given rule set.
+   *
+   * @param rule Rules to traverse with.
+   * @param numThreads Number of threads to use; if 0, the number of threads
+   *     available to OpenMP is used.
+   */
+  ParallelDualTreeTraverser(RuleType& rule, const size_t numThreads = 0);
+
+  /**
+   * Traverse the two trees.  This does not reset the number of prunes.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  void Traverse(BinarySpaceTree& queryNode,
+                BinarySpaceTree& referenceNode);
+
+  //! Get the number of threads used for traversal.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for traversal.
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of visited combinations.
+  size_t NumVisited() const { return numVisited; }
+  //! Modify the number of visited combinations.
+  size_t& NumVisited() { return numVisited; }
+
+  //! Get the number of times a node combination was scored.
+  size_t NumScores() const { return numScores; }
+  //! Modify the number of times a node combination was scored.
+  size_t& NumScores() { return numScores; }
+
+  //! Get the number of times a base case was calculated.
+  size_t NumBaseCases() const { return numBaseCases; }
+  //! Modify the number of times a base case was calculated.
+  size_t& NumBaseCases() { return numBaseCases; }
+
+ private:
+  /**
+   * Collect the disjoint query subtrees that will be handed to the workers.
+   * Nodes are split until they hold no more than maxDescendants points.
+   */
+  void CollectSubtrees(BinarySpaceTree& queryNode,
+                       const size_t maxDescendants,
+                       std::vector<BinarySpaceTree*>& subtrees) const;
+
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! The number of threads to use.
+  size_t numThreads;
+
+  //! The number of prunes.
+  size_t numPrunes;
+
+  //! The number of node combinations that have been visited during traversal.
+  size_t numVisited;
+
+  //! The number of times a node combination was scored.
+  size_t numScores;
+
+  //! The number of times a base case was calculated.
+  size_t numBaseCases;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_dual_tree_traverser_impl.hpp"
+
+#endif // MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
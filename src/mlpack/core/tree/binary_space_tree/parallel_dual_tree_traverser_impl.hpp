@@ -0,0 +1,141 @@
+/**
+ * @file parallel_dual_tree_traverser_impl.hpp
+ *
+ * Implementation of the ParallelDualTreeTraverser for BinarySpaceTree.  The
+ * query tree is cut into disjoint subtrees, which are traversed against the
+ * reference tree in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_dual_tree_traverser.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace tree {
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ParallelDualTreeTraverser<RuleType>::ParallelDualTreeTraverser(
+    RuleType& rule,
+    const size_t numThreads) :
+    rule(rule),
+    numThreads(numThreads),
+    numPrunes(0),
+    numVisited(0),
+    numScores(0),
+    numBaseCases(0)
+{ /* Nothing to do. */ }
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ParallelDualTreeTraverser<RuleType>::Traverse(
+    BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>&
+        queryNode,
+    BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>&
+        referenceNode)
+{
+  const size_t threads = ParallelThreads(numThreads);
+
+  // If there is nothing to split, fall back to the serial traversal.
+  if (threads <= 1 || queryNode.IsLeaf())
+  {
+    DualTreeTraverser<RuleType> traverser(rule);
+    traverser.Traverse(queryNode, referenceNode);
+
+    numPrunes += traverser.NumPrunes();
+    numVisited += traverser.NumVisited();
+    numScores += traverser.NumScores();
+    numBaseCases += traverser.NumBaseCases();
+    return;
+  }
+
+  // Cut the query tree so that there are several subtrees per thread.  The
+  // extra subtrees keep all threads busy when some subtrees are much cheaper to
+  // traverse than others.
+  std::vector<BinarySpaceTree*> subtrees;
+  const size_t maxDescendants = std::max(queryNode.NumDescendants() /
+      (8 * threads), (size_t) 1);
+  CollectSubtrees(queryNode, maxDescendants, subtrees);
+
+  size_t prunes = 0, visited = 0, scores = 0, baseCases = 0;
+  size_t ruleScores = 0, ruleBaseCases = 0;
+
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1) \
+      reduction(+:prunes, visited, scores, baseCases, ruleScores, \
+                ruleBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+  {
+    // Each worker has its own rules object, which shares its results with the
+    // original rules object.
+    RuleType workerRule(rule);
+    const size_t startScores = workerRule.Scores();
+    const size_t startBaseCases = workerRule.BaseCases();
+
+    DualTreeTraverser<RuleType> traverser(workerRule);
+    traverser.Traverse(*subtrees[i], referenceNode);
+
+    prunes += traverser.NumPrunes();
+    visited += traverser.NumVisited();
+    scores += traverser.NumScores();
+    baseCases += traverser.NumBaseCases();
+    ruleScores += workerRule.Scores() - startScores;
+    ruleBaseCases += workerRule.BaseCases() - startBaseCases;
+  }
+
+  numPrunes += prunes;
+  numVisited += visited;
+  numScores += scores;
+  numBaseCases += baseCases;
+  rule.Scores() += ruleScores;
+  rule.BaseCases() += ruleBaseCases;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ParallelDualTreeTraverser<RuleType>::CollectSubtrees(
+    BinarySpaceTree& queryNode,
+    const size_t maxDescendants,
+    std::vector<BinarySpaceTree*>& subtrees) const
+{
+  if (queryNode.IsLeaf() || queryNode.NumDescendants() <= maxDescendants)
+  {
+    subtrees.push_back(&queryNode);
+    return;
+  }
+
+  CollectSubtrees(*queryNode.Left(), maxDescendants, subtrees);
+  CollectSubtrees(*queryNode.Right(), maxDescendants, subtrees);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif // MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
@@ -0,0 +1,117 @@
+/**
+ * @file shared_tree.hpp
+ *
+ * Definition of the SharedTree class, a reference-counted handle to one built
+ * BinarySpaceTree that several algorithms can search at the same time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SHARED_TREE_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SHARED_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "flat_tree_index.hpp"
+
+#include <memory>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A SharedTree holds the structure and the (permuted) points of one built
+ * BinarySpaceTree, and can hand out any number of trees that use that
+ * structure and those points in place.  This lets a pipeline that runs, e.g.,
+ * k-nearest-neighbor search, k-furthest-neighbor search, range search and
+ * DBSCAN on the same reference set build the tree once and keep one permuted
+ * copy of the points, even though each of those algorithms uses a different
+ * statistic type.
+ *
+ * The handed out trees each have their own nodes and statistics (the nodes are
+ * recreated from the shared structure with one pass, as FlatTreeIndex does),
+ * so they can be used concurrently.  Their points are read-only.  Copying a
+ * SharedTree is cheap: the copies refer to the same data, which is freed when
+ * the last copy is destroyed.  NeighborSearch, RangeSearch and DBSCAN accept a
+ * SharedTree directly, and keep a copy of the handle for as long as they use
+ * the data.
+ *
+ * A tree can be handed out as any BinarySpaceTree type with the same bound
+ * type and element type as the tree the SharedTree was made from; only the
+ * statistic type (and the split type, which is not used after building) may
+ * differ.
+ *
+ * @code
+ * std::vector<size_t> oldFromNew;
+ * KDTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(data, oldFromNew);
+ * SharedTree shared(tree, oldFromNew);
+ *
+ * KNN knn;
+ * knn.Train(shared);
+ * RangeSearch<> rs;
+ * rs.Train(shared);
+ * @endcode
+ */
+class SharedTree
+{
+ public:
+  //! Create an empty handle, which does not refer to any tree.
+  SharedTree() { }
+
+  /**
+   * Copy the structure and the points of the given tree into a new SharedTree.
+   * The given tree is not needed afterwards.  The mapping must have as many
+   * entries as the tree has points; trees searched through the SharedTree map
+   * their results back to the original indices with it.
+   *
+   * @param tree Root of the tree to share.
+   * @param oldFromNew Mapping from the indices of the points in the tree to
+   *     their original indices.
+   */
+  template<typename TreeType>
+  SharedTree(const TreeType& tree, const std::vector<size_t>& oldFromNew);
+
+  /**
+   * Create a new tree that uses the shared structure and points.  The tree
+   * refers to data owned by this handle, so a copy of the handle must outlive
+   * it.  A std::runtime_error is thrown if the tree type uses a different bound
+   * or element type than the shared tree, and a std::invalid_argument if the
+   * handle is empty.
+   *
+   * @param oldFromNew Filled with the mapping given at construction.
+   * @return The new (frozen) tree, which the caller must delete.
+   */
+  template<typename TreeType>
+  TreeType* Tree(std::vector<size_t>& oldFromNew) const;
+
+  //! Return whether the handle refers to no tree.
+  bool Empty() const { return !data; }
+
+  //! Return the number of handles that refer to the same tree.
+  size_t UseCount() const { return data ? data.use_count() : 0; }
+
+  //! Get the mapping from the indices in the shared tree to the original ones.
+  const std::vector<size_t>& OldFromNew() const;
+
+ private:
+  //! The shared data.
+  struct Data
+  {
+    //! The tree, in the format written by FlatTreeIndex::Save().
+    std::string block;
+    //! The mapping given at construction.
+    std::vector<size_t> oldFromNew;
+  };
+
+  //! The shared data, or NULL for an empty handle.
+  std::shared_ptr<const Data> data;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "shared_tree_impl.hpp"
+
+#endif
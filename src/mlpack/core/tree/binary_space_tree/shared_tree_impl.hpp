@@ -0,0 +1,66 @@
+/**
+ * @file shared_tree_impl.hpp
+ *
+ * Implementation of the SharedTree class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SHARED_TREE_IMPL_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SHARED_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "shared_tree.hpp"
+
+#include <sstream>
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+SharedTree::SharedTree(const TreeType& tree,
+                       const std::vector<size_t>& oldFromNew)
+{
+  if (oldFromNew.size() != tree.Dataset().n_cols)
+    throw std::invalid_argument("SharedTree::SharedTree(): the mapping does "
+        "not have one entry for each point");
+
+  // The mapping is kept outside of the block, so that it can be handed out
+  // without copying or decoding it.
+  std::ostringstream stream(std::ios::binary);
+  FlatTreeIndex<TreeType>::Save(tree, std::vector<size_t>(), stream);
+
+  std::shared_ptr<Data> newData = std::make_shared<Data>();
+  newData->block = stream.str();
+  newData->oldFromNew = oldFromNew;
+  data = newData;
+}
+
+template<typename TreeType>
+TreeType* SharedTree::Tree(std::vector<size_t>& oldFromNew) const
+{
+  if (!data)
+    throw std::invalid_argument("SharedTree::Tree(): the handle is empty");
+
+  // The mapping stored in the block is empty.
+  TreeType* tree = FlatTreeIndex<TreeType>::Load(data->block.data(),
+      data->block.size(), oldFromNew);
+  oldFromNew = data->oldFromNew;
+  return tree;
+}
+
+inline const std::vector<size_t>& SharedTree::OldFromNew() const
+{
+  if (!data)
+    throw std::invalid_argument("SharedTree::OldFromNew(): the handle is "
+        "empty");
+
+  return data->oldFromNew;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
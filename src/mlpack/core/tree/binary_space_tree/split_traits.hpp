@@ -0,0 +1,50 @@
+/**
+ * @file split_traits.hpp
+ *
+ * This file defines the SplitTraits class, which describes properties of the
+ * split types used by BinarySpaceTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The SplitTraits class provides compile-time information about a split type
+ * used by BinarySpaceTree.  Each split type may specialize this class to
+ * override the default (conservative) values.
+ *
+ * @code
+ * template<typename BoundType, typename MatType>
+ * class SplitTraits<MySplit<BoundType, MatType>>
+ * {
+ *  public:
+ *   static const bool SupportsParallelBuild = true;
+ * };
+ * @endcode
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * This is true if the split of a node depends only on the points held in
+   * that node, and if the split can be computed and performed for disjoint
+   * nodes at the same time.  In that case, the children of large nodes are
+   * built in parallel, and the resulting tree (and point mapping) is the same
+   * as the serially built tree.  Splits that draw random numbers or keep state
+   * between nodes must leave this false.
+   */
+  static const bool SupportsParallelBuild = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
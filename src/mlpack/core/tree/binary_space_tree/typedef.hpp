@@ -79,6 +79,42 @@ using MeanSplitKDTree = BinarySpaceTree<MetricType,
                                         bound::HRectBound,
                                         MeanSplit>;
 
+/**
+ * A midpoint-split kd-tree for two-dimensional data, such as geospatial data.
+ * This is the same tree as the KDTree, but the bound of each node is a
+ * bound::FixedHRectBound, which stores its two ranges in the node itself and
+ * computes distances without a loop over a runtime number of dimensions.
+ * Building the tree on data with another number of dimensions throws a
+ * std::invalid_argument exception.  For the point-to-point distances to be
+ * unrolled too, use a metric::FixedLMetric, such as
+ * metric::FixedEuclideanDistance<2>.
+ *
+ * This template typedef satisfies the TreeType policy API.
+ *
+ * @see @ref trees, BinarySpaceTree, KDTree, KDTree3D
+ */
+template<typename MetricType, typename StatisticType, typename MatType>
+using KDTree2D = BinarySpaceTree<MetricType,
+                                 StatisticType,
+                                 MatType,
+                                 bound::HRectBound2D,
+                                 MidpointSplit>;
+
+/**
+ * A midpoint-split kd-tree for three-dimensional data, such as point clouds.
+ * This is the same as the KDTree2D, for three dimensions.
+ *
+ * This template typedef satisfies the TreeType policy API.
+ *
+ * @see @ref trees, BinarySpaceTree, KDTree, KDTree2D
+ */
+template<typename MetricType, typename StatisticType, typename MatType>
+using KDTree3D = BinarySpaceTree<MetricType,
+                                 StatisticType,
+                                 MatType,
+                                 bound::HRectBound3D,
+                                 MidpointSplit>;
+
 /**
  * A midpoint-split ball tree.  This tree holds its points only in the leaves,
  * similar to the KDTree and MeanSplitKDTree.  However, the bounding shape of
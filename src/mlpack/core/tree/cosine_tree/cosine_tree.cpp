@@ -11,6 +11,8 @@
  */
 #include "cosine_tree.hpp"
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <mlpack/core/util/reduction_partials.hpp>
 
 #include <boost/math/distributions/normal.hpp>
 
@@ -29,7 +31,8 @@ CosineTree::CosineTree(const arma::mat& dataset) :
   l2NormsSquared.zeros(numColumns);
 
   // Set indices and calculate squared norms of the columns.
-  for (size_t i = 0; i < numColumns; i++)
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) numColumns; i++)
   {
     indices[i] = i;
     double l2Norm = arma::norm(dataset.col(i), 2);
@@ -75,12 +78,17 @@ CosineTree::CosineTree(CosineTree& parentNode,
 
 CosineTree::CosineTree(const arma::mat& dataset,
                        const double epsilon,
-                       const double delta) :
+                       const double delta,
+                       const size_t batchSize) :
     dataset(dataset),
     delta(delta),
     left(NULL),
     right(NULL)
 {
+  if (batchSize == 0)
+    throw std::invalid_argument("CosineTree::CosineTree(): the batch size must "
+        "be greater than 0");
+
   // Declare the cosine tree priority queue.
   CosineNodeQueue treeQueue;
 
@@ -97,14 +105,18 @@ CosineTree::CosineTree(const arma::mat& dataset,
   while (treeQueue.top() &&
          (monteCarloError > epsilon * root.FrobNormSquared()))
   {
-    // Pop node from queue with highest projection error.
-    CosineTree* currentNode;
-    currentNode = treeQueue.top();
-    treeQueue.pop();
+    // Pop the nodes from the queue with the highest projection errors.
+    std::vector<CosineTree*> splitNodes;
+    do
+    {
+      splitNodes.push_back(treeQueue.top());
+      treeQueue.pop();
+    } while (splitNodes.size() < batchSize && !treeQueue.empty() &&
+        treeQueue.top()->L2Error() != 0.0);
 
     // If the priority is 0, we can't improve anything, and we can assume that
     // we've done the best we can.
-    if (currentNode->L2Error() == 0.0)
+    if (splitNodes[0]->L2Error() == 0.0)
     {
       Log::Warn << "CosineTree::CosineTree(): could not build tree to "
           << "desired relative error " << epsilon << "; failing with estimated "
@@ -113,34 +125,56 @@ CosineTree::CosineTree(const arma::mat& dataset,
       break;
     }
 
-    // Split the node into left and right children.  We assume that this cannot
-    // fail; it might fail if L2Error() is 0, but we have already avoided that
-    // case.
-    currentNode->CosineNodeSplit();
+    // Split the nodes into left and right children.  We assume that this
+    // cannot fail; it might fail if L2Error() is 0, but we have already avoided
+    // that case.  A single node is split with all of the threads; several
+    // nodes are split at once, each with its own random stream, so that the
+    // children do not depend on the number of threads.
+    const uint64_t seed = math::RandomStreamSeed();
+    if (splitNodes.size() == 1)
+    {
+      math::RandomStream stream(seed, 0);
+      math::RandomStreamScope scope(stream);
+      splitNodes[0]->CosineNodeSplit();
+    }
+    else
+    {
+      #pragma omp parallel for num_threads(ParallelThreads()) \
+          schedule(dynamic, 1)
+      for (omp_size_t j = 0; j < (omp_size_t) splitNodes.size(); ++j)
+      {
+        math::RandomStream stream(seed, j);
+        math::RandomStreamScope scope(stream);
+        splitNodes[j]->CosineNodeSplit();
+      }
+    }
 
-    // Obtain pointers to the left and right children of the current node.
-    CosineTree *currentLeft, *currentRight;
-    currentLeft = currentNode->Left();
-    currentRight = currentNode->Right();
+    for (size_t j = 0; j < splitNodes.size(); ++j)
+    {
+      // Obtain pointers to the left and right children of the split node.
+      CosineTree *currentLeft, *currentRight;
+      currentLeft = splitNodes[j]->Left();
+      currentRight = splitNodes[j]->Right();
 
-    // Calculate basis vectors of left and right children.
-    arma::vec lBasisVector, rBasisVector;
+      // Calculate basis vectors of left and right children.
+      arma::vec lBasisVector, rBasisVector;
 
-    ModifiedGramSchmidt(treeQueue, currentLeft->Centroid(), lBasisVector);
-    ModifiedGramSchmidt(treeQueue, currentRight->Centroid(), rBasisVector,
-                        &lBasisVector);
+      ModifiedGramSchmidt(treeQueue, currentLeft->Centroid(), lBasisVector);
+      ModifiedGramSchmidt(treeQueue, currentRight->Centroid(), rBasisVector,
+                          &lBasisVector);
 
-    // Add basis vectors to their respective nodes.
-    currentLeft->BasisVector(lBasisVector);
-    currentRight->BasisVector(rBasisVector);
+      // Add basis vectors to their respective nodes.
+      currentLeft->BasisVector(lBasisVector);
+      currentRight->BasisVector(rBasisVector);
 
-    // Calculate Monte Carlo error estimates for child nodes.
-    MonteCarloError(currentLeft, treeQueue, &lBasisVector, &rBasisVector);
-    MonteCarloError(currentRight, treeQueue, &lBasisVector, &rBasisVector);
+      // Calculate Monte Carlo error estimates for child nodes.
+      MonteCarloError(currentLeft, treeQueue, &lBasisVector, &rBasisVector);
+      MonteCarloError(currentRight, treeQueue, &lBasisVector, &rBasisVector);
 
-    // Push child nodes into the priority queue.
-    treeQueue.push(currentLeft);
-    treeQueue.push(currentRight);
+      // Push child nodes into the priority queue.
+      treeQueue.push(currentLeft);
+      treeQueue.push(currentRight);
+    }
 
     // Calculate Monte Carlo error estimate for the root node.
     monteCarloError = MonteCarloError(&root, treeQueue);
@@ -166,19 +200,22 @@ void CosineTree::ModifiedGramSchmidt(CosineNodeQueue& treeQueue,
   // Set new basis vector to centroid.
   newBasisVector = centroid;
 
-  // Variables for iterating throught the priority queue.
-  CosineTree *currentNode;
+  // Collect the vectors of the current basis.
+  std::vector<const arma::vec*> basisVectors;
   CosineNodeQueue::const_iterator i = treeQueue.begin();
+  for ( ; i != treeQueue.end(); i++)
+    basisVectors.push_back(&(*i)->BasisVector());
 
   // For every vector in the current basis, remove its projection from the
-  // centroid.
-  for ( ; i != treeQueue.end(); i++)
-  {
-    currentNode = *i;
+  // centroid.  The projections are all taken on the centroid, so they can be
+  // computed in parallel.
+  arma::vec projections(basisVectors.size());
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(static)
+  for (omp_size_t k = 0; k < (omp_size_t) basisVectors.size(); k++)
+    projections(k) = arma::dot(*basisVectors[k], centroid);
 
-    double projection = arma::dot(currentNode->BasisVector(), centroid);
-    newBasisVector -= projection * currentNode->BasisVector();
-  }
+  for (size_t k = 0; k < basisVectors.size(); k++)
+    newBasisVector -= projections(k) * *basisVectors[k];
 
   // If additional basis vector is passed, take it into account.
   if (addBasisVector)
@@ -205,55 +242,41 @@ double CosineTree::MonteCarloError(CosineTree* node,
   size_t numSamples = log(node->NumColumns()) + 1;
   node->ColumnSamplesLS(sampledIndices, probabilities, numSamples);
 
-  // Get pointer to the original dataset.
-  arma::mat dataset = node->GetDataset();
-
-  // Initialize weighted projection magnitudes as zeros.
-  arma::vec weightedMagnitudes;
-  weightedMagnitudes.zeros(numSamples);
+  // Get the original dataset.
+  const arma::mat& dataset = node->GetDataset();
 
-  // Set size of projection vector, depending on whether additional basis
-  // vectors are passed.
-  size_t projectionSize;
+  // Collect the vectors of the current basis, and the additional basis
+  // vectors, if both are passed.
+  std::vector<const arma::vec*> basisVectors;
+  CosineNodeQueue::const_iterator j = treeQueue.begin();
+  for ( ; j != treeQueue.end(); j++)
+    basisVectors.push_back(&(*j)->BasisVector());
   if (addBasisVector1 && addBasisVector2)
-    projectionSize = treeQueue.size() + 2;
-  else
-    projectionSize = treeQueue.size();
-
-  // For each sample, calculate the weighted projection onto the current basis.
-  for (size_t i = 0; i < numSamples; i++)
   {
-    // Initialize projection as a vector of zeros.
-    arma::vec projection;
-    projection.zeros(projectionSize);
-
-    CosineTree *currentNode;
-    CosineNodeQueue::const_iterator j = treeQueue.begin();
-
-    size_t k = 0;
-    // Compute the projection of the sampled vector onto the existing subspace.
-    for ( ; j != treeQueue.end(); j++, k++)
-    {
-      currentNode = *j;
+    basisVectors.push_back(addBasisVector1);
+    basisVectors.push_back(addBasisVector2);
+  }
 
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                currentNode->BasisVector());
-    }
-    // If two additional vectors are passed, take their projections.
-    if (addBasisVector1 && addBasisVector2)
+  // Compute the projections of the samples onto the subspace, in parallel
+  // over the basis vectors.
+  arma::mat projections(numSamples, basisVectors.size());
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(static)
+  for (omp_size_t k = 0; k < (omp_size_t) basisVectors.size(); k++)
+  {
+    for (size_t i = 0; i < numSamples; i++)
     {
-      projection(k++) = arma::dot(dataset.col(sampledIndices[i]),
-                                  *addBasisVector1);
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                *addBasisVector2);
+      projections(i, k) = arma::dot(dataset.col(sampledIndices[i]),
+                                    *basisVectors[k]);
     }
+  }
 
-    // Calculate the Frobenius norm squared of the projected vector.
-    double frobProjection = arma::norm(projection, "frob");
-    double frobProjectionSquared = frobProjection * frobProjection;
-
-    // Calculate the weighted projection magnitude.
-    weightedMagnitudes(i) = frobProjectionSquared / probabilities(i);
+  // For each sample, calculate the weighted magnitude of the projection (the
+  // squared Frobenius norm of the projected vector).
+  arma::vec weightedMagnitudes(numSamples);
+  for (size_t i = 0; i < numSamples; i++)
+  {
+    weightedMagnitudes(i) = arma::accu(arma::square(projections.row(i))) /
+        probabilities(i);
   }
 
   // Compute mean and standard deviation of the weighted samples.
@@ -354,7 +377,7 @@ void CosineTree::ColumnSamplesLS(std::vector<size_t>& sampledIndices,
   for (size_t i = 0; i < numSamples; i++)
   {
     // Generate a random value for sampling.
-    double randValue = arma::randu();
+    double randValue = math::Random();
     size_t start = 0, end = numColumns, searchIndex;
 
     // Sample from the distribution and store corresponding probability.
@@ -384,7 +407,7 @@ size_t CosineTree::ColumnSampleLS()
   }
 
   // Generate a random value for sampling.
-  double randValue = arma::randu();
+  double randValue = math::Random();
   size_t start = 0, end = numColumns;
 
   // Sample from the distribution.
@@ -424,7 +447,8 @@ void CosineTree::CalculateCosines(arma::vec& cosines)
   // Initialize cosine vector as a vector of zeros.
   cosines.zeros(numColumns);
 
-  for (size_t i = 0; i < numColumns; i++)
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) numColumns; i++)
   {
     // If norm is zero, store cosine value as zero. Else, calculate cosine value
     // between two vectors.
@@ -443,14 +467,20 @@ void CosineTree::CalculateCosines(arma::vec& cosines)
 
 void CosineTree::CalculateCentroid()
 {
-  // Initialize centroid as vector of zeros.
-  centroid.zeros(dataset.n_rows);
+  // Calculate centroid of columns in the node, summing the columns of each
+  // chunk in parallel.
+  ReductionPartials<arma::vec> partials(numColumns,
+      arma::vec(dataset.n_rows, arma::fill::zeros));
 
-  // Calculate centroid of columns in the node.
-  for (size_t i = 0; i < numColumns; i++)
+  #pragma omp parallel for num_threads(partials.Threads()) schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) partials.Chunks(); c++)
   {
-    centroid += dataset.col(indices[i]);
+    arma::vec& partial = partials.Partial(c);
+    for (size_t i = partials.Begin(c); i < partials.End(c); i++)
+      partial += dataset.col(indices[i]);
   }
+
+  partials.Reduce(centroid, [](arma::vec& a, const arma::vec& b) { a += b; });
   centroid /= numColumns;
 }
 
@@ -60,13 +60,21 @@ class CosineTree
    * input matrix's projection on the obtained subspace is less than a fraction
    * of the norm of the input matrix.
    *
+   * The norms, centroids, cosines and projections of each node are computed in
+   * parallel.  If batchSize is greater than 1, up to that many nodes with the
+   * largest errors are split at once (in parallel) before the error of the
+   * subspace is estimated again.  This may add a few more basis vectors than
+   * needed, but keeps all threads busy once the nodes get small.
+   *
    * @param dataset Matrix for which the CosineTree is constructed.
    * @param epsilon Error tolerance fraction for calculated subspace.
    * @param delta Cumulative probability for Monte Carlo error lower bound.
+   * @param batchSize Number of nodes split in each round.
    */
   CosineTree(const arma::mat& dataset,
              const double epsilon,
-             const double delta);
+             const double delta,
+             const size_t batchSize = 1);
 
   /**
    * Clean up the CosineTree: release allocated memory (including children).
@@ -17,6 +17,8 @@
 #include "cover_tree/cover_tree.hpp"
 #include "cover_tree/single_tree_traverser.hpp"
 #include "cover_tree/single_tree_traverser_impl.hpp"
+#include "cover_tree/parallel_single_tree_traverser.hpp"
+#include "cover_tree/parallel_single_tree_traverser_impl.hpp"
 #include "cover_tree/dual_tree_traverser.hpp"
 #include "cover_tree/dual_tree_traverser_impl.hpp"
 #include "cover_tree/traits.hpp"
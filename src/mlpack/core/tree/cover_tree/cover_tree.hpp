@@ -256,6 +256,11 @@ class CoverTree
   template<typename RuleType>
   class SingleTreeTraverser;
 
+  //! A single-tree cover tree traverser that traverses many query points at
+  //! once with several threads; see parallel_single_tree_traverser.hpp.
+  template<typename RuleType>
+  class ParallelSingleTreeTraverser;
+
   //! A dual-tree cover tree traverser; see dual_tree_traverser.hpp.
   template<typename RuleType>
   class DualTreeTraverser;
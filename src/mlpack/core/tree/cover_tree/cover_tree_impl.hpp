@@ -14,6 +14,7 @@
 
 // In case it hasn't already been included.
 #include "cover_tree.hpp"
+#include <mlpack/core/tree/parallel_split_threshold.hpp>
 
 #include <queue>
 #include <string>
@@ -1241,9 +1242,11 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
                      const size_t pointSetSize)
 {
   // For each point, rebuild the distances.  The indices do not need to be
-  // modified.
+  // modified.  The distances are independent of each other, so large point
+  // sets (which are found near the top of the tree) are split between threads.
   distanceComps += pointSetSize;
-  for (size_t i = 0; i < pointSetSize; ++i)
+  #pragma omp parallel for if (pointSetSize >= ParallelSplitThreshold)
+  for (omp_size_t i = 0; i < (omp_size_t) pointSetSize; ++i)
   {
     distances[i] = metric->Evaluate(dataset->col(pointIndex),
         dataset->col(indices[i]));
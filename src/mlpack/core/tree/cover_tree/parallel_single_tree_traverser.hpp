@@ -0,0 +1,125 @@
+/**
+ * @file parallel_single_tree_traverser.hpp
+ *
+ * Defines the ParallelSingleTreeTraverser for the cover tree.  This traverses
+ * the reference tree with a range of query points, using several threads; each
+ * query point is traversed breadth-first, as the SingleTreeTraverser does.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_COVER_TREE_PARALLEL_SINGLE_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_COVER_TREE_PARALLEL_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "cover_tree.hpp"
+#include "single_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A single-tree traverser for cover trees that uses multiple threads.  The
+ * query points of a batch are handed out to the threads dynamically, and each
+ * thread traverses the reference tree with its query points one after another,
+ * in the same order as the SingleTreeTraverser.  So, for each query point,
+ * the same nodes are scored and the same base cases are computed as with the
+ * SingleTreeTraverser.
+ *
+ * Each thread receives its own copy of the rules, made with the RuleType copy
+ * constructor.  That copy must share the results of the original rules object
+ * (as, e.g., NeighborSearchRules does), but may hold its own counters.
+ *
+ * The reference tree is shared by all threads, so Score() must not change the
+ * statistics of the reference nodes.  To make that possible, before each call
+ * to Score(queryIndex, node), the traversal info of the rules holds the parent
+ * of the node as the last reference node and the base case between the query
+ * point and the point of the parent as the last base case (for the root, the
+ * last reference node is NULL).  Rules that take advantage of self-children
+ * (such as NeighborSearchRules) can take the base case of a self-child from
+ * there, instead of the statistic of the parent.
+ *
+ * If mlpack was compiled without OpenMP, or only one thread is requested, the
+ * query points are traversed one after another by the calling thread.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+class CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    ParallelSingleTreeTraverser
+{
+ public:
+  /**
+   * Initialize the parallel single tree traverser with the given rule.
+   *
+   * @param rule Rules to traverse with.
+   * @param numThreads Number of threads to use; if 0, the number of threads
+   *     available to OpenMP is used.
+   */
+  ParallelSingleTreeTraverser(RuleType& rule, const size_t numThreads = 0);
+
+  /**
+   * Traverse the tree with the given point, using only the calling thread.
+   *
+   * @param queryIndex The index of the point in the query set which is used as
+   *      the query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryIndex, CoverTree& referenceNode);
+
+  /**
+   * Traverse the tree with each of the query points with indices in
+   * [queryBegin, queryEnd), using several threads.  This does not reset the
+   * number of prunes.
+   *
+   * @param queryBegin Index of the first query point.
+   * @param queryEnd One past the index of the last query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryBegin,
+                const size_t queryEnd,
+                CoverTree& referenceNode);
+
+  //! Get the number of threads used for traversal.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for traversal.
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the number of prunes so far.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Set the number of prunes (good for a reset to 0).
+  size_t& NumPrunes() { return numPrunes; }
+
+ private:
+  /**
+   * Traverse the tree with one query point and the given rules, and return
+   * the number of prunes.
+   */
+  static size_t TraverseQuery(RuleType& rule,
+                              const size_t queryIndex,
+                              CoverTree& referenceNode);
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The number of threads to use.
+  size_t numThreads;
+
+  //! The number of nodes which have been pruned during traversal.
+  size_t numPrunes;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_single_tree_traverser_impl.hpp"
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ * @file parallel_single_tree_traverser_impl.hpp
+ *
+ * Implementation of the ParallelSingleTreeTraverser for the cover tree.  The
+ * traversal of each query point is the one of the SingleTreeTraverser; the
+ * query points are divided between threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_COVER_TREE_PARALLEL_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_COVER_TREE_PARALLEL_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_single_tree_traverser.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace tree {
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+ParallelSingleTreeTraverser<RuleType>::ParallelSingleTreeTraverser(
+    RuleType& rule,
+    const size_t numThreads) :
+    rule(rule),
+    numThreads(numThreads),
+    numPrunes(0)
+{ /* Nothing to do. */ }
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+ParallelSingleTreeTraverser<RuleType>::Traverse(
+    const size_t queryIndex,
+    CoverTree& referenceNode)
+{
+  numPrunes += TraverseQuery(rule, queryIndex, referenceNode);
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+ParallelSingleTreeTraverser<RuleType>::Traverse(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    CoverTree& referenceNode)
+{
+  const size_t threads = ParallelThreads(numThreads);
+
+  // With one thread, or one query point, there is nothing to divide.
+  if (threads <= 1 || queryEnd - queryBegin <= 1)
+  {
+    for (size_t i = queryBegin; i < queryEnd; ++i)
+      numPrunes += TraverseQuery(rule, i, referenceNode);
+    return;
+  }
+
+  size_t prunes = 0, ruleScores = 0, ruleBaseCases = 0;
+
+  #pragma omp parallel num_threads(threads) \
+      reduction(+:prunes, ruleScores, ruleBaseCases)
+  {
+    // Each thread has its own rules object, which shares its results with the
+    // original rules object.  The query points of one thread are traversed one
+    // after another, so per-query state of the rules (such as a work budget)
+    // works as it does with the SingleTreeTraverser.
+    RuleType workerRule(rule);
+    const size_t startScores = workerRule.Scores();
+    const size_t startBaseCases = workerRule.BaseCases();
+
+    // Query points may be very different in cost, so they are handed out in
+    // small chunks.
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = (omp_size_t) queryBegin; i < (omp_size_t) queryEnd;
+         ++i)
+    {
+      prunes += TraverseQuery(workerRule, i, referenceNode);
+    }
+
+    ruleScores += workerRule.Scores() - startScores;
+    ruleBaseCases += workerRule.BaseCases() - startBaseCases;
+  }
+
+  numPrunes += prunes;
+  rule.Scores() += ruleScores;
+  rule.BaseCases() += ruleBaseCases;
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+template<typename RuleType>
+size_t CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+ParallelSingleTreeTraverser<RuleType>::TraverseQuery(
+    RuleType& rule,
+    const size_t queryIndex,
+    CoverTree& referenceNode)
+{
+  // This follows SingleTreeTraverser::Traverse(), but before each call to
+  // Score() the parent of the node and its base case are stored in the
+  // traversal info, so that the rules do not need the reference statistics.
+  typedef CoverTreeMapEntry<MetricType, StatisticType, MatType, RootPointPolicy>
+      MapEntryType;
+
+  size_t numPrunes = 0;
+
+  // We will use this map as a priority queue, as the SingleTreeTraverser does.
+  std::map<int, std::vector<MapEntryType> > mapQueue;
+
+  // Create the score for the children.  The root has no parent.
+  rule.TraversalInfo().LastReferenceNode() = NULL;
+  rule.TraversalInfo().LastBaseCase() = 0.0;
+  double rootChildScore = rule.Score(queryIndex, referenceNode);
+
+  if (rootChildScore == DBL_MAX)
+  {
+    numPrunes += referenceNode.NumChildren();
+  }
+  else
+  {
+    // Manually add the children of the first node.
+    double rootBaseCase = rule.BaseCase(queryIndex, referenceNode.Point());
+
+    // Don't add the self-leaf.
+    size_t i = 0;
+    if (referenceNode.Child(0).NumChildren() == 0)
+    {
+      ++numPrunes;
+      i = 1;
+    }
+
+    for (/* i was set above. */; i < referenceNode.NumChildren(); ++i)
+    {
+      MapEntryType newFrame;
+      newFrame.node = &referenceNode.Child(i);
+      newFrame.score = rootChildScore;
+      newFrame.baseCase = rootBaseCase;
+      newFrame.parent = referenceNode.Point();
+
+      // Put it into the map.
+      mapQueue[newFrame.node->Scale()].push_back(newFrame);
+    }
+  }
+
+  // Now begin the iteration through the map, but only if it has anything in it.
+  if (mapQueue.empty())
+    return numPrunes;
+  typename std::map<int, std::vector<MapEntryType> >::reverse_iterator rit =
+      mapQueue.rbegin();
+
+  // We will treat the leaves differently (below).
+  while ((*rit).first != INT_MIN)
+  {
+    // Get a reference to the current scale.
+    std::vector<MapEntryType>& scaleVector = (*rit).second;
+
+    // Before traversing all the points in this scale, sort by score.
+    std::sort(scaleVector.begin(), scaleVector.end());
+
+    // Now loop over each element.
+    for (size_t i = 0; i < scaleVector.size(); ++i)
+    {
+      // Get a reference to the current element.
+      const MapEntryType& frame = scaleVector.at(i);
+
+      CoverTree* node = frame.node;
+      const double score = frame.score;
+      const size_t parent = frame.parent;
+      const size_t point = node->Point();
+      double baseCase = frame.baseCase;
+
+      // First we recalculate the score of this node to find if we can prune it.
+      if (rule.Rescore(queryIndex, *node, score) == DBL_MAX)
+      {
+        ++numPrunes;
+        continue;
+      }
+
+      // Create the score for the children.
+      rule.TraversalInfo().LastReferenceNode() = node->Parent();
+      rule.TraversalInfo().LastBaseCase() = frame.baseCase;
+      const double childScore = rule.Score(queryIndex, *node);
+
+      // Now if this childScore is DBL_MAX we can prune all children.
+      if (childScore == DBL_MAX)
+      {
+        numPrunes += node->NumChildren();
+        continue;
+      }
+
+      // If we are a self-child, the base case has already been evaluated.
+      if (point != parent)
+        baseCase = rule.BaseCase(queryIndex, point);
+
+      // Don't add the self-leaf.
+      size_t j = 0;
+      if (node->Child(0).NumChildren() == 0)
+      {
+        ++numPrunes;
+        j = 1;
+      }
+
+      for (/* j is already set. */; j < node->NumChildren(); ++j)
+      {
+        MapEntryType newFrame;
+        newFrame.node = &node->Child(j);
+        newFrame.score = childScore;
+        newFrame.baseCase = baseCase;
+        newFrame.parent = point;
+
+        mapQueue[newFrame.node->Scale()].push_back(newFrame);
+      }
+    }
+
+    // Now clear the memory for this scale; it isn't needed anymore.
+    mapQueue.erase((*rit).first);
+  }
+
+  // Now deal with the leaves.
+  for (size_t i = 0; i < mapQueue[INT_MIN].size(); ++i)
+  {
+    const MapEntryType& frame = mapQueue[INT_MIN].at(i);
+
+    CoverTree* node = frame.node;
+    const double score = frame.score;
+    const size_t point = node->Point();
+
+    // First, recalculate the score of this node to find if we can prune it.
+    if (rule.Rescore(queryIndex, *node, score) == DBL_MAX)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    rule.TraversalInfo().LastReferenceNode() = node->Parent();
+    rule.TraversalInfo().LastBaseCase() = frame.baseCase;
+    const double actualScore = rule.Score(queryIndex, *node);
+
+    if (actualScore == DBL_MAX)
+      ++numPrunes;
+    else
+      rule.BaseCase(queryIndex, point);
+  }
+
+  return numPrunes;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
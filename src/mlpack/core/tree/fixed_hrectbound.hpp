@@ -0,0 +1,189 @@
+/**
+ * @file fixed_hrectbound.hpp
+ *
+ * Bounds that are hyperrectangles with a number of dimensions known at compile
+ * time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_FIXED_HRECTBOUND_HPP
+#define MLPACK_CORE_TREE_FIXED_HRECTBOUND_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/range.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include "hrectbound.hpp"
+#include "bound_traits.hpp"
+
+namespace mlpack {
+namespace bound {
+
+/**
+ * A hyperrectangle with exactly FixedDim dimensions, with the same interface
+ * and the same results as HRectBound.  The ranges are stored in the bound
+ * itself instead of a separately allocated array, so they are in the same
+ * cache lines as the rest of the tree node, and the loops over the dimensions
+ * in the distance computations have a constant number of iterations, which the
+ * compiler unrolls.  This is meant for low-dimensional data; the HRectBound2D
+ * and HRectBound3D templates can be given to BinarySpaceTree (see
+ * tree::KDTree2D and tree::KDTree3D).
+ *
+ * A std::invalid_argument exception is thrown if a bound is created for
+ * points with a different number of dimensions.
+ *
+ * @tparam FixedDim Number of dimensions.
+ * @tparam MetricType Type of metric to use; must be an LMetric or a
+ *     FixedLMetric.
+ * @tparam ElemType Element type.
+ */
+template<size_t FixedDim,
+         typename MetricType = metric::LMetric<2, true>,
+         typename ElemType = double>
+class FixedHRectBound
+{
+  static_assert(meta::IsLMetric<MetricType>::Value == true,
+      "FixedHRectBound can only be used with the LMetric<> metric type.");
+  static_assert(FixedDim > 0, "FixedHRectBound needs at least one dimension.");
+
+ public:
+  //! Create a bound with each dimension the empty set.
+  FixedHRectBound();
+
+  /**
+   * Create a bound with each dimension the empty set, for points of the given
+   * dimensionality, which must be FixedDim.
+   */
+  FixedHRectBound(const size_t dimension);
+
+  //! Resets all dimensions to the empty set (so that this bound contains
+  //! nothing).
+  void Clear();
+
+  //! Gets the dimensionality.
+  size_t Dim() const { return FixedDim; }
+
+  //! Get the range for a particular dimension.  No bounds checking.  Be
+  //! careful: this may make MinWidth() invalid.
+  math::RangeType<ElemType>& operator[](const size_t i) { return bounds[i]; }
+  //! Modify the range for a particular dimension.  No bounds checking.
+  const math::RangeType<ElemType>& operator[](const size_t i) const
+  { return bounds[i]; }
+
+  //! Get the minimum width of the bound.
+  ElemType MinWidth() const { return minWidth; }
+  //! Modify the minimum width of the bound.
+  ElemType& MinWidth() { return minWidth; }
+
+  //! Calculates the center of the range, placing it into the given vector.
+  void Center(arma::Col<ElemType>& center) const;
+
+  //! Calculate the volume of the hyperrectangle.
+  ElemType Volume() const;
+
+  //! Calculates minimum bound-to-point distance.
+  template<typename VecType>
+  ElemType MinDistance(const VecType& point,
+                       typename std::enable_if_t<IsVector<VecType>::value>* = 0)
+      const;
+
+  //! Calculates minimum bound-to-bound distance.
+  ElemType MinDistance(const FixedHRectBound& other) const;
+
+  //! Calculates maximum bound-to-point distance.
+  template<typename VecType>
+  ElemType MaxDistance(const VecType& point,
+                       typename std::enable_if_t<IsVector<VecType>::value>* = 0)
+      const;
+
+  //! Calculates maximum bound-to-bound distance.
+  ElemType MaxDistance(const FixedHRectBound& other) const;
+
+  //! Calculates minimum and maximum bound-to-bound distance.
+  math::RangeType<ElemType> RangeDistance(const FixedHRectBound& other) const;
+
+  //! Calculates minimum and maximum bound-to-point distance.
+  template<typename VecType>
+  math::RangeType<ElemType> RangeDistance(
+      const VecType& point,
+      typename std::enable_if_t<IsVector<VecType>::value>* = 0) const;
+
+  /**
+   * Expands this region to include new points.
+   *
+   * @tparam MatType Type of matrix; could be Mat, SpMat, a subview, or just a
+   *   vector.
+   * @param data Data points to expand this region to include.
+   */
+  template<typename MatType>
+  FixedHRectBound& operator|=(const MatType& data);
+
+  //! Expands this region to encompass another bound.
+  FixedHRectBound& operator|=(const FixedHRectBound& other);
+
+  //! Determines if a point is within this bound.
+  template<typename VecType>
+  bool Contains(const VecType& point) const;
+
+  //! Determines if this bound partially contains a bound.
+  bool Contains(const FixedHRectBound& bound) const;
+
+  //! Returns the intersection of this bound and another.
+  FixedHRectBound operator&(const FixedHRectBound& bound) const;
+
+  //! Intersects this bound with another.
+  FixedHRectBound& operator&=(const FixedHRectBound& bound);
+
+  //! Returns the volume of overlap of this bound and another.
+  ElemType Overlap(const FixedHRectBound& bound) const;
+
+  //! Returns the diameter of the hyperrectangle (that is, the longest
+  //! diagonal).
+  ElemType Diameter() const;
+
+  //! Serialize the bound object.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int version);
+
+ private:
+  //! Add the distance in one dimension (which is nonnegative) to a sum.
+  static void Accumulate(ElemType& sum, const ElemType v);
+  //! Turn a sum of distances into the distance, as MetricType does.
+  static ElemType Finish(const ElemType sum);
+
+  //! Recompute the minimum width.
+  void UpdateMinWidth();
+
+  //! The bounds for each dimension.
+  math::RangeType<ElemType> bounds[FixedDim];
+  //! Cached minimum width of bound.
+  ElemType minWidth;
+};
+
+//! A FixedHRectBound for two-dimensional points, which can be given to a
+//! BinarySpaceTree.
+template<typename MetricType = metric::LMetric<2, true>,
+         typename ElemType = double>
+using HRectBound2D = FixedHRectBound<2, MetricType, ElemType>;
+
+//! A FixedHRectBound for three-dimensional points, which can be given to a
+//! BinarySpaceTree.
+template<typename MetricType = metric::LMetric<2, true>,
+         typename ElemType = double>
+using HRectBound3D = FixedHRectBound<3, MetricType, ElemType>;
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+struct BoundTraits<FixedHRectBound<FixedDim, MetricType, ElemType>>
+{
+  //! These bounds are always tight for each dimension.
+  const static bool HasTightBounds = true;
+};
+
+} // namespace bound
+} // namespace mlpack
+
+#include "fixed_hrectbound_impl.hpp"
+
+#endif // MLPACK_CORE_TREE_FIXED_HRECTBOUND_HPP
@@ -0,0 +1,393 @@
+/**
+ * @file fixed_hrectbound_impl.hpp
+ *
+ * Implementation of the fixed-dimension hyperrectangle bound.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_FIXED_HRECTBOUND_IMPL_HPP
+#define MLPACK_CORE_TREE_FIXED_HRECTBOUND_IMPL_HPP
+
+// In case it has not been included yet.
+#include "fixed_hrectbound.hpp"
+
+namespace mlpack {
+namespace bound {
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline FixedHRectBound<FixedDim, MetricType, ElemType>::FixedHRectBound() :
+    minWidth(0)
+{ /* Nothing to do. */ }
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline FixedHRectBound<FixedDim, MetricType, ElemType>::FixedHRectBound(
+    const size_t dimension) :
+    minWidth(0)
+{
+  if (dimension != FixedDim)
+  {
+    std::ostringstream oss;
+    oss << "FixedHRectBound::FixedHRectBound(): cannot bound points with "
+        << dimension << " dimensions; the bound has " << FixedDim
+        << " dimensions";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline void FixedHRectBound<FixedDim, MetricType, ElemType>::Clear()
+{
+  for (size_t i = 0; i < FixedDim; ++i)
+    bounds[i] = math::RangeType<ElemType>();
+  minWidth = 0;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline void FixedHRectBound<FixedDim, MetricType, ElemType>::Center(
+    arma::Col<ElemType>& center) const
+{
+  if (center.n_elem != FixedDim)
+    center.set_size(FixedDim);
+
+  for (size_t i = 0; i < FixedDim; ++i)
+    center[i] = bounds[i].Mid();
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::Volume() const
+{
+  ElemType volume = 1.0;
+  for (size_t i = 0; i < FixedDim; ++i)
+  {
+    if (bounds[i].Lo() >= bounds[i].Hi())
+      return 0;
+
+    volume *= (bounds[i].Hi() - bounds[i].Lo());
+  }
+
+  return volume;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline force_inline
+void FixedHRectBound<FixedDim, MetricType, ElemType>::Accumulate(
+    ElemType& sum,
+    const ElemType v)
+{
+  // The compiler should optimize out this if statement entirely.
+  if (MetricType::Power == 1)
+    sum += v;
+  else if (MetricType::Power == 2)
+    sum += v * v;
+  else
+    sum += std::pow(v, (ElemType) MetricType::Power);
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline force_inline
+ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::Finish(
+    const ElemType sum)
+{
+  if (!MetricType::TakeRoot || MetricType::Power == 1)
+    return sum;
+  else if (MetricType::Power == 2)
+    return (ElemType) std::sqrt(sum);
+  else
+    return (ElemType) pow((double) sum, 1.0 / (double) MetricType::Power);
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline void FixedHRectBound<FixedDim, MetricType, ElemType>::UpdateMinWidth()
+{
+  minWidth = bounds[0].Width();
+  for (size_t i = 1; i < FixedDim; ++i)
+    minWidth = std::min(minWidth, bounds[i].Width());
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+template<typename VecType>
+inline ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::MinDistance(
+    const VecType& point,
+    typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
+{
+  Log::Assert(point.n_elem == FixedDim);
+
+  // At most one of the distances to the two sides is positive.
+  ElemType sum = 0;
+  for (size_t d = 0; d < FixedDim; ++d)
+  {
+    const ElemType lower = bounds[d].Lo() - point[d];
+    const ElemType higher = point[d] - bounds[d].Hi();
+    Accumulate(sum, std::max(std::max(lower, higher), (ElemType) 0));
+  }
+
+  return Finish(sum);
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::MinDistance(
+    const FixedHRectBound& other) const
+{
+  ElemType sum = 0;
+  for (size_t d = 0; d < FixedDim; ++d)
+  {
+    const ElemType lower = other.bounds[d].Lo() - bounds[d].Hi();
+    const ElemType higher = bounds[d].Lo() - other.bounds[d].Hi();
+    Accumulate(sum, std::max(std::max(lower, higher), (ElemType) 0));
+  }
+
+  return Finish(sum);
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+template<typename VecType>
+inline ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::MaxDistance(
+    const VecType& point,
+    typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
+{
+  Log::Assert(point.n_elem == FixedDim);
+
+  ElemType sum = 0;
+  for (size_t d = 0; d < FixedDim; ++d)
+  {
+    Accumulate(sum, std::max(std::fabs(point[d] - bounds[d].Lo()),
+        std::fabs(bounds[d].Hi() - point[d])));
+  }
+
+  return Finish(sum);
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::MaxDistance(
+    const FixedHRectBound& other) const
+{
+  ElemType sum = 0;
+  for (size_t d = 0; d < FixedDim; ++d)
+  {
+    Accumulate(sum, std::max(std::fabs(other.bounds[d].Hi() - bounds[d].Lo()),
+        std::fabs(bounds[d].Hi() - other.bounds[d].Lo())));
+  }
+
+  return Finish(sum);
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline math::RangeType<ElemType>
+FixedHRectBound<FixedDim, MetricType, ElemType>::RangeDistance(
+    const FixedHRectBound& other) const
+{
+  ElemType loSum = 0;
+  ElemType hiSum = 0;
+  for (size_t d = 0; d < FixedDim; ++d)
+  {
+    const ElemType v1 = other.bounds[d].Lo() - bounds[d].Hi();
+    const ElemType v2 = bounds[d].Lo() - other.bounds[d].Hi();
+
+    // One of v1 or v2 is negative.
+    ElemType vLo, vHi;
+    if (v1 >= v2)
+    {
+      vHi = -v2;
+      vLo = (v1 > 0) ? v1 : 0;
+    }
+    else
+    {
+      vHi = -v1;
+      vLo = (v2 > 0) ? v2 : 0;
+    }
+
+    Accumulate(loSum, vLo);
+    Accumulate(hiSum, vHi);
+  }
+
+  return math::RangeType<ElemType>(Finish(loSum), Finish(hiSum));
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+template<typename VecType>
+inline math::RangeType<ElemType>
+FixedHRectBound<FixedDim, MetricType, ElemType>::RangeDistance(
+    const VecType& point,
+    typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
+{
+  Log::Assert(point.n_elem == FixedDim);
+
+  ElemType loSum = 0;
+  ElemType hiSum = 0;
+  for (size_t d = 0; d < FixedDim; ++d)
+  {
+    const ElemType v1 = bounds[d].Lo() - point[d]; // Negative if point > lo.
+    const ElemType v2 = point[d] - bounds[d].Hi(); // Negative if point < hi.
+
+    // One of v1 or v2 (or both) is negative.
+    ElemType vLo, vHi;
+    if (v1 >= 0)
+    {
+      vHi = -v2;
+      vLo = v1;
+    }
+    else if (v2 >= 0)
+    {
+      vHi = -v1;
+      vLo = v2;
+    }
+    else
+    {
+      vHi = -std::min(v1, v2);
+      vLo = 0;
+    }
+
+    Accumulate(loSum, vLo);
+    Accumulate(hiSum, vHi);
+  }
+
+  return math::RangeType<ElemType>(Finish(loSum), Finish(hiSum));
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+template<typename MatType>
+inline FixedHRectBound<FixedDim, MetricType, ElemType>&
+FixedHRectBound<FixedDim, MetricType, ElemType>::operator|=(
+    const MatType& data)
+{
+  Log::Assert(data.n_rows == FixedDim);
+
+  // The data may hold a different element type than the bound (for instance,
+  // when single-precision points are bounded in double precision).
+  arma::Col<typename MatType::elem_type> mins(min(data, 1));
+  arma::Col<typename MatType::elem_type> maxs(max(data, 1));
+
+  for (size_t i = 0; i < FixedDim; ++i)
+    bounds[i] |= math::RangeType<ElemType>(mins[i], maxs[i]);
+  UpdateMinWidth();
+
+  return *this;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline FixedHRectBound<FixedDim, MetricType, ElemType>&
+FixedHRectBound<FixedDim, MetricType, ElemType>::operator|=(
+    const FixedHRectBound& other)
+{
+  for (size_t i = 0; i < FixedDim; ++i)
+    bounds[i] |= other.bounds[i];
+  UpdateMinWidth();
+
+  return *this;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+template<typename VecType>
+inline bool FixedHRectBound<FixedDim, MetricType, ElemType>::Contains(
+    const VecType& point) const
+{
+  for (size_t i = 0; i < FixedDim; ++i)
+  {
+    if (!bounds[i].Contains(point(i)))
+      return false;
+  }
+
+  return true;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline bool FixedHRectBound<FixedDim, MetricType, ElemType>::Contains(
+    const FixedHRectBound& bound) const
+{
+  for (size_t i = 0; i < FixedDim; ++i)
+  {
+    // If a does not overlap b at all.
+    if (bounds[i].Hi() <= bound.bounds[i].Lo() ||
+        bounds[i].Lo() >= bound.bounds[i].Hi())
+      return false;
+  }
+
+  return true;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline FixedHRectBound<FixedDim, MetricType, ElemType>
+FixedHRectBound<FixedDim, MetricType, ElemType>::operator&(
+    const FixedHRectBound& bound) const
+{
+  FixedHRectBound result(*this);
+  result &= bound;
+  return result;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline FixedHRectBound<FixedDim, MetricType, ElemType>&
+FixedHRectBound<FixedDim, MetricType, ElemType>::operator&=(
+    const FixedHRectBound& bound)
+{
+  for (size_t k = 0; k < FixedDim; ++k)
+  {
+    bounds[k].Lo() = std::max(bounds[k].Lo(), bound.bounds[k].Lo());
+    bounds[k].Hi() = std::min(bounds[k].Hi(), bound.bounds[k].Hi());
+  }
+  return *this;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::Overlap(
+    const FixedHRectBound& bound) const
+{
+  ElemType volume = 1.0;
+  for (size_t k = 0; k < FixedDim; ++k)
+  {
+    const ElemType lo = std::max(bounds[k].Lo(), bound.bounds[k].Lo());
+    const ElemType hi = std::min(bounds[k].Hi(), bound.bounds[k].Hi());
+
+    if (hi <= lo)
+      return 0;
+
+    volume *= hi - lo;
+  }
+  return volume;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<FixedDim, MetricType, ElemType>::Diameter()
+    const
+{
+  ElemType d = 0;
+  for (size_t i = 0; i < FixedDim; ++i)
+    d += std::pow(bounds[i].Hi() - bounds[i].Lo(),
+        (ElemType) MetricType::Power);
+
+  if (MetricType::TakeRoot)
+    return (ElemType) std::pow((double) d, 1.0 / (double) MetricType::Power);
+  else
+    return d;
+}
+
+template<size_t FixedDim, typename MetricType, typename ElemType>
+template<typename Archive>
+void FixedHRectBound<FixedDim, MetricType, ElemType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  // The dimensionality is stored too, so that the archive has the same layout
+  // as the archive of an HRectBound.
+  size_t dim = FixedDim;
+  ar & data::CreateNVP(dim, "dim");
+  if (Archive::is_loading::value && dim != FixedDim)
+  {
+    std::ostringstream oss;
+    oss << "FixedHRectBound::Serialize(): cannot load a bound with " << dim
+        << " dimensions into a bound with " << FixedDim << " dimensions";
+    throw std::invalid_argument(oss.str());
+  }
+
+  math::RangeType<ElemType>* boundsPtr = bounds;
+  ar & data::CreateArrayNVP(boundsPtr, dim, "bounds");
+  ar & data::CreateNVP(minWidth, "minWidth");
+}
+
+} // namespace bound
+} // namespace mlpack
+
+#endif // MLPACK_CORE_TREE_FIXED_HRECTBOUND_IMPL_HPP
@@ -0,0 +1,130 @@
+/**
+ * @file greedy_batch_single_tree_traverser.hpp
+ *
+ * A greedy traverser like GreedySingleTreeTraverser, which routes a batch of
+ * query points down the tree together instead of one query point at a time.
+ * The RuleType class must implement the method 'GetBestChild()'.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_GREEDY_BATCH_SINGLE_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_GREEDY_BATCH_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This gives us a HasNodeBaseCasesCheck object that we can use to tell whether
+ * or not a RuleType can compute the base cases of many query points with the
+ * points of a node at once.
+ */
+HAS_MEM_FUNC(NodeBaseCases, HasNodeBaseCasesCheck);
+
+/**
+ * A greedy single-tree traverser that visits, for each query point, the same
+ * nodes as GreedySingleTreeTraverser (at each node, only the child given by
+ * the GetBestChild() method of the rules), but handles a batch of query points
+ * at once.  The batch is split at each node between the children that its
+ * query points go to, so each node is visited once per batch, and the base
+ * cases between the points held by a node and all of the query points that
+ * reach it are computed together.  If the rules have a method
+ *
+ * @code
+ * size_t NodeBaseCases(const std::vector<size_t>& queryIndices,
+ *                      TreeType& referenceNode);
+ * @endcode
+ *
+ * (as NeighborSearchRules does), it is used for those base cases, so that they
+ * can be computed with a dense kernel; otherwise BaseCase() is called for each
+ * pair.  The base cases of each query point are computed in the same order as
+ * with GreedySingleTreeTraverser, so the results are the same.
+ */
+template<typename TreeType, typename RuleType>
+class GreedyBatchSingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the traverser with the given rule set.
+   *
+   * @param rule Rules to traverse with.
+   * @param batchSize Number of query points that are routed down the tree
+   *     together by the range overload of Traverse().
+   */
+  GreedyBatchSingleTreeTraverser(RuleType& rule,
+                                 const size_t batchSize = 1024);
+
+  /**
+   * Traverse the tree with each of the query points with indices in
+   * [queryBegin, queryEnd), in batches of BatchSize() query points.
+   *
+   * @param queryBegin Index of the first query point.
+   * @param queryEnd One past the index of the last query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryBegin,
+                const size_t queryEnd,
+                TreeType& referenceNode);
+
+  /**
+   * Traverse the tree with the given batch of query points.
+   *
+   * @param queryIndices Indices of the query points of the batch.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const std::vector<size_t>& queryIndices,
+                TreeType& referenceNode);
+
+  //! Get the number of query points of a batch.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of query points of a batch.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+
+ private:
+  /**
+   * Compute the base cases between the query points and the points of the
+   * node with the NodeBaseCases() method of the rules.
+   */
+  template<typename Rule = RuleType>
+  void BaseCases(const std::vector<size_t>& queryIndices,
+                 TreeType& referenceNode,
+                 const std::enable_if_t<HasNodeBaseCasesCheck<Rule,
+                     size_t(Rule::*)(const std::vector<size_t>&,
+                                     TreeType&)>::value>* = 0);
+
+  /**
+   * Compute the base cases between the query points and the points of the
+   * node one pair at a time, for rules without a NodeBaseCases() method.
+   */
+  template<typename Rule = RuleType>
+  void BaseCases(const std::vector<size_t>& queryIndices,
+                 TreeType& referenceNode,
+                 const std::enable_if_t<!HasNodeBaseCasesCheck<Rule,
+                     size_t(Rule::*)(const std::vector<size_t>&,
+                                     TreeType&)>::value>* = 0);
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The number of query points of a batch.
+  size_t batchSize;
+
+  //! The number of nodes which have been pruned during traversal.
+  size_t numPrunes;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "greedy_batch_single_tree_traverser_impl.hpp"
+
+#endif
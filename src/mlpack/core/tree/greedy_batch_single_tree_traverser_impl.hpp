@@ -0,0 +1,128 @@
+/**
+ * @file greedy_batch_single_tree_traverser_impl.hpp
+ *
+ * Implementation of GreedyBatchSingleTreeTraverser, which routes batches of
+ * query points down the tree greedily.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_GREEDY_BATCH_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_GREEDY_BATCH_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "greedy_batch_single_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType, typename RuleType>
+GreedyBatchSingleTreeTraverser<TreeType, RuleType>::
+GreedyBatchSingleTreeTraverser(RuleType& rule, const size_t batchSize) :
+    rule(rule),
+    batchSize(batchSize),
+    numPrunes(0)
+{ /* Nothing to do. */ }
+
+template<typename TreeType, typename RuleType>
+void GreedyBatchSingleTreeTraverser<TreeType, RuleType>::Traverse(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    TreeType& referenceNode)
+{
+  const size_t step = std::max(batchSize, (size_t) 1);
+  std::vector<size_t> queryIndices;
+  for (size_t begin = queryBegin; begin < queryEnd; begin += step)
+  {
+    const size_t end = std::min(queryEnd, begin + step);
+    queryIndices.resize(end - begin);
+    for (size_t i = begin; i < end; ++i)
+      queryIndices[i - begin] = i;
+
+    Traverse(queryIndices, referenceNode);
+  }
+}
+
+template<typename TreeType, typename RuleType>
+void GreedyBatchSingleTreeTraverser<TreeType, RuleType>::Traverse(
+    const std::vector<size_t>& queryIndices,
+    TreeType& referenceNode)
+{
+  if (queryIndices.empty())
+    return;
+
+  // Run the base cases for all the points in the reference node.
+  BaseCases(queryIndices, referenceNode);
+
+  if (referenceNode.IsLeaf())
+    return;
+
+  // We are pruning all but one child for each query point.
+  const size_t numChildren = referenceNode.NumChildren();
+  numPrunes += (numChildren - 1) * queryIndices.size();
+
+  // Split the batch between the best children of its query points, keeping the
+  // order of the query points.
+  std::vector<size_t> bestChildren(queryIndices.size());
+  std::vector<size_t> counts(numChildren, 0);
+  for (size_t i = 0; i < queryIndices.size(); ++i)
+  {
+    bestChildren[i] = rule.GetBestChild(queryIndices[i], referenceNode);
+    ++counts[bestChildren[i]];
+  }
+
+  std::vector<size_t> childIndices;
+  for (size_t c = 0; c < numChildren; ++c)
+  {
+    if (counts[c] == 0)
+      continue;
+
+    // The whole batch may go to the same child, in which case it is passed
+    // down as it is.
+    if (counts[c] == queryIndices.size())
+    {
+      Traverse(queryIndices, referenceNode.Child(c));
+      return;
+    }
+
+    childIndices.clear();
+    childIndices.reserve(counts[c]);
+    for (size_t i = 0; i < queryIndices.size(); ++i)
+      if (bestChildren[i] == c)
+        childIndices.push_back(queryIndices[i]);
+
+    Traverse(childIndices, referenceNode.Child(c));
+  }
+}
+
+template<typename TreeType, typename RuleType>
+template<typename Rule>
+void GreedyBatchSingleTreeTraverser<TreeType, RuleType>::BaseCases(
+    const std::vector<size_t>& queryIndices,
+    TreeType& referenceNode,
+    const std::enable_if_t<HasNodeBaseCasesCheck<Rule,
+        size_t(Rule::*)(const std::vector<size_t>&, TreeType&)>::value>*)
+{
+  if (referenceNode.NumPoints() > 0)
+    rule.NodeBaseCases(queryIndices, referenceNode);
+}
+
+template<typename TreeType, typename RuleType>
+template<typename Rule>
+void GreedyBatchSingleTreeTraverser<TreeType, RuleType>::BaseCases(
+    const std::vector<size_t>& queryIndices,
+    TreeType& referenceNode,
+    const std::enable_if_t<!HasNodeBaseCasesCheck<Rule,
+        size_t(Rule::*)(const std::vector<size_t>&, TreeType&)>::value>*)
+{
+  for (size_t j = 0; j < queryIndices.size(); ++j)
+    for (size_t i = 0; i < referenceNode.NumPoints(); ++i)
+      rule.BaseCase(queryIndices[j], referenceNode.Point(i));
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
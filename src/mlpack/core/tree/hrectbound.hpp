@@ -17,6 +17,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/range.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/metrics/fixed_lmetric.hpp>
 #include "bound_traits.hpp"
 
 namespace mlpack {
@@ -39,6 +40,12 @@ struct IsLMetric<metric::LMetric<Power, TakeRoot>>
   static const bool Value = true;
 };
 
+template<size_t FixedDim, int Power, bool TakeRoot>
+struct IsLMetric<metric::FixedLMetric<FixedDim, Power, TakeRoot>>
+{
+  static const bool Value = true;
+};
+
 } // namespace meta
 
 /**
@@ -512,8 +512,10 @@ HRectBound<MetricType, ElemType>::operator|=(const MatType& data)
 {
   Log::Assert(data.n_rows == dim);
 
-  arma::Col<ElemType> mins(min(data, 1));
-  arma::Col<ElemType> maxs(max(data, 1));
+  // The data may hold a different element type than the bound (for instance,
+  // when single-precision points are bounded in double precision).
+  arma::Col<typename MatType::elem_type> mins(min(data, 1));
+  arma::Col<typename MatType::elem_type> maxs(max(data, 1));
 
   minWidth = std::numeric_limits<ElemType>::max();
   for (size_t i = 0; i < dim; i++)
@@ -19,6 +19,24 @@
 namespace mlpack {
 namespace tree {
 
+/**
+ * The Octree is a generalization of the quadtree and the octree to any number
+ * of dimensions: each node is split at its center into (up to) 2^d children,
+ * one for each orthant, and empty children are not created.  It is best suited
+ * to low-dimensional data, like 3-dimensional point clouds, which can be held
+ * in single precision (arma::fmat).
+ *
+ * The tree is built in parallel with OpenMP.  The points of large nodes (of at
+ * least 100000 points, in at most 8 dimensions) are sorted by child with a
+ * counting sort that each thread runs on a chunk of the points; this needs a
+ * temporary copy of the points of the node.  The children of large nodes are
+ * then built as parallel tasks, since they hold disjoint ranges of points.
+ * The tree does not depend on the number of threads.
+ *
+ * @tparam MetricType The metric to use.
+ * @tparam StatisticType Extra data contained in each node.
+ * @tparam MatType The type of the dataset.
+ */
 template<typename MetricType = metric::EuclideanDistance,
          typename StatisticType = EmptyStatistic,
          typename MatType = arma::mat>
@@ -399,31 +417,88 @@ class Octree
   friend class boost::serialization::access;
 
  private:
+  //! Compute the bound of the points of the node (in parallel, for large
+  //! nodes).
+  void ComputeBound();
+
   /**
    * Split the node, using the given center and the given maximum width of this
-   * node.
+   * node, and fill the mappings vector if it is given.
    *
    * @param center Center of the node.
    * @param width Width of the current node.
+   * @param oldFromNew Mappings from old to new (may be NULL).
    * @param maxLeafSize Maximum number of points allowed in a leaf.
    */
   void SplitNode(const arma::vec& center,
                  const double width,
+                 std::vector<size_t>* oldFromNew,
                  const size_t maxLeafSize);
 
   /**
-   * Split the node, using the given center and the given maximum width of this
-   * node, and fill the mappings vector.
+   * Reorder the points of the node so that the points of each child are
+   * contiguous, with one in-place split for each dimension, and store the index
+   * of the first point of each child.
+   *
+   * @param center Center of the node.
+   * @param childBegins Index of the first point of each child (and one past the
+   *     last point of the node).
+   * @param oldFromNew Mappings from old to new (may be NULL).
+   */
+  void PartitionInPlace(const arma::vec& center,
+                        arma::Col<size_t>& childBegins,
+                        std::vector<size_t>* oldFromNew);
+
+  /**
+   * Reorder the points of the node so that the points of each child are
+   * contiguous, with a parallel counting sort by child (which keeps the order
+   * of the points of each child), and store the index of the first point of
+   * each child.  This only works for dense data in at most 8 dimensions.
+   *
+   * @param center Center of the node.
+   * @param childBegins Index of the first point of each child (and one past the
+   *     last point of the node).
+   * @param oldFromNew Mappings from old to new (may be NULL).
+   */
+  void PartitionByChild(const arma::vec& center,
+                        arma::Col<size_t>& childBegins,
+                        std::vector<size_t>* oldFromNew);
+
+  /**
+   * Create the non-empty children of the node, once its points are ordered by
+   * child, in parallel for large nodes.
    *
    * @param center Center of the node.
    * @param width Width of the current node.
-   * @param oldFromNew Mappings from old to new.
+   * @param childBegins Index of the first point of each child (and one past the
+   *     last point of the node).
+   * @param oldFromNew Mappings from old to new (may be NULL).
    * @param maxLeafSize Maximum number of points allowed in a leaf.
    */
-  void SplitNode(const arma::vec& center,
-                 const double width,
-                 std::vector<size_t>& oldFromNew,
-                 const size_t maxLeafSize);
+  void BuildChildren(const arma::vec& center,
+                     const double width,
+                     const arma::Col<size_t>& childBegins,
+                     std::vector<size_t>* oldFromNew,
+                     const size_t maxLeafSize);
+
+  /**
+   * Create one child of the node.
+   *
+   * @param childIndex Position of the child in the children of the node.
+   * @param i Index of the orthant of the child.
+   * @param childCenter Center of the child.
+   * @param childWidth Width of the child.
+   * @param childBegins Index of the first point of each child.
+   * @param oldFromNew Mappings from old to new (may be NULL).
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   */
+  void BuildChild(const size_t childIndex,
+                  const size_t i,
+                  const arma::vec& childCenter,
+                  const double childWidth,
+                  const arma::Col<size_t>& childBegins,
+                  std::vector<size_t>* oldFromNew,
+                  const size_t maxLeafSize);
 
   /**
    * This is used for sorting points while splitting.
@@ -13,9 +13,15 @@
 #define MLPACK_CORE_TREE_OCTREE_OCTREE_IMPL_HPP
 
 #include "octree.hpp"
+#include <mlpack/core/tree/parallel_split_threshold.hpp>
 #include <mlpack/core/tree/perform_split.hpp>
+#include <mlpack/core/util/reduction_partials.hpp>
 #include <stack>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree {
 
@@ -33,7 +39,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
   if (count > 0)
   {
     // Calculate empirical center of data.
-    bound |= *this->dataset;
+    ComputeBound();
     arma::vec center;
     bound.Center(center);
 
@@ -42,7 +48,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    SplitNode(center, maxWidth, NULL, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -75,7 +81,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   if (count > 0)
   {
     // Calculate empirical center of data.
-    bound |= *this->dataset;
+    ComputeBound();
     arma::vec center;
     bound.Center(center);
 
@@ -84,7 +90,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitNode(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -118,7 +124,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   if (count > 0)
   {
     // Calculate empirical center of data.
-    bound |= *this->dataset;
+    ComputeBound();
     arma::vec center;
     bound.Center(center);
 
@@ -127,7 +133,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitNode(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -159,7 +165,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
   if (count > 0)
   {
     // Calculate empirical center of data.
-    bound |= *this->dataset;
+    ComputeBound();
     arma::vec center;
     bound.Center(center);
 
@@ -168,7 +174,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    SplitNode(center, maxWidth, NULL, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -201,7 +207,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   if (count > 0)
   {
     // Calculate empirical center of data.
-    bound |= *this->dataset;
+    ComputeBound();
     arma::vec center;
     bound.Center(center);
 
@@ -210,7 +216,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitNode(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -244,7 +250,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   if (count > 0)
   {
     // Calculate empirical center of data.
-    bound |= *this->dataset;
+    ComputeBound();
     arma::vec center;
     bound.Center(center);
 
@@ -253,7 +259,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    SplitNode(center, maxWidth, &oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -287,10 +293,10 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     parent(parent)
 {
   // Calculate empirical center of data.
-  bound |= dataset->cols(begin, begin + count - 1);
+  ComputeBound();
 
   // Now split the node.
-  SplitNode(center, width, maxLeafSize);
+  SplitNode(center, width, NULL, maxLeafSize);
 
   // Calculate the distance from the empirical center of this node to the
   // empirical center of the parent.
@@ -322,10 +328,10 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     parent(parent)
 {
   // Calculate empirical center of data.
-  bound |= dataset->cols(begin, begin + count - 1);
+  ComputeBound();
 
   // Now split the node.
-  SplitNode(center, width, oldFromNew, maxLeafSize);
+  SplitNode(center, width, &oldFromNew, maxLeafSize);
 
   // Calculate the distance from the empirical center of this node to the
   // empirical center of the parent.
@@ -440,7 +446,7 @@ size_t Octree<MetricType, StatisticType, MatType>::GetNearestChild(
 {
   // It's possible that this could be improved by caching which children we have
   // and which we don't, but for now this is just a brute force search.
-  ElemType bestDistance = DBL_MAX;
+  ElemType bestDistance = std::numeric_limits<ElemType>::max();
   size_t bestIndex = NumChildren();
   for (size_t i = 0; i < NumChildren(); ++i)
   {
@@ -484,7 +490,7 @@ size_t Octree<MetricType, StatisticType, MatType>::GetNearestChild(
 {
   // It's possible that this could be improved by caching which children we have
   // and which we don't, but for now this is just a brute force search.
-  ElemType bestDistance = DBL_MAX;
+  ElemType bestDistance = std::numeric_limits<ElemType>::max();
   size_t bestIndex = NumChildren();
   for (size_t i = 0; i < NumChildren(); ++i)
   {
@@ -703,11 +709,42 @@ void Octree<MetricType, StatisticType, MatType>::Serialize(
   }
 }
 
+//! Compute the bound of the node.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::ComputeBound()
+{
+  // The bound of a large node is the union of the bounds of chunks of its
+  // points, which are found in parallel.  (Below the root, the nodes are built
+  // in parallel anyway, so ParallelThreads() is then 1.)
+  if (arma::is_SpMat<MatType>::value || count < 100000 ||
+      ParallelThreads() == 1)
+  {
+    bound |= dataset->cols(begin, begin + count - 1);
+    return;
+  }
+
+  ReductionPartials<bound::HRectBound<MetricType>> partials(count,
+      bound::HRectBound<MetricType>(dataset->n_rows), 0, 16384);
+
+  #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads())
+  for (omp_size_t c = 0; c < (omp_size_t) partials.Chunks(); ++c)
+  {
+    partials.Partial(c) |= dataset->cols(begin + partials.Begin(c),
+        begin + partials.End(c) - 1);
+  }
+
+  bound::HRectBound<MetricType> chunkBound;
+  partials.Reduce(chunkBound, [](bound::HRectBound<MetricType>& a,
+      const bound::HRectBound<MetricType>& b) { a |= b; });
+  bound |= chunkBound;
+}
+
 //! Split the node.
 template<typename MetricType, typename StatisticType, typename MatType>
 void Octree<MetricType, StatisticType, MatType>::SplitNode(
     const arma::vec& center,
     const double width,
+    std::vector<size_t>* oldFromNew,
     const size_t maxLeafSize)
 {
   // No need to split if we have fewer than the maximum number of points in this
@@ -720,6 +757,26 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   childBegins[0] = begin;
   childBegins[childBegins.n_elem - 1] = begin + count;
 
+  // Large nodes are sorted by child out of place, which is one pass over the
+  // points and can be done in parallel; other nodes are split in place.  The
+  // points of each child are the same either way; only their order differs,
+  // and it only depends on the number of points of the node.
+  if (!arma::is_SpMat<MatType>::value && dataset->n_rows <= 8 &&
+      count >= 100000)
+    PartitionByChild(center, childBegins, oldFromNew);
+  else
+    PartitionInPlace(center, childBegins, oldFromNew);
+
+  BuildChildren(center, width, childBegins, oldFromNew, maxLeafSize);
+}
+
+//! Reorder the points of the node by child, in place.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::PartitionInPlace(
+    const arma::vec& center,
+    arma::Col<size_t>& childBegins,
+    std::vector<size_t>* oldFromNew)
+{
   // We will make log2(dim) passes, splitting along the last down to the first
   // dimension.  The tuple holds { dim, begin, count, leftChildIndex }.
   std::stack<std::tuple<size_t, size_t, size_t, size_t>> stack;
@@ -741,8 +798,11 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
     // all points belonging to children of index 2^(d - 1) and above will be on
     // the right side.
     SplitInfo s(d, center);
-    const size_t firstRight = split::PerformSplit<MatType, SplitInfo>(*dataset,
-        childBegin, childCount, s);
+    const size_t firstRight = (oldFromNew == NULL) ?
+        split::PerformSplit<MatType, SplitInfo>(*dataset, childBegin,
+            childCount, s) :
+        split::PerformSplit<MatType, SplitInfo>(*dataset, childBegin,
+            childCount, s, *oldFromNew);
 
     // We can set the first index of the right child.  The first index of the
     // left child is already set.
@@ -778,119 +838,102 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
       }
     }
   }
+}
 
-  // Now that the dataset is reordered, we can create the children.
-  arma::vec childCenter(center.n_elem);
-  const double childWidth = width / 2.0;
-  for (size_t i = 0; i < childBegins.n_elem - 1; ++i)
+//! Reorder the points of the node by child, with a counting sort.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::PartitionByChild(
+    const arma::vec& center,
+    arma::Col<size_t>& childBegins,
+    std::vector<size_t>* oldFromNew)
+{
+  const size_t numChildren = childBegins.n_elem - 1;
+  const size_t threads = ParallelThreads();
+  const size_t chunks = std::min((size_t) 256, (count + 16383) / 16384);
+
+  // Find the child of each point (bit d is set if the point is on the right
+  // side of the center in dimension d), and count the points of each child in
+  // each chunk.
+  std::vector<unsigned char> childIndices(count);
+  arma::Mat<size_t> chunkCounts(numChildren, chunks, arma::fill::zeros);
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks; ++c)
   {
-    // If the child has no points, don't create it.
-    if (childBegins[i + 1] - childBegins[i] == 0)
-      continue;
+    for (size_t i = c * count / chunks; i < (c + 1) * count / chunks; ++i)
+    {
+      // This is the same test as SplitInfo::AssignToLeftNode().
+      size_t child = 0;
+      for (size_t d = 0; d < dataset->n_rows; ++d)
+        if (!((*dataset)(d, begin + i) < center[d]))
+          child |= ((size_t) 1 << d);
+
+      childIndices[i] = (unsigned char) child;
+      ++chunkCounts(child, c);
+    }
+  }
 
-    // Create the correct center.
-    for (size_t d = 0; d < center.n_elem; ++d)
+  // The points of each child are stored in the order of the chunks, so each
+  // chunk knows where to put its points.
+  size_t position = 0;
+  for (size_t child = 0; child < numChildren; ++child)
+  {
+    childBegins[child] = begin + position;
+    for (size_t c = 0; c < chunks; ++c)
     {
-      // Is the dimension "right" (1) or "left" (0)?
-      if (((i >> d) & 1) == 0)
-        childCenter[d] = center[d] - childWidth;
-      else
-        childCenter[d] = center[d] + childWidth;
+      const size_t chunkCount = chunkCounts(child, c);
+      chunkCounts(child, c) = position;
+      position += chunkCount;
     }
+  }
 
-    children.push_back(new Octree(this, childBegins[i],
-        childBegins[i + 1] - childBegins[i], childCenter, childWidth,
-        maxLeafSize));
+  MatType points(dataset->n_rows, count);
+  std::vector<size_t> oldIndices((oldFromNew == NULL) ? 0 : count);
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks; ++c)
+  {
+    for (size_t i = c * count / chunks; i < (c + 1) * count / chunks; ++i)
+    {
+      const size_t newIndex = chunkCounts(childIndices[i], c)++;
+      points.col(newIndex) = dataset->col(begin + i);
+      if (oldFromNew != NULL)
+        oldIndices[newIndex] = (*oldFromNew)[begin + i];
+    }
+  }
+
+  // Copy the points back into the dataset.
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks; ++c)
+  {
+    const size_t chunkBegin = c * count / chunks;
+    const size_t chunkEnd = (c + 1) * count / chunks;
+    dataset->cols(begin + chunkBegin, begin + chunkEnd - 1) =
+        points.cols(chunkBegin, chunkEnd - 1);
+    if (oldFromNew != NULL)
+      std::copy(oldIndices.begin() + chunkBegin, oldIndices.begin() + chunkEnd,
+          oldFromNew->begin() + begin + chunkBegin);
   }
 }
 
-//! Split the node, and store mappings.
+//! Build the children of the node.
 template<typename MetricType, typename StatisticType, typename MatType>
-void Octree<MetricType, StatisticType, MatType>::SplitNode(
+void Octree<MetricType, StatisticType, MatType>::BuildChildren(
     const arma::vec& center,
     const double width,
-    std::vector<size_t>& oldFromNew,
+    const arma::Col<size_t>& childBegins,
+    std::vector<size_t>* oldFromNew,
     const size_t maxLeafSize)
 {
-  // No need to split if we have fewer than the maximum number of points in this
-  // node.
-  if (count <= maxLeafSize)
-    return;
-
-  // This will hold the index of the first point in each child.
-  arma::Col<size_t> childBegins(((size_t) 1 << dataset->n_rows) + 1);
-  childBegins[0] = begin;
-  childBegins[childBegins.n_elem - 1] = begin + count;
-
-  // We will make log2(dim) passes, splitting along the last down to the first
-  // dimension.  The tuple holds { dim, begin, count, leftChildIndex }.
-  std::stack<std::tuple<size_t, size_t, size_t, size_t>> stack;
-  stack.push(std::tuple<size_t, size_t, size_t, size_t>(dataset->n_rows - 1,
-      begin, count, 0));
-
-  while (!stack.empty())
-  {
-    std::tuple<size_t, size_t, size_t, size_t> t = stack.top();
-    stack.pop();
-
-    const size_t d = std::get<0>(t);
-    const size_t childBegin = std::get<1>(t);
-    const size_t childCount = std::get<2>(t);
-    const size_t leftChildIndex = std::get<3>(t);
-
-    // Perform a "half-split": after this split, all points belonging to
-    // children of index 2^(d - 1) - 1 and less will be on the left side, and
-    // all points belonging to children of index 2^(d - 1) and above will be on
-    // the right side.
-    SplitInfo s(d, center);
-    const size_t firstRight = split::PerformSplit<MatType, SplitInfo>(*dataset,
-        childBegin, childCount, s, oldFromNew);
-
-    // We can set the first index of the right child.  The first index of the
-    // left child is already set.
-    const size_t rightChildIndex = leftChildIndex + ((size_t) 1 << d);
-    childBegins[rightChildIndex] = firstRight;
-
-    // Now we have to recurse, if this was not the last dimension.
-    if (d != 0)
-    {
-      if (firstRight > childBegin)
-      {
-        stack.push(std::tuple<size_t, size_t, size_t, size_t>(d - 1, childBegin,
-            firstRight - childBegin, leftChildIndex));
-      }
-      else
-      {
-        // Set beginning indices correctly for all children below this level.
-        for (size_t c = leftChildIndex + 1; c < rightChildIndex; ++c)
-          childBegins[c] = childBegins[leftChildIndex];
-      }
-
-      if (firstRight < childBegin + childCount)
-      {
-        stack.push(std::tuple<size_t, size_t, size_t, size_t>(d - 1, firstRight,
-            childCount - (firstRight - childBegin), rightChildIndex));
-      }
-      else
-      {
-        // Set beginning indices correctly for all children below this level.
-        for (size_t c = rightChildIndex + 1;
-             c < rightChildIndex + (rightChildIndex - leftChildIndex); ++c)
-          childBegins[c] = childBegins[rightChildIndex];
-      }
-    }
-  }
-
-  // Now that the dataset is reordered, we can create the children.
-  arma::vec childCenter(center.n_elem);
+  // Empty children are not created.  Find the center of each other child.
+  std::vector<size_t> childIndices;
+  std::vector<arma::vec> childCenters;
   const double childWidth = width / 2.0;
   for (size_t i = 0; i < childBegins.n_elem - 1; ++i)
   {
-    // If the child has no points, don't create it.
     if (childBegins[i + 1] - childBegins[i] == 0)
       continue;
 
     // Create the correct center.
+    arma::vec childCenter(center.n_elem);
     for (size_t d = 0; d < center.n_elem; ++d)
     {
       // Is the dimension "right" (1) or "left" (0)?
@@ -900,10 +943,66 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
         childCenter[d] = center[d] + childWidth;
     }
 
-    children.push_back(new Octree(this, childBegins[i],
-        childBegins[i + 1] - childBegins[i], oldFromNew, childCenter,
-        childWidth, maxLeafSize));
+    childIndices.push_back(i);
+    childCenters.push_back(std::move(childCenter));
   }
+  children.resize(childIndices.size());
+
+  // The children hold disjoint ranges of points, so they can be built at the
+  // same time, as long as the dataset is dense (column swaps in a sparse matrix
+  // modify shared storage).
+  const bool parallel = !arma::is_SpMat<MatType>::value &&
+      (count >= ParallelSplitThreshold);
+
+  #ifdef HAS_OPENMP
+  // The first large node starts the team of threads; the children of all other
+  // large nodes are built as tasks run by that team.
+  if (parallel && !omp_in_parallel())
+  {
+    #pragma omp parallel num_threads(ParallelThreads())
+    {
+      #pragma omp single
+      {
+        for (size_t c = 0; c < childIndices.size(); ++c)
+        {
+          #pragma omp task shared(childIndices, childCenters, childBegins)
+          BuildChild(c, childIndices[c], childCenters[c], childWidth,
+              childBegins, oldFromNew, maxLeafSize);
+        }
+      }
+    }
+    return;
+  }
+  #endif
+
+  for (size_t c = 0; c < childIndices.size(); ++c)
+  {
+    #pragma omp task if(parallel) \
+        shared(childIndices, childCenters, childBegins)
+    BuildChild(c, childIndices[c], childCenters[c], childWidth, childBegins,
+        oldFromNew, maxLeafSize);
+  }
+
+  // All children must be finished before the statistic of this node is built.
+  #pragma omp taskwait
+}
+
+//! Build one child of the node.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::BuildChild(
+    const size_t childIndex,
+    const size_t i,
+    const arma::vec& childCenter,
+    const double childWidth,
+    const arma::Col<size_t>& childBegins,
+    std::vector<size_t>* oldFromNew,
+    const size_t maxLeafSize)
+{
+  children[childIndex] = (oldFromNew == NULL) ?
+      new Octree(this, childBegins[i], childBegins[i + 1] - childBegins[i],
+          childCenter, childWidth, maxLeafSize) :
+      new Octree(this, childBegins[i], childBegins[i + 1] - childBegins[i],
+          *oldFromNew, childCenter, childWidth, maxLeafSize);
 }
 
 } // namespace tree
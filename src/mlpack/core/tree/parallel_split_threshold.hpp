@@ -0,0 +1,32 @@
+/**
+ * @file parallel_split_threshold.hpp
+ *
+ * The size from which the trees split their nodes with several threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_SPLIT_THRESHOLD_HPP
+#define MLPACK_CORE_TREE_PARALLEL_SPLIT_THRESHOLD_HPP
+
+#include <cstddef>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The number of points from which the work on a node during tree construction
+ * (building its children, or computing the distances of its points) is split
+ * between threads.  Below this, a node takes less time than starting a task or
+ * a parallel loop, so it is handled by a single thread.  Since only the points
+ * of disjoint nodes (or independent distances) are handled at the same time,
+ * the tree that is built does not depend on this value.
+ */
+const size_t ParallelSplitThreshold = 10000;
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file parallel_traverser_traits.hpp
+ *
+ * Checks for whether a tree type has parallel traversers, so that algorithms
+ * can use them when they exist and fall back to the serial traversers when they
+ * do not.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_TRAVERSER_TRAITS_HPP
+#define MLPACK_CORE_TREE_PARALLEL_TRAVERSER_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * HasParallelSingleTreeTraverser<TreeType, RuleType>::value is true if the
+ * given tree type has a ParallelSingleTreeTraverser for the given rules.
+ */
+template<typename TreeType, typename RuleType>
+class HasParallelSingleTreeTraverser
+{
+  template<typename T>
+  static char Check(
+      typename T::template ParallelSingleTreeTraverser<RuleType>*);
+  template<typename T>
+  static long Check(...);
+
+ public:
+  static const bool value = (sizeof(Check<TreeType>(0)) == sizeof(char));
+};
+
+/**
+ * HasParallelDualTreeTraverser<TreeType, RuleType>::value is true if the given
+ * tree type has a ParallelDualTreeTraverser for the given rules.
+ */
+template<typename TreeType, typename RuleType>
+class HasParallelDualTreeTraverser
+{
+  template<typename T>
+  static char Check(typename T::template ParallelDualTreeTraverser<RuleType>*);
+  template<typename T>
+  static long Check(...);
+
+ public:
+  static const bool value = (sizeof(Check<TreeType>(0)) == sizeof(char));
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
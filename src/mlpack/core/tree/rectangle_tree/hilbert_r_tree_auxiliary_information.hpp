@@ -142,6 +142,18 @@ class HilbertRTreeAuxiliaryInformation
   void Serialize(Archive& ar, const unsigned int /* version */);
 };
 
+//! The points of a Hilbert R tree are ordered by their Hilbert values.
+template<typename TreeType,
+         template<typename> class HilbertValueType>
+struct UsesHilbertOrder<HilbertRTreeAuxiliaryInformation<TreeType,
+                                                         HilbertValueType>>
+{
+  static const bool value = true;
+
+  //! The type of the Hilbert values.
+  typedef HilbertValueType<typename TreeType::ElemType> HilbertValue;
+};
+
 } // namespace tree
 } // namespace mlpack
 
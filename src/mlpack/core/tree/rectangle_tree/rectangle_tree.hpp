@@ -24,6 +24,30 @@
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+/**
+ * An empty tag type which selects the bulk-loading constructors of
+ * RectangleTree, for instance:
+ *
+ * @code
+ * RTree<metric::EuclideanDistance, EmptyStatistic, arma::mat> tree(dataset,
+ *     BulkLoadTag());
+ * @endcode
+ */
+struct BulkLoadTag { };
+
+/**
+ * UsesHilbertOrder<AuxiliaryInformationType>::value is true if the auxiliary
+ * information keeps the points of the tree ordered by their Hilbert values, as
+ * the auxiliary information of the Hilbert R tree does.  In that case the
+ * specialization also defines the type of the Hilbert values as HilbertValue.
+ * Bulk loading uses this to decide how to order the points.
+ */
+template<typename AuxiliaryInformationType>
+struct UsesHilbertOrder
+{
+  static const bool value = false;
+};
+
 /**
  * A rectangle type tree tree, such as an R-tree or X-tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -156,6 +180,60 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset, but bulk load the tree instead of inserting the points one at a
+   * time.  The points are divided into the smallest possible number of leaves,
+   * which are filled evenly, and the nodes of each level are formed by
+   * Sort-Tile-Recursive packing: the points of a node are cut into slabs along
+   * the dimension with the largest spread, and each slab is cut again along the
+   * remaining dimensions.  This takes O(n log n) time and gives nodes which
+   * overlap much less than the nodes of a tree built by insertion.
+   *
+   * Packed nodes may overlap, and the points of a Hilbert R tree must be
+   * ordered by their Hilbert values, so for R+ trees, R++ trees and Hilbert R
+   * trees the points are only sorted (by Hilbert value for the Hilbert R tree,
+   * and in Sort-Tile-Recursive order otherwise) and then inserted one at a
+   * time.  As consecutive points are close to each other, this is still much
+   * faster than inserting the points in their original order.
+   *
+   * Points may be inserted into and deleted from the tree afterwards as usual.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(const MatType& data,
+                const BulkLoadTag,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk loading
+   * the given dataset, and taking ownership of the given dataset.  See the
+   * constructor above for details on bulk loading.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(MatType&& data,
+                const BulkLoadTag,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -542,6 +620,79 @@ class RectangleTree
    */
   void SplitNode(std::vector<bool>& relevels);
 
+  /**
+   * Build the tree from all points of the dataset by bulk loading.  This must
+   * only be called on an empty root node.
+   */
+  void BulkLoad();
+
+  /**
+   * Build this node by packing the given leaves.  The points are divided
+   * evenly between numLeaves leaves, in the order given by indices.
+   *
+   * @param indices The indices of all points; the indices of the points of
+   *     this node are rearranged.
+   * @param numPoints The total number of points.
+   * @param numLeaves The total number of leaves.
+   * @param firstLeaf The index of the first leaf of this node.
+   * @param lastLeaf One past the index of the last leaf of this node.
+   * @param height The number of levels below this node (0 for a leaf).
+   */
+  void BulkLoadNode(std::vector<size_t>& indices,
+                    const size_t numPoints,
+                    const size_t numLeaves,
+                    const size_t firstLeaf,
+                    const size_t lastLeaf,
+                    const size_t height);
+
+  /**
+   * Rearrange the indices of the points of the given groups with
+   * Sort-Tile-Recursive tiling, so that the points of each group form a tile.
+   * Group i holds the points with positions in [groupBegin[i],
+   * groupBegin[i + 1]).
+   *
+   * @param indices The indices of the points.
+   * @param groupBegin The position of the first point of each group.
+   * @param firstGroup The first group to tile.
+   * @param lastGroup One past the last group to tile.
+   * @param numDims The number of dimensions left to cut along.
+   */
+  void TilePoints(std::vector<size_t>& indices,
+                  const std::vector<size_t>& groupBegin,
+                  const size_t firstGroup,
+                  const size_t lastGroup,
+                  const size_t numDims) const;
+
+  /**
+   * Order the points for bulk loading by insertion: by their Hilbert values, if
+   * the auxiliary information requires that.
+   */
+  template<typename AuxType = AuxiliaryInformation>
+  void BulkLoadOrder(std::vector<size_t>& indices,
+                     const size_t numLeaves,
+                     const typename std::enable_if<
+                         UsesHilbertOrder<AuxType>::value>::type* = 0) const;
+
+  /**
+   * Order the points for bulk loading by insertion: in Sort-Tile-Recursive
+   * order, leaf by leaf.
+   */
+  template<typename AuxType = AuxiliaryInformation>
+  void BulkLoadOrder(std::vector<size_t>& indices,
+                     const size_t numLeaves,
+                     const typename std::enable_if<
+                         !UsesHilbertOrder<AuxType>::value>::type* = 0) const;
+
+  //! Get the position of the first point of the given leaf, when numPoints
+  //! points are divided evenly between numLeaves leaves.
+  static size_t LeafBegin(const size_t leaf,
+                          const size_t numPoints,
+                          const size_t numLeaves)
+  {
+    return leaf * (numPoints / numLeaves) +
+        std::min(leaf, numPoints % numLeaves);
+  }
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
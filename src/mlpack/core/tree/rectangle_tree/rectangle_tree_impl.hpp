@@ -17,6 +17,7 @@
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/tree/tree_traits.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -101,6 +102,74 @@ RectangleTree(MatType&& data,
     root->InsertPoint(i);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const BulkLoadTag,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  BulkLoad();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const BulkLoadTag,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  BulkLoad();
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -893,6 +962,237 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
   }
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::BulkLoad()
+{
+  if (maxLeafSize == 0)
+    throw std::invalid_argument("RectangleTree: maxLeafSize must be positive!");
+  if (maxNumChildren < 2)
+  {
+    throw std::invalid_argument("RectangleTree: maxNumChildren must be at "
+        "least 2!");
+  }
+
+  const size_t numPoints = dataset->n_cols;
+  std::vector<size_t> indices(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    indices[i] = i;
+
+  // The smallest number of leaves that can hold all the points.
+  const size_t numLeaves = std::max((numPoints + maxLeafSize - 1) /
+      maxLeafSize, (size_t) 1);
+
+  // Packed nodes may overlap, which R+ and R++ trees do not allow, and the
+  // leaves of a Hilbert R tree must follow the Hilbert curve.  So for these
+  // trees, we sort the points and insert them in that order.
+  if (!TreeTraits<RectangleTree>::HasOverlappingChildren ||
+      UsesHilbertOrder<AuxiliaryInformation>::value)
+  {
+    BulkLoadOrder(indices, numLeaves);
+
+    stat = StatisticType(*this);
+    for (size_t i = 0; i < numPoints; ++i)
+      InsertPoint(indices[i]);
+
+    return;
+  }
+
+  // The tree is as low as possible: numLeaves leaves must fit below the root.
+  size_t height = 0;
+  for (size_t capacity = 1; capacity < numLeaves; capacity *= maxNumChildren)
+    ++height;
+
+  BulkLoadNode(indices, numPoints, numLeaves, 0, numLeaves, height);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoadNode(std::vector<size_t>& indices,
+                 const size_t numPoints,
+                 const size_t numLeaves,
+                 const size_t firstLeaf,
+                 const size_t lastLeaf,
+                 const size_t height)
+{
+  if (height == 0)
+  {
+    // This is a leaf, so it takes its share of the points.
+    const size_t end = LeafBegin(lastLeaf, numPoints, numLeaves);
+    for (size_t i = LeafBegin(firstLeaf, numPoints, numLeaves); i < end; ++i)
+    {
+      bound |= dataset->col(indices[i]);
+      if (!auxiliaryInfo.HandlePointInsertion(this, indices[i]))
+        points[count++] = indices[i];
+    }
+
+    numDescendants = count;
+  }
+  else
+  {
+    // Each child can hold maxNumChildren^(height - 1) leaves.  We use as few
+    // children as possible, but no fewer than minNumChildren.
+    size_t childCapacity = 1;
+    for (size_t i = 1; i < height; ++i)
+      childCapacity *= maxNumChildren;
+
+    const size_t nodeLeaves = lastLeaf - firstLeaf;
+    const size_t nodeChildren = std::max(
+        (nodeLeaves + childCapacity - 1) / childCapacity,
+        std::min(nodeLeaves, minNumChildren));
+
+    // Divide the leaves evenly between the children.
+    std::vector<size_t> childLeaves(nodeChildren + 1);
+    std::vector<size_t> childBegin(nodeChildren + 1);
+    for (size_t i = 0; i <= nodeChildren; ++i)
+    {
+      childLeaves[i] = firstLeaf + i * (nodeLeaves / nodeChildren) +
+          std::min(i, nodeLeaves % nodeChildren);
+      childBegin[i] = LeafBegin(childLeaves[i], numPoints, numLeaves);
+    }
+
+    // Now arrange the points so that the points of each child form a tile.
+    TilePoints(indices, childBegin, 0, nodeChildren, dataset->n_rows);
+
+    for (size_t i = 0; i < nodeChildren; ++i)
+    {
+      RectangleTree* child = new RectangleTree(this);
+      child->BulkLoadNode(indices, numPoints, numLeaves, childLeaves[i],
+          childLeaves[i + 1], height - 1);
+
+      bound |= child->Bound();
+      numDescendants += child->numDescendants;
+      if (!auxiliaryInfo.HandleNodeInsertion(this, child, true))
+        children[numChildren++] = child;
+    }
+  }
+
+  // The node is complete now, so we can build its statistic.
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    TilePoints(std::vector<size_t>& indices,
+               const std::vector<size_t>& groupBegin,
+               const size_t firstGroup,
+               const size_t lastGroup,
+               const size_t numDims) const
+{
+  const size_t numGroups = lastGroup - firstGroup;
+  if (numGroups <= 1)
+    return;
+
+  const size_t begin = groupBegin[firstGroup];
+  const size_t end = groupBegin[lastGroup];
+
+  // Sort the points along the dimension in which they are spread the most.
+  bound::HRectBound<metric::EuclideanDistance, ElemType> range(dataset->n_rows);
+  for (size_t i = begin; i < end; ++i)
+    range |= dataset->col(indices[i]);
+
+  size_t dim = 0;
+  for (size_t d = 1; d < range.Dim(); ++d)
+    if (range[d].Width() > range[dim].Width())
+      dim = d;
+
+  const MatType& data = *dataset;
+  std::sort(indices.begin() + begin, indices.begin() + end,
+      [&data, dim](const size_t a, const size_t b)
+      {
+        return data(dim, a) < data(dim, b);
+      });
+
+  // Cut the groups into the smallest number of slices s with
+  // s^numDims >= numGroups, and tile each slice along the other dimensions.
+  size_t numSlices = (numDims <= 1) ? numGroups : 1;
+  while (numSlices < numGroups)
+  {
+    size_t power = 1;
+    for (size_t i = 0; i < numDims && power < numGroups; ++i)
+      power *= numSlices;
+
+    if (power >= numGroups)
+      break;
+
+    ++numSlices;
+  }
+
+  const size_t groupsPerSlice = (numGroups + numSlices - 1) / numSlices;
+  for (size_t i = firstGroup; i < lastGroup; i += groupsPerSlice)
+  {
+    TilePoints(indices, groupBegin, i, std::min(i + groupsPerSlice, lastGroup),
+        (numDims > 1) ? numDims - 1 : 1);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename AuxType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoadOrder(std::vector<size_t>& indices,
+                  const size_t /* numLeaves */,
+                  const typename std::enable_if<
+                      UsesHilbertOrder<AuxType>::value>::type*) const
+{
+  typedef typename UsesHilbertOrder<AuxType>::HilbertValue HilbertValue;
+  typedef typename HilbertValue::HilbertElemType HilbertElemType;
+
+  // Calculate each Hilbert value only once.
+  std::vector<arma::Col<HilbertElemType>> values(dataset->n_cols);
+  for (size_t i = 0; i < dataset->n_cols; ++i)
+    values[i] = HilbertValue::CalculateValue(dataset->col(i));
+
+  std::sort(indices.begin(), indices.end(),
+      [&values](const size_t a, const size_t b)
+      {
+        return HilbertValue::CompareValues(values[a], values[b]) < 0;
+      });
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename AuxType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoadOrder(std::vector<size_t>& indices,
+                  const size_t numLeaves,
+                  const typename std::enable_if<
+                      !UsesHilbertOrder<AuxType>::value>::type*) const
+{
+  std::vector<size_t> leafBegin(numLeaves + 1);
+  for (size_t i = 0; i <= numLeaves; ++i)
+    leafBegin[i] = LeafBegin(i, indices.size(), numLeaves);
+
+  TilePoints(indices, leafBegin, 0, numLeaves, dataset->n_rows);
+}
+
 //! Default constructor for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
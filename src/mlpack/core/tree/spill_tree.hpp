@@ -18,6 +18,8 @@
 #include "spill_tree/spill_tree.hpp"
 #include "spill_tree/spill_single_tree_traverser.hpp"
 #include "spill_tree/spill_single_tree_traverser_impl.hpp"
+#include "spill_tree/spill_parallel_single_tree_traverser.hpp"
+#include "spill_tree/spill_parallel_single_tree_traverser_impl.hpp"
 #include "spill_tree/spill_dual_tree_traverser.hpp"
 #include "spill_tree/spill_dual_tree_traverser_impl.hpp"
 #include "spill_tree/traits.hpp"
@@ -0,0 +1,110 @@
+/**
+ * @file spill_parallel_single_tree_traverser.hpp
+ *
+ * A nested class of SpillTree which traverses the tree with a range of query
+ * points, using several threads.  Each query point is traversed by a
+ * SpillSingleTreeTraverser.  The Defeatist template parameter determines if the
+ * traversers must do defeatist search on overlapping nodes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SPILL_TREE_SPILL_PARALLEL_SINGLE_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_SPILL_TREE_SPILL_PARALLEL_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "spill_tree.hpp"
+#include "spill_single_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A single-tree traverser for spill trees that uses multiple threads.  The
+ * query points of a batch are handed out to the threads dynamically, and each
+ * thread traverses the reference tree with its query points one after another
+ * with a SpillSingleTreeTraverser.  So, for each query point, the same nodes
+ * are visited and the same base cases are computed as without threads.
+ *
+ * Each thread receives its own copy of the rules, made with the RuleType copy
+ * constructor.  That copy must share the results of the original rules object
+ * (as, e.g., NeighborSearchRules does), but may hold its own counters.  The
+ * reference tree is shared by all threads, so the rules must not change it
+ * during single-tree traversal; NeighborSearchRules does not for spill trees.
+ *
+ * If mlpack was compiled without OpenMP, or only one thread is requested, the
+ * query points are traversed one after another by the calling thread.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType, bool Defeatist>
+class SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
+    SpillParallelSingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel single tree traverser with the given rule set.
+   *
+   * @param rule Rules to traverse with.
+   * @param numThreads Number of threads to use; if 0, the number of threads
+   *     available to OpenMP is used.
+   */
+  SpillParallelSingleTreeTraverser(RuleType& rule, const size_t numThreads = 0);
+
+  /**
+   * Traverse the tree with the given point, using only the calling thread.
+   *
+   * @param queryIndex The index of the point in the query set which is being
+   *     used as the query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryIndex, SpillTree& referenceNode);
+
+  /**
+   * Traverse the tree with each of the query points with indices in
+   * [queryBegin, queryEnd), using several threads.  This does not reset the
+   * number of prunes.
+   *
+   * @param queryBegin Index of the first query point.
+   * @param queryEnd One past the index of the last query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryBegin,
+                const size_t queryEnd,
+                SpillTree& referenceNode);
+
+  //! Get the number of threads used for traversal.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for traversal.
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+ private:
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The number of threads to use.
+  size_t numThreads;
+
+  //! The number of nodes which have been pruned during traversal.
+  size_t numPrunes;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "spill_parallel_single_tree_traverser_impl.hpp"
+
+#endif
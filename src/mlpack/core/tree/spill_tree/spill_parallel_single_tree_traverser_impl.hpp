@@ -0,0 +1,117 @@
+/**
+ * @file spill_parallel_single_tree_traverser_impl.hpp
+ *
+ * Implementation of the SpillParallelSingleTreeTraverser for SpillTree.  The
+ * query points are divided between threads, each of which runs a
+ * SpillSingleTreeTraverser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SPILL_TREE_SPILL_PARALLEL_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_SPILL_TREE_SPILL_PARALLEL_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "spill_parallel_single_tree_traverser.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace tree {
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType, bool Defeatist>
+SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
+SpillParallelSingleTreeTraverser<RuleType, Defeatist>::
+SpillParallelSingleTreeTraverser(RuleType& rule, const size_t numThreads) :
+    rule(rule),
+    numThreads(numThreads),
+    numPrunes(0)
+{ /* Nothing to do. */ }
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType, bool Defeatist>
+void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
+SpillParallelSingleTreeTraverser<RuleType, Defeatist>::Traverse(
+    const size_t queryIndex,
+    SpillTree& referenceNode)
+{
+  SpillSingleTreeTraverser<RuleType, Defeatist> traverser(rule);
+  traverser.Traverse(queryIndex, referenceNode);
+  numPrunes += traverser.NumPrunes();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+template<typename RuleType, bool Defeatist>
+void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
+SpillParallelSingleTreeTraverser<RuleType, Defeatist>::Traverse(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    SpillTree& referenceNode)
+{
+  const size_t threads = ParallelThreads(numThreads);
+
+  // With one thread, or one query point, there is nothing to divide.
+  if (threads <= 1 || queryEnd - queryBegin <= 1)
+  {
+    SpillSingleTreeTraverser<RuleType, Defeatist> traverser(rule);
+    for (size_t i = queryBegin; i < queryEnd; ++i)
+      traverser.Traverse(i, referenceNode);
+    numPrunes += traverser.NumPrunes();
+    return;
+  }
+
+  size_t prunes = 0, ruleScores = 0, ruleBaseCases = 0;
+
+  #pragma omp parallel num_threads(threads) \
+      reduction(+:prunes, ruleScores, ruleBaseCases)
+  {
+    // Each thread has its own rules object, which shares its results with the
+    // original rules object.
+    RuleType workerRule(rule);
+    const size_t startScores = workerRule.Scores();
+    const size_t startBaseCases = workerRule.BaseCases();
+    SpillSingleTreeTraverser<RuleType, Defeatist> traverser(workerRule);
+
+    // Defeatist search visits few nodes per query point, so the query points
+    // are handed out in chunks to keep the scheduling overhead low.
+    #pragma omp for schedule(dynamic, 64)
+    for (omp_size_t i = (omp_size_t) queryBegin; i < (omp_size_t) queryEnd;
+         ++i)
+    {
+      traverser.Traverse(i, referenceNode);
+    }
+
+    prunes += traverser.NumPrunes();
+    ruleScores += workerRule.Scores() - startScores;
+    ruleBaseCases += workerRule.BaseCases() - startBaseCases;
+  }
+
+  numPrunes += prunes;
+  rule.Scores() += ruleScores;
+  rule.BaseCases() += ruleBaseCases;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
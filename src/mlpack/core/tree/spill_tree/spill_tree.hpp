@@ -121,6 +121,12 @@ class SpillTree
   template<typename RuleType, bool Defeatist = false>
   class SpillSingleTreeTraverser;
 
+  //! A single-tree traverser for hybrid spill trees that traverses many query
+  //! points at once with several threads; see
+  //! spill_parallel_single_tree_traverser.hpp for implementation.
+  template<typename RuleType, bool Defeatist = false>
+  class SpillParallelSingleTreeTraverser;
+
   //! A generic dual-tree traverser for hybrid spill trees; see
   //! spill_dual_tree_traverser.hpp for implementation.  The Defeatist
   //! template parameter determines if the traverser must do defeatist search on
@@ -137,6 +143,16 @@ class SpillTree
   template<typename RuleType>
   using DefeatistSingleTreeTraverser = SpillSingleTreeTraverser<RuleType, true>;
 
+  //! A multithreaded single-tree traverser for hybrid spill trees.
+  template<typename RuleType>
+  using ParallelSingleTreeTraverser =
+      SpillParallelSingleTreeTraverser<RuleType, false>;
+
+  //! A multithreaded defeatist single-tree traverser for hybrid spill trees.
+  template<typename RuleType>
+  using DefeatistParallelSingleTreeTraverser =
+      SpillParallelSingleTreeTraverser<RuleType, true>;
+
   //! A dual-tree traverser for hybrid spill trees.
   template<typename RuleType>
   using DualTreeTraverser = SpillDualTreeTraverser<RuleType, false>;
@@ -91,4 +91,37 @@ struct IsVector<arma::SpSubview<eT> >
   const static bool value = true;
 };
 
+/**
+ * If value == true, then VecType is a dense Armadillo vector whose elements
+ * are contiguous in memory, so they can be read through a pointer to the first
+ * element (VecType::colptr(0)).  Rows of matrices (subview_row) are not
+ * contiguous.
+ */
+template<typename VecType>
+struct IsContiguousVector
+{
+  const static bool value = false;
+};
+
+// template<>
+template<typename eT>
+struct IsContiguousVector<arma::Col<eT> >
+{
+  const static bool value = true;
+};
+
+// template<>
+template<typename eT>
+struct IsContiguousVector<arma::Row<eT> >
+{
+  const static bool value = true;
+};
+
+// template<>
+template<typename eT>
+struct IsContiguousVector<arma::subview_col<eT> >
+{
+  const static bool value = true;
+};
+
 #endif
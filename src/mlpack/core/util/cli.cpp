@@ -113,14 +113,14 @@ bool CLI::HasParam(const std::string& key)
 {
   std::string usedKey = key;
   const std::map<std::string, util::ParamData>& parameters =
-      GetSingleton().parameters;
+      Settings().parameters;
 
   if (!parameters.count(key))
   {
     // Check any aliases, but only after we are sure the actual option as given
     // does not exist.
-    if (key.length() == 1 && GetSingleton().aliases.count(key[0]))
-      usedKey = GetSingleton().aliases[key[0]];
+    if (key.length() == 1 && Settings().aliases.count(key[0]))
+      usedKey = Settings().aliases[key[0]];
 
     if (!parameters.count(usedKey))
     {
@@ -133,6 +133,12 @@ bool CLI::HasParam(const std::string& key)
   return (parameters.at(checkKey).wasPassed > 0);
 }
 
+// Returns the settings of the calling thread.
+CLI& CLI::Settings()
+{
+  return (context != NULL) ? *context : GetSingleton();
+}
+
 // Returns the sole instance of this class.
 CLI& CLI::GetSingleton()
 {
@@ -159,13 +165,13 @@ void CLI::RegisterProgramDoc(ProgramDoc* doc)
 // Get the parameters that the CLI object knows about.
 std::map<std::string, ParamData>& CLI::Parameters()
 {
-  return GetSingleton().parameters;
+  return Settings().parameters;
 }
 
 // Get the parameters that the CLI object knows about.
 std::map<char, std::string>& CLI::Aliases()
 {
-  return GetSingleton().aliases;
+  return Settings().aliases;
 }
 
 // Get the program name as set by PROGRAM_INFO().
@@ -177,14 +183,14 @@ std::string CLI::ProgramName()
 // Set a particular parameter as passed.
 void CLI::SetPassed(const std::string& name)
 {
-  if (GetSingleton().parameters.count(name) == 0)
+  if (Settings().parameters.count(name) == 0)
   {
     throw std::invalid_argument("CLI::SetPassed(): parameter " + name +
         " not known!");
   }
 
   // Set passed to true.
-  GetSingleton().parameters[name].wasPassed = true;
+  Settings().parameters[name].wasPassed = true;
 }
 
 // Store settings.
@@ -192,9 +198,10 @@ void CLI::StoreSettings(const std::string& name)
 {
   // Take all of the parameters and put them in the map.  Clear anything old
   // first.
-  std::get<0>(GetSingleton().storageMap[name]) = GetSingleton().parameters;
-  std::get<1>(GetSingleton().storageMap[name]) = GetSingleton().aliases;
-  std::get<2>(GetSingleton().storageMap[name]) = GetSingleton().functionMap;
+  std::lock_guard<std::mutex> lock(GetSingleton().storageMutex);
+  std::get<0>(GetSingleton().storageMap[name]) = Settings().parameters;
+  std::get<1>(GetSingleton().storageMap[name]) = Settings().aliases;
+  std::get<2>(GetSingleton().storageMap[name]) = Settings().functionMap;
 
   ClearSettings();
 }
@@ -202,6 +209,7 @@ void CLI::StoreSettings(const std::string& name)
 // Restore settings.
 void CLI::RestoreSettings(const std::string& name, const bool fatal)
 {
+  std::lock_guard<std::mutex> lock(GetSingleton().storageMutex);
   if (GetSingleton().storageMap.count(name) == 0 && fatal)
   {
     throw std::invalid_argument("no settings stored under the name '" + name
@@ -214,9 +222,9 @@ void CLI::RestoreSettings(const std::string& name, const bool fatal)
   }
   else
   {
-    GetSingleton().parameters = std::get<0>(GetSingleton().storageMap[name]);
-    GetSingleton().aliases = std::get<1>(GetSingleton().storageMap[name]);
-    GetSingleton().functionMap = std::get<2>(GetSingleton().storageMap[name]);
+    Settings().parameters = std::get<0>(GetSingleton().storageMap[name]);
+    Settings().aliases = std::get<1>(GetSingleton().storageMap[name]);
+    Settings().functionMap = std::get<2>(GetSingleton().storageMap[name]);
   }
 }
 
@@ -233,8 +241,8 @@ void CLI::ClearSettings()
   std::vector<std::string> persistentTypes;
 
   std::map<std::string, util::ParamData>::const_iterator it =
-      GetSingleton().parameters.begin();
-  while (it != GetSingleton().parameters.end())
+      Settings().parameters.begin();
+  while (it != Settings().parameters.end())
   {
     // Is the parameter persistent?
     if (it->second.persistent)
@@ -251,8 +259,8 @@ void CLI::ClearSettings()
 
   // Now check if there are any persistent aliases.
   std::map<char, std::string>::const_iterator it2 =
-      GetSingleton().aliases.begin();
-  while (it2 != GetSingleton().aliases.end())
+      Settings().aliases.begin();
+  while (it2 != Settings().aliases.end())
   {
     // Is this an alias to a persistent parameter?
     if (persistent.count(it2->second) > 0)
@@ -265,11 +273,34 @@ void CLI::ClearSettings()
   {
     // Add to persistent function map.
     persistentFunctions[persistentTypes[i]] =
-        GetSingleton().functionMap[persistentTypes[i]];
+        Settings().functionMap[persistentTypes[i]];
   }
 
   // Save only the persistent parameters.
-  GetSingleton().parameters = persistent;
-  GetSingleton().aliases = persistentAliases;
-  GetSingleton().functionMap = persistentFunctions;
+  Settings().parameters = persistent;
+  Settings().aliases = persistentAliases;
+  Settings().functionMap = persistentFunctions;
+}
+
+// Restore settings into a context of the calling thread.
+void CLI::RestoreContext(const std::string& name)
+{
+  ClearContext();
+  context = new CLI();
+  try
+  {
+    RestoreSettings(name);
+  }
+  catch (std::invalid_argument&)
+  {
+    ClearContext();
+    throw;
+  }
+}
+
+// Go back to the global settings.
+void CLI::ClearContext()
+{
+  delete context;
+  context = NULL;
 }
@@ -17,6 +17,7 @@
 #include <list>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <string>
 
 #include <boost/any.hpp>
@@ -284,6 +285,25 @@ class CLI
    */
   static void ClearSettings();
 
+  /**
+   * Restore the parameters and function mappings of the given name (see
+   * RestoreSettings()) into a context that belongs to the calling thread.
+   * Until ClearContext() is called, all of the parameter methods called from
+   * this thread use the context instead of the global settings, so several
+   * threads can run bindings at once.  A previous context of the thread is
+   * replaced.  A std::invalid_argument exception will be thrown if no settings
+   * with the given name have been stored.
+   *
+   * @param name Name of settings to restore.
+   */
+  static void RestoreContext(const std::string& name);
+
+  /**
+   * Remove the context of the calling thread (see RestoreContext()), so that it
+   * uses the global settings again.
+   */
+  static void ClearContext();
+
  private:
   //! Convenience map from alias values to names.
   std::map<char, std::string> aliases;
@@ -301,6 +321,15 @@ class CLI
   //! Storage map for parameters.
   std::map<std::string, std::tuple<std::map<std::string, util::ParamData>,
       std::map<char, std::string>, FunctionMapType>> storageMap;
+  //! Mutex for the storage map, which several threads may restore from.
+  std::mutex storageMutex;
+
+  //! The context of the calling thread, or NULL if it has none.
+  static thread_local CLI* context;
+
+  //! Get the object holding the settings that the calling thread uses: its
+  //! context, or else the singleton.
+  static CLI& Settings();
 
  private:
   //! The singleton itself.
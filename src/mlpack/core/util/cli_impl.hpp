@@ -37,15 +37,15 @@ T& CLI::GetParam(const std::string& identifier)
 {
   // Only use the alias if the parameter does not exist as given.
   std::string key =
-      (GetSingleton().parameters.count(identifier) == 0 &&
-       identifier.length() == 1 && GetSingleton().aliases.count(identifier[0]))
-      ? GetSingleton().aliases[identifier[0]] : identifier;
+      (Settings().parameters.count(identifier) == 0 &&
+       identifier.length() == 1 && Settings().aliases.count(identifier[0]))
+      ? Settings().aliases[identifier[0]] : identifier;
 
-  if (GetSingleton().parameters.count(key) == 0)
+  if (Settings().parameters.count(key) == 0)
     Log::Fatal << "Parameter --" << key << " does not exist in this program!"
         << std::endl;
 
-  util::ParamData& d = GetSingleton().parameters[key];
+  util::ParamData& d = Settings().parameters[key];
 
   // Make sure the types are correct.
   if (TYPENAME(T) != d.tname)
@@ -54,10 +54,10 @@ T& CLI::GetParam(const std::string& identifier)
         << std::endl;
 
   // Do we have a special mapped function?
-  if (CLI::GetSingleton().functionMap[d.tname].count("GetParam") != 0)
+  if (CLI::Settings().functionMap[d.tname].count("GetParam") != 0)
   {
     T* output = NULL;
-    CLI::GetSingleton().functionMap[d.tname]["GetParam"](d, NULL,
+    CLI::Settings().functionMap[d.tname]["GetParam"](d, NULL,
         (void*) &output);
     return *output;
   }
@@ -78,16 +78,16 @@ template<typename T>
 std::string CLI::GetPrintableParam(const std::string& identifier)
 {
   // Only use the alias if the parameter does not exist as given.
-  std::string key = ((GetSingleton().parameters.count(identifier) == 0) &&
+  std::string key = ((Settings().parameters.count(identifier) == 0) &&
       (identifier.length() == 1) &&
-      (GetSingleton().aliases.count(identifier[0]) > 0)) ?
-      GetSingleton().aliases[identifier[0]] : identifier;
+      (Settings().aliases.count(identifier[0]) > 0)) ?
+      Settings().aliases[identifier[0]] : identifier;
 
-  if (GetSingleton().parameters.count(key) == 0)
+  if (Settings().parameters.count(key) == 0)
     Log::Fatal << "Parameter --" << key << " does not exist in this program!"
         << std::endl;
 
-  util::ParamData& d = GetSingleton().parameters[key];
+  util::ParamData& d = Settings().parameters[key];
 
   // Make sure the types are correct.
   if (TYPENAME(T) != d.tname)
@@ -96,10 +96,10 @@ std::string CLI::GetPrintableParam(const std::string& identifier)
         << std::endl;
 
   // Do we have a special mapped function?
-  if (CLI::GetSingleton().functionMap[d.tname].count("GetPrintableParam") != 0)
+  if (CLI::Settings().functionMap[d.tname].count("GetPrintableParam") != 0)
   {
     std::string output;
-    CLI::GetSingleton().functionMap[d.tname]["GetPrintableParam"](d, NULL,
+    CLI::Settings().functionMap[d.tname]["GetPrintableParam"](d, NULL,
         (void*) &output);
     return output;
   }
@@ -117,15 +117,15 @@ T& CLI::GetRawParam(const std::string& identifier)
 {
   // Only use the alias if the parameter does not exist as given.
   std::string key =
-      (GetSingleton().parameters.count(identifier) == 0 &&
-       identifier.length() == 1 && GetSingleton().aliases.count(identifier[0]))
-      ? GetSingleton().aliases[identifier[0]] : identifier;
+      (Settings().parameters.count(identifier) == 0 &&
+       identifier.length() == 1 && Settings().aliases.count(identifier[0]))
+      ? Settings().aliases[identifier[0]] : identifier;
 
-  if (GetSingleton().parameters.count(key) == 0)
+  if (Settings().parameters.count(key) == 0)
     Log::Fatal << "Parameter --" << key << " does not exist in this program!"
         << std::endl;
 
-  util::ParamData& d = GetSingleton().parameters[key];
+  util::ParamData& d = Settings().parameters[key];
 
   // Make sure the types are correct.
   if (TYPENAME(T) != d.tname)
@@ -134,10 +134,10 @@ T& CLI::GetRawParam(const std::string& identifier)
         << std::endl;
 
   // Do we have a special mapped function?
-  if (CLI::GetSingleton().functionMap[d.tname].count("GetRawParam") != 0)
+  if (CLI::Settings().functionMap[d.tname].count("GetRawParam") != 0)
   {
     T* output = NULL;
-    CLI::GetSingleton().functionMap[d.tname]["GetRawParam"](d, NULL,
+    CLI::Settings().functionMap[d.tname]["GetRawParam"](d, NULL,
         (void*) &output);
     return *output;
   }
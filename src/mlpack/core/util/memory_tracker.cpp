@@ -0,0 +1,171 @@
+/**
+ * @file memory_tracker.cpp
+ *
+ * Implementation of MemoryTracker.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "memory_tracker.hpp"
+
+#include <atomic>
+#include <cstdlib>
+
+#if defined(_WIN32)
+  #include <malloc.h>
+#elif defined(__APPLE__)
+  #include <malloc/malloc.h>
+#else
+  #include <malloc.h>
+#endif
+
+using namespace mlpack;
+
+// The alignment of the allocated memory; Armadillo needs at most 32 bytes.
+static const size_t alignment = 32;
+
+// The counters.  These are constant-initialized, so memory can be allocated
+// during static initialization too.
+static std::atomic<int64_t> bytesInUse(0);
+static std::atomic<int64_t> peakBytes(0);
+static std::atomic<uint64_t> totalBytes(0);
+static std::atomic<uint64_t> allocations(0);
+
+// A scope of BeginScope().  It is claimed first, and only updated by the
+// allocations once it is active, so that the peak is set before.
+struct MemoryScope
+{
+  std::atomic<bool> claimed;
+  std::atomic<bool> active;
+  std::atomic<int64_t> peak;
+};
+
+static MemoryScope scopes[MemoryTracker::Scopes];
+static std::atomic<size_t> activeScopes(0);
+
+// Set the value to the given one, if it is larger.
+static void AtomicMax(std::atomic<int64_t>& value, const int64_t candidate)
+{
+  int64_t current = value.load(std::memory_order_relaxed);
+  while (candidate > current && !value.compare_exchange_weak(current,
+      candidate, std::memory_order_relaxed)) { }
+}
+
+// Get the number of bytes the allocator actually reserved for the memory, which
+// is the same for Allocate() and Free().
+static size_t AllocatedSize(void* memory)
+{
+#if defined(_WIN32)
+  return _aligned_msize(memory, alignment, 0);
+#elif defined(__APPLE__)
+  return malloc_size(memory);
+#else
+  return malloc_usable_size(memory);
+#endif
+}
+
+bool MemoryTracker::Enabled()
+{
+#ifdef MLPACK_TRACK_MEMORY
+  return true;
+#else
+  return false;
+#endif
+}
+
+void* MemoryTracker::Allocate(const size_t bytes)
+{
+  void* memory = NULL;
+#if defined(_WIN32)
+  memory = _aligned_malloc(bytes, alignment);
+#else
+  if (posix_memalign(&memory, alignment, bytes) != 0)
+    memory = NULL;
+#endif
+
+  if (memory == NULL)
+    return NULL;
+
+  const int64_t size = (int64_t) AllocatedSize(memory);
+  totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const int64_t current = bytesInUse.fetch_add(size,
+      std::memory_order_relaxed) + size;
+  AtomicMax(peakBytes, current);
+
+  if (activeScopes.load(std::memory_order_relaxed) > 0)
+  {
+    for (size_t i = 0; i < Scopes; ++i)
+      if (scopes[i].active.load(std::memory_order_acquire))
+        AtomicMax(scopes[i].peak, current);
+  }
+
+  return memory;
+}
+
+void MemoryTracker::Free(void* memory)
+{
+  if (memory == NULL)
+    return;
+
+  bytesInUse.fetch_sub((int64_t) AllocatedSize(memory),
+      std::memory_order_relaxed);
+
+#if defined(_WIN32)
+  _aligned_free(memory);
+#else
+  free(memory);
+#endif
+}
+
+int64_t MemoryTracker::Bytes()
+{
+  return bytesInUse.load(std::memory_order_relaxed);
+}
+
+int64_t MemoryTracker::PeakBytes()
+{
+  return peakBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t MemoryTracker::TotalBytes()
+{
+  return totalBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t MemoryTracker::Allocations()
+{
+  return allocations.load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::BeginScope()
+{
+  for (size_t i = 0; i < Scopes; ++i)
+  {
+    bool expected = false;
+    if (scopes[i].claimed.compare_exchange_strong(expected, true))
+    {
+      scopes[i].peak.store(Bytes(), std::memory_order_relaxed);
+      scopes[i].active.store(true, std::memory_order_release);
+      ++activeScopes;
+      return i;
+    }
+  }
+
+  return Scopes;
+}
+
+int64_t MemoryTracker::EndScope(const size_t scope)
+{
+  if (scope >= Scopes)
+    return Bytes();
+
+  scopes[scope].active.store(false, std::memory_order_release);
+  --activeScopes;
+  const int64_t peak = scopes[scope].peak.load(std::memory_order_relaxed);
+  scopes[scope].claimed.store(false, std::memory_order_release);
+
+  return peak;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file memory_tracker.hpp
+ *
+ * Counting of the memory allocated for Armadillo objects, for the timers of
+ * mlpack.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_MEMORY_TRACKER_HPP
+#define MLPACK_CORE_UTIL_MEMORY_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mlpack {
+
+/**
+ * The memory used during a timer (see Timer::GetMemory()).  If a timer is run
+ * several times, the peak is the largest of all runs, and the other values are
+ * summed.
+ */
+struct MemoryUsage
+{
+  //! The most memory in use at once during the timer, above the memory that
+  //! was in use when the timer was started.
+  size_t peakBytes;
+  //! The number of bytes allocated during the timer.
+  size_t allocatedBytes;
+  //! The number of allocations during the timer.
+  size_t allocations;
+};
+
+/**
+ * MemoryTracker counts the memory allocated by Armadillo for the elements of
+ * matrices, vectors and cubes: the number of allocations, the bytes allocated
+ * in total, the bytes in use and their peak.  It is opt-in, since every
+ * allocation then updates a few atomic counters: if mlpack is configured with
+ * -DMEMORY_TRACKING=ON (which defines MLPACK_TRACK_MEMORY), Armadillo allocates
+ * through Allocate() and Free().  Code that uses mlpack should then define
+ * MLPACK_TRACK_MEMORY too.  Only heap memory is counted (not the elements of
+ * small objects, which Armadillo keeps inside of the object), and only with an
+ * Armadillo version that supports ARMA_ALIEN_MEM_ALLOC_FUNCTION; other versions
+ * ignore it, and nothing is counted.
+ *
+ * The timers (Timer::Start() and Timer::Stop()) record what is allocated while
+ * they run, which can be read with Timer::GetMemory(); it is also written to
+ * the profile of the timers, and printed with --verbose.  Memory is counted for
+ * all threads, so the values of a timer include what other threads allocate
+ * while it runs.
+ */
+class MemoryTracker
+{
+ public:
+  //! The number of scopes (running timers) that are tracked at once.
+  static const size_t Scopes = 64;
+
+  //! Get whether Armadillo allocates through MemoryTracker.
+  static bool Enabled();
+
+  /**
+   * Allocate the given number of bytes (aligned as Armadillo needs), and count
+   * them.
+   *
+   * @param bytes Number of bytes to allocate.
+   * @return Allocated memory, or NULL if it could not be allocated.
+   */
+  static void* Allocate(const size_t bytes);
+
+  /**
+   * Free memory that was allocated with Allocate().
+   *
+   * @param memory Memory to free (may be NULL).
+   */
+  static void Free(void* memory);
+
+  //! Get the number of bytes currently in use.
+  static int64_t Bytes();
+  //! Get the most bytes in use at once so far.
+  static int64_t PeakBytes();
+  //! Get the number of bytes allocated so far.
+  static uint64_t TotalBytes();
+  //! Get the number of allocations so far.
+  static uint64_t Allocations();
+
+  /**
+   * Start recording the peak of the bytes in use, for a timer.
+   *
+   * @return Index of the scope, or Scopes if too many scopes are running (the
+   *     peak is then not recorded).
+   */
+  static size_t BeginScope();
+
+  /**
+   * Stop recording the peak of the bytes in use that was started with
+   * BeginScope().
+   *
+   * @param scope Index of the scope.
+   * @return The most bytes in use at once during the scope (or the bytes in
+   *     use now, if the scope is Scopes).
+   */
+  static int64_t EndScope(const size_t scope);
+};
+
+} // namespace mlpack
+
+#endif
@@ -45,6 +45,7 @@ using Option = mlpack::bindings::cli::CLIOption<T>;
 #include <mlpack/core/util/param.hpp>
 #include <mlpack/bindings/cli/parse_command_line.hpp>
 #include <mlpack/bindings/cli/end_program.hpp>
+#include <mlpack/bindings/cli/run_batch.hpp>
 
 void mlpackMain(); // This is typically defined after this include.
 
@@ -53,8 +54,20 @@ int main(int argc, char** argv)
   // A "total_time" timer is run by default for each mlpack program.
   mlpack::Timer::Start("total_time");
 
+  // Keep the default values of the parameters, in case the program is run once
+  // for each line of a batch file.
+  const std::map<std::string, mlpack::util::ParamData> defaults =
+      mlpack::CLI::Parameters();
+
   // Parse the command-line options; put them into CLI.
   mlpack::bindings::cli::ParseCommandLine(argc, argv);
+
+  if (mlpack::CLI::HasParam("batch_file"))
+  {
+    mlpack::bindings::cli::RunBatch(argc, argv, defaults, mlpackMain);
+    return 0;
+  }
+
   // Enable timing.
   mlpack::Timer::EnableTiming();
 
@@ -133,6 +146,12 @@ using Option = mlpack::bindings::python::PyOption<T>;
 
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
+PARAM_STRING_IN("profile_file", "If specified, a profile of the timers and "
+    "method counters is written to this file at the end of execution, in "
+    "Chrome Trace Event JSON format.", "", "");
+PARAM_INT_IN("threads", "Maximum number of threads to use (0 uses all "
+    "available threads).  Only has an effect if mlpack was compiled with "
+    "OpenMP.", "", 0);
 
 // Nothing else needs to be defined---the binding will use mlpackMain() as-is.
 
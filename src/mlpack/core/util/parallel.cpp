@@ -0,0 +1,104 @@
+/**
+ * @file parallel.cpp
+ *
+ * Implementation of the control of the number of threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+using namespace mlpack;
+
+// The global limit, and the limit of each thread (0 if it has none).
+static std::atomic<size_t> globalLimit(0);
+static thread_local size_t scopedLimit = 0;
+
+// Whether the parallel reductions are deterministic.
+static std::atomic<bool> deterministicReductions(false);
+
+#ifdef HAS_OPENMP
+// The OpenMP default number of threads before any limit was set.
+static int DefaultThreads()
+{
+  static const int defaultThreads = omp_get_max_threads();
+  return defaultThreads;
+}
+#endif
+
+size_t mlpack::ParallelThreads(const size_t requested)
+{
+  #ifdef HAS_OPENMP
+    // Never start nested teams.
+    if (omp_in_parallel())
+      return 1;
+
+    size_t threads = (requested == 0) ? (size_t) omp_get_max_threads() :
+        requested;
+    const size_t limit = ThreadLimit();
+    if (limit > 0)
+      threads = std::min(threads, limit);
+
+    return std::max(threads, (size_t) 1);
+  #else
+    (void) requested;
+    return 1;
+  #endif
+}
+
+void mlpack::SetThreadLimit(const size_t threads)
+{
+  #ifdef HAS_OPENMP
+    omp_set_num_threads((threads == 0) ? DefaultThreads() : (int) threads);
+  #endif
+  globalLimit = threads;
+}
+
+size_t mlpack::ThreadLimit()
+{
+  return (scopedLimit > 0) ? scopedLimit : globalLimit.load();
+}
+
+ScopedThreadLimit::ScopedThreadLimit(const size_t threads) :
+    oldLimit(scopedLimit),
+    oldThreads(0)
+{
+  #ifdef HAS_OPENMP
+    const int defaultThreads = DefaultThreads();
+    oldThreads = omp_get_max_threads();
+  #endif
+
+  scopedLimit = threads;
+
+  #ifdef HAS_OPENMP
+    const size_t limit = ThreadLimit();
+    omp_set_num_threads((limit == 0) ? defaultThreads : (int) limit);
+  #endif
+}
+
+ScopedThreadLimit::~ScopedThreadLimit()
+{
+  scopedLimit = oldLimit;
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+}
+
+void mlpack::SetDeterministicReductions(const bool deterministic)
+{
+  deterministicReductions = deterministic;
+}
+
+bool mlpack::DeterministicReductions()
+{
+  return deterministicReductions;
+}
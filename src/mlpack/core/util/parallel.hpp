@@ -0,0 +1,107 @@
+/**
+ * @file parallel.hpp
+ *
+ * Library-wide control of the number of threads used by the parallel (OpenMP)
+ * regions of mlpack.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_PARALLEL_HPP
+#define MLPACK_CORE_UTIL_PARALLEL_HPP
+
+#include <cstddef>
+
+namespace mlpack {
+
+/**
+ * Get the number of threads that a parallel region of mlpack started now
+ * should use.  This is the given number of threads (or, if it is 0, the number
+ * of threads OpenMP would use), capped by the thread limit of the calling
+ * thread (see ScopedThreadLimit) or else the global thread limit (see
+ * SetThreadLimit()).  Inside of a parallel region this is always 1, so that
+ * the methods called from a parallel loop (of mlpack or of the application) do
+ * not oversubscribe the cores with nested teams.
+ *
+ * Without OpenMP, this is always 1.
+ *
+ * @param requested Number of threads requested by the caller (0 means as many
+ *     as are allowed).
+ */
+size_t ParallelThreads(const size_t requested = 0);
+
+/**
+ * Set the global limit on the number of threads of the parallel regions of
+ * mlpack, for all threads without their own ScopedThreadLimit.  0 removes the
+ * limit.  The OpenMP default number of threads of the calling thread is also
+ * set, so that the parallel regions with no explicit number of threads follow
+ * the limit too.
+ *
+ * @param threads Maximum number of threads (0 for no limit).
+ */
+void SetThreadLimit(const size_t threads);
+
+/**
+ * Get the thread limit of the calling thread: its ScopedThreadLimit if there is
+ * one, or else the global limit.  0 means that there is no limit.
+ */
+size_t ThreadLimit();
+
+/**
+ * Make the parallel reductions of mlpack (the sums of the partial results of
+ * the threads, like the centroids of k-means) deterministic, or not.  If they
+ * are, the results are split into partial results that only depend on the
+ * size of the problem, and these are merged in a fixed order (see
+ * ReductionPartials), so that the results are bit-for-bit the same for any
+ * number of threads; the methods whose threads update a model without
+ * synchronization (HOGWILD!) then run on one thread.  This needs more memory
+ * and is a little slower, so it is disabled by default.
+ *
+ * @param deterministic Whether the reductions should be deterministic.
+ */
+void SetDeterministicReductions(const bool deterministic);
+
+//! Get whether the parallel reductions are deterministic.
+bool DeterministicReductions();
+
+/**
+ * Limit the number of threads of the parallel regions of mlpack started by the
+ * calling thread, until the end of the scope.  This lets an application with
+ * its own thread pool give each mlpack call a share of the cores:
+ *
+ * @code
+ * // In a worker thread of the application.
+ * ScopedThreadLimit limit(2);
+ * kmeans.Cluster(data, clusters, assignments);
+ * @endcode
+ *
+ * Limits can be nested; the previous limit is restored on destruction.
+ */
+class ScopedThreadLimit
+{
+ public:
+  /**
+   * Set the thread limit of the calling thread.
+   *
+   * @param threads Maximum number of threads (0 for the global limit).
+   */
+  explicit ScopedThreadLimit(const size_t threads);
+
+  //! Restore the previous thread limit of the calling thread.
+  ~ScopedThreadLimit();
+
+  ScopedThreadLimit(const ScopedThreadLimit&) = delete;
+  ScopedThreadLimit& operator=(const ScopedThreadLimit&) = delete;
+
+ private:
+  //! The previous limit of the thread.
+  size_t oldLimit;
+  //! The previous OpenMP default number of threads of the thread.
+  int oldThreads;
+};
+
+} // namespace mlpack
+
+#endif
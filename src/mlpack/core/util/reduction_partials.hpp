@@ -0,0 +1,165 @@
+/**
+ * @file reduction_partials.hpp
+ *
+ * The partial results of a parallel reduction, which are merged in a fixed
+ * order if deterministic reductions are enabled.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_REDUCTION_PARTIALS_HPP
+#define MLPACK_CORE_UTIL_REDUCTION_PARTIALS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+
+/**
+ * ReductionPartials holds the partial results of a parallel loop over the
+ * items [0, n), which are then merged into one result (for instance, the sums
+ * of the points assigned to each centroid).  The items are split into chunks,
+ * which are handed out to the threads by the loop:
+ *
+ * @code
+ * ReductionPartials<arma::vec> partials(data.n_cols,
+ *     arma::vec(data.n_rows, arma::fill::zeros));
+ *
+ * #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads())
+ * for (omp_size_t c = 0; c < (omp_size_t) partials.Chunks(); ++c)
+ * {
+ *   arma::vec& partial = partials.Partial(c);
+ *   for (size_t i = partials.Begin(c); i < partials.End(c); ++i)
+ *     partial += data.col(i);
+ * }
+ *
+ * arma::vec sum;
+ * partials.Reduce(sum, [](arma::vec& a, const arma::vec& b) { a += b; });
+ * @endcode
+ *
+ * The chunks only depend on n.  If DeterministicReductions() is enabled, each
+ * chunk has its own partial result, and Reduce() merges them pairwise in a
+ * fixed tree order, so the result is bit-for-bit the same for any number of
+ * threads and any scheduling.  Otherwise each thread has one partial result
+ * for all of its chunks, as with a critical section, which needs less memory
+ * but may round differently from run to run.
+ *
+ * @tparam T Type of the partial results.
+ */
+template<typename T>
+class ReductionPartials
+{
+ public:
+  //! The largest number of chunks.
+  static const size_t MaxChunks = 256;
+
+  /**
+   * Create the partial results for a loop over the given number of items.
+   *
+   * @param n Number of items.
+   * @param identity Partial result of no items (usually zeros).
+   * @param threads Number of threads requested for the loop (0 means as many
+   *     as are allowed; see ParallelThreads()).
+   * @param minChunkSize Smallest number of items of a chunk (at least 1).
+   */
+  ReductionPartials(const size_t n,
+                    const T& identity,
+                    const size_t threads = 0,
+                    const size_t minChunkSize = 64) :
+      n(n),
+      chunks(std::min(MaxChunks, (n + minChunkSize - 1) / minChunkSize)),
+      threads(ParallelThreads(threads)),
+      deterministic(DeterministicReductions()),
+      partials(deterministic ? std::max(chunks, (size_t) 1) : this->threads,
+          identity)
+  { }
+
+  //! Get the number of threads the loop should use.
+  size_t Threads() const { return threads; }
+  //! Get the number of chunks.
+  size_t Chunks() const { return chunks; }
+  //! Get the first item of the given chunk.
+  size_t Begin(const size_t chunk) const { return chunk * n / chunks; }
+  //! Get one past the last item of the given chunk.
+  size_t End(const size_t chunk) const { return (chunk + 1) * n / chunks; }
+
+  /**
+   * Get the partial result to add the items of the given chunk to.  This must
+   * be called from the thread that runs the chunk, inside of the parallel loop
+   * (with at most Threads() threads).
+   *
+   * @param chunk Index of the chunk.
+   */
+  T& Partial(const size_t chunk)
+  {
+    if (deterministic)
+      return partials[chunk];
+
+    #ifdef HAS_OPENMP
+      return partials[omp_get_thread_num()];
+    #else
+      (void) chunk;
+      return partials[0];
+    #endif
+  }
+
+  /**
+   * Merge all of the partial results into the given result.  The merge
+   * function is called as merge(a, b) and should add b to a.
+   *
+   * @param result Result of all of the items.
+   * @param merge Function that merges two partial results.
+   */
+  template<typename MergeFunctionType>
+  void Reduce(T& result, MergeFunctionType merge)
+  {
+    if (!deterministic)
+    {
+      for (size_t i = 1; i < partials.size(); ++i)
+        merge(partials[0], partials[i]);
+    }
+    else
+    {
+      // Merge neighbors, then neighbors of neighbors, and so on.
+      for (size_t stride = 1; stride < partials.size(); stride *= 2)
+      {
+        const size_t pairs = (partials.size() + 2 * stride - 1) /
+            (2 * stride);
+
+        #pragma omp parallel for num_threads(threads)
+        for (omp_size_t p = 0; p < (omp_size_t) pairs; ++p)
+        {
+          const size_t first = p * 2 * stride;
+          if (first + stride < partials.size())
+            merge(partials[first], partials[first + stride]);
+        }
+      }
+    }
+
+    result = std::move(partials[0]);
+  }
+
+ private:
+  //! The number of items.
+  size_t n;
+  //! The number of chunks.
+  size_t chunks;
+  //! The number of threads of the loop.
+  size_t threads;
+  //! Whether each chunk has its own partial result.
+  bool deterministic;
+  //! The partial results (of each chunk, or of each thread).
+  std::vector<T> partials;
+};
+
+template<typename T>
+const size_t ReductionPartials<T>::MaxChunks;
+
+} // namespace mlpack
+
+#endif
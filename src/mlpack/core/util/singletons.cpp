@@ -33,6 +33,7 @@ using namespace mlpack::util;
 #endif
 
 CLI* CLI::singleton = NULL;
+thread_local CLI* CLI::context = NULL;
 
 // Only output debugging output if in debug mode.
 #ifdef DEBUG
@@ -15,8 +15,10 @@
 #include "cli.hpp"
 #include "log.hpp"
 
+#include <algorithm>
 #include <map>
 #include <string>
+#include <fstream>
 
 using namespace mlpack;
 using namespace std;
@@ -64,19 +66,99 @@ void Timer::ResetAll()
   CLI::GetSingleton().timer.Reset();
 }
 
+// Enable tracing.
+void Timer::EnableTracing()
+{
+  CLI::GetSingleton().timer.Tracing() = true;
+}
+
+// Disable tracing.
+void Timer::DisableTracing()
+{
+  CLI::GetSingleton().timer.Tracing() = false;
+}
+
+void Timer::Count(const string& name, const size_t count)
+{
+  CLI::GetSingleton().timer.AddCount(name, count);
+}
+
+size_t Timer::GetCount(const string& name)
+{
+  return CLI::GetSingleton().timer.GetCount(name);
+}
+
+MemoryUsage Timer::GetMemory(const string& name)
+{
+  return CLI::GetSingleton().timer.GetMemory(name);
+}
+
+TimerCounter::TimerCounter(const char* name) :
+    name(name),
+    enabled(CLI::GetSingleton().timer.Enabled()),
+    tracing(CLI::GetSingleton().timer.Tracing())
+{
+  Reset();
+  CLI::GetSingleton().timer.RegisterCounter(this);
+}
+
+TimerCounter::~TimerCounter()
+{
+  CLI::GetSingleton().timer.UnregisterCounter(this);
+}
+
+void TimerCounter::Trace(const steady_clock::time_point start,
+                         const steady_clock::time_point end) const
+{
+  CLI::GetSingleton().timer.RecordSpan(name, start, end,
+      this_thread::get_id());
+}
+
+microseconds TimerCounter::Total() const
+{
+  int64_t total = 0;
+  for (size_t i = 0; i < Slots; ++i)
+    total += slots[i].nanoseconds.load(memory_order_relaxed);
+
+  return duration_cast<microseconds>(nanoseconds(total));
+}
+
+void TimerCounter::Reset()
+{
+  for (size_t i = 0; i < Slots; ++i)
+    slots[i].nanoseconds.store(0, memory_order_relaxed);
+}
+
 // Reset a Timers object.
 void Timers::Reset()
 {
   lock_guard<mutex> lock(timersMutex);
   timers.clear();
   timerStartTime.clear();
+  for (TimerCounter* counter : counters)
+    counter->Reset();
+
+  spans.clear();
+  threadIndices.clear();
+  counts.clear();
+
+  for (auto& threadStarts : memoryStart)
+    for (auto& start : threadStarts.second)
+      MemoryTracker::EndScope(start.second.scope);
+  memoryStart.clear();
+  memory.clear();
+  epoch = steady_clock::now();
 }
 
 map<string, microseconds> Timers::GetAllTimers()
 {
-  // Make a copy of the timer.
+  // Make a copy of the timer, with the time of the scoped timers merged in.
   lock_guard<mutex> lock(timersMutex);
-  return timers;
+  map<string, microseconds> allTimers = timers;
+  for (TimerCounter* counter : counters)
+    allTimers[counter->Name()] += counter->Total();
+
+  return allTimers;
 }
 
 microseconds Timers::GetTimer(const string& timerName)
@@ -85,7 +167,215 @@ microseconds Timers::GetTimer(const string& timerName)
     return microseconds(0);
 
   lock_guard<mutex> lock(timersMutex);
-  return timers[timerName];
+  microseconds total = timers[timerName];
+  for (TimerCounter* counter : counters)
+    if (timerName == counter->Name())
+      total += counter->Total();
+
+  return total;
+}
+
+void Timers::RegisterCounter(TimerCounter* counter)
+{
+  lock_guard<mutex> lock(timersMutex);
+  counters.push_back(counter);
+}
+
+void Timers::UnregisterCounter(TimerCounter* counter)
+{
+  lock_guard<mutex> lock(timersMutex);
+  counters.remove(counter);
+}
+
+void Timers::RecordSpan(const string& timerName,
+                        const steady_clock::time_point start,
+                        const steady_clock::time_point end,
+                        const thread::id& threadId)
+{
+  if (!enabled || !tracing)
+    return;
+
+  lock_guard<mutex> lock(timersMutex);
+  AddSpan(timerName, start, end, threadId);
+}
+
+void Timers::AddSpan(const string& timerName,
+                     const steady_clock::time_point start,
+                     const steady_clock::time_point end,
+                     const thread::id& threadId)
+{
+  // Threads are numbered in the order they first record a span.
+  if (threadIndices.count(threadId) == 0)
+  {
+    const size_t index = threadIndices.size();
+    threadIndices[threadId] = index;
+  }
+
+  TimerSpan span;
+  span.name = timerName;
+  span.thread = threadIndices[threadId];
+  span.start = duration_cast<microseconds>(start - epoch).count();
+  span.end = duration_cast<microseconds>(end - epoch).count();
+  spans.push_back(std::move(span));
+}
+
+void Timers::AddCount(const string& counterName, const size_t count)
+{
+  if (!enabled)
+    return;
+
+  lock_guard<mutex> lock(timersMutex);
+  counts[counterName] += count;
+}
+
+size_t Timers::GetCount(const string& counterName)
+{
+  lock_guard<mutex> lock(timersMutex);
+  map<string, size_t>::const_iterator it = counts.find(counterName);
+  return (it == counts.end()) ? 0 : it->second;
+}
+
+map<string, size_t> Timers::GetAllCounts()
+{
+  lock_guard<mutex> lock(timersMutex);
+  return counts;
+}
+
+MemoryUsage Timers::GetMemory(const string& timerName)
+{
+  lock_guard<mutex> lock(timersMutex);
+  map<string, MemoryUsage>::const_iterator it = memory.find(timerName);
+  if (it == memory.end())
+    return MemoryUsage{ 0, 0, 0 };
+
+  return it->second;
+}
+
+map<string, MemoryUsage> Timers::GetAllMemory()
+{
+  lock_guard<mutex> lock(timersMutex);
+  return memory;
+}
+
+Timers::MemoryStart Timers::StartMemory()
+{
+  MemoryStart start;
+  start.bytes = MemoryTracker::Bytes();
+  start.totalBytes = MemoryTracker::TotalBytes();
+  start.allocations = MemoryTracker::Allocations();
+  start.scope = MemoryTracker::BeginScope();
+  return start;
+}
+
+void Timers::AddMemory(const string& timerName, const MemoryStart& start)
+{
+  const int64_t peak = MemoryTracker::EndScope(start.scope) - start.bytes;
+
+  MemoryUsage& usage = memory[timerName];
+  usage.peakBytes = std::max(usage.peakBytes, (size_t) std::max(peak,
+      (int64_t) 0));
+  usage.allocatedBytes += MemoryTracker::TotalBytes() - start.totalBytes;
+  usage.allocations += MemoryTracker::Allocations() - start.allocations;
+}
+
+// Write the given string as a JSON string.
+static void WriteJSONString(ostream& stream, const string& str)
+{
+  stream << '"';
+  for (const char c : str)
+  {
+    if (c == '"' || c == '\\')
+      stream << '\\' << c;
+    else if ((unsigned char) c < 0x20)
+      stream << "\\u" << hex << setw(4) << setfill('0') << (int) c << dec;
+    else
+      stream << c;
+  }
+  stream << '"';
+}
+
+void Timers::WriteProfile(ostream& stream)
+{
+  // Get the totals first, since these take the lock.
+  const map<string, microseconds> allTimers = GetAllTimers();
+  const map<string, size_t> allCounts = GetAllCounts();
+  const map<string, MemoryUsage> allMemory = GetAllMemory();
+
+  lock_guard<mutex> lock(timersMutex);
+
+  const int64_t now = duration_cast<microseconds>(steady_clock::now() -
+      epoch).count();
+
+  stream << "{" << endl << "  \"traceEvents\": [";
+  bool first = true;
+  for (const TimerSpan& span : spans)
+  {
+    stream << (first ? "" : ",") << endl << "    { \"name\": ";
+    WriteJSONString(stream, span.name);
+    stream << ", \"ph\": \"X\", \"pid\": 0, \"tid\": " << span.thread
+        << ", \"ts\": " << span.start << ", \"dur\": "
+        << (span.end - span.start) << " }";
+    first = false;
+  }
+  for (auto& count : allCounts)
+  {
+    stream << (first ? "" : ",") << endl << "    { \"name\": ";
+    WriteJSONString(stream, count.first);
+    stream << ", \"ph\": \"C\", \"pid\": 0, \"tid\": 0, \"ts\": " << now
+        << ", \"args\": { \"value\": " << count.second << " } }";
+    first = false;
+  }
+  stream << endl << "  ]," << endl;
+  stream << "  \"displayTimeUnit\": \"ms\"," << endl;
+
+  stream << "  \"timers\": {";
+  first = true;
+  for (auto& timer : allTimers)
+  {
+    stream << (first ? "" : ",") << endl << "    ";
+    WriteJSONString(stream, timer.first);
+    stream << ": " << timer.second.count();
+    first = false;
+  }
+  stream << endl << "  }," << endl;
+
+  stream << "  \"counters\": {";
+  first = true;
+  for (auto& count : allCounts)
+  {
+    stream << (first ? "" : ",") << endl << "    ";
+    WriteJSONString(stream, count.first);
+    stream << ": " << count.second;
+    first = false;
+  }
+  stream << endl << "  }," << endl;
+
+  stream << "  \"memory\": {";
+  first = true;
+  for (auto& usage : allMemory)
+  {
+    stream << (first ? "" : ",") << endl << "    ";
+    WriteJSONString(stream, usage.first);
+    stream << ": { \"peak_bytes\": " << usage.second.peakBytes
+        << ", \"allocated_bytes\": " << usage.second.allocatedBytes
+        << ", \"allocations\": " << usage.second.allocations << " }";
+    first = false;
+  }
+  stream << endl << "  }" << endl << "}" << endl;
+}
+
+void Timers::WriteProfile(const string& filename)
+{
+  ofstream stream(filename);
+  if (!stream.is_open())
+  {
+    ostringstream error;
+    error << "Timers::WriteProfile(): cannot open file '" << filename
+        << "' for writing";
+    throw runtime_error(error.str());
+  }
+
+  WriteProfile(stream);
 }
 
 bool Timers::GetState(const string& timerName,
@@ -164,12 +454,26 @@ void Timers::StopAllTimers()
   lock_guard<mutex> lock(timersMutex);
 
   high_resolution_clock::time_point currTime = high_resolution_clock::now();
+  const steady_clock::time_point end = steady_clock::now();
   for (auto it : timerStartTime)
+  {
     for (auto it2 : it.second)
-      timers[it2.first] += duration_cast<microseconds>(currTime - it2.second);
+    {
+      const microseconds delta = duration_cast<microseconds>(currTime -
+          it2.second);
+      timers[it2.first] += delta;
+      if (tracing)
+        AddSpan(it2.first, end - delta, end, it.first);
+    }
+  }
+
+  for (auto& threadStarts : memoryStart)
+    for (auto& start : threadStarts.second)
+      AddMemory(start.first, start.second);
 
   // If all timers are stopped, we can clear the maps.
   timerStartTime.clear();
+  memoryStart.clear();
 }
 
 void Timers::StartTimer(const string& timerName,
@@ -201,6 +505,7 @@ void Timers::StartTimer(const string& timerName,
   }
 
   timerStartTime[threadId][timerName] = currTime;
+  memoryStart[threadId][timerName] = StartMemory();
 }
 
 void Timers::StopTimer(const string& timerName,
@@ -226,11 +531,24 @@ void Timers::StopTimer(const string& timerName,
   high_resolution_clock::time_point currTime = high_resolution_clock::now();
 
   // Calculate the delta time.
-  timers[timerName] += duration_cast<microseconds>(currTime -
+  const microseconds delta = duration_cast<microseconds>(currTime -
       timerStartTime[threadId][timerName]);
+  timers[timerName] += delta;
+
+  // The span is recorded with the clock of the scoped timers.
+  if (tracing)
+  {
+    const steady_clock::time_point end = steady_clock::now();
+    AddSpan(timerName, end - delta, end, threadId);
+  }
+
+  AddMemory(timerName, memoryStart[threadId][timerName]);
 
   // Remove the entries.
   timerStartTime[threadId].erase(timerName);
   if (timerStartTime[threadId].empty())
     timerStartTime.erase(threadId);
+  memoryStart[threadId].erase(timerName);
+  if (memoryStart[threadId].empty())
+    memoryStart.erase(threadId);
 }
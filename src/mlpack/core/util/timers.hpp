@@ -16,11 +16,16 @@
 
 #include <map>
 #include <string>
+#include <vector>
+#include <ostream>
 #include <chrono> // chrono library for cross platform timer calculation.
 #include <thread> // std::thread is used for thread safety.
 #include <mutex>
 #include <list>
 #include <atomic>
+#include <cstdint>
+
+#include "memory_tracker.hpp"
 
 #if defined(_WIN32)
   // uint64_t isn't defined on every windows.
@@ -92,13 +97,209 @@ class Timer
    * existing timers.
    */
   static void ResetAll();
+
+  /**
+   * Enable recording a timeline of every span of time measured by the timers
+   * (with the thread it ran on), which can then be written with
+   * Timers::WriteProfile().  This takes a lock for every span, so scoped
+   * timers in tight loops become slower while tracing is enabled.
+   */
+  static void EnableTracing();
+
+  /**
+   * Disable recording the timeline of the timers.  The spans recorded so far
+   * are kept until ResetAll() is called.
+   */
+  static void DisableTracing();
+
+  /**
+   * Add the given value to the method counter with the given name (for
+   * instance, the number of base cases of a search).  Nothing is counted if
+   * timing is disabled.
+   *
+   * @param name Name of the counter.
+   * @param count Value to add to the counter.
+   */
+  static void Count(const std::string& name, const size_t count);
+
+  /**
+   * Get the value of the given method counter.
+   *
+   * @param name Name of the counter.
+   */
+  static size_t GetCount(const std::string& name);
+
+  /**
+   * Get the memory allocated while the given timer ran (see MemoryTracker).
+   * This is only counted with Start() and Stop(), not with scoped timers, and
+   * it is all zeros unless mlpack was compiled with memory tracking.
+   *
+   * @param name Name of the timer.
+   */
+  static MemoryUsage GetMemory(const std::string& name);
 };
 
+/**
+ * A named counter of time for ScopedTimer.  Each thread adds the time it
+ * measures to its own slot (one cache line each), so the threads never wait on
+ * each other; the slots are only summed when the time is read with Timer::Get()
+ * or Timers::GetAllTimers(), under the same name as the Start()/Stop() timers.
+ *
+ * Counters are not meant to be created directly: MLPACK_SCOPED_TIMER() creates
+ * one static counter for each place it is used, so the name is registered only
+ * once and never looked up again.
+ */
+class TimerCounter
+{
+ public:
+  //! The number of per-thread slots of each counter.
+  static const size_t Slots = 64;
+
+  /**
+   * Create the counter and register it with the timers of CLI.  The name is
+   * not copied, so it should be a string literal.
+   *
+   * @param name Name of the timer the time is added to.
+   */
+  TimerCounter(const char* name);
+
+  //! Unregister the counter.
+  ~TimerCounter();
+
+  TimerCounter(const TimerCounter&) = delete;
+  TimerCounter& operator=(const TimerCounter&) = delete;
+
+  //! Get the name of the timer.
+  const char* Name() const { return name; }
+
+  //! Get whether or not timing is enabled.
+  bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+  //! Get whether or not the spans of time are recorded.
+  bool Tracing() const { return tracing.load(std::memory_order_relaxed); }
+
+  //! Add the given time to the slot of the calling thread.
+  void Add(const std::chrono::nanoseconds elapsed)
+  {
+    slots[ThreadSlot()].nanoseconds.fetch_add(elapsed.count(),
+        std::memory_order_relaxed);
+  }
+
+  //! Record the span of time of the calling thread in the timeline.
+  void Trace(const std::chrono::steady_clock::time_point start,
+             const std::chrono::steady_clock::time_point end) const;
+
+  //! Get the time added by all threads so far.
+  std::chrono::microseconds Total() const;
+
+  //! Reset the time of all threads to zero.
+  void Reset();
+
+ private:
+  //! The time of one or more threads, padded to its own cache line.
+  struct alignas(64) Slot
+  {
+    std::atomic<int64_t> nanoseconds;
+  };
+
+  //! Get the slot of the calling thread, which is chosen on its first call.
+  static size_t ThreadSlot()
+  {
+    static std::atomic<size_t> nextSlot(0);
+    static thread_local const size_t slot = (nextSlot++ % Slots);
+    return slot;
+  }
+
+  //! The name of the timer.
+  const char* name;
+  //! Whether or not timing is enabled (owned by the Timers object).
+  const std::atomic<bool>& enabled;
+  //! Whether or not the spans are recorded (owned by the Timers object).
+  const std::atomic<bool>& tracing;
+  //! The time of each thread.
+  Slot slots[Slots];
+};
+
+/**
+ * A timer that adds the time between its construction and its destruction to a
+ * TimerCounter.  Unlike Timer::Start() and Timer::Stop(), it takes no lock and
+ * does not look up the name, so it costs about two reads of the clock and can
+ * be used inside parallel loops.  If timing is disabled when it is created,
+ * nothing is measured.  It is used through MLPACK_SCOPED_TIMER():
+ *
+ * @code
+ * void Function()
+ * {
+ *   MLPACK_SCOPED_TIMER("function");
+ *   // ...
+ * }
+ *
+ * // Later, the time spent in Function() by all threads:
+ * std::chrono::microseconds time = Timer::Get("function");
+ * @endcode
+ */
+class ScopedTimer
+{
+ public:
+  /**
+   * Start measuring the time for the given counter.
+   *
+   * @param counter Counter to add the time to.
+   */
+  explicit ScopedTimer(TimerCounter& counter) :
+      counter(counter),
+      running(counter.Enabled())
+  {
+    if (running)
+      start = std::chrono::steady_clock::now();
+  }
+
+  //! Add the time since construction to the counter.
+  ~ScopedTimer()
+  {
+    if (running)
+    {
+      const std::chrono::steady_clock::time_point end =
+          std::chrono::steady_clock::now();
+      counter.Add(end - start);
+      if (counter.Tracing())
+        counter.Trace(start, end);
+    }
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  //! The counter to add the time to.
+  TimerCounter& counter;
+  //! Whether or not the time is measured.
+  bool running;
+  //! The time of construction.
+  std::chrono::steady_clock::time_point start;
+};
+
+#define MLPACK_TIMER_JOIN_IMPL(a, b) a##b
+#define MLPACK_TIMER_JOIN(a, b) MLPACK_TIMER_JOIN_IMPL(a, b)
+
+/**
+ * Measure the time until the end of the current scope, and add it to the timer
+ * with the given name (a string literal).  See ScopedTimer.
+ */
+#define MLPACK_SCOPED_TIMER(NAME) \
+    static ::mlpack::TimerCounter MLPACK_TIMER_JOIN(mlpackTimerCounter, \
+        __LINE__)(NAME); \
+    ::mlpack::ScopedTimer MLPACK_TIMER_JOIN(mlpackScopedTimer, __LINE__)( \
+        MLPACK_TIMER_JOIN(mlpackTimerCounter, __LINE__))
+
 class Timers
 {
  public:
   //! Default to disabled.
-  Timers() : enabled(false) { }
+  Timers() :
+      epoch(std::chrono::steady_clock::now()),
+      enabled(false),
+      tracing(false)
+  { }
 
   /**
    * Returns a copy of all the timers used via this interface.
@@ -167,6 +368,95 @@ class Timers
   //! Get whether or not timing is enabled.
   bool Enabled() const { return enabled; }
 
+  /**
+   * Register a counter of a ScopedTimer, whose time is then included in the
+   * timer of the same name.
+   *
+   * @param counter Counter to register.
+   */
+  void RegisterCounter(TimerCounter* counter);
+
+  /**
+   * Unregister a counter of a ScopedTimer.
+   *
+   * @param counter Counter to unregister.
+   */
+  void UnregisterCounter(TimerCounter* counter);
+
+  //! Modify whether or not the spans of the timers are recorded.
+  std::atomic<bool>& Tracing() { return tracing; }
+  //! Get whether or not the spans of the timers are recorded.
+  bool Tracing() const { return tracing; }
+
+  /**
+   * Record a span of time of the given timer in the timeline, if tracing is
+   * enabled.
+   *
+   * @param timerName The name of the timer in question.
+   * @param start Beginning of the span.
+   * @param end End of the span.
+   * @param threadId Id of the thread the span ran on.
+   */
+  void RecordSpan(const std::string& timerName,
+                  const std::chrono::steady_clock::time_point start,
+                  const std::chrono::steady_clock::time_point end,
+                  const std::thread::id& threadId = std::thread::id());
+
+  /**
+   * Add the given value to the method counter with the given name.
+   *
+   * @param counterName The name of the counter in question.
+   * @param count Value to add to the counter.
+   */
+  void AddCount(const std::string& counterName, const size_t count);
+
+  /**
+   * Returns the value of the given method counter.
+   *
+   * @param counterName The name of the counter in question.
+   */
+  size_t GetCount(const std::string& counterName);
+
+  /**
+   * Returns a copy of all the method counters.
+   */
+  std::map<std::string, size_t> GetAllCounts();
+
+  /**
+   * Returns the memory allocated while the given timer ran.
+   *
+   * @param timerName The name of the timer in question.
+   */
+  MemoryUsage GetMemory(const std::string& timerName);
+
+  /**
+   * Returns a copy of the memory allocated while each timer ran.
+   */
+  std::map<std::string, MemoryUsage> GetAllMemory();
+
+  /**
+   * Write the recorded timeline, the timers and the method counters to the
+   * given stream, in Chrome Trace Event JSON format (which can be opened with
+   * chrome://tracing or Perfetto).  The spans are "X" events and the counters
+   * are "C" events at the end of the timeline; the totals of the timers (in
+   * microseconds) and the counters are also written as the "timers" and
+   * "counters" objects, for scripts that only need a summary, and the memory
+   * allocated while each timer ran as the "memory" object.
+   *
+   * @param stream Stream to write the profile to.
+   */
+  void WriteProfile(std::ostream& stream);
+
+  /**
+   * Write the profile (see above) to the given file.
+   *
+   * @note A std::runtime_error exception will be thrown if the file cannot be
+   * opened.
+   *
+   * @param filename Name of the file to write the profile to.
+   */
+  void WriteProfile(const std::string& filename);
+
  private:
   //! A map of all the timers that are being tracked.
   std::map<std::string, std::chrono::microseconds> timers;
@@ -175,9 +465,58 @@ class Timers
   //! A map for the starting values of the timers.
   std::map<std::thread::id, std::map<std::string,
       std::chrono::high_resolution_clock::time_point>> timerStartTime;
+  //! The counters of the scoped timers.
+  std::list<TimerCounter*> counters;
+
+  //! A span of time of a timer, in microseconds since the epoch.
+  struct TimerSpan
+  {
+    std::string name;
+    size_t thread;
+    int64_t start;
+    int64_t end;
+  };
+
+  //! The recorded timeline.
+  std::vector<TimerSpan> spans;
+  //! The index of each thread in the timeline.
+  std::map<std::thread::id, size_t> threadIndices;
+  //! The beginning of the timeline.
+  std::chrono::steady_clock::time_point epoch;
+  //! The method counters.
+  std::map<std::string, size_t> counts;
+
+  //! The memory counters when a timer was started.
+  struct MemoryStart
+  {
+    size_t scope;
+    int64_t bytes;
+    uint64_t totalBytes;
+    uint64_t allocations;
+  };
+
+  //! The memory counters of each running timer.
+  std::map<std::thread::id, std::map<std::string, MemoryStart>> memoryStart;
+  //! The memory allocated while each timer ran.
+  std::map<std::string, MemoryUsage> memory;
+
+  //! Get the memory counters for a timer that is started now.
+  static MemoryStart StartMemory();
+
+  //! Add the memory of a run of a timer, that is stopped now; timersMutex must
+  //! be held.
+  void AddMemory(const std::string& timerName, const MemoryStart& start);
+
+  //! Record a span; timersMutex must be held.
+  void AddSpan(const std::string& timerName,
+               const std::chrono::steady_clock::time_point start,
+               const std::chrono::steady_clock::time_point end,
+               const std::thread::id& threadId);
 
   //! Whether or not timing is enabled.
   std::atomic<bool> enabled;
+  //! Whether or not the spans are recorded.
+  std::atomic<bool> tracing;
 };
 
 } // namespace mlpack
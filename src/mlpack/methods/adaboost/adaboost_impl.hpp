@@ -86,9 +86,6 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
   // To be used for prediction by the weak learner.
   arma::Row<size_t> predictedLabels(labels.n_cols);
 
-  // Use tempData to modify input data for incorporating weights.
-  MatType tempData(data);
-
   // This matrix is a helper matrix used to calculate the final hypothesis.
   arma::mat sumFinalH = arma::zeros<arma::mat>(numClasses,
       predictedLabels.n_cols);
@@ -118,9 +115,10 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
     // Build the weight vectors.
     weights = arma::sum(D);
 
-    // Use the existing weak learner to train a new one with new weights.
-    WeakLearnerType w(other, tempData, labels, numClasses, weights);
-    w.Classify(tempData, predictedLabels);
+    // Use the existing weak learner to train a new one with new weights.  The
+    // weights are passed alongside the data, so the data is never copied.
+    WeakLearnerType w(other, data, labels, numClasses, weights);
+    w.Classify(data, predictedLabels);
 
     // Now from predictedLabels, build ht, the weak hypothesis
     // buildClassificationMatrix(ht, predictedLabels);
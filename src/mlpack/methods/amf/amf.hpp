@@ -22,9 +22,12 @@
 
 #include <mlpack/methods/amf/update_rules/nmf_mult_dist.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
+#include <mlpack/methods/amf/update_rules/implicit_als.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_als.hpp>
 #include <mlpack/methods/amf/update_rules/svd_batch_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_incomplete_incremental_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_complete_incremental_learning.hpp>
+#include <mlpack/methods/amf/update_rules/svd_parallel_incremental_learning.hpp>
 
 #include <mlpack/methods/amf/init_rules/random_init.hpp>
 #include <mlpack/methods/amf/init_rules/random_acol_init.hpp>
@@ -142,6 +145,28 @@ typedef amf::AMF<amf::SimpleResidueTermination,
                  amf::RandomAcolInitialization<>,
                  amf::NMFALSUpdate> NMFALSFactorizer;
 
+/**
+ * SparseALSFactorizer factorizes the observed (nonzero) entries of the given
+ * matrix V into two matrices W and H by alternating least squares with
+ * weighted regularization.
+ *
+ * @see SparseALSUpdate
+ */
+typedef amf::AMF<amf::SimpleResidueTermination,
+                 amf::RandomAcolInitialization<>,
+                 amf::SparseALSUpdate> SparseALSFactorizer;
+
+/**
+ * ImplicitALSFactorizer factorizes the preferences of the given matrix V of
+ * implicit feedback into two matrices W and H by weighted alternating least
+ * squares.
+ *
+ * @see ImplicitALSUpdate
+ */
+typedef amf::AMF<amf::SimpleResidueTermination,
+                 amf::RandomAcolInitialization<>,
+                 amf::ImplicitALSUpdate> ImplicitALSFactorizer;
+
 //! Add simple typedefs
 #ifdef MLPACK_USE_CXX11
 
@@ -247,6 +272,18 @@ typedef amf::AMF<amf::SimpleResidueTermination,
                  amf::SVDCompleteIncrementalLearning<arma::sp_mat> >
         SparseSVDCompleteIncrementalFactorizer;
 
+/**
+ * SparseSVDParallelIncrementalFactorizer factorizes given sparse matrix V into
+ * two matrices W and H by incremental gradient descent over the nonzero
+ * entries of V, with lock-free parallel steps.
+ *
+ * @see SVDParallelIncrementalLearning
+ */
+typedef amf::AMF<amf::SimpleResidueTermination,
+                 amf::RandomAcolInitialization<>,
+                 amf::SVDParallelIncrementalLearning>
+        SparseSVDParallelIncrementalFactorizer;
+
 /**
  * SVDCompleteIncrementalFactorizer factorizes given matrix V into two matrices
  * W and H by complete incremental gradient descent. SVD complete incremental
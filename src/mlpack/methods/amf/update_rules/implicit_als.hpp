@@ -0,0 +1,234 @@
+/**
+ * @file implicit_als.hpp
+ *
+ * Alternating least squares for implicit feedback (such as clicks or dwell
+ * times), as used for collaborative filtering.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_IMPLICIT_ALS_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_IMPLICIT_ALS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class implements weighted alternating least squares for implicit
+ * feedback, as described in the following paper:
+ *
+ * @code
+ * @inproceedings{hu2008collaborative,
+ *   title={Collaborative filtering for implicit feedback datasets},
+ *   author={Hu, Y. and Koren, Y. and Volinsky, C.},
+ *   booktitle={Eighth IEEE International Conference on Data Mining},
+ *   pages={263--272},
+ *   year={2008}
+ * }
+ * @endcode
+ *
+ * Each entry v_ij of the input matrix V is an amount of feedback (for instance
+ * a number of clicks), and zero entries mean no feedback.  The factorization
+ * fits the preference p_ij (1 if v_ij > 0 and 0 otherwise) of every entry,
+ * including the zero ones, with the confidence c_ij = 1 + alpha v_ij.  So the
+ * column h_j of H is
+ *
+ * \f[
+ * h_j = (W^T W + W^T (C_j - I) W + \lambda I)^{-1} W^T C_j p_j,
+ * \f]
+ *
+ * where C_j is the diagonal matrix of the confidences of column j.  W^T W is
+ * computed once per update, and C_j - I and p_j are only nonzero on the
+ * nonzero entries of column j, so solving for h_j costs O(n_j r^2 + r^3) for
+ * the n_j nonzero entries of the column, instead of touching every row.  The
+ * rows of W are found in the same way, and the systems are solved in parallel
+ * with OpenMP.
+ *
+ * Since the factors estimate preferences, the ratings that CF estimates with
+ * them are scores between 0 and 1 that are only meaningful for ranking.
+ */
+class ImplicitALSUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given parameters.
+   *
+   * @param alpha Rate at which the confidence grows with the feedback.
+   * @param lambda Regularization parameter.
+   * @param numThreads Number of threads to use; 0 uses the OpenMP default.
+   */
+  ImplicitALSUpdate(const double alpha = 40.0,
+                    const double lambda = 0.1,
+                    const size_t numThreads = 0) :
+      alpha(alpha),
+      lambda(lambda),
+      numThreads(numThreads)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Keep the nonzero entries of the given matrix, and of its transpose, for
+   * the updates.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    feedback = arma::sp_mat(dataset);
+    feedbackT = feedback.t();
+  }
+
+  /**
+   * The update rule for the basis matrix W.  Each row of W is the weighted
+   * least squares solution for the preferences of the same row of V.
+   *
+   * @param V Input matrix to be factorized (the entries kept by Initialize()
+   *     are used).
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H)
+  {
+    // The rows of W are found as the columns of W^T.
+    arma::mat wt(H.n_rows, feedbackT.n_cols);
+    Solve(feedbackT, H, wt);
+    W = wt.t();
+  }
+
+  /**
+   * The update rule for the encoding matrix H.  Each column of H is the
+   * weighted least squares solution for the preferences of the same column of
+   * V.
+   *
+   * @param V Input matrix to be factorized (the entries kept by Initialize()
+   *     are used).
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& /* V */,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    H.set_size(W.n_cols, feedback.n_cols);
+    Solve(feedback, W.t(), H);
+  }
+
+  //! Get the rate at which the confidence grows with the feedback.
+  double Alpha() const { return alpha; }
+  //! Modify the rate at which the confidence grows with the feedback.
+  double& Alpha() { return alpha; }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Get the number of threads.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads (0 uses the OpenMP default).
+  size_t& NumThreads() { return numThreads; }
+
+  //! Serialize the parameters of the update rule.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    using data::CreateNVP;
+    ar & CreateNVP(alpha, "alpha");
+    ar & CreateNVP(lambda, "lambda");
+    ar & CreateNVP(numThreads, "numThreads");
+  }
+
+ private:
+  /**
+   * Solve the weighted least squares problem of every column of the given
+   * matrix: column j of factors is set to the solution over all the factors
+   * (columns of other), with the confidences and preferences given by the
+   * nonzero entries of column j of data.
+   *
+   * @param data The feedback, one column per system.
+   * @param other The fixed factors, one column per row of data.
+   * @param factors The factors to solve for, already of the right size.
+   */
+  void Solve(const arma::sp_mat& data,
+             const arma::mat& other,
+             arma::mat& factors) const
+  {
+    const size_t r = other.n_rows;
+
+    // The part of every system that does not depend on the feedback.
+    arma::mat gram = other * other.t();
+    gram.diag() += lambda;
+
+    const size_t threads = ParallelThreads(numThreads);
+
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 64)
+    for (omp_size_t j = 0; j < (omp_size_t) data.n_cols; ++j)
+    {
+      const size_t begin = data.col_ptrs[j];
+      const size_t end = data.col_ptrs[j + 1];
+      if (begin == end)
+      {
+        // All preferences are zero, so the solution is zero.
+        factors.col(j).zeros();
+        continue;
+      }
+
+      // Only the entries with feedback add to W^T W and W^T C_j p_j.
+      arma::mat a(gram);
+      arma::vec b(r, arma::fill::zeros);
+      for (size_t k = begin; k < end; ++k)
+      {
+        const arma::vec f(const_cast<double*>(other.colptr(
+            data.row_indices[k])), r, false, true);
+        const double confidence = 1.0 + alpha * data.values[k];
+        a += (confidence - 1.0) * f * f.t();
+        b += confidence * f;
+      }
+
+      // The system is positive definite if lambda > 0; otherwise the
+      // pseudoinverse gives the least squares solution.
+      arma::vec solution;
+      if (!arma::solve(solution, a, b))
+      {
+        arma::mat inverse;
+        if (arma::pinv(inverse, a))
+          solution = inverse * b;
+        else
+          solution.zeros(r);
+      }
+      factors.col(j) = solution;
+    }
+  }
+
+  //! Rate at which the confidence grows with the feedback.
+  double alpha;
+  //! Regularization parameter.
+  double lambda;
+  //! Number of threads to use (0 for the OpenMP default).
+  size_t numThreads;
+
+  //! The feedback of the input matrix.
+  arma::sp_mat feedback;
+  //! The feedback of the transposed input matrix.
+  arma::sp_mat feedbackT;
+}; // class ImplicitALSUpdate
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "sparse_products.hpp"
+
 namespace mlpack {
 namespace amf {
 
@@ -75,7 +77,9 @@ class NMFALSUpdate
   {
     // The call to inv() sometimes fails; so we are using the psuedoinverse.
     // W = (inv(H * H.t()) * H * V.t()).t();
-    W = V * H.t() * pinv(H * H.t());
+    // V * H^T is computed in parallel if V is sparse.
+    ProductWithTranspose(V, H, W);
+    W *= pinv(H * H.t());
 
     // Set all negative numbers to machine epsilon.
     for (size_t i = 0; i < W.n_elem; i++)
@@ -106,7 +110,10 @@ class NMFALSUpdate
                              const arma::mat& W,
                              arma::mat& H)
   {
-    H = pinv(W.t() * W) * W.t() * V;
+    // W^T * V is computed in parallel if V is sparse.
+    arma::mat product;
+    TransposeProduct(W, V, product);
+    H = pinv(W.t() * W) * product;
 
     // Set all negative numbers to 0.
     for (size_t i = 0; i < H.n_elem; i++)
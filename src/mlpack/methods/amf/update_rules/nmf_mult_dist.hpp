@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "sparse_products.hpp"
+
 namespace mlpack {
 namespace amf {
 
@@ -71,7 +73,10 @@ class NMFMultiplicativeDistanceUpdate
                              arma::mat& W,
                              const arma::mat& H)
   {
-    W = (W % (V * H.t())) / (W * H * H.t());
+    // V * H^T is computed in parallel if V is sparse.
+    arma::mat product;
+    ProductWithTranspose(V, H, product);
+    W = (W % product) / (W * (H * H.t()));
   }
 
   /**
@@ -93,7 +98,10 @@ class NMFMultiplicativeDistanceUpdate
                              const arma::mat& W,
                              arma::mat& H)
   {
-    H = (H % (W.t() * V)) / (W.t() * W * H);
+    // W^T * V is computed in parallel if V is sparse.
+    arma::mat product;
+    TransposeProduct(W, V, product);
+    H = (H % product) / ((W.t() * W) * H);
   }
 
   //! Serialize the object (in this case, there is nothing to serialize).
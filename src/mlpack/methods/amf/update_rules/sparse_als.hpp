@@ -0,0 +1,227 @@
+/**
+ * @file sparse_als.hpp
+ *
+ * Alternating least squares over the observed entries of the input matrix, as
+ * used for collaborative filtering.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_ALS_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_ALS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class implements alternating least squares with weighted
+ * regularization (ALS-WR), as described in the following paper:
+ *
+ * @code
+ * @inproceedings{zhou2008large,
+ *   title={Large-scale parallel collaborative filtering for the Netflix
+ *       prize},
+ *   author={Zhou, Y. and Wilkinson, D. and Schreiber, R. and Pan, R.},
+ *   booktitle={Algorithmic Aspects in Information and Management},
+ *   pages={337--348},
+ *   year={2008}
+ * }
+ * @endcode
+ *
+ * Unlike NMFALSUpdate, which fits all the entries of the input matrix V, only
+ * the nonzero entries of V are treated as observed.  Each column h_j of H is
+ * the solution of a small r x r system over the observed entries of column j
+ * of V,
+ *
+ * \f[
+ * h_j = (W_{I_j}^T W_{I_j} + \lambda n_j I)^{-1} W_{I_j}^T v_{I_j},
+ * \f]
+ *
+ * where \f$ I_j \f$ are the rows of the observed entries and \f$ n_j \f$ their
+ * number, and the rows of W are found in the same way.  The cost of an update
+ * is O(nnz r^2 + (m + n) r^3), and the systems are solved in parallel with
+ * OpenMP.  The factors are not constrained to be nonnegative.
+ *
+ * The nonzero entries of V and of its transpose are kept by Initialize(), so
+ * the input matrix (dense or sparse) is only read once.
+ */
+class SparseALSUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given regularization.
+   *
+   * @param lambda Regularization parameter.
+   * @param weighted If true, the regularization of each row or column is
+   *     scaled by its number of observed entries.
+   * @param numThreads Number of threads to use; 0 uses the OpenMP default.
+   */
+  SparseALSUpdate(const double lambda = 0.05,
+                  const bool weighted = true,
+                  const size_t numThreads = 0) :
+      lambda(lambda),
+      weighted(weighted),
+      numThreads(numThreads)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Keep the observed entries of the given matrix, and of its transpose, for
+   * the updates.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    observed = arma::sp_mat(dataset);
+    observedT = observed.t();
+  }
+
+  /**
+   * The update rule for the basis matrix W.  Each row of W is the regularized
+   * least squares solution over the observed entries of the same row of V.
+   *
+   * @param V Input matrix to be factorized (the entries kept by Initialize()
+   *     are used).
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H)
+  {
+    // The rows of W are found as the columns of W^T.
+    arma::mat wt(H.n_rows, observedT.n_cols);
+    Solve(observedT, H, wt);
+    W = wt.t();
+  }
+
+  /**
+   * The update rule for the encoding matrix H.  Each column of H is the
+   * regularized least squares solution over the observed entries of the same
+   * column of V.
+   *
+   * @param V Input matrix to be factorized (the entries kept by Initialize()
+   *     are used).
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& /* V */,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    H.set_size(W.n_cols, observed.n_cols);
+    Solve(observed, W.t(), H);
+  }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Get whether the regularization is weighted.
+  bool Weighted() const { return weighted; }
+  //! Modify whether the regularization is weighted.
+  bool& Weighted() { return weighted; }
+
+  //! Get the number of threads.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads (0 uses the OpenMP default).
+  size_t& NumThreads() { return numThreads; }
+
+  //! Serialize the parameters of the update rule.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    using data::CreateNVP;
+    ar & CreateNVP(lambda, "lambda");
+    ar & CreateNVP(weighted, "weighted");
+    ar & CreateNVP(numThreads, "numThreads");
+  }
+
+ private:
+  /**
+   * Solve the least squares problem of every column of the given matrix:
+   * column j of factors is set to the solution over the factors (columns of
+   * other) of the observed entries of column j of data.
+   *
+   * @param data The observed entries, one column per system.
+   * @param other The fixed factors, one column per row of data.
+   * @param factors The factors to solve for, already of the right size.
+   */
+  void Solve(const arma::sp_mat& data,
+             const arma::mat& other,
+             arma::mat& factors) const
+  {
+    const size_t r = other.n_rows;
+
+    const size_t threads = ParallelThreads(numThreads);
+
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 64)
+    for (omp_size_t j = 0; j < (omp_size_t) data.n_cols; ++j)
+    {
+      const size_t begin = data.col_ptrs[j];
+      const size_t end = data.col_ptrs[j + 1];
+      if (begin == end)
+      {
+        // Nothing is known about this column.
+        factors.col(j).zeros();
+        continue;
+      }
+
+      arma::mat a(r, r, arma::fill::zeros);
+      arma::vec b(r, arma::fill::zeros);
+      for (size_t k = begin; k < end; ++k)
+      {
+        const arma::vec f(const_cast<double*>(other.colptr(
+            data.row_indices[k])), r, false, true);
+        a += f * f.t();
+        b += data.values[k] * f;
+      }
+      a.diag() += weighted ? lambda * (end - begin) : lambda;
+
+      // The system is positive definite if lambda > 0; otherwise the
+      // pseudoinverse gives the least squares solution.
+      arma::vec solution;
+      if (!arma::solve(solution, a, b))
+      {
+        arma::mat inverse;
+        if (arma::pinv(inverse, a))
+          solution = inverse * b;
+        else
+          solution.zeros(r);
+      }
+      factors.col(j) = solution;
+    }
+  }
+
+  //! Regularization parameter.
+  double lambda;
+  //! Whether the regularization is scaled by the number of observed entries.
+  bool weighted;
+  //! Number of threads to use (0 for the OpenMP default).
+  size_t numThreads;
+
+  //! The observed entries of the input matrix.
+  arma::sp_mat observed;
+  //! The observed entries of the transposed input matrix.
+  arma::sp_mat observedT;
+}; // class SparseALSUpdate
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file sparse_products.hpp
+ *
+ * Products of the input matrix of AMF with the factor matrices, which are
+ * computed in parallel when the input matrix is sparse.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_PRODUCTS_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_PRODUCTS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * Compute V * H^T.  For a dense V this is a single BLAS call, which is
+ * multi-threaded if the BLAS is.
+ *
+ * @param V Input matrix.
+ * @param H Encoding matrix.
+ * @param product Set to V * H^T.
+ */
+template<typename MatType>
+inline void ProductWithTranspose(const MatType& V,
+                                 const arma::mat& H,
+                                 arma::mat& product)
+{
+  product = V * H.t();
+}
+
+/**
+ * Compute V * H^T for a sparse V.  Armadillo computes products with sparse
+ * matrices in a single thread, so each row of the product is computed by
+ * itself here, in parallel with OpenMP; V is transposed once (in O(nnz) time)
+ * so that the rows can be accessed directly.
+ *
+ * @param V Input matrix.
+ * @param H Encoding matrix.
+ * @param product Set to V * H^T.
+ */
+inline void ProductWithTranspose(const arma::sp_mat& V,
+                                 const arma::mat& H,
+                                 arma::mat& product)
+{
+  const arma::sp_mat vt = V.t();
+  const size_t r = H.n_rows;
+
+  // The rows of the product are built as columns, so that they are
+  // contiguous.
+  arma::mat productT(r, V.n_rows);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) vt.n_cols; ++i)
+  {
+    double* out = productT.colptr(i);
+    std::fill(out, out + r, 0.0);
+    for (size_t k = vt.col_ptrs[i]; k < vt.col_ptrs[i + 1]; ++k)
+    {
+      const double value = vt.values[k];
+      const double* h = H.colptr(vt.row_indices[k]);
+      for (size_t d = 0; d < r; ++d)
+        out[d] += value * h[d];
+    }
+  }
+
+  product = productT.t();
+}
+
+/**
+ * Compute W^T * V.  For a dense V this is a single BLAS call, which is
+ * multi-threaded if the BLAS is.
+ *
+ * @param W Basis matrix.
+ * @param V Input matrix.
+ * @param product Set to W^T * V.
+ */
+template<typename MatType>
+inline void TransposeProduct(const arma::mat& W,
+                             const MatType& V,
+                             arma::mat& product)
+{
+  product = W.t() * V;
+}
+
+/**
+ * Compute W^T * V for a sparse V, one column of the product at a time, in
+ * parallel with OpenMP.
+ *
+ * @param W Basis matrix.
+ * @param V Input matrix.
+ * @param product Set to W^T * V.
+ */
+inline void TransposeProduct(const arma::mat& W,
+                             const arma::sp_mat& V,
+                             arma::mat& product)
+{
+  // Each column of the product combines rows of W, so W is transposed first.
+  const arma::mat wt = W.t();
+  const size_t r = wt.n_rows;
+
+  product.set_size(r, V.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t j = 0; j < (omp_size_t) V.n_cols; ++j)
+  {
+    double* out = product.colptr(j);
+    std::fill(out, out + r, 0.0);
+    for (size_t k = V.col_ptrs[j]; k < V.col_ptrs[j + 1]; ++k)
+    {
+      const double value = V.values[k];
+      const double* w = wt.colptr(V.row_indices[k]);
+      for (size_t d = 0; d < r; ++d)
+        out[d] += value * w[d];
+    }
+  }
+}
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -100,7 +100,9 @@ class SVDBatchLearning
     // Compute the step.
     arma::mat deltaW;
     deltaW.zeros(n, r);
-    for (size_t i = 0; i < n; i++)
+    // The rows of the step are independent.
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) n; i++)
     {
       for (size_t j = 0; j < m; j++)
       {
@@ -145,7 +147,9 @@ class SVDBatchLearning
     // Compute the step.
     arma::mat deltaH;
     deltaH.zeros(r, m);
-    for (size_t j = 0; j < m; j++)
+    // The columns of the step are independent.
+    #pragma omp parallel for
+    for (omp_size_t j = 0; j < (omp_size_t) m; j++)
     {
       for (size_t i = 0; i < n; i++)
       {
@@ -209,17 +213,27 @@ inline void SVDBatchLearning::WUpdate<arma::sp_mat>(const arma::sp_mat& V,
 
   mW = momentum * mW;
 
-  arma::mat deltaW;
-  deltaW.zeros(n, r);
+  // The step is built transposed, one column for each row of V, so that the
+  // rows of V can be handled in parallel; V is transposed for that in O(nnz)
+  // time.
+  const arma::sp_mat vt = V.t();
+  const arma::mat wt = W.t();
+  arma::mat deltaWT(r, n);
 
-  for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
+  #pragma omp parallel for
+  for (omp_size_t row = 0; row < (omp_size_t) n; ++row)
   {
-    const size_t row = it.row();
-    const size_t col = it.col();
-    deltaW.row(it.row()) += (*it - arma::dot(W.row(row), H.col(col))) *
-                                             arma::trans(H.col(col));
+    deltaWT.col(row).zeros();
+    for (size_t k = vt.col_ptrs[row]; k < vt.col_ptrs[row + 1]; ++k)
+    {
+      const size_t col = vt.row_indices[k];
+      deltaWT.col(row) += (vt.values[k] - arma::dot(wt.col(row), H.col(col))) *
+          H.col(col);
+    }
   }
 
+  arma::mat deltaW = deltaWT.t();
+
   if (kw != 0)
     deltaW -= kw * W;
 
@@ -237,15 +251,20 @@ inline void SVDBatchLearning::HUpdate<arma::sp_mat>(const arma::sp_mat& V,
 
   mH = momentum * mH;
 
+  const arma::mat wt = W.t();
   arma::mat deltaH;
   deltaH.zeros(r, m);
 
-  for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
+  // The columns of V are handled in parallel.
+  #pragma omp parallel for
+  for (omp_size_t col = 0; col < (omp_size_t) m; ++col)
   {
-    const size_t row = it.row();
-    const size_t col = it.col();
-    deltaH.col(col) += (*it - arma::dot(W.row(row), H.col(col))) *
-        W.row(row).t();
+    for (size_t k = V.col_ptrs[col]; k < V.col_ptrs[col + 1]; ++k)
+    {
+      const size_t row = V.row_indices[k];
+      deltaH.col(col) += (V.values[k] - arma::dot(wt.col(row), H.col(col))) *
+          wt.col(row);
+    }
   }
 
   if (kh != 0)
@@ -0,0 +1,231 @@
+/**
+ * @file svd_parallel_incremental_learning.hpp
+ *
+ * SVD incremental learning over the nonzero entries of the input matrix, with
+ * lock-free (Hogwild) parallel steps.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_SVD_PARALLEL_INCREMENTAL_LEARNING_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_SVD_PARALLEL_INCREMENTAL_LEARNING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class computes SVD with incremental learning over the nonzero entries
+ * of the input matrix (as in 'Algorithm 3' of 'A Guide to Singular Value
+ * Decomposition for Collaborative Filtering' by Chih-Chao Ma, like
+ * SVDCompleteIncrementalLearning), with the steps of the entries taken in
+ * parallel without locks, as described in the following paper:
+ *
+ * @code
+ * @inproceedings{recht2011hogwild,
+ *   title={Hogwild!: A lock-free approach to parallelizing stochastic
+ *       gradient descent},
+ *   author={Recht, B. and Re, C. and Wright, S. and Niu, F.},
+ *   booktitle={Advances in Neural Information Processing Systems},
+ *   pages={693--701},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * The entries are visited in a random order, which is split between the
+ * threads.  Two threads only write to the same feature vector when they
+ * handle two ratings of the same user or item at the same time, which is rare
+ * for sparse ratings; the (unsynchronized) writes of both are then kept.
+ *
+ * Unlike SVDCompleteIncrementalLearning, where each call of WUpdate() and
+ * HUpdate() handles a single entry, a call of WUpdate() takes a step for every
+ * nonzero entry of V with H fixed, and a call of HUpdate() does the same for
+ * H.  So one iteration of AMF is a pass over the data, and termination
+ * policies like ValidationRMSETermination or SimpleToleranceTermination can be
+ * used directly, without CompleteIncrementalTermination.
+ *
+ * @see SVDCompleteIncrementalLearning
+ */
+class SVDParallelIncrementalLearning
+{
+ public:
+  /**
+   * Initialize the parameters of SVDParallelIncrementalLearning.
+   *
+   * @param u Step value used in incremental learning.
+   * @param kw Regularization constant for W matrix.
+   * @param kh Regularization constant for H matrix.
+   * @param numThreads Number of threads to use; 0 uses the OpenMP default.
+   */
+  SVDParallelIncrementalLearning(const double u = 0.005,
+                                 const double kw = 0,
+                                 const double kh = 0,
+                                 const size_t numThreads = 0) :
+      u(u), kw(kw), kh(kh), numThreads(numThreads)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Collect the nonzero entries of the input matrix, which are visited by the
+   * updates.  This function must be called before a new factorization.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of factorization.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    const arma::sp_mat entries(dataset);
+
+    rows.set_size(entries.n_nonzero);
+    cols.set_size(entries.n_nonzero);
+    values.set_size(entries.n_nonzero);
+    size_t k = 0;
+    for (size_t j = 0; j < entries.n_cols; ++j)
+    {
+      for (size_t i = entries.col_ptrs[j]; i < entries.col_ptrs[j + 1]; ++i)
+      {
+        rows[k] = entries.row_indices[i];
+        cols[k] = j;
+        values[k] = entries.values[i];
+        ++k;
+      }
+    }
+
+    order.set_size(values.n_elem);
+    for (size_t i = 0; i < order.n_elem; ++i)
+      order[i] = i;
+  }
+
+  /**
+   * The update rule for the basis matrix W: take a step on the item feature
+   * vector of every nonzero entry of V, in parallel.
+   *
+   * @param V Input matrix to be factorized (the entries collected by
+   *     Initialize() are used).
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H)
+  {
+    // The item feature vectors are made contiguous while they are updated.
+    arma::mat wt = W.t();
+    Pass(rows, cols, H, wt, kw);
+    W = wt.t();
+  }
+
+  /**
+   * The update rule for the encoding matrix H: take a step on the user feature
+   * vector of every nonzero entry of V, in parallel.
+   *
+   * @param V Input matrix to be factorized (the entries collected by
+   *     Initialize() are used).
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& /* V */,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    const arma::mat wt = W.t();
+    Pass(cols, rows, wt, H, kh);
+  }
+
+  //! Get the step size.
+  double U() const { return u; }
+  //! Modify the step size.
+  double& U() { return u; }
+
+  //! Get the number of threads.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads (0 uses the OpenMP default).
+  size_t& NumThreads() { return numThreads; }
+
+  //! Serialize the parameters of the update rule.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    using data::CreateNVP;
+    ar & CreateNVP(u, "u");
+    ar & CreateNVP(kw, "kw");
+    ar & CreateNVP(kh, "kh");
+    ar & CreateNVP(numThreads, "numThreads");
+  }
+
+ private:
+  /**
+   * Take a step on one feature vector for every entry, in a new random order.
+   * For entry k, column updated[k] of target is moved towards the rating with
+   * column fixed[k] of other held fixed.
+   *
+   * @param updated Index of the updated feature vector of each entry.
+   * @param fixed Index of the fixed feature vector of each entry.
+   * @param other Fixed feature vectors, one per column.
+   * @param target Updated feature vectors, one per column.
+   * @param k Regularization constant of the updated feature vectors.
+   */
+  void Pass(const arma::Col<size_t>& updated,
+            const arma::Col<size_t>& fixed,
+            const arma::mat& other,
+            arma::mat& target,
+            const double k)
+  {
+    const size_t r = target.n_rows;
+    std::shuffle(order.begin(), order.end(), math::randGen);
+
+    const size_t threads = ParallelThreads(numThreads);
+
+    // Each thread takes a contiguous part of the order, so that it does not
+    // share cache lines of the order with the others.
+    #pragma omp parallel for num_threads(threads) schedule(static)
+    for (omp_size_t e = 0; e < (omp_size_t) order.n_elem; ++e)
+    {
+      const size_t entry = order[e];
+      double* t = target.colptr(updated[entry]);
+      const double* o = other.colptr(fixed[entry]);
+
+      double prediction = 0.0;
+      for (size_t d = 0; d < r; ++d)
+        prediction += t[d] * o[d];
+      const double error = values[entry] - prediction;
+
+      for (size_t d = 0; d < r; ++d)
+        t[d] += u * (error * o[d] - k * t[d]);
+    }
+  }
+
+  //! Step size of incremental learning.
+  double u;
+  //! Regularization parameter for matrix W.
+  double kw;
+  //! Regularization parameter for matrix H.
+  double kh;
+  //! Number of threads to use (0 for the OpenMP default).
+  size_t numThreads;
+
+  //! The row of each nonzero entry of the input matrix.
+  arma::Col<size_t> rows;
+  //! The column of each nonzero entry of the input matrix.
+  arma::Col<size_t> cols;
+  //! The value of each nonzero entry of the input matrix.
+  arma::vec values;
+  //! The order in which the entries are visited.
+  arma::Col<size_t> order;
+}; // class SVDParallelIncrementalLearning
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
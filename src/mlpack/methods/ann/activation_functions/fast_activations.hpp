@@ -0,0 +1,330 @@
+/**
+ * @file fast_activations.hpp
+ *
+ * Polynomial approximations of the transcendental activation functions (the
+ * logistic function, tanh and softplus) with bounded error, for the forward
+ * passes of networks that do not need the exact values.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_FAST_ACTIVATIONS_HPP
+#define MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_FAST_ACTIVATIONS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+//! The accuracy of the activation functions of the forward pass.
+enum ActivationAccuracy
+{
+  //! Use std::exp(), std::tanh() and std::log() for every element.
+  EXACT_ACTIVATIONS,
+  //! Use polynomial approximations with a relative error of a few units in
+  //! the last place (below 2e-15), which are as good as the exact functions
+  //! for training.
+  TRAINING_ACTIVATIONS,
+  //! Use shorter polynomial approximations with a relative error below 1e-6,
+  //! which are enough for prediction.
+  INFERENCE_ACTIVATIONS
+};
+
+/**
+ * Get the accuracy of the activation functions set for the current thread by
+ * an ActivationAccuracyScope (EXACT_ACTIVATIONS if there is none).
+ */
+inline ActivationAccuracy& ScopedActivationAccuracy()
+{
+  static thread_local ActivationAccuracy accuracy = EXACT_ACTIVATIONS;
+  return accuracy;
+}
+
+/**
+ * While an ActivationAccuracyScope exists, the activation functions of the
+ * thread that created it (LogisticFunction, TanhFunction, SoftplusFunction and
+ * the LogSoftMax layer) compute matrices with the given accuracy.  The FFN
+ * class uses this for the forward pass (see FFN::ActivationMode()):
+ *
+ * @code
+ * ActivationAccuracyScope scope(INFERENCE_ACTIVATIONS);
+ * network.Forward(...);
+ * @endcode
+ *
+ * Scopes can be nested; the previous accuracy is used again when a scope ends.
+ * The derivatives are always exact.
+ */
+class ActivationAccuracyScope
+{
+ public:
+  /**
+   * Use the given accuracy on this thread until the scope ends.
+   *
+   * @param accuracy Accuracy of the activation functions.
+   */
+  ActivationAccuracyScope(const ActivationAccuracy accuracy) :
+      previous(ScopedActivationAccuracy())
+  {
+    ScopedActivationAccuracy() = accuracy;
+  }
+
+  //! Use the previous accuracy again.
+  ~ActivationAccuracyScope() { ScopedActivationAccuracy() = previous; }
+
+ private:
+  //! A scope cannot be copied.
+  ActivationAccuracyScope(const ActivationAccuracyScope&);
+  //! A scope cannot be copied.
+  ActivationAccuracyScope& operator=(const ActivationAccuracyScope&);
+
+  //! The accuracy that was used before the scope.
+  ActivationAccuracy previous;
+};
+
+/**
+ * Approximation of exp(x).  The argument is split as x = n ln(2) + r with
+ * |r| <= ln(2) / 2, so that exp(x) = 2^n exp(r), and exp(r) is a Taylor
+ * polynomial (of degree 12 for training, and 6 for inference).  The argument
+ * is clamped to [-708, 709], so the result is never zero or infinite.
+ *
+ * None of the kernels have branches, so that the compiler can vectorize the
+ * loops over a matrix with the widest instructions of the target (for
+ * instance AVX2 or AVX-512 with -march=native).
+ *
+ * @tparam Inference Whether to use the shorter polynomial.
+ */
+template<bool Inference>
+class FastExp
+{
+ public:
+  static double Fn(double x)
+  {
+    x = std::min(std::max(x, -708.0), 709.0);
+
+    // Adding 1.5 * 2^52 rounds x / ln(2) to the nearest integer, which ends up
+    // in the low bits of the mantissa.
+    const double shifted = x * 1.4426950408889634 + 6755399441055744.0;
+    const double n = shifted - 6755399441055744.0;
+    int64_t shiftedBits;
+    std::memcpy(&shiftedBits, &shifted, sizeof(double));
+
+    // ln(2) is split into two parts, so that n * ln(2) is exact enough.
+    const double r = (x - n * 0.693145751953125) -
+        n * 1.42860682030941723212e-6;
+
+    double p;
+    if (Inference)
+    {
+      p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 +
+          r * (1.0 / 120 + r * (1.0 / 720))))));
+    }
+    else
+    {
+      p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 +
+          r * (1.0 / 120 + r * (1.0 / 720 + r * (1.0 / 5040 +
+          r * (1.0 / 40320 + r * (1.0 / 362880 + r * (1.0 / 3628800 +
+          r * (1.0 / 39916800 + r * (1.0 / 479001600))))))))))));
+    }
+
+    // 2^n, built from the exponent bits.
+    const int64_t bits = (shiftedBits - 0x4338000000000000LL + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(double));
+    return p * scale;
+  }
+};
+
+/**
+ * Approximation of log(1 + t) for t in [0, 1].  1 + t is reduced to m in
+ * [1 / sqrt(2), sqrt(2)] (halving it if needed), and log(m) = 2 atanh(s) with
+ * s = (m - 1) / (m + 1) is a series in s (up to s^19 for training, and s^7 for
+ * inference).  The rounding error of 1 + t is added back.
+ *
+ * @tparam Inference Whether to use the shorter series.
+ */
+template<bool Inference>
+class FastLog1p
+{
+ public:
+  static double Fn(const double t)
+  {
+    const double u = 1.0 + t;
+    const double c = t - (u - 1.0);
+    const double high = (double) (u > 1.4142135623730951);
+    const double m = u - 0.5 * high * u;
+    const double s = (m - 1.0) / (m + 1.0);
+    const double s2 = s * s;
+
+    double q;
+    if (Inference)
+    {
+      q = 1.0 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7)));
+    }
+    else
+    {
+      q = 1.0 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7 +
+          s2 * (1.0 / 9 + s2 * (1.0 / 11 + s2 * (1.0 / 13 + s2 * (1.0 / 15 +
+          s2 * (1.0 / 17 + s2 * (1.0 / 19)))))))));
+    }
+
+    return high * 0.6931471805599453 + 2.0 * s * q + c / u;
+  }
+};
+
+/**
+ * Approximation of the logistic function 1 / (1 + exp(-x)).
+ *
+ * @tparam Inference Whether to use the faster, less accurate approximation.
+ */
+template<bool Inference>
+class FastLogistic
+{
+ public:
+  static double Fn(const double x)
+  {
+    return 1.0 / (1.0 + FastExp<Inference>::Fn(-x));
+  }
+};
+
+/**
+ * Approximation of tanh(x) = (1 - exp(-2|x|)) / (1 + exp(-2|x|)) (with the
+ * sign of x).  That loses accuracy for small |x|, where the Taylor series of
+ * tanh is used instead.
+ *
+ * @tparam Inference Whether to use the faster, less accurate approximation.
+ */
+template<bool Inference>
+class FastTanh
+{
+ public:
+  static double Fn(const double x)
+  {
+    const double a = std::fabs(x);
+    const double t = FastExp<Inference>::Fn(-2.0 * a);
+    const double large = (1.0 - t) / (1.0 + t);
+
+    // The series is only used below 0.0625; clamping keeps it finite.
+    const double b = std::min(a, 0.0625);
+    const double b2 = b * b;
+    const double small = b * (1.0 + b2 * (-1.0 / 3 + b2 * (2.0 / 15 +
+        b2 * (-17.0 / 315 + b2 * (62.0 / 2835 + b2 * (-1382.0 / 155925))))));
+
+    const double w = (double) (a < 0.0625);
+    return std::copysign(w * small + (1.0 - w) * large, x);
+  }
+};
+
+/**
+ * Approximation of the softplus function log(1 + exp(x)) =
+ * max(x, 0) + log(1 + exp(-|x|)), which never overflows.
+ *
+ * @tparam Inference Whether to use the faster, less accurate approximation.
+ */
+template<bool Inference>
+class FastSoftplus
+{
+ public:
+  static double Fn(const double x)
+  {
+    return std::max(x, 0.0) +
+        FastLog1p<Inference>::Fn(FastExp<Inference>::Fn(-std::fabs(x)));
+  }
+};
+
+namespace details {
+
+/**
+ * Apply the given kernel to n elements, adding the bias first if it is given.
+ * The output may be the input.
+ */
+template<typename KernelType, typename eT>
+inline void FastActivationLoop(const eT* input,
+                               const eT* bias,
+                               eT* output,
+                               const size_t n)
+{
+  if (bias != NULL)
+  {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+      output[i] = (eT) KernelType::Fn((double) (input[i] + bias[i]));
+  }
+  else
+  {
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+      output[i] = (eT) KernelType::Fn((double) input[i]);
+  }
+}
+
+} // namespace details
+
+/**
+ * Compute output = f(input + bias) with one of the approximations, where the
+ * bias (if it is given) is added to each column, in one pass over the matrix.
+ * Large matrices are split between the OpenMP threads.  The output may be the
+ * input.
+ *
+ * @code
+ * // output = tanh(output + biases), to inference accuracy.
+ * FastActivation<FastTanh>(output, output, INFERENCE_ACTIVATIONS, &biases);
+ * @endcode
+ *
+ * @tparam FastFunctionType Approximation to use (FastExp, FastLogistic,
+ *     FastTanh or FastSoftplus).
+ * @param input Input matrix.
+ * @param output Matrix to store the activations in.
+ * @param accuracy INFERENCE_ACTIVATIONS for the less accurate approximation;
+ *     otherwise the accurate one is used.
+ * @param bias Vector to add to each column of the input first (with as many
+ *     elements as the input has rows), or NULL.
+ */
+template<template<bool> class FastFunctionType, typename eT>
+void FastActivation(const arma::Mat<eT>& input,
+                    arma::Mat<eT>& output,
+                    const ActivationAccuracy accuracy,
+                    const arma::Col<eT>* bias = NULL)
+{
+  if (bias != NULL && bias->n_elem != input.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "FastActivation(): the bias has " << bias->n_elem << " elements, "
+        << "but the input has " << input.n_rows << " rows";
+    throw std::invalid_argument(oss.str());
+  }
+
+  output.set_size(input.n_rows, input.n_cols);
+
+  // Without a bias the matrix is split into chunks of elements, so that long
+  // loops are vectorized even for row vectors.
+  const size_t chunkSize = (bias != NULL) ? input.n_rows : 4096;
+  const size_t chunks = (chunkSize == 0) ? 0 :
+      (input.n_elem + chunkSize - 1) / chunkSize;
+  const size_t threads = (input.n_elem >= 65536) ? ParallelThreads() : 1;
+  const eT* biasPtr = (bias != NULL) ? bias->memptr() : NULL;
+  const bool inference = (accuracy == INFERENCE_ACTIVATIONS);
+
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks; ++c)
+  {
+    const size_t begin = c * chunkSize;
+    const size_t n = std::min(chunkSize, input.n_elem - begin);
+    if (inference)
+    {
+      details::FastActivationLoop<FastFunctionType<true>>(
+          input.memptr() + begin, biasPtr, output.memptr() + begin, n);
+    }
+    else
+    {
+      details::FastActivationLoop<FastFunctionType<false>>(
+          input.memptr() + begin, biasPtr, output.memptr() + begin, n);
+    }
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "fast_activations.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -61,6 +63,27 @@ class LogisticFunction
     y = (1.0 / (1 + arma::exp(-x)));
   }
 
+  /**
+   * Computes the logistic function of a matrix, exactly or with the
+   * approximation selected for the current thread (see
+   * ActivationAccuracyScope).
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   */
+  template<typename eT>
+  static void Fn(const arma::Mat<eT>& x, arma::Mat<eT>& y)
+  {
+    const ActivationAccuracy accuracy = ScopedActivationAccuracy();
+    if (accuracy != EXACT_ACTIVATIONS)
+    {
+      FastActivation<FastLogistic>(x, y, accuracy);
+      return;
+    }
+
+    y = (1.0 / (1 + arma::exp(-x)));
+  }
+
   /**
    * Computes the first derivative of the logistic function.
    *
@@ -28,6 +28,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "fast_activations.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -71,6 +73,30 @@ class SoftplusFunction
       y(i) = Fn(x(i));
   }
 
+  /**
+   * Computes the softplus function of a matrix, exactly or with the
+   * approximation selected for the current thread (see
+   * ActivationAccuracyScope).
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   */
+  template<typename eT>
+  static void Fn(const arma::Mat<eT>& x, arma::Mat<eT>& y)
+  {
+    const ActivationAccuracy accuracy = ScopedActivationAccuracy();
+    if (accuracy != EXACT_ACTIVATIONS)
+    {
+      FastActivation<FastSoftplus>(x, y, accuracy);
+      return;
+    }
+
+    y = x;
+
+    for (size_t i = 0; i < x.n_elem; i++)
+      y(i) = Fn(x(i));
+  }
+
   /**
    * Computes the first derivative of the softplus function.
    *
@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "fast_activations.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -52,6 +54,27 @@ class TanhFunction
     y = arma::tanh(x);
   }
 
+  /**
+   * Computes the tanh function of a matrix, exactly or with the
+   * approximation selected for the current thread (see
+   * ActivationAccuracyScope).
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   */
+  template<typename eT>
+  static void Fn(const arma::Mat<eT>& x, arma::Mat<eT>& y)
+  {
+    const ActivationAccuracy accuracy = ScopedActivationAccuracy();
+    if (accuracy != EXACT_ACTIVATIONS)
+    {
+      FastActivation<FastTanh>(x, y, accuracy);
+      return;
+    }
+
+    y = arma::tanh(x);
+  }
+
   /**
    * Computes the first derivative of the tanh function.
    *
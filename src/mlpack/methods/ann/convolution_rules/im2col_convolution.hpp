@@ -0,0 +1,377 @@
+/**
+ * @file im2col_convolution.hpp
+ *
+ * Implementation of the convolution through im2col: the patches of the input
+ * that the filter is applied to are copied into the rows of a matrix, so that
+ * the convolution becomes a matrix product.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+#include "layer_convolution.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by lowering it to a matrix product.
+ * With unit strides the results are the same as the results of
+ * NaiveConvolution.  The strides dW and dH are applied to the rows and the
+ * columns of the input, so the valid convolution of an (r x c) input with a
+ * (kr x kc) filter has ((r - kr) / dW + 1) rows and ((c - kc) / dH + 1)
+ * columns, just like the output of a Convolution layer.
+ *
+ * The real benefit comes from using this rule in a Convolution layer: the
+ * specialization of LayerConvolution below lowers all input maps and all
+ * kernels of the layer to one matrix product in each of the forward pass, the
+ * backward pass and the gradient computation.
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    const arma::Cube<eT> inputMap(const_cast<eT*>(input.memptr()),
+        input.n_rows, input.n_cols, 1, false, true);
+
+    arma::Mat<eT> patches;
+    Im2Col(inputMap, filter.n_rows, filter.n_cols, dW, dH, patches);
+
+    output.set_size((input.n_rows - filter.n_rows) / dW + 1,
+        (input.n_cols - filter.n_cols) / dH + 1);
+    arma::Mat<eT> result(output.memptr(), output.n_elem, 1, false, true);
+    result = patches * arma::vectorise(filter);
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    // Pad the input with (filter size - 1) zeros on each side.
+    arma::Mat<eT> inputPadded = arma::zeros<arma::Mat<eT> >(
+        input.n_rows + 2 * (filter.n_rows - 1),
+        input.n_cols + 2 * (filter.n_cols - 1));
+    inputPadded.submat(filter.n_rows - 1, filter.n_cols - 1,
+        filter.n_rows - 1 + input.n_rows - 1,
+        filter.n_cols - 1 + input.n_cols - 1) = input;
+
+    Im2ColConvolution<ValidConvolution>::Convolution(inputPadded, filter,
+        output, dW, dH);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(0),
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        filter.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < filter.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(i),
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0), filter,
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i), filter,
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /**
+   * Copy the patches of the input maps that a (kW x kH) filter is applied to
+   * into the rows of a matrix.  Row (x + y * outputWidth) holds the patch of
+   * output position (x, y); its elements are ordered like the elements of a
+   * (kW x kH x input.n_slices) cube, so the product of the patches with a
+   * vectorised filter cube is the (vectorised) valid convolution.
+   *
+   * @param input The input maps.
+   * @param kW Width of the filter.
+   * @param kH Height of the filter.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param patches Matrix to store the patches in.
+   */
+  template<typename eT>
+  static void Im2Col(const arma::Cube<eT>& input,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     arma::Mat<eT>& patches)
+  {
+    const size_t outputWidth = (input.n_rows - kW) / dW + 1;
+    const size_t outputHeight = (input.n_cols - kH) / dH + 1;
+    patches.set_size(outputWidth * outputHeight, kW * kH * input.n_slices);
+
+    // Each column of the patches is filled in order, with one strided pass
+    // over the input map.
+    eT* patchPtr = patches.memptr();
+    for (size_t s = 0; s < input.n_slices; ++s)
+    {
+      for (size_t kj = 0; kj < kH; ++kj)
+      {
+        for (size_t ki = 0; ki < kW; ++ki)
+        {
+          for (size_t y = 0; y < outputHeight; ++y)
+          {
+            const eT* inputPtr = input.slice_colptr(s, y * dH + kj) + ki;
+            for (size_t x = 0; x < outputWidth; ++x, ++patchPtr)
+              *patchPtr = inputPtr[x * dW];
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * The adjoint of Im2Col(): add each element of the patches to the element of
+   * the maps it was taken from.
+   *
+   * @param patches The patches, as returned by Im2Col().
+   * @param kW Width of the filter.
+   * @param kH Height of the filter.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param output The maps to add the patches to; must be allocated already.
+   */
+  template<typename eT>
+  static void Col2Im(const arma::Mat<eT>& patches,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     arma::Cube<eT>& output)
+  {
+    const size_t outputWidth = (output.n_rows - kW) / dW + 1;
+    const size_t outputHeight = (output.n_cols - kH) / dH + 1;
+
+    const eT* patchPtr = patches.memptr();
+    for (size_t s = 0; s < output.n_slices; ++s)
+    {
+      for (size_t kj = 0; kj < kH; ++kj)
+      {
+        for (size_t ki = 0; ki < kW; ++ki)
+        {
+          for (size_t y = 0; y < outputHeight; ++y)
+          {
+            eT* outputPtr = output.slice_colptr(s, y * dH + kj) + ki;
+            for (size_t x = 0; x < outputWidth; ++x, ++patchPtr)
+              outputPtr[x * dW] += *patchPtr;
+          }
+        }
+      }
+    }
+  }
+};  // class Im2ColConvolution
+
+/**
+ * The convolutions of a layer that uses Im2ColConvolution are lowered to one
+ * matrix product each.  The kernels of output map outMap are the consecutive
+ * slices [outMap * inSize, (outMap + 1) * inSize) of the weight cube, so the
+ * weight cube is used as a matrix with one column of kernels per output map,
+ * without copying it.
+ */
+template<typename BorderMode>
+class LayerConvolution<Im2ColConvolution<BorderMode> >
+{
+ public:
+  template<typename eT>
+  static void Forward(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& weight,
+                      arma::Cube<eT>& output,
+                      const size_t dW,
+                      const size_t dH)
+  {
+    arma::Mat<eT> patches;
+    Im2ColConvolution<BorderMode>::Im2Col(input, weight.n_rows, weight.n_cols,
+        dW, dH, patches);
+
+    const arma::Mat<eT> kernels(const_cast<eT*>(weight.memptr()),
+        weight.n_rows * weight.n_cols * input.n_slices, output.n_slices, false,
+        true);
+    arma::Mat<eT> result(output.memptr(), patches.n_rows, output.n_slices,
+        false, true);
+    result += patches * kernels;
+  }
+
+  template<typename eT>
+  static void Backward(const arma::Cube<eT>& error,
+                       const arma::Cube<eT>& weight,
+                       arma::Cube<eT>& g,
+                       const size_t dW,
+                       const size_t dH,
+                       const size_t padW,
+                       const size_t padH)
+  {
+    const arma::Mat<eT> errors(const_cast<eT*>(error.memptr()),
+        error.n_rows * error.n_cols, error.n_slices, false, true);
+    const arma::Mat<eT> kernels(const_cast<eT*>(weight.memptr()),
+        weight.n_rows * weight.n_cols * g.n_slices, error.n_slices, false,
+        true);
+    const arma::Mat<eT> patches = errors * kernels.t();
+
+    if (padW == 0 && padH == 0)
+    {
+      Im2ColConvolution<BorderMode>::Col2Im(patches, weight.n_rows,
+          weight.n_cols, dW, dH, g);
+    }
+    else
+    {
+      // The error of the padding is dropped.
+      arma::Cube<eT> gPadded = arma::zeros<arma::Cube<eT> >(
+          g.n_rows + 2 * padW, g.n_cols + 2 * padH, g.n_slices);
+      Im2ColConvolution<BorderMode>::Col2Im(patches, weight.n_rows,
+          weight.n_cols, dW, dH, gPadded);
+      g += gPadded.tube(padW, padH, padW + g.n_rows - 1, padH + g.n_cols - 1);
+    }
+  }
+
+  template<typename eT>
+  static void Gradient(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Cube<eT>& gradient,
+                       const size_t dW,
+                       const size_t dH)
+  {
+    arma::Mat<eT> patches;
+    Im2ColConvolution<BorderMode>::Im2Col(input, gradient.n_rows,
+        gradient.n_cols, dW, dH, patches);
+
+    const arma::Mat<eT> errors(const_cast<eT*>(error.memptr()),
+        error.n_rows * error.n_cols, error.n_slices, false, true);
+    arma::Mat<eT> result(gradient.memptr(),
+        gradient.n_rows * gradient.n_cols * input.n_slices, error.n_slices,
+        false, true);
+    result += patches.t() * errors;
+  }
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file layer_convolution.hpp
+ *
+ * Convolution of all maps of a convolution layer with all of its kernels.  By
+ * default each pair of an input map and a kernel is convolved on its own with
+ * the given convolution rule; rules that can do better (like
+ * Im2ColConvolution) specialize LayerConvolution.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_LAYER_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_LAYER_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Perform the convolutions of the forward pass, the backward pass and the
+ * gradient computation of a layer with inSize input maps and outSize output
+ * maps.  The kernels are stored as the slices of a cube; slice
+ * (outMap * inSize + inMap) connects input map inMap to output map outMap.
+ *
+ * @tparam ConvolutionRule Convolution rule used for each pair of a map and a
+ *     kernel.
+ */
+template<typename ConvolutionRule>
+class LayerConvolution
+{
+ public:
+  /**
+   * Add the valid convolution of the input maps with the kernels to the
+   * output maps.
+   *
+   * @param input The (padded) input maps.
+   * @param weight The kernels of the layer.
+   * @param output The output maps; must be allocated already.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Forward(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& weight,
+                      arma::Cube<eT>& output,
+                      const size_t dW,
+                      const size_t dH)
+  {
+    for (size_t outMap = 0, outMapIdx = 0; outMap < output.n_slices; outMap++)
+    {
+      for (size_t inMap = 0; inMap < input.n_slices; inMap++, outMapIdx++)
+      {
+        arma::Mat<eT> convOutput;
+        ConvolutionRule::Convolution(input.slice(inMap),
+            weight.slice(outMapIdx), convOutput, dW, dH);
+
+        output.slice(outMap) += convOutput;
+      }
+    }
+  }
+
+  /**
+   * Add the error of the input maps, given the error of the output maps, to g.
+   *
+   * @param error The error of the output maps.
+   * @param weight The kernels of the layer.
+   * @param g The error of the (unpadded) input maps; must be allocated
+   *     already.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param padW Padding width of the input.
+   * @param padH Padding height of the input.
+   */
+  template<typename eT>
+  static void Backward(const arma::Cube<eT>& error,
+                       const arma::Cube<eT>& weight,
+                       arma::Cube<eT>& g,
+                       const size_t dW,
+                       const size_t dH,
+                       const size_t padW,
+                       const size_t padH)
+  {
+    for (size_t outMap = 0, outMapIdx = 0; outMap < error.n_slices; outMap++)
+    {
+      for (size_t inMap = 0; inMap < g.n_slices; inMap++, outMapIdx++)
+      {
+        // Left-right flip, up-down flip.
+        const arma::Mat<eT> rotatedFilter =
+            arma::fliplr(arma::flipud(weight.slice(outMapIdx)));
+
+        arma::Mat<eT> output;
+        ConvolutionRule::Convolution(error.slice(outMap), rotatedFilter,
+            output, dW, dH);
+
+        if (padW != 0 || padH != 0)
+        {
+          g.slice(inMap) += output.submat(rotatedFilter.n_rows / 2,
+              rotatedFilter.n_cols / 2,
+              rotatedFilter.n_rows / 2 + g.n_rows - 1,
+              rotatedFilter.n_cols / 2 + g.n_cols - 1);
+        }
+        else
+        {
+          g.slice(inMap) += output;
+        }
+      }
+    }
+  }
+
+  /**
+   * Add the gradient of the kernels, given the (padded) input maps and the
+   * error of the output maps, to gradient.
+   *
+   * @param input The (padded) input maps.
+   * @param error The error of the output maps.
+   * @param gradient The gradient of the kernels; must be allocated already.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Gradient(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Cube<eT>& gradient,
+                       const size_t dW,
+                       const size_t dH)
+  {
+    for (size_t outMap = 0, outMapIdx = 0; outMap < error.n_slices; outMap++)
+    {
+      for (size_t inMap = 0; inMap < input.n_slices; inMap++, outMapIdx++)
+      {
+        arma::Cube<eT> inputSlices = input.slices(inMap, inMap);
+        arma::Cube<eT> deltaSlices = error.slices(outMap, outMap);
+
+        arma::Cube<eT> output;
+        ConvolutionRule::Convolution(inputSlices, deltaSlices, output, dW,
+            dH);
+
+        if (gradient.n_rows < output.n_rows &&
+            gradient.n_cols < output.n_cols)
+        {
+          for (size_t i = 0; i < output.n_slices; i++)
+          {
+            const arma::Mat<eT>& subOutput = output.slice(i);
+
+            gradient.slice(outMapIdx) += subOutput.submat(subOutput.n_rows / 2,
+                subOutput.n_cols / 2,
+                subOutput.n_rows / 2 + gradient.n_rows - 1,
+                subOutput.n_cols / 2 + gradient.n_cols - 1);
+          }
+        }
+        else
+        {
+          for (size_t i = 0; i < output.n_slices; i++)
+            gradient.slice(outMapIdx) += output.slice(i);
+        }
+      }
+    }
+  }
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * @file file_data_source.hpp
+ *
+ * Definition of the FileDataSource class, which streams batches from a dataset
+ * that is stored in several files.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_SOURCE_FILE_DATA_SOURCE_HPP
+#define MLPACK_METHODS_ANN_DATA_SOURCE_FILE_DATA_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "matrix_data_source.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A data source (see MatrixDataSource) for datasets that are too large to be
+ * held in memory.  The dataset is split into chunks, each of which is stored
+ * in a predictor file and a response file that can be loaded with
+ * data::Load().  Only one chunk is held in memory at a time; it is loaded when
+ * the batches of the previous chunk have been used.  If the points are
+ * shuffled, each epoch visits the chunks in a new random order and the points
+ * of each chunk in a new random order.
+ *
+ * Loading a chunk blocks the training; wrap the data source into a
+ * PrefetchDataSource to load the chunks in the background.
+ *
+ * @code
+ * FileDataSource source({ "x0.csv", "x1.csv" }, { "y0.csv", "y1.csv" }, 64);
+ * PrefetchDataSource<FileDataSource> prefetch(source);
+ * model.Train(prefetch, optimizer, 10);
+ * @endcode
+ */
+class FileDataSource
+{
+ public:
+  /**
+   * Create the data source for the given files; the files are not loaded yet.
+   * A std::invalid_argument exception is thrown if the number of predictor
+   * files and response files differs, or if the batch size is 0.
+   *
+   * @param predictorFiles The predictor file of each chunk.
+   * @param responseFiles The response file of each chunk.
+   * @param batchSize Number of points of each batch; the last batch of each
+   *        chunk can be smaller.
+   * @param shuffle If true, the chunks and the points of each chunk are
+   *        shuffled at the start of every epoch.
+   */
+  FileDataSource(std::vector<std::string> predictorFiles,
+                 std::vector<std::string> responseFiles,
+                 const size_t batchSize = 32,
+                 const bool shuffle = true);
+
+  //! Start a new epoch.
+  void Reset();
+
+  /**
+   * Store the next batch of the epoch in the given matrices, loading the next
+   * chunk if necessary.  A std::runtime_error exception is thrown if a chunk
+   * cannot be loaded.
+   *
+   * @param predictors Matrix to store the predictors of the batch in.
+   * @param responses Matrix to store the responses of the batch in.
+   * @return false if the epoch is over, and there is no further batch.
+   */
+  bool NextBatch(arma::mat& predictors, arma::mat& responses);
+
+  //! Get the number of chunks.
+  size_t NumChunks() const { return predictorFiles.size(); }
+
+ private:
+  //! The predictor file of each chunk.
+  std::vector<std::string> predictorFiles;
+
+  //! The response file of each chunk.
+  std::vector<std::string> responseFiles;
+
+  //! The number of points of each batch.
+  size_t batchSize;
+
+  //! If true, the chunks and the points are shuffled at every epoch.
+  bool shuffle;
+
+  //! The order of the chunks in the current epoch.
+  arma::uvec ordering;
+
+  //! The position of the next chunk in the ordering.
+  size_t nextChunk;
+
+  //! The chunk that is currently loaded.
+  MatrixDataSource chunk;
+}; // class FileDataSource
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "file_data_source_impl.hpp"
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file file_data_source_impl.hpp
+ *
+ * Implementation of the FileDataSource class, which streams batches from a
+ * dataset that is stored in several files.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_SOURCE_FILE_DATA_SOURCE_IMPL_HPP
+#define MLPACK_METHODS_ANN_DATA_SOURCE_FILE_DATA_SOURCE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "file_data_source.hpp"
+
+#include <mlpack/core/data/load.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline FileDataSource::FileDataSource(std::vector<std::string> predictorFiles,
+                                      std::vector<std::string> responseFiles,
+                                      const size_t batchSize,
+                                      const bool shuffle) :
+    predictorFiles(std::move(predictorFiles)),
+    responseFiles(std::move(responseFiles)),
+    batchSize(batchSize),
+    shuffle(shuffle),
+    nextChunk(0),
+    chunk(arma::mat(), arma::mat(), std::max(batchSize, (size_t) 1), shuffle)
+{
+  if (this->predictorFiles.size() != this->responseFiles.size())
+  {
+    std::ostringstream oss;
+    oss << "FileDataSource::FileDataSource(): " << this->predictorFiles.size()
+        << " predictor files given for " << this->responseFiles.size()
+        << " response files";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("FileDataSource::FileDataSource(): the batch "
+        "size must be positive");
+  }
+
+  if (NumChunks() > 0)
+    ordering = arma::linspace<arma::uvec>(0, NumChunks() - 1, NumChunks());
+}
+
+inline void FileDataSource::Reset()
+{
+  nextChunk = 0;
+  chunk = MatrixDataSource(arma::mat(), arma::mat(), batchSize, shuffle);
+
+  if (shuffle)
+    ordering = arma::shuffle(ordering);
+}
+
+inline bool FileDataSource::NextBatch(arma::mat& predictors,
+                                      arma::mat& responses)
+{
+  // Load chunks until one of them has a batch left; chunks can be empty.
+  while (!chunk.NextBatch(predictors, responses))
+  {
+    if (nextChunk >= NumChunks())
+      return false;
+
+    const size_t index = ordering[nextChunk++];
+    arma::mat chunkPredictors, chunkResponses;
+    if (!data::Load(predictorFiles[index], chunkPredictors) ||
+        !data::Load(responseFiles[index], chunkResponses))
+    {
+      std::ostringstream oss;
+      oss << "FileDataSource::NextBatch(): cannot load chunk " << index
+          << " ('" << predictorFiles[index] << "', '" << responseFiles[index]
+          << "')";
+      throw std::runtime_error(oss.str());
+    }
+
+    chunk = MatrixDataSource(std::move(chunkPredictors),
+        std::move(chunkResponses), batchSize, shuffle);
+    chunk.Reset();
+  }
+
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file matrix_data_source.hpp
+ *
+ * Definition of the MatrixDataSource class, which splits a dataset that is held
+ * in memory into batches.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_SOURCE_MATRIX_DATA_SOURCE_HPP
+#define MLPACK_METHODS_ANN_DATA_SOURCE_MATRIX_DATA_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A data source that splits a dataset held in memory into batches.  Like all
+ * data sources, it provides the batches of one pass over the data (an epoch)
+ * through two functions:
+ *
+ * @code
+ * // Start a new epoch.
+ * void Reset();
+ *
+ * // Store the next batch of the epoch in the given matrices, and return
+ * // false if the epoch is over.
+ * bool NextBatch(arma::mat& predictors, arma::mat& responses);
+ * @endcode
+ *
+ * Any class with these functions can be used to train an FFN or an RNN on a
+ * stream of batches, for instance a class that generates the data.  If the
+ * points are shuffled, each epoch visits them in a new random order.
+ */
+class MatrixDataSource
+{
+ public:
+  /**
+   * Create the data source for the given dataset.  A std::invalid_argument
+   * exception is thrown if the predictors and the responses have a different
+   * number of points, or if the batch size is 0.
+   *
+   * @param predictors Input training variables (one point per column).
+   * @param responses Outputs results from input training variables.
+   * @param batchSize Number of points of each batch; the last batch of an
+   *        epoch can be smaller.
+   * @param shuffle If true, the points are shuffled at the start of every
+   *        epoch.
+   */
+  MatrixDataSource(arma::mat predictors,
+                   arma::mat responses,
+                   const size_t batchSize = 32,
+                   const bool shuffle = true);
+
+  //! Start a new epoch.
+  void Reset();
+
+  /**
+   * Store the next batch of the epoch in the given matrices.
+   *
+   * @param predictors Matrix to store the predictors of the batch in.
+   * @param responses Matrix to store the responses of the batch in.
+   * @return false if the epoch is over, and there is no further batch.
+   */
+  bool NextBatch(arma::mat& predictors, arma::mat& responses);
+
+  //! Get the number of points.
+  size_t NumPoints() const { return predictors.n_cols; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get whether the points are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether the points are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+ private:
+  //! The predictors of the dataset.
+  arma::mat predictors;
+
+  //! The responses of the dataset.
+  arma::mat responses;
+
+  //! The number of points of each batch.
+  size_t batchSize;
+
+  //! If true, the points are shuffled at the start of every epoch.
+  bool shuffle;
+
+  //! The order of the points in the current epoch, if they are shuffled.
+  arma::uvec ordering;
+
+  //! The first point of the next batch.
+  size_t position;
+}; // class MatrixDataSource
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "matrix_data_source_impl.hpp"
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file matrix_data_source_impl.hpp
+ *
+ * Implementation of the MatrixDataSource class, which splits a dataset that is
+ * held in memory into batches.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_SOURCE_MATRIX_DATA_SOURCE_IMPL_HPP
+#define MLPACK_METHODS_ANN_DATA_SOURCE_MATRIX_DATA_SOURCE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "matrix_data_source.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline MatrixDataSource::MatrixDataSource(arma::mat predictors,
+                                          arma::mat responses,
+                                          const size_t batchSize,
+                                          const bool shuffle) :
+    predictors(std::move(predictors)),
+    responses(std::move(responses)),
+    batchSize(batchSize),
+    shuffle(shuffle),
+    position(0)
+{
+  if (this->predictors.n_cols != this->responses.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "MatrixDataSource::MatrixDataSource(): " << this->predictors.n_cols
+        << " predictors given for " << this->responses.n_cols << " responses";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("MatrixDataSource::MatrixDataSource(): the "
+        "batch size must be positive");
+  }
+}
+
+inline void MatrixDataSource::Reset()
+{
+  position = 0;
+
+  if (shuffle && predictors.n_cols > 0)
+  {
+    ordering = arma::shuffle(arma::linspace<arma::uvec>(0,
+        predictors.n_cols - 1, predictors.n_cols));
+  }
+}
+
+inline bool MatrixDataSource::NextBatch(arma::mat& predictors,
+                                        arma::mat& responses)
+{
+  if (position >= this->predictors.n_cols)
+    return false;
+
+  const size_t last = std::min(position + batchSize,
+      (size_t) this->predictors.n_cols) - 1;
+
+  // The ordering is only valid if the points were shuffled at the start of
+  // the epoch.
+  if (shuffle && ordering.n_elem == this->predictors.n_cols)
+  {
+    const arma::uvec batch = ordering.subvec(position, last);
+    predictors = this->predictors.cols(batch);
+    responses = this->responses.cols(batch);
+  }
+  else
+  {
+    predictors = this->predictors.cols(position, last);
+    responses = this->responses.cols(position, last);
+  }
+
+  position = last + 1;
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
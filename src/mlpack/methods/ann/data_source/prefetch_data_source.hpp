@@ -0,0 +1,122 @@
+/**
+ * @file prefetch_data_source.hpp
+ *
+ * Definition of the PrefetchDataSource class, which prepares the batches of
+ * another data source in a background thread.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_SOURCE_PREFETCH_DATA_SOURCE_HPP
+#define MLPACK_METHODS_ANN_DATA_SOURCE_PREFETCH_DATA_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A data source (see MatrixDataSource) that prepares the batches of another
+ * data source in a background thread.  While the network trains on one batch,
+ * the thread already gathers (and loads, shuffles or generates) the next
+ * batches, up to the given number, so the training does not wait for the data
+ * unless the data source is slower than the training.
+ *
+ * Each Reset() starts a new thread for the epoch, which calls Reset() and then
+ * NextBatch() of the given data source; the data source must not be used by
+ * anything else meanwhile.  An exception thrown by the data source is passed
+ * on by NextBatch(), after the batches before it.
+ *
+ * @tparam DataSourceType The type of the data source to prefetch from.
+ */
+template<typename DataSourceType>
+class PrefetchDataSource
+{
+ public:
+  /**
+   * Create the prefetching data source for the given data source.  A
+   * std::invalid_argument exception is thrown if the queue size is 0.
+   *
+   * @param source The data source to prefetch the batches from.
+   * @param queueSize Maximum number of batches that are prepared ahead.
+   */
+  PrefetchDataSource(DataSourceType& source, const size_t queueSize = 2);
+
+  //! The background thread uses this object, so it cannot be copied.
+  PrefetchDataSource(const PrefetchDataSource&) = delete;
+  PrefetchDataSource& operator=(const PrefetchDataSource&) = delete;
+
+  //! Stop the background thread.
+  ~PrefetchDataSource();
+
+  //! Start a new epoch, abandoning the rest of the current one.
+  void Reset();
+
+  /**
+   * Store the next batch of the epoch in the given matrices, waiting for the
+   * background thread if it has not prepared one yet.  If no epoch was started,
+   * one is started first.
+   *
+   * @param predictors Matrix to store the predictors of the batch in.
+   * @param responses Matrix to store the responses of the batch in.
+   * @return false if the epoch is over, and there is no further batch.
+   */
+  bool NextBatch(arma::mat& predictors, arma::mat& responses);
+
+  //! Get the maximum number of batches that are prepared ahead.
+  size_t QueueSize() const { return queueSize; }
+
+ private:
+  //! Stop the background thread and wait for it.
+  void Stop();
+
+  //! The function of the background thread, which fills the queue with the
+  //! batches of one epoch.
+  void Fill();
+
+  //! The data source to prefetch from.
+  DataSourceType& source;
+
+  //! Maximum number of batches that are prepared ahead.
+  size_t queueSize;
+
+  //! The batches that have been prepared.
+  std::deque<std::pair<arma::mat, arma::mat> > queue;
+
+  //! Set when the background thread has passed all batches of the epoch.
+  bool finished;
+
+  //! Set to make the background thread stop.
+  bool stop;
+
+  //! The exception thrown by the data source, if any.
+  std::exception_ptr error;
+
+  //! The mutex that guards the queue and the flags.
+  std::mutex mutex;
+
+  //! Signalled when a batch was added or the epoch is over.
+  std::condition_variable notEmpty;
+
+  //! Signalled when a batch was taken or the thread should stop.
+  std::condition_variable notFull;
+
+  //! The background thread.
+  std::thread worker;
+}; // class PrefetchDataSource
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "prefetch_data_source_impl.hpp"
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file prefetch_data_source_impl.hpp
+ *
+ * Implementation of the PrefetchDataSource class, which prepares the batches of
+ * another data source in a background thread.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_SOURCE_PREFETCH_DATA_SOURCE_IMPL_HPP
+#define MLPACK_METHODS_ANN_DATA_SOURCE_PREFETCH_DATA_SOURCE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "prefetch_data_source.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename DataSourceType>
+PrefetchDataSource<DataSourceType>::PrefetchDataSource(
+    DataSourceType& source, const size_t queueSize) :
+    source(source),
+    queueSize(queueSize),
+    finished(false),
+    stop(false)
+{
+  if (queueSize == 0)
+  {
+    throw std::invalid_argument("PrefetchDataSource::PrefetchDataSource(): "
+        "the queue size must be positive");
+  }
+}
+
+template<typename DataSourceType>
+PrefetchDataSource<DataSourceType>::~PrefetchDataSource()
+{
+  Stop();
+}
+
+template<typename DataSourceType>
+void PrefetchDataSource<DataSourceType>::Reset()
+{
+  Stop();
+
+  queue.clear();
+  finished = false;
+  stop = false;
+  error = std::exception_ptr();
+
+  worker = std::thread(&PrefetchDataSource::Fill, this);
+}
+
+template<typename DataSourceType>
+bool PrefetchDataSource<DataSourceType>::NextBatch(arma::mat& predictors,
+                                                   arma::mat& responses)
+{
+  if (!worker.joinable())
+    Reset();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  notEmpty.wait(lock, [this] { return !queue.empty() || finished; });
+
+  if (!queue.empty())
+  {
+    predictors = std::move(queue.front().first);
+    responses = std::move(queue.front().second);
+    queue.pop_front();
+
+    notFull.notify_one();
+    return true;
+  }
+
+  // The epoch is over; pass on the exception that ended it, if any.
+  if (error)
+  {
+    std::exception_ptr e = error;
+    error = std::exception_ptr();
+    std::rethrow_exception(e);
+  }
+
+  return false;
+}
+
+template<typename DataSourceType>
+void PrefetchDataSource<DataSourceType>::Stop()
+{
+  if (!worker.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+
+  notFull.notify_all();
+  worker.join();
+}
+
+template<typename DataSourceType>
+void PrefetchDataSource<DataSourceType>::Fill()
+{
+  try
+  {
+    source.Reset();
+
+    arma::mat predictors, responses;
+    while (source.NextBatch(predictors, responses))
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      notFull.wait(lock, [this] { return stop || queue.size() < queueSize; });
+      if (stop)
+        return;
+
+      queue.emplace_back(std::move(predictors), std::move(responses));
+      notEmpty.notify_one();
+    }
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    error = std::current_exception();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  finished = true;
+  notEmpty.notify_one();
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
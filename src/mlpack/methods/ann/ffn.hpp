@@ -27,27 +27,50 @@
 #include "init_rules/network_init.hpp"
 
 #include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/activation_functions/fast_activations.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
 
+#include <memory>
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 /**
  * Implementation of a standard feed forward network.
  *
+ * Every layer keeps its output, its delta and its gradient between passes, and
+ * the layers write into them in place.  Once they have been sized for a batch,
+ * training and prediction on batches of the same size allocate no memory for
+ * them.
+ *
+ * The objective and the gradient of a batch can be computed by several threads
+ * at once (see NumThreads()).  The batch is then split into contiguous blocks,
+ * one per thread, and each block is passed through a copy of the layers that
+ * shares the parameters of the network.  The results of the blocks are summed
+ * in order, so for a given number of threads they do not depend on the
+ * scheduling of the threads; this holds for networks without random layers
+ * (like Dropout).
+ *
  * @tparam OutputLayerType The output layer type used to evaluate the network.
  * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam MatType Type of the parameters, the data and the activations
+ *     (arma::mat, or arma::fmat to train and predict in single precision).  The
+ *     layers and the output layer must use the same type.
  */
 template<
   typename OutputLayerType = NegativeLogLikelihood<>,
-  typename InitializationRuleType = RandomInitialization
+  typename InitializationRuleType = RandomInitialization,
+  typename MatType = arma::mat
 >
 class FFN
 {
  public:
   //! Convenience typedef for the internal model construction.
-  using NetworkType = FFN<OutputLayerType, InitializationRuleType>;
+  using NetworkType = FFN<OutputLayerType, InitializationRuleType, MatType>;
+
+  //! The type of the sparse gradients.
+  typedef arma::SpMat<typename MatType::elem_type> SpMatType;
 
   /**
    * Create the FFN object with the given predictors and responses set (this is
@@ -89,8 +112,8 @@ class FFN
    * @param initializeRule Optional instantiated InitializationRule object
    *        for initializing the network parameter.
    */
-  FFN(arma::mat predictors,
-      arma::mat responses,
+  FFN(MatType predictors,
+      MatType responses,
       OutputLayerType outputLayer = OutputLayerType(),
       InitializationRuleType initializeRule = InitializationRuleType());
 
@@ -114,8 +137,8 @@ class FFN
    * @param optimizer Instantiated optimizer used to train the model.
    */
   template<typename OptimizerType>
-  void Train(arma::mat predictors,
-             arma::mat responses,
+  void Train(MatType predictors,
+             MatType responses,
              OptimizerType& optimizer);
 
   /**
@@ -135,7 +158,31 @@ class FFN
    * @param responses Outputs results from input training variables.
    */
   template<typename OptimizerType = mlpack::optimization::RMSProp>
-  void Train(arma::mat predictors, arma::mat responses);
+  void Train(MatType predictors, MatType responses);
+
+  /**
+   * Train the feedforward network on a stream of batches from the given data
+   * source (see MatrixDataSource), for the given number of epochs.  At
+   * the start of every epoch the data source is reset, and the optimizer is run
+   * on each batch, starting from the current parameters.  The optimizer should
+   * keep its state between batches and should not run for long on a single
+   * batch, e.g. a MiniBatchSGD optimizer with the batch size of the data
+   * source, maxIterations set to 2 (one step per batch) and resetPolicy set to
+   * false, leaving the shuffling to the data source.
+   *
+   * Use a PrefetchDataSource to prepare the next batches in the background
+   * while the current one trains.
+   *
+   * @tparam DataSourceType Type of the data source.
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param source The data source to take the batches from.
+   * @param optimizer Instantiated optimizer used to train on each batch.
+   * @param epochs Number of passes over the data source.
+   */
+  template<typename DataSourceType, typename OptimizerType>
+  void Train(DataSourceType& source,
+             OptimizerType& optimizer,
+             const size_t epochs = 1);
 
   /**
    * Predict the responses to a given set of predictors. The responses will
@@ -148,7 +195,7 @@ class FFN
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(MatType predictors, MatType& results);
 
    /**
    * Evaluate the feedforward network with the given parameters, but using only
@@ -160,19 +207,38 @@ class FFN
    * @param deterministic Whether or not to train or test the model. Note some
    *        layer act differently in training or testing mode.
    */
-  double Evaluate(const arma::mat& parameters,
+  double Evaluate(const MatType& parameters,
                   const size_t i,
                   const bool deterministic = true);
 
+  /**
+   * Evaluate the feedforward network with the given parameters on the
+   * consecutive data points [begin, begin + batchSize).  The points are passed
+   * through the network together, so each layer processes the whole batch at
+   * once; this is used by optimizers such as MiniBatchSGD.  Networks with
+   * layers that work on images (convolution, pooling, glimpse) pass one point
+   * at a time.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to use for objective function
+   *        evaluation.
+   * If NumThreads() is not 1, the batch is split between threads.
+   *
+   * @return The sum of the objectives of the points.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize);
+
   /**
    * Evaluate the feedforward network with the given parameters. This function
    * is usually called by the optimizer to train the model.
    *
    * @param parameters Matrix model parameters.
-   * @param deterministic Whether or not to train or test the model. Note some
-   *        layer act differently in training or testing mode.
    */
-  double Evaluate(const arma::mat& parameters);
+  double Evaluate(const MatType& parameters);
 
   /**
    * Evaluate the gradient of the feedforward network with the given parameters,
@@ -183,9 +249,109 @@ class FFN
    * @param i Index of points to use for objective function gradient evaluation.
    * @param gradient Matrix to output gradient into.
    */
-  void Gradient(const arma::mat& parameters,
+  void Gradient(const MatType& parameters,
                 const size_t i,
-                arma::mat& gradient);
+                MatType& gradient);
+
+  /**
+   * Evaluate the gradient of the feedforward network with the given
+   * parameters, with respect to the consecutive data points
+   * [begin, begin + batchSize).  The points are passed through the network
+   * together, just like in the batch version of Evaluate(), and the gradient
+   * is the sum of the gradients of the points.  If NumThreads() is not 1, the
+   * batch is split between threads, and the gradients of their blocks are
+   * summed in order.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to use for objective function gradient
+   *        evaluation.
+   */
+  void Gradient(const MatType& parameters,
+                const size_t begin,
+                MatType& gradient,
+                const size_t batchSize);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on all points
+   * and store the gradient in the given matrix.  The objective comes from the
+   * same forward pass as the gradient, so layers like Dropout are in training
+   * mode for it (unlike in Evaluate()).
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param gradient Matrix to output gradient into.
+   * @return The sum of the objectives of the points.
+   */
+  double EvaluateWithGradient(const MatType& parameters,
+                              MatType& gradient);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on one point
+   * and store the gradient in the given matrix, with one forward pass.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param i Index of the point to use.
+   * @param gradient Matrix to output gradient into.
+   * @return The objective of the point.
+   */
+  double EvaluateWithGradient(const MatType& parameters,
+                              const size_t i,
+                              MatType& gradient);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on the
+   * consecutive points [begin, begin + batchSize) and store the sum of their
+   * gradients in the given matrix, with one forward pass, as in the batch
+   * version of Gradient().
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point to use.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to use.
+   * @return The sum of the objectives of the points.
+   */
+  double EvaluateWithGradient(const MatType& parameters,
+                              const size_t begin,
+                              MatType& gradient,
+                              const size_t batchSize);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on one point
+   * and store the gradient in the given sparse matrix.  Layers with a sparse
+   * gradient (like Lookup) only add the columns of their weights that were
+   * used, so the cost of the gradient does not depend on the size of their
+   * weights; the gradients of the other layers are added as they are.  Use
+   * a SparseGradientFunction to train with sparse gradients, with an
+   * optimizer that supports them (like Adam or AdaGrad).
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param i Index of the point to use.
+   * @param gradient Sparse matrix to output gradient into.
+   * @return The objective of the point.
+   */
+  double EvaluateWithGradient(const MatType& parameters,
+                              const size_t i,
+                              SpMatType& gradient);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on the
+   * consecutive points [begin, begin + batchSize) and store the sum of their
+   * gradients in the given sparse matrix, as in the sparse version of
+   * EvaluateWithGradient() for one point.  The batch is not split between
+   * threads.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point to use.
+   * @param gradient Sparse matrix to output gradient into.
+   * @param batchSize Number of points to use.
+   * @return The sum of the objectives of the points.
+   */
+  double EvaluateWithGradient(const MatType& parameters,
+                              const size_t begin,
+                              SpMatType& gradient,
+                              const size_t batchSize);
 
   /*
    * Add a new module to the model.
@@ -200,15 +366,33 @@ class FFN
    *
    * @param layer The Layer to be added to the model.
    */
-  void Add(LayerTypes layer) { network.push_back(layer); }
+  void Add(LayerTypes<MatType> layer) { network.push_back(layer); }
+
+  //! Get the layers of the network.
+  const std::vector<LayerTypes<MatType>>& Model() const { return network; }
 
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
   //! Return the initial point for the optimization.
-  const arma::mat& Parameters() const { return parameter; }
+  const MatType& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
-  arma::mat& Parameters() { return parameter; }
+  MatType& Parameters() { return parameter; }
+
+  //! Get the number of threads that compute the objective and the gradient of
+  //! a batch.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads that compute the objective and the gradient
+  //! of a batch (0 means as many as OpenMP provides; the default is 1).
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the accuracy of the activation functions of the forward pass.
+  ActivationAccuracy ActivationMode() const { return activationAccuracy; }
+  //! Modify the accuracy of the activation functions of the forward pass
+  //! (EXACT_ACTIVATIONS by default; TRAINING_ACTIVATIONS is as accurate as
+  //! needed for training, and INFERENCE_ACTIVATIONS for prediction only).  The
+  //! derivatives are always exact.  This is not serialized.
+  ActivationAccuracy& ActivationMode() { return activationAccuracy; }
 
   /**
    * Reset the module infomration (weights/parameters).
@@ -229,7 +413,7 @@ class FFN
    * @param inputs The input data.
    * @param results The predicted results.
    */
-  void Forward(arma::mat inputs, arma::mat& results);
+  void Forward(MatType inputs, MatType& results);
 
   /**
    * Perform the backward pass of the data in real batch mode.
@@ -242,7 +426,7 @@ class FFN
    * @param gradients Computed gradients.
    * @return Training error of the current pass.
    */
-  double Backward(arma::mat targets, arma::mat& gradients);
+  double Backward(MatType targets, MatType& gradients);
 
  private:
   // Helper functions.
@@ -252,7 +436,7 @@ class FFN
    *
    * @param input Data sequence to compute probabilities for.
    */
-  void Forward(arma::mat&& input);
+  void Forward(MatType&& input);
 
   /**
    * Prepare the network for the given data.
@@ -261,7 +445,28 @@ class FFN
    * @param predictors Input data variables.
    * @param responses Outputs results from input data variables.
    */
-  void ResetData(arma::mat predictors, arma::mat responses);
+  void ResetData(MatType predictors, MatType responses);
+
+  /**
+   * Pass the consecutive points [begin, begin + batchSize) through the network
+   * and evaluate the output layer.
+   *
+   * @param begin Index of the first point.
+   * @param batchSize Number of points.
+   * @param deterministic Whether or not to train or test the model.
+   * @return The sum of the objectives of the points.
+   */
+  double EvaluateBatch(const size_t begin,
+                       const size_t batchSize,
+                       const bool deterministic);
+
+  /**
+   * Return whether several points can be passed through the network at once.
+   * This is not the case if a layer works on images, since such layers only
+   * take a single point.  The sizes of the layers are found with a forward
+   * pass of the first point, if that has not been done yet.
+   */
+  bool SupportsBatches();
 
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
@@ -275,6 +480,12 @@ class FFN
    */
   void Gradient();
 
+  /**
+   * Iterate through all layer modules and store their gradients in the given
+   * sparse matrix; layers without a sparse gradient use the dense workspace.
+   */
+  void SparseGradient(SpMatType& gradient);
+
   /**
    * Reset the module status by setting the current deterministic parameter
    * for all modules that implement the Deterministic function.
@@ -284,7 +495,24 @@ class FFN
   /**
    * Reset the gradient for all modules that implement the Gradient function.
    */
-  void ResetGradients(arma::mat& gradient);
+  void ResetGradients(MatType& gradient);
+
+  /**
+   * Return the number of threads that a batch of the given size is split
+   * between.
+   *
+   * @param batchSize Number of points in the batch.
+   */
+  size_t BatchThreads(const size_t batchSize) const;
+
+  /**
+   * Make sure that there is a worker network for each of the given number of
+   * threads.  The workers have their own copies of the layers (and so of the
+   * activations), but share the parameters and the data of this network.
+   *
+   * @param threads Number of worker networks.
+   */
+  void ResetWorkers(const size_t threads);
 
   /**
    * Swap the content of this network with given network.
@@ -310,34 +538,34 @@ class FFN
   bool reset;
 
   //! Locally-stored model modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<MatType>> network;
 
   //! The matrix of data points (predictors).
-  arma::mat predictors;
+  MatType predictors;
 
   //! The matrix of responses to the input data points.
-  arma::mat responses;
+  MatType responses;
 
   //! Matrix of (trained) parameters.
-  arma::mat parameter;
+  MatType parameter;
 
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
   //! The current error for the backward pass.
-  arma::mat error;
+  MatType error;
 
   //! THe current input of the forward/backward pass.
-  arma::mat currentInput;
+  MatType currentInput;
 
   //! THe current target of the forward/backward pass.
-  arma::mat currentTarget;
+  MatType currentTarget;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<MatType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<MatType> outputParameterVisitor;
 
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
@@ -358,19 +586,37 @@ class FFN
   bool deterministic;
 
   //! Locally-stored delta object.
-  arma::mat delta;
+  MatType delta;
 
   //! Locally-stored input parameter object.
-  arma::mat inputParameter;
+  MatType inputParameter;
 
   //! Locally-stored output parameter object.
-  arma::mat outputParameter;
+  MatType outputParameter;
 
   //! Locally-stored gradient parameter.
-  arma::mat gradient;
+  MatType gradient;
+
+  //! The number of threads that compute the objective and the gradient of a
+  //! batch.
+  size_t numThreads;
+
+  //! The accuracy of the activation functions of the forward pass.
+  ActivationAccuracy activationAccuracy;
+
+  //! The networks that compute the objective and the gradient of the blocks of
+  //! a batch, if more than one thread is used.
+  std::vector<std::unique_ptr<FFN> > workers;
+
+  //! The gradients of the blocks of a batch.
+  std::vector<MatType> workerGradients;
+
+  //! The gradients of the layers without a sparse gradient, for the sparse
+  //! gradient of the network.
+  MatType sparseWorkspace;
 
   //! Locally-stored copy visitor
-  CopyVisitor copyVisitor;
+  CopyVisitor<MatType> copyVisitor;
 }; // class FFN
 
 } // namespace ann
@@ -20,17 +20,23 @@
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
+#include "visitor/sparse_gradient_visitor.hpp"
 #include "visitor/set_input_height_visitor.hpp"
 #include "visitor/set_input_width_visitor.hpp"
 
 #include <boost/serialization/variant.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
     OutputLayerType outputLayer, InitializationRuleType initializeRule) :
     outputLayer(std::move(outputLayer)),
     initializeRule(std::move(initializeRule)),
@@ -38,15 +44,18 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     height(0),
     reset(false),
     numFunctions(0),
-    deterministic(true)
+    deterministic(true),
+    numThreads(1),
+    activationAccuracy(EXACT_ACTIVATIONS)
 {
   /* Nothing to do here */
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
-    arma::mat predictors,
-    arma::mat responses,
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
+    MatType predictors,
+    MatType responses,
     OutputLayerType outputLayer,
     InitializationRuleType initializeRule) :
     outputLayer(std::move(outputLayer)),
@@ -56,21 +65,25 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     reset(false),
     predictors(std::move(predictors)),
     responses(std::move(responses)),
-    deterministic(true)
+    deterministic(true),
+    numThreads(1),
+    activationAccuracy(EXACT_ACTIVATIONS)
 {
   numFunctions = this->responses.n_cols;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::~FFN()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::~FFN()
 {
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deleteVisitor));
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetData(
-    arma::mat predictors, arma::mat responses)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetData(
+    MatType predictors, MatType responses)
 {
   numFunctions = responses.n_cols;
   this->predictors = std::move(predictors);
@@ -84,11 +97,12 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetData(
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename OptimizerType>
-void FFN<OutputLayerType, InitializationRuleType>::Train(
-      arma::mat predictors,
-      arma::mat responses,
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Train(
+      MatType predictors,
+      MatType responses,
       OptimizerType& optimizer)
 {
   ResetData(std::move(predictors), std::move(responses));
@@ -102,10 +116,11 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename OptimizerType>
-void FFN<OutputLayerType, InitializationRuleType>::Train(
-    arma::mat predictors, arma::mat responses)
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    MatType predictors, MatType responses)
 {
   numFunctions = responses.n_cols;
 
@@ -131,9 +146,37 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Forward(
-    arma::mat inputs, arma::mat& results)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+template<typename DataSourceType, typename OptimizerType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    DataSourceType& source,
+    OptimizerType& optimizer,
+    const size_t epochs)
+{
+  MatType batchPredictors, batchResponses;
+
+  Timer::Start("ffn_optimization");
+  for (size_t epoch = 0; epoch < epochs; ++epoch)
+  {
+    double objective = 0;
+    source.Reset();
+    while (source.NextBatch(batchPredictors, batchResponses))
+    {
+      ResetData(std::move(batchPredictors), std::move(batchResponses));
+      objective += optimizer.Optimize(*this, parameter);
+    }
+
+    Log::Info << "FFN::Train(): objective of epoch " << epoch << " is "
+        << objective << "." << std::endl;
+  }
+  Timer::Stop("ffn_optimization");
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Forward(
+    MatType inputs, MatType& results)
 {
   if (parameter.is_empty())
   {
@@ -151,9 +194,10 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(
   results = boost::apply_visitor(outputParameterVisitor, network.back());
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-double FFN<OutputLayerType, InitializationRuleType>::Backward(
-    arma::mat targets, arma::mat& gradients)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::Backward(
+    MatType targets, MatType& gradients)
 {
   currentTarget = std::move(targets);
   double res = outputLayer.Forward(std::move(boost::apply_visitor(
@@ -162,7 +206,7 @@ double FFN<OutputLayerType, InitializationRuleType>::Backward(
   outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
       network.back())), std::move(currentTarget), std::move(error));
 
-  gradients = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+  gradients = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
 
   Backward();
   ResetGradients(gradients);
@@ -171,9 +215,10 @@ double FFN<OutputLayerType, InitializationRuleType>::Backward(
   return res;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Predict(
-    arma::mat predictors, arma::mat& results)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Predict(
+    MatType predictors, MatType& results)
 {
   if (parameter.is_empty())
   {
@@ -186,18 +231,18 @@ void FFN<OutputLayerType, InitializationRuleType>::Predict(
     ResetDeterministic();
   }
 
-  arma::mat resultsTemp;
-  Forward(std::move(arma::mat(predictors.colptr(0),
+  MatType resultsTemp;
+  Forward(std::move(MatType(predictors.colptr(0),
       predictors.n_rows, 1, false, true)));
   resultsTemp = boost::apply_visitor(outputParameterVisitor,
       network.back()).col(0);
 
-  results = arma::mat(resultsTemp.n_elem, predictors.n_cols);
+  results = MatType(resultsTemp.n_elem, predictors.n_cols);
   results.col(0) = resultsTemp.col(0);
 
   for (size_t i = 1; i < predictors.n_cols; i++)
   {
-    Forward(std::move(arma::mat(predictors.colptr(i),
+    Forward(std::move(MatType(predictors.colptr(i),
         predictors.n_rows, 1, false, true)));
 
     resultsTemp = boost::apply_visitor(outputParameterVisitor,
@@ -206,45 +251,106 @@ void FFN<OutputLayerType, InitializationRuleType>::Predict(
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
-    const arma::mat& /* parameters */, const size_t i, const bool deterministic)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& /* parameters */, const size_t i, const bool deterministic)
+{
+  return EvaluateBatch(i, 1, deterministic);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& parameters,
+    const size_t begin,
+    const size_t batchSize)
 {
+  const size_t threads = BatchThreads(batchSize);
+  if (threads <= 1)
+    return EvaluateBatch(begin, batchSize, true);
+
   if (parameter.is_empty())
   {
     ResetParameters();
   }
 
-  if (deterministic != this->deterministic)
+  ResetWorkers(threads);
+
+  // Each worker evaluates a contiguous block of the batch; the objectives of
+  // the blocks are summed in order.
+  arma::vec objectives(threads);
+
+  #pragma omp parallel for num_threads(threads) schedule(static, 1)
+  for (omp_size_t t = 0; t < (omp_size_t) threads; ++t)
   {
-    this->deterministic = deterministic;
-    ResetDeterministic();
+    const size_t block = (size_t) t;
+    const size_t blockBegin = begin + block * batchSize / threads;
+    const size_t blockEnd = begin + (block + 1) * batchSize / threads;
+    objectives[block] = workers[block]->Evaluate(parameters, blockBegin,
+        blockEnd - blockBegin);
   }
 
-  currentInput = predictors.unsafe_col(i);
-  currentTarget = responses.unsafe_col(i);
-
-  Forward(std::move(currentInput));
-  double res = outputLayer.Forward(std::move(boost::apply_visitor(
-      outputParameterVisitor, network.back())), std::move(currentTarget));
+  double res = 0;
+  for (size_t t = 0; t < threads; ++t)
+    res += objectives[t];
 
   return res;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
-    const arma::mat& parameters)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& parameters)
 {
-  double res = 0;
-  for (size_t i = 0; i < predictors.n_cols; ++i)
-    res += Evaluate(parameters, i, true);
+  return Evaluate(parameters, 0, predictors.n_cols);
+}
 
-  return res;
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters, const size_t i, MatType& gradient)
+{
+  Gradient(parameters, i, gradient, 1);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize)
+{
+  EvaluateWithGradient(parameters, begin, gradient, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType,
+           MatType>::EvaluateWithGradient(
+    const MatType& parameters, MatType& gradient)
+{
+  return EvaluateWithGradient(parameters, 0, gradient, predictors.n_cols);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType,
+           MatType>::EvaluateWithGradient(
+    const MatType& parameters, const size_t i, MatType& gradient)
+{
+  return EvaluateWithGradient(parameters, i, gradient, 1);
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Gradient(
-    const arma::mat& parameters, const size_t i, arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType,
+           MatType>::EvaluateWithGradient(
+    const MatType& parameters,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize)
 {
   if (gradient.is_empty())
   {
@@ -253,14 +359,59 @@ void FFN<OutputLayerType, InitializationRuleType>::Gradient(
       ResetParameters();
     }
 
-    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+    gradient = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
   }
   else
   {
     gradient.zeros();
   }
 
-  Evaluate(parameters, i, false);
+  const size_t threads = BatchThreads(batchSize);
+  if (threads > 1)
+  {
+    ResetWorkers(threads);
+
+    // Each worker computes the objective and the gradient of a contiguous
+    // block of the batch.  The blocks only depend on the batch size and the
+    // number of threads, and their results are summed in order, so the result
+    // does not depend on the scheduling of the threads.
+    arma::vec objectives(threads);
+
+    #pragma omp parallel for num_threads(threads) schedule(static, 1)
+    for (omp_size_t t = 0; t < (omp_size_t) threads; ++t)
+    {
+      const size_t block = (size_t) t;
+      const size_t blockBegin = begin + block * batchSize / threads;
+      const size_t blockEnd = begin + (block + 1) * batchSize / threads;
+      objectives[block] = workers[block]->EvaluateWithGradient(parameters,
+          blockBegin, workerGradients[block], blockEnd - blockBegin);
+    }
+
+    double res = 0;
+    for (size_t t = 0; t < threads; ++t)
+    {
+      res += objectives[t];
+      gradient += workerGradients[t];
+    }
+
+    return res;
+  }
+
+  if (batchSize > 1 && !SupportsBatches())
+  {
+    double res = 0;
+    MatType pointGradient;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+    {
+      res += EvaluateWithGradient(parameters, i, pointGradient, 1);
+      gradient += pointGradient;
+    }
+
+    return res;
+  }
+
+  // The forward pass of the gradient also gives the objective.
+  const double res = EvaluateBatch(begin, batchSize, false);
 
   outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
       network.back())), std::move(currentTarget), std::move(error));
@@ -268,42 +419,230 @@ void FFN<OutputLayerType, InitializationRuleType>::Gradient(
   Backward();
   ResetGradients(gradient);
   Gradient();
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType,
+           MatType>::EvaluateWithGradient(
+    const MatType& parameters, const size_t i, SpMatType& gradient)
+{
+  return EvaluateWithGradient(parameters, i, gradient, 1);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType,
+           MatType>::EvaluateWithGradient(
+    const MatType& parameters,
+    const size_t begin,
+    SpMatType& gradient,
+    const size_t batchSize)
+{
+  if (parameter.is_empty())
+  {
+    ResetParameters();
+  }
+
+  if (batchSize > 1 && !SupportsBatches())
+  {
+    double res = 0;
+    SpMatType pointGradient;
+    gradient.zeros(parameter.n_rows, parameter.n_cols);
+    for (size_t i = begin; i < begin + batchSize; ++i)
+    {
+      res += EvaluateWithGradient(parameters, i, pointGradient, 1);
+      gradient += pointGradient;
+    }
+
+    return res;
+  }
+
+  // The forward pass of the gradient also gives the objective.
+  const double res = EvaluateBatch(begin, batchSize, false);
+
+  outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
+      network.back())), std::move(currentTarget), std::move(error));
+
+  Backward();
+  SparseGradient(gradient);
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double FFN<OutputLayerType, InitializationRuleType, MatType>::EvaluateBatch(
+    const size_t begin, const size_t batchSize, const bool deterministic)
+{
+  if (parameter.is_empty())
+  {
+    ResetParameters();
+  }
+
+  if (deterministic != this->deterministic)
+  {
+    this->deterministic = deterministic;
+    ResetDeterministic();
+  }
+
+  if (batchSize > 1 && !SupportsBatches())
+  {
+    double res = 0;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+      res += EvaluateBatch(i, 1, deterministic);
+
+    return res;
+  }
+
+  currentInput = predictors.cols(begin, begin + batchSize - 1);
+  currentTarget = responses.cols(begin, begin + batchSize - 1);
+
+  Forward(std::move(currentInput));
+
+  MatType& output = boost::apply_visitor(outputParameterVisitor,
+      network.back());
+  if (batchSize == 1)
+    return outputLayer.Forward(std::move(output), std::move(currentTarget));
+
+  // The output layer is evaluated for each point on its own, so that the
+  // objective of the batch is the sum of the objectives of its points for
+  // every output layer (MeanSquaredError, for instance, averages over all
+  // columns it is given).
+  double res = 0;
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    res += outputLayer.Forward(std::move(MatType(output.colptr(i),
+        output.n_rows, 1, false, true)), std::move(MatType(
+        currentTarget.colptr(i), currentTarget.n_rows, 1, false, true)));
+  }
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+bool FFN<OutputLayerType, InitializationRuleType, MatType>::SupportsBatches()
+{
+  if (!reset)
+    EvaluateBatch(0, 1, deterministic);
+
+  // Only layers that work on images report an output width or height.
+  return (width == 0 && height == 0);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+size_t FFN<OutputLayerType, InitializationRuleType, MatType>::BatchThreads(
+    const size_t batchSize) const
+{
+  const size_t threads = ParallelThreads(numThreads);
+
+  return std::min(threads, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetWorkers(
+    const size_t threads)
+{
+  // The workers can be reused as long as the network, its parameters and its
+  // data have not changed.
+  if (workers.size() == threads &&
+      workers[0]->network.size() == network.size() &&
+      workers[0]->parameter.memptr() == parameter.memptr() &&
+      workers[0]->parameter.n_elem == parameter.n_elem &&
+      workers[0]->predictors.memptr() == predictors.memptr() &&
+      workers[0]->predictors.n_cols == predictors.n_cols &&
+      workers[0]->responses.memptr() == responses.memptr())
+  {
+    for (size_t t = 0; t < threads; ++t)
+      workers[t]->activationAccuracy = activationAccuracy;
+    return;
+  }
+
+  workers.clear();
+  workerGradients.clear();
+  workerGradients.resize(threads);
+
+  for (size_t t = 0; t < threads; ++t)
+  {
+    std::unique_ptr<FFN> worker(new FFN(outputLayer, initializeRule));
+    for (size_t i = 0; i < network.size(); ++i)
+    {
+      worker->network.push_back(boost::apply_visitor(copyVisitor,
+          network[i]));
+    }
+
+    // The aliases are not strict, so the workers keep pointing to the memory
+    // of this network when the aliases are moved into them.
+    worker->parameter = MatType(parameter.memptr(), parameter.n_rows,
+        parameter.n_cols, false, false);
+    worker->predictors = MatType(predictors.memptr(), predictors.n_rows,
+        predictors.n_cols, false, false);
+    worker->responses = MatType(responses.memptr(), responses.n_rows,
+        responses.n_cols, false, false);
+    worker->numFunctions = numFunctions;
+    worker->activationAccuracy = activationAccuracy;
+
+    size_t offset = 0;
+    for (size_t i = 0; i < worker->network.size(); ++i)
+    {
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+          worker->parameter), offset), worker->network[i]);
+
+      boost::apply_visitor(resetVisitor, worker->network[i]);
+    }
+
+    worker->ResetDeterministic();
+    workers.push_back(std::move(worker));
+  }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetParameters()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetParameters()
 {
   ResetDeterministic();
 
   // Reset the network parameter with the given initialization rule.
-  NetworkInitialization<InitializationRuleType> networkInit(initializeRule);
+  NetworkInitialization<InitializationRuleType, MatType>
+      networkInit(initializeRule);
   networkInit.Initialize(network, parameter);
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetDeterministic()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetDeterministic()
 {
   DeterministicSetVisitor deterministicSetVisitor(deterministic);
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deterministicSetVisitor));
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::ResetGradients(
-    arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::ResetGradients(
+    MatType& gradient)
 {
   size_t offset = 0;
   for (size_t i = 0; i < network.size(); ++i)
   {
-    offset += boost::apply_visitor(GradientSetVisitor(std::move(gradient),
-        offset), network[i]);
+    offset += boost::apply_visitor(GradientSetVisitor<MatType>(std::move(
+        gradient), offset), network[i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType,
+         MatType>::Forward(MatType&& input)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
+  ActivationAccuracyScope accuracyScope(activationAccuracy);
+
+  boost::apply_visitor(ForwardVisitor<MatType>(std::move(input), std::move(
       boost::apply_visitor(outputParameterVisitor, network.front()))),
       network.front());
 
@@ -331,7 +670,7 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
       boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
     }
 
-    boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
+    boost::apply_visitor(ForwardVisitor<MatType>(std::move(boost::apply_visitor(
         outputParameterVisitor, network[i - 1])), std::move(
         boost::apply_visitor(outputParameterVisitor, network[i]))), network[i]);
 
@@ -357,44 +696,101 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Backward()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
+  boost::apply_visitor(BackwardVisitor<MatType>(std::move(boost::apply_visitor(
       outputParameterVisitor, network.back())), std::move(error), std::move(
       boost::apply_visitor(deltaVisitor, network.back()))), network.back());
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[network.size() - i])), std::move(
-        boost::apply_visitor(deltaVisitor, network[network.size() - i + 1])),
-        std::move(boost::apply_visitor(deltaVisitor,
-        network[network.size() - i]))), network[network.size() - i]);
+    boost::apply_visitor(BackwardVisitor<MatType>(std::move(
+        boost::apply_visitor(outputParameterVisitor,
+        network[network.size() - i])), std::move(boost::apply_visitor(
+        deltaVisitor, network[network.size() - i + 1])), std::move(
+        boost::apply_visitor(deltaVisitor, network[network.size() - i]))),
+        network[network.size() - i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Gradient()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Gradient()
 {
-  boost::apply_visitor(GradientVisitor(std::move(currentInput), std::move(
-      boost::apply_visitor(deltaVisitor, network[1]))), network.front());
+  boost::apply_visitor(GradientVisitor<MatType>(std::move(currentInput),
+      std::move(boost::apply_visitor(deltaVisitor, network[1]))),
+      network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i - 1])), std::move(
-        boost::apply_visitor(deltaVisitor, network[i + 1]))), network[i]);
+    boost::apply_visitor(GradientVisitor<MatType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, network[i - 1])),
+        std::move(boost::apply_visitor(deltaVisitor, network[i + 1]))),
+        network[i]);
   }
 
-  boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
+  boost::apply_visitor(GradientVisitor<MatType>(std::move(boost::apply_visitor(
       outputParameterVisitor, network[network.size() - 2])), std::move(error)),
       network[network.size() - 1]);
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::SparseGradient(
+    SpMatType& gradient)
+{
+  // The layers without a sparse gradient write theirs into the workspace.
+  // They overwrite all of it, so it is never cleared, and the parts of the
+  // layers with a sparse gradient are never touched.
+  if (sparseWorkspace.n_rows != parameter.n_rows ||
+      sparseWorkspace.n_cols != parameter.n_cols)
+  {
+    sparseWorkspace.zeros(parameter.n_rows, parameter.n_cols);
+  }
+
+  // The layers are visited in the order of their parameters, so the indices
+  // of the nonzero elements are sorted.
+  std::vector<arma::uword> rows;
+  std::vector<typename MatType::elem_type> values;
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    const size_t size = boost::apply_visitor(GradientSetVisitor<MatType>(
+        std::move(sparseWorkspace), offset), network[i]);
+
+    MatType& input = (i == 0) ? currentInput :
+        boost::apply_visitor(outputParameterVisitor, network[i - 1]);
+    MatType& delta = (i == network.size() - 1) ? error :
+        boost::apply_visitor(deltaVisitor, network[i + 1]);
+
+    if (!boost::apply_visitor(SparseGradientVisitor<MatType>(std::move(input),
+        std::move(delta), offset, rows, values), network[i]))
+    {
+      for (size_t j = offset; j < offset + size; ++j)
+      {
+        rows.push_back(j);
+        values.push_back(sparseWorkspace[j]);
+      }
+    }
+
+    offset += size;
+  }
+
+  arma::umat locations(2, rows.size(), arma::fill::zeros);
+  for (size_t j = 0; j < rows.size(); ++j)
+    locations(0, j) = rows[j];
+
+  gradient = SpMatType(locations,
+      arma::Col<typename MatType::elem_type>(values), parameter.n_rows,
+      parameter.n_cols, false, false);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename Archive>
-void FFN<OutputLayerType, InitializationRuleType>::Serialize(
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Serialize(
     Archive& ar, const unsigned int /* version */)
 {
   ar & data::CreateNVP(parameter, "parameter");
@@ -421,8 +817,8 @@ void FFN<OutputLayerType, InitializationRuleType>::Serialize(
     size_t offset = 0;
     for (size_t i = 0; i < network.size(); ++i)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
-          offset), network[i]);
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+          parameter), offset), network[i]);
 
       boost::apply_visitor(resetVisitor, network[i]);
     }
@@ -432,8 +828,9 @@ void FFN<OutputLayerType, InitializationRuleType>::Serialize(
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void FFN<OutputLayerType, InitializationRuleType, MatType>::Swap(FFN& network)
 {
   std::swap(outputLayer, network.outputLayer);
   std::swap(initializeRule, network.initializeRule);
@@ -453,10 +850,15 @@ void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(numThreads, network.numThreads);
+  std::swap(activationAccuracy, network.activationAccuracy);
+  std::swap(workers, network.workers);
+  std::swap(workerGradients, network.workerGradients);
 };
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
     const FFN& network):
     outputLayer(network.outputLayer),
     initializeRule(network.initializeRule),
@@ -474,7 +876,9 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    numThreads(network.numThreads),
+    activationAccuracy(network.activationAccuracy)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -484,8 +888,9 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
   }
 };
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>::FFN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>::FFN(
     FFN&& network):
     outputLayer(std::move(network.outputLayer)),
     initializeRule(std::move(network.initializeRule)),
@@ -503,14 +908,17 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    numThreads(network.numThreads),
+    activationAccuracy(network.activationAccuracy)
 {
   this->network = std::move(network.network);
 };
 
-template<typename OutputLayerType, typename InitializationRuleType>
-FFN<OutputLayerType, InitializationRuleType>&
-FFN<OutputLayerType, InitializationRuleType>::operator = (FFN network)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+FFN<OutputLayerType, InitializationRuleType, MatType>&
+FFN<OutputLayerType, InitializationRuleType, MatType>::operator = (FFN network)
 {
   Swap(network);
   return *this;
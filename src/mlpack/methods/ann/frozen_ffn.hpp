@@ -0,0 +1,176 @@
+/**
+ * @file frozen_ffn.hpp
+ *
+ * Definition of the FrozenFFN class, a compact inference-only copy of a trained
+ * feed forward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_FROZEN_FFN_HPP
+#define MLPACK_METHODS_ANN_FROZEN_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A trained feed forward network, frozen for prediction.  The layers of the
+ * network are fused into a short list of stages; each stage computes
+ *
+ * @code
+ * output = f(W * (s * input) + b)
+ * @endcode
+ *
+ * with a weight matrix W, a bias b and a scale s (each of which may be absent)
+ * and an elementwise activation function f.  A Linear or LinearNoBias layer
+ * and the activation layer after it form one stage, and Dropout layers are
+ * folded into the weights of a neighbouring stage.  Because no backward pass is
+ * needed, the frozen network keeps no gradients, deltas or per-layer
+ * activations; Predict() only uses two buffers that are reused between calls.
+ *
+ * Only the layers that can be fused this way are supported: Linear,
+ * LinearNoBias, Dropout, LogSoftMax and the identity, rectifier, sigmoid and
+ * tanh activation layers.  A frozen network can be saved with data::Save() and
+ * loaded by a process that only serves predictions.
+ *
+ * The activation functions have the accuracy of the network that was frozen
+ * (see FFN::ActivationMode()), which can be changed with ActivationMode().
+ * With an approximation, the bias of a logistic or tanh stage is added while
+ * the activation function is applied, in one pass over the output.
+ *
+ * @code
+ * FFN<NegativeLogLikelihood<> > model;
+ * // ... add layers and train the model ...
+ *
+ * FrozenFFN frozen(model);
+ * data::Save("frozen.xml", "frozen", frozen);
+ *
+ * arma::mat predictions;
+ * frozen.Predict(testData, predictions);
+ * @endcode
+ */
+class FrozenFFN
+{
+ public:
+  //! The elementwise activation functions a stage can apply.
+  enum ActivationType
+  {
+    IDENTITY,
+    RECTIFIER,
+    LOGISTIC,
+    TANH,
+    LOG_SOFTMAX
+  };
+
+  /**
+   * Create an empty frozen network, which returns its input unchanged.  This is
+   * mostly useful before loading a frozen network with data::Load().
+   */
+  FrozenFFN();
+
+  /**
+   * Freeze the given trained network.  If the parameters of the network have
+   * not been initialized yet, they are initialized first.  The frozen network
+   * uses the same accuracy of the activation functions.  A
+   * std::invalid_argument exception is thrown if the network contains a layer
+   * that cannot be frozen.
+   *
+   * @param network The network to freeze.
+   */
+  template<typename OutputLayerType, typename InitializationRuleType>
+  FrozenFFN(FFN<OutputLayerType, InitializationRuleType>& network);
+
+  /**
+   * Predict the responses to the given data points.  The results are the same
+   * as the results of FFN::Predict() of the network that was frozen.
+   *
+   * @param predictors Input data points (one per column).
+   * @param results Matrix to store the predicted responses in.
+   */
+  void Predict(const arma::mat& predictors, arma::mat& results);
+
+  //! Get the number of stages.
+  size_t Stages() const { return weights.size(); }
+
+  //! Get the weight matrix of the given stage (empty if there is none).
+  const arma::mat& Weight(const size_t stage) const { return weights[stage]; }
+  //! Get the bias of the given stage (empty if there is none).
+  const arma::vec& Bias(const size_t stage) const { return biases[stage]; }
+  //! Get the input scale of the given stage.
+  double Scale(const size_t stage) const { return scales[stage]; }
+  //! Get the activation function of the given stage.
+  ActivationType Activation(const size_t stage) const
+  {
+    return activations[stage];
+  }
+
+  //! Get the accuracy of the activation functions.
+  ActivationAccuracy ActivationMode() const { return activationAccuracy; }
+  //! Modify the accuracy of the activation functions (this is not
+  //! serialized).
+  ActivationAccuracy& ActivationMode() { return activationAccuracy; }
+
+  //! Serialize the frozen network.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  // The visitor that freezes the layers of a network adds the stages.
+  friend class FreezeVisitor;
+
+  //! Add a stage with the given weight matrix and bias (which may be empty).
+  void AddLinear(const arma::mat& weight, const arma::vec& bias);
+
+  //! Apply the given activation function to the output of the last stage.
+  void AddActivation(const ActivationType activation);
+
+  //! Scale the output of the last stage (or the input of the next one) by the
+  //! given factor.
+  void AddScale(const double scale);
+
+  //! Add the scale that could not be folded into a stage, if any.
+  void Finish();
+
+  //! Apply the given activation function to the given matrix, in place.
+  void Activate(const ActivationType activation, arma::mat& output);
+
+  //! The weight matrix of each stage.
+  std::vector<arma::mat> weights;
+
+  //! The bias of each stage.
+  std::vector<arma::vec> biases;
+
+  //! The input scale of each stage.
+  std::vector<double> scales;
+
+  //! The activation function of each stage.
+  std::vector<ActivationType> activations;
+
+  //! The scale that is still to be applied to the input of the next stage,
+  //! while the network is being frozen.
+  double pendingScale;
+
+  //! The accuracy of the activation functions.
+  ActivationAccuracy activationAccuracy;
+
+  //! The buffers of the intermediate results of Predict().
+  arma::mat buffers[2];
+
+  //! The buffer of the input of activation functions that cannot be applied
+  //! in place.
+  arma::mat activationInput;
+}; // class FrozenFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "frozen_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,230 @@
+/**
+ * @file frozen_ffn_impl.hpp
+ *
+ * Implementation of the FrozenFFN class, a compact inference-only copy of a
+ * trained feed forward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_FROZEN_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_FROZEN_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "frozen_ffn.hpp"
+
+#include "visitor/freeze_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline FrozenFFN::FrozenFFN() :
+    pendingScale(1.0),
+    activationAccuracy(EXACT_ACTIVATIONS)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+FrozenFFN::FrozenFFN(FFN<OutputLayerType, InitializationRuleType>& network) :
+    pendingScale(1.0),
+    activationAccuracy(network.ActivationMode())
+{
+  if (network.Parameters().is_empty())
+    network.ResetParameters();
+
+  for (size_t i = 0; i < network.Model().size(); ++i)
+    boost::apply_visitor(FreezeVisitor(*this), network.Model()[i]);
+
+  Finish();
+}
+
+inline void FrozenFFN::Predict(const arma::mat& predictors, arma::mat& results)
+{
+  if (weights.empty())
+  {
+    results = predictors;
+    return;
+  }
+
+  ActivationAccuracyScope accuracyScope(activationAccuracy);
+
+  const arma::mat* input = &predictors;
+  for (size_t i = 0; i < weights.size(); ++i)
+  {
+    // The last stage writes straight into the results; the others alternate
+    // between the two buffers.
+    arma::mat& output = (i == weights.size() - 1) ? results : buffers[i % 2];
+
+    if (weights[i].is_empty())
+    {
+      output = scales[i] * (*input);
+    }
+    else
+    {
+      if (weights[i].n_cols != input->n_rows)
+      {
+        std::ostringstream oss;
+        oss << "FrozenFFN::Predict(): stage " << i << " expects "
+            << weights[i].n_cols << "-dimensional input, but got "
+            << input->n_rows << " dimensions";
+        throw std::invalid_argument(oss.str());
+      }
+
+      output = weights[i] * (*input);
+    }
+
+    const bool fuse = (activationAccuracy != EXACT_ACTIVATIONS) &&
+        !biases[i].is_empty() &&
+        (activations[i] == LOGISTIC || activations[i] == TANH);
+    if (fuse && activations[i] == LOGISTIC)
+    {
+      FastActivation<FastLogistic>(output, output, activationAccuracy,
+          &biases[i]);
+    }
+    else if (fuse)
+    {
+      FastActivation<FastTanh>(output, output, activationAccuracy,
+          &biases[i]);
+    }
+    else
+    {
+      if (!biases[i].is_empty())
+        output.each_col() += biases[i];
+
+      Activate(activations[i], output);
+    }
+
+    input = &output;
+  }
+}
+
+inline void FrozenFFN::AddLinear(const arma::mat& weight,
+                                 const arma::vec& bias)
+{
+  weights.push_back(pendingScale * weight);
+  biases.push_back(bias);
+  scales.push_back(1.0);
+  activations.push_back(IDENTITY);
+
+  pendingScale = 1.0;
+}
+
+inline void FrozenFFN::AddActivation(const ActivationType activation)
+{
+  // Fuse the activation with the last stage, if that one does not have an
+  // activation yet.
+  if (!activations.empty() && activations.back() == IDENTITY &&
+      pendingScale == 1.0)
+  {
+    activations.back() = activation;
+    return;
+  }
+
+  weights.push_back(arma::mat());
+  biases.push_back(arma::vec());
+  scales.push_back(pendingScale);
+  activations.push_back(activation);
+
+  pendingScale = 1.0;
+}
+
+inline void FrozenFFN::AddScale(const double scale)
+{
+  if (scale == 1.0)
+    return;
+
+  // If the last stage is linear, scale its output: f(s * (W * x + b)) is
+  // f((s * W) * x + s * b).  Otherwise the scale goes into the input of the
+  // next stage.
+  if (!activations.empty() && activations.back() == IDENTITY &&
+      pendingScale == 1.0)
+  {
+    if (weights.back().is_empty())
+      scales.back() *= scale;
+    else
+      weights.back() *= scale;
+
+    biases.back() *= scale;
+  }
+  else
+  {
+    pendingScale *= scale;
+  }
+}
+
+inline void FrozenFFN::Finish()
+{
+  if (pendingScale != 1.0)
+  {
+    weights.push_back(arma::mat());
+    biases.push_back(arma::vec());
+    scales.push_back(pendingScale);
+    activations.push_back(IDENTITY);
+
+    pendingScale = 1.0;
+  }
+}
+
+inline void FrozenFFN::Activate(const ActivationType activation,
+                                arma::mat& output)
+{
+  switch (activation)
+  {
+    case IDENTITY:
+      break;
+    case RECTIFIER:
+      output.transform([](const double x) { return std::max(0.0, x); });
+      break;
+    case LOGISTIC:
+      LogisticFunction::Fn(output, output);
+      break;
+    case TANH:
+      TanhFunction::Fn(output, output);
+      break;
+    case LOG_SOFTMAX:
+      // Use the layer itself, so that the results match the network exactly.
+      activationInput.swap(output);
+      LogSoftMax<arma::mat, arma::mat>().Forward(std::move(activationInput),
+          std::move(output));
+      break;
+  }
+}
+
+template<typename Archive>
+void FrozenFFN::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  size_t stages = weights.size();
+  ar & data::CreateNVP(stages, "stages");
+
+  // If we are loading, we must resize the stages correctly.
+  if (Archive::is_loading::value)
+  {
+    weights.resize(stages);
+    biases.resize(stages);
+    scales.resize(stages);
+    activations.resize(stages);
+    pendingScale = 1.0;
+  }
+
+  // Serialize each stage; generate the correct names for each one.
+  for (size_t i = 0; i < stages; ++i)
+  {
+    std::ostringstream oss;
+    oss << i;
+
+    size_t activation = (size_t) activations[i];
+    ar & data::CreateNVP(weights[i], "weight" + oss.str());
+    ar & data::CreateNVP(biases[i], "bias" + oss.str());
+    ar & data::CreateNVP(scales[i], "scale" + oss.str());
+    ar & data::CreateNVP(activation, "activation" + oss.str());
+    activations[i] = (ActivationType) activation;
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
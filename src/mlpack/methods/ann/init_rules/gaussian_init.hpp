@@ -47,13 +47,14 @@ class GaussianInitialization
    * @param rows Number of rows.
    * @param cols Number of columns.
    */
-  void Initialize(arma::mat& W,
+  template<typename eT>
+  void Initialize(arma::Mat<eT>& W,
                   const size_t rows,
                   const size_t cols)
   {
     if (W.is_empty())
     {
-      W = arma::mat(rows, cols);
+      W = arma::Mat<eT>(rows, cols);
     }
     W.imbue( [&]() { return arma::as_scalar(RandNormal(mean, variance)); } );
   }
@@ -66,12 +67,13 @@ class GaussianInitialization
    * @param cols Number of columns.
    * @param slice Numbers of slices.
    */
-  void Initialize(arma::cube & W,
+  template<typename eT>
+  void Initialize(arma::Cube<eT>& W,
                   const size_t rows,
                   const size_t cols,
                   const size_t slices)
   {
-    W = arma::cube(rows, cols, slices);
+    W = arma::Cube<eT>(rows, cols, slices);
 
     for (size_t i = 0; i < slices; i++)
       Initialize(W.slice(i), rows, cols);
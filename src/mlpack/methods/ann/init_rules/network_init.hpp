@@ -29,7 +29,7 @@ namespace ann /** Artificial Neural Network. */ {
  * This class is used to initialize the network with the given initialization
  * rule.
  */
-template<typename InitializationRuleType>
+template<typename InitializationRuleType, typename MatType = arma::mat>
 class NetworkInitialization
 {
  public:
@@ -52,7 +52,8 @@ class NetworkInitialization
    * @param network Network that should be initialized.
    * @param parameter The network parameter.
    */
-  void Initialize(const std::vector<LayerTypes>& network, arma::mat& parameter)
+  void Initialize(const std::vector<LayerTypes<MatType>>& network,
+                  MatType& parameter)
   {
     // Determine the number of parameter/weights of the given network.
     size_t weights = 0;
@@ -69,7 +70,7 @@ class NetworkInitialization
         // initialization rule.
         const size_t weight = boost::apply_visitor(weightSizeVisitor,
             network[i]);
-        arma::mat tmp = arma::mat(parameter.memptr() + offset,
+        MatType tmp = MatType(parameter.memptr() + offset,
             weight, 1, false, false);
         initializeRule.Initialize(tmp, tmp.n_elem, 1);
 
@@ -88,8 +89,8 @@ class NetworkInitialization
     // hold various other modules.
     for (size_t i = 0, offset = 0; i < network.size(); ++i)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
-          offset), network[i]);
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(
+          std::move(parameter), offset), network[i]);
 
       boost::apply_visitor(resetVisitor, network[i]);
     }
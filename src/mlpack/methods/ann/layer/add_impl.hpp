@@ -52,7 +52,7 @@ void Add<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient = error;
+  gradient = arma::sum(error, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -46,8 +46,8 @@ void Concat<InputDataType, OutputDataType>::Forward(
 
   for (size_t i = 0; i < network.size(); ++i)
   {
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-        boost::apply_visitor(outputParameterVisitor, network[i]))),
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(outputParameterVisitor, network[i]))),
         network[i]);
 
     if (boost::apply_visitor(
@@ -58,7 +58,7 @@ void Concat<InputDataType, OutputDataType>::Forward(
     }
   }
 
-  output = arma::zeros(outSize, network.size());
+  output = arma::zeros<arma::Mat<eT> >(outSize, network.size());
   for (size_t i = 0; i < network.size(); ++i)
   {
     size_t elements = boost::apply_visitor(outputParameterVisitor,
@@ -90,7 +90,7 @@ void Concat<InputDataType, OutputDataType>::Backward(
     elements = boost::apply_visitor(outputParameterVisitor,
         network[i]).n_elem;
 
-    arma::mat delta;
+    OutputDataType delta;
     if (gy.n_cols == 1)
     {
       delta = gy.submat(j, 0, j + elements - 1, 0);
@@ -100,8 +100,9 @@ void Concat<InputDataType, OutputDataType>::Backward(
       delta = gy.submat(0, i, elements - 1, i);
     }
 
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i])), std::move(delta), std::move(
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(
+        std::move(boost::apply_visitor(outputParameterVisitor, network[i])),
+        std::move(delta), std::move(
         boost::apply_visitor(deltaVisitor, network[i]))), network[i]);
 
     if (boost::apply_visitor(deltaVisitor, network[i]).n_elem > outSize)
@@ -124,7 +125,7 @@ void Concat<InputDataType, OutputDataType>::Backward(
 
   if (!same)
   {
-    g = arma::zeros(outSize, network.size());
+    g = arma::zeros<arma::Mat<eT> >(outSize, network.size());
     for (size_t i = 0; i < network.size(); ++i)
     {
       size_t elements = boost::apply_visitor(deltaVisitor, network[i]).n_elem;
@@ -151,7 +152,7 @@ void Concat<InputDataType, OutputDataType>::Gradient(
 {
   for (size_t i = 0; i < network.size(); ++i)
   {
-    boost::apply_visitor(GradientVisitor(std::move(input),
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
         std::move(error)), network[i]);
   }
 }
@@ -51,7 +51,7 @@ double ConcatPerformance<
   double output = 0;
   for (size_t i = 0; i < input.n_elem; i+= elements)
   {
-    arma::mat subInput = input.submat(i, 0, i + elements - 1, 0);
+    arma::Mat<eT> subInput = input.submat(i, 0, i + elements - 1, 0);
     output += outputLayer.Forward(std::move(subInput), std::move(target));
   }
 
@@ -75,13 +75,13 @@ void ConcatPerformance<
 {
   const size_t elements = input.n_elem / inSize;
 
-  arma::mat subInput = input.submat(0, 0, elements - 1, 0);
-  arma::mat subOutput;
+  arma::Mat<eT> subInput = input.submat(0, 0, elements - 1, 0);
+  arma::Mat<eT> subOutput;
 
   outputLayer.Backward(std::move(subInput), std::move(target),
       std::move(subOutput));
 
-  output = arma::zeros(subOutput.n_elem, inSize);
+  output = arma::zeros<arma::Mat<eT> >(subOutput.n_elem, inSize);
   output.col(0) = subOutput;
 
   for (size_t i = elements, j = 0; i < input.n_elem; i+= elements, j++)
@@ -18,6 +18,8 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/layer_convolution.hpp>
 
 #include "layer_types.hpp"
 
@@ -28,6 +30,12 @@ namespace ann /** Artificial Neural Network. */ {
  * Implementation of the Convolution class. The Convolution class represents a
  * single layer of a neural network.
  *
+ * The convolutions of all maps with all kernels are performed by
+ * LayerConvolution.  With Im2ColConvolution as the convolution rules, each of
+ * the forward pass, the backward pass and the gradient computation is a single
+ * matrix product per input point, which is much faster than the per-map
+ * convolutions of the other rules for all but the smallest layers.
+ *
  * @tparam ForwardConvolutionRule Convolution to perform forward process.
  * @tparam BackwardConvolutionRule Convolution to perform backward process.
  * @tparam GradientConvolutionRule Convolution to calculate gradient.
@@ -141,6 +149,26 @@ class Convolution
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get the number of input maps.
+  size_t InputSize() const { return inSize; }
+  //! Get the number of output maps.
+  size_t OutputSize() const { return outSize; }
+
+  //! Get the width of the filters.
+  size_t KernelWidth() const { return kW; }
+  //! Get the height of the filters.
+  size_t KernelHeight() const { return kH; }
+
+  //! Get the stride of the filters in the x direction.
+  size_t StrideWidth() const { return dW; }
+  //! Get the stride of the filters in the y direction.
+  size_t StrideHeight() const { return dH; }
+
+  //! Get the padding width.
+  size_t PadWidth() const { return padW; }
+  //! Get the padding height.
+  size_t PadHeight() const { return padH; }
+
   //! Get the input width.
   size_t const& InputWidth() const { return inputWidth; }
   //! Modify input the width.
@@ -185,35 +213,6 @@ class Convolution
     return std::floor(size + p * 2 - k) / s + 1;
   }
 
-  /*
-   * Rotates a 3rd-order tensor counterclockwise by 180 degrees.
-   *
-   * @param input The input data to be rotated.
-   * @param output The rotated output.
-   */
-  template<typename eT>
-  void Rotate180(const arma::Cube<eT>& input, arma::Cube<eT>& output)
-  {
-    output = arma::Cube<eT>(input.n_rows, input.n_cols, input.n_slices);
-
-    // * left-right flip, up-down flip */
-    for (size_t s = 0; s < output.n_slices; s++)
-      output.slice(s) = arma::fliplr(arma::flipud(input.slice(s)));
-  }
-
-  /*
-   * Rotates a dense matrix counterclockwise by 180 degrees.
-   *
-   * @param input The input data to be rotated.
-   * @param output The rotated output.
-   */
-  template<typename eT>
-  void Rotate180(const arma::Mat<eT>& input, arma::Mat<eT>& output)
-  {
-    // * left-right flip, up-down flip */
-    output = arma::fliplr(arma::flipud(input));
-  }
-
   /*
    * Pad the given input data.
    *
@@ -231,7 +230,8 @@ class Convolution
     if (output.n_rows != input.n_rows + wPad * 2 ||
         output.n_cols != input.n_cols + hPad * 2)
     {
-      output = arma::zeros(input.n_rows + wPad * 2, input.n_cols + hPad * 2);
+      output = arma::zeros<arma::Mat<eT> >(input.n_rows + wPad * 2,
+          input.n_cols + hPad * 2);
     }
 
     output.submat(wPad, hPad, wPad + input.n_rows - 1,
@@ -252,12 +252,12 @@ class Convolution
            size_t hPad,
            arma::Cube<eT>& output)
   {
-    output = arma::zeros(input.n_rows + wPad * 2,
+    output = arma::zeros<arma::Cube<eT> >(input.n_rows + wPad * 2,
         input.n_cols + hPad * 2, input.n_slices);
 
     for (size_t i = 0; i < input.n_slices; ++i)
     {
-      Pad<double>(input.slice(i), wPad, hPad, output.slice(i));
+      Pad<eT>(input.slice(i), wPad, hPad, output.slice(i));
     }
   }
 
@@ -288,11 +288,14 @@ class Convolution
   //! Locally-stored weight object.
   OutputDataType weights;
 
+  //! The type of the input, output and weight maps.
+  typedef arma::Cube<typename OutputDataType::elem_type> CubeType;
+
   //! Locally-stored weight object.
-  arma::cube weight;
+  CubeType weight;
 
   //! Locally-stored bias term object.
-  arma::mat bias;
+  OutputDataType bias;
 
   //! Locally-stored input width.
   size_t inputWidth;
@@ -307,19 +310,19 @@ class Convolution
   size_t outputHeight;
 
   //! Locally-stored transformed output parameter.
-  arma::cube outputTemp;
+  CubeType outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  CubeType inputTemp;
 
   //! Locally-stored transformed padded input parameter.
-  arma::cube inputPaddedTemp;
+  CubeType inputPaddedTemp;
 
   //! Locally-stored transformed error parameter.
-  arma::cube gTemp;
+  CubeType gTemp;
 
   //! Locally-stored transformed gradient parameter.
-  arma::cube gradientTemp;
+  CubeType gradientTemp;
 
   //! Locally-stored delta object.
   OutputDataType delta;
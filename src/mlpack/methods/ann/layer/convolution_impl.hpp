@@ -91,9 +91,9 @@ void Convolution<
     OutputDataType
 >::Reset()
 {
-    weight = arma::cube(weights.memptr(), kW, kH,
+    weight = CubeType(weights.memptr(), kW, kH,
         outSize * inSize, false, false);
-    bias = arma::mat(weights.memptr() + weight.n_elem,
+    bias = OutputDataType(weights.memptr() + weight.n_elem,
         outSize, 1, false, false);
 }
 
@@ -113,7 +113,10 @@ void Convolution<
     OutputDataType
 >::Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, inSize);
+  // The input and the results are copied into the existing buffers, so no
+  // memory is allocated once the buffers have the right size.
+  inputTemp = arma::Cube<eT>(const_cast<eT*>(input.memptr()), inputWidth,
+      inputHeight, inSize, false, true);
 
   if (padW != 0 || padH != 0)
   {
@@ -125,30 +128,22 @@ void Convolution<
 
   outputTemp = arma::zeros<arma::Cube<eT> >(wConv, hConv, outSize);
 
-  for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
+  if (padW != 0 || padH != 0)
   {
-    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
-    {
-      arma::Mat<eT> convOutput;
-
-      if (padW != 0 || padH != 0)
-      {
-        ForwardConvolutionRule::Convolution(inputPaddedTemp.slice(inMap),
-            weight.slice(outMapIdx), convOutput, dW, dH);
-      }
-      else
-      {
-        ForwardConvolutionRule::Convolution(inputTemp.slice(inMap),
-            weight.slice(outMapIdx), convOutput, dW, dH);
-      }
-
-      outputTemp.slice(outMap) += convOutput;
-    }
+    LayerConvolution<ForwardConvolutionRule>::Forward(inputPaddedTemp, weight,
+        outputTemp, dW, dH);
+  }
+  else
+  {
+    LayerConvolution<ForwardConvolutionRule>::Forward(inputTemp, weight,
+        outputTemp, dW, dH);
+  }
 
+  for (size_t outMap = 0; outMap < outSize; outMap++)
     outputTemp.slice(outMap) += bias(outMap);
-  }
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1, false,
+      true);
 
   outputWidth = outputTemp.n_rows;
   outputHeight = outputTemp.n_cols;
@@ -171,37 +166,15 @@ void Convolution<
 >::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(),
-        outputWidth, outputHeight, outSize);
+  const arma::Cube<eT> mappedError(gy.memptr(), outputWidth, outputHeight,
+      outSize, false, true);
   gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
-  for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
-  {
-    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
-    {
-      arma::Mat<eT> rotatedFilter;
-      Rotate180(weight.slice(outMapIdx), rotatedFilter);
-
-      arma::Mat<eT> output;
-      BackwardConvolutionRule::Convolution(mappedError.slice(outMap),
-          rotatedFilter, output, dW, dH);
+  LayerConvolution<BackwardConvolutionRule>::Backward(mappedError, weight,
+      gTemp, dW, dH, padW, padH);
 
-      if (padW != 0 || padH != 0)
-      {
-        gTemp.slice(inMap) += output.submat(rotatedFilter.n_rows / 2,
-            rotatedFilter.n_cols / 2,
-            rotatedFilter.n_rows / 2 + gTemp.n_rows - 1,
-            rotatedFilter.n_cols / 2 + gTemp.n_cols - 1);
-      }
-      else
-      {
-        gTemp.slice(inMap) += output;
-      }
-    }
-  }
-
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1, false, true);
 }
 
 template<
@@ -223,65 +196,25 @@ void Convolution<
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  arma::cube mappedError;
-  if (padW != 0 && padH != 0)
+  const arma::Cube<eT> mappedError(error.memptr(), outputWidth, outputHeight,
+      outSize, false, true);
+
+  gradientTemp = arma::zeros<arma::Cube<eT> >(weight.n_rows, weight.n_cols,
+      weight.n_slices);
+
+  if (padW != 0 || padH != 0)
   {
-    mappedError = arma::cube(error.memptr(), outputWidth / padW,
-        outputHeight / padH, outSize);
+    LayerConvolution<GradientConvolutionRule>::Gradient(inputPaddedTemp,
+        mappedError, gradientTemp, dW, dH);
   }
   else
   {
-    mappedError = arma::cube(error.memptr(), outputWidth,
-        outputHeight, outSize);
+    LayerConvolution<GradientConvolutionRule>::Gradient(inputTemp,
+        mappedError, gradientTemp, dW, dH);
   }
 
-  gradientTemp = arma::zeros<arma::Cube<eT> >(weight.n_rows, weight.n_cols,
-      weight.n_slices);
-
-  for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
+  for (size_t outMap = 0; outMap < outSize; outMap++)
   {
-    for (size_t inMap = 0, s = outMap; inMap < inSize; inMap++, outMapIdx++,
-        s += outSize)
-    {
-      arma::Cube<eT> inputSlices;
-      if (padW != 0 || padH != 0)
-      {
-        inputSlices = inputPaddedTemp.slices(inMap, inMap);
-      }
-      else
-      {
-        inputSlices = inputTemp.slices(inMap, inMap);
-      }
-
-      arma::Cube<eT> deltaSlices = mappedError.slices(outMap, outMap);
-
-      arma::Cube<eT> output;
-      GradientConvolutionRule::Convolution(inputSlices, deltaSlices,
-          output, dW, dH);
-
-      if ((padW != 0 || padH != 0) &&
-          (gradientTemp.n_rows < output.n_rows &&
-          gradientTemp.n_cols < output.n_cols))
-      {
-        for (size_t i = 0; i < output.n_slices; i++)
-        {
-          arma::mat subOutput = output.slice(i);
-
-          gradientTemp.slice(s) += subOutput.submat(subOutput.n_rows / 2,
-              subOutput.n_cols / 2,
-              subOutput.n_rows / 2 + gradientTemp.n_rows - 1,
-              subOutput.n_cols / 2 + gradientTemp.n_cols - 1);
-        }
-      }
-      else
-      {
-        for (size_t i = 0; i < output.n_slices; i++)
-        {
-          gradientTemp.slice(s) += output.slice(i);
-        }
-      }
-    }
-
     gradient.submat(weight.n_elem + outMap, 0,
         weight.n_elem + outMap, 0) = arma::accu(mappedError.slices(
         outMap, outMap));
@@ -17,6 +17,7 @@
 #include <mlpack/prereqs.hpp>
 
 #include "layer_types.hpp"
+#include "dropout_mask.hpp"
 #include "add_merge.hpp"
 #include "linear.hpp"
 #include "sequential.hpp"
@@ -113,7 +114,7 @@ class DropConnect
                 arma::Mat<eT>&& /* gradient */);
 
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
   //! Get the parameters.
   OutputDataType const& Parameters() const { return parameters; }
@@ -184,8 +185,8 @@ class DropConnect
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored mask object.
-  OutputDataType mask;
+  //! The mask of the weights of the last forward pass in training mode.
+  DropoutMask mask;
 
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
@@ -194,10 +195,10 @@ class DropConnect
   OutputDataType denoise;
 
   //! Locally-stored layer module.
-  LayerTypes baseLayer;
+  LayerTypes<OutputDataType> baseLayer;
 
   //! Locally-stored network modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 }; // class DropConnect.
 
 }  // namespace ann
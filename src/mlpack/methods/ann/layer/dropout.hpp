@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "dropout_mask.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -28,6 +30,9 @@ namespace ann /** Artificial Neural Network. */ {
  * Note: During training you should set deterministic to false and during
  * testing you should set deterministic to true.
  *
+ * The mask is not stored: it is a DropoutMask, which is computed again from
+ * its seed by the backward pass.
+ *
  * For more information, see the following.
  *
  * @code
@@ -135,8 +140,8 @@ class Dropout
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored mast object.
-  OutputDataType mask;
+  //! The mask of the last forward pass in training mode.
+  DropoutMask mask;
 
   //! The probability of setting a value to zero.
   double ratio;
@@ -53,9 +53,8 @@ void Dropout<InputDataType, OutputDataType>::Forward(
   {
     // Scale with input / (1 - ratio) and set values to zero with probability
     // ratio.
-    mask = arma::randu<arma::Mat<eT> >(input.n_rows, input.n_cols);
-    mask.transform( [&](double val) { return (val > ratio); } );
-    output = input % mask * scale;
+    mask.Reset(ratio);
+    mask.Apply(input, output, scale);
   }
 }
 
@@ -66,7 +65,7 @@ void Dropout<InputDataType, OutputDataType>::Backward(
     arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  g = gy % mask * scale;
+  mask.Apply(gy, g, scale);
 }
 
 template<typename InputDataType, typename OutputDataType>
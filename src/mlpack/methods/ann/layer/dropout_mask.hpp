@@ -0,0 +1,130 @@
+/**
+ * @file dropout_mask.hpp
+ *
+ * Definition of DropoutMask, a random mask for the Dropout and DropConnect
+ * layers that is computed from a seed instead of being stored.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_DROPOUT_MASK_HPP
+#define MLPACK_METHODS_ANN_LAYER_DROPOUT_MASK_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <mlpack/core/math/random_stream.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A random mask that drops each element of a matrix with a given probability.
+ * The mask is a function of a 64-bit seed: element i is kept if a 32-bit half
+ * of the (i / 2)'th number of the counter-based math::RandomStream of the seed
+ * is at least ratio * 2^32.  So the mask takes no memory, it can be applied
+ * again in the backward pass instead of being stored, and any range of
+ * elements can be computed independently of the others; Apply() splits the
+ * elements between threads, and the result does not depend on their number.
+ *
+ * @code
+ * DropoutMask mask;
+ * mask.Reset(0.5);               // Draw a new mask.
+ * mask.Apply(input, output, 2.0);  // output = input % mask * 2.0.
+ * mask.Apply(gy, g, 2.0);          // The same mask again.
+ * @endcode
+ */
+class DropoutMask
+{
+ public:
+  //! Create a mask that keeps every element.
+  DropoutMask() : seed(0), threshold(0) { }
+
+  /**
+   * Draw a new mask with the given probability of dropping each element.  The
+   * seed is drawn with math::RandomStreamSeed(), so it is determined by the
+   * seed given to math::RandomSeed().
+   *
+   * @param ratio The probability of dropping an element (in [0, 1]).
+   */
+  void Reset(const double ratio)
+  {
+    seed = math::RandomStreamSeed();
+    threshold = (uint64_t) std::ceil(std::min(std::max(ratio, 0.0), 1.0) *
+        4294967296.0);
+  }
+
+  //! Return whether the element with the given index is kept.
+  bool Keep(const size_t i) const
+  {
+    math::RandomStream stream(seed);
+    stream.Discard(i / 2);
+    const uint64_t bits = stream();
+    return ((i % 2 == 0) ? (bits & 0xFFFFFFFFULL) : (bits >> 32)) >= threshold;
+  }
+
+  /**
+   * Set each element of the output to the element of the input times the
+   * scale if the mask keeps it, and to zero otherwise.  The input and the
+   * output may be the same matrix.
+   *
+   * @param input Matrix to mask.
+   * @param output Matrix to store the result in.
+   * @param scale Factor of the kept elements.
+   */
+  template<typename eT>
+  void Apply(const arma::Mat<eT>& input,
+             arma::Mat<eT>& output,
+             const double scale) const
+  {
+    output.set_size(input.n_rows, input.n_cols);
+    const eT* in = input.memptr();
+    eT* out = output.memptr();
+    const eT factor = (eT) scale;
+    const size_t n = input.n_elem;
+
+    // Each chunk holds 2 * ChunkPairs elements and starts its own copy of the
+    // stream at its first pair of elements.
+    const size_t chunks = (n + 2 * ChunkPairs - 1) / (2 * ChunkPairs);
+    #pragma omp parallel for num_threads(ParallelThreads()) \
+        if (chunks > 1) schedule(static)
+    for (omp_size_t c = 0; c < (omp_size_t) chunks; ++c)
+    {
+      math::RandomStream stream(seed);
+      stream.Discard(c * ChunkPairs);
+
+      const size_t begin = c * 2 * ChunkPairs;
+      const size_t end = std::min(n, begin + 2 * ChunkPairs);
+      size_t i = begin;
+      for (; i + 1 < end; i += 2)
+      {
+        const uint64_t bits = stream();
+        out[i] = ((bits & 0xFFFFFFFFULL) >= threshold) ? in[i] * factor : 0;
+        out[i + 1] = ((bits >> 32) >= threshold) ? in[i + 1] * factor : 0;
+      }
+
+      if (i < end)
+        out[i] = ((stream() & 0xFFFFFFFFULL) >= threshold) ? in[i] * factor : 0;
+    }
+  }
+
+  //! Get the seed of the mask.
+  uint64_t Seed() const { return seed; }
+  //! Modify the seed of the mask.
+  uint64_t& Seed() { return seed; }
+
+ private:
+  //! The number of pairs of elements of a chunk of Apply().
+  static const size_t ChunkPairs = 4096;
+
+  //! The seed of the stream of the mask.
+  uint64_t seed;
+  //! Elements whose 32 random bits are below this are dropped.
+  uint64_t threshold;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,255 @@
+/**
+ * @file fast_lstm.hpp
+ *
+ * Definition of the FastLSTM class, an LSTM layer that computes all of its
+ * gates with a single matrix product per time step.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_LSTM_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_LSTM_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <limits>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An implementation of an LSTM layer that computes the same function as the
+ * LSTM layer, but without sub-modules.  The weights of all four gates (input
+ * gate, hidden state, forget gate and output gate, in this order) are stacked
+ * into one matrix W of size (4 * outSize) x (inSize + outSize), so each time
+ * step computes all gates with a single matrix product
+ *
+ * @code
+ * gates = W * [input; previousOutput] + bias
+ * @endcode
+ *
+ * followed by one elementwise pass over the gates and the cell.  The values
+ * the backward pass needs (the stacked inputs, the gate activations and the
+ * cell states of every time step of the sequence) are stored in one
+ * contiguous matrix each, with one block of columns per time step, and the
+ * backward pass again needs a single matrix product per time step.
+ *
+ * The parameters are stored as W (column-major), followed by the bias.
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class FastLSTM
+{
+ public:
+  //! Create the FastLSTM object.
+  FastLSTM();
+
+  /**
+   * Create the FastLSTM layer object using the specified parameters.
+   *
+   * @param inSize The number of input units.
+   * @param outSize The number of output units.
+   * @param rho Maximum number of steps to backpropagate through time (BPTT).
+   */
+  FastLSTM(const size_t inSize,
+           const size_t outSize,
+           const size_t rho = std::numeric_limits<size_t>::max());
+
+  /*
+   * Reset the layer parameter.
+   */
+  void Reset();
+
+  /**
+   * Ordinary feed forward pass of a neural network, evaluating the function
+   * f(x) by propagating the activity forward through f.
+   *
+   * @param input Input data used for evaluating the specified function.
+   * @param output Resulting output activation.
+   */
+  template<typename eT>
+  void Forward(arma::Mat<eT>&& input, arma::Mat<eT>&& output);
+
+  /**
+   * Ordinary feed backward pass of a neural network, calculating the function
+   * f(x) by propagating x backwards trough f. Using the results from the feed
+   * forward pass.
+   *
+   * @param input The propagated input activation.
+   * @param gy The backpropagated error.
+   * @param g The calculated gradient.
+   */
+  template<typename eT>
+  void Backward(const arma::Mat<eT>&& input,
+                arma::Mat<eT>&& gy,
+                arma::Mat<eT>&& g);
+
+  /*
+   * Calculate the gradient using the output delta and the input activation.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  template<typename eT>
+  void Gradient(arma::Mat<eT>&& input,
+                arma::Mat<eT>&& error,
+                arma::Mat<eT>&& gradient);
+
+  /*
+   * Reset the state of the layer for a new sequence.
+   */
+  void ResetCell();
+
+  /**
+   * Recompute the given time step of the current sequence with the next call
+   * of Forward(), from the buffers of the forward pass, which are not
+   * changed.  RNN uses this to recompute
+   * the activations of the layers during the backward pass instead of storing
+   * them (see RNN::Recompute()).
+   *
+   * @param step Time step to recompute (counted from the last ResetCell()).
+   */
+  void Replay(const size_t step);
+
+  //! The value of the deterministic parameter.
+  bool Deterministic() const { return deterministic; }
+  //! Modify the value of the deterministic parameter.
+  bool& Deterministic() { return deterministic; }
+
+  //! Get the maximum number of steps to backpropagate through time (BPTT).
+  size_t Rho() const { return rho; }
+  //! Modify the maximum number of steps to backpropagate through time (BPTT).
+  size_t& Rho() { return rho; }
+
+  //! Get the parameters.
+  OutputDataType const& Parameters() const { return weights; }
+  //! Modify the parameters.
+  OutputDataType& Parameters() { return weights; }
+
+  //! Get the input parameter.
+  InputDataType const& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType const& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType const& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  //! Get the gradient.
+  OutputDataType const& Gradient() const { return gradient; }
+  //! Modify the gradient.
+  OutputDataType& Gradient() { return gradient; }
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Make sure the step buffers can hold the given number of time steps.
+  void ReserveSteps(const size_t steps);
+
+  //! Locally-stored number of input units.
+  size_t inSize;
+
+  //! Locally-stored number of output units.
+  size_t outSize;
+
+  //! Number of steps to backpropagate through time (BPTT).
+  size_t rho;
+
+  //! Current batch size.
+  size_t batchSize;
+
+  //! The number of time steps the step buffers can hold.
+  size_t capacity;
+
+  //! Locally-stored number of forward steps of the current sequence.
+  size_t forwardStep;
+
+  //! Locally-stored number of backward steps of the current sequence.
+  size_t backwardStep;
+
+  //! The time step of the last backward pass, used by Gradient().
+  size_t gradientStep;
+
+  //! If true, no backward pass follows, so the step buffers only keep the
+  //! current and the next time step.
+  bool deterministic;
+
+  //! Whether the next Forward() call recomputes a stored time step.
+  bool replay;
+
+  //! Locally-stored time step that is recomputed by the next Forward() call.
+  size_t replayStep;
+
+  //! Locally-stored weight object.
+  OutputDataType weights;
+
+  //! The stacked weights of all gates.
+  OutputDataType weight;
+
+  //! The stacked biases of all gates.
+  OutputDataType bias;
+
+  //! The stacked input and previous output of each time step.
+  OutputDataType stackedInput;
+
+  //! The activations of the gates of each time step.
+  OutputDataType gateActivation;
+
+  //! The cell state before the first and after each time step.
+  OutputDataType cell;
+
+  //! The activation of the cell state of each time step.
+  OutputDataType cellActivation;
+
+  //! The error of the gate inputs of the last backward step.
+  OutputDataType gateError;
+
+  //! The error of the stacked input of the last backward step.
+  OutputDataType stackedInputError;
+
+  //! The error of the output, passed back from the next time step.
+  OutputDataType outputError;
+
+  //! The error of the cell state, passed back from the next time step.
+  OutputDataType cellError;
+
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored gradient object.
+  OutputDataType gradient;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+}; // class FastLSTM
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "fast_lstm_impl.hpp"
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file fast_lstm_impl.hpp
+ *
+ * Implementation of the FastLSTM class, an LSTM layer that computes all of its
+ * gates with a single matrix product per time step.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_LSTM_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_LSTM_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "fast_lstm.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+FastLSTM<InputDataType, OutputDataType>::FastLSTM() :
+    replay(false),
+    replayStep(0)
+{
+  // Nothing to do here.
+}
+
+template <typename InputDataType, typename OutputDataType>
+FastLSTM<InputDataType, OutputDataType>::FastLSTM(
+    const size_t inSize,
+    const size_t outSize,
+    const size_t rho) :
+    inSize(inSize),
+    outSize(outSize),
+    rho(rho),
+    batchSize(0),
+    capacity(0),
+    forwardStep(0),
+    backwardStep(0),
+    gradientStep(0),
+    deterministic(false),
+    replay(false),
+    replayStep(0)
+{
+  weights.set_size(4 * outSize * (inSize + outSize) + 4 * outSize, 1);
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastLSTM<InputDataType, OutputDataType>::Reset()
+{
+  weight = OutputDataType(weights.memptr(), 4 * outSize, inSize + outSize,
+      false, false);
+  bias = OutputDataType(weights.memptr() + weight.n_elem, 4 * outSize, 1,
+      false, false);
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastLSTM<InputDataType, OutputDataType>::ResetCell()
+{
+  forwardStep = 0;
+  backwardStep = 0;
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastLSTM<InputDataType, OutputDataType>::Replay(const size_t step)
+{
+  replay = true;
+  replayStep = step;
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastLSTM<InputDataType, OutputDataType>::ReserveSteps(const size_t steps)
+{
+  if (steps <= capacity)
+    return;
+
+  // Grow geometrically, so that long sequences only cause a few
+  // reallocations; resize() keeps the values of the earlier time steps.
+  capacity = std::max(steps, 2 * capacity);
+  stackedInput.resize(inSize + outSize, batchSize * capacity);
+  gateActivation.resize(4 * outSize, batchSize * capacity);
+  cell.resize(outSize, batchSize * capacity);
+  cellActivation.resize(outSize, batchSize * capacity);
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void FastLSTM<InputDataType, OutputDataType>::Forward(
+    arma::Mat<eT>&& input, arma::Mat<eT>&& output)
+{
+  // A new batch size starts a new sequence, with new buffers.
+  if (input.n_cols != batchSize)
+  {
+    batchSize = input.n_cols;
+    capacity = 0;
+    ResetCell();
+  }
+
+  // Without a backward pass only the current and the next time step are
+  // needed, so two blocks of the buffers are used alternately.  A recomputed
+  // time step writes the same values into its blocks again.
+  const size_t step = replay ? replayStep : forwardStep;
+  const size_t slot = deterministic ? (step % 2) : step;
+  const size_t nextSlot = deterministic ? ((step + 1) % 2) : (step + 1);
+  ReserveSteps(std::max(slot, nextSlot) + 1);
+
+  arma::Mat<eT> currentInput(stackedInput.colptr(slot * batchSize),
+      inSize + outSize, batchSize, false, true);
+  arma::Mat<eT> prevCell(cell.colptr(slot * batchSize), outSize, batchSize,
+      false, true);
+
+  // The previous output has been stored by the previous time step; the state
+  // starts from zero at the beginning of the sequence and every rho steps.
+  currentInput.rows(0, inSize - 1) = input;
+  if (step % rho == 0)
+  {
+    currentInput.rows(inSize, inSize + outSize - 1).zeros();
+    prevCell.zeros();
+  }
+
+  // Compute the inputs of all gates with one matrix product.
+  arma::Mat<eT> gates(gateActivation.colptr(slot * batchSize), 4 * outSize,
+      batchSize, false, true);
+  gates = weight * currentInput;
+  gates.each_col() += bias;
+
+  arma::Mat<eT> nextInput(stackedInput.colptr(nextSlot * batchSize),
+      inSize + outSize, batchSize, false, true);
+  arma::Mat<eT> nextCell(cell.colptr(nextSlot * batchSize), outSize,
+      batchSize, false, true);
+  arma::Mat<eT> activation(cellActivation.colptr(slot * batchSize), outSize,
+      batchSize, false, true);
+  output.set_size(outSize, batchSize);
+
+  // Apply the gate activations and update the cell in a single pass.
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    eT* gate = gates.colptr(j);
+    const eT* c = prevCell.colptr(j);
+    eT* nextC = nextCell.colptr(j);
+    eT* cellAct = activation.colptr(j);
+    eT* out = output.colptr(j);
+    eT* nextOut = nextInput.colptr(j) + inSize;
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const eT inputGate = 1.0 / (1.0 + std::exp(-gate[k]));
+      const eT hiddenState = std::tanh(gate[outSize + k]);
+      const eT forgetGate = 1.0 / (1.0 + std::exp(-gate[2 * outSize + k]));
+      const eT outputGate = 1.0 / (1.0 + std::exp(-gate[3 * outSize + k]));
+
+      gate[k] = inputGate;
+      gate[outSize + k] = hiddenState;
+      gate[2 * outSize + k] = forgetGate;
+      gate[3 * outSize + k] = outputGate;
+
+      nextC[k] = inputGate * hiddenState + forgetGate * c[k];
+      cellAct[k] = std::tanh(nextC[k]);
+      out[k] = outputGate * cellAct[k];
+      nextOut[k] = out[k];
+    }
+  }
+
+  if (replay)
+    replay = false;
+  else
+    forwardStep++;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void FastLSTM<InputDataType, OutputDataType>::Backward(
+    const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+{
+  // The time steps are passed backwards, starting from the last one.
+  const size_t step = forwardStep - backwardStep - 1;
+
+  // The errors of the next time step only flow back into this one if the
+  // state was not reset in between.
+  const bool recurrent = (backwardStep > 0) && ((step + 1) % rho != 0);
+
+  const arma::Mat<eT> gates(gateActivation.colptr(step * batchSize),
+      4 * outSize, batchSize, false, true);
+  const arma::Mat<eT> prevCell(cell.colptr(step * batchSize), outSize,
+      batchSize, false, true);
+  const arma::Mat<eT> activation(cellActivation.colptr(step * batchSize),
+      outSize, batchSize, false, true);
+
+  gateError.set_size(4 * outSize, batchSize);
+  if (!recurrent)
+  {
+    outputError.zeros(outSize, batchSize);
+    cellError.zeros(outSize, batchSize);
+  }
+
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const eT* gate = gates.colptr(j);
+    const eT* c = prevCell.colptr(j);
+    const eT* cellAct = activation.colptr(j);
+    const eT* error = gy.colptr(j);
+    const eT* nextOutError = outputError.colptr(j);
+    eT* cError = cellError.colptr(j);
+    eT* gError = gateError.colptr(j);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const eT inputGate = gate[k];
+      const eT hiddenState = gate[outSize + k];
+      const eT forgetGate = gate[2 * outSize + k];
+      const eT outputGate = gate[3 * outSize + k];
+
+      const eT outError = error[k] + nextOutError[k];
+      const eT cellStateError = outError * outputGate *
+          (1.0 - cellAct[k] * cellAct[k]) + cError[k];
+
+      gError[k] = cellStateError * hiddenState * inputGate * (1.0 - inputGate);
+      gError[outSize + k] = cellStateError * inputGate *
+          (1.0 - hiddenState * hiddenState);
+      gError[2 * outSize + k] = cellStateError * c[k] * forgetGate *
+          (1.0 - forgetGate);
+      gError[3 * outSize + k] = outError * cellAct[k] * outputGate *
+          (1.0 - outputGate);
+
+      cError[k] = cellStateError * forgetGate;
+    }
+  }
+
+  // Pass the error of all gates back with one matrix product.
+  stackedInputError = weight.t() * gateError;
+  g = stackedInputError.rows(0, inSize - 1);
+  outputError = stackedInputError.rows(inSize, inSize + outSize - 1);
+
+  gradientStep = step;
+  backwardStep++;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void FastLSTM<InputDataType, OutputDataType>::Gradient(
+    arma::Mat<eT>&& /* input */,
+    arma::Mat<eT>&& /* error */,
+    arma::Mat<eT>&& gradient)
+{
+  const arma::Mat<eT> currentInput(stackedInput.colptr(gradientStep *
+      batchSize), inSize + outSize, batchSize, false, true);
+
+  // Write the products straight into the gradient, without temporaries.
+  arma::Mat<eT> weightGradient(gradient.memptr(), weight.n_rows,
+      weight.n_cols, false, true);
+  weightGradient = gateError * currentInput.t();
+
+  arma::Mat<eT> biasGradient(gradient.memptr() + weight.n_elem,
+      bias.n_elem, 1, false, true);
+  biasGradient = arma::sum(gateError, 1);
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void FastLSTM<InputDataType, OutputDataType>::serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(inSize);
+  ar & BOOST_SERIALIZATION_NVP(outSize);
+  ar & BOOST_SERIALIZATION_NVP(rho);
+
+  // This is inefficient, but we have to allocate this memory so that
+  // WeightSetVisitor gets the right size.
+  if (Archive::is_loading::value)
+  {
+    weights.set_size(4 * outSize * (inSize + outSize) + 4 * outSize, 1);
+    batchSize = 0;
+    capacity = 0;
+    forwardStep = 0;
+    backwardStep = 0;
+    gradientStep = 0;
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -118,6 +118,17 @@ class GRU
    */
   void ResetCell();
 
+  /**
+   * Recompute the given time step of the current sequence with the next call
+   * of Forward(), from the output that was stored for the previous time
+   * step, without storing anything again.  RNN uses this to
+   * recompute the activations of the layers during the backward pass instead
+   * of storing them (see RNN::Recompute()).
+   *
+   * @param step Time step to recompute (counted from the last ResetCell()).
+   */
+  void Replay(const size_t step);
+
   //! The value of the deterministic parameter.
   bool Deterministic() const { return deterministic; }
   //! Modify the value of the deterministic parameter.
@@ -154,7 +165,7 @@ class GRU
   OutputDataType& Gradient() { return gradient; }
 
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
   /**
    * Serialize the layer
@@ -179,34 +190,34 @@ class GRU
   OutputDataType weights;
 
   //! Locally-stored input 2 gate module.
-  LayerTypes input2GateModule;
+  LayerTypes<OutputDataType> input2GateModule;
 
   //! Locally-stored output 2 gate module.
-  LayerTypes output2GateModule;
+  LayerTypes<OutputDataType> output2GateModule;
 
   //! Locally-stored output hidden state 2 gate module.
-  LayerTypes outputHidden2GateModule;
+  LayerTypes<OutputDataType> outputHidden2GateModule;
 
   //! Locally-stored input gate module.
-  LayerTypes inputGateModule;
+  LayerTypes<OutputDataType> inputGateModule;
 
   //! Locally-stored hidden state module.
-  LayerTypes hiddenStateModule;
+  LayerTypes<OutputDataType> hiddenStateModule;
 
   //! Locally-stored forget gate module.
-  LayerTypes forgetGateModule;
+  LayerTypes<OutputDataType> forgetGateModule;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored delete visitor.
   DeleteVisitor deleteVisitor;
 
   //! Locally-stored list of network modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored number of forward steps.
   size_t forwardStep;
@@ -218,26 +229,32 @@ class GRU
   size_t gradientStep;
 
   //! Locally-stored output parameters.
-  std::list<arma::mat> outParameter;
+  std::list<OutputDataType> outParameter;
 
   //! Matrix of all zeroes to initialize the output
-  arma::mat allZeros;
+  OutputDataType allZeros;
 
   //! Iterator pointed to the last output produced by the cell
-  std::list<arma::mat>::iterator prevOutput;
+  typename std::list<OutputDataType>::iterator prevOutput;
 
   //! Iterator pointed to the last output processed by backward
-  std::list<arma::mat>::iterator backIterator;
+  typename std::list<OutputDataType>::iterator backIterator;
 
   //! Iterator pointed to the last output processed by gradient
-  std::list<arma::mat>::iterator gradIterator;
+  typename std::list<OutputDataType>::iterator gradIterator;
 
   //! Locally-stored previous error.
-  arma::mat prevError;
+  OutputDataType prevError;
 
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
 
+  //! Whether the next Forward() call recomputes a stored time step.
+  bool replay;
+
+  //! Locally-stored time step that is recomputed by the next Forward() call.
+  size_t replayStep;
+
   //! Locally-stored delta object.
   OutputDataType delta;
 
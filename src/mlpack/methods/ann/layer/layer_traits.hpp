@@ -15,6 +15,9 @@
 
 #include <mlpack/core/util/sfinae_utility.hpp>
 
+#include <type_traits>
+#include <utility>
+
 namespace mlpack {
 namespace ann {
 
@@ -76,6 +79,26 @@ HAS_MEM_FUNC(Add, HasAddCheck);
 // can use with SFINAE to catch when a type has a Model() function.
 HAS_MEM_FUNC(Model, HasModelCheck);
 
+/**
+ * HasModel<T>::value is true if the layer type T holds other layers, which can
+ * be modified through a Model() function.  Unlike HasModelCheck, this does not
+ * depend on the element type of the layers.
+ */
+template<typename T>
+struct HasModel
+{
+  typedef char yes[1];
+  typedef char no [2];
+
+  template<typename U>
+  static yes& chk(typename std::remove_reference<
+      decltype(std::declval<U&>().Model())>::type*);
+  template<typename>
+  static no& chk(...);
+
+  static bool const value = sizeof(chk<T>(0)) == sizeof(yes);
+};
+
 // This gives us a HasLocationCheck<T, U> type (where U is a function pointer)
 // we can use with SFINAE to catch when a type has a Location() function.
 HAS_MEM_FUNC(Location, HasLocationCheck);
@@ -104,6 +127,15 @@ HAS_MEM_FUNC(InputHeight, HasInputHeight);
 // can use with SFINAE to catch when a type has a Rho() function.
 HAS_MEM_FUNC(Rho, HasRho);
 
+// This gives us a HasGradientColumnsCheck<T, U> type (where U is a function
+// pointer) we can use with SFINAE to catch when a type has a
+// GradientColumns() function (and so a sparse gradient).
+HAS_MEM_FUNC(GradientColumns, HasGradientColumnsCheck);
+
+// This gives us a HasReplayCheck<T, U> type (where U is a function pointer) we
+// can use with SFINAE to catch when a type has a Replay() function.
+HAS_MEM_FUNC(Replay, HasReplayCheck);
+
 } // namespace ann
 } // namespace mlpack
 
@@ -46,6 +46,7 @@ namespace ann {
 template<typename InputDataType, typename OutputDataType> class AddMerge;
 template<typename InputDataType, typename OutputDataType> class Concat;
 template<typename InputDataType, typename OutputDataType> class DropConnect;
+template<typename InputDataType, typename OutputDataType> class FastLSTM;
 template<typename InputDataType, typename OutputDataType> class Glimpse;
 template<typename InputDataType, typename OutputDataType> class Linear;
 template<typename InputDataType, typename OutputDataType> class LinearNoBias;
@@ -77,46 +78,52 @@ template<
 >
 class RecurrentAttention;
 
+/**
+ * The set of layers a network is built from.  All layers use MatType (e.g.
+ * arma::mat or arma::fmat) for their parameters and activations.
+ */
+template<typename MatType = arma::mat>
 using LayerTypes = boost::variant<
-    Add<arma::mat, arma::mat>*,
-    AddMerge<arma::mat, arma::mat>*,
-    BaseLayer<LogisticFunction, arma::mat, arma::mat>*,
-    BaseLayer<IdentityFunction, arma::mat, arma::mat>*,
-    BaseLayer<TanhFunction, arma::mat, arma::mat>*,
-    BaseLayer<RectifierFunction, arma::mat, arma::mat>*,
-    Concat<arma::mat, arma::mat>*,
-    ConcatPerformance<NegativeLogLikelihood<arma::mat, arma::mat>,
-                      arma::mat, arma::mat>*,
-    Constant<arma::mat, arma::mat>*,
+    Add<MatType, MatType>*,
+    AddMerge<MatType, MatType>*,
+    BaseLayer<LogisticFunction, MatType, MatType>*,
+    BaseLayer<IdentityFunction, MatType, MatType>*,
+    BaseLayer<TanhFunction, MatType, MatType>*,
+    BaseLayer<RectifierFunction, MatType, MatType>*,
+    Concat<MatType, MatType>*,
+    ConcatPerformance<NegativeLogLikelihood<MatType, MatType>,
+                      MatType, MatType>*,
+    Constant<MatType, MatType>*,
     Convolution<NaiveConvolution<ValidConvolution>,
                 NaiveConvolution<FullConvolution>,
-                NaiveConvolution<ValidConvolution>, arma::mat, arma::mat>*,
-    CrossEntropyError<arma::mat, arma::mat>*,
-    DropConnect<arma::mat, arma::mat>*,
-    Dropout<arma::mat, arma::mat>*,
-    ELU<arma::mat, arma::mat>*,
-    Glimpse<arma::mat, arma::mat>*,
-    HardTanH<arma::mat, arma::mat>*,
-    Join<arma::mat, arma::mat>*,
-    LeakyReLU<arma::mat, arma::mat>*,
-    Linear<arma::mat, arma::mat>*,
-    LinearNoBias<arma::mat, arma::mat>*,
-    LogSoftMax<arma::mat, arma::mat>*,
-    Lookup<arma::mat, arma::mat>*,
-    LSTM<arma::mat, arma::mat>*,
-    GRU<arma::mat, arma::mat>*,
-    MaxPooling<arma::mat, arma::mat>*,
-    MeanPooling<arma::mat, arma::mat>*,
-    MeanSquaredError<arma::mat, arma::mat>*,
-    MultiplyConstant<arma::mat, arma::mat>*,
-    NegativeLogLikelihood<arma::mat, arma::mat>*,
-    PReLU<arma::mat, arma::mat>*,
-    Recurrent<arma::mat, arma::mat>*,
-    RecurrentAttention<arma::mat, arma::mat>*,
-    ReinforceNormal<arma::mat, arma::mat>*,
-    Select<arma::mat, arma::mat>*,
-    Sequential<arma::mat, arma::mat>*,
-    VRClassReward<arma::mat, arma::mat>*
+                NaiveConvolution<ValidConvolution>, MatType, MatType>*,
+    CrossEntropyError<MatType, MatType>*,
+    DropConnect<MatType, MatType>*,
+    Dropout<MatType, MatType>*,
+    ELU<MatType, MatType>*,
+    FastLSTM<MatType, MatType>*,
+    Glimpse<MatType, MatType>*,
+    HardTanH<MatType, MatType>*,
+    Join<MatType, MatType>*,
+    LeakyReLU<MatType, MatType>*,
+    Linear<MatType, MatType>*,
+    LinearNoBias<MatType, MatType>*,
+    LogSoftMax<MatType, MatType>*,
+    Lookup<MatType, MatType>*,
+    LSTM<MatType, MatType>*,
+    GRU<MatType, MatType>*,
+    MaxPooling<MatType, MatType>*,
+    MeanPooling<MatType, MatType>*,
+    MeanSquaredError<MatType, MatType>*,
+    MultiplyConstant<MatType, MatType>*,
+    NegativeLogLikelihood<MatType, MatType>*,
+    PReLU<MatType, MatType>*,
+    Recurrent<MatType, MatType>*,
+    RecurrentAttention<MatType, MatType>*,
+    ReinforceNormal<MatType, MatType>*,
+    Select<MatType, MatType>*,
+    Sequential<MatType, MatType>*,
+    VRClassReward<MatType, MatType>*
 >;
 
 } // namespace ann
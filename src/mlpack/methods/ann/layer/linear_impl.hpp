@@ -38,8 +38,8 @@ Linear<InputDataType, OutputDataType>::Linear(
 template<typename InputDataType, typename OutputDataType>
 void Linear<InputDataType, OutputDataType>::Reset()
 {
-  weight = arma::mat(weights.memptr(), outSize, inSize, false, false);
-  bias = arma::mat(weights.memptr() + weight.n_elem,
+  weight = OutputDataType(weights.memptr(), outSize, inSize, false, false);
+  bias = OutputDataType(weights.memptr() + weight.n_elem,
       outSize, 1, false, false);
 }
 
@@ -67,10 +67,14 @@ void Linear<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient.submat(0, 0, weight.n_elem - 1, 0) = arma::vectorise(
-      error * input.t());
-  gradient.submat(weight.n_elem, 0, gradient.n_elem - 1, 0) =
-      arma::mean(error, 1);
+  // Write the products straight into the gradient, without temporaries.
+  arma::Mat<eT> weightGradient(gradient.memptr(), weight.n_rows,
+      weight.n_cols, false, true);
+  weightGradient = error * input.t();
+
+  arma::Mat<eT> biasGradient(gradient.memptr() + weight.n_elem,
+      gradient.n_elem - weight.n_elem, 1, false, true);
+  biasGradient = arma::sum(error, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -92,6 +92,11 @@ class LinearNoBias
   //! Modify the parameters.
   OutputDataType& Parameters() { return weights; }
 
+  //! Get the number of input units.
+  size_t InputSize() const { return inSize; }
+  //! Get the number of output units.
+  size_t OutputSize() const { return outSize; }
+
   //! Get the input parameter.
   InputDataType const& InputParameter() const { return inputParameter; }
   //! Modify the input parameter.
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_ANN_LAYER_LOG_SOFTMAX_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/activation_functions/fast_activations.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -24,6 +25,9 @@ namespace ann /** Artificial Neural Network. */ {
  * (NegativeLogLikelihoodLayer), which expects that the input contains
  * log-probabilities for each class.
  *
+ * Within an ActivationAccuracyScope (for instance in a network with
+ * FFN::ActivationMode() set) the exponentials are computed with FastExp.
+ *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
  * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
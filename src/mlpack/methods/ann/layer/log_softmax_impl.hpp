@@ -29,7 +29,20 @@ template<typename InputType, typename OutputType>
 void LogSoftMax<InputDataType, OutputDataType>::Forward(
     const InputType&& input, OutputType&& output)
 {
-  arma::mat maxInput = arma::repmat(arma::max(input), input.n_rows, 1);
+  arma::Mat<typename InputType::elem_type> maxInput = arma::repmat(
+      arma::max(input), input.n_rows, 1);
+
+  const ActivationAccuracy accuracy = ScopedActivationAccuracy();
+  if (accuracy != EXACT_ACTIVATIONS)
+  {
+    // exp(input - max) to the accuracy selected for this thread.
+    output = (input - maxInput);
+    FastActivation<FastExp>(output, output, accuracy);
+    maxInput.each_row() += arma::log(arma::sum(output));
+    output = input - maxInput;
+    return;
+  }
+
   output = (maxInput - input);
 
   // Approximation of the hyperbolic tangent. The acuracy however is
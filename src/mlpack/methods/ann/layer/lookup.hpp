@@ -80,6 +80,20 @@ class Lookup
                 arma::Mat<eT>&& error,
                 arma::Mat<eT>&& gradient);
 
+  /*
+   * Calculate the gradient of the looked-up columns only, using the output
+   * delta and the input activation.  The gradient is stored as the indices of
+   * the columns of the weights that were looked up (GradientColumns()) and
+   * the gradient of each of these columns (GradientValues()), so the cost does
+   * not depend on the number of input units.  This is used by the sparse
+   * gradient of FFN.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   */
+  template<typename eT>
+  void SparseGradient(const arma::Mat<eT>&& input, arma::Mat<eT>&& error);
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
@@ -105,6 +119,11 @@ class Lookup
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get the (sorted) indices of the columns of the last sparse gradient.
+  const arma::uvec& GradientColumns() const { return gradientColumns; }
+  //! Get the gradient of each column of the last sparse gradient.
+  OutputDataType const& GradientValues() const { return gradientValues; }
+
   /**
    * Serialize the layer
    */
@@ -127,6 +146,12 @@ class Lookup
   //! Locally-stored gradient object.
   OutputDataType gradient;
 
+  //! Locally-stored columns of the sparse gradient.
+  arma::uvec gradientColumns;
+
+  //! Locally-stored gradient of the columns of the sparse gradient.
+  OutputDataType gradientValues;
+
   //! Locally-stored input parameter object.
   InputDataType inputParameter;
 
@@ -54,8 +54,29 @@ void Lookup<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient = arma::zeros<arma::Mat<eT> >(weights.n_rows, weights.n_cols);
-  gradient.cols(arma::conv_to<arma::uvec>::from(input) - 1) = error;
+  SparseGradient(std::move(input), std::move(error));
+
+  gradient.zeros(weights.n_rows, weights.n_cols);
+  gradient.cols(gradientColumns) = gradientValues;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void Lookup<InputDataType, OutputDataType>::SparseGradient(
+    const arma::Mat<eT>&& input,
+    arma::Mat<eT>&& error)
+{
+  const arma::uvec indices = arma::conv_to<arma::uvec>::from(input) - 1;
+  gradientColumns = arma::unique(indices);
+  gradientValues.zeros(weights.n_rows, gradientColumns.n_elem);
+
+  // A column that is looked up several times gets the sum of the errors.
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    const size_t column = std::lower_bound(gradientColumns.begin(),
+        gradientColumns.end(), indices[i]) - gradientColumns.begin();
+    gradientValues.col(column) += error.col(i);
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -107,6 +107,17 @@ class LSTM
    */
   void ResetCell();
 
+  /**
+   * Recompute the given time step of the current sequence with the next call
+   * of Forward(), from the output and the cell that were stored for the
+   * previous time step, without storing anything again.  RNN uses this to
+   * recompute the activations of the layers during the backward pass instead
+   * of storing them (see RNN::Recompute()).
+   *
+   * @param step Time step to recompute (counted from the last ResetCell()).
+   */
+  void Replay(const size_t step);
+
   //! The value of the deterministic parameter.
   bool Deterministic() const { return deterministic; }
   //! Modify the value of the deterministic parameter.
@@ -143,7 +154,7 @@ class LSTM
   OutputDataType& Gradient() { return gradient; }
 
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
   /**
    * Serialize the layer
@@ -168,43 +179,43 @@ class LSTM
   OutputDataType weights;
 
   //! Locally-stored previous output.
-  std::list<arma::mat>::iterator prevOutput;
+  typename std::list<OutputDataType>::iterator prevOutput;
 
   //! Locally-stored previous cell state.
-  std::list<arma::mat>::iterator prevCell;
+  typename std::list<OutputDataType>::iterator prevCell;
 
   //! Locally-stored input 2 gate module.
-  LayerTypes input2GateModule;
+  LayerTypes<OutputDataType> input2GateModule;
 
   //! Locally-stored output 2 gate module.
-  LayerTypes output2GateModule;
+  LayerTypes<OutputDataType> output2GateModule;
 
   //! Locally-stored input gate module.
-  LayerTypes inputGateModule;
+  LayerTypes<OutputDataType> inputGateModule;
 
   //! Locally-stored hidden state module.
-  LayerTypes hiddenStateModule;
+  LayerTypes<OutputDataType> hiddenStateModule;
 
   //! Locally-stored forget gate module.
-  LayerTypes forgetGateModule;
+  LayerTypes<OutputDataType> forgetGateModule;
 
   //! Locally-stored output gate module.
-  LayerTypes outputGateModule;
+  LayerTypes<OutputDataType> outputGateModule;
 
   //! Locally-stored cell module.
-  LayerTypes cellModule;
+  LayerTypes<OutputDataType> cellModule;
 
   //! Locally-stored cell activation module.
-  LayerTypes cellActivationModule;
+  LayerTypes<OutputDataType> cellActivationModule;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored list of network modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored number of forward steps.
   size_t forwardStep;
@@ -216,29 +227,44 @@ class LSTM
   size_t gradientStep;
 
   //! Locally-stored cell parameters.
-  std::list<arma::mat> cellParameter;
+  std::list<OutputDataType> cellParameter;
 
   //! Locally-stored output parameters.
-  std::list<arma::mat> outParameter;
+  std::list<OutputDataType> outParameter;
 
   //! Matrix of all zeroes to initialize the output and the cell
-  arma::mat allZeros;
+  OutputDataType allZeros;
 
   //! Iterator pointed to the last cell output processed by backward
-  std::list<arma::mat>::iterator backIterator;
+  typename std::list<OutputDataType>::iterator backIterator;
 
   //! Iterator pointed to the last output processed by gradient
-  std::list<arma::mat>::iterator gradIterator;
+  typename std::list<OutputDataType>::iterator gradIterator;
 
   //! Locally-stored previous error.
-  arma::mat prevError;
+  OutputDataType prevError;
 
   //! Locally-stored foget gate error.
-  arma::mat forgetGateError;
+  OutputDataType forgetGateError;
+
+  //! Locally-stored errors of the outputs of the gates and of the cell
+  //! activation; they are members so that each step reuses their memory.
+  OutputDataType outputGateError;
+  OutputDataType cellActivationOutputError;
+  OutputDataType cellActivationError;
+  OutputDataType hiddenStateError;
+  OutputDataType inputGateError;
+  OutputDataType forgetGateOutputError;
 
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
 
+  //! Whether the next Forward() call recomputes a stored time step.
+  bool replay;
+
+  //! Locally-stored time step that is recomputed by the next Forward() call.
+  size_t replayStep;
+
   //! Locally-stored delta object.
   OutputDataType delta;
 
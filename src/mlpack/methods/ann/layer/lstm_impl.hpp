@@ -24,7 +24,9 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 template<typename InputDataType, typename OutputDataType>
-LSTM<InputDataType, OutputDataType>::LSTM()
+LSTM<InputDataType, OutputDataType>::LSTM() :
+    replay(false),
+    replayStep(0)
 {
   // Nothing to do here.
 }
@@ -41,38 +43,48 @@ LSTM<InputDataType, OutputDataType>::LSTM(
     forwardStep(0),
     backwardStep(0),
     gradientStep(0),
-    deterministic(false)
+    deterministic(false),
+    replay(false),
+    replayStep(0)
 {
-  input2GateModule = new Linear<>(inSize, 4 * outSize);
-  output2GateModule = new LinearNoBias<>(outSize, 4 * outSize);
+  input2GateModule = new Linear<OutputDataType, OutputDataType>(inSize,
+      4 * outSize);
+  output2GateModule = new LinearNoBias<OutputDataType, OutputDataType>(outSize,
+      4 * outSize);
 
   network.push_back(input2GateModule);
   network.push_back(output2GateModule);
 
-  inputGateModule = new SigmoidLayer<>();
-  hiddenStateModule = new TanHLayer<>();
-  forgetGateModule = new SigmoidLayer<>();
-  outputGateModule = new SigmoidLayer<>();
+  inputGateModule = new SigmoidLayer<LogisticFunction, OutputDataType,
+      OutputDataType>();
+  hiddenStateModule = new TanHLayer<TanhFunction, OutputDataType,
+      OutputDataType>();
+  forgetGateModule = new SigmoidLayer<LogisticFunction, OutputDataType,
+      OutputDataType>();
+  outputGateModule = new SigmoidLayer<LogisticFunction, OutputDataType,
+      OutputDataType>();
 
   network.push_back(inputGateModule);
   network.push_back(hiddenStateModule);
   network.push_back(forgetGateModule);
   network.push_back(outputGateModule);
 
-  cellModule = new IdentityLayer<>();
-  cellActivationModule = new TanHLayer<>();
+  cellModule = new IdentityLayer<IdentityFunction, OutputDataType,
+      OutputDataType>();
+  cellActivationModule = new TanHLayer<TanhFunction, OutputDataType,
+      OutputDataType>();
 
   network.push_back(cellModule);
   network.push_back(cellActivationModule);
 
-  prevError = arma::zeros<arma::mat>(4 * outSize, batchSize);
+  prevError = arma::zeros<OutputDataType>(4 * outSize, batchSize);
 
-  allZeros = arma::zeros<arma::mat>(outSize, batchSize);
+  allZeros = arma::zeros<OutputDataType>(outSize, batchSize);
 
-  outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
+  outParameter.push_back(std::move(OutputDataType(allZeros.memptr(),
     allZeros.n_rows, allZeros.n_cols, false, false)));
 
-  cellParameter.push_back(std::move(arma::mat(allZeros.memptr(),
+  cellParameter.push_back(std::move(OutputDataType(allZeros.memptr(),
     allZeros.n_rows, allZeros.n_cols, false, false)));
 
   prevOutput = outParameter.begin();
@@ -103,35 +115,53 @@ void LSTM<InputDataType, OutputDataType>::Forward(
   if (input.n_cols != batchSize)
   {
     batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
+    prevError.resize(4 * outSize, batchSize);
+
+    // A sequence starts from the zero state, which needs a column for each
+    // sequence of the batch.
+    if (forwardStep == 0)
+    {
+      allZeros.zeros(outSize, batchSize);
+      ResetCell();
+    }
   }
 
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, input2GateModule))),
-      input2GateModule);
+  // A recomputed time step starts from the stored output and cell of the
+  // previous time step.
+  typename std::list<OutputDataType>::iterator lastOutput = prevOutput;
+  typename std::list<OutputDataType>::iterator lastCell = prevCell;
+  if (replay)
+  {
+    prevOutput = std::next(outParameter.begin(), replayStep);
+    prevCell = std::next(cellParameter.begin(), replayStep);
+  }
 
-  boost::apply_visitor(ForwardVisitor(std::move(*prevOutput), std::move(
-      boost::apply_visitor(outputParameterVisitor, output2GateModule))),
-      output2GateModule);
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+      std::move(boost::apply_visitor(outputParameterVisitor,
+      input2GateModule))), input2GateModule);
+
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(*prevOutput),
+      std::move(boost::apply_visitor(outputParameterVisitor,
+      output2GateModule))), output2GateModule);
 
   output = boost::apply_visitor(outputParameterVisitor, input2GateModule) +
       boost::apply_visitor(outputParameterVisitor, output2GateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       0, 0, 1 * outSize - 1, batchSize - 1)), std::move(boost::apply_visitor(
       outputParameterVisitor, inputGateModule))), inputGateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       1 * outSize, 0, 2 * outSize - 1, batchSize - 1)), std::move(
       boost::apply_visitor(outputParameterVisitor, hiddenStateModule))),
       hiddenStateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       2 * outSize, 0, 3 * outSize - 1, batchSize - 1)), std::move(
       boost::apply_visitor(outputParameterVisitor, forgetGateModule))),
       forgetGateModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(output.submat(
       3 * outSize, 0, 4 * outSize - 1, batchSize - 1)), std::move(
       boost::apply_visitor(outputParameterVisitor, outputGateModule))),
       outputGateModule);
@@ -139,32 +169,43 @@ void LSTM<InputDataType, OutputDataType>::Forward(
   // Update the cell (nextCell): cmul1 + cmul2
   // where cmul1 is input gate * hidden state and
   // cmul2 is forget gate * cell (prevCell).
-  arma::mat tempPrevCell = (boost::apply_visitor(outputParameterVisitor,
+  OutputDataType tempPrevCell = (boost::apply_visitor(outputParameterVisitor,
       inputGateModule) % boost::apply_visitor(outputParameterVisitor,
       hiddenStateModule)) + (boost::apply_visitor(outputParameterVisitor,
       forgetGateModule) % *prevCell);
 
-  boost::apply_visitor(ForwardVisitor(std::move(tempPrevCell), std::move(
-      boost::apply_visitor(outputParameterVisitor, cellModule))), cellModule);
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(tempPrevCell),
+      std::move(boost::apply_visitor(outputParameterVisitor, cellModule))),
+      cellModule);
 
-  boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellModule)), std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule))), cellActivationModule);
+  boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, cellModule)), std::move(
+      boost::apply_visitor(outputParameterVisitor, cellActivationModule))),
+      cellActivationModule);
 
   output = boost::apply_visitor(outputParameterVisitor,
       cellActivationModule) % boost::apply_visitor(outputParameterVisitor,
       outputGateModule);
 
+  // The stored states are not changed by a recomputed time step.
+  if (replay)
+  {
+    prevOutput = lastOutput;
+    prevCell = lastCell;
+    replay = false;
+    return;
+  }
+
   forwardStep++;
   if (forwardStep == rho)
   {
     forwardStep = 0;
     if (!deterministic)
     {
-      outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
+      outParameter.push_back(std::move(OutputDataType(allZeros.memptr(),
         allZeros.n_rows, allZeros.n_cols, false, false)));
 
-      cellParameter.push_back(std::move(arma::mat(allZeros.memptr(),
+      cellParameter.push_back(std::move(OutputDataType(allZeros.memptr(),
         allZeros.n_rows, allZeros.n_cols, false, false)));
 
       prevOutput = --outParameter.end();
@@ -215,7 +256,7 @@ void LSTM<InputDataType, OutputDataType>::Backward(
   if (input.n_cols != batchSize)
   {
     batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
+    prevError.resize(4 * outSize, batchSize);
   }
 
   if ((outParameter.size() - backwardStep  - 1) % rho != 0 && backwardStep != 0)
@@ -228,18 +269,20 @@ void LSTM<InputDataType, OutputDataType>::Backward(
     backIterator = --(--cellParameter.end());
   }
 
-  arma::mat g1 = boost::apply_visitor(outputParameterVisitor,
+  // The errors are stored in members, so their memory is reused by the next
+  // steps.
+  outputGateError = boost::apply_visitor(outputParameterVisitor,
       cellActivationModule) % gy;
 
-  arma::mat g2 = boost::apply_visitor(outputParameterVisitor,
+  cellActivationOutputError = boost::apply_visitor(outputParameterVisitor,
       outputGateModule) % gy;
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule)), std::move(g2),
-      std::move(boost::apply_visitor(deltaVisitor, cellActivationModule))),
-      cellActivationModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, cellActivationModule)),
+      std::move(cellActivationOutputError), std::move(boost::apply_visitor(
+      deltaVisitor, cellActivationModule))), cellActivationModule);
 
-  arma::mat cellActivationError = boost::apply_visitor(deltaVisitor,
+  cellActivationError = boost::apply_visitor(deltaVisitor,
       cellActivationModule);
 
   if (backwardStep > 0)
@@ -247,36 +290,36 @@ void LSTM<InputDataType, OutputDataType>::Backward(
     cellActivationError += forgetGateError;
   }
 
-  arma::mat g4 = boost::apply_visitor(outputParameterVisitor,
+  hiddenStateError = boost::apply_visitor(outputParameterVisitor,
       inputGateModule) % cellActivationError;
 
-  arma::mat g5 = boost::apply_visitor(outputParameterVisitor,
+  inputGateError = boost::apply_visitor(outputParameterVisitor,
       hiddenStateModule) % cellActivationError;
 
   forgetGateError = boost::apply_visitor(outputParameterVisitor,
       forgetGateModule) % cellActivationError;
 
-  arma::mat g7 = *backIterator % cellActivationError;
+  forgetGateOutputError = *backIterator % cellActivationError;
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule)), std::move(g5),
-      std::move(boost::apply_visitor(deltaVisitor, inputGateModule))),
-      inputGateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, inputGateModule)),
+      std::move(inputGateError), std::move(boost::apply_visitor(deltaVisitor,
+      inputGateModule))), inputGateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, hiddenStateModule)), std::move(g4),
-      std::move(boost::apply_visitor(deltaVisitor, hiddenStateModule))),
-      hiddenStateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, hiddenStateModule)),
+      std::move(hiddenStateError), std::move(boost::apply_visitor(deltaVisitor,
+      hiddenStateModule))), hiddenStateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, forgetGateModule)), std::move(g7),
-      std::move(boost::apply_visitor(deltaVisitor, forgetGateModule))),
-      forgetGateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, forgetGateModule)),
+      std::move(forgetGateOutputError), std::move(boost::apply_visitor(
+      deltaVisitor, forgetGateModule))), forgetGateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, outputGateModule)), std::move(g1),
-      std::move(boost::apply_visitor(deltaVisitor, outputGateModule))),
-      outputGateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, outputGateModule)),
+      std::move(outputGateError), std::move(boost::apply_visitor(deltaVisitor,
+      outputGateModule))), outputGateModule);
 
   prevError.submat(0, 0, 1 * outSize - 1, batchSize - 1) = boost::apply_visitor(
       deltaVisitor, inputGateModule);
@@ -287,15 +330,15 @@ void LSTM<InputDataType, OutputDataType>::Backward(
   prevError.submat(3 * outSize, 0, 4 * outSize - 1, batchSize - 1) =
       boost::apply_visitor(deltaVisitor, outputGateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, input2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, input2GateModule))),
-      input2GateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, input2GateModule)),
+      std::move(prevError), std::move(boost::apply_visitor(deltaVisitor,
+      input2GateModule))), input2GateModule);
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, output2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, output2GateModule))),
-      output2GateModule);
+  boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+      boost::apply_visitor(outputParameterVisitor, output2GateModule)),
+      std::move(prevError), std::move(boost::apply_visitor(deltaVisitor,
+      output2GateModule))), output2GateModule);
 
   backwardStep++;
   backIterator--;
@@ -315,10 +358,10 @@ void LSTM<InputDataType, OutputDataType>::Gradient(
     gradIterator = --(--outParameter.end());
   }
 
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(prevError)),
-      input2GateModule);
+  boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+      std::move(prevError)), input2GateModule);
 
-  boost::apply_visitor(GradientVisitor(
+  boost::apply_visitor(GradientVisitor<OutputDataType>(
       std::move(*gradIterator),
       std::move(prevError)), output2GateModule);
 
@@ -329,11 +372,11 @@ template<typename InputDataType, typename OutputDataType>
 void LSTM<InputDataType, OutputDataType>::ResetCell()
 {
   outParameter.clear();
-  outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
+  outParameter.push_back(std::move(OutputDataType(allZeros.memptr(),
     allZeros.n_rows, allZeros.n_cols, false, false)));
 
   cellParameter.clear();
-  cellParameter.push_back(std::move(arma::mat(allZeros.memptr(),
+  cellParameter.push_back(std::move(OutputDataType(allZeros.memptr(),
     allZeros.n_rows, allZeros.n_cols, false, false)));
 
   prevOutput = outParameter.begin();
@@ -346,6 +389,13 @@ void LSTM<InputDataType, OutputDataType>::ResetCell()
   backwardStep = 0;
 }
 
+template<typename InputDataType, typename OutputDataType>
+void LSTM<InputDataType, OutputDataType>::Replay(const size_t step)
+{
+  replay = true;
+  replayStep = step;
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void LSTM<InputDataType, OutputDataType>::serialize(
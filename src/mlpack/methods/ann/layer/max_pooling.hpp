@@ -157,7 +157,8 @@ class MaxPooling
     {
       for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dH)
       {
-        arma::mat subInput = input(arma::span(rowidx, rowidx + kW - 1 - offset),
+        arma::Mat<eT> subInput = input(
+            arma::span(rowidx, rowidx + kW - 1 - offset),
             arma::span(colidx, colidx + kH - 1 - offset));
 
         const size_t idx = pooling.Pooling(subInput);
@@ -236,13 +237,13 @@ class MaxPooling
   bool deterministic;
 
   //! Locally-stored output parameter.
-  arma::cube outputTemp;
+  arma::Cube<typename OutputDataType::elem_type> outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  arma::Cube<typename OutputDataType::elem_type> inputTemp;
 
   //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
+  arma::Cube<typename OutputDataType::elem_type> gTemp;
 
   //! Locally-stored pooling strategy.
   MaxPoolingRule pooling;
@@ -266,7 +267,11 @@ class MaxPooling
   arma::Col<size_t> indicesCol;
 
   //! Locally-stored pooling indicies.
-  std::vector<arma::cube> poolingIndices;
+  std::vector<arma::Cube<typename OutputDataType::elem_type> > poolingIndices;
+
+  //! The number of pooling indices that are in use; the remaining ones are
+  //! kept to be reused by later forward passes.
+  size_t poolingStep;
 }; // class MaxPooling
 
 } // namespace ann
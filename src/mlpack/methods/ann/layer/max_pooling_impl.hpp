@@ -20,7 +20,8 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 template<typename InputDataType, typename OutputDataType>
-MaxPooling<InputDataType, OutputDataType>::MaxPooling()
+MaxPooling<InputDataType, OutputDataType>::MaxPooling() :
+    poolingStep(0)
 {
   // Nothing to do here.
 }
@@ -43,7 +44,8 @@ MaxPooling<InputDataType, OutputDataType>::MaxPooling(
     inputHeight(0),
     outputWidth(0),
     outputHeight(0),
-    deterministic(false)
+    deterministic(false),
+    poolingStep(0)
 {
   // Nothing to do here.
 }
@@ -54,7 +56,10 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
   const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
   const size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  // The input and the results are copied into the existing buffers, so no
+  // memory is allocated once the buffers have the right size.
+  inputTemp = arma::Cube<eT>(const_cast<eT*>(input.memptr()), inputWidth,
+      inputHeight, slices, false, true);
 
   if (floor)
   {
@@ -74,7 +79,13 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
 
   if (!deterministic)
   {
-    poolingIndices.push_back(outputTemp);
+    // Reuse the pooling indices of an earlier pass, if there is one.
+    if (poolingStep == poolingIndices.size())
+      poolingIndices.push_back(outputTemp);
+    else
+      poolingIndices[poolingStep] = outputTemp;
+
+    poolingStep++;
   }
 
   if (!reset)
@@ -93,7 +104,7 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     if (!deterministic)
     {
       PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-        poolingIndices.back().slice(s));
+        poolingIndices[poolingStep - 1].slice(s));
     }
     else
     {
@@ -102,7 +113,8 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     }
   }
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1, false,
+      true);
 
   outputWidth = outputTemp.n_rows;
   outputHeight = outputTemp.n_cols;
@@ -114,21 +126,21 @@ template<typename eT>
 void MaxPooling<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
+  const arma::Cube<eT> mappedError(gy.memptr(), outputWidth, outputHeight,
+      outSize, false, true);
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
+  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
   for (size_t s = 0; s < mappedError.n_slices; s++)
   {
     Unpooling(mappedError.slice(s), gTemp.slice(s),
-        poolingIndices.back().slice(s));
+        poolingIndices[poolingStep - 1].slice(s));
   }
 
-  poolingIndices.pop_back();
+  poolingStep--;
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1, false, true);
 }
 
 template<typename InputDataType, typename OutputDataType>
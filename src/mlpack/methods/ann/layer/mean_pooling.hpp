@@ -137,11 +137,10 @@ class MeanPooling
     {
       for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dW)
       {
-        arma::mat subInput = input(
+        output(i, j) = arma::accu(input(
             arma::span(rowidx, rowidx + rStep - 1 - offset),
-            arma::span(colidx, colidx + cStep - 1 - offset));
-
-        output(i, j) = arma::mean(arma::mean(subInput));
+            arma::span(colidx, colidx + cStep - 1 - offset))) /
+            ((rStep - offset) * (cStep - offset));
       }
     }
   }
@@ -160,19 +159,13 @@ class MeanPooling
     const size_t rStep = input.n_rows / error.n_rows - offset;
     const size_t cStep = input.n_cols / error.n_cols - offset;
 
-    arma::Mat<eT> unpooledError;
     for (size_t j = 0; j < input.n_cols - cStep; j += cStep)
     {
       for (size_t i = 0; i < input.n_rows - rStep; i += rStep)
       {
-        const arma::Mat<eT>& inputArea = input(arma::span(i, i + rStep - 1),
-            arma::span(j, j + cStep - 1));
-
-        unpooledError = arma::Mat<eT>(inputArea.n_rows, inputArea.n_cols);
-        unpooledError.fill(error(i / rStep, j / cStep) / inputArea.n_elem);
-
         output(arma::span(i, i + rStep - 1 - offset),
-            arma::span(j, j + cStep - 1 - offset)) += unpooledError;
+            arma::span(j, j + cStep - 1 - offset)) +=
+            error(i / rStep, j / cStep) / (rStep * cStep);
       }
     }
   }
@@ -220,13 +213,13 @@ class MeanPooling
   size_t offset;
 
   //! Locally-stored output parameter.
-  arma::cube outputTemp;
+  arma::Cube<typename OutputDataType::elem_type> outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  arma::Cube<typename OutputDataType::elem_type> inputTemp;
 
   //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
+  arma::Cube<typename OutputDataType::elem_type> gTemp;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -54,7 +54,10 @@ void MeanPooling<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
   size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  // The input and the results are copied into the existing buffers, so no
+  // memory is allocated once the buffers have the right size.
+  inputTemp = arma::Cube<eT>(const_cast<eT*>(input.memptr()), inputWidth,
+      inputHeight, slices, false, true);
 
   if (floor)
   {
@@ -77,7 +80,8 @@ void MeanPooling<InputDataType, OutputDataType>::Forward(
   for (size_t s = 0; s < inputTemp.n_slices; s++)
     Pooling(inputTemp.slice(s), outputTemp.slice(s));
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1, false,
+      true);
 
   outputWidth = outputTemp.n_rows;
   outputHeight = outputTemp.n_cols;
@@ -91,10 +95,10 @@ void MeanPooling<InputDataType, OutputDataType>::Backward(
   arma::Mat<eT>&& gy,
   arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
+  const arma::Cube<eT> mappedError(gy.memptr(), outputWidth, outputHeight,
+      outSize, false, true);
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
+  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
   for (size_t s = 0; s < mappedError.n_slices; s++)
@@ -102,7 +106,7 @@ void MeanPooling<InputDataType, OutputDataType>::Backward(
     Unpooling(inputTemp.slice(s), mappedError.slice(s), gTemp.slice(s));
   }
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem, 1, false, true);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -120,9 +120,9 @@ class PReLU
   OutputDataType& Gradient() { return gradient; }
 
   //! Get the non zero gradient.
-  double const& Alpha() const { return alpha(0); }
+  typename OutputDataType::elem_type const& Alpha() const { return alpha(0); }
   //! Modify the non zero gradient.
-  double& Alpha() { return alpha(0); }
+  typename OutputDataType::elem_type& Alpha() { return alpha(0); }
 
   /**
    * Serialize the layer.
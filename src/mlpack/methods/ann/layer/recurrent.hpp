@@ -104,8 +104,19 @@ class Recurrent
                 arma::Mat<eT>&& error,
                 arma::Mat<eT>&& /* gradient */);
 
+  /**
+   * Recompute the given time step of the current sequence with the next call
+   * of Forward(), from the feedback output that was stored for the previous
+   * time step, without storing anything again.  RNN uses this to recompute the
+   * activations of the layers during the backward pass instead of storing them
+   * (see RNN::Recompute()).
+   *
+   * @param step Time step to recompute.
+   */
+  void Replay(const size_t step);
+
   //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
+  std::vector<LayerTypes<OutputDataType>>& Model() { return network; }
 
     //! The value of the deterministic parameter.
   bool Deterministic() const { return deterministic; }
@@ -145,16 +156,16 @@ class Recurrent
 
  private:
   //! Locally-stored start module.
-  LayerTypes startModule;
+  LayerTypes<OutputDataType> startModule;
 
   //! Locally-stored input module.
-  LayerTypes inputModule;
+  LayerTypes<OutputDataType> inputModule;
 
   //! Locally-stored feedback module.
-  LayerTypes feedbackModule;
+  LayerTypes<OutputDataType> feedbackModule;
 
   //! Locally-stored transfer module.
-  LayerTypes transferModule;
+  LayerTypes<OutputDataType> transferModule;
 
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
@@ -171,32 +182,38 @@ class Recurrent
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
 
+  //! Whether the next Forward() call recomputes a stored time step.
+  bool replay;
+
+  //! Locally-stored time step that is recomputed by the next Forward() call.
+  size_t replayStep;
+
   //! Locally-stored weight object.
   OutputDataType parameters;
 
   //! Locally-stored initial module.
-  LayerTypes initialModule;
+  LayerTypes<OutputDataType> initialModule;
 
   //! Locally-stored recurrent module.
-  LayerTypes recurrentModule;
+  LayerTypes<OutputDataType> recurrentModule;
 
   //! Locally-stored model modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<OutputDataType>> network;
 
   //! Locally-stored merge module.
-  LayerTypes mergeModule;
+  LayerTypes<OutputDataType> mergeModule;
 
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<OutputDataType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<OutputDataType> outputParameterVisitor;
 
   //! Locally-stored feedback output parameters.
-  std::vector<arma::mat> feedbackOutputParameter;
+  std::vector<OutputDataType> feedbackOutputParameter;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -211,7 +228,7 @@ class Recurrent
   OutputDataType outputParameter;
 
   //! Locally-stored recurrent error parameter.
-  arma::mat recurrentError;
+  OutputDataType recurrentError;
 }; // class Recurrent
 
 } // namespace ann
@@ -71,25 +71,26 @@ void RecurrentAttention<InputDataType, OutputDataType>::Forward(
   {
     if (forwardStep == 0)
     {
-      boost::apply_visitor(ForwardVisitor(std::move(initialInput), std::move(
-          boost::apply_visitor(outputParameterVisitor, actionModule))),
-          actionModule);
+      boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+          initialInput), std::move(boost::apply_visitor(outputParameterVisitor,
+          actionModule))), actionModule);
     }
     else
     {
-      boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-          outputParameterVisitor, rnnModule)), std::move(boost::apply_visitor(
-          outputParameterVisitor, actionModule))), actionModule);
+      boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+          boost::apply_visitor(outputParameterVisitor, rnnModule)), std::move(
+          boost::apply_visitor(outputParameterVisitor, actionModule))),
+          actionModule);
     }
 
     // Initialize the glimpse input.
-    arma::mat glimpseInput = arma::zeros(input.n_elem, 2);
+    OutputDataType glimpseInput = arma::zeros<OutputDataType>(input.n_elem, 2);
     glimpseInput.col(0) = input;
     glimpseInput.submat(0, 1, boost::apply_visitor(outputParameterVisitor,
         actionModule).n_elem - 1, 1) = boost::apply_visitor(
         outputParameterVisitor, actionModule);
 
-    boost::apply_visitor(ForwardVisitor(std::move(glimpseInput),
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(glimpseInput),
         std::move(boost::apply_visitor(outputParameterVisitor, rnnModule))),
         rnnModule);
 
@@ -98,7 +99,7 @@ void RecurrentAttention<InputDataType, OutputDataType>::Forward(
     {
       for (size_t l = 0; l < network.size(); ++l)
       {
-        boost::apply_visitor(SaveOutputParameterVisitor(
+        boost::apply_visitor(SaveOutputParameterVisitor<OutputDataType>(
             std::move(moduleOutputParameter)), network[l]);
       }
     }
@@ -136,9 +137,9 @@ void RecurrentAttention<InputDataType, OutputDataType>::Backward(
   if (backwardStep == 0)
   {
     size_t offset = 0;
-    offset += boost::apply_visitor(GradientSetVisitor(
+    offset += boost::apply_visitor(GradientSetVisitor<OutputDataType>(
         std::move(intermediateGradient), offset), rnnModule);
-    boost::apply_visitor(GradientSetVisitor(
+    boost::apply_visitor(GradientSetVisitor<OutputDataType>(
         std::move(intermediateGradient), offset), actionModule);
 
     attentionGradient.zeros();
@@ -158,25 +159,26 @@ void RecurrentAttention<InputDataType, OutputDataType>::Backward(
 
     for (size_t l = 0; l < network.size(); ++l)
     {
-      boost::apply_visitor(LoadOutputParameterVisitor(
+      boost::apply_visitor(LoadOutputParameterVisitor<OutputDataType>(
          std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
     }
 
     if (backwardStep == (rho - 1))
     {
-      boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-          outputParameterVisitor, actionModule)), std::move(actionError),
-          std::move(actionDelta)), actionModule);
+      boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+          boost::apply_visitor(outputParameterVisitor, actionModule)),
+          std::move(actionError), std::move(actionDelta)), actionModule);
     }
     else
     {
-      boost::apply_visitor(BackwardVisitor(std::move(initialInput),
-          std::move(actionError), std::move(actionDelta)), actionModule);
+      boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+          initialInput), std::move(actionError), std::move(actionDelta)),
+          actionModule);
     }
 
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, rnnModule)), std::move(recurrentError),
-        std::move(rnnDelta)), rnnModule);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, rnnModule)),
+        std::move(recurrentError), std::move(rnnDelta)), rnnModule);
 
     if (backwardStep == 0)
     {
@@ -199,9 +201,9 @@ void RecurrentAttention<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& /* gradient */)
 {
   size_t offset = 0;
-  offset += boost::apply_visitor(GradientUpdateVisitor(
+  offset += boost::apply_visitor(GradientUpdateVisitor<OutputDataType>(
       std::move(attentionGradient), offset), rnnModule);
-  boost::apply_visitor(GradientUpdateVisitor(
+  boost::apply_visitor(GradientUpdateVisitor<OutputDataType>(
       std::move(attentionGradient), offset), actionModule);
 }
 
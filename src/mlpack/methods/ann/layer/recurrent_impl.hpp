@@ -30,7 +30,9 @@ Recurrent<InputDataType, OutputDataType>::Recurrent() :
     forwardStep(0),
     backwardStep(0),
     gradientStep(0),
-    deterministic(false)
+    deterministic(false),
+    replay(false),
+    replayStep(0)
 {
   // Nothing to do.
 }
@@ -56,25 +58,30 @@ Recurrent<InputDataType, OutputDataType>::Recurrent(
     forwardStep(0),
     backwardStep(0),
     gradientStep(0),
-    deterministic(false)
+    deterministic(false),
+    replay(false),
+    replayStep(0)
 {
-  initialModule = new Sequential<>();
-  mergeModule = new AddMerge<>();
-  recurrentModule = new Sequential<>(false);
+  initialModule = new Sequential<OutputDataType, OutputDataType>();
+  mergeModule = new AddMerge<OutputDataType, OutputDataType>();
+  recurrentModule = new Sequential<OutputDataType, OutputDataType>(false);
 
-  boost::apply_visitor(AddVisitor(inputModule), initialModule);
-  boost::apply_visitor(AddVisitor(startModule), initialModule);
-  boost::apply_visitor(AddVisitor(transferModule), initialModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(inputModule), initialModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(startModule), initialModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(transferModule),
+      initialModule);
 
   boost::apply_visitor(weightSizeVisitor, startModule);
   boost::apply_visitor(weightSizeVisitor, inputModule);
   boost::apply_visitor(weightSizeVisitor, feedbackModule);
   boost::apply_visitor(weightSizeVisitor, transferModule);
 
-  boost::apply_visitor(AddVisitor(inputModule), mergeModule);
-  boost::apply_visitor(AddVisitor(feedbackModule), mergeModule);
-  boost::apply_visitor(AddVisitor(mergeModule), recurrentModule);
-  boost::apply_visitor(AddVisitor(transferModule), recurrentModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(inputModule), mergeModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(feedbackModule), mergeModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(mergeModule),
+      recurrentModule);
+  boost::apply_visitor(AddVisitor<OutputDataType>(transferModule),
+      recurrentModule);
 
   network.push_back(initialModule);
   network.push_back(mergeModule);
@@ -82,33 +89,62 @@ Recurrent<InputDataType, OutputDataType>::Recurrent(
   network.push_back(recurrentModule);
 }
 
+template<typename InputDataType, typename OutputDataType>
+void Recurrent<InputDataType, OutputDataType>::Replay(const size_t step)
+{
+  replay = true;
+  replayStep = step;
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename eT>
 void Recurrent<InputDataType, OutputDataType>::Forward(
     arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  if (forwardStep == 0)
+  const size_t step = replay ? (replayStep % rho) : forwardStep;
+  if (step == 0)
   {
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
-        initialModule);
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(output)), initialModule);
   }
   else
   {
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-        boost::apply_visitor(outputParameterVisitor, inputModule))),
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(outputParameterVisitor, inputModule))),
         inputModule);
 
-    boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, transferModule)), std::move(
-        boost::apply_visitor(outputParameterVisitor, feedbackModule))),
-        feedbackModule);
+    if (replay)
+    {
+      // The feedback outputs of the current sequence are the last ones that
+      // were stored; the last of them belongs to the time step before
+      // forwardStep.
+      const size_t lastStep = (forwardStep + rho - 1) % rho;
+      boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+          feedbackOutputParameter[feedbackOutputParameter.size() - lastStep +
+          step - 2]), std::move(boost::apply_visitor(outputParameterVisitor,
+          feedbackModule))), feedbackModule);
+    }
+    else
+    {
+      boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(
+          boost::apply_visitor(outputParameterVisitor, transferModule)),
+          std::move(boost::apply_visitor(outputParameterVisitor,
+          feedbackModule))), feedbackModule);
+    }
 
-    boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
-        recurrentModule);
+    boost::apply_visitor(ForwardVisitor<OutputDataType>(std::move(input),
+        std::move(output)), recurrentModule);
   }
 
   output = boost::apply_visitor(outputParameterVisitor, transferModule);
 
+  // The stored feedback outputs are not changed by a recomputed time step.
+  if (replay)
+  {
+    replay = false;
+    return;
+  }
+
   // Save the feedback output parameter when training the module.
   if (!deterministic)
   {
@@ -133,7 +169,9 @@ template<typename eT>
 void Recurrent<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  if (!recurrentError.is_empty())
+  // The error of the previous step is kept only if it belongs to the same
+  // batch of sequences.
+  if (arma::size(recurrentError) == arma::size(gy))
   {
     recurrentError += gy;
   }
@@ -144,26 +182,27 @@ void Recurrent<InputDataType, OutputDataType>::Backward(
 
   if (backwardStep < (rho - 1))
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, recurrentModule)), std::move(recurrentError),
-        std::move(boost::apply_visitor(deltaVisitor, recurrentModule))),
-        recurrentModule);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, recurrentModule)),
+        std::move(recurrentError), std::move(boost::apply_visitor(deltaVisitor,
+        recurrentModule))), recurrentModule);
 
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, inputModule)), std::move(
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, inputModule)), std::move(
         boost::apply_visitor(deltaVisitor, recurrentModule)), std::move(g)),
         inputModule);
 
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, feedbackModule)), std::move(
-        boost::apply_visitor(deltaVisitor, recurrentModule)), std::move(
-        boost::apply_visitor(deltaVisitor, feedbackModule))), feedbackModule);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, feedbackModule)),
+        std::move(boost::apply_visitor(deltaVisitor, recurrentModule)),
+        std::move(boost::apply_visitor(deltaVisitor, feedbackModule))),
+        feedbackModule);
   }
   else
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, initialModule)), std::move(recurrentError),
-        std::move(g)), initialModule);
+    boost::apply_visitor(BackwardVisitor<OutputDataType>(std::move(
+        boost::apply_visitor(outputParameterVisitor, initialModule)),
+        std::move(recurrentError), std::move(g)), initialModule);
   }
 
   recurrentError = boost::apply_visitor(deltaVisitor, feedbackModule);
@@ -179,25 +218,28 @@ void Recurrent<InputDataType, OutputDataType>::Gradient(
 {
   if (gradientStep < (rho - 1))
   {
-    boost::apply_visitor(GradientVisitor(std::move(input), std::move(error)),
-        recurrentModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+        std::move(error)), recurrentModule);
 
-    boost::apply_visitor(GradientVisitor(std::move(input), std::move(
-        boost::apply_visitor(deltaVisitor, mergeModule))), inputModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(deltaVisitor, mergeModule))),
+        inputModule);
 
-    boost::apply_visitor(GradientVisitor(std::move(
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(
         feedbackOutputParameter[feedbackOutputParameter.size() - 2 -
         gradientStep]), std::move(boost::apply_visitor(deltaVisitor,
         mergeModule))), feedbackModule);
   }
   else
   {
-    boost::apply_visitor(GradientZeroVisitor(), recurrentModule);
-    boost::apply_visitor(GradientZeroVisitor(), inputModule);
-    boost::apply_visitor(GradientZeroVisitor(), feedbackModule);
+    boost::apply_visitor(GradientZeroVisitor<OutputDataType>(),
+        recurrentModule);
+    boost::apply_visitor(GradientZeroVisitor<OutputDataType>(), inputModule);
+    boost::apply_visitor(GradientZeroVisitor<OutputDataType>(), feedbackModule);
 
-    boost::apply_visitor(GradientVisitor(std::move(input), std::move(
-        boost::apply_visitor(deltaVisitor, startModule))), initialModule);
+    boost::apply_visitor(GradientVisitor<OutputDataType>(std::move(input),
+        std::move(boost::apply_visitor(deltaVisitor, startModule))),
+        initialModule);
   }
 
   gradientStep++;
@@ -238,23 +280,29 @@ void Recurrent<InputDataType, OutputDataType>::serialize(
   // Set up the network.
   if (Archive::is_loading::value)
   {
-    initialModule = new Sequential<>();
-    mergeModule = new AddMerge<>();
-    recurrentModule = new Sequential<>(false);
+    initialModule = new Sequential<OutputDataType, OutputDataType>();
+    mergeModule = new AddMerge<OutputDataType, OutputDataType>();
+    recurrentModule = new Sequential<OutputDataType, OutputDataType>(false);
 
-    boost::apply_visitor(AddVisitor(inputModule), initialModule);
-    boost::apply_visitor(AddVisitor(startModule), initialModule);
-    boost::apply_visitor(AddVisitor(transferModule), initialModule);
+    boost::apply_visitor(AddVisitor<OutputDataType>(inputModule),
+        initialModule);
+    boost::apply_visitor(AddVisitor<OutputDataType>(startModule),
+        initialModule);
+    boost::apply_visitor(AddVisitor<OutputDataType>(transferModule),
+        initialModule);
 
     boost::apply_visitor(weightSizeVisitor, startModule);
     boost::apply_visitor(weightSizeVisitor, inputModule);
     boost::apply_visitor(weightSizeVisitor, feedbackModule);
     boost::apply_visitor(weightSizeVisitor, transferModule);
 
-    boost::apply_visitor(AddVisitor(inputModule), mergeModule);
-    boost::apply_visitor(AddVisitor(feedbackModule), mergeModule);
-    boost::apply_visitor(AddVisitor(mergeModule), recurrentModule);
-    boost::apply_visitor(AddVisitor(transferModule), recurrentModule);
+    boost::apply_visitor(AddVisitor<OutputDataType>(inputModule), mergeModule);
+    boost::apply_visitor(AddVisitor<OutputDataType>(feedbackModule),
+        mergeModule);
+    boost::apply_visitor(AddVisitor<OutputDataType>(mergeModule),
+        recurrentModule);
+    boost::apply_visitor(AddVisitor<OutputDataType>(transferModule),
+        recurrentModule);
 
     network.push_back(initialModule);
     network.push_back(mergeModule);
@@ -0,0 +1,341 @@
+/**
+ * @file quantized_ffn.hpp
+ *
+ * Definition of the QuantizedFFN class, an inference-only copy of a trained
+ * feed forward network with 8-bit weights and activations.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_FFN_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A trained feed forward network, quantized after training for prediction.
+ * As in FrozenFFN, the layers are fused into a short list of stages; each
+ * Linear, LinearNoBias or Convolution layer and the activation layer after it
+ * form one stage, and Dropout layers are folded into the weights.  In each
+ * stage,
+ *
+ *  - the input is quantized to unsigned 8-bit integers, with a scale and a
+ *    zero point for each input channel (each dimension of the input of a
+ *    linear stage, and each input map of a convolution);
+ *  - the weights are signed 8-bit integers, with a scale for each output
+ *    channel (each output unit or output map), into which the scales of the
+ *    input channels are folded;
+ *  - the products are summed in 32-bit integers, which are then scaled back,
+ *    and the bias and the activation function are applied in double
+ *    precision.
+ *
+ * The scales of the inputs are calibrated from a representative batch of
+ * points: each input channel covers the range of the values that it takes for
+ * the batch (and 0, which is represented exactly).  Larger values are clamped.
+ * The calibration batch is also used to measure how far the predictions of
+ * the quantized network are from the predictions of the network; see
+ * CalibrationError() and CalibrationAgreement(), and Compare() for other data.
+ *
+ * The weights take an eighth of the memory of the weights of the network.  The
+ * integer dot products are written as plain loops, which compilers vectorize
+ * with the multiply-add instructions of the target (for instance AVX2, or
+ * AVX-512 VNNI with -march=native); the points of a batch are split between
+ * the OpenMP threads.
+ *
+ * Only the layers that can be fused this way are supported: Linear,
+ * LinearNoBias, Convolution, Dropout, LogSoftMax and the identity, rectifier,
+ * sigmoid and tanh activation layers.  Convolutions are computed like the
+ * Im2ColConvolution rule (which gives the same results as NaiveConvolution
+ * for unit strides).  A quantized network can be saved with data::Save() and
+ * loaded by a process that only serves predictions.
+ *
+ * @code
+ * FFN<NegativeLogLikelihood<> > model;
+ * // ... add layers and train the model ...
+ *
+ * QuantizedFFN quantized(model, calibrationData);
+ * Log::Info << "Largest error: " << quantized.CalibrationError() << std::endl;
+ * data::Save("quantized.xml", "quantized", quantized);
+ *
+ * arma::mat predictions;
+ * quantized.Predict(testData, predictions);
+ * @endcode
+ */
+class QuantizedFFN
+{
+ public:
+  //! The elementwise activation functions a stage can apply.
+  enum ActivationType
+  {
+    IDENTITY,
+    RECTIFIER,
+    LOGISTIC,
+    TANH,
+    LOG_SOFTMAX
+  };
+
+  //! The kinds of stages.
+  enum StageType
+  {
+    //! A stage that only scales its input and applies the activation.
+    ELEMENTWISE,
+    //! A quantized matrix product.
+    LINEAR,
+    //! A quantized convolution.
+    CONVOLUTION
+  };
+
+  //! The shape of the input of a convolution stage and of its filters.
+  struct Geometry
+  {
+    //! The number of input maps.
+    size_t inSize;
+    //! The width of the input maps.
+    size_t inputWidth;
+    //! The height of the input maps.
+    size_t inputHeight;
+    //! The width of the filters.
+    size_t kW;
+    //! The height of the filters.
+    size_t kH;
+    //! The stride of the filters in the x direction.
+    size_t dW;
+    //! The stride of the filters in the y direction.
+    size_t dH;
+    //! The padding width.
+    size_t padW;
+    //! The padding height.
+    size_t padH;
+
+    //! Serialize the geometry.
+    template<typename Archive>
+    void Serialize(Archive& ar, const unsigned int /* version */)
+    {
+      ar & data::CreateNVP(inSize, "inSize");
+      ar & data::CreateNVP(inputWidth, "inputWidth");
+      ar & data::CreateNVP(inputHeight, "inputHeight");
+      ar & data::CreateNVP(kW, "kW");
+      ar & data::CreateNVP(kH, "kH");
+      ar & data::CreateNVP(dW, "dW");
+      ar & data::CreateNVP(dH, "dH");
+      ar & data::CreateNVP(padW, "padW");
+      ar & data::CreateNVP(padH, "padH");
+    }
+  };
+
+  /**
+   * Create an empty quantized network, which returns its input unchanged.
+   * This is mostly useful before loading a quantized network with
+   * data::Load().
+   */
+  QuantizedFFN();
+
+  /**
+   * Quantize the given trained network, calibrating the inputs of the stages
+   * with the given points.  If the parameters of the network have not been
+   * initialized yet, they are initialized first.  A std::invalid_argument
+   * exception is thrown if the network contains a layer that cannot be
+   * quantized.
+   *
+   * @param network The network to quantize.
+   * @param calibrationData Representative input points (one per column).
+   */
+  template<typename OutputLayerType, typename InitializationRuleType>
+  QuantizedFFN(FFN<OutputLayerType, InitializationRuleType>& network,
+               const arma::mat& calibrationData);
+
+  /**
+   * Predict the responses to the given data points.
+   *
+   * @param predictors Input data points (one per column).
+   * @param results Matrix to store the predicted responses in.
+   */
+  void Predict(const arma::mat& predictors, arma::mat& results);
+
+  /**
+   * Compare the predictions of the quantized network with the given reference
+   * predictions (for instance, the results of FFN::Predict() of the network
+   * that was quantized).
+   *
+   * @param predictors Input data points (one per column).
+   * @param reference Reference predictions for the points.
+   * @param maxError Set to the largest absolute difference between the
+   *     predictions.
+   * @param agreement Set to the fraction of points for which both predictions
+   *     have the largest response in the same row (the same class).
+   */
+  void Compare(const arma::mat& predictors,
+               const arma::mat& reference,
+               double& maxError,
+               double& agreement);
+
+  //! Get the number of stages.
+  size_t Stages() const { return stages.size(); }
+  //! Get the type of the given stage.
+  StageType Type(const size_t stage) const { return stages[stage].type; }
+  //! Get the activation function of the given stage.
+  ActivationType Activation(const size_t stage) const
+  {
+    return stages[stage].activation;
+  }
+  //! Get the quantized weights of the given stage (one column for each output
+  //! channel; empty for elementwise stages).
+  const arma::Mat<int8_t>& Weight(const size_t stage) const
+  {
+    return stages[stage].weight;
+  }
+
+  //! Get the largest absolute error of the predictions of the calibration
+  //! points.
+  double CalibrationError() const { return calibrationError; }
+  //! Get the fraction of the calibration points with the same predicted class
+  //! as with the network.
+  double CalibrationAgreement() const { return calibrationAgreement; }
+
+  //! Serialize the quantized network.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  // The visitor that quantizes the layers of a network adds the stages.
+  friend class QuantizeVisitor;
+
+  //! A stage of the network.
+  struct Stage
+  {
+    //! The kind of the stage.
+    StageType type;
+    //! The activation function of the stage.
+    ActivationType activation;
+    //! The input scale of an elementwise stage.
+    double scale;
+    //! The shape of a convolution.
+    Geometry geometry;
+
+    //! The weights in double precision, until the stage is quantized (one
+    //! row for each output unit of a linear stage, or one column for each
+    //! output map of a convolution).
+    arma::mat floatWeight;
+    //! The quantized weights (one column for each output channel).
+    arma::Mat<int8_t> weight;
+    //! The scale of each output channel.
+    arma::vec weightScale;
+    //! The sum of the products of the quantized weights of each output
+    //! channel with the input zero points.
+    arma::Col<int32_t> offset;
+    //! The bias of each output channel.
+    arma::vec bias;
+
+    //! The scale of each input channel.
+    arma::vec inputScale;
+    //! The zero point of each input channel.
+    arma::Col<uint8_t> inputZero;
+  };
+
+  //! Add a linear stage with the given weight matrix and bias.
+  void AddLinear(const arma::mat& weight, const arma::vec& bias);
+
+  //! Add a convolution stage with the given kernels (one column for each
+  //! output map), bias and geometry.
+  void AddConvolution(const arma::mat& kernels,
+                      const arma::vec& bias,
+                      const Geometry& geometry);
+
+  //! Apply the given activation function to the output of the last stage.
+  void AddActivation(const ActivationType activation);
+
+  //! Scale the output of the last stage (or the input of the next one) by the
+  //! given factor.
+  void AddScale(const double scale);
+
+  //! Add the scale that could not be folded into a stage, if any.
+  void Finish();
+
+  //! Get the number of input dimensions of the given stage (0 for an
+  //! elementwise stage).
+  static size_t InputDimensions(const Stage& stage);
+
+  //! Get the width and the height of the output maps of a convolution.
+  static void OutputSize(const Geometry& geometry,
+                         size_t& outputWidth,
+                         size_t& outputHeight);
+
+  /**
+   * Copy the patches of the input maps of a convolution that the filters are
+   * applied to into the columns of a (kW kH inSize x outputWidth outputHeight)
+   * matrix, whose elements are ordered like the columns of the kernels.  The
+   * padding of each map has the given value.
+   */
+  template<typename eT>
+  static void Patches(const Geometry& geometry,
+                      const eT* input,
+                      const eT* padding,
+                      eT* patches);
+
+  //! Compute the dot product of quantized inputs and weights.
+  static int32_t DotProduct(const uint8_t* input,
+                            const int8_t* weight,
+                            const size_t n);
+
+  /**
+   * Set the input scales of the given stage from the given calibration
+   * inputs, and quantize its weights.
+   */
+  static void Calibrate(Stage& stage, const arma::mat& input);
+
+  //! Compute the given stage in double precision, with the weights that have
+  //! not been quantized yet.
+  void FloatForward(const Stage& stage,
+                    const arma::mat& input,
+                    arma::mat& output);
+
+  //! Quantize the input of the given stage.
+  static void QuantizeInput(const Stage& stage,
+                            const arma::mat& input,
+                            arma::Mat<uint8_t>& quantizedInput);
+
+  //! Compute the given stage with the quantized weights.
+  void QuantizedForward(const Stage& stage,
+                        const arma::mat& input,
+                        arma::mat& output);
+
+  //! Apply the given activation function to the given matrix, in place.
+  void Activate(const ActivationType activation, arma::mat& output);
+
+  //! The stages of the network.
+  std::vector<Stage> stages;
+
+  //! The scale that is still to be applied to the input of the next stage,
+  //! while the network is being quantized.
+  double pendingScale;
+
+  //! The largest absolute error of the predictions of the calibration points.
+  double calibrationError;
+  //! The fraction of the calibration points with the same predicted class.
+  double calibrationAgreement;
+
+  //! The buffers of the intermediate results of Predict().
+  arma::mat buffers[2];
+
+  //! The buffer of the quantized input of a stage.
+  arma::Mat<uint8_t> quantizedInput;
+
+  //! The buffer of the input of activation functions that cannot be applied
+  //! in place.
+  arma::mat activationInput;
+}; // class QuantizedFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,640 @@
+/**
+ * @file quantized_ffn_impl.hpp
+ *
+ * Implementation of the QuantizedFFN class, an inference-only copy of a
+ * trained feed forward network with 8-bit weights and activations.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantized_ffn.hpp"
+
+#include "visitor/quantize_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline QuantizedFFN::QuantizedFFN() :
+    pendingScale(1.0),
+    calibrationError(0.0),
+    calibrationAgreement(1.0)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+QuantizedFFN::QuantizedFFN(
+    FFN<OutputLayerType, InitializationRuleType>& network,
+    const arma::mat& calibrationData) :
+    pendingScale(1.0),
+    calibrationError(0.0),
+    calibrationAgreement(1.0)
+{
+  if (calibrationData.n_cols == 0)
+    throw std::invalid_argument("QuantizedFFN: no calibration points given");
+
+  // Predicting the calibration points initializes the parameters and the input
+  // shapes of the layers, and gives the predictions to compare with.
+  arma::mat reference;
+  network.Predict(calibrationData, reference);
+
+  for (size_t i = 0; i < network.Model().size(); ++i)
+    boost::apply_visitor(QuantizeVisitor(*this), network.Model()[i]);
+
+  Finish();
+
+  // Each stage is calibrated with its input in double precision, so that the
+  // errors of the earlier stages do not change the scales.
+  arma::mat input = calibrationData, output;
+  for (size_t i = 0; i < stages.size(); ++i)
+  {
+    if (stages[i].type != ELEMENTWISE)
+    {
+      if (InputDimensions(stages[i]) != input.n_rows)
+      {
+        std::ostringstream oss;
+        oss << "QuantizedFFN: stage " << i << " expects "
+            << InputDimensions(stages[i]) << "-dimensional input, but got "
+            << input.n_rows << " dimensions";
+        throw std::invalid_argument(oss.str());
+      }
+
+      Calibrate(stages[i], input);
+    }
+
+    FloatForward(stages[i], input, output);
+    Activate(stages[i].activation, output);
+    input.swap(output);
+
+    stages[i].floatWeight.reset();
+  }
+
+  Compare(calibrationData, reference, calibrationError, calibrationAgreement);
+  Log::Info << "QuantizedFFN: the largest error of the predictions of the "
+      << calibrationData.n_cols << " calibration points is " << calibrationError
+      << "; " << (100.0 * calibrationAgreement) << "% of the points have the "
+      << "same predicted class." << std::endl;
+}
+
+inline void QuantizedFFN::Predict(const arma::mat& predictors,
+                                  arma::mat& results)
+{
+  if (stages.empty())
+  {
+    results = predictors;
+    return;
+  }
+
+  const arma::mat* input = &predictors;
+  for (size_t i = 0; i < stages.size(); ++i)
+  {
+    // The last stage writes straight into the results; the others alternate
+    // between the two buffers.
+    arma::mat& output = (i == stages.size() - 1) ? results : buffers[i % 2];
+
+    const Stage& stage = stages[i];
+    if (stage.type == ELEMENTWISE)
+    {
+      output = stage.scale * (*input);
+    }
+    else
+    {
+      if (InputDimensions(stage) != input->n_rows)
+      {
+        std::ostringstream oss;
+        oss << "QuantizedFFN::Predict(): stage " << i << " expects "
+            << InputDimensions(stage) << "-dimensional input, but got "
+            << input->n_rows << " dimensions";
+        throw std::invalid_argument(oss.str());
+      }
+
+      QuantizedForward(stage, *input, output);
+    }
+
+    Activate(stage.activation, output);
+    input = &output;
+  }
+}
+
+inline void QuantizedFFN::Compare(const arma::mat& predictors,
+                                  const arma::mat& reference,
+                                  double& maxError,
+                                  double& agreement)
+{
+  arma::mat predictions;
+  Predict(predictors, predictions);
+
+  if (predictions.n_rows != reference.n_rows ||
+      predictions.n_cols != reference.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "QuantizedFFN::Compare(): the predictions are "
+        << predictions.n_rows << "x" << predictions.n_cols << ", but the "
+        << "reference is " << reference.n_rows << "x" << reference.n_cols;
+    throw std::invalid_argument(oss.str());
+  }
+
+  maxError = predictions.is_empty() ? 0.0 :
+      arma::abs(predictions - reference).max();
+
+  size_t agreeing = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    arma::uword predictedClass, referenceClass;
+    predictions.col(i).max(predictedClass);
+    reference.col(i).max(referenceClass);
+    if (predictedClass == referenceClass)
+      ++agreeing;
+  }
+
+  agreement = (predictions.n_cols == 0) ? 1.0 :
+      (double) agreeing / predictions.n_cols;
+}
+
+inline void QuantizedFFN::AddLinear(const arma::mat& weight,
+                                    const arma::vec& bias)
+{
+  Stage stage;
+  stage.type = LINEAR;
+  stage.activation = IDENTITY;
+  stage.scale = 1.0;
+  stage.geometry = Geometry();
+  stage.floatWeight = pendingScale * weight;
+  stage.bias = bias;
+  stages.push_back(std::move(stage));
+
+  pendingScale = 1.0;
+}
+
+inline void QuantizedFFN::AddConvolution(const arma::mat& kernels,
+                                         const arma::vec& bias,
+                                         const Geometry& geometry)
+{
+  if (geometry.inputWidth + 2 * geometry.padW < geometry.kW ||
+      geometry.inputHeight + 2 * geometry.padH < geometry.kH ||
+      geometry.dW == 0 || geometry.dH == 0)
+  {
+    std::ostringstream oss;
+    oss << "QuantizedFFN: the " << geometry.kW << "x" << geometry.kH
+        << " filters of a convolution do not fit its (padded) "
+        << geometry.inputWidth << "x" << geometry.inputHeight << " input";
+    throw std::invalid_argument(oss.str());
+  }
+
+  Stage stage;
+  stage.type = CONVOLUTION;
+  stage.activation = IDENTITY;
+  stage.scale = 1.0;
+  stage.geometry = geometry;
+  stage.floatWeight = pendingScale * kernels;
+  stage.bias = bias;
+  stages.push_back(std::move(stage));
+
+  pendingScale = 1.0;
+}
+
+inline void QuantizedFFN::AddActivation(const ActivationType activation)
+{
+  // Fuse the activation with the last stage, if that one does not have an
+  // activation yet.
+  if (!stages.empty() && stages.back().activation == IDENTITY &&
+      pendingScale == 1.0)
+  {
+    stages.back().activation = activation;
+    return;
+  }
+
+  Stage stage;
+  stage.type = ELEMENTWISE;
+  stage.activation = activation;
+  stage.scale = pendingScale;
+  stage.geometry = Geometry();
+  stages.push_back(std::move(stage));
+
+  pendingScale = 1.0;
+}
+
+inline void QuantizedFFN::AddScale(const double scale)
+{
+  if (scale == 1.0)
+    return;
+
+  // If the last stage has no activation, scale its output.  Otherwise the
+  // scale goes into the input of the next stage.
+  if (!stages.empty() && stages.back().activation == IDENTITY &&
+      pendingScale == 1.0)
+  {
+    if (stages.back().type == ELEMENTWISE)
+    {
+      stages.back().scale *= scale;
+    }
+    else
+    {
+      stages.back().floatWeight *= scale;
+      stages.back().bias *= scale;
+    }
+  }
+  else
+  {
+    pendingScale *= scale;
+  }
+}
+
+inline void QuantizedFFN::Finish()
+{
+  if (pendingScale != 1.0)
+  {
+    Stage stage;
+    stage.type = ELEMENTWISE;
+    stage.activation = IDENTITY;
+    stage.scale = pendingScale;
+    stage.geometry = Geometry();
+    stages.push_back(std::move(stage));
+
+    pendingScale = 1.0;
+  }
+}
+
+inline size_t QuantizedFFN::InputDimensions(const Stage& stage)
+{
+  if (stage.type == CONVOLUTION)
+  {
+    return stage.geometry.inputWidth * stage.geometry.inputHeight *
+        stage.geometry.inSize;
+  }
+  else if (stage.type == LINEAR)
+  {
+    // The weights of a quantized stage have one row for each input dimension.
+    return stage.floatWeight.is_empty() ? stage.weight.n_rows :
+        stage.floatWeight.n_cols;
+  }
+
+  return 0;
+}
+
+inline void QuantizedFFN::OutputSize(const Geometry& geometry,
+                                     size_t& outputWidth,
+                                     size_t& outputHeight)
+{
+  outputWidth = (geometry.inputWidth + 2 * geometry.padW - geometry.kW) /
+      geometry.dW + 1;
+  outputHeight = (geometry.inputHeight + 2 * geometry.padH - geometry.kH) /
+      geometry.dH + 1;
+}
+
+template<typename eT>
+void QuantizedFFN::Patches(const Geometry& geometry,
+                           const eT* input,
+                           const eT* padding,
+                           eT* patches)
+{
+  size_t outputWidth, outputHeight;
+  OutputSize(geometry, outputWidth, outputHeight);
+  const size_t mapSize = geometry.inputWidth * geometry.inputHeight;
+
+  for (size_t y = 0; y < outputHeight; ++y)
+  {
+    for (size_t x = 0; x < outputWidth; ++x)
+    {
+      for (size_t s = 0; s < geometry.inSize; ++s)
+      {
+        for (size_t kj = 0; kj < geometry.kH; ++kj)
+        {
+          // The positions in the padded maps, which may be in the padding.
+          const ptrdiff_t col = (ptrdiff_t) (y * geometry.dH + kj) -
+              (ptrdiff_t) geometry.padH;
+          const bool colInside = (col >= 0 &&
+              col < (ptrdiff_t) geometry.inputHeight);
+          for (size_t ki = 0; ki < geometry.kW; ++ki, ++patches)
+          {
+            const ptrdiff_t row = (ptrdiff_t) (x * geometry.dW + ki) -
+                (ptrdiff_t) geometry.padW;
+            if (colInside && row >= 0 && row < (ptrdiff_t) geometry.inputWidth)
+              *patches = input[s * mapSize + col * geometry.inputWidth + row];
+            else
+              *patches = padding[s];
+          }
+        }
+      }
+    }
+  }
+}
+
+inline int32_t QuantizedFFN::DotProduct(const uint8_t* input,
+                                        const int8_t* weight,
+                                        const size_t n)
+{
+  // The products of 8-bit integers fit in 16 bits, and the sums in 32 bits;
+  // compilers turn this loop into (u8 x s8) multiply-add instructions.
+  int32_t sum = 0;
+  for (size_t i = 0; i < n; ++i)
+    sum += (int32_t) input[i] * (int32_t) weight[i];
+  return sum;
+}
+
+inline void QuantizedFFN::Calibrate(Stage& stage, const arma::mat& input)
+{
+  // Each input map of a convolution is one channel; each dimension of the
+  // input of a linear stage is its own channel.
+  const size_t channelSize = (stage.type == CONVOLUTION) ?
+      stage.geometry.inputWidth * stage.geometry.inputHeight : 1;
+  const size_t channels = input.n_rows / channelSize;
+
+  const arma::mat channelView(const_cast<double*>(input.memptr()),
+      channelSize, channels * input.n_cols, false, true);
+  const arma::mat lowest = arma::reshape(arma::min(channelView, 0), channels,
+      input.n_cols);
+  const arma::mat highest = arma::reshape(arma::max(channelView, 0), channels,
+      input.n_cols);
+
+  stage.inputScale.zeros(channels);
+  stage.inputZero.zeros(channels);
+  double smallestScale = 0.0;
+  for (size_t c = 0; c < channels; ++c)
+  {
+    // The range always contains 0, so that zeros (and the padding of a
+    // convolution) are represented exactly.
+    const double lo = std::min(lowest.row(c).min(), 0.0);
+    const double hi = std::max(highest.row(c).max(), 0.0);
+    if (hi == lo)
+      continue;
+
+    const double scale = (hi - lo) / 255.0;
+    stage.inputScale[c] = scale;
+    stage.inputZero[c] = (uint8_t) std::min(std::max(std::round(-lo / scale),
+        0.0), 255.0);
+    if (smallestScale == 0.0 || scale < smallestScale)
+      smallestScale = scale;
+  }
+
+  // Channels that are always 0 (like dead rectifiers) get the smallest scale,
+  // so that their weights do not take over the scales of the weights.
+  if (smallestScale == 0.0)
+    smallestScale = 1.0;
+  for (size_t c = 0; c < channels; ++c)
+    if (stage.inputScale[c] == 0.0)
+      stage.inputScale[c] = smallestScale;
+
+  // Fold the input scales into the weights, with one column of weights for
+  // each output channel.
+  arma::mat weights;
+  arma::vec rowScales, rowZeros;
+  if (stage.type == LINEAR)
+  {
+    weights = stage.floatWeight.t();
+    rowScales = stage.inputScale;
+    rowZeros = arma::conv_to<arma::vec>::from(stage.inputZero);
+  }
+  else
+  {
+    weights = stage.floatWeight;
+    const size_t kernelSize = stage.geometry.kW * stage.geometry.kH;
+    rowScales.set_size(weights.n_rows);
+    rowZeros.set_size(weights.n_rows);
+    for (size_t k = 0; k < weights.n_rows; ++k)
+    {
+      rowScales[k] = stage.inputScale[k / kernelSize];
+      rowZeros[k] = (double) stage.inputZero[k / kernelSize];
+    }
+  }
+  weights.each_col() %= rowScales;
+
+  // Each product is at most 255 * 127 in magnitude, so the 32-bit sums cannot
+  // overflow below this many products.
+  const size_t maxFanIn = std::numeric_limits<int32_t>::max() / (255 * 127);
+  if (weights.n_rows > maxFanIn)
+  {
+    std::ostringstream oss;
+    oss << "QuantizedFFN: a stage has " << weights.n_rows << " inputs for "
+        << "each output, but at most " << maxFanIn << " can be quantized";
+    throw std::invalid_argument(oss.str());
+  }
+
+  stage.weight.set_size(weights.n_rows, weights.n_cols);
+  stage.weightScale.set_size(weights.n_cols);
+  stage.offset.set_size(weights.n_cols);
+  for (size_t o = 0; o < weights.n_cols; ++o)
+  {
+    const double largest = arma::abs(weights.col(o)).max();
+    const double scale = (largest > 0.0) ? largest / 127.0 : 1.0;
+    stage.weightScale[o] = scale;
+
+    int32_t offset = 0;
+    for (size_t k = 0; k < weights.n_rows; ++k)
+    {
+      const int8_t w = (int8_t) std::min(std::max(std::round(weights(k, o) /
+          scale), -127.0), 127.0);
+      stage.weight(k, o) = w;
+      offset += (int32_t) w * (int32_t) rowZeros[k];
+    }
+    stage.offset[o] = offset;
+  }
+}
+
+inline void QuantizedFFN::FloatForward(const Stage& stage,
+                                       const arma::mat& input,
+                                       arma::mat& output)
+{
+  if (stage.type == ELEMENTWISE)
+  {
+    output = stage.scale * input;
+  }
+  else if (stage.type == LINEAR)
+  {
+    output = stage.floatWeight * input;
+    output.each_col() += stage.bias;
+  }
+  else
+  {
+    size_t outputWidth, outputHeight;
+    OutputSize(stage.geometry, outputWidth, outputHeight);
+    const size_t positions = outputWidth * outputHeight;
+    const size_t outSize = stage.floatWeight.n_cols;
+    const arma::vec padding = arma::zeros<arma::vec>(stage.geometry.inSize);
+
+    output.set_size(positions * outSize, input.n_cols);
+    arma::mat patches(stage.floatWeight.n_rows, positions);
+    for (size_t i = 0; i < input.n_cols; ++i)
+    {
+      Patches(stage.geometry, input.colptr(i), padding.memptr(),
+          patches.memptr());
+
+      // Column o of the result is output map o.
+      arma::mat result(output.colptr(i), positions, outSize, false, true);
+      result = patches.t() * stage.floatWeight;
+      result.each_row() += stage.bias.t();
+    }
+  }
+}
+
+inline void QuantizedFFN::QuantizeInput(const Stage& stage,
+                                        const arma::mat& input,
+                                        arma::Mat<uint8_t>& quantizedInput)
+{
+  const size_t channels = stage.inputScale.n_elem;
+  const size_t channelSize = input.n_rows / channels;
+  quantizedInput.set_size(input.n_rows, input.n_cols);
+
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) input.n_cols; ++i)
+  {
+    const double* in = input.colptr(i);
+    uint8_t* out = quantizedInput.colptr(i);
+    for (size_t c = 0; c < channels; ++c)
+    {
+      const double inverseScale = 1.0 / stage.inputScale[c];
+      const double zero = (double) stage.inputZero[c];
+      for (size_t j = 0; j < channelSize; ++j, ++in, ++out)
+      {
+        const double q = std::round((*in) * inverseScale) + zero;
+        *out = (uint8_t) std::min(std::max(q, 0.0), 255.0);
+      }
+    }
+  }
+}
+
+inline void QuantizedFFN::QuantizedForward(const Stage& stage,
+                                           const arma::mat& input,
+                                           arma::mat& output)
+{
+  QuantizeInput(stage, input, quantizedInput);
+
+  const size_t outSize = stage.weight.n_cols;
+  const size_t fanIn = stage.weight.n_rows;
+  if (stage.type == LINEAR)
+  {
+    output.set_size(outSize, input.n_cols);
+
+    // Each thread takes blocks of points, so that each column of weights is
+    // used for a few points while it is in the cache.
+    const size_t blockSize = 16;
+    const size_t blocks = (input.n_cols + blockSize - 1) / blockSize;
+    #pragma omp parallel for num_threads(ParallelThreads()) schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) blocks; ++b)
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min((size_t) input.n_cols, begin + blockSize);
+      for (size_t o = 0; o < outSize; ++o)
+      {
+        const int8_t* weight = stage.weight.colptr(o);
+        for (size_t i = begin; i < end; ++i)
+        {
+          const int32_t sum = DotProduct(quantizedInput.colptr(i), weight,
+              fanIn);
+          output(o, i) = stage.weightScale[o] * (double) (sum -
+              stage.offset[o]) + stage.bias[o];
+        }
+      }
+    }
+  }
+  else
+  {
+    size_t outputWidth, outputHeight;
+    OutputSize(stage.geometry, outputWidth, outputHeight);
+    const size_t positions = outputWidth * outputHeight;
+    output.set_size(positions * outSize, input.n_cols);
+
+    #pragma omp parallel num_threads(ParallelThreads())
+    {
+      // The patches are padded with the zero point of each map, which stands
+      // for 0.
+      std::vector<uint8_t> patches(fanIn * positions);
+
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) input.n_cols; ++i)
+      {
+        Patches(stage.geometry, quantizedInput.colptr(i),
+            stage.inputZero.memptr(), patches.data());
+
+        double* out = output.colptr(i);
+        for (size_t o = 0; o < outSize; ++o)
+        {
+          const int8_t* weight = stage.weight.colptr(o);
+          for (size_t p = 0; p < positions; ++p, ++out)
+          {
+            const int32_t sum = DotProduct(&patches[p * fanIn], weight, fanIn);
+            *out = stage.weightScale[o] * (double) (sum - stage.offset[o]) +
+                stage.bias[o];
+          }
+        }
+      }
+    }
+  }
+}
+
+inline void QuantizedFFN::Activate(const ActivationType activation,
+                                   arma::mat& output)
+{
+  switch (activation)
+  {
+    case IDENTITY:
+      break;
+    case RECTIFIER:
+      output.transform([](const double x) { return std::max(0.0, x); });
+      break;
+    case LOGISTIC:
+      LogisticFunction::Fn(output, output);
+      break;
+    case TANH:
+      TanhFunction::Fn(output, output);
+      break;
+    case LOG_SOFTMAX:
+      // Use the layer itself, so that the results match the network.
+      activationInput.swap(output);
+      LogSoftMax<arma::mat, arma::mat>().Forward(std::move(activationInput),
+          std::move(output));
+      break;
+  }
+}
+
+template<typename Archive>
+void QuantizedFFN::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  size_t stageCount = stages.size();
+  ar & data::CreateNVP(stageCount, "stages");
+
+  // If we are loading, we must resize the stages correctly.
+  if (Archive::is_loading::value)
+  {
+    stages.clear();
+    stages.resize(stageCount);
+    pendingScale = 1.0;
+  }
+
+  // Serialize each stage; generate the correct names for each one.
+  for (size_t i = 0; i < stageCount; ++i)
+  {
+    std::ostringstream oss;
+    oss << i;
+
+    Stage& stage = stages[i];
+    size_t type = (size_t) stage.type;
+    size_t activation = (size_t) stage.activation;
+    ar & data::CreateNVP(type, "type" + oss.str());
+    ar & data::CreateNVP(activation, "activation" + oss.str());
+    ar & data::CreateNVP(stage.scale, "scale" + oss.str());
+    ar & data::CreateNVP(stage.geometry, "geometry" + oss.str());
+    ar & data::CreateNVP(stage.weight, "weight" + oss.str());
+    ar & data::CreateNVP(stage.weightScale, "weightScale" + oss.str());
+    ar & data::CreateNVP(stage.offset, "offset" + oss.str());
+    ar & data::CreateNVP(stage.bias, "bias" + oss.str());
+    ar & data::CreateNVP(stage.inputScale, "inputScale" + oss.str());
+    ar & data::CreateNVP(stage.inputZero, "inputZero" + oss.str());
+    stage.type = (StageType) type;
+    stage.activation = (ActivationType) activation;
+  }
+
+  ar & data::CreateNVP(calibrationError, "calibrationError");
+  ar & data::CreateNVP(calibrationAgreement, "calibrationAgreement");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -33,16 +33,20 @@ namespace ann /** Artificial Neural Network. */ {
  *
  * @tparam OutputLayerType The output layer type used to evaluate the network.
  * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam MatType Type of the parameters, the data and the activations
+ *     (arma::mat, or arma::fmat to train and predict in single precision).  The
+ *     layers and the output layer must use the same type.
  */
 template<
   typename OutputLayerType = NegativeLogLikelihood<>,
-  typename InitializationRuleType = RandomInitialization
+  typename InitializationRuleType = RandomInitialization,
+  typename MatType = arma::mat
 >
 class RNN
 {
  public:
   //! Convenience typedef for the internal model construction.
-  using NetworkType = RNN<OutputLayerType, InitializationRuleType>;
+  using NetworkType = RNN<OutputLayerType, InitializationRuleType, MatType>;
 
   /**
    * Create the RNN object with the given predictors and responses set (this is
@@ -81,8 +85,8 @@ class RNN
    * @param initializeRule Optional instantiated InitializationRule object
    *        for initializing the network parameter.
    */
-  RNN(arma::mat predictors,
-      arma::mat responses,
+  RNN(MatType predictors,
+      MatType responses,
       const size_t rho,
       const bool single = false,
       OutputLayerType outputLayer = OutputLayerType(),
@@ -108,8 +112,8 @@ class RNN
    * @param optimizer Instantiated optimizer used to train the model.
    */
   template<typename OptimizerType>
-  void Train(arma::mat predictors,
-             arma::mat responses,
+  void Train(MatType predictors,
+             MatType responses,
              OptimizerType& optimizer);
 
   /**
@@ -129,7 +133,60 @@ class RNN
    * @param responses Outputs results from input training variables.
    */
   template<typename OptimizerType = mlpack::optimization::StandardSGD>
-  void Train(arma::mat predictors, arma::mat responses);
+  void Train(MatType predictors, MatType responses);
+
+  /**
+   * Train the recurrent neural network on a stream of batches from the given
+   * data source (see MatrixDataSource), for the given number of epochs.  At
+   * the start of every epoch the data source is reset, and the optimizer is run
+   * on each batch, starting from the current parameters.  The optimizer should
+   * keep its state between batches and should not run for long on a single
+   * batch, e.g. a MiniBatchSGD optimizer with the batch size of the data
+   * source, maxIterations set to 2 (one step per batch) and resetPolicy set to
+   * false, leaving the shuffling to the data source.
+   *
+   * Each batch is trained on as in Train(), with sequences of rho time steps.
+   *
+   * Use a PrefetchDataSource to prepare the next batches in the background
+   * while the current one trains.
+   *
+   * @tparam DataSourceType Type of the data source.
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param source The data source to take the batches from.
+   * @param optimizer Instantiated optimizer used to train on each batch.
+   * @param epochs Number of passes over the data source.
+   */
+  template<typename DataSourceType, typename OptimizerType>
+  void Train(DataSourceType& source,
+             OptimizerType& optimizer,
+             const size_t epochs = 1);
+
+  /**
+   * Train the recurrent neural network on sequences of different lengths,
+   * using the given optimizer.  Each column of the predictors and the
+   * responses holds one sequence, padded to rho time steps; sequence i only
+   * has its first sequenceLengths[i] time steps.  The padding does not
+   * contribute to the objective or the gradient, so its values do not matter,
+   * and in single mode only the last time step of each sequence is used for
+   * the gradient.
+   *
+   * The sequences are sorted by length before training, so that each batch of
+   * an optimizer such as MiniBatchSGD holds sequences of similar lengths, and
+   * each batch is only passed through the network for as many time steps as
+   * its longest sequence has.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param sequenceLengths Number of time steps of each sequence (at most
+   *        rho).
+   * @param optimizer Instantiated optimizer used to train the model.
+   */
+  template<typename OptimizerType>
+  void Train(MatType predictors,
+             MatType responses,
+             arma::Row<size_t> sequenceLengths,
+             OptimizerType& optimizer);
 
   /**
    * Predict the responses to a given set of predictors. The responses will
@@ -142,7 +199,7 @@ class RNN
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(MatType predictors, MatType& results);
 
   /**
    * Evaluate the recurrent neural network with the given parameters. This
@@ -153,7 +210,7 @@ class RNN
    * @param deterministic Whether or not to train or test the model. Note some
    *        layer act differently in training or testing mode.
    */
-  double Evaluate(const arma::mat& /* parameters */,
+  double Evaluate(const MatType& /* parameters */,
                   const size_t i,
                   const bool deterministic = true);
 
@@ -167,9 +224,46 @@ class RNN
    * @param i Index of points to use for objective function gradient evaluation.
    * @param gradient Matrix to output gradient into.
    */
-  void Gradient(const arma::mat& parameters,
+  void Gradient(const MatType& parameters,
                 const size_t i,
-                arma::mat& gradient);
+                MatType& gradient);
+
+  /**
+   * Evaluate the recurrent neural network with the given parameters on the
+   * consecutive sequences [begin, begin + batchSize).  At each time step the
+   * inputs of all sequences are passed through the network together, so each
+   * layer processes the whole batch at once; this is used by optimizers such
+   * as MiniBatchSGD.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first sequence to use for objective function
+   *        evaluation.
+   * @param batchSize Number of sequences to use for objective function
+   *        evaluation.
+   * @return The sum of the objectives of the sequences.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize);
+
+  /**
+   * Evaluate the gradient of the recurrent neural network with the given
+   * parameters, with respect to the consecutive sequences
+   * [begin, begin + batchSize).  The sequences are passed through the network
+   * together, just like in the batch version of Evaluate(), and the gradient is
+   * the sum of the gradients of the sequences.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first sequence to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of sequences to use for objective function gradient
+   *        evaluation.
+   */
+  void Gradient(const MatType& parameters,
+                const size_t begin,
+                MatType& gradient,
+                const size_t batchSize);
 
   /*
    * Add a new module to the model.
@@ -192,21 +286,38 @@ class RNN
    *
    * @param layer The Layer to be added to the model.
    */
-  void Add(LayerTypes layer) { network.push_back(layer); }
+  void Add(LayerTypes<MatType> layer) { network.push_back(layer); }
 
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
   //! Return the initial point for the optimization.
-  const arma::mat& Parameters() const { return parameter; }
+  const MatType& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
-  arma::mat& Parameters() { return parameter; }
+  MatType& Parameters() { return parameter; }
 
   //! Return the maximum length of backpropagation through time.
   const size_t& Rho() const { return rho; }
   //! Modify the maximum length of backpropagation through time.
   size_t& Rho() { return rho; }
 
+  //! Get the number of time steps of each training sequence (empty if all
+  //! sequences have rho time steps).
+  const arma::Row<size_t>& SequenceLengths() const { return sequenceLengths; }
+  //! Modify the number of time steps of each training sequence (empty if all
+  //! sequences have rho time steps).
+  arma::Row<size_t>& SequenceLengths() { return sequenceLengths; }
+
+  //! Get whether the activations of the layers are recomputed during the
+  //! backward pass, instead of being stored by the forward pass.
+  bool Recompute() const { return recompute; }
+  //! Modify whether the activations of the layers are recomputed during the
+  //! backward pass, instead of being stored by the forward pass.  This needs
+  //! the memory of the activations of one time step instead of all of them, for
+  //! the cost of a second forward pass in each call of Gradient(); layers that
+  //! draw random numbers (like Dropout) draw them again.
+  bool& Recompute() { return recompute; }
+
   //! Serialize the model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -218,13 +329,36 @@ class RNN
    *
    * @param input Data sequence to compute probabilities for.
    */
-  void Forward(arma::mat&& input);
+  void Forward(MatType&& input);
+
+  /**
+   * Pass the consecutive sequences [begin, begin + batchSize) through the
+   * network and evaluate the output layer at each time step.
+   *
+   * @param begin Index of the first sequence.
+   * @param batchSize Number of sequences.
+   * @param deterministic Whether or not to train or test the model.
+   * @return The sum of the objectives of the sequences.
+   */
+  double EvaluateBatch(const size_t begin,
+                       const size_t batchSize,
+                       const bool deterministic);
 
   /**
    * Reset the state of RNN cells in the network for new input sequence.
    */
   void ResetCells();
 
+  //! Return the number of time steps of the given training sequence.
+  size_t SequenceLength(const size_t i) const
+  {
+    return sequenceLengths.is_empty() ? rho : sequenceLengths[i];
+  }
+
+  //! Return the number of time steps of the longest of the consecutive
+  //! training sequences [begin, begin + batchSize).
+  size_t BatchSteps(const size_t begin, const size_t batchSize) const;
+
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
    * backward pass for module.
@@ -243,7 +377,7 @@ class RNN
    * @param predictors Input predictors.
    * @param results Vector to put output prediction of a response into.
    */
-  void SinglePredict(const arma::mat& predictors, arma::mat& results);
+  void SinglePredict(const MatType& predictors, MatType& results);
 
   /**
    * Reset the module infomration (weights/parameters).
@@ -259,7 +393,7 @@ class RNN
   /**
    * Reset the gradient for all modules that implement the Gradient function.
    */
-  void ResetGradients(arma::mat& gradient);
+  void ResetGradients(MatType& gradient);
 
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
@@ -290,34 +424,38 @@ class RNN
   bool single;
 
   //! Locally-stored model modules.
-  std::vector<LayerTypes> network;
+  std::vector<LayerTypes<MatType>> network;
 
   //! The matrix of data points (predictors).
-  arma::mat predictors;
+  MatType predictors;
 
   //! The matrix of responses to the input data points.
-  arma::mat responses;
+  MatType responses;
+
+  //! The number of time steps of each training sequence (empty if all
+  //! sequences have rho time steps).
+  arma::Row<size_t> sequenceLengths;
 
   //! Matrix of (trained) parameters.
-  arma::mat parameter;
+  MatType parameter;
 
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
   //! The current error for the backward pass.
-  arma::mat error;
+  MatType error;
 
   //! THe current input of the forward/backward pass.
-  arma::mat currentInput;
+  MatType currentInput;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitor<MatType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitor<MatType> outputParameterVisitor;
 
   //! List of all module parameters for the backward pass (BBTT).
-  std::vector<arma::mat> moduleOutputParameter;
+  std::vector<MatType> moduleOutputParameter;
 
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
@@ -330,6 +468,9 @@ class RNN
 
   //! The current evaluation mode (training or testing).
   bool deterministic;
+
+  //! Whether the activations are recomputed during the backward pass.
+  bool recompute;
 }; // class RNN
 
 } // namespace ann
@@ -19,6 +19,7 @@
 #include "visitor/save_output_parameter_visitor.hpp"
 #include "visitor/forward_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
+#include "visitor/replay_visitor.hpp"
 #include "visitor/reset_cell_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
@@ -30,8 +31,9 @@
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
-template<typename OutputLayerType, typename InitializationRuleType>
-RNN<OutputLayerType, InitializationRuleType>::RNN(
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+RNN<OutputLayerType, InitializationRuleType, MatType>::RNN(
     const size_t rho,
     const bool single,
     OutputLayerType outputLayer,
@@ -46,15 +48,17 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     reset(false),
     single(single),
     numFunctions(0),
-    deterministic(true)
+    deterministic(true),
+    recompute(false)
 {
   /* Nothing to do here */
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-RNN<OutputLayerType, InitializationRuleType>::RNN(
-    arma::mat predictors,
-    arma::mat responses,
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+RNN<OutputLayerType, InitializationRuleType, MatType>::RNN(
+    MatType predictors,
+    MatType responses,
     const size_t rho,
     const bool single,
     OutputLayerType outputLayer,
@@ -71,32 +75,75 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     predictors(std::move(predictors)),
     responses(std::move(responses)),
     numFunctions(0),
-    deterministic(true)
+    deterministic(true),
+    recompute(false)
 {
   numFunctions = this->responses.n_cols;
   ResetDeterministic();
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-RNN<OutputLayerType, InitializationRuleType>::~RNN()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+RNN<OutputLayerType, InitializationRuleType, MatType>::~RNN()
 {
-  for (LayerTypes& layer : network)
+  for (LayerTypes<MatType>& layer : network)
   {
     boost::apply_visitor(deleteVisitor, layer);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename OptimizerType>
-void RNN<OutputLayerType, InitializationRuleType>::Train(
-    arma::mat predictors,
-    arma::mat responses,
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    MatType predictors,
+    MatType responses,
+    OptimizerType& optimizer)
+{
+  Train(std::move(predictors), std::move(responses), arma::Row<size_t>(),
+      optimizer);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+template<typename OptimizerType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    MatType predictors,
+    MatType responses,
+    arma::Row<size_t> sequenceLengths,
     OptimizerType& optimizer)
 {
   numFunctions = responses.n_cols;
 
+  if (!sequenceLengths.is_empty())
+  {
+    if (sequenceLengths.n_elem != responses.n_cols)
+    {
+      std::ostringstream oss;
+      oss << "RNN::Train(): " << sequenceLengths.n_elem << " sequence lengths "
+          << "given for " << responses.n_cols << " sequences";
+      throw std::invalid_argument(oss.str());
+    }
+
+    if (sequenceLengths.min() == 0 || sequenceLengths.max() > rho)
+    {
+      std::ostringstream oss;
+      oss << "RNN::Train(): sequence lengths must be between 1 and rho ("
+          << rho << ")";
+      throw std::invalid_argument(oss.str());
+    }
+
+    // Sort the sequences by length, so that consecutive sequences (which are
+    // batched together) have similar lengths.
+    const arma::uvec order = arma::stable_sort_index(sequenceLengths);
+    predictors = predictors.cols(order);
+    responses = responses.cols(order);
+    sequenceLengths = sequenceLengths.cols(order);
+  }
+
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
+  this->sequenceLengths = std::move(sequenceLengths);
 
   this->deterministic = true;
   ResetDeterministic();
@@ -116,8 +163,9 @@ void RNN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::ResetCells()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::ResetCells()
 {
   for (size_t i = 1; i < network.size(); ++i)
   {
@@ -125,15 +173,28 @@ void RNN<OutputLayerType, InitializationRuleType>::ResetCells()
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+size_t RNN<OutputLayerType, InitializationRuleType, MatType>::BatchSteps(
+    const size_t begin, const size_t batchSize) const
+{
+  if (sequenceLengths.is_empty())
+    return rho;
+
+  return arma::max(sequenceLengths.subvec(begin, begin + batchSize - 1));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename OptimizerType>
-void RNN<OutputLayerType, InitializationRuleType>::Train(
-    arma::mat predictors, arma::mat responses)
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    MatType predictors, MatType responses)
 {
   numFunctions = responses.n_cols;
 
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
+  sequenceLengths.reset();
 
   this->deterministic = true;
   ResetDeterministic();
@@ -155,9 +216,51 @@ void RNN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Predict(
-    arma::mat predictors, arma::mat& results)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+template<typename DataSourceType, typename OptimizerType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Train(
+    DataSourceType& source,
+    OptimizerType& optimizer,
+    const size_t epochs)
+{
+  MatType batchPredictors, batchResponses;
+
+  Timer::Start("rnn_optimization");
+  for (size_t epoch = 0; epoch < epochs; ++epoch)
+  {
+    double objective = 0;
+    source.Reset();
+    while (source.NextBatch(batchPredictors, batchResponses))
+    {
+      numFunctions = batchResponses.n_cols;
+
+      predictors = std::move(batchPredictors);
+      responses = std::move(batchResponses);
+      sequenceLengths.reset();
+
+      deterministic = true;
+      ResetDeterministic();
+
+      if (!reset)
+      {
+        ResetParameters();
+        reset = true;
+      }
+
+      objective += optimizer.Optimize(*this, parameter);
+    }
+
+    Log::Info << "RNN::Train(): objective of epoch " << epoch << " is "
+        << objective << "." << std::endl;
+  }
+  Timer::Stop("rnn_optimization");
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Predict(
+    MatType predictors, MatType& results)
 {
   ResetCells();
 
@@ -172,22 +275,23 @@ void RNN<OutputLayerType, InitializationRuleType>::Predict(
     ResetDeterministic();
   }
 
-  results = arma::zeros<arma::mat>(outputSize * rho, predictors.n_cols);
-  arma::mat resultsTemp = results.col(0);
+  results = arma::zeros<MatType>(outputSize * rho, predictors.n_cols);
+  MatType resultsTemp = results.col(0);
 
   for (size_t i = 0; i < predictors.n_cols; i++)
   {
     SinglePredict(
-        arma::mat(predictors.colptr(i), predictors.n_rows, 1, false, true),
+        MatType(predictors.colptr(i), predictors.n_rows, 1, false, true),
         resultsTemp);
 
     results.col(i) = resultsTemp;
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::SinglePredict(
-    const arma::mat& predictors, arma::mat& results)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::SinglePredict(
+    const MatType& predictors, MatType& results)
 {
   for (size_t seqNum = 0; seqNum < rho; ++seqNum)
   {
@@ -200,9 +304,28 @@ void RNN<OutputLayerType, InitializationRuleType>::SinglePredict(
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
-    const arma::mat& /* parameters */, const size_t i, const bool deterministic)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double RNN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& /* parameters */, const size_t i, const bool deterministic)
+{
+  return EvaluateBatch(i, 1, deterministic);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double RNN<OutputLayerType, InitializationRuleType, MatType>::Evaluate(
+    const MatType& /* parameters */,
+    const size_t begin,
+    const size_t batchSize)
+{
+  return EvaluateBatch(begin, batchSize, true);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+double RNN<OutputLayerType, InitializationRuleType, MatType>::EvaluateBatch(
+    const size_t begin, const size_t batchSize, const bool deterministic)
 {
   if (parameter.is_empty())
   {
@@ -216,58 +339,91 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
     ResetDeterministic();
   }
 
-  arma::mat input = arma::mat(predictors.colptr(i), predictors.n_rows,
-      1, false, true);
-  arma::mat target = arma::mat(responses.colptr(i), responses.n_rows,
-      1, false, true);
+  MatType input = MatType(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true);
+  MatType target = MatType(responses.colptr(begin), responses.n_rows,
+      batchSize, false, true);
 
   if (!inputSize)
   {
-    inputSize = input.n_elem / rho;
-    targetSize = target.n_elem / rho;
+    inputSize = input.n_rows / rho;
+    targetSize = target.n_rows / rho;
   }
   else if (targetSize == 0)
   {
-    targetSize = target.n_elem / rho;
+    targetSize = target.n_rows / rho;
   }
 
   ResetCells();
 
   double performance = 0;
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  // The batch only needs as many time steps as its longest sequence has.
+  const size_t steps = BatchSteps(begin, batchSize);
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
   {
     currentInput = input.rows(seqNum * inputSize, (seqNum + 1) * inputSize - 1);
-    arma::mat currentTarget = target.rows(seqNum * targetSize,
+    MatType currentTarget = target.rows(seqNum * targetSize,
         (seqNum + 1) * targetSize - 1);
 
     Forward(std::move(currentInput));
 
-    if (!deterministic)
+    if (!deterministic && !recompute)
     {
       for (size_t l = 0; l < network.size(); ++l)
       {
-        boost::apply_visitor(SaveOutputParameterVisitor(
+        boost::apply_visitor(SaveOutputParameterVisitor<MatType>(
             std::move(moduleOutputParameter)), network[l]);
       }
     }
 
-    performance += outputLayer.Forward(std::move(boost::apply_visitor(
-        outputParameterVisitor, network.back())), std::move(currentTarget));
+    MatType& output = boost::apply_visitor(outputParameterVisitor,
+        network.back());
+    if (batchSize == 1)
+    {
+      performance += outputLayer.Forward(std::move(output),
+          std::move(currentTarget));
+      continue;
+    }
+
+    // The output layer is evaluated for each sequence on its own, so that the
+    // objective of the batch is the sum of the objectives of its sequences for
+    // every output layer.  Sequences that have already ended are skipped.
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      if (seqNum >= SequenceLength(begin + i))
+        continue;
+
+      performance += outputLayer.Forward(std::move(MatType(output.colptr(i),
+          output.n_rows, 1, false, true)), std::move(MatType(
+          currentTarget.colptr(i), currentTarget.n_rows, 1, false, true)));
+    }
   }
 
   if (!outputSize)
   {
     outputSize = boost::apply_visitor(outputParameterVisitor,
-        network.back()).n_elem;
+        network.back()).n_rows;
   }
 
   return performance;
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Gradient(
-    const arma::mat& parameters, const size_t i, arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& parameters, const size_t i, MatType& gradient)
+{
+  Gradient(parameters, i, gradient, 1);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Gradient(
+    const MatType& /* parameters */,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize)
 {
   if (gradient.is_empty())
   {
@@ -277,40 +433,53 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
       reset = true;
     }
 
-    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+    gradient = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
   }
   else
   {
     gradient.zeros();
   }
 
-  Evaluate(parameters, i, false);
+  EvaluateBatch(begin, batchSize, false);
 
-  arma::mat currentGradient = arma::zeros<arma::mat>(parameter.n_rows,
+  MatType currentGradient = arma::zeros<MatType>(parameter.n_rows,
       parameter.n_cols);
   ResetGradients(currentGradient);
 
-  arma::mat input = arma::mat(predictors.colptr(i), predictors.n_rows,
-      1, false, true);
-  arma::mat target = arma::mat(responses.colptr(i), responses.n_rows,
-      1, false, true);
+  MatType input = MatType(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true);
+  MatType target = MatType(responses.colptr(begin), responses.n_rows,
+      batchSize, false, true);
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  const size_t steps = BatchSteps(begin, batchSize);
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
   {
     currentGradient.zeros();
 
-    arma::mat currentTarget = target.rows((rho - seqNum - 1) * targetSize,
-        (rho - seqNum) * targetSize - 1);
-    currentInput = input.rows((rho - seqNum - 1) * inputSize,
-        (rho - seqNum) * inputSize - 1);
+    const size_t step = steps - seqNum - 1;
+    MatType currentTarget = target.rows(step * targetSize,
+        (step + 1) * targetSize - 1);
+    currentInput = input.rows(step * inputSize, (step + 1) * inputSize - 1);
 
-    for (size_t l = 0; l < network.size(); ++l)
+    if (recompute)
+    {
+      // The recurrent layers have stored their states of all time steps, from
+      // which the activations of this time step are computed again.
+      for (size_t l = 0; l < network.size(); ++l)
+        boost::apply_visitor(ReplayVisitor(step), network[l]);
+
+      Forward(std::move(currentInput));
+    }
+    else
     {
-      boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(LoadOutputParameterVisitor<MatType>(
+            std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
+      }
     }
 
-    if (single && seqNum > 0)
+    if (single && seqNum > 0 && sequenceLengths.is_empty())
     {
       error.zeros();
     }
@@ -319,6 +488,18 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
       outputLayer.Backward(std::move(boost::apply_visitor(
           outputParameterVisitor, network.back())), std::move(currentTarget),
           std::move(error));
+
+      // Mask the error of the sequences that have ended before this time step
+      // (in single mode, of all sequences that do not end at this time step).
+      if (!sequenceLengths.is_empty())
+      {
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+          const size_t length = sequenceLengths[begin + i];
+          if (step >= length || (single && step != length - 1))
+            error.col(i).zeros();
+        }
+      }
     }
 
     Backward();
@@ -327,63 +508,70 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::ResetParameters()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::ResetParameters()
 {
   ResetDeterministic();
 
   // Reset the network parameter with the given initialization rule.
-  NetworkInitialization<InitializationRuleType> networkInit(initializeRule);
+  NetworkInitialization<InitializationRuleType, MatType>
+      networkInit(initializeRule);
   networkInit.Initialize(network, parameter);
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::ResetDeterministic()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::ResetDeterministic()
 {
   DeterministicSetVisitor deterministicSetVisitor(deterministic);
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deterministicSetVisitor));
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::ResetGradients(
-    arma::mat& gradient)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::ResetGradients(
+    MatType& gradient)
 {
   size_t offset = 0;
-  for (LayerTypes& layer : network)
+  for (LayerTypes<MatType>& layer : network)
   {
-    offset += boost::apply_visitor(GradientSetVisitor(std::move(gradient),
-        offset), layer);
+    offset += boost::apply_visitor(GradientSetVisitor<MatType>(std::move(
+        gradient), offset), layer);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType,
+         MatType>::Forward(MatType&& input)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
+  boost::apply_visitor(ForwardVisitor<MatType>(std::move(input), std::move(
       boost::apply_visitor(outputParameterVisitor, network.front()))),
       network.front());
 
   for (size_t i = 1; i < network.size(); ++i)
   {
-    boost::apply_visitor(ForwardVisitor(
+    boost::apply_visitor(ForwardVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor, network[i - 1])),
         std::move(boost::apply_visitor(outputParameterVisitor, network[i]))),
         network[i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Backward()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(
+  boost::apply_visitor(BackwardVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
         std::move(error), std::move(boost::apply_visitor(deltaVisitor,
         network.back()))), network.back());
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(
+    boost::apply_visitor(BackwardVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor,
         network[network.size() - i])), std::move(boost::apply_visitor(
         deltaVisitor, network[network.size() - i + 1])), std::move(
@@ -392,24 +580,27 @@ void RNN<OutputLayerType, InitializationRuleType>::Backward()
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
-void RNN<OutputLayerType, InitializationRuleType>::Gradient()
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Gradient()
 {
-  boost::apply_visitor(GradientVisitor(std::move(currentInput), std::move(
-      boost::apply_visitor(deltaVisitor, network[1]))), network.front());
+  boost::apply_visitor(GradientVisitor<MatType>(std::move(currentInput),
+      std::move(boost::apply_visitor(deltaVisitor, network[1]))),
+      network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(
+    boost::apply_visitor(GradientVisitor<MatType>(
         std::move(boost::apply_visitor(outputParameterVisitor, network[i - 1])),
         std::move(boost::apply_visitor(deltaVisitor, network[i + 1]))),
         network[i]);
   }
 }
 
-template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType>
 template<typename Archive>
-void RNN<OutputLayerType, InitializationRuleType>::Serialize(
+void RNN<OutputLayerType, InitializationRuleType, MatType>::Serialize(
     Archive& ar, const unsigned int /* version */)
 {
   ar & data::CreateNVP(parameter, "parameter");
@@ -435,10 +626,10 @@ void RNN<OutputLayerType, InitializationRuleType>::Serialize(
     reset = false;
 
     size_t offset = 0;
-    for (LayerTypes& layer : network)
+    for (LayerTypes<MatType>& layer : network)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
-          offset), layer);
+      offset += boost::apply_visitor(WeightSetVisitor<MatType>(std::move(
+          parameter), offset), layer);
 
       boost::apply_visitor(resetVisitor, layer);
     }
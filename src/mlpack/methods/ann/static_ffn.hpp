@@ -0,0 +1,240 @@
+/**
+ * @file static_ffn.hpp
+ *
+ * Definition of the StaticFFN class, a feed forward network whose layers are
+ * fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "layer/layer_traits.hpp"
+#include "init_rules/random_init.hpp"
+
+#include <tuple>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A feed forward network for prediction whose layers are given as template
+ * parameters.  The layers are held by value in a std::tuple instead of a vector
+ * of LayerTypes, so every layer call is resolved at compile time, without
+ * visitors, and the compiler can inline the whole forward pass.  This matters
+ * for small networks of a few layers, where the dispatch costs about as much
+ * as the layers themselves.
+ *
+ * Any of the existing layer classes can be used.  As in FFN, the parameters of
+ * all layers are stored in one matrix (see Parameters()), in the order of the
+ * layers, so the parameters of a trained FFN with the same layers can simply be
+ * copied into a StaticFFN:
+ *
+ * @code
+ * FFN<NegativeLogLikelihood<> > model;
+ * model.Add<Linear<> >(10, 20);
+ * model.Add<ReLULayer<> >();
+ * model.Add<Linear<> >(20, 3);
+ * model.Add<LogSoftMax<> >();
+ * // ... train the model ...
+ *
+ * StaticFFN<Linear<>, ReLULayer<>, Linear<>, LogSoftMax<> > network(
+ *     Linear<>(10, 20), ReLULayer<>(), Linear<>(20, 3), LogSoftMax<>());
+ * network.Parameters() = model.Parameters();
+ *
+ * arma::mat predictions;
+ * network.Predict(testData, predictions);
+ * @endcode
+ *
+ * Layers with a deterministic mode (like Dropout) are put into it, because the
+ * network is only used for prediction.
+ *
+ * @tparam Layers The types of the layers, from the input to the output.
+ */
+template<typename... Layers>
+class StaticFFN
+{
+  static_assert(sizeof...(Layers) > 0,
+      "StaticFFN needs at least one layer.");
+
+ public:
+  //! The tuple type that holds the layers.
+  typedef std::tuple<Layers...> NetworkType;
+
+  /**
+   * Create the network with default-constructed layers.  This is mostly useful
+   * before loading a network with data::Load().
+   */
+  StaticFFN();
+
+  /**
+   * Create the network from the given layers, and initialize the parameters
+   * with RandomInitialization.
+   *
+   * @param layers The layers of the network, from the input to the output.
+   */
+  StaticFFN(Layers... layers);
+
+  //! Copy the given network; the copy gets its own parameters.
+  StaticFFN(const StaticFFN& other);
+
+  //! Copy the given network into this one; this network gets its own
+  //! parameters.
+  StaticFFN& operator=(const StaticFFN& other);
+
+  /**
+   * Initialize the parameters of the network with the given initialization
+   * rule.
+   *
+   * @param initializeRule Rule to initialize the parameters.
+   */
+  template<typename InitializationRuleType = RandomInitialization>
+  void ResetParameters(
+      InitializationRuleType initializeRule = InitializationRuleType());
+
+  /**
+   * Predict the responses to the given data points, passing all of them
+   * through the network at once.
+   *
+   * @param predictors Input data points (one per column).
+   * @param results Matrix to store the predicted responses in.
+   */
+  void Predict(const arma::mat& predictors, arma::mat& results);
+
+  //! Get the layer with the given index.
+  template<size_t I>
+  const typename std::tuple_element<I, NetworkType>::type& Layer() const
+  {
+    return std::get<I>(network);
+  }
+  //! Modify the layer with the given index.
+  template<size_t I>
+  typename std::tuple_element<I, NetworkType>::type& Layer()
+  {
+    return std::get<I>(network);
+  }
+
+  //! Return the number of layers.
+  static constexpr size_t Size() { return sizeof...(Layers); }
+
+  //! Return the initial point for the optimization.
+  const arma::mat& Parameters() const { return parameter; }
+  //! Modify the initial point for the optimization.  The size must not be
+  //! changed, because the layers use the memory of this matrix.
+  arma::mat& Parameters() { return parameter; }
+
+  //! Serialize the network.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Pass the given input through the layers, starting from layer I.
+  template<size_t I>
+  typename std::enable_if<I + 1 < sizeof...(Layers), void>::type
+  Forward(arma::mat&& input, arma::mat& results);
+
+  //! Pass the given input through the last layer, into the results.
+  template<size_t I>
+  typename std::enable_if<I + 1 == sizeof...(Layers), void>::type
+  Forward(arma::mat&& input, arma::mat& results);
+
+  //! Return the number of parameters of the layers, starting from layer I.
+  template<size_t I>
+  typename std::enable_if<I < sizeof...(Layers), size_t>::type
+  NetworkSize();
+
+  //! End of the recursion over the layers.
+  template<size_t I>
+  typename std::enable_if<I == sizeof...(Layers), size_t>::type
+  NetworkSize() { return 0; }
+
+  //! Let the layers, starting from layer I, use the parameter memory that
+  //! starts at the given offset.
+  template<size_t I>
+  typename std::enable_if<I < sizeof...(Layers), void>::type
+  SetWeights(const size_t offset);
+
+  //! End of the recursion over the layers.
+  template<size_t I>
+  typename std::enable_if<I == sizeof...(Layers), void>::type
+  SetWeights(const size_t /* offset */) { }
+
+  //! Serialize the layers, starting from layer I.
+  template<size_t I, typename Archive>
+  typename std::enable_if<I < sizeof...(Layers), void>::type
+  SerializeLayers(Archive& ar);
+
+  //! End of the recursion over the layers.
+  template<size_t I, typename Archive>
+  typename std::enable_if<I == sizeof...(Layers), void>::type
+  SerializeLayers(Archive& /* ar */) { }
+
+  //! Return the number of parameters of the given layer.
+  template<typename T>
+  static typename std::enable_if<
+      HasParametersCheck<T, arma::mat&(T::*)()>::value, size_t>::type
+  LayerSize(T& layer) { return layer.Parameters().n_elem; }
+
+  //! Return the number of parameters of a layer without parameters.
+  template<typename T>
+  static typename std::enable_if<
+      !HasParametersCheck<T, arma::mat&(T::*)()>::value, size_t>::type
+  LayerSize(T& /* layer */) { return 0; }
+
+  //! Let the given layer use the given part of the parameter memory.
+  template<typename T>
+  typename std::enable_if<
+      HasParametersCheck<T, arma::mat&(T::*)()>::value, void>::type
+  LayerWeights(T& layer, const size_t offset, const size_t size);
+
+  //! Nothing to do for a layer without parameters.
+  template<typename T>
+  typename std::enable_if<
+      !HasParametersCheck<T, arma::mat&(T::*)()>::value, void>::type
+  LayerWeights(T& /* layer */,
+               const size_t /* offset */,
+               const size_t /* size */) { }
+
+  //! Reset the given layer, so that it uses its new parameters.
+  template<typename T>
+  static typename std::enable_if<
+      HasResetCheck<T, void(T::*)()>::value, void>::type
+  LayerReset(T& layer) { layer.Reset(); }
+
+  //! Nothing to do for a layer without Reset().
+  template<typename T>
+  static typename std::enable_if<
+      !HasResetCheck<T, void(T::*)()>::value, void>::type
+  LayerReset(T& /* layer */) { }
+
+  //! Put the given layer into its deterministic mode.
+  template<typename T>
+  static typename std::enable_if<
+      HasDeterministicCheck<T, bool&(T::*)(void)>::value, void>::type
+  LayerDeterministic(T& layer) { layer.Deterministic() = true; }
+
+  //! Nothing to do for a layer without a deterministic mode.
+  template<typename T>
+  static typename std::enable_if<
+      !HasDeterministicCheck<T, bool&(T::*)(void)>::value, void>::type
+  LayerDeterministic(T& /* layer */) { }
+
+  //! The layers of the network.
+  NetworkType network;
+
+  //! The parameters of all layers.
+  arma::mat parameter;
+}; // class StaticFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "static_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file static_ffn_impl.hpp
+ *
+ * Implementation of the StaticFFN class, a feed forward network whose layers
+ * are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "static_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename... Layers>
+StaticFFN<Layers...>::StaticFFN()
+{
+  // Nothing to do here.
+}
+
+template<typename... Layers>
+StaticFFN<Layers...>::StaticFFN(Layers... layers) :
+    network(std::move(layers)...)
+{
+  ResetParameters();
+}
+
+template<typename... Layers>
+StaticFFN<Layers...>::StaticFFN(const StaticFFN& other) :
+    network(other.network),
+    parameter(other.parameter)
+{
+  // The copied layers have to use the copied parameters.
+  SetWeights<0>(0);
+}
+
+template<typename... Layers>
+StaticFFN<Layers...>& StaticFFN<Layers...>::operator=(const StaticFFN& other)
+{
+  if (this != &other)
+  {
+    network = other.network;
+    parameter = other.parameter;
+    SetWeights<0>(0);
+  }
+
+  return *this;
+}
+
+template<typename... Layers>
+template<typename InitializationRuleType>
+void StaticFFN<Layers...>::ResetParameters(
+    InitializationRuleType initializeRule)
+{
+  parameter.set_size(NetworkSize<0>(), 1);
+  initializeRule.Initialize(parameter, parameter.n_elem, 1);
+  SetWeights<0>(0);
+}
+
+template<typename... Layers>
+void StaticFFN<Layers...>::Predict(const arma::mat& predictors,
+                                   arma::mat& results)
+{
+  // The layers do not modify their input, so the predictors are not copied.
+  Forward<0>(arma::mat(const_cast<double*>(predictors.memptr()),
+      predictors.n_rows, predictors.n_cols, false, true), results);
+}
+
+template<typename... Layers>
+template<size_t I>
+typename std::enable_if<I + 1 < sizeof...(Layers), void>::type
+StaticFFN<Layers...>::Forward(arma::mat&& input, arma::mat& results)
+{
+  typename std::tuple_element<I, NetworkType>::type& layer =
+      std::get<I>(network);
+
+  layer.Forward(std::move(input), std::move(layer.OutputParameter()));
+  Forward<I + 1>(std::move(layer.OutputParameter()), results);
+}
+
+template<typename... Layers>
+template<size_t I>
+typename std::enable_if<I + 1 == sizeof...(Layers), void>::type
+StaticFFN<Layers...>::Forward(arma::mat&& input, arma::mat& results)
+{
+  std::get<I>(network).Forward(std::move(input), std::move(results));
+}
+
+template<typename... Layers>
+template<size_t I>
+typename std::enable_if<I < sizeof...(Layers), size_t>::type
+StaticFFN<Layers...>::NetworkSize()
+{
+  return LayerSize(std::get<I>(network)) + NetworkSize<I + 1>();
+}
+
+template<typename... Layers>
+template<size_t I>
+typename std::enable_if<I < sizeof...(Layers), void>::type
+StaticFFN<Layers...>::SetWeights(const size_t offset)
+{
+  typename std::tuple_element<I, NetworkType>::type& layer =
+      std::get<I>(network);
+
+  const size_t size = LayerSize(layer);
+  LayerWeights(layer, offset, size);
+  LayerReset(layer);
+  LayerDeterministic(layer);
+
+  SetWeights<I + 1>(offset + size);
+}
+
+template<typename... Layers>
+template<typename T>
+typename std::enable_if<
+    HasParametersCheck<T, arma::mat&(T::*)()>::value, void>::type
+StaticFFN<Layers...>::LayerWeights(T& layer,
+                                   const size_t offset,
+                                   const size_t size)
+{
+  layer.Parameters() = arma::mat(parameter.memptr() + offset, size, 1, false,
+      false);
+}
+
+template<typename... Layers>
+template<typename Archive>
+void StaticFFN<Layers...>::Serialize(Archive& ar,
+                                     const unsigned int /* version */)
+{
+  // The layers have to be loaded first, so that they know their sizes.
+  SerializeLayers<0>(ar);
+  ar & data::CreateNVP(parameter, "parameter");
+
+  // If we are loading, the layers have to use the loaded parameters.
+  if (Archive::is_loading::value)
+    SetWeights<0>(0);
+}
+
+template<typename... Layers>
+template<size_t I, typename Archive>
+typename std::enable_if<I < sizeof...(Layers), void>::type
+StaticFFN<Layers...>::SerializeLayers(Archive& ar)
+{
+  std::ostringstream oss;
+  oss << "layer" << I;
+  ar & data::CreateNVP(std::get<I>(network), oss.str());
+
+  SerializeLayers<I + 1>(ar);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
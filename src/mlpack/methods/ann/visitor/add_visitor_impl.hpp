@@ -19,31 +19,35 @@ namespace mlpack {
 namespace ann {
 
 //! AddVisitor visitor class.
+template<typename MatType>
 template<typename T>
-inline AddVisitor::AddVisitor(T newLayer) :
+inline AddVisitor<MatType>::AddVisitor(T newLayer) :
     newLayer(std::move(newLayer))
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void AddVisitor::operator()(LayerType* layer) const
+inline void AddVisitor<MatType>::operator()(LayerType* layer) const
 {
   LayerAdd<LayerType>(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    HasAddCheck<T, void(T::*)(LayerTypes)>::value, void>::type
-AddVisitor::LayerAdd(T* layer) const
+    HasAddCheck<T, void(T::*)(LayerTypes<MatType>)>::value, void>::type
+AddVisitor<MatType>::LayerAdd(T* layer) const
 {
   layer->Add(newLayer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    !HasAddCheck<T, void(T::*)(LayerTypes)>::value, void>::type
-AddVisitor::LayerAdd(T* /* layer */) const
+    !HasAddCheck<T, void(T::*)(LayerTypes<MatType>)>::value, void>::type
+AddVisitor<MatType>::LayerAdd(T* /* layer */) const
 {
   /* Nothing to do here. */
 }
@@ -22,11 +22,12 @@ namespace ann {
  * This visitor is to support copy constructor for neural network module.
  * We want a layer-wise copy rather than simple duplicate the pointer.
  */
-class CopyVisitor : public boost::static_visitor<LayerTypes>
+template<typename MatType = arma::mat>
+class CopyVisitor : public boost::static_visitor<LayerTypes<MatType>>
 {
  public:
   template <typename LayerType>
-  LayerTypes operator()(LayerType*) const;
+  LayerTypes<MatType> operator()(LayerType*) const;
 };
 
 } // namespace ann
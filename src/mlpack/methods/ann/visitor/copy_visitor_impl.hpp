@@ -18,8 +18,10 @@
 namespace mlpack {
 namespace ann {
 
+template<typename MatType>
 template <typename LayerType>
-inline LayerTypes CopyVisitor::operator()(LayerType* layer) const
+inline LayerTypes<MatType> CopyVisitor<MatType>::operator()(
+    LayerType* layer) const
 {
   return new LayerType(*layer);
 }
@@ -24,12 +24,13 @@ namespace ann {
 /**
  * DeltaVisitor exposes the delta parameter of the given module.
  */
-class DeltaVisitor : public boost::static_visitor<arma::mat&>
+template<typename MatType = arma::mat>
+class DeltaVisitor : public boost::static_visitor<MatType&>
 {
  public:
   //! Return the delta parameter.
   template<typename LayerType>
-  arma::mat& operator()(LayerType* layer) const;
+  MatType& operator()(LayerType* layer) const;
 };
 
 } // namespace ann
@@ -19,8 +19,9 @@ namespace mlpack {
 namespace ann {
 
 //! DeltaVisitor visitor class.
+template<typename MatType>
 template<typename LayerType>
-inline arma::mat& DeltaVisitor::operator()(LayerType *layer) const
+inline MatType& DeltaVisitor<MatType>::operator()(LayerType *layer) const
 {
   return layer->Delta();
 }
@@ -34,7 +34,7 @@ inline void DeterministicSetVisitor::operator()(LayerType* layer) const
 template<typename T>
 inline typename std::enable_if<
     HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+    HasModel<T>::value, void>::type
 DeterministicSetVisitor::LayerDeterministic(T* layer) const
 {
   layer->Deterministic() = deterministic;
@@ -49,7 +49,7 @@ DeterministicSetVisitor::LayerDeterministic(T* layer) const
 template<typename T>
 inline typename std::enable_if<
     !HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+    HasModel<T>::value, void>::type
 DeterministicSetVisitor::LayerDeterministic(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
@@ -62,7 +62,7 @@ DeterministicSetVisitor::LayerDeterministic(T* layer) const
 template<typename T>
 inline typename std::enable_if<
     HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+    !HasModel<T>::value, void>::type
 DeterministicSetVisitor::LayerDeterministic(T* layer) const
 {
   layer->Deterministic() = deterministic;
@@ -71,7 +71,7 @@ DeterministicSetVisitor::LayerDeterministic(T* layer) const
 template<typename T>
 inline typename std::enable_if<
     !HasDeterministicCheck<T, bool&(T::*)(void)>::value &&
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+    !HasModel<T>::value, void>::type
 DeterministicSetVisitor::LayerDeterministic(T* /* input */) const
 {
   /* Nothing to do here. */
@@ -19,15 +19,18 @@ namespace mlpack {
 namespace ann {
 
 //! ForwardVisitor visitor class.
-inline ForwardVisitor::ForwardVisitor(arma::mat&& input, arma::mat&& output) :
+template<typename MatType>
+inline ForwardVisitor<MatType>::ForwardVisitor(MatType&& input,
+                                               MatType&& output) :
     input(std::move(input)),
     output(std::move(output))
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void ForwardVisitor::operator()(LayerType* layer) const
+inline void ForwardVisitor<MatType>::operator()(LayerType* layer) const
 {
   layer->Forward(std::move(input), std::move(output));
 }
@@ -0,0 +1,97 @@
+/**
+ * @file freeze_visitor_impl.hpp
+ *
+ * Implementation of the layer abstraction that freezes the layers of a
+ * network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_FREEZE_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_FREEZE_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "freeze_visitor.hpp"
+
+#include <mlpack/methods/ann/frozen_ffn.hpp>
+
+namespace mlpack {
+namespace ann {
+
+//! FreezeVisitor visitor class.
+inline FreezeVisitor::FreezeVisitor(FrozenFFN& network) : network(network)
+{
+  /* Nothing to do here. */
+}
+
+inline void FreezeVisitor::operator()(Linear<arma::mat, arma::mat>* layer)
+    const
+{
+  const arma::mat& parameters = layer->Parameters();
+  const size_t inSize = layer->InputSize();
+  const size_t outSize = layer->OutputSize();
+
+  network.AddLinear(arma::mat(parameters.memptr(), outSize, inSize),
+      arma::vec(parameters.memptr() + outSize * inSize, outSize));
+}
+
+inline void FreezeVisitor::operator()(
+    LinearNoBias<arma::mat, arma::mat>* layer) const
+{
+  network.AddLinear(arma::mat(layer->Parameters().memptr(),
+      layer->OutputSize(), layer->InputSize()), arma::vec());
+}
+
+inline void FreezeVisitor::operator()(
+    BaseLayer<IdentityFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+inline void FreezeVisitor::operator()(
+    BaseLayer<RectifierFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(FrozenFFN::RECTIFIER);
+}
+
+inline void FreezeVisitor::operator()(
+    BaseLayer<LogisticFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(FrozenFFN::LOGISTIC);
+}
+
+inline void FreezeVisitor::operator()(
+    BaseLayer<TanhFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(FrozenFFN::TANH);
+}
+
+inline void FreezeVisitor::operator()(
+    LogSoftMax<arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(FrozenFFN::LOG_SOFTMAX);
+}
+
+inline void FreezeVisitor::operator()(Dropout<arma::mat, arma::mat>* layer)
+    const
+{
+  // At prediction time a Dropout layer passes its input through, multiplied by
+  // 1 / (1 - ratio) if it rescales.
+  if (layer->Rescale())
+    network.AddScale(1.0 / (1.0 - layer->Ratio()));
+}
+
+template<typename LayerType>
+inline void FreezeVisitor::operator()(LayerType* /* layer */) const
+{
+  throw std::invalid_argument("FrozenFFN: the network contains a layer that "
+      "cannot be frozen; only Linear, LinearNoBias, Dropout, LogSoftMax "
+      "and identity, rectifier, sigmoid and tanh layers are supported");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -24,6 +24,7 @@ namespace ann {
 /*
  * GradientZeroVisitor set the gradient to zero for the given module.
  */
+template<typename MatType = arma::mat>
 class GradientZeroVisitor : public boost::static_visitor<void>
 {
  public:
@@ -38,8 +39,8 @@ class GradientZeroVisitor : public boost::static_visitor<void>
   //! Set the gradient to zero if the module implements the Gradient() function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value, void>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+      HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Do not set the gradient to zero if the module doesn't implement the
   //! Gradient() function.
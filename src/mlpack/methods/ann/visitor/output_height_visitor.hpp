@@ -38,7 +38,7 @@ class OutputHeightVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       !HasInputHeight<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModel<T>::value, size_t>::type
   LayerOutputHeight(T* layer) const;
 
   //! Return the output height if the module implements the InputHeight()
@@ -46,14 +46,14 @@ class OutputHeightVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       HasInputHeight<T, size_t&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModel<T>::value, size_t>::type
   LayerOutputHeight(T* layer) const;
 
   //! Return the output height if the module implements the Model() function.
   template<typename T>
   typename std::enable_if<
       !HasInputHeight<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModel<T>::value, size_t>::type
   LayerOutputHeight(T* layer) const;
 
   //! Return the output height if the module implement the Model() or
@@ -61,7 +61,7 @@ class OutputHeightVisitor : public boost::static_visitor<size_t>
   template<typename T>
   typename std::enable_if<
       HasInputHeight<T, size_t&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModel<T>::value, size_t>::type
   LayerOutputHeight(T* layer) const;
 };
 
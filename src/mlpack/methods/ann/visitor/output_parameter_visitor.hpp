@@ -24,12 +24,13 @@ namespace ann {
 /**
  * OutputParameterVisitor exposes the output parameter of the given module.
  */
-class OutputParameterVisitor : public boost::static_visitor<arma::mat&>
+template<typename MatType = arma::mat>
+class OutputParameterVisitor : public boost::static_visitor<MatType&>
 {
  public:
   //! Return the output parameter set.
   template<typename LayerType>
-  arma::mat& operator()(LayerType* layer) const;
+  MatType& operator()(LayerType* layer) const;
 };
 
 } // namespace ann
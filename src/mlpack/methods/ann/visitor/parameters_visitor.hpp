@@ -25,11 +25,12 @@ namespace ann {
  * ParametersVisitor exposes the parameters set of the given module and stores
  * the parameters set into the given matrix.
  */
+template<typename MatType = arma::mat>
 class ParametersVisitor : public boost::static_visitor<void>
 {
  public:
   //! Store the parameters set into the given parameters matrix.
-  ParametersVisitor(arma::mat&& parameters);
+  ParametersVisitor(MatType&& parameters);
 
   //! Set the parameters set.
   template<typename LayerType>
@@ -37,7 +38,7 @@ class ParametersVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameters set.
-  arma::mat&& parameters;
+  MatType&& parameters;
 
   //! Do not set the parameters set if the module doesn't implement the
   //! Parameters() function.
@@ -19,30 +19,35 @@ namespace mlpack {
 namespace ann {
 
 //! ParametersVisitor visitor class.
-inline ParametersVisitor::ParametersVisitor(arma::mat&& parameters) :
+template<typename MatType>
+inline ParametersVisitor<MatType>::ParametersVisitor(MatType&& parameters) :
     parameters(std::move(parameters))
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void ParametersVisitor::operator()(LayerType *layer) const
+inline void ParametersVisitor<MatType>::operator()(LayerType *layer) const
 {
   LayerParameters(layer, layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value, void>::type
-ParametersVisitor::LayerParameters(T* /* layer */, P& /* output */) const
+ParametersVisitor<MatType>::LayerParameters(T* /* layer */,
+                                            P& /* output */) const
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value, void>::type
-ParametersVisitor::LayerParameters(T* layer, P& /* output */) const
+ParametersVisitor<MatType>::LayerParameters(T* layer, P& /* output */) const
 {
   parameters = layer->Parameters();
 }
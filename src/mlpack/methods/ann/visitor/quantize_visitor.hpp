@@ -0,0 +1,83 @@
+/**
+ * @file quantize_visitor.hpp
+ *
+ * This file provides an abstraction that adds the layers of a trained network
+ * to a QuantizedFFN, one layer at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+class QuantizedFFN;
+
+/**
+ * QuantizeVisitor adds the given layer to a QuantizedFFN.  Layers that cannot
+ * be quantized cause a std::invalid_argument exception.
+ */
+class QuantizeVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Add the visited layers to the given quantized network.
+  QuantizeVisitor(QuantizedFFN& network);
+
+  //! Add the weights and the bias of a Linear layer.
+  void operator()(Linear<arma::mat, arma::mat>* layer) const;
+
+  //! Add the weights of a LinearNoBias layer.
+  void operator()(LinearNoBias<arma::mat, arma::mat>* layer) const;
+
+  //! Add the kernels, the bias and the geometry of a Convolution layer.
+  template<typename ForwardConvolutionRule,
+           typename BackwardConvolutionRule,
+           typename GradientConvolutionRule>
+  void operator()(Convolution<ForwardConvolutionRule, BackwardConvolutionRule,
+      GradientConvolutionRule, arma::mat, arma::mat>* layer) const;
+
+  //! Add an identity layer (nothing to do).
+  void operator()(BaseLayer<IdentityFunction, arma::mat, arma::mat>* layer)
+      const;
+
+  //! Add a rectifier layer.
+  void operator()(BaseLayer<RectifierFunction, arma::mat, arma::mat>* layer)
+      const;
+
+  //! Add a sigmoid layer.
+  void operator()(BaseLayer<LogisticFunction, arma::mat, arma::mat>* layer)
+      const;
+
+  //! Add a tanh layer.
+  void operator()(BaseLayer<TanhFunction, arma::mat, arma::mat>* layer) const;
+
+  //! Add a LogSoftMax layer.
+  void operator()(LogSoftMax<arma::mat, arma::mat>* layer) const;
+
+  //! Fold a Dropout layer, which only scales its input at prediction time.
+  void operator()(Dropout<arma::mat, arma::mat>* layer) const;
+
+  //! Any other layer cannot be quantized.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+ private:
+  //! The quantized network the layers are added to.
+  QuantizedFFN& network;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantize_visitor_impl.hpp"
+
+#endif
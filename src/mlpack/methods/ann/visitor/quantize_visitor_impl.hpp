@@ -0,0 +1,129 @@
+/**
+ * @file quantize_visitor_impl.hpp
+ *
+ * Implementation of the QuantizeVisitor class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantize_visitor.hpp"
+
+#include <mlpack/methods/ann/quantized_ffn.hpp>
+
+namespace mlpack {
+namespace ann {
+
+//! QuantizeVisitor visitor class.
+inline QuantizeVisitor::QuantizeVisitor(QuantizedFFN& network) :
+    network(network)
+{
+  /* Nothing to do here. */
+}
+
+inline void QuantizeVisitor::operator()(Linear<arma::mat, arma::mat>* layer)
+    const
+{
+  const arma::mat& parameters = layer->Parameters();
+  const size_t inSize = layer->InputSize();
+  const size_t outSize = layer->OutputSize();
+
+  network.AddLinear(arma::mat(parameters.memptr(), outSize, inSize),
+      arma::vec(parameters.memptr() + outSize * inSize, outSize));
+}
+
+inline void QuantizeVisitor::operator()(
+    LinearNoBias<arma::mat, arma::mat>* layer) const
+{
+  network.AddLinear(arma::mat(layer->Parameters().memptr(),
+      layer->OutputSize(), layer->InputSize()),
+      arma::zeros<arma::vec>(layer->OutputSize()));
+}
+
+template<typename ForwardConvolutionRule,
+         typename BackwardConvolutionRule,
+         typename GradientConvolutionRule>
+inline void QuantizeVisitor::operator()(
+    Convolution<ForwardConvolutionRule, BackwardConvolutionRule,
+    GradientConvolutionRule, arma::mat, arma::mat>* layer) const
+{
+  // The kernels of output map o are column o of the kernel matrix; see
+  // LayerConvolution<Im2ColConvolution<> >.
+  const arma::mat& parameters = layer->Parameters();
+  const size_t kernelSize = layer->KernelWidth() * layer->KernelHeight() *
+      layer->InputSize();
+  const size_t outSize = layer->OutputSize();
+
+  QuantizedFFN::Geometry geometry;
+  geometry.inSize = layer->InputSize();
+  geometry.inputWidth = layer->InputWidth();
+  geometry.inputHeight = layer->InputHeight();
+  geometry.kW = layer->KernelWidth();
+  geometry.kH = layer->KernelHeight();
+  geometry.dW = layer->StrideWidth();
+  geometry.dH = layer->StrideHeight();
+  geometry.padW = layer->PadWidth();
+  geometry.padH = layer->PadHeight();
+
+  network.AddConvolution(arma::mat(parameters.memptr(), kernelSize, outSize),
+      arma::vec(parameters.memptr() + kernelSize * outSize, outSize),
+      geometry);
+}
+
+inline void QuantizeVisitor::operator()(
+    BaseLayer<IdentityFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+inline void QuantizeVisitor::operator()(
+    BaseLayer<RectifierFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(QuantizedFFN::RECTIFIER);
+}
+
+inline void QuantizeVisitor::operator()(
+    BaseLayer<LogisticFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(QuantizedFFN::LOGISTIC);
+}
+
+inline void QuantizeVisitor::operator()(
+    BaseLayer<TanhFunction, arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(QuantizedFFN::TANH);
+}
+
+inline void QuantizeVisitor::operator()(
+    LogSoftMax<arma::mat, arma::mat>* /* layer */) const
+{
+  network.AddActivation(QuantizedFFN::LOG_SOFTMAX);
+}
+
+inline void QuantizeVisitor::operator()(Dropout<arma::mat, arma::mat>* layer)
+    const
+{
+  // At prediction time a Dropout layer passes its input through, multiplied by
+  // 1 / (1 - ratio) if it rescales.
+  if (layer->Rescale())
+    network.AddScale(1.0 / (1.0 - layer->Ratio()));
+}
+
+template<typename LayerType>
+inline void QuantizeVisitor::operator()(LayerType* /* layer */) const
+{
+  throw std::invalid_argument("QuantizedFFN: the network contains a layer "
+      "that cannot be quantized; only Linear, LinearNoBias, Convolution, "
+      "Dropout, LogSoftMax and identity, rectifier, sigmoid and tanh layers "
+      "are supported");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
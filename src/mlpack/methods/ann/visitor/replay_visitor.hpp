@@ -0,0 +1,64 @@
+/**
+ * @file replay_visitor.hpp
+ *
+ * Boost static visitor abstraction for calling the Replay() function of the
+ * recurrent layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_REPLAY_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_REPLAY_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * ReplayVisitor executes the Replay() function, so that the next Forward()
+ * call of a recurrent layer recomputes the given time step from the states it
+ * has stored.  Layers without a Replay() function keep no state between time
+ * steps, so nothing is done for them.
+ */
+class ReplayVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Execute the Replay() function for the given time step.
+  ReplayVisitor(const size_t step);
+
+  //! Execute the Replay() function.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+ private:
+  //! The time step to recompute.
+  size_t step;
+
+  //! Execute the Replay() function for a module which implements the Replay()
+  //! function.
+  template<typename T>
+  typename std::enable_if<
+      HasReplayCheck<T, void(T::*)(const size_t)>::value, void>::type
+  Replay(T* layer) const;
+
+  //! Do not execute the Replay() function for a module which doesn't implement
+  //! the Replay() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasReplayCheck<T, void(T::*)(const size_t)>::value, void>::type
+  Replay(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "replay_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file replay_visitor_impl.hpp
+ *
+ * Implementation of the Replay() function layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_REPLAY_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_REPLAY_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "replay_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! ReplayVisitor visitor class.
+inline ReplayVisitor::ReplayVisitor(const size_t step) : step(step)
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline void ReplayVisitor::operator()(LayerType* layer) const
+{
+  Replay(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasReplayCheck<T, void(T::*)(const size_t)>::value, void>::type
+ReplayVisitor::Replay(T* layer) const
+{
+  layer->Replay(step);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasReplayCheck<T, void(T::*)(const size_t)>::value, void>::type
+ReplayVisitor::Replay(T* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -37,7 +37,7 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasResetCheck<T, void(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModel<T>::value, void>::type
   ResetParameter(T* layer) const;
 
   //! Execute the Reset() function for a module which implements the Model()
@@ -45,7 +45,7 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasResetCheck<T, void(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModel<T>::value, void>::type
   ResetParameter(T* layer) const;
 
   //! Execute the Reset() function for a module which implements the Reset()
@@ -53,7 +53,7 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasResetCheck<T, void(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModel<T>::value, void>::type
   ResetParameter(T* layer) const;
 
   //! Do not execute the Reset() function for a module which doesn't implement
@@ -61,7 +61,7 @@ class ResetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasResetCheck<T, void(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModel<T>::value, void>::type
   ResetParameter(T* layer) const;
 };
 
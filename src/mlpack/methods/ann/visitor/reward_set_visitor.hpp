@@ -43,7 +43,7 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasRewardCheck<T, double&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModel<T>::value, void>::type
   LayerReward(T* layer) const;
 
   //! Set the deterministic parameter if the module implements the
@@ -51,7 +51,7 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasRewardCheck<T, double&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModel<T>::value, void>::type
   LayerReward(T* layer) const;
 
   //! Set the deterministic parameter if the module implements the
@@ -59,7 +59,7 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       HasRewardCheck<T, double&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModel<T>::value, void>::type
   LayerReward(T* layer) const;
 
   //! Do not set the deterministic parameter if the module doesn't implement the
@@ -67,7 +67,7 @@ class RewardSetVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasRewardCheck<T, double&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModel<T>::value, void>::type
   LayerReward(T* layer) const;
 };
 
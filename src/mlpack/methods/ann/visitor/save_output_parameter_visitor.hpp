@@ -25,11 +25,12 @@ namespace ann {
  * SaveOutputParameterVisitor saves the output parameter into the given
  * parameter set.
  */
+template<typename MatType = arma::mat>
 class SaveOutputParameterVisitor : public boost::static_visitor<void>
 {
  public:
   //! Save the output parameter into the given parameter set.
-  SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter);
+  SaveOutputParameterVisitor(std::vector<MatType>&& parameter);
 
   //! Save the output parameter.
   template<typename LayerType>
@@ -37,20 +38,20 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameter set.
-  std::vector<arma::mat>&& parameter;
+  std::vector<MatType>&& parameter;
 
   //! Save the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
   typename std::enable_if<
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      !HasModel<T>::value, void>::type
   OutputParameter(T* layer) const;
 
   //! Save the output parameter for a module which implements the Model()
   //! function.
   template<typename T>
   typename std::enable_if<
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+      HasModel<T>::value, void>::type
   OutputParameter(T* layer) const;
 };
 
@@ -19,30 +19,35 @@ namespace mlpack {
 namespace ann {
 
 //! SaveOutputParameterVisitor visitor class.
-inline SaveOutputParameterVisitor::SaveOutputParameterVisitor(
-    std::vector<arma::mat>&& parameter) : parameter(std::move(parameter))
+template<typename MatType>
+inline SaveOutputParameterVisitor<MatType>::SaveOutputParameterVisitor(
+    std::vector<MatType>&& parameter) : parameter(std::move(parameter))
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void SaveOutputParameterVisitor::operator()(LayerType* layer) const
+inline void SaveOutputParameterVisitor<MatType>::operator()(
+    LayerType* layer) const
 {
   OutputParameter(layer);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-SaveOutputParameterVisitor::OutputParameter(T* layer) const
+    !HasModel<T>::value, void>::type
+SaveOutputParameterVisitor<MatType>::OutputParameter(T* layer) const
 {
   parameter.push_back(layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
-    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
-SaveOutputParameterVisitor::OutputParameter(T* layer) const
+    HasModel<T>::value, void>::type
+SaveOutputParameterVisitor<MatType>::OutputParameter(T* layer) const
 {
   parameter.push_back(layer->OutputParameter());
 
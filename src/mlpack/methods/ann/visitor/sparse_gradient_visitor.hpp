@@ -0,0 +1,88 @@
+/**
+ * @file sparse_gradient_visitor.hpp
+ *
+ * This file provides an abstraction for the sparse gradient of the layers that
+ * have one (like Lookup), and the Gradient() function of the other layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include "gradient_visitor.hpp"
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * SparseGradientVisitor executes the SparseGradient() method of the given
+ * module if it has a sparse gradient, and adds the nonzero elements of the
+ * gradient (as indices into the parameters of the network, and values) to the
+ * given vectors.  Other modules execute their Gradient() method, as with
+ * GradientVisitor.  The visitor returns whether the module has a sparse
+ * gradient.
+ */
+template<typename MatType = arma::mat>
+class SparseGradientVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Executes the SparseGradient() or the Gradient() method of the given
+  //! module using the input and delta parameter.  The parameters of the
+  //! module start at the given offset into the parameters of the network.
+  SparseGradientVisitor(MatType&& input,
+                        MatType&& delta,
+                        const size_t offset,
+                        std::vector<arma::uword>& rows,
+                        std::vector<typename MatType::elem_type>& values);
+
+  //! Executes the SparseGradient() or the Gradient() method.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+ private:
+  //! The input set.
+  MatType&& input;
+
+  //! The delta parameter.
+  MatType&& delta;
+
+  //! The offset of the parameters of the module.
+  size_t offset;
+
+  //! The indices of the nonzero elements of the gradient.
+  std::vector<arma::uword>& rows;
+
+  //! The values of the nonzero elements of the gradient.
+  std::vector<typename MatType::elem_type>& values;
+
+  //! Execute the SparseGradient() function if the module has a sparse
+  //! gradient.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value,
+      bool>::type
+  LayerGradients(T* layer) const;
+
+  //! Execute the Gradient() function (if any) if the module doesn't have a
+  //! sparse gradient.
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value,
+      bool>::type
+  LayerGradients(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_gradient_visitor_impl.hpp"
+
+#endif
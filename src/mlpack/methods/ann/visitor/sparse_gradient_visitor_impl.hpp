@@ -0,0 +1,86 @@
+/**
+ * @file sparse_gradient_visitor_impl.hpp
+ *
+ * Implementation of the sparse gradient layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_gradient_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! SparseGradientVisitor visitor class.
+template<typename MatType>
+inline SparseGradientVisitor<MatType>::SparseGradientVisitor(
+    MatType&& input,
+    MatType&& delta,
+    const size_t offset,
+    std::vector<arma::uword>& rows,
+    std::vector<typename MatType::elem_type>& values) :
+    input(std::move(input)),
+    delta(std::move(delta)),
+    offset(offset),
+    rows(rows),
+    values(values)
+{
+  /* Nothing to do here. */
+}
+
+template<typename MatType>
+template<typename LayerType>
+inline bool SparseGradientVisitor<MatType>::operator()(LayerType* layer) const
+{
+  return LayerGradients(layer);
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value,
+    bool>::type
+SparseGradientVisitor<MatType>::LayerGradients(T* layer) const
+{
+  layer->SparseGradient(std::move(input), std::move(delta));
+
+  // The weights are stored column by column in the parameters, and the
+  // columns are sorted, so the indices are sorted too.
+  const arma::uvec& columns = layer->GradientColumns();
+  const MatType& columnGradients = layer->GradientValues();
+  const size_t nRows = layer->Parameters().n_rows;
+  rows.reserve(rows.size() + columnGradients.n_elem);
+  values.reserve(values.size() + columnGradients.n_elem);
+  for (size_t c = 0; c < columns.n_elem; ++c)
+  {
+    for (size_t r = 0; r < nRows; ++r)
+    {
+      rows.push_back(offset + columns[c] * nRows + r);
+      values.push_back(columnGradients(r, c));
+    }
+  }
+
+  return true;
+}
+
+template<typename MatType>
+template<typename T>
+inline typename std::enable_if<
+    !HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value,
+    bool>::type
+SparseGradientVisitor<MatType>::LayerGradients(T* layer) const
+{
+  GradientVisitor<MatType>(std::move(input), std::move(delta))(layer);
+  return false;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -38,7 +38,7 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       !HasParametersCheck<T, P&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModel<T>::value, size_t>::type
   LayerSize(T* layer, P& output) const;
 
   //! Return the number of parameters if the module implements the Model()
@@ -46,7 +46,7 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       !HasParametersCheck<T, P&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModel<T>::value, size_t>::type
   LayerSize(T* layer, P& output) const;
 
   //! Return the number of parameters if the module implements the Parameters()
@@ -54,7 +54,7 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       HasParametersCheck<T, P&(T::*)()>::value &&
-      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      !HasModel<T>::value, size_t>::type
   LayerSize(T* layer, P& output) const;
 
   //! Return the accumulated number of parameters if the module implements the
@@ -62,7 +62,7 @@ class WeightSizeVisitor : public boost::static_visitor<size_t>
   template<typename T, typename P>
   typename std::enable_if<
       HasParametersCheck<T, P&(T::*)()>::value &&
-      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+      HasModel<T>::value, size_t>::type
   LayerSize(T* layer, P& output) const;
 };
 
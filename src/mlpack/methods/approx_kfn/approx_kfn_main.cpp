@@ -16,6 +16,8 @@
 #include "drusilla_select.hpp"
 #include "qdafn.hpp"
 
+#include <fstream>
+
 using namespace mlpack;
 using namespace mlpack::neighbor;
 using namespace std;
@@ -85,7 +87,11 @@ PROGRAM_INFO("Approximate furthest neighbor search",
     PRINT_DATASET("neighbors") + " by calling"
     "\n\n" +
     PRINT_CALL("approx_kfn", "input_model", "model", "query", "new_query_set",
-        "k", 3, "neighbors", "neighbors"));
+        "k", 3, "neighbors", "neighbors") +
+    "\n\n"
+    "A model can also be saved as a flat index with --output_index_file.  An "
+    "index given with --input_index_file is memory-mapped instead of loaded, "
+    "so programs that run many times on the same model start quickly.");
 
 PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
 PARAM_MATRIX_IN("query", "Matrix containing query points.", "q");
@@ -132,6 +138,38 @@ class ApproxKFNModel
       ar & data::CreateNVP(qdafn, "model");
     }
   }
+
+  //! Save the model as a flat index.
+  void SaveIndex(const std::string& filename) const
+  {
+    if (type == 0)
+      ds.SaveIndex(filename);
+    else
+      qdafn.SaveIndex(filename);
+  }
+
+  //! Load the model from a flat index of either type.
+  void LoadIndex(const std::string& filename)
+  {
+    // The type of the model is given by the magic bytes at the start.
+    char magic[8] = { 0 };
+    std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+      throw std::runtime_error("cannot open file '" + filename + "'");
+    stream.read(magic, sizeof(magic));
+    stream.close();
+
+    if (std::string(magic, 7) == "MLPKQDI")
+    {
+      type = 1;
+      qdafn.LoadIndex(filename);
+    }
+    else
+    {
+      type = 0;
+      ds.LoadIndex(filename);
+    }
+  }
 };
 
 // Model loading and saving.
@@ -139,23 +177,31 @@ PARAM_MODEL_IN(ApproxKFNModel, "input_model", "File containing input model.",
     "m");
 PARAM_MODEL_OUT(ApproxKFNModel, "output_model", "File to save output model to.",
     "M");
+PARAM_STRING_IN("input_index_file", "Model saved as a flat index with "
+    "--output_index_file; it is memory-mapped instead of loaded.", "", "");
+PARAM_STRING_IN("output_index_file", "If specified, the model will be saved "
+    "here as a flat index.", "", "");
 
 void mlpackMain()
 {
-  if (!CLI::HasParam("reference") && !CLI::HasParam("input_model"))
-    Log::Fatal << "Either --reference_file (-r) or --input_model_file (-m) must"
-        << " be specified!" << endl;
-  if (CLI::HasParam("reference") && CLI::HasParam("input_model"))
-    Log::Fatal << "Only one of --reference_file (-r) or --input_model_file (-m)"
-        << " can be specified!" << endl;
-  if (!CLI::HasParam("output_model") && !CLI::HasParam("k"))
-    Log::Warn << "Neither --output_model_file (-M) nor --k (-k) are specified;"
-        << " no task will be performed." << endl;
+  const size_t numSources = (CLI::HasParam("reference") ? 1 : 0) +
+      (CLI::HasParam("input_model") ? 1 : 0) +
+      (CLI::HasParam("input_index_file") ? 1 : 0);
+  if (numSources == 0)
+    Log::Fatal << "One of --reference_file (-r), --input_model_file (-m) or "
+        << "--input_index_file must be specified!" << endl;
+  if (numSources > 1)
+    Log::Fatal << "Only one of --reference_file (-r), --input_model_file (-m) "
+        << "or --input_index_file can be specified!" << endl;
+  if (!CLI::HasParam("output_model") && !CLI::HasParam("output_index_file") &&
+      !CLI::HasParam("k"))
+    Log::Warn << "Neither --output_model_file (-M), --output_index_file nor "
+        << "--k (-k) are specified; no task will be performed." << endl;
   if (!CLI::HasParam("neighbors") && !CLI::HasParam("distances") &&
-      !CLI::HasParam("output_model"))
-    Log::Warn << "None of --output_model_file (-M), --neighbors_file (-n), or "
-        << "--distances_file (-d) are specified; no output will be saved!"
-        << endl;
+      !CLI::HasParam("output_model") && !CLI::HasParam("output_index_file"))
+    Log::Warn << "None of --output_model_file (-M), --output_index_file, "
+        << "--neighbors_file (-n), or --distances_file (-d) are specified; no "
+        << "output will be saved!" << endl;
   if (CLI::GetParam<string>("algorithm") != "ds" &&
       CLI::GetParam<string>("algorithm") != "qdafn")
     Log::Fatal << "Unknown algorithm '" << CLI::GetParam<string>("algorithm")
@@ -216,6 +262,22 @@ void mlpackMain()
     }
     Log::Info << "Model built." << endl;
   }
+  else if (CLI::HasParam("input_index_file"))
+  {
+    // Map the index from file.
+    const string indexFile = CLI::GetParam<string>("input_index_file");
+    try
+    {
+      m.LoadIndex(indexFile);
+    }
+    catch (std::exception& e)
+    {
+      Log::Fatal << "Cannot load index from '" << indexFile << "': "
+          << e.what() << endl;
+    }
+    Log::Info << "Loaded " << (m.type == 0 ? "DrusillaSelect" : "QDAFN")
+        << " index from '" << indexFile << "'." << endl;
+  }
   else
   {
     // We must load the model from file.
@@ -291,6 +353,20 @@ void mlpackMain()
       CLI::GetParam<arma::mat>("distances") = std::move(distances);
   }
 
+  if (CLI::HasParam("output_index_file"))
+  {
+    const string indexFile = CLI::GetParam<string>("output_index_file");
+    try
+    {
+      m.SaveIndex(indexFile);
+    }
+    catch (std::exception& e)
+    {
+      Log::Fatal << "Cannot save index to '" << indexFile << "': " << e.what()
+          << endl;
+    }
+  }
+
   // Should we save the model?
   if (CLI::HasParam("output_model"))
     CLI::GetParam<ApproxKFNModel>("output_model") = std::move(m);
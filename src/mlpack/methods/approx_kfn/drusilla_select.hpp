@@ -31,6 +31,7 @@
 #define MLPACK_METHODS_APPROX_KFN_DRUSILLA_SELECT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
 
 namespace mlpack {
 namespace neighbor {
@@ -66,6 +67,9 @@ class DrusillaSelect
    * are left unspecified, then the values set in the constructor will be used
    * instead.
    *
+   * The points are projected onto each line with one matrix-vector product,
+   * and the scores of the points are computed in parallel.
+   *
    * @param referenceSet Set to extract candidate points from.
    * @param l Number of projections.
    * @param m Number of elements to store for each projection.
@@ -81,7 +85,8 @@ class DrusillaSelect
    * NeighborSearch and LSHSearch classes.  That is, each column in the
    * neighbors and distances matrices will refer to a single query point, and
    * the k'th row in that column will refer to the k'th candidate neighbor or
-   * distance for that query point.
+   * distance for that query point.  The query points are split between the
+   * OpenMP threads.
    *
    * @param querySet Set of query points to search.
    * @param k Number of furthest neighbors to search for.
@@ -99,6 +104,27 @@ class DrusillaSelect
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
 
+  /**
+   * Save the trained model to the given file as a flat index, which
+   * LoadIndex() can use in place from a memory-mapped file.  Only dense
+   * matrix types can be saved this way.
+   *
+   * @param filename File to save to.
+   */
+  void SaveIndex(const std::string& filename) const;
+
+  /**
+   * Load a model from an index saved with SaveIndex().  The file is mapped into
+   * memory and the candidate set is used in place, so loading is fast, and
+   * several processes that load the same index share one copy of it.  The file
+   * must not be modified while the model is in use, and the candidate set must
+   * not be modified until the model is trained again.  A std::runtime_error is
+   * thrown if the file is not a valid index for this type of model.
+   *
+   * @param filename File to load from.
+   */
+  void LoadIndex(const std::string& filename);
+
   //! Access the candidate set.
   const MatType& CandidateSet() const { return candidateSet; }
   //! Modify the candidate set.  Be careful!
@@ -119,6 +145,28 @@ class DrusillaSelect
   size_t l;
   //! The number of points in each projection.
   size_t m;
+
+  //! If the model was loaded with LoadIndex(), the mapped index file, which
+  //! holds the candidate set; otherwise NULL.
+  std::shared_ptr<data::MappedFile> mappedIndex;
+
+  //! The header of an index file written by SaveIndex().
+  struct IndexHeader
+  {
+    //! Identifies the format.
+    char magic[8];
+    //! Version of the format.
+    uint64_t version;
+    //! Size in bytes of each element of the candidate set.
+    uint64_t elementSize;
+    uint64_t l;
+    uint64_t m;
+    //! Dimensionality of the candidate set.
+    uint64_t rows;
+    //! Offset of the candidate set, which is a multiple of 4096; the indices
+    //! of the candidates follow the header.
+    uint64_t candidatesOffset;
+  };
 };
 
 } // namespace neighbor
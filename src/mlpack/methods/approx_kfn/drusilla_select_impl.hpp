@@ -16,10 +16,9 @@
 #include "drusilla_select.hpp"
 
 #include <queue>
-#include <mlpack/methods/neighbor_search/neighbor_search_rules.hpp>
-#include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
-#include <mlpack/core/tree/binary_space_tree.hpp>
 #include <algorithm>
+#include <fstream>
+#include <cstring>
 
 namespace mlpack {
 namespace neighbor {
@@ -78,19 +77,28 @@ void DrusillaSelect<MatType>::Train(
         "large!  Choose smaller values.  l*m must be smaller than the number "
         "of points in the dataset.");
 
+  // If the model was loaded from an index, the old candidate set lives in the
+  // mapped file, so it must not be reused.
+  candidateSet.reset();
+  mappedIndex.reset();
+
   candidateSet.set_size(referenceSet.n_rows, l * m);
   candidateIndices.set_size(l * m);
 
   arma::vec dataMean(arma::mean(referenceSet, 1));
   arma::vec norms(referenceSet.n_cols);
+  arma::vec squaredNorms(referenceSet.n_cols);
 
   MatType refCopy(referenceSet.n_rows, referenceSet.n_cols);
   for (size_t i = 0; i < refCopy.n_cols; ++i)
   {
     refCopy.col(i) = referenceSet.col(i) - dataMean;
     norms[i] = arma::norm(refCopy.col(i));
+    squaredNorms[i] = norms[i] * norms[i];
   }
 
+  const size_t threads = ParallelThreads();
+
   // Find the top m points for each of the l projections...
   for (size_t i = 0; i < l; ++i)
   {
@@ -100,16 +108,25 @@ void DrusillaSelect<MatType>::Train(
 
     arma::vec line(refCopy.col(maxIndex) / arma::norm(refCopy.col(maxIndex)));
 
-    // Calculate distortion and offset and make scores.
-    std::vector<bool> closeAngle(referenceSet.n_cols, false);
+    // Project every point onto the line at once.  Since the line has unit
+    // length, the distortion (the distance of the point to the line) follows
+    // from the offset and the norm of the point.
+    const arma::rowvec offsets = line.t() * refCopy;
+
+    // Calculate distortion and offset and make scores.  (This is a vector of
+    // char and not bool, so that different threads can write neighboring
+    // elements.)
+    std::vector<char> closeAngle(referenceSet.n_cols, 0);
     arma::vec sums(referenceSet.n_cols);
-    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+    #pragma omp parallel for num_threads(threads)
+    for (omp_size_t j = 0; j < (omp_size_t) referenceSet.n_cols; ++j)
     {
       if (norms[j] > 0.0)
       {
-        const double offset = arma::dot(refCopy.col(j), line);
-        const double distortion = arma::norm(refCopy.col(j) - offset * line);
-        sums[j] = std::abs(offset) - std::abs(distortion);
+        const double offset = offsets[j];
+        const double distortion = std::sqrt(std::max(squaredNorms[j] -
+            offset * offset, 0.0));
+        sums[j] = std::abs(offset) - distortion;
         closeAngle[j] =
             (std::atan(distortion / std::abs(offset)) < (M_PI / 8.0));
       }
@@ -179,23 +196,35 @@ void DrusillaSelect<MatType>::Search(const MatType& querySet,
     throw std::invalid_argument("DrusillaSelect::Search(): requested k is "
         "greater than number of points in candidate set!  Increase l or m.");
 
-  // We'll use the NeighborSearchRules class to perform our brute-force search.
-  // Note that we aren't using trees for our search, so we can use 'int' as a
-  // TreeType.
-  metric::EuclideanDistance metric;
-  NeighborSearchRules<FurthestNeighborSort, metric::EuclideanDistance,
-      tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic, MatType>>
-      rules(candidateSet, querySet, k, metric, 0, false);
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
 
-  for (size_t q = 0; q < querySet.n_cols; ++q)
+  // Each query point is compared with every candidate, so the query points are
+  // split between the threads.
+  typedef std::pair<double, size_t> Candidate;
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(dynamic, 16)
+  for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
+  {
+    std::vector<Candidate> results(candidateSet.n_cols);
     for (size_t r = 0; r < candidateSet.n_cols; ++r)
-      rules.BaseCase(q, r);
+      results[r] = Candidate(metric::EuclideanDistance::Evaluate(
+          querySet.col(q), candidateSet.col(r)), r);
 
-  rules.GetResults(neighbors, distances);
+    // Keep the k furthest candidates (the first one, if two are equally far).
+    std::partial_sort(results.begin(), results.begin() + k, results.end(),
+        [](const Candidate& a, const Candidate& b)
+        {
+          return (a.first > b.first) ||
+              (a.first == b.first && a.second < b.second);
+        });
 
-  // Map the neighbors back to their original indices in the reference set.
-  for (size_t i = 0; i < neighbors.n_elem; ++i)
-    neighbors[i] = candidateIndices[neighbors[i]];
+    // Map the neighbors back to their original indices in the reference set.
+    for (size_t j = 0; j < k; ++j)
+    {
+      neighbors(j, q) = candidateIndices[results[j].second];
+      distances(j, q) = results[j].first;
+    }
+  }
 }
 
 //! Serialize the model.
@@ -210,6 +239,102 @@ void DrusillaSelect<MatType>::Serialize(Archive& ar,
   ar & CreateNVP(candidateIndices, "candidateIndices");
   ar & CreateNVP(l, "l");
   ar & CreateNVP(m, "m");
+
+  // A loaded candidate set has its own memory.
+  if (Archive::is_loading::value)
+    mappedIndex.reset();
+}
+
+//! Save the model as a flat index.
+template<typename MatType>
+void DrusillaSelect<MatType>::SaveIndex(const std::string& filename) const
+{
+  static_assert(!arma::is_SpMat<MatType>::value, "DrusillaSelect::SaveIndex():"
+      " only dense models can be saved as an index");
+  typedef typename MatType::elem_type ElemType;
+
+  if (candidateSet.n_cols == 0)
+    throw std::invalid_argument("DrusillaSelect::SaveIndex(): candidate set "
+        "not initialized!  Call Train() first.");
+
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("DrusillaSelect::SaveIndex(): cannot open file '"
+        + filename + "' for writing");
+
+  IndexHeader header;
+  std::memset(&header, 0, sizeof(IndexHeader));
+  std::memcpy(header.magic, "MLPKDSI", 8);
+  header.version = 1;
+  header.elementSize = sizeof(ElemType);
+  header.l = l;
+  header.m = m;
+  header.rows = candidateSet.n_rows;
+
+  // The candidate set starts on a page boundary.
+  const size_t indicesEnd = sizeof(IndexHeader) +
+      candidateIndices.n_elem * sizeof(uint64_t);
+  header.candidatesOffset = ((indicesEnd + 4095) / 4096) * 4096;
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(IndexHeader));
+  const arma::Col<uint64_t> indices =
+      arma::conv_to<arma::Col<uint64_t>>::from(candidateIndices);
+  stream.write(reinterpret_cast<const char*>(indices.memptr()),
+      indices.n_elem * sizeof(uint64_t));
+  const std::vector<char> padding(header.candidatesOffset - indicesEnd, 0);
+  stream.write(padding.data(), padding.size());
+  stream.write(reinterpret_cast<const char*>(candidateSet.memptr()),
+      candidateSet.n_elem * sizeof(ElemType));
+
+  if (!stream)
+    throw std::runtime_error("DrusillaSelect::SaveIndex(): error writing file '"
+        + filename + "'");
+}
+
+//! Load the model from a flat index.
+template<typename MatType>
+void DrusillaSelect<MatType>::LoadIndex(const std::string& filename)
+{
+  static_assert(!arma::is_SpMat<MatType>::value, "DrusillaSelect::LoadIndex():"
+      " only dense models can be loaded from an index");
+  typedef typename MatType::elem_type ElemType;
+
+  std::shared_ptr<data::MappedFile> file =
+      std::make_shared<data::MappedFile>(filename);
+
+  IndexHeader header;
+  if (file->Size() < sizeof(IndexHeader))
+    throw std::runtime_error("DrusillaSelect::LoadIndex(): '" + filename +
+        "' is not a DrusillaSelect index");
+  std::memcpy(&header, file->Data(), sizeof(IndexHeader));
+
+  if (std::memcmp(header.magic, "MLPKDSI", 8) != 0 || header.version != 1)
+    throw std::runtime_error("DrusillaSelect::LoadIndex(): '" + filename +
+        "' is not a DrusillaSelect index");
+  if (header.elementSize != sizeof(ElemType) || header.l == 0 ||
+      header.m == 0 || sizeof(IndexHeader) + header.l * header.m *
+      sizeof(uint64_t) > header.candidatesOffset ||
+      header.candidatesOffset > file->Size() ||
+      header.rows * header.l * header.m * sizeof(ElemType) >
+      file->Size() - header.candidatesOffset)
+    throw std::runtime_error("DrusillaSelect::LoadIndex(): '" + filename +
+        "' is malformed");
+
+  l = header.l;
+  m = header.m;
+
+  const arma::Col<uint64_t> indices(reinterpret_cast<const uint64_t*>(
+      file->Data() + sizeof(IndexHeader)), l * m);
+  candidateIndices = arma::conv_to<arma::Col<size_t>>::from(indices);
+
+  // Use the candidate set in place; the matrix is not strict, so that it gets
+  // its own memory if it is resized later.
+  candidateSet = MatType(const_cast<ElemType*>(reinterpret_cast<const
+      ElemType*>(file->Data() + header.candidatesOffset)), header.rows, l * m,
+      false, false);
+
+  // The candidate set lives in the mapped file, so keep it open.
+  mappedIndex = file;
 }
 
 } // namespace neighbor
@@ -26,6 +26,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
 
 namespace mlpack {
 namespace neighbor {
@@ -58,7 +59,9 @@ class QDAFN
   /**
    * Train the QDAFN model on the given reference set, optionally setting new
    * parameters for the number of projections/tables (l) and the number of
-   * elements stored for each projection/table (m).
+   * elements stored for each projection/table (m).  The reference points are
+   * projected onto all of the lines with one matrix product, and the tables
+   * are filled in parallel.
    *
    * @param referenceSet Reference set to train on.
    * @param l Number of projections.
@@ -72,7 +75,9 @@ class QDAFN
    * Search for the k furthest neighbors of the given query set.  (The query set
    * can contain just one point, that is okay.)  The results will be stored in
    * the given neighbors and distances matrices, in the same format as the
-   * mlpack NeighborSearch and LSHSearch classes.
+   * mlpack NeighborSearch and LSHSearch classes.  The query points are
+   * projected onto all of the lines with one matrix product, and are then
+   * split between the OpenMP threads.
    */
   void Search(const MatType& querySet,
               const size_t k,
@@ -81,7 +86,28 @@ class QDAFN
 
   //! Serialize the model.
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
+
+  /**
+   * Save the trained model to the given file as a flat index, which
+   * LoadIndex() can use in place from a memory-mapped file.  Only dense
+   * matrix types can be saved this way.
+   *
+   * @param filename File to save to.
+   */
+  void SaveIndex(const std::string& filename) const;
+
+  /**
+   * Load a model from an index saved with SaveIndex().  The file is mapped into
+   * memory and the candidate sets are used in place, so loading is fast.  The
+   * file must not be modified while the model is in use, and the candidate sets
+   * must not be modified until the model is trained again.  A
+   * std::runtime_error is thrown if the file is not a valid index for this type
+   * of model.
+   *
+   * @param filename File to load from.
+   */
+  void LoadIndex(const std::string& filename);
 
   //! Get the number of projections.
   size_t NumProjections() const { return candidateSet.size(); }
@@ -98,8 +124,6 @@ class QDAFN
   size_t m;
   //! The random lines we are projecting onto.  Has l columns.
   arma::mat lines;
-  //! Projections of each point onto each random line.
-  arma::mat projections;
 
   //! Indices of the points for each S.
   arma::Mat<size_t> sIndices;
@@ -108,11 +132,38 @@ class QDAFN
 
   // Candidate sets; one element in the vector for each table.
   std::vector<MatType> candidateSet;
+
+  //! If the model was loaded with LoadIndex(), the mapped index file, which
+  //! holds the candidate sets; otherwise NULL.
+  std::shared_ptr<data::MappedFile> mappedIndex;
+
+  //! The header of an index file written by SaveIndex().
+  struct IndexHeader
+  {
+    //! Identifies the format.
+    char magic[8];
+    //! Version of the format.
+    uint64_t version;
+    //! Size in bytes of each element of the candidate sets.
+    uint64_t elementSize;
+    uint64_t l;
+    uint64_t m;
+    //! Dimensionality of the candidate sets.
+    uint64_t rows;
+    //! Offset of the candidate sets, which is a multiple of 4096; the lines,
+    //! the values and the indices of the candidates follow the header.
+    uint64_t candidatesOffset;
+  };
 };
 
 } // namespace neighbor
 } // namespace mlpack
 
+//! Set the serialization version of the QDAFN class.  Version 1 no longer
+//! stores the projections of the reference set.
+BOOST_TEMPLATE_CLASS_VERSION(template<typename MatType>,
+    mlpack::neighbor::QDAFN<MatType>, 1);
+
 // Include implementation.
 #include "qdafn_impl.hpp"
 
@@ -16,6 +16,8 @@
 #include "qdafn.hpp"
 
 #include <queue>
+#include <fstream>
+#include <cstring>
 #include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
 
 namespace mlpack {
@@ -58,6 +60,15 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
   if (mIn != 0)
     m = mIn;
 
+  if (m > referenceSet.n_cols)
+    throw std::invalid_argument("QDAFN::Train(): m must not be greater than "
+        "the number of points in the reference set!");
+
+  // The candidate sets of a model loaded from an index live in the mapped
+  // file, so they must not be reused.
+  candidateSet.clear();
+  mappedIndex.reset();
+
   // Build tables.  This is done by drawing random points from a Gaussian
   // distribution as the vectors we project onto.  The Gaussian should have zero
   // mean and unit variance.
@@ -67,23 +78,35 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
     lines.col(i) = gd.Random();
 
   // Now, project each of the reference points onto each line, and collect the
-  // top m elements.
-  projections = referenceSet.t() * lines;
+  // top m elements.  The projections are only needed here.
+  const arma::mat projections = referenceSet.t() * lines;
 
-  // Loop over each projection and find the top m elements.
+  // Loop over each projection and find the top m elements.  Only the top m
+  // need to be sorted, and ties are broken by index, so that the tables do not
+  // depend on the sort.
   sIndices.set_size(m, l);
   sValues.set_size(m, l);
   candidateSet.resize(l);
-  for (size_t i = 0; i < l; ++i)
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(dynamic, 1)
+  for (omp_size_t t = 0; t < (omp_size_t) l; ++t)
   {
-    candidateSet[i].set_size(referenceSet.n_rows, m);
-    arma::uvec sortedIndices = arma::sort_index(projections.col(i), "descend");
+    const size_t i = (size_t) t;
+    const double* values = projections.colptr(i);
+    std::vector<size_t> sortedIndices(referenceSet.n_cols);
+    for (size_t j = 0; j < sortedIndices.size(); ++j)
+      sortedIndices[j] = j;
+    std::partial_sort(sortedIndices.begin(), sortedIndices.begin() + m,
+        sortedIndices.end(), [values](const size_t a, const size_t b)
+        {
+          return (values[a] > values[b]) || (values[a] == values[b] && a < b);
+        });
 
     // Grab the top m elements.
+    candidateSet[i].set_size(referenceSet.n_rows, m);
     for (size_t j = 0; j < m; ++j)
     {
       sIndices(j, i) = sortedIndices[j];
-      sValues(j, i) = projections(sortedIndices[j], i);
+      sValues(j, i) = values[sortedIndices[j]];
       candidateSet[i].col(j) = referenceSet.col(sortedIndices[j]);
     }
   }
@@ -104,17 +127,22 @@ void QDAFN<MatType>::Search(const MatType& querySet,
   neighbors.fill(size_t() - 1);
   distances.zeros(k, querySet.n_cols);
 
+  // Project all of the query points onto all of the lines at once.
+  const arma::mat queryProjections = lines.t() * querySet;
+
   // Search for each point.
-  for (size_t q = 0; q < querySet.n_cols; ++q)
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(dynamic, 16)
+  for (omp_size_t qIndex = 0; qIndex < (omp_size_t) querySet.n_cols; ++qIndex)
   {
+    const size_t q = (size_t) qIndex;
+
     // Initialize a priority queue.
     // The size_t represents the index of the table, and the double represents
     // the value of l_i * S_i - l_i * query (see line 6 of Algorithm 1).
     std::priority_queue<std::pair<double, size_t>> queue;
     for (size_t i = 0; i < l; ++i)
     {
-      const double val = sValues(0, i) - arma::dot(querySet.col(q),
-          lines.col(i));
+      const double val = sValues(0, i) - queryProjections(i, q);
       queue.push(std::make_pair(val, i));
     }
 
@@ -129,7 +157,7 @@ void QDAFN<MatType>::Search(const MatType& querySet,
         resultsQueue(std::less<std::pair<double, size_t>>(), std::move(v));
     for (size_t i = 0; i < m; ++i)
     {
-      std::pair<size_t, double> p = queue.top();
+      const std::pair<double, size_t> p = queue.top();
       queue.pop();
 
       // Get index of reference point to look at.
@@ -171,21 +199,138 @@ void QDAFN<MatType>::Search(const MatType& querySet,
 
 template<typename MatType>
 template<typename Archive>
-void QDAFN<MatType>::Serialize(Archive& ar, const unsigned int /* version */)
+void QDAFN<MatType>::Serialize(Archive& ar, const unsigned int version)
 {
   using data::CreateNVP;
 
   ar & CreateNVP(l, "l");
   ar & CreateNVP(m, "m");
   ar & CreateNVP(lines, "lines");
-  ar & CreateNVP(projections, "projections");
+
+  // Older versions stored the projections of the reference set, which are not
+  // needed for search.
+  if (version == 0 && Archive::is_loading::value)
+  {
+    arma::mat projections;
+    ar & CreateNVP(projections, "projections");
+  }
+
   ar & CreateNVP(sIndices, "sIndices");
   ar & CreateNVP(sValues, "sValues");
   if (Archive::is_loading::value)
+  {
     candidateSet.clear();
+    mappedIndex.reset();
+  }
   ar & CreateNVP(candidateSet, "candidateSet");
 }
 
+//! Save the model as a flat index.
+template<typename MatType>
+void QDAFN<MatType>::SaveIndex(const std::string& filename) const
+{
+  static_assert(!arma::is_SpMat<MatType>::value, "QDAFN::SaveIndex(): only "
+      "dense models can be saved as an index");
+  typedef typename MatType::elem_type ElemType;
+
+  if (candidateSet.size() != l)
+    throw std::invalid_argument("QDAFN::SaveIndex(): the model is not "
+        "trained!  Call Train() first.");
+
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("QDAFN::SaveIndex(): cannot open file '" +
+        filename + "' for writing");
+
+  IndexHeader header;
+  std::memset(&header, 0, sizeof(IndexHeader));
+  std::memcpy(header.magic, "MLPKQDI", 8);
+  header.version = 1;
+  header.elementSize = sizeof(ElemType);
+  header.l = l;
+  header.m = m;
+  header.rows = lines.n_rows;
+
+  // The candidate sets start on a page boundary.
+  const size_t tablesEnd = sizeof(IndexHeader) + lines.n_elem *
+      sizeof(double) + sValues.n_elem * sizeof(double) + sIndices.n_elem *
+      sizeof(uint64_t);
+  header.candidatesOffset = ((tablesEnd + 4095) / 4096) * 4096;
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(IndexHeader));
+  stream.write(reinterpret_cast<const char*>(lines.memptr()),
+      lines.n_elem * sizeof(double));
+  stream.write(reinterpret_cast<const char*>(sValues.memptr()),
+      sValues.n_elem * sizeof(double));
+  const arma::Mat<uint64_t> indices =
+      arma::conv_to<arma::Mat<uint64_t>>::from(sIndices);
+  stream.write(reinterpret_cast<const char*>(indices.memptr()),
+      indices.n_elem * sizeof(uint64_t));
+  const std::vector<char> padding(header.candidatesOffset - tablesEnd, 0);
+  stream.write(padding.data(), padding.size());
+  for (size_t i = 0; i < l; ++i)
+    stream.write(reinterpret_cast<const char*>(candidateSet[i].memptr()),
+        candidateSet[i].n_elem * sizeof(ElemType));
+
+  if (!stream)
+    throw std::runtime_error("QDAFN::SaveIndex(): error writing file '" +
+        filename + "'");
+}
+
+//! Load the model from a flat index.
+template<typename MatType>
+void QDAFN<MatType>::LoadIndex(const std::string& filename)
+{
+  static_assert(!arma::is_SpMat<MatType>::value, "QDAFN::LoadIndex(): only "
+      "dense models can be loaded from an index");
+  typedef typename MatType::elem_type ElemType;
+
+  std::shared_ptr<data::MappedFile> file =
+      std::make_shared<data::MappedFile>(filename);
+
+  IndexHeader header;
+  if (file->Size() < sizeof(IndexHeader))
+    throw std::runtime_error("QDAFN::LoadIndex(): '" + filename + "' is not a "
+        "QDAFN index");
+  std::memcpy(&header, file->Data(), sizeof(IndexHeader));
+
+  if (std::memcmp(header.magic, "MLPKQDI", 8) != 0 || header.version != 1)
+    throw std::runtime_error("QDAFN::LoadIndex(): '" + filename + "' is not a "
+        "QDAFN index");
+  if (header.elementSize != sizeof(ElemType) || header.l == 0 ||
+      header.m == 0 || sizeof(IndexHeader) + header.l * (header.rows +
+      2 * header.m) * sizeof(double) > header.candidatesOffset ||
+      header.candidatesOffset > file->Size() ||
+      header.rows * header.l * header.m * sizeof(ElemType) >
+      file->Size() - header.candidatesOffset)
+    throw std::runtime_error("QDAFN::LoadIndex(): '" + filename + "' is "
+        "malformed");
+
+  l = header.l;
+  m = header.m;
+
+  const char* tables = file->Data() + sizeof(IndexHeader);
+  lines = arma::mat(reinterpret_cast<const double*>(tables), header.rows, l);
+  tables += lines.n_elem * sizeof(double);
+  sValues = arma::mat(reinterpret_cast<const double*>(tables), m, l);
+  tables += sValues.n_elem * sizeof(double);
+  const arma::Mat<uint64_t> indices(reinterpret_cast<const uint64_t*>(tables),
+      m, l);
+  sIndices = arma::conv_to<arma::Mat<size_t>>::from(indices);
+
+  // Use the candidate sets in place; the matrices are not strict, so that they
+  // get their own memory if they are resized later.
+  candidateSet.clear();
+  const ElemType* candidates = reinterpret_cast<const ElemType*>(
+      file->Data() + header.candidatesOffset);
+  for (size_t i = 0; i < l; ++i)
+    candidateSet.emplace_back(const_cast<ElemType*>(candidates +
+        i * header.rows * m), header.rows, m, false, false);
+
+  // The candidate sets live in the mapped file, so keep it open.
+  mappedIndex = file;
+}
+
 } // namespace neighbor
 } // namespace mlpack
 
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_BLOCK_KRYLOV_SVD_RANDOMIZED_BLOCK_KRYLOV_SVD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/column_blocks.hpp>
 
 namespace mlpack {
 namespace svd {
@@ -104,6 +105,28 @@ class RandomizedBlockKrylovSVD
              arma::mat& v,
              const size_t rank);
 
+  /**
+   * Apply Principal Component Analysis to a data set that is given as blocks
+   * of columns (see data::MatrixColumnBlocks and data::HDF5ColumnBlocks), such
+   * as a memory-mapped matrix or an HDF5 dataset that does not fit in memory.
+   * Each product with the data is a parallel pass over the blocks (the
+   * products with data * data^T take a single pass each), so only a few blocks
+   * are in memory at a time, besides the Krylov subspace and a matrix of
+   * blockSize columns with one row per column of the data.
+   *
+   * @param data Blocks of the data matrix.
+   * @param u First unitary matrix.
+   * @param v Second unitary matrix.
+   * @param s Diagonal matrix of singular values.
+   * @param rank Rank of the approximation.
+   */
+  template<typename BlocksType>
+  void ApplyBlocks(const BlocksType& data,
+                   arma::mat& u,
+                   arma::vec& s,
+                   arma::mat& v,
+                   const size_t rank);
+
   //! Get the number of iterations for the power method.
   size_t MaxIterations() const { return maxIterations; }
   //! Modify the number of iterations for the power method.
@@ -125,4 +148,7 @@ class RandomizedBlockKrylovSVD
 } // namespace svd
 } // namespace mlpack
 
+// Include implementation.
+#include "randomized_block_krylov_svd_impl.hpp"
+
 #endif
@@ -0,0 +1,73 @@
+/**
+ * @file randomized_block_krylov_svd_impl.hpp
+ *
+ * Implementation of the randomized block krylov SVD method on data given as
+ * blocks of columns.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_BLOCK_KRYLOV_SVD_RANDOMIZED_BLOCK_KRYLOV_SVD_IMPL_HPP
+#define MLPACK_METHODS_BLOCK_KRYLOV_SVD_RANDOMIZED_BLOCK_KRYLOV_SVD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "randomized_block_krylov_svd.hpp"
+
+namespace mlpack {
+namespace svd {
+
+template<typename BlocksType>
+void RandomizedBlockKrylovSVD::ApplyBlocks(const BlocksType& data,
+                                           arma::mat& u,
+                                           arma::vec& s,
+                                           arma::mat& v,
+                                           const size_t rank)
+{
+  arma::mat Q, R, block, blockIteration, product;
+
+  if (blockSize == 0)
+  {
+    blockSize = rank + 10;
+  }
+
+  // Random block initialization.
+  arma::mat G = arma::randn(data.Cols(), blockSize);
+
+  // Construct and orthonormalize Krylov subspace.
+  arma::mat K(data.Rows(), blockSize * (maxIterations + 1));
+
+  // As in Apply(), the blocks of the subspace are stored in place in K.
+  block = arma::mat(K.memptr(), data.Rows(), blockSize, false, false);
+  data::ColumnBlockMultiply(data, G, product);
+  arma::qr_econ(block, R, product);
+
+  for (size_t blockOffset = block.n_elem; blockOffset < K.n_elem;
+      blockOffset += block.n_elem)
+  {
+    blockIteration = arma::mat(K.memptr() + blockOffset, block.n_rows,
+        block.n_cols, false, false);
+
+    // data * (data^T * block) in a single pass over the data.
+    data::ColumnBlockGramMultiply(data, block, product);
+    arma::qr_econ(blockIteration, R, product);
+
+    block = arma::mat(K.memptr() + blockOffset, block.n_rows, block.n_cols,
+        false, false);
+  }
+
+  arma::qr_econ(Q, R, K);
+
+  // Approximate eigenvalues and eigenvectors using Rayleigh–Ritz method, with
+  // Q^T * data = (data^T * Q)^T.
+  data::ColumnBlockTransMultiply(data, Q, product);
+  arma::svd_econ(u, s, v, arma::mat(product.t()));
+
+  u = Q * u;
+}
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
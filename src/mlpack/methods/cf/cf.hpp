@@ -18,12 +18,18 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include "cf_neighbor_search.hpp"
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
 #include <set>
 #include <map>
 #include <iostream>
+#include <queue>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace cf /** Collaborative filtering. */ {
@@ -73,19 +79,37 @@ struct FactorizerTraits
  * are in a matrix that holds doubles, should hold integer (or size_t) values.
  * The user and item indices are assumed to start at 0.
  *
- * @tparam FactorizerType The type of matrix factorization to use to decompose
- *     the rating matrix (a W and H matrix).  This must implement the method
- *     Apply(arma::sp_mat& data, size_t rank, arma::mat& W, arma::mat& H).
+ * The factors W and H are stored as matrices of type MatType, which may be
+ * arma::fmat to halve the memory of a model and speed up the estimation of
+ * ratings (see FloatCF).  The factorizers work in double precision, so the
+ * factors are converted to MatType after the factorization.  The neighbor
+ * search of the users is always done in double precision.
+ *
+ * The type of matrix factorization to use to decompose the rating matrix (a W
+ * and H matrix) is given to the constructor or to Train(); it must implement
+ * the method Apply(arma::sp_mat& data, size_t rank, arma::mat& W,
+ * arma::mat& H).
+ *
+ * @tparam MatType The type of the factor matrices: arma::mat or arma::fmat.
  */
-class CF
+template<typename MatType = arma::mat>
+class CFType
 {
  public:
   /**
    * Initialize the CF object without performing any factorization.  Be sure to
    * call Train() before calling GetRecommendations() or any other functions!
+   * The type of neighbor search that finds the most similar users can be given
+   * here, so that only that index is built by Train().
+   *
+   * @param numUsersForSimilarity Size of the neighborhood.
+   * @param rank Rank parameter for matrix factorization.
+   * @param searchType Type of neighbor search for the neighborhoods.
    */
-  CF(const size_t numUsersForSimilarity = 5,
-     const size_t rank = 0);
+  CFType(const size_t numUsersForSimilarity = 5,
+         const size_t rank = 0,
+         const CFNeighborSearch::SearchTypes searchType =
+             CFNeighborSearch::KD_TREE_SEARCH);
 
   /**
    * Initialize the CF object using an instantiated factorizer, immediately
@@ -104,10 +128,10 @@ class CF
    * @param rank Rank parameter for matrix factorization.
    */
   template<typename FactorizerType = amf::NMFALSFactorizer>
-  CF(const arma::mat& data,
-     FactorizerType factorizer = FactorizerType(),
-     const size_t numUsersForSimilarity = 5,
-     const size_t rank = 0);
+  CFType(const arma::mat& data,
+         FactorizerType factorizer = FactorizerType(),
+         const size_t numUsersForSimilarity = 5,
+         const size_t rank = 0);
 
   /**
    * Initialize the CF object using an instantiated factorizer, immediately
@@ -128,12 +152,27 @@ class CF
    * @param rank Rank parameter for matrix factorization.
    */
   template<typename FactorizerType = amf::NMFALSFactorizer>
-  CF(const arma::sp_mat& data,
-     FactorizerType factorizer = FactorizerType(),
-     const size_t numUsersForSimilarity = 5,
-     const size_t rank = 0,
-     const typename std::enable_if_t<
-         !FactorizerTraits<FactorizerType>::UsesCoordinateList>* = 0);
+  CFType(const arma::sp_mat& data,
+         FactorizerType factorizer = FactorizerType(),
+         const size_t numUsersForSimilarity = 5,
+         const size_t rank = 0,
+         const typename std::enable_if_t<
+             !FactorizerTraits<FactorizerType>::UsesCoordinateList>* = 0);
+
+  /**
+   * Copy the given CF model.  The neighbor search index is rebuilt for the
+   * copy.
+   */
+  CFType(const CFType& other);
+
+  //! Take ownership of the given CF model.
+  CFType(CFType&& other) = default;
+
+  //! Copy the given CF model, rebuilding the neighbor search index.
+  CFType& operator=(const CFType& other);
+
+  //! Take ownership of the given CF model.
+  CFType& operator=(CFType&& other) = default;
 
   /**
    * Train the CF model (i.e. factorize the input matrix) using the parameters
@@ -161,6 +200,48 @@ class CF
              const typename std::enable_if_t<
                  !FactorizerTraits<FactorizerType>::UsesCoordinateList>* = 0);
 
+  /**
+   * Add new users to the trained model without refactorizing the rating
+   * matrix (fold-in).  The factors of each new user (its column of H) are the
+   * regularized least squares solution over its ratings with W held fixed,
+   *
+   * \f[
+   * h = (W_I^T W_I + \lambda I)^{-1} W_I^T v_I,
+   * \f]
+   *
+   * where I are the items the user rated.  To match the factorization, lambda
+   * should be the regularization of H used by the update rule (0 for
+   * NMFALSUpdate); for the weighted regularization of SparseALSUpdate, it is
+   * scaled by the number of ratings of the user.
+   *
+   * The new users are searched by brute force until there are enough of them
+   * to rebuild the neighbor search index, so adding a few users takes about
+   * as long as solving their least squares problems.  A std::invalid_argument
+   * is thrown if the model is not trained or if the number of rows of ratings
+   * is not the number of items.
+   *
+   * @param ratings Ratings of the new users, one column per user, with a row
+   *     for each item.
+   * @param lambda Regularization parameter of the least squares problems.
+   * @return The index of the first new user.
+   */
+  size_t AddUsers(const arma::sp_mat& ratings, const double lambda = 0.0);
+
+  /**
+   * Add new items to the trained model without refactorizing the rating
+   * matrix (fold-in).  The factors of each new item (its row of W) are the
+   * regularized least squares solution over its ratings with H held fixed,
+   * as for AddUsers().  Since W changes, the neighbor search index of the
+   * users is rebuilt.  A std::invalid_argument is thrown if the model is not
+   * trained or if the number of columns of ratings is not the number of users.
+   *
+   * @param ratings Ratings of the new items, one row per item, with a column
+   *     for each user.
+   * @param lambda Regularization parameter of the least squares problems.
+   * @return The index of the first new item.
+   */
+  size_t AddItems(const arma::sp_mat& ratings, const double lambda = 0.0);
+
   //! Sets number of users for calculating similarity.
   void NumUsersForSimilarity(const size_t num)
   {
@@ -191,10 +272,24 @@ class CF
     return rank;
   }
 
+  /**
+   * Set the type of neighbor search that finds the most similar users.  An
+   * approximate search (see CFNeighborSearch) trades a little accuracy of the
+   * neighborhoods for much faster recommendations on large models.  If the
+   * model is trained, the index is rebuilt.
+   */
+  void NeighborSearchType(const CFNeighborSearch::SearchTypes searchType);
+
+  //! Get the type of neighbor search that finds the most similar users.
+  CFNeighborSearch::SearchTypes NeighborSearchType() const
+  {
+    return userIndex.SearchType();
+  }
+
   //! Get the User Matrix.
-  const arma::mat& W() const { return w; }
+  const MatType& W() const { return w; }
   //! Get the Item Matrix.
-  const arma::mat& H() const { return h; }
+  const MatType& H() const { return h; }
   //! Get the cleaned data matrix.
   const arma::sp_mat& CleanedData() const { return cleanedData; }
 
@@ -203,26 +298,35 @@ class CF
    *
    * @param numRecs Number of Recommendations
    * @param recommendations Matrix to save recommendations into.
+   * @param numThreads Number of threads to use (0 uses the OpenMP default).
    */
   void GetRecommendations(const size_t numRecs,
-                          arma::Mat<size_t>& recommendations);
+                          arma::Mat<size_t>& recommendations,
+                          const size_t numThreads = 0);
 
   /**
    * Generates the given number of recommendations for the specified users.
+   * The ratings of the items are estimated block by block, from the average
+   * factors of the neighborhood of each user, so the ratings for all items are
+   * never stored; the users are divided between threads.
    *
    * @param numRecs Number of Recommendations
    * @param recommendations Matrix to save recommendations
    * @param users Users for which recommendations are to be generated
+   * @param numThreads Number of threads to use (0 uses the OpenMP default).
    */
   void GetRecommendations(const size_t numRecs,
                           arma::Mat<size_t>& recommendations,
-                          const arma::Col<size_t>& users);
+                          const arma::Col<size_t>& users,
+                          const size_t numThreads = 0);
 
   //! Converts the User, Item, Value Matrix to User-Item Table
   static void CleanData(const arma::mat& data, arma::sp_mat& cleanedData);
 
   /**
-   * Predict the rating of an item by a particular user.
+   * Predict the rating of an item by a particular user.  The predictions use
+   * the cached neighbor search index of the model, so Predict() must not be
+   * called on the same model from several threads at once.
    *
    * @param user User to predict for.
    * @param item Item to predict for.
@@ -238,17 +342,40 @@ class CF
    * have length equal to combinations.n_cols, and predictions[i] will be equal
    * to the prediction for the user/item combination in combinations.col(i).
    *
+   * The combinations are grouped by user, so that the neighborhood of each
+   * user is found once and its factors averaged once; then the ratings of the
+   * items of each user are computed in blocks, as products of the gathered
+   * item factors with the averaged factors, and the users are divided between
+   * threads.
+   *
    * @param combinations User/item combinations to predict.
    * @param predictions Predicted ratings for each user/item combination.
+   * @param numThreads Number of threads to use (0 uses the OpenMP default).
    */
   void Predict(const arma::Mat<size_t>& combinations,
-               arma::vec& predictions) const;
+               arma::vec& predictions,
+               const size_t numThreads = 0) const;
+
+  /**
+   * Predict ratings for each user-item combination in the given coordinate list
+   * matrix, like the overload above, but write the predictions to the given
+   * memory, which must hold combinations.n_cols doubles.  This may be a
+   * preallocated buffer or a memory-mapped output file, so that the
+   * predictions of very many combinations do not have to be copied.
+   *
+   * @param combinations User/item combinations to predict.
+   * @param predictions Memory for the predicted rating of each combination.
+   * @param numThreads Number of threads to use (0 uses the OpenMP default).
+   */
+  void Predict(const arma::Mat<size_t>& combinations,
+               double* predictions,
+               const size_t numThreads = 0) const;
 
   /**
    * Serialize the CF model to the given archive.
    */
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
  private:
   //! Number of users for similarity.
@@ -256,11 +383,73 @@ class CF
   //! Rank used for matrix factorization.
   size_t rank;
   //! User matrix.
-  arma::mat w;
+  MatType w;
   //! Item matrix.
-  arma::mat h;
+  MatType h;
   //! Cleaned data matrix.
   arma::sp_mat cleanedData;
+  //! H stretched by the Cholesky factor of W^T W; users are neighbors in it.
+  MatType stretchedH;
+  //! Nearest neighbor search index over the columns of stretchedH.
+  mutable CFNeighborSearch userIndex;
+  //! The Cholesky factor (L^T) of W^T W, which stretches H.
+  arma::mat stretching;
+  //! The number of users in userIndex; later users are searched by brute
+  //! force.
+  size_t indexedUsers;
+
+  /**
+   * Compute stretchedH from the factorization and build the nearest neighbor
+   * search index of the users.  This is done once whenever the model changes
+   * (after Train() or after loading), so that recommendations and predictions
+   * only need to search for the neighbors of the queried users.
+   */
+  void BuildSimilarityIndex();
+
+  /**
+   * Find the numUsersForSimilarity nearest neighbors of each of the given
+   * users with the cached index, and among the users added since it was
+   * built.
+   *
+   * @param users Users to find the neighbors of.
+   * @param neighborhood Set to the neighbors of each user, one column each.
+   */
+  void SimilarUsers(const arma::Col<size_t>& users,
+                    arma::Mat<size_t>& neighborhood) const;
+
+  /**
+   * Compute the average of the factors (columns of H) of the neighborhood of
+   * each of the given users.  The average of the estimated ratings of the
+   * neighbors, W H.col(j), is W times this average.
+   *
+   * @param users Users to average the neighborhoods of.
+   * @param factors Set to the averaged factors of each user, one column each.
+   */
+  void NeighborhoodFactors(const arma::Col<size_t>& users,
+                           MatType& factors) const;
+
+  /**
+   * Solve the least squares problem of fold-in: find the factors x that
+   * minimize the squared error of x^T f_i to each rating in the given column
+   * of ratings, where f_i is the column of fixed of the rated user or item,
+   * plus lambda ||x||^2.
+   */
+  static arma::vec FoldIn(const arma::mat& fixed,
+                          const arma::sp_mat& ratings,
+                          const size_t col,
+                          const double lambda);
+
+  //! Append the columns of extra to the columns of data.
+  static arma::sp_mat AppendColumns(const arma::sp_mat& data,
+                                    const arma::sp_mat& extra);
+
+  //! Get the given factors in double precision, without a copy if they are.
+  static const arma::mat& AsDouble(const arma::mat& m) { return m; }
+  //! Get the given factors in double precision.
+  static arma::mat AsDouble(const arma::fmat& m)
+  {
+    return arma::conv_to<arma::mat>::from(m);
+  }
 
   //! Candidate represents a possible recommendation (value, item).
   typedef std::pair<double, size_t> Candidate;
@@ -272,11 +461,21 @@ class CF
       return c1.first > c2.first;
     };
   };
-}; // class CF
+}; // class CFType
+
+//! Collaborative filtering with double precision factors.
+typedef CFType<arma::mat> CF;
+//! Collaborative filtering with single precision factors.
+typedef CFType<arma::fmat> FloatCF;
 
 } // namespace cf
 } // namespace mlpack
 
+//! Set the serialization version of the CFType class.  Version 1 also stores
+//! the type of neighbor search.
+BOOST_TEMPLATE_CLASS_VERSION(template<typename MatType>,
+    mlpack::cf::CFType<MatType>, 1);
+
 // Include implementation of templated functions.
 #include "cf_impl.hpp"
 
@@ -22,42 +22,69 @@
 namespace mlpack {
 namespace cf {
 
+// Apply the factorizer; the factorizers work in double precision, so the
+// factors are converted afterwards.
+template<typename FactorizerType, typename DataType, typename MatType>
+void Factorize(FactorizerType& factorizer,
+               const DataType& data,
+               const size_t rank,
+               MatType& w,
+               MatType& h)
+{
+  arma::mat wd, hd;
+  factorizer.Apply(data, rank, wd, hd);
+  w = arma::conv_to<MatType>::from(wd);
+  h = arma::conv_to<MatType>::from(hd);
+}
+
+// Apply the factorizer when the factors are in double precision.
+template<typename FactorizerType, typename DataType>
+void Factorize(FactorizerType& factorizer,
+               const DataType& data,
+               const size_t rank,
+               arma::mat& w,
+               arma::mat& h)
+{
+  factorizer.Apply(data, rank, w, h);
+}
+
 // Apply the factorizer when a coordinate list is used.
-template<typename FactorizerType>
+template<typename FactorizerType, typename MatType>
 void ApplyFactorizer(FactorizerType& factorizer,
                      const arma::mat& data,
                      const arma::sp_mat& /* cleanedData */,
                      const size_t rank,
-                     arma::mat& w,
-                     arma::mat& h,
+                     MatType& w,
+                     MatType& h,
                      const typename std::enable_if_t<FactorizerTraits<
                          FactorizerType>::UsesCoordinateList>* = 0)
 {
-  factorizer.Apply(data, rank, w, h);
+  Factorize(factorizer, data, rank, w, h);
 }
 
 // Apply the factorizer when coordinate lists are not used.
-template<typename FactorizerType>
+template<typename FactorizerType, typename MatType>
 void ApplyFactorizer(FactorizerType& factorizer,
                      const arma::mat& /* data */,
                      const arma::sp_mat& cleanedData,
                      const size_t rank,
-                     arma::mat& w,
-                     arma::mat& h,
+                     MatType& w,
+                     MatType& h,
                      const typename std::enable_if_t<!FactorizerTraits<
                          FactorizerType>::UsesCoordinateList>* = 0)
 {
-  factorizer.Apply(cleanedData, rank, w, h);
+  Factorize(factorizer, cleanedData, rank, w, h);
 }
 
 /**
  * Construct the CF object using an instantiated factorizer.
  */
+template<typename MatType>
 template<typename FactorizerType>
-CF::CF(const arma::mat& data,
-       FactorizerType factorizer,
-       const size_t numUsersForSimilarity,
-       const size_t rank) :
+CFType<MatType>::CFType(const arma::mat& data,
+                        FactorizerType factorizer,
+                        const size_t numUsersForSimilarity,
+                        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
     rank(rank)
 {
@@ -76,13 +103,15 @@ CF::CF(const arma::mat& data,
 /**
  * Construct the CF object using an instantiated factorizer.
  */
+template<typename MatType>
 template<typename FactorizerType>
-CF::CF(const arma::sp_mat& data,
-       FactorizerType factorizer,
-       const size_t numUsersForSimilarity,
-       const size_t rank,
-       const typename std::enable_if_t<
-           !FactorizerTraits<FactorizerType>::UsesCoordinateList>*) :
+CFType<MatType>::CFType(const arma::sp_mat& data,
+                        FactorizerType factorizer,
+                        const size_t numUsersForSimilarity,
+                        const size_t rank,
+                        const typename std::enable_if_t<
+                            !FactorizerTraits<
+                            FactorizerType>::UsesCoordinateList>*) :
     numUsersForSimilarity(numUsersForSimilarity),
     rank(rank)
 {
@@ -98,8 +127,9 @@ CF::CF(const arma::sp_mat& data,
   Train(data, factorizer);
 }
 
+template<typename MatType>
 template<typename FactorizerType>
-void CF::Train(const arma::mat& data, FactorizerType factorizer)
+void CFType<MatType>::Train(const arma::mat& data, FactorizerType factorizer)
 {
   CleanData(data, cleanedData);
 
@@ -123,13 +153,15 @@ void CF::Train(const arma::mat& data, FactorizerType factorizer)
   Timer::Start("cf_factorization");
   ApplyFactorizer(factorizer, data, cleanedData, this->rank, w, h);
   Timer::Stop("cf_factorization");
+  BuildSimilarityIndex();
 }
 
+template<typename MatType>
 template<typename FactorizerType>
-void CF::Train(const arma::sp_mat& data,
-               FactorizerType factorizer,
-               const typename std::enable_if_t<!FactorizerTraits<
-                   FactorizerType>::UsesCoordinateList>*)
+void CFType<MatType>::Train(const arma::sp_mat& data,
+                            FactorizerType factorizer,
+                            const typename std::enable_if_t<!FactorizerTraits<
+                                FactorizerType>::UsesCoordinateList>*)
 {
   cleanedData = data;
 
@@ -149,13 +181,15 @@ void CF::Train(const arma::sp_mat& data,
   }
 
   Timer::Start("cf_factorization");
-  factorizer.Apply(cleanedData, this->rank, w, h);
+  Factorize(factorizer, cleanedData, this->rank, w, h);
   Timer::Stop("cf_factorization");
+  BuildSimilarityIndex();
 }
 
 //! Serialize the model.
+template<typename MatType>
 template<typename Archive>
-void CF::Serialize(Archive& ar, const unsigned int /* version */)
+void CFType<MatType>::Serialize(Archive& ar, const unsigned int version)
 {
   // This model is simple; just serialize all the members.  No special handling
   // required.
@@ -166,6 +200,528 @@ void CF::Serialize(Archive& ar, const unsigned int /* version */)
   ar & CreateNVP(w, "w");
   ar & CreateNVP(h, "h");
   ar & CreateNVP(cleanedData, "cleanedData");
+
+  // Older versions always used kd-tree search.
+  size_t searchType = (size_t) userIndex.SearchType();
+  if (version >= 1)
+    ar & CreateNVP(searchType, "searchType");
+  else
+    searchType = (size_t) CFNeighborSearch::KD_TREE_SEARCH;
+  if (Archive::is_loading::value)
+    userIndex.SearchType() = (CFNeighborSearch::SearchTypes) searchType;
+
+  // The neighbor search index is not stored, since it is rebuilt quickly.
+  if (Archive::is_loading::value)
+    BuildSimilarityIndex();
+}
+
+// Default CF constructor.
+template<typename MatType>
+CFType<MatType>::CFType(const size_t numUsersForSimilarity,
+                        const size_t rank,
+                        const CFNeighborSearch::SearchTypes searchType) :
+    numUsersForSimilarity(numUsersForSimilarity),
+    rank(rank),
+    userIndex(searchType),
+    indexedUsers(0)
+{
+  // Validate neighbourhood size.
+  if (numUsersForSimilarity < 1)
+  {
+    Log::Warn << "CF::CF(): neighbourhood size should be > 0 ("
+        << numUsersForSimilarity << " given). Setting value to 5.\n";
+    // Set default value of 5.
+    this->numUsersForSimilarity = 5;
+  }
+}
+
+// Copy the model; the neighbor search index is rebuilt.
+template<typename MatType>
+CFType<MatType>::CFType(const CFType& other) :
+    numUsersForSimilarity(other.numUsersForSimilarity),
+    rank(other.rank),
+    w(other.w),
+    h(other.h),
+    cleanedData(other.cleanedData),
+    userIndex(other.userIndex.SearchType())
+{
+  BuildSimilarityIndex();
+}
+
+template<typename MatType>
+CFType<MatType>& CFType<MatType>::operator=(const CFType& other)
+{
+  if (this != &other)
+  {
+    numUsersForSimilarity = other.numUsersForSimilarity;
+    rank = other.rank;
+    w = other.w;
+    h = other.h;
+    cleanedData = other.cleanedData;
+    userIndex.SearchType() = other.userIndex.SearchType();
+    BuildSimilarityIndex();
+  }
+
+  return *this;
+}
+
+template<typename MatType>
+void CFType<MatType>::NeighborSearchType(
+    const CFNeighborSearch::SearchTypes searchType)
+{
+  if (searchType == userIndex.SearchType())
+    return;
+
+  userIndex.SearchType() = searchType;
+  BuildSimilarityIndex();
+}
+
+template<typename MatType>
+void CFType<MatType>::GetRecommendations(const size_t numRecs,
+                                         arma::Mat<size_t>& recommendations,
+                                         const size_t numThreads)
+{
+  // Generate list of users.  Maybe it would be more efficient to pass an empty
+  // users list, and then have the other overload of GetRecommendations() assume
+  // that if users is empty, then recommendations should be generated for all
+  // users?
+  arma::Col<size_t> users = arma::linspace<arma::Col<size_t> >(0,
+      cleanedData.n_cols - 1, cleanedData.n_cols);
+
+  // Call the main overload for recommendations.
+  GetRecommendations(numRecs, recommendations, users, numThreads);
+}
+
+template<typename MatType>
+void CFType<MatType>::GetRecommendations(const size_t numRecs,
+                                         arma::Mat<size_t>& recommendations,
+                                         const arma::Col<size_t>& users,
+                                         const size_t numThreads)
+{
+  // Only the average factors of the neighborhood of each user are needed,
+  // instead of a rating for every item and every neighbor.
+  MatType factors;
+  NeighborhoodFactors(users, factors);
+
+  const size_t threads = ParallelThreads(numThreads);
+
+  // The users are split into blocks, and the ratings of each block are
+  // computed for one block of items at a time, so that the ratings of a user
+  // for all items are never stored.  Each user keeps the best numRecs items
+  // in a heap.  The items the user already rated are skipped by walking the
+  // (sorted) row indices of the user's column of cleanedData alongside.
+  const size_t userBlockSize = 64;
+  const size_t itemBlockSize = 4096;
+  const size_t userBlocks = (users.n_elem + userBlockSize - 1) / userBlockSize;
+
+  // Default candidate: the smallest possible value and invalid item number.
+  const Candidate def = std::make_pair(-DBL_MAX, cleanedData.n_rows);
+  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
+      CandidateList;
+  std::vector<CandidateList> pqueues(users.n_elem, CandidateList(
+      CandidateCmp(), std::vector<Candidate>(numRecs, def)));
+
+  #pragma omp parallel for num_threads(threads) schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) userBlocks; ++b)
+  {
+    const size_t firstUser = b * userBlockSize;
+    const size_t lastUser = std::min(firstUser + userBlockSize,
+        (size_t) users.n_elem) - 1;
+
+    // The position in the rated items of each user of the block.
+    std::vector<size_t> nextRated(lastUser - firstUser + 1);
+    for (size_t i = firstUser; i <= lastUser; ++i)
+      nextRated[i - firstUser] = cleanedData.col_ptrs[users[i]];
+
+    MatType ratings;
+    for (size_t firstItem = 0; firstItem < w.n_rows;
+         firstItem += itemBlockSize)
+    {
+      const size_t lastItem = std::min(firstItem + itemBlockSize,
+          (size_t) w.n_rows) - 1;
+      ratings = w.rows(firstItem, lastItem) * factors.cols(firstUser,
+          lastUser);
+
+      for (size_t i = firstUser; i <= lastUser; ++i)
+      {
+        CandidateList& pqueue = pqueues[i];
+        size_t& next = nextRated[i - firstUser];
+        const size_t endRated = cleanedData.col_ptrs[users[i] + 1];
+        const typename MatType::elem_type* userRatings =
+            ratings.colptr(i - firstUser);
+
+        for (size_t j = firstItem; j <= lastItem; ++j)
+        {
+          // Ensure that the user hasn't already rated the item.
+          while (next < endRated && cleanedData.row_indices[next] < j)
+            ++next;
+          if (next < endRated && cleanedData.row_indices[next] == j)
+            continue; // The user already rated the item.
+
+          // Is the estimated value better than the worst candidate?
+          const double rating = userRatings[j - firstItem];
+          if (rating > pqueue.top().first)
+          {
+            pqueue.pop();
+            pqueue.push(std::make_pair(rating, j));
+          }
+        }
+      }
+    }
+  }
+
+  recommendations.set_size(numRecs, users.n_elem);
+  for (size_t i = 0; i < users.n_elem; i++)
+  {
+    CandidateList& pqueue = pqueues[i];
+    for (size_t p = 1; p <= numRecs; p++)
+    {
+      recommendations(numRecs - p, i) = pqueue.top().second;
+      pqueue.pop();
+    }
+
+    // If we were not able to come up with enough recommendations, issue a
+    // warning.
+    if (recommendations(numRecs - 1, i) == def.second)
+      Log::Warn << "Could not provide " << numRecs << " recommendations "
+          << "for user " << users(i) << " (not enough un-rated items)!"
+          << std::endl;
+  }
+}
+
+// Predict the rating for a single user/item combination.
+template<typename MatType>
+double CFType<MatType>::Predict(const size_t user, const size_t item) const
+{
+  // First, we need to find the nearest neighbors of the given user.
+  // We'll use the same technique as for GetRecommendations().
+  arma::Col<size_t> users(1);
+  users[0] = user;
+  arma::Mat<size_t> neighborhood;
+  SimilarUsers(users, neighborhood);
+
+  double rating = 0; // We'll take the average of neighborhood values.
+
+  for (size_t j = 0; j < neighborhood.n_rows; ++j)
+    rating += arma::as_scalar(w.row(item) * h.col(neighborhood(j, 0)));
+  rating /= neighborhood.n_rows;
+
+  return rating;
+}
+
+// Predict the rating for a group of user/item combinations.
+template<typename MatType>
+void CFType<MatType>::Predict(const arma::Mat<size_t>& combinations,
+                              arma::vec& predictions,
+                              const size_t numThreads) const
+{
+  predictions.set_size(combinations.n_cols);
+  Predict(combinations, predictions.memptr(), numThreads);
+}
+
+// Predict the rating for a group of user/item combinations, into the given
+// memory.
+template<typename MatType>
+void CFType<MatType>::Predict(const arma::Mat<size_t>& combinations,
+                              double* predictions,
+                              const size_t numThreads) const
+{
+  if (combinations.n_cols == 0)
+    return;
+
+  // Group the combinations by user, so that each user's neighborhood is only
+  // found and averaged once.
+  const arma::uvec ordering = arma::sort_index(combinations.row(0).t());
+  const arma::Col<size_t> users = arma::unique(combinations.row(0).t());
+
+  MatType factors;
+  NeighborhoodFactors(users, factors);
+
+  // The first position in the ordering of the combinations of each user.
+  std::vector<size_t> groupStart(users.n_elem + 1);
+  size_t user = 0;
+  for (size_t i = 0; i < ordering.n_elem; ++i)
+    if (i == 0 || combinations(0, ordering[i]) != users[user - 1])
+      groupStart[user++] = i;
+  groupStart[users.n_elem] = ordering.n_elem;
+
+  const size_t threads = ParallelThreads(numThreads);
+
+  // The item factors of a block of combinations are gathered into the
+  // columns of a small matrix, and their ratings are the product of it with
+  // the averaged factors of the user.  Pairs of different users rarely share
+  // items, so the users are not blocked together.
+  const size_t blockSize = 1024;
+
+  #pragma omp parallel for num_threads(threads) schedule(dynamic)
+  for (omp_size_t u = 0; u < (omp_size_t) users.n_elem; ++u)
+  {
+    MatType items;
+    for (size_t first = groupStart[u]; first < groupStart[u + 1];
+         first += blockSize)
+    {
+      const size_t last = std::min(first + blockSize, groupStart[u + 1]);
+      items.set_size(w.n_cols, last - first);
+      for (size_t i = first; i < last; ++i)
+        items.col(i - first) = w.row(combinations(1, ordering[i])).t();
+
+      const MatType ratings = factors.col(u).t() * items;
+      for (size_t i = first; i < last; ++i)
+        predictions[ordering[i]] = ratings[i - first];
+    }
+  }
+}
+
+template<typename MatType>
+void CFType<MatType>::NeighborhoodFactors(const arma::Col<size_t>& users,
+                                          MatType& factors) const
+{
+  // Calculate the neighborhood of the users with the index built after
+  // training.
+  arma::Mat<size_t> neighborhood;
+  SimilarUsers(users, neighborhood);
+
+  factors.zeros(h.n_rows, users.n_elem);
+  for (size_t i = 0; i < users.n_elem; ++i)
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      factors.col(i) += h.col(neighborhood(j, i));
+  factors /= neighborhood.n_rows;
+}
+
+template<typename MatType>
+void CFType<MatType>::BuildSimilarityIndex()
+{
+  // We want to avoid calculating the full rating matrix, so we will do nearest
+  // neighbor search only on the H matrix, using the observation that if the
+  // rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i), W
+  // H.col(j)).  This can be seen as nearest neighbor search on the H matrix
+  // with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll decompose
+  // M^{-1} = L L^T (the Cholesky decomposition), and then multiply H by L^T.
+  // Then we can perform nearest neighbor search.
+  if (w.n_elem == 0 || h.n_elem == 0)
+  {
+    stretchedH.reset();
+    stretching.reset();
+    userIndex = CFNeighborSearch(userIndex.SearchType());
+    indexedUsers = 0;
+    return;
+  }
+
+  // This is done in double precision, whatever the type of the factors.
+  const arma::mat& wd = AsDouble(w);
+  stretching = arma::chol(wd.t() * wd);
+  // Due to the Armadillo API, this is L^T H.
+  const arma::mat stretched = stretching * AsDouble(h);
+
+  Timer::Start("cf_similarity_index");
+  userIndex.Train(stretched);
+  Timer::Stop("cf_similarity_index");
+  stretchedH = arma::conv_to<MatType>::from(stretched);
+  indexedUsers = stretchedH.n_cols;
+}
+
+template<typename MatType>
+void CFType<MatType>::SimilarUsers(const arma::Col<size_t>& users,
+                                   arma::Mat<size_t>& neighborhood) const
+{
+  // Select feature vectors of queried users.
+  arma::mat query(stretchedH.n_rows, users.n_elem);
+  for (size_t i = 0; i < users.n_elem; ++i)
+    query.col(i) = arma::conv_to<arma::vec>::from(stretchedH.col(users[i]));
+
+  userIndex.Search(query, std::min(numUsersForSimilarity, indexedUsers),
+      neighborhood);
+
+  // The users added by AddUsers() since the index was built are compared with
+  // each query by brute force, and the closest of them and of the neighbors
+  // found by the index are kept.
+  if (indexedUsers < stretchedH.n_cols)
+  {
+    arma::Mat<size_t> indexNeighborhood = std::move(neighborhood);
+    neighborhood.set_size(numUsersForSimilarity, users.n_elem);
+
+    std::vector<std::pair<double, size_t>> candidates;
+    for (size_t i = 0; i < users.n_elem; ++i)
+    {
+      candidates.clear();
+      for (size_t j = 0; j < indexNeighborhood.n_rows; ++j)
+      {
+        const size_t neighbor = indexNeighborhood(j, i);
+        if (neighbor < stretchedH.n_cols)
+        {
+          candidates.push_back(std::make_pair(arma::norm(query.col(i) -
+              arma::conv_to<arma::vec>::from(stretchedH.col(neighbor))),
+              neighbor));
+        }
+      }
+      for (size_t u = indexedUsers; u < stretchedH.n_cols; ++u)
+      {
+        candidates.push_back(std::make_pair(arma::norm(query.col(i) -
+            arma::conv_to<arma::vec>::from(stretchedH.col(u))), u));
+      }
+
+      const size_t found = std::min(numUsersForSimilarity, candidates.size());
+      std::partial_sort(candidates.begin(), candidates.begin() + found,
+          candidates.end());
+      for (size_t j = 0; j < numUsersForSimilarity; ++j)
+      {
+        neighborhood(j, i) = (j < found) ? candidates[j].second :
+            stretchedH.n_cols;
+      }
+    }
+  }
+
+  // An approximate search may not find enough neighbors; the missing ones are
+  // replaced with the user itself, so that every neighborhood has the same
+  // size.
+  for (size_t i = 0; i < neighborhood.n_cols; ++i)
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      if (neighborhood(j, i) >= stretchedH.n_cols)
+        neighborhood(j, i) = users[i];
+}
+
+template<typename MatType>
+arma::vec CFType<MatType>::FoldIn(const arma::mat& fixed,
+                                  const arma::sp_mat& ratings,
+                                  const size_t col,
+                                  const double lambda)
+{
+  const size_t r = fixed.n_rows;
+  arma::mat a(r, r, arma::fill::zeros);
+  arma::vec b(r, arma::fill::zeros);
+  for (size_t k = ratings.col_ptrs[col]; k < ratings.col_ptrs[col + 1]; ++k)
+  {
+    const arma::vec f(const_cast<double*>(fixed.colptr(
+        ratings.row_indices[k])), r, false, true);
+    a += f * f.t();
+    b += ratings.values[k] * f;
+  }
+  a.diag() += lambda;
+
+  // Without regularization, the system is singular if there are fewer
+  // ratings than factors, so the pseudoinverse is used then.
+  arma::vec x;
+  if (lambda <= 0.0 || !arma::solve(x, a, b))
+    x = arma::pinv(a) * b;
+
+  return x;
+}
+
+template<typename MatType>
+arma::sp_mat CFType<MatType>::AppendColumns(const arma::sp_mat& data,
+                                            const arma::sp_mat& extra)
+{
+  arma::umat locations(2, data.n_nonzero + extra.n_nonzero);
+  arma::vec values(data.n_nonzero + extra.n_nonzero);
+  size_t k = 0;
+  for (arma::sp_mat::const_iterator it = data.begin(); it != data.end(); ++it)
+  {
+    locations(0, k) = it.row();
+    locations(1, k) = it.col();
+    values[k++] = *it;
+  }
+  for (arma::sp_mat::const_iterator it = extra.begin(); it != extra.end();
+       ++it)
+  {
+    locations(0, k) = it.row();
+    locations(1, k) = data.n_cols + it.col();
+    values[k++] = *it;
+  }
+
+  return arma::sp_mat(locations, values, data.n_rows,
+      data.n_cols + extra.n_cols);
+}
+
+template<typename MatType>
+size_t CFType<MatType>::AddUsers(const arma::sp_mat& ratings,
+                                 const double lambda)
+{
+  if (w.n_elem == 0)
+    throw std::invalid_argument("CF::AddUsers(): the model is not trained");
+  if (ratings.n_rows != cleanedData.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "CF::AddUsers(): the ratings have " << ratings.n_rows << " rows, "
+        << "but there are " << cleanedData.n_rows << " items";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t firstUser = cleanedData.n_cols;
+  const arma::mat wt = AsDouble(w).t();
+  arma::mat newH(h.n_rows, ratings.n_cols);
+  for (size_t i = 0; i < ratings.n_cols; ++i)
+    newH.col(i) = FoldIn(wt, ratings, i, lambda);
+
+  h = arma::join_rows(h, arma::conv_to<MatType>::from(newH));
+  cleanedData = AppendColumns(cleanedData, ratings);
+  stretchedH = arma::join_rows(stretchedH,
+      arma::conv_to<MatType>::from(stretching * newH));
+
+  // W is unchanged, so the index stays valid for the old users; it is only
+  // rebuilt once the brute force search over the new users would cost more
+  // than about a tenth of the users.
+  if ((stretchedH.n_cols - indexedUsers) * 10 > indexedUsers)
+    BuildSimilarityIndex();
+
+  return firstUser;
+}
+
+template<typename MatType>
+size_t CFType<MatType>::AddItems(const arma::sp_mat& ratings,
+                                 const double lambda)
+{
+  if (w.n_elem == 0)
+    throw std::invalid_argument("CF::AddItems(): the model is not trained");
+  if (ratings.n_cols != cleanedData.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "CF::AddItems(): the ratings have " << ratings.n_cols << " "
+        << "columns, but there are " << cleanedData.n_cols << " users";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t firstItem = cleanedData.n_rows;
+  const arma::sp_mat itemRatings = ratings.t();
+  const arma::mat& hd = AsDouble(h);
+  arma::mat newW(itemRatings.n_cols, w.n_cols);
+  for (size_t i = 0; i < itemRatings.n_cols; ++i)
+    newW.row(i) = FoldIn(hd, itemRatings, i, lambda).t();
+
+  w = arma::join_cols(w, arma::conv_to<MatType>::from(newW));
+  const arma::sp_mat itemData = cleanedData.t();
+  cleanedData = AppendColumns(itemData, itemRatings).t();
+
+  // The stretching of H depends on W, so the whole index is rebuilt.
+  BuildSimilarityIndex();
+
+  return firstItem;
+}
+
+template<typename MatType>
+void CFType<MatType>::CleanData(const arma::mat& data,
+                                arma::sp_mat& cleanedData)
+{
+  // Generate list of locations for batch insert constructor for sparse
+  // matrices.
+  arma::umat locations(2, data.n_cols);
+  arma::vec values(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    // We have to transpose it because items are rows, and users are columns.
+    locations(1, i) = ((arma::uword) data(0, i));
+    locations(0, i) = ((arma::uword) data(1, i));
+    values(i) = data(2, i);
+    if (values(i) == 0)
+      Log::Warn << "User rating of 0 ignored for user " << locations(1, i)
+          << ", item " << locations(0, i) << "." << std::endl;
+  }
+
+  // Find maximum user and item IDs.
+  const size_t maxItemID = (size_t) max(locations.row(0)) + 1;
+  const size_t maxUserID = (size_t) max(locations.row(1)) + 1;
+
+  // Fill sparse matrix.
+  cleanedData = arma::sp_mat(locations, values, maxItemID, maxUserID);
 }
 
 } // namespace cf
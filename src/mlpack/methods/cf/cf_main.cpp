@@ -16,7 +16,7 @@
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
 #include <mlpack/methods/amf/termination_policies/max_iteration_termination.hpp>
-#include "cf.hpp"
+#include "cf_model.hpp"
 
 using namespace mlpack;
 using namespace mlpack::cf;
@@ -49,7 +49,14 @@ PROGRAM_INFO("Collaborative Filtering", "This program performs collaborative "
     "specified with the " + PRINT_PARAM_STRING("recommendations") + " "
     "parameter, and the number of similar users (the size of the neighborhood) "
     " to be considered when generating recommendations can be specified with "
-    "the " + PRINT_PARAM_STRING("neighborhood") + " parameter."
+    "the " + PRINT_PARAM_STRING("neighborhood") + " parameter.  The similar "
+    "users are found with the neighbor search given by the " +
+    PRINT_PARAM_STRING("neighbor_search") + " parameter: 'kd' and 'cover' are "
+    "exact searches with kd-trees and cover trees, and 'spill' (spill trees "
+    "with defeatist search), 'lsh' (locality-sensitive hashing), and 'ra' "
+    "(rank-approximate search) are approximate searches that are much faster "
+    "for many users, but may miss some of the most similar ones.  If a model "
+    "is loaded, its search is only changed if this parameter is given."
     "\n\n"
     "For performing the matrix decomposition, the following optimization "
     "algorithms can be specified via the " + PRINT_PARAM_STRING("algorithm") +
@@ -61,7 +68,21 @@ PROGRAM_INFO("Collaborative Filtering", "This program performs collaborative "
     "'BatchSVD' -- SVD batch learning\n"
     "'SVDIncompleteIncremental' -- SVD incomplete incremental learning\n"
     "'SVDCompleteIncremental' -- SVD complete incremental learning\n"
+    "'ImplicitALS' -- Weighted alternating least squares for implicit "
+    "feedback\n"
     "\n"
+    "With 'ImplicitALS', the ratings are amounts of implicit feedback (like "
+    "numbers of clicks) rather than explicit ratings: every item a user gave "
+    "feedback on is preferred, with a confidence that grows with the feedback "
+    "at the rate given by the " + PRINT_PARAM_STRING("alpha") + " parameter, "
+    "and the estimated ratings are preference scores between 0 and 1."
+    "\n\n"
+    "The factors are stored in double precision, unless the " +
+    PRINT_PARAM_STRING("single_precision") + " parameter is given; then they "
+    "are stored in single precision, which halves the size of the model and "
+    "speeds up recommendations.  The factorization itself is always done in "
+    "double precision."
+    "\n\n"
     "A trained model may be saved to with the " +
     PRINT_PARAM_STRING("output_model") + " output parameter."
     "\n\n"
@@ -86,21 +107,27 @@ PARAM_STRING_IN("algorithm", "Algorithm used for matrix factorization.", "a",
     "NMF");
 PARAM_INT_IN("neighborhood", "Size of the neighborhood of similar users to "
     "consider for each query user.", "n", 5);
+PARAM_STRING_IN("neighbor_search", "Neighbor search for the neighborhoods of "
+    "similar users: 'kd', 'cover', 'spill', 'lsh', or 'ra'.", "k", "kd");
 PARAM_INT_IN("rank", "Rank of decomposed matrices (if 0, a heuristic is used to"
     " estimate the rank).", "R", 0);
 PARAM_MATRIX_IN("test", "Test set to calculate RMSE on.", "T");
+PARAM_DOUBLE_IN("alpha", "Rate at which the confidence in a preference grows "
+    "with the feedback, for the 'ImplicitALS' algorithm.", "L", 40.0);
 
 // Offer the user the option to set the maximum number of iterations, and
 // terminate only based on the number of iterations.
 PARAM_INT_IN("max_iterations", "Maximum number of iterations.", "N", 1000);
 PARAM_FLAG("iteration_only_termination", "Terminate only when the maximum "
     "number of iterations is reached.", "I");
+PARAM_FLAG("single_precision", "Store the factors of the trained model in "
+    "single precision.", "F");
 PARAM_DOUBLE_IN("min_residue", "Residue required to terminate the factorization"
     " (lower values generally mean better fits).", "r", 1e-5);
 
 // Load/save a model.
-PARAM_MODEL_IN(CF, "input_model", "Trained CF model to load.", "m");
-PARAM_MODEL_OUT(CF, "output_model", "Output for trained CF model.", "M");
+PARAM_MODEL_IN(CFModel, "input_model", "Trained CF model to load.", "m");
+PARAM_MODEL_OUT(CFModel, "output_model", "Output for trained CF model.", "M");
 
 // Query settings.
 PARAM_UMATRIX_IN("query", "List of query users for which recommendations should"
@@ -114,7 +141,8 @@ PARAM_INT_IN("recommendations", "Number of recommendations to generate for each"
 
 PARAM_INT_IN("seed", "Set the random seed (0 uses std::time(NULL)).", "s", 0);
 
-void ComputeRecommendations(CF& cf,
+template<typename MatType>
+void ComputeRecommendations(CFType<MatType>& cf,
                             const size_t numRecs,
                             arma::Mat<size_t>& recommendations)
 {
@@ -140,7 +168,8 @@ void ComputeRecommendations(CF& cf,
   }
 }
 
-void ComputeRMSE(CF& cf)
+template<typename MatType>
+void ComputeRMSE(CFType<MatType>& cf)
 {
   // Now, compute each test point.
   arma::mat testData = std::move(CLI::GetParam<arma::mat>("test"));
@@ -167,7 +196,23 @@ void ComputeRMSE(CF& cf)
   Log::Info << "RMSE is " << rmse << "." << endl;
 }
 
-void PerformAction(CF& c)
+// Store the trained model in the output model.
+void StoreModel(CF& c)
+{
+  CFModel& model = CLI::GetParam<CFModel>("output_model");
+  model.SinglePrecision() = false;
+  model.Model() = std::move(c);
+}
+
+void StoreModel(FloatCF& c)
+{
+  CFModel& model = CLI::GetParam<CFModel>("output_model");
+  model.SinglePrecision() = true;
+  model.SinglePrecisionModel() = std::move(c);
+}
+
+template<typename MatType>
+void PerformAction(CFType<MatType>& c)
 {
   if (CLI::HasParam("query") || CLI::HasParam("all_user_recommendations"))
   {
@@ -187,7 +232,7 @@ void PerformAction(CF& c)
     ComputeRMSE(c);
 
   if (CLI::HasParam("output_model"))
-    CLI::GetParam<CF>("output_model") = std::move(c);
+    StoreModel(c);
 }
 
 template<typename Factorizer>
@@ -197,9 +242,23 @@ void PerformAction(Factorizer&& factorizer,
 {
   // Parameters for generating the CF object.
   const size_t neighborhood = (size_t) CLI::GetParam<int>("neighborhood");
-  CF c(dataset, factorizer, neighborhood, rank);
+  const CFNeighborSearch::SearchTypes searchType =
+      CFNeighborSearch::ParseSearchType(
+      CLI::GetParam<string>("neighbor_search"));
 
-  PerformAction(c);
+  // Only the chosen index is built after the factorization.
+  if (CLI::HasParam("single_precision"))
+  {
+    FloatCF c(neighborhood, rank, searchType);
+    c.Train(dataset, factorizer);
+    PerformAction(c);
+  }
+  else
+  {
+    CF c(neighborhood, rank, searchType);
+    c.Train(dataset, factorizer);
+    PerformAction(c);
+  }
 }
 
 void AssembleFactorizerType(const std::string& algorithm,
@@ -208,6 +267,7 @@ void AssembleFactorizerType(const std::string& algorithm,
                             const size_t rank)
 {
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+  const double alpha = CLI::GetParam<double>("alpha");
   if (maxIterationTermination)
   {
     // Force termination when maximum number of iterations reached.
@@ -236,6 +296,13 @@ void AssembleFactorizerType(const std::string& algorithm,
           SVDCompleteIncrementalLearning<arma::sp_mat>> FactorizerType;
       PerformAction(FactorizerType(mit), dataset, rank);
     }
+    else if (algorithm == "ImplicitALS")
+    {
+      typedef AMF<MaxIterationTermination, RandomAcolInitialization<>,
+          ImplicitALSUpdate> FactorizerType;
+      PerformAction(FactorizerType(mit, RandomAcolInitialization<>(),
+          ImplicitALSUpdate(alpha)), dataset, rank);
+    }
     else if (algorithm == "RegSVD")
     {
       Log::Fatal << "--iteration_only_termination not supported with 'RegSVD' "
@@ -257,11 +324,27 @@ void AssembleFactorizerType(const std::string& algorithm,
           rank);
     else if (algorithm == "SVDCompleteIncremental")
       PerformAction(SparseSVDCompleteIncrementalFactorizer(srt), dataset, rank);
+    else if (algorithm == "ImplicitALS")
+      PerformAction(ImplicitALSFactorizer(srt, RandomAcolInitialization<>(),
+          ImplicitALSUpdate(alpha)), dataset, rank);
     else if (algorithm == "RegSVD")
       PerformAction(RegularizedSVD<>(maxIterations), dataset, rank);
   }
 }
 
+// Change the neighbor search of a loaded model if asked, and use it.
+template<typename MatType>
+void LoadedModelAction(CFType<MatType>& c)
+{
+  if (CLI::HasParam("neighbor_search"))
+  {
+    c.NeighborSearchType(CFNeighborSearch::ParseSearchType(
+        CLI::GetParam<string>("neighbor_search")));
+  }
+
+  PerformAction(c);
+}
+
 void mlpackMain()
 {
   if (CLI::GetParam<int>("seed") == 0)
@@ -292,6 +375,15 @@ void mlpackMain()
     Log::Warn << "--output_file is ignored because neither --query_file nor "
         << "--all_user_recommendations are specified." << endl;
 
+  try
+  {
+    CFNeighborSearch::ParseSearchType(CLI::GetParam<string>("neighbor_search"));
+  }
+  catch (std::invalid_argument& e)
+  {
+    Log::Fatal << e.what() << "." << endl;
+  }
+
   // Either load from a model, or train a model.
   if (CLI::HasParam("training"))
   {
@@ -314,10 +406,18 @@ void mlpackMain()
         algo != "BatchSVD" &&
         algo != "SVDIncompleteIncremental" &&
         algo != "SVDCompleteIncremental" &&
+        algo != "ImplicitALS" &&
         algo != "RegSVD")
       Log::Fatal << "Invalid decomposition algorithm.  Choices are 'NMF', "
           << "'BatchSVD', 'SVDIncompleteIncremental', 'SVDCompleteIncremental',"
-          << " and 'RegSVD'." << endl;
+          << " 'ImplicitALS', and 'RegSVD'." << endl;
+
+    if (CLI::HasParam("alpha") && algo != "ImplicitALS")
+      Log::Warn << "--alpha ignored, because the algorithm is not "
+          << "'ImplicitALS'." << endl;
+    if (CLI::GetParam<double>("alpha") < 0.0)
+      Log::Fatal << "--alpha must be nonnegative (received "
+          << CLI::GetParam<double>("alpha") << ")!" << endl;
 
     // Issue a warning if the user provided a minimum residue but it will be
     // ignored.
@@ -333,8 +433,18 @@ void mlpackMain()
   else
   {
     // Load an input model.
-    CF c = std::move(CLI::GetParam<CF>("input_model"));
-
-    PerformAction(c);
+    CFModel& model = CLI::GetParam<CFModel>("input_model");
+    if (CLI::HasParam("single_precision") && !model.SinglePrecision())
+      Log::Warn << "--single_precision ignored, because the input model is in "
+          << "double precision." << endl;
+
+    // The model is used in place, so that it is not consumed.
+    if (model.SinglePrecision())
+      LoadedModelAction(model.SinglePrecisionModel());
+    else
+      LoadedModelAction(model.Model());
+
+    if (CLI::HasParam("output_model"))
+      CLI::GetParam<CFModel>("output_model") = std::move(model);
   }
 }
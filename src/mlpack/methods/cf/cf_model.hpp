@@ -0,0 +1,108 @@
+/**
+ * @file cf_model.hpp
+ *
+ * A serializable CF model that holds its factors in double or single
+ * precision, for the cf program.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_CF_CF_MODEL_HPP
+#define MLPACK_METHODS_CF_CF_MODEL_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "cf.hpp"
+
+namespace mlpack {
+namespace cf {
+
+/**
+ * CFModel holds either a CF model, with factors in double precision, or a
+ * FloatCF model, with factors in single precision, so that the cf program can
+ * save and load both.  Only the model of the precision given by
+ * SinglePrecision() is used; the other one stays empty.
+ */
+class CFModel
+{
+ public:
+  /**
+   * Create an empty model of the given precision.
+   *
+   * @param singlePrecision Whether the factors are in single precision.
+   */
+  CFModel(const bool singlePrecision = false) :
+      singlePrecision(singlePrecision)
+  {
+    // Nothing to do.
+  }
+
+  //! Get whether the factors are in single precision.
+  bool SinglePrecision() const { return singlePrecision; }
+  //! Modify whether the factors are in single precision.
+  bool& SinglePrecision() { return singlePrecision; }
+
+  /**
+   * Get the model with factors in double precision.  A std::invalid_argument
+   * is thrown if the model is in single precision.
+   */
+  CF& Model()
+  {
+    if (singlePrecision)
+      throw std::invalid_argument("CFModel::Model(): the model is in single "
+          "precision; use SinglePrecisionModel()");
+    return cf;
+  }
+
+  /**
+   * Get the model with factors in single precision.  A std::invalid_argument
+   * is thrown if the model is in double precision.
+   */
+  FloatCF& SinglePrecisionModel()
+  {
+    if (!singlePrecision)
+      throw std::invalid_argument("CFModel::SinglePrecisionModel(): the model "
+          "is not in single precision; use Model()");
+    return floatCF;
+  }
+
+  /**
+   * Serialize the model of the chosen precision.  Model files from before
+   * version 2 hold a CF model directly (with version 0 or 1 of CF), so they are
+   * loaded into the double precision model.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int version)
+  {
+    if (version < 2)
+    {
+      singlePrecision = false;
+      cf.Serialize(ar, version);
+      return;
+    }
+
+    ar & data::CreateNVP(singlePrecision, "singlePrecision");
+    if (singlePrecision)
+      ar & data::CreateNVP(floatCF, "cf");
+    else
+      ar & data::CreateNVP(cf, "cf");
+  }
+
+ private:
+  //! Whether the factors are in single precision.
+  bool singlePrecision;
+  //! The model in double precision.
+  CF cf;
+  //! The model in single precision.
+  FloatCF floatCF;
+};
+
+} // namespace cf
+} // namespace mlpack
+
+//! Set the serialization version of the CFModel class.  Older files hold a CF
+//! model, whose versions are 0 and 1.
+BOOST_TEMPLATE_CLASS_VERSION(template<>, mlpack::cf::CFModel, 2);
+
+#endif
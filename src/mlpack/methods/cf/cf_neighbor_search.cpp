@@ -0,0 +1,188 @@
+/**
+ * @file cf_neighbor_search.cpp
+ *
+ * Implementation of the CFNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "cf_neighbor_search.hpp"
+
+using namespace mlpack;
+using namespace mlpack::cf;
+
+namespace {
+
+//! Delete the search object.
+class DeleteSearchVisitor : public boost::static_visitor<void>
+{
+ public:
+  template<typename SearchType>
+  void operator()(SearchType* search) const { delete search; }
+};
+
+//! Search for the neighbors of the query points.
+class SearchVisitor : public boost::static_visitor<void>
+{
+ public:
+  SearchVisitor(const arma::mat& querySet,
+                const size_t k,
+                arma::Mat<size_t>& neighbors) :
+      querySet(querySet),
+      k(k),
+      neighbors(neighbors)
+  { }
+
+  //! Tree-based exact or defeatist search: a single query point does not need
+  //! a query tree.
+  template<typename SortPolicy,
+           typename MetricType,
+           typename MatType,
+           template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType,
+           template<typename RuleType> class DualTreeTraversalType,
+           template<typename RuleType> class SingleTreeTraversalType>
+  void operator()(neighbor::NeighborSearch<SortPolicy, MetricType, MatType,
+      TreeType, DualTreeTraversalType, SingleTreeTraversalType>* ns) const
+  {
+    const neighbor::NeighborSearchMode mode = ns->SearchMode();
+    if (querySet.n_cols == 1)
+      ns->SearchMode() = neighbor::SINGLE_TREE_MODE;
+
+    arma::mat distances;
+    ns->Search(querySet, k, neighbors, distances);
+    ns->SearchMode() = mode;
+  }
+
+  //! LSH search.
+  void operator()(neighbor::LSHSearch<>* lsh) const
+  {
+    arma::mat distances;
+    lsh->Search(querySet, k, neighbors, distances);
+  }
+
+  //! Rank-approximate search.
+  void operator()(neighbor::KRANN* ra) const
+  {
+    const bool singleMode = ra->SingleMode();
+    if (querySet.n_cols == 1)
+      ra->SingleMode() = true;
+
+    arma::mat distances;
+    ra->Search(querySet, k, neighbors, distances);
+    ra->SingleMode() = singleMode;
+  }
+
+ private:
+  const arma::mat& querySet;
+  const size_t k;
+  arma::Mat<size_t>& neighbors;
+};
+
+} // namespace
+
+CFNeighborSearch::CFNeighborSearch(const SearchTypes searchType) :
+    searchType(searchType),
+    trained(false),
+    search(static_cast<neighbor::KNN*>(NULL))
+{
+  // Nothing to do.
+}
+
+CFNeighborSearch::~CFNeighborSearch()
+{
+  Clean();
+}
+
+CFNeighborSearch::CFNeighborSearch(CFNeighborSearch&& other) :
+    searchType(other.searchType),
+    trained(other.trained),
+    search(other.search)
+{
+  other.trained = false;
+  other.search = static_cast<neighbor::KNN*>(NULL);
+}
+
+CFNeighborSearch& CFNeighborSearch::operator=(CFNeighborSearch&& other)
+{
+  if (this != &other)
+  {
+    Clean();
+
+    searchType = other.searchType;
+    trained = other.trained;
+    search = other.search;
+    other.trained = false;
+    other.search = static_cast<neighbor::KNN*>(NULL);
+  }
+
+  return *this;
+}
+
+void CFNeighborSearch::Train(const arma::mat& referenceSet)
+{
+  Clean();
+
+  switch (searchType)
+  {
+    case KD_TREE_SEARCH:
+      search = new neighbor::KNN(referenceSet);
+      break;
+    case COVER_TREE_SEARCH:
+      search = new CoverTreeKNN(referenceSet);
+      break;
+    case SPILL_TREE_SEARCH:
+      search = new neighbor::SpillKNN(referenceSet);
+      break;
+    case LSH_SEARCH:
+      // These are the defaults of mlpack_lsh.
+      search = new neighbor::LSHSearch<>(referenceSet, 10, 30);
+      break;
+    case RA_SEARCH:
+      search = new neighbor::KRANN(referenceSet);
+      break;
+  }
+
+  trained = true;
+}
+
+void CFNeighborSearch::Search(const arma::mat& querySet,
+                              const size_t k,
+                              arma::Mat<size_t>& neighbors)
+{
+  if (!trained)
+  {
+    throw std::invalid_argument("CFNeighborSearch::Search(): no users to "
+        "search; call Train() first");
+  }
+
+  boost::apply_visitor(SearchVisitor(querySet, k, neighbors), search);
+}
+
+CFNeighborSearch::SearchTypes CFNeighborSearch::ParseSearchType(
+    const std::string& name)
+{
+  if (name == "kd")
+    return KD_TREE_SEARCH;
+  else if (name == "cover")
+    return COVER_TREE_SEARCH;
+  else if (name == "spill")
+    return SPILL_TREE_SEARCH;
+  else if (name == "lsh")
+    return LSH_SEARCH;
+  else if (name == "ra")
+    return RA_SEARCH;
+
+  throw std::invalid_argument("unknown neighbor search type '" + name + "'; "
+      "must be 'kd', 'cover', 'spill', 'lsh', or 'ra'");
+}
+
+void CFNeighborSearch::Clean()
+{
+  boost::apply_visitor(DeleteSearchVisitor(), search);
+  search = static_cast<neighbor::KNN*>(NULL);
+  trained = false;
+}
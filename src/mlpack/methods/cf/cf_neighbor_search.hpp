@@ -0,0 +1,130 @@
+/**
+ * @file cf_neighbor_search.hpp
+ *
+ * Definition of the CFNeighborSearch class, which finds the neighborhoods of
+ * users for CF with exact or approximate nearest neighbor search.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_CF_CF_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_CF_CF_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/spill_tree.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/rann/ra_search.hpp>
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace cf {
+
+//! Exact nearest neighbor search with cover trees.
+typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort,
+    metric::EuclideanDistance, arma::mat, tree::StandardCoverTree>
+    CoverTreeKNN;
+
+/**
+ * The nearest neighbor search that CF uses to find the most similar users.
+ * The search is built once on the stretched H matrix of the model, and can be
+ * exact (with kd-trees or cover trees) or approximate: spill trees with
+ * defeatist search, locality-sensitive hashing (LSHSearch), or rank-
+ * approximate search (RASearch).  The approximate searches may return users
+ * that are not the nearest ones, and LSHSearch may even return fewer than the
+ * requested number of users; these are marked with an index of SIZE_MAX.
+ *
+ * The Search() calls of one CFNeighborSearch object must not run concurrently.
+ */
+class CFNeighborSearch
+{
+ public:
+  //! The types of neighbor search that can be used.
+  enum SearchTypes
+  {
+    KD_TREE_SEARCH,
+    COVER_TREE_SEARCH,
+    SPILL_TREE_SEARCH,
+    LSH_SEARCH,
+    RA_SEARCH
+  };
+
+  /**
+   * Create the neighbor search of the given type, which is empty until
+   * Train() is called.
+   *
+   * @param searchType Type of neighbor search to use.
+   */
+  CFNeighborSearch(const SearchTypes searchType = KD_TREE_SEARCH);
+
+  //! Delete the neighbor search.
+  ~CFNeighborSearch();
+
+  // The neighbor search is rebuilt rather than copied.
+  CFNeighborSearch(const CFNeighborSearch& other) = delete;
+  CFNeighborSearch& operator=(const CFNeighborSearch& other) = delete;
+
+  //! Take ownership of the given neighbor search.
+  CFNeighborSearch(CFNeighborSearch&& other);
+  //! Take ownership of the given neighbor search.
+  CFNeighborSearch& operator=(CFNeighborSearch&& other);
+
+  /**
+   * Build the neighbor search on the given users, one per column, replacing
+   * the previous one.  The search type can be changed before with
+   * SearchType().
+   *
+   * @param referenceSet Users to search among.
+   */
+  void Train(const arma::mat& referenceSet);
+
+  /**
+   * Find the k nearest users of each of the given query points.  Tree-based
+   * searches use single-tree search for a single query point and dual-tree
+   * search otherwise.
+   *
+   * @param querySet Points to find the neighbors of.
+   * @param k Number of neighbors to find.
+   * @param neighbors Set to the indices of the neighbors of each query point.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors);
+
+  //! Get whether Train() has been called.
+  bool Trained() const { return trained; }
+
+  //! Get the type of neighbor search.
+  SearchTypes SearchType() const { return searchType; }
+  //! Modify the type of neighbor search (Train() has to be called again).
+  SearchTypes& SearchType() { return searchType; }
+
+  /**
+   * Get the search type with the given name: "kd", "cover", "spill", "lsh" or
+   * "ra".  A std::invalid_argument is thrown for other names.
+   */
+  static SearchTypes ParseSearchType(const std::string& name);
+
+ private:
+  //! Delete the current search object.
+  void Clean();
+
+  //! The type of neighbor search.
+  SearchTypes searchType;
+  //! Whether Train() has been called.
+  bool trained;
+  //! The search object, of the type given by searchType.
+  boost::variant<neighbor::KNN*,
+                 CoverTreeKNN*,
+                 neighbor::SpillKNN*,
+                 neighbor::LSHSearch<>*,
+                 neighbor::KRANN*> search;
+};
+
+} // namespace cf
+} // namespace mlpack
+
+#endif
@@ -15,8 +15,9 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/range_search/range_search.hpp>
-#include <mlpack/methods/emst/union_find.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
 #include "random_point_selection.hpp"
+#include "grid_range_search.hpp"
 #include <boost/dynamic_bitset.hpp>
 
 namespace mlpack {
@@ -43,6 +44,19 @@ namespace dbscan {
  * range search technique used and the point selection strategy by means of
  * template parameters.
  *
+ * The points of each neighborhood are joined with a ConcurrentUnionFind, so in
+ * batch mode the range search may call its callback from several threads, as
+ * RangeSearch does in naive and single-tree mode; DBSCAN with
+ * RangeSearch<>(false, true) therefore clusters with all available threads.
+ * Each cluster is labeled by the order of its first point, so the labels do
+ * not depend on the number of threads or on the order in which the
+ * neighborhoods are found.
+ *
+ * For low-dimensional data, GridRangeSearch can be used as the RangeSearchType.
+ * If the RangeSearchType has a member JoinNeighborhoods(epsilon, uf), as
+ * GridRangeSearch does, batch mode lets it join the neighborhoods itself
+ * instead of searching each point.
+ *
  * @tparam RangeSearchType Class to use for range searching.
  * @tparam PointSelectionPolicy Strategy for selecting next point to cluster
  *      with.
@@ -53,11 +67,12 @@ class DBSCAN
 {
  public:
   /**
-   * Construct the DBSCAN object with the given parameters.  The batchMode
-   * parameter should be set to false in the case where RAM issues will be
-   * encountered (i.e. if the dataset is very large or if epsilon is large).
-   * When batchMode is false, each point will be searched iteratively, which
-   * could be slower but will use less memory.
+   * Construct the DBSCAN object with the given parameters.  When batchMode is
+   * true, all points are searched with one range search, and each pair of
+   * neighbors is joined as soon as it is found, so the neighborhoods are not
+   * stored; the RangeSearchType must then support searching with a callback
+   * (as RangeSearch does).  When batchMode is false, each point will be
+   * searched iteratively, which is usually slower.
    *
    * @param epsilon Size of range query.
    * @param minPoints Minimum number of points for each cluster.
@@ -111,6 +126,19 @@ class DBSCAN
                  arma::Row<size_t>& assignments,
                  arma::mat& centroids);
 
+  /**
+   * Performs DBSCAN clustering on the points held by the given SharedTree,
+   * returning the number of clusters and also the list of cluster assignments.
+   * The range search uses the shared tree instead of building its own, so the
+   * RangeSearchType must accept a SharedTree in Train() (as RangeSearch does).
+   * The assignments are given in terms of the original indices of the points.
+   *
+   * @param referenceTree Handle to the shared tree holding the points.
+   * @param assignments Vector to store cluster assignments.
+   */
+  size_t Cluster(const tree::SharedTree& referenceTree,
+                 arma::Row<size_t>& assignments);
+
  private:
   //! Maximum distance between two points to be part of same cluster.
   double epsilon;
@@ -136,11 +164,11 @@ class DBSCAN
    *
    * @param data Dataset to cluster.
    * @param assignments Assignments for each point.
-   * @param uf UnionFind structure that will be modified.
+   * @param uf Union-find structure that will be modified.
    */
   template<typename MatType>
   void PointwiseCluster(const MatType& data,
-                        emst::UnionFind& uf);
+                        emst::ConcurrentUnionFind& uf);
 
   /**
    * Performs DBSCAN clustering on the data, returning number of clusters
@@ -149,11 +177,24 @@ class DBSCAN
    *
    * @param data Dataset to cluster.
    * @param assignments Assignments for each point.
-   * @param uf UnionFind structure that will be modified.
+   * @param uf Union-find structure that will be modified.
    */
   template<typename MatType>
   void BatchCluster(const MatType& data,
-                    emst::UnionFind& uf);
+                    emst::ConcurrentUnionFind& uf);
+
+  /**
+   * Turn the sets of the given union-find structure into cluster assignments,
+   * giving sets with fewer than minPoints points the assignment SIZE_MAX, and
+   * return the number of clusters.
+   *
+   * @param uf Union-find structure holding the points of each cluster.
+   * @param numPoints Number of points that were clustered.
+   * @param assignments Vector to store cluster assignments.
+   */
+  size_t AssignClusters(emst::ConcurrentUnionFind& uf,
+                        const size_t numPoints,
+                        arma::Row<size_t>& assignments);
 };
 
 } // namespace dbscan
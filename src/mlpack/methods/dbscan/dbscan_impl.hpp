@@ -13,10 +13,60 @@
 #define MLPACK_METHODS_DBSCAN_DBSCAN_IMPL_HPP
 
 #include "dbscan.hpp"
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 namespace mlpack {
 namespace dbscan {
 
+/**
+ * This gives us a JoinsNeighborhoods object that we can use to tell whether or
+ * not a RangeSearchType can join the neighborhoods of all points by itself.
+ */
+HAS_MEM_FUNC(JoinNeighborhoods, JoinsNeighborhoodsCheck);
+
+/**
+ * 'value' is true if the RangeSearchType class has a member
+ * void JoinNeighborhoods(const double epsilon, emst::ConcurrentUnionFind& uf).
+ */
+template<typename RangeSearchType>
+struct JoinsNeighborhoods
+{
+  static const bool value = JoinsNeighborhoodsCheck<RangeSearchType,
+      void(RangeSearchType::*)(const double,
+                               emst::ConcurrentUnionFind&)>::value;
+};
+
+//! Join the neighborhoods of all points with the range search itself, if it
+//! can do that.
+template<typename RangeSearchType, typename MatType>
+void JoinAllNeighborhoods(
+    RangeSearchType& rangeSearch,
+    const MatType& /* data */,
+    const double epsilon,
+    emst::ConcurrentUnionFind& uf,
+    const typename std::enable_if_t<
+        JoinsNeighborhoods<RangeSearchType>::value>* = 0)
+{
+  rangeSearch.JoinNeighborhoods(epsilon, uf);
+}
+
+//! Join the neighborhoods of all points with a monochromatic range search.
+//! Each pair is joined as soon as it is found, so that the neighborhoods do not
+//! have to be stored.
+template<typename RangeSearchType, typename MatType>
+void JoinAllNeighborhoods(
+    RangeSearchType& rangeSearch,
+    const MatType& data,
+    const double epsilon,
+    emst::ConcurrentUnionFind& uf,
+    const typename std::enable_if_t<
+        !JoinsNeighborhoods<RangeSearchType>::value>* = 0)
+{
+  auto unionPoints = [&uf](const size_t i, const size_t j,
+      const double /* distance */) { uf.Union(i, j); };
+  rangeSearch.Search(data, math::Range(0.0, epsilon), unionPoints);
+}
+
 /**
  * Construct the DBSCAN object with the given parameters.
  */
@@ -100,8 +150,8 @@ size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
     const MatType& data,
     arma::Row<size_t>& assignments)
 {
-  // Initialize the UnionFind object.
-  emst::UnionFind uf(data.n_cols);
+  // Initialize the union-find structure.
+  emst::ConcurrentUnionFind uf(data.n_cols);
   rangeSearch.Train(data);
 
   if (batchMode)
@@ -109,9 +159,71 @@ size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
   else
     PointwiseCluster(data, uf);
 
-  // Now set assignments.
-  assignments.set_size(data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+  return AssignClusters(uf, data.n_cols, assignments);
+}
+
+/**
+ * Performs DBSCAN clustering on the points of a shared tree, returning the
+ * number of clusters and also the list of cluster assignments.
+ */
+template<typename RangeSearchType, typename PointSelectionPolicy>
+size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
+    const tree::SharedTree& referenceTree,
+    arma::Row<size_t>& assignments)
+{
+  rangeSearch.Train(referenceTree);
+
+  // The points of the tree are permuted.
+  const std::vector<size_t>& oldFromNew = referenceTree.OldFromNew();
+  emst::ConcurrentUnionFind uf(oldFromNew.size());
+
+  if (batchMode)
+  {
+    // The monochromatic search gives the results in terms of the original
+    // indices of the points.  Each pair is joined as soon as it is found, so
+    // the neighborhoods are never stored.
+    auto unionPoints = [&uf](const size_t i, const size_t j,
+        const double /* distance */) { uf.Union(i, j); };
+    Log::Info << "Performing range search." << std::endl;
+    rangeSearch.Search(math::Range(0.0, epsilon), unionPoints);
+    Log::Info << "Range search complete." << std::endl;
+  }
+  else
+  {
+    std::vector<std::vector<size_t>> neighbors;
+    std::vector<std::vector<double>> distances;
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+    {
+      if (i % 10000 == 0 && i > 0)
+        Log::Info << "DBSCAN clustering on point " << i << "..." << std::endl;
+
+      // The neighbors are given in terms of the original indices, but the
+      // query point has to be mapped.
+      rangeSearch.Search(rangeSearch.ReferenceSet().col(i),
+          math::Range(0.0, epsilon), neighbors, distances);
+
+      for (size_t j = 0; j < neighbors[0].size(); ++j)
+        uf.Union(oldFromNew[i], neighbors[0][j]);
+    }
+  }
+
+  return AssignClusters(uf, oldFromNew.size(), assignments);
+}
+
+/**
+ * Turn the sets of a union-find structure into cluster assignments.
+ */
+template<typename RangeSearchType, typename PointSelectionPolicy>
+size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::AssignClusters(
+    emst::ConcurrentUnionFind& uf,
+    const size_t numPoints,
+    arma::Row<size_t>& assignments)
+{
+  // Now set assignments.  The root of each set is its point with the smallest
+  // index, so the clusters below are numbered in the order of their first
+  // points, however the sets were joined.
+  assignments.set_size(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
     assignments[i] = uf.Find(i);
 
   // Get a count of all clusters.
@@ -150,7 +262,7 @@ template<typename RangeSearchType, typename PointSelectionPolicy>
 template<typename MatType>
 void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
     const MatType& data,
-    emst::UnionFind& uf)
+    emst::ConcurrentUnionFind& uf)
 {
   std::vector<std::vector<size_t>> neighbors;
   std::vector<std::vector<double>> distances;
@@ -179,23 +291,14 @@ template<typename RangeSearchType, typename PointSelectionPolicy>
 template<typename MatType>
 void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
     const MatType& data,
-    emst::UnionFind& uf)
+    emst::ConcurrentUnionFind& uf)
 {
-  // For each point, find the points in epsilon-nighborhood and their distances.
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
+  // For each point, find the points in epsilon-nighborhood, and union the
+  // point to each of them.
   Log::Info << "Performing range search." << std::endl;
   rangeSearch.Train(data);
-  rangeSearch.Search(data, math::Range(0.0, epsilon), neighbors, distances);
+  JoinAllNeighborhoods(rangeSearch, data, epsilon, uf);
   Log::Info << "Range search complete." << std::endl;
-
-  // Now loop over all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[i].size(); ++j)
-      uf.Union(i, neighbors[i][j]);
-  }
 }
 
 } // namespace dbscan
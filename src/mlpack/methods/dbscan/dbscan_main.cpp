@@ -14,6 +14,7 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/data/curve_order.hpp>
 
 #include "dbscan.hpp"
 
@@ -51,7 +52,22 @@ PROGRAM_INFO("DBSCAN clustering",
     " 'hilbert-r', 'r-plus', 'r-plus-plus', 'cover', 'ball'. The " +
     PRINT_PARAM_STRING("single_mode") + " parameter will force single-tree "
     "search (as opposed to the default dual-tree search), and '" +
-    PRINT_PARAM_STRING("naive") + " will force brute-force range search."
+    PRINT_PARAM_STRING("naive") + " will force brute-force range search.  "
+    "Single-tree and brute-force search use all threads available to OpenMP."
+    "\n\n"
+    "For low-dimensional data, the " + PRINT_PARAM_STRING("grid") + " "
+    "parameter replaces the range search by a grid of cells whose diagonal is "
+    "the radius; all points of a cell are clustered together without computing"
+    " distances, and only neighboring cells are compared.  This is usually "
+    "much faster than a tree in two or three dimensions, and also uses all "
+    "threads available to OpenMP."
+    "\n\n"
+    "The " + PRINT_PARAM_STRING("curve_order") + " parameter reorders the "
+    "points along a space-filling curve ('z-order' or 'hilbert') before "
+    "clustering, so that points that are close to each other are also close in "
+    "memory, which helps brute-force search in particular.  The assignments "
+    "are given in the original order of the points (but the clusters may be "
+    "numbered differently)."
     "\n\n"
     "An example usage to run DBSCAN on the dataset in " +
     PRINT_DATASET("input") + " with a radius of 0.5 and a minimum cluster size"
@@ -74,22 +90,38 @@ PARAM_FLAG("single_mode", "If set, single-tree range search (not dual-tree) "
     "will be used.", "S");
 PARAM_FLAG("naive", "If set, brute-force range search (not tree-based) "
     "will be used.", "N");
+PARAM_FLAG("grid", "If set, a grid of cells (not a tree) will be used to find "
+    "the neighbors of each point; this is only suitable for low-dimensional "
+    "data.", "G");
+PARAM_STRING_IN("curve_order", "If specified, the space-filling curve to "
+    "reorder the points along before clustering ('z-order' or 'hilbert').", "",
+    "");
 
 // Actually run the clustering, and process the output.
 template<typename RangeSearchType>
-void RunDBSCAN(RangeSearchType rs = RangeSearchType())
+void ClusterAndSave(RangeSearchType rs)
 {
-  if (CLI::HasParam("single_mode"))
-    rs.SingleMode() = true;
-
   // Load dataset.
   arma::mat dataset = std::move(CLI::GetParam<arma::mat>("input"));
 
+  // Reorder the points along a space-filling curve, if requested.
+  const string curveOrder = CLI::GetParam<string>("curve_order");
+  std::vector<size_t> oldFromNew;
+  if (!curveOrder.empty())
+  {
+    Timer::Start("curve_ordering");
+    data::ReorderByCurve(dataset, oldFromNew, (curveOrder == "z-order") ?
+        data::Z_ORDER_CURVE : data::HILBERT_CURVE);
+    Timer::Stop("curve_ordering");
+  }
+
   const double epsilon = CLI::GetParam<double>("epsilon");
   const size_t minSize = (size_t) CLI::GetParam<int>("min_size");
 
-  DBSCAN<RangeSearchType> d(epsilon, minSize, !CLI::HasParam("single_mode"),
-      rs);
+  // Batch mode joins each pair of neighbors as soon as it is found, without
+  // storing the neighborhoods; with naive or single-tree search, the points
+  // are searched with several threads.
+  DBSCAN<RangeSearchType> d(epsilon, minSize, true, rs);
 
   // If possible, avoid the overhead of calculating centroids.
   arma::Row<size_t> assignments;
@@ -106,16 +138,50 @@ void RunDBSCAN(RangeSearchType rs = RangeSearchType())
     d.Cluster(dataset, assignments);
   }
 
+  // Give the assignments in the original order of the points.
+  if (!curveOrder.empty())
+    data::UnmapColumns(assignments, oldFromNew);
+
   if (CLI::HasParam("assignments"))
     CLI::GetParam<arma::Row<size_t>>("assignments") = std::move(assignments);
 }
 
+// Run the clustering with a RangeSearch object.
+template<typename RangeSearchType>
+void RunDBSCAN(RangeSearchType rs = RangeSearchType())
+{
+  if (CLI::HasParam("single_mode"))
+    rs.SingleMode() = true;
+
+  ClusterAndSave(rs);
+}
+
 void mlpackMain()
 {
   if (!CLI::HasParam("assignments") && !CLI::HasParam("centroids"))
     Log::Warn << "Neither --assignments_file nor --centroids_file are "
         << "specified; no output will be saved!" << endl;
 
+  const string curveOrder = CLI::GetParam<string>("curve_order");
+  if (!curveOrder.empty() && curveOrder != "z-order" &&
+      curveOrder != "hilbert")
+  {
+    Log::Fatal << "Invalid curve order '" << curveOrder << "'; must be "
+        << "'z-order' or 'hilbert'." << endl;
+  }
+
+  if (CLI::HasParam("grid"))
+  {
+    if (CLI::HasParam("single_mode"))
+      Log::Warn << "--single_mode ignored because --grid is specified." << endl;
+    if (CLI::HasParam("naive"))
+      Log::Warn << "--naive ignored because --grid is specified." << endl;
+
+    ClusterAndSave(GridRangeSearch<>());
+    CLI::Destroy();
+    return;
+  }
+
   if (CLI::HasParam("single_mode") && CLI::HasParam("naive"))
     Log::Warn << "--single_mode ignored because --naive is specified." << endl;
 
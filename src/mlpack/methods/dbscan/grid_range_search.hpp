@@ -0,0 +1,200 @@
+/**
+ * @file grid_range_search.hpp
+ *
+ * A range search for low-dimensional data that hashes the points into a grid
+ * of cells, so that only the cells near a query point have to be searched.  It
+ * can be used as the RangeSearchType of DBSCAN.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/range.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
+#include <boost/functional/hash.hpp>
+#include <unordered_map>
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * A Euclidean range search that puts the reference points into a grid of cubic
+ * cells, which are stored in a hash table, so that empty cells take no memory.
+ * The side of each cell is r / sqrt(d), where r is the upper end of the
+ * searched range and d is the dimensionality; so any two points in the same
+ * cell are at most r apart, and a query point only has to be compared with the
+ * points of the few cells around its own cell.  The grid is built by the first
+ * search, and again when the upper end of the range changes.
+ *
+ * The number of cells around a cell that have to be searched grows
+ * exponentially with the dimensionality, so this is only meant for
+ * low-dimensional data (in two or three dimensions it is usually much faster
+ * than a tree); a std::invalid_argument is thrown if there are too many.
+ *
+ * When used as the RangeSearchType of DBSCAN in batch mode, DBSCAN calls
+ * JoinNeighborhoods() instead of searching each point: all the points of a cell
+ * are joined without computing any distance, and two neighboring cells are
+ * joined as soon as one pair of their points is close enough.  The cells are
+ * divided between threads with OpenMP.
+ *
+ * The reference set is not copied, so it must stay alive while the object is
+ * used.
+ *
+ * @tparam MatType Type of data (a dense matrix).
+ */
+template<typename MatType = arma::mat>
+class GridRangeSearch
+{
+ public:
+  /**
+   * Create the GridRangeSearch object without a reference set; Train() must be
+   * called before searching.
+   */
+  GridRangeSearch();
+
+  /**
+   * Create the GridRangeSearch object with the given reference set.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  GridRangeSearch(const MatType& referenceSet);
+
+  /**
+   * Set the reference set.  The grid will be built by the next search.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(const MatType& referenceSet);
+
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, returning the results in neighbors and distances, in the same
+   * format as RangeSearch::Search().
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param neighbors Object which will hold the list of neighbors for each
+   *      query point.
+   * @param distances Object which will hold the list of distances for each
+   *      query point.
+   */
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances);
+
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, and call the given callback with each result, as
+   *
+   * @code
+   * callback(queryIndex, referenceIndex, distance);
+   * @endcode
+   *
+   * The query points are searched one after another by the calling thread.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Callback to call with each result.
+   */
+  template<typename CallbackType>
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              CallbackType& callback);
+
+  /**
+   * Join every two reference points that are at most epsilon apart in the
+   * given union-find structure, which must have an element for each reference
+   * point.  Pairs inside a cell, and pairs between two cells that have already
+   * been joined, are not compared, so the sets are the same as if each such
+   * pair were joined, but far fewer distances are computed.
+   *
+   * @param epsilon Maximum distance between two joined points.
+   * @param uf Union-find structure to join the points in.
+   */
+  void JoinNeighborhoods(const double epsilon, emst::ConcurrentUnionFind& uf);
+
+  //! Get the reference set.
+  const MatType& ReferenceSet() const { return *referenceSet; }
+
+  //! Get the number of non-empty cells of the grid (0 before the first
+  //! search).
+  size_t NumCells() const { return cellStarts.empty() ? 0 :
+      cellStarts.size() - 1; }
+
+  //! Get the number of distance computations during the last search.
+  size_t BaseCases() const { return baseCases; }
+
+ private:
+  //! The integer coordinates of a cell.
+  typedef std::vector<long long> CellCoordinates;
+
+  //! Hash function for cell coordinates.
+  struct CellHash
+  {
+    size_t operator()(const CellCoordinates& coordinates) const
+    {
+      return boost::hash_range(coordinates.begin(), coordinates.end());
+    }
+  };
+
+  //! The reference set.
+  const MatType* referenceSet;
+
+  //! The upper end of the range the grid was built for, or 0 if there is no
+  //! grid.
+  double gridRadius;
+  //! The side of each cell.
+  double cellSide;
+  //! The minimum of each dimension of the reference set.
+  arma::vec minimums;
+
+  //! The index of each non-empty cell.
+  std::unordered_map<CellCoordinates, size_t, CellHash> cellIndices;
+  //! The coordinates of each non-empty cell.
+  std::vector<CellCoordinates> cells;
+  //! The points of cell i are cellPoints[cellStarts[i]] up to (but not
+  //! including) cellPoints[cellStarts[i + 1]].
+  std::vector<size_t> cellStarts;
+  //! The reference points, ordered by cell.
+  std::vector<size_t> cellPoints;
+  //! The offsets of the cells which might hold points within gridRadius of a
+  //! point in a cell (including the cell itself).
+  std::vector<CellCoordinates> offsets;
+
+  //! The number of distance computations during the last search.
+  size_t baseCases;
+
+  //! Build the grid for the given radius, unless it is already built.
+  void BuildGrid(const double radius);
+
+  //! Compute the coordinates of the cell holding the given point.
+  template<typename VecType>
+  CellCoordinates Cell(const VecType& point) const;
+
+  //! Return the index of the cell with the given coordinates, or cells.size()
+  //! if that cell is empty.
+  size_t FindCell(const CellCoordinates& coordinates) const;
+
+  //! Call the given function with each reference point that lies in the range
+  //! of the given query point, and its distance, and return the number of
+  //! distance computations.
+  template<typename VecType, typename FunctionType>
+  size_t SearchPoint(const VecType& query,
+                     const math::Range& range,
+                     FunctionType&& function) const;
+};
+
+} // namespace dbscan
+} // namespace mlpack
+
+// Include implementation.
+#include "grid_range_search_impl.hpp"
+
+#endif
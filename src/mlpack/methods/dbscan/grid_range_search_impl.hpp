@@ -0,0 +1,373 @@
+/**
+ * @file grid_range_search_impl.hpp
+ *
+ * Implementation of GridRangeSearch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "grid_range_search.hpp"
+
+namespace mlpack {
+namespace dbscan {
+
+template<typename MatType>
+GridRangeSearch<MatType>::GridRangeSearch() :
+    referenceSet(NULL),
+    gridRadius(0.0),
+    cellSide(0.0),
+    baseCases(0)
+{
+  // Nothing to do.
+}
+
+template<typename MatType>
+GridRangeSearch<MatType>::GridRangeSearch(const MatType& referenceSet) :
+    referenceSet(&referenceSet),
+    gridRadius(0.0),
+    cellSide(0.0),
+    baseCases(0)
+{
+  // Nothing to do.
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::Train(const MatType& referenceSet)
+{
+  this->referenceSet = &referenceSet;
+
+  // The grid of the old reference set is useless now.
+  gridRadius = 0.0;
+  cellIndices.clear();
+  cells.clear();
+  cellStarts.clear();
+  cellPoints.clear();
+  offsets.clear();
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
+{
+  if (referenceSet == NULL)
+    throw std::invalid_argument("GridRangeSearch::Search(): no reference set "
+        "given; call Train() first!");
+  if (querySet.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "GridRangeSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality of the "
+        << "reference set (" << referenceSet->n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  BuildGrid(range.Hi());
+
+  neighbors.clear();
+  neighbors.resize(querySet.n_cols);
+  distances.clear();
+  distances.resize(querySet.n_cols);
+
+  // Each query point only writes its own results, so the query points can be
+  // searched by several threads.
+  size_t totalBaseCases = 0;
+  #pragma omp parallel for schedule(dynamic, 16) reduction(+:totalBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+  {
+    totalBaseCases += SearchPoint(querySet.col(i), range,
+        [&](const size_t j, const double distance)
+        {
+          neighbors[i].push_back(j);
+          distances[i].push_back(distance);
+        });
+  }
+
+  baseCases = totalBaseCases;
+}
+
+template<typename MatType>
+template<typename CallbackType>
+void GridRangeSearch<MatType>::Search(const MatType& querySet,
+                                      const math::Range& range,
+                                      CallbackType& callback)
+{
+  if (referenceSet == NULL)
+    throw std::invalid_argument("GridRangeSearch::Search(): no reference set "
+        "given; call Train() first!");
+  if (querySet.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "GridRangeSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality of the "
+        << "reference set (" << referenceSet->n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  BuildGrid(range.Hi());
+
+  baseCases = 0;
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    baseCases += SearchPoint(querySet.col(i), range,
+        [&](const size_t j, const double distance)
+        {
+          callback(i, j, distance);
+        });
+  }
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::JoinNeighborhoods(
+    const double epsilon,
+    emst::ConcurrentUnionFind& uf)
+{
+  if (referenceSet == NULL)
+    throw std::invalid_argument("GridRangeSearch::JoinNeighborhoods(): no "
+        "reference set given; call Train() first!");
+  if (uf.Size() != referenceSet->n_cols)
+    throw std::invalid_argument("GridRangeSearch::JoinNeighborhoods(): the "
+        "union-find structure must have an element for each reference point!");
+
+  BuildGrid(epsilon);
+
+  const size_t numCells = cells.size();
+
+  // No two points in a cell are more than epsilon apart, so the points of each
+  // cell are joined without computing distances.
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (omp_size_t c = 0; c < (omp_size_t) numCells; ++c)
+  {
+    for (size_t k = cellStarts[c] + 1; k < cellStarts[c + 1]; ++k)
+      uf.Union(cellPoints[cellStarts[c]], cellPoints[k]);
+  }
+
+  // Then each pair of neighboring cells is joined if any of their points are
+  // close enough.  Pairs of cells that already belong to the same set can be
+  // skipped, and the search stops at the first close pair of points.
+  size_t totalBaseCases = 0;
+  #pragma omp parallel for schedule(dynamic, 16) reduction(+:totalBaseCases)
+  for (omp_size_t c = 0; c < (omp_size_t) numCells; ++c)
+  {
+    CellCoordinates neighbor(cells[c].size());
+    for (size_t o = 0; o < offsets.size(); ++o)
+    {
+      for (size_t d = 0; d < neighbor.size(); ++d)
+        neighbor[d] = cells[c][d] + offsets[o][d];
+
+      // Each pair of cells is only considered once, from the cell with the
+      // smaller index.
+      const size_t n = FindCell(neighbor);
+      if (n == cells.size() || n <= (size_t) c)
+        continue;
+
+      if (uf.Find(cellPoints[cellStarts[c]]) ==
+          uf.Find(cellPoints[cellStarts[n]]))
+        continue;
+
+      bool joined = false;
+      for (size_t i = cellStarts[c]; i < cellStarts[c + 1] && !joined; ++i)
+      {
+        for (size_t j = cellStarts[n]; j < cellStarts[n + 1]; ++j)
+        {
+          ++totalBaseCases;
+          const double distance = metric::EuclideanDistance::Evaluate(
+              referenceSet->col(cellPoints[i]),
+              referenceSet->col(cellPoints[j]));
+          if (distance <= epsilon)
+          {
+            uf.Union(cellPoints[i], cellPoints[j]);
+            joined = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  baseCases = totalBaseCases;
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::BuildGrid(const double radius)
+{
+  if (radius <= 0.0 || !std::isfinite(radius))
+  {
+    std::ostringstream oss;
+    oss << "GridRangeSearch: the upper end of the search range (" << radius
+        << ") must be positive and finite!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (radius == gridRadius)
+    return;
+
+  const size_t dimensionality = referenceSet->n_rows;
+  if (dimensionality == 0)
+    throw std::invalid_argument("GridRangeSearch: the reference set must have "
+        "at least one dimension!");
+
+  // The diagonal of a cell is slightly shorter than the radius, so that no
+  // rounding of the coordinates can put two points that are more than the
+  // radius apart in the same cell.
+  cellSide = radius / std::sqrt((double) dimensionality) * (1.0 - 1e-8);
+
+  // Find the offsets of the cells that can hold points within the radius of a
+  // point in the center cell: the cells within m cells in each dimension,
+  // whose closest corners are within the radius.
+  const size_t m = (size_t) std::ceil(radius / cellSide);
+  const double numOffsets = std::pow(2.0 * m + 1.0, (double) dimensionality);
+  if (numOffsets > 1e5)
+  {
+    std::ostringstream oss;
+    oss << "GridRangeSearch: " << dimensionality << "-dimensional data needs "
+        << "too many neighboring cells; use a tree-based range search instead!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  offsets.clear();
+  CellCoordinates offset(dimensionality, -((long long) m));
+  while (true)
+  {
+    double minDistance = 0.0;
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const double gap = std::max(std::abs(offset[d]) - 1LL, 0LL) * cellSide;
+      minDistance += gap * gap;
+    }
+    if (minDistance <= radius * radius)
+      offsets.push_back(offset);
+
+    // Go to the next offset.
+    size_t d = 0;
+    while (d < dimensionality && offset[d] == (long long) m)
+      offset[d++] = -((long long) m);
+    if (d == dimensionality)
+      break;
+    ++offset[d];
+  }
+
+  // Find the cell of each point.
+  const size_t numPoints = referenceSet->n_cols;
+  minimums.set_size(dimensionality);
+  if (numPoints > 0)
+  {
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      minimums[d] = referenceSet->row(d).min();
+      const double extent = (referenceSet->row(d).max() - minimums[d]) /
+          cellSide;
+      if (!(extent < 1e18))
+      {
+        std::ostringstream oss;
+        oss << "GridRangeSearch: the reference set spans too many cells in "
+            << "dimension " << d << "!";
+        throw std::invalid_argument(oss.str());
+      }
+    }
+  }
+
+  cellIndices.clear();
+  cells.clear();
+  std::vector<size_t> pointCells(numPoints);
+  std::vector<size_t> counts;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    CellCoordinates cell = Cell(referenceSet->col(i));
+    auto it = cellIndices.find(cell);
+    if (it == cellIndices.end())
+    {
+      it = cellIndices.emplace(cell, cells.size()).first;
+      cells.push_back(std::move(cell));
+      counts.push_back(0);
+    }
+
+    pointCells[i] = it->second;
+    ++counts[it->second];
+  }
+
+  // Store the points of each cell contiguously.
+  cellStarts.assign(cells.size() + 1, 0);
+  for (size_t c = 0; c < cells.size(); ++c)
+    cellStarts[c + 1] = cellStarts[c] + counts[c];
+
+  cellPoints.resize(numPoints);
+  std::vector<size_t> next(cellStarts.begin(), cellStarts.end() - 1);
+  for (size_t i = 0; i < numPoints; ++i)
+    cellPoints[next[pointCells[i]]++] = i;
+
+  gridRadius = radius;
+}
+
+template<typename MatType>
+template<typename VecType>
+typename GridRangeSearch<MatType>::CellCoordinates
+GridRangeSearch<MatType>::Cell(const VecType& point) const
+{
+  // Query points can be far away from the reference set; their coordinates
+  // are clamped, which keeps them out of reach of every reference cell.
+  const double limit = 4e18;
+  CellCoordinates cell(point.n_elem);
+  for (size_t d = 0; d < point.n_elem; ++d)
+  {
+    const double c = std::floor((point[d] - minimums[d]) / cellSide);
+    cell[d] = std::isnan(c) ? (long long) limit :
+        (long long) std::min(std::max(c, -limit), limit);
+  }
+
+  return cell;
+}
+
+template<typename MatType>
+size_t GridRangeSearch<MatType>::FindCell(
+    const CellCoordinates& coordinates) const
+{
+  const auto it = cellIndices.find(coordinates);
+  return (it == cellIndices.end()) ? cells.size() : it->second;
+}
+
+template<typename MatType>
+template<typename VecType, typename FunctionType>
+size_t GridRangeSearch<MatType>::SearchPoint(const VecType& query,
+                                             const math::Range& range,
+                                             FunctionType&& function) const
+{
+  const CellCoordinates cell = Cell(query);
+  CellCoordinates neighbor(cell.size());
+
+  size_t numBaseCases = 0;
+  for (size_t o = 0; o < offsets.size(); ++o)
+  {
+    for (size_t d = 0; d < cell.size(); ++d)
+      neighbor[d] = cell[d] + offsets[o][d];
+
+    const size_t n = FindCell(neighbor);
+    if (n == cells.size())
+      continue;
+
+    for (size_t k = cellStarts[n]; k < cellStarts[n + 1]; ++k)
+    {
+      const size_t j = cellPoints[k];
+      const double distance = metric::EuclideanDistance::Evaluate(query,
+          referenceSet->col(j));
+      ++numBaseCases;
+      if (range.Contains(distance))
+        function(j, distance);
+    }
+  }
+
+  return numBaseCases;
+}
+
+} // namespace dbscan
+} // namespace mlpack
+
+#endif
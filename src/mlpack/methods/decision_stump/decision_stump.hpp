@@ -28,6 +28,9 @@ namespace decision_stump {
  * last bin has range up to \infty (split[i + 1] does not exist in that case).
  * Points that are below the first bin will take the label of the first bin.
  *
+ * During training, the candidate splitting dimensions are evaluated in
+ * parallel with OpenMP.
+ *
  * @tparam MatType Type of matrix that is being used (sparse or dense).
  */
 template<typename MatType = arma::mat>
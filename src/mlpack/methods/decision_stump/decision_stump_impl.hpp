@@ -104,30 +104,40 @@ void DecisionStump<MatType>::Train(const MatType& data,
 {
   // If classLabels are not all identical, proceed with training.
   size_t bestDim = 0;
-  double entropy;
   const double rootEntropy = CalculateEntropy<UseWeights>(labels, weights);
 
-  double gain, bestGain = 0.0;
-  for (size_t i = 0; i < data.n_rows; i++)
+  // The dimensions are independent, so they are evaluated in parallel.  Each
+  // dimension is copied out of the data once, since a row of a column-major
+  // matrix is not contiguous.
+  arma::vec gains(data.n_rows, arma::fill::zeros);
+  arma::Col<char> distinct(data.n_rows, arma::fill::zeros);
+  #pragma omp parallel for schedule(dynamic) if (data.n_rows > 1)
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_rows; i++)
   {
+    const arma::Row<typename MatType::elem_type> dimension = data.row(i);
+
     // Go through each dimension of the data.
-    if (IsDistinct(data.row(i)))
+    if (IsDistinct(dimension))
     {
       // For each dimension with non-identical values, treat it as a potential
       // splitting dimension and calculate entropy if split on it.
-      entropy = SetupSplitDimension<UseWeights>(data.row(i), labels, weights);
-
-      gain = rootEntropy - entropy;
-      // Find the dimension with the best entropy so that the gain is
-      // maximized.
+      distinct[i] = 1;
+      gains[i] = rootEntropy - SetupSplitDimension<UseWeights>(dimension,
+          labels, weights);
+    }
+  }
 
-      // We are maximizing gain, which is what is returned from
-      // SetupSplitDimension().
-      if (gain < bestGain)
-      {
-        bestDim = i;
-        bestGain = gain;
-      }
+  // Find the dimension with the best entropy so that the gain is maximized.
+  // We are maximizing gain, which is what is returned from
+  // SetupSplitDimension().  Ties go to the first dimension, as when the
+  // dimensions are evaluated one after another.
+  double bestGain = 0.0;
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    if (distinct[i] && gains[i] < bestGain)
+    {
+      bestDim = i;
+      bestGain = gains[i];
     }
   }
   splitDimension = bestDim;
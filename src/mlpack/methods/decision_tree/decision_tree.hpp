@@ -14,12 +14,18 @@
 #define MLPACK_METHODS_DECISION_TREE_DECISION_TREE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/feature_binning.hpp>
 #include "gini_gain.hpp"
 #include "best_binary_numeric_split.hpp"
+#include "histogram_numeric_split.hpp"
 #include "all_categorical_split.hpp"
 #include "all_dimension_select.hpp"
 #include <type_traits>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree {
 
@@ -259,6 +265,40 @@ class DecisionTree :
              const std::enable_if_t<arma::is_arma_type<typename
                  std::remove_reference<WeightsType>::type>::value>* = 0);
 
+  /**
+   * Train the decision tree on the points of the given dataset with the given
+   * indices, which may repeat (as in a bootstrap sample).  Unlike the other
+   * Train() overloads, the dataset is not copied: only a copy of the indices
+   * is reordered, so that many trees can be trained on the same dataset at
+   * once.  The tree is the same as if it were trained on the columns of the
+   * dataset given by the indices.  This will overwrite the existing model.
+   *
+   * The dataset does not have to hold doubles: each dimension of a node is
+   * converted when it is searched for a split, so the dataset can be stored as
+   * an arma::fmat, or as the arma::Mat<uint8_t> bins of a data::FeatureBinning
+   * (then call MapBinnedSplits() after training).
+   *
+   * @tparam UseWeights Whether the weights are used (or ignored).
+   * @tparam UseDatasetInfo Whether the types of the dimensions are given by
+   *     datasetInfo; if false, datasetInfo is ignored and all dimensions are
+   *     numeric.
+   * @param data Dataset to train on.
+   * @param indices Indices of the points of the dataset to train on.
+   * @param datasetInfo Type information for each dimension.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point of the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+  void Train(const MatType& data,
+             const arma::uvec& indices,
+             const data::DatasetInfo& datasetInfo,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const arma::rowvec& weights,
+             const size_t minimumLeafSize = 10);
+
   /**
    * Classify the given point, using the entire tree.  The predicted label is
    * returned.
@@ -284,7 +324,8 @@ class DecisionTree :
 
   /**
    * Classify the given points, using the entire tree.  The predicted labels for
-   * each point are stored in the given vector.
+   * each point are stored in the given vector.  The points are classified in
+   * parallel with OpenMP.
    *
    * @param data Set of points to classify.
    * @param predictions This will be filled with predictions for each point.
@@ -296,7 +337,8 @@ class DecisionTree :
   /**
    * Classify the given points and also return estimates of the probabilities
    * for each class in the given matrix.  The predicted labels for each point
-   * are stored in the given vector.
+   * are stored in the given vector.  The points are classified in parallel
+   * with OpenMP.
    *
    * @param data Set of points to classify.
    * @param predictions This will be filled with predictions for each point.
@@ -322,6 +364,18 @@ class DecisionTree :
   //! Modify the child of the given index (be careful!).
   DecisionTree& Child(const size_t i) { return *children[i]; }
 
+  //! Get the dimension this node splits on (only valid if it has children).
+  size_t SplitDimension() const { return splitDimension; }
+  //! Get the type of the dimension this node splits on (only valid if it has
+  //! children).
+  data::Datatype SplitDimensionType() const
+  { return (data::Datatype) dimensionTypeOrMajorityClass; }
+  //! Get the majority class of this node (only valid if it is a leaf).
+  size_t MajorityClass() const { return dimensionTypeOrMajorityClass; }
+  //! Get the class probabilities of this node if it is a leaf, or the split
+  //! information of its split type if it has children.
+  const arma::vec& ClassProbabilities() const { return classProbabilities; }
+
   /**
    * Given a point and that this node is not a leaf, calculate the index of the
    * child node this point would go towards.  This method is primarily used by
@@ -332,6 +386,19 @@ class DecisionTree :
   template<typename VecType>
   size_t CalculateDirection(const VecType& point) const;
 
+  /**
+   * Map the split values of a tree that was trained on the bins of the given
+   * binning (see data::FeatureBinning) to values of the dimensions, so that
+   * the tree classifies the original data (and not the bins) the way it
+   * classifies the bins it was trained on.  The numeric split must be a
+   * threshold split that holds its split value in ClassProbabilities()[0],
+   * such as BestBinaryNumericSplit and HistogramNumericSplit; categorical
+   * splits are not changed.  This must only be called once.
+   *
+   * @param binning The binning of the training data.
+   */
+  void MapBinnedSplits(const data::FeatureBinning& binning);
+
   /**
    * Get the number of classes in the tree.
    */
@@ -415,6 +482,48 @@ class DecisionTree :
              const size_t numClasses,
              arma::rowvec& weights,
              const size_t minimumLeafSize = 10);
+
+  /**
+   * Corresponding to the public Train() method on indices, this method trains
+   * the node on the points with the indices in the range [begin, begin +
+   * count), which are reordered for the children; the dataset, labels and
+   * weights are not modified.
+   *
+   * @param data Dataset to train on.
+   * @param indices Indices of the points of each node.
+   * @param begin Position of the first index that belongs to this node.
+   * @param count Number of points in this node.
+   * @param datasetInfo Type information for each dimension.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point of the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   */
+  template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+  void Train(const MatType& data,
+             arma::uvec& indices,
+             const size_t begin,
+             const size_t count,
+             const data::DatasetInfo& datasetInfo,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const arma::rowvec& weights,
+             const size_t minimumLeafSize);
+
+  /**
+   * Train the children of a node with trainChild(i) for each child i.  The
+   * children hold disjoint ranges of the points, so if parallel is true, the
+   * large ones are grown as OpenMP tasks; the tree is the same as with serial
+   * training.
+   *
+   * @param childCounts Number of points of each child.
+   * @param parallel Whether the children may be grown in parallel.
+   * @param trainChild Function that trains the given child.
+   */
+  template<typename TrainChildType>
+  static void TrainChildren(const std::vector<size_t>& childCounts,
+                            const bool parallel,
+                            const TrainChildType& trainChild);
 };
 
 /**
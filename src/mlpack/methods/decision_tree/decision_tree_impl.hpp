@@ -504,6 +504,61 @@ void DecisionTree<FitnessFunction,
       minimumLeafSize);
 }
 
+//! Train on the points with the given indices.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::Train(const MatType& data,
+                                      const arma::uvec& indices,
+                                      const data::DatasetInfo& datasetInfo,
+                                      const arma::Row<size_t>& labels,
+                                      const size_t numClasses,
+                                      const arma::rowvec& weights,
+                                      const size_t minimumLeafSize)
+{
+  // Sanity checks on data.
+  if (data.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::Train(): number of points (" << data.n_cols << ") "
+        << "does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (UseWeights && data.n_cols != weights.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::Train(): number of points (" << data.n_cols << ") "
+        << "does not match number of weights (" << weights.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (indices.n_elem > 0 && indices.max() >= data.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "DecisionTree::Train(): index " << indices.max() << " is out of "
+        << "range for a dataset with " << data.n_cols << " points!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Only the indices are reordered.
+  arma::uvec tmpIndices(indices);
+  Train<UseWeights, UseDatasetInfo>(data, tmpIndices, 0, tmpIndices.n_elem,
+      datasetInfo, labels, numClasses, weights, minimumLeafSize);
+}
+
 //! Train on the given data.
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
@@ -542,8 +597,81 @@ void DecisionTree<FitnessFunction,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = datasetInfo.Dimensionality(); // This means "no split".
   DimensionSelectionType dimensions(datasetInfo.Dimensionality());
-  for (size_t i = dimensions.Begin(); i != dimensions.End();
-       i = dimensions.Next())
+
+  // At large nodes, the candidate dimensions are searched in parallel, each
+  // into its own split information.  Then the results are taken in the order
+  // of the dimensions, as the serial search does; the split functions only
+  // compare with bestGain to decide whether to keep a split, so the result is
+  // the same.
+  bool parallelSearch = false;
+  #ifdef HAS_OPENMP
+  parallelSearch = ParallelThreads() > 1 &&
+      count * datasetInfo.Dimensionality() >= 100000;
+  #endif
+  if (parallelSearch)
+  {
+    std::vector<size_t> candidates;
+    for (size_t i = dimensions.Begin(); i != dimensions.End();
+         i = dimensions.Next())
+      candidates.push_back(i);
+
+    std::vector<double> gains(candidates.size(), -DBL_MAX);
+    std::vector<arma::vec> probabilities(candidates.size());
+    std::vector<NumericAuxiliarySplitInfo> numericAux(candidates.size());
+    std::vector<CategoricalAuxiliarySplitInfo> categoricalAux(
+        candidates.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t c = 0; c < (omp_size_t) candidates.size(); ++c)
+    {
+      const size_t i = candidates[c];
+      if (datasetInfo.Type(i) == data::Datatype::categorical)
+      {
+        gains[c] = CategoricalSplit::template SplitIfBetter<UseWeights>(
+            bestGain,
+            data.cols(begin, begin + count - 1).row(i),
+            datasetInfo.NumMappings(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            probabilities[c],
+            categoricalAux[c]);
+      }
+      else if (datasetInfo.Type(i) == data::Datatype::numeric)
+      {
+        gains[c] = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
+            data.cols(begin, begin + count - 1).row(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            probabilities[c],
+            numericAux[c]);
+      }
+    }
+
+    for (size_t c = 0; c < candidates.size(); ++c)
+    {
+      if (gains[c] > bestGain)
+      {
+        bestDim = candidates[c];
+        bestGain = gains[c];
+        classProbabilities = probabilities[c];
+        if (datasetInfo.Type(bestDim) == data::Datatype::categorical)
+          CategoricalAuxiliarySplitInfo::operator=(categoricalAux[c]);
+        else
+          NumericAuxiliarySplitInfo::operator=(numericAux[c]);
+      }
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
+    }
+  }
+
+  for (size_t i = parallelSearch ? dimensions.End() : dimensions.Begin();
+       i != dimensions.End(); i = dimensions.Next())
   {
     double dimGain = -DBL_MAX;
     if (datasetInfo.Type(i) == data::Datatype::categorical)
@@ -618,11 +746,12 @@ void DecisionTree<FitnessFunction,
       childCounts[childAssignments[i - begin]]++;
 
     // Split into children.
+    std::vector<size_t> childBegins(numChildren), childSizes(numChildren);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = currentCol; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -634,23 +763,22 @@ void DecisionTree<FitnessFunction,
           ++currentCol;
         }
       }
-
-      // Now build the child recursively.
-      DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, currentCol - currentChildBegin);
-      }
-      else
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, minimumLeafSize);
-      }
-      children.push_back(child);
+      childSizes[i] = currentCol - childBegins[i];
+      children.push_back(new DecisionTree());
     }
+
+    // Now build the children recursively.  A random dimension selection
+    // would draw its dimensions in a different order if the children were
+    // grown in parallel, so only the default selection is.
+    const auto trainChild = [&](const size_t i)
+    {
+      children[i]->template Train<UseWeights>(data, childBegins[i],
+          childSizes[i], datasetInfo, labels, numClasses, weights,
+          NoRecursion ? childSizes[i] : minimumLeafSize);
+    };
+    TrainChildren(childSizes, !NoRecursion &&
+        std::is_same<DimensionSelectionType, AllDimensionSelect>::value,
+        trainChild);
   }
   else
   {
@@ -705,7 +833,54 @@ void DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = data.n_rows; // This means "no split".
-  for (size_t i = 0; i < data.n_rows; ++i)
+
+  // At large nodes, the dimensions are searched in parallel, each into its own
+  // split information, and the results are taken in the order of the
+  // dimensions, as the serial search does.
+  bool parallelSearch = false;
+  #ifdef HAS_OPENMP
+  parallelSearch = ParallelThreads() > 1 &&
+      count * data.n_rows >= 100000;
+  #endif
+  if (parallelSearch)
+  {
+    std::vector<double> gains(data.n_rows, -DBL_MAX);
+    std::vector<arma::vec> probabilities(data.n_rows);
+    std::vector<NumericAuxiliarySplitInfo> numericAux(data.n_rows);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) data.n_rows; ++i)
+    {
+      gains[i] = NumericSplitType<FitnessFunction>::template
+          SplitIfBetter<UseWeights>(bestGain,
+                                    data.cols(begin, begin + count - 1).row(i),
+                                    labels.cols(begin, begin + count - 1),
+                                    numClasses,
+                                    UseWeights ?
+                                        weights.cols(begin, begin + count - 1) :
+                                        weights,
+                                    minimumLeafSize,
+                                    probabilities[i],
+                                    numericAux[i]);
+    }
+
+    for (size_t i = 0; i < data.n_rows; ++i)
+    {
+      if (gains[i] > bestGain)
+      {
+        bestDim = i;
+        bestGain = gains[i];
+        classProbabilities = probabilities[i];
+        NumericAuxiliarySplitInfo::operator=(numericAux[i]);
+      }
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
+    }
+  }
+
+  for (size_t i = 0; !parallelSearch && i < data.n_rows; ++i)
   {
     const double dimGain = NumericSplitType<FitnessFunction>::template
         SplitIfBetter<UseWeights>(bestGain,
@@ -753,11 +928,12 @@ void DecisionTree<FitnessFunction,
     for (size_t j = begin; j < begin + count; ++j)
       childCounts[childAssignments[j - begin]]++;
 
+    std::vector<size_t> childBegins(numChildren), childSizes(numChildren);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = currentCol; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -769,23 +945,19 @@ void DecisionTree<FitnessFunction,
           ++currentCol;
         }
       }
-
-      // Now build the child recursively.
-      DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            currentCol - currentChildBegin);
-      }
-      else
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            minimumLeafSize);
-      }
-      children.push_back(child);
+      childSizes[i] = currentCol - childBegins[i];
+      children.push_back(new DecisionTree());
     }
+
+    // Now build the children recursively.  Every dimension is searched here,
+    // so the children can always be grown in parallel.
+    const auto trainChild = [&](const size_t i)
+    {
+      children[i]->template Train<UseWeights>(data, childBegins[i],
+          childSizes[i], labels, numClasses, weights,
+          NoRecursion ? childSizes[i] : minimumLeafSize);
+    };
+    TrainChildren(childSizes, !NoRecursion, trainChild);
   }
   else
   {
@@ -800,6 +972,177 @@ void DecisionTree<FitnessFunction,
   }
 }
 
+//! Train on the points with the given range of indices.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, bool UseDatasetInfo, typename MatType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::Train(const MatType& data,
+                                      arma::uvec& indices,
+                                      const size_t begin,
+                                      const size_t count,
+                                      const data::DatasetInfo& datasetInfo,
+                                      const arma::Row<size_t>& labels,
+                                      const size_t numClasses,
+                                      const arma::rowvec& weights,
+                                      const size_t minimumLeafSize)
+{
+  // Clear children if needed.
+  for (size_t i = 0; i < children.size(); ++i)
+    delete children[i];
+  children.clear();
+
+  // Gather the labels and weights of the points of this node, in the order of
+  // their indices; the dimensions are gathered one at a time below.
+  arma::Row<size_t> nodeLabels(count);
+  arma::rowvec nodeWeights(UseWeights ? count : 0);
+  for (size_t j = 0; j < count; ++j)
+  {
+    nodeLabels[j] = labels[indices[begin + j]];
+    if (UseWeights)
+      nodeWeights[j] = weights[indices[begin + j]];
+  }
+
+  // Find the best split as the other Train() methods do: over the dimensions
+  // given by DimensionSelectionType if we have type information, and over all
+  // the (numeric) dimensions otherwise.
+  double bestGain = FitnessFunction::template Evaluate<UseWeights>(nodeLabels,
+      numClasses, nodeWeights);
+  size_t bestDim = data.n_rows; // This means "no split".
+  // The values are gathered as doubles, whatever the type of the dataset.
+  arma::rowvec values(count);
+  const auto searchDimension = [&](const size_t i)
+  {
+    for (size_t j = 0; j < count; ++j)
+      values[j] = data(i, indices[begin + j]);
+
+    double dimGain = -DBL_MAX;
+    if (UseDatasetInfo &&
+        datasetInfo.Type(i) == data::Datatype::categorical)
+    {
+      dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
+          values, datasetInfo.NumMappings(i), nodeLabels, numClasses,
+          nodeWeights, minimumLeafSize, classProbabilities, *this);
+    }
+    else if (!UseDatasetInfo ||
+        datasetInfo.Type(i) == data::Datatype::numeric)
+    {
+      dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
+          values, nodeLabels, numClasses, nodeWeights, minimumLeafSize,
+          classProbabilities, *this);
+    }
+
+    // Was there an improvement?  If so mark that it's the new best dimension.
+    if (dimGain > bestGain)
+    {
+      bestDim = i;
+      bestGain = dimGain;
+    }
+
+    // If the gain is the best possible, no need to keep looking.
+    return (bestGain >= 0.0);
+  };
+
+  if (UseDatasetInfo)
+  {
+    DimensionSelectionType dimensions(datasetInfo.Dimensionality());
+    for (size_t i = dimensions.Begin(); i != dimensions.End();
+         i = dimensions.Next())
+    {
+      if (searchDimension(i))
+        break;
+    }
+  }
+  else
+  {
+    // We won't be using these members, so reset them.
+    CategoricalAuxiliarySplitInfo::operator=(CategoricalAuxiliarySplitInfo());
+
+    for (size_t i = 0; i < data.n_rows; ++i)
+    {
+      if (searchDimension(i))
+        break;
+    }
+  }
+
+  // Did we split or not?  If so, then split the indices and create the
+  // children.
+  if (bestDim != data.n_rows)
+  {
+    const bool categorical = UseDatasetInfo &&
+        (datasetInfo.Type(bestDim) == data::Datatype::categorical);
+    dimensionTypeOrMajorityClass = (size_t) (categorical ?
+        data::Datatype::categorical : data::Datatype::numeric);
+    splitDimension = bestDim;
+
+    // Get the number of children we will have.
+    const size_t numChildren = categorical ?
+        CategoricalSplit::NumChildren(classProbabilities, *this) :
+        NumericSplit::NumChildren(classProbabilities, *this);
+
+    // Calculate all child assignments.
+    arma::Row<size_t> childAssignments(count);
+    for (size_t j = 0; j < count; ++j)
+    {
+      const double value = data(bestDim, indices[begin + j]);
+      childAssignments[j] = categorical ?
+          CategoricalSplit::CalculateDirection(value, classProbabilities,
+              *this) :
+          NumericSplit::CalculateDirection(value, classProbabilities, *this);
+    }
+
+    // Split the indices into children, in the same order as the other Train()
+    // methods reorder the points.
+    std::vector<size_t> childBegins(numChildren), childSizes(numChildren);
+    size_t current = begin;
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      childBegins[i] = current;
+      for (size_t j = current; j < begin + count; ++j)
+      {
+        if (childAssignments[j - begin] == i)
+        {
+          childAssignments.swap_cols(current - begin, j - begin);
+          indices.swap_rows(current, j);
+          ++current;
+        }
+      }
+      childSizes[i] = current - childBegins[i];
+      children.push_back(new DecisionTree());
+    }
+
+    // Now build the children recursively.  As in the other Train() methods,
+    // random dimension selections keep the children serial.
+    const auto trainChild = [&](const size_t i)
+    {
+      children[i]->template Train<UseWeights, UseDatasetInfo>(data, indices,
+          childBegins[i], childSizes[i], datasetInfo, labels, numClasses,
+          weights, NoRecursion ? childSizes[i] : minimumLeafSize);
+    };
+    TrainChildren(childSizes, !NoRecursion && (!UseDatasetInfo ||
+        std::is_same<DimensionSelectionType, AllDimensionSelect>::value),
+        trainChild);
+  }
+  else
+  {
+    // Clear auxiliary info objects.
+    NumericAuxiliarySplitInfo::operator=(NumericAuxiliarySplitInfo());
+    CategoricalAuxiliarySplitInfo::operator=(CategoricalAuxiliarySplitInfo());
+
+    // Calculate class probabilities because we are a leaf.
+    CalculateClassProbabilities<UseWeights>(nodeLabels, numClasses,
+        nodeWeights);
+  }
+}
+
 //! Return the class.
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
@@ -876,7 +1219,8 @@ void DecisionTree<FitnessFunction,
   }
 
   // Loop over each point.
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
     predictions[i] = Classify(data.col(i));
 }
 
@@ -912,7 +1256,8 @@ void DecisionTree<FitnessFunction,
     node = &node->Child(0);
   probabilities.set_size(node->classProbabilities.n_elem, data.n_cols);
 
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
   {
     arma::vec v = probabilities.unsafe_col(i); // Alias of column.
     Classify(data.col(i), predictions[i], v);
@@ -982,13 +1327,57 @@ size_t DecisionTree<FitnessFunction,
                     ElemType,
                     NoRecursion>::CalculateDirection(const VecType& point) const
 {
+  // The split information is held as doubles, so the value is converted for
+  // points of other types.
+  const double value = point[splitDimension];
   if ((data::Datatype) dimensionTypeOrMajorityClass ==
       data::Datatype::categorical)
-    return CategoricalSplit::CalculateDirection(point[splitDimension],
-        classProbabilities, *this);
+    return CategoricalSplit::CalculateDirection(value, classProbabilities,
+        *this);
   else
-    return NumericSplit::CalculateDirection(point[splitDimension],
-        classProbabilities, *this);
+    return NumericSplit::CalculateDirection(value, classProbabilities, *this);
+}
+
+// Map the split values from bins to the values of the dimensions.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::MapBinnedSplits(
+    const data::FeatureBinning& binning)
+{
+  if (children.empty())
+    return;
+
+  if ((data::Datatype) dimensionTypeOrMajorityClass ==
+      data::Datatype::numeric)
+  {
+    if (splitDimension >= binning.Dimensionality())
+    {
+      std::ostringstream oss;
+      oss << "DecisionTree::MapBinnedSplits(): the tree splits on dimension "
+          << splitDimension << ", but the binning has only "
+          << binning.Dimensionality() << " dimensions!";
+      throw std::invalid_argument(oss.str());
+    }
+
+    // The points in the bins up to the integer part of the split value go
+    // left, which are the values up to the upper edge of that bin.  There is
+    // always a nonempty bin after it, so it is not the last bin.
+    const size_t bin = (size_t) std::floor(classProbabilities[0]);
+    classProbabilities[0] = binning.Threshold(splitDimension,
+        std::min(bin, binning.Bins(splitDimension) - 2));
+  }
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->MapBinnedSplits(binning);
 }
 
 // Get the number of classes in the tree.
@@ -1013,6 +1402,61 @@ size_t DecisionTree<FitnessFunction,
     return children[0]->NumClasses();
 }
 
+//! Train the children of a node, in parallel if possible.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename TrainChildType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::TrainChildren(
+    const std::vector<size_t>& childCounts,
+    const bool parallel,
+    const TrainChildType& trainChild)
+{
+  #ifdef HAS_OPENMP
+  // Children smaller than this are trained by the task of their parent, since
+  // the overhead of a task would be larger than the work.
+  const size_t minimumTaskSize = 512;
+
+  if (parallel && omp_in_parallel())
+  {
+    // We are already inside the tasks of a parent, so each large child gets
+    // its own task.
+    const TrainChildType* trainer = &trainChild;
+    for (size_t i = 0; i < childCounts.size(); ++i)
+    {
+      #pragma omp task firstprivate(trainer, i) \
+          if(childCounts[i] >= minimumTaskSize)
+      (*trainer)(i);
+    }
+    #pragma omp taskwait
+    return;
+  }
+  else if (parallel && ParallelThreads() > 1)
+  {
+    // Create the threads that run the tasks of the whole subtree.
+    #pragma omp parallel num_threads(ParallelThreads())
+    {
+      #pragma omp single
+      TrainChildren(childCounts, parallel, trainChild);
+    }
+    return;
+  }
+  #else
+  (void) parallel;
+  #endif
+
+  for (size_t i = 0; i < childCounts.size(); ++i)
+    trainChild(i);
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType,
@@ -175,6 +175,30 @@ class GiniGain
     return -impurity;
   }
 
+  /**
+   * Evaluate the Gini impurity of a set of points from the (possibly weighted)
+   * number of points of each class.  This is used by HistogramNumericSplit.
+   *
+   * @param counts Number or weight of the points of each class.
+   */
+  static double EvaluateCounts(const arma::vec& counts)
+  {
+    const double total = arma::accu(counts);
+
+    // Corner case: if there are no elements, the impurity is zero.
+    if (total == 0.0)
+      return 0.0;
+
+    double impurity = 0.0;
+    for (size_t i = 0; i < counts.n_elem; ++i)
+    {
+      const double f = counts[i] / total;
+      impurity += f * (1.0 - f);
+    }
+
+    return -impurity;
+  }
+
   /**
    * Return the range of the Gini impurity for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
@@ -0,0 +1,156 @@
+/**
+ * @file histogram_numeric_split_impl.hpp
+ *
+ * Implementation of the strategy that finds the best binary numeric split
+ * among the boundaries of a histogram.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction>
+template<bool UseWeights, typename VecType, typename WeightVecType>
+double HistogramNumericSplit<FitnessFunction>::SplitIfBetter(
+    const double bestGain,
+    const VecType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    const size_t minimumLeafSize,
+    arma::Col<typename VecType::elem_type>& classProbabilities,
+    AuxiliarySplitInfo<typename VecType::elem_type>& /* aux */)
+{
+  typedef typename VecType::elem_type ElemType;
+
+  // First sanity check: if we don't have enough points, we can't split.
+  if (data.n_elem < (minimumLeafSize * 2))
+    return bestGain;
+
+  // The bucket boundaries are the quantiles of a strided sample of the points.
+  // A point is in the bucket of the first boundary that is not smaller than
+  // it, or in the last bucket if there is none.  With at most MaxBins points,
+  // every distinct value is a boundary.
+  const size_t n = data.n_elem;
+  const size_t sampleSize = std::min(n, 4 * MaxBins);
+  std::vector<ElemType> sample(sampleSize);
+  for (size_t i = 0; i < sampleSize; ++i)
+    sample[i] = data[(i * n) / sampleSize];
+  std::sort(sample.begin(), sample.end());
+
+  std::vector<ElemType> boundaries;
+  boundaries.reserve(MaxBins - 1);
+  for (size_t b = 0; b < MaxBins - 1; ++b)
+  {
+    const size_t index = (sampleSize <= MaxBins) ? b :
+        ((b + 1) * sampleSize) / MaxBins;
+    if (index >= sampleSize)
+      break;
+    if (boundaries.empty() || sample[index] != boundaries.back())
+      boundaries.push_back(sample[index]);
+  }
+
+  // Accumulate the class counts (or weights), the number of points and the
+  // range of values of each bucket, in one pass.
+  const size_t numBins = boundaries.size() + 1;
+  arma::mat counts(numClasses, numBins, arma::fill::zeros);
+  std::vector<size_t> binPoints(numBins, 0);
+  std::vector<ElemType> binMin(numBins, std::numeric_limits<ElemType>::max());
+  std::vector<ElemType> binMax(numBins,
+      std::numeric_limits<ElemType>::lowest());
+  for (size_t i = 0; i < n; ++i)
+  {
+    const ElemType value = data[i];
+    const size_t bin = std::lower_bound(boundaries.begin(), boundaries.end(),
+        value) - boundaries.begin();
+    counts(labels[i], bin) += UseWeights ? (double) weights[i] : 1.0;
+    ++binPoints[bin];
+    binMin[bin] = std::min(binMin[bin], value);
+    binMax[bin] = std::max(binMax[bin], value);
+  }
+
+  const arma::vec totalCounts = arma::sum(counts, 1);
+  const double totalWeight = arma::accu(totalCounts);
+  if (totalWeight == 0.0)
+    return bestGain;
+
+  // Now try a split after each nonempty bucket that has a nonempty bucket
+  // after it.  Force a minimum leaf size of 1 (empty children don't make
+  // sense).
+  double bestFoundGain = bestGain;
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+  arma::vec leftCounts(numClasses, arma::fill::zeros);
+  size_t leftPoints = 0;
+  size_t bin = 0;
+  while (bin < numBins && binPoints[bin] == 0)
+    ++bin;
+  while (bin < numBins)
+  {
+    size_t next = bin + 1;
+    while (next < numBins && binPoints[next] == 0)
+      ++next;
+    if (next == numBins)
+      break;
+
+    leftCounts += counts.col(bin);
+    leftPoints += binPoints[bin];
+    const ElemType leftMax = binMax[bin];
+    bin = next;
+
+    if (leftPoints < minimum || n - leftPoints < minimum)
+      continue;
+
+    // The counts of the right child are the rest of the counts of the node.
+    const arma::vec rightCounts = totalCounts - leftCounts;
+    const double leftWeight = arma::accu(leftCounts);
+    const double rightWeight = totalWeight - leftWeight;
+    const double gain = (leftWeight / totalWeight) *
+        FitnessFunction::EvaluateCounts(leftCounts) +
+        (rightWeight / totalWeight) *
+        FitnessFunction::EvaluateCounts(rightCounts);
+
+    // The split value is halfway between the largest value on the left and
+    // the smallest value on the right.
+    if (gain >= 0.0)
+    {
+      // We can take a shortcut: no split will be better than this, so just take
+      // this one.
+      classProbabilities.set_size(1);
+      classProbabilities[0] = (leftMax + binMin[next]) / 2.0;
+      return gain;
+    }
+    else if (gain > bestFoundGain)
+    {
+      // We still have a better split.
+      bestFoundGain = gain;
+      classProbabilities.set_size(1);
+      classProbabilities[0] = (leftMax + binMin[next]) / 2.0;
+    }
+  }
+
+  return bestFoundGain;
+}
+
+template<typename FitnessFunction>
+template<typename ElemType>
+size_t HistogramNumericSplit<FitnessFunction>::CalculateDirection(
+    const ElemType& point,
+    const arma::Col<ElemType>& classProbabilities,
+    const AuxiliarySplitInfo<ElemType>& /* aux */)
+{
+  if (point <= classProbabilities[0])
+    return 0; // Go left.
+  else
+    return 1; // Go right.
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
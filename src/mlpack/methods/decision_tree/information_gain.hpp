@@ -172,6 +172,32 @@ class InformationGain
     return gain;
   }
 
+  /**
+   * Calculate the information gain of a set of points from the (possibly
+   * weighted) number of points of each class.  This is used by
+   * HistogramNumericSplit.
+   *
+   * @param counts Number or weight of the points of each class.
+   */
+  static double EvaluateCounts(const arma::vec& counts)
+  {
+    const double total = arma::accu(counts);
+
+    // Edge case: if there are no elements, the gain is zero.
+    if (total == 0.0)
+      return 0.0;
+
+    double gain = 0.0;
+    for (size_t i = 0; i < counts.n_elem; ++i)
+    {
+      const double f = counts[i] / total;
+      if (f > 0.0)
+        gain += f * std::log2(f);
+    }
+
+    return gain;
+  }
+
   /**
    * Return the range of the information gain for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
@@ -179,13 +179,17 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
   arma::vec regularizationConstants(prunedSequence.size());
   regularizationConstants.fill(0.0);
 
+  // The results of each fold are kept, and summed in the order of the folds
+  // afterwards, so that they do not depend on the number of threads.
+  std::vector<arma::vec> foldConstants(folds);
+
   Timer::Start("cross_validation");
   // Go through each fold.  On the Visual Studio compiler, we have to use
   // intmax_t because size_t is not yet supported by their OpenMP
   // implementation. omp_size_t is the appropriate type according to the
   // platform.
-  #pragma omp parallel for default(none) \
-      shared(prunedSequence, regularizationConstants)
+  #pragma omp parallel for num_threads(ParallelThreads()) default(none) \
+      shared(prunedSequence, foldConstants)
   for (omp_size_t fold = 0; fold < (omp_size_t) folds; fold++)
   {
     // Break up data into train and test sets.
@@ -225,8 +229,8 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
     // Sequentially prune with all the values of available alphas and adding
     // values for test values.  Don't enter this loop if there are less than two
     // trees in the pruned sequence.
-    arma::vec cvRegularizationConstants(prunedSequence.size());
-    cvRegularizationConstants.fill(0.0);
+    arma::vec& cvRegularizationConstants = foldConstants[fold];
+    cvRegularizationConstants.zeros(prunedSequence.size());
     for (size_t i = 0;
          i < ((prunedSequence.size() < 2) ? 0 : prunedSequence.size() - 2); ++i)
     {
@@ -258,10 +262,10 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
     if (prunedSequence.size() > 2)
       cvRegularizationConstants[prunedSequence.size() - 2] += 2.0 * cvVal
         / (double) cvData.n_cols;
-
-    #pragma omp critical(DTreeCVUpdate)
-    regularizationConstants += cvRegularizationConstants;
   }
+
+  for (size_t fold = 0; fold < folds; ++fold)
+    regularizationConstants += foldConstants[fold];
   Timer::Stop("cross_validation");
 
   double optimalAlpha = -1.0;
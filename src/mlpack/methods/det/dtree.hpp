@@ -15,6 +15,10 @@
 
 #include <mlpack/prereqs.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace det /** Density Estimation Trees */ {
 
@@ -181,6 +185,16 @@ class DTree
    */
   double ComputeValue(const VecType& query) const;
 
+  /**
+   * Compute the density estimate of each of the given query points.  The
+   * queries are evaluated in parallel with OpenMP, and each one gives the same
+   * value as ComputeValue() on the single point.
+   *
+   * @param queries Points to estimate density of, one per column.
+   * @param values Will be set to the density estimate of each point.
+   */
+  void ComputeValue(const MatType& queries, arma::rowvec& values) const;
+
   /**
    * Index the buckets for possible usage later; this results in every leaf in
    * the tree having a specific tag (accessible with BucketTag()).  This
@@ -344,6 +358,18 @@ class DTree
                  double& rightError,
                  const size_t minLeafSize = 5) const;
 
+  /**
+   * Grow the two children of this node, whose ranges of points are disjoint,
+   * in parallel with OpenMP tasks if the node is large enough.
+   */
+  void GrowChildren(MatType& data,
+                    arma::Col<size_t>& oldFromNew,
+                    const bool useVolReg,
+                    const size_t maxLeafSize,
+                    const size_t minLeafSize,
+                    double& leftG,
+                    double& rightG);
+
   /**
    * Split the data, returning the number of points left of the split.
    */
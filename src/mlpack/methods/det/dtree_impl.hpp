@@ -453,14 +453,21 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
   double minError = logNegError;
   bool splitFound = false;
 
-  // Loop through each dimension.
-#ifdef _WIN32
-  #pragma omp parallel for default(shared)
-  for (intmax_t dim = 0; dim < (intmax_t) maxVals.n_elem; ++dim)
-#else
-  #pragma omp parallel for default(shared)
-  for (size_t dim = 0; dim < maxVals.n_elem; ++dim)
-#endif
+  // The best split of each dimension; the dimensions are searched in parallel,
+  // and then the best one is taken in order, so that ties are broken the same
+  // way no matter how the search was scheduled.
+  std::vector<char> dimSplitsFound(maxVals.n_elem, 0);
+  std::vector<double> dimMinErrors(maxVals.n_elem);
+  std::vector<double> dimLeftErrors(maxVals.n_elem);
+  std::vector<double> dimRightErrors(maxVals.n_elem);
+  std::vector<ElemType> dimSplitValues(maxVals.n_elem);
+
+  // Loop through each dimension.  Small nodes are searched serially, since
+  // the work would not pay for the threads.
+  #pragma omp parallel for num_threads(ParallelThreads()) \
+      default(shared) schedule(dynamic) \
+      if (points * maxVals.n_elem >= 10000)
+  for (omp_size_t dim = 0; dim < (omp_size_t) maxVals.n_elem; ++dim)
   {
     const ElemType min = minVals[dim];
     const ElemType max = maxVals[dim];
@@ -528,22 +535,30 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
       }
     }
 
-    const double actualMinDimError = std::log(minDimError)
+    // Calculate actual error (in logspace) by adding terms back to our
+    // estimate.
+    dimSplitsFound[dim] = dimSplitFound;
+    dimMinErrors[dim] = std::log(minDimError)
+      - 2 * std::log((double) data.n_cols)
+      - volumeWithoutDim;
+    dimSplitValues[dim] = dimSplitValue;
+    dimLeftErrors[dim] = std::log(dimLeftError)
+      - 2 * std::log((double) data.n_cols)
+      - volumeWithoutDim;
+    dimRightErrors[dim] = std::log(dimRightError)
       - 2 * std::log((double) data.n_cols)
       - volumeWithoutDim;
+  }
 
-#pragma omp critical(DTreeFindUpdate)
-    if ((actualMinDimError > minError) && dimSplitFound)
+  for (size_t dim = 0; dim < maxVals.n_elem; ++dim)
+  {
+    if ((dimMinErrors[dim] > minError) && dimSplitsFound[dim])
     {
-      // Calculate actual error (in logspace) by adding terms back to our
-      // estimate.
-      minError = actualMinDimError;
+      minError = dimMinErrors[dim];
       splitDim = dim;
-      splitValue = dimSplitValue;
-      leftError = std::log(dimLeftError) - 2 * std::log((double) data.n_cols)
-        - volumeWithoutDim;
-      rightError = std::log(dimRightError) - 2 * std::log((double) data.n_cols)
-        - volumeWithoutDim;
+      splitValue = dimSplitValues[dim];
+      leftError = dimLeftErrors[dim];
+      rightError = dimRightErrors[dim];
       splitFound = true;
     } // end if better split found in this dimension.
   }
@@ -637,10 +652,8 @@ double DTree<MatType, TagType>::Grow(MatType& data,
       left = new DTree(maxValsL, minValsL, start, splitIndex, leftError);
       right = new DTree(maxValsR, minValsR, splitIndex, end, rightError);
 
-      leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                         minLeafSize);
-      rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                           minLeafSize);
+      GrowChildren(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize,
+          leftG, rightG);
 
       // Store values of R(T~) and |T~|.
       subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
@@ -735,6 +748,53 @@ double DTree<MatType, TagType>::Grow(MatType& data,
 }
 
 
+// Grow both children, in parallel if possible.  The children hold separate
+// ranges of the points, so they can reorder them at the same time.
+template<typename MatType, typename TagType>
+void DTree<MatType, TagType>::GrowChildren(MatType& data,
+                                           arma::Col<size_t>& oldFromNew,
+                                           const bool useVolReg,
+                                           const size_t maxLeafSize,
+                                           const size_t minLeafSize,
+                                           double& leftG,
+                                           double& rightG)
+{
+  #ifdef HAS_OPENMP
+  // Children smaller than this are grown by the task of their parent, since
+  // the overhead of a task would be larger than the work.
+  const size_t minimumTaskSize = 1024;
+
+  if (omp_in_parallel())
+  {
+    // We are already inside the tasks of a parent, so each large child gets
+    // its own task.
+    #pragma omp task shared(data, oldFromNew, leftG) \
+        if (left->End() - left->Start() >= minimumTaskSize)
+    leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize);
+    #pragma omp task shared(data, oldFromNew, rightG) \
+        if (right->End() - right->Start() >= minimumTaskSize)
+    rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
+        minLeafSize);
+    #pragma omp taskwait
+    return;
+  }
+  else if (ParallelThreads() > 1 && end - start >= 2 * minimumTaskSize)
+  {
+    // Create the threads that run the tasks of the whole subtree.
+    #pragma omp parallel num_threads(ParallelThreads())
+    {
+      #pragma omp single
+      GrowChildren(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize,
+          leftG, rightG);
+    }
+    return;
+  }
+  #endif
+
+  leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize);
+  rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize);
+}
+
 template<typename MatType, typename TagType>
 double DTree<MatType, TagType>::PruneAndUpdate(const double oldAlpha,
                                                const size_t points,
@@ -889,6 +949,45 @@ double DTree<MatType, TagType>::ComputeValue(const VecType& query) const
   return 0.0;
 }
 
+template<typename MatType, typename TagType>
+void DTree<MatType, TagType>::ComputeValue(const MatType& queries,
+                                           arma::rowvec& values) const
+{
+  Log::Assert(queries.n_rows == maxVals.n_elem);
+
+  values.set_size(queries.n_cols);
+
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) queries.n_cols; ++i)
+  {
+    // Points outside of the bounding box of the root have zero density.
+    bool inRange = true;
+    if (root == 1)
+    {
+      for (size_t d = 0; d < queries.n_rows && inRange; ++d)
+      {
+        const ElemType value = queries(d, i);
+        inRange = (value >= minVals[d]) && (value <= maxVals[d]);
+      }
+    }
+
+    if (!inRange)
+    {
+      values[i] = 0.0;
+      continue;
+    }
+
+    const DTree* node = this;
+    while (node->subtreeLeaves != 1)
+    {
+      node = (queries(node->splitDim, i) <= node->splitValue) ? node->left :
+          node->right;
+    }
+
+    values[i] = std::exp(std::log(node->ratio) - node->logVolume);
+  }
+}
+
 // Index the buckets for possible usage later.
 template<typename MatType, typename TagType>
 TagType DTree<MatType, TagType>::TagTree(const TagType& tag, bool every)
@@ -0,0 +1,120 @@
+/**
+ * @file concurrent_union_find.hpp
+ *
+ * Implements a union-find data structure that may be used by several threads at
+ * once.  It has the same interface as UnionFind, but all updates of the
+ * structure are made with atomic compare-and-swap operations, so no locks are
+ * needed.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
+#define MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+#include <memory>
+
+namespace mlpack {
+namespace emst {
+
+/**
+ * A lock-free union-find data structure.  Like UnionFind, it tracks the
+ * components of a graph: each point is initially in its own component, Union(x,
+ * y) unites the components containing x and y, and Find(x) returns the index of
+ * the component containing x.  Find() and Union() may be called from any number
+ * of threads at the same time.
+ *
+ * Find() shortens the paths it walks by path halving, and Union() links the
+ * root with the larger index below the root with the smaller index.  Both only
+ * change the parent of an element with a single compare-and-swap, so a thread
+ * never sees a cycle, and a Find() that runs at the same time as Find() calls
+ * only (and no Union() calls) always returns the same component.
+ */
+class ConcurrentUnionFind
+{
+ private:
+  //! The number of elements.
+  size_t size;
+  //! The parent of each element; the roots are their own parents.
+  std::unique_ptr<std::atomic<size_t>[]> parent;
+
+ public:
+  //! Construct the object with the given size.
+  ConcurrentUnionFind(const size_t size) :
+      size(size),
+      parent(new std::atomic<size_t>[size])
+  {
+    for (size_t i = 0; i < size; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the component containing an element.
+   *
+   * @param x the component to be found
+   * @return The index of the component containing x
+   */
+  size_t Find(size_t x)
+  {
+    while (true)
+    {
+      size_t p = parent[x].load(std::memory_order_acquire);
+      if (p == x)
+        return x;
+
+      // Path halving: point x to its grandparent.  If another thread changed
+      // the parent of x in the meantime, its change is just as good.
+      const size_t gp = parent[p].load(std::memory_order_acquire);
+      if (p != gp)
+      {
+        parent[x].compare_exchange_weak(p, gp, std::memory_order_acq_rel,
+            std::memory_order_acquire);
+      }
+
+      x = gp;
+    }
+  }
+
+  /**
+   * Union the components containing x and y.
+   *
+   * @param x one component
+   * @param y the other component
+   * @return true if the components were different (and have been united).
+   */
+  bool Union(const size_t x, const size_t y)
+  {
+    while (true)
+    {
+      size_t xRoot = Find(x);
+      size_t yRoot = Find(y);
+
+      if (xRoot == yRoot)
+        return false;
+
+      // Always link the larger index below the smaller one; with this fixed
+      // order, concurrent unions cannot create a cycle.
+      if (xRoot < yRoot)
+        std::swap(xRoot, yRoot);
+
+      // This only succeeds if xRoot is still a root; otherwise, try again with
+      // the new roots.
+      size_t expected = xRoot;
+      if (parent[xRoot].compare_exchange_strong(expected, yRoot,
+          std::memory_order_acq_rel, std::memory_order_acquire))
+        return true;
+    }
+  }
+
+  //! Get the number of elements.
+  size_t Size() const { return size; }
+}; // class ConcurrentUnionFind
+
+} // namespace emst
+} // namespace mlpack
+
+#endif // MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
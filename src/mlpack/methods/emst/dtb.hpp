@@ -27,6 +27,7 @@
 
 #include "dtb_stat.hpp"
 #include "edge_pair.hpp"
+#include "concurrent_union_find.hpp"
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
@@ -68,6 +69,13 @@ namespace emst /** Euclidean Minimum Spanning Trees. */ {
  * More advanced usage of the class can use different types of trees, pass in an
  * already-built tree, or compute the MST using the O(n^2) naive algorithm.
  *
+ * The search of each Boruvka round can be run with several threads; see
+ * NumThreads().  Then the query tree is divided between threads if the tree
+ * type has a ParallelDualTreeTraverser (as BinarySpaceTree does), and the
+ * naive algorithm divides the points between threads.  The resulting spanning
+ * tree is the same as with one thread, unless several edges have the same
+ * length.
+ *
  * @tparam MetricType The metric to use.
  * @tparam MatType The type of data matrix to use.
  * @tparam TreeType Type of tree to use.  This should follow the TreeType policy
@@ -102,8 +110,8 @@ class DualTreeBoruvka
   //! Edges.
   std::vector<EdgePair> edges; // We must use vector with non-numerical types.
 
-  //! Connections.
-  UnionFind connections;
+  //! Connections.  These are shared by all threads during a round.
+  ConcurrentUnionFind connections;
 
   //! List of edge nodes.
   arma::Col<size_t> neighborsInComponent;
@@ -118,6 +126,9 @@ class DualTreeBoruvka
   //! The instantiated metric.
   MetricType metric;
 
+  //! The number of threads to use for each round.
+  size_t numThreads;
+
   //! For sorting the edge list after the computation.
   struct SortEdgesHelper
   {
@@ -176,6 +187,13 @@ class DualTreeBoruvka
    */
   void ComputeMST(arma::mat& results);
 
+  //! Get the number of threads used for each round (0 means all threads
+  //! available to OpenMP).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for each round (0 means all threads
+  //! available to OpenMP).
+  size_t& NumThreads() { return numThreads; }
+
  private:
   /**
    * Adds a single edge to the edge list
@@ -187,6 +205,12 @@ class DualTreeBoruvka
    */
   void AddAllEdges();
 
+  /**
+   * Run the rounds of the algorithm with the given number of threads (more
+   * than one), with the rules in parallel mode.
+   */
+  void ComputeMSTParallel(const size_t threads);
+
   /**
    * Unpermute the edge list and output it to results.
    */
@@ -14,6 +14,12 @@
 
 #include "dtb_rules.hpp"
 
+#include <mlpack/core/tree/parallel_traverser_traits.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace emst {
 
@@ -39,6 +45,34 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+//! Traverse the tree with itself, dividing the query tree between threads.
+template<typename TreeType, typename RuleType>
+void ParallelDualTreeTraverse(
+    RuleType& rules,
+    TreeType& tree,
+    const size_t threads,
+    const typename std::enable_if<tree::HasParallelDualTreeTraverser<
+        TreeType, RuleType>::value>::type* = 0)
+{
+  typename TreeType::template ParallelDualTreeTraverser<RuleType>
+      traverser(rules, threads);
+  traverser.Traverse(tree, tree);
+}
+
+//! Traverse the tree with itself, with one thread, for trees that do not have
+//! a ParallelDualTreeTraverser.
+template<typename TreeType, typename RuleType>
+void ParallelDualTreeTraverse(
+    RuleType& rules,
+    TreeType& tree,
+    const size_t /* threads */,
+    const typename std::enable_if<!tree::HasParallelDualTreeTraverser<
+        TreeType, RuleType>::value>::type* = 0)
+{
+  typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+  traverser.Traverse(tree, tree);
+}
+
 /**
  * Takes in a reference to the data set.  Copies the data, builds the tree,
  * and initializes all of the member variables.
@@ -59,7 +93,8 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     naive(naive),
     connections(dataset.n_cols),
     totalDist(0.0),
-    metric(metric)
+    metric(metric),
+    numThreads(1)
 {
   edges.reserve(data.n_cols - 1); // Set size.
 
@@ -84,7 +119,8 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     naive(false),
     connections(data.n_cols),
     totalDist(0.0),
-    metric(metric)
+    metric(metric),
+    numThreads(1)
 {
   edges.reserve(data.n_cols - 1); // Fill with EdgePairs.
 
@@ -123,28 +159,123 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
 
   totalDist = 0; // Reset distance.
 
-  typedef DTBRules<MetricType, Tree> RuleType;
-  RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
-                 neighborsOutComponent, metric);
+  const size_t threads = ParallelThreads(numThreads);
+
+  if (threads > 1)
+  {
+    ComputeMSTParallel(threads);
+  }
+  else
+  {
+    typedef DTBRules<MetricType, Tree, ConcurrentUnionFind> RuleType;
+    RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
+                   neighborsOutComponent, metric);
+    while (edges.size() < (data.n_cols - 1))
+    {
+      if (naive)
+      {
+        // Full O(N^2) traversal.
+        for (size_t i = 0; i < data.n_cols; ++i)
+          for (size_t j = 0; j < data.n_cols; ++j)
+            rules.BaseCase(i, j);
+      }
+      else
+      {
+        typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+        traverser.Traverse(*tree, *tree);
+      }
+
+      AddAllEdges();
+
+      Cleanup();
+
+      Log::Info << edges.size() << " edges found so far." << std::endl;
+      if (!naive)
+      {
+        Log::Info << rules.BaseCases() << " cumulative base cases."
+            << std::endl;
+        Log::Info << rules.Scores() << " cumulative node combinations scored."
+            << std::endl;
+      }
+    }
+  }
+
+  Timer::Stop("emst/mst_computation");
+
+  EmitResults(results);
+
+  Log::Info << "Total spanning tree length: " << totalDist << std::endl;
+}
+
+/**
+ * Run the rounds with several threads.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMSTParallel(
+    const size_t threads)
+{
+  // The candidate edge of each point, and the distance of the best candidate
+  // edge of each component.
+  arma::vec pointDistances(data.n_cols);
+  pointDistances.fill(DBL_MAX);
+  arma::Col<size_t> pointNeighbors(data.n_cols);
+  std::vector<std::atomic<double>> componentDistances(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    componentDistances[i].store(DBL_MAX, std::memory_order_relaxed);
+
+  typedef DTBRules<MetricType, Tree, ConcurrentUnionFind> RuleType;
+  RuleType rules(data, connections, pointDistances, pointNeighbors,
+                 componentDistances, metric);
   while (edges.size() < (data.n_cols - 1))
   {
     if (naive)
     {
-      // Full O(N^2) traversal.
-      for (size_t i = 0; i < data.n_cols; ++i)
-        for (size_t j = 0; j < data.n_cols; ++j)
-          rules.BaseCase(i, j);
+      // Full O(N^2) traversal, with the query points divided between threads.
+      #pragma omp parallel num_threads(threads)
+      {
+        RuleType workerRules(rules);
+
+        #pragma omp for schedule(dynamic, 16)
+        for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+          for (size_t j = 0; j < data.n_cols; ++j)
+            workerRules.BaseCase(i, j);
+      }
     }
     else
     {
-      typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-      traverser.Traverse(*tree, *tree);
+      ParallelDualTreeTraverse(rules, *tree, threads);
+    }
+
+    // Now that all threads are done, choose the candidate edge of each
+    // component from the candidate edges of its points.  Ties go to the point
+    // with the smallest index.
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      if (pointDistances[i] == DBL_MAX)
+        continue;
+
+      const size_t component = connections.Find(i);
+      if (pointDistances[i] < neighborsDistances[component])
+      {
+        neighborsDistances[component] = pointDistances[i];
+        neighborsInComponent[component] = i;
+        neighborsOutComponent[component] = pointNeighbors[i];
+      }
     }
 
     AddAllEdges();
 
     Cleanup();
 
+    pointDistances.fill(DBL_MAX);
+    for (size_t i = 0; i < data.n_cols; ++i)
+      componentDistances[i].store(DBL_MAX, std::memory_order_relaxed);
+
     Log::Info << edges.size() << " edges found so far." << std::endl;
     if (!naive)
     {
@@ -153,12 +284,6 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
           << std::endl;
     }
   }
-
-  Timer::Stop("emst/mst_computation");
-
-  EmitResults(results);
-
-  Log::Info << "Total spanning tree length: " << totalDist << std::endl;
 }
 
 /**
@@ -16,20 +16,78 @@
 
 #include <mlpack/core/tree/traversal_info.hpp>
 
+#include <atomic>
+
+#include "union_find.hpp"
+
 namespace mlpack {
 namespace emst {
 
-template<typename MetricType, typename TreeType>
+/**
+ * The rules for the search of the nearest neighbor outside of each component,
+ * in one round of DualTreeBoruvka.
+ *
+ * The rules can work in one of two ways.  By default, the candidate edge of
+ * each component is stored, and updated during the search.  In parallel mode,
+ * the candidate edge of each query point is stored instead, so a query point
+ * is only ever updated by the thread that searches it.  The best candidate
+ * distance of each component is also kept, in an atomic so that all threads can
+ * use it for pruning.  Afterwards, the best candidate edge of each component
+ * must be chosen from the edges of its points.  Copies of a rules object share
+ * its results, so each thread may use its own copy.
+ *
+ * @tparam MetricType The metric to use for computation.
+ * @tparam TreeType The tree type to use.
+ * @tparam UnionFindType The union-find structure holding the components; it
+ *     must be safe to use from several threads in parallel mode (as
+ *     ConcurrentUnionFind is).
+ */
+template<typename MetricType,
+         typename TreeType,
+         typename UnionFindType = UnionFind>
 class DTBRules
 {
  public:
+  /**
+   * Construct the rules, storing the candidate edge of each component.
+   *
+   * @param dataSet The data points.
+   * @param connections The components found so far.
+   * @param neighborsDistances The distance of the candidate edge of each
+   *     component.
+   * @param neighborsInComponent The endpoint of the candidate edge of each
+   *     component that is in the component.
+   * @param neighborsOutComponent The endpoint of the candidate edge of each
+   *     component that is outside of the component.
+   * @param metric Instantiated metric.
+   */
   DTBRules(const arma::mat& dataSet,
-           UnionFind& connections,
+           UnionFindType& connections,
            arma::vec& neighborsDistances,
            arma::Col<size_t>& neighborsInComponent,
            arma::Col<size_t>& neighborsOutComponent,
            MetricType& metric);
 
+  /**
+   * Construct the rules in parallel mode, storing the candidate edge of each
+   * point and the candidate distance of each component.
+   *
+   * @param dataSet The data points.
+   * @param connections The components found so far.
+   * @param pointDistances The distance of the candidate edge of each point.
+   * @param pointNeighbors The other endpoint of the candidate edge of each
+   *     point.
+   * @param componentDistances The distance of the best candidate edge of each
+   *     component; this must have an element for each point.
+   * @param metric Instantiated metric.
+   */
+  DTBRules(const arma::mat& dataSet,
+           UnionFindType& connections,
+           arma::vec& pointDistances,
+           arma::Col<size_t>& pointNeighbors,
+           std::vector<std::atomic<double>>& componentDistances,
+           MetricType& metric);
+
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
   /**
@@ -102,19 +160,24 @@ class DTBRules
   const arma::mat& dataSet;
 
   //! Stores the tree structure so far
-  UnionFind& connections;
+  UnionFindType& connections;
 
-  //! The distance to the candidate nearest neighbor for each component.
+  //! The distance to the candidate nearest neighbor for each component (or,
+  //! in parallel mode, for each point).
   arma::vec& neighborsDistances;
 
   //! The index of the point in the component that is an endpoint of the
-  //! candidate edge.
-  arma::Col<size_t>& neighborsInComponent;
+  //! candidate edge.  This is NULL in parallel mode.
+  arma::Col<size_t>* neighborsInComponent;
 
   //! The index of the point outside of the component that is an endpoint
-  //! of the candidate edge.
+  //! of the candidate edge (or, in parallel mode, the other endpoint of the
+  //! candidate edge of each point).
   arma::Col<size_t>& neighborsOutComponent;
 
+  //! The best candidate distance of each component, in parallel mode only.
+  std::vector<std::atomic<double>>* componentDistances;
+
   //! The instantiated metric.
   MetricType& metric;
 
@@ -123,6 +186,14 @@ class DTBRules
    */
   inline double CalculateBound(TreeType& queryNode) const;
 
+  //! Get the distance of the best candidate edge of the given component.
+  double ComponentDistance(const size_t component) const
+  {
+    return componentDistances ?
+        (*componentDistances)[component].load(std::memory_order_relaxed) :
+        neighborsDistances[component];
+  }
+
   TraversalInfoType traversalInfo;
 
   //! The number of base cases calculated.
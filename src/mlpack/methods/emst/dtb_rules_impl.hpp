@@ -15,10 +15,10 @@
 namespace mlpack {
 namespace emst {
 
-template<typename MetricType, typename TreeType>
-DTBRules<MetricType, TreeType>::
+template<typename MetricType, typename TreeType, typename UnionFindType>
+DTBRules<MetricType, TreeType, UnionFindType>::
 DTBRules(const arma::mat& dataSet,
-         UnionFind& connections,
+         UnionFindType& connections,
          arma::vec& neighborsDistances,
          arma::Col<size_t>& neighborsInComponent,
          arma::Col<size_t>& neighborsOutComponent,
@@ -27,8 +27,9 @@ DTBRules(const arma::mat& dataSet,
   dataSet(dataSet),
   connections(connections),
   neighborsDistances(neighborsDistances),
-  neighborsInComponent(neighborsInComponent),
+  neighborsInComponent(&neighborsInComponent),
   neighborsOutComponent(neighborsOutComponent),
+  componentDistances(NULL),
   metric(metric),
   baseCases(0),
   scores(0)
@@ -36,10 +37,33 @@ DTBRules(const arma::mat& dataSet,
   // Nothing else to do.
 }
 
-template<typename MetricType, typename TreeType>
+template<typename MetricType, typename TreeType, typename UnionFindType>
+DTBRules<MetricType, TreeType, UnionFindType>::
+DTBRules(const arma::mat& dataSet,
+         UnionFindType& connections,
+         arma::vec& pointDistances,
+         arma::Col<size_t>& pointNeighbors,
+         std::vector<std::atomic<double>>& componentDistances,
+         MetricType& metric)
+:
+  dataSet(dataSet),
+  connections(connections),
+  neighborsDistances(pointDistances),
+  neighborsInComponent(NULL),
+  neighborsOutComponent(pointNeighbors),
+  componentDistances(&componentDistances),
+  metric(metric),
+  baseCases(0),
+  scores(0)
+{
+  // Nothing else to do.
+}
+
+template<typename MetricType, typename TreeType, typename UnionFindType>
 inline force_inline
-double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
-                                                const size_t referenceIndex)
+double DTBRules<MetricType, TreeType, UnionFindType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
 {
   // Check if the points are in the same component at this iteration.
   // If not, return the distance between them.  Also, store a better result as
@@ -57,27 +81,47 @@ double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
     double distance = metric.Evaluate(dataSet.col(queryIndex),
                                       dataSet.col(referenceIndex));
 
-    if (distance < neighborsDistances[queryComponentIndex])
+    if (componentDistances)
+    {
+      // The candidate of the query point is only updated by this thread.
+      if (distance < neighborsDistances[queryIndex])
+      {
+        Log::Assert(queryIndex != referenceIndex);
+
+        neighborsDistances[queryIndex] = distance;
+        neighborsOutComponent[queryIndex] = referenceIndex;
+
+        // Lower the distance of the component, unless another thread found a
+        // closer point in the meantime.
+        std::atomic<double>& componentDistance =
+            (*componentDistances)[queryComponentIndex];
+        double current = componentDistance.load(std::memory_order_relaxed);
+        while (distance < current && !componentDistance.compare_exchange_weak(
+            current, distance, std::memory_order_relaxed)) { }
+      }
+    }
+    else if (distance < neighborsDistances[queryComponentIndex])
     {
       Log::Assert(queryIndex != referenceIndex);
 
       neighborsDistances[queryComponentIndex] = distance;
-      neighborsInComponent[queryComponentIndex] = queryIndex;
+      (*neighborsInComponent)[queryComponentIndex] = queryIndex;
       neighborsOutComponent[queryComponentIndex] = referenceIndex;
     }
   }
 
-  if (newUpperBound < neighborsDistances[queryComponentIndex])
-    newUpperBound = neighborsDistances[queryComponentIndex];
+  if (newUpperBound < ComponentDistance(queryComponentIndex))
+    newUpperBound = ComponentDistance(queryComponentIndex);
 
   Log::Assert(newUpperBound >= 0.0);
 
   return newUpperBound;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
-                                             TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
 {
   size_t queryComponentIndex = connections.Find(queryIndex);
 
@@ -93,24 +137,26 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
-  return neighborsDistances[queryComponentIndex] < distance
+  return ComponentDistance(queryComponentIndex) < distance
       ? DBL_MAX : distance;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Rescore(const size_t queryIndex,
-                                               TreeType& /* referenceNode */,
-                                               const double oldScore)
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Rescore(
+    const size_t queryIndex,
+    TreeType& /* referenceNode */,
+    const double oldScore)
 {
   // We don't need to check component membership again, because it can't
   // change inside a single iteration.
-  return (oldScore > neighborsDistances[connections.Find(queryIndex)])
+  return (oldScore > ComponentDistance(connections.Find(queryIndex)))
       ? DBL_MAX : oldScore;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Score(TreeType& queryNode,
-                                             TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
 {
   // If all the queries belong to the same component as all the references
   // then we prune.
@@ -128,10 +174,11 @@ double DTBRules<MetricType, TreeType>::Score(TreeType& queryNode,
   return (bound < distance) ? DBL_MAX : distance;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Rescore(TreeType& queryNode,
-                                               TreeType& /* referenceNode */,
-                                               const double oldScore) const
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Rescore(
+    TreeType& queryNode,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
 {
   const double bound = CalculateBound(queryNode);
   return (oldScore > bound) ? DBL_MAX : oldScore;
@@ -139,8 +186,8 @@ double DTBRules<MetricType, TreeType>::Rescore(TreeType& queryNode,
 
 // Calculate the bound for a given query node in its current state and update
 // it.
-template<typename MetricType, typename TreeType>
-inline double DTBRules<MetricType, TreeType>::CalculateBound(
+template<typename MetricType, typename TreeType, typename UnionFindType>
+inline double DTBRules<MetricType, TreeType, UnionFindType>::CalculateBound(
     TreeType& queryNode) const
 {
   double worstPointBound = -DBL_MAX;
@@ -153,7 +200,7 @@ inline double DTBRules<MetricType, TreeType>::CalculateBound(
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
     const size_t pointComponent = connections.Find(queryNode.Point(i));
-    const double bound = neighborsDistances[pointComponent];
+    const double bound = ComponentDistance(pointComponent);
 
     if (bound > worstPointBound)
       worstPointBound = bound;
@@ -45,6 +45,11 @@ PROGRAM_INFO("Fast Euclidean Minimum Spanning Tree",
     "dimensions).  The leaf size does not affect the results, but it may have "
     "some effect on the runtime of the algorithm."
     "\n\n"
+    "Each round of the algorithm uses the number of threads given with the " +
+    PRINT_PARAM_STRING("threads") + " parameter (by default, all available "
+    "threads).  The spanning tree does not depend on the number of threads, "
+    "unless several edges have the same length."
+    "\n\n"
     "For example, the minimum spanning tree of the input dataset " +
     PRINT_DATASET("data") + " can be calculated with a leaf size of 20 and "
     "stored as " + PRINT_DATASET("spanning_tree") + " using the following "
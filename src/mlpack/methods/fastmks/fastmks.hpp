@@ -253,6 +253,25 @@ class FastMKS
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  /**
+   * Run brute-force search for the given query set.  Blocks of query points
+   * are searched in parallel, and the kernel values between a block of query
+   * points and a block of reference points are computed together with
+   * kernel::KernelMatrix().
+   *
+   * @param querySet Set of query points.
+   * @param k The number of maximum kernels to find.
+   * @param indices Matrix to store resulting indices of max-kernel search in.
+   * @param kernels Matrix to store resulting max-kernel values in.
+   * @param sameSet If true, the query set is the reference set, and a point is
+   *     not returned as its own candidate.
+   */
+  void NaiveSearch(const MatType& querySet,
+                   const size_t k,
+                   arma::Mat<size_t>& indices,
+                   arma::mat& kernels,
+                   const bool sameSet);
+
   //! The reference dataset.  We never own this; only the tree or a higher level
   //! does.
   const MatType* referenceSet;
@@ -18,10 +18,59 @@
 #include "fastmks_rules.hpp"
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+#include <mlpack/core/tree/parallel_traverser_traits.hpp>
 
 namespace mlpack {
 namespace fastmks {
 
+/**
+ * Determine whether single-tree search can use the ParallelSingleTreeTraverser
+ * of the given tree type.  FastMKSRules stores kernel values in the statistics
+ * of the reference nodes unless the traverser hands them over in the traversal
+ * info, as the cover tree's ParallelSingleTreeTraverser does; so this is only
+ * true for trees with self-children (cover trees).
+ */
+template<typename TreeType, typename RuleType>
+struct CanTraverseInParallel
+{
+  static const bool value =
+      tree::HasParallelSingleTreeTraverser<TreeType, RuleType>::value &&
+      tree::TreeTraits<TreeType>::HasSelfChildren;
+};
+
+//! Traverse the reference tree with each query point, using several threads;
+//! return the number of prunes.
+template<typename TreeType, typename RuleType>
+size_t SingleTreeTraverse(
+    RuleType& rules,
+    TreeType& referenceTree,
+    const size_t numQueries,
+    const typename std::enable_if<
+        CanTraverseInParallel<TreeType, RuleType>::value>::type* = 0)
+{
+  typename TreeType::template ParallelSingleTreeTraverser<RuleType>
+      traverser(rules);
+  traverser.Traverse(0, numQueries, referenceTree);
+  return traverser.NumPrunes();
+}
+
+//! Traverse the reference tree with each query point, one after another;
+//! return the number of prunes.
+template<typename TreeType, typename RuleType>
+size_t SingleTreeTraverse(
+    RuleType& rules,
+    TreeType& referenceTree,
+    const size_t numQueries,
+    const typename std::enable_if<
+        !CanTraverseInParallel<TreeType, RuleType>::value>::type* = 0)
+{
+  typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
+  for (size_t i = 0; i < numQueries; ++i)
+    traverser.Traverse(i, referenceTree);
+  return traverser.NumPrunes();
+}
+
 // No data; create a model on an empty dataset.
 template<typename KernelType,
          typename MatType,
@@ -304,33 +353,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        const double eval = metric.Kernel().Evaluate(querySet.col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(querySet, k, indices, kernels, false);
 
     Timer::Stop("computing_products");
 
@@ -345,10 +368,8 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     typedef FastMKSRules<KernelType, Tree> RuleType;
     RuleType rules(*referenceSet, querySet, k, metric.Kernel());
 
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // The query points are divided between threads if the tree allows it.
+    SingleTreeTraverse(rules, *referenceTree, querySet.n_cols);
 
     Log::Info << rules.BaseCases() << " base cases." << std::endl;
     Log::Info << rules.Scores() << " scores." << std::endl;
@@ -433,36 +454,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        if (q == r)
-          continue; // Don't return the point as its own candidate.
-
-        const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(*referenceSet, k, indices, kernels, true);
 
     Timer::Stop("computing_products");
 
@@ -477,13 +469,10 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     typedef FastMKSRules<KernelType, Tree> RuleType;
     RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel());
 
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
+    // The query points are divided between threads if the tree allows it.
     // Save the number of pruned nodes.
-    const size_t numPrunes = traverser.NumPrunes();
+    const size_t numPrunes = SingleTreeTraverse(rules, *referenceTree,
+        referenceSet->n_cols);
 
     Log::Info << "Pruned " << numPrunes << " nodes." << std::endl;
 
@@ -502,6 +491,86 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   Search(referenceTree, k, indices, kernels);
 }
 
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::NaiveSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels,
+    const bool sameSet)
+{
+  // The kernel values between a block of query points and a block of reference
+  // points are computed at once; for kernels of the inner product or of the
+  // squared distance this is one matrix multiplication.  The blocks of query
+  // points are independent, so they are handed out to threads.
+  const size_t queryBlockSize = 128;
+  const size_t referenceBlockSize = 2048;
+  const size_t numQueryBlocks = (querySet.n_cols + queryBlockSize - 1) /
+      queryBlockSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numQueryBlocks; ++b)
+  {
+    const size_t queryBegin = b * queryBlockSize;
+    const size_t queryEnd = std::min(queryBegin + queryBlockSize,
+        (size_t) querySet.n_cols);
+
+    const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+    std::vector<CandidateList> pqueues;
+    pqueues.reserve(queryEnd - queryBegin);
+    for (size_t q = queryBegin; q < queryEnd; ++q)
+    {
+      std::vector<Candidate> cList(k, def);
+      pqueues.push_back(CandidateList(CandidateCmp(), std::move(cList)));
+    }
+
+    arma::mat blockKernels;
+    for (size_t referenceBegin = 0; referenceBegin < referenceSet->n_cols;
+         referenceBegin += referenceBlockSize)
+    {
+      const size_t referenceEnd = std::min(referenceBegin +
+          referenceBlockSize, (size_t) referenceSet->n_cols);
+
+      kernel::KernelMatrix(metric.Kernel(),
+          referenceSet->cols(referenceBegin, referenceEnd - 1),
+          querySet.cols(queryBegin, queryEnd - 1), blockKernels);
+
+      for (size_t q = queryBegin; q < queryEnd; ++q)
+      {
+        CandidateList& pqueue = pqueues[q - queryBegin];
+        for (size_t r = referenceBegin; r < referenceEnd; ++r)
+        {
+          if (sameSet && q == r)
+            continue; // Don't return the point as its own candidate.
+
+          const double eval = blockKernels(r - referenceBegin, q - queryBegin);
+          if (eval > pqueue.top().first)
+          {
+            Candidate c = std::make_pair(eval, r);
+            pqueue.pop();
+            pqueue.push(c);
+          }
+        }
+      }
+    }
+
+    for (size_t q = queryBegin; q < queryEnd; ++q)
+    {
+      CandidateList& pqueue = pqueues[q - queryBegin];
+      for (size_t j = 1; j <= k; j++)
+      {
+        indices(k - j, q) = pqueue.top().second;
+        kernels(k - j, q) = pqueue.top().first;
+        pqueue.pop();
+      }
+    }
+  }
+}
+
 //! Serialize the model.
 template<typename KernelType,
          typename MatType,
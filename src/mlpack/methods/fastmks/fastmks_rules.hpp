@@ -48,6 +48,17 @@ class FastMKSRules
                const size_t k,
                KernelType& kernel);
 
+  /**
+   * Construct a FastMKSRules object that shares the candidate lists of the
+   * given object.  The new object has its own traversal information, base case
+   * cache and counters, so it can be used by a different thread than the given
+   * object (as the cover tree's ParallelSingleTreeTraverser does), as long as
+   * the two objects are never used for the same query point at the same time.
+   *
+   * @param other FastMKSRules object to share candidate lists with.
+   */
+  FastMKSRules(const FastMKSRules& other);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -148,8 +159,13 @@ class FastMKSRules
   typedef boost::heap::priority_queue<Candidate,
       boost::heap::compare<CandidateCmp>> CandidateList;
 
-  //! Set of candidates for each point.
-  std::vector<CandidateList> candidates;
+  //! Storage for the candidates of each point, if this object owns them (i.e.,
+  //! if it was not created with the copy constructor).
+  std::vector<CandidateList> candidateStorage;
+
+  //! Set of candidates for each point.  This may be shared with other
+  //! FastMKSRules objects.
+  std::vector<CandidateList>& candidates;
 
   //! Number of points to search for.
   const size_t k;
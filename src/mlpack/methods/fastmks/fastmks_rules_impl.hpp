@@ -26,6 +26,7 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     KernelType& kernel) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(candidateStorage),
     k(k),
     kernel(kernel),
     lastQueryIndex(-1),
@@ -64,6 +65,27 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
   candidates.swap(tmp);
 }
 
+template<typename KernelType, typename TreeType>
+FastMKSRules<KernelType, TreeType>::FastMKSRules(const FastMKSRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    queryKernels(other.queryKernels),
+    referenceKernels(other.referenceKernels),
+    kernel(other.kernel),
+    lastQueryIndex(-1),
+    lastReferenceIndex(-1),
+    lastKernel(0.0),
+    baseCases(0),
+    scores(0)
+{
+  // The traversal info must not point at any node of the other object's
+  // traversal; as in the other constructor, we use the this pointer.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+}
+
 template<typename KernelType, typename TreeType>
 void FastMKSRules<KernelType, TreeType>::GetResults(
     arma::Mat<size_t>& indices,
@@ -131,6 +153,13 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
   // Compare with the current best.
   const double bestKernel = candidates[queryIndex].top().first;
 
+  // A traverser may hand us the kernel value of the query and the parent in the
+  // traversal info (the cover tree's ParallelSingleTreeTraverser does), in
+  // which case the statistics of the reference tree are neither read nor
+  // written.
+  const bool parentGiven =
+      (traversalInfo.LastReferenceNode() == referenceNode.Parent());
+
   // See if we can perform a parent-child prune.
   const double furthestDist = referenceNode.FurthestDescendantDistance();
   if (referenceNode.Parent() != NULL)
@@ -138,7 +167,8 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
     double maxKernelBound;
     const double parentDist = referenceNode.ParentDistance();
     const double combinedDistBound = parentDist + furthestDist;
-    const double lastKernel = referenceNode.Parent()->Stat().LastKernel();
+    const double lastKernel = parentGiven ? traversalInfo.LastBaseCase() :
+        referenceNode.Parent()->Stat().LastKernel();
     if (kernel::KernelTraits<KernelType>::IsNormalized)
     {
       const double squaredDist = std::pow(combinedDistBound, 2.0);
@@ -175,7 +205,8 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
         referenceNode.Parent() != NULL &&
         referenceNode.Point(0) == referenceNode.Parent()->Point(0))
     {
-      kernelEval = referenceNode.Parent()->Stat().LastKernel();
+      kernelEval = parentGiven ? traversalInfo.LastBaseCase() :
+          referenceNode.Parent()->Stat().LastKernel();
     }
     else
     {
@@ -190,7 +221,8 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
     kernelEval = kernel.Evaluate(querySet.col(queryIndex), refCenter);
   }
 
-  referenceNode.Stat().LastKernel() = kernelEval;
+  if (!parentGiven)
+    referenceNode.Stat().LastKernel() = kernelEval;
 
   double maxKernel;
   if (kernel::KernelTraits<KernelType>::IsNormalized)
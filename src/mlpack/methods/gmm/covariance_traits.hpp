@@ -0,0 +1,87 @@
+/**
+ * @file covariance_traits.hpp
+ *
+ * Traits that describe how the covariance of a Gaussian distribution is
+ * stored, so that EMFit can fit Gaussians with full and with diagonal
+ * covariances.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_COVARIANCE_TRAITS_HPP
+#define MLPACK_METHODS_GMM_COVARIANCE_TRAITS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * The CovarianceTraits class gives the type of the covariance of a Gaussian
+ * distribution, and the operations EMFit needs to estimate it.  A
+ * specialization must be given for each distribution that EMFit can fit.
+ */
+template<typename DistributionType>
+struct CovarianceTraits;
+
+//! A GaussianDistribution stores its full covariance matrix.
+template<>
+struct CovarianceTraits<distribution::GaussianDistribution>
+{
+  //! The type of the covariance.
+  typedef arma::mat CovarianceType;
+
+  //! Return the weighted scatter of the given points, sum_j w_j x_j x_j^T.
+  static arma::mat Scatter(const arma::mat& points, const arma::vec& weights)
+  {
+    return (points.each_row() % weights.t()) * points.t();
+  }
+
+  //! Return the scatter x x^T of one point.
+  static arma::mat Outer(const arma::vec& point) { return point * point.t(); }
+
+  //! Return the covariance with the given diagonal and no other entries.
+  static arma::mat FromDiagonal(const arma::vec& diagonal)
+  {
+    return arma::diagmat(diagonal);
+  }
+
+  //! Return the diagonal of the given covariance.
+  static arma::vec Diagonal(const arma::mat& covariance)
+  {
+    return covariance.diag();
+  }
+};
+
+//! A DiagonalGaussianDistribution only stores the diagonal of its covariance,
+//! so each operation only computes the diagonal.
+template<>
+struct CovarianceTraits<distribution::DiagonalGaussianDistribution>
+{
+  //! The type of the covariance.
+  typedef arma::vec CovarianceType;
+
+  //! Return the diagonal of the weighted scatter of the given points.
+  static arma::vec Scatter(const arma::mat& points, const arma::vec& weights)
+  {
+    return arma::square(points) * weights;
+  }
+
+  //! Return the diagonal of the scatter of one point.
+  static arma::vec Outer(const arma::vec& point) { return point % point; }
+
+  //! Return the given diagonal.
+  static arma::vec FromDiagonal(const arma::vec& diagonal) { return diagonal; }
+
+  //! Return the given diagonal.
+  static arma::vec Diagonal(const arma::vec& covariance) { return covariance; }
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
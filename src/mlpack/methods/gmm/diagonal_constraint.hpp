@@ -30,6 +30,13 @@ class DiagonalConstraint
     covariance = arma::diagmat(arma::clamp(covariance.diag(), 1e-10, DBL_MAX));
   }
 
+  //! Apply the same lower bound to a diagonal covariance, which is already
+  //! diagonal.
+  static void ApplyConstraint(arma::vec& diagCovariance)
+  {
+    diagCovariance = arma::clamp(diagCovariance, 1e-10, DBL_MAX);
+  }
+
   //! Serialize the constraint (which holds nothing, so, nothing to do).
   template<typename Archive>
   static void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
@@ -0,0 +1,114 @@
+/**
+ * @file diagonal_gmm.cpp
+ *
+ * Implementation of the non-template methods of DiagonalGMM.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "diagonal_gmm.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+DiagonalGMM::DiagonalGMM(const size_t gaussians, const size_t dimensionality) :
+    gaussians(gaussians),
+    dimensionality(dimensionality),
+    dists(gaussians,
+        distribution::DiagonalGaussianDistribution(dimensionality)),
+    weights(gaussians)
+{
+  // Set equal weights.
+  weights.fill(1.0 / gaussians);
+}
+
+double DiagonalGMM::Probability(const arma::vec& observation) const
+{
+  double sum = 0;
+  for (size_t i = 0; i < gaussians; ++i)
+    sum += weights[i] * dists[i].Probability(observation);
+
+  return sum;
+}
+
+double DiagonalGMM::Probability(const arma::vec& observation,
+                                const size_t component) const
+{
+  return weights[component] * dists[component].Probability(observation);
+}
+
+void DiagonalGMM::LogProbability(const arma::mat& observations,
+                                 arma::vec& logProbabilities) const
+{
+  // Row j holds the weighted log-densities of observation j.
+  arma::mat logProbs(observations.n_cols, gaussians);
+  arma::vec componentLogProbs;
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    dists[i].LogProbability(observations, componentLogProbs);
+    logProbs.col(i) = componentLogProbs + std::log(weights[i]);
+  }
+
+  // Sum the densities of each observation with the log-sum-exp trick.
+  logProbabilities.set_size(observations.n_cols);
+  for (size_t j = 0; j < observations.n_cols; ++j)
+  {
+    const double maxLogProb = logProbs.row(j).max();
+    if (maxLogProb == -std::numeric_limits<double>::infinity())
+      logProbabilities[j] = maxLogProb;
+    else
+      logProbabilities[j] = maxLogProb + std::log(arma::accu(arma::exp(
+          logProbs.row(j) - maxLogProb)));
+  }
+}
+
+arma::vec DiagonalGMM::Random() const
+{
+  // Determine which Gaussian it will be coming from.
+  const double gaussRand = math::Random();
+  size_t gaussian = 0;
+
+  double sumProb = 0;
+  for (size_t g = 0; g < gaussians; ++g)
+  {
+    sumProb += weights(g);
+    if (gaussRand <= sumProb)
+    {
+      gaussian = g;
+      break;
+    }
+  }
+
+  return dists[gaussian].Random();
+}
+
+void DiagonalGMM::Classify(const arma::mat& observations,
+                           arma::Row<size_t>& labels) const
+{
+  labels.set_size(observations.n_cols);
+
+  // Compare the weighted log-probabilities of the components, one component
+  // at a time.
+  arma::vec best(observations.n_cols);
+  best.fill(-std::numeric_limits<double>::infinity());
+  labels.zeros();
+  arma::vec logProbs;
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    dists[i].LogProbability(observations, logProbs);
+    logProbs += std::log(weights[i]);
+    for (size_t j = 0; j < observations.n_cols; ++j)
+    {
+      if (logProbs[j] >= best[j])
+      {
+        best[j] = logProbs[j];
+        labels[j] = i;
+      }
+    }
+  }
+}
+
+} // namespace gmm
+} // namespace mlpack
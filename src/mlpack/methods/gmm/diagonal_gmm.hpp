@@ -0,0 +1,193 @@
+/**
+ * @file diagonal_gmm.hpp
+ *
+ * Defines a Gaussian mixture model whose components have diagonal covariances.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_DIAGONAL_GMM_HPP
+#define MLPACK_METHODS_GMM_DIAGONAL_GMM_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
+
+#include "em_fit.hpp"
+#include "diagonal_constraint.hpp"
+#include "train_trials.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * A Gaussian Mixture Model whose components are DiagonalGaussianDistributions.
+ * It has the same interface as GMM, but each component only stores the
+ * diagonal of its covariance, so training and evaluating the model take O(d)
+ * time and memory per point and component instead of O(d^2) (and the O(d^3)
+ * covariance inversions disappear).  This is the model to use whenever the
+ * covariances are constrained to be diagonal anyway.
+ *
+ * The FittingType must provide the same Estimate() functions as for GMM, but
+ * with std::vector<distribution::DiagonalGaussianDistribution> components;
+ * EMFit<> with DiagonalGaussianDistribution as its Distribution parameter does.
+ *
+ * @code
+ * // Set up a mixture of 5 diagonal Gaussians in a 4-dimensional space.
+ * DiagonalGMM g(5, 4);
+ * g.Train(data);
+ *
+ * double probability = g.Probability(observation);
+ * arma::vec observation = g.Random();
+ * @endcode
+ */
+class DiagonalGMM
+{
+ private:
+  //! The number of Gaussians in the model.
+  size_t gaussians;
+  //! The dimensionality of the model.
+  size_t dimensionality;
+
+  //! Vector of Gaussians.
+  std::vector<distribution::DiagonalGaussianDistribution> dists;
+
+  //! Vector of a priori weights for each Gaussian.
+  arma::vec weights;
+
+ public:
+  //! The default fitting type: EM with diagonal Gaussian components.
+  typedef EMFit<kmeans::KMeans<>, DiagonalConstraint,
+      distribution::DiagonalGaussianDistribution> DefaultFittingType;
+
+  /**
+   * Create an empty diagonal GMM, with zero Gaussians.
+   */
+  DiagonalGMM() : gaussians(0), dimensionality(0) { }
+
+  /**
+   * Create a diagonal GMM with the given number of Gaussians, each of which
+   * have the specified dimensionality.  The means will be set to 0 and the
+   * covariances to the identity.
+   *
+   * @param gaussians Number of Gaussians in this GMM.
+   * @param dimensionality Dimensionality of each Gaussian.
+   */
+  DiagonalGMM(const size_t gaussians, const size_t dimensionality);
+
+  /**
+   * Create a diagonal GMM with the given dists and weights.
+   *
+   * @param dists Distributions of the model.
+   * @param weights Weights of the model.
+   */
+  DiagonalGMM(
+      const std::vector<distribution::DiagonalGaussianDistribution>& dists,
+      const arma::vec& weights) :
+      gaussians(dists.size()),
+      dimensionality((!dists.empty()) ? dists[0].Mean().n_elem : 0),
+      dists(dists),
+      weights(weights) { /* Nothing to do. */ }
+
+  //! Return the number of gaussians in the model.
+  size_t Gaussians() const { return gaussians; }
+  //! Return the dimensionality of the model.
+  size_t Dimensionality() const { return dimensionality; }
+
+  //! Return a const reference to a component distribution.
+  const distribution::DiagonalGaussianDistribution& Component(size_t i) const
+  { return dists[i]; }
+  //! Return a reference to a component distribution.
+  distribution::DiagonalGaussianDistribution& Component(size_t i)
+  { return dists[i]; }
+
+  //! Return a const reference to the a priori weights of each Gaussian.
+  const arma::vec& Weights() const { return weights; }
+  //! Return a reference to the a priori weights of each Gaussian.
+  arma::vec& Weights() { return weights; }
+
+  /**
+   * Return the probability that the given observation came from this
+   * distribution.
+   *
+   * @param observation Observation to evaluate the probability of.
+   */
+  double Probability(const arma::vec& observation) const;
+
+  /**
+   * Return the probability that the given observation came from the given
+   * Gaussian component in this distribution.
+   *
+   * @param observation Observation to evaluate the probability of.
+   * @param component Index of the component of the GMM to be considered.
+   */
+  double Probability(const arma::vec& observation,
+                     const size_t component) const;
+
+  /**
+   * Compute the log-probability of each of the given observations under this
+   * model.  This is faster than calling Probability() for each observation.
+   *
+   * @param observations Observations to evaluate, one per column.
+   * @param logProbabilities Vector to store the log-probabilities in.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
+  /**
+   * Return a randomly generated observation according to the probability
+   * distribution defined by this object.
+   */
+  arma::vec Random() const;
+
+  /**
+   * Estimate the model from the given observations with the given fitting
+   * type; see GMM::Train() for the meaning of the parameters.
+   *
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename FittingType = DefaultFittingType>
+  double Train(const arma::mat& observations,
+               const size_t trials = 1,
+               const bool useExistingModel = false,
+               FittingType fitter = FittingType());
+
+  /**
+   * Estimate the model from the given observations, each of which has the
+   * given probability of being from this distribution; see GMM::Train() for
+   * the meaning of the parameters.
+   *
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename FittingType = DefaultFittingType>
+  double Train(const arma::mat& observations,
+               const arma::vec& probabilities,
+               const size_t trials = 1,
+               const bool useExistingModel = false,
+               FittingType fitter = FittingType());
+
+  /**
+   * Classify the given observations as being from an individual component in
+   * this GMM.
+   *
+   * @param observations List of observations to classify.
+   * @param labels Object which will be filled with labels.
+   */
+  void Classify(const arma::mat& observations,
+                arma::Row<size_t>& labels) const;
+
+  /**
+   * Serialize the diagonal GMM.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+// Include implementation.
+#include "diagonal_gmm_impl.hpp"
+
+#endif
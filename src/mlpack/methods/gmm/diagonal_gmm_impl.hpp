@@ -0,0 +1,139 @@
+/**
+ * @file diagonal_gmm_impl.hpp
+ *
+ * Implementation of template-based DiagonalGMM methods.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_DIAGONAL_GMM_IMPL_HPP
+#define MLPACK_METHODS_GMM_DIAGONAL_GMM_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "diagonal_gmm.hpp"
+#include "responsibilities.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * Fit the diagonal GMM to the given observations.
+ */
+template<typename FittingType>
+double DiagonalGMM::Train(const arma::mat& observations,
+                          const size_t trials,
+                          const bool useExistingModel,
+                          FittingType fitter)
+{
+  double bestLikelihood; // This will be reported later.
+
+  // We don't need to store temporary models if we are only doing one trial.
+  if (trials == 1)
+  {
+    // Train the model.  The user will have been warned earlier if the GMM was
+    // initialized with no parameters (0 gaussians, dimensionality of 0).
+    fitter.Estimate(observations, dists, weights, useExistingModel);
+    bestLikelihood = ComputeLogLikelihood(observations, dists, weights);
+  }
+  else
+  {
+    if (trials == 0)
+      return -DBL_MAX; // It's what they asked for...
+
+    // The trials run in parallel, each with its own copy of the model.
+    arma::vec trialLikelihoods;
+    bestLikelihood = TrainTrials(observations, NULL, trials,
+        useExistingModel, fitter, dists, weights, trialLikelihoods);
+
+    for (size_t trial = 0; trial < trials; ++trial)
+    {
+      Log::Info << "DiagonalGMM::Train(): Log-likelihood of trial " << trial
+          << " is " << trialLikelihoods[trial] << "." << std::endl;
+    }
+  }
+
+  // Report final log-likelihood and return it.
+  Log::Info << "DiagonalGMM::Train(): log-likelihood of trained GMM is "
+      << bestLikelihood << "." << std::endl;
+  return bestLikelihood;
+}
+
+/**
+ * Fit the diagonal GMM to the given observations, each of which has a certain
+ * probability of being from this distribution.
+ */
+template<typename FittingType>
+double DiagonalGMM::Train(const arma::mat& observations,
+                          const arma::vec& probabilities,
+                          const size_t trials,
+                          const bool useExistingModel,
+                          FittingType fitter)
+{
+  double bestLikelihood; // This will be reported later.
+
+  // We don't need to store temporary models if we are only doing one trial.
+  if (trials == 1)
+  {
+    // Train the model.  The user will have been warned earlier if the GMM was
+    // initialized with no parameters (0 gaussians, dimensionality of 0).
+    fitter.Estimate(observations, probabilities, dists, weights,
+        useExistingModel);
+    bestLikelihood = ComputeLogLikelihood(observations, dists, weights);
+  }
+  else
+  {
+    if (trials == 0)
+      return -DBL_MAX; // It's what they asked for...
+
+    // The trials run in parallel, each with its own copy of the model.
+    arma::vec trialLikelihoods;
+    bestLikelihood = TrainTrials(observations, &probabilities, trials,
+        useExistingModel, fitter, dists, weights, trialLikelihoods);
+
+    for (size_t trial = 0; trial < trials; ++trial)
+    {
+      Log::Debug << "DiagonalGMM::Train(): Log-likelihood of trial " << trial
+          << " is " << trialLikelihoods[trial] << "." << std::endl;
+    }
+  }
+
+  // Report final log-likelihood and return it.
+  Log::Info << "DiagonalGMM::Train(): log-likelihood of trained GMM is "
+      << bestLikelihood << "." << std::endl;
+  return bestLikelihood;
+}
+
+/**
+ * Serialize the object.
+ */
+template<typename Archive>
+void DiagonalGMM::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(gaussians, "gaussians");
+  ar & CreateNVP(dimensionality, "dimensionality");
+
+  // Load (or save) the gaussians.  Not going to use the default std::vector
+  // serialize here because it won't call out correctly to Serialize() for each
+  // Gaussian distribution.
+  if (Archive::is_loading::value)
+    dists.resize(gaussians);
+
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    std::ostringstream oss;
+    oss << "dist" << i;
+    ar & CreateNVP(dists[i], oss.str());
+  }
+
+  ar & CreateNVP(weights, "weights");
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
+
@@ -76,6 +76,19 @@ class EigenvalueRatioConstraint
     covariance = eigenvectors * arma::diagmat(eigenvalues) * eigenvectors.t();
   }
 
+  /**
+   * Apply the eigenvalue ratio constraint to the given diagonal covariance,
+   * whose eigenvalues are its elements.  The order of the elements is kept,
+   * and the ratios are applied from the largest element down.
+   */
+  void ApplyConstraint(arma::vec& diagCovariance) const
+  {
+    const arma::uvec order = arma::sort_index(diagCovariance, "descend");
+    const double largest = diagCovariance[order[0]];
+    for (size_t i = 0; i < order.n_elem; ++i)
+      diagCovariance[order[i]] = largest * ratios[i];
+  }
+
   //! Serialize the constraint.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
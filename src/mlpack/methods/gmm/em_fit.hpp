@@ -21,6 +21,8 @@
 #include <mlpack/methods/kmeans/kmeans.hpp>
 // Default covariance matrix constraint.
 #include "positive_definite_constraint.hpp"
+#include "responsibilities.hpp"
+#include "covariance_traits.hpp"
 
 namespace mlpack {
 namespace gmm {
@@ -37,9 +39,34 @@ namespace gmm {
  *
  * This method should create 'clusters' clusters, and return the assignment of
  * each point to a cluster.
+ *
+ * The E-step is computed in log space on blocks of points, which are divided
+ * between the threads available to OpenMP.
+ *
+ * If BatchSize() is not 0, stepwise mini-batch EM is used instead of batch EM:
+ * each iteration is one pass over the observations in batches of BatchSize()
+ * points, in random order.  After each batch, the running sufficient
+ * statistics of the model (the a priori weights and the weighted first and
+ * second moments of each component) are moved towards the statistics of the
+ * batch with step size (t + 2)^(-StepSizeDecay()), where t is the number of
+ * batches seen so far, and the model is updated from them.  So only the
+ * responsibilities of one batch are ever stored, and each iteration updates
+ * the model many times.  StepSizeDecay() should be in (0.5, 1].
+ *
+ * The components can be GaussianDistributions (with full covariance) or
+ * DiagonalGaussianDistributions; the latter only ever compute the diagonal of
+ * the covariance, which is much faster in many dimensions.  The
+ * CovarianceConstraintPolicy must then accept an arma::vec holding the
+ * diagonal.
+ *
+ * @tparam InitialClusteringType Type of the initial clustering.
+ * @tparam CovarianceConstraintPolicy Constraint applied to each covariance.
+ * @tparam Distribution Type of the components; CovarianceTraits must be
+ *     specialized for it.
  */
 template<typename InitialClusteringType = kmeans::KMeans<>,
-         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
+         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint,
+         typename Distribution = distribution::GaussianDistribution>
 class EMFit
 {
  public:
@@ -81,7 +108,7 @@ class EMFit
    *      clustering.
    */
   void Estimate(const arma::mat& observations,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<Distribution>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -104,7 +131,7 @@ class EMFit
    */
   void Estimate(const arma::mat& observations,
                 const arma::vec& probabilities,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<Distribution>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -128,11 +155,26 @@ class EMFit
   //! Modify the tolerance for the convergence of the EM algorithm.
   double& Tolerance() { return tolerance; }
 
+  //! Get the batch size of mini-batch EM (0 means batch EM).
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size of mini-batch EM (0 means batch EM).
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the decay of the step size of mini-batch EM.
+  double StepSizeDecay() const { return stepSizeDecay; }
+  //! Modify the decay of the step size of mini-batch EM.
+  double& StepSizeDecay() { return stepSizeDecay; }
+
   //! Serialize the fitter.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
 
  private:
+  //! The operations on the covariances of the components.
+  typedef CovarianceTraits<Distribution> Traits;
+  //! The type of the covariances of the components.
+  typedef typename Traits::CovarianceType CovarianceType;
+
   /**
    * Run the clusterer, and then turn the cluster assignments into Gaussians.
    * This is a helper function for both overloads of Estimate().  The vectors
@@ -144,23 +186,25 @@ class EMFit
    * @param weights Vector to store a priori weights in.
    */
   void InitialClustering(const arma::mat& observations,
-                         std::vector<distribution::GaussianDistribution>& dists,
+                         std::vector<Distribution>& dists,
                          arma::vec& weights);
 
   /**
-   * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
-   * GMM code.  Intuition suggests that the log-likelihood is not the best way
-   * to determine if the EM algorithm has converged.
+   * Fit the model with stepwise mini-batch EM, starting from the given model.
+   * This is a helper function for both overloads of Estimate().  Iteration
+   * stops when the log-likelihood of a pass (computed for each batch before
+   * the model is updated with it) changes by no more than the tolerance.
    *
-   * @param data Data matrix.
-   * @param means Vector of means.
-   * @param covariances Vector of covariance matrices.
-   * @param weights Vector of a priori weights.
+   * @param observations List of observations to train on.
+   * @param probabilities If not NULL, probability of each point being from
+   *      this model.
+   * @param dists Distributions to train.
+   * @param weights A priori weights to train.
    */
-  double LogLikelihood(const arma::mat& data,
-                       const std::vector<distribution::GaussianDistribution>&
-                           dists,
-                       const arma::vec& weights) const;
+  void MiniBatchEstimate(const arma::mat& observations,
+                         const arma::vec* probabilities,
+                         std::vector<Distribution>& dists,
+                         arma::vec& weights);
 
   // Armadillo uses uword internally as an OpenMP index type, which crashes
   // Visual Studio.
@@ -177,7 +221,7 @@ class EMFit
    */
   void ArmadilloGMMWrapper(
       const arma::mat& observations,
-      std::vector<distribution::GaussianDistribution>& dists,
+      std::vector<Distribution>& dists,
       arma::vec& weights,
       const bool useInitialModel);
   #endif
@@ -186,6 +230,10 @@ class EMFit
   size_t maxIterations;
   //! Tolerance for convergence of EM.
   double tolerance;
+  //! Number of points in each batch of mini-batch EM, or 0 for batch EM.
+  size_t batchSize;
+  //! Decay of the step size of mini-batch EM.
+  double stepSizeDecay;
   //! Object which will perform the clustering.
   InitialClusteringType clusterer;
   //! Object which applies constraints to the covariance matrix.
@@ -195,6 +243,26 @@ class EMFit
 } // namespace gmm
 } // namespace mlpack
 
+namespace boost {
+namespace serialization {
+
+//! Set the serialization version of the EMFit class.  Version 1 also stores
+//! the batch size and the step size decay.  (BOOST_TEMPLATE_CLASS_VERSION()
+//! cannot be used, because the template signature contains commas.)
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+struct version<mlpack::data::SecondShim<mlpack::gmm::EMFit<
+    InitialClusteringType, CovarianceConstraintPolicy, Distribution>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "em_fit_impl.hpp"
 
@@ -21,30 +21,37 @@ namespace mlpack {
 namespace gmm {
 
 //! Constructor.
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-EMFit<InitialClusteringType, CovarianceConstraintPolicy>::EMFit(
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::EMFit(
     const size_t maxIterations,
     const double tolerance,
     InitialClusteringType clusterer,
     CovarianceConstraintPolicy constraint) :
     maxIterations(maxIterations),
     tolerance(tolerance),
+    batchSize(0),
+    stepSizeDecay(0.6),
     clusterer(clusterer),
     constraint(constraint)
 { /* Nothing to do. */ }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
-    const arma::mat& observations,
-    std::vector<distribution::GaussianDistribution>& dists,
-    arma::vec& weights,
-    const bool useInitialModel)
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(const arma::mat& observations,
+         std::vector<Distribution>& dists,
+         arma::vec& weights,
+         const bool useInitialModel)
 {
   // Shortcut: if the user is using the DiagonalConstraint, then we will call
   // out to Armadillo.  But Armadillo uses uword internally as an OpenMP index
   // type, which crashes Visual Studio, so don't do this on Windows.
   #ifndef _WIN32
-  if (std::is_same<CovarianceConstraintPolicy, DiagonalConstraint>::value)
+  if (std::is_same<CovarianceConstraintPolicy, DiagonalConstraint>::value &&
+      batchSize == 0)
   {
     ArmadilloGMMWrapper(observations, dists, weights, useInitialModel);
     return;
@@ -55,13 +62,22 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  if (batchSize > 0)
+  {
+    MiniBatchEstimate(observations, NULL, dists, weights);
+    return;
+  }
+
+  // The conditional probabilities of choosing a particular Gaussian given the
+  // observations and the present theta value are computed together with the
+  // log-likelihood of the model.
+  arma::mat condProb;
+  double l = ComputeResponsibilities(observations, dists, weights, &condProb);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
@@ -70,27 +86,6 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
         << "log-likelihood " << l << "." << std::endl;
 
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
-
     // Store the sum of the probability of each state over all the observations.
     arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
 
@@ -102,17 +97,14 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
       if (probRowSums[i] != 0)
         dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
 
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i)));
-
       // Don't update if there's no probability of the Gaussian having points.
       if (probRowSums[i] != 0.0)
       {
-        arma::mat covariance = (tmp * trans(tmpB)) / probRowSums[i];
+        // Calculate the new value of the covariances using the updated
+        // conditional probabilities and the updated means.
+        const arma::mat centered = observations.each_col() - dists[i].Mean();
+        CovarianceType covariance = Traits::Scatter(centered,
+            condProb.col(i)) / probRowSums[i];
         // Apply covariance constraint.
         constraint.ApplyConstraint(covariance);
         dists[i].Covariance(std::move(covariance));
@@ -123,58 +115,49 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     // probabilities.
     weights = probRowSums / observations.n_cols;
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate new log-likelihood, and the conditional
+    // probabilities for the next iteration.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = ComputeResponsibilities(observations, dists, weights, &condProb);
 
     iteration++;
   }
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
-    const arma::mat& observations,
-    const arma::vec& probabilities,
-    std::vector<distribution::GaussianDistribution>& dists,
-    arma::vec& weights,
-    const bool useInitialModel)
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(const arma::mat& observations,
+         const arma::vec& probabilities,
+         std::vector<Distribution>& dists,
+         arma::vec& weights,
+         const bool useInitialModel)
 {
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  if (batchSize > 0)
+  {
+    MiniBatchEstimate(observations, &probabilities, dists, weights);
+    return;
+  }
+
+  // The conditional probabilities of choosing a particular Gaussian given the
+  // observations and the present theta value are computed together with the
+  // log-likelihood of the model.
+  arma::mat condProb;
+  double l = ComputeResponsibilities(observations, dists, weights, &condProb);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
-
     // This will store the sum of probabilities of each state over all the
     // observations.
     arma::vec probRowSums(dists.size());
@@ -194,12 +177,9 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
 
       // Calculate the new value of the covariances using the updated
       // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i) % probabilities));
-
-      arma::mat cov = (tmp * trans(tmpB)) / probRowSums[i];
+      const arma::mat centered = observations.each_col() - dists[i].Mean();
+      CovarianceType cov = Traits::Scatter(centered,
+          condProb.col(i) % probabilities) / probRowSums[i];
 
       // Apply covariance constraint.
       constraint.ApplyConstraint(cov);
@@ -211,18 +191,21 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     // probabilities.
     weights = probRowSums / accu(probabilities);
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate new log-likelihood, and the conditional
+    // probabilities for the next iteration.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = ComputeResponsibilities(observations, dists, weights, &condProb);
 
     iteration++;
   }
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
 InitialClustering(const arma::mat& observations,
-                  std::vector<distribution::GaussianDistribution>& dists,
+                  std::vector<Distribution>& dists,
                   arma::vec& weights)
 {
   // Assignments from clustering.
@@ -232,7 +215,7 @@ InitialClustering(const arma::mat& observations,
   clusterer.Cluster(observations, dists.size(), assignments);
 
   std::vector<arma::vec> means(dists.size());
-  std::vector<arma::mat> covs(dists.size());
+  std::vector<CovarianceType> covs(dists.size());
 
   // Now calculate the means, covariances, and weights.
   weights.zeros();
@@ -252,7 +235,7 @@ InitialClustering(const arma::mat& observations,
     means[cluster] += observations.col(i);
 
     // Add this to the relevant covariance.
-    covs[cluster] += observations.col(i) * trans(observations.col(i));
+    covs[cluster] += Traits::Outer(observations.col(i));
 
     // Now add one to the weights (we will normalize).
     weights[cluster]++;
@@ -268,7 +251,7 @@ InitialClustering(const arma::mat& observations,
   {
     const size_t cluster = assignments[i];
     const arma::vec normObs = observations.col(i) - means[cluster];
-    covs[cluster] += normObs * normObs.t();
+    covs[cluster] += Traits::Outer(normObs);
   }
 
   for (size_t i = 0; i < dists.size(); ++i)
@@ -286,44 +269,126 @@ InitialClustering(const arma::mat& observations,
   weights /= accu(weights);
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::LogLikelihood(
-    const arma::mat& observations,
-    const std::vector<distribution::GaussianDistribution>& dists,
-    const arma::vec& weights) const
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+MiniBatchEstimate(const arma::mat& observations,
+                  const arma::vec* probabilities,
+                  std::vector<Distribution>& dists,
+                  arma::vec& weights)
 {
-  double logLikelihood = 0;
-
-  arma::vec phis;
-  arma::mat likelihoods(dists.size(), observations.n_cols);
-
-  for (size_t i = 0; i < dists.size(); ++i)
+  const size_t k = dists.size();
+  const size_t numBatches = (observations.n_cols + batchSize - 1) / batchSize;
+
+  // The running sufficient statistics, per unit of probability mass: the
+  // weight, and the weighted first and second moments of each component.
+  arma::vec s0 = weights;
+  arma::mat s1(observations.n_rows, k);
+  std::vector<CovarianceType> s2(k);
+  for (size_t i = 0; i < k; ++i)
   {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
+    s1.col(i) = weights[i] * dists[i].Mean();
+    s2[i] = weights[i] * (dists[i].Covariance() +
+        Traits::Outer(dists[i].Mean()));
   }
-  // Now sum over every point.
-  for (size_t j = 0; j < observations.n_cols; ++j)
+
+  double lOld = -DBL_MAX;
+  double l = DBL_MAX;
+  size_t t = 0;
+  for (size_t iteration = 1; std::abs(l - lOld) > tolerance &&
+       iteration != maxIterations; ++iteration)
   {
-    if (accu(likelihoods.col(j)) == 0)
-      Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
-          << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
-  }
+    lOld = l;
+    l = 0.0;
+
+    // The order is shuffled with math::RandInt(), so that it comes from the
+    // random stream of the calling thread (see GMM::Train()).
+    std::vector<size_t> order(numBatches);
+    for (size_t b = 0; b < numBatches; ++b)
+      order[b] = b;
+    for (size_t b = numBatches; b > 1; --b)
+      std::swap(order[b - 1], order[math::RandInt(b)]);
+
+    for (size_t b = 0; b < numBatches; ++b, ++t)
+    {
+      const size_t begin = order[b] * batchSize;
+      const size_t end = std::min(begin + batchSize, observations.n_cols) - 1;
+      const arma::mat batch = observations.cols(begin, end);
+
+      // E-step on the batch only.
+      arma::mat condProb;
+      l += ComputeResponsibilities(batch, dists, weights, &condProb);
+
+      // Weight each point by the probability of it being from this model.
+      double mass = (double) batch.n_cols;
+      if (probabilities != NULL)
+      {
+        const arma::vec batchProbabilities = probabilities->subvec(begin, end);
+        condProb.each_col() %= batchProbabilities;
+        mass = arma::accu(batchProbabilities);
+      }
+      if (mass == 0.0)
+        continue;
+
+      const double stepSize = std::pow(t + 2.0, -stepSizeDecay);
+
+      // Move the statistics towards those of the batch, and update each
+      // component from them.
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) k; ++i)
+      {
+        const arma::vec r = condProb.col(i) / mass;
+        s0[i] = (1.0 - stepSize) * s0[i] + stepSize * arma::accu(r);
+        s1.col(i) = (1.0 - stepSize) * s1.col(i) + stepSize * (batch * r);
+        s2[i] = (1.0 - stepSize) * s2[i] +
+            stepSize * Traits::Scatter(batch, r);
+
+        // Don't update if there's no probability of the Gaussian having
+        // points.
+        if (s0[i] == 0.0)
+          continue;
+
+        dists[i].Mean() = s1.col(i) / s0[i];
+        CovarianceType covariance = s2[i] / s0[i] -
+            Traits::Outer(dists[i].Mean());
+        // Apply covariance constraint.
+        constraint.ApplyConstraint(covariance);
+        dists[i].Covariance(std::move(covariance));
+      }
+
+      weights = s0 / arma::accu(s0);
+    }
 
-  return logLikelihood;
+    Log::Info << "EMFit::Estimate(): mini-batch iteration " << iteration
+        << ", log-likelihood " << l << "." << std::endl;
+  }
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
 template<typename Archive>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Serialize(
-    Archive& ar,
-    const unsigned int /* version */)
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Serialize(Archive& ar, const unsigned int version)
 {
   using data::CreateNVP;
 
   ar & CreateNVP(maxIterations, "maxIterations");
   ar & CreateNVP(tolerance, "tolerance");
+
+  // Older versions did not support mini-batch EM.
+  if (version >= 1)
+  {
+    ar & CreateNVP(batchSize, "batchSize");
+    ar & CreateNVP(stepSizeDecay, "stepSizeDecay");
+  }
+  else if (Archive::is_loading::value)
+  {
+    batchSize = 0;
+    stepSizeDecay = 0.6;
+  }
+
   ar & CreateNVP(clusterer, "clusterer");
   ar & CreateNVP(constraint, "constraint");
 }
@@ -331,10 +396,12 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Serialize(
 // Armadillo uses uword internally as an OpenMP index type, which crashes Visual
 // Studio.
 #ifndef _WIN32
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
 ArmadilloGMMWrapper(const arma::mat& observations,
-                    std::vector<distribution::GaussianDistribution>& dists,
+                    std::vector<Distribution>& dists,
                     arma::vec& weights,
                     const bool useInitialModel)
 {
@@ -363,7 +430,7 @@ ArmadilloGMMWrapper(const arma::mat& observations,
     for (size_t i = 0; i < dists.size(); ++i)
     {
       means.col(i) = dists[i].Mean();
-      covs.col(i) = dists[i].Covariance().diag();
+      covs.col(i) = Traits::Diagonal(dists[i].Covariance());
     }
 
     g.reset(observations.n_rows, dists.size());
@@ -385,7 +452,7 @@ ArmadilloGMMWrapper(const arma::mat& observations,
   for (size_t i = 0; i < dists.size(); ++i)
   {
     dists[i].Mean() = g.means.col(i);
-    dists[i].Covariance(std::move(arma::diagmat(g.dcovs.col(i))));
+    dists[i].Covariance(Traits::FromDiagonal(arma::vec(g.dcovs.col(i))));
   }
 }
 #endif
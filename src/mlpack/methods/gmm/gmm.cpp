@@ -76,6 +76,38 @@ double GMM::Probability(const arma::vec& observation,
   return weights[component] * dists[component].Probability(observation);
 }
 
+/**
+ * Return the log-probability of each of the given observations under this GMM.
+ */
+void GMM::LogProbability(const arma::mat& observations,
+                         arma::vec& logProbabilities) const
+{
+  logProbabilities.set_size(observations.n_cols);
+  const size_t numBlocks = (observations.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize,
+        (size_t) observations.n_cols);
+
+    arma::mat logProbs;
+    ComponentLogProbabilities(observations.cols(begin, end - 1), logProbs);
+
+    // Sum the densities of each observation with the log-sum-exp trick.
+    for (size_t j = 0; j < logProbs.n_cols; ++j)
+    {
+      const double maxLogProb = logProbs.col(j).max();
+      if (maxLogProb == -std::numeric_limits<double>::infinity())
+        logProbabilities[begin + j] = maxLogProb;
+      else
+        logProbabilities[begin + j] = maxLogProb + std::log(arma::accu(
+            arma::exp(logProbs.col(j) - maxLogProb)));
+    }
+  }
+}
+
 /**
  * Return a randomly generated observation according to the probability
  * distribution defined by this object.
@@ -108,27 +140,51 @@ arma::vec GMM::Random() const
 void GMM::Classify(const arma::mat& observations,
                    arma::Row<size_t>& labels) const
 {
-  // This is not the best way to do this!
+  labels.zeros(observations.n_cols);
+  const size_t numBlocks = (observations.n_cols + BlockSize - 1) / BlockSize;
 
-  // We should not have to fill this with values, because each one should be
-  // overwritten.
-  labels.set_size(observations.n_cols);
-  for (size_t i = 0; i < observations.n_cols; ++i)
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
-    // Find maximum probability component.
-    double probability = 0;
-    for (size_t j = 0; j < gaussians; ++j)
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize,
+        (size_t) observations.n_cols);
+
+    arma::mat logProbs;
+    ComponentLogProbabilities(observations.cols(begin, end - 1), logProbs);
+
+    // Find the maximum probability component; ties go to the last one.
+    for (size_t j = 0; j < logProbs.n_cols; ++j)
     {
-      double newProb = Probability(observations.unsafe_col(i), j);
-      if (newProb >= probability)
+      double best = -std::numeric_limits<double>::infinity();
+      for (size_t i = 0; i < gaussians; ++i)
       {
-        probability = newProb;
-        labels[i] = j;
+        if (logProbs(i, j) >= best)
+        {
+          best = logProbs(i, j);
+          labels[begin + j] = i;
+        }
       }
     }
   }
 }
 
+/**
+ * Compute the weighted log-densities of every component for the given
+ * observations.
+ */
+void GMM::ComponentLogProbabilities(const arma::mat& observations,
+                                    arma::mat& logProbs) const
+{
+  logProbs.set_size(gaussians, observations.n_cols);
+  arma::vec componentLogProbs;
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    dists[i].LogProbability(observations, componentLogProbs);
+    logProbs.row(i) = componentLogProbs.t() + std::log(weights[i]);
+  }
+}
+
 /**
  * Get the log-likelihood of this data's fit to the model.
  */
@@ -137,20 +193,7 @@ double GMM::LogLikelihood(
     const std::vector<distribution::GaussianDistribution>& distsL,
     const arma::vec& weightsL) const
 {
-  double loglikelihood = 0;
-  arma::vec phis;
-  arma::mat likelihoods(gaussians, data.n_cols);
-
-  for (size_t i = 0; i < gaussians; i++)
-  {
-    distsL[i].Probability(data, phis);
-    likelihoods.row(i) = weightsL(i) * trans(phis);
-  }
-
-  // Now sum over every point.
-  for (size_t j = 0; j < data.n_cols; j++)
-    loglikelihood += log(accu(likelihoods.col(j)));
-  return loglikelihood;
+  return ComputeLogLikelihood(data, distsL, weightsL);
 }
 
 } // namespace gmm
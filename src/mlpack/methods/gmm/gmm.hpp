@@ -18,6 +18,7 @@
 
 // This is the default fitting method class.
 #include "em_fit.hpp"
+#include "train_trials.hpp"
 
 namespace mlpack {
 namespace gmm /** Gaussian Mixture Models. */ {
@@ -175,6 +176,17 @@ class GMM
   double Probability(const arma::vec& observation,
                      const size_t component) const;
 
+  /**
+   * Compute the log-probability of each of the given observations under this
+   * model.  The observations are processed in blocks, in parallel with OpenMP,
+   * so this is much faster than calling Probability() for each observation.
+   *
+   * @param observations Observations to evaluate, one per column.
+   * @param logProbabilities Vector to store the log-probabilities in.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -190,6 +202,9 @@ class GMM
    * The fitting will be performed 'trials' times; from these trials, the model
    * with the greatest log-likelihood will be selected.  By default, only one
    * trial is performed.  The log-likelihood of the best fitting is returned.
+   * The trials run in parallel; each uses its own copy of the fitter and its
+   * own random stream, so the chosen model does not depend on the number of
+   * threads (see TrainTrials()).
    *
    * Optionally, the existing model can be used as an initial model for the
    * estimation by setting 'useExistingModel' to true.  If the fitting procedure
@@ -220,6 +235,9 @@ class GMM
    * The fitting will be performed 'trials' times; from these trials, the model
    * with the greatest log-likelihood will be selected.  By default, only one
    * trial is performed.  The log-likelihood of the best fitting is returned.
+   * The trials run in parallel; each uses its own copy of the fitter and its
+   * own random stream, so the chosen model does not depend on the number of
+   * threads (see TrainTrials()).
    *
    * Optionally, the existing model can be used as an initial model for the
    * estimation by setting 'useExistingModel' to true.  If the fitting procedure
@@ -268,6 +286,21 @@ class GMM
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  //! Number of observations that are evaluated together by LogProbability()
+  //! and Classify().
+  static const size_t BlockSize = 1024;
+
+  /**
+   * Compute the weighted log-densities of every component for the given
+   * observations: element (i, j) of logProbs is the log of the density of
+   * component i at observation j, times the weight of component i.
+   *
+   * @param observations Observations to evaluate, one per column.
+   * @param logProbs Matrix to store the weighted log-densities in.
+   */
+  void ComponentLogProbabilities(const arma::mat& observations,
+                                 arma::mat& logProbs) const;
+
   /**
    * This function computes the loglikelihood of the given model.  This function
    * is used by GMM::Train().
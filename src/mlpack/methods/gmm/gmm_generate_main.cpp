@@ -56,7 +56,8 @@ void mlpackMain()
   if (CLI::GetParam<int>("samples") < 0)
     Log::Fatal << "Parameter to --samples must be greater than 0!" << endl;
 
-  GMM gmm = std::move(CLI::GetParam<GMM>("input_model"));
+  // The model is used in place, so that it is not consumed.
+  const GMM& gmm = CLI::GetParam<GMM>("input_model");
 
   size_t length = (size_t) CLI::GetParam<int>("samples");
   Log::Info << "Generating " << length << " samples..." << endl;
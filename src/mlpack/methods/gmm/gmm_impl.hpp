@@ -44,54 +44,15 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
-    {
-      distsOrig = dists;
-      weightsOrig = weights;
-    }
-
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, dists, weights, useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
+    // The trials run in parallel, each with its own copy of the model.
+    arma::vec trialLikelihoods;
+    bestLikelihood = TrainTrials(observations, NULL, trials,
+        useExistingModel, fitter, dists, weights, trialLikelihoods);
 
-    Log::Info << "GMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
-
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
-
-    for (size_t trial = 1; trial < trials; ++trial)
+    for (size_t trial = 0; trial < trials; ++trial)
     {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
-
-      fitter.Estimate(observations, distsTrial, weightsTrial, useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
-      Log::Info << "GMM::Train(): Log-likelihood of trial " << trial << " is "
-          << newLikelihood << "." << std::endl;
-
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
-
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
+      Log::Info << "GMM::Train(): Log-likelihood of trial " << trial
+          << " is " << trialLikelihoods[trial] << "." << std::endl;
     }
   }
 
@@ -128,56 +89,15 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
-    {
-      distsOrig = dists;
-      weightsOrig = weights;
-    }
-
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, probabilities, dists, weights,
-        useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
-
-    Log::Debug << "GMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
-
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
+    // The trials run in parallel, each with its own copy of the model.
+    arma::vec trialLikelihoods;
+    bestLikelihood = TrainTrials(observations, &probabilities, trials,
+        useExistingModel, fitter, dists, weights, trialLikelihoods);
 
-    for (size_t trial = 1; trial < trials; ++trial)
+    for (size_t trial = 0; trial < trials; ++trial)
     {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
-
-      fitter.Estimate(observations, probabilities, distsTrial, weightsTrial,
-          useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
-      Log::Debug << "GMM::Train(): Log-likelihood of trial " << trial << " is "
-          << newLikelihood << "." << std::endl;
-
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
-
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
+      Log::Debug << "GMM::Train(): Log-likelihood of trial " << trial
+          << " is " << trialLikelihoods[trial] << "." << std::endl;
     }
   }
 
@@ -13,6 +13,7 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/mlpack_main.hpp>
 #include "gmm.hpp"
+#include "diagonal_gmm.hpp"
 
 using namespace std;
 using namespace mlpack;
@@ -47,14 +48,44 @@ void mlpackMain()
         << "saved!" << endl;
 
   // Get the GMM and the points.
-  GMM gmm = std::move(CLI::GetParam<GMM>("input_model"));
+  const GMM& gmm = CLI::GetParam<GMM>("input_model");
 
   arma::mat dataset = std::move(CLI::GetParam<arma::mat>("input"));
 
+  // If every covariance is diagonal (for instance, because the model was
+  // trained with --diagonal_covariance), a DiagonalGMM gives the same
+  // probabilities in O(d) time per point and component.
+  bool diagonal = true;
+  for (size_t i = 0; i < gmm.Gaussians() && diagonal; ++i)
+  {
+    const arma::mat& covariance = gmm.Component(i).Covariance();
+    diagonal = arma::all(arma::vectorise(covariance -
+        arma::diagmat(covariance)) == 0.0) &&
+        arma::all(covariance.diag() > 0.0);
+  }
+
   // Now calculate the probabilities.
   arma::rowvec probabilities(dataset.n_cols);
-  for (size_t i = 0; i < dataset.n_cols; ++i)
-    probabilities[i] = gmm.Probability(dataset.unsafe_col(i));
+  if (diagonal)
+  {
+    std::vector<distribution::DiagonalGaussianDistribution> dists;
+    for (size_t i = 0; i < gmm.Gaussians(); ++i)
+    {
+      dists.push_back(distribution::DiagonalGaussianDistribution(
+          gmm.Component(i).Mean(), gmm.Component(i).Covariance().diag()));
+    }
+
+    arma::vec logProbabilities;
+    DiagonalGMM(dists, gmm.Weights()).LogProbability(dataset,
+        logProbabilities);
+    probabilities = arma::exp(logProbabilities).t();
+  }
+  else
+  {
+    arma::vec logProbabilities;
+    gmm.LogProbability(dataset, logProbabilities);
+    probabilities = arma::exp(logProbabilities).t();
+  }
 
   // And save the result.
   if (CLI::HasParam("output"))
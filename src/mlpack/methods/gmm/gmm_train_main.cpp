@@ -14,6 +14,7 @@
 #include <mlpack/core/util/mlpack_main.hpp>
 
 #include "gmm.hpp"
+#include "diagonal_gmm.hpp"
 #include "no_constraint.hpp"
 #include "diagonal_constraint.hpp"
 
@@ -58,6 +59,14 @@ PROGRAM_INFO("Gaussian Mixture Model (GMM) Training",
     "causes training to be faster, but restricts the ability to fit more "
     "complex GMMs."
     "\n\n"
+    "For large datasets, the " + PRINT_PARAM_STRING("batch_size") + " "
+    "parameter trains with stepwise mini-batch EM: each iteration is one pass "
+    "over the data in random batches of that many points, and the model is "
+    "updated after every batch, so only the responsibilities of one batch are "
+    "stored.  The step size of the t'th batch is (t + 2)^(-d), where d is "
+    "given with the " + PRINT_PARAM_STRING("step_size_decay") + " parameter "
+    "and should be in (0.5, 1]."
+    "\n\n"
     "If GMM training fails with an error indicating that a covariance matrix "
     "could not be inverted, make sure that the " +
     PRINT_PARAM_STRING("no_force_positive") + " parameter is not "
@@ -102,6 +111,10 @@ PARAM_INT_IN("max_iterations", "Maximum number of iterations of EM algorithm "
     "(passing 0 will run until convergence).", "n", 250);
 PARAM_FLAG("diagonal_covariance", "Force the covariance of the Gaussians to "
     "be diagonal.  This can accelerate training time significantly.", "d");
+PARAM_INT_IN("batch_size", "If nonzero, use mini-batch EM with batches of this "
+    "many points.", "b", 0);
+PARAM_DOUBLE_IN("step_size_decay", "Decay of the step size of mini-batch EM "
+    "(should be in (0.5, 1]).", "D", 0.6);
 
 // Parameters for dataset modification.
 PARAM_DOUBLE_IN("noise", "Variance of zero-mean Gaussian noise to add to data.",
@@ -121,6 +134,43 @@ PARAM_MODEL_IN(GMM, "input_model", "Initial input GMM model to start training "
     "with.", "m");
 PARAM_MODEL_OUT(GMM, "output_model", "Output for trained GMM model.", "M");
 
+// Set the mini-batch parameters of the EM fitter and train the GMM with it.
+template<typename GMMType, typename FittingType>
+double TrainGMM(GMMType& gmm, const arma::mat& dataPoints, FittingType& em)
+{
+  em.BatchSize() = (size_t) CLI::GetParam<int>("batch_size");
+  em.StepSizeDecay() = CLI::GetParam<double>("step_size_decay");
+
+  // Compute the parameters of the model using the EM algorithm.
+  Timer::Start("em");
+  const double likelihood = gmm.Train(dataPoints,
+      CLI::GetParam<int>("trials"), false, em);
+  Timer::Stop("em");
+
+  return likelihood;
+}
+
+// Train a DiagonalGMM with the same size as the given GMM, and store the result
+// in the GMM, since models are always saved as GMMs.
+template<typename FittingType>
+double TrainDiagonalGMM(GMM& gmm, const arma::mat& dataPoints, FittingType& em)
+{
+  DiagonalGMM diagonalGMM(gmm.Gaussians(), gmm.Dimensionality());
+  const double likelihood = TrainGMM(diagonalGMM, dataPoints, em);
+
+  std::vector<distribution::GaussianDistribution> dists;
+  for (size_t i = 0; i < diagonalGMM.Gaussians(); ++i)
+  {
+    const distribution::DiagonalGaussianDistribution& d =
+        diagonalGMM.Component(i);
+    dists.push_back(distribution::GaussianDistribution(d.Mean(),
+        arma::diagmat(d.Covariance())));
+  }
+  gmm = GMM(dists, diagonalGMM.Weights());
+
+  return likelihood;
+}
+
 void mlpackMain()
 {
   // Check parameters and load data.
@@ -141,6 +191,16 @@ void mlpackMain()
     Log::Warn << "--no_force_positive ignored because --diagonal_covariance is "
         << "specified!" << endl;
 
+  if (CLI::GetParam<int>("batch_size") < 0)
+  {
+    Log::Fatal << "Invalid batch size (" << CLI::GetParam<int>("batch_size")
+        << "); must be greater than or equal to 0." << std::endl;
+  }
+
+  if (CLI::HasParam("step_size_decay") && !CLI::HasParam("batch_size"))
+    Log::Warn << "--step_size_decay ignored because --batch_size is not "
+        << "specified!" << endl;
+
   if (!CLI::HasParam("output_model"))
     Log::Warn << "--output_model_file is not specified, so no model will be "
         << "saved!" << endl;
@@ -204,30 +264,20 @@ void mlpackMain()
     // to use different types.
     if (diagonalCovariance)
     {
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
-      EMFit<KMeansType, DiagonalConstraint> em(maxIterations, tolerance, k);
-      likelihood = gmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
-      Timer::Stop("em");
+      EMFit<KMeansType, DiagonalConstraint,
+          distribution::DiagonalGaussianDistribution> em(maxIterations,
+          tolerance, k);
+      likelihood = TrainDiagonalGMM(gmm, dataPoints, em);
     }
     else if (forcePositive)
     {
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
       EMFit<KMeansType> em(maxIterations, tolerance, k);
-      likelihood = gmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
-      Timer::Stop("em");
+      likelihood = TrainGMM(gmm, dataPoints, em);
     }
     else
     {
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
       EMFit<KMeansType, NoConstraint> em(maxIterations, tolerance, k);
-      likelihood = gmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
-      Timer::Stop("em");
+      likelihood = TrainGMM(gmm, dataPoints, em);
     }
   }
   else
@@ -236,30 +286,18 @@ void mlpackMain()
     // to use different types.
     if (diagonalCovariance)
     {
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
-      EMFit<kmeans::KMeans<>, DiagonalConstraint> em(maxIterations, tolerance);
-      likelihood = gmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
-      Timer::Stop("em");
+      DiagonalGMM::DefaultFittingType em(maxIterations, tolerance);
+      likelihood = TrainDiagonalGMM(gmm, dataPoints, em);
     }
     else if (forcePositive)
     {
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
       EMFit<> em(maxIterations, tolerance);
-      likelihood = gmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
-      Timer::Stop("em");
+      likelihood = TrainGMM(gmm, dataPoints, em);
     }
     else
     {
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
       EMFit<KMeans<>, NoConstraint> em(maxIterations, tolerance);
-      likelihood = gmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
-      Timer::Stop("em");
+      likelihood = TrainGMM(gmm, dataPoints, em);
     }
   }
 
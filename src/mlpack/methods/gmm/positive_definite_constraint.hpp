@@ -62,6 +62,19 @@ class PositiveDefiniteConstraint
     }
   }
 
+  /**
+   * Apply the same constraint to a diagonal covariance, whose eigenvalues are
+   * its elements: no element may be smaller than 1e-50, or than 1e-5 times the
+   * largest element.
+   *
+   * @param diagCovariance Diagonal of the covariance matrix.
+   */
+  static void ApplyConstraint(arma::vec& diagCovariance)
+  {
+    const double minEigval = std::max(diagCovariance.max() / 1e5, 1e-50);
+    diagCovariance = arma::clamp(diagCovariance, minEigval, DBL_MAX);
+  }
+
   //! Serialize the constraint (which stores nothing, so, nothing to do).
   template<typename Archive>
   static void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
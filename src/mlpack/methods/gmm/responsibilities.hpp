@@ -0,0 +1,139 @@
+/**
+ * @file responsibilities.hpp
+ *
+ * The E-step of the EM algorithm for GMMs: compute the log-likelihood of a set
+ * of observations under a GMM, and optionally the posterior probability of each
+ * component for each observation.  The observations are processed in blocks,
+ * in log space, with several threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_RESPONSIBILITIES_HPP
+#define MLPACK_METHODS_GMM_RESPONSIBILITIES_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * Compute the log-likelihood of the given observations under the GMM with the
+ * given components and weights.  If responsibilities is not NULL, it is set to
+ * an (n x k) matrix whose element (j, i) is the posterior probability that
+ * observation j comes from component i.
+ *
+ * The observations are split into blocks, which are divided between the OpenMP
+ * threads.  For each block, the log-densities of all components are computed,
+ * and the likelihood of each observation is summed with the log-sum-exp trick,
+ * so that observations far from every component still get proper
+ * responsibilities.  Observations with likelihood zero under every component
+ * get zero responsibilities and add -inf to the log-likelihood.
+ *
+ * @tparam DistributionType Type of the components; it must provide
+ *     LogProbability(const arma::mat&, arma::vec&), as GaussianDistribution
+ *     and DiagonalGaussianDistribution do.
+ * @param observations Observations, one per column.
+ * @param dists Components of the GMM.
+ * @param weights A priori weights of the components.
+ * @param responsibilities If not NULL, matrix to store the responsibilities in.
+ * @param blockSize Number of observations in each block.
+ * @return Log-likelihood of the observations.
+ */
+template<typename DistributionType>
+double ComputeResponsibilities(
+    const arma::mat& observations,
+    const std::vector<DistributionType>& dists,
+    const arma::vec& weights,
+    arma::mat* responsibilities,
+    const size_t blockSize = 1024)
+{
+  const size_t n = observations.n_cols;
+  const size_t k = dists.size();
+  if (responsibilities != NULL)
+    responsibilities->set_size(n, k);
+
+  const arma::vec logWeights = arma::log(weights);
+  const size_t numBlocks = (n + blockSize - 1) / blockSize;
+
+  // The log-likelihood of each block is kept, and they are summed in order, so
+  // that the result does not depend on the number of threads.
+  arma::vec blockLogLikelihoods(numBlocks, arma::fill::zeros);
+  size_t zeroPoints = 0;
+
+  #pragma omp parallel for schedule(dynamic) num_threads(ParallelThreads()) \
+      reduction(+:zeroPoints)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    double& logLikelihood = blockLogLikelihoods[b];
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, n);
+    const arma::mat block = observations.cols(begin, end - 1);
+
+    // Column j holds the weighted log-densities of observation j.
+    arma::mat logProbs(k, block.n_cols);
+    arma::vec componentLogProbs;
+    for (size_t i = 0; i < k; ++i)
+    {
+      dists[i].LogProbability(block, componentLogProbs);
+      logProbs.row(i) = componentLogProbs.t() + logWeights[i];
+    }
+
+    for (size_t j = 0; j < logProbs.n_cols; ++j)
+    {
+      const double maxLogProb = logProbs.col(j).max();
+      if (maxLogProb == -std::numeric_limits<double>::infinity())
+      {
+        // Avoid NaNs; this point gets no responsibilities at all.
+        logProbs.col(j).zeros();
+        logLikelihood += maxLogProb;
+        ++zeroPoints;
+        continue;
+      }
+
+      const double logSum = maxLogProb +
+          std::log(arma::accu(arma::exp(logProbs.col(j) - maxLogProb)));
+      logProbs.col(j) = arma::exp(logProbs.col(j) - logSum);
+      logLikelihood += logSum;
+    }
+
+    if (responsibilities != NULL)
+      responsibilities->rows(begin, end - 1) = logProbs.t();
+  }
+
+  double logLikelihood = 0.0;
+  for (size_t b = 0; b < numBlocks; ++b)
+    logLikelihood += blockLogLikelihoods[b];
+
+  if (zeroPoints > 0)
+    Log::Info << "Likelihood of " << zeroPoints << " points is 0!  They are "
+        << "probably outliers." << std::endl;
+
+  return logLikelihood;
+}
+
+/**
+ * Compute the log-likelihood of the given observations under the GMM with the
+ * given components and weights, without storing any responsibilities.
+ *
+ * @param observations Observations, one per column.
+ * @param dists Components of the GMM.
+ * @param weights A priori weights of the components.
+ * @return Log-likelihood of the observations.
+ */
+template<typename DistributionType>
+double ComputeLogLikelihood(
+    const arma::mat& observations,
+    const std::vector<DistributionType>& dists,
+    const arma::vec& weights)
+{
+  return ComputeResponsibilities(observations, dists, weights,
+      (arma::mat*) NULL);
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
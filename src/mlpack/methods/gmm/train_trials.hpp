@@ -0,0 +1,115 @@
+/**
+ * @file train_trials.hpp
+ *
+ * Run several trials of fitting a GMM in parallel, and keep the model with the
+ * greatest log-likelihood.  This is used by GMM::Train() and
+ * DiagonalGMM::Train() when more than one trial is requested.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_TRAIN_TRIALS_HPP
+#define MLPACK_METHODS_GMM_TRAIN_TRIALS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "responsibilities.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * Fit the given model 'trials' times, with each trial running on an OpenMP
+ * thread, and replace the model with the fit that has the greatest
+ * log-likelihood (the first one, if several are equally good).  Each trial
+ * uses its own copy of the fitter and draws its random numbers from its own
+ * math::RandomStream, so the result does not depend on the number of threads
+ * or on the order in which the trials run.
+ *
+ * Log::Info (and Log::Debug) are silenced while the trials run, since the
+ * messages of concurrent trials would be interleaved; the log-likelihood of
+ * each trial is returned in trialLikelihoods instead, so that the caller can
+ * report them.
+ *
+ * @tparam FittingType Type of the fitter, as for GMM::Train().
+ * @tparam DistributionType Type of the components of the model.
+ * @param observations Observations of the model.
+ * @param probabilities Probability of each observation being from this
+ *     distribution, or NULL if all observations are from it.
+ * @param trials Number of trials to perform.
+ * @param useExistingModel If true, each trial starts from the given model.
+ * @param fitter Fitter to copy for each trial.
+ * @param dists Components of the model; set to those of the best fit.
+ * @param weights Weights of the model; set to those of the best fit.
+ * @param trialLikelihoods Set to the log-likelihood of each trial.
+ * @return The log-likelihood of the best fit.
+ */
+template<typename FittingType, typename DistributionType>
+double TrainTrials(const arma::mat& observations,
+                   const arma::vec* probabilities,
+                   const size_t trials,
+                   const bool useExistingModel,
+                   const FittingType& fitter,
+                   std::vector<DistributionType>& dists,
+                   arma::vec& weights,
+                   arma::vec& trialLikelihoods)
+{
+  // Every trial starts from a copy of the model; if the existing model is not
+  // used, the copies only give the shapes of the components.
+  std::vector<std::vector<DistributionType>> trialDists(trials, dists);
+  std::vector<arma::vec> trialWeights(trials, weights);
+  trialLikelihoods.set_size(trials);
+
+  const uint64_t seed = math::RandomStreamSeed();
+
+  const bool infoIgnored = Log::Info.ignoreInput;
+  Log::Info.ignoreInput = true;
+#ifdef DEBUG
+  const bool debugIgnored = Log::Debug.ignoreInput;
+  Log::Debug.ignoreInput = true;
+#endif
+
+  // The trials may take very different numbers of iterations.
+  #pragma omp parallel for schedule(dynamic) num_threads(ParallelThreads())
+  for (omp_size_t trial = 0; trial < (omp_size_t) trials; ++trial)
+  {
+    math::RandomStream stream(seed, trial);
+    math::RandomStreamScope scope(stream);
+
+    FittingType trialFitter(fitter);
+    if (probabilities == NULL)
+    {
+      trialFitter.Estimate(observations, trialDists[trial],
+          trialWeights[trial], useExistingModel);
+    }
+    else
+    {
+      trialFitter.Estimate(observations, *probabilities, trialDists[trial],
+          trialWeights[trial], useExistingModel);
+    }
+
+    trialLikelihoods[trial] = ComputeLogLikelihood(observations,
+        trialDists[trial], trialWeights[trial]);
+  }
+
+  Log::Info.ignoreInput = infoIgnored;
+#ifdef DEBUG
+  Log::Debug.ignoreInput = debugIgnored;
+#endif
+
+  size_t best = 0;
+  for (size_t trial = 1; trial < trials; ++trial)
+    if (trialLikelihoods[trial] > trialLikelihoods[best])
+      best = trial;
+
+  dists = std::move(trialDists[best]);
+  weights = std::move(trialWeights[best]);
+  return trialLikelihoods[best];
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,10 @@
 #define MLPACK_METHODS_HMM_HMM_HPP
 
 #include <mlpack/prereqs.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 #include <mlpack/core/dists/discrete_distribution.hpp>
 
 namespace mlpack {
@@ -158,6 +162,10 @@ class HMM
    * log-likelihood of the model between iterations is less than the tolerance,
    * the Baum-Welch algorithm terminates.
    *
+   * The E-step is run on the sequences in parallel with OpenMP; each thread
+   * accumulates the initial and transition probabilities of its own
+   * contiguous chunk of sequences, and the chunks are added in order.
+   *
    * @note
    * Train() can be called multiple times with different sequences; each time it
    * is called, it uses the current parameters of the HMM as a starting point
@@ -267,6 +275,34 @@ class HMM
    */
   double LogLikelihood(const arma::mat& dataSeq) const;
 
+  /**
+   * Compute the most probable hidden state sequence of each of the given data
+   * sequences, using the Viterbi algorithm.  The sequences are decoded in
+   * parallel with OpenMP, and each thread reuses the same trellis for all the
+   * sequences it decodes.
+   *
+   * @param dataSeq Vector of observation sequences.
+   * @param stateSeq Vector in which the most probable state sequence of each
+   *    observation sequence will be stored.
+   * @param logLikelihoods Vector in which the log-likelihood of the most
+   *    probable state sequence of each observation sequence will be stored.
+   */
+  void Predict(const std::vector<arma::mat>& dataSeq,
+               std::vector<arma::Row<size_t>>& stateSeq,
+               arma::vec& logLikelihoods) const;
+
+  /**
+   * Compute the log-likelihood of each of the given data sequences.  The
+   * sequences are scored in parallel with OpenMP, and each thread reuses the
+   * same forward probability matrix for all the sequences it scores.
+   *
+   * @param dataSeq Vector of data sequences to evaluate the likelihood of.
+   * @param logLikelihoods Vector in which the log-likelihood of each sequence
+   *    will be stored.
+   */
+  void LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                     arma::vec& logLikelihoods) const;
+
   /**
    * HMM filtering. Computes the k-step-ahead expected emission at each time
    * conditioned only on prior observations. That is
@@ -330,6 +366,36 @@ class HMM
 
  protected:
   // Helper functions.
+  /**
+   * Compute the log-probability of each observation of the given sequence
+   * under the emission distribution of each state.  The returned matrix has
+   * rows equal to the number of hidden states and columns equal to the number
+   * of observations.  If the distribution has a batch method
+   * LogProbability(const arma::mat&, arma::vec&) const, as the Gaussian
+   * distributions and GMMs do, each state is evaluated with one call to it;
+   * otherwise Probability() is called for each observation.
+   *
+   * The forward-backward algorithm and the Viterbi algorithm need the same
+   * emission probabilities several times, so they are computed once for each
+   * sequence with this function.
+   *
+   * @param dataSeq Data sequence to compute log-probabilities for.
+   * @param logEmission Matrix in which the log-probabilities will be saved.
+   */
+  void EmissionLogProbability(const arma::mat& dataSeq,
+                              arma::mat& logEmission) const;
+
+  /**
+   * Compute the probability of each observation of the given sequence under
+   * the emission distribution of each state; this is the exponential of the
+   * matrix given by EmissionLogProbability().
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param emissionProb Matrix in which the probabilities will be saved.
+   */
+  void EmissionProbability(const arma::mat& dataSeq,
+                           arma::mat& emissionProb) const;
+
   /**
    * The Forward algorithm (part of the Forward-Backward algorithm).  Computes
    * forward probabilities for each state for each observation in the given data
@@ -359,6 +425,86 @@ class HMM
                 const arma::vec& scales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Run the Forward algorithm with the given emission probabilities (as given
+   * by EmissionProbability()) of a data sequence.
+   *
+   * @param emissionProb Emission probabilities of each state for each
+   *     observation.
+   * @param scales Vector in which scaling factors will be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void ForwardWithEmission(const arma::mat& emissionProb,
+                           arma::vec& scales,
+                           arma::mat& forwardProb) const;
+
+  /**
+   * Run the Backward algorithm with the given emission probabilities (as given
+   * by EmissionProbability()) of a data sequence.
+   *
+   * @param emissionProb Emission probabilities of each state for each
+   *     observation.
+   * @param scales Vector of scaling factors.
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void BackwardWithEmission(const arma::mat& emissionProb,
+                            const arma::vec& scales,
+                            arma::mat& backwardProb) const;
+
+  /**
+   * Run the Forward-Backward algorithm with the given emission probabilities
+   * (as given by EmissionProbability()) of a data sequence; see Estimate().
+   *
+   * @param emissionProb Emission probabilities of each state for each
+   *     observation.
+   * @param stateProb Matrix in which the state probabilities will be stored.
+   * @param forwardProb Matrix in which the forward probabilities will be
+   *    stored.
+   * @param backwardProb Matrix in which the backward probabilities will be
+   *    stored.
+   * @param scales Vector in which the scaling factors will be stored.
+   * @return Log-likelihood of the sequence.
+   */
+  double EstimateWithEmission(const arma::mat& emissionProb,
+                              arma::mat& stateProb,
+                              arma::mat& forwardProb,
+                              arma::mat& backwardProb,
+                              arma::vec& scales) const;
+
+  /**
+   * The Viterbi algorithm, used by Predict().  The trellis matrices are only
+   * workspace; they are resized as needed, so they may be reused across
+   * sequences.
+   *
+   * @param dataSeq Sequence of observations (with at least one observation).
+   * @param logTrans Logarithm of the transposed transition matrix.
+   * @param stateSeq Vector in which the most probable state sequence will be
+   *    stored.
+   * @param logStateProb Workspace for the log-probabilities of the states.
+   * @param stateSeqBack Workspace for the most probable previous states.
+   * @param logEmission Workspace for the emission log-probabilities.
+   * @return Log-likelihood of most probable state sequence.
+   */
+  double Viterbi(const arma::mat& dataSeq,
+                 const arma::mat& logTrans,
+                 arma::Row<size_t>& stateSeq,
+                 arma::mat& logStateProb,
+                 arma::mat& stateSeqBack,
+                 arma::mat& logEmission) const;
+
+  /**
+   * Train the emission distribution of each hidden state by calling
+   * train(state), in parallel over the states, which are independent.  Each
+   * call draws its random numbers (as the initialization of a GMM does) from
+   * its own math::RandomStream, so the result does not depend on the number
+   * of threads.  Log::Info (and Log::Debug) are silenced while the states are
+   * trained, since the messages of concurrent calls would be interleaved.
+   *
+   * @param train Function that trains the emission of the given state.
+   */
+  template<typename TrainType>
+  void TrainEmissions(TrainType train);
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
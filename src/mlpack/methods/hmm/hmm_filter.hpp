@@ -0,0 +1,127 @@
+/**
+ * @file hmm_filter.hpp
+ *
+ * Definition of the HMMFilter class, which filters a stream of observations
+ * with an HMM one observation at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_HMM_FILTER_HPP
+#define MLPACK_METHODS_HMM_HMM_FILTER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "hmm.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * An HMMFilter runs the forward algorithm of an HMM on a stream of
+ * observations, as they arrive.  Only the current forward message (the
+ * probabilities of the hidden states given the observations so far) and the
+ * log-likelihood of the observations so far are kept, so each observation is
+ * processed in O(states^2) time, without reprocessing the history.
+ *
+ * After the same observations, StateProbabilities() is the last column of the
+ * forward probabilities of HMM::Filter(), PredictEmission() gives its last
+ * column, and LogLikelihood() is the same as HMM::LogLikelihood().
+ *
+ * @code
+ * HMM<GaussianDistribution> hmm(...);
+ * HMMFilter<GaussianDistribution> filter(hmm);
+ * arma::vec observation, expected;
+ * while (ReadSensor(observation))
+ * {
+ *   filter.Update(observation);
+ *   filter.PredictEmission(1, expected);
+ * }
+ * @endcode
+ *
+ * The HMM is held by reference, so it must outlive the filter and should not
+ * be modified while the filter is used.
+ *
+ * @tparam Distribution Type of emission distribution of the HMM.
+ */
+template<typename Distribution = distribution::DiscreteDistribution>
+class HMMFilter
+{
+ public:
+  /**
+   * Create a filter for the given HMM, with no observations yet.
+   *
+   * @param hmm HMM to filter observations with.
+   */
+  HMMFilter(const HMM<Distribution>& hmm);
+
+  //! Forget all the observations, so that the next one is the first.
+  void Reset();
+
+  /**
+   * Add the next observation of the stream.
+   *
+   * @param observation Next observation.
+   * @return Log-likelihood of the observation given the previous ones.
+   */
+  double Update(const arma::vec& observation);
+
+  /**
+   * Add the next observations of the stream, in order.
+   *
+   * @param observations Next observations, one per column.
+   * @return Log-likelihood of the observations given the previous ones.
+   */
+  double Update(const arma::mat& observations);
+
+  /**
+   * Compute the probabilities of the hidden states the given number of steps
+   * after the last observation, given all the observations so far.  With no
+   * observations, these are predictions from the initial state probabilities.
+   *
+   * @param ahead Number of steps ahead (0 for the current state).
+   * @param stateProb Vector in which the state probabilities will be stored.
+   */
+  void PredictStates(const size_t ahead, arma::vec& stateProb) const;
+
+  /**
+   * Compute the expected emission the given number of steps after the last
+   * observation, given all the observations so far, like HMM::Filter().  The
+   * emission distributions must have a Mean() function, and the expectation
+   * may not be meaningful for discrete emissions.
+   *
+   * @param ahead Number of steps ahead (0 for the current emission).
+   * @param emission Vector in which the expected emission will be stored.
+   */
+  void PredictEmission(const size_t ahead, arma::vec& emission) const;
+
+  //! Get the probabilities of the current hidden state given the observations.
+  const arma::vec& StateProbabilities() const { return forward; }
+  //! Get the log-likelihood of all the observations so far.
+  double LogLikelihood() const { return logLikelihood; }
+  //! Get the number of observations so far.
+  size_t NumObservations() const { return numObservations; }
+  //! Get the HMM.
+  const HMM<Distribution>& Model() const { return hmm; }
+
+ private:
+  //! The HMM.
+  const HMM<Distribution>& hmm;
+  //! The forward message: the probabilities of the current hidden state.
+  arma::vec forward;
+  //! Workspace for the next forward message.
+  arma::vec next;
+  //! The log-likelihood of the observations so far.
+  double logLikelihood;
+  //! The number of observations so far.
+  size_t numObservations;
+};
+
+} // namespace hmm
+} // namespace mlpack
+
+// Include implementation.
+#include "hmm_filter_impl.hpp"
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file hmm_filter_impl.hpp
+ *
+ * Implementation of the HMMFilter class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_HMM_FILTER_IMPL_HPP
+#define MLPACK_METHODS_HMM_HMM_FILTER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hmm_filter.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+template<typename Distribution>
+HMMFilter<Distribution>::HMMFilter(const HMM<Distribution>& hmm) :
+    hmm(hmm)
+{
+  Reset();
+}
+
+template<typename Distribution>
+void HMMFilter<Distribution>::Reset()
+{
+  // Before the first observation, the state is distributed like the initial
+  // state probabilities.
+  forward = hmm.Initial();
+  next.set_size(forward.n_elem);
+  logLikelihood = 0.0;
+  numObservations = 0;
+}
+
+template<typename Distribution>
+double HMMFilter<Distribution>::Update(const arma::vec& observation)
+{
+  if (observation.n_elem != hmm.Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "HMMFilter::Update(): the observation has " << observation.n_elem
+        << " dimensions, but the HMM has dimensionality "
+        << hmm.Dimensionality();
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The first observation is emitted from the initial state; the next ones
+  // come after a transition, like in HMM::Forward().
+  if (numObservations == 0)
+    next = forward;
+  else
+    next = hmm.Transition() * forward;
+
+  for (size_t state = 0; state < next.n_elem; ++state)
+    next[state] *= hmm.Emission()[state].Probability(observation);
+
+  // Normalize the message; the scaling factor is the probability of the
+  // observation given the previous ones.
+  const double scale = arma::accu(next);
+  if (scale > 0.0)
+    next /= scale;
+
+  forward.swap(next);
+  ++numObservations;
+
+  const double observationLogLikelihood = std::log(scale);
+  logLikelihood += observationLogLikelihood;
+  return observationLogLikelihood;
+}
+
+template<typename Distribution>
+double HMMFilter<Distribution>::Update(const arma::mat& observations)
+{
+  double batchLogLikelihood = 0.0;
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    // Take an alias of the column, so that it is not copied.
+    const arma::vec observation(const_cast<double*>(observations.colptr(i)),
+        observations.n_rows, false, true);
+    batchLogLikelihood += Update(observation);
+  }
+
+  return batchLogLikelihood;
+}
+
+template<typename Distribution>
+void HMMFilter<Distribution>::PredictStates(const size_t ahead,
+                                            arma::vec& stateProb) const
+{
+  // A few transitions are cheaper as matrix-vector products than with the
+  // power of the transition matrix.
+  stateProb = forward;
+  for (size_t i = 0; i < ahead; ++i)
+    stateProb = hmm.Transition() * stateProb;
+}
+
+template<typename Distribution>
+void HMMFilter<Distribution>::PredictEmission(const size_t ahead,
+                                              arma::vec& emission) const
+{
+  arma::vec stateProb;
+  PredictStates(ahead, stateProb);
+
+  // Will not work for distributions without a Mean() function.
+  emission.zeros(hmm.Dimensionality());
+  for (size_t i = 0; i < hmm.Emission().size(); ++i)
+    emission += hmm.Emission()[i].Mean() * stateProb[i];
+}
+
+} // namespace hmm
+} // namespace mlpack
+
+#endif
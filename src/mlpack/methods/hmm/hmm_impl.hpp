@@ -17,9 +17,54 @@
 // Just in case...
 #include "hmm.hpp"
 
+#include <mlpack/core/util/sfinae_utility.hpp>
+
 namespace mlpack {
 namespace hmm {
 
+HAS_MEM_FUNC(LogProbability, HasBatchLogProbabilityCheck);
+
+/**
+ * 'value' is true if the Distribution class has a member
+ * void LogProbability(const arma::mat&, arma::vec&) const.
+ */
+template<typename Distribution>
+struct HasBatchLogProbability
+{
+  static const bool value = HasBatchLogProbabilityCheck<Distribution,
+      void(Distribution::*)(const arma::mat&, arma::vec&) const>::value;
+};
+
+//! Compute the log-probabilities of the observations with one batch call.
+template<typename Distribution>
+void BatchLogProbability(
+    const Distribution& distribution,
+    const arma::mat& observations,
+    arma::vec& logProbabilities,
+    const typename std::enable_if_t<
+        HasBatchLogProbability<Distribution>::value>* = 0)
+{
+  distribution.LogProbability(observations, logProbabilities);
+}
+
+//! Compute the log-probabilities of the observations one at a time, because
+//! the distribution has no batch method.
+template<typename Distribution>
+void BatchLogProbability(
+    const Distribution& distribution,
+    const arma::mat& observations,
+    arma::vec& logProbabilities,
+    const typename std::enable_if_t<
+        !HasBatchLogProbability<Distribution>::value>* = 0)
+{
+  logProbabilities.set_size(observations.n_cols);
+  for (size_t t = 0; t < observations.n_cols; ++t)
+  {
+    logProbabilities[t] = std::log(distribution.Probability(
+        observations.unsafe_col(t)));
+  }
+}
+
 /**
  * Create the Hidden Markov Model with the given number of hidden states and the
  * given number of emission states.
@@ -104,10 +149,26 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The observations
+  // do not change between iterations, so they are only copied once; each
+  // sequence has its own range of columns, starting at its offset.
   std::vector<arma::vec> emissionProb(transition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  std::vector<size_t> offsets(dataSeq.size() + 1, 0);
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+  {
+    offsets[seq + 1] = offsets[seq] + dataSeq[seq].n_cols;
+    if (dataSeq[seq].n_cols > 0)
+      emissionList.cols(offsets[seq], offsets[seq + 1] - 1) = dataSeq[seq];
+  }
+
+  // The E-step of each sequence is independent, so the sequences are split
+  // into one contiguous chunk per thread, each with its own accumulators.  The
+  // accumulators are then added in the order of the chunks, so the result
+  // does not depend on the scheduling of the threads.
+  const size_t numChunks = std::max((size_t) 1, std::min(ParallelThreads(),
+      dataSeq.size()));
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
@@ -123,52 +184,82 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
     // Reset log likelihood.
     loglik = 0;
 
-    // Sum over time.
-    size_t sumTime = 0;
+    std::vector<arma::vec> chunkInitial(numChunks,
+        arma::vec(transition.n_rows, arma::fill::zeros));
+    std::vector<arma::mat> chunkTransition(numChunks,
+        arma::mat(transition.n_rows, transition.n_cols, arma::fill::zeros));
+    std::vector<double> chunkLoglik(numChunks, 0.0);
 
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    // Loop over each chunk of sequences.
+    #pragma omp parallel for schedule(static, 1) if (numChunks > 1)
+    for (omp_size_t chunk = 0; chunk < (omp_size_t) numChunks; ++chunk)
     {
-      arma::mat stateProb;
-      arma::mat forward;
-      arma::mat backward;
-      arma::vec scales;
-
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
-
-      // Add to estimate of initial probability for state j.
-      for (size_t j = 0; j < transition.n_cols; ++j)
-        newInitial[j] += stateProb(j, 0);
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
+      const size_t begin = chunk * dataSeq.size() / numChunks;
+      const size_t end = (chunk + 1) * dataSeq.size() / numChunks;
+
+      arma::vec& chunkNewInitial = chunkInitial[chunk];
+      arma::mat& chunkNewTransition = chunkTransition[chunk];
+
+      for (size_t seq = begin; seq < end; seq++)
       {
+        arma::mat stateProb;
+        arma::mat forward;
+        arma::mat backward;
+        arma::vec scales;
+
+        // The emission probabilities are used by both passes of the
+        // forward-backward algorithm and by the M-step, so they are computed
+        // only once.
+        arma::mat emissionProb;
+        EmissionProbability(dataSeq[seq], emissionProb);
+
+        // Add the log-likelihood of this sequence.  This is the E-step.
+        chunkLoglik[chunk] += EstimateWithEmission(emissionProb, stateProb,
+            forward, backward, scales);
+
+        // Add to estimate of initial probability for state j.
         for (size_t j = 0; j < transition.n_cols; ++j)
+          chunkNewInitial[j] += stateProb(j, 0);
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // We store the new estimates in a different matrix.
+        const size_t length = dataSeq[seq].n_cols;
+        if (length > 1)
         {
-          if (t < dataSeq[seq].n_cols - 1)
-          {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
-          }
-
-          // Add to list of emission observations, for Distribution::Train().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+          // Estimate of T_ij (probability of transition from state j to state
+          // i).  We postpone multiplication of the old T_ij until later.  The
+          // sum over time of forward(j, t) * backward(i, t + 1) *
+          // E_i(seq[t + 1]) / scales[t + 1] is the matrix product of the
+          // weighted backward probabilities with the forward probabilities, so
+          // the whole sequence takes a single matrix multiplication.
+          arma::mat weightedBackward = backward.cols(1, length - 1) %
+              emissionProb.cols(1, length - 1);
+          weightedBackward.each_row() /= scales.subvec(1, length - 1).t();
+
+          chunkNewTransition += weightedBackward *
+              forward.cols(0, length - 2).t();
         }
-        sumTime++;
+
+        // Add to the weights of the emission observations, for
+        // Distribution::Train().
+        for (size_t t = 0; t < length; ++t)
+          for (size_t j = 0; j < transition.n_cols; ++j)
+            emissionProb[j][offsets[seq] + t] = stateProb(j, t);
       }
     }
 
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+      loglik += chunkLoglik[chunk];
+      newInitial += chunkInitial[chunk];
+      newTransition += chunkTransition[chunk];
+    }
+
     // Normalize the new initial probabilities.
     if (dataSeq.size() > 1)
       initial = newInitial / dataSeq.size();
@@ -191,9 +282,12 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
         transition.col(i).fill(1.0 / (double) transition.n_rows);
     }
 
-    // Now estimate emission probabilities.
-    for (size_t state = 0; state < transition.n_cols; state++)
+    // Now estimate emission probabilities.  All states are fit to the same
+    // observations, with their own weights.
+    TrainEmissions([&](const size_t state)
+    {
       emission[state].Train(emissionList, emissionProb[state]);
+    });
 
     Log::Debug << "Iteration " << iter << ": log-likelihood " << loglik
         << "." << std::endl;
@@ -280,6 +374,16 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
 
   // Estimate emission matrix.
   for (size_t state = 0; state < transition.n_cols; state++)
+  {
+    if (emissionList[state].size() == 0)
+    {
+      Log::Warn << "There are no observations in training data with hidden "
+          << "state " << state << "!  The corresponding emission distribution "
+          << "is likely to be meaningless." << std::endl;
+    }
+  }
+
+  TrainEmissions([&](const size_t state)
   {
     // Generate full sequence of observations for this state from the list of
     // emissions that are from this state.
@@ -294,13 +398,36 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
 
       emission[state].Train(emissions);
     }
-    else
-    {
-      Log::Warn << "There are no observations in training data with hidden "
-          << "state " << state << "!  The corresponding emission distribution "
-          << "is likely to be meaningless." << std::endl;
-    }
+  });
+}
+
+//! Train the emission of each state, in parallel over the states.
+template<typename Distribution>
+template<typename TrainType>
+void HMM<Distribution>::TrainEmissions(TrainType train)
+{
+  const uint64_t seed = math::RandomStreamSeed();
+
+  const bool infoIgnored = Log::Info.ignoreInput;
+  Log::Info.ignoreInput = true;
+#ifdef DEBUG
+  const bool debugIgnored = Log::Debug.ignoreInput;
+  Log::Debug.ignoreInput = true;
+#endif
+
+  // Fitting a mixture may take much longer for some states than for others.
+  #pragma omp parallel for schedule(dynamic) num_threads(ParallelThreads())
+  for (omp_size_t state = 0; state < (omp_size_t) emission.size(); ++state)
+  {
+    math::RandomStream stream(seed, state);
+    math::RandomStreamScope scope(stream);
+    train((size_t) state);
   }
+
+  Log::Info.ignoreInput = infoIgnored;
+#ifdef DEBUG
+  Log::Debug.ignoreInput = debugIgnored;
+#endif
 }
 
 /**
@@ -313,10 +440,27 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
                                    arma::mat& forwardProb,
                                    arma::mat& backwardProb,
                                    arma::vec& scales) const
+{
+  arma::mat emissionProb;
+  EmissionProbability(dataSeq, emissionProb);
+
+  return EstimateWithEmission(emissionProb, stateProb, forwardProb,
+      backwardProb, scales);
+}
+
+/**
+ * Run the forward-backward algorithm with the given emission probabilities.
+ */
+template<typename Distribution>
+double HMM<Distribution>::EstimateWithEmission(const arma::mat& emissionProb,
+                                               arma::mat& stateProb,
+                                               arma::mat& forwardProb,
+                                               arma::mat& backwardProb,
+                                               arma::vec& scales) const
 {
   // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+  ForwardWithEmission(emissionProb, scales, forwardProb);
+  BackwardWithEmission(emissionProb, scales, backwardProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
@@ -398,18 +542,71 @@ void HMM<Distribution>::Generate(const size_t length,
 template<typename Distribution>
 double HMM<Distribution>::Predict(const arma::mat& dataSeq,
                                   arma::Row<size_t>& stateSeq) const
+{
+  arma::mat logStateProb, stateSeqBack, logEmission;
+
+  // Store the logs of the transposed transition matrix.  This is because we
+  // will be using the rows of the transition matrix.
+  const arma::mat logTrans(log(trans(transition)));
+
+  return Viterbi(dataSeq, logTrans, stateSeq, logStateProb, stateSeqBack,
+      logEmission);
+}
+
+/**
+ * Compute the most probable hidden state sequence of each of the given
+ * observations in parallel.
+ */
+template<typename Distribution>
+void HMM<Distribution>::Predict(const std::vector<arma::mat>& dataSeq,
+                                std::vector<arma::Row<size_t>>& stateSeq,
+                                arma::vec& logLikelihoods) const
+{
+  stateSeq.resize(dataSeq.size());
+  logLikelihoods.zeros(dataSeq.size());
+
+  const arma::mat logTrans(log(trans(transition)));
+
+  #pragma omp parallel
+  {
+    // Each thread keeps its trellis for all of its sequences, so that short
+    // sequences do not each allocate new matrices.
+    arma::mat logStateProb, stateSeqBack, logEmission;
+
+    #pragma omp for schedule(dynamic, 64)
+    for (omp_size_t i = 0; i < (omp_size_t) dataSeq.size(); ++i)
+    {
+      if (dataSeq[i].n_cols == 0)
+      {
+        stateSeq[i].clear();
+        continue;
+      }
+
+      logLikelihoods[i] = Viterbi(dataSeq[i], logTrans, stateSeq[i],
+          logStateProb, stateSeqBack, logEmission);
+    }
+  }
+}
+
+/**
+ * The Viterbi algorithm, with the given workspace for the trellis.
+ */
+template<typename Distribution>
+double HMM<Distribution>::Viterbi(const arma::mat& dataSeq,
+                                  const arma::mat& logTrans,
+                                  arma::Row<size_t>& stateSeq,
+                                  arma::mat& logStateProb,
+                                  arma::mat& stateSeqBack,
+                                  arma::mat& logEmission) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
   // probable sequence of states to produce the observed data sequence.  We
   // don't use log-likelihoods to save that little bit of time, but we'll
   // calculate the log-likelihood at the end of it all.
   stateSeq.set_size(dataSeq.n_cols);
-  arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
-  arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
-
-  // Store the logs of the transposed transition matrix.  This is because we
-  // will be using the rows of the transition matrix.
-  arma::mat logTrans(log(trans(transition)));
+  logStateProb.set_size(transition.n_rows, dataSeq.n_cols);
+  stateSeqBack.set_size(transition.n_rows, dataSeq.n_cols);
+  EmissionLogProbability(dataSeq, logEmission);
 
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
@@ -417,8 +614,7 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   logStateProb.col(0).zeros();
   for (size_t state = 0; state < transition.n_rows; state++)
   {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
+    logStateProb(state, 0) = log(initial[state]) + logEmission(state, 0);
     stateSeqBack(state, 0) = state;
   }
 
@@ -432,8 +628,7 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
     for (size_t j = 0; j < transition.n_rows; j++)
     {
       arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
+      logStateProb(j, t) = prob.max(index) + logEmission(j, t);
         stateSeqBack(j, t) = index;
     }
   }
@@ -463,6 +658,35 @@ double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
   return accu(log(scales));
 }
 
+/**
+ * Compute the log-likelihood of each of the given data sequences in parallel.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                                      arma::vec& logLikelihoods) const
+{
+  logLikelihoods.zeros(dataSeq.size());
+
+  #pragma omp parallel
+  {
+    // Forward() resizes these for each sequence, which does not allocate once
+    // they are large enough.
+    arma::mat forward;
+    arma::vec scales;
+
+    #pragma omp for schedule(dynamic, 64)
+    for (omp_size_t i = 0; i < (omp_size_t) dataSeq.size(); ++i)
+    {
+      // An empty sequence has probability 1.
+      if (dataSeq[i].n_cols == 0)
+        continue;
+
+      Forward(dataSeq[i], scales, forward);
+      logLikelihoods[i] = accu(log(scales));
+    }
+  }
+}
+
 /**
  * HMM filtering.
  */
@@ -476,9 +700,10 @@ void HMM<Distribution>::Filter(const arma::mat& dataSeq,
   arma::vec scales;
   Forward(dataSeq, scales, forwardProb);
 
-  // Propagate state ahead.
-  if (ahead != 0)
-    forwardProb = pow(transition, ahead) * forwardProb;
+  // Propagate state ahead.  (arma::pow() would be the elementwise power of
+  // the transition matrix, not the matrix power.)
+  for (size_t i = 0; i < ahead; ++i)
+    forwardProb = transition * forwardProb;
 
   // Compute expected emissions.
   // Will not work for distributions without a Mean() function.
@@ -505,6 +730,34 @@ void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
     smoothSeq += emission[i].Mean() * stateProb.row(i);
 }
 
+/**
+ * Compute the emission log-probabilities of each state for each observation.
+ */
+template<typename Distribution>
+void HMM<Distribution>::EmissionLogProbability(const arma::mat& dataSeq,
+                                               arma::mat& logEmission) const
+{
+  logEmission.set_size(transition.n_rows, dataSeq.n_cols);
+
+  arma::vec logProbabilities;
+  for (size_t state = 0; state < transition.n_rows; state++)
+  {
+    BatchLogProbability(emission[state], dataSeq, logProbabilities);
+    logEmission.row(state) = logProbabilities.t();
+  }
+}
+
+/**
+ * Compute the emission probabilities of each state for each observation.
+ */
+template<typename Distribution>
+void HMM<Distribution>::EmissionProbability(const arma::mat& dataSeq,
+                                            arma::mat& emissionProb) const
+{
+  EmissionLogProbability(dataSeq, emissionProb);
+  emissionProb = arma::exp(emissionProb);
+}
+
 /**
  * The Forward procedure (part of the Forward-Backward algorithm).
  */
@@ -512,20 +765,41 @@ template<typename Distribution>
 void HMM<Distribution>::Forward(const arma::mat& dataSeq,
                                 arma::vec& scales,
                                 arma::mat& forwardProb) const
+{
+  arma::mat emissionProb;
+  EmissionProbability(dataSeq, emissionProb);
+  ForwardWithEmission(emissionProb, scales, forwardProb);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::Backward(const arma::mat& dataSeq,
+                                 const arma::vec& scales,
+                                 arma::mat& backwardProb) const
+{
+  arma::mat emissionProb;
+  EmissionProbability(dataSeq, emissionProb);
+  BackwardWithEmission(emissionProb, scales, backwardProb);
+}
+
+/**
+ * The Forward procedure, with the emission probabilities already computed.
+ */
+template<typename Distribution>
+void HMM<Distribution>::ForwardWithEmission(const arma::mat& emissionProb,
+                                            arma::vec& scales,
+                                            arma::mat& forwardProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
+  forwardProb.zeros(transition.n_rows, emissionProb.n_cols);
+  scales.zeros(emissionProb.n_cols);
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  forwardProb.col(0) = initial % emissionProb.col(0);
 
   // Then normalize the column.
   scales[0] = accu(forwardProb.col(0));
@@ -533,17 +807,13 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
     forwardProb.col(0) /= scales[0];
 
   // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  for (size_t t = 1; t < emissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
-    }
+    // The forward probability of state j at time t is the sum over all states
+    // of the probability of the previous state transitioning to the current
+    // state and emitting the given observation.
+    forwardProb.col(t) = (transition * forwardProb.col(t - 1)) %
+        emissionProb.col(t);
 
     // Normalize probability.
     scales[t] = accu(forwardProb.col(t));
@@ -552,35 +822,34 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
   }
 }
 
+/**
+ * The Backward procedure, with the emission probabilities already computed.
+ */
 template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+void HMM<Distribution>::BackwardWithEmission(const arma::mat& emissionProb,
+                                             const arma::vec& scales,
+                                             arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.zeros(transition.n_rows, emissionProb.n_cols);
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
+  backwardProb.col(emissionProb.n_cols - 1).fill(1);
 
   // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  for (size_t t = emissionProb.n_cols - 2; t + 1 > 0; t--)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      if (scales[t + 1] > 0.0)
-        backwardProb(j, t) /= scales[t + 1];
-    }
+    // The backward probability of state j at time t is the sum over all states
+    // of the probability of the next state having been a transition from the
+    // current state multiplied by the probability of each of those states
+    // emitting the given observation.
+    backwardProb.col(t) = transition.t() * (backwardProb.col(t + 1) %
+        emissionProb.col(t + 1));
+
+    // Normalize by the weights from the forward algorithm.
+    if (scales[t + 1] > 0.0)
+      backwardProb.col(t) /= scales[t + 1];
   }
 }
 
@@ -37,12 +37,23 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Sequence Log-Likelihood", "This "
     PRINT_DATASET("seq") + " with the pre-trained HMM " + PRINT_MODEL("hmm") +
     ", the following command may be used: "
     "\n\n" +
-    PRINT_CALL("hmm_loglik", "input", "seq", "input_model", "hmm"));
+    PRINT_CALL("hmm_loglik", "input", "seq", "input_model", "hmm") +
+    "\n\n"
+    "Many sequences can be scored at once, in parallel, by concatenating them "
+    "in " + PRINT_PARAM_STRING("input") + " and giving the number of "
+    "observations of each sequence with " + PRINT_PARAM_STRING("lengths") +
+    ".  The log-likelihood of each sequence is then given in " +
+    PRINT_PARAM_STRING("log_likelihoods") + ", and " +
+    PRINT_PARAM_STRING("log_likelihood") + " is their sum.");
 
 PARAM_MATRIX_IN_REQ("input", "File containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "File containing HMM.", "m");
+PARAM_UROW_IN("lengths", "Lengths of the sequences concatenated in the input "
+    "observations, to score each of them separately.", "l");
 
 PARAM_DOUBLE_OUT("log_likelihood", "Log-likelihood of the sequence.");
+PARAM_COL_OUT("log_likelihoods", "Log-likelihood of each sequence, if "
+    "--lengths is given.", "o");
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -68,9 +79,38 @@ struct Loglik
           << "not equal to the dimensionality of the HMM ("
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
-    const double loglik = hmm.LogLikelihood(dataSeq);
+    if (CLI::HasParam("lengths"))
+    {
+      const arma::Row<size_t>& lengths =
+          CLI::GetParam<arma::Row<size_t>>("lengths");
+      if (accu(lengths) != dataSeq.n_cols)
+        Log::Fatal << "The sequence lengths add up to " << accu(lengths)
+            << ", but there are " << dataSeq.n_cols << " observations!"
+            << endl;
+
+      // Split the observations into the sequences, and score all of them at
+      // once.
+      std::vector<mat> sequences(lengths.n_elem);
+      size_t begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        if (lengths[i] > 0)
+          sequences[i] = dataSeq.cols(begin, begin + lengths[i] - 1);
+        begin += lengths[i];
+      }
+
+      arma::vec logLikelihoods;
+      hmm.LogLikelihood(sequences, logLikelihoods);
 
-    CLI::GetParam<double>("log_likelihood") = loglik;
+      CLI::GetParam<double>("log_likelihood") = accu(logLikelihoods);
+      CLI::GetParam<arma::vec>("log_likelihoods") = std::move(logLikelihoods);
+    }
+    else
+    {
+      const double loglik = hmm.LogLikelihood(dataSeq);
+
+      CLI::GetParam<double>("log_likelihood") = loglik;
+    }
   }
 };
 
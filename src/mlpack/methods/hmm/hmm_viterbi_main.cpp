@@ -41,11 +41,19 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction", "This "
     ", the following command could be used:"
     "\n\n" +
     PRINT_CALL("hmm_viterbi", "input", "obs", "input_model", "hmm", "output",
-        "states"));
+        "states") +
+    "\n\n"
+    "Many sequences can be decoded at once, in parallel, by concatenating them "
+    "in " + PRINT_PARAM_STRING("input") + " and giving the number of "
+    "observations of each sequence with " + PRINT_PARAM_STRING("lengths") +
+    ".  The state sequences are then concatenated in the same way in " +
+    PRINT_PARAM_STRING("output") + ".");
 
 PARAM_MATRIX_IN_REQ("input", "Matrix containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "Trained HMM to use.", "m");
 PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
+PARAM_UROW_IN("lengths", "Lengths of the sequences concatenated in the input "
+    "observations, to decode each of them separately.", "l");
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -72,7 +80,43 @@ struct Viterbi
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
     arma::Row<size_t> sequence;
-    hmm.Predict(dataSeq, sequence);
+    if (CLI::HasParam("lengths"))
+    {
+      const arma::Row<size_t>& lengths =
+          CLI::GetParam<arma::Row<size_t>>("lengths");
+      if (accu(lengths) != dataSeq.n_cols)
+        Log::Fatal << "The sequence lengths add up to " << accu(lengths)
+            << ", but there are " << dataSeq.n_cols << " observations!"
+            << endl;
+
+      // Split the observations into the sequences, and decode all of them at
+      // once.
+      std::vector<mat> sequences(lengths.n_elem);
+      size_t begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        if (lengths[i] > 0)
+          sequences[i] = dataSeq.cols(begin, begin + lengths[i] - 1);
+        begin += lengths[i];
+      }
+
+      std::vector<arma::Row<size_t>> stateSequences;
+      arma::vec logLikelihoods;
+      hmm.Predict(sequences, stateSequences, logLikelihoods);
+
+      sequence.set_size(dataSeq.n_cols);
+      begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        if (lengths[i] > 0)
+          sequence.cols(begin, begin + lengths[i] - 1) = stateSequences[i];
+        begin += lengths[i];
+      }
+    }
+    else
+    {
+      hmm.Predict(dataSeq, sequence);
+    }
 
     // Save output.
     if (CLI::HasParam("output"))
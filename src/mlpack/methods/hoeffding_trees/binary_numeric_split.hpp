@@ -106,6 +106,15 @@ class BinaryNumericSplit
   //! The probability of the majority class given the points seen so far.
   double MajorityProbability() const;
 
+  //! Return the approximate number of bytes used by the object (each element
+  //! seen so far is a node of the multimap, with three pointers and a color).
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) + sizeof(size_t) * classCounts.n_elem +
+        sortedElements.size() * (sizeof(std::pair<ObservationType, size_t>) +
+        4 * sizeof(void*));
+  }
+
   //! Serialize the object.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
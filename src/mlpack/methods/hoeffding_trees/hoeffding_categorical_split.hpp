@@ -106,6 +106,12 @@ class HoeffdingCategoricalSplit
   //! Get the probability of the majority class given the points seen so far.
   double MajorityProbability() const;
 
+  //! Return the approximate number of bytes used by the object.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) + sizeof(size_t) * sufficientStatistics.n_elem;
+  }
+
   //! Serialize the categorical split.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
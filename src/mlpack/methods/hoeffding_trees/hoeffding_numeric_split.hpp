@@ -119,6 +119,14 @@ class HoeffdingNumericSplit
   //! Return the number of bins.
   size_t Bins() const { return bins; }
 
+  //! Return the approximate number of bytes used by the object.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) + sizeof(ObservationType) * (observations.n_elem +
+        splitPoints.n_elem) + sizeof(size_t) * (labels.n_elem +
+        sufficientStatistics.n_elem);
+  }
+
   //! Serialize the object.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
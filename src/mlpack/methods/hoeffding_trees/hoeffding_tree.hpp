@@ -150,7 +150,11 @@ class HoeffdingTree
 
   /**
    * Train on a set of points, either in streaming mode or in batch mode, with
-   * the given labels.
+   * the given labels.  In streaming mode, the points are taken as a
+   * mini-batch: they are first routed to the leaves they reach, and then the
+   * leaves are trained in parallel, each on its points in order and with one
+   * dimension of the points at a time, up to each split check.  The tree is
+   * the same as if the points were trained on one at a time.
    *
    * @param data Data points to train on.
    * @param label Labels of data points.
@@ -287,6 +291,53 @@ class HoeffdingTree
    */
   void CreateChildren();
 
+  /**
+   * Get the approximate number of bytes used by this node and its
+   * descendants, including the split statistics of the leaves.
+   */
+  size_t MemoryUsage() const;
+
+  //! Get whether this node keeps split statistics (always true if it is not a
+  //! leaf).
+  bool Active() const { return active; }
+
+  /**
+   * Deactivate this leaf: its split statistics are freed, and until it is
+   * reactivated, it only counts the points that reach it and predicts its
+   * current majority class.  Nothing is done if the node is not an active
+   * leaf.
+   */
+  void Deactivate();
+
+  /**
+   * Reactivate this leaf, if it is inactive: new split statistics are created,
+   * so it starts again to collect points for a split.
+   */
+  void Reactivate();
+
+  /**
+   * Get how promising this node is to split, as in VFDT: the number of points
+   * that reached it times the fraction of them that are not of the majority
+   * class.  (For a leaf, this is proportional to the reduction of the error
+   * that a split could bring.)
+   */
+  double Promise() const
+  {
+    return totalSamples * (1.0 - majorityProbability);
+  }
+
+  /**
+   * Limit the memory used by the tree to the given number of bytes (as
+   * reported by MemoryUsage()), as in VFDT: the least promising leaves are
+   * deactivated until the tree fits, and then the most promising inactive
+   * leaves are reactivated, in place of less promising active ones, while they
+   * fit.  This should be called regularly while training a tree on a long
+   * stream, since the tree grows with the stream.
+   *
+   * @param maxMemory The maximum number of bytes the tree may use.
+   */
+  void LimitMemory(const size_t maxMemory);
+
   //! Serialize the split.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -294,6 +345,41 @@ class HoeffdingTree
  private:
   // We need to keep some information for before we have split.
 
+  //! Get the approximate number of bytes used by this node alone.
+  size_t NodeMemoryUsage() const;
+
+  //! Append all the leaves of this subtree to the given vector.
+  void GetLeaves(std::vector<HoeffdingTree*>& leaves);
+
+  /**
+   * Append to leaves each leaf of this subtree that one of the given points
+   * reaches, with the points (in the same order) that reach it.
+   *
+   * @param data Points to route.
+   * @param points Indices of the points of data that reach this node.
+   * @param leaves Leaves, with the indices of the points that reach them.
+   */
+  template<typename MatType>
+  void CollectLeaves(
+      const MatType& data,
+      const std::vector<size_t>& points,
+      std::vector<std::pair<HoeffdingTree*, std::vector<size_t>>>& leaves);
+
+  /**
+   * Train this leaf on the given points, in order, as Train() on each point in
+   * turn would: the statistics are updated for all the points up to the next
+   * split check at once, and once the leaf splits, the remaining points are
+   * passed to the children.
+   *
+   * @param data Points to train on.
+   * @param labels Labels of all the points of data.
+   * @param points Indices of the points of data to train on.
+   */
+  template<typename MatType>
+  void TrainLeaf(const MatType& data,
+                 const arma::Row<size_t>& labels,
+                 const std::vector<size_t>& points);
+
   //! Information for splitting of numeric features (used before split).
   std::vector<NumericSplitType<FitnessFunction>> numericSplits;
   //! Information for splitting of categorical features (used before split).
@@ -304,8 +390,12 @@ class HoeffdingTree
   //! Indicates whether or not we own the mappings.
   bool ownsMappings;
 
-  //! The number of samples seen so far by this node.
+  //! The number of samples seen so far by the split statistics of this node.
   size_t numSamples;
+  //! The number of samples seen by this node, also while it was inactive.
+  size_t totalSamples;
+  //! Whether this node has split statistics.
+  bool active;
   //! The number of classes this node is trained on.
   size_t numClasses;
   //! The maximum number of samples we can see before splitting.
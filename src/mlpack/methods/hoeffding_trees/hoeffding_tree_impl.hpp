@@ -43,6 +43,8 @@ HoeffdingTree<
         std::pair<size_t, size_t>>()),
     ownsMappings(true),
     numSamples(0),
+    totalSamples(0),
+    active(true),
     numClasses(numClasses),
     maxSamples((maxSamples == 0) ? size_t(-1) : maxSamples),
     checkInterval(checkInterval),
@@ -51,6 +53,8 @@ HoeffdingTree<
     ownsInfo(false),
     successProbability(successProbability),
     splitDimension(size_t(-1)),
+    majorityClass(0),
+    majorityProbability(0.0),
     categoricalSplit(0),
     numericSplit()
 {
@@ -99,6 +103,8 @@ HoeffdingTree<
         new std::unordered_map<size_t, std::pair<size_t, size_t>>()),
     ownsMappings(dimensionMappingsIn == NULL),
     numSamples(0),
+    totalSamples(0),
+    active(true),
     numClasses(numClasses),
     maxSamples((maxSamples == 0) ? size_t(-1) : maxSamples),
     checkInterval(checkInterval),
@@ -107,6 +113,8 @@ HoeffdingTree<
     ownsInfo(false),
     successProbability(successProbability),
     splitDimension(size_t(-1)),
+    majorityClass(0),
+    majorityProbability(0.0),
     categoricalSplit(0),
     numericSplit()
 {
@@ -161,6 +169,8 @@ HoeffdingTree<FitnessFunction, NumericSplitType, CategoricalSplitType>::
         std::pair<size_t, size_t>>(*other.dimensionMappings)),
     ownsMappings(true),
     numSamples(other.numSamples),
+    totalSamples(other.totalSamples),
+    active(other.active),
     numClasses(other.numClasses),
     maxSamples(other.maxSamples),
     checkInterval(other.checkInterval),
@@ -213,8 +223,7 @@ void HoeffdingTree<
     // Don't split if there are fewer than five points.
     size_t oldMaxSamples = maxSamples;
     maxSamples = std::max(size_t(data.n_cols - 1), size_t(5));
-    for (size_t i = 0; i < data.n_cols; ++i)
-      Train(data.col(i), labels[i]);
+    Train(data, labels, false);
     maxSamples = oldMaxSamples;
 
     // Now, if we did split, find out which points go to which child, and
@@ -265,9 +274,20 @@ void HoeffdingTree<
   }
   else
   {
-    // We aren't training in batch mode; loop through the points.
+    // We aren't training in batch mode, so the points are a mini-batch of the
+    // stream.  First find the leaf that each point reaches.
+    std::vector<size_t> points(data.n_cols);
     for (size_t i = 0; i < data.n_cols; ++i)
-      Train(data.col(i), labels[i]);
+      points[i] = i;
+    std::vector<std::pair<HoeffdingTree*, std::vector<size_t>>> leaves;
+    CollectLeaves(data, points, leaves);
+
+    // Each leaf only depends on its own points, so the leaves can be trained
+    // in parallel.  With a single leaf, its dimensions are trained in parallel
+    // instead.
+    #pragma omp parallel for schedule(dynamic) if(leaves.size() > 1)
+    for (omp_size_t i = 0; i < (omp_size_t) leaves.size(); ++i)
+      leaves[i].first->TrainLeaf(data, labels, leaves[i].second);
   }
 }
 
@@ -284,6 +304,11 @@ void HoeffdingTree<
 {
   if (splitDimension == size_t(-1))
   {
+    // An inactive leaf only counts the points.
+    ++totalSamples;
+    if (!active)
+      return;
+
     ++numSamples;
     size_t numericIndex = 0;
     size_t categoricalIndex = 0;
@@ -328,6 +353,126 @@ void HoeffdingTree<
   }
 }
 
+//! Find the leaves that the given points reach.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename MatType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::CollectLeaves(
+    const MatType& data,
+    const std::vector<size_t>& points,
+    std::vector<std::pair<HoeffdingTree*, std::vector<size_t>>>& leaves)
+{
+  if (points.empty())
+    return;
+
+  if (splitDimension == size_t(-1))
+  {
+    leaves.push_back(std::make_pair(this, points));
+    return;
+  }
+
+  std::vector<std::vector<size_t>> childPoints(children.size());
+  for (size_t i = 0; i < points.size(); ++i)
+    childPoints[CalculateDirection(data.col(points[i]))].push_back(points[i]);
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->CollectLeaves(data, childPoints[i], leaves);
+}
+
+//! Train a leaf on the given points.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename MatType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::TrainLeaf(const MatType& data,
+             const arma::Row<size_t>& labels,
+             const std::vector<size_t>& points)
+{
+  // An inactive leaf only counts the points.
+  if (!active)
+  {
+    totalSamples += points.size();
+    return;
+  }
+
+  size_t begin = 0;
+  while (begin < points.size() && splitDimension == size_t(-1))
+  {
+    // Take the points up to the next split check.
+    const size_t end = std::min(points.size(),
+        begin + checkInterval - (numSamples % checkInterval));
+
+    // The statistics of each dimension only depend on the points in order, so
+    // the dimensions are trained independently.
+    const size_t dimensions = categoricalSplits.size() + numericSplits.size();
+    #pragma omp parallel for schedule(dynamic) \
+        if((end - begin) * dimensions >= 10000)
+    for (omp_size_t d = 0; d < (omp_size_t) dimensions; ++d)
+    {
+      const std::pair<size_t, size_t>& mapping = dimensionMappings->at(d);
+      if (mapping.first == data::Datatype::categorical)
+      {
+        for (size_t i = begin; i < end; ++i)
+          categoricalSplits[mapping.second].Train(data(d, points[i]),
+              labels[points[i]]);
+      }
+      else if (mapping.first == data::Datatype::numeric)
+      {
+        for (size_t i = begin; i < end; ++i)
+          numericSplits[mapping.second].Train(data(d, points[i]),
+              labels[points[i]]);
+      }
+    }
+    numSamples += end - begin;
+    totalSamples += end - begin;
+    begin = end;
+
+    // Grab majority class from splits.
+    if (categoricalSplits.size() > 0)
+    {
+      majorityClass = categoricalSplits[0].MajorityClass();
+      majorityProbability = categoricalSplits[0].MajorityProbability();
+    }
+    else
+    {
+      majorityClass = numericSplits[0].MajorityClass();
+      majorityProbability = numericSplits[0].MajorityProbability();
+    }
+
+    // Check for a split, if we should.
+    if (numSamples % checkInterval == 0)
+    {
+      const size_t numChildren = SplitCheck();
+      if (numChildren > 0)
+      {
+        // We need to add a bunch of children.
+        // Delete children, if we have them.
+        children.clear();
+        CreateChildren();
+      }
+    }
+  }
+
+  // If we split, the rest of the points go to the children.
+  if (begin < points.size())
+  {
+    std::vector<std::pair<HoeffdingTree*, std::vector<size_t>>> leaves;
+    CollectLeaves(data, std::vector<size_t>(points.begin() + begin,
+        points.end()), leaves);
+    for (size_t i = 0; i < leaves.size(); ++i)
+      leaves[i].first->TrainLeaf(data, labels, leaves[i].second);
+  }
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType>
@@ -337,8 +482,8 @@ size_t HoeffdingTree<
     CategoricalSplitType
 >::SplitCheck()
 {
-  // Do nothing if we've already split.
-  if (splitDimension != size_t(-1))
+  // Do nothing if we've already split, or if we have no statistics.
+  if (splitDimension != size_t(-1) || !active)
     return 0;
 
   // If not enough points have been seen, we cannot split.
@@ -682,6 +827,222 @@ void HoeffdingTree<
   categoricalSplits.clear();
 }
 
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+size_t HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::MemoryUsage() const
+{
+  size_t memory = NodeMemoryUsage();
+  for (size_t i = 0; i < children.size(); ++i)
+    memory += children[i]->MemoryUsage();
+
+  return memory;
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+size_t HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::NodeMemoryUsage() const
+{
+  size_t memory = sizeof(*this) + children.capacity() * sizeof(HoeffdingTree*);
+  for (size_t i = 0; i < numericSplits.size(); ++i)
+    memory += numericSplits[i].MemoryUsage();
+  for (size_t i = 0; i < categoricalSplits.size(); ++i)
+    memory += categoricalSplits[i].MemoryUsage();
+
+  return memory;
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Deactivate()
+{
+  if (splitDimension != size_t(-1) || !active)
+    return;
+
+  // Keep only empty splits with the same parameters, so that the statistics
+  // can be created again by Reactivate().
+  std::vector<NumericSplitType<FitnessFunction>> numericPrototype;
+  if (!numericSplits.empty())
+  {
+    numericPrototype.push_back(NumericSplitType<FitnessFunction>(numClasses,
+        numericSplits[0]));
+  }
+
+  std::vector<CategoricalSplitType<FitnessFunction>> categoricalPrototype;
+  if (!categoricalSplits.empty())
+  {
+    categoricalPrototype.push_back(CategoricalSplitType<FitnessFunction>(0,
+        numClasses, categoricalSplits[0]));
+  }
+
+  numericSplits.swap(numericPrototype);
+  categoricalSplits.swap(categoricalPrototype);
+  numSamples = 0;
+  active = false;
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Reactivate()
+{
+  if (splitDimension != size_t(-1) || active)
+    return;
+
+  const NumericSplitType<FitnessFunction> numericPrototype =
+      numericSplits.empty() ? NumericSplitType<FitnessFunction>(numClasses) :
+      numericSplits[0];
+  const CategoricalSplitType<FitnessFunction> categoricalPrototype =
+      categoricalSplits.empty() ?
+      CategoricalSplitType<FitnessFunction>(0, numClasses) :
+      categoricalSplits[0];
+
+  // The splits are created in the same order as in the constructor, so that
+  // the dimension mappings still apply.
+  numericSplits.clear();
+  categoricalSplits.clear();
+  for (size_t i = 0; i < datasetInfo->Dimensionality(); ++i)
+  {
+    if (datasetInfo->Type(i) == data::Datatype::categorical)
+    {
+      categoricalSplits.push_back(CategoricalSplitType<FitnessFunction>(
+          datasetInfo->NumMappings(i), numClasses, categoricalPrototype));
+    }
+    else
+    {
+      numericSplits.push_back(NumericSplitType<FitnessFunction>(numClasses,
+          numericPrototype));
+    }
+  }
+
+  numSamples = 0;
+  active = true;
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::GetLeaves(std::vector<HoeffdingTree*>& leaves)
+{
+  if (splitDimension == size_t(-1))
+    leaves.push_back(this);
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->GetLeaves(leaves);
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::LimitMemory(const size_t maxMemory)
+{
+  std::vector<HoeffdingTree*> leaves;
+  GetLeaves(leaves);
+
+  // Sort the leaves from the most to the least promising.
+  std::stable_sort(leaves.begin(), leaves.end(),
+      [](const HoeffdingTree* a, const HoeffdingTree* b)
+      {
+        return a->Promise() > b->Promise();
+      });
+
+  // Deactivate the least promising leaves until the tree fits.
+  size_t memory = MemoryUsage();
+  for (size_t i = leaves.size(); i > 0 && memory > maxMemory; --i)
+  {
+    if (leaves[i - 1]->Active())
+    {
+      memory -= leaves[i - 1]->NodeMemoryUsage();
+      leaves[i - 1]->Deactivate();
+      memory += leaves[i - 1]->NodeMemoryUsage();
+    }
+  }
+
+  // Now reactivate the most promising inactive leaves, in place of the less
+  // promising active leaves, for as long as they fit.
+  size_t last = leaves.size(); // Active leaves after this may be deactivated.
+  for (size_t i = 0; i < last; ++i)
+  {
+    if (leaves[i]->Active())
+      continue;
+
+    const size_t inactiveMemory = leaves[i]->NodeMemoryUsage();
+    leaves[i]->Reactivate();
+    memory += leaves[i]->NodeMemoryUsage() - inactiveMemory;
+
+    // Find how many of the least promising active leaves have to go to make
+    // room.
+    size_t newLast = last;
+    size_t freed = 0;
+    std::vector<size_t> evicted;
+    while (memory > maxMemory + freed && newLast > i + 1)
+    {
+      --newLast;
+      if (leaves[newLast]->Active())
+      {
+        // This is an estimate: all inactive leaves use about the same memory.
+        freed += std::max(leaves[newLast]->NodeMemoryUsage(),
+            inactiveMemory) - inactiveMemory;
+        evicted.push_back(newLast);
+      }
+    }
+
+    if (memory > maxMemory + freed)
+    {
+      // The leaf does not fit, and neither will the less promising ones.
+      memory -= leaves[i]->NodeMemoryUsage() - inactiveMemory;
+      leaves[i]->Deactivate();
+      break;
+    }
+
+    for (size_t j = 0; j < evicted.size(); ++j)
+    {
+      memory -= leaves[evicted[j]]->NodeMemoryUsage();
+      leaves[evicted[j]]->Deactivate();
+      memory += leaves[evicted[j]]->NodeMemoryUsage();
+    }
+    last = newLast;
+  }
+}
+
 template<
     typename FitnessFunction,
     template<typename> class NumericSplitType,
@@ -731,8 +1092,11 @@ void HoeffdingTree<
   // different things.
   if (splitDimension == size_t(-1))
   {
-    // We have not yet split.  So we have to serialize the splits.
-    ar & CreateNVP(numSamples, "numSamples");
+    // We have not yet split.  So we have to serialize the splits.  An
+    // inactive leaf is saved as a leaf that has seen no samples, so it is
+    // active again (with its majority class) when it is loaded.
+    size_t samples = active ? numSamples : 0;
+    ar & CreateNVP(samples, "numSamples");
     ar & CreateNVP(numClasses, "numClasses");
     ar & CreateNVP(maxSamples, "maxSamples");
     ar & CreateNVP(successProbability, "successProbability");
@@ -741,6 +1105,10 @@ void HoeffdingTree<
     // which case we can just reinitialize).
     if (Archive::is_loading::value)
     {
+      numSamples = samples;
+      totalSamples = samples;
+      active = true;
+
       // Re-initialize all of the splits.
       numericSplits.clear();
       categoricalSplits.clear();
@@ -762,7 +1130,7 @@ void HoeffdingTree<
 
     // There's no need to serialize if there's no information contained in the
     // splits.
-    if (numSamples == 0)
+    if (samples == 0)
       return;
 
     // Serialize numeric splits.
@@ -819,6 +1187,8 @@ void HoeffdingTree<
       categoricalSplits.clear();
 
       numSamples = 0;
+      totalSamples = 0;
+      active = true;
       numClasses = 0;
       maxSamples = 0;
       successProbability = 0.0;
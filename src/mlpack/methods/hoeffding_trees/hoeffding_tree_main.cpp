@@ -104,6 +104,9 @@ PARAM_INT_IN("bins", "If the 'domingos' split strategy is used, this specifies "
 PARAM_INT_IN("observations_before_binning", "If the 'domingos' split strategy "
     "is used, this specifies the number of samples observed before binning is "
     "performed.", "o", 100);
+PARAM_INT_IN("max_memory", "If nonzero, the maximum number of bytes that the "
+    "tree may use while training; the least promising leaves stop collecting "
+    "statistics to stay under it.", "x", 0);
 
 // Convenience typedef.
 typedef tuple<DatasetInfo, arma::mat> TupleType;
@@ -149,6 +152,9 @@ void mlpackMain()
         << endl;
   }
 
+  if (CLI::GetParam<int>("max_memory") < 0)
+    Log::Fatal << "--max_memory (-x) must be nonnegative!" << endl;
+
   // Do we need to load a model or do we already have one?
   HoeffdingTreeModel model;
   DatasetInfo datasetInfo;
@@ -211,18 +217,30 @@ void mlpackMain()
       --passes; // This model-building takes one pass.
     }
 
+    const size_t maxMemory = (size_t) CLI::GetParam<int>("max_memory");
+    if (maxMemory > 0)
+      model.LimitMemory(maxMemory);
+
     // Now pass over the trees as many times as we need to.
     if (batchTraining)
     {
       // We only need to do batch training if we've not already called
       // BuildModel.
       if (CLI::HasParam("input_model"))
+      {
         model.Train(trainingSet, labels, true);
+        if (maxMemory > 0)
+          model.LimitMemory(maxMemory);
+      }
     }
     else
     {
       for (size_t p = 0; p < passes; ++p)
+      {
         model.Train(trainingSet, labels, false);
+        if (maxMemory > 0)
+          model.LimitMemory(maxMemory);
+      }
     }
 
     Timer::Stop("tree_training");
@@ -247,6 +265,7 @@ void mlpackMain()
 
   // Get the number of nodes in the tree.
   Log::Info << model.NumNodes() << " nodes in the tree." << endl;
+  Log::Info << model.MemoryUsage() << " bytes used by the tree." << endl;
 
   // The tree is trained or loaded.  Now do any testing if we need.
   if (CLI::HasParam("test"))
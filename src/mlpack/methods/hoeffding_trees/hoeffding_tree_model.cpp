@@ -288,3 +288,41 @@ size_t HoeffdingTreeModel::NumNodes() const
 
   return 0; // This should never happen!
 }
+
+// Get the memory used by the tree.
+size_t HoeffdingTreeModel::MemoryUsage() const
+{
+  switch (type)
+  {
+    case GINI_HOEFFDING:
+      return giniHoeffdingTree->MemoryUsage();
+    case GINI_BINARY:
+      return giniBinaryTree->MemoryUsage();
+    case INFO_HOEFFDING:
+      return infoHoeffdingTree->MemoryUsage();
+    case INFO_BINARY:
+      return infoBinaryTree->MemoryUsage();
+  }
+
+  return 0; // This should never happen!
+}
+
+// Limit the memory used by the tree.
+void HoeffdingTreeModel::LimitMemory(const size_t maxMemory)
+{
+  switch (type)
+  {
+    case GINI_HOEFFDING:
+      giniHoeffdingTree->LimitMemory(maxMemory);
+      break;
+    case GINI_BINARY:
+      giniBinaryTree->LimitMemory(maxMemory);
+      break;
+    case INFO_HOEFFDING:
+      infoHoeffdingTree->LimitMemory(maxMemory);
+      break;
+    case INFO_BINARY:
+      infoBinaryTree->LimitMemory(maxMemory);
+      break;
+  }
+}
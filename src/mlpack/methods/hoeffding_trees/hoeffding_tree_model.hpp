@@ -157,6 +157,20 @@ class HoeffdingTreeModel
    */
   size_t NumNodes() const;
 
+  /**
+   * Get the approximate number of bytes used by the tree.
+   */
+  size_t MemoryUsage() const;
+
+  /**
+   * Limit the memory used by the tree to the given number of bytes, by
+   * deactivating its least promising leaves (see HoeffdingTree::LimitMemory()).
+   * Be sure that BuildModel() has been called first!
+   *
+   * @param maxMemory The maximum number of bytes the tree may use.
+   */
+  void LimitMemory(const size_t maxMemory);
+
   /**
    * Serialize the model.
    */
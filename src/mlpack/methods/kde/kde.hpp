@@ -0,0 +1,215 @@
+/**
+ * @file kde.hpp
+ *
+ * Defines the KDE class, which estimates the density of a reference set at a
+ * set of query points, using trees to approximate the sums of the kernel
+ * values.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_HPP
+#define MLPACK_METHODS_KDE_KDE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/statistic.hpp>
+
+namespace mlpack {
+namespace kde /** Kernel density estimation. */ {
+
+/**
+ * The KDE class estimates the density of a reference set at the points of a
+ * query set, which is the mean of the kernel values between each query point
+ * and all reference points:
+ *
+ *   f(q) = (1 / N) sum_r K(d(q, r)).
+ *
+ * (For a density that integrates to one, divide by the normalizing constant of
+ * the kernel, like GaussianKernel::Normalizer().)  Instead of the O(N M) kernel
+ * evaluations of the naive computation, a tree of the reference set (and in
+ * dual-tree mode, of the query set) is used: the kernel values of a whole node
+ * are estimated at once if they are close enough to each other.  Each estimate
+ * is within
+ *
+ *   absError + relError * f(q)
+ *
+ * of the true density f(q).  The kernel must be a function of the distance
+ * that does not increase with the distance, like the GaussianKernel,
+ * EpanechnikovKernel and TriangularKernel; kernels with a bounded support (the
+ * latter two) prune the nodes outside of their bandwidth exactly.
+ *
+ * An example:
+ *
+ * @code
+ * extern arma::mat referenceSet, querySet;
+ *
+ * KDE<GaussianKernel> kde(0.01, 0.0, GaussianKernel(0.5));
+ * kde.Train(referenceSet);
+ *
+ * arma::vec estimations;
+ * kde.Evaluate(querySet, estimations);
+ * @endcode
+ *
+ * With trees whose first point is the centroid of the node (like the cover
+ * tree), the dual-tree traversal may evaluate a pair of points more than once,
+ * which cannot be told apart from the sums; for these trees the single-tree
+ * traversal is always used.
+ *
+ * @tparam KernelType Kernel to use (a function of the distance).
+ * @tparam MetricType Metric to use for the distances.
+ * @tparam MatType Type of the data matrices.
+ * @tparam TreeType Type of the tree to use.
+ */
+template<typename KernelType = kernel::GaussianKernel,
+         typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class KDE
+{
+ public:
+  //! Convenience typedef.
+  typedef TreeType<MetricType, tree::EmptyStatistic, MatType> Tree;
+
+  /**
+   * Initialize the KDE object with the given error tolerances, kernel and
+   * metric.  Train() must be called before Evaluate().
+   *
+   * @param relError Relative error tolerance of each estimate (at least 0).
+   * @param absError Absolute error tolerance of each estimate (at least 0).
+   * @param kernel Instantiated kernel.
+   * @param metric Instantiated metric.
+   * @param naive If true, all kernel values are computed (without a tree).
+   * @param singleMode If true, single-tree computation is used instead of
+   *     dual-tree computation.
+   */
+  KDE(const double relError = 0.05,
+      const double absError = 0.0,
+      KernelType kernel = KernelType(),
+      MetricType metric = MetricType(),
+      const bool naive = false,
+      const bool singleMode = false);
+
+  //! Copying a KDE object is not supported (it may not own its tree).
+  KDE(const KDE& other) = delete;
+
+  //! Take the reference tree and the settings of the given KDE object.
+  KDE(KDE&& other);
+
+  //! Delete the KDE object and the reference tree, if it was built by it.
+  ~KDE();
+
+  /**
+   * Set the reference set, and build the reference tree (unless naive mode is
+   * used).  The matrix is taken by value; use std::move() to avoid a copy.
+   * The tree may rearrange the points, which does not change the estimates.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * Set the reference tree, which is not copied; it must stay valid while the
+   * KDE object uses it, and is not deleted by it.
+   *
+   * @param referenceTree Tree of the reference points.
+   */
+  void Train(Tree* referenceTree);
+
+  /**
+   * Estimate the density of the reference set at each of the given query
+   * points.  Naive mode and single-tree mode divide the query points between
+   * the threads.
+   *
+   * @param querySet Set of query points.
+   * @param estimations Vector to store the estimate of each query point in.
+   */
+  void Evaluate(const MatType& querySet, arma::vec& estimations);
+
+  //! Get the relative error tolerance.
+  double RelativeError() const { return relError; }
+  //! Set the relative error tolerance (at least 0).
+  void RelativeError(const double newError);
+
+  //! Get the absolute error tolerance.
+  double AbsoluteError() const { return absError; }
+  //! Set the absolute error tolerance (at least 0).
+  void AbsoluteError(const double newError);
+
+  //! Get the kernel.
+  const KernelType& Kernel() const { return kernel; }
+  //! Modify the kernel.
+  KernelType& Kernel() { return kernel; }
+
+  //! Get the metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get whether naive mode is used.
+  bool Naive() const { return naive; }
+  //! Modify whether naive mode is used; Train() must be called again after
+  //! naive mode is switched off.
+  bool& Naive() { return naive; }
+
+  //! Get whether single-tree mode is used.
+  bool SingleMode() const { return singleMode; }
+  //! Modify whether single-tree mode is used.
+  bool& SingleMode() { return singleMode; }
+
+  //! Get the reference tree (NULL in naive mode).
+  Tree* ReferenceTree() { return referenceTree; }
+
+  //! Get the number of kernel evaluations of the last call to Evaluate().
+  size_t BaseCases() const { return baseCases; }
+  //! Get the number of node distances of the last call to Evaluate().
+  size_t Scores() const { return scores; }
+
+ private:
+  //! Check the given error tolerance.
+  static void CheckError(const double error, const std::string& name);
+
+  //! Delete the reference tree and set, if they are owned.
+  void Clear();
+
+  //! The relative error tolerance.
+  double relError;
+  //! The absolute error tolerance.
+  double absError;
+  //! The instantiated kernel.
+  KernelType kernel;
+  //! The instantiated metric.
+  MetricType metric;
+  //! Whether naive mode is used.
+  bool naive;
+  //! Whether single-tree mode is used.
+  bool singleMode;
+
+  //! The reference tree (NULL if not built).
+  Tree* referenceTree;
+  //! The reference set (the dataset of the tree, if there is one).
+  const MatType* referenceSet;
+  //! Whether the reference tree is owned by this object.
+  bool treeOwner;
+  //! Whether the reference set is owned by this object (without a tree).
+  bool setOwner;
+
+  //! The number of kernel evaluations of the last evaluation.
+  size_t baseCases;
+  //! The number of node distances of the last evaluation.
+  size_t scores;
+};
+
+} // namespace kde
+} // namespace mlpack
+
+// Include implementation.
+#include "kde_impl.hpp"
+
+#endif
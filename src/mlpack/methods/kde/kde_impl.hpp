@@ -0,0 +1,338 @@
+/**
+ * @file kde_impl.hpp
+ *
+ * Implementation of the KDE class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_IMPL_HPP
+#define MLPACK_METHODS_KDE_KDE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde.hpp"
+
+// The rules for traversal.
+#include "kde_rules.hpp"
+
+namespace mlpack {
+namespace kde {
+
+//! Call the tree constructor that does mapping.
+template<typename TreeType, typename MatType>
+TreeType* BuildTree(
+    const MatType& dataset,
+    std::vector<size_t>& oldFromNew,
+    const typename std::enable_if<
+        tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
+{
+  return new TreeType(dataset, oldFromNew);
+}
+
+//! Call the tree constructor that does not do mapping.
+template<typename TreeType, typename MatType>
+TreeType* BuildTree(
+    const MatType& dataset,
+    const std::vector<size_t>& /* oldFromNew */,
+    const typename std::enable_if<
+        !tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
+{
+  return new TreeType(dataset);
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+KDE<KernelType, MetricType, MatType, TreeType>::KDE(
+    const double relError,
+    const double absError,
+    KernelType kernel,
+    MetricType metric,
+    const bool naive,
+    const bool singleMode) :
+    relError(relError),
+    absError(absError),
+    kernel(std::move(kernel)),
+    metric(std::move(metric)),
+    naive(naive),
+    singleMode(singleMode),
+    referenceTree(NULL),
+    referenceSet(NULL),
+    treeOwner(false),
+    setOwner(false),
+    baseCases(0),
+    scores(0)
+{
+  CheckError(relError, "relative");
+  CheckError(absError, "absolute");
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+KDE<KernelType, MetricType, MatType, TreeType>::KDE(KDE&& other) :
+    relError(other.relError),
+    absError(other.absError),
+    kernel(std::move(other.kernel)),
+    metric(std::move(other.metric)),
+    naive(other.naive),
+    singleMode(other.singleMode),
+    referenceTree(other.referenceTree),
+    referenceSet(other.referenceSet),
+    treeOwner(other.treeOwner),
+    setOwner(other.setOwner),
+    baseCases(other.baseCases),
+    scores(other.scores)
+{
+  other.referenceTree = NULL;
+  other.referenceSet = NULL;
+  other.treeOwner = false;
+  other.setOwner = false;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+KDE<KernelType, MetricType, MatType, TreeType>::~KDE()
+{
+  Clear();
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::Train(
+    MatType referenceSet)
+{
+  Clear();
+
+  if (naive)
+  {
+    this->referenceSet = new MatType(std::move(referenceSet));
+    setOwner = true;
+    return;
+  }
+
+  // The order of the reference points does not matter for the sums.
+  Timer::Start("tree_building");
+  referenceTree = new Tree(std::move(referenceSet));
+  Timer::Stop("tree_building");
+
+  this->referenceSet = &referenceTree->Dataset();
+  treeOwner = true;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::Train(
+    Tree* referenceTree)
+{
+  Clear();
+
+  this->referenceTree = referenceTree;
+  referenceSet = &referenceTree->Dataset();
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::Evaluate(
+    const MatType& querySet,
+    arma::vec& estimations)
+{
+  if (referenceSet == NULL || (!naive && referenceTree == NULL))
+  {
+    throw std::runtime_error("KDE::Evaluate(): no reference tree; call "
+        "Train() first!");
+  }
+
+  if (querySet.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "KDE::Evaluate(): dimensionalities of query set ("
+        << querySet.n_rows << ") and reference set (" << referenceSet->n_rows
+        << ") do not match!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  estimations.zeros(querySet.n_cols);
+  baseCases = 0;
+  scores = 0;
+
+  if (referenceSet->n_cols == 0)
+    return;
+
+  typedef KDERules<MetricType, KernelType, Tree> RuleType;
+
+  Timer::Start("computing_densities");
+  if (naive)
+  {
+    RuleType rules(*referenceSet, querySet, estimations, relError, absError,
+        metric, kernel);
+
+    // The query points are independent, so they are divided between threads,
+    // each of which has its own copy of the rules.
+    #pragma omp parallel
+    {
+      RuleType workerRules(rules);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          workerRules.BaseCase(i, j);
+    }
+
+    baseCases = querySet.n_cols * referenceSet->n_cols;
+  }
+  else if (singleMode || tree::TreeTraits<Tree>::FirstPointIsCentroid)
+  {
+    RuleType rules(*referenceSet, querySet, estimations, relError, absError,
+        metric, kernel);
+
+    size_t ruleBaseCases = 0, ruleScores = 0;
+
+    // The traversals of the query points are independent and do not change the
+    // reference tree, so the query points are divided between threads, each of
+    // which has its own copy of the rules.
+    #pragma omp parallel reduction(+:ruleBaseCases, ruleScores)
+    {
+      RuleType workerRules(rules);
+      typename Tree::template SingleTreeTraverser<RuleType>
+          traverser(workerRules);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+
+      ruleBaseCases += workerRules.BaseCases();
+      ruleScores += workerRules.Scores();
+    }
+
+    baseCases = ruleBaseCases;
+    scores = ruleScores;
+  }
+  else
+  {
+    // Build the query tree.
+    Timer::Stop("computing_densities");
+    Timer::Start("tree_building");
+    std::vector<size_t> oldFromNewQueries;
+    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    Timer::Stop("tree_building");
+    Timer::Start("computing_densities");
+
+    arma::vec treeEstimations(querySet.n_cols, arma::fill::zeros);
+    RuleType rules(*referenceSet, queryTree->Dataset(), treeEstimations,
+        relError, absError, metric, kernel);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(*queryTree, *referenceTree);
+
+    baseCases = rules.BaseCases();
+    scores = rules.Scores();
+
+    // Map the estimates back to the original order of the query points.
+    if (tree::TreeTraits<Tree>::RearrangesDataset)
+    {
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        estimations[oldFromNewQueries[i]] = treeEstimations[i];
+    }
+    else
+    {
+      estimations = std::move(treeEstimations);
+    }
+
+    delete queryTree;
+  }
+
+  estimations /= referenceSet->n_cols;
+  Timer::Stop("computing_densities");
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::RelativeError(
+    const double newError)
+{
+  CheckError(newError, "relative");
+  relError = newError;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::AbsoluteError(
+    const double newError)
+{
+  CheckError(newError, "absolute");
+  absError = newError;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::CheckError(
+    const double error, const std::string& name)
+{
+  if (error < 0.0)
+  {
+    std::ostringstream oss;
+    oss << "KDE: the " << name << " error tolerance must be at least 0 (given "
+        << error << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::Clear()
+{
+  if (treeOwner)
+    delete referenceTree;
+  if (setOwner)
+    delete referenceSet;
+
+  referenceTree = NULL;
+  referenceSet = NULL;
+  treeOwner = false;
+  setOwner = false;
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
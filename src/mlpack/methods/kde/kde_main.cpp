@@ -0,0 +1,179 @@
+/**
+ * @file kde_main.cpp
+ *
+ * Executable for kernel density estimation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/cover_tree.hpp>
+
+#include "kde.hpp"
+
+using namespace mlpack;
+using namespace mlpack::kde;
+using namespace mlpack::kernel;
+using namespace mlpack::metric;
+using namespace mlpack::tree;
+using namespace std;
+
+PROGRAM_INFO("Kernel Density Estimation",
+    "This program estimates the density of a reference set at each point of a "
+    "query set: the mean of the kernel values between the query point and all "
+    "of the reference points.  Trees are used to estimate the kernel values of "
+    "whole groups of reference points at once, so that each estimate is within"
+    " the absolute error plus the relative error times the density of the true"
+    " density.  The estimates are not divided by the normalizing constant of "
+    "the kernel."
+    "\n\n"
+    "The reference set is given with " + PRINT_PARAM_STRING("reference") +
+    ", and the query set with " + PRINT_PARAM_STRING("query") + " (if it is "
+    "not given, the density is estimated at the reference points).  The "
+    "estimates can be saved with " + PRINT_PARAM_STRING("predictions") + "."
+    "\n\n"
+    "The kernel (" + PRINT_PARAM_STRING("kernel") + ") may be 'gaussian', "
+    "'epanechnikov' or 'triangular', with the bandwidth given by " +
+    PRINT_PARAM_STRING("bandwidth") + ".  The error tolerances are given with "
+    + PRINT_PARAM_STRING("rel_error") + " and " +
+    PRINT_PARAM_STRING("abs_error") + ".  The type of tree (" +
+    PRINT_PARAM_STRING("tree_type") + ") may be 'kd', 'ball' or 'cover'; the " +
+    PRINT_PARAM_STRING("single_mode") + " parameter forces single-tree "
+    "estimation (as opposed to the default dual-tree estimation), and " +
+    PRINT_PARAM_STRING("naive") + " computes all of the kernel values.  "
+    "Single-tree and naive estimation use all threads available to OpenMP."
+    "\n\n"
+    "For example, the density of the points in " + PRINT_DATASET("reference")
+    + " at the points in " + PRINT_DATASET("query") + " with a Gaussian kernel"
+    " with a bandwidth of 0.2 and a relative error of 1% can be saved to " +
+    PRINT_DATASET("predictions") + " with the following command:"
+    "\n\n" +
+    PRINT_CALL("kde", "reference", "reference", "query", "query", "bandwidth",
+        0.2, "rel_error", 0.01, "predictions", "predictions"));
+
+PARAM_MATRIX_IN_REQ("reference", "Reference dataset.", "r");
+PARAM_MATRIX_IN("query", "Query dataset (the reference dataset if not "
+    "given).", "q");
+PARAM_COL_OUT("predictions", "Vector to save the density estimates of the "
+    "query points to.", "p");
+
+PARAM_STRING_IN("kernel", "Kernel to use ('gaussian', 'epanechnikov', "
+    "'triangular').", "k", "gaussian");
+PARAM_DOUBLE_IN("bandwidth", "Bandwidth of the kernel.", "b", 1.0);
+PARAM_DOUBLE_IN("rel_error", "Relative error tolerance of the estimates.", "e",
+    0.05);
+PARAM_DOUBLE_IN("abs_error", "Absolute error tolerance of the estimates.", "E",
+    0.0);
+
+PARAM_STRING_IN("tree_type", "Type of tree to use ('kd', 'ball', 'cover').",
+    "t", "kd");
+PARAM_FLAG("single_mode", "If set, single-tree estimation (not dual-tree) will "
+    "be used.", "S");
+PARAM_FLAG("naive", "If set, all kernel values will be computed (without a "
+    "tree).", "N");
+
+// Estimate the densities with the given type of KDE object, and save them.
+template<typename KDEType>
+void EvaluateAndSave(KDEType kde)
+{
+  arma::mat reference = std::move(CLI::GetParam<arma::mat>("reference"));
+
+  arma::vec estimations;
+  if (CLI::HasParam("query"))
+  {
+    const arma::mat& query = CLI::GetParam<arma::mat>("query");
+    kde.Train(std::move(reference));
+    kde.Evaluate(query, estimations);
+  }
+  else
+  {
+    // The tree may rearrange its copy of the points.
+    kde.Train(reference);
+    kde.Evaluate(reference, estimations);
+  }
+
+  Log::Info << kde.BaseCases() << " kernel evaluations and " << kde.Scores()
+      << " node distances." << endl;
+
+  if (CLI::HasParam("predictions"))
+    CLI::GetParam<arma::vec>("predictions") = std::move(estimations);
+}
+
+// Choose the tree type for the given kernel.
+template<typename KernelType>
+void RunKDE(const KernelType& kernel)
+{
+  const double relError = CLI::GetParam<double>("rel_error");
+  const double absError = CLI::GetParam<double>("abs_error");
+  const bool naive = CLI::HasParam("naive");
+  const bool singleMode = CLI::HasParam("single_mode");
+
+  const string treeType = CLI::GetParam<string>("tree_type");
+  if (treeType == "kd")
+  {
+    typedef KDE<KernelType, EuclideanDistance, arma::mat, KDTree> KDEType;
+    EvaluateAndSave(KDEType(relError, absError, kernel, EuclideanDistance(),
+        naive, singleMode));
+  }
+  else if (treeType == "ball")
+  {
+    typedef KDE<KernelType, EuclideanDistance, arma::mat, BallTree> KDEType;
+    EvaluateAndSave(KDEType(relError, absError, kernel, EuclideanDistance(),
+        naive, singleMode));
+  }
+  else if (treeType == "cover")
+  {
+    typedef KDE<KernelType, EuclideanDistance, arma::mat, StandardCoverTree>
+        KDEType;
+    EvaluateAndSave(KDEType(relError, absError, kernel, EuclideanDistance(),
+        naive, singleMode));
+  }
+  else
+  {
+    Log::Fatal << "Unknown tree type specified!  Valid choices are 'kd', "
+        << "'ball' and 'cover'." << endl;
+  }
+}
+
+void mlpackMain()
+{
+  if (!CLI::HasParam("predictions"))
+    Log::Warn << "--predictions_file is not specified; no output will be "
+        << "saved!" << endl;
+
+  if (CLI::HasParam("single_mode") && CLI::HasParam("naive"))
+    Log::Warn << "--single_mode ignored because --naive is specified." << endl;
+
+  const double bandwidth = CLI::GetParam<double>("bandwidth");
+  if (bandwidth <= 0.0)
+  {
+    Log::Fatal << "Invalid bandwidth " << bandwidth << "; must be greater than "
+        << "0!" << endl;
+  }
+
+  if (CLI::GetParam<double>("rel_error") < 0.0 ||
+      CLI::GetParam<double>("abs_error") < 0.0)
+  {
+    Log::Fatal << "The error tolerances must be at least 0!" << endl;
+  }
+
+  const string kernelType = CLI::GetParam<string>("kernel");
+  if (kernelType == "gaussian")
+    RunKDE(GaussianKernel(bandwidth));
+  else if (kernelType == "epanechnikov")
+    RunKDE(EpanechnikovKernel(bandwidth));
+  else if (kernelType == "triangular")
+    RunKDE(TriangularKernel(bandwidth));
+  else
+  {
+    Log::Fatal << "Unknown kernel type specified!  Valid choices are "
+        << "'gaussian', 'epanechnikov' and 'triangular'." << endl;
+  }
+}
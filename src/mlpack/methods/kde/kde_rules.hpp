@@ -0,0 +1,181 @@
+/**
+ * @file kde_rules.hpp
+ *
+ * Rules for kernel density estimation, so that it can be done with arbitrary
+ * tree types.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_RULES_HPP
+#define MLPACK_METHODS_KDE_KDE_RULES_HPP
+
+#include <mlpack/core/tree/traversal_info.hpp>
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * The KDERules class is a template helper class used by the KDE class to sum
+ * the kernel values between the query points and the reference points.  A
+ * reference node is pruned if the kernel values of all of its points are close
+ * enough to each other: then each of them is estimated by the mean of the
+ * largest and the smallest kernel value of the node (at the smallest and the
+ * largest distance).  Each query point has an error budget of
+ *
+ *   absError + relError * (kernel value)
+ *
+ * for each reference point, so that the estimate of the mean kernel value of
+ * each query point is within absError + relError * (true value) of the true
+ * value.  The estimates are summed into the given vector; they are divided by
+ * the number of reference points by KDE.
+ *
+ * The kernel must be a function of the distance that does not increase with
+ * the distance (like the Gaussian, Epanechnikov and triangular kernels).
+ *
+ * @tparam MetricType The metric to use for computation.
+ * @tparam KernelType The kernel to use for computation.
+ * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ */
+template<typename MetricType, typename KernelType, typename TreeType>
+class KDERules
+{
+ public:
+  /**
+   * Construct the KDERules object.  This is usually done from within the KDE
+   * class at evaluation time.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param densities Vector to add the kernel sums of the query points to.
+   * @param relError Relative error tolerance.
+   * @param absError Absolute error tolerance.
+   * @param metric Instantiated metric.
+   * @param kernel Instantiated kernel.
+   */
+  KDERules(const typename TreeType::Mat& referenceSet,
+           const typename TreeType::Mat& querySet,
+           arma::vec& densities,
+           const double relError,
+           const double absError,
+           MetricType& metric,
+           KernelType& kernel);
+
+  /**
+   * Compute the base case between the given query point and reference point.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceIndex Index of reference point.
+   */
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+
+  /**
+   * Get the score for recursion order.  A low score indicates priority for
+   * recursion, while DBL_MAX indicates that the node should not be recursed
+   * into at all (it has been pruned, and its kernel values were estimated).
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   */
+  double Score(const size_t queryIndex, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order.  Nothing that was not pruned
+   * before can be pruned now, so this returns the old score.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  /**
+   * Get the score for recursion order.  A low score indicates priority for
+   * recursion, while DBL_MAX indicates that the node should not be recursed
+   * into at all (it has been pruned, and its kernel values were estimated for
+   * all points of the query node).
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   */
+  double Score(TreeType& queryNode, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order.  Nothing that was not pruned
+   * before can be pruned now, so this returns the old score.
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(TreeType& queryNode,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  typedef typename tree::TraversalInfo<TreeType> TraversalInfoType;
+
+  const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
+  TraversalInfoType& TraversalInfo() { return traversalInfo; }
+
+  //! Get the number of base cases.
+  size_t BaseCases() const { return baseCases; }
+  //! Get the number of scores (that is, calls to RangeDistance()).
+  size_t Scores() const { return scores; }
+
+ private:
+  /**
+   * Check whether the kernel values of a node can be estimated for the given
+   * range of distances, and if so, estimate them.
+   *
+   * @param distances Range of the distances between the query point (or
+   *     node) and the reference node.
+   * @param estimate Set to the estimated kernel value of each reference point.
+   * @return Whether the node can be pruned.
+   */
+  bool CanPrune(const math::Range& distances, double& estimate) const;
+
+  //! The reference set.
+  const typename TreeType::Mat& referenceSet;
+
+  //! The query set.
+  const typename TreeType::Mat& querySet;
+
+  //! The kernel sums of the query points.
+  arma::vec& densities;
+
+  //! The relative error tolerance.
+  double relError;
+
+  //! The absolute error tolerance.
+  double absError;
+
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The instantiated kernel.
+  KernelType& kernel;
+
+  //! The last query index.
+  size_t lastQueryIndex;
+  //! The last reference index.
+  size_t lastReferenceIndex;
+
+  TraversalInfoType traversalInfo;
+
+  //! The number of base cases.
+  size_t baseCases;
+  //! The number of scores.
+  size_t scores;
+};
+
+} // namespace kde
+} // namespace mlpack
+
+// Include implementation.
+#include "kde_rules_impl.hpp"
+
+#endif
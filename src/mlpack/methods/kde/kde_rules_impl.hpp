@@ -0,0 +1,164 @@
+/**
+ * @file kde_rules_impl.hpp
+ *
+ * Implementation of rules for kernel density estimation with generic trees.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_RULES_IMPL_HPP
+#define MLPACK_METHODS_KDE_KDE_RULES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde_rules.hpp"
+
+namespace mlpack {
+namespace kde {
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDERules<MetricType, KernelType, TreeType>::KDERules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    arma::vec& densities,
+    const double relError,
+    const double absError,
+    MetricType& metric,
+    KernelType& kernel) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    densities(densities),
+    relError(relError),
+    absError(absError),
+    metric(metric),
+    kernel(kernel),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+//! The base case.  Evaluate the kernel between the two points and add it to
+//! the sum of the query point.
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline
+double KDERules<MetricType, KernelType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
+{
+  // If we have just performed this base case, don't add it again.
+  if ((lastQueryIndex == queryIndex) && (lastReferenceIndex == referenceIndex))
+    return 0.0;
+
+  const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
+      referenceSet.unsafe_col(referenceIndex));
+  ++baseCases;
+
+  lastQueryIndex = queryIndex;
+  lastReferenceIndex = referenceIndex;
+
+  densities[queryIndex] += kernel.Evaluate(distance);
+
+  return distance;
+}
+
+//! Single-tree scoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
+{
+  const math::Range distances = referenceNode.RangeDistance(
+      querySet.unsafe_col(queryIndex));
+  ++scores;
+
+  double estimate;
+  if (!CanPrune(distances, estimate))
+    return distances.Lo();
+
+  // Trees whose first point is the centroid evaluate the base case of a node
+  // after it was scored, unless the node is a self-child: then the base case
+  // of its point was evaluated with its parent, and must not be counted twice.
+  size_t numPoints = referenceNode.NumDescendants();
+  if (tree::TreeTraits<TreeType>::FirstPointIsCentroid &&
+      tree::TreeTraits<TreeType>::HasSelfChildren &&
+      (referenceNode.Parent() != NULL) &&
+      (referenceNode.Point(0) == referenceNode.Parent()->Point(0)))
+  {
+    --numPoints;
+  }
+
+  densities[queryIndex] += numPoints * estimate;
+  return DBL_MAX;
+}
+
+//! Single-tree rescoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Rescore(
+    const size_t /* queryIndex */,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  // If it wasn't pruned before, it isn't pruned now.
+  return oldScore;
+}
+
+//! Dual-tree scoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  const math::Range distances = referenceNode.RangeDistance(queryNode);
+  ++scores;
+
+  double estimate;
+  if (!CanPrune(distances, estimate))
+    return distances.Lo();
+
+  // Each pair of points is covered by exactly one visited combination of
+  // nodes, so all points of the query node get the whole reference node.
+  const double sum = referenceNode.NumDescendants() * estimate;
+  for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+    densities[queryNode.Descendant(i)] += sum;
+
+  return DBL_MAX;
+}
+
+//! Dual-tree rescoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Rescore(
+    TreeType& /* queryNode */,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  // If it wasn't pruned before, it isn't pruned now.
+  return oldScore;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline bool KDERules<MetricType, KernelType, TreeType>::CanPrune(
+    const math::Range& distances,
+    double& estimate) const
+{
+  // The kernel does not increase with the distance, so these bound the kernel
+  // values of all points of the node.
+  const double maxKernel = kernel.Evaluate(distances.Lo());
+  const double minKernel = kernel.Evaluate(distances.Hi());
+
+  // The mean of the bounds is off by at most half of their difference, which
+  // must be within the error budget of each point.
+  if (maxKernel - minKernel > 2.0 * (absError + relError * minKernel))
+    return false;
+
+  estimate = (maxKernel + minKernel) / 2.0;
+  return true;
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
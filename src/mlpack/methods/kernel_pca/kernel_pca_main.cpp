@@ -30,6 +30,7 @@
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
 #include <mlpack/methods/nystroem_method/nystroem_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 
 #include "kernel_pca.hpp"
 
@@ -92,7 +93,13 @@ PROGRAM_INFO("Kernel Principal Components Analysis",
     "the kernel matrix; to specify the sampling scheme, the " +
     PRINT_PARAM_STRING("sampling") + " parameter is used.  The "
     "sampling scheme for the Nystr\u00F6m method can be chosen from the "
-    "following list: 'kmeans', 'random', 'ordered'.");
+    "following list: 'kmeans', 'random', 'ordered'."
+    "\n\n"
+    "For datasets whose kernel matrix does not fit in memory, the " +
+    PRINT_PARAM_STRING("randomized") + " parameter finds the leading kernel "
+    "principal components with a randomized range finder instead, computing "
+    "the kernel matrix in blocks that are not stored; the memory then grows "
+    "linearly with the number of points.");
 
 PARAM_MATRIX_IN_REQ("input", "Input dataset to perform KPCA on.", "i");
 PARAM_MATRIX_OUT("output", "Matrix to save modified dataset to.", "o");
@@ -107,6 +114,8 @@ PARAM_FLAG("center", "If set, the transformed data will be centered about the "
     "origin.", "c");
 
 PARAM_FLAG("nystroem_method", "If set, the nystroem method will be used.", "n");
+PARAM_FLAG("randomized", "If set, a randomized range finder on the kernel "
+    "matrix, computed in blocks, will be used.", "r");
 
 PARAM_STRING_IN("sampling", "Sampling scheme to use for the nystroem method: "
     "'kmeans', 'random', 'ordered'", "s", "kmeans");
@@ -124,6 +133,7 @@ template<typename KernelType>
 void RunKPCA(arma::mat& dataset,
              const bool centerTransformedData,
              const bool nystroem,
+             const bool randomized,
              const size_t newDim,
              const string& sampling,
              KernelType& kernel)
@@ -156,6 +166,12 @@ void RunKPCA(arma::mat& dataset,
         << "choices are 'kmeans', 'random' and 'ordered'" << endl;
     }
   }
+  else if (randomized)
+  {
+    KernelPCA<KernelType, RandomizedKernelRule<KernelType>> kpca(kernel,
+        centerTransformedData);
+    kpca.Apply(dataset, newDim);
+  }
   else
   {
     KernelPCA<KernelType> kpca(kernel, centerTransformedData);
@@ -191,21 +207,25 @@ void mlpackMain()
 
   const bool centerTransformedData = CLI::HasParam("center");
   const bool nystroem = CLI::HasParam("nystroem_method");
+  const bool randomized = CLI::HasParam("randomized");
+  if (nystroem && randomized)
+    Log::Fatal << "Only one of --nystroem_method (-n) and --randomized (-r) "
+        << "may be specified!" << endl;
   const string sampling = CLI::GetParam<string>("sampling");
 
   if (kernelType == "linear")
   {
     LinearKernel kernel;
-    RunKPCA<LinearKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<LinearKernel>(dataset, centerTransformedData, nystroem,
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "gaussian")
   {
     const double bandwidth = CLI::GetParam<double>("bandwidth");
 
     GaussianKernel kernel(bandwidth);
-    RunKPCA<GaussianKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<GaussianKernel>(dataset, centerTransformedData, nystroem,
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "polynomial")
   {
@@ -214,7 +234,7 @@ void mlpackMain()
 
     PolynomialKernel kernel(degree, offset);
     RunKPCA<PolynomialKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "hyptan")
   {
@@ -223,15 +243,15 @@ void mlpackMain()
 
     HyperbolicTangentKernel kernel(scale, offset);
     RunKPCA<HyperbolicTangentKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "laplacian")
   {
     const double bandwidth = CLI::GetParam<double>("bandwidth");
 
     LaplacianKernel kernel(bandwidth);
-    RunKPCA<LaplacianKernel>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<LaplacianKernel>(dataset, centerTransformedData, nystroem,
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "epanechnikov")
   {
@@ -239,13 +259,13 @@ void mlpackMain()
 
     EpanechnikovKernel kernel(bandwidth);
     RunKPCA<EpanechnikovKernel>(dataset, centerTransformedData, nystroem,
-        newDim, sampling, kernel);
+        randomized, newDim, sampling, kernel);
   }
   else if (kernelType == "cosine")
   {
     CosineDistance kernel;
-    RunKPCA<CosineDistance>(dataset, centerTransformedData, nystroem, newDim,
-        sampling, kernel);
+    RunKPCA<CosineDistance>(dataset, centerTransformedData, nystroem,
+        randomized, newDim, sampling, kernel);
   }
   else
   {
@@ -0,0 +1,152 @@
+/**
+ * @file randomized_method.hpp
+ *
+ * Use a randomized range finder on the kernel matrix, computed in blocks, to
+ * find the kernel principal components without storing the kernel matrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+#define MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
+namespace mlpack {
+namespace kpca {
+
+/**
+ * Find the leading kernel principal components with a randomized range
+ * finder, like RandomizedSVD does for the data matrix (Halko, Martinsson and
+ * Tropp, "Finding structure with randomness", 2011).  The centered kernel
+ * matrix is never stored: each product of it with a thin matrix is computed
+ * from tiles of BlockSize x BlockSize kernel values, which are evaluated with
+ * kernel::KernelMatrix() and discarded, and the row blocks of the product are
+ * computed in parallel with OpenMP.  So the memory grows as O(n * rank)
+ * instead of O(n^2), at the cost of computing the kernel values
+ * PowerIterations + 2 times.
+ *
+ * The range finder uses rank + Oversampling random directions; its
+ * eigenvalues and eigenvectors are approximations of those of NaiveKernelRule,
+ * which are the most accurate for the largest eigenvalues.
+ *
+ * @tparam KernelType Type of kernel to use.
+ * @tparam PowerIterations Number of power iterations of the range finder.
+ * @tparam Oversampling Number of extra random directions.
+ * @tparam BlockSize Number of points in each block of the kernel matrix.
+ */
+template<typename KernelType,
+         size_t PowerIterations = 2,
+         size_t Oversampling = 10,
+         size_t BlockSize = 1024>
+class RandomizedKernelRule
+{
+ public:
+  /**
+   * Find the leading eigenvectors of the centered kernel matrix.
+   *
+   * @param data Input data points.
+   * @param transformedData Matrix to output results into.
+   * @param eigval KPCA eigenvalues will be written to this vector.
+   * @param eigvec KPCA eigenvectors will be written to this matrix.
+   * @param rank Number of kernel principal components to find.
+   * @param kernel Kernel to be used for computation.
+   */
+  static void ApplyKernelMatrix(const arma::mat& data,
+                                arma::mat& transformedData,
+                                arma::vec& eigval,
+                                arma::mat& eigvec,
+                                const size_t rank,
+                                KernelType kernel = KernelType())
+  {
+    const size_t n = data.n_cols;
+    const size_t components = std::min(rank, n);
+    const size_t samples = std::min(components + Oversampling, n);
+
+    // Find an orthonormal basis of the range of the centered kernel matrix.
+    arma::mat q, r, y;
+    CenteredKernelProduct(data, arma::randn<arma::mat>(n, samples), kernel,
+        y);
+    arma::qr_econ(q, r, y);
+    for (size_t i = 0; i < PowerIterations; ++i)
+    {
+      CenteredKernelProduct(data, q, kernel, y);
+      arma::qr_econ(q, r, y);
+    }
+
+    // Eigendecompose the projection of the centered kernel matrix onto the
+    // basis.
+    CenteredKernelProduct(data, q, kernel, y);
+    arma::mat projection = q.t() * y;
+    projection = 0.5 * (projection + projection.t());
+
+    arma::mat smallEigvec;
+    arma::eig_sym(eigval, smallEigvec, projection);
+
+    // The eigenvalues are ordered backwards (we need largest to smallest).
+    eigval = arma::flipud(eigval);
+    smallEigvec = arma::fliplr(smallEigvec);
+
+    eigval = eigval.head(components);
+    smallEigvec = smallEigvec.head_cols(components);
+    eigvec = q * smallEigvec;
+
+    // Like NaiveKernelRule, the projection of the points onto each
+    // eigenvector is divided by the square root of its eigenvalue.
+    transformedData = (y * smallEigvec).t();
+    transformedData.each_col() /= arma::sqrt(eigval);
+  }
+
+ private:
+  /**
+   * Compute the product of the centered kernel matrix H K H (with
+   * H = I - 1 1^T / n) with the given matrix, in blocks.
+   *
+   * @param data Input data points.
+   * @param x Matrix with one row per point.
+   * @param kernel Kernel to be used for computation.
+   * @param y Matrix to store the product in.
+   */
+  static void CenteredKernelProduct(const arma::mat& data,
+                                    const arma::mat& x,
+                                    KernelType& kernel,
+                                    arma::mat& y)
+  {
+    const size_t n = data.n_cols;
+    const size_t numBlocks = (n + BlockSize - 1) / BlockSize;
+
+    arma::mat centeredX = x;
+    centeredX.each_row() -= arma::mean(x, 0);
+
+    y.zeros(n, x.n_cols);
+
+    // Each thread computes whole row blocks of the product, so no two threads
+    // write to the same rows.
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) numBlocks; ++i)
+    {
+      const size_t rowBegin = i * BlockSize;
+      const size_t rowEnd = std::min(rowBegin + BlockSize, n);
+
+      arma::mat tile;
+      for (size_t colBegin = 0; colBegin < n; colBegin += BlockSize)
+      {
+        const size_t colEnd = std::min(colBegin + BlockSize, n);
+        kernel::KernelMatrix(kernel, data.cols(rowBegin, rowEnd - 1),
+            data.cols(colBegin, colEnd - 1), tile);
+        y.rows(rowBegin, rowEnd - 1) += tile *
+            centeredX.rows(colBegin, colEnd - 1);
+      }
+    }
+
+    y.each_row() -= arma::mean(y, 0);
+  }
+};
+
+} // namespace kpca
+} // namespace mlpack
+
+#endif
@@ -110,6 +110,27 @@ class DualTreeKMeans
 
   arma::mat interclusterDistances; // Static storage for intercluster distances.
 
+  //! The type of the nearest neighbor search among the centroids.
+  typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort, MetricType,
+      MatType, NNSTreeType> CentroidSearchType;
+
+  //! The centroid tree is rebuilt once a centroid has moved further than this
+  //! fraction of the furthest descendant distance of the root since the tree
+  //! was built; until then the tree is refitted, if the tree type can do that.
+  static constexpr double RebuildMovement = 0.1;
+
+  //! The nearest neighbor search among the centroids, which holds the tree
+  //! built on the centroids; it is kept between iterations.
+  std::unique_ptr<CentroidSearchType> centroidSearch;
+  //! The mapping of the points of the centroid tree to the centroids.
+  std::vector<size_t> oldFromNewCentroids;
+  //! The centroids the centroid tree was built on.
+  arma::mat treeCentroids;
+
+  //! Build a tree on the given centroids, or refit the tree of the last
+  //! iteration to them if they have not moved far since it was built.
+  void UpdateCentroidTree(const arma::mat& centroids);
+
   //! Update the bounds in the tree before the next iteration.
   //! centroids is the current (not yet searched) centroids.
   void UpdateTree(Tree& node,
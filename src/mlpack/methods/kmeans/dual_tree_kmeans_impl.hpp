@@ -20,6 +20,8 @@
 
 #include "dual_tree_kmeans_rules.hpp"
 
+#include <mlpack/core/util/sfinae_utility.hpp>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -47,6 +49,49 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+HAS_MEM_FUNC(RefitBounds, HasRefitBoundsCheck);
+
+/**
+ * 'value' is true if the TreeType class has a member void RefitBounds(), so
+ * that a tree built on the centroids can be moved with them.
+ */
+template<typename TreeType>
+struct CanRefitBounds
+{
+  static const bool value = HasRefitBoundsCheck<TreeType,
+      void(TreeType::*)()>::value;
+};
+
+//! Move the points of the given tree to the given centroids and refit its
+//! bounds.
+template<typename TreeType>
+void RefitTree(
+    TreeType& tree,
+    const arma::mat& centroids,
+    const std::vector<size_t>& oldFromNew,
+    const typename std::enable_if_t<CanRefitBounds<TreeType>::value>* = 0)
+{
+  typename TreeType::Mat& treeCentroids = tree.Dataset();
+  for (size_t i = 0; i < treeCentroids.n_cols; ++i)
+  {
+    const size_t c = tree::TreeTraits<TreeType>::RearrangesDataset ?
+        oldFromNew[i] : i;
+    treeCentroids.col(i) = centroids.col(c);
+  }
+
+  tree.RefitBounds();
+}
+
+//! This is never called, since the tree is always rebuilt when it cannot be
+//! refitted.
+template<typename TreeType>
+void RefitTree(
+    TreeType& /* tree */,
+    const arma::mat& /* centroids */,
+    const std::vector<size_t>& /* oldFromNew */,
+    const typename std::enable_if_t<!CanRefitBounds<TreeType>::value>* = 0)
+{ }
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -99,16 +144,12 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
     arma::mat& newCentroids,
     arma::Col<size_t>& counts)
 {
-  // Build a tree on the centroids.  This will make a copy if necessary, which
-  // is unfortunate, but I don't see a reasonable way around it.
-  std::vector<size_t> oldFromNewCentroids;
-  Tree* centroidTree = BuildTree<Tree>(centroids, oldFromNewCentroids);
-
-  // Find the nearest neighbors of each of the clusters.  We have to make our
-  // own TreeType, which is a little bit abuse, but we know for sure the
-  // TreeStatType we have will work.
-  neighbor::NeighborSearch<neighbor::NearestNeighborSort, MetricType, MatType,
-      NNSTreeType> nns(std::move(*centroidTree));
+  // Build a tree on the centroids, or move the tree of the last iteration to
+  // them.
+  Timer::Start("centroid_tree");
+  UpdateCentroidTree(centroids);
+  Timer::Stop("centroid_tree");
+  CentroidSearchType& nns = *centroidSearch;
 
   // Reset information in the tree, if we need to.
   if (iteration > 0)
@@ -199,13 +240,56 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
   }
   distanceCalculations += centroids.n_cols;
 
-  delete centroidTree;
-
   ++iteration;
 
   return std::sqrt(residual);
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DualTreeKMeans<MetricType, MatType, TreeType>::UpdateCentroidTree(
+    const arma::mat& centroids)
+{
+  // In late iterations the centroids barely move, so the tree of the last
+  // iteration only needs its bounds refitted; its structure is only worth
+  // rebuilding once the centroids have moved far from where it was built.
+  bool rebuild = !centroidSearch || !CanRefitBounds<Tree>::value ||
+      treeCentroids.n_cols != centroids.n_cols;
+  if (!rebuild)
+  {
+    double movement = 0.0;
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      movement = std::max(movement, metric.Evaluate(centroids.col(c),
+          treeCentroids.col(c)));
+    }
+    distanceCalculations += centroids.n_cols;
+
+    rebuild = (movement > RebuildMovement *
+        centroidSearch->ReferenceTree().FurthestDescendantDistance());
+  }
+
+  if (rebuild)
+  {
+    // This will make a copy if necessary, which is unfortunate, but I don't
+    // see a reasonable way around it.  We have to make our own TreeType for
+    // the nearest neighbor search, which is a little bit abuse, but we know
+    // for sure the TreeStatType we have will work.
+    oldFromNewCentroids.clear();
+    Tree* centroidTree = BuildTree<Tree>(centroids, oldFromNewCentroids);
+    centroidSearch.reset(new CentroidSearchType(std::move(*centroidTree)));
+    delete centroidTree;
+    treeCentroids = centroids;
+  }
+  else
+  {
+    RefitTree(centroidSearch->ReferenceTree(), centroids, oldFromNewCentroids);
+  }
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
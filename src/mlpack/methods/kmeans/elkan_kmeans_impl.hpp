@@ -2,7 +2,8 @@
  * @file elkan_kmeans_impl.hpp
  * @author Ryan Curtin
  *
- * An implementation of Elkan's algorithm for exact Lloyd iterations.
+ * An implementation of Elkan's algorithm for exact Lloyd iterations, using
+ * OpenMP to divide the points between threads.
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -46,9 +47,6 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // being the closest cluster centroid.
   clusterDistances.diag().fill(DBL_MAX);
 
-  // Initially set r(x) to true.
-  std::vector<bool> mustRecalculate(dataset.n_cols, true);
-
   // If this is the first iteration, we must reset all the bounds.
   if (lowerBounds.n_rows != centroids.n_cols)
   {
@@ -62,14 +60,18 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   }
 
   // Step 1: for all centers, compute between-cluster distances.  For all
-  // centers, compute s(c) = 1/2 min d(c, c').
-  for (size_t i = 0; i < centroids.n_cols; ++i)
+  // centers, compute s(c) = 1/2 min d(c, c').  Each thread fills different
+  // elements of the matrix; the rows get shorter, so they are handed out
+  // dynamically.
+  size_t calculations = 0;
+  #pragma omp parallel for schedule(dynamic) reduction(+:calculations)
+  for (omp_size_t i = 0; i < (omp_size_t) centroids.n_cols; ++i)
   {
     for (size_t j = i + 1; j < centroids.n_cols; ++j)
     {
       const double distance = metric.Evaluate(centroids.col(i),
                                               centroids.col(j));
-      distanceCalculations++;
+      calculations++;
       clusterDistances(i, j) = distance;
       clusterDistances(j, i) = distance;
     }
@@ -79,19 +81,36 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // that this is equivalent to s(c) for each cluster c.
   minClusterDistances = 0.5 * arma::min(clusterDistances).t();
 
-  // Now loop over all points, and see which ones need to be updated.
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  // Now loop over all points, and see which ones need to be updated.  The
+  // bounds of each point are only used by that point, so the points are
+  // divided between threads; the points of each chunk are summed into its own
+  // centroids (see ReductionPartials), which are combined at the end, as in
+  // NaiveKMeans.  How many distances are computed for a point depends on how
+  // well its bounds prune, so the chunks are handed out dynamically.
+  typedef std::pair<arma::mat, arma::Col<size_t>> SumsType;
+  ReductionPartials<SumsType> partials(dataset.n_cols, SumsType(newCentroids,
+      counts));
+
+  #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads()) \
+      reduction(+:calculations)
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
   {
-    // Step 2: identify all points such that u(x) <= s(c(x)).
-    if (upperBounds(i) <= minClusterDistances(assignments[i]))
-    {
-      // No change needed.  This point must still belong to that cluster.
-      counts(assignments[i])++;
-      newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-      continue;
-    }
-    else
+    arma::mat& localCentroids = partials.Partial(chunk).first;
+    arma::Col<size_t>& localCounts = partials.Partial(chunk).second;
+
+    for (size_t i = partials.Begin(chunk); i < partials.End(chunk); ++i)
     {
+      // Step 2: identify all points such that u(x) <= s(c(x)).
+      if (upperBounds(i) <= minClusterDistances(assignments[i]))
+      {
+        // No change needed.  This point must still belong to that cluster.
+        localCounts(assignments[i])++;
+        localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+        continue;
+      }
+
+      // Initially set r(x) to true.
+      bool mustRecalculate = true;
       for (size_t c = 0; c < centroids.n_cols; ++c)
       {
         // Step 3: for all remaining points x and centers c such that c != c(x),
@@ -108,13 +127,13 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
         // Step 3a: if r(x) then compute d(x, c(x)) and assign r(x) = false.
         // Otherwise, d(x, c(x)) = u(x).
         double dist;
-        if (mustRecalculate[i])
+        if (mustRecalculate)
         {
-          mustRecalculate[i] = false;
+          mustRecalculate = false;
           dist = metric.Evaluate(dataset.col(i), centroids.col(assignments[i]));
           lowerBounds(assignments[i], i) = dist;
           upperBounds(i) = dist;
-          distanceCalculations++;
+          calculations++;
 
           // Check if we can prune again.
           if (upperBounds(i) <= lowerBounds(c, i))
@@ -136,7 +155,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           const double pointDist = metric.Evaluate(dataset.col(i),
                                                    centroids.col(c));
           lowerBounds(c, i) = pointDist;
-          distanceCalculations++;
+          calculations++;
           if (pointDist < dist)
           {
             upperBounds(i) = pointDist;
@@ -144,15 +163,27 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           }
         }
       }
-    }
 
-    // At this point, we know the new cluster assignment.
-    // Step 4: for each center c, let m(c) be the mean of the points assigned to
-    // c.
-    newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-    counts[assignments[i]]++;
+      // At this point, we know the new cluster assignment.
+      // Step 4: for each center c, let m(c) be the mean of the points assigned
+      // to c.
+      localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+      localCounts[assignments[i]]++;
+    }
   }
 
+  // Combine the centroids of each chunk (or thread).
+  SumsType sums;
+  partials.Reduce(sums, [](SumsType& a, const SumsType& b)
+  {
+    a.first += b.first;
+    a.second += b.second;
+  });
+  newCentroids = std::move(sums.first);
+  counts = std::move(sums.second);
+
+  distanceCalculations += calculations;
+
   // Now, normalize and calculate the distance each cluster has moved.
   arma::vec moveDistances(centroids.n_cols);
   double cNorm = 0.0; // Cluster movement for residual.
@@ -166,7 +197,8 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     distanceCalculations++;
   }
 
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
   {
     // Step 5: for each point x and center c, assign
     //   l(x, c) = max { l(x, c) - d(c, m(c)), 0 }.
@@ -2,7 +2,8 @@
  * @file hamerly_kmeans_impl.hpp
  * @author Ryan Curtin
  *
- * An implementation of Greg Hamerly's algorithm for k-means clustering.
+ * An implementation of Greg Hamerly's algorithm for k-means clustering, using
+ * OpenMP to divide the points between threads.
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -49,83 +50,127 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
 
-  // Calculate minimum intra-cluster distance for each cluster.
+  // Calculate minimum intra-cluster distance for each cluster.  Each thread
+  // keeps its own minimums, because both clusters of a pair are updated.
   minClusterDistances.fill(DBL_MAX);
-  for (size_t i = 0; i < centroids.n_cols; ++i)
+  size_t calculations = 0;
+  #pragma omp parallel reduction(+:calculations)
   {
-    for (size_t j = i + 1; j < centroids.n_cols; ++j)
+    arma::vec localMinClusterDistances(centroids.n_cols);
+    localMinClusterDistances.fill(DBL_MAX);
+
+    // The rows get shorter, so they are handed out dynamically.
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) centroids.n_cols; ++i)
     {
-      const double dist = metric.Evaluate(centroids.col(i), centroids.col(j)) /
-          2.0;
-      ++distanceCalculations;
-
-      // Update bounds, if this intra-cluster distance is smaller.
-      if (dist < minClusterDistances(i))
-        minClusterDistances(i) = dist;
-      if (dist < minClusterDistances(j))
-        minClusterDistances(j) = dist;
+      for (size_t j = i + 1; j < centroids.n_cols; ++j)
+      {
+        const double dist = metric.Evaluate(centroids.col(i),
+            centroids.col(j)) / 2.0;
+        ++calculations;
+
+        // Update bounds, if this intra-cluster distance is smaller.
+        if (dist < localMinClusterDistances(i))
+          localMinClusterDistances(i) = dist;
+        if (dist < localMinClusterDistances(j))
+          localMinClusterDistances(j) = dist;
+      }
     }
+
+    #pragma omp critical
+    minClusterDistances = arma::min(minClusterDistances,
+        localMinClusterDistances);
   }
 
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  // The bounds of each point are only used by that point, so the points are
+  // divided between threads; the points of each chunk are summed into its own
+  // centroids (see ReductionPartials), which are combined at the end, as in
+  // NaiveKMeans.  Pruned points are much cheaper than the others, so the
+  // chunks are handed out dynamically.
+  typedef std::pair<arma::mat, arma::Col<size_t>> SumsType;
+  ReductionPartials<SumsType> partials(dataset.n_cols, SumsType(newCentroids,
+      counts));
+
+  #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads()) \
+      reduction(+:calculations, hamerlyPruned)
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
   {
-    const double m = std::max(minClusterDistances(assignments[i]),
-                              lowerBounds(i));
-
-    // First bound test.
-    if (upperBounds(i) <= m)
-    {
-      ++hamerlyPruned;
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
+    arma::mat& localCentroids = partials.Partial(chunk).first;
+    arma::Col<size_t>& localCounts = partials.Partial(chunk).second;
 
-    // Tighten upper bound.
-    upperBounds(i) = metric.Evaluate(dataset.col(i),
-                                     centroids.col(assignments[i]));
-    ++distanceCalculations;
-
-    // Second bound test.
-    if (upperBounds(i) <= m)
+    for (size_t i = partials.Begin(chunk); i < partials.End(chunk); ++i)
     {
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
+      const double m = std::max(minClusterDistances(assignments[i]),
+                                lowerBounds(i));
 
-    // The bounds failed.  So test against all other clusters.
-    // This is Hamerly's Point-All-Ctrs() function from the paper.
-    // We have to reset the lower bound first.
-    lowerBounds(i) = DBL_MAX;
-    for (size_t c = 0; c < centroids.n_cols; ++c)
-    {
-      if (c == assignments[i])
+      // First bound test.
+      if (upperBounds(i) <= m)
+      {
+        ++hamerlyPruned;
+        localCentroids.col(assignments[i]) += dataset.col(i);
+        ++localCounts(assignments[i]);
         continue;
+      }
 
-      const double dist = metric.Evaluate(dataset.col(i), centroids.col(c));
+      // Tighten upper bound.
+      upperBounds(i) = metric.Evaluate(dataset.col(i),
+                                       centroids.col(assignments[i]));
+      ++calculations;
 
-      // Is this a better cluster?  At this point, upperBounds[i] = d(i, c(i)).
-      if (dist < upperBounds(i))
+      // Second bound test.
+      if (upperBounds(i) <= m)
       {
-        // lowerBounds holds the second closest cluster.
-        lowerBounds(i) = upperBounds(i);
-        upperBounds(i) = dist;
-        assignments[i] = c;
+        localCentroids.col(assignments[i]) += dataset.col(i);
+        ++localCounts(assignments[i]);
+        continue;
       }
-      else if (dist < lowerBounds(i))
+
+      // The bounds failed.  So test against all other clusters.
+      // This is Hamerly's Point-All-Ctrs() function from the paper.
+      // We have to reset the lower bound first.
+      lowerBounds(i) = DBL_MAX;
+      for (size_t c = 0; c < centroids.n_cols; ++c)
       {
-        // This is a closer second-closest cluster.
-        lowerBounds(i) = dist;
+        if (c == assignments[i])
+          continue;
+
+        const double dist = metric.Evaluate(dataset.col(i), centroids.col(c));
+
+        // Is this a better cluster?  At this point, upperBounds[i] =
+        // d(i, c(i)).
+        if (dist < upperBounds(i))
+        {
+          // lowerBounds holds the second closest cluster.
+          lowerBounds(i) = upperBounds(i);
+          upperBounds(i) = dist;
+          assignments[i] = c;
+        }
+        else if (dist < lowerBounds(i))
+        {
+          // This is a closer second-closest cluster.
+          lowerBounds(i) = dist;
+        }
       }
-    }
-    distanceCalculations += centroids.n_cols - 1;
+      calculations += centroids.n_cols - 1;
 
-    // Update new centroids.
-    newCentroids.col(assignments[i]) += dataset.col(i);
-    ++counts(assignments[i]);
+      // Update new centroids.
+      localCentroids.col(assignments[i]) += dataset.col(i);
+      ++localCounts(assignments[i]);
+    }
   }
 
+  // Combine the centroids of each chunk (or thread).
+  SumsType sums;
+  partials.Reduce(sums, [](SumsType& a, const SumsType& b)
+  {
+    a.first += b.first;
+    a.second += b.second;
+  });
+  newCentroids = std::move(sums.first);
+  counts = std::move(sums.second);
+
+  distanceCalculations += calculations;
+
   // Normalize centroids and calculate cluster movement (contains parts of
   // Move-Centers() and Update-Bounds()).
   double furthestMovement = 0.0;
@@ -158,7 +203,8 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   }
 
   // Now update bounds (lines 3-8 of Update-Bounds()).
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
   {
     upperBounds(i) += centroidMovements(assignments[i]);
     if (assignments[i] == furthestMovingCluster)
@@ -60,7 +60,9 @@ namespace kmeans /** K-Means clustering. */ {
  *     data, const size_t emptyCluster, const arma::mat& oldCentroids,
  *     arma::mat& newCentroids, arma::Col<size_t>& counts, MetricType& metric,
  *     const size_t iteration)'.
- * @tparam LloydStepType Implementation of single Lloyd step to use.
+ * @tparam LloydStepType Implementation of single Lloyd step to use.  If it has
+ *     a 'size_t& BatchSize()' member (as MiniBatchKMeans does), it is given
+ *     the batch size of the KMeans object.
  *
  * @see RandomPartition, SampleInitialization, RefinedStart, AllowEmptyClusters,
  *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans
@@ -160,6 +162,13 @@ class KMeans
   //! Set the maximum number of iterations.
   size_t& MaxIterations() { return maxIterations; }
 
+  //! Get the number of points in each batch, for Lloyd step types that use
+  //! batches of points (like MiniBatchKMeans).
+  size_t BatchSize() const { return batchSize; }
+  //! Set the number of points in each batch, for Lloyd step types that use
+  //! batches of points (like MiniBatchKMeans).
+  size_t& BatchSize() { return batchSize; }
+
   //! Get the distance metric.
   const MetricType& Metric() const { return metric; }
   //! Modify the distance metric.
@@ -183,6 +192,8 @@ class KMeans
  private:
   //! Maximum number of iterations before giving up.
   size_t maxIterations;
+  //! Number of points in each batch, for step types that use batches.
+  size_t batchSize;
   //! Instantiated distance metric.
   MetricType metric;
   //! Instantiated initial partitioning policy.
@@ -194,6 +205,28 @@ class KMeans
 } // namespace kmeans
 } // namespace mlpack
 
+namespace boost {
+namespace serialization {
+
+//! Set the serialization version of the KMeans class.  Version 1 also stores
+//! the batch size.  (BOOST_TEMPLATE_CLASS_VERSION() cannot be used, because the
+//! template signature contains commas.)
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+struct version<mlpack::data::SecondShim<mlpack::kmeans::KMeans<MetricType,
+    InitialPartitionPolicy, EmptyClusterPolicy, LloydStepType, MatType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "kmeans_impl.hpp"
 
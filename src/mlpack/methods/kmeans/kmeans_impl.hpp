@@ -78,6 +78,40 @@ bool GetInitialAssignmentsOrCentroids(
   return false;
 }
 
+/**
+ * This gives us a UsesBatches object that we can use to tell whether or not a
+ * LloydStepType needs to be given the batch size.
+ */
+HAS_MEM_FUNC(BatchSize, UsesBatchesCheck);
+
+/**
+ * 'value' is true if the LloydStepType class has a member size_t& BatchSize().
+ */
+template<typename LloydStepType>
+struct UsesBatches
+{
+  static const bool value = UsesBatchesCheck<LloydStepType,
+      size_t&(LloydStepType::*)()>::value;
+};
+
+//! Give the batch size to the Lloyd step, if it uses batches.
+template<typename LloydStepType>
+void SetBatchSize(
+    LloydStepType& lloydStep,
+    const size_t batchSize,
+    const typename std::enable_if_t<UsesBatches<LloydStepType>::value>* = 0)
+{
+  lloydStep.BatchSize() = batchSize;
+}
+
+//! Do nothing, because the Lloyd step does not use batches.
+template<typename LloydStepType>
+void SetBatchSize(
+    LloydStepType& /* lloydStep */,
+    const size_t /* batchSize */,
+    const typename std::enable_if_t<!UsesBatches<LloydStepType>::value>* = 0)
+{ }
+
 /**
  * Construct the K-Means object.
  */
@@ -97,6 +131,7 @@ KMeans(const size_t maxIterations,
        const InitialPartitionPolicy partitioner,
        const EmptyClusterPolicy emptyClusterAction) :
     maxIterations(maxIterations),
+    batchSize(1000),
     metric(metric),
     partitioner(partitioner),
     emptyClusterAction(emptyClusterAction)
@@ -208,6 +243,7 @@ Cluster(const MatType& data,
   size_t iteration = 0;
 
   LloydStepType<MetricType, MatType> lloydStep(data, metric);
+  SetBatchSize(lloydStep, batchSize);
   arma::mat centroidsOther;
   double cNorm;
 
@@ -261,6 +297,7 @@ Cluster(const MatType& data,
   }
   Log::Info << lloydStep.DistanceCalculations() << " distance calculations."
       << std::endl;
+  Timer::Count("distance_calculations", lloydStep.DistanceCalculations());
 }
 
 /**
@@ -347,9 +384,16 @@ void KMeans<MetricType,
             InitialPartitionPolicy,
             EmptyClusterPolicy,
             LloydStepType,
-            MatType>::Serialize(Archive& ar, const unsigned int /* version */)
+            MatType>::Serialize(Archive& ar, const unsigned int version)
 {
   ar & data::CreateNVP(maxIterations, "max_iterations");
+
+  // Older versions did not store the batch size.
+  if (version >= 1)
+    ar & data::CreateNVP(batchSize, "batch_size");
+  else if (Archive::is_loading::value)
+    batchSize = 1000;
+
   ar & data::CreateNVP(metric, "metric");
   ar & data::CreateNVP(partitioner, "partitioner");
   ar & data::CreateNVP(emptyClusterAction, "emptyClusterAction");
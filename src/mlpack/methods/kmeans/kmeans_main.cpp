@@ -12,15 +12,20 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/core/data/curve_order.hpp>
 
 #include "kmeans.hpp"
 #include "allow_empty_clusters.hpp"
 #include "kill_empty_clusters.hpp"
 #include "refined_start.hpp"
+#include "kmeans_parallel_initialization.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
+#include "yinyang_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
+#include "sparse_kmeans.hpp"
 
 using namespace mlpack;
 using namespace mlpack::kmeans;
@@ -42,14 +47,40 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     "used in each sample, the " + PRINT_PARAM_STRING("percentage") +
     " parameter is used (it should be a value between 0.0 and 1.0)."
     "\n\n"
+    "Alternately, the k-means|| approach (Bahmani et al., \"Scalable "
+    "k-means++\", 2012) can be used to select initial points by specifying the "
+    + PRINT_PARAM_STRING("kmeans_parallel") + " parameter.  This approach "
+    "runs a few sampling rounds over the dataset, given by the " +
+    PRINT_PARAM_STRING("rounds") + " parameter; in each round, on average " +
+    PRINT_PARAM_STRING("oversampling") + " times the number of clusters "
+    "candidate points are chosen."
+    "\n\n"
     "There are several options available for the algorithm used for each Lloyd "
     "iteration, specified with the " + PRINT_PARAM_STRING("algorithm") + " "
     " option.  The standard O(kN) approach can be used ('naive').  Other "
     "options include the Pelleg-Moore tree-based algorithm ('pelleg-moore'), "
     "Elkan's triangle-inequality based algorithm ('elkan'), Hamerly's "
-    "modification to Elkan's algorithm ('hamerly'), the dual-tree k-means "
-    "algorithm ('dualtree'), and the dual-tree k-means algorithm using the "
-    "cover tree ('dualtree-covertree')."
+    "modification to Elkan's algorithm ('hamerly'), Yinyang k-means, which "
+    "keeps bounds for groups of centroids and needs much less memory than "
+    "Elkan's algorithm for many clusters ('yinyang'), the dual-tree k-means "
+    "algorithm ('dualtree'), the dual-tree k-means algorithm using the "
+    "cover tree ('dualtree-covertree'), mini-batch k-means ('minibatch'), and "
+    "an algorithm for sparse data ('sparse')."
+    "\n\n"
+    "Mini-batch k-means (Sculley, \"Web-scale k-means clustering\", 2010) uses "
+    "only a random batch of points in each iteration; the number of points in "
+    "each batch is given by the " + PRINT_PARAM_STRING("batch_size") + " "
+    "parameter.  This can be much faster than the other algorithms for large "
+    "datasets, but the centroids are only approximate.  Because each iteration "
+    "is very cheap, " + PRINT_PARAM_STRING("max_iterations") + " should "
+    "usually be increased."
+    "\n\n"
+    "The 'sparse' algorithm is meant for data where most elements are zero, "
+    "such as TF-IDF vectors of documents.  The dataset is converted to a "
+    "sparse matrix, and the distances to the centroids are computed from the "
+    "dot products of the nonzero elements of each point with the centroids, "
+    "so each iteration takes time proportional to the number of nonzero "
+    "elements times the number of clusters."
     "\n\n"
     "The behavior for when an empty cluster is encountered can be modified with"
     " the " + PRINT_PARAM_STRING("allow_empty_clusters") + " option.  When "
@@ -69,6 +100,12 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     "number of iterations may be specified with the " +
     PRINT_PARAM_STRING("max_iterations") + " parameter."
     "\n\n"
+    "The " + PRINT_PARAM_STRING("curve_order") + " parameter reorders the "
+    "points along a space-filling curve ('z-order' or 'hilbert') before "
+    "clustering, so that points that are close to each other are also close in "
+    "memory; this can make the iterations faster for large datasets.  The "
+    "output is given in the original order of the points."
+    "\n\n"
     "As an example, to use Hamerly's algorithm to perform k-means clustering "
     "with k=10 on the dataset " + PRINT_DATASET("data") + ", saving the "
     "centroids to " + PRINT_DATASET("centroids") + " and the assignments for "
@@ -119,9 +156,22 @@ PARAM_INT_IN("samplings", "Number of samplings to perform for refined start "
 PARAM_DOUBLE_IN("percentage", "Percentage of dataset to use for each refined "
     "start sampling (use when --refined_start is specified).", "p", 0.02);
 
+// Parameters for k-means|| initialization.
+PARAM_FLAG("kmeans_parallel", "Use the k-means|| initial point strategy by "
+    "Bahmani et al. to choose initial points.", "K");
+PARAM_INT_IN("rounds", "Number of sampling rounds for k-means|| (use when "
+    "--kmeans_parallel is specified).", "R", 5);
+PARAM_DOUBLE_IN("oversampling", "Oversampling factor for k-means|| (use when "
+    "--kmeans_parallel is specified).", "O", 2.0);
+
 PARAM_STRING_IN("algorithm", "Algorithm to use for the Lloyd iteration "
-    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', or "
-    "'dualtree-covertree').", "a", "naive");
+    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', 'dualtree', "
+    "'dualtree-covertree', 'minibatch', or 'sparse').", "a", "naive");
+PARAM_INT_IN("batch_size", "Number of points in each batch for mini-batch "
+    "k-means (use when --algorithm minibatch is specified).", "b", 1000);
+PARAM_STRING_IN("curve_order", "If specified, the space-filling curve to "
+    "reorder the points along before clustering ('z-order' or 'hilbert').", "",
+    "");
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -136,9 +186,17 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp);
 // Given the template parameters, sanitize/load input and run k-means.
 template<typename InitialPartitionPolicy,
          typename EmptyClusterPolicy,
-         template<class, class> class LloydStepType>
+         template<class, class> class LloydStepType,
+         typename MatType = arma::mat>
 void RunKMeans(const InitialPartitionPolicy& ipp);
 
+// Get the dataset as the type of matrix that k-means is run on; a dense
+// dataset is used as it is, and a sparse one is converted into the given
+// matrix.
+const arma::mat& ClusteringData(const arma::mat& dataset, arma::mat& converted);
+const arma::sp_mat& ClusteringData(const arma::mat& dataset,
+                                   arma::sp_mat& converted);
+
 void mlpackMain()
 {
   // Initialize random seed.
@@ -150,6 +208,10 @@ void mlpackMain()
   // Now, start building the KMeans type that we'll be using.  Start with the
   // initial partition policy.  The call to FindEmptyClusterPolicy<> results in
   // a call to RunKMeans<> and the algorithm is completed.
+  if (CLI::HasParam("refined_start") && CLI::HasParam("kmeans_parallel"))
+    Log::Fatal << "Only one of --refined_start (-r) or --kmeans_parallel (-K) "
+        << "may be specified!" << endl;
+
   if (CLI::HasParam("refined_start"))
   {
     const int samplings = CLI::GetParam<int>("samplings");
@@ -164,6 +226,21 @@ void mlpackMain()
 
     FindEmptyClusterPolicy<RefinedStart>(RefinedStart(samplings, percentage));
   }
+  else if (CLI::HasParam("kmeans_parallel"))
+  {
+    const int rounds = CLI::GetParam<int>("rounds");
+    const double oversampling = CLI::GetParam<double>("oversampling");
+
+    if (rounds < 0)
+      Log::Fatal << "Number of rounds (" << rounds << ") must be greater than "
+          << "or equal to 0!" << endl;
+    if (oversampling <= 0.0)
+      Log::Fatal << "Oversampling factor (" << oversampling << ") must be "
+          << "greater than 0.0!" << endl;
+
+    FindEmptyClusterPolicy<KMeansParallelInitialization>(
+        KMeansParallelInitialization(rounds, oversampling));
+  }
   else
   {
     FindEmptyClusterPolicy<SampleInitialization>(SampleInitialization());
@@ -197,6 +274,8 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, ElkanKMeans>(ipp);
   else if (algorithm == "hamerly")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, HamerlyKMeans>(ipp);
+  else if (algorithm == "yinyang")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, YinyangKMeans>(ipp);
   else if (algorithm == "pelleg-moore")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
         PellegMooreKMeans>(ipp);
@@ -206,18 +285,39 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
   else if (algorithm == "dualtree-covertree")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
         CoverTreeDualTreeKMeans>(ipp);
+  else if (algorithm == "minibatch")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
+        MiniBatchKMeans>(ipp);
+  else if (algorithm == "sparse")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, SparseKMeans,
+        arma::sp_mat>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
   else
     Log::Fatal << "Unknown algorithm: '" << algorithm << "'.  Supported options"
-        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', and "
-        << "'dualtree-covertree'." << endl;
+        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', "
+        << "'dualtree', 'dualtree-covertree', 'minibatch', and 'sparse'."
+        << endl;
+}
+
+const arma::mat& ClusteringData(const arma::mat& dataset,
+                                arma::mat& /* converted */)
+{
+  return dataset;
+}
+
+const arma::sp_mat& ClusteringData(const arma::mat& dataset,
+                                   arma::sp_mat& converted)
+{
+  converted = arma::sp_mat(dataset);
+  return converted;
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
 template<typename InitialPartitionPolicy,
          typename EmptyClusterPolicy,
-         template<class, class> class LloydStepType>
+         template<class, class> class LloydStepType,
+         typename MatType>
 void RunKMeans(const InitialPartitionPolicy& ipp)
 {
   // Now, do validation of input options.
@@ -245,6 +345,19 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
         ")! Must be greater than or equal to 0." << endl;
   }
 
+  const int batchSize = CLI::GetParam<int>("batch_size");
+  if (batchSize <= 0)
+  {
+    Log::Fatal << "Invalid batch size (" << batchSize << ")! Must be greater "
+        << "than 0." << endl;
+  }
+  else if (CLI::HasParam("batch_size") &&
+      CLI::GetParam<string>("algorithm") != "minibatch")
+  {
+    Log::Warn << "--batch_size is ignored because --algorithm is not "
+        << "'minibatch'." << endl;
+  }
+
   // Make sure we have an output file if we're not doing the work in-place.
   if (!CLI::HasParam("in_place") && !CLI::HasParam("output") &&
       !CLI::HasParam("centroid"))
@@ -253,10 +366,28 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
         << "no results will be saved." << std::endl;
   }
 
+  const string curveOrder = CLI::GetParam<string>("curve_order");
+  if (!curveOrder.empty() && curveOrder != "z-order" &&
+      curveOrder != "hilbert")
+  {
+    Log::Fatal << "Invalid curve order '" << curveOrder << "'; must be "
+        << "'z-order' or 'hilbert'." << endl;
+  }
+
   // Load our dataset.
   arma::mat dataset = CLI::GetParam<arma::mat>("input");
   arma::mat centroids;
 
+  // Reorder the points along a space-filling curve, if requested.
+  std::vector<size_t> oldFromNew;
+  if (!curveOrder.empty())
+  {
+    Timer::Start("curve_ordering");
+    data::ReorderByCurve(dataset, oldFromNew, (curveOrder == "z-order") ?
+        data::Z_ORDER_CURVE : data::HILBERT_CURVE);
+    Timer::Stop("curve_ordering");
+  }
+
   const bool initialCentroidGuess = CLI::HasParam("initial_centroids");
   // Load initial centroids if the user asked for it.
   if (initialCentroidGuess)
@@ -268,24 +399,41 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
     if (CLI::HasParam("refined_start"))
       Log::Warn << "Initial centroids are specified, but will be ignored "
           << "because --refined_start is also specified!" << endl;
+    else if (CLI::HasParam("kmeans_parallel"))
+      Log::Warn << "Initial centroids are specified, but will be ignored "
+          << "because --kmeans_parallel is also specified!" << endl;
     else
       Log::Info << "Using initial centroid guesses." << endl;
   }
 
+  // A sparse copy of the dataset is only made for the 'sparse' algorithm.
+  MatType converted;
+  const MatType& data = ClusteringData(dataset, converted);
+
   Timer::Start("clustering");
   KMeans<metric::EuclideanDistance,
          InitialPartitionPolicy,
          EmptyClusterPolicy,
-         LloydStepType> kmeans(maxIterations, metric::EuclideanDistance(), ipp);
+         LloydStepType,
+         MatType> kmeans(maxIterations, metric::EuclideanDistance(), ipp);
+  kmeans.BatchSize() = (size_t) batchSize;
 
   if (CLI::HasParam("output") || CLI::HasParam("in_place"))
   {
     // We need to get the assignments.
     arma::Row<size_t> assignments;
-    kmeans.Cluster(dataset, clusters, assignments, centroids,
+    kmeans.Cluster(data, clusters, assignments, centroids,
         false, initialCentroidGuess);
     Timer::Stop("clustering");
 
+    // Put the points back in their original order.
+    if (!curveOrder.empty())
+    {
+      data::UnmapColumns(assignments, oldFromNew);
+      if (CLI::HasParam("in_place") || !CLI::HasParam("labels_only"))
+        data::UnmapColumns(dataset, oldFromNew);
+    }
+
     // Now figure out what to do with our results.
     if (CLI::HasParam("in_place"))
     {
@@ -329,7 +477,7 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
   else
   {
     // Just save the centroids.
-    kmeans.Cluster(dataset, clusters, centroids, initialCentroidGuess);
+    kmeans.Cluster(data, clusters, centroids, initialCentroidGuess);
     Timer::Stop("clustering");
   }
 
@@ -0,0 +1,166 @@
+/**
+ * @file kmeans_parallel_initialization.hpp
+ *
+ * An implementation of the k-means|| ("scalable k-means++") initialization of
+ * Bahmani et al.  It chooses initial centroids that are nearly as good as those
+ * chosen by k-means++, but needs only a few passes over the data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means|| approach for choosing initial centroids for k-means clustering.
+ * k-means++ chooses the k centroids one after another, each with probability
+ * proportional to its squared distance to the centroids chosen so far, so it
+ * needs k passes over the data.  k-means|| instead runs a small number of
+ * rounds; in each round, every point is chosen as a candidate independently
+ * with probability proportional to its squared distance to the candidates so
+ * far, such that on average (oversampling * k) candidates are chosen.  Each
+ * candidate is then weighted by the number of points closest to it, and the
+ * weighted candidates are reduced to k centroids with k-means++.
+ *
+ * The distance computations of each round are divided among threads with
+ * OpenMP.  All random numbers are drawn by the calling thread, so for a given
+ * random seed the result does not depend on the number of threads.
+ *
+ * For more information, see the following paper:
+ *
+ * @article{bahmani2012scalable,
+ *   title={Scalable k-means++},
+ *   author={Bahmani, Bahman and Moseley, Benjamin and Vattani, Andrea and
+ *       Kumar, Ravi and Vassilvitskii, Sergei},
+ *   journal={Proceedings of the VLDB Endowment},
+ *   volume={5},
+ *   number={7},
+ *   pages={622--633},
+ *   year={2012}
+ * }
+ */
+class KMeansParallelInitialization
+{
+ public:
+  /**
+   * Create the KMeansParallelInitialization object, optionally specifying the
+   * number of sampling rounds and the oversampling factor.  In each round, on
+   * average (oversampling * clusters) candidates are chosen.
+   *
+   * @param rounds Number of sampling rounds.
+   * @param oversampling Oversampling factor.
+   */
+  KMeansParallelInitialization(const size_t rounds = 5,
+                               const double oversampling = 2.0) :
+      rounds(rounds), oversampling(oversampling) { }
+
+  /**
+   * Choose the given number of initial centroids for the given dataset with
+   * the k-means|| algorithm.  Each centroid is a point of the dataset.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to partition.
+   * @param clusters Number of clusters to split dataset into.
+   * @param centroids Matrix to store centroids into.
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::mat& centroids);
+
+  /**
+   * Choose the given number of initial centroids for a dataset that is split
+   * into the given shards (of points of the same dimensionality), without
+   * putting the shards together.  In each round, the candidates are sampled
+   * from each shard in turn, and the weights of the candidates are the sums of
+   * the counts of each shard.  With a single shard, the centroids are the same
+   * as those of Cluster() for the same random seed.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param shards Shards of the dataset to partition.
+   * @param clusters Number of clusters to split dataset into.
+   * @param centroids Matrix to store centroids into.
+   */
+  template<typename MatType>
+  void ClusterShards(const std::vector<MatType>& shards,
+                     const size_t clusters,
+                     arma::mat& centroids) const;
+
+  //! Get the number of sampling rounds.
+  size_t Rounds() const { return rounds; }
+  //! Modify the number of sampling rounds.
+  size_t& Rounds() { return rounds; }
+
+  //! Get the oversampling factor.
+  double Oversampling() const { return oversampling; }
+  //! Modify the oversampling factor.
+  double& Oversampling() { return oversampling; }
+
+  //! Serialize the object.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(rounds, "rounds");
+    ar & data::CreateNVP(oversampling, "oversampling");
+  }
+
+ private:
+  //! The number of sampling rounds.
+  size_t rounds;
+  //! The oversampling factor.
+  double oversampling;
+
+  //! Choose the centroids of the dataset split into the given shards.
+  template<typename MatType>
+  void ChooseCentroids(const std::vector<const MatType*>& shards,
+                       const size_t clusters,
+                       arma::mat& centroids) const;
+
+  //! Return the point of the given index in the shards, taken in order.
+  template<typename MatType>
+  static arma::vec Point(const std::vector<const MatType*>& shards,
+                         size_t index);
+
+  /**
+   * Update the squared distance of each point to its closest candidate, and
+   * the closest candidate itself, with the candidates of index firstNew and
+   * above.
+   */
+  template<typename MatType>
+  static void UpdateDistances(const MatType& data,
+                              const arma::mat& candidates,
+                              const size_t firstNew,
+                              arma::vec& minDistances,
+                              arma::Row<size_t>& closest);
+
+  /**
+   * Choose the given number of centroids from the weighted candidates with
+   * k-means++.  Returns the number of centroids that could be chosen; this is
+   * less than clusters only if there are fewer distinct candidates.
+   */
+  static size_t Recluster(const arma::mat& candidates,
+                          const arma::vec& weights,
+                          const size_t clusters,
+                          arma::mat& centroids);
+
+  /**
+   * Return an index chosen with probability proportional to the given weights,
+   * which must not all be zero.
+   */
+  static size_t WeightedSample(const arma::vec& weights);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "kmeans_parallel_initialization_impl.hpp"
+
+#endif
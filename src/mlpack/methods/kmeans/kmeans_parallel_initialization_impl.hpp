@@ -0,0 +1,248 @@
+/**
+ * @file kmeans_parallel_initialization_impl.hpp
+ *
+ * Implementation of the k-means|| initialization of Bahmani et al.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel_initialization.hpp"
+
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansParallelInitialization::Cluster(const MatType& data,
+                                           const size_t clusters,
+                                           arma::mat& centroids)
+{
+  ChooseCentroids(std::vector<const MatType*>(1, &data), clusters, centroids);
+}
+
+template<typename MatType>
+void KMeansParallelInitialization::ClusterShards(
+    const std::vector<MatType>& shards,
+    const size_t clusters,
+    arma::mat& centroids) const
+{
+  std::vector<const MatType*> shardPointers(shards.size());
+  for (size_t s = 0; s < shards.size(); ++s)
+    shardPointers[s] = &shards[s];
+
+  ChooseCentroids(shardPointers, clusters, centroids);
+}
+
+template<typename MatType>
+void KMeansParallelInitialization::ChooseCentroids(
+    const std::vector<const MatType*>& shards,
+    const size_t clusters,
+    arma::mat& centroids) const
+{
+  size_t numPoints = 0;
+  size_t dimensionality = 0;
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    if (shards[s]->n_cols == 0)
+      continue;
+
+    if (numPoints > 0 && shards[s]->n_rows != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "KMeansParallelInitialization::ClusterShards(): shard " << s
+          << " has dimensionality " << shards[s]->n_rows << ", but the "
+          << "shards before it have dimensionality " << dimensionality;
+      throw std::invalid_argument(oss.str());
+    }
+
+    numPoints += shards[s]->n_cols;
+    dimensionality = shards[s]->n_rows;
+  }
+
+  if (numPoints == 0)
+    throw std::invalid_argument("KMeansParallelInitialization::Cluster(): "
+        "dataset is empty!");
+
+  // The first candidate is a point chosen uniformly at random.
+  arma::mat candidates(dimensionality, 1);
+  candidates.col(0) = Point(shards, math::RandInt(numPoints));
+
+  std::vector<arma::vec> minDistances(shards.size());
+  std::vector<arma::Row<size_t>> closest(shards.size());
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    minDistances[s].set_size(shards[s]->n_cols);
+    minDistances[s].fill(std::numeric_limits<double>::max());
+    closest[s].zeros(shards[s]->n_cols);
+  }
+
+  const double expectedSamples = oversampling * clusters;
+  size_t firstNew = 0;
+  for (size_t round = 0; round <= rounds; ++round)
+  {
+    // Take the candidates chosen in the last round into account.
+    for (size_t s = 0; s < shards.size(); ++s)
+    {
+      UpdateDistances(*shards[s], candidates, firstNew, minDistances[s],
+          closest[s]);
+    }
+    if (round == rounds)
+      break;
+
+    // If the cost is zero, every point is already a candidate.
+    double cost = 0.0;
+    for (size_t s = 0; s < shards.size(); ++s)
+      cost += arma::accu(minDistances[s]);
+    if (cost == 0.0)
+      break;
+
+    // Choose each point with probability proportional to its squared distance
+    // to the closest candidate.  The random numbers are drawn here, and not by
+    // the threads, so that the result does not depend on the number of threads.
+    std::vector<std::pair<size_t, size_t>> sampled;
+    for (size_t s = 0; s < shards.size(); ++s)
+    {
+      const arma::vec random = arma::randu<arma::vec>(shards[s]->n_cols);
+      for (size_t i = 0; i < shards[s]->n_cols; ++i)
+        if (random[i] < expectedSamples * minDistances[s][i] / cost)
+          sampled.push_back(std::make_pair(s, i));
+    }
+
+    firstNew = candidates.n_cols;
+    candidates.resize(dimensionality, firstNew + sampled.size());
+    for (size_t i = 0; i < sampled.size(); ++i)
+    {
+      candidates.col(firstNew + i) =
+          arma::vec(shards[sampled[i].first]->col(sampled[i].second));
+    }
+  }
+
+  // The weight of each candidate is the number of points closest to it.
+  arma::vec weights(candidates.n_cols, arma::fill::zeros);
+  for (size_t s = 0; s < shards.size(); ++s)
+    for (size_t i = 0; i < closest[s].n_elem; ++i)
+      ++weights[closest[s][i]];
+
+  Log::Info << "k-means|| chose " << candidates.n_cols << " candidates for "
+      << clusters << " clusters." << std::endl;
+
+  const size_t chosen = Recluster(candidates, weights, clusters, centroids);
+
+  // If there were not enough distinct candidates, the dataset has fewer
+  // distinct points than clusters; fill the rest with random points.
+  for (size_t i = chosen; i < clusters; ++i)
+    centroids.col(i) = Point(shards, math::RandInt(numPoints));
+}
+
+template<typename MatType>
+arma::vec KMeansParallelInitialization::Point(
+    const std::vector<const MatType*>& shards,
+    size_t index)
+{
+  size_t s = 0;
+  while (index >= shards[s]->n_cols)
+    index -= shards[s++]->n_cols;
+
+  return arma::vec(shards[s]->col(index));
+}
+
+template<typename MatType>
+void KMeansParallelInitialization::UpdateDistances(
+    const MatType& data,
+    const arma::mat& candidates,
+    const size_t firstNew,
+    arma::vec& minDistances,
+    arma::Row<size_t>& closest)
+{
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    for (size_t j = firstNew; j < candidates.n_cols; ++j)
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          data.col(i), candidates.unsafe_col(j));
+      if (distance < minDistances[i])
+      {
+        minDistances[i] = distance;
+        closest[i] = j;
+      }
+    }
+  }
+}
+
+inline size_t KMeansParallelInitialization::Recluster(
+    const arma::mat& candidates,
+    const arma::vec& weights,
+    const size_t clusters,
+    arma::mat& centroids)
+{
+  centroids.set_size(candidates.n_rows, clusters);
+  if (clusters == 0)
+    return 0;
+
+  // Weighted k-means++: the first centroid is chosen with probability
+  // proportional to the weights, and each next one with probability
+  // proportional to the weight times the squared distance to the closest
+  // centroid chosen so far.
+  arma::vec minDistances(candidates.n_cols);
+  minDistances.fill(std::numeric_limits<double>::max());
+  size_t next = WeightedSample(weights);
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    centroids.col(c) = candidates.col(next);
+    if (c + 1 == clusters)
+      break;
+
+    #pragma omp parallel for
+    for (omp_size_t j = 0; j < (omp_size_t) candidates.n_cols; ++j)
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          candidates.unsafe_col(j), centroids.unsafe_col(c));
+      if (distance < minDistances[j])
+        minDistances[j] = distance;
+    }
+
+    const arma::vec probabilities = weights % minDistances;
+    if (arma::accu(probabilities) == 0.0)
+      return c + 1;
+
+    next = WeightedSample(probabilities);
+  }
+
+  return clusters;
+}
+
+inline size_t KMeansParallelInitialization::WeightedSample(
+    const arma::vec& weights)
+{
+  const double total = arma::accu(weights);
+  const double target = math::Random() * total;
+
+  double sum = 0.0;
+  size_t last = 0;
+  for (size_t i = 0; i < weights.n_elem; ++i)
+  {
+    if (weights[i] == 0.0)
+      continue;
+
+    sum += weights[i];
+    last = i;
+    if (target < sum)
+      return i;
+  }
+
+  // Rounding may leave the target just past the end.
+  return last;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of a step of mini-batch k-means (Sculley, 2010).  Each
+ * iteration only looks at a small random sample of the dataset, so this is
+ * useful for very large datasets.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * An implementation of a single iteration of mini-batch k-means, as described
+ * in the following paper:
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, D.},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * Instead of the whole dataset, each iteration draws a batch of points
+ * uniformly at random (with replacement) and assigns each of them to its
+ * closest centroid.  Then each centroid is moved towards each of its points
+ * with a per-centroid learning rate of 1 / (number of points the centroid has
+ * been assigned so far).  So each centroid is the mean of all the points it
+ * has been assigned in any iteration, and stops moving as it sees more points.
+ * The assignment of the points of a batch is done in parallel with OpenMP.
+ *
+ * If your intention is to run the full k-means algorithm, you are looking for
+ * the mlpack::kmeans::KMeans class instead of this one; use MiniBatchKMeans as
+ * its LloydStepType.  KMeans sets the batch size with BatchSize().  Because
+ * each iteration only uses one batch, the maximum number of iterations given
+ * to KMeans should be chosen with the batch size in mind.
+ *
+ * The counts returned by Iterate() are the numbers of points each cluster has
+ * been assigned in all iterations so far, so a cluster is only empty if it has
+ * never been assigned a point.
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points to use in each iteration.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1000);
+
+  /**
+   * Run a single iteration of mini-batch k-means, updating the given centroids
+   * into the newCentroids matrix.  Centroids that are not assigned any point of
+   * the batch do not move.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points assigned to each cluster in all iterations
+   *     so far.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  //! Get the number of distance calculations.
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of points used in each iteration.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points used in each iteration.
+  size_t& BatchSize() { return batchSize; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The number of points used in each iteration.
+  size_t batchSize;
+
+  //! The number of points each cluster has been assigned so far; the learning
+  //! rate of each cluster is the inverse of this.
+  arma::Col<size_t> clusterCounts;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of a step of mini-batch k-means.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("MiniBatchKMeans::Iterate(): the batch size "
+        "must be positive!");
+  }
+
+  // On the first iteration (or if the number of clusters has changed), no
+  // cluster has been assigned any points yet.
+  if (clusterCounts.n_elem != centroids.n_cols)
+    clusterCounts.zeros(centroids.n_cols);
+
+  // Draw the batch first, so the result does not depend on the number of
+  // threads.
+  arma::Col<size_t> batch(batchSize);
+  for (size_t i = 0; i < batchSize; ++i)
+    batch[i] = math::RandInt(dataset.n_cols);
+
+  // The sums and counts of the points of the batch assigned to each cluster,
+  // as partial results of the chunks of the batch (see ReductionPartials).
+  typedef std::pair<arma::mat, arma::Col<size_t>> SumsType;
+  ReductionPartials<SumsType> partials(batchSize, SumsType(
+      arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros),
+      arma::Col<size_t>(centroids.n_cols, arma::fill::zeros)));
+
+  // Find the closest centroid to each point of the batch, in parallel.
+  #pragma omp parallel for schedule(static) num_threads(partials.Threads())
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
+  {
+    arma::mat& localSums = partials.Partial(chunk).first;
+    arma::Col<size_t>& localCounts = partials.Partial(chunk).second;
+
+    for (size_t i = partials.Begin(chunk); i < partials.End(chunk); ++i)
+    {
+      const size_t point = batch[i];
+      double minDistance = std::numeric_limits<double>::infinity();
+      size_t closestCluster = centroids.n_cols; // Invalid value.
+
+      for (size_t j = 0; j < centroids.n_cols; j++)
+      {
+        const double distance = metric.Evaluate(dataset.col(point),
+            centroids.unsafe_col(j));
+        if (distance < minDistance)
+        {
+          minDistance = distance;
+          closestCluster = j;
+        }
+      }
+
+      Log::Assert(closestCluster != centroids.n_cols);
+
+      localSums.unsafe_col(closestCluster) += dataset.col(point);
+      localCounts(closestCluster)++;
+    }
+  }
+
+  // Combine the results of each chunk (or thread).
+  SumsType sums;
+  partials.Reduce(sums, [](SumsType& a, const SumsType& b)
+  {
+    a.first += b.first;
+    a.second += b.second;
+  });
+  const arma::mat& batchSums = sums.first;
+  const arma::Col<size_t>& batchCounts = sums.second;
+
+  distanceCalculations += centroids.n_cols * batchSize;
+
+  // Moving a centroid c towards each of its m new points x in turn, with the
+  // learning rate 1 / (number of points seen), gives
+  //   c + (sum(x) - m c) / (clusterCounts + m),
+  // so the updates of the batch can be applied all at once.
+  newCentroids = centroids;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    if (batchCounts[i] == 0)
+      continue;
+
+    clusterCounts[i] += batchCounts[i];
+    newCentroids.col(i) += (batchSums.col(i) - double(batchCounts[i]) *
+        centroids.col(i)) / double(clusterCounts[i]);
+  }
+
+  counts = clusterCounts;
+
+  // Calculate how much the centroids moved in this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,7 @@
 #ifndef MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 #define MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 
 namespace mlpack {
 namespace kmeans {
@@ -54,9 +55,72 @@ class NaiveKMeans
                  arma::mat& newCentroids,
                  arma::Col<size_t>& counts);
 
+  /**
+   * Find the closest centroid of each point, and compute the sum of the points
+   * closest to each centroid and their number, as Iterate() does before it
+   * divides the sums by the counts.  The sums and counts of datasets that are
+   * parts of a larger dataset (like the shards of ShardedKMeans) can simply
+   * be added up.
+   *
+   * @param centroids Current cluster centroids.
+   * @param sums Sum of the points of each cluster.
+   * @param counts Number of points in each cluster.
+   */
+  void Accumulate(const arma::mat& centroids,
+                  arma::mat& sums,
+                  arma::Col<size_t>& counts);
+
   size_t DistanceCalculations() const { return distanceCalculations; }
 
  private:
+  //! Number of points whose closest centroids are found together.
+  static const size_t TileSize = 256;
+
+  //! Whether the closest centroids may be found with matrix products.
+  static const bool BlockedAssignment =
+      (std::is_same<MetricType, metric::EuclideanDistance>::value ||
+       std::is_same<MetricType, metric::SquaredEuclideanDistance>::value) &&
+      std::is_same<MatType, arma::mat>::value;
+
+  /**
+   * Find the closest centroid to each of the points from begin to end - 1,
+   * with the same results as evaluating the distance to each centroid.  For
+   * dense, high-dimensional data, the squared distances to all centroids are
+   * first estimated with a single matrix product (using
+   * ||a||^2 + ||b||^2 - 2 a^T b), and only the centroids that may be the
+   * closest are evaluated exactly.
+   *
+   * @param centroids Current cluster centroids.
+   * @param centroidNorms Squared norms of the centroids.
+   * @param begin Index of the first point.
+   * @param end Index after the last point.
+   * @param closest Set to the index of the closest centroid of each point.
+   */
+  template<bool Blocked = BlockedAssignment>
+  void FindClosest(const arma::mat& centroids,
+                   const arma::rowvec& centroidNorms,
+                   const size_t begin,
+                   const size_t end,
+                   size_t* closest,
+                   const std::enable_if_t<Blocked>* = 0);
+
+  //! Find the closest centroid to each of the points from begin to end - 1,
+  //! evaluating the distance to each centroid.
+  template<bool Blocked = BlockedAssignment>
+  void FindClosest(const arma::mat& centroids,
+                   const arma::rowvec& centroidNorms,
+                   const size_t begin,
+                   const size_t end,
+                   size_t* closest,
+                   const std::enable_if_t<!Blocked>* = 0);
+
+  //! Find the closest centroid to each of the points from begin to end - 1,
+  //! evaluating the distance to each centroid.
+  void FindClosestPairwise(const arma::mat& centroids,
+                           const size_t begin,
+                           const size_t end,
+                           size_t* closest);
+
   //! The dataset.
   const MatType& dataset;
   //! The instantiated metric.
@@ -36,67 +36,185 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
                                                  arma::mat& newCentroids,
                                                  arma::Col<size_t>& counts)
 {
-  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  Accumulate(centroids, newCentroids, counts);
+
+  // Now normalize the centroid.
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    if (counts(i) != 0)
+      newCentroids.col(i) /= counts(i);
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+void NaiveKMeans<MetricType, MatType>::Accumulate(const arma::mat& centroids,
+                                                  arma::mat& sums,
+                                                  arma::Col<size_t>& counts)
+{
+  sums.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
 
-  // Find the closest centroid to each point and update the new centroids.
-  // Computed in parallel over the complete dataset
-  #pragma omp parallel
+  // The squared norms of the centroids are only needed for matrix products.
+  arma::rowvec centroidNorms;
+  if (BlockedAssignment)
+    centroidNorms = arma::sum(arma::square(centroids), 0);
+
+  // Find the closest centroid to each point and update the sums.
+  // Computed in parallel over the complete dataset; the sums of the points are
+  // partial results (see ReductionPartials), which are combined at the end.
+  typedef std::pair<arma::mat, arma::Col<size_t>> SumsType;
+  ReductionPartials<SumsType> partials(dataset.n_cols, SumsType(sums,
+      counts));
+
+  #pragma omp parallel for schedule(static) num_threads(partials.Threads())
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
   {
-    // The current state of the K-means is private for each thread
-    arma::mat localCentroids(centroids.n_rows, centroids.n_cols,
-        arma::fill::zeros);
-    arma::Col<size_t> localCounts(centroids.n_cols, arma::fill::zeros);
+    arma::mat& localCentroids = partials.Partial(chunk).first;
+    arma::Col<size_t>& localCounts = partials.Partial(chunk).second;
 
-    #pragma omp for
-    for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
+    // The closest centroids are found for a tile of points at a time.
+    size_t closest[TileSize];
+    for (size_t begin = partials.Begin(chunk); begin < partials.End(chunk);
+        begin += TileSize)
     {
-      // Find the closest centroid to this point.
-      double minDistance = std::numeric_limits<double>::infinity();
-      size_t closestCluster = centroids.n_cols; // Invalid value.
+      const size_t end = std::min(begin + (size_t) TileSize,
+          partials.End(chunk));
+      FindClosest(centroids, centroidNorms, begin, end, closest);
 
-      for (size_t j = 0; j < centroids.n_cols; j++)
+      // Update the closest centroid of each point.
+      for (size_t i = begin; i < end; ++i)
       {
-        const double distance = metric.Evaluate(dataset.col(i),
-            centroids.unsafe_col(j));
-        if (distance < minDistance)
-        {
-          minDistance = distance;
-          closestCluster = j;
-        }
+        localCentroids.unsafe_col(closest[i - begin]) += dataset.col(i);
+        localCounts(closest[i - begin])++;
       }
+    }
+  }
+
+  // Combine the sums of each chunk (or thread).
+  SumsType total;
+  partials.Reduce(total, [](SumsType& a, const SumsType& b)
+  {
+    a.first += b.first;
+    a.second += b.second;
+  });
+  sums = std::move(total.first);
+  counts = std::move(total.second);
+
+  distanceCalculations += centroids.n_cols * dataset.n_cols;
+}
+
+template<typename MetricType, typename MatType>
+template<bool Blocked>
+void NaiveKMeans<MetricType, MatType>::FindClosest(
+    const arma::mat& centroids,
+    const arma::rowvec& centroidNorms,
+    const size_t begin,
+    const size_t end,
+    size_t* closest,
+    const std::enable_if_t<Blocked>*)
+{
+  // In low dimensions, the matrix product does not pay off.
+  if (dataset.n_rows < 16 || centroids.n_cols < 2)
+  {
+    FindClosestPairwise(centroids, begin, end, closest);
+    return;
+  }
 
-      Log::Assert(closestCluster != centroids.n_cols);
+  // The points are contiguous, so alias them.
+  const arma::mat points(const_cast<double*>(dataset.colptr(begin)),
+      dataset.n_rows, end - begin, false, true);
+  const arma::rowvec pointNorms = arma::sum(arma::square(points), 0);
+  const arma::mat products = centroids.t() * points;
 
-      // We now have the minimum distance centroid index.  Update that centroid.
-      localCentroids.unsafe_col(closestCluster) += dataset.col(i);
-      localCounts(closestCluster)++;
+  // The estimate of a squared distance can be off by roughly the machine
+  // epsilon times the dimensionality times the squared norms.  Only the
+  // centroids whose estimate is within twice that of the best upper bound are
+  // evaluated exactly, in order, so the closest centroid (and the choice
+  // between ties) is the same as when all distances are evaluated.
+  const double relativeError = (dataset.n_rows + 4) *
+      std::numeric_limits<double>::epsilon();
+  for (size_t j = 0; j < points.n_cols; ++j)
+  {
+    double bound = std::numeric_limits<double>::infinity();
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      const double normSum = pointNorms[j] + centroidNorms[c];
+      const double estimate = normSum - 2.0 * products(c, j);
+      bound = std::min(bound, estimate + 2.0 * relativeError * normSum);
     }
-    // Combine calculated state from each thread
-    #pragma omp critical
+
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+    for (size_t c = 0; c < centroids.n_cols; ++c)
     {
-      newCentroids += localCentroids;
-      counts += localCounts;
+      const double normSum = pointNorms[j] + centroidNorms[c];
+      const double estimate = normSum - 2.0 * products(c, j);
+      if (estimate - 2.0 * relativeError * normSum > bound)
+        continue;
+
+      const double distance = metric.Evaluate(points.col(j),
+          centroids.unsafe_col(c));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = c;
+      }
     }
-  }
 
-  // Now normalize the centroid.
-  for (size_t i = 0; i < centroids.n_cols; ++i)
-    if (counts(i) != 0)
-      newCentroids.col(i) /= counts(i);
+    Log::Assert(closestCluster != centroids.n_cols);
+    closest[j] = closestCluster;
+  }
+}
 
-  distanceCalculations += centroids.n_cols * dataset.n_cols;
+template<typename MetricType, typename MatType>
+template<bool Blocked>
+void NaiveKMeans<MetricType, MatType>::FindClosest(
+    const arma::mat& centroids,
+    const arma::rowvec& /* centroidNorms */,
+    const size_t begin,
+    const size_t end,
+    size_t* closest,
+    const std::enable_if_t<!Blocked>*)
+{
+  FindClosestPairwise(centroids, begin, end, closest);
+}
 
-  // Calculate cluster distortion for this iteration.
-  double cNorm = 0.0;
-  for (size_t i = 0; i < centroids.n_cols; ++i)
+template<typename MetricType, typename MatType>
+void NaiveKMeans<MetricType, MatType>::FindClosestPairwise(
+    const arma::mat& centroids,
+    const size_t begin,
+    const size_t end,
+    size_t* closest)
+{
+  for (size_t i = begin; i < end; ++i)
   {
-    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
-        2.0);
-  }
-  distanceCalculations += centroids.n_cols;
+    // Find the closest centroid to this point.
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
 
-  return std::sqrt(cNorm);
+    for (size_t j = 0; j < centroids.n_cols; j++)
+    {
+      const double distance = metric.Evaluate(dataset.col(i),
+          centroids.unsafe_col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    closest[i - begin] = closestCluster;
+  }
 }
 
 } // namespace kmeans
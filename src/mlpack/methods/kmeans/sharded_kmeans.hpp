@@ -0,0 +1,198 @@
+/**
+ * @file sharded_kmeans.hpp
+ *
+ * Definition of the ShardedKMeans class, which runs Lloyd iterations on a
+ * dataset that is split into shards, combining the partial sums of the shards
+ * in each iteration.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SHARDED_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_SHARDED_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include "allow_empty_clusters.hpp"
+#include "kill_empty_clusters.hpp"
+#include "kmeans_parallel_initialization.hpp"
+#include "max_variance_new_cluster.hpp"
+#include "naive_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The ShardedKMeans class performs k-means clustering on a dataset that is
+ * split into shards (for instance, because each shard is loaded from its own
+ * file), without putting the shards together.  Each Lloyd iteration computes
+ * the sum of the points closest to each centroid and their number for each
+ * shard with NaiveKMeans::Accumulate(), and adds them up, which gives the same
+ * centroids as one iteration over the whole dataset.
+ *
+ * The initial centroids are chosen with k-means|| over all shards (see
+ * KMeansParallelInitialization::ClusterShards()), unless they are given.
+ * Empty clusters are handled by the given policy, which must be one of
+ * AllowEmptyClusters, KillEmptyClusters and MaxVarianceNewCluster; the
+ * variances and the furthest points of MaxVarianceNewCluster are computed over
+ * all shards, so the result is the same as that of KMeans with the same
+ * policy.
+ *
+ * @code
+ * std::vector<arma::mat> shards(files.size());
+ * for (size_t i = 0; i < files.size(); ++i)
+ *   data::Load(files[i], shards[i]);
+ *
+ * ShardedKMeans<> k;
+ * arma::mat centroids;
+ * k.Cluster(shards, 10, centroids);
+ * @endcode
+ *
+ * @tparam MetricType The distance metric to use for this KMeans; see
+ *     metric::LMetric for an example.
+ * @tparam EmptyClusterPolicy Policy for what to do on an empty cluster.
+ * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename EmptyClusterPolicy = MaxVarianceNewCluster,
+         typename MatType = arma::mat>
+class ShardedKMeans
+{
+ public:
+  /**
+   * Create a ShardedKMeans object.
+   *
+   * @param maxIterations Maximum number of iterations allowed before giving up
+   *     (0 is valid, but the algorithm may never terminate).
+   * @param metric Optional MetricType object.
+   * @param initializer Optional k-means|| object to choose the initial
+   *     centroids with.
+   * @param emptyClusterAction Optional EmptyClusterPolicy object.
+   */
+  ShardedKMeans(const size_t maxIterations = 1000,
+                const MetricType metric = MetricType(),
+                const KMeansParallelInitialization initializer =
+                    KMeansParallelInitialization(),
+                const EmptyClusterPolicy emptyClusterAction =
+                    EmptyClusterPolicy());
+
+  /**
+   * Perform k-means clustering on the dataset split into the given shards,
+   * returning the centroids of each cluster (each column is a centroid).  A
+   * std::invalid_argument is thrown if the shards do not have the same
+   * dimensionality, if the number of clusters is zero or greater than the
+   * number of points, or if the initial guess has the wrong size.
+   *
+   * @param shards Shards of the dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param centroids Matrix in which centroids are stored.
+   * @param initialGuess If true, then it is assumed that centroids contains
+   *     the initial cluster centroids.
+   */
+  void Cluster(const std::vector<MatType>& shards,
+               const size_t clusters,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  /**
+   * Perform k-means clustering on the dataset split into the given shards,
+   * returning the centroids of each cluster and the cluster of each point of
+   * each shard.
+   *
+   * @param shards Shards of the dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param assignments Set to the cluster of each point of each shard.
+   * @param centroids Matrix in which centroids are stored.
+   * @param initialGuess If true, then it is assumed that centroids contains
+   *     the initial cluster centroids.
+   */
+  void Cluster(const std::vector<MatType>& shards,
+               const size_t clusters,
+               std::vector<arma::Row<size_t>>& assignments,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Set the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the distance metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the distance metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get the k-means|| initializer.
+  const KMeansParallelInitialization& Initializer() const
+  { return initializer; }
+  //! Modify the k-means|| initializer.
+  KMeansParallelInitialization& Initializer() { return initializer; }
+
+  //! Get the empty cluster policy.
+  const EmptyClusterPolicy& EmptyClusterAction() const
+  { return emptyClusterAction; }
+  //! Modify the empty cluster policy.
+  EmptyClusterPolicy& EmptyClusterAction() { return emptyClusterAction; }
+
+ private:
+  //! Handle the empty clusters with a policy that does not use the data.
+  template<typename PolicyType>
+  void EmptyClusters(PolicyType& policy,
+                     const std::vector<MatType>& shards,
+                     const arma::mat& oldCentroids,
+                     arma::mat& newCentroids,
+                     arma::Col<size_t>& counts,
+                     const size_t iteration,
+                     const std::enable_if_t<
+                         std::is_same<PolicyType, AllowEmptyClusters>::value ||
+                         std::is_same<PolicyType, KillEmptyClusters>::value>* =
+                         0);
+
+  /**
+   * Handle the empty clusters as MaxVarianceNewCluster does: each empty
+   * cluster takes the point (of any shard) that is furthest from the centroid
+   * of the cluster with the greatest variance.
+   */
+  void EmptyClusters(MaxVarianceNewCluster& policy,
+                     const std::vector<MatType>& shards,
+                     const arma::mat& oldCentroids,
+                     arma::mat& newCentroids,
+                     arma::Col<size_t>& counts,
+                     const size_t iteration);
+
+  /**
+   * Compute the closest of the given centroids for each point of each shard,
+   * and the variance of each cluster (0 for clusters of at most one point).
+   */
+  void Variances(const std::vector<MatType>& shards,
+                 const arma::mat& centroids,
+                 const arma::Col<size_t>& counts,
+                 std::vector<arma::Row<size_t>>& assignments,
+                 arma::vec& variances);
+
+  //! Set the closest centroid of each point of the given shard.
+  void Assign(const MatType& shard,
+              const arma::mat& centroids,
+              arma::Row<size_t>& assignments,
+              arma::vec& distances);
+
+  //! Maximum number of iterations before giving up.
+  size_t maxIterations;
+  //! Instantiated distance metric.
+  MetricType metric;
+  //! The k-means|| initializer.
+  KMeansParallelInitialization initializer;
+  //! Instantiated empty cluster policy.
+  EmptyClusterPolicy emptyClusterAction;
+}; // class ShardedKMeans
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "sharded_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,346 @@
+/**
+ * @file sharded_kmeans_impl.hpp
+ *
+ * Implementation of the ShardedKMeans class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SHARDED_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_SHARDED_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sharded_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename EmptyClusterPolicy, typename MatType>
+ShardedKMeans<MetricType, EmptyClusterPolicy, MatType>::ShardedKMeans(
+    const size_t maxIterations,
+    const MetricType metric,
+    const KMeansParallelInitialization initializer,
+    const EmptyClusterPolicy emptyClusterAction) :
+    maxIterations(maxIterations),
+    metric(metric),
+    initializer(initializer),
+    emptyClusterAction(emptyClusterAction)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename EmptyClusterPolicy, typename MatType>
+void ShardedKMeans<MetricType, EmptyClusterPolicy, MatType>::Cluster(
+    const std::vector<MatType>& shards,
+    const size_t clusters,
+    arma::mat& centroids,
+    const bool initialGuess)
+{
+  size_t numPoints = 0;
+  size_t dimensionality = 0;
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    if (shards[s].n_cols == 0)
+      continue;
+
+    if (numPoints > 0 && shards[s].n_rows != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "ShardedKMeans::Cluster(): shard " << s << " has dimensionality "
+          << shards[s].n_rows << ", but the shards before it have "
+          << "dimensionality " << dimensionality;
+      throw std::invalid_argument(oss.str());
+    }
+
+    numPoints += shards[s].n_cols;
+    dimensionality = shards[s].n_rows;
+  }
+
+  if (clusters == 0 || clusters > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "ShardedKMeans::Cluster(): cannot split " << numPoints << " points "
+        << "into " << clusters << " clusters";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (initialGuess)
+  {
+    if (centroids.n_cols != clusters || centroids.n_rows != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "ShardedKMeans::Cluster(): the initial centroids are "
+          << centroids.n_rows << "x" << centroids.n_cols << ", but they must "
+          << "be " << dimensionality << "x" << clusters;
+      throw std::invalid_argument(oss.str());
+    }
+  }
+  else
+  {
+    initializer.ClusterShards(shards, clusters, centroids);
+  }
+
+  // One Lloyd step per shard; their sums and counts are added up.
+  std::vector<NaiveKMeans<MetricType, MatType>> steps;
+  steps.reserve(shards.size());
+  for (size_t s = 0; s < shards.size(); ++s)
+    steps.push_back(NaiveKMeans<MetricType, MatType>(shards[s], metric));
+
+  arma::mat newCentroids;
+  arma::mat shardSums;
+  arma::Col<size_t> counts, shardCounts;
+  size_t iteration = 0;
+  size_t distanceCalculations = 0;
+  double cNorm;
+  do
+  {
+    newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    counts.zeros(centroids.n_cols);
+    for (size_t s = 0; s < shards.size(); ++s)
+    {
+      if (shards[s].n_cols == 0)
+        continue;
+
+      steps[s].Accumulate(centroids, shardSums, shardCounts);
+      newCentroids += shardSums;
+      counts += shardCounts;
+    }
+
+    for (size_t i = 0; i < centroids.n_cols; ++i)
+      if (counts(i) != 0)
+        newCentroids.col(i) /= counts(i);
+
+    // The residual is computed before the empty clusters are handled, as
+    // KMeans does.
+    cNorm = 0.0;
+    for (size_t i = 0; i < centroids.n_cols; ++i)
+    {
+      cNorm += std::pow(metric.Evaluate(centroids.col(i),
+          newCentroids.col(i)), 2.0);
+    }
+    cNorm = std::sqrt(cNorm);
+    distanceCalculations += centroids.n_cols;
+
+    if (arma::any(counts == 0))
+    {
+      EmptyClusters(emptyClusterAction, shards, centroids, newCentroids,
+          counts, iteration);
+    }
+
+    centroids.swap(newCentroids);
+
+    iteration++;
+    Log::Info << "ShardedKMeans::Cluster(): iteration " << iteration
+        << ", residual " << cNorm << ".\n";
+    if (std::isnan(cNorm) || std::isinf(cNorm))
+      cNorm = 1e-4; // Keep iterating.
+  } while (cNorm > 1e-5 && iteration != maxIterations);
+
+  if (iteration != maxIterations)
+  {
+    Log::Info << "ShardedKMeans::Cluster(): converged after " << iteration
+        << " iterations." << std::endl;
+  }
+  else
+  {
+    Log::Info << "ShardedKMeans::Cluster(): terminated after limit of "
+        << iteration << " iterations." << std::endl;
+  }
+
+  for (size_t s = 0; s < steps.size(); ++s)
+    distanceCalculations += steps[s].DistanceCalculations();
+  Log::Info << distanceCalculations << " distance calculations." << std::endl;
+  Timer::Count("distance_calculations", distanceCalculations);
+}
+
+template<typename MetricType, typename EmptyClusterPolicy, typename MatType>
+void ShardedKMeans<MetricType, EmptyClusterPolicy, MatType>::Cluster(
+    const std::vector<MatType>& shards,
+    const size_t clusters,
+    std::vector<arma::Row<size_t>>& assignments,
+    arma::mat& centroids,
+    const bool initialGuess)
+{
+  Cluster(shards, clusters, centroids, initialGuess);
+
+  assignments.resize(shards.size());
+  arma::vec distances;
+  for (size_t s = 0; s < shards.size(); ++s)
+    Assign(shards[s], centroids, assignments[s], distances);
+}
+
+template<typename MetricType, typename EmptyClusterPolicy, typename MatType>
+template<typename PolicyType>
+void ShardedKMeans<MetricType, EmptyClusterPolicy, MatType>::EmptyClusters(
+    PolicyType& policy,
+    const std::vector<MatType>& /* shards */,
+    const arma::mat& oldCentroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts,
+    const size_t iteration,
+    const std::enable_if_t<
+        std::is_same<PolicyType, AllowEmptyClusters>::value ||
+        std::is_same<PolicyType, KillEmptyClusters>::value>*)
+{
+  // These policies do not look at the data.
+  const MatType noData;
+  for (size_t i = 0; i < counts.n_elem; ++i)
+  {
+    if (counts(i) == 0)
+    {
+      Log::Info << "Cluster " << i << " is empty.\n";
+      policy.EmptyCluster(noData, i, oldCentroids, newCentroids, counts,
+          metric, iteration);
+    }
+  }
+}
+
+template<typename MetricType, typename EmptyClusterPolicy, typename MatType>
+void ShardedKMeans<MetricType, EmptyClusterPolicy, MatType>::EmptyClusters(
+    MaxVarianceNewCluster& /* policy */,
+    const std::vector<MatType>& shards,
+    const arma::mat& oldCentroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts,
+    const size_t /* iteration */)
+{
+  std::vector<arma::Row<size_t>> assignments;
+  arma::vec variances;
+  bool precalculated = false;
+  for (size_t emptyCluster = 0; emptyCluster < counts.n_elem; ++emptyCluster)
+  {
+    if (counts(emptyCluster) != 0)
+      continue;
+
+    Log::Info << "Cluster " << emptyCluster << " is empty.\n";
+    if (!precalculated)
+    {
+      Variances(shards, oldCentroids, counts, assignments, variances);
+      precalculated = true;
+    }
+
+    // If the cluster with maximum variance has variance of 0, then all its
+    // points are the same.
+    arma::uword maxVarCluster = 0;
+    variances.max(maxVarCluster);
+    if (variances[maxVarCluster] == 0.0)
+      continue;
+
+    // Find the point of that cluster which is furthest away, in any shard.
+    size_t furthestShard = shards.size();
+    size_t furthestPoint = 0;
+    double maxDistance = -DBL_MAX;
+    for (size_t s = 0; s < shards.size(); ++s)
+    {
+      for (size_t i = 0; i < shards[s].n_cols; ++i)
+      {
+        if (assignments[s][i] != maxVarCluster)
+          continue;
+
+        const double distance = std::pow(metric.Evaluate(shards[s].col(i),
+            newCentroids.col(maxVarCluster)), 2.0);
+        if (distance > maxDistance)
+        {
+          maxDistance = distance;
+          furthestShard = s;
+          furthestPoint = i;
+        }
+      }
+    }
+
+    // Take that point and add it to the empty cluster.
+    const arma::vec point(shards[furthestShard].col(furthestPoint));
+    newCentroids.col(maxVarCluster) *= (double(counts[maxVarCluster]) /
+        double(counts[maxVarCluster] - 1));
+    newCentroids.col(maxVarCluster) -= (1.0 / (counts[maxVarCluster] - 1.0)) *
+        point;
+    counts[maxVarCluster]--;
+    counts[emptyCluster]++;
+    newCentroids.col(emptyCluster) = point;
+    assignments[furthestShard][furthestPoint] = emptyCluster;
+
+    // Update the variances; if the cluster cannot give another point, they
+    // are computed again for the next empty cluster.
+    variances[emptyCluster] = 0;
+    if (counts[maxVarCluster] <= 1)
+    {
+      variances[maxVarCluster] = 0;
+      precalculated = false;
+    }
+    else
+    {
+      variances[maxVarCluster] = (1.0 / counts[maxVarCluster]) *
+          ((counts[maxVarCluster] + 1) * variances[maxVarCluster] -
+          maxDistance);
+    }
+
+    Log::Debug << "Point " << furthestPoint << " of shard " << furthestShard
+        << " assigned to empty cluster " << emptyCluster << ".\n";
+  }
+}
+
+template<typename MetricType, typename EmptyClusterPolicy, typename MatType>
+void ShardedKMeans<MetricType, EmptyClusterPolicy, MatType>::Variances(
+    const std::vector<MatType>& shards,
+    const arma::mat& centroids,
+    const arma::Col<size_t>& counts,
+    std::vector<arma::Row<size_t>>& assignments,
+    arma::vec& variances)
+{
+  variances.zeros(centroids.n_cols);
+  assignments.resize(shards.size());
+  arma::vec distances;
+  for (size_t s = 0; s < shards.size(); ++s)
+  {
+    Assign(shards[s], centroids, assignments[s], distances);
+    for (size_t i = 0; i < shards[s].n_cols; ++i)
+      variances[assignments[s][i]] += distances[i] * distances[i];
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+  {
+    if (counts[i] <= 1)
+      variances[i] = 0;
+    else
+      variances[i] /= counts[i];
+  }
+}
+
+template<typename MetricType, typename EmptyClusterPolicy, typename MatType>
+void ShardedKMeans<MetricType, EmptyClusterPolicy, MatType>::Assign(
+    const MatType& shard,
+    const arma::mat& centroids,
+    arma::Row<size_t>& assignments,
+    arma::vec& distances)
+{
+  assignments.set_size(shard.n_cols);
+  distances.set_size(shard.n_cols);
+
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) shard.n_cols; ++i)
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(shard.col(i),
+          centroids.col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+    distances[i] = minDistance;
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file sparse_kmeans.hpp
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering of
+ * sparse data, such as TF-IDF vectors, whose cost is proportional to the number
+ * of nonzero elements of the dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SPARSE_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_SPARSE_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * An implementation of a single iteration of Lloyd's algorithm for k-means of
+ * sparse data.  If your intention is to run the full k-means algorithm, you
+ * are looking for the mlpack::kmeans::KMeans class instead of this one; use
+ * SparseKMeans as its LloydStepType, with arma::sp_mat as its MatType.
+ *
+ * NaiveKMeans computes each distance from the difference of a point and a
+ * centroid, which is dense even when the point is sparse.  Instead, this step
+ * uses the expansion
+ *
+ *   || x - c ||^2 = || x ||^2 + || c ||^2 - 2 x^T c,
+ *
+ * where the squared norms of the (dense) centroids are computed once per
+ * iteration, and the dot products of each point with all the centroids are
+ * accumulated from its nonzero elements only.  (The squared norm of the point
+ * is the same for all the centroids, so it is not needed to find the closest
+ * one.)
+ * The centroids are transposed in each iteration, so that the centroid
+ * coordinates that one nonzero element is multiplied with are contiguous.  One
+ * iteration takes O(k nnz + k d) time instead of O(k N d).  The points are
+ * split between the OpenMP threads.
+ *
+ * Because of the cancellation in the expansion, the distances are a little
+ * less accurate than the distances NaiveKMeans computes, so points that are
+ * almost exactly as far from two centroids may be assigned differently.  Only
+ * the Euclidean distance (and the squared Euclidean distance) can be expanded
+ * this way, so MetricType must be metric::LMetric<2, true> or
+ * metric::LMetric<2, false>.  Dense datasets are supported too, but for them
+ * the expansion saves nothing.
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::sp_mat or arma::mat).
+ */
+template<typename MetricType, typename MatType>
+class SparseKMeans
+{
+  static_assert(std::is_same<MetricType, metric::LMetric<2, true>>::value ||
+      std::is_same<MetricType, metric::LMetric<2, false>>::value,
+      "SparseKMeans can only be used with the Euclidean distance.");
+
+ public:
+  /**
+   * Construct the SparseKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   */
+  SparseKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of the Lloyd algorithm, updating the given centroids
+   * into the newCentroids matrix.  If any cluster is empty (that is, if any
+   * cluster has no points assigned to it), then the centroid associated with
+   * that cluster may be filled with invalid data (it will be corrected later).
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points in each cluster at the end of the iteration.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  //! Get the number of distance calculations.
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+ private:
+  //! Set dots to the dot products of the given point of a sparse dataset with
+  //! the centroids, whose transpose is given.
+  static void Products(const arma::sp_mat& dataset,
+                       const size_t point,
+                       const arma::mat& centroidsT,
+                       arma::vec& dots);
+  //! Set dots to the dot products of the given point of a dense dataset with
+  //! the centroids, whose transpose is given.
+  static void Products(const arma::mat& dataset,
+                       const size_t point,
+                       const arma::mat& centroidsT,
+                       arma::vec& dots);
+
+  //! Add the given point of a sparse dataset to the given sum.
+  static void AddPoint(const arma::sp_mat& dataset,
+                       const size_t point,
+                       double* sum);
+  //! Add the given point of a dense dataset to the given sum.
+  static void AddPoint(const arma::mat& dataset,
+                       const size_t point,
+                       double* sum);
+
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_kmeans_impl.hpp"
+
+#endif
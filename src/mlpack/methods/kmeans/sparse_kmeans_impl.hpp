@@ -0,0 +1,158 @@
+/**
+ * @file sparse_kmeans_impl.hpp
+ *
+ * Implementation of a step of the Lloyd algorithm for k-means clustering of
+ * sparse data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SPARSE_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_SPARSE_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+SparseKMeans<MetricType, MatType>::SparseKMeans(const MatType& dataset,
+                                                MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double SparseKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                  arma::mat& newCentroids,
+                                                  arma::Col<size_t>& counts)
+{
+  const size_t k = centroids.n_cols;
+
+  // Each column of the transpose holds the coordinate of one dimension for all
+  // the centroids.
+  const arma::mat centroidsT = centroids.t();
+  const arma::rowvec centroidNorms = arma::sum(arma::square(centroids), 0);
+
+  // Find the closest centroid to each point and update the new centroids.  The
+  // sums of the points are partial results (see ReductionPartials), which are
+  // combined at the end.
+  typedef std::pair<arma::mat, arma::Col<size_t>> SumsType;
+  ReductionPartials<SumsType> partials(dataset.n_cols, SumsType(
+      arma::mat(centroids.n_rows, k, arma::fill::zeros),
+      arma::Col<size_t>(k, arma::fill::zeros)));
+
+  #pragma omp parallel for schedule(static) num_threads(partials.Threads())
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
+  {
+    arma::mat& localCentroids = partials.Partial(chunk).first;
+    arma::Col<size_t>& localCounts = partials.Partial(chunk).second;
+    arma::vec dots(k);
+
+    for (size_t i = partials.Begin(chunk); i < partials.End(chunk); ++i)
+    {
+      Products(dataset, i, centroidsT, dots);
+
+      // Find the closest centroid to this point.  The squared norm of the
+      // point is the same for all centroids, so it is left out.
+      double minDistance = std::numeric_limits<double>::infinity();
+      size_t closestCluster = k; // Invalid value.
+      for (size_t j = 0; j < k; ++j)
+      {
+        const double distance = centroidNorms[j] - 2.0 * dots[j];
+        if (distance < minDistance)
+        {
+          minDistance = distance;
+          closestCluster = j;
+        }
+      }
+
+      Log::Assert(closestCluster != k);
+
+      // We now have the minimum distance centroid index.  Update that centroid.
+      AddPoint(dataset, i, localCentroids.colptr(closestCluster));
+      localCounts[closestCluster]++;
+    }
+  }
+
+  // Combine the sums of each chunk (or thread).
+  SumsType sums;
+  partials.Reduce(sums, [](SumsType& a, const SumsType& b)
+  {
+    a.first += b.first;
+    a.second += b.second;
+  });
+  newCentroids = std::move(sums.first);
+  counts = std::move(sums.second);
+
+  // Now normalize the centroid.
+  for (size_t i = 0; i < k; ++i)
+    if (counts[i] != 0)
+      newCentroids.col(i) /= counts[i];
+
+  distanceCalculations += k * dataset.n_cols;
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < k; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += k;
+
+  return std::sqrt(cNorm);
+}
+
+template<typename MetricType, typename MatType>
+void SparseKMeans<MetricType, MatType>::Products(const arma::sp_mat& dataset,
+                                                 const size_t point,
+                                                 const arma::mat& centroidsT,
+                                                 arma::vec& dots)
+{
+  dots.zeros();
+  arma::sp_mat::const_iterator it = dataset.begin_col(point);
+  const arma::sp_mat::const_iterator end = dataset.end_col(point);
+  for ( ; it != end; ++it)
+    dots += (*it) * centroidsT.unsafe_col(it.row());
+}
+
+template<typename MetricType, typename MatType>
+void SparseKMeans<MetricType, MatType>::Products(const arma::mat& dataset,
+                                                 const size_t point,
+                                                 const arma::mat& centroidsT,
+                                                 arma::vec& dots)
+{
+  dots = centroidsT * dataset.unsafe_col(point);
+}
+
+template<typename MetricType, typename MatType>
+void SparseKMeans<MetricType, MatType>::AddPoint(const arma::sp_mat& dataset,
+                                                 const size_t point,
+                                                 double* sum)
+{
+  arma::sp_mat::const_iterator it = dataset.begin_col(point);
+  const arma::sp_mat::const_iterator end = dataset.end_col(point);
+  for ( ; it != end; ++it)
+    sum[it.row()] += (*it);
+}
+
+template<typename MetricType, typename MatType>
+void SparseKMeans<MetricType, MatType>::AddPoint(const arma::mat& dataset,
+                                                 const size_t point,
+                                                 double* sum)
+{
+  const double* x = dataset.colptr(point);
+  for (size_t d = 0; d < dataset.n_rows; ++d)
+    sum[d] += x[d];
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file yinyang_kmeans.hpp
+ *
+ * An implementation of Yinyang k-means, which prunes distance calculations
+ * with one lower bound per group of centroids instead of one per centroid.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * Yinyang k-means gives exactly the same Lloyd iterations as NaiveKMeans, but
+ * uses the triangle inequality to avoid most distance calculations.  Elkan's
+ * algorithm keeps a lower bound on the distance of each point to each centroid,
+ * which needs O(nk) memory; Hamerly's algorithm keeps only one lower bound per
+ * point, but that prunes much less.  Yinyang k-means divides the centroids into
+ * t groups (by clustering the initial centroids) and keeps, for each point, a
+ * lower bound on the distance to each group.  A point whose upper bound is
+ * below all its group bounds keeps its assignment, and otherwise only the
+ * groups whose bound is below the upper bound are searched.
+ *
+ * The group bounds are stored as single-precision floats, rounded down so that
+ * they remain valid bounds, so they take t * n * 4 bytes.  With the default
+ * t = ceil(k / 10) this is a twentieth of the bounds of Elkan's algorithm.
+ *
+ * The points are divided between threads with OpenMP, as in ElkanKMeans.
+ *
+ * For more information, see the following paper:
+ *
+ * @inproceedings{ding2015yinyang,
+ *   title={Yinyang K-means: A drop-in replacement of the classic K-means with
+ *       consistent speedup},
+ *   author={Ding, Yufei and Zhao, Yue and Shen, Xipeng and Musuvathi, Madanlal
+ *       and Mytkowicz, Todd},
+ *   booktitle={Proceedings of the 32nd International Conference on Machine
+ *       Learning (ICML 2015)},
+ *   pages={579--587},
+ *   year={2015}
+ * }
+ *
+ * @tparam MetricType Metric to use; it must satisfy the triangle inequality.
+ * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class YinyangKMeans
+{
+ public:
+  /**
+   * Construct the YinyangKMeans object, which must store the bounds of each
+   * point.
+   *
+   * @param dataset Dataset to cluster.
+   * @param metric Instantiated metric.
+   */
+  YinyangKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of Yinyang k-means, updating the given centroids
+   * into the newCentroids matrix.  In the first iteration (or whenever the
+   * number of centroids changes) the centroids are grouped and the bounds are
+   * computed exactly.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Current counts, to be overwritten with new counts.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  //! Get the number of distance calculations.
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of centroid groups; 0 means ceil(k / 10).
+  size_t NumGroups() const { return numGroups; }
+  //! Modify the number of centroid groups; 0 means ceil(k / 10).  This takes
+  //! effect when the centroids are next grouped.
+  size_t& NumGroups() { return numGroups; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The number of groups, or 0 to choose it from the number of centroids.
+  size_t numGroups;
+
+  //! The centroids in each group.
+  std::vector<std::vector<size_t>> groups;
+  //! The group of each centroid.
+  arma::Col<size_t> centroidGroups;
+
+  //! Upper bounds for each point.
+  arma::vec upperBounds;
+  //! Lower bounds on the distance of each point (column) to each group
+  //! (row), not counting the centroid the point is assigned to.
+  arma::fmat lowerBounds;
+  //! Assignments for each point.
+  arma::Col<size_t> assignments;
+
+  //! Track distance calculations.
+  size_t distanceCalculations;
+
+  //! Divide the centroids into groups by clustering them.
+  void GroupCentroids(const arma::mat& centroids);
+
+  //! Compute the assignment and all bounds of each point exactly.
+  void InitializeBounds(const arma::mat& centroids);
+
+  //! Round the given lower bound down to a float.
+  static float LowerBound(const double bound);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "yinyang_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,305 @@
+/**
+ * @file yinyang_kmeans_impl.hpp
+ *
+ * Implementation of Yinyang k-means, using OpenMP to divide the points between
+ * threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "yinyang_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+YinyangKMeans<MetricType, MatType>::YinyangKMeans(const MatType& dataset,
+                                                  MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    numGroups(0),
+    distanceCalculations(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename MatType>
+double YinyangKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  // If this is the first iteration, we need to group the centroids and set all
+  // the bounds.
+  if (centroidGroups.n_elem != centroids.n_cols)
+  {
+    GroupCentroids(centroids);
+    InitializeBounds(centroids);
+  }
+
+  // Reset new centroids.
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+
+  size_t calculations = 0;
+  size_t globallyPruned = 0;
+
+  // The points of each chunk are summed into its own centroids (see
+  // ReductionPartials), which are combined at the end.  Pruned points are much
+  // cheaper than the others, so the chunks are handed out dynamically.
+  typedef std::pair<arma::mat, arma::Col<size_t>> SumsType;
+  ReductionPartials<SumsType> partials(dataset.n_cols, SumsType(newCentroids,
+      counts));
+
+  #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads()) \
+      reduction(+:calculations, globallyPruned)
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
+  {
+    arma::mat& localCentroids = partials.Partial(chunk).first;
+    arma::Col<size_t>& localCounts = partials.Partial(chunk).second;
+
+    for (size_t i = partials.Begin(chunk); i < partials.End(chunk); ++i)
+    {
+      // Global filter: if the upper bound is below the bounds of all groups,
+      // no other centroid can be closer.
+      const double globalLowerBound = lowerBounds.unsafe_col(i).min();
+      if (upperBounds(i) <= globalLowerBound)
+      {
+        ++globallyPruned;
+        localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+        ++localCounts(assignments[i]);
+        continue;
+      }
+
+      // Tighten the upper bound and try again.
+      size_t best = assignments[i];
+      double bestDistance = metric.Evaluate(dataset.col(i),
+                                            centroids.col(best));
+      ++calculations;
+
+      if (bestDistance > globalLowerBound)
+      {
+        // Group filter: only search the groups whose bound is below the
+        // distance to the best centroid so far.
+        for (size_t g = 0; g < groups.size(); ++g)
+        {
+          if (groups[g].empty() || lowerBounds(g, i) >= bestDistance)
+            continue;
+
+          double groupMin = DBL_MAX;
+          for (size_t j = 0; j < groups[g].size(); ++j)
+          {
+            const size_t c = groups[g][j];
+            if (c == best)
+              continue;
+
+            const double distance = metric.Evaluate(dataset.col(i),
+                                                    centroids.col(c));
+            ++calculations;
+
+            if (distance < bestDistance)
+            {
+              // The old best centroid is not the closest anymore, so its
+              // distance now bounds its group.
+              const size_t oldGroup = centroidGroups[best];
+              if (oldGroup == g)
+                groupMin = std::min(groupMin, bestDistance);
+              else
+                lowerBounds(oldGroup, i) = std::min(lowerBounds(oldGroup, i),
+                    LowerBound(bestDistance));
+
+              best = c;
+              bestDistance = distance;
+            }
+            else
+            {
+              groupMin = std::min(groupMin, distance);
+            }
+          }
+
+          lowerBounds(g, i) = LowerBound(groupMin);
+        }
+      }
+
+      upperBounds(i) = bestDistance;
+      assignments[i] = best;
+      localCentroids.col(best) += arma::vec(dataset.col(i));
+      ++localCounts(best);
+    }
+  }
+
+  // Combine the centroids of each chunk (or thread).
+  SumsType sums;
+  partials.Reduce(sums, [](SumsType& a, const SumsType& b)
+  {
+    a.first += b.first;
+    a.second += b.second;
+  });
+  newCentroids = std::move(sums.first);
+  counts = std::move(sums.second);
+
+  distanceCalculations += calculations;
+
+  // Normalize centroids and calculate how far each centroid, and each group,
+  // moved.
+  arma::vec centroidMovements(centroids.n_cols);
+  arma::vec groupMovements(groups.size(), arma::fill::zeros);
+  double centroidMovement = 0.0;
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    if (counts(c) > 0)
+      newCentroids.col(c) /= counts(c);
+
+    const double movement = metric.Evaluate(centroids.col(c),
+                                            newCentroids.col(c));
+    centroidMovements(c) = movement;
+    centroidMovement += std::pow(movement, 2.0);
+    ++distanceCalculations;
+
+    if (movement > groupMovements(centroidGroups[c]))
+      groupMovements(centroidGroups[c]) = movement;
+  }
+
+  // Now update the bounds for the new centroids.
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
+  {
+    upperBounds(i) += centroidMovements(assignments[i]);
+    for (size_t g = 0; g < groups.size(); ++g)
+      lowerBounds(g, i) = LowerBound(lowerBounds(g, i) - groupMovements(g));
+  }
+
+  Log::Info << "Yinyang global prunes: " << globallyPruned << ".\n";
+
+  return std::sqrt(centroidMovement);
+}
+
+template<typename MetricType, typename MatType>
+void YinyangKMeans<MetricType, MatType>::GroupCentroids(
+    const arma::mat& centroids)
+{
+  const size_t k = centroids.n_cols;
+  size_t t = (numGroups == 0) ? (k + 9) / 10 : std::min(numGroups, k);
+  if (t == 0)
+    t = 1;
+
+  // Cluster the centroids with a few Lloyd iterations, starting from evenly
+  // spaced centroids.  Any grouping gives correct results; a good one only
+  // makes the group bounds tighter.
+  arma::mat groupCentroids(centroids.n_rows, t);
+  for (size_t g = 0; g < t; ++g)
+    groupCentroids.col(g) = centroids.col((g * k) / t);
+
+  centroidGroups.zeros(k);
+  for (size_t iteration = 0; iteration < 5; ++iteration)
+  {
+    #pragma omp parallel for
+    for (omp_size_t c = 0; c < (omp_size_t) k; ++c)
+    {
+      double minDistance = DBL_MAX;
+      for (size_t g = 0; g < t; ++g)
+      {
+        const double distance = metric.Evaluate(centroids.col(c),
+                                                groupCentroids.col(g));
+        if (distance < minDistance)
+        {
+          minDistance = distance;
+          centroidGroups[c] = g;
+        }
+      }
+    }
+    distanceCalculations += k * t;
+
+    arma::mat newGroupCentroids(centroids.n_rows, t, arma::fill::zeros);
+    arma::Col<size_t> groupCounts(t, arma::fill::zeros);
+    for (size_t c = 0; c < k; ++c)
+    {
+      newGroupCentroids.col(centroidGroups[c]) += centroids.col(c);
+      ++groupCounts[centroidGroups[c]];
+    }
+
+    for (size_t g = 0; g < t; ++g)
+      if (groupCounts[g] > 0)
+        groupCentroids.col(g) = newGroupCentroids.col(g) / groupCounts[g];
+  }
+
+  groups.clear();
+  groups.resize(t);
+  for (size_t c = 0; c < k; ++c)
+    groups[centroidGroups[c]].push_back(c);
+}
+
+template<typename MetricType, typename MatType>
+void YinyangKMeans<MetricType, MatType>::InitializeBounds(
+    const arma::mat& centroids)
+{
+  upperBounds.set_size(dataset.n_cols);
+  lowerBounds.set_size(groups.size(), dataset.n_cols);
+  assignments.set_size(dataset.n_cols);
+
+  size_t calculations = 0;
+  #pragma omp parallel reduction(+:calculations)
+  {
+    arma::vec groupMins(groups.size());
+
+    #pragma omp for
+    for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
+    {
+      groupMins.fill(DBL_MAX);
+      double bestDistance = DBL_MAX;
+      size_t best = 0;
+      for (size_t c = 0; c < centroids.n_cols; ++c)
+      {
+        const double distance = metric.Evaluate(dataset.col(i),
+                                                centroids.col(c));
+        if (distance < bestDistance)
+        {
+          if (bestDistance != DBL_MAX)
+            groupMins[centroidGroups[best]] = std::min(
+                groupMins[centroidGroups[best]], bestDistance);
+
+          best = c;
+          bestDistance = distance;
+        }
+        else
+        {
+          groupMins[centroidGroups[c]] = std::min(groupMins[centroidGroups[c]],
+              distance);
+        }
+      }
+      calculations += centroids.n_cols;
+
+      upperBounds(i) = bestDistance;
+      assignments[i] = best;
+      for (size_t g = 0; g < groups.size(); ++g)
+        lowerBounds(g, i) = LowerBound(groupMins[g]);
+    }
+  }
+  distanceCalculations += calculations;
+}
+
+template<typename MetricType, typename MatType>
+float YinyangKMeans<MetricType, MatType>::LowerBound(const double bound)
+{
+  // Distances are never negative, so a bound below -FLT_MAX may be clamped.
+  if (bound >= (double) std::numeric_limits<float>::max())
+    return std::numeric_limits<float>::max();
+  else if (bound <= (double) -std::numeric_limits<float>::max())
+    return -std::numeric_limits<float>::max();
+
+  float result = (float) bound;
+  if ((double) result > bound)
+    result = std::nextafter(result, -std::numeric_limits<float>::max());
+
+  return result;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
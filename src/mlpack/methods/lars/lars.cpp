@@ -21,6 +21,7 @@ LARS::LARS(const bool useCholesky,
            const double lambda2,
            const double tolerance) :
     matGram(&matGramInternal),
+    gramHasLambda2(false),
     useCholesky(useCholesky),
     lasso((lambda1 != 0)),
     lambda1(lambda1),
@@ -35,6 +36,7 @@ LARS::LARS(const bool useCholesky,
            const double lambda2,
            const double tolerance) :
     matGram(&gramMatrix),
+    gramHasLambda2(false),
     useCholesky(useCholesky),
     lasso((lambda1 != 0)),
     lambda1(lambda1),
@@ -51,6 +53,7 @@ LARS::LARS(const arma::mat& data,
            const double lambda2,
            const double tolerance) :
     matGram(&matGramInternal),
+    gramHasLambda2(false),
     useCholesky(useCholesky),
     lasso((lambda1 != 0)),
     lambda1(lambda1),
@@ -71,6 +74,7 @@ LARS::LARS(const arma::mat& data,
            const double lambda2,
            const double tolerance) :
     matGram(&gramMatrix),
+    gramHasLambda2(false),
     useCholesky(useCholesky),
     lasso((lambda1 != 0)),
     lambda1(lambda1),
@@ -130,17 +134,9 @@ void LARS::Train(const arma::mat& matX,
                  arma::vec& beta,
                  const bool transposeData)
 {
+  CheckGram(transposeData ? matX.n_rows : matX.n_cols);
   Timer::Start("lars_regression");
 
-  // Clear any previous solution information.
-  betaPath.clear();
-  lambdaPath.clear();
-  activeSet.clear();
-  isActive.clear();
-  ignoreSet.clear();
-  isIgnored.clear();
-  matUtriCholFactor.reset();
-
   // This matrix may end up holding the transpose -- if necessary.
   arma::mat dataTrans;
   // dataRef is row-major.
@@ -149,19 +145,137 @@ void LARS::Train(const arma::mat& matX,
     dataTrans = trans(matX);
 
   // Compute X' * y.
-  arma::vec vecXTy = trans(y * dataRef);
+  const arma::vec vecXTy = trans(y * dataRef);
+
+  ComputeGram(dataRef);
+  RunLARS(vecXTy, beta);
+
+  Timer::Stop("lars_regression");
+}
+
+void LARS::Train(const arma::mat& matX,
+                 const arma::mat& responses,
+                 arma::mat& beta,
+                 const bool transposeData)
+{
+  const size_t numPoints = (transposeData ? matX.n_cols : matX.n_rows);
+  if (responses.n_rows != numPoints)
+  {
+    std::ostringstream oss;
+    oss << "LARS::Train(): the responses have " << responses.n_rows
+        << " rows, but there are " << numPoints << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  CheckGram(transposeData ? matX.n_rows : matX.n_cols);
+  Timer::Start("lars_regression");
+
+  arma::mat dataTrans;
+  const arma::mat& dataRef = (transposeData ? dataTrans : matX);
+  if (transposeData)
+    dataTrans = trans(matX);
+
+  // The correlations of all the responses are computed with one matrix
+  // product, and the Gram matrix is shared by all the problems.
+  const arma::mat matXTy = trans(dataRef) * responses;
+  ComputeGram(dataRef);
+
+  beta.set_size(dataRef.n_cols, responses.n_cols);
+  if (responses.n_cols == 0)
+  {
+    Timer::Stop("lars_regression");
+    return;
+  }
+
+  // The problems are independent, so they are solved in parallel, each thread
+  // with its own LARS object that only reads the Gram matrix.  The last
+  // problem is solved by this object, so that its solution path is kept.
+  const omp_size_t numParallel = (omp_size_t) responses.n_cols - 1;
+  #pragma omp parallel
+  {
+    LARS threadLars(useCholesky, *matGram, lambda1, lambda2, tolerance);
+    threadLars.gramHasLambda2 = gramHasLambda2;
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < numParallel; ++i)
+    {
+      arma::vec betaCol = beta.unsafe_col(i);
+      threadLars.RunLARS(matXTy.col(i), betaCol);
+    }
+  }
+
+  arma::vec betaCol = beta.unsafe_col(responses.n_cols - 1);
+  RunLARS(matXTy.col(responses.n_cols - 1), betaCol);
+
+  Timer::Stop("lars_regression");
+}
+
+void LARS::Solve(const arma::vec& correlations, arma::vec& beta)
+{
+  if (matGram->n_rows != correlations.n_elem ||
+      matGram->n_cols != correlations.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "LARS::Solve(): the Gram matrix is " << matGram->n_rows << "x"
+        << matGram->n_cols << ", but there are " << correlations.n_elem
+        << " correlations";
+    throw std::invalid_argument(oss.str());
+  }
+
+  Timer::Start("lars_regression");
+  RunLARS(correlations, beta);
+  Timer::Stop("lars_regression");
+}
+
+void LARS::CheckGram(const size_t dims) const
+{
+  if (matGram != &matGramInternal &&
+      (matGram->n_rows != dims || matGram->n_cols != dims))
+  {
+    std::ostringstream oss;
+    oss << "LARS::Train(): the Gram matrix is " << matGram->n_rows << "x"
+        << matGram->n_cols << ", but the data has " << dims << " dimensions";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+void LARS::ComputeGram(const arma::mat& dataRef)
+{
+  // Compute the Gram matrix, unless one was given to the constructor (which is
+  // then used as it is).  If this is the elastic net problem, we will add
+  // lambda2 * I_n to the matrix.
+  if (matGram == &matGramInternal)
+  {
+    matGramInternal = trans(dataRef) * dataRef;
+
+    gramHasLambda2 = (elasticNet && !useCholesky);
+    if (gramHasLambda2)
+      matGramInternal += lambda2 * arma::eye(dataRef.n_cols, dataRef.n_cols);
+  }
+}
+
+void LARS::RunLARS(const arma::vec& vecXTy, arma::vec& beta)
+{
+  const size_t dims = vecXTy.n_elem;
+
+  // Clear any previous solution information.
+  betaPath.clear();
+  lambdaPath.clear();
+  activeSet.clear();
+  isActive.clear();
+  ignoreSet.clear();
+  isIgnored.clear();
+  matUtriCholFactor.reset();
 
   // Set up active set variables.  In the beginning, the active set has size 0
   // (all dimensions are inactive).
-  isActive.resize(dataRef.n_cols, false);
+  isActive.resize(dims, false);
 
   // Set up ignores set variables. Initialized empty.
-  isIgnored.resize(dataRef.n_cols, false);
+  isIgnored.resize(dims, false);
 
-  // Initialize yHat and beta.
-  beta = arma::zeros(dataRef.n_cols);
-  arma::vec yHat = arma::zeros(dataRef.n_rows);
-  arma::vec yHatDirection(dataRef.n_rows);
+  // Initialize beta.
+  beta = arma::zeros(dims);
 
   bool lassocond = false;
 
@@ -185,28 +299,16 @@ void LARS::Train(const arma::mat& matX,
   if (maxCorr < lambda1)
   {
     lambdaPath[0] = lambda1;
-    Timer::Stop("lars_regression");
     return;
   }
 
-  // Compute the Gram matrix.  If this is the elastic net problem, we will add
-  // lambda2 * I_n to the matrix.
-  if (matGram->n_elem != dataRef.n_cols * dataRef.n_cols)
-  {
-    // In this case, matGram should reference matGramInternal.
-    matGramInternal = trans(dataRef) * dataRef;
-
-    if (elasticNet && !useCholesky)
-      matGramInternal += lambda2 * arma::eye(dataRef.n_cols, dataRef.n_cols);
-  }
-
   // Main loop.
-  while (((activeSet.size() + ignoreSet.size()) < dataRef.n_cols) &&
+  while (((activeSet.size() + ignoreSet.size()) < dims) &&
          (maxCorr > tolerance))
   {
     // Compute the maximum correlation among inactive dimensions.
     maxCorr = 0;
-    for (size_t i = 0; i < dataRef.n_cols; i++)
+    for (size_t i = 0; i < dims; i++)
     {
       if ((!isActive[i]) && (!isIgnored[i]) && (fabs(corr(i)) > maxCorr))
       {
@@ -225,7 +327,7 @@ void LARS::Train(const arma::mat& matX,
         //   newGramCol[i] = dot(matX.col(activeSet[i]), matX.col(changeInd));
         // }
         // This is equivalent to the above 5 lines.
-        arma::vec newGramCol = matGram->elem(changeInd * dataRef.n_cols +
+        arma::vec newGramCol = matGram->elem(changeInd * dims +
             arma::conv_to<arma::uvec>::from(activeSet));
 
         CholeskyInsert((*matGram)(changeInd, changeInd), newGramCol);
@@ -315,21 +417,25 @@ void LARS::Train(const arma::mat& matX,
       }
     }
 
-    // compute "equiangular" direction in output space
-    ComputeYHatDirection(dataRef, betaDirection, yHatDirection);
-
     double gamma = maxCorr / normalization;
 
     // If not all variables are active.
-    if ((activeSet.size() + ignoreSet.size()) < dataRef.n_cols)
+    if ((activeSet.size() + ignoreSet.size()) < dims)
     {
+      // The correlations of the dimensions with the "equiangular" direction in
+      // output space, X^T X betaDirection, come from the Gram matrix, so the
+      // data itself is not needed.
+      arma::vec dirCorrs = arma::zeros(dims);
+      for (size_t i = 0; i < activeSet.size(); i++)
+        dirCorrs += betaDirection(i) * matGram->col(activeSet[i]);
+
       // Compute correlations with direction.
-      for (size_t ind = 0; ind < dataRef.n_cols; ind++)
+      for (size_t ind = 0; ind < dims; ind++)
       {
         if (isActive[ind] || isIgnored[ind])
           continue;
 
-        double dirCorr = dot(dataRef.col(ind), yHatDirection);
+        double dirCorr = dirCorrs(ind);
         double val1 = (maxCorr - corr(ind)) / (normalization - dirCorr);
         double val2 = (maxCorr + corr(ind)) / (normalization + dirCorr);
         if ((val1 > 0) && (val1 < gamma))
@@ -364,9 +470,6 @@ void LARS::Train(const arma::mat& matX,
       }
     }
 
-    // Update the prediction.
-    yHat += gamma * yHatDirection;
-
     // Update the estimator.
     for (size_t i = 0; i < activeSet.size(); i++)
     {
@@ -391,8 +494,12 @@ void LARS::Train(const arma::mat& matX,
       Deactivate(changeInd);
     }
 
-    corr = vecXTy - trans(dataRef) * yHat;
-    if (elasticNet)
+    // The correlations of the residual, X^T (y - X beta), are computed with the
+    // Gram matrix too; only the active dimensions have nonzero coefficients.
+    corr = vecXTy;
+    for (size_t i = 0; i < activeSet.size(); i++)
+      corr -= beta(activeSet[i]) * matGram->col(activeSet[i]);
+    if (elasticNet && !gramHasLambda2)
       corr -= lambda2 * beta;
 
     double curLambda = 0;
@@ -416,8 +523,6 @@ void LARS::Train(const arma::mat& matX,
 
   // Unfortunate copy...
   beta = betaPath.back();
-
-  Timer::Stop("lars_regression");
 }
 
 void LARS::Train(const arma::mat& data,
@@ -467,15 +572,6 @@ void LARS::Ignore(const size_t varInd)
   ignoreSet.push_back(varInd);
 }
 
-void LARS::ComputeYHatDirection(const arma::mat& matX,
-                                const arma::vec& betaDirection,
-                                arma::vec& yHatDirection)
-{
-  yHatDirection.fill(0);
-  for (size_t i = 0; i < activeSet.size(); i++)
-    yHatDirection += betaDirection(i) * matX.col(activeSet[i]);
-}
-
 void LARS::InterpolateBeta()
 {
   int pathLength = betaPath.size();
@@ -290,6 +290,47 @@ class LARS
              const arma::rowvec& responses,
              const bool transposeData = true);
 
+  /**
+   * Run LARS on several sets of responses for the same data, as when a
+   * dictionary is used to code many points.  X^T y is computed for all of them
+   * with a single matrix product and the Gram matrix is only computed once (if
+   * none was given to the constructor), so that each problem only takes time
+   * that depends on the dimensionality of the data, and not on the number of
+   * points.  The problems are solved in parallel with OpenMP, each thread with
+   * its own copy of the LARS settings sharing the Gram matrix.  After this, the
+   * solution path and the active set are those of the last problem.
+   *
+   * As with the other overloads, pass 'false' for transposeData if the data
+   * is row-major (each row is a point).
+   *
+   * @param data Input data.
+   * @param responses Responses; each column holds the responses of all the
+   *     points for one problem.
+   * @param beta Matrix to store the solutions in; column i is the solution for
+   *     column i of the responses.
+   * @param transposeData Should be true if the input data is column-major and
+   *     false otherwise.
+   */
+  void Train(const arma::mat& data,
+             const arma::mat& responses,
+             arma::mat& beta,
+             const bool transposeData);
+
+  /**
+   * Run LARS for responses y given only by X^T y (the correlations of the
+   * responses with each dimension), using the Gram matrix X^T X given to the
+   * constructor (or computed by the last call to Train()).  The data itself is
+   * not needed, so when many problems share the same data (or a Gram matrix
+   * that is cheap to update, like the weighted dictionaries of local coordinate
+   * coding), each of them takes time that depends only on the dimensionality.
+   * A std::invalid_argument is thrown if the size of the Gram matrix does not
+   * match the number of correlations.
+   *
+   * @param correlations X^T y.
+   * @param beta Vector to store the solution (the coefficients) in.
+   */
+  void Solve(const arma::vec& correlations, arma::vec& beta);
+
   /**
    * Predict y_i for each data point in the given data matrix, using the
    * currently-trained LARS model (so make sure you run Regress() first).  If
@@ -346,6 +387,10 @@ class LARS
   //! Pointer to the Gram matrix we will use.
   const arma::mat* matGram;
 
+  //! Whether the Gram matrix holds lambda2 * I_n (only if it was computed for
+  //! the elastic net without the Cholesky decomposition).
+  bool gramHasLambda2;
+
   //! Upper triangular cholesky factor; initially 0x0 matrix.
   arma::mat matUtriCholFactor;
 
@@ -406,10 +451,23 @@ class LARS
    */
   void Ignore(const size_t varInd);
 
-  // compute "equiangular" direction in output space
-  void ComputeYHatDirection(const arma::mat& matX,
-                            const arma::vec& betaDirection,
-                            arma::vec& yHatDirection);
+  /**
+   * Throw a std::invalid_argument if a Gram matrix was given to the
+   * constructor and its size does not match the given dimensionality.
+   */
+  void CheckGram(const size_t dims) const;
+
+  /**
+   * Compute the Gram matrix of the given row-major data, unless one was given
+   * to the constructor.
+   */
+  void ComputeGram(const arma::mat& dataRef);
+
+  /**
+   * Run LARS with the Gram matrix, given X^T y.  Only the Gram matrix is used,
+   * so this takes time that does not depend on the number of points.
+   */
+  void RunLARS(const arma::vec& vecXTy, arma::vec& beta);
 
   // interpolate to compute last solution vector
   void InterpolateBeta();
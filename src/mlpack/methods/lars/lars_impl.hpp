@@ -43,6 +43,10 @@ void LARS::Serialize(Archive& ar, const unsigned int /* version */)
   ar & CreateNVP(lambda1, "lambda1");
   ar & CreateNVP(elasticNet, "elasticNet");
   ar & CreateNVP(lambda2, "lambda2");
+
+  // A loaded Gram matrix is treated like one computed by Train().
+  if (Archive::is_loading::value)
+    gramHasLambda2 = (elasticNet && !useCholesky);
   ar & CreateNVP(tolerance, "tolerance");
   ar & CreateNVP(betaPath, "betaPath");
   ar & CreateNVP(lambdaPath, "lambdaPath");
@@ -42,6 +42,14 @@ LinearRegression::LinearRegression(const arma::mat& predictors,
   Train(predictors, responses, weights, intercept);
 }
 
+LinearRegression::LinearRegression(const NormalEquations& equations,
+                                   const double lambda) :
+    lambda(lambda),
+    intercept(equations.Intercept())
+{
+  Train(equations);
+}
+
 void LinearRegression::Train(const arma::mat& predictors,
                              const arma::vec& responses,
                              const bool intercept,
@@ -122,6 +130,27 @@ void LinearRegression::Train(const arma::mat& predictors,
   }
 }
 
+void LinearRegression::Train(const NormalEquations& equations)
+{
+  intercept = equations.Intercept();
+
+  // The ridge penalty is added to the diagonal of X W X^T, except for the
+  // intercept, like in the QR decomposition above.
+  arma::mat gram = equations.Gram();
+  if (lambda != 0.0 && equations.Dimensionality() > 0)
+  {
+    const size_t offset = intercept ? 1 : 0;
+    gram.diag().subvec(offset, gram.n_rows - 1) += lambda;
+  }
+
+  if (!arma::solve(parameters, gram, equations.Moment()))
+  {
+    parameters.clear();
+    throw std::runtime_error("LinearRegression::Train(): the normal equations "
+        "could not be solved");
+  }
+}
+
 void LinearRegression::Predict(const arma::mat& points, arma::vec& predictions)
     const
 {
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_LINEAR_REGRESSION_LINEAR_REGRESSION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "normal_equations.hpp"
 
 namespace mlpack {
 namespace regression /** Regression methods. */ {
@@ -69,6 +70,16 @@ class LinearRegression
                    const double lambda = 0,
                    const bool intercept = true);
 
+  /**
+   * Creates the model from the normal equations of the training points, which
+   * can be accumulated in batches (see NormalEquations).  Whether or not an
+   * intercept term is used is given by the equations.
+   *
+   * @param equations Normal equations of the training points.
+   * @param lambda Regularization constant for ridge regression.
+   */
+  LinearRegression(const NormalEquations& equations, const double lambda = 0);
+
   /**
    * Empty constructor.  This gives a non-working model, so make sure Train() is
    * called (or make sure the model parameters are set) before calling
@@ -125,6 +136,19 @@ class LinearRegression
              const arma::rowvec& weights,
              const bool intercept = true);
 
+  /**
+   * Train the LinearRegression model by solving the given normal equations,
+   * with the regularization parameter lambda of the model (the intercept is
+   * not penalized).  The equations can be built from batches of points, so
+   * that the training set does not have to be in memory; see NormalEquations.
+   * Careful!  This will completely ignore and overwrite the existing model.
+   * Whether or not an intercept term is used is given by the equations.  A
+   * std::runtime_error is thrown if the system cannot be solved.
+   *
+   * @param equations Normal equations of the training points.
+   */
+  void Train(const NormalEquations& equations);
+
   /**
    * Calculate y_i for each data point in points.
    *
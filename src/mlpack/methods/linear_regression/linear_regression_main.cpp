@@ -175,23 +175,18 @@ void mlpackMain()
     Timer::Start("regression");
     lr = LinearRegression(regressors, responses);
     Timer::Stop("regression");
-
-    // Save the parameters.
-    if (CLI::HasParam("output_model"))
-      CLI::GetParam<LinearRegression>("output_model") = std::move(lr);
+  }
+  else
+  {
+    // A model file was passed in, so load it.
+    Timer::Start("load_model");
+    lr = std::move(CLI::GetParam<LinearRegression>("input_model"));
+    Timer::Stop("load_model");
   }
 
   // Did we want to predict, too?
   if (CLI::HasParam("test"))
   {
-    // A model file was passed in, so load it.
-    if (!computeModel)
-    {
-      Timer::Start("load_model");
-      lr = std::move(CLI::GetParam<LinearRegression>("input_model"));
-      Timer::Stop("load_model");
-    }
-
     // Load the test file data.
     Timer::Start("load_test_points");
     mat points = std::move(CLI::GetParam<mat>("test"));
@@ -216,4 +211,8 @@ void mlpackMain()
     if (CLI::HasParam("output_predictions"))
       CLI::GetParam<vec>("output_predictions") = std::move(predictions);
   }
+
+  // Save the model, if needed.
+  if (CLI::HasParam("output_model"))
+    CLI::GetParam<LinearRegression>("output_model") = std::move(lr);
 }
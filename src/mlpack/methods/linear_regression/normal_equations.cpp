@@ -0,0 +1,156 @@
+/**
+ * @file normal_equations.cpp
+ *
+ * Implementation of the NormalEquations class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "normal_equations.hpp"
+
+using namespace mlpack;
+using namespace mlpack::regression;
+
+NormalEquations::NormalEquations(const size_t dimensionality,
+                                 const bool intercept) :
+    dimensionality(dimensionality),
+    intercept(intercept)
+{
+  Reset();
+}
+
+void NormalEquations::Add(const arma::mat& predictors,
+                          const arma::rowvec& responses)
+{
+  Add(predictors, responses, arma::rowvec());
+}
+
+void NormalEquations::Add(const arma::mat& predictors,
+                          const arma::rowvec& responses,
+                          const arma::rowvec& weights)
+{
+  if (predictors.n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "NormalEquations::Add(): the points have " << predictors.n_rows
+        << " dimensions, but " << dimensionality << " were expected";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (responses.n_elem != predictors.n_cols ||
+      (weights.n_elem > 0 && weights.n_elem != predictors.n_cols))
+  {
+    std::ostringstream oss;
+    oss << "NormalEquations::Add(): there are " << predictors.n_cols
+        << " points, but " << responses.n_elem << " responses and "
+        << weights.n_elem << " weights";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t numBlocks = (predictors.n_cols + BlockSize - 1) / BlockSize;
+
+  // Each chunk is a range of the blocks.
+  typedef std::pair<arma::mat, arma::vec> SumsType;
+  ReductionPartials<SumsType> partials(numBlocks, SumsType(
+      arma::mat(gram.n_rows, gram.n_cols, arma::fill::zeros),
+      arma::vec(moment.n_elem, arma::fill::zeros)), 0, 1);
+
+  #pragma omp parallel for schedule(static) num_threads(partials.Threads())
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
+  {
+    SumsType& local = partials.Partial(chunk);
+    for (size_t b = partials.Begin(chunk); b < partials.End(chunk); ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min((size_t) predictors.n_cols,
+          begin + BlockSize) - 1;
+      AddBlock(predictors, responses, weights, begin, end, local.first,
+          local.second);
+    }
+  }
+
+  // Combine the sums of each chunk.
+  SumsType sums;
+  partials.Reduce(sums, [](SumsType& a, const SumsType& b)
+  {
+    a.first += b.first;
+    a.second += b.second;
+  });
+
+  gram += sums.first;
+  moment += sums.second;
+
+  numPoints += predictors.n_cols;
+}
+
+void NormalEquations::AddBlock(const arma::mat& predictors,
+                               const arma::rowvec& responses,
+                               const arma::rowvec& weights,
+                               const size_t begin,
+                               const size_t end,
+                               arma::mat& blockGram,
+                               arma::vec& blockMoment) const
+{
+  const arma::mat points = predictors.cols(begin, end);
+  const arma::rowvec blockResponses = responses.subvec(begin, end);
+  arma::mat weightedPoints = points;
+  arma::rowvec weightedResponses = blockResponses;
+  if (weights.n_elem > 0)
+  {
+    weightedPoints.each_row() %= weights.subvec(begin, end);
+    weightedResponses %= weights.subvec(begin, end);
+  }
+
+  // The intercept is the first row and column, so the equations of the points
+  // go after it; this avoids building the matrix of the points with a row of
+  // ones.
+  if (intercept)
+  {
+    blockGram(0, 0) += (weights.n_elem > 0) ?
+        arma::accu(weights.subvec(begin, end)) : (double) points.n_cols;
+    blockMoment(0) += arma::accu(weightedResponses);
+  }
+
+  if (dimensionality == 0)
+    return;
+
+  const size_t offset = intercept ? 1 : 0;
+  blockGram.submat(offset, offset, blockGram.n_rows - 1, blockGram.n_cols - 1)
+      += weightedPoints * points.t();
+  blockMoment.subvec(offset, blockMoment.n_elem - 1) +=
+      weightedPoints * blockResponses.t();
+  if (intercept)
+  {
+    const arma::vec pointSums = arma::sum(weightedPoints, 1);
+    blockGram.submat(1, 0, blockGram.n_rows - 1, 0) += pointSums;
+    blockGram.submat(0, 1, 0, blockGram.n_cols - 1) += pointSums.t();
+  }
+}
+
+void NormalEquations::Merge(const NormalEquations& other)
+{
+  if (other.dimensionality != dimensionality || other.intercept != intercept)
+  {
+    std::ostringstream oss;
+    oss << "NormalEquations::Merge(): the equations are for " << dimensionality
+        << " dimensions " << (intercept ? "with" : "without") << " intercept, "
+        << "but the other equations are for " << other.dimensionality
+        << " dimensions " << (other.intercept ? "with" : "without")
+        << " intercept";
+    throw std::invalid_argument(oss.str());
+  }
+
+  gram += other.gram;
+  moment += other.moment;
+  numPoints += other.numPoints;
+}
+
+void NormalEquations::Reset()
+{
+  const size_t size = dimensionality + (intercept ? 1 : 0);
+  gram.zeros(size, size);
+  moment.zeros(size);
+  numPoints = 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file normal_equations.hpp
+ *
+ * Definition of the NormalEquations class, which accumulates the normal
+ * equations of a least-squares problem from batches of points, so that a
+ * LinearRegression model can be trained in a single pass over a dataset that
+ * does not fit in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LINEAR_REGRESSION_NORMAL_EQUATIONS_HPP
+#define MLPACK_METHODS_LINEAR_REGRESSION_NORMAL_EQUATIONS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * The normal equations X W X^T B = X W y of a (weighted) least-squares
+ * problem, accumulated from batches of points.  X holds the points as columns
+ * (with a first row of ones if an intercept is fitted), y the responses and W
+ * the diagonal matrix of the weights of the points.  Only the (d + 1) x (d + 1)
+ * matrix X W X^T and the vector X W y are kept, so memory usage does not depend
+ * on the number of points.
+ *
+ * The points of a batch are split between OpenMP threads, and the equations of
+ * different parts of a dataset (for instance built by different processes) can
+ * be merged with Merge(); a NormalEquations object can be serialized to be
+ * sent from one process to another.  Once all the points are added, pass the
+ * object to LinearRegression::Train() to solve the system (with the ridge
+ * regularization of the model) once.
+ *
+ * @code
+ * data::BatchReader<> reader("train.csv", 100000);
+ * NormalEquations equations(reader.Dimensionality() - 1);
+ * arma::mat batch;
+ * while (reader.NextBatch(batch))
+ * {
+ *   // The last dimension of the file holds the responses.
+ *   equations.Add(batch.rows(0, batch.n_rows - 2),
+ *       batch.row(batch.n_rows - 1));
+ * }
+ *
+ * LinearRegression lr;
+ * lr.Lambda() = 0.1;
+ * lr.Train(equations);
+ * @endcode
+ */
+class NormalEquations
+{
+ public:
+  /**
+   * Create empty normal equations for points of the given dimensionality.
+   *
+   * @param dimensionality Dimensionality of the points.
+   * @param intercept Whether or not an intercept term is fitted.
+   */
+  NormalEquations(const size_t dimensionality = 0,
+                  const bool intercept = true);
+
+  /**
+   * Add the given points and their responses to the equations.  A
+   * std::invalid_argument is thrown if the sizes do not match.
+   *
+   * @param predictors Points to add, as columns.
+   * @param responses Responses of the points.
+   */
+  void Add(const arma::mat& predictors, const arma::rowvec& responses);
+
+  /**
+   * Add the given points, with the given weights, and their responses to the
+   * equations.  A std::invalid_argument is thrown if the sizes do not match.
+   *
+   * @param predictors Points to add, as columns.
+   * @param responses Responses of the points.
+   * @param weights Observation weights of the points.
+   */
+  void Add(const arma::mat& predictors,
+           const arma::rowvec& responses,
+           const arma::rowvec& weights);
+
+  /**
+   * Add the equations of other points to these ones, as if their points had
+   * been added to this object.  A std::invalid_argument is thrown if the
+   * dimensionality or the intercept setting is different.
+   *
+   * @param other Normal equations of the other points.
+   */
+  void Merge(const NormalEquations& other);
+
+  //! Remove all the points that were added.
+  void Reset();
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get whether or not an intercept term is fitted.
+  bool Intercept() const { return intercept; }
+  //! Get the number of points that were added.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the matrix X W X^T (the first row and column are for the intercept).
+  const arma::mat& Gram() const { return gram; }
+  //! Get the vector X W y (the first element is for the intercept).
+  const arma::vec& Moment() const { return moment; }
+
+  //! Serialize the equations.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(dimensionality, "dimensionality");
+    ar & data::CreateNVP(intercept, "intercept");
+    ar & data::CreateNVP(numPoints, "numPoints");
+    ar & data::CreateNVP(gram, "gram");
+    ar & data::CreateNVP(moment, "moment");
+  }
+
+ private:
+  //! Number of points that each thread adds at a time.
+  static const size_t BlockSize = 4096;
+
+  /**
+   * Add the points of the given columns to the given matrix and vector.  If
+   * weights is empty, each point has weight 1.
+   */
+  void AddBlock(const arma::mat& predictors,
+                const arma::rowvec& responses,
+                const arma::rowvec& weights,
+                const size_t begin,
+                const size_t end,
+                arma::mat& blockGram,
+                arma::vec& blockMoment) const;
+
+  //! Dimensionality of the points.
+  size_t dimensionality;
+  //! Whether or not an intercept term is fitted.
+  bool intercept;
+  //! Number of points that were added.
+  size_t numPoints;
+  //! The matrix X W X^T.
+  arma::mat gram;
+  //! The vector X W y.
+  arma::vec moment;
+};
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
@@ -30,35 +30,36 @@ LocalCoordinateCoding::LocalCoordinateCoding(
 
 void LocalCoordinateCoding::Encode(const arma::mat& data, arma::mat& codes)
 {
+  // The correlations of the points with the atoms are needed both for the
+  // distances and for LARS, so they are computed once for all the points.
+  const arma::mat dictTData = trans(dictionary) * data;
   arma::mat invSqDists = 1.0 / (repmat(trans(sum(square(dictionary))), 1,
-      data.n_cols) + repmat(sum(square(data)), atoms, 1) - 2 * trans(dictionary)
-      * data);
+      data.n_cols) + repmat(sum(square(data)), atoms, 1) - 2 * dictTData);
 
-  arma::mat dictGram = trans(dictionary) * dictionary;
-  arma::mat dictGramTD(dictGram.n_rows, dictGram.n_cols);
+  const arma::mat dictGram = trans(dictionary) * dictionary;
 
+  // The points are coded independently, so they are coded in parallel; each
+  // thread has its own weighted Gram matrix and LARS object, and they all read
+  // the same dictionary Gram matrix.
   codes.set_size(atoms, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; i++)
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; i++)
   {
-    // Report progress.
-    if ((i % 100) == 0)
-    {
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-    }
-
     arma::vec invW = invSqDists.unsafe_col(i);
-    arma::mat dictPrime = dictionary * diagmat(invW);
 
-    arma::mat dictGramTD = diagmat(invW) * dictGram * diagmat(invW);
+    // The weighted dictionary is D' = D diag(invW), so its Gram matrix is
+    // diag(invW) D^T D diag(invW) and its correlations with the point are
+    // invW % (D^T x); neither needs D' itself.
+    const arma::mat dictGramTD = dictGram % (invW * trans(invW));
+    const arma::vec correlations = invW % dictTData.col(i);
 
     bool useCholesky = false;
     regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
 
-    // Run LARS for this point, by making an alias of the point and passing
+    // Run LARS for this point, by making an alias of the code and passing
     // that.
     arma::vec beta = codes.unsafe_col(i);
-    arma::rowvec responses = data.unsafe_col(i).t();
-    lars.Train(dictPrime, responses, beta, false);
+    lars.Solve(correlations, beta);
     beta %= invW; // Remember, beta is an alias of codes.col(i).
   }
 }
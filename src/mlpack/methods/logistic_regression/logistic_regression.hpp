@@ -16,6 +16,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/cv/warm_start_traits.hpp>
 
 #include "logistic_regression_function.hpp"
 
@@ -258,6 +259,38 @@ class LogisticRegression
 };
 
 } // namespace regression
+
+namespace cv {
+
+/**
+ * LogisticRegression can be trained starting from the parameters of a previous
+ * model (for example, one with a different lambda), as long as the
+ * dimensionality is the same.
+ */
+template<typename MatType>
+struct WarmStartTraits<regression::LogisticRegression<MatType>>
+{
+  static const bool Supported = true;
+
+  template<typename PredictionsType, typename... Args>
+  static regression::LogisticRegression<MatType> Train(
+      const regression::LogisticRegression<MatType>& previous,
+      const MatType& predictors,
+      const PredictionsType& responses,
+      const Args&... args)
+  {
+    if (previous.Parameters().n_elem != predictors.n_rows + 1)
+    {
+      return regression::LogisticRegression<MatType>(predictors, responses,
+          args...);
+    }
+
+    return regression::LogisticRegression<MatType>(predictors, responses,
+        previous.Parameters(), args...);
+  }
+};
+
+} // namespace cv
 } // namespace mlpack
 
 // Include implementation.
@@ -107,6 +107,31 @@ class LogisticRegressionFunction
                 const size_t i,
                 GradType& gradient) const;
 
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with the given parameters.  This computes the sigmoids of all points only
+   * once, so it is cheaper than calling Evaluate() and Gradient().
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param gradient Vector to output gradient into.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the logistic regression log-likelihood function and its gradient
+   * with the given parameters, using only one data point.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of the point to use.
+   * @param gradient Vector to output gradient into.
+   * @return The objective function of the point.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t i,
+                              arma::mat& gradient) const;
+
   /**
    * Evaluate the gradient of the logistic regression log-likelihood function
    * with the given parameters, and with respect to only one feature in the
@@ -172,6 +172,66 @@ void LogisticRegressionFunction<MatType>::Gradient(
       * (responses[i] - sigmoid) + regularization;
 }
 
+//! Evaluate the logistic regression objective function and its gradient.
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  // The sigmoids are shared between the objective and the gradient; see
+  // Evaluate() and Gradient() for the details of each.
+  const arma::rowvec sigmoids = 1.0 / (1.0 + arma::exp(-parameters(0, 0) -
+      parameters.tail_cols(parameters.n_elem - 1) * predictors));
+
+  double result = 0.0;
+  for (size_t i = 0; i < responses.n_elem; ++i)
+  {
+    if (responses[i] == 1)
+      result += log(sigmoids[i]);
+    else
+      result += log(1.0 - sigmoids[i]);
+  }
+
+  const double regularization = 0.5 * lambda *
+      arma::dot(parameters.tail_cols(parameters.n_elem - 1),
+      parameters.tail_cols(parameters.n_elem - 1));
+
+  gradient.set_size(arma::size(parameters));
+  gradient[0] = -arma::accu(responses - sigmoids);
+  gradient.tail_cols(parameters.n_elem - 1) = (sigmoids - responses) *
+      predictors.t() + lambda * parameters.tail_cols(parameters.n_elem - 1);
+
+  return -result + regularization;
+}
+
+//! Evaluate the logistic regression objective function and its gradient with
+//! respect to one point.
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::mat& gradient) const
+{
+  const double norm = arma::norm(parameters.tail_cols(parameters.n_elem - 1));
+  const double regularization = lambda * (1.0 / (2.0 * predictors.n_cols)) *
+      norm * norm;
+
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - arma::dot(
+        predictors.col(i), parameters.tail_cols(parameters.n_elem - 1).t())));
+
+  gradient.set_size(arma::size(parameters));
+  gradient[0] = -(responses[i] - sigmoid);
+  gradient.tail_cols(parameters.n_elem - 1) = -predictors.col(i).t()
+      * (responses[i] - sigmoid) + lambda *
+      parameters.tail_cols(parameters.n_elem - 1) / predictors.n_cols;
+
+  if (responses[i] == 1)
+    return -log(sigmoid) + regularization;
+  else
+    return -log(1.0 - sigmoid) + regularization;
+}
+
 /**
  * Evaluate the partial gradient of the logistic regression objective
  * function with respect to the individual features in the parameter.
@@ -75,6 +75,9 @@ PARAM_DOUBLE_IN("hash_width", "The hash width for the first-level hashing in "
     "a hash width for its use.", "H", 0.0);
 PARAM_INT_IN("num_probes", "Number of additional probes for multiprobe LSH; if "
     "0, traditional LSH is used.", "T", 0);
+PARAM_FLAG("template_probing", "If set, multiprobe LSH uses one probing "
+    "sequence that is computed for all queries instead of one for each query "
+    "and table, which is faster for many probes.", "p");
 PARAM_INT_IN("second_hash_size", "The size of the second level hash table.",
     "S", 99901);
 PARAM_INT_IN("bucket_size", "The size of a bucket in the second level hash.",
@@ -147,6 +150,7 @@ void mlpackMain()
   const size_t numTables = CLI::GetParam<int>("tables");
   const double hashWidth = CLI::GetParam<double>("hash_width");
   const size_t numProbes = (size_t) CLI::GetParam<int>("num_probes");
+  const bool templateProbing = CLI::HasParam("template_probing");
 
   arma::Mat<size_t> neighbors;
   arma::mat distances;
@@ -188,11 +192,12 @@ void mlpackMain()
           << CLI::GetPrintableParam<arma::mat>("query") << "' ("
           << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
 
-      allkann.Search(queryData, k, neighbors, distances, 0, numProbes);
+      allkann.Search(queryData, k, neighbors, distances, 0, numProbes,
+          templateProbing);
     }
     else
     {
-      allkann.Search(k, neighbors, distances, 0, numProbes);
+      allkann.Search(k, neighbors, distances, 0, numProbes, templateProbing);
     }
   }
 
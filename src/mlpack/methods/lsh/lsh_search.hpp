@@ -189,6 +189,20 @@ class LSHSearch
              const size_t bucketSize = 500,
              const arma::cube& projection = arma::cube());
 
+  /**
+   * Add the given points to the reference set and to the hash tables, using
+   * the existing projections, offsets and second hash weights.  Only the new
+   * points are hashed; they get the indices after the existing reference
+   * points.  As in Train(), a point is not added to a bucket that already
+   * holds bucketSize points.  The reference set is copied into a new matrix
+   * (which the model owns from then on), so the reference set given to Train()
+   * is left unchanged.  A std::invalid_argument is thrown if the model is not
+   * trained or the points do not have the dimensionality of the reference set.
+   *
+   * @param newPoints Points to add to the reference set.
+   */
+  void Insert(const arma::mat& newPoints);
+
   /**
    * Compute the nearest neighbors of the points in the given query set and
    * store the output in the given matrices.  The matrices will be set to the
@@ -209,13 +223,17 @@ class LSHSearch
    *     considered.
    * @param T The number of additional probing bins to examine with multiprobe
    *     LSH. If T = 0, classic single-probe LSH is run (default).
+   * @param templateProbing If true, the additional probing bins are taken from
+   *     a probing sequence that is computed once for all queries (see
+   *     BuildProbingTemplate()), instead of a heap for each query and table.
    */
   void Search(const arma::mat& querySet,
               const size_t k,
               arma::Mat<size_t>& resultingNeighbors,
               arma::mat& distances,
               const size_t numTablesToSearch = 0,
-              const size_t T = 0);
+              const size_t T = 0,
+              const bool templateProbing = false);
 
   /**
    * Compute the nearest neighbors and store the output in the given matrices.
@@ -234,12 +252,18 @@ class LSHSearch
    *     available without having to build hashing for every table size.
    *     By default, this is set to zero in which case all tables are
    *     considered.
+   * @param T The number of additional probing bins to examine with multiprobe
+   *     LSH. If T = 0, classic single-probe LSH is run (default).
+   * @param templateProbing If true, the additional probing bins are taken from
+   *     a probing sequence that is computed once for all queries (see
+   *     BuildProbingTemplate()), instead of a heap for each query and table.
    */
   void Search(const size_t k,
               arma::Mat<size_t>& resultingNeighbors,
               arma::mat& distances,
               const size_t numTablesToSearch = 0,
-              size_t T = 0);
+              size_t T = 0,
+              const bool templateProbing = false);
 
   /**
    * Compute the recall (% of neighbors found) given the neighbors returned by
@@ -281,9 +305,25 @@ class LSHSearch
   //! Get the bucket size of the second hash.
   size_t BucketSize() const { return bucketSize; }
 
-  //! Get the second hash table.
-  const std::vector<arma::Col<size_t>>& SecondHashTable() const
-      { return secondHashTable; }
+  /**
+   * Get the second hash table, as one vector of reference point indices for
+   * each row.  The table is stored compactly (see BucketOffsets()), so this
+   * builds a copy.
+   */
+  std::vector<arma::Col<size_t>> SecondHashTable() const;
+
+  //! Get the number of rows (non-empty buckets) in the second hash table.
+  size_t NumBuckets() const
+  { return bucketOffsets.is_empty() ? 0 : bucketOffsets.n_elem - 1; }
+
+  //! Get the offsets of the rows of the second hash table: the points of row i
+  //! are BucketPoint(j) for j in [BucketOffsets()[i], BucketOffsets()[i + 1]).
+  const arma::Col<size_t>& BucketOffsets() const { return bucketOffsets; }
+
+  //! Get the index of the reference point at position i of the second hash
+  //! table (rows are stored one after another).
+  size_t BucketPoint(const size_t i) const
+  { return bucketPoints.is_empty() ? bucketPointsSmall[i] : bucketPoints[i]; }
 
   //! Get the projection tables.
   const arma::cube& Projections() { return projections; }
@@ -297,6 +337,21 @@ class LSHSearch
   }
 
  private:
+  /**
+   * A query-independent probing sequence for multiprobe LSH: T perturbation
+   * sets over the positions of the sorted scores of a query (see
+   * BuildProbingTemplate()).  Set i holds the positions
+   * positions[begins[i]], ..., positions[begins[i + 1] - 1].
+   */
+  struct ProbingTemplate
+  {
+    //! The positions of all of the sets, one set after another.
+    arma::Col<size_t> positions;
+    //! The index of the first position of each set (and the total number of
+    //! positions at the end).
+    arma::Col<size_t> begins;
+  };
+
   /**
    * This function takes a query and hashes it into each of the hash tables to
    * get keys for the query and then the key is hashed to a bucket of the second
@@ -318,6 +373,49 @@ class LSHSearch
                               size_t numTablesToSearch,
                               const size_t T) const;
 
+  /**
+   * Project the points with indices in [begin, end) into the first
+   * 'numTablesToSearch' tables, with one matrix multiplication, and add the
+   * offsets.  Column j of the codes holds the (numProj x numTablesToSearch)
+   * not-floored code matrix of point (begin + j), one table after another.
+   *
+   * @param points Set of points to project.
+   * @param begin Index of the first point to project.
+   * @param end One past the index of the last point to project.
+   * @param numTablesToSearch The number of tables to project into; must be at
+   *     least 1 and at most the number of tables.
+   * @param codes Matrix to store the codes in.
+   */
+  void ProjectPoints(const arma::mat& points,
+                     const size_t begin,
+                     const size_t end,
+                     const size_t numTablesToSearch,
+                     arma::mat& codes) const;
+
+  /**
+   * Given the not-floored codes of a query in each table (with the offsets
+   * added), hash the codes into the second hash table and collect all the
+   * points in those buckets as the neighbor candidates.  This is the part of
+   * ReturnIndicesFromTable() that comes after the projection of the query.
+   *
+   * @param queryCodesNotFloored Projections of the query in each table, one
+   *     column per table.
+   * @param referenceIndices The list of neighbor candidates.
+   * @param numTablesToSearch The number of tables to search in; must be at
+   *     least 1 and at most the number of tables.
+   * @param T The number of additional probing bins for multiprobe LSH. If 0,
+   *    single-probe is used.
+   * @param probingTemplate If given, the additional probing bins are taken
+   *    from this probing sequence (which must have T sets) with
+   *    GetTemplateProbingBins().
+   */
+  void ReturnIndicesFromCodes(
+      const arma::mat& queryCodesNotFloored,
+      arma::uvec& referenceIndices,
+      const size_t numTablesToSearch,
+      const size_t T,
+      const ProbingTemplate* probingTemplate = NULL) const;
+
   /**
    * This is a helper function that computes the distance of the query to the
    * neighbor candidates and appropriately stores the best 'k' candidates.  This
@@ -377,6 +475,44 @@ class LSHSearch
                                 const size_t T,
                                 arma::mat& additionalProbingBins) const;
 
+  /**
+   * Compute the query-directed probing sequence of Lv et al. (2007) that does
+   * not depend on the query.  When the 2 * numProj scores of a query (the
+   * squared distances of its projections to the boundaries of its bins) are
+   * sorted, sorted positions j and (2 * numProj - 1 - j) always belong to the
+   * same projection, so whether a perturbation set of sorted positions is
+   * valid does not depend on the query, and the expected value of the j'th
+   * smallest score for uniformly distributed projections is known.  The T
+   * valid sets with the smallest expected scores are generated here once, with
+   * the shift and expand operations, and GetTemplateProbingBins() maps them to
+   * the bins of each query.
+   *
+   * @param numProj The number of projections of each table.
+   * @param T The number of sets to generate (at most 2^numProj - 1).
+   * @param probingTemplate Probing sequence to store the sets in.
+   */
+  static void BuildProbingTemplate(const size_t numProj,
+                                   const size_t T,
+                                   ProbingTemplate& probingTemplate);
+
+  /**
+   * Compute the additional probing bins of a query from a probing sequence
+   * built by BuildProbingTemplate().  Only the distances of the projections of
+   * the query to their closest bin boundaries are sorted, so this takes
+   * O(numProj log(numProj)) time plus the size of the sequence.
+   *
+   * @param queryCode vector containing the numProj-dimensional query code.
+   * @param queryCodeNotFloored vector containing the projection location of the
+   *    query.
+   * @param probingTemplate The probing sequence.
+   * @param additionalProbingBins matrix. Each column will hold one additional
+   *    bin.
+   */
+  void GetTemplateProbingBins(const arma::vec& queryCode,
+                              const arma::vec& queryCodeNotFloored,
+                              const ProbingTemplate& probingTemplate,
+                              arma::mat& additionalProbingBins) const;
+
   /**
    * Returns the score of a perturbation vector generated by perturbation set A.
    * The score of a pertubation set (vector) is the sum of scores of the
@@ -415,6 +551,28 @@ class LSHSearch
    */
   bool PerturbationValid(const std::vector<bool>& A) const;
 
+  /**
+   * Compute the second-level hash (the bucket) of each of the given points in
+   * each table.
+   *
+   * @param points Points to hash.
+   * @param secondHashVectors Filled with the bucket of point j in table i at
+   *     (i, j).
+   */
+  void ComputeSecondHashes(const arma::mat& points,
+                           arma::Mat<size_t>& secondHashVectors) const;
+
+  /**
+   * Store the given rows as the second hash table, with 32-bit indices if the
+   * reference set has fewer than 2^32 points.  Only the first rowSizes[i]
+   * points of row i are kept.
+   *
+   * @param rows Reference point indices of each row.
+   * @param rowSizes Number of points to keep in each row.
+   */
+  void SetSecondHashTable(const std::vector<arma::Col<size_t>>& rows,
+                          const arma::Col<size_t>& rowSizes);
+
   //! Reference dataset.
   const arma::mat* referenceSet;
   //! If true, we own the reference set.
@@ -443,13 +601,18 @@ class LSHSearch
   //! The bucket size of the second hash.
   size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) vectors each with
-  //! (<= bucketSize) elements.
-  std::vector<arma::Col<size_t>> secondHashTable;
+  //! The final hash table has (< secondHashSize) rows, each with (<=
+  //! bucketSize) elements, stored one after another.  Row i starts at
+  //! bucketOffsets[i]; the last element is the total number of elements.
+  arma::Col<size_t> bucketOffsets;
+
+  //! The elements of the hash table, if the reference set has 2^32 points or
+  //! more (otherwise empty).
+  arma::Col<size_t> bucketPoints;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The elements of the hash table, if the reference set has fewer than 2^32
+  //! points (otherwise empty).  This halves the size of the table.
+  arma::Col<arma::u32> bucketPointsSmall;
 
   //! For a particular hash value, points to the row in secondHashTable
   //! corresponding to this value. Length secondHashSize.
@@ -458,6 +621,10 @@ class LSHSearch
   //! The number of distance evaluations.
   size_t distanceEvaluations;
 
+  //! The number of queries that Search() projects with one matrix
+  //! multiplication.
+  static const size_t queryBlockSize = 4096;
+
   //! Candidate represents a possible candidate neighbor (distance, index).
   typedef std::pair<double, size_t> Candidate;
 
@@ -479,7 +646,7 @@ class LSHSearch
 
 //! Set the serialization version of the LSHSearch class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::LSHSearch<SortPolicy>, 1);
+    mlpack::neighbor::LSHSearch<SortPolicy>, 2);
 
 // Include implementation.
 #include "lsh_search_impl.hpp"
@@ -90,8 +90,9 @@ LSHSearch<SortPolicy>::LSHSearch(const LSHSearch& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(other.secondHashWeights),
     bucketSize(other.bucketSize),
-    secondHashTable(other.secondHashTable),
-    bucketContentSize(other.bucketContentSize),
+    bucketOffsets(other.bucketOffsets),
+    bucketPoints(other.bucketPoints),
+    bucketPointsSmall(other.bucketPointsSmall),
     bucketRowInHashTable(other.bucketRowInHashTable),
     distanceEvaluations(other.distanceEvaluations)
 {
@@ -111,8 +112,9 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(std::move(other.secondHashWeights)),
     bucketSize(other.bucketSize),
-    secondHashTable(std::move(other.secondHashTable)),
-    bucketContentSize(std::move(other.bucketContentSize)),
+    bucketOffsets(std::move(other.bucketOffsets)),
+    bucketPoints(std::move(other.bucketPoints)),
+    bucketPointsSmall(std::move(other.bucketPointsSmall)),
     bucketRowInHashTable(std::move(other.bucketRowInHashTable)),
     distanceEvaluations(other.distanceEvaluations)
 {
@@ -144,8 +146,9 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(const LSHSearch& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = other.secondHashWeights;
   bucketSize = other.bucketSize;
-  secondHashTable = other.secondHashTable;
-  bucketContentSize = other.bucketContentSize;
+  bucketOffsets = other.bucketOffsets;
+  bucketPoints = other.bucketPoints;
+  bucketPointsSmall = other.bucketPointsSmall;
   bucketRowInHashTable = other.bucketRowInHashTable;
   distanceEvaluations = other.distanceEvaluations;
 
@@ -169,8 +172,9 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = std::move(other.secondHashWeights);
   bucketSize = other.bucketSize;
-  secondHashTable = std::move(other.secondHashTable);
-  bucketContentSize = std::move(other.bucketContentSize);
+  bucketOffsets = std::move(other.bucketOffsets);
+  bucketPoints = std::move(other.bucketPoints);
+  bucketPointsSmall = std::move(other.bucketPointsSmall);
   bucketRowInHashTable = std::move(other.bucketRowInHashTable);
   distanceEvaluations = other.distanceEvaluations;
 
@@ -282,9 +286,200 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
   }
 
   // We will store the second hash vectors in this matrix; the second hash
-  // vector for table i will be held in row i.  We have to use int and not
-  // size_t, otherwise negative numbers are cast to 0.
-  arma::Mat<size_t> secondHashVectors(numTables, referenceSet.n_cols);
+  // vector for table i will be held in row i.
+  arma::Mat<size_t> secondHashVectors;
+  ComputeSecondHashes(referenceSet, secondHashVectors);
+
+  // Now, using the hash vectors for each table, count the number of rows we
+  // have in the second hash table.
+  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
+  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
+    secondHashBinCounts[secondHashVectors[i]]++;
+
+  // Enforce the maximum bucket size.
+  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
+  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
+      { return std::min(val, effectiveBucketSize); });
+
+  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
+
+  // The rows are stored one after another.  First give each bucket its row, in
+  // the order in which the buckets are first seen, and find where each row
+  // starts.
+  bucketOffsets.set_size(numRowsInTable + 1);
+  bucketOffsets[0] = 0;
+  size_t currentRow = 0;
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      // This is the bucket number.
+      const size_t hashInd = (size_t) secondHashVectors(i, j);
+
+      // If this is currently an empty bucket, start a new row and keep track
+      // of which row corresponds to the bucket.
+      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      {
+        bucketRowInHashTable[hashInd] = currentRow;
+        bucketOffsets[currentRow + 1] = bucketOffsets[currentRow] +
+            secondHashBinCounts[hashInd];
+        currentRow++;
+      }
+    }
+  }
+
+  // Indices of 32 bits are enough for most reference sets.
+  const size_t totalPoints = bucketOffsets[numRowsInTable];
+  const bool smallIndices = (referenceSet.n_cols <=
+      (size_t) std::numeric_limits<arma::u32>::max());
+  bucketPoints.reset();
+  bucketPointsSmall.reset();
+  if (smallIndices)
+    bucketPointsSmall.set_size(totalPoints);
+  else
+    bucketPoints.set_size(totalPoints);
+
+  // Next we must assign each point in each table to its row, as long as the
+  // row is not full.
+  arma::Col<size_t> rowFill(numRowsInTable, arma::fill::zeros);
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      // The point ID is 'j'.
+      const size_t row = bucketRowInHashTable[secondHashVectors(i, j)];
+      if (bucketOffsets[row] + rowFill[row] < bucketOffsets[row + 1])
+      {
+        const size_t position = bucketOffsets[row] + rowFill[row]++;
+        if (smallIndices)
+          bucketPointsSmall[position] = (arma::u32) j;
+        else
+          bucketPoints[position] = j;
+      }
+    } // Loop over all points in the reference set.
+  } // Loop over tables.
+
+  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
+            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
+            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
+            << std::endl;
+}
+
+// Add points to the reference set and the hash tables.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Insert(const arma::mat& newPoints)
+{
+  if (projections.n_slices == 0)
+    throw std::invalid_argument("LSHSearch::Insert(): the model has not been "
+        "trained");
+  if (newPoints.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): dimensionality of new points ("
+        << newPoints.n_rows << ") is not equal to the dimensionality of the "
+        << "reference set (" << referenceSet->n_rows << ")";
+    throw std::invalid_argument(oss.str());
+  }
+  if (newPoints.n_cols == 0)
+    return;
+
+  const size_t oldSize = referenceSet->n_cols;
+  arma::mat* newSet = new arma::mat(arma::join_rows(*referenceSet, newPoints));
+  if (ownsSet)
+    delete referenceSet;
+  referenceSet = newSet;
+  ownsSet = true;
+
+  // Only the new points need to be hashed.
+  arma::Mat<size_t> secondHashVectors;
+  ComputeSecondHashes(newPoints, secondHashVectors);
+
+  // Find the row of each new point in each table, in the same order as
+  // Train() assigns them: buckets that were empty get new rows at the end, and
+  // full rows do not take more points.
+  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
+  const size_t oldRows = NumBuckets();
+  std::vector<size_t> rowSizes(oldRows);
+  for (size_t i = 0; i < oldRows; ++i)
+    rowSizes[i] = bucketOffsets[i + 1] - bucketOffsets[i];
+
+  std::vector<std::pair<size_t, size_t>> added; // (row, point) pairs.
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      const size_t hashInd = secondHashVectors(i, j);
+      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      {
+        bucketRowInHashTable[hashInd] = rowSizes.size();
+        rowSizes.push_back(0);
+      }
+
+      const size_t row = bucketRowInHashTable[hashInd];
+      if (rowSizes[row] < effectiveBucketSize)
+      {
+        ++rowSizes[row];
+        added.push_back(std::make_pair(row, oldSize + j));
+      }
+    }
+  }
+
+  // Now lay the table out again, with room for the new points after the old
+  // points of each row.
+  arma::Col<size_t> newOffsets(rowSizes.size() + 1);
+  newOffsets[0] = 0;
+  for (size_t i = 0; i < rowSizes.size(); ++i)
+    newOffsets[i + 1] = newOffsets[i] + rowSizes[i];
+
+  const bool smallIndices = (referenceSet->n_cols <=
+      (size_t) std::numeric_limits<arma::u32>::max());
+  arma::Col<size_t> newPointsLarge;
+  arma::Col<arma::u32> newPointsSmall;
+  if (smallIndices)
+    newPointsSmall.set_size(newOffsets[rowSizes.size()]);
+  else
+    newPointsLarge.set_size(newOffsets[rowSizes.size()]);
+
+  std::vector<size_t> rowFill(rowSizes.size(), 0);
+  for (size_t i = 0; i < oldRows; ++i)
+  {
+    rowFill[i] = bucketOffsets[i + 1] - bucketOffsets[i];
+    for (size_t j = 0; j < rowFill[i]; ++j)
+    {
+      const size_t point = BucketPoint(bucketOffsets[i] + j);
+      if (smallIndices)
+        newPointsSmall[newOffsets[i] + j] = (arma::u32) point;
+      else
+        newPointsLarge[newOffsets[i] + j] = point;
+    }
+  }
+
+  for (size_t i = 0; i < added.size(); ++i)
+  {
+    const size_t row = added[i].first;
+    const size_t position = newOffsets[row] + rowFill[row]++;
+    if (smallIndices)
+      newPointsSmall[position] = (arma::u32) added[i].second;
+    else
+      newPointsLarge[position] = added[i].second;
+  }
+
+  bucketOffsets = std::move(newOffsets);
+  bucketPoints = std::move(newPointsLarge);
+  bucketPointsSmall = std::move(newPointsSmall);
+
+  Log::Info << "Inserted " << newPoints.n_cols << " points; the hash table has "
+      << NumBuckets() << " rows, totaling " << bucketOffsets[NumBuckets()]
+      << " elements." << std::endl;
+}
+
+// Compute the second-level hash of each point in each table.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::ComputeSecondHashes(
+    const arma::mat& points,
+    arma::Mat<size_t>& secondHashVectors) const
+{
+  secondHashVectors.set_size(numTables, points.n_cols);
 
   for (size_t i = 0; i < numTables; i++)
   {
@@ -293,15 +488,15 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
 
     // The following code performs the task of hashing each point to a
     // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
+    // 'points.n_cols') key matrix.
     //
     // For a single table, let the 'numProj' projections be denoted by 'proj_i'
     // and the corresponding offset be 'offset_i'.  Then the key of a single
     // point is obtained as:
     // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
     arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       referenceSet.n_cols);
-    arma::mat hashMat = projections.slice(i).t() * (referenceSet);
+                                       points.n_cols);
+    arma::mat hashMat = projections.slice(i).t() * points;
     hashMat += offsetMat;
     hashMat /= hashWidth;
 
@@ -325,56 +520,6 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
       }
     }
   }
-
-  // Now, using the hash vectors for each table, count the number of rows we
-  // have in the second hash table.
-  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
-  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
-    secondHashBinCounts[secondHashVectors[i]]++;
-
-  // Enforce the maximum bucket size.
-  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
-  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
-      { return std::min(val, effectiveBucketSize); });
-
-  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
-  secondHashTable.resize(numRowsInTable);
-
-  // Next we must assign each point in each table to the right second hash
-  // table.
-  size_t currentRow = 0;
-  for (size_t i = 0; i < numTables; ++i)
-  {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVectors.n_cols; j++)
-    {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
-
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
-      if (bucketRowInHashTable[hashInd] == secondHashSize)
-      {
-        bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
-        currentRow++;
-      }
-
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
-
-  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
-            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
-            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
-            << std::endl;
 }
 
 // Base case where the query set is the reference set.  (So, we can't return
@@ -726,6 +871,134 @@ void LSHSearch<SortPolicy>::GetAdditionalProbingBins(
   }
 }
 
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::BuildProbingTemplate(
+    const size_t numProj,
+    const size_t T,
+    ProbingTemplate& probingTemplate)
+{
+  // The expected value of the j'th smallest score (for j = 1, ..., 2 numProj),
+  // in units of hashWidth^2, if the projections are uniformly distributed in
+  // their bins; see Section 4.5 of Lv et al. (2007).
+  const size_t m = numProj;
+  const double denominator = 4.0 * (m + 1) * (m + 2);
+  arma::vec expectedScores(2 * m);
+  for (size_t j = 1; j <= 2 * m; ++j)
+  {
+    if (j <= m)
+    {
+      expectedScores[j - 1] = j * (j + 1) / denominator;
+    }
+    else
+    {
+      const double r = 2.0 * m + 1 - j;
+      expectedScores[j - 1] = 1.0 - r / (m + 1) + r * (r + 1) / denominator;
+    }
+  }
+
+  // Generate the sets in increasing order of their expected scores with the
+  // shift and expand operations; each set of sorted positions is generated
+  // exactly once.  Invalid sets are not part of the sequence, but their
+  // children can be valid.
+  std::vector<std::vector<size_t>> sets(1, std::vector<size_t>(1, 0));
+  std::priority_queue<
+    std::pair<double, size_t>,
+    std::vector<std::pair<double, size_t>>,
+    std::greater<std::pair<double, size_t>>
+  > minHeap;
+  minHeap.push(std::make_pair(expectedScores[0], 0));
+
+  std::vector<size_t> positions;
+  std::vector<size_t> begins(1, 0);
+  while (begins.size() <= T && !minHeap.empty())
+  {
+    const double score = minHeap.top().first;
+    const std::vector<size_t> set = sets[minHeap.top().second];
+    minHeap.pop();
+
+    const size_t last = set.back();
+    if (last + 1 < 2 * m)
+    {
+      // Shift: replace the largest position with the next one.
+      std::vector<size_t> shifted(set);
+      shifted.back() = last + 1;
+      sets.push_back(shifted);
+      minHeap.push(std::make_pair(score - expectedScores[last] +
+          expectedScores[last + 1], sets.size() - 1));
+
+      // Expand: add the next position.
+      std::vector<size_t> expanded(set);
+      expanded.push_back(last + 1);
+      sets.push_back(expanded);
+      minHeap.push(std::make_pair(score + expectedScores[last + 1],
+          sets.size() - 1));
+    }
+
+    // Positions j and (2m - 1 - j) perturb the same projection.
+    bool valid = true;
+    for (size_t i = 0; i < set.size() && valid; ++i)
+    {
+      if (set[i] >= m)
+        valid = !std::binary_search(set.begin(), set.end(), 2 * m - 1 - set[i]);
+    }
+
+    if (valid)
+    {
+      positions.insert(positions.end(), set.begin(), set.end());
+      begins.push_back(positions.size());
+    }
+  }
+
+  probingTemplate.positions = arma::conv_to<arma::Col<size_t>>::from(
+      positions);
+  probingTemplate.begins = arma::conv_to<arma::Col<size_t>>::from(begins);
+}
+
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::GetTemplateProbingBins(
+    const arma::vec& queryCode,
+    const arma::vec& queryCodeNotFloored,
+    const ProbingTemplate& probingTemplate,
+    arma::mat& additionalProbingBins) const
+{
+  const size_t T = probingTemplate.begins.n_elem - 1;
+  additionalProbingBins.set_size(numProj, T);
+  additionalProbingBins.each_col() = queryCode;
+
+  // Find the closest bin boundary of each projection, and the action (-1/+1)
+  // that crosses it.  Sorting these distances sorts all the scores: the
+  // distance to the other boundary of projection order[j] is the score at
+  // sorted position (2 numProj - 1 - j).
+  arma::vec closest(numProj);
+  arma::Col<short int> actions(numProj);
+  for (size_t d = 0; d < numProj; ++d)
+  {
+    const double limLow = queryCodeNotFloored[d] - queryCode[d] * hashWidth;
+    const double limHigh = hashWidth - limLow;
+    closest[d] = std::min(limLow, limHigh);
+    actions[d] = (limLow <= limHigh) ? -1 : 1;
+  }
+  const arma::uvec order = arma::sort_index(closest);
+
+  for (size_t c = 0; c < T; ++c)
+  {
+    for (size_t i = probingTemplate.begins[c];
+         i < probingTemplate.begins[c + 1]; ++i)
+    {
+      const size_t p = probingTemplate.positions[i];
+      if (p < numProj)
+      {
+        additionalProbingBins(order[p], c) += actions[order[p]];
+      }
+      else
+      {
+        const size_t d = order[2 * numProj - 1 - p];
+        additionalProbingBins(d, c) -= actions[d];
+      }
+    }
+  }
+}
+
 template<typename SortPolicy>
 template<typename VecType>
 void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
@@ -749,13 +1022,47 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
   // vector.
 
   // Compute the projection of the query in each table.
-  arma::mat allProjInTables(numProj, numTablesToSearch);
   arma::mat queryCodesNotFloored(numProj, numTablesToSearch);
   for (size_t i = 0; i < numTablesToSearch; i++)
     queryCodesNotFloored.unsafe_col(i) = projections.slice(i).t() * queryPoint;
 
   queryCodesNotFloored += offsets.cols(0, numTablesToSearch - 1);
-  allProjInTables = arma::floor(queryCodesNotFloored / hashWidth);
+
+  ReturnIndicesFromCodes(queryCodesNotFloored, referenceIndices,
+      numTablesToSearch, T);
+}
+
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::ProjectPoints(const arma::mat& points,
+                                          const size_t begin,
+                                          const size_t end,
+                                          const size_t numTablesToSearch,
+                                          arma::mat& codes) const
+{
+  // The slices of the projections cube are stored one after another, so the
+  // projections of the first 'numTablesToSearch' tables form one
+  // (dimensionality x (numProj * numTablesToSearch)) matrix, and all points can
+  // be projected into all tables with one matrix multiplication.  Column j of
+  // the result then holds the codes of point (begin + j) in the layout
+  // ReturnIndicesFromCodes() expects: numProj rows for each table, one table
+  // after another.
+  const arma::mat allProjections(const_cast<double*>(projections.memptr()),
+      projections.n_rows, numProj * numTablesToSearch, false, true);
+
+  codes = allProjections.t() * points.cols(begin, end - 1);
+  codes.each_col() += arma::vectorise(offsets.cols(0, numTablesToSearch - 1));
+}
+
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::ReturnIndicesFromCodes(
+    const arma::mat& queryCodesNotFloored,
+    arma::uvec& referenceIndices,
+    const size_t numTablesToSearch,
+    const size_t T,
+    const ProbingTemplate* probingTemplate) const
+{
+  const arma::mat allProjInTables = arma::floor(queryCodesNotFloored /
+      hashWidth);
 
   // Use hashMat to store the primary probing codes and any additional codes
   // from multiprobe LSH.
@@ -777,10 +1084,20 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     {
       // Construct this table's probing sequence of length T.
       arma::mat additionalProbingBins;
-      GetAdditionalProbingBins(allProjInTables.unsafe_col(i),
-                                queryCodesNotFloored.unsafe_col(i),
-                                T,
-                                additionalProbingBins);
+      if (probingTemplate)
+      {
+        GetTemplateProbingBins(allProjInTables.unsafe_col(i),
+                               queryCodesNotFloored.unsafe_col(i),
+                               *probingTemplate,
+                               additionalProbingBins);
+      }
+      else
+      {
+        GetAdditionalProbingBins(allProjInTables.unsafe_col(i),
+                                  queryCodesNotFloored.unsafe_col(i),
+                                  T,
+                                  additionalProbingBins);
+      }
 
       // Map each probing bin to a bin in secondHashTable (just like we did for
       // the primary hash table).
@@ -792,6 +1109,10 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     }
   }
 
+  // The rows of the hash table hold 32-bit indices unless the reference set is
+  // very large.
+  const bool smallIndices = bucketPoints.is_empty();
+
   // Count number of points hashed in the same bucket as the query.
   size_t maxNumPoints = 0;
   for (size_t i = 0; i < numTablesToSearch; ++i)
@@ -800,8 +1121,8 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     {
       const size_t hashInd = hashMat(p, i); // find query's bucket
       const size_t tableRow = bucketRowInHashTable[hashInd];
-      if (tableRow < secondHashSize)
-        maxNumPoints += bucketContentSize[tableRow]; // count bucket contents
+      if (tableRow < secondHashSize) // count bucket contents
+        maxNumPoints += bucketOffsets[tableRow + 1] - bucketOffsets[tableRow];
     }
   }
 
@@ -832,11 +1153,20 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
         size_t hashInd = hashMat(p, i);
         size_t tableRow = bucketRowInHashTable[hashInd];
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
+        if (tableRow < secondHashSize)
         {
           // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
+          const size_t end = bucketOffsets[tableRow + 1];
+          if (smallIndices)
+          {
+            for (size_t j = bucketOffsets[tableRow]; j < end; ++j)
+              refPointsConsidered[bucketPointsSmall[j]]++;
+          }
+          else
+          {
+            for (size_t j = bucketOffsets[tableRow]; j < end; ++j)
+              refPointsConsidered[bucketPoints[j]]++;
+          }
         }
       }
     }
@@ -866,9 +1196,18 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
         if (tableRow < secondHashSize)
         {
           // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
-       }
+          const size_t end = bucketOffsets[tableRow + 1];
+          if (smallIndices)
+          {
+            for (size_t j = bucketOffsets[tableRow]; j < end; ++j)
+              refPointsConsideredSmall(start++) = bucketPointsSmall[j];
+          }
+          else
+          {
+            for (size_t j = bucketOffsets[tableRow]; j < end; ++j)
+              refPointsConsideredSmall(start++) = bucketPoints[j];
+          }
+        }
       }
     }
 
@@ -885,7 +1224,8 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
                                    arma::Mat<size_t>& resultingNeighbors,
                                    arma::mat& distances,
                                    const size_t numTablesToSearch,
-                                   const size_t T)
+                                   const size_t T,
+                                   const bool templateProbing)
 {
   // Ensure the dimensionality of the query set is correct.
   if (querySet.n_rows != referenceSet->n_rows)
@@ -930,38 +1270,61 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
     Log::Info << "Running multiprobe LSH with " << Teffective
         <<" additional probing bins per table per query." << std::endl;
 
+  // The probing sequence of template probing is the same for every query.
+  ProbingTemplate probingTemplate;
+  if (templateProbing && Teffective > 0)
+    BuildProbingTemplate(numProj, Teffective, probingTemplate);
+  const ProbingTemplate* templatePtr = (templateProbing && Teffective > 0) ?
+      &probingTemplate : NULL;
+
+  // Decide on the number of tables to look into.
+  const size_t tablesToSearch = (numTablesToSearch == 0 ||
+      numTablesToSearch > numTables) ? numTables : numTablesToSearch;
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+  // The queries are projected into all tables one block at a time, with one
+  // matrix multiplication per block; the block size bounds the memory used
+  // for the codes.
+  arma::mat blockCodes;
+  for (size_t begin = 0; begin < querySet.n_cols; begin += queryBlockSize)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    const size_t end = std::min(begin + queryBlockSize,
+        (size_t) querySet.n_cols);
+    ProjectPoints(querySet, begin, end, tablesToSearch, blockCodes);
+
+    // Parallelization to process more than one query at a time.
+    #pragma omp parallel for num_threads(ParallelThreads()) \
+        shared(resultingNeighbors, distances, blockCodes) \
+        schedule(dynamic)\
+        reduction(+:avgIndicesReturned)
+    for (omp_size_t i = (omp_size_t) begin; i < (omp_size_t) end; ++i)
+    {
+      // Go through every query point.
+      // Look up the codes of the query in every hash table in the
+      // 'secondHashTable' to obtain the neighbor candidates.
+      const arma::mat queryCodes(blockCodes.colptr(i - begin), numProj,
+          tablesToSearch, false, true);
+      arma::uvec refIndices;
+      ReturnIndicesFromCodes(queryCodes, refIndices, tablesToSearch,
+          Teffective, templatePtr);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
 
   distanceEvaluations += avgIndicesReturned;
+  Timer::Count("distance_evaluations", avgIndicesReturned);
   avgIndicesReturned /= querySet.n_cols;
   Log::Info << avgIndicesReturned << " distinct indices returned on average." <<
       std::endl;
@@ -974,7 +1337,8 @@ Search(const size_t k,
        arma::Mat<size_t>& resultingNeighbors,
        arma::mat& distances,
        const size_t numTablesToSearch,
-       size_t T)
+       size_t T,
+       const bool templateProbing)
 {
   // This is monochromatic search; the query set is the reference set.
   resultingNeighbors.set_size(k, referenceSet->n_cols);
@@ -996,38 +1360,60 @@ Search(const size_t k,
     Log::Info << "Running multiprobe LSH with " << Teffective <<
       " additional probing bins per table per query."<< std::endl;
 
+  // The probing sequence of template probing is the same for every query.
+  ProbingTemplate probingTemplate;
+  if (templateProbing && Teffective > 0)
+    BuildProbingTemplate(numProj, Teffective, probingTemplate);
+  const ProbingTemplate* templatePtr = (templateProbing && Teffective > 0) ?
+      &probingTemplate : NULL;
+
+  // Decide on the number of tables to look into.
+  const size_t tablesToSearch = (numTablesToSearch == 0 ||
+      numTablesToSearch > numTables) ? numTables : numTablesToSearch;
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+  // The queries are projected into all tables one block at a time, as in the
+  // bichromatic search.
+  arma::mat blockCodes;
+  for (size_t begin = 0; begin < referenceSet->n_cols; begin += queryBlockSize)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet->col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    const size_t end = std::min(begin + queryBlockSize,
+        (size_t) referenceSet->n_cols);
+    ProjectPoints(*referenceSet, begin, end, tablesToSearch, blockCodes);
+
+    // Parallelization to process more than one query at a time.
+    #pragma omp parallel for num_threads(ParallelThreads()) \
+        shared(resultingNeighbors, distances, blockCodes) \
+        schedule(dynamic)\
+        reduction(+:avgIndicesReturned)
+    for (omp_size_t i = (omp_size_t) begin; i < (omp_size_t) end; ++i)
+    {
+      // Go through every query point.
+      // Look up the codes of the query in every hash table in the
+      // 'secondHashTable' to obtain the neighbor candidates.
+      const arma::mat queryCodes(blockCodes.colptr(i - begin), numProj,
+          tablesToSearch, false, true);
+      arma::uvec refIndices;
+      ReturnIndicesFromCodes(queryCodes, refIndices, tablesToSearch,
+          Teffective, templatePtr);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned += refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
 
   distanceEvaluations += avgIndicesReturned;
+  Timer::Count("distance_evaluations", avgIndicesReturned);
   avgIndicesReturned /= referenceSet->n_cols;
   Log::Info << avgIndicesReturned << " distinct indices returned on average." <<
       std::endl;
@@ -1106,6 +1492,23 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
   ar & CreateNVP(bucketSize, "bucketSize");
   // needs specific handling for new version
 
+  // Since version 2, the second hash table is stored as it is held: the offsets
+  // of the rows and the elements of all rows.
+  if (version >= 2)
+  {
+    ar & CreateNVP(bucketOffsets, "bucketOffsets");
+    ar & CreateNVP(bucketPoints, "bucketPoints");
+    ar & CreateNVP(bucketPointsSmall, "bucketPointsSmall");
+    ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+    ar & CreateNVP(distanceEvaluations, "distanceEvaluations");
+    return;
+  }
+
+  // Older versions can only be loaded; the rows are loaded separately, then
+  // packed.
+  std::vector<arma::Col<size_t>> secondHashTable;
+  arma::Col<size_t> bucketContentSize;
+
   // Backward compatibility: in older versions of LSHSearch, the secondHashTable
   // was stored as an arma::Mat<size_t>.  So we need to properly load that, then
   // prune it down to size.
@@ -1138,16 +1541,8 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
   else
   {
     size_t tables;
-    if (Archive::is_saving::value)
-      tables = secondHashTable.size();
     ar & CreateNVP(tables, "numSecondHashTables");
-
-    // Set size of second hash table if needed.
-    if (Archive::is_loading::value)
-    {
-      secondHashTable.clear();
-      secondHashTable.resize(tables);
-    }
+    secondHashTable.resize(tables);
 
     for (size_t i = 0; i < secondHashTable.size(); ++i)
     {
@@ -1170,7 +1565,7 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
     ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
 
     // Compress into a smaller vector by just dropping all of the zeros.
-    bucketContentSize.set_size(secondHashTable.size());
+    bucketContentSize.zeros(secondHashTable.size());
     for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
       if (tmpBucketContentSize[i] > 0)
         bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
@@ -1181,9 +1576,57 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
     ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
   }
 
+  SetSecondHashTable(secondHashTable, bucketContentSize);
+
   ar & CreateNVP(distanceEvaluations, "distanceEvaluations");
 }
 
+template<typename SortPolicy>
+std::vector<arma::Col<size_t>> LSHSearch<SortPolicy>::SecondHashTable() const
+{
+  std::vector<arma::Col<size_t>> rows(NumBuckets());
+  for (size_t i = 0; i < rows.size(); ++i)
+  {
+    rows[i].set_size(bucketOffsets[i + 1] - bucketOffsets[i]);
+    for (size_t j = 0; j < rows[i].n_elem; ++j)
+      rows[i][j] = BucketPoint(bucketOffsets[i] + j);
+  }
+
+  return rows;
+}
+
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::SetSecondHashTable(
+    const std::vector<arma::Col<size_t>>& rows,
+    const arma::Col<size_t>& rowSizes)
+{
+  bucketOffsets.set_size(rows.size() + 1);
+  bucketOffsets[0] = 0;
+  for (size_t i = 0; i < rows.size(); ++i)
+    bucketOffsets[i + 1] = bucketOffsets[i] +
+        std::min((size_t) rows[i].n_elem, (size_t) rowSizes[i]);
+
+  const bool smallIndices = (referenceSet->n_cols <=
+      (size_t) std::numeric_limits<arma::u32>::max());
+  bucketPoints.reset();
+  bucketPointsSmall.reset();
+  if (smallIndices)
+    bucketPointsSmall.set_size(bucketOffsets[rows.size()]);
+  else
+    bucketPoints.set_size(bucketOffsets[rows.size()]);
+
+  for (size_t i = 0; i < rows.size(); ++i)
+  {
+    for (size_t j = 0; j < bucketOffsets[i + 1] - bucketOffsets[i]; ++j)
+    {
+      if (smallIndices)
+        bucketPointsSmall[bucketOffsets[i] + j] = (arma::u32) rows[i][j];
+      else
+        bucketPoints[bucketOffsets[i] + j] = rows[i][j];
+    }
+  }
+}
+
 } // namespace neighbor
 } // namespace mlpack
 
@@ -27,6 +27,10 @@ namespace meanshift /** Mean shift clustering. */ {
  * apply mean shift algorithm until maximum iterations or convergence.  Then
  * remove duplicate centroids.
  *
+ * All seeds are shifted together with one reference tree, which is built once;
+ * the range searches of each step are divided between the threads available
+ * to OpenMP.  The duplicate centroids are also found with a tree.
+ *
  * A simple example of how to run mean shift clustering is shown below.
  *
  * @code
@@ -121,34 +125,24 @@ class MeanShift
                 MatType& seeds);
 
   /**
-   * Use kernel to calculate new centroid given dataset and valid neighbors.
+   * Use kernel to calculate the weight of a neighbor at the given distance
+   * from the current centroid.  The centroid itself has weight zero.
    *
-   * @param data The whole dataset
-   * @param neighbors Valid neighbors
-   * @param distances Distances to neighbors
-   # @param centroid Store calculated centroid
+   * @param distance Distance of the neighbor to the centroid.
    */
   template<bool ApplyKernel = UseKernel>
-  typename std::enable_if<ApplyKernel, bool>::type
-  CalculateCentroid(const MatType& data,
-                    const std::vector<size_t>& neighbors,
-                    const std::vector<double>& distances,
-                    arma::colvec& centroid);
+  typename std::enable_if<ApplyKernel, double>::type
+  Weight(const double distance) const;
 
   /**
-   * Use mean to calculate new centroid given dataset and valid neighbors.
+   * Give every neighbor the same weight, so that the new centroid is the mean
+   * of the neighbors.
    *
-   * @param data The whole dataset
-   * @param neighbors Valid neighbors
-   * @param distances Distances to neighbors
-   # @param centroid Store calculated centroid
+   * @param distance Distance of the neighbor to the centroid (unused).
    */
   template<bool ApplyKernel = UseKernel>
-  typename std::enable_if<!ApplyKernel, bool>::type
-  CalculateCentroid(const MatType& data,
-                    const std::vector<size_t>& neighbors,
-                    const std::vector<double>&, /*unused*/
-                    arma::colvec& centroid);
+  typename std::enable_if<!ApplyKernel, double>::type
+  Weight(const double distance) const;
 
   /**
    * If distance of two centroids is less than radius, one will be removed.
@@ -129,51 +129,28 @@ void MeanShift<UseKernel, KernelType, MatType>::GenSeeds(
   seeds *= binSize;
 }
 
-// Calculate new centroid with given kernel.
+// Calculate the weight of a neighbor with the given kernel.
 template<bool UseKernel, typename KernelType, typename MatType>
 template<bool ApplyKernel>
-typename std::enable_if<ApplyKernel, bool>::type
-MeanShift<UseKernel, KernelType, MatType>::
-CalculateCentroid(const MatType& data,
-                  const std::vector<size_t>& neighbors,
-                  const std::vector<double>& distances,
-                  arma::colvec& centroid)
+typename std::enable_if<ApplyKernel, double>::type
+MeanShift<UseKernel, KernelType, MatType>::Weight(const double distance) const
 {
-  double sumWeight = 0;
-  for (size_t i = 0; i < neighbors.size(); ++i)
-  {
-    if (distances[i] > 0)
-    {
-      double dist = distances[i] / radius;
-      double weight = kernel.Gradient(dist) / dist;
-      sumWeight += weight;
-      centroid += weight * data.unsafe_col(neighbors[i]);
-    }
-  }
+  // The centroid itself does not take part in the weighted mean.
+  if (distance <= 0)
+    return 0.0;
 
-  if (sumWeight != 0)
-  {
-    centroid /= sumWeight;
-    return true;
-  }
-  return false;
+  const double dist = distance / radius;
+  return kernel.Gradient(dist) / dist;
 }
 
-// Calculate new centroid by mean.
+// Every neighbor has the same weight in the mean.
 template<bool UseKernel, typename KernelType, typename MatType>
 template<bool ApplyKernel>
-typename std::enable_if<!ApplyKernel, bool>::type
-MeanShift<UseKernel, KernelType, MatType>::
-CalculateCentroid(const MatType& data,
-                  const std::vector<size_t>& neighbors,
-                  const std::vector<double>&, /*unused*/
-                  arma::colvec& centroid)
+typename std::enable_if<!ApplyKernel, double>::type
+MeanShift<UseKernel, KernelType, MatType>::Weight(
+    const double /* distance */) const
 {
-  for (size_t i = 0; i < neighbors.size(); ++i)
-    centroid += data.unsafe_col(neighbors[i]);
-
-  centroid /= neighbors.size();
-  return true;
+  return 1.0;
 }
 
 /**
@@ -201,65 +178,120 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
     pSeeds = &seeds;
   }
 
-  // Holds all centroids before removing duplicate ones.
-  arma::mat allCentroids(pSeeds->n_rows, pSeeds->n_cols);
+  // Holds all centroids before removing duplicate ones.  Initially, each
+  // centroid is its seed.
+  arma::mat allCentroids(*pSeeds);
+  std::vector<bool> converged(pSeeds->n_cols, false);
 
   assignments.set_size(data.n_cols);
 
-  range::RangeSearch<> rangeSearcher(data);
-  math::Range validRadius(0, radius);
-  std::vector<std::vector<size_t> > neighbors;
-  std::vector<std::vector<double> > distances;
+  // The reference tree is built only once.  The seeds are shifted together,
+  // one step per iteration, and single-tree search divides them between the
+  // threads, without building a tree on them; each seed still takes the same
+  // steps as if it were shifted alone.
+  range::RangeSearch<> rangeSearcher(data, false, true);
+  const math::Range validRadius(0, radius);
+
+  // The seeds that have neither converged nor been given up yet.
+  std::vector<size_t> active(pSeeds->n_cols);
+  for (size_t i = 0; i < active.size(); ++i)
+    active[i] = i;
 
-  // For each seed, perform mean shift algorithm.
-  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  for (size_t completedIterations = 0; completedIterations < maxIterations &&
+       !active.empty(); completedIterations++)
   {
-    // Initial centroid is the seed itself.
-    allCentroids.col(i) = pSeeds->unsafe_col(i);
-    for (size_t completedIterations = 0; completedIterations < maxIterations;
-         completedIterations++)
+    arma::mat oldCentroids(data.n_rows, active.size());
+    for (size_t k = 0; k < active.size(); ++k)
+      oldCentroids.col(k) = allCentroids.col(active[k]);
+
+    // Sum up the weighted neighbors of each centroid as soon as they are
+    // found, so that the neighborhoods are never stored.  The callback is
+    // never called for the same centroid from two threads at once.
+    arma::mat sums(data.n_rows, active.size(), arma::fill::zeros);
+    arma::vec sumWeights(active.size(), arma::fill::zeros);
+    arma::Col<size_t> counts(active.size(), arma::fill::zeros);
+    auto addNeighbor = [&](const size_t k, const size_t j,
+        const double distance)
     {
-      // Store new centroid in this.
-      arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
+      ++counts[k];
+      const double weight = Weight(distance);
+      if (weight != 0.0)
+      {
+        sums.col(k) += weight * data.col(j);
+        sumWeights[k] += weight;
+      }
+    };
+    rangeSearcher.Search(oldCentroids, validRadius, addNeighbor);
 
-      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
-          neighbors, distances);
-      if (neighbors[0].size() <= 1)
-        break;
+    std::vector<size_t> stillActive;
+    for (size_t k = 0; k < active.size(); ++k)
+    {
+      // Give up on seeds without neighbors.
+      if (counts[k] <= 1)
+        continue;
 
       // Calculate new centroid.
-      if (!CalculateCentroid(data, neighbors[0], distances[0], newCentroid))
-        newCentroid = allCentroids.unsafe_col(i);
+      arma::colvec newCentroid = oldCentroids.col(k);
+      if (sumWeights[k] != 0.0)
+        newCentroid = sums.col(k) / sumWeights[k];
 
       // If the mean shift vector is small enough, it has converged.
       if (metric::EuclideanDistance::Evaluate(newCentroid,
-          allCentroids.unsafe_col(i)) < 1e-3 * radius)
+          oldCentroids.col(k)) < 1e-3 * radius)
       {
-        // Determine if the new centroid is duplicate with old ones.
-        bool isDuplicated = false;
-        for (size_t k = 0; k < centroids.n_cols; ++k)
-        {
-          const double distance = metric::EuclideanDistance::Evaluate(
-              allCentroids.unsafe_col(i), centroids.unsafe_col(k));
-          if (distance < radius)
-          {
-            isDuplicated = true;
-            break;
-          }
-        }
-
-        if (!isDuplicated)
-          centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
-
-        // Get out of the loop.
-        break;
+        converged[active[k]] = true;
+        continue;
       }
 
       // Update the centroid.
-      allCentroids.col(i) = newCentroid;
+      allCentroids.col(active[k]) = newCentroid;
+      stillActive.push_back(active[k]);
     }
+
+    active.swap(stillActive);
   }
 
+  // Collect the converged centroids, in the order of their seeds.
+  std::vector<size_t> convergedSeeds;
+  for (size_t i = 0; i < converged.size(); ++i)
+    if (converged[i])
+      convergedSeeds.push_back(i);
+
+  arma::mat candidates(data.n_rows, convergedSeeds.size());
+  for (size_t k = 0; k < convergedSeeds.size(); ++k)
+    candidates.col(k) = allCentroids.col(convergedSeeds[k]);
+
+  // Remove duplicate centroids: in the order of their seeds, a centroid is
+  // kept unless it is closer than the radius to a centroid that was kept
+  // before.  The close pairs are found with one tree-based range search.
+  std::vector<bool> kept(candidates.n_cols, true);
+  if (candidates.n_cols > 1)
+  {
+    range::RangeSearch<> merger(candidates);
+    std::vector<std::vector<size_t>> neighbors;
+    std::vector<std::vector<double>> distances;
+    merger.Search(validRadius, neighbors, distances);
+
+    for (size_t k = 0; k < candidates.n_cols; ++k)
+    {
+      for (size_t j = 0; j < neighbors[k].size(); ++j)
+      {
+        if (neighbors[k][j] < k && kept[neighbors[k][j]] &&
+            distances[k][j] < radius)
+        {
+          kept[k] = false;
+          break;
+        }
+      }
+    }
+  }
+
+  centroids.set_size(data.n_rows, std::count(kept.begin(), kept.end(), true));
+  size_t numCentroids = 0;
+  for (size_t k = 0; k < candidates.n_cols; ++k)
+    if (kept[k])
+      centroids.col(numCentroids++) = candidates.col(k);
+
   // Assign centroids to each point.
   neighbor::KNN neighborSearcher(centroids);
   arma::mat neighborDistances;
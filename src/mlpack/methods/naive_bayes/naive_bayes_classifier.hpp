@@ -105,6 +105,10 @@ class NaiveBayesClassifier
    * classes, either re-initialize or call Means(), Variances(), and
    * Probabilities() individually to set them to the right size.
    *
+   * With the incremental algorithm, the data may be one mini-batch of a
+   * stream: the statistics of the batch are merged into the model, giving the
+   * same model as training on each of its points with Train(point, label).
+   *
    * @param data The dataset to train on.
    * @param labels The labels for the dataset.
    * @param numClasses The numbe of classes in the dataset.
@@ -228,7 +232,9 @@ class NaiveBayesClassifier
   /**
    * Compute the unnormalized posterior log probability of given points (log
    * likelihood). Results are returned as arma::mat, and each column represents
-   * a point, each row represents log likelihood of a class.
+   * a point, each row represents log likelihood of a class.  The log
+   * likelihoods of a block of points for all classes are computed with two
+   * matrix multiplications, and the blocks are computed in parallel.
    *
    * @param data Set of points to compute posterior log probability for.
    * @param logLikelihoods Matrix to store log likelihoods in.
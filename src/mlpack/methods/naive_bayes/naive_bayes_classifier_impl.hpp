@@ -105,24 +105,57 @@ void NaiveBayesClassifier<ModelMatType>::Train(
   // for each of the features with respect to each of the labels.
   if (incremental)
   {
-    // Use incremental algorithm.
+    // Use incremental algorithm.  The data is a mini-batch: first its own
+    // statistics are computed with the two-pass algorithm, then they are merged
+    // into the model with the parallel form of Welford's algorithm (Chan et
+    // al.), which gives the same model as training on each point in turn.
     // Fist, de-normalize probabilities.
     probabilities *= trainingPoints;
 
+    ModelMatType batchCounts(numClasses, 1, arma::fill::zeros);
+    ModelMatType batchMeans(data.n_rows, numClasses, arma::fill::zeros);
+    ModelMatType batchSquares(data.n_rows, numClasses, arma::fill::zeros);
     for (size_t j = 0; j < data.n_cols; ++j)
     {
       const size_t label = labels[j];
-      ++probabilities[label];
+      ++batchCounts[label];
+      batchMeans.col(label) += data.col(j);
+    }
+
+    for (size_t i = 0; i < numClasses; ++i)
+      if (batchCounts[i] != 0.0)
+        batchMeans.col(i) /= batchCounts[i];
 
-      arma::vec delta = data.col(j) - means.col(label);
-      means.col(label) += delta / probabilities[label];
-      variances.col(label) += delta % (data.col(j) - means.col(label));
+    for (size_t j = 0; j < data.n_cols; ++j)
+    {
+      const size_t label = labels[j];
+      batchSquares.col(label) += square(data.col(j) - batchMeans.col(label));
     }
 
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
+    for (size_t i = 0; i < numClasses; ++i)
     {
-      if (probabilities[i] > 2)
-        variances.col(i) /= (probabilities[i] - 1);
+      if (batchCounts[i] == 0.0)
+        continue;
+
+      const ElemType oldCount = probabilities[i];
+      const ElemType count = oldCount + batchCounts[i];
+
+      // De-normalize the variance into a sum of squared differences to the
+      // mean.
+      ModelMatType squares = variances.col(i);
+      if (oldCount > 1)
+        squares *= (oldCount - 1);
+      else
+        squares.zeros();
+
+      const ModelMatType delta = batchMeans.col(i) - means.col(i);
+      means.col(i) += delta * (batchCounts[i] / count);
+      squares += batchSquares.col(i) + square(delta) *
+          (oldCount * batchCounts[i] / count);
+
+      variances.col(i) = (count > 1) ? ModelMatType(squares / (count - 1)) :
+          squares;
+      probabilities[i] = count;
     }
   }
   else
@@ -169,8 +202,9 @@ void NaiveBayesClassifier<ModelMatType>::Train(
     if (variances[i] == 0.0)
       variances[i] = 1e-50;
 
-  probabilities /= data.n_cols;
+  // In incremental mode, the class counts include the points seen before.
   trainingPoints += data.n_cols;
+  probabilities /= (incremental ? trainingPoints : data.n_cols);
 }
 
 template<typename ModelMatType>
@@ -208,23 +242,45 @@ void NaiveBayesClassifier<ModelMatType>::LogLikelihood(
       "NaiveBayesClassifier: element type of given data must match the element "
       "type of the model!");
 
-  logLikelihoods = arma::log(arma::repmat(probabilities, 1, data.n_cols));
-  ModelMatType invVar = 1.0 / variances;
+  // This is an adaptation of gmm::phi() for the case where the covariance is
+  // a diagonal matrix.  The exponent of the Gaussian of class c at point x is
+  //
+  //   -0.5 sum_d (x_d - mu_cd)^2 / var_cd
+  //     = -0.5 (x % x)^T invVar_c + x^T (mu_c % invVar_c) + const_c,
+  //
+  // so the log likelihoods of all the points for all the classes take two
+  // matrix multiplications.  The points and means are first shifted by the
+  // average of the means, so that the terms do not cancel badly when the data
+  // is far from the origin.
+  const ModelMatType center = arma::mean(means, 1);
+  const ModelMatType invVar = 1.0 / variances;
+  const ModelMatType shiftedMeans = means.each_col() - center.col(0);
+  const ModelMatType scaledMeans = shiftedMeans % invVar;
+
+  // The terms that do not depend on the point: the log prior, the
+  // normalization of the Gaussian, and the part of the exponent with the mean
+  // only.
+  const ModelMatType constants = arma::log(probabilities) + (data.n_rows /
+      -2.0 * log(2 * M_PI)) - 0.5 * arma::sum(arma::log(variances), 0).t() -
+      0.5 * arma::sum(shiftedMeans % scaledMeans, 0).t();
+
+  // The points are processed in blocks of columns, in parallel.
+  const size_t blockSize = 1024;
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+  logLikelihoods.set_size(means.n_cols, data.n_cols);
+
+  #pragma omp parallel for schedule(dynamic) if (numBlocks > 1)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) data.n_cols) - 1;
 
-  // Calculate the joint log likelihood of point for each of the
-  // means.n_cols.
+    ModelMatType points = data.cols(begin, end);
+    points.each_col() -= center.col(0);
 
-  // Loop over every class.
-  for (size_t i = 0; i < means.n_cols; i++)
-  {
-    // This is an adaptation of gmm::phi() for the case where the covariance is
-    // a diagonal matrix.
-    ModelMatType diffs = data - arma::repmat(means.col(i), 1, data.n_cols);
-    ModelMatType rhs = -0.5 * arma::diagmat(invVar.col(i)) * diffs;
-    arma::Mat<ElemType> exponents = arma::sum(diffs % rhs, 0);
-
-    logLikelihoods.row(i) += (data.n_rows / -2.0 * log(2 * M_PI) - 0.5 *
-        std::log(arma::det(arma::diagmat(variances.col(i)))) + exponents);
+    logLikelihoods.cols(begin, end) = scaledMeans.t() * points -
+        0.5 * invVar.t() * arma::square(points);
+    logLikelihoods.cols(begin, end).each_col() += constants.col(0);
   }
 }
 
@@ -290,7 +346,8 @@ void NaiveBayesClassifier<ModelMatType>::Classify(
   ModelMatType logLikelihoods;
   LogLikelihood(data, logLikelihoods);
 
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
   {
     arma::uword maxIndex = 0;
     logLikelihoods.unsafe_col(i).max(maxIndex);
@@ -318,23 +375,20 @@ void NaiveBayesClassifier<ModelMatType>::Classify(
   ModelMatType logLikelihoods;
   LogLikelihood(data, logLikelihoods);
 
-  // This will hold log(Prob(X)) for each point.
-  arma::Col<ElemType> logProbX(data.n_cols);
-  for (size_t j = 0; j < data.n_cols; ++j)
+  // Normalize by log(Prob(X)) for each point, and find the class with the
+  // maximum probability.
+  #pragma omp parallel for
+  for (omp_size_t j = 0; j < (omp_size_t) data.n_cols; ++j)
   {
-    logProbX(j) = log(arma::accu(exp(logLikelihoods.col(j))));
-    logLikelihoods.col(j) -= logProbX(j);
-  }
+    const ElemType logProbX = log(arma::accu(exp(logLikelihoods.col(j))));
+    logLikelihoods.col(j) -= logProbX;
 
-  predictionProbs = arma::exp(logLikelihoods);
-
-  // Now calculate maximum probabilities for each point.
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
     arma::uword maxIndex;
-    logLikelihoods.unsafe_col(i).max(maxIndex);
-    predictions[i] = maxIndex;
+    logLikelihoods.unsafe_col(j).max(maxIndex);
+    predictions[j] = maxIndex;
   }
+
+  predictionProbs = arma::exp(logLikelihoods);
 }
 
 template<typename ModelMatType>
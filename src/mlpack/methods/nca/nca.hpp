@@ -17,6 +17,7 @@
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
 
 #include "nca_softmax_error_function.hpp"
+#include "nca_approx_softmax_error_function.hpp"
 
 namespace mlpack {
 namespace nca /** Neighborhood Components Analysis. */ {
@@ -43,9 +44,13 @@ namespace nca /** Neighborhood Components Analysis. */ {
  *   year = {2004}
  * }
  * @endcode
+ *
+ * The error function is SoftmaxErrorFunction by default; on large datasets,
+ * ApproxSoftmaxErrorFunction only sums the terms of close pairs of points.
  */
 template<typename MetricType = metric::SquaredEuclideanDistance,
-         typename OptimizerType = optimization::StandardSGD>
+         typename OptimizerType = optimization::StandardSGD,
+         template<typename> class ErrorFunctionType = SoftmaxErrorFunction>
 class NCA
 {
  public:
@@ -82,6 +87,12 @@ class NCA
   //! Get the labels reference.
   const arma::Row<size_t>& Labels() const { return labels; }
 
+  //! Get the error function.
+  const ErrorFunctionType<MetricType>& ErrorFunction() const
+  { return errorFunction; }
+  //! Modify the error function.
+  ErrorFunctionType<MetricType>& ErrorFunction() { return errorFunction; }
+
   //! Get the optimizer.
   const OptimizerType& Optimizer() const { return optimizer; }
   OptimizerType& Optimizer() { return optimizer; }
@@ -96,7 +107,7 @@ class NCA
   MetricType metric;
 
   //! The function to optimize.
-  SoftmaxErrorFunction<MetricType> errorFunction;
+  ErrorFunctionType<MetricType> errorFunction;
 
   //! The optimizer to use.
   OptimizerType optimizer;
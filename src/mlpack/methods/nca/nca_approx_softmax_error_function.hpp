@@ -0,0 +1,200 @@
+/**
+ * @file nca_approx_softmax_error_function.hpp
+ *
+ * An approximation of the softmax error function of NCA that only sums the
+ * terms of the pairs of points that are close after the transformation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NCA_NCA_APPROX_SOFTMAX_ERROR_FUNCTION_HPP
+#define MLPACK_METHODS_NCA_NCA_APPROX_SOFTMAX_ERROR_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace nca {
+
+/**
+ * An approximation of the "softmax" stochastic neighbor assignment probability
+ * function (see SoftmaxErrorFunction), where the sums over pairs of points only
+ * include the pairs whose distance after the transformation, d(A x_i, A x_k),
+ * is at most the given cutoff.  The terms of the other pairs are below
+ * exp(-cutoff), so they are negligible for the default cutoff, and the error
+ * and its gradient take time proportional to the number of close pairs instead
+ * of n^2.
+ *
+ * The close pairs are found with a range search on a kd-tree of the
+ * transformed points, with a radius a little larger than the cutoff.  The
+ * candidates are kept as long as the transformation cannot have moved any pair
+ * of points by more than that margin, which is checked from the change of A
+ * alone (so it costs O(d^2)); only then is the tree rebuilt.  So the
+ * separable Evaluate() and Gradient(), used by SGD, only transform the point
+ * and its candidates.  A point without candidates has p_i = 0, and no
+ * gradient.
+ *
+ * The metric has to be an L2 metric (squared or not), since the candidates are
+ * found with the Euclidean distance.
+ *
+ * @code
+ * NCA<SquaredEuclideanDistance, StandardSGD, ApproxSoftmaxErrorFunction>
+ *     nca(data, labels);
+ * nca.ErrorFunction().Cutoff() = 15;
+ * nca.LearnDistance(distance);
+ * @endcode
+ */
+template<typename MetricType = metric::SquaredEuclideanDistance>
+class ApproxSoftmaxErrorFunction
+{
+ public:
+  static_assert(MetricType::Power == 2, "ApproxSoftmaxErrorFunction: the "
+      "metric must be an L2 metric");
+
+  /**
+   * Initialize the error function.
+   *
+   * @param dataset Matrix containing the dataset.
+   * @param labels Vector of class labels for each point in the dataset.
+   * @param metric Instantiated metric (optional).
+   * @param cutoff Largest distance between transformed points whose term is
+   *     kept (in the units of the metric).
+   * @param margin Euclidean distance that is added to the radius of the range
+   *     search for the candidates, so that they can be kept while A changes.
+   */
+  ApproxSoftmaxErrorFunction(const arma::mat& dataset,
+                             const arma::Row<size_t>& labels,
+                             MetricType metric = MetricType(),
+                             const double cutoff = 20.0,
+                             const double margin = 1.0);
+
+  /**
+   * Evaluate the approximate softmax function for the given covariance matrix.
+   * This is the non-separable implementation.
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   */
+  double Evaluate(const arma::mat& covariance);
+
+  /**
+   * Evaluate the approximate softmax objective function for the given
+   * covariance matrix on only one point of the dataset.
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   * @param i Index of point to use for objective function.
+   */
+  double Evaluate(const arma::mat& covariance, const size_t i);
+
+  /**
+   * Evaluate the gradient of the approximate softmax function for the given
+   * covariance matrix.  This is the non-separable implementation.
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   * @param gradient Matrix to store the calculated gradient in.
+   */
+  void Gradient(const arma::mat& covariance, arma::mat& gradient);
+
+  /**
+   * Evaluate the gradient of the approximate softmax function for the given
+   * covariance matrix on only one point of the dataset.
+   *
+   * @param covariance Covariance matrix of Mahalanobis distance.
+   * @param i Index of point to use for objective function.
+   * @param gradient Matrix to store the calculated gradient in.
+   */
+  template<typename GradType>
+  void Gradient(const arma::mat& covariance,
+                const size_t i,
+                GradType& gradient);
+
+  /**
+   * Get the initial point.
+   */
+  const arma::mat GetInitialPoint() const;
+
+  /**
+   * Get the number of functions the objective function can be decomposed into.
+   * This is just the number of points in the dataset.
+   */
+  size_t NumFunctions() const { return dataset.n_cols; }
+
+  //! Get the cutoff distance.
+  double Cutoff() const { return cutoff; }
+  //! Modify the cutoff distance (the candidates are found again).
+  double& Cutoff() { searched = false; return cutoff; }
+
+  //! Get the margin of the range search.
+  double Margin() const { return margin; }
+  //! Modify the margin of the range search (the candidates are found again).
+  double& Margin() { searched = false; return margin; }
+
+  //! Get the number of range searches done so far.
+  size_t NumSearches() const { return numSearches; }
+
+ private:
+  //! The dataset.
+  const arma::mat& dataset;
+  //! Labels for each point in the dataset.
+  const arma::Row<size_t>& labels;
+
+  //! The instantiated metric.
+  MetricType metric;
+
+  //! The largest distance whose term is kept.
+  double cutoff;
+  //! The margin of the range search.
+  double margin;
+
+  //! The largest distance of a point to the mean of the dataset.
+  double datasetRadius;
+
+  //! The candidates of each point, found with searchCoordinates.
+  std::vector<std::vector<size_t>> candidates;
+  //! The coordinates the candidates were found with.
+  arma::mat searchCoordinates;
+  //! Whether candidates were found for the current parameters.
+  bool searched;
+  //! The number of range searches done so far.
+  size_t numSearches;
+
+  //! Last coordinates.  Used for the non-separable Evaluate() and Gradient().
+  arma::mat lastCoordinates;
+  //! Stretched dataset, for the non-separable Evaluate() and Gradient().
+  arma::mat stretchedDataset;
+  //! Holds calculated p_i, for the non-separable Evaluate() and Gradient().
+  arma::vec p;
+  //! Holds denominators for calculation of p_ij, for the non-separable
+  //! Evaluate() and Gradient().
+  arma::vec denominators;
+  //! False if nothing has ever been precalculated (only at construction time).
+  bool precalculated;
+
+  /**
+   * Find the candidates of each point again, unless they are still valid with
+   * the given coordinates: the distance between any two transformed points
+   * changes by at most ||A - A_0||_F * ||x_i - x_k||, which is at most
+   * ||A - A_0||_F * 2 * datasetRadius.
+   *
+   * @param coordinates Current coordinates.
+   */
+  void UpdateCandidates(const arma::mat& coordinates);
+
+  /**
+   * Precalculate p_i and the denominators for all points, if the coordinates
+   * are different than the last ones.  This is used by the non-separable
+   * Evaluate() and Gradient().
+   *
+   * @param coordinates Coordinates matrix to use for precalculation.
+   */
+  void Precalculate(const arma::mat& coordinates);
+};
+
+} // namespace nca
+} // namespace mlpack
+
+// Include implementation.
+#include "nca_approx_softmax_error_function_impl.hpp"
+
+#endif
@@ -0,0 +1,282 @@
+/**
+ * @file nca_approx_softmax_error_function_impl.hpp
+ *
+ * Implementation of the approximate softmax error function of NCA.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NCA_NCA_APPROX_SOFTMAX_ERROR_FUNCTION_IMPL_HPP
+#define MLPACK_METHODS_NCA_NCA_APPROX_SOFTMAX_ERROR_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included already.
+#include "nca_approx_softmax_error_function.hpp"
+
+#include <mlpack/methods/range_search/range_search.hpp>
+
+namespace mlpack {
+namespace nca {
+
+template<typename MetricType>
+ApproxSoftmaxErrorFunction<MetricType>::ApproxSoftmaxErrorFunction(
+    const arma::mat& dataset,
+    const arma::Row<size_t>& labels,
+    MetricType metric,
+    const double cutoff,
+    const double margin) :
+    dataset(dataset),
+    labels(labels),
+    metric(metric),
+    cutoff(cutoff),
+    margin(margin),
+    datasetRadius(0.0),
+    searched(false),
+    numSearches(0),
+    precalculated(false)
+{
+  if (dataset.n_cols > 0)
+  {
+    const arma::vec mean = arma::mean(dataset, 1);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      datasetRadius = std::max(datasetRadius,
+          arma::norm(dataset.col(i) - mean, 2));
+    }
+  }
+}
+
+template<typename MetricType>
+double ApproxSoftmaxErrorFunction<MetricType>::Evaluate(
+    const arma::mat& coordinates)
+{
+  Precalculate(coordinates);
+
+  return -arma::accu(p); // Negate because the optimizer is a minimizer.
+}
+
+template<typename MetricType>
+double ApproxSoftmaxErrorFunction<MetricType>::Evaluate(
+    const arma::mat& coordinates,
+    const size_t i)
+{
+  UpdateCandidates(coordinates);
+
+  // Only the point and its candidates are transformed.
+  const arma::vec stretchedPoint = coordinates * dataset.col(i);
+  double numerator = 0;
+  double denominator = 0;
+  for (size_t j = 0; j < candidates[i].size(); ++j)
+  {
+    const size_t k = candidates[i][j];
+    const double eval = std::exp(-metric.Evaluate(stretchedPoint,
+        arma::vec(coordinates * dataset.col(k))));
+
+    if (labels[i] == labels[k])
+      numerator += eval;
+
+    denominator += eval;
+  }
+
+  if (denominator == 0.0)
+    return 0;
+
+  return -(numerator / denominator);
+}
+
+template<typename MetricType>
+void ApproxSoftmaxErrorFunction<MetricType>::Gradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient)
+{
+  Precalculate(coordinates);
+
+  // This is the sum of SoftmaxErrorFunction::Gradient(), over the pairs of
+  // candidates (each pair once).
+  ReductionPartials<arma::mat> partials(dataset.n_cols,
+      arma::mat(dataset.n_rows, dataset.n_rows, arma::fill::zeros));
+
+  #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads())
+  for (omp_size_t chunk = 0; chunk < (omp_size_t) partials.Chunks(); ++chunk)
+  {
+    arma::mat& localSum = partials.Partial(chunk);
+    for (size_t i = partials.Begin(chunk); i < partials.End(chunk); ++i)
+    {
+      for (size_t j = 0; j < candidates[i].size(); ++j)
+      {
+        const size_t k = candidates[i][j];
+        if (k < i)
+          continue;
+
+        const double eval = std::exp(-metric.Evaluate(
+            stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(k)));
+        const double p_ik = eval / denominators[i];
+        const double p_ki = eval / denominators[k];
+
+        const arma::vec x_ik = dataset.col(i) - dataset.col(k);
+        if (labels[i] == labels[k])
+        {
+          localSum += ((p[i] - 1) * p_ik + (p[k] - 1) * p_ki) *
+              (x_ik * x_ik.t());
+        }
+        else
+        {
+          localSum += (p[i] * p_ik + p[k] * p_ki) * (x_ik * x_ik.t());
+        }
+      }
+    }
+  }
+
+  arma::mat sum;
+  partials.Reduce(sum, [](arma::mat& a, const arma::mat& b) { a += b; });
+
+  gradient = -2 * coordinates * sum;
+}
+
+template<typename MetricType>
+template<typename GradType>
+void ApproxSoftmaxErrorFunction<MetricType>::Gradient(
+    const arma::mat& coordinates,
+    const size_t i,
+    GradType& gradient)
+{
+  UpdateCandidates(coordinates);
+
+  double numerator = 0;
+  double denominator = 0;
+
+  GradType firstTerm;
+  GradType secondTerm;
+  firstTerm.zeros(coordinates.n_cols, coordinates.n_cols);
+  secondTerm.zeros(coordinates.n_cols, coordinates.n_cols);
+
+  const arma::vec stretchedPoint = coordinates * dataset.col(i);
+  for (size_t j = 0; j < candidates[i].size(); ++j)
+  {
+    const size_t k = candidates[i][j];
+    const double eval = std::exp(-metric.Evaluate(stretchedPoint,
+        arma::vec(coordinates * dataset.col(k))));
+
+    // As in SoftmaxErrorFunction, x_ik is not stretched.
+    GradType x_ik = dataset.col(i) - dataset.col(k);
+    if (labels[i] == labels[k])
+    {
+      numerator += eval;
+      secondTerm += eval * x_ik * trans(x_ik);
+    }
+
+    denominator += eval;
+    firstTerm += eval * x_ik * trans(x_ik);
+  }
+
+  // A point without candidates does not contribute to the gradient.
+  if (denominator == 0)
+  {
+    gradient.zeros(coordinates.n_rows, coordinates.n_cols);
+    return;
+  }
+
+  const double p = numerator / denominator;
+  firstTerm /= denominator;
+  secondTerm /= denominator;
+
+  gradient = -2 * coordinates * (p * firstTerm - secondTerm);
+}
+
+template<typename MetricType>
+const arma::mat ApproxSoftmaxErrorFunction<MetricType>::GetInitialPoint() const
+{
+  return arma::eye<arma::mat>(dataset.n_rows, dataset.n_rows);
+}
+
+template<typename MetricType>
+void ApproxSoftmaxErrorFunction<MetricType>::UpdateCandidates(
+    const arma::mat& coordinates)
+{
+  if (searched && coordinates.n_rows == searchCoordinates.n_rows &&
+      coordinates.n_cols == searchCoordinates.n_cols &&
+      arma::norm(coordinates - searchCoordinates, "fro") * 2 * datasetRadius
+      <= margin)
+    return;
+
+  searchCoordinates = coordinates;
+
+  // The terms that are kept have a Euclidean distance of at most the radius.
+  const double radius = MetricType::TakeRoot ? cutoff : std::sqrt(cutoff);
+
+  candidates.clear();
+  candidates.resize(dataset.n_cols);
+
+  // In single-tree mode, the callback is called from several threads, but
+  // never for the same point at once.
+  range::RangeSearch<> rangeSearch(arma::mat(coordinates * dataset), false,
+      true);
+  auto addCandidate = [this](const size_t queryIndex,
+                             const size_t referenceIndex,
+                             const double /* distance */)
+  {
+    candidates[queryIndex].push_back(referenceIndex);
+  };
+  rangeSearch.Search(math::Range(0.0, radius + margin), addCandidate);
+
+  searched = true;
+  ++numSearches;
+
+  // The sums have to be computed again with the new candidates.
+  precalculated = false;
+}
+
+template<typename MetricType>
+void ApproxSoftmaxErrorFunction<MetricType>::Precalculate(
+    const arma::mat& coordinates)
+{
+  UpdateCandidates(coordinates);
+
+  // Make sure the calculation is necessary.
+  if (precalculated && coordinates.n_rows == lastCoordinates.n_rows &&
+      coordinates.n_cols == lastCoordinates.n_cols &&
+      arma::accu(coordinates == lastCoordinates) == coordinates.n_elem)
+    return;
+
+  lastCoordinates = coordinates;
+  stretchedDataset = coordinates * dataset;
+
+  // Each point only sums its own terms, so that the points can be handled in
+  // parallel.
+  p.zeros(dataset.n_cols);
+  denominators.zeros(dataset.n_cols);
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
+  {
+    for (size_t j = 0; j < candidates[i].size(); ++j)
+    {
+      const size_t k = candidates[i][j];
+      const double eval = std::exp(-metric.Evaluate(
+          stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(k)));
+
+      denominators[i] += eval;
+      if (labels[i] == labels[k])
+        p[i] += eval;
+    }
+
+    if (denominators[i] == 0.0)
+    {
+      // Set to usable values.
+      denominators[i] = std::numeric_limits<double>::infinity();
+      p[i] = 0;
+    }
+    else
+    {
+      p[i] /= denominators[i];
+    }
+  }
+
+  precalculated = true;
+}
+
+} // namespace nca
+} // namespace mlpack
+
+#endif
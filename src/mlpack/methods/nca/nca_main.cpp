@@ -89,7 +89,14 @@ PROGRAM_INFO("Neighborhood Components Analysis (NCA)",
     "mlpack L-BFGS documentation (in lbfgs.hpp) or the vast set of published "
     "literature on L-BFGS."
     "\n\n"
-    "By default, the SGD optimizer is used.");
+    "By default, the SGD optimizer is used."
+    "\n\n"
+    "On large datasets, the error function can be approximated by only "
+    "considering the pairs of points that are close after the transformation: "
+    "if the " + PRINT_PARAM_STRING("cutoff") + " parameter is positive, the "
+    "terms of the pairs whose distance is larger than the cutoff are dropped.  "
+    "The close pairs are found with a kd-tree, which is only rebuilt when the "
+    "transformation changes enough.");
 
 PARAM_MATRIX_IN_REQ("input", "Input dataset to run NCA on.", "i");
 PARAM_MATRIX_OUT("output", "Output matrix for learned distance matrix.", "o");
@@ -123,6 +130,12 @@ PARAM_DOUBLE_IN("min_step", "Minimum step of line search for L-BFGS.", "m",
 PARAM_DOUBLE_IN("max_step", "Maximum step of line search for L-BFGS.", "M",
     1e20);
 
+PARAM_DOUBLE_IN("cutoff", "If positive, only the pairs of points whose "
+    "distance after the transformation is at most this cutoff are used to "
+    "compute the error function and its gradient (the pairs are found with a "
+    "kd-tree).",
+    "C", 0.0);
+
 PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
 using namespace mlpack;
@@ -131,6 +144,76 @@ using namespace mlpack::metric;
 using namespace mlpack::optimization;
 using namespace std;
 
+// The exact error function has no cutoff.
+template<typename MetricType>
+void SetCutoff(SoftmaxErrorFunction<MetricType>& /* errorFunction */) { }
+
+template<typename MetricType>
+void SetCutoff(ApproxSoftmaxErrorFunction<MetricType>& errorFunction)
+{
+  errorFunction.Cutoff() = CLI::GetParam<double>("cutoff");
+}
+
+// Run NCA with the given error function and the optimizer and parameters
+// given on the command line.
+template<template<typename> class ErrorFunctionType>
+void LearnDistance(const arma::mat& data,
+                   const arma::Row<size_t>& labels,
+                   arma::mat& distance)
+{
+  const string optimizerType = CLI::GetParam<string>("optimizer");
+  const double stepSize = CLI::GetParam<double>("step_size");
+  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  const bool shuffle = !CLI::HasParam("linear_scan");
+  const int numBasis = CLI::GetParam<int>("num_basis");
+  const double armijoConstant = CLI::GetParam<double>("armijo_constant");
+  const double wolfe = CLI::GetParam<double>("wolfe");
+  const int maxLineSearchTrials = CLI::GetParam<int>("max_line_search_trials");
+  const double minStep = CLI::GetParam<double>("min_step");
+  const double maxStep = CLI::GetParam<double>("max_step");
+  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
+
+  if (optimizerType == "sgd")
+  {
+    NCA<LMetric<2>, StandardSGD, ErrorFunctionType> nca(data, labels);
+    nca.Optimizer().StepSize() = stepSize;
+    nca.Optimizer().MaxIterations() = maxIterations;
+    nca.Optimizer().Tolerance() = tolerance;
+    nca.Optimizer().Shuffle() = shuffle;
+
+    SetCutoff(nca.ErrorFunction());
+    nca.LearnDistance(distance);
+  }
+  else if (optimizerType == "lbfgs")
+  {
+    NCA<LMetric<2>, L_BFGS, ErrorFunctionType> nca(data, labels);
+    nca.Optimizer().NumBasis() = numBasis;
+    nca.Optimizer().MaxIterations() = maxIterations;
+    nca.Optimizer().ArmijoConstant() = armijoConstant;
+    nca.Optimizer().Wolfe() = wolfe;
+    nca.Optimizer().MinGradientNorm() = tolerance;
+    nca.Optimizer().MaxLineSearchTrials() = maxLineSearchTrials;
+    nca.Optimizer().MinStep() = minStep;
+    nca.Optimizer().MaxStep() = maxStep;
+
+    SetCutoff(nca.ErrorFunction());
+    nca.LearnDistance(distance);
+  }
+  else if (optimizerType == "minibatch-sgd")
+  {
+    NCA<LMetric<2>, MiniBatchSGD, ErrorFunctionType> nca(data, labels);
+    nca.Optimizer().StepSize() = stepSize;
+    nca.Optimizer().MaxIterations() = maxIterations;
+    nca.Optimizer().Tolerance() = tolerance;
+    nca.Optimizer().Shuffle() = shuffle;
+    nca.Optimizer().BatchSize() = batchSize;
+
+    SetCutoff(nca.ErrorFunction());
+    nca.LearnDistance(distance);
+  }
+}
+
 void mlpackMain()
 {
   if (CLI::GetParam<int>("seed") != 0)
@@ -196,18 +279,7 @@ void mlpackMain()
           << "optimizer)." << endl;
   }
 
-  const double stepSize = CLI::GetParam<double>("step_size");
-  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
-  const double tolerance = CLI::GetParam<double>("tolerance");
   const bool normalize = CLI::HasParam("normalize");
-  const bool shuffle = !CLI::HasParam("linear_scan");
-  const int numBasis = CLI::GetParam<int>("num_basis");
-  const double armijoConstant = CLI::GetParam<double>("armijo_constant");
-  const double wolfe = CLI::GetParam<double>("wolfe");
-  const int maxLineSearchTrials = CLI::GetParam<int>("max_line_search_trials");
-  const double minStep = CLI::GetParam<double>("min_step");
-  const double maxStep = CLI::GetParam<double>("max_step");
-  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
 
   // Load data.
   arma::mat data = std::move(CLI::GetParam<arma::mat>("input"));
@@ -253,41 +325,10 @@ void mlpackMain()
   }
 
   // Now create the NCA object and run the optimization.
-  if (optimizerType == "sgd")
-  {
-    NCA<LMetric<2> > nca(data, labels);
-    nca.Optimizer().StepSize() = stepSize;
-    nca.Optimizer().MaxIterations() = maxIterations;
-    nca.Optimizer().Tolerance() = tolerance;
-    nca.Optimizer().Shuffle() = shuffle;
-
-    nca.LearnDistance(distance);
-  }
-  else if (optimizerType == "lbfgs")
-  {
-    NCA<LMetric<2>, L_BFGS> nca(data, labels);
-    nca.Optimizer().NumBasis() = numBasis;
-    nca.Optimizer().MaxIterations() = maxIterations;
-    nca.Optimizer().ArmijoConstant() = armijoConstant;
-    nca.Optimizer().Wolfe() = wolfe;
-    nca.Optimizer().MinGradientNorm() = tolerance;
-    nca.Optimizer().MaxLineSearchTrials() = maxLineSearchTrials;
-    nca.Optimizer().MinStep() = minStep;
-    nca.Optimizer().MaxStep() = maxStep;
-
-    nca.LearnDistance(distance);
-  }
-  else if (optimizerType == "minibatch-sgd")
-  {
-    NCA<LMetric<2>, MiniBatchSGD> nca(data, labels);
-    nca.Optimizer().StepSize() = stepSize;
-    nca.Optimizer().MaxIterations() = maxIterations;
-    nca.Optimizer().Tolerance() = tolerance;
-    nca.Optimizer().Shuffle() = shuffle;
-    nca.Optimizer().BatchSize() = batchSize;
-
-    nca.LearnDistance(distance);
-  }
+  if (CLI::GetParam<double>("cutoff") > 0.0)
+    LearnDistance<ApproxSoftmaxErrorFunction>(data, labels, distance);
+  else
+    LearnDistance<SoftmaxErrorFunction>(data, labels, distance);
 
   // Save the output.
   if (CLI::HasParam("output"))
@@ -15,12 +15,18 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/core/data/query_server.hpp>
+#include <mlpack/core/data/batch_writer.hpp>
+#include <mlpack/core/data/process_batches.hpp>
 
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
 
 #include "neighbor_search.hpp"
+#include "nn_descent.hpp"
 #include "unmap.hpp"
 #include "ns_model.hpp"
 
@@ -56,6 +62,11 @@ PROGRAM_INFO("k-Nearest-Neighbors Search",
 
 // Define our input parameters that this program will take.
 PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_STRING_IN("sparse_reference_file", "File containing a sparse reference "
+    "dataset in coordinate list format (one 'row column value' line for each "
+    "nonzero element, with zero-based indices), to use instead of "
+    "--reference_file.  Only kd-trees and ball trees can be built on sparse "
+    "data.", "", "");
 PARAM_MATRIX_OUT("distances", "Matrix to output distances into.", "d");
 PARAM_UMATRIX_OUT("neighbors", "Matrix to output neighbors into.", "n");
 PARAM_MATRIX_IN("true_distances", "Matrix of true distances to compute "
@@ -68,11 +79,30 @@ PARAM_UMATRIX_IN("true_neighbors", "Matrix of true neighbors to compute the "
 PARAM_MODEL_IN(KNNModel, "input_model", "Pre-trained kNN model.", "m");
 PARAM_MODEL_OUT(KNNModel, "output_model", "If specified, the kNN model will be "
     "output here.", "M");
+PARAM_STRING_IN("input_index_file", "Pre-trained kNN model saved as a flat "
+    "index with --output_index_file; it is memory-mapped instead of loaded.  "
+    "If --reference_file (-r) is also given, it must hold the reference set "
+    "the model was built on, which is used instead of the one in the index "
+    "(if any).", "", "");
+PARAM_STRING_IN("output_index_file", "If specified, the kNN model will be "
+    "saved here as a flat index (only for kd-trees and ball trees).", "", "");
+PARAM_FLAG("index_without_reference", "If true, the reference set is left out "
+    "of the index saved with --output_index_file, which must then be loaded "
+    "with the same --reference_file (-r).", "");
 
 // The user may specify a query file of query points and a number of nearest
 // neighbors to search for.
 PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
+PARAM_STRING_IN("sparse_query_file", "File containing sparse query points in "
+    "coordinate list format, to use instead of --query_file (optional).", "",
+    "");
 PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 0);
+PARAM_INT_IN("query_batch_size", "If greater than 0, the query points of "
+    "--query_file are searched for in batches of this many points, and the "
+    "results are written batch by batch; the next batches are read and the "
+    "results of the previous batches are written while a batch is searched "
+    "for, so neither the query set nor the results have to fit in memory.  The "
+    "output files must be CSV or raw ASCII files.", "", 0);
 
 // The user may specify the type of tree to use, and a few parameters for tree
 // building.
@@ -90,11 +120,16 @@ PARAM_DOUBLE_IN("rho", "Balance threshold (only valid for spill trees).", "b",
 
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_FLAG("single_precision", "If true, the reference set and the tree are "
+    "stored in single precision, which halves their memory footprint.  Only "
+    "available for kd-trees, ball trees and octrees.", "");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+    "'dual_tree', 'greedy', 'nn_descent'.  'nn_descent' approximates the "
+    "nearest neighbors of the reference set itself with NN-Descent, without "
+    "any tree, which is faster for high-dimensional data.", "a", "dual_tree");
 PARAM_FLAG("naive", "(Deprecated) If true, O(n^2) naive mode is used for "
     "computation. Will be removed in mlpack 3.0.0. Use '--algorithm naive' "
     "instead.", "N");
@@ -103,6 +138,347 @@ PARAM_FLAG("single_mode", "(Deprecated) If true, single-tree search is used "
     "'--algorithm single_tree' instead.", "S");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate nearest neighbor "
     "search with given relative error.", "e", 0);
+PARAM_INT_IN("max_iterations", "Maximum number of iterations of NN-Descent "
+    "(only valid for '--algorithm nn_descent').", "", 10);
+PARAM_DOUBLE_IN("sample_rate", "Fraction of the new neighbors of each point "
+    "that NN-Descent compares in each iteration (only valid for '--algorithm "
+    "nn_descent').", "", 1.0);
+PARAM_DOUBLE_IN("tolerance", "NN-Descent stops once fewer than this fraction "
+    "of the neighbors are replaced in an iteration (only valid for "
+    "'--algorithm nn_descent').", "", 0.001);
+
+// Serving settings.
+PARAM_FLAG("serve", "If true, the program does not exit after the model is "
+    "built or loaded, but answers batches of query points (with --k neighbors "
+    "each) that are sent on standard input until the input ends, writing the "
+    "results to standard output.  All pending batches are answered with a "
+    "single search.  See the QueryServer class for the format of requests and "
+    "responses.", "");
+PARAM_STRING_IN("serve_socket", "If specified with --serve, batches of query "
+    "points are read from the clients of a Unix domain socket at this path "
+    "instead of standard input.", "", "");
+PARAM_INT_IN("serve_batch_size", "Maximum number of query points that --serve "
+    "searches at once.", "", 100000);
+
+// Get the size of the reference set of the model, whatever its precision.
+void ReferenceSize(const KNNModel& knn, size_t& rows, size_t& cols)
+{
+  if (knn.Sparse())
+  {
+    rows = knn.SparseDataset().n_rows;
+    cols = knn.SparseDataset().n_cols;
+    return;
+  }
+
+  rows = knn.SinglePrecision() ? knn.SinglePrecisionDataset().n_rows :
+      knn.Dataset().n_rows;
+  cols = knn.SinglePrecision() ? knn.SinglePrecisionDataset().n_cols :
+      knn.Dataset().n_cols;
+}
+
+// Load the dense reference set given with --reference_file.
+arma::mat LoadReference()
+{
+  arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
+
+  Log::Info << "Loaded reference data from '"
+      << CLI::GetPrintableParam<arma::mat>("reference") << "' ("
+      << referenceSet.n_rows << " x " << referenceSet.n_cols << ")." << endl;
+  return referenceSet;
+}
+
+// Load a sparse matrix in coordinate list format.  The file only tells the
+// largest row index, so the matrix is given at least the given number of rows.
+arma::sp_mat LoadSparse(const string& filename, const size_t minRows = 0)
+{
+  arma::sp_mat matrix;
+  if (!matrix.load(filename, arma::coord_ascii))
+    Log::Fatal << "Cannot load sparse matrix from '" << filename << "'!"
+        << endl;
+
+  if (matrix.n_rows < minRows)
+    matrix.resize(minRows, matrix.n_cols);
+
+  Log::Info << "Loaded sparse matrix from '" << filename << "' ("
+      << matrix.n_rows << " x " << matrix.n_cols << ", " << matrix.n_nonzero
+      << " nonzeros)." << endl;
+  return matrix;
+}
+
+// Answer batches of query points until no more arrive.
+void Serve(KNNModel& knn, const size_t k)
+{
+  std::unique_ptr<data::QueryServer> server;
+  try
+  {
+    if (CLI::HasParam("serve_socket"))
+      server.reset(new data::QueryServer(
+          CLI::GetParam<string>("serve_socket")));
+    else
+      server.reset(new data::QueryServer());
+  }
+  catch (std::exception& e)
+  {
+    Log::Fatal << "Cannot serve queries: " << e.what() << endl;
+  }
+
+  size_t referenceRows, referenceCols;
+  ReferenceSize(knn, referenceRows, referenceCols);
+  const size_t maxPoints = (size_t) CLI::GetParam<int>("serve_batch_size");
+
+  std::vector<data::QueryServer::Request> requests;
+  while (server->Collect(requests, maxPoints))
+  {
+    // Requests with the wrong dimensionality are answered with an error.
+    std::vector<std::string> errors(requests.size());
+    size_t numPoints = 0;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+      if (requests[i].points.n_rows != referenceRows &&
+          requests[i].points.n_cols > 0)
+      {
+        std::ostringstream oss;
+        oss << "query points have " << requests[i].points.n_rows
+            << " dimensions, but the reference points have " << referenceRows;
+        errors[i] = oss.str();
+      }
+      else
+      {
+        numPoints += requests[i].points.n_cols;
+      }
+    }
+
+    // All other requests are answered with one search.
+    arma::Mat<size_t> neighbors(k, 0);
+    arma::mat distances(k, 0);
+    if (numPoints > 0)
+    {
+      arma::mat queryData(referenceRows, numPoints);
+      size_t col = 0;
+      for (size_t i = 0; i < requests.size(); ++i)
+      {
+        if (!errors[i].empty() || requests[i].points.n_cols == 0)
+          continue;
+
+        queryData.cols(col, col + requests[i].points.n_cols - 1) =
+            requests[i].points;
+        col += requests[i].points.n_cols;
+      }
+
+      try
+      {
+        knn.Search(std::move(queryData), k, neighbors, distances);
+      }
+      catch (std::exception& e)
+      {
+        for (size_t i = 0; i < requests.size(); ++i)
+          if (errors[i].empty())
+            errors[i] = e.what();
+      }
+    }
+
+    // Send the results in the order of the requests.
+    size_t col = 0;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+      const size_t n = requests[i].points.n_cols;
+      if (!errors[i].empty())
+        server->RespondError(requests[i], errors[i]);
+      else if (n == 0)
+        server->Respond(requests[i], arma::Mat<size_t>(k, 0), arma::mat(k, 0));
+      else
+        server->Respond(requests[i], neighbors.cols(col, col + n - 1),
+            distances.cols(col, col + n - 1));
+
+      if (errors[i].empty())
+        col += n;
+    }
+  }
+}
+
+// Print the error and the recall of the results, if the true results are given.
+void ReportQuality(const arma::Mat<size_t>& neighbors,
+                   const arma::mat& distances,
+                   const bool exact)
+{
+  // Calculate the effective error, if desired.
+  if (CLI::HasParam("true_distances"))
+  {
+    if (exact)
+      Log::Warn << "--true_distances_file (-D) specified, but the search is "
+          << "exact, so there is no need to calculate the error!" << endl;
+
+    arma::mat trueDistances =
+        std::move(CLI::GetParam<arma::mat>("true_distances"));
+
+    if (trueDistances.n_rows != distances.n_rows ||
+        trueDistances.n_cols != distances.n_cols)
+      Log::Fatal << "The true distances file must have the same number of "
+          << "values than the set of distances being queried!" << endl;
+
+    Log::Info << "Effective error: " << KNN::EffectiveError(distances,
+        trueDistances) << endl;
+  }
+
+  // Calculate the recall, if desired.
+  if (CLI::HasParam("true_neighbors"))
+  {
+    if (exact)
+      Log::Warn << "--true_neighbors_file (-T) specified, but the search is "
+          << "exact, so there is no need to calculate the recall!" << endl;
+
+    arma::Mat<size_t> trueNeighbors =
+        std::move(CLI::GetParam<arma::Mat<size_t>>("true_neighbors"));
+
+    if (trueNeighbors.n_rows != neighbors.n_rows ||
+        trueNeighbors.n_cols != neighbors.n_cols)
+      Log::Fatal << "The true neighbors file must have the same number of "
+          << "values than the set of neighbors being queried!" << endl;
+
+    Log::Info << "Recall: " << KNN::Recall(neighbors, trueNeighbors) << endl;
+  }
+}
+
+// Save the results, if desired.
+void SaveResults(arma::Mat<size_t>& neighbors, arma::mat& distances)
+{
+  if (CLI::HasParam("neighbors"))
+    CLI::GetParam<arma::Mat<size_t>>("neighbors") = std::move(neighbors);
+  if (CLI::HasParam("distances"))
+    CLI::GetParam<arma::mat>("distances") = std::move(distances);
+}
+
+// Search for the neighbors of the query points given with --query_file in
+// batches, reading the next batches and writing the results of the previous
+// ones during each search.
+void SearchInBatches(KNNModel& knn, const size_t k, const size_t batchSize)
+{
+  size_t referenceRows, referenceCols;
+  ReferenceSize(knn, referenceRows, referenceCols);
+
+  // The query points are only numeric, so no first pass over the file is
+  // needed to map strings.
+  const string queryFile = CLI::GetPrintableParam<arma::mat>("query");
+  std::unique_ptr<data::BatchReader<double, data::MissingPolicy>> reader;
+  std::unique_ptr<data::BatchWriter<size_t>> neighborsWriter;
+  std::unique_ptr<data::BatchWriter<double>> distancesWriter;
+  try
+  {
+    reader.reset(new data::BatchReader<double, data::MissingPolicy>(queryFile,
+        batchSize));
+    if (CLI::HasParam("neighbors"))
+      neighborsWriter.reset(new data::BatchWriter<size_t>(
+          CLI::GetPrintableParam<arma::Mat<size_t>>("neighbors"), k));
+    if (CLI::HasParam("distances"))
+      distancesWriter.reset(new data::BatchWriter<double>(
+          CLI::GetPrintableParam<arma::mat>("distances"), k));
+  }
+  catch (std::exception& e)
+  {
+    Log::Fatal << "Cannot search in batches: " << e.what() << endl;
+  }
+
+  if (reader->Dimensionality() != referenceRows)
+    Log::Fatal << "The query points have " << reader->Dimensionality()
+        << " dimensions, but the reference points have " << referenceRows
+        << "!" << endl;
+
+  typedef std::pair<arma::Mat<size_t>, arma::mat> ResultType;
+  size_t queryPoints = 0;
+  try
+  {
+    queryPoints = data::ProcessBatches(*reader,
+        [&](arma::mat& batch, const size_t /* first */)
+        {
+          ResultType results;
+          knn.Search(std::move(batch), k, results.first, results.second);
+          return results;
+        },
+        [&](ResultType& results)
+        {
+          if (neighborsWriter)
+            neighborsWriter->WriteBatch(results.first);
+          if (distancesWriter)
+            distancesWriter->WriteBatch(results.second);
+        });
+
+    if (neighborsWriter)
+      neighborsWriter->Close();
+    if (distancesWriter)
+      distancesWriter->Close();
+  }
+  catch (std::exception& e)
+  {
+    Log::Fatal << "Search in batches failed: " << e.what() << endl;
+  }
+
+  Log::Info << "Searched for the neighbors of " << queryPoints << " query "
+      << "points from '" << queryFile << "' in batches of " << batchSize
+      << " points." << endl;
+}
+
+// Approximate the k nearest neighbors of each reference point with NN-Descent.
+void BuildGraph()
+{
+  if (!CLI::HasParam("reference"))
+    Log::Fatal << "--algorithm nn_descent requires --reference_file (-r)!"
+        << endl;
+  if (!CLI::HasParam("k"))
+    Log::Fatal << "--algorithm nn_descent requires the number of neighbors to "
+        << "find (--k)!" << endl;
+  if (CLI::HasParam("query") || CLI::HasParam("sparse_query_file") ||
+      CLI::HasParam("serve"))
+    Log::Fatal << "--algorithm nn_descent only finds the neighbors of the "
+        << "reference points, so --query_file (-q), --sparse_query_file and "
+        << "--serve can't be used!" << endl;
+  if (CLI::HasParam("output_model") || CLI::HasParam("output_index_file"))
+    Log::Fatal << "--algorithm nn_descent doesn't build a model, so "
+        << "--output_model_file (-M) and --output_index_file can't be used!"
+        << endl;
+  if (CLI::HasParam("naive") || CLI::HasParam("single_mode"))
+    Log::Fatal << "Contradiction between options --algorithm nn_descent and "
+        << "--naive or --single_mode." << endl;
+  if (CLI::HasParam("tree_type") || CLI::HasParam("leaf_size") ||
+      CLI::HasParam("random_basis") || CLI::HasParam("single_precision") ||
+      CLI::HasParam("epsilon"))
+    Log::Warn << "--tree_type (-t), --leaf_size (-l), --random_basis (-R), "
+        << "--single_precision and --epsilon (-e) are ignored by --algorithm "
+        << "nn_descent." << endl;
+
+  const int maxIterations = CLI::GetParam<int>("max_iterations");
+  if (maxIterations < 1)
+    Log::Fatal << "Invalid max_iterations: " << maxIterations << ".  Must be "
+        << "greater than 0." << endl;
+
+  const double sampleRate = CLI::GetParam<double>("sample_rate");
+  if (sampleRate <= 0 || sampleRate > 1)
+    Log::Fatal << "Invalid sample_rate: " << sampleRate << ".  Must be in the "
+        << "range (0,1]." << endl;
+
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  if (tolerance < 0)
+    Log::Fatal << "Invalid tolerance: " << tolerance << ".  Must be "
+        << "non-negative." << endl;
+
+  arma::mat referenceSet = LoadReference();
+  const size_t k = (size_t) CLI::GetParam<int>("k");
+  if (k == 0 || k >= referenceSet.n_cols)
+  {
+    Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
+    Log::Fatal << "than the number of reference points (";
+    Log::Fatal << referenceSet.n_cols << ")." << endl;
+  }
+
+  NNDescent<> nnDescent((size_t) maxIterations, sampleRate, tolerance);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  nnDescent.Compute(referenceSet, k, neighbors, distances);
+  Log::Info << "NN-Descent finished after " << nnDescent.Iterations()
+      << " iterations." << endl;
+
+  ReportQuality(neighbors, distances, false);
+  SaveResults(neighbors, distances);
+}
 
 void mlpackMain()
 {
@@ -111,45 +487,139 @@ void mlpackMain()
   else
     math::RandomSeed((size_t) std::time(NULL));
 
-  // A user cannot specify both reference data and a model.
-  if (CLI::HasParam("reference") && CLI::HasParam("input_model"))
-    Log::Fatal << "Only one of --reference_file (-r) or --input_model_file (-m)"
-        << " may be specified!" << endl;
+  // When queries are served on standard input, the responses are written to
+  // standard output, so warnings and other messages go to standard error.
+  std::unique_ptr<data::StandardOutputRedirect> redirect;
+  if (CLI::HasParam("serve") && !CLI::HasParam("serve_socket"))
+    redirect.reset(new data::StandardOutputRedirect());
+
+  // A user cannot specify more than one of reference data, a model, and an
+  // index; but the reference data may be given with an index, which then uses
+  // it.
+  const bool sharedReference = CLI::HasParam("input_index_file") &&
+      CLI::HasParam("reference");
+  const size_t numSources =
+      ((CLI::HasParam("reference") && !sharedReference) ? 1 : 0) +
+      (CLI::HasParam("sparse_reference_file") ? 1 : 0) +
+      (CLI::HasParam("input_model") ? 1 : 0) +
+      (CLI::HasParam("input_index_file") ? 1 : 0);
+  if (numSources > 1)
+    Log::Fatal << "Only one of --reference_file (-r), --sparse_reference_file, "
+        << "--input_model_file (-m) or --input_index_file may be specified!"
+        << endl;
 
   // A user must specify one of them...
-  if (!CLI::HasParam("reference") && !CLI::HasParam("input_model"))
-    Log::Fatal << "No model specified (--input_model_file) and no reference "
-        << "data specified (--reference_file)!  One must be provided." << endl;
+  if (numSources == 0)
+    Log::Fatal << "No model specified (--input_model_file or "
+        << "--input_index_file) and no reference data specified "
+        << "(--reference_file or --sparse_reference_file)!  One must be "
+        << "provided." << endl;
 
-  if (CLI::HasParam("input_model"))
+  if (CLI::HasParam("input_model") || CLI::HasParam("input_index_file"))
   {
+    const string modelOption = CLI::HasParam("input_model") ?
+        "--input_model_file" : "--input_index_file";
+
     // Notify the user of parameters that will be ignored.
     if (CLI::HasParam("tree_type"))
-      Log::Warn << "--tree_type (-t) will be ignored because --input_model_file"
+      Log::Warn << "--tree_type (-t) will be ignored because " << modelOption
           << " is specified." << endl;
     if (CLI::HasParam("random_basis"))
       Log::Warn << "--random_basis (-R) will be ignored because "
-          << "--input_model_file is specified." << endl;
+          << modelOption << " is specified." << endl;
+    if (CLI::HasParam("single_precision"))
+      Log::Warn << "--single_precision will be ignored because "
+          << modelOption << " is specified." << endl;
     if (CLI::HasParam("tau"))
-      Log::Warn << "--tau (-u) will be ignored because --input_model_file is "
-          "specified." << endl;
+      Log::Warn << "--tau (-u) will be ignored because " << modelOption
+          << " is specified." << endl;
     if (CLI::HasParam("rho"))
-      Log::Warn << "--rho (-b) will be ignored because --input_model_file is "
-          "specified." << endl;
+      Log::Warn << "--rho (-b) will be ignored because " << modelOption
+          << " is specified." << endl;
     // Notify the user of parameters that will be only be considered for query
     // tree.
     if (CLI::HasParam("leaf_size"))
       Log::Warn << "--leaf_size (-l) will only be considered for the query "
-          "tree, because --input_model_file is specified." << endl;
+          << "tree, because " << modelOption << " is specified." << endl;
+  }
+
+  if (CLI::HasParam("serve"))
+  {
+    if (!CLI::HasParam("k"))
+      Log::Fatal << "--serve requires the number of neighbors to find (--k)!"
+          << endl;
+    if (!CLI::HasParam("serve_socket") && CLI::HasParam("verbose"))
+      Log::Fatal << "--verbose (-v) can't be used with --serve on standard "
+          << "input, because the results are written to standard output!"
+          << endl;
+
+    // Notify the user of parameters that will be ignored.
+    if (CLI::HasParam("query") || CLI::HasParam("sparse_query_file"))
+      Log::Warn << "--query_file (-q) and --sparse_query_file will be ignored "
+          << "because --serve is specified." << endl;
+    if (CLI::HasParam("neighbors") || CLI::HasParam("distances"))
+      Log::Warn << "--neighbors_file and --distances_file will be ignored "
+          << "because --serve is specified." << endl;
+    if (CLI::HasParam("true_neighbors") || CLI::HasParam("true_distances"))
+      Log::Warn << "--true_neighbors_file and --true_distances_file will be "
+          << "ignored because --serve is specified." << endl;
+  }
+  else if (CLI::HasParam("serve_socket") || CLI::HasParam("serve_batch_size"))
+  {
+    Log::Warn << "--serve_socket and --serve_batch_size will be ignored "
+        << "because --serve is not specified." << endl;
   }
 
+  if (CLI::GetParam<int>("query_batch_size") < 0)
+    Log::Fatal << "Invalid --query_batch_size: "
+        << CLI::GetParam<int>("query_batch_size") << "; must be 0 or greater."
+        << endl;
+
+  if (CLI::GetParam<int>("query_batch_size") > 0)
+  {
+    if (!CLI::HasParam("query"))
+      Log::Fatal << "--query_batch_size requires --query_file (-q)!" << endl;
+    if (CLI::HasParam("true_neighbors") || CLI::HasParam("true_distances"))
+      Log::Fatal << "--true_neighbors_file (-T) and --true_distances_file (-D) "
+          << "can't be used with --query_batch_size, because the results are "
+          << "not kept in memory." << endl;
+    if (CLI::HasParam("serve"))
+      Log::Warn << "--query_batch_size will be ignored because --serve is "
+          << "specified." << endl;
+
+
+    // Binary files need the number of points before the first batch is
+    // written.
+    std::vector<string> outputFiles;
+    if (CLI::HasParam("neighbors"))
+      outputFiles.push_back(CLI::GetPrintableParam<arma::Mat<size_t>>(
+          "neighbors"));
+    if (CLI::HasParam("distances"))
+      outputFiles.push_back(CLI::GetPrintableParam<arma::mat>("distances"));
+    for (const string& outputFile : outputFiles)
+    {
+      const string extension = data::Extension(outputFile);
+      if (extension != "csv" && extension != "txt")
+        Log::Fatal << "Cannot write '" << outputFile << "' in batches; the "
+            << "output files must be CSV or raw ASCII files (.csv or .txt) "
+            << "with --query_batch_size." << endl;
+    }
+  }
+
+  if (CLI::GetParam<int>("serve_batch_size") < 1)
+    Log::Fatal << "Invalid --serve_batch_size: "
+        << CLI::GetParam<int>("serve_batch_size") << "; must be greater than "
+        << "0." << endl;
+
   // The user should give something to do...
-  if (!CLI::HasParam("k") && !CLI::HasParam("output_model"))
-    Log::Warn << "Neither -k nor --output_model_file are specified, so no "
-        << "results from this program will be saved!" << endl;
+  if (!CLI::HasParam("k") && !CLI::HasParam("output_model") &&
+      !CLI::HasParam("output_index_file"))
+    Log::Warn << "Neither -k nor --output_model_file nor --output_index_file "
+        << "are specified, so no results from this program will be saved!"
+        << endl;
 
   // If the user specifies k but no output files, they should be warned.
-  if (CLI::HasParam("k") &&
+  if (CLI::HasParam("k") && !CLI::HasParam("serve") &&
       !(CLI::HasParam("neighbors") || CLI::HasParam("distances")))
     Log::Warn << "Neither --neighbors_file nor --distances_file is specified, "
         << "so the nearest neighbor search results will not be saved!" << endl;
@@ -197,10 +667,21 @@ void mlpackMain()
     Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be non-negative. "
         << endl;
 
+  const string algorithm = CLI::GetParam<string>("algorithm");
+  if (algorithm == "nn_descent")
+  {
+    BuildGraph();
+    return;
+  }
+
+  if (CLI::HasParam("max_iterations") || CLI::HasParam("sample_rate") ||
+      CLI::HasParam("tolerance"))
+    Log::Fatal << "--max_iterations, --sample_rate and --tolerance are only "
+        << "valid for '--algorithm nn_descent'." << endl;
+
   // We either have to load the reference data, or we have to load the model.
   KNNModel knn;
 
-  const string algorithm = CLI::GetParam<string>("algorithm");
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
 
   if (algorithm == "naive")
@@ -213,8 +694,8 @@ void mlpackMain()
     searchMode = GREEDY_SINGLE_TREE_MODE;
   else
     Log::Fatal << "Unknown neighbor search algorithm '" << algorithm << "'; "
-        << "valid choices are 'naive', 'single_tree', 'dual_tree' and 'greedy'."
-        << endl;
+        << "valid choices are 'naive', 'single_tree', 'dual_tree', 'greedy' "
+        << "and 'nn_descent'." << endl;
 
   if (CLI::HasParam("single_mode"))
   {
@@ -243,7 +724,17 @@ void mlpackMain()
       Log::Warn << "--single_mode ignored because --naive is present." << endl;
   }
 
-  if (CLI::HasParam("reference"))
+  if (CLI::HasParam("query") && CLI::HasParam("sparse_query_file"))
+    Log::Fatal << "Only one of --query_file (-q) and --sparse_query_file may "
+        << "be specified!" << endl;
+
+  if (CLI::HasParam("index_without_reference") &&
+      !CLI::HasParam("output_index_file"))
+    Log::Warn << "--index_without_reference ignored because "
+        << "--output_index_file is not specified." << endl;
+
+  if ((CLI::HasParam("reference") && !sharedReference) ||
+      CLI::HasParam("sparse_reference_file"))
   {
     // Get all the parameters.
     const string treeType = CLI::GetParam<string>("tree_type");
@@ -292,14 +783,71 @@ void mlpackMain()
     knn.Tau() = tau;
     knn.Rho() = rho;
 
-    arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
+    if (CLI::HasParam("sparse_reference_file"))
+    {
+      if (tree != KNNModel::KD_TREE && tree != KNNModel::BALL_TREE)
+        Log::Fatal << "--sparse_reference_file is only available for kd-trees "
+            << "and ball trees." << endl;
+      if (randomBasis)
+        Log::Fatal << "--random_basis (-R) can't be used with "
+            << "--sparse_reference_file." << endl;
+      if (CLI::HasParam("single_precision"))
+        Log::Warn << "--single_precision will be ignored because "
+            << "--sparse_reference_file is specified." << endl;
+
+      arma::sp_mat referenceSet = LoadSparse(
+          CLI::GetParam<string>("sparse_reference_file"));
+      knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode,
+          epsilon);
+    }
+    else if (CLI::HasParam("single_precision"))
+    {
+      if (tree != KNNModel::KD_TREE && tree != KNNModel::BALL_TREE &&
+          tree != KNNModel::OCTREE)
+        Log::Fatal << "--single_precision is only available for kd-trees, "
+            << "ball trees and octrees." << endl;
+
+      // Release the double-precision copy before the tree is built.
+      arma::mat referenceSet = LoadReference();
+      arma::fmat singleReferenceSet =
+          arma::conv_to<arma::fmat>::from(referenceSet);
+      referenceSet.reset();
+      knn.BuildModel(std::move(singleReferenceSet), size_t(lsInt), searchMode,
+          epsilon);
+    }
+    else
+    {
+      knn.BuildModel(LoadReference(), size_t(lsInt), searchMode, epsilon);
+    }
+  }
+  else if (CLI::HasParam("input_index_file"))
+  {
+    // Map the index from file.
+    const string indexFile = CLI::GetParam<string>("input_index_file");
+    try
+    {
+      if (sharedReference)
+        knn.LoadIndex(indexFile, LoadReference());
+      else
+        knn.LoadIndex(indexFile);
+    }
+    catch (std::exception& e)
+    {
+      Log::Fatal << "Cannot load index from '" << indexFile << "': "
+          << e.what() << endl;
+    }
+
+    // Adjust search mode.
+    knn.SearchMode() = searchMode;
+    knn.Epsilon() = epsilon;
 
-    Log::Info << "Loaded reference data from '"
-        << CLI::GetPrintableParam<arma::mat>("reference") << "' ("
-        << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
-        << endl;
+    if (CLI::HasParam("leaf_size"))
+      knn.LeafSize() = size_t(lsInt);
 
-    knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode, epsilon);
+    size_t rows, cols;
+    ReferenceSize(knn, rows, cols);
+    Log::Info << "Loaded kNN index from '" << indexFile << "' (trained on "
+        << rows << "x" << cols << " dataset)." << endl;
   }
   else
   {
@@ -316,19 +864,38 @@ void mlpackMain()
     if (CLI::HasParam("leaf_size"))
       knn.LeafSize() = size_t(lsInt);
 
+    size_t rows, cols;
+    ReferenceSize(knn, rows, cols);
     Log::Info << "Loaded kNN model from '"
         << CLI::GetPrintableParam<KNNModel>("input_model") << "' (trained on "
-        << knn.Dataset().n_rows << "x" << knn.Dataset().n_cols << " dataset)."
-        << endl;
+        << rows << "x" << cols << " dataset)." << endl;
   }
 
+  // Answer queries until no more arrive, if desired.
+  if (CLI::HasParam("serve"))
+  {
+    const size_t k = (size_t) CLI::GetParam<int>("k");
+    size_t referenceRows, referenceCols;
+    ReferenceSize(knn, referenceRows, referenceCols);
+    if (k > referenceCols)
+    {
+      Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
+      Log::Fatal << "than or equal to the number of reference points (";
+      Log::Fatal << referenceCols << ")." << endl;
+    }
+
+    Serve(knn, k);
+  }
   // Perform search, if desired.
-  if (CLI::HasParam("k"))
+  else if (CLI::HasParam("k"))
   {
     const size_t k = (size_t) CLI::GetParam<int>("k");
+    const size_t queryBatchSize =
+        (size_t) CLI::GetParam<int>("query_batch_size");
 
+    // With --query_batch_size, the query points are read by SearchInBatches().
     arma::mat queryData;
-    if (CLI::HasParam("query"))
+    if (CLI::HasParam("query") && queryBatchSize == 0)
     {
       queryData = std::move(CLI::GetParam<arma::mat>("query"));
       Log::Info << "Loaded query data from '"
@@ -339,64 +906,55 @@ void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than the
     // number of reference points.  Since it is unsigned, we only test the upper
     // bound.
-    if (k > knn.Dataset().n_cols)
+    size_t referenceRows, referenceCols;
+    ReferenceSize(knn, referenceRows, referenceCols);
+    if (k > referenceCols)
     {
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
       Log::Fatal << "than or equal to the number of reference points (";
-      Log::Fatal << knn.Dataset().n_cols << ")." << endl;
+      Log::Fatal << referenceCols << ")." << endl;
     }
 
     // Now run the search.
     arma::Mat<size_t> neighbors;
     arma::mat distances;
 
-    if (CLI::HasParam("query"))
+    if (queryBatchSize > 0)
+    {
+      SearchInBatches(knn, k, queryBatchSize);
+    }
+    else if (CLI::HasParam("query"))
+    {
       knn.Search(std::move(queryData), k, neighbors, distances);
+    }
+    else if (CLI::HasParam("sparse_query_file"))
+    {
+      arma::sp_mat sparseQueryData = LoadSparse(
+          CLI::GetParam<string>("sparse_query_file"), referenceRows);
+      knn.Search(std::move(sparseQueryData), k, neighbors, distances);
+    }
     else
+    {
       knn.Search(k, neighbors, distances);
+    }
     Log::Info << "Search complete." << endl;
 
-    // Save output, if desired.
-    if (CLI::HasParam("neighbors"))
-      CLI::GetParam<arma::Mat<size_t>>("neighbors") = std::move(neighbors);
-    if (CLI::HasParam("distances"))
-      CLI::GetParam<arma::mat>("distances") = std::move(distances);
+    ReportQuality(neighbors, distances, knn.TreeType() != KNNModel::SPILL_TREE
+        && knn.Epsilon() == 0);
+    SaveResults(neighbors, distances);
+  }
 
-    // Calculate the effective error, if desired.
-    if (CLI::HasParam("true_distances"))
+  if (CLI::HasParam("output_index_file"))
+  {
+    const string indexFile = CLI::GetParam<string>("output_index_file");
+    try
     {
-      if (knn.TreeType() != KNNModel::SPILL_TREE && knn.Epsilon() == 0)
-        Log::Warn << "--true_distances_file (-D) specified, but the search is "
-            << "exact, so there is no need to calculate the error!" << endl;
-
-      arma::mat trueDistances =
-          std::move(CLI::GetParam<arma::mat>("true_distances"));
-
-      if (trueDistances.n_rows != distances.n_rows ||
-          trueDistances.n_cols != distances.n_cols)
-        Log::Fatal << "The true distances file must have the same number of "
-            << "values than the set of distances being queried!" << endl;
-
-      Log::Info << "Effective error: " << KNN::EffectiveError(distances,
-          trueDistances) << endl;
+      knn.SaveIndex(indexFile, !CLI::HasParam("index_without_reference"));
     }
-
-    // Calculate the recall, if desired.
-    if (CLI::HasParam("true_neighbors"))
+    catch (std::exception& e)
     {
-      if (knn.TreeType() != KNNModel::SPILL_TREE && knn.Epsilon() == 0)
-        Log::Warn << "--true_neighbors_file (-T) specified, but the search is "
-            << "exact, so there is no need to calculate the recall!" << endl;
-
-      arma::Mat<size_t> trueNeighbors =
-          std::move(CLI::GetParam<arma::Mat<size_t>>("true_neighbors"));
-
-      if (trueNeighbors.n_rows != neighbors.n_rows ||
-          trueNeighbors.n_cols != neighbors.n_cols)
-        Log::Fatal << "The true neighbors file must have the same number of "
-            << "values than the set of neighbors being queried!" << endl;
-
-      Log::Info << "Recall: " << KNN::Recall(neighbors, trueNeighbors) << endl;
+      Log::Fatal << "Cannot save index to '" << indexFile << "': " << e.what()
+          << endl;
     }
   }
 
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 #include <vector>
 #include <string>
 
@@ -30,9 +31,46 @@ namespace mlpack {
 // all-furthest-neighbors searches.
 namespace neighbor  {
 
-// Forward declaration.
-template<typename SortPolicy>
-class TrainVisitor;
+/**
+ * These give us HasInsertPointCheck and HasDeletePointCheck objects that we can
+ * use to tell whether or not a tree type can insert and delete single points
+ * after it has been built.
+ */
+HAS_MEM_FUNC(InsertPoint, HasInsertPointCheck);
+HAS_MEM_FUNC(DeletePoint, HasDeletePointCheck);
+
+/**
+ * TreeSupportsUpdates<TreeType>::value is true if points can be inserted into
+ * and deleted from a built tree of the given type (for instance, for all the
+ * RectangleTree variants).  Only for those tree types can the reference set of
+ * NeighborSearch be updated with Insert() and Remove().
+ */
+template<typename TreeType>
+struct TreeSupportsUpdates
+{
+  static const bool value =
+      HasInsertPointCheck<TreeType, void(TreeType::*)(const size_t)>::value &&
+      HasDeletePointCheck<TreeType, bool(TreeType::*)(const size_t)>::value;
+};
+
+/**
+ * This gives us a HasTraverseCheck object that we can use to tell whether a
+ * single-tree traverser can traverse a range of query points in one call.
+ */
+HAS_MEM_FUNC(Traverse, HasTraverseCheck);
+
+/**
+ * TraverserSupportsBatches<TraverserType, TreeType>::value is true if the given
+ * single-tree traverser can traverse the tree with a whole range of query
+ * points at once (for instance, the cover tree's ParallelSingleTreeTraverser,
+ * which divides the query points between threads).
+ */
+template<typename TraverserType, typename TreeType>
+struct TraverserSupportsBatches
+{
+  static const bool value = HasTraverseCheck<TraverserType,
+      void(TraverserType::*)(const size_t, const size_t, TreeType&)>::value;
+};
 
 //! NeighborSearchMode represents the different neighbor search modes available.
 enum NeighborSearchMode
@@ -277,6 +315,49 @@ class NeighborSearch
    */
   void Train(Tree&& referenceTree);
 
+  /**
+   * Set the reference tree to a tree that uses the structure and the points
+   * held by the given SharedTree, so that no tree is built and the points are
+   * not copied.  The results are given in terms of the original indices of the
+   * points.  This object keeps a copy of the handle while it uses the tree; the
+   * reference set can't be changed with Insert() or Remove() in the meantime.
+   *
+   * This is only available for BinarySpaceTree types, and the tree held by the
+   * handle must have the same bound and element type as this tree type.
+   *
+   * @param referenceTree Handle to the shared reference tree.
+   */
+  void Train(const tree::SharedTree& referenceTree);
+
+  /**
+   * Add the given points to the reference set, and insert them into the
+   * reference tree without rebuilding it.  The new points get the indices that
+   * follow the current last reference point.  Searches can be run as usual
+   * between updates.
+   *
+   * This is only possible if the tree type supports point insertion (see
+   * TreeSupportsUpdates), or in naive mode if this object owns the reference
+   * set; otherwise, a std::invalid_argument is thrown.
+   *
+   * @param points Points to add to the reference set.
+   */
+  void Insert(const MatType& points);
+
+  /**
+   * Remove the reference points with the given indices from the reference set
+   * and from the reference tree, without rebuilding it.  Like
+   * arma::Mat::shed_cols(), the remaining points keep their order, so the index
+   * of a point decreases by the number of removed points that preceded it.
+   *
+   * This is only possible if the tree type supports point deletion (see
+   * TreeSupportsUpdates), or in naive mode if this object owns the reference
+   * set; otherwise, a std::invalid_argument is thrown.  An invalid index also
+   * causes a std::invalid_argument to be thrown.
+   *
+   * @param indices Indices of the reference points to remove.
+   */
+  void Remove(const arma::Col<size_t>& indices);
+
   /**
    * For each point in the query set, compute the nearest neighbors and store
    * the output in the given matrices.  The matrices will be set to the size of
@@ -299,6 +380,30 @@ class NeighborSearch
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * For each point in the query set, compute the k neighbors that are better
+   * than the given bound of the point, as the other overload of Search() does.
+   * The bound of a query point is typically the k'th distance of neighbors
+   * that were already found in another reference set (like another shard of
+   * a reference set that is split between several NeighborSearch objects),
+   * so that the search prunes with it from the start; the results can then be
+   * merged with MergeNeighbors().  If fewer than k neighbors are better than
+   * the bound, the remaining neighbors are size_t() - 1 and their distances
+   * are SortPolicy::WorstDistance().
+   *
+   * @param querySet Set of query points (can be just one point).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   * @param bounds Bound of each query point; if empty, there are no bounds.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances,
+              const arma::vec& bounds);
+
   /**
    * Given a pre-built query tree, search for the nearest neighbors of each
    * point in the query tree, storing the output in the given matrices.  The
@@ -392,6 +497,25 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
+  /**
+   * Access the maximum number of base cases (distance evaluations) for each
+   * query point in single-tree search; 0, the default, means no limit.  When a
+   * query point uses up this budget, its search stops, and it is given the best
+   * neighbors found so far; Truncated() tells which query points this happened
+   * to.  This bounds the work done for each query point, trading recall for
+   * predictable latency, like the 'checks' parameter of FLANN.  The budget is
+   * ignored by the other search modes.
+   */
+  size_t MaxBaseCases() const { return maxBaseCases; }
+  //! Modify the maximum number of base cases for each query point in
+  //! single-tree search.
+  size_t& MaxBaseCases() { return maxBaseCases; }
+
+  //! Access, for each query point of the last search, whether its search was
+  //! cut short by the budget set with MaxBaseCases(); the results for such a
+  //! query point may not be exact.
+  const std::vector<bool>& Truncated() const { return truncated; }
+
   //! Access the reference dataset.
   const MatType& ReferenceSet() const { return *referenceSet; }
 
@@ -400,6 +524,14 @@ class NeighborSearch
   //! Modify the reference tree.
   Tree& ReferenceTree() { return *referenceTree; }
 
+  //! Access the mapping from the indices of the points in the reference tree to
+  //! their original indices (empty if the points were not rearranged).
+  const std::vector<size_t>& OldFromNewReferences() const
+  { return oldFromNewReferences; }
+  //! Modify the mapping from the indices of the points in the reference tree
+  //! to their original indices.
+  std::vector<size_t>& OldFromNewReferences() { return oldFromNewReferences; }
+
   //! Serialize the NeighborSearch model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -416,11 +548,16 @@ class NeighborSearch
   bool treeOwner;
   //! If true, we own the reference set.
   bool setOwner;
+  //! If the reference tree uses the data of a SharedTree, the handle to it.
+  tree::SharedTree sharedTree;
 
   //! Indicates the neighbor search mode.
   NeighborSearchMode searchMode;
   //! Indicates the relative error to be considered in approximate search.
   double epsilon;
+  //! The maximum number of base cases for each query point in single-tree
+  //! search (0 for no limit).
+  size_t maxBaseCases;
 
   //! Instantiation of metric.
   MetricType metric;
@@ -429,14 +566,31 @@ class NeighborSearch
   size_t baseCases;
   //! The total number of scores (applicable for non-naive search).
   size_t scores;
+  //! For each query point of the last search, whether its search was
+  //! truncated.
+  std::vector<bool> truncated;
 
   //! If this is true, the reference tree bounds need to be reset on a call to
   //! Search() without a query set.
   bool treeNeedsReset;
 
-  //! The NSModel class should have access to internal members.
-  template<typename SortPol>
-  friend class TrainVisitor;
+  //! Check that the reference set can be updated with Insert() or Remove().
+  void CheckUpdatable() const;
+
+  //! Traverse the reference tree with each of the first numQueries query
+  //! points, one after another.
+  template<typename TraverserType>
+  typename std::enable_if<
+      !TraverserSupportsBatches<TraverserType, Tree>::value>::type
+  SingleTreeTraverse(TraverserType& traverser, const size_t numQueries);
+
+  //! Traverse the reference tree with the first numQueries query points in one
+  //! call, unless there is a work budget, which needs the truncation flags of
+  //! the one rules object.
+  template<typename TraverserType>
+  typename std::enable_if<
+      TraverserSupportsBatches<TraverserType, Tree>::value>::type
+  SingleTreeTraverse(TraverserType& traverser, const size_t numQueries);
 }; // class NeighborSearch
 
 } // namespace neighbor
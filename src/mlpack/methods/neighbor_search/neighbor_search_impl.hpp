@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/greedy_single_tree_traverser.hpp>
+#include <mlpack/core/tree/greedy_batch_single_tree_traverser.hpp>
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
 
@@ -45,6 +46,106 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+//! Add points to the dataset of a tree that supports insertion, and insert
+//! them into the tree.
+template<typename TreeType, typename MatType>
+void InsertIntoTree(
+    TreeType& tree,
+    const MatType& points,
+    const typename std::enable_if_t<
+        TreeSupportsUpdates<TreeType>::value, TreeType
+    >* = 0)
+{
+  const size_t oldPoints = tree.Dataset().n_cols;
+  tree.Dataset().insert_cols(oldPoints, points);
+  for (size_t i = oldPoints; i < tree.Dataset().n_cols; ++i)
+    tree.InsertPoint(i);
+}
+
+//! Trees that do not support insertion can't be updated.
+template<typename TreeType, typename MatType>
+void InsertIntoTree(
+    TreeType& /* tree */,
+    const MatType& /* points */,
+    const typename std::enable_if_t<
+        !TreeSupportsUpdates<TreeType>::value, TreeType
+    >* = 0)
+{
+  throw std::invalid_argument("the reference tree type does not support "
+      "inserting points");
+}
+
+//! Delete the points with the given (sorted, unique) indices from a tree that
+//! supports deletion, and renumber the remaining points as if the deleted
+//! columns were shed from the dataset.
+template<typename TreeType>
+void RemoveFromTree(
+    TreeType& tree,
+    const arma::Col<size_t>& indices,
+    const typename std::enable_if_t<
+        TreeSupportsUpdates<TreeType>::value, TreeType
+    >* = 0)
+{
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    if (!tree.DeletePoint(indices[i]))
+    {
+      std::ostringstream oss;
+      oss << "point " << indices[i] << " was not found in the reference tree";
+      throw std::runtime_error(oss.str());
+    }
+  }
+
+  std::stack<TreeType*> nodes;
+  nodes.push(&tree);
+  while (!nodes.empty())
+  {
+    TreeType* node = nodes.top();
+    nodes.pop();
+
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+    {
+      const size_t point = node->Point(i);
+      node->Point(i) = point - (std::lower_bound(indices.begin(),
+          indices.end(), point) - indices.begin());
+    }
+
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      nodes.push(&node->Child(i));
+  }
+}
+
+//! Trees that do not support deletion can't be updated.
+template<typename TreeType>
+void RemoveFromTree(
+    TreeType& /* tree */,
+    const arma::Col<size_t>& /* indices */,
+    const typename std::enable_if_t<
+        !TreeSupportsUpdates<TreeType>::value, TreeType
+    >* = 0)
+{
+  throw std::invalid_argument("the reference tree type does not support "
+      "removing points");
+}
+
+//! Remove the columns with the given (sorted, unique) indices from the matrix.
+template<typename MatType>
+void ShedColumns(MatType& matrix, const arma::Col<size_t>& indices)
+{
+  arma::uvec kept(matrix.n_cols - indices.n_elem);
+  size_t next = 0;
+  for (size_t i = 0, j = 0; i < matrix.n_cols; ++i)
+  {
+    if (j < indices.n_elem && indices[j] == i)
+      ++j;
+    else
+      kept[next++] = i;
+  }
+
+  MatType keptColumns = matrix.cols(kept);
+  matrix = std::move(keptColumns);
+}
+
 // Construct the object.
 template<typename SortPolicy,
          typename MetricType,
@@ -67,6 +168,7 @@ SingleTreeTraversalType>::NeighborSearch(const MatType& referenceSetIn,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -98,6 +200,7 @@ SingleTreeTraversalType>::NeighborSearch(MatType&& referenceSetIn,
     setOwner(mode == NAIVE_MODE),
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -127,6 +230,7 @@ SingleTreeTraversalType>::NeighborSearch(const Tree& referenceTree,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -156,6 +260,7 @@ SingleTreeTraversalType>::NeighborSearch(Tree&& referenceTree,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -184,6 +289,7 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
     setOwner(true),
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -219,9 +325,11 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     setOwner(!other.referenceTree),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    maxBaseCases(other.maxBaseCases),
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores),
+    truncated(other.truncated),
     treeNeedsReset(false)
 {
   // Nothing else to do.
@@ -243,11 +351,14 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     referenceSet(other.referenceSet),
     treeOwner(other.treeOwner),
     setOwner(other.setOwner),
+    sharedTree(std::move(other.sharedTree)),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    maxBaseCases(other.maxBaseCases),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores),
+    truncated(std::move(other.truncated)),
     treeNeedsReset(other.treeNeedsReset)
 {
   // Clear the other model.
@@ -258,6 +369,7 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
   other.setOwner = true;
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.maxBaseCases = 0;
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
@@ -291,6 +403,8 @@ NeighborSearch<SortPolicy,
   if (setOwner && referenceSet)
     delete referenceSet;
 
+  // The copied tree owns its points.
+  sharedTree = tree::SharedTree();
   oldFromNewReferences = other.oldFromNewReferences;
   referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
@@ -299,9 +413,11 @@ NeighborSearch<SortPolicy,
   setOwner = (other.referenceTree == NULL);
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  maxBaseCases = other.maxBaseCases;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
+  truncated = other.truncated;
   treeNeedsReset = false;
 }
 
@@ -338,11 +454,14 @@ NeighborSearch<SortPolicy,
   referenceSet = other.referenceSet;
   treeOwner = other.treeOwner;
   setOwner = other.setOwner;
+  sharedTree = std::move(other.sharedTree);
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  maxBaseCases = other.maxBaseCases;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
+  truncated = std::move(other.truncated);
   treeNeedsReset = other.treeNeedsReset;
 
   // Reset the other object.
@@ -353,6 +472,7 @@ NeighborSearch<SortPolicy,
   other.setOwner = true;
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.maxBaseCases = 0;
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
@@ -394,6 +514,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
     oldFromNewReferences.clear();
     delete referenceTree;
   }
+  sharedTree = tree::SharedTree();
 
   // We may need to rebuild the tree.
   if (searchMode != NAIVE_MODE)
@@ -434,6 +555,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType&& referenceSetIn)
     oldFromNewReferences.clear();
     delete referenceTree;
   }
+  sharedTree = tree::SharedTree();
 
   // We may need to rebuild the tree.
   if (searchMode != NAIVE_MODE)
@@ -484,6 +606,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
     oldFromNewReferences.clear();
     delete this->referenceTree;
   }
+  sharedTree = tree::SharedTree();
 
   if (setOwner && referenceSet)
     delete this->referenceSet;
@@ -514,6 +637,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree&& referenceTree)
     oldFromNewReferences.clear();
     delete this->referenceTree;
   }
+  sharedTree = tree::SharedTree();
 
   if (setOwner && referenceSet)
     delete this->referenceSet;
@@ -524,6 +648,186 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree&& referenceTree)
   setOwner = false;
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Train(
+    const tree::SharedTree& referenceTree)
+{
+  if (searchMode == NAIVE_MODE)
+    throw std::invalid_argument("cannot train on given reference tree when "
+        "naive search (without trees) is desired");
+
+  // Load the new tree first, so nothing changes if the handle is not usable.
+  std::vector<size_t> oldFromNew;
+  Tree* newTree = referenceTree.Tree<Tree>(oldFromNew);
+
+  if (treeOwner && this->referenceTree)
+    delete this->referenceTree;
+
+  if (setOwner && referenceSet)
+    delete this->referenceSet;
+
+  // The handle is replaced only after the old tree is gone, since that tree may
+  // use the data of the old handle.
+  sharedTree = referenceTree;
+  oldFromNewReferences = std::move(oldFromNew);
+  this->referenceTree = newTree;
+  this->referenceSet = &newTree->Dataset();
+  treeOwner = true;
+  setOwner = false;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Insert(const MatType& points)
+{
+  CheckUpdatable();
+
+  if (points.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "dimensionality of points to insert (" << points.n_rows << ") does "
+        << "not match the dimensionality of the reference set ("
+        << referenceSet->n_rows << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (referenceTree)
+    InsertIntoTree(*referenceTree, points);
+  else
+    const_cast<MatType*>(referenceSet)->insert_cols(referenceSet->n_cols,
+        points);
+
+  // The bounds held in the statistics of the changed nodes are stale now.
+  treeNeedsReset = true;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Remove(
+    const arma::Col<size_t>& indices)
+{
+  CheckUpdatable();
+
+  // arma::unique() also sorts the indices.
+  const arma::Col<size_t> sortedIndices = arma::unique(indices);
+  if (!sortedIndices.is_empty() &&
+      sortedIndices[sortedIndices.n_elem - 1] >= referenceSet->n_cols)
+  {
+    std::ostringstream oss;
+    oss << "cannot remove point " << sortedIndices[sortedIndices.n_elem - 1]
+        << "; there are only " << referenceSet->n_cols << " reference points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (referenceTree)
+  {
+    RemoveFromTree(*referenceTree, sortedIndices);
+    ShedColumns(referenceTree->Dataset(), sortedIndices);
+  }
+  else
+  {
+    ShedColumns(*const_cast<MatType*>(referenceSet), sortedIndices);
+  }
+
+  // The bounds held in the statistics of the changed nodes are stale now.
+  treeNeedsReset = true;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::CheckUpdatable() const
+{
+  if (referenceTree && !TreeSupportsUpdates<Tree>::value)
+    throw std::invalid_argument("the reference tree type does not support "
+        "inserting and removing points");
+  if (!referenceTree && !setOwner)
+    throw std::invalid_argument("cannot update a reference set that is not "
+        "owned by the NeighborSearch object");
+  if (!sharedTree.Empty())
+    throw std::invalid_argument("cannot update a reference tree that uses "
+        "the points of a SharedTree");
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename TraverserType>
+typename std::enable_if<
+    !TraverserSupportsBatches<TraverserType, typename NeighborSearch<SortPolicy,
+    MetricType, MatType, TreeType, DualTreeTraversalType,
+    SingleTreeTraversalType>::Tree>::value>::type
+NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
+SingleTreeTraversalType>::SingleTreeTraverse(TraverserType& traverser,
+                                             const size_t numQueries)
+{
+  for (size_t i = 0; i < numQueries; ++i)
+    traverser.Traverse(i, *referenceTree);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename TraverserType>
+typename std::enable_if<
+    TraverserSupportsBatches<TraverserType, typename NeighborSearch<SortPolicy,
+    MetricType, MatType, TreeType, DualTreeTraversalType,
+    SingleTreeTraversalType>::Tree>::value>::type
+NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
+SingleTreeTraversalType>::SingleTreeTraverse(TraverserType& traverser,
+                                             const size_t numQueries)
+{
+  // Each thread of a batched traversal has its own copy of the rules, and the
+  // truncation flags of those copies would be lost.
+  if (maxBaseCases != 0)
+  {
+    for (size_t i = 0; i < numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+  }
+  else
+  {
+    traverser.Traverse(0, numQueries, *referenceTree);
+  }
+}
+
 /**
  * Computes the best neighbors and stores them in resultingNeighbors and
  * distances.
@@ -542,6 +846,25 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     const size_t k,
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
+{
+  Search(querySet, k, neighbors, distances, arma::vec());
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const arma::vec& bounds)
 {
   if (k > referenceSet->n_cols)
   {
@@ -551,6 +874,14 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     throw std::invalid_argument(ss.str());
   }
 
+  if (!bounds.is_empty() && bounds.n_elem != querySet.n_cols)
+  {
+    std::stringstream ss;
+    ss << "NeighborSearch::Search(): " << bounds.n_elem << " bounds were "
+        << "given for " << querySet.n_cols << " query points";
+    throw std::invalid_argument(ss.str());
+  }
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -582,6 +913,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   neighborPtr->set_size(k, querySet.n_cols);
   distancePtr->set_size(k, querySet.n_cols);
 
+  // Only single-tree search can be truncated.
+  truncated.assign(querySet.n_cols, false);
+
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
 
   switch (searchMode)
@@ -590,13 +924,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     {
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      if (!bounds.is_empty())
+        rules.SetCandidateBounds(bounds);
 
       // The naive brute-force traversal.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
-
-      baseCases += querySet.n_cols * referenceSet->n_cols;
+      baseCases += rules.BruteForceBaseCases();
 
       rules.GetResults(*neighborPtr, *distancePtr);
       break;
@@ -604,14 +936,16 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     case SINGLE_TREE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      RuleType rules(*referenceSet, querySet, k, metric, epsilon, false,
+          maxBaseCases);
+      if (!bounds.is_empty())
+        rules.SetCandidateBounds(bounds);
 
       // Create the traverser.
       SingleTreeTraversalType<RuleType> traverser(rules);
 
       // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      SingleTreeTraverse(traverser, querySet.n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -622,6 +956,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
           << std::endl;
 
       rules.GetResults(*neighborPtr, *distancePtr);
+      truncated = rules.Truncated();
       break;
     }
     case DUAL_TREE_MODE:
@@ -636,6 +971,19 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
 
+      // The bounds are given in the order of the query set.
+      if (!bounds.is_empty() && !oldFromNewQueries.empty())
+      {
+        arma::vec treeBounds(bounds.n_elem);
+        for (size_t i = 0; i < bounds.n_elem; ++i)
+          treeBounds[i] = bounds[oldFromNewQueries[i]];
+        rules.SetCandidateBounds(treeBounds);
+      }
+      else if (!bounds.is_empty())
+      {
+        rules.SetCandidateBounds(bounds);
+      }
+
       // Create the traverser.
       DualTreeTraversalType<RuleType> traverser(rules);
 
@@ -658,13 +1006,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     {
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric);
+      if (!bounds.is_empty())
+        rules.SetCandidateBounds(bounds);
 
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Create the traverser, which routes batches of query points down the
+      // tree together.
+      tree::GreedyBatchSingleTreeTraverser<Tree, RuleType> traverser(rules);
+      traverser.Traverse(0, querySet.n_cols, *referenceTree);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -680,6 +1028,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 
   Timer::Stop("computing_neighbors");
+  Timer::Count("base_cases", baseCases);
+  Timer::Count("scores", scores);
 
   // Map points back to original indices, if necessary.
   if (tree::TreeTraits<Tree>::RearrangesDataset)
@@ -695,11 +1045,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         // Map distances (copy a column).
         distances.col(oldFromNewQueries[i]) = distancePtr->col(i);
 
-        // Map indices of neighbors.
+        // Map indices of neighbors; candidates that did not beat the bounds
+        // have no index.
         for (size_t j = 0; j < distances.n_rows; j++)
         {
-          neighbors(j, oldFromNewQueries[i]) =
-              oldFromNewReferences[(*neighborPtr)(j, i)];
+          const size_t neighbor = (*neighborPtr)(j, i);
+          neighbors(j, oldFromNewQueries[i]) = (neighbor == size_t() - 1) ?
+              neighbor : oldFromNewReferences[neighbor];
         }
       }
 
@@ -732,13 +1084,27 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       // Map indices of neighbors.
       for (size_t i = 0; i < neighbors.n_cols; i++)
+      {
         for (size_t j = 0; j < neighbors.n_rows; j++)
-          neighbors(j, i) = oldFromNewReferences[(*neighborPtr)(j, i)];
+        {
+          const size_t neighbor = (*neighborPtr)(j, i);
+          neighbors(j, i) = (neighbor == size_t() - 1) ? neighbor :
+              oldFromNewReferences[neighbor];
+        }
+      }
 
       // Finished with temporary matrix.
       delete neighborPtr;
     }
   }
+
+  // Candidates that did not beat the bounds are not neighbors.
+  if (!bounds.is_empty())
+  {
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+      if (neighbors[i] == size_t() - 1)
+        distances[i] = SortPolicy::WorstDistance();
+  }
 } // Search()
 
 template<typename SortPolicy,
@@ -778,6 +1144,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // Get a reference to the query set.
   const MatType& querySet = queryTree.Dataset();
 
+  // Dual-tree search is never truncated.
+  truncated.assign(querySet.n_cols, false);
+
   // We won't need to map query indices, but will we need to map distances?
   arma::Mat<size_t>* neighborPtr = &neighbors;
 
@@ -808,6 +1177,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Log::Info << rules.BaseCases() << " base cases were calculated.\n";
 
   Timer::Stop("computing_neighbors");
+  Timer::Count("base_cases", baseCases);
+  Timer::Count("scores", scores);
 
   // Do we need to map indices?
   if (!oldFromNewReferences.empty() &&
@@ -868,21 +1239,19 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   neighborPtr->set_size(k, referenceSet->n_cols);
   distancePtr->set_size(k, referenceSet->n_cols);
 
-  // Create the helper object for the traversal.
+  // Create the helper object for the traversal.  Only single-tree search has a
+  // work budget.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
-      true /* don't return the same point as nearest neighbor */);
+      true /* don't return the same point as nearest neighbor */,
+      (searchMode == SINGLE_TREE_MODE) ? maxBaseCases : 0);
 
   switch (searchMode)
   {
     case NAIVE_MODE:
     {
       // The naive brute-force solution.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
-
-      baseCases += referenceSet->n_cols * referenceSet->n_cols;
+      baseCases += rules.BruteForceBaseCases();
       break;
     }
     case SINGLE_TREE_MODE:
@@ -891,8 +1260,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       SingleTreeTraversalType<RuleType> traverser(rules);
 
       // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      SingleTreeTraverse(traverser, referenceSet->n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -956,12 +1324,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Create the traverser, which routes batches of query points down the
+      // tree together.
+      tree::GreedyBatchSingleTreeTraverser<Tree, RuleType> traverser(rules);
+      traverser.Traverse(0, referenceSet->n_cols, *referenceTree);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -975,8 +1341,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 
   rules.GetResults(*neighborPtr, *distancePtr);
+  truncated = rules.Truncated();
 
   Timer::Stop("computing_neighbors");
+  Timer::Count("base_cases", baseCases);
+  Timer::Count("scores", scores);
 
   // Do we need to map the reference indices?
   if (!oldFromNewReferences.empty() &&
@@ -985,11 +1354,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     neighbors.set_size(k, referenceSet->n_cols);
     distances.set_size(k, referenceSet->n_cols);
 
+    const std::vector<bool>& ruleTruncated = rules.Truncated();
     for (size_t i = 0; i < distances.n_cols; ++i)
     {
       // Map distances (copy a column).
       const size_t refMapping = oldFromNewReferences[i];
       distances.col(refMapping) = distancePtr->col(i);
+      truncated[refMapping] = ruleTruncated[i];
 
       // Map each neighbor's index.
       for (size_t j = 0; j < distances.n_rows; ++j)
@@ -1113,6 +1484,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Serialize(
     {
       if (treeOwner && referenceTree)
         delete referenceTree;
+      sharedTree = tree::SharedTree();
 
       referenceTree = NULL;
       oldFromNewReferences.clear();
@@ -1126,6 +1498,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Serialize(
     {
       if (treeOwner && referenceTree)
         delete referenceTree;
+      sharedTree = tree::SharedTree();
 
       // After we load the tree, we will own it.
       treeOwner = true;
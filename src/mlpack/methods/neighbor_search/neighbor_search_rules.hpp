@@ -14,6 +14,9 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include "sort_policies/nearest_neighbor_sort.hpp"
 
 #include <queue>
 
@@ -46,13 +49,28 @@ class NeighborSearchRules
    * @param epsilon Relative approximate error.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param maxBaseCases Maximum number of base cases for each query point (0
+   *      means no limit); see MaxBaseCases().
    */
   NeighborSearchRules(const typename TreeType::Mat& referenceSet,
                       const typename TreeType::Mat& querySet,
                       const size_t k,
                       MetricType& metric,
                       const double epsilon = 0,
-                      const bool sameSet = false);
+                      const bool sameSet = false,
+                      const size_t maxBaseCases = 0);
+
+  /**
+   * Construct a NeighborSearchRules object that shares the candidate lists of
+   * the given object.  The new object has its own traversal information, base
+   * case cache and counters, so it can be used by a different thread than the
+   * given object (this is what ParallelDualTreeTraverser does), as long as the
+   * two objects are never used for the same query point at the same time.
+   * The new object has the same work budget, but its own truncation flags.
+   *
+   * @param other NeighborSearchRules object to share candidate lists with.
+   */
+  NeighborSearchRules(const NeighborSearchRules& other);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -63,6 +81,19 @@ class NeighborSearchRules
    */
   void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances);
 
+  /**
+   * Only look for candidates that are better than the given distance of each
+   * query point, as if k candidates at that distance had already been found;
+   * this is used when some neighbors have already been found elsewhere (for
+   * instance in another shard of the reference set), so that the traversal
+   * prunes with their k'th distance from the start.  The candidate lists must
+   * not have been changed yet.  Candidates that are not replaced have index
+   * size_t() - 1 in the results.
+   *
+   * @param bounds Bound of each query point, in the order of the query set.
+   */
+  void SetCandidateBounds(const arma::vec& bounds);
+
   /**
    * Get the distance from the query point to the reference point.
    * This will update the list of candidates with the new point if appropriate
@@ -73,6 +104,51 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between every point of the query leaf and every
+   * point of the reference leaf, skipping the query points for which Score()
+   * prunes the reference leaf.  The results are the same as calling BaseCase()
+   * for each pair.  For nearest neighbor search with the (squared) Euclidean
+   * distance on dense, high-dimensional data, all distances between the two
+   * leaves are first estimated with a single matrix product (using
+   * ||a||^2 + ||b||^2 - 2 a^T b), and only the pairs that may enter a candidate
+   * list are evaluated exactly.
+   *
+   * @param queryNode Query leaf.
+   * @param referenceNode Reference leaf.
+   * @return The number of base cases performed.
+   */
+  size_t LeafBaseCases(TreeType& queryNode, TreeType& referenceNode);
+
+  /**
+   * Compute the base cases between each of the given query points and each of
+   * the points held by the reference node (see TreeType::Point()), as
+   * GreedyBatchSingleTreeTraverser does for the query points that reach the
+   * node.  The results are the same as calling BaseCase() for each pair, query
+   * point by query point; as in LeafBaseCases(), the distances are first
+   * estimated with a single matrix product when that pays off.
+   *
+   * @param queryIndices Indices of the query points.
+   * @param referenceNode Reference node.
+   * @return The number of base cases performed.
+   */
+  size_t NodeBaseCases(const std::vector<size_t>& queryIndices,
+                       TreeType& referenceNode);
+
+  /**
+   * Compute the base cases between every query point and every reference
+   * point, as naive (brute-force) search does.  The results are the same as
+   * calling BaseCase() for each pair.  When LeafBaseCases() would estimate
+   * the distances with a matrix product, the query and reference points are
+   * split into tiles, the distances between each pair of tiles are estimated
+   * with one matrix product, and the tiles of query points are split between
+   * the OpenMP threads; the memory taken by the products does not depend on
+   * the number of points.
+   *
+   * @return The number of base cases performed.
+   */
+  size_t BruteForceBaseCases();
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -149,6 +225,20 @@ class NeighborSearchRules
   //! Modify the number of scores that have been performed.
   size_t& Scores() { return scores; }
 
+  /**
+   * Get the maximum number of base cases for each query point (0 means no
+   * limit).  Once a query point has used up its budget, further base cases are
+   * not computed and every reference node is pruned, so the query point keeps
+   * the best neighbors found so far.  The budget is kept for one query point at
+   * a time, so it is only meaningful when the query points are traversed one
+   * after another, as single-tree traversals do.
+   */
+  size_t MaxBaseCases() const { return maxBaseCases; }
+
+  //! Get, for each query point, whether its search was cut short because its
+  //! work budget was used up.
+  const std::vector<bool>& Truncated() const { return truncated; }
+
   //! Convenience typedef.
   typedef typename tree::TraversalInfo<TreeType> TraversalInfoType;
 
@@ -164,23 +254,25 @@ class NeighborSearchRules
   //! The query set.
   const typename TreeType::Mat& querySet;
 
-  //! Candidate represents a possible candidate neighbor (distance, index).
-  typedef std::pair<double, size_t> Candidate;
-
-  //! Compare two candidates based on the distance.
-  struct CandidateCmp {
-    bool operator()(const Candidate& c1, const Candidate& c2)
-    {
-      return !SortPolicy::IsBetter(c2.first, c1.first);
-    };
-  };
-
-  //! Use a priority queue to represent the list of candidate neighbors.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-      CandidateList;
-
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! The largest k for which the candidates of each query point are kept
+  //! sorted (and updated by insertion); for larger k, they are kept as a heap
+  //! with the worst candidate on top.
+  static const size_t SortedCandidatesLimit = 16;
+
+  //! Storage for the distances of the candidate neighbors of each point, if
+  //! this object owns them (i.e., if it was not created with the copy
+  //! constructor).
+  arma::mat candidateDistanceStorage;
+  //! Storage for the indices of the candidate neighbors of each point, if this
+  //! object owns them.
+  arma::Mat<size_t> candidateIndexStorage;
+
+  //! The distances of the k candidate neighbors of each point, one column per
+  //! query point.  This may be shared with other NeighborSearchRules objects.
+  arma::mat& candidateDistances;
+  //! The indices of the k candidate neighbors of each point, in the same
+  //! order as candidateDistances.
+  arma::Mat<size_t>& candidateIndices;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -210,6 +302,117 @@ class NeighborSearchRules
   //! traversal before each call to Score().
   TraversalInfoType traversalInfo;
 
+  //! The maximum number of base cases for each query point (0 for no limit).
+  const size_t maxBaseCases;
+  //! The query point whose base cases are counted in budgetBaseCases.
+  size_t budgetQueryIndex;
+  //! The number of base cases performed for budgetQueryIndex.
+  size_t budgetBaseCases;
+  //! For each query point, whether its work budget ran out.
+  std::vector<bool> truncated;
+
+  //! Return the distance of the k'th best candidate of the given query point.
+  double WorstCandidateDistance(const size_t queryIndex) const
+  {
+    return candidateDistances(k <= SortedCandidatesLimit ? k - 1 : 0,
+        queryIndex);
+  }
+
+  /**
+   * Move the first candidate of the given heap of candidates down to its
+   * place, so that the heap has the worst candidate on top again.
+   *
+   * @param distances Distances of the candidates in the heap.
+   * @param indices Indices of the candidates in the heap.
+   * @param size Number of candidates in the heap.
+   */
+  static void SiftDownCandidate(double* distances,
+                                size_t* indices,
+                                const size_t size);
+
+  //! Return whether the work budget of the given query point is used up.
+  bool BudgetSpent(const size_t queryIndex) const
+  {
+    return (maxBaseCases != 0) && (queryIndex == budgetQueryIndex) &&
+        (budgetBaseCases >= maxBaseCases);
+  }
+
+  //! Whether LeafBaseCases() may estimate distances with a matrix product.
+  static const bool BlockedLeafBaseCases =
+      std::is_same<SortPolicy, NearestNeighborSort>::value &&
+      (std::is_same<MetricType, metric::EuclideanDistance>::value ||
+       std::is_same<MetricType, metric::SquaredEuclideanDistance>::value) &&
+      std::is_same<typename TreeType::Mat, arma::mat>::value;
+
+  //! Compute the base cases between two leaves, estimating the distances with
+  //! a matrix product if the data has enough dimensions.
+  template<bool Blocked = BlockedLeafBaseCases>
+  size_t LeafBaseCasesImpl(TreeType& queryNode,
+                           TreeType& referenceNode,
+                           const std::enable_if_t<Blocked>* = 0);
+
+  //! Compute the base cases between two leaves one pair at a time.
+  template<bool Blocked = BlockedLeafBaseCases>
+  size_t LeafBaseCasesImpl(TreeType& queryNode,
+                           TreeType& referenceNode,
+                           const std::enable_if_t<!Blocked>* = 0);
+
+  //! Compute the base cases between two leaves one pair at a time.
+  size_t PairwiseLeafBaseCases(TreeType& queryNode, TreeType& referenceNode);
+
+  //! Compute the base cases between the given query points and the points of
+  //! the reference node, estimating the distances with a matrix product if the
+  //! data has enough dimensions.
+  template<bool Blocked = BlockedLeafBaseCases>
+  size_t NodeBaseCasesImpl(const std::vector<size_t>& queryIndices,
+                           TreeType& referenceNode,
+                           const std::enable_if_t<Blocked>* = 0);
+
+  //! Compute the base cases between the given query points and the points of
+  //! the reference node one pair at a time.
+  template<bool Blocked = BlockedLeafBaseCases>
+  size_t NodeBaseCasesImpl(const std::vector<size_t>& queryIndices,
+                           TreeType& referenceNode,
+                           const std::enable_if_t<!Blocked>* = 0);
+
+  //! Compute the base cases between the given query points and the points of
+  //! the reference node one pair at a time.
+  size_t PairwiseNodeBaseCases(const std::vector<size_t>& queryIndices,
+                               TreeType& referenceNode);
+
+  //! Number of query points of each tile of BruteForceBaseCases().
+  static const size_t QueryTileSize = 256;
+  //! Number of reference points of each tile of BruteForceBaseCases().
+  static const size_t ReferenceTileSize = 1024;
+
+  //! Compute the base cases between all query and reference points, tile by
+  //! tile, if the data has enough dimensions.
+  template<bool Blocked = BlockedLeafBaseCases>
+  size_t BruteForceBaseCasesImpl(const std::enable_if_t<Blocked>* = 0);
+
+  //! Compute the base cases between all query and reference points one pair
+  //! at a time.
+  template<bool Blocked = BlockedLeafBaseCases>
+  size_t BruteForceBaseCasesImpl(const std::enable_if_t<!Blocked>* = 0);
+
+  //! Compute the base cases between all query and reference points one pair
+  //! at a time.
+  size_t PairwiseBruteForceBaseCases();
+
+  /**
+   * Compute the base cases between the given query points and reference
+   * points, estimating all of the squared distances with one matrix product
+   * and evaluating exactly only the pairs that may enter a candidate list.
+   *
+   * @param queryIndices Indices of the query points.
+   * @param references The reference points.
+   * @param referenceIndices Indices of the reference points.
+   * @return The number of pairs.
+   */
+  size_t BlockedBaseCases(const arma::uvec& queryIndices,
+                          const arma::mat& references,
+                          const arma::uvec& referenceIndices);
+
   /**
    * Recalculate the bound for a given query node.
    */
@@ -19,6 +19,28 @@
 namespace mlpack {
 namespace neighbor {
 
+//! Compute the distance between two points; most metrics cannot stop early
+//! above the bound.
+template<typename MetricType, typename VecTypeA, typename VecTypeB>
+inline double BoundedDistance(MetricType& metric,
+                              const VecTypeA& a,
+                              const VecTypeB& b,
+                              const double /* bound */)
+{
+  return metric.Evaluate(a, b);
+}
+
+//! Compute the distance between two points, but stop once it is known to be
+//! greater than the bound.
+template<int Power, bool TakeRoot, typename VecTypeA, typename VecTypeB>
+inline double BoundedDistance(metric::LMetric<Power, TakeRoot>& /* metric */,
+                              const VecTypeA& a,
+                              const VecTypeB& b,
+                              const double bound)
+{
+  return metric::LMetric<Power, TakeRoot>::EvaluateBounded(a, b, bound);
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const typename TreeType::Mat& referenceSet,
@@ -26,9 +48,14 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const size_t k,
     MetricType& metric,
     const double epsilon,
-    const bool sameSet) :
+    const bool sameSet,
+    const size_t maxBaseCases) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidateDistanceStorage(k, querySet.n_cols),
+    candidateIndexStorage(k, querySet.n_cols),
+    candidateDistances(candidateDistanceStorage),
+    candidateIndices(candidateIndexStorage),
     k(k),
     metric(metric),
     sameSet(sameSet),
@@ -36,7 +63,11 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
     baseCases(0),
-    scores(0)
+    scores(0),
+    maxBaseCases(maxBaseCases),
+    budgetQueryIndex(querySet.n_cols),
+    budgetBaseCases(0),
+    truncated(querySet.n_cols, false)
 {
   // We must set the traversal info last query and reference node pointers to
   // something that is both invalid (i.e. not a tree node) and not NULL.  We'll
@@ -47,16 +78,37 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
   // Let's build the list of candidate neighbors for each query point.
   // It will be initialized with k candidates: (WorstDistance, size_t() - 1)
   // The list of candidates will be updated when visiting new points with the
-  // BaseCase() method.
-  const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
-      size_t() - 1);
-
-  std::vector<Candidate> vect(k, def);
-  CandidateList pqueue(CandidateCmp(), std::move(vect));
+  // BaseCase() method.  The candidates of all query points are stored in two
+  // matrices, so that no list has to be allocated by itself.
+  candidateDistances.fill(SortPolicy::WorstDistance());
+  candidateIndices.fill(size_t() - 1);
+}
 
-  candidates.reserve(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; i++)
-    candidates.push_back(pqueue);
+template<typename SortPolicy, typename MetricType, typename TreeType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+    const NeighborSearchRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidateDistances(other.candidateDistances),
+    candidateIndices(other.candidateIndices),
+    k(other.k),
+    metric(other.metric),
+    sameSet(other.sameSet),
+    epsilon(other.epsilon),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    lastBaseCase(0.0),
+    baseCases(0),
+    scores(0),
+    maxBaseCases(other.maxBaseCases),
+    budgetQueryIndex(querySet.n_cols),
+    budgetBaseCases(0),
+    truncated(querySet.n_cols, false)
+{
+  // The traversal info must not point at any node of the other object's
+  // traversal; as in the other constructor, we use the this pointer.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -64,20 +116,36 @@ void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  neighbors.set_size(k, querySet.n_cols);
-  distances.set_size(k, querySet.n_cols);
+  neighbors = candidateIndices;
+  distances = candidateDistances;
 
-  for (size_t i = 0; i < querySet.n_cols; i++)
+  // Small lists of candidates are already sorted.  The others are heaps, which
+  // are sorted by taking the worst candidate off the top repeatedly.
+  if (k <= SortedCandidatesLimit)
+    return;
+
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; i++)
   {
-    CandidateList& pqueue = candidates[i];
-    for (size_t j = 1; j <= k; j++)
+    double* queryDistances = distances.colptr(i);
+    size_t* queryNeighbors = neighbors.colptr(i);
+    for (size_t end = k - 1; end > 0; --end)
     {
-      neighbors(k - j, i) = pqueue.top().second;
-      distances(k - j, i) = pqueue.top().first;
-      pqueue.pop();
+      std::swap(queryDistances[0], queryDistances[end]);
+      std::swap(queryNeighbors[0], queryNeighbors[end]);
+      SiftDownCandidate(queryDistances, queryNeighbors, end);
     }
   }
-};
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::SetCandidateBounds(
+    const arma::vec& bounds)
+{
+  // A list of equal candidates is both sorted and a heap.
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+    candidateDistances.col(i).fill(bounds[i]);
+}
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline force_inline // Absolutely MUST be inline so optimizations can happen.
@@ -93,8 +161,38 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   if ((lastQueryIndex == queryIndex) && (lastReferenceIndex == referenceIndex))
     return lastBaseCase;
 
-  double distance = metric.Evaluate(querySet.col(queryIndex),
-                                    referenceSet.col(referenceIndex));
+  // Enforce the work budget of the query point, if there is one.
+  if (maxBaseCases != 0)
+  {
+    if (queryIndex != budgetQueryIndex)
+    {
+      budgetQueryIndex = queryIndex;
+      budgetBaseCases = 0;
+    }
+
+    if (budgetBaseCases == maxBaseCases)
+    {
+      truncated[queryIndex] = true;
+      return SortPolicy::WorstDistance();
+    }
+    ++budgetBaseCases;
+  }
+
+  // The traversers of trees whose first point is the centroid use the
+  // distance; otherwise only a distance that beats the k'th best candidate of
+  // the query point matters, so the metric may stop once it is worse.
+  double distance;
+  if (!tree::TreeTraits<TreeType>::FirstPointIsCentroid &&
+      std::is_same<SortPolicy, NearestNS>::value)
+  {
+    distance = BoundedDistance(metric, querySet.col(queryIndex),
+        referenceSet.col(referenceIndex), WorstCandidateDistance(queryIndex));
+  }
+  else
+  {
+    distance = metric.Evaluate(querySet.col(queryIndex),
+                               referenceSet.col(referenceIndex));
+  }
   ++baseCases;
 
   InsertNeighbor(queryIndex, referenceIndex, distance);
@@ -107,6 +205,284 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+inline size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+LeafBaseCases(TreeType& queryNode, TreeType& referenceNode)
+{
+  return LeafBaseCasesImpl(queryNode, referenceNode);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool Blocked>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+LeafBaseCasesImpl(TreeType& queryNode,
+                  TreeType& referenceNode,
+                  const std::enable_if_t<Blocked>*)
+{
+  // In low dimensions, the matrix product does not pay off.
+  if (querySet.n_rows < 16)
+    return PairwiseLeafBaseCases(queryNode, referenceNode);
+
+  // Find the query points that the reference leaf may still improve.
+  std::vector<arma::uword> active;
+  active.reserve(queryNode.Count());
+  const size_t queryEnd = queryNode.Begin() + queryNode.Count();
+  for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+    if (Score(query, referenceNode) != DBL_MAX)
+      active.push_back(query);
+
+  if (active.empty())
+    return 0;
+
+  const size_t refBegin = referenceNode.Begin();
+  const size_t refCount = referenceNode.Count();
+  // The points of the reference leaf are contiguous, so alias them.
+  const arma::mat references(
+      const_cast<double*>(referenceSet.colptr(refBegin)), referenceSet.n_rows,
+      refCount, false, true);
+  arma::uvec referenceIndices(refCount);
+  for (size_t i = 0; i < refCount; ++i)
+    referenceIndices[i] = refBegin + i;
+
+  return BlockedBaseCases(arma::uvec(active), references, referenceIndices);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool Blocked>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+LeafBaseCasesImpl(TreeType& queryNode,
+                  TreeType& referenceNode,
+                  const std::enable_if_t<!Blocked>*)
+{
+  return PairwiseLeafBaseCases(queryNode, referenceNode);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+inline size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+BruteForceBaseCases()
+{
+  return BruteForceBaseCasesImpl();
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool Blocked>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+BruteForceBaseCasesImpl(const std::enable_if_t<Blocked>*)
+{
+  // In low dimensions, the matrix product does not pay off; with a work
+  // budget, BaseCase() must count the base cases of each query point.
+  if (querySet.n_rows < 16 || maxBaseCases != 0)
+    return PairwiseBruteForceBaseCases();
+
+  const size_t queryTiles = (querySet.n_cols + QueryTileSize - 1) /
+      QueryTileSize;
+  size_t numBaseCases = 0;
+
+  #pragma omp parallel num_threads(ParallelThreads()) \
+      reduction(+:numBaseCases)
+  {
+    // Each thread works on its own query points, so it can share the
+    // candidate lists, but needs its own cache and counters.
+    NeighborSearchRules threadRules(*this);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t t = 0; t < (omp_size_t) queryTiles; ++t)
+    {
+      const size_t queryBegin = (size_t) t * QueryTileSize;
+      const size_t queryCount = std::min((size_t) QueryTileSize,
+          (size_t) querySet.n_cols - queryBegin);
+      arma::uvec queryIndices(queryCount);
+      for (size_t i = 0; i < queryCount; ++i)
+        queryIndices[i] = queryBegin + i;
+
+      // The reference tiles are contiguous, so alias them.
+      for (size_t refBegin = 0; refBegin < referenceSet.n_cols;
+          refBegin += ReferenceTileSize)
+      {
+        const size_t refCount = std::min((size_t) ReferenceTileSize,
+            (size_t) referenceSet.n_cols - refBegin);
+        const arma::mat references(
+            const_cast<double*>(referenceSet.colptr(refBegin)),
+            referenceSet.n_rows, refCount, false, true);
+        arma::uvec referenceIndices(refCount);
+        for (size_t i = 0; i < refCount; ++i)
+          referenceIndices[i] = refBegin + i;
+
+        threadRules.BlockedBaseCases(queryIndices, references,
+            referenceIndices);
+      }
+    }
+
+    numBaseCases += threadRules.baseCases;
+  }
+
+  baseCases += numBaseCases;
+
+  // The base case cache does not hold any of these results.
+  lastQueryIndex = querySet.n_cols;
+  lastReferenceIndex = referenceSet.n_cols;
+
+  return querySet.n_cols * referenceSet.n_cols;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool Blocked>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+BruteForceBaseCasesImpl(const std::enable_if_t<!Blocked>*)
+{
+  return PairwiseBruteForceBaseCases();
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+PairwiseBruteForceBaseCases()
+{
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+      BaseCase(i, j);
+
+  return querySet.n_cols * referenceSet.n_cols;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+BlockedBaseCases(const arma::uvec& queryIndices,
+                 const arma::mat& references,
+                 const arma::uvec& referenceIndices)
+{
+  const arma::mat queries = querySet.cols(queryIndices);
+  const size_t refCount = referenceIndices.n_elem;
+
+  const arma::rowvec queryNorms = arma::sum(arma::square(queries), 0);
+  const arma::rowvec refNorms = arma::sum(arma::square(references), 0);
+  const arma::mat products = references.t() * queries;
+
+  // The estimate of a squared distance can be off by roughly the machine
+  // epsilon times the dimensionality times the squared norms.  Only pairs whose
+  // estimate is within twice that of the k'th best candidate are evaluated
+  // exactly, so the candidate lists end up exactly as with BaseCase().
+  const double relativeError = (querySet.n_rows + 4) *
+      std::numeric_limits<double>::epsilon();
+  const bool squared = std::is_same<MetricType,
+      metric::SquaredEuclideanDistance>::value;
+
+  size_t numBaseCases = 0;
+  for (size_t j = 0; j < queryIndices.n_elem; ++j)
+  {
+    const size_t queryIndex = queryIndices[j];
+    for (size_t i = 0; i < refCount; ++i)
+    {
+      const size_t referenceIndex = referenceIndices[i];
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+
+      ++numBaseCases;
+
+      const double normSum = queryNorms[j] + refNorms[i];
+      const double estimate = normSum - 2.0 * products(i, j);
+      const double best = WorstCandidateDistance(queryIndex);
+      const double bestSquared = squared ? best : best * best;
+      if (estimate - 2.0 * relativeError * normSum > bestSquared)
+        continue;
+
+      const double distance = std::is_same<SortPolicy, NearestNS>::value ?
+          BoundedDistance(metric, querySet.col(queryIndex),
+              referenceSet.col(referenceIndex), best) :
+          metric.Evaluate(querySet.col(queryIndex),
+              referenceSet.col(referenceIndex));
+      InsertNeighbor(queryIndex, referenceIndex, distance);
+    }
+  }
+
+  baseCases += numBaseCases;
+
+  // The base case cache does not hold any of these results.
+  lastQueryIndex = querySet.n_cols;
+  lastReferenceIndex = referenceSet.n_cols;
+
+  return queryIndices.n_elem * refCount;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+inline size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+NodeBaseCases(const std::vector<size_t>& queryIndices,
+              TreeType& referenceNode)
+{
+  return NodeBaseCasesImpl(queryIndices, referenceNode);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool Blocked>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+NodeBaseCasesImpl(const std::vector<size_t>& queryIndices,
+                  TreeType& referenceNode,
+                  const std::enable_if_t<Blocked>*)
+{
+  // In low dimensions the matrix product does not pay off; with a work budget,
+  // BaseCase() must count the base cases of each query point.  Trees whose
+  // first point is the centroid need the exact distances of BaseCase().
+  const size_t numPoints = referenceNode.NumPoints();
+  if (querySet.n_rows < 16 || maxBaseCases != 0 ||
+      tree::TreeTraits<TreeType>::FirstPointIsCentroid ||
+      queryIndices.empty() || numPoints == 0)
+    return PairwiseNodeBaseCases(queryIndices, referenceNode);
+
+  arma::uvec referenceIndices(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    referenceIndices[i] = referenceNode.Point(i);
+
+  arma::uvec queries(queryIndices.size());
+  for (size_t j = 0; j < queryIndices.size(); ++j)
+    queries[j] = queryIndices[j];
+
+  return BlockedBaseCases(queries, referenceSet.cols(referenceIndices),
+      referenceIndices);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool Blocked>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+NodeBaseCasesImpl(const std::vector<size_t>& queryIndices,
+                  TreeType& referenceNode,
+                  const std::enable_if_t<!Blocked>*)
+{
+  return PairwiseNodeBaseCases(queryIndices, referenceNode);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+PairwiseNodeBaseCases(const std::vector<size_t>& queryIndices,
+                      TreeType& referenceNode)
+{
+  for (size_t j = 0; j < queryIndices.size(); ++j)
+    for (size_t i = 0; i < referenceNode.NumPoints(); ++i)
+      BaseCase(queryIndices[j], referenceNode.Point(i));
+
+  return queryIndices.size() * referenceNode.NumPoints();
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+PairwiseLeafBaseCases(TreeType& queryNode, TreeType& referenceNode)
+{
+  size_t numBaseCases = 0;
+  const size_t queryEnd = queryNode.Begin() + queryNode.Count();
+  const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
+  for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+  {
+    // Skip the query point if the reference leaf cannot improve it.
+    if (Score(query, referenceNode) == DBL_MAX)
+      continue;
+
+    for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
+      BaseCase(query, ref);
+
+    numBaseCases += referenceNode.Count();
+  }
+
+  return numBaseCases;
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
@@ -121,16 +497,24 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     double baseCase = -1.0;
     if (tree::TreeTraits<TreeType>::HasSelfChildren)
     {
+      // A traverser may hand us the base case of the parent in the traversal
+      // info (the cover tree's ParallelSingleTreeTraverser does), in which case
+      // the statistics of the reference tree are neither read nor written.
+      const bool parentGiven =
+          (traversalInfo.LastReferenceNode() == referenceNode.Parent());
+
       // If the parent node is the same, then we have already calculated the
       // base case.
       if ((referenceNode.Parent() != NULL) &&
           (referenceNode.Point(0) == referenceNode.Parent()->Point(0)))
-        baseCase = referenceNode.Parent()->Stat().LastDistance();
+        baseCase = parentGiven ? traversalInfo.LastBaseCase() :
+            referenceNode.Parent()->Stat().LastDistance();
       else
         baseCase = BaseCase(queryIndex, referenceNode.Point(0));
 
       // Save this evaluation.
-      referenceNode.Stat().LastDistance() = baseCase;
+      if (!parentGiven)
+        referenceNode.Stat().LastDistance() = baseCase;
     }
 
     distance = SortPolicy::CombineBest(baseCase,
@@ -143,11 +527,21 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
   }
 
   // Compare against the best k'th distance for this query point so far.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = WorstCandidateDistance(queryIndex);
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
-  return (SortPolicy::IsBetter(distance, bestDistance)) ?
-      SortPolicy::ConvertToScore(distance) : DBL_MAX;
+  if (!SortPolicy::IsBetter(distance, bestDistance))
+    return DBL_MAX;
+
+  // The node may hold better neighbors, but we can't look for them if the
+  // query point has no work left in its budget.
+  if (BudgetSpent(queryIndex))
+  {
+    truncated[queryIndex] = true;
+    return DBL_MAX;
+  }
+
+  return SortPolicy::ConvertToScore(distance);
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -179,7 +573,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   const double distance = SortPolicy::ConvertToDistance(oldScore);
 
   // Just check the score again against the distances.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = WorstCandidateDistance(queryIndex);
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX;
@@ -404,7 +798,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   // Loop over points held in the node.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const double distance = candidates[queryNode.Point(i)].top().first;
+    const double distance = WorstCandidateDistance(queryNode.Point(i));
     if (SortPolicy::IsBetter(worstDistance, distance))
       worstDistance = distance;
     if (SortPolicy::IsBetter(distance, bestPointDistance))
@@ -499,14 +893,68 @@ InsertNeighbor(
     const size_t neighbor,
     const double distance)
 {
-  CandidateList& pqueue = candidates[queryIndex];
-  Candidate c = std::make_pair(distance, neighbor);
+  double* queryDistances = candidateDistances.colptr(queryIndex);
+  size_t* queryNeighbors = candidateIndices.colptr(queryIndex);
 
-  if (CandidateCmp()(c, pqueue.top()))
+  if (k <= SortedCandidatesLimit)
   {
-    pqueue.pop();
-    pqueue.push(c);
+    // The list is sorted from the best to the worst candidate, so the new
+    // candidate replaces the last one and moves ahead of the worse ones.
+    if (SortPolicy::IsBetter(queryDistances[k - 1], distance))
+      return;
+
+    size_t i = k - 1;
+    while (i > 0 && SortPolicy::IsBetter(distance, queryDistances[i - 1]))
+    {
+      queryDistances[i] = queryDistances[i - 1];
+      queryNeighbors[i] = queryNeighbors[i - 1];
+      --i;
+    }
+
+    queryDistances[i] = distance;
+    queryNeighbors[i] = neighbor;
   }
+  else
+  {
+    // The worst candidate is on top of the heap; replace it.
+    if (SortPolicy::IsBetter(queryDistances[0], distance))
+      return;
+
+    queryDistances[0] = distance;
+    queryNeighbors[0] = neighbor;
+    SiftDownCandidate(queryDistances, queryNeighbors, k);
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::SiftDownCandidate(
+    double* distances,
+    size_t* indices,
+    const size_t size)
+{
+  const double distance = distances[0];
+  const size_t index = indices[0];
+
+  // Move the worse child up as long as it is worse than the candidate.
+  size_t i = 0;
+  size_t child = 1;
+  while (child < size)
+  {
+    if (child + 1 < size &&
+        SortPolicy::IsBetter(distances[child], distances[child + 1]))
+      ++child;
+
+    if (!SortPolicy::IsBetter(distance, distances[child]))
+      break;
+
+    distances[i] = distances[child];
+    indices[i] = indices[child];
+    i = child;
+    child = 2 * i + 1;
+  }
+
+  distances[i] = distance;
+  indices[i] = index;
 }
 
 } // namespace neighbor
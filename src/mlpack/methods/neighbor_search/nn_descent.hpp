@@ -0,0 +1,234 @@
+/**
+ * @file nn_descent.hpp
+ *
+ * Approximate construction of the k-nearest-neighbor graph of a dataset with
+ * NN-Descent.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * NNDescent builds an approximation of the k-nearest-neighbor graph of a
+ * dataset: the k nearest neighbors of each point, other than the point itself,
+ * in the same format as the monochromatic search of NeighborSearch.  It uses
+ * the NN-Descent algorithm, which is based on the idea that a neighbor of a
+ * neighbor is likely to be a neighbor too:
+ *
+ * @code
+ * @inproceedings{dong2011efficient,
+ *   title={Efficient k-nearest neighbor graph construction for generic
+ *       similarity measures},
+ *   author={Dong, Wei and Charikar, Moses and Li, Kai},
+ *   booktitle={Proceedings of the 20th International Conference on World Wide
+ *       Web (WWW '11)},
+ *   pages={577--586},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * Every point starts with k random neighbors.  In each iteration, the
+ * neighbors of every point (both the points in its list and the points that
+ * have it in their list) are compared with each other, and each pair that is
+ * closer than the k'th neighbor of one of its points is inserted in the list of
+ * that point.  Pairs of neighbors that were already compared in an earlier
+ * iteration are skipped, and only a sample of the new neighbors of each point
+ * (given by the sample rate) is used in each iteration.  The search stops once
+ * fewer than tolerance * k * n neighbors are replaced in an iteration, or after
+ * the given number of iterations; more iterations, a larger sample rate and a
+ * lower tolerance give a higher recall.  Since the cost of an iteration barely
+ * depends on the dimensionality of the data, this is much faster than
+ * tree-based search for high-dimensional data.
+ *
+ * The points are split between the OpenMP threads.  The neighbor lists are not
+ * modified while the pairs are compared: each thread keeps the insertions it
+ * finds in its own buffers (one for each range of points), and then each thread
+ * applies the insertions for its range of points, so that no lock is needed.
+ *
+ * @code
+ * NNDescent<> nnDescent;
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * nnDescent.Compute(dataset, 10, neighbors, distances);
+ * @endcode
+ *
+ * @tparam MetricType Metric to use for the distances (for instance LMetric or
+ *     IPMetric).
+ * @tparam MatType Type of the dataset.
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat>
+class NNDescent
+{
+ public:
+  /**
+   * Create the NNDescent object with the given parameters.
+   *
+   * @param maxIterations Maximum number of iterations (at least 1).
+   * @param sampleRate Fraction of the new neighbors of each point that are
+   *     compared in each iteration (in (0, 1]).
+   * @param tolerance The search stops once fewer than tolerance * k * n
+   *     neighbors are replaced in an iteration.
+   * @param metric Instantiated metric.
+   */
+  NNDescent(const size_t maxIterations = 10,
+            const double sampleRate = 1.0,
+            const double tolerance = 0.001,
+            const MetricType metric = MetricType());
+
+  /**
+   * Compute the approximate k nearest neighbors of each point of the dataset.
+   * Column i of the results holds the neighbors of point i, sorted by
+   * increasing distance.
+   *
+   * @param dataset Dataset to build the graph of.
+   * @param k Number of neighbors of each point (less than the number of
+   *     points).
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances to the neighbors in.
+   */
+  void Compute(const MatType& dataset,
+               const size_t k,
+               arma::Mat<size_t>& neighbors,
+               arma::mat& distances);
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the sample rate.
+  double SampleRate() const { return sampleRate; }
+  //! Modify the sample rate.
+  double& SampleRate() { return sampleRate; }
+
+  //! Get the tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get the number of iterations of the last call to Compute().
+  size_t Iterations() const { return iterations; }
+  //! Get the number of distances computed by the last call to Compute().
+  size_t BaseCases() const { return baseCases; }
+
+ private:
+  //! An entry of the neighbor list of a point.
+  struct Candidate
+  {
+    //! The distance to the neighbor.
+    double distance;
+    //! The index of the neighbor.
+    size_t index;
+    //! Whether the neighbor has not been compared with the others yet.
+    bool isNew;
+  };
+
+  //! A neighbor to insert in the list of a point.
+  struct Insertion
+  {
+    //! The point whose list the neighbor is inserted in.
+    size_t point;
+    //! The index of the neighbor.
+    size_t index;
+    //! The distance to the neighbor.
+    double distance;
+  };
+
+  //! Order candidates by distance, so that the heap of each list has the
+  //! furthest neighbor on top.
+  static bool CandidateComparator(const Candidate& a, const Candidate& b)
+  {
+    return a.distance < b.distance;
+  }
+
+  /**
+   * Add a random sample of the given reverse neighbors of a point to its list
+   * of neighbors (to compare), without duplicates.
+   *
+   * @param list Neighbors of the point to compare.
+   * @param reverse Points that have the point as a neighbor (they are
+   *     reordered).
+   * @param sampleSize The largest number of reverse neighbors to add.
+   * @param stream Random stream of the point.
+   */
+  static void MergeSample(std::vector<size_t>& list,
+                          std::vector<size_t>& reverse,
+                          const size_t sampleSize,
+                          math::RandomStream& stream);
+
+  /**
+   * Compute the distance between two neighbors of a point, and store the
+   * insertions in their lists if they are closer than the furthest neighbor.
+   *
+   * @param dataset Dataset of the points.
+   * @param a Index of the first neighbor.
+   * @param b Index of the second neighbor.
+   * @param threadBuffers The buffers of the calling thread (one for each range
+   *     of points).
+   * @param threads The number of ranges of points.
+   */
+  void Compare(const MatType& dataset,
+               const size_t a,
+               const size_t b,
+               std::vector<Insertion>* threadBuffers,
+               const size_t threads);
+
+  /**
+   * Insert the given neighbor in the list of the given point, if it is closer
+   * than the furthest neighbor in the list and not already in it.
+   *
+   * @return Whether the neighbor was inserted.
+   */
+  bool Insert(const size_t point, const size_t index, const double distance);
+
+  //! Get the distance to the furthest neighbor in the list of a point.
+  double Furthest(const size_t point) const
+  {
+    return graph[point * k].distance;
+  }
+
+  //! The maximum number of iterations.
+  size_t maxIterations;
+  //! The fraction of the new neighbors that are compared in each iteration.
+  double sampleRate;
+  //! The fraction of the neighbors that must change for another iteration.
+  double tolerance;
+  //! The metric.
+  MetricType metric;
+
+  //! The number of neighbors of each point, during Compute().
+  size_t k;
+  //! The neighbor list of each point (k candidates for each point, stored as
+  //! a heap), during Compute().
+  std::vector<Candidate> graph;
+
+  //! The number of iterations of the last call to Compute().
+  size_t iterations;
+  //! The number of distances computed by the last call to Compute().
+  size_t baseCases;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "nn_descent_impl.hpp"
+
+#endif
@@ -0,0 +1,326 @@
+/**
+ * @file nn_descent_impl.hpp
+ *
+ * Implementation of the NNDescent class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "nn_descent.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename MetricType, typename MatType>
+NNDescent<MetricType, MatType>::NNDescent(const size_t maxIterations,
+                                          const double sampleRate,
+                                          const double tolerance,
+                                          const MetricType metric) :
+    maxIterations(maxIterations),
+    sampleRate(sampleRate),
+    tolerance(tolerance),
+    metric(metric),
+    k(0),
+    iterations(0),
+    baseCases(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Compute(const MatType& dataset,
+                                             const size_t k,
+                                             arma::Mat<size_t>& neighbors,
+                                             arma::mat& distances)
+{
+  const size_t n = dataset.n_cols;
+  if (k == 0 || k >= n)
+  {
+    std::ostringstream oss;
+    oss << "NNDescent::Compute(): invalid k (" << k << "); must be greater "
+        << "than 0 and less than the number of points (" << n << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (maxIterations == 0)
+    throw std::invalid_argument("NNDescent::Compute(): the maximum number of "
+        "iterations must be greater than 0");
+  if (sampleRate <= 0.0 || sampleRate > 1.0)
+    throw std::invalid_argument("NNDescent::Compute(): the sample rate must be "
+        "in (0, 1]");
+  if (tolerance < 0.0)
+    throw std::invalid_argument("NNDescent::Compute(): the tolerance must be "
+        "non-negative");
+
+  Timer::Start("computing_neighbors");
+
+  this->k = k;
+  graph.resize(n * k);
+  iterations = 0;
+  baseCases = n * k;
+
+  const size_t threads = ParallelThreads();
+  const size_t sampleSize = std::max((size_t) 1,
+      (size_t) std::ceil(sampleRate * k));
+
+  // Start with k distinct random neighbors for each point.
+  const uint64_t initialSeed = math::RandomStreamSeed();
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 256)
+  for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+  {
+    const size_t point = (size_t) i;
+    math::RandomStream stream(initialSeed, point);
+    Candidate* list = &graph[point * k];
+    for (size_t j = 0; j < k; ++j)
+    {
+      size_t index;
+      bool duplicate;
+      do
+      {
+        // Draw from every point but this one.
+        index = std::min((size_t) (stream.Random() * (n - 1)), n - 2);
+        if (index >= point)
+          ++index;
+
+        duplicate = false;
+        for (size_t l = 0; l < j && !duplicate; ++l)
+          duplicate = (list[l].index == index);
+      } while (duplicate);
+
+      list[j].distance = metric.Evaluate(dataset.col(point),
+          dataset.col(index));
+      list[j].index = index;
+      list[j].isNew = true;
+    }
+
+    std::make_heap(list, list + k, CandidateComparator);
+  }
+
+  std::vector<std::vector<size_t>> newNeighbors(n), oldNeighbors(n);
+  std::vector<std::vector<size_t>> newReverse(n), oldReverse(n);
+  // The insertions found by each thread, for the points of each thread.
+  std::vector<std::vector<Insertion>> buffers(threads * threads);
+
+  while (iterations < maxIterations)
+  {
+    ++iterations;
+    const uint64_t seed = math::RandomStreamSeed();
+
+    // Split the neighbors of each point into the old ones and a sample of the
+    // new ones, which will not be new in the next iteration.
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 256)
+    for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+    {
+      const size_t point = (size_t) i;
+      math::RandomStream stream(seed, point);
+      Candidate* list = &graph[point * k];
+
+      std::vector<size_t> newPositions;
+      oldNeighbors[point].clear();
+      for (size_t j = 0; j < k; ++j)
+      {
+        if (list[j].isNew)
+          newPositions.push_back(j);
+        else
+          oldNeighbors[point].push_back(list[j].index);
+      }
+
+      if (newPositions.size() > sampleSize)
+      {
+        std::shuffle(newPositions.begin(), newPositions.end(), stream);
+        newPositions.resize(sampleSize);
+      }
+
+      newNeighbors[point].clear();
+      for (size_t j = 0; j < newPositions.size(); ++j)
+      {
+        newNeighbors[point].push_back(list[newPositions[j]].index);
+        list[newPositions[j]].isNew = false;
+      }
+    }
+
+    // Find the points that have each point as a neighbor.
+    for (size_t point = 0; point < n; ++point)
+    {
+      newReverse[point].clear();
+      oldReverse[point].clear();
+    }
+    for (size_t point = 0; point < n; ++point)
+    {
+      for (size_t j = 0; j < newNeighbors[point].size(); ++j)
+        newReverse[newNeighbors[point][j]].push_back(point);
+      for (size_t j = 0; j < oldNeighbors[point].size(); ++j)
+        oldReverse[oldNeighbors[point][j]].push_back(point);
+    }
+
+    // Compare a sample of those points too.
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 256)
+    for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+    {
+      const size_t point = (size_t) i;
+      math::RandomStream stream(seed, n + point);
+      MergeSample(newNeighbors[point], newReverse[point], sampleSize, stream);
+      MergeSample(oldNeighbors[point], oldReverse[point], sampleSize, stream);
+    }
+
+    // Compare the neighbors of each block of points with each other, and then
+    // insert the closer pairs, so that the buffers stay small.
+    size_t updates = 0;
+    const size_t blockSize = 1024 * threads;
+    for (size_t begin = 0; begin < n; begin += blockSize)
+    {
+      const size_t end = std::min(n, begin + blockSize);
+
+      size_t blockBaseCases = 0;
+      #pragma omp parallel num_threads(threads) reduction(+:blockBaseCases)
+      {
+        size_t thread = 0;
+        #ifdef HAS_OPENMP
+          thread = (size_t) omp_get_thread_num();
+        #endif
+        std::vector<Insertion>* threadBuffers = &buffers[thread * threads];
+
+        #pragma omp for schedule(dynamic, 16)
+        for (omp_size_t i = (omp_size_t) begin; i < (omp_size_t) end; ++i)
+        {
+          const std::vector<size_t>& newList = newNeighbors[i];
+          const std::vector<size_t>& oldList = oldNeighbors[i];
+          for (size_t a = 0; a < newList.size(); ++a)
+          {
+            for (size_t b = a + 1; b < newList.size(); ++b)
+            {
+              Compare(dataset, newList[a], newList[b], threadBuffers, threads);
+              ++blockBaseCases;
+            }
+
+            for (size_t b = 0; b < oldList.size(); ++b)
+            {
+              if (newList[a] == oldList[b])
+                continue;
+
+              Compare(dataset, newList[a], oldList[b], threadBuffers, threads);
+              ++blockBaseCases;
+            }
+          }
+        }
+      }
+
+      size_t blockUpdates = 0;
+      #pragma omp parallel for num_threads(threads) schedule(dynamic, 1) \
+          reduction(+:blockUpdates)
+      for (omp_size_t b = 0; b < (omp_size_t) threads; ++b)
+      {
+        for (size_t t = 0; t < threads; ++t)
+        {
+          std::vector<Insertion>& buffer = buffers[t * threads + b];
+          for (size_t j = 0; j < buffer.size(); ++j)
+            if (Insert(buffer[j].point, buffer[j].index, buffer[j].distance))
+              ++blockUpdates;
+          buffer.clear();
+        }
+      }
+
+      baseCases += blockBaseCases;
+      updates += blockUpdates;
+    }
+
+    Log::Info << "NN-Descent iteration " << iterations << ": " << updates
+        << " neighbors replaced." << std::endl;
+    if ((double) updates < tolerance * k * n)
+      break;
+  }
+
+  // Sort the neighbors of each point by distance.
+  neighbors.set_size(k, n);
+  distances.set_size(k, n);
+  #pragma omp parallel for num_threads(threads)
+  for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+  {
+    Candidate* list = &graph[i * k];
+    std::sort_heap(list, list + k, CandidateComparator);
+    for (size_t j = 0; j < k; ++j)
+    {
+      neighbors(j, i) = list[j].index;
+      distances(j, i) = list[j].distance;
+    }
+  }
+
+  std::vector<Candidate>().swap(graph);
+
+  Log::Info << baseCases << " distances were computed in " << iterations
+      << " iterations." << std::endl;
+
+  Timer::Stop("computing_neighbors");
+  Timer::Count("base_cases", baseCases);
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::MergeSample(
+    std::vector<size_t>& list,
+    std::vector<size_t>& reverse,
+    const size_t sampleSize,
+    math::RandomStream& stream)
+{
+  if (reverse.size() > sampleSize)
+  {
+    std::shuffle(reverse.begin(), reverse.end(), stream);
+    reverse.resize(sampleSize);
+  }
+
+  list.insert(list.end(), reverse.begin(), reverse.end());
+  std::sort(list.begin(), list.end());
+  list.erase(std::unique(list.begin(), list.end()), list.end());
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Compare(
+    const MatType& dataset,
+    const size_t a,
+    const size_t b,
+    std::vector<Insertion>* threadBuffers,
+    const size_t threads)
+{
+  const double distance = metric.Evaluate(dataset.col(a), dataset.col(b));
+
+  // The lists are not modified during the comparisons, so this is a good
+  // filter for insertions that would be rejected anyway.
+  const size_t n = graph.size() / k;
+  if (distance < Furthest(a))
+    threadBuffers[a * threads / n].push_back(Insertion { a, b, distance });
+  if (distance < Furthest(b))
+    threadBuffers[b * threads / n].push_back(Insertion { b, a, distance });
+}
+
+template<typename MetricType, typename MatType>
+bool NNDescent<MetricType, MatType>::Insert(const size_t point,
+                                            const size_t index,
+                                            const double distance)
+{
+  Candidate* list = &graph[point * k];
+  if (distance >= list[0].distance)
+    return false;
+
+  for (size_t j = 0; j < k; ++j)
+    if (list[j].index == index)
+      return false;
+
+  // Replace the furthest neighbor.
+  std::pop_heap(list, list + k, CandidateComparator);
+  list[k - 1].distance = distance;
+  list[k - 1].index = index;
+  list[k - 1].isNew = true;
+  std::push_heap(list, list + k, CandidateComparator);
+
+  return true;
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -20,9 +20,12 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/spill_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
 #include <boost/variant.hpp>
 #include "neighbor_search.hpp"
 
+#include <memory>
+
 namespace mlpack {
 namespace neighbor {
 
@@ -32,14 +35,55 @@ namespace neighbor {
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
 using NSType = NeighborSearch<SortPolicy,
                               metric::EuclideanDistance,
-                              arma::mat,
+                              MatType,
                               TreeType,
                               TreeType<metric::EuclideanDistance,
                                   NeighborSearchStat<SortPolicy>,
-                                  arma::mat>::template DualTreeTraverser>;
+                                  MatType>::template DualTreeTraverser>;
+
+/**
+ * Alias template for euclidean neighbor search that uses the multithreaded
+ * dual-tree traverser.  This is only available for BinarySpaceTree types; if
+ * one thread is used, the search is the same as with NSType.
+ */
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
+using ParallelNSType = NeighborSearch<SortPolicy,
+                                      metric::EuclideanDistance,
+                                      MatType,
+                                      TreeType,
+                                      TreeType<metric::EuclideanDistance,
+                                          NeighborSearchStat<SortPolicy>,
+                                          MatType>::template
+                                          ParallelDualTreeTraverser>;
+
+/**
+ * Alias template for euclidean neighbor search with cover trees, where
+ * single-tree search divides the query points between threads.  With one
+ * thread, the search is the same as with NSType.
+ */
+template<typename SortPolicy, typename MatType = arma::mat>
+using CoverTreeNSType = NeighborSearch<SortPolicy,
+                                       metric::EuclideanDistance,
+                                       MatType,
+                                       tree::StandardCoverTree,
+                                       tree::StandardCoverTree<
+                                           metric::EuclideanDistance,
+                                           NeighborSearchStat<SortPolicy>,
+                                           MatType>::template
+                                           DualTreeTraverser,
+                                       tree::StandardCoverTree<
+                                           metric::EuclideanDistance,
+                                           NeighborSearchStat<SortPolicy>,
+                                           MatType>::template
+                                           ParallelSingleTreeTraverser>;
 
 template<typename SortPolicy>
 struct NSModelName
@@ -93,13 +137,16 @@ class MonoSearchVisitor : public boost::static_visitor<void>
  * We use template specialization to differentiate those tree types that
  * accept leafSize as a parameter. In these cases, before doing neighbor search,
  * a query tree with proper leafSize is built from the querySet.
+ *
+ * @tparam MatType Type of the query set; this must be the type of the matrices
+ *     that the visited NSType instances are built on.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class BiSearchVisitor : public boost::static_visitor<void>
 {
  private:
   //! The query set for the bichromatic search.
-  const arma::mat& querySet;
+  const MatType& querySet;
   //! The number of neighbors to search for.
   const size_t k;
   //! The result matrix for neighbors.
@@ -122,7 +169,7 @@ class BiSearchVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
 
   //! Default Bichromatic neighbor search on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -131,10 +178,15 @@ class BiSearchVisitor : public boost::static_visitor<void>
   void operator()(NSTypeT<TreeType>* ns) const;
 
   //! Bichromatic neighbor search on the given NSType specialized for KDTrees.
-  void operator()(NSTypeT<tree::KDTree>* ns) const;
+  void operator()(ParallelNSType<SortPolicy, tree::KDTree, MatType>* ns) const;
 
   //! Bichromatic neighbor search on the given NSType specialized for BallTrees.
-  void operator()(NSTypeT<tree::BallTree>* ns) const;
+  void operator()(ParallelNSType<SortPolicy, tree::BallTree, MatType>* ns)
+      const;
+
+  //! Bichromatic neighbor search on the given NSType specialized for cover
+  //! trees.
+  void operator()(CoverTreeNSType<SortPolicy, MatType>* ns) const;
 
   //! Bichromatic neighbor search specialized for SPTrees.
   void operator()(SpillKNN* ns) const;
@@ -143,7 +195,7 @@ class BiSearchVisitor : public boost::static_visitor<void>
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
   //! Construct the BiSearchVisitor.
-  BiSearchVisitor(const arma::mat& querySet,
+  BiSearchVisitor(const MatType& querySet,
                   const size_t k,
                   arma::Mat<size_t>& neighbors,
                   arma::mat& distances,
@@ -157,13 +209,16 @@ class BiSearchVisitor : public boost::static_visitor<void>
  * NSType. We use template specialization to differentiate those tree types that
  * accept leafSize as a parameter. In these cases, a reference tree with proper
  * leafSize is built from the referenceSet.
+ *
+ * @tparam MatType Type of the reference set; this must be the type of the
+ *     matrices that the visited NSType instances are built on.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class TrainVisitor : public boost::static_visitor<void>
 {
  private:
   //! The reference set to use for training.
-  arma::mat&& referenceSet;
+  MatType&& referenceSet;
   //! The leaf size, used only by BinarySpaceTree.
   size_t leafSize;
   //! Overlapping size (for spill trees).
@@ -180,7 +235,7 @@ class TrainVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
 
   //! Default Train on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -189,10 +244,14 @@ class TrainVisitor : public boost::static_visitor<void>
   void operator()(NSTypeT<TreeType>* ns) const;
 
   //! Train on the given NSType specialized for KDTrees.
-  void operator()(NSTypeT<tree::KDTree>* ns) const;
+  void operator()(ParallelNSType<SortPolicy, tree::KDTree, MatType>* ns) const;
 
   //! Train on the given NSType specialized for BallTrees.
-  void operator()(NSTypeT<tree::BallTree>* ns) const;
+  void operator()(ParallelNSType<SortPolicy, tree::BallTree, MatType>* ns)
+      const;
+
+  //! Train on the given NSType specialized for cover trees.
+  void operator()(CoverTreeNSType<SortPolicy, MatType>* ns) const;
 
   //! Train specialized for SPTrees.
   void operator()(SpillKNN* ns) const;
@@ -202,7 +261,7 @@ class TrainVisitor : public boost::static_visitor<void>
 
   //! Construct the TrainVisitor object with the given reference set, leafSize
   //! for BinarySpaceTrees, and tau and rho for spill trees.
-  TrainVisitor(arma::mat&& referenceSet,
+  TrainVisitor(MatType&& referenceSet,
                const size_t leafSize,
                const double tau,
                const double rho);
@@ -232,13 +291,55 @@ class EpsilonVisitor : public boost::static_visitor<double&>
 
 /**
  * ReferenceSetVisitor exposes the referenceSet of the given NSType.
+ *
+ * @tparam MatType Type of the reference set.
  */
-class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
+template<typename MatType = arma::mat>
+class ReferenceSetVisitor : public boost::static_visitor<const MatType&>
 {
  public:
   //! Return the reference set.
   template<typename NSType>
-  const arma::mat& operator()(NSType *ns) const;
+  const MatType& operator()(NSType *ns) const;
+};
+
+/**
+ * InsertVisitor adds points to the reference set of the given NSType.
+ *
+ * @tparam MatType Type of the points.
+ */
+template<typename MatType = arma::mat>
+class InsertVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The points to add.
+  const MatType& points;
+
+ public:
+  //! Add the points to the reference set.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Construct the InsertVisitor object with the given points.
+  InsertVisitor(const MatType& points) : points(points) { }
+};
+
+/**
+ * RemoveVisitor removes points from the reference set of the given NSType.
+ */
+class RemoveVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The indices of the points to remove.
+  const arma::Col<size_t>& indices;
+
+ public:
+  //! Remove the points from the reference set.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Construct the RemoveVisitor object with the given indices.
+  RemoveVisitor(const arma::Col<size_t>& indices) : indices(indices) { }
 };
 
 /**
@@ -260,6 +361,18 @@ class DeleteVisitor : public boost::static_visitor<void>
  * flexibility as the NeighborSearch class.  So if you are using it outside of
  * mlpack_knn and mlpack_kfn, be aware that it is limited!
  *
+ * A model may also be built in single precision, with BuildModel() on an
+ * arma::fmat; its reference set and tree then take half the memory.  This is
+ * only possible with kd-trees, ball trees and octrees.  Query sets are
+ * converted to the precision of the model, and distances are always returned
+ * as doubles.
+ *
+ * Similarly, a model may be built on a sparse reference set, with BuildModel()
+ * on an arma::sp_mat, again only with kd-trees and ball trees (or in naive
+ * mode).  The reference set then takes memory proportional to its number of
+ * nonzeros, and distances between sparse points are computed from their
+ * nonzero elements only.  Dense query sets are converted to sparse matrices.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  */
 template<typename SortPolicy>
@@ -308,11 +421,11 @@ class NSModel
    * treeType. It is initialized every time BuildModel is executed.
    * We access to the contained value through the visitor classes defined above.
    */
-  boost::variant<NSType<SortPolicy, tree::KDTree>*,
-                 NSType<SortPolicy, tree::StandardCoverTree>*,
+  boost::variant<ParallelNSType<SortPolicy, tree::KDTree>*,
+                 CoverTreeNSType<SortPolicy>*,
                  NSType<SortPolicy, tree::RTree>*,
                  NSType<SortPolicy, tree::RStarTree>*,
-                 NSType<SortPolicy, tree::BallTree>*,
+                 ParallelNSType<SortPolicy, tree::BallTree>*,
                  NSType<SortPolicy, tree::XTree>*,
                  NSType<SortPolicy, tree::HilbertRTree>*,
                  NSType<SortPolicy, tree::RPlusTree>*,
@@ -324,6 +437,116 @@ class NSModel
                  NSType<SortPolicy, tree::UBTree>*,
                  NSType<SortPolicy, tree::Octree>*> nSearch;
 
+  //! If true, the model was built in single precision and nSearchSingle is
+  //! used instead of nSearch.
+  bool singlePrecision;
+
+  /**
+   * nSearchSingle holds the instance of the NeighborSearch class for models
+   * built in single precision, which are only available for kd-trees, ball
+   * trees and octrees.
+   */
+  boost::variant<ParallelNSType<SortPolicy, tree::KDTree, arma::fmat>*,
+                 ParallelNSType<SortPolicy, tree::BallTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::Octree, arma::fmat>*>
+      nSearchSingle;
+
+  //! If true, the model was built on a sparse reference set and nSearchSparse
+  //! is used instead of nSearch.
+  bool sparse;
+
+  /**
+   * nSearchSparse holds the instance of the NeighborSearch class for models
+   * built on sparse reference sets, which are only available for kd-trees and
+   * ball trees.
+   */
+  boost::variant<ParallelNSType<SortPolicy, tree::KDTree, arma::sp_mat>*,
+                 ParallelNSType<SortPolicy, tree::BallTree, arma::sp_mat>*>
+      nSearchSparse;
+
+  //! If the model was loaded with LoadIndex(), the mapped index file, which
+  //! holds the reference set; otherwise NULL.
+  std::shared_ptr<data::MappedFile> mappedIndex;
+
+  //! The header of an index file written by SaveIndex().
+  struct IndexHeader
+  {
+    //! Identifies the format.
+    char magic[8];
+    //! Version of the format.
+    uint64_t version;
+    //! Name of the model (see NSModelName), which identifies the sort policy.
+    char name[64];
+    uint64_t treeType;
+    //! Size in bytes of each element of the reference set.
+    uint64_t elementSize;
+    uint64_t leafSize;
+    uint64_t randomBasis;
+    uint64_t searchMode;
+    double epsilon;
+    //! Size of the random basis, which follows the header.
+    uint64_t basisRows;
+    uint64_t basisCols;
+    //! Offset of the tree, which is a multiple of 4096.
+    uint64_t treeOffset;
+  };
+
+  //! The header of an index file of version 1, which had no elementSize (the
+  //! reference set was always in double precision).
+  struct IndexHeaderV1
+  {
+    char magic[8];
+    uint64_t version;
+    char name[64];
+    uint64_t treeType;
+    uint64_t leafSize;
+    uint64_t randomBasis;
+    uint64_t searchMode;
+    double epsilon;
+    uint64_t basisRows;
+    uint64_t basisCols;
+    uint64_t treeOffset;
+  };
+
+  //! Save the tree of the NeighborSearch object of the given type as the tree
+  //! of an index.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType,
+           typename MatType,
+           typename VariantType>
+  void SaveIndexTree(const VariantType& search,
+                     std::ostream& stream,
+                     const bool saveReferenceSet) const;
+
+  //! Load the tree of an index as the tree of a new NeighborSearch object of
+  //! the given type.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType,
+           typename MatType,
+           typename VariantType>
+  void LoadIndexTree(VariantType& search,
+                     const data::MappedFile& file,
+                     const size_t offset,
+                     const NeighborSearchMode searchMode,
+                     const double epsilon,
+                     const arma::mat* referenceSet);
+
+  //! Load a model from an index, with the given reference set if the index
+  //! does not hold it.
+  void LoadIndex(const std::string& filename, const arma::mat* referenceSet);
+
+  //! Delete the NeighborSearch object, whichever precision it has, or whether
+  //! it is sparse.
+  void Clean();
+
+  //! Create the random basis q for the given dimensionality.
+  void BuildRandomBasis(const size_t dimensionality);
+
+  //! Log the kind of search that is about to be performed.
+  void LogSearch(const size_t k);
+
  public:
   /**
    * Initialize the NSModel with the given type and whether or not a random
@@ -370,8 +593,18 @@ class NSModel
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
 
-  //! Expose the dataset.
+  //! Expose the dataset.  This may only be used if the model is neither in
+  //! single precision nor sparse.
   const arma::mat& Dataset() const;
+  //! Expose the dataset of a model in single precision.
+  const arma::fmat& SinglePrecisionDataset() const;
+  //! Expose the dataset of a sparse model.
+  const arma::sp_mat& SparseDataset() const;
+
+  //! Get whether the model was built in single precision.
+  bool SinglePrecision() const { return singlePrecision; }
+  //! Get whether the model was built on a sparse reference set.
+  bool Sparse() const { return sparse; }
 
   //! Expose SearchMode.
   NeighborSearchMode SearchMode() const;
@@ -407,17 +640,125 @@ class NSModel
                   const NeighborSearchMode searchMode,
                   const double epsilon = 0);
 
-  //! Perform neighbor search.  The query set will be reordered.
+  /**
+   * Build the reference tree in single precision.  Only kd-trees, ball trees
+   * and octrees can be built in single precision; for other tree types, a
+   * std::invalid_argument is thrown.
+   */
+  void BuildModel(arma::fmat&& referenceSet,
+                  const size_t leafSize,
+                  const NeighborSearchMode searchMode,
+                  const double epsilon = 0);
+
+  /**
+   * Build the reference tree on a sparse reference set.  Only kd-trees and
+   * ball trees can be built on sparse data, and no random basis can be used
+   * (the projected points would be dense); otherwise, a std::invalid_argument
+   * is thrown.
+   */
+  void BuildModel(arma::sp_mat&& referenceSet,
+                  const size_t leafSize,
+                  const NeighborSearchMode searchMode,
+                  const double epsilon = 0);
+
+  //! Perform neighbor search.  The query set will be reordered.  If the model
+  //! is in single precision, the query set is converted first.
   void Search(arma::mat&& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  //! Perform neighbor search with a single-precision query set.  The query set
+  //! will be reordered.  If the model is not in single precision, the query set
+  //! is converted first.
+  void Search(arma::fmat&& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Perform neighbor search with a sparse query set.  The query set will be
+  //! reordered.  If the model is not sparse, the query set is converted to a
+  //! dense matrix first.
+  void Search(arma::sp_mat&& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
   //! Perform monochromatic neighbor search.
   void Search(const size_t k,
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Add the given points to the reference set, without rebuilding the
+   * reference tree.  This is only possible for the R tree variants (R, R*, X,
+   * Hilbert R, R+ and R++ trees), whose trees support point insertion, and in
+   * naive mode, for models that are not sparse; otherwise, a
+   * std::invalid_argument is thrown.  If a random
+   * basis is used, the points are projected onto it first.
+   *
+   * @param points Points to add to the reference set.
+   */
+  void Insert(const arma::mat& points);
+
+  /**
+   * Remove the reference points with the given indices, without rebuilding the
+   * reference tree.  The remaining points keep their order (see
+   * NeighborSearch::Remove()).  This is possible in the same cases as
+   * Insert().
+   *
+   * @param indices Indices of the reference points to remove.
+   */
+  void Remove(const arma::Col<size_t>& indices);
+
+  /**
+   * Save the model to the given file as a flat index, which LoadIndex() can
+   * use in place from a memory-mapped file instead of deserializing it.  Only
+   * kd-tree and ball tree models that are not in naive mode can be saved this
+   * way, and sparse models cannot; otherwise, a std::invalid_argument is
+   * thrown.  A model in single precision is saved in single precision.
+   *
+   * If saveReferenceSet is false, the reference set is left out of the index,
+   * which then holds only the tree and the permutation of the points; the
+   * index must be loaded with the reference set (in its original form, as
+   * given to BuildModel()).  This way, several indexes of one large dataset
+   * do not each hold a copy of it.
+   *
+   * @param filename File to save to.
+   * @param saveReferenceSet Whether to save the reference set in the index.
+   */
+  void SaveIndex(const std::string& filename,
+                 const bool saveReferenceSet = true) const;
+
+  /**
+   * Load a model from an index saved with SaveIndex().  The file is mapped
+   * into memory and the reference set is used in place, so loading is fast,
+   * and several processes that load the same index share one copy of the
+   * reference set.  The file must not be modified while the model is in use.
+   * A std::runtime_error is thrown if the file is not a valid index for this
+   * kind of model.
+   *
+   * @param filename File to load from.
+   */
+  void LoadIndex(const std::string& filename);
+
+  /**
+   * Load a model from an index saved with SaveIndex(), with the given
+   * reference set, which must be the one the model was built on; this is how
+   * an index saved without its reference set is loaded.  The reference set
+   * is projected onto the random basis of the model, if it has one, and
+   * permuted into the order of the tree; the model holds its own copy of it,
+   * so neither the file nor the given matrix (which may be a
+   * data::MappedMatrix) are used after this returns.  A std::invalid_argument
+   * is thrown if the reference set does not have the size of the one the
+   * model was built on, and a std::runtime_error if the file is not a valid
+   * index for this kind of model.
+   *
+   * @param filename File to load from.
+   * @param referenceSet Reference set the model was built on.
+   */
+  void LoadIndex(const std::string& filename, const arma::mat& referenceSet);
+
   //! Return a string representation of the current tree type.
   std::string TreeName() const;
 };
@@ -427,7 +768,7 @@ class NSModel
 
 //! Set the serialization version of the NSModel class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::NSModel<SortPolicy>, 1);
+    mlpack::neighbor::NSModel<SortPolicy>, 3);
 
 // Include implementation.
 #include "ns_model_impl.hpp"
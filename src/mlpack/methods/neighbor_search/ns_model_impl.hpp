@@ -20,6 +20,9 @@
 
 #include <boost/serialization/variant.hpp>
 
+#include <cstring>
+#include <fstream>
+
 namespace mlpack {
 namespace neighbor {
 
@@ -33,14 +36,15 @@ void MonoSearchVisitor::operator()(NSType *ns) const
 }
 
 //! Save parameters for bichromatic neighbor search.
-template<typename SortPolicy>
-BiSearchVisitor<SortPolicy>::BiSearchVisitor(const arma::mat& querySet,
-                                             const size_t k,
-                                             arma::Mat<size_t>& neighbors,
-                                             arma::mat& distances,
-                                             const size_t leafSize,
-                                             const double tau,
-                                             const double rho) :
+template<typename SortPolicy, typename MatType>
+BiSearchVisitor<SortPolicy, MatType>::BiSearchVisitor(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const size_t leafSize,
+    const double tau,
+    const double rho) :
     querySet(querySet),
     k(k),
     neighbors(neighbors),
@@ -51,11 +55,12 @@ BiSearchVisitor<SortPolicy>::BiSearchVisitor(const arma::mat& querySet,
 {}
 
 //! Default Bichromatic neighbor search on the given NSType instance.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
+void BiSearchVisitor<SortPolicy, MatType>::operator()(NSTypeT<TreeType>* ns)
+    const
 {
   if (ns)
     return ns->Search(querySet, k, neighbors, distances);
@@ -63,8 +68,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType specialized for KDTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    ParallelNSType<SortPolicy, tree::KDTree, MatType>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -72,17 +78,29 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType specialized for BallTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    ParallelNSType<SortPolicy, tree::BallTree, MatType>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Bichromatic neighbor search on the given NSType specialized for cover
+//! trees.
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    CoverTreeNSType<SortPolicy, MatType>* ns) const
+{
+  if (ns)
+    return ns->Search(querySet, k, neighbors, distances);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Bichromatic neighbor search specialized for SPTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(SpillKNN* ns) const
 {
   if (ns)
   {
@@ -102,8 +120,9 @@ void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
 }
 
 //! Bichromatic neighbor search specialized for octrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(NSTypeT<tree::Octree>* ns)
+    const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -111,9 +130,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType considering the leafSize.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<typename NSType>
-void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
+void BiSearchVisitor<SortPolicy, MatType>::SearchLeaf(NSType* ns) const
 {
   if (ns->SearchMode() == DUAL_TREE_MODE)
   {
@@ -139,11 +158,11 @@ void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
 }
 
 //! Save parameters for Train.
-template<typename SortPolicy>
-TrainVisitor<SortPolicy>::TrainVisitor(arma::mat&& referenceSet,
-                                       const size_t leafSize,
-                                       const double tau,
-                                       const double rho) :
+template<typename SortPolicy, typename MatType>
+TrainVisitor<SortPolicy, MatType>::TrainVisitor(MatType&& referenceSet,
+                                                const size_t leafSize,
+                                                const double tau,
+                                                const double rho) :
     referenceSet(std::move(referenceSet)),
     leafSize(leafSize),
     tau(tau),
@@ -151,11 +170,11 @@ TrainVisitor<SortPolicy>::TrainVisitor(arma::mat&& referenceSet,
 {}
 
 //! Default Train on the given NSType instance.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
+void TrainVisitor<SortPolicy, MatType>::operator()(NSTypeT<TreeType>* ns) const
 {
   if (ns)
     return ns->Train(std::move(referenceSet));
@@ -163,8 +182,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
 }
 
 //! Train on the given NSType specialized for KDTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    ParallelNSType<SortPolicy, tree::KDTree, MatType>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -172,17 +192,28 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 }
 
 //! Train on the given NSType specialized for BallTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    ParallelNSType<SortPolicy, tree::BallTree, MatType>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Train on the given NSType specialized for cover trees.
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    CoverTreeNSType<SortPolicy, MatType>* ns) const
+{
+  if (ns)
+    return ns->Train(std::move(referenceSet));
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Train specialized for SPTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(SpillKNN* ns) const
 {
   if (ns)
   {
@@ -199,8 +230,9 @@ void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
 }
 
 //! Train specialized for Octrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(NSTypeT<tree::Octree>* ns)
+    const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -208,9 +240,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 }
 
 //! Train on the given NSType considering the leafSize.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<typename NSType>
-void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
+void TrainVisitor<SortPolicy, MatType>::TrainLeaf(NSType* ns) const
 {
   if (ns->SearchMode() == NAIVE_MODE)
     ns->Train(std::move(referenceSet));
@@ -221,7 +253,7 @@ void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
         oldFromNewReferences, leafSize);
     ns->Train(std::move(referenceTree));
     // Set the mappings.
-    ns->oldFromNewReferences = std::move(oldFromNewReferences);
+    ns->OldFromNewReferences() = std::move(oldFromNewReferences);
   }
 }
 
@@ -244,14 +276,34 @@ double& EpsilonVisitor::operator()(NSType* ns) const
 }
 
 //! Expose the referenceSet of the given NSType.
+template<typename MatType>
 template<typename NSType>
-const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
+const MatType& ReferenceSetVisitor<MatType>::operator()(NSType* ns) const
 {
   if (ns)
     return ns->ReferenceSet();
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Add points to the reference set.
+template<typename MatType>
+template<typename NSType>
+void InsertVisitor<MatType>::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->Insert(points);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Remove points from the reference set.
+template<typename NSType>
+void RemoveVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->Remove(indices);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Clean memory, if necessary.
 template<typename NSType>
 void DeleteVisitor::operator()(NSType* ns) const
@@ -270,7 +322,9 @@ NSModel<SortPolicy>::NSModel(TreeTypes treeType, bool randomBasis) :
     leafSize(20),
     tau(0),
     rho(0.7),
-    randomBasis(randomBasis)
+    randomBasis(randomBasis),
+    singlePrecision(false),
+    sparse(false)
 {
   // Nothing to do.
 }
@@ -283,7 +337,12 @@ NSModel<SortPolicy>::NSModel(const NSModel& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(other.q),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    singlePrecision(other.singlePrecision),
+    nSearchSingle(other.nSearchSingle),
+    sparse(other.sparse),
+    nSearchSparse(other.nSearchSparse),
+    mappedIndex(other.mappedIndex)
 {
   // Nothing to do.
 }
@@ -296,7 +355,12 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    singlePrecision(other.singlePrecision),
+    nSearchSingle(other.nSearchSingle),
+    sparse(other.sparse),
+    nSearchSparse(other.nSearchSparse),
+    mappedIndex(std::move(other.mappedIndex))
 {
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -305,12 +369,16 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
   other.rho = 0.7;
   other.randomBasis = false;
   other.nSearch = decltype(other.nSearch)();
+  other.singlePrecision = false;
+  other.nSearchSingle = decltype(other.nSearchSingle)();
+  other.sparse = false;
+  other.nSearchSparse = decltype(other.nSearchSparse)();
 }
 
 template<typename SortPolicy>
 NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
 {
-  boost::apply_visitor(DeleteVisitor(), nSearch);
+  Clean();
 
   treeType = other.treeType;
   leafSize = other.leafSize;
@@ -319,6 +387,11 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
   randomBasis = other.randomBasis;
   q = other.q;
   nSearch = other.nSearch;
+  singlePrecision = other.singlePrecision;
+  nSearchSingle = other.nSearchSingle;
+  sparse = other.sparse;
+  nSearchSparse = other.nSearchSparse;
+  mappedIndex = other.mappedIndex;
 
   return *this;
 }
@@ -326,7 +399,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
 template<typename SortPolicy>
 NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
 {
-  boost::apply_visitor(DeleteVisitor(), nSearch);
+  Clean();
 
   treeType = other.treeType;
   leafSize = other.leafSize;
@@ -334,8 +407,13 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   rho = other.rho;
   randomBasis = other.randomBasis;
   q = std::move(other.q);
-  // Copy the pointer and type.
+  // Copy the pointers and types.
   nSearch = other.nSearch;
+  singlePrecision = other.singlePrecision;
+  nSearchSingle = other.nSearchSingle;
+  sparse = other.sparse;
+  nSearchSparse = other.nSearchSparse;
+  mappedIndex = std::move(other.mappedIndex);
 
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -344,6 +422,10 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   other.rho = 0.7;
   other.randomBasis = false;
   other.nSearch = decltype(other.nSearch)();
+  other.singlePrecision = false;
+  other.nSearchSingle = decltype(other.nSearchSingle)();
+  other.sparse = false;
+  other.nSearchSparse = decltype(other.nSearchSparse)();
 
   return *this;
 }
@@ -352,7 +434,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
 template<typename SortPolicy>
 NSModel<SortPolicy>::~NSModel()
 {
-  boost::apply_visitor(DeleteVisitor(), nSearch);
+  Clean();
 }
 
 /**
@@ -362,6 +444,7 @@ NSModel<SortPolicy>::~NSModel()
  */
 template<typename Archive,
          typename SortPolicy,
+         typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
@@ -371,7 +454,7 @@ void serialize(
     Archive& ar,
     NeighborSearch<SortPolicy,
                    metric::EuclideanDistance,
-                   arma::mat,
+                   MatType,
                    TreeType,
                    TraversalType,
                    SingleTreeTraversalType>& ns,
@@ -399,23 +482,68 @@ void NSModel<SortPolicy>::Serialize(Archive& ar, const unsigned int version)
 
   // This should never happen, but just in case, be clean with memory.
   if (Archive::is_loading::value)
-    boost::apply_visitor(DeleteVisitor(), nSearch);
+    Clean();
+
+  // Models in single precision were added in version 2.
+  if (version > 1)
+    ar & data::CreateNVP(singlePrecision, "singlePrecision");
+
+  // Sparse models were added in version 3.
+  if (version > 2)
+    ar & data::CreateNVP(sparse, "sparse");
 
   const std::string& name = NSModelName<SortPolicy>::Name();
-  ar & data::CreateNVP(nSearch, name);
+  if (singlePrecision)
+    ar & data::CreateNVP(nSearchSingle, name);
+  else if (sparse)
+    ar & data::CreateNVP(nSearchSparse, name);
+  else
+    ar & data::CreateNVP(nSearch, name);
 }
 
 //! Expose the dataset.
 template<typename SortPolicy>
 const arma::mat& NSModel<SortPolicy>::Dataset() const
 {
-  return boost::apply_visitor(ReferenceSetVisitor(), nSearch);
+  if (singlePrecision)
+    throw std::invalid_argument("NSModel::Dataset(): the model is in single "
+        "precision; use SinglePrecisionDataset()");
+  if (sparse)
+    throw std::invalid_argument("NSModel::Dataset(): the model is sparse; use "
+        "SparseDataset()");
+  return boost::apply_visitor(ReferenceSetVisitor<arma::mat>(), nSearch);
+}
+
+//! Expose the dataset of a model in single precision.
+template<typename SortPolicy>
+const arma::fmat& NSModel<SortPolicy>::SinglePrecisionDataset() const
+{
+  if (!singlePrecision)
+    throw std::invalid_argument("NSModel::SinglePrecisionDataset(): the model "
+        "is not in single precision; use Dataset()");
+  return boost::apply_visitor(ReferenceSetVisitor<arma::fmat>(),
+      nSearchSingle);
+}
+
+//! Expose the dataset of a sparse model.
+template<typename SortPolicy>
+const arma::sp_mat& NSModel<SortPolicy>::SparseDataset() const
+{
+  if (!sparse)
+    throw std::invalid_argument("NSModel::SparseDataset(): the model is not "
+        "sparse; use Dataset()");
+  return boost::apply_visitor(ReferenceSetVisitor<arma::sp_mat>(),
+      nSearchSparse);
 }
 
 //! Access the search mode.
 template<typename SortPolicy>
 NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
 {
+  if (singlePrecision)
+    return boost::apply_visitor(SearchModeVisitor(), nSearchSingle);
+  if (sparse)
+    return boost::apply_visitor(SearchModeVisitor(), nSearchSparse);
   return boost::apply_visitor(SearchModeVisitor(), nSearch);
 }
 
@@ -423,18 +551,30 @@ NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
 template<typename SortPolicy>
 NeighborSearchMode& NSModel<SortPolicy>::SearchMode()
 {
+  if (singlePrecision)
+    return boost::apply_visitor(SearchModeVisitor(), nSearchSingle);
+  if (sparse)
+    return boost::apply_visitor(SearchModeVisitor(), nSearchSparse);
   return boost::apply_visitor(SearchModeVisitor(), nSearch);
 }
 
 template<typename SortPolicy>
 double NSModel<SortPolicy>::Epsilon() const
 {
+  if (singlePrecision)
+    return boost::apply_visitor(EpsilonVisitor(), nSearchSingle);
+  if (sparse)
+    return boost::apply_visitor(EpsilonVisitor(), nSearchSparse);
   return boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
 template<typename SortPolicy>
 double& NSModel<SortPolicy>::Epsilon()
 {
+  if (singlePrecision)
+    return boost::apply_visitor(EpsilonVisitor(), nSearchSingle);
+  if (sparse)
+    return boost::apply_visitor(EpsilonVisitor(), nSearchSparse);
   return boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
@@ -448,38 +588,10 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   this->leafSize = leafSize;
   // Initialize random basis if necessary.
   if (randomBasis)
-  {
-    Log::Info << "Creating random basis..." << std::endl;
-    while (true)
-    {
-      // [Q, R] = qr(randn(d, d));
-      // Q = Q * diag(sign(diag(R)));
-      arma::mat r;
-      if (arma::qr(q, r, arma::randn<arma::mat>(referenceSet.n_rows,
-              referenceSet.n_rows)))
-      {
-        arma::vec rDiag(r.n_rows);
-        for (size_t i = 0; i < rDiag.n_elem; ++i)
-        {
-          if (r(i, i) < 0)
-            rDiag(i) = -1;
-          else if (r(i, i) > 0)
-            rDiag(i) = 1;
-          else
-            rDiag(i) = 0;
-        }
-
-        q *= arma::diagmat(rDiag);
-
-        // Check if the determinant is positive.
-        if (arma::det(q) >= 0)
-          break;
-      }
-    }
-  }
+    BuildRandomBasis(referenceSet.n_rows);
 
   // Clean memory, if necessary.
-  boost::apply_visitor(DeleteVisitor(), nSearch);
+  Clean();
 
   // Do we need to modify the reference set?
   if (randomBasis)
@@ -494,11 +606,11 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   switch (treeType)
   {
     case KD_TREE:
-      nSearch = new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
+      nSearch = new ParallelNSType<SortPolicy, tree::KDTree>(searchMode,
+          epsilon);
       break;
     case COVER_TREE:
-      nSearch = new NSType<SortPolicy, tree::StandardCoverTree>(searchMode,
-          epsilon);
+      nSearch = new CoverTreeNSType<SortPolicy>(searchMode, epsilon);
       break;
     case R_TREE:
       nSearch = new NSType<SortPolicy, tree::RTree>(searchMode, epsilon);
@@ -507,7 +619,8 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
       nSearch = new NSType<SortPolicy, tree::RStarTree>(searchMode, epsilon);
       break;
     case BALL_TREE:
-      nSearch = new NSType<SortPolicy, tree::BallTree>(searchMode, epsilon);
+      nSearch = new ParallelNSType<SortPolicy, tree::BallTree>(searchMode,
+          epsilon);
       break;
     case X_TREE:
       nSearch = new NSType<SortPolicy, tree::XTree>(searchMode, epsilon);
@@ -552,6 +665,101 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   }
 }
 
+//! Build the reference tree in single precision.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::BuildModel(arma::fmat&& referenceSet,
+                                     const size_t leafSize,
+                                     const NeighborSearchMode searchMode,
+                                     const double epsilon)
+{
+  if (treeType != KD_TREE && treeType != BALL_TREE && treeType != OCTREE)
+    throw std::invalid_argument("NSModel::BuildModel(): only kd-tree, ball "
+        "tree and octree models can be built in single precision");
+
+  this->leafSize = leafSize;
+  // Initialize random basis if necessary.
+  if (randomBasis)
+    BuildRandomBasis(referenceSet.n_rows);
+
+  // Clean memory, if necessary.
+  Clean();
+  singlePrecision = true;
+
+  // Do we need to modify the reference set?
+  if (randomBasis)
+    referenceSet = arma::conv_to<arma::fmat>::from(q) * referenceSet;
+
+  if (searchMode != NAIVE_MODE)
+  {
+    Timer::Start("tree_building");
+    Log::Info << "Building single-precision reference tree..." << std::endl;
+  }
+
+  if (treeType == KD_TREE)
+    nSearchSingle = new ParallelNSType<SortPolicy, tree::KDTree, arma::fmat>(
+        searchMode, epsilon);
+  else if (treeType == BALL_TREE)
+    nSearchSingle = new ParallelNSType<SortPolicy, tree::BallTree,
+        arma::fmat>(searchMode, epsilon);
+  else
+    nSearchSingle = new NSType<SortPolicy, tree::Octree, arma::fmat>(
+        searchMode, epsilon);
+
+  TrainVisitor<SortPolicy, arma::fmat> tn(std::move(referenceSet), leafSize,
+      tau, rho);
+  boost::apply_visitor(tn, nSearchSingle);
+
+  if (searchMode != NAIVE_MODE)
+  {
+    Timer::Stop("tree_building");
+    Log::Info << "Tree built." << std::endl;
+  }
+}
+
+//! Build the reference tree on a sparse reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::BuildModel(arma::sp_mat&& referenceSet,
+                                     const size_t leafSize,
+                                     const NeighborSearchMode searchMode,
+                                     const double epsilon)
+{
+  if (treeType != KD_TREE && treeType != BALL_TREE)
+    throw std::invalid_argument("NSModel::BuildModel(): only kd-tree and ball "
+        "tree models can be built on sparse data");
+  if (randomBasis)
+    throw std::invalid_argument("NSModel::BuildModel(): a random basis cannot "
+        "be used with sparse data");
+
+  this->leafSize = leafSize;
+
+  // Clean memory, if necessary.
+  Clean();
+  sparse = true;
+
+  if (searchMode != NAIVE_MODE)
+  {
+    Timer::Start("tree_building");
+    Log::Info << "Building sparse reference tree..." << std::endl;
+  }
+
+  if (treeType == KD_TREE)
+    nSearchSparse = new ParallelNSType<SortPolicy, tree::KDTree,
+        arma::sp_mat>(searchMode, epsilon);
+  else
+    nSearchSparse = new ParallelNSType<SortPolicy, tree::BallTree,
+        arma::sp_mat>(searchMode, epsilon);
+
+  TrainVisitor<SortPolicy, arma::sp_mat> tn(std::move(referenceSet), leafSize,
+      tau, rho);
+  boost::apply_visitor(tn, nSearchSparse);
+
+  if (searchMode != NAIVE_MODE)
+  {
+    Timer::Stop("tree_building");
+    Log::Info << "Tree built." << std::endl;
+  }
+}
+
 //! Perform neighbor search.  The query set will be reordered.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::Search(arma::mat&& querySet,
@@ -559,39 +767,420 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
                                  arma::Mat<size_t>& neighbors,
                                  arma::mat& distances)
 {
+  if (singlePrecision)
+  {
+    // Convert the query set, and release the original as early as possible.
+    arma::fmat singleQuerySet = arma::conv_to<arma::fmat>::from(querySet);
+    querySet.reset();
+    return Search(std::move(singleQuerySet), k, neighbors, distances);
+  }
+  else if (sparse)
+  {
+    arma::sp_mat sparseQuerySet(querySet);
+    querySet.reset();
+    return Search(std::move(sparseQuerySet), k, neighbors, distances);
+  }
+
   // We may need to map the query set randomly.
   if (randomBasis)
     querySet = q * querySet;
 
-  Log::Info << "Searching for " << k << " neighbors with ";
-
-  switch (SearchMode())
-  {
-    case NAIVE_MODE:
-      Log::Info << "brute-force (naive) search..." << std::endl;
-      break;
-    case SINGLE_TREE_MODE:
-      Log::Info << "single-tree " << TreeName() << " search..." << std::endl;
-      break;
-    case DUAL_TREE_MODE:
-      Log::Info << "dual-tree " << TreeName() << " search..." << std::endl;
-      break;
-    case GREEDY_SINGLE_TREE_MODE:
-      Log::Info << "greedy single-tree " << TreeName() << " search..."
-          << std::endl;
-      break;
-  }
+  LogSearch(k);
 
   BiSearchVisitor<SortPolicy> search(querySet, k, neighbors, distances,
       leafSize, tau, rho);
   boost::apply_visitor(search, nSearch);
 }
 
+//! Perform neighbor search with a single-precision query set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Search(arma::fmat&& querySet,
+                                 const size_t k,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& distances)
+{
+  if (!singlePrecision)
+  {
+    arma::mat doubleQuerySet = arma::conv_to<arma::mat>::from(querySet);
+    querySet.reset();
+    return Search(std::move(doubleQuerySet), k, neighbors, distances);
+  }
+
+  // We may need to map the query set randomly.
+  if (randomBasis)
+    querySet = arma::conv_to<arma::fmat>::from(q) * querySet;
+
+  LogSearch(k);
+
+  BiSearchVisitor<SortPolicy, arma::fmat> search(querySet, k, neighbors,
+      distances, leafSize, tau, rho);
+  boost::apply_visitor(search, nSearchSingle);
+}
+
+//! Perform neighbor search with a sparse query set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Search(arma::sp_mat&& querySet,
+                                 const size_t k,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& distances)
+{
+  if (!sparse)
+  {
+    arma::mat denseQuerySet(querySet);
+    querySet.reset();
+    return Search(std::move(denseQuerySet), k, neighbors, distances);
+  }
+
+  LogSearch(k);
+
+  BiSearchVisitor<SortPolicy, arma::sp_mat> search(querySet, k, neighbors,
+      distances, leafSize, tau, rho);
+  boost::apply_visitor(search, nSearchSparse);
+}
+
 //! Perform neighbor search.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::Search(const size_t k,
                                  arma::Mat<size_t>& neighbors,
                                  arma::mat& distances)
+{
+  LogSearch(k);
+
+  if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
+    Log::Info << "Maximum of " << Epsilon() * 100 << "% relative error."
+        << std::endl;
+
+  MonoSearchVisitor search(k, neighbors, distances);
+  if (singlePrecision)
+    boost::apply_visitor(search, nSearchSingle);
+  else if (sparse)
+    boost::apply_visitor(search, nSearchSparse);
+  else
+    boost::apply_visitor(search, nSearch);
+}
+
+//! Add points to the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Insert(const arma::mat& points)
+{
+  if (sparse)
+    throw std::invalid_argument("NSModel::Insert(): points cannot be added to "
+        "sparse models");
+
+  if (singlePrecision)
+  {
+    // We may need to map the points randomly.
+    arma::fmat singlePoints = arma::conv_to<arma::fmat>::from(points);
+    if (randomBasis)
+      singlePoints = arma::conv_to<arma::fmat>::from(q) * singlePoints;
+    boost::apply_visitor(InsertVisitor<arma::fmat>(singlePoints),
+        nSearchSingle);
+  }
+  // We may need to map the points randomly.
+  else if (randomBasis)
+    boost::apply_visitor(InsertVisitor<arma::mat>(q * points), nSearch);
+  else
+    boost::apply_visitor(InsertVisitor<arma::mat>(points), nSearch);
+}
+
+//! Remove points from the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Remove(const arma::Col<size_t>& indices)
+{
+  if (sparse)
+    throw std::invalid_argument("NSModel::Remove(): points cannot be removed "
+        "from sparse models");
+
+  if (singlePrecision)
+    boost::apply_visitor(RemoveVisitor(indices), nSearchSingle);
+  else
+    boost::apply_visitor(RemoveVisitor(indices), nSearch);
+}
+
+//! Save the model as a flat index.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::SaveIndex(const std::string& filename,
+                                    const bool saveReferenceSet) const
+{
+  if (treeType != KD_TREE && treeType != BALL_TREE)
+    throw std::invalid_argument("NSModel::SaveIndex(): only kd-tree and ball "
+        "tree models can be saved as an index");
+  if (SearchMode() == NAIVE_MODE)
+    throw std::invalid_argument("NSModel::SaveIndex(): models in naive mode "
+        "have no tree to save as an index");
+  if (sparse)
+    throw std::invalid_argument("NSModel::SaveIndex(): sparse models cannot "
+        "be saved as an index");
+
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("NSModel::SaveIndex(): cannot open file '" +
+        filename + "' for writing");
+
+  IndexHeader header;
+  std::memset(&header, 0, sizeof(IndexHeader));
+  std::memcpy(header.magic, "MLPKNSI", 8);
+  header.version = 2;
+  const std::string name = NSModelName<SortPolicy>::Name();
+  std::strncpy(header.name, name.c_str(), sizeof(header.name) - 1);
+  header.treeType = treeType;
+  header.elementSize = singlePrecision ? sizeof(float) : sizeof(double);
+  header.leafSize = leafSize;
+  header.randomBasis = randomBasis;
+  header.searchMode = SearchMode();
+  header.epsilon = Epsilon();
+  header.basisRows = q.n_rows;
+  header.basisCols = q.n_cols;
+
+  // The tree starts on a page boundary, so that its points do too.
+  const size_t basisEnd = sizeof(IndexHeader) + q.n_elem * sizeof(double);
+  header.treeOffset = ((basisEnd + 4095) / 4096) * 4096;
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(IndexHeader));
+  stream.write(reinterpret_cast<const char*>(q.memptr()),
+      q.n_elem * sizeof(double));
+  const std::vector<char> padding(header.treeOffset - basisEnd, 0);
+  stream.write(padding.data(), padding.size());
+
+  if (treeType == KD_TREE && singlePrecision)
+    SaveIndexTree<tree::KDTree, arma::fmat>(nSearchSingle, stream,
+        saveReferenceSet);
+  else if (treeType == KD_TREE)
+    SaveIndexTree<tree::KDTree, arma::mat>(nSearch, stream,
+        saveReferenceSet);
+  else if (singlePrecision)
+    SaveIndexTree<tree::BallTree, arma::fmat>(nSearchSingle, stream,
+        saveReferenceSet);
+  else
+    SaveIndexTree<tree::BallTree, arma::mat>(nSearch, stream,
+        saveReferenceSet);
+
+  if (!stream)
+    throw std::runtime_error("NSModel::SaveIndex(): error writing file '" +
+        filename + "'");
+}
+
+//! Load the model from a flat index.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LoadIndex(const std::string& filename)
+{
+  LoadIndex(filename, NULL);
+}
+
+//! Load the model from a flat index, with the given reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LoadIndex(const std::string& filename,
+                                    const arma::mat& referenceSet)
+{
+  LoadIndex(filename, &referenceSet);
+}
+
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LoadIndex(const std::string& filename,
+                                    const arma::mat* referenceSet)
+{
+  std::shared_ptr<data::MappedFile> file =
+      std::make_shared<data::MappedFile>(filename);
+
+  // Version 1 files have a shorter header, without the element size; they are
+  // converted to the current header.
+  IndexHeader header;
+  size_t headerSize = sizeof(IndexHeader);
+  if (file->Size() < sizeof(IndexHeaderV1))
+    throw std::runtime_error("NSModel::LoadIndex(): '" + filename + "' is not "
+        "a neighbor search index");
+  std::memcpy(&header, file->Data(), 16);
+  if (std::memcmp(header.magic, "MLPKNSI", 8) != 0 ||
+      (header.version != 1 && header.version != 2))
+    throw std::runtime_error("NSModel::LoadIndex(): '" + filename + "' is not "
+        "a neighbor search index");
+
+  if (header.version == 1)
+  {
+    IndexHeaderV1 oldHeader;
+    std::memcpy(&oldHeader, file->Data(), sizeof(IndexHeaderV1));
+    std::memcpy(header.name, oldHeader.name, sizeof(header.name));
+    header.treeType = oldHeader.treeType;
+    header.elementSize = sizeof(double);
+    header.leafSize = oldHeader.leafSize;
+    header.randomBasis = oldHeader.randomBasis;
+    header.searchMode = oldHeader.searchMode;
+    header.epsilon = oldHeader.epsilon;
+    header.basisRows = oldHeader.basisRows;
+    header.basisCols = oldHeader.basisCols;
+    header.treeOffset = oldHeader.treeOffset;
+    headerSize = sizeof(IndexHeaderV1);
+  }
+  else
+  {
+    if (file->Size() < sizeof(IndexHeader))
+      throw std::runtime_error("NSModel::LoadIndex(): '" + filename + "' is "
+          "malformed");
+    std::memcpy(&header, file->Data(), sizeof(IndexHeader));
+  }
+  header.name[sizeof(header.name) - 1] = '\0';
+
+  if (std::string(header.name) != NSModelName<SortPolicy>::Name())
+    throw std::runtime_error("NSModel::LoadIndex(): '" + filename + "' holds "
+        "a " + std::string(header.name) + ", not a " +
+        NSModelName<SortPolicy>::Name());
+  if ((header.treeType != KD_TREE && header.treeType != BALL_TREE) ||
+      (header.elementSize != sizeof(float) &&
+       header.elementSize != sizeof(double)) ||
+      header.searchMode > GREEDY_SINGLE_TREE_MODE ||
+      headerSize + header.basisRows * header.basisCols * sizeof(double) >
+      header.treeOffset || header.treeOffset > file->Size())
+    throw std::runtime_error("NSModel::LoadIndex(): '" + filename + "' is "
+        "malformed");
+
+  // Clean memory, if necessary.
+  Clean();
+
+  treeType = (TreeTypes) header.treeType;
+  leafSize = header.leafSize;
+  randomBasis = (header.randomBasis != 0);
+  q = arma::mat(reinterpret_cast<const double*>(file->Data() + headerSize),
+      header.basisRows, header.basisCols);
+
+  const NeighborSearchMode searchMode = (NeighborSearchMode) header.searchMode;
+  singlePrecision = (header.elementSize == sizeof(float));
+  if (treeType == KD_TREE && singlePrecision)
+    LoadIndexTree<tree::KDTree, arma::fmat>(nSearchSingle, *file,
+        header.treeOffset, searchMode, header.epsilon, referenceSet);
+  else if (treeType == KD_TREE)
+    LoadIndexTree<tree::KDTree, arma::mat>(nSearch, *file, header.treeOffset,
+        searchMode, header.epsilon, referenceSet);
+  else if (singlePrecision)
+    LoadIndexTree<tree::BallTree, arma::fmat>(nSearchSingle, *file,
+        header.treeOffset, searchMode, header.epsilon, referenceSet);
+  else
+    LoadIndexTree<tree::BallTree, arma::mat>(nSearch, *file,
+        header.treeOffset, searchMode, header.epsilon, referenceSet);
+
+  // Unless it was given, the reference set lives in the mapped file, so keep
+  // it open.
+  if (referenceSet == NULL)
+    mappedIndex = file;
+}
+
+template<typename SortPolicy>
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename MatType,
+         typename VariantType>
+void NSModel<SortPolicy>::SaveIndexTree(const VariantType& search,
+                                        std::ostream& stream,
+                                        const bool saveReferenceSet) const
+{
+  typedef ParallelNSType<SortPolicy, TreeType, MatType> NSType;
+  const NSType* ns = boost::get<NSType*>(search);
+
+  tree::FlatTreeIndex<typename NSType::Tree>::Save(ns->ReferenceTree(),
+      ns->OldFromNewReferences(), stream, saveReferenceSet);
+}
+
+template<typename SortPolicy>
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename MatType,
+         typename VariantType>
+void NSModel<SortPolicy>::LoadIndexTree(VariantType& search,
+                                        const data::MappedFile& file,
+                                        const size_t offset,
+                                        const NeighborSearchMode searchMode,
+                                        const double epsilon,
+                                        const arma::mat* referenceSet)
+{
+  typedef ParallelNSType<SortPolicy, TreeType, MatType> NSType;
+  typedef tree::FlatTreeIndex<typename NSType::Tree> IndexType;
+
+  std::vector<size_t> oldFromNew;
+  typename NSType::Tree* referenceTree;
+  if (referenceSet == NULL)
+  {
+    referenceTree = IndexType::Load(file.Data() + offset, file.Size() - offset,
+        oldFromNew);
+  }
+  else
+  {
+    // The tree was built on the reference set projected onto the random
+    // basis, in the precision of the model.
+    if (randomBasis && referenceSet->n_rows != q.n_cols)
+    {
+      std::ostringstream oss;
+      oss << "NSModel::LoadIndex(): the given reference set has "
+          << "dimensionality " << referenceSet->n_rows << ", but the model was "
+          << "built on a reference set of dimensionality " << q.n_cols;
+      throw std::invalid_argument(oss.str());
+    }
+
+    MatType points = arma::conv_to<MatType>::from(*referenceSet);
+    if (randomBasis)
+      points = arma::conv_to<MatType>::from(q) * points;
+    referenceTree = IndexType::Load(file.Data() + offset, file.Size() - offset,
+        points, oldFromNew);
+  }
+
+  NSType* ns = new NSType(std::move(*referenceTree), searchMode, epsilon);
+  delete referenceTree;
+  ns->OldFromNewReferences() = std::move(oldFromNew);
+
+  search = ns;
+}
+
+//! Delete the NeighborSearch object.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Clean()
+{
+  boost::apply_visitor(DeleteVisitor(), nSearch);
+  boost::apply_visitor(DeleteVisitor(), nSearchSingle);
+  boost::apply_visitor(DeleteVisitor(), nSearchSparse);
+  nSearch = decltype(nSearch)();
+  nSearchSingle = decltype(nSearchSingle)();
+  nSearchSparse = decltype(nSearchSparse)();
+  singlePrecision = false;
+  sparse = false;
+  mappedIndex.reset();
+}
+
+//! Create a random orthogonal basis with positive determinant.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::BuildRandomBasis(const size_t dimensionality)
+{
+  Log::Info << "Creating random basis..." << std::endl;
+  while (true)
+  {
+    // [Q, R] = qr(randn(d, d));
+    // Q = Q * diag(sign(diag(R)));
+    arma::mat r;
+    if (arma::qr(q, r, arma::randn<arma::mat>(dimensionality,
+            dimensionality)))
+    {
+      arma::vec rDiag(r.n_rows);
+      for (size_t i = 0; i < rDiag.n_elem; ++i)
+      {
+        if (r(i, i) < 0)
+          rDiag(i) = -1;
+        else if (r(i, i) > 0)
+          rDiag(i) = 1;
+        else
+          rDiag(i) = 0;
+      }
+
+      q *= arma::diagmat(rDiag);
+
+      // Check if the determinant is positive.
+      if (arma::det(q) >= 0)
+        break;
+    }
+  }
+}
+
+//! Log the kind of search that is about to be performed.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LogSearch(const size_t k)
 {
   Log::Info << "Searching for " << k << " neighbors with ";
 
@@ -611,13 +1200,6 @@ void NSModel<SortPolicy>::Search(const size_t k,
           << std::endl;
       break;
   }
-
-  if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
-    Log::Info << "Maximum of " << Epsilon() * 100 << "% relative error."
-        << std::endl;
-
-  MonoSearchVisitor search(k, neighbors, distances);
-  boost::apply_visitor(search, nSearch);
 }
 
 //! Get the name of the tree type.
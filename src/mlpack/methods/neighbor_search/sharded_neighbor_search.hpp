@@ -0,0 +1,176 @@
+/**
+ * @file sharded_neighbor_search.hpp
+ *
+ * Defines the ShardedNeighborSearch class, which searches a reference set that
+ * is split into shards with one NeighborSearch object per shard, and the
+ * MergeNeighbors() function, which merges the results of the shards.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Merge the neighbors found in a shard of a reference set into the best
+ * neighbors found so far.  Each column of the matrices holds the neighbors of
+ * one query point, best first, as returned by NeighborSearch::Search(); empty
+ * entries have index size_t() - 1 and distance SortPolicy::WorstDistance().
+ * The number of neighbors that are kept is the number of rows of neighbors,
+ * and the shard may have found fewer neighbors than that.  When two neighbors
+ * have the same distance, the one that was already found comes first.
+ *
+ * This is what ShardedNeighborSearch does with the results of its shards; it
+ * can also be used to merge the results of shards that are searched
+ * elsewhere (for instance, by other processes).
+ *
+ * @tparam SortPolicy The sort policy of the distances.
+ * @param neighbors Best neighbors found so far; set to the merged neighbors.
+ * @param distances Distances of neighbors; set to the merged distances.
+ * @param shardNeighbors Neighbors found in the shard, as indices into the
+ *     shard.
+ * @param shardDistances Distances of the neighbors found in the shard.
+ * @param offset Index of the first point of the shard in the reference set,
+ *     which is added to the indices of shardNeighbors.
+ */
+template<typename SortPolicy>
+void MergeNeighbors(arma::Mat<size_t>& neighbors,
+                    arma::mat& distances,
+                    const arma::Mat<size_t>& shardNeighbors,
+                    const arma::mat& shardDistances,
+                    const size_t offset);
+
+/**
+ * The ShardedNeighborSearch class searches a reference set that is split into
+ * shards, with one NeighborSearch object (and one tree) per shard, so that
+ * each shard can be built, saved and loaded by itself.  The shards are
+ * searched one after another: the first shard is searched as usual, and each
+ * of the others is searched with the k'th distance of the neighbors found so
+ * far as the initial bound of each query point (see the overload of
+ * NeighborSearch::Search() that takes bounds), so that the traversal of the
+ * later shards prunes from the start.  The results of each shard are merged
+ * with MergeNeighbors().  The results are the same as those of one
+ * NeighborSearch object on the whole reference set (with the same epsilon),
+ * except for the order of neighbors with equal distances.
+ *
+ * The indices of the neighbors refer to the whole reference set, in which the
+ * points of each shard follow those of the shards before it.
+ *
+ * @code
+ * // Search a reference set that is split into 4 kd-trees.
+ * ShardedNeighborSearch<> knn(referenceSet, 4);
+ * knn.Search(querySet, k, neighbors, distances);
+ *
+ * // Or build a search from shards that were built and saved separately.
+ * ShardedNeighborSearch<> sharded;
+ * for (size_t i = 0; i < shardFiles.size(); ++i)
+ * {
+ *   KNN shard;
+ *   data::Load(shardFiles[i], "knn", shard);
+ *   sharded.AddShard(std::move(shard));
+ * }
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ * @tparam TreeType The tree type of each shard.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class ShardedNeighborSearch
+{
+ public:
+  //! The type of the search of each shard.
+  typedef NeighborSearch<SortPolicy, MetricType, MatType, TreeType> ShardType;
+
+  /**
+   * Split the given reference set into the given number of shards of
+   * consecutive points (of nearly equal sizes), and build the search of each
+   * shard.  A std::invalid_argument is thrown if the number of shards is zero
+   * or greater than the number of points.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numShards Number of shards.
+   * @param mode Neighbor search mode of each shard.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  ShardedNeighborSearch(const MatType& referenceSet,
+                        const size_t numShards,
+                        const NeighborSearchMode mode = DUAL_TREE_MODE,
+                        const double epsilon = 0,
+                        const MetricType metric = MetricType());
+
+  /**
+   * Create a search without shards; add them with AddShard().
+   */
+  ShardedNeighborSearch() : numReferencePoints(0) { }
+
+  /**
+   * Add the given search as the last shard.  The points of its reference set
+   * follow the points of the shards that were already added.
+   *
+   * @param shard Search of the shard.
+   */
+  void AddShard(ShardType&& shard);
+
+  /**
+   * For each point in the query set, find the k neighbors in the whole
+   * reference set.  A std::invalid_argument is thrown if there are no shards,
+   * or if k is greater than the number of reference points.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the number of shards.
+  size_t NumShards() const { return shards.size(); }
+
+  //! Get the search of the given shard.
+  const ShardType& Shard(const size_t i) const { return *shards[i]; }
+  //! Modify the search of the given shard.
+  ShardType& Shard(const size_t i) { return *shards[i]; }
+
+  //! Get the index of the first point of the given shard.
+  size_t ShardOffset(const size_t i) const { return offsets[i]; }
+
+  //! Get the number of points of all shards.
+  size_t NumReferencePoints() const { return numReferencePoints; }
+
+ private:
+  //! The search of each shard.
+  std::vector<std::unique_ptr<ShardType>> shards;
+  //! The index of the first point of each shard.
+  std::vector<size_t> offsets;
+  //! The number of points of all shards.
+  size_t numReferencePoints;
+}; // class ShardedNeighborSearch
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "sharded_neighbor_search_impl.hpp"
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @file sharded_neighbor_search_impl.hpp
+ *
+ * Implementation of the ShardedNeighborSearch class and of MergeNeighbors().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sharded_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy>
+void MergeNeighbors(arma::Mat<size_t>& neighbors,
+                    arma::mat& distances,
+                    const arma::Mat<size_t>& shardNeighbors,
+                    const arma::mat& shardDistances,
+                    const size_t offset)
+{
+  if (shardNeighbors.n_cols != neighbors.n_cols ||
+      shardDistances.n_cols != neighbors.n_cols ||
+      shardDistances.n_rows != shardNeighbors.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "MergeNeighbors(): the neighbors of the shard are "
+        << shardNeighbors.n_rows << "x" << shardNeighbors.n_cols << " and "
+        << "their distances are " << shardDistances.n_rows << "x"
+        << shardDistances.n_cols << ", but there are " << neighbors.n_cols
+        << " query points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t k = neighbors.n_rows;
+  const size_t shardK = shardNeighbors.n_rows;
+  arma::Mat<size_t> mergedNeighbors(k, neighbors.n_cols);
+  arma::mat mergedDistances(k, neighbors.n_cols);
+
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t q = 0; q < (omp_size_t) neighbors.n_cols; ++q)
+  {
+    // Both lists are sorted, so take the better of their fronts k times.
+    size_t current = 0, shard = 0;
+    for (size_t i = 0; i < k; ++i)
+    {
+      if (shard < shardK && shardNeighbors(shard, q) != size_t() - 1 &&
+          SortPolicy::IsBetter(shardDistances(shard, q),
+                               distances(current, q)))
+      {
+        mergedNeighbors(i, q) = shardNeighbors(shard, q) + offset;
+        mergedDistances(i, q) = shardDistances(shard, q);
+        ++shard;
+      }
+      else
+      {
+        mergedNeighbors(i, q) = neighbors(current, q);
+        mergedDistances(i, q) = distances(current, q);
+        ++current;
+      }
+    }
+  }
+
+  neighbors = std::move(mergedNeighbors);
+  distances = std::move(mergedDistances);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename, typename, typename> class TreeType>
+ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+ShardedNeighborSearch(const MatType& referenceSet,
+                      const size_t numShards,
+                      const NeighborSearchMode mode,
+                      const double epsilon,
+                      const MetricType metric) :
+    numReferencePoints(0)
+{
+  if (numShards == 0 || numShards > referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "ShardedNeighborSearch::ShardedNeighborSearch(): cannot split "
+        << referenceSet.n_cols << " points into " << numShards << " shards";
+    throw std::invalid_argument(oss.str());
+  }
+
+  for (size_t i = 0; i < numShards; ++i)
+  {
+    const size_t begin = i * referenceSet.n_cols / numShards;
+    const size_t end = (i + 1) * referenceSet.n_cols / numShards;
+    AddShard(ShardType(MatType(referenceSet.cols(begin, end - 1)), mode,
+        epsilon, metric));
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename, typename, typename> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+AddShard(ShardType&& shard)
+{
+  offsets.push_back(numReferencePoints);
+  numReferencePoints += shard.ReferenceSet().n_cols;
+  shards.push_back(std::unique_ptr<ShardType>(
+      new ShardType(std::move(shard))));
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename, typename, typename> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (shards.empty())
+  {
+    throw std::invalid_argument("ShardedNeighborSearch::Search(): there are "
+        "no shards to search");
+  }
+
+  if (k > numReferencePoints)
+  {
+    std::ostringstream oss;
+    oss << "ShardedNeighborSearch::Search(): requested value of k (" << k
+        << ") is greater than the number of points in the reference set ("
+        << numReferencePoints << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  neighbors.fill(size_t() - 1);
+  distances.set_size(k, querySet.n_cols);
+  distances.fill(SortPolicy::WorstDistance());
+  if (k == 0)
+    return;
+
+  arma::Mat<size_t> shardNeighbors;
+  arma::mat shardDistances;
+  for (size_t i = 0; i < shards.size(); ++i)
+  {
+    const size_t shardK = std::min(k,
+        (size_t) shards[i]->ReferenceSet().n_cols);
+    if (shardK == 0)
+      continue;
+
+    // Only the neighbors that beat the k'th neighbor found so far matter.
+    if (i == 0)
+    {
+      shards[i]->Search(querySet, shardK, shardNeighbors, shardDistances);
+    }
+    else
+    {
+      shards[i]->Search(querySet, shardK, shardNeighbors, shardDistances,
+          arma::vec(distances.row(k - 1).t()));
+    }
+
+    MergeNeighbors<SortPolicy>(neighbors, distances, shardNeighbors,
+        shardDistances, offsets[i]);
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
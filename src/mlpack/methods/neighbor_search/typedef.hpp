@@ -40,7 +40,8 @@ typedef NeighborSearch<FurthestNeighborSort, metric::EuclideanDistance> KFN;
 /**
  * The DefeatistKNN class is the k-nearest-neighbors method considering
  * defeatist search. It returns L2 distances (Euclidean distances) for each of
- * the k nearest neighbors found.
+ * the k nearest neighbors found.  Single-tree search divides the query points
+ * between threads (if mlpack was compiled with OpenMP).
  * @tparam TreeType The tree type to use; must adhere to the TreeType API,
  *     and implement Defeatist Traversers.
  */
@@ -57,7 +58,7 @@ using DefeatistKNN = NeighborSearch<
         arma::mat>::template DefeatistDualTreeTraverser,
     TreeType<metric::EuclideanDistance,
         NeighborSearchStat<NearestNeighborSort>,
-        arma::mat>::template DefeatistSingleTreeTraverser>;
+        arma::mat>::template DefeatistParallelSingleTreeTraverser>;
 
 /**
  * The SpillKNN class is the k-nearest-neighbors method considering defeatist
@@ -0,0 +1,142 @@
+/**
+ * @file whitened_neighbor_search.hpp
+ *
+ * Defines the WhitenedNeighborSearch class, which performs neighbor searches
+ * with the Mahalanobis distance by transforming the points once and searching
+ * them with the Euclidean distance.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_WHITENED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_WHITENED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/mahalanobis_distance.hpp>
+
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The WhitenedNeighborSearch class finds neighbors with the Mahalanobis
+ * distance.  Evaluating the Mahalanobis distance takes O(d^2) time for each
+ * pair of points, and the bounds of trees built with it are not as tight as
+ * those of Euclidean trees; but since the Mahalanobis distance between a and b
+ * is the Euclidean distance between R a and R b, where R is given by
+ * MahalanobisDistance::Transformation(), this class transforms the reference
+ * set and each query set once and searches them with a NeighborSearch object
+ * that uses the Euclidean distance (and, by default, a kd-tree).  The
+ * distances that are returned are those of the given Mahalanobis distance, so
+ * with TakeRoot = false they are the squared distances.
+ *
+ * The indices of the neighbors refer to the points of the given reference
+ * set.  If an approximate search is performed, epsilon bounds the relative
+ * error of the (rooted) distances.
+ *
+ * @code
+ * metric::MahalanobisDistance<> mahalanobis(covariance);
+ * WhitenedNeighborSearch<> knn(referenceSet, DUAL_TREE_MODE, 0, mahalanobis);
+ * knn.Search(querySet, k, neighbors, distances);
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam TakeRoot Whether the distances of the Mahalanobis distance are
+ *     rooted.
+ * @tparam TreeType The tree type to use for the transformed points.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         bool TakeRoot = true,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class WhitenedNeighborSearch
+{
+ public:
+  //! The metric of the distances that are returned.
+  typedef metric::MahalanobisDistance<TakeRoot> MetricType;
+  //! The type of the search of the transformed points.
+  typedef NeighborSearch<SortPolicy, metric::EuclideanDistance, arma::mat,
+      TreeType> SearchType;
+
+  /**
+   * Transform the given reference set and build the search of the transformed
+   * points.  If the covariance matrix of the metric is empty, the identity
+   * matrix is used.  A std::invalid_argument is thrown if the covariance
+   * matrix does not match the dimensionality of the reference set.
+   *
+   * @param referenceSet Set of reference points.
+   * @param mode Neighbor search mode.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric Mahalanobis distance to search with.
+   */
+  WhitenedNeighborSearch(const arma::mat& referenceSet,
+                         const NeighborSearchMode mode = DUAL_TREE_MODE,
+                         const double epsilon = 0,
+                         const MetricType& metric = MetricType());
+
+  /**
+   * For each point in the query set, find the k neighbors in the reference
+   * set with the Mahalanobis distance.  A std::invalid_argument is thrown if
+   * the dimensionality of the query set is wrong.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * For each point in the reference set, find the k neighbors in the
+   * reference set (excluding the point itself) with the Mahalanobis distance.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each point.
+   * @param distances Matrix storing distances of neighbors for each point.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the Mahalanobis distance.
+  const MetricType& Metric() const { return metric; }
+
+  //! Get the transformation of the points.
+  const arma::mat& Transformation() const { return transformation; }
+
+  //! Get the search of the transformed points.
+  const SearchType& WhitenedSearch() const { return search; }
+  //! Modify the search of the transformed points.
+  SearchType& WhitenedSearch() { return search; }
+
+ private:
+  //! Compute the transformation for points of the given dimensionality.
+  static arma::mat ComputeTransformation(const MetricType& metric,
+                                         const size_t dimensionality);
+
+  //! Convert the Euclidean distances of the search to the given metric.
+  static void ConvertDistances(arma::mat& distances);
+
+  //! The Mahalanobis distance.
+  MetricType metric;
+  //! The transformation of the points.
+  arma::mat transformation;
+  //! The search of the transformed points.
+  SearchType search;
+}; // class WhitenedNeighborSearch
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "whitened_neighbor_search_impl.hpp"
+
+#endif
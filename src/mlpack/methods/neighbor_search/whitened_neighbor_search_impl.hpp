@@ -0,0 +1,113 @@
+/**
+ * @file whitened_neighbor_search_impl.hpp
+ *
+ * Implementation of the WhitenedNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_WHITENED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_WHITENED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "whitened_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         bool TakeRoot,
+         template<typename, typename, typename> class TreeType>
+WhitenedNeighborSearch<SortPolicy, TakeRoot, TreeType>::WhitenedNeighborSearch(
+    const arma::mat& referenceSet,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType& metric) :
+    metric(metric),
+    transformation(ComputeTransformation(metric, referenceSet.n_rows)),
+    search(arma::mat(transformation * referenceSet), mode, epsilon)
+{
+  // Nothing to do.
+}
+
+template<typename SortPolicy,
+         bool TakeRoot,
+         template<typename, typename, typename> class TreeType>
+void WhitenedNeighborSearch<SortPolicy, TakeRoot, TreeType>::Search(
+    const arma::mat& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (querySet.n_rows != transformation.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "WhitenedNeighborSearch::Search(): the query set has "
+        << "dimensionality " << querySet.n_rows << ", but the reference set "
+        << "has dimensionality " << transformation.n_cols;
+    throw std::invalid_argument(oss.str());
+  }
+
+  search.Search(arma::mat(transformation * querySet), k, neighbors,
+      distances);
+  ConvertDistances(distances);
+}
+
+template<typename SortPolicy,
+         bool TakeRoot,
+         template<typename, typename, typename> class TreeType>
+void WhitenedNeighborSearch<SortPolicy, TakeRoot, TreeType>::Search(
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  search.Search(k, neighbors, distances);
+  ConvertDistances(distances);
+}
+
+template<typename SortPolicy,
+         bool TakeRoot,
+         template<typename, typename, typename> class TreeType>
+arma::mat WhitenedNeighborSearch<SortPolicy, TakeRoot, TreeType>::
+    ComputeTransformation(const MetricType& metric,
+                          const size_t dimensionality)
+{
+  if (metric.Covariance().n_elem == 0)
+    return arma::eye<arma::mat>(dimensionality, dimensionality);
+
+  if (metric.Covariance().n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "WhitenedNeighborSearch::WhitenedNeighborSearch(): the covariance "
+        << "matrix of the metric has " << metric.Covariance().n_rows
+        << " rows, but the reference set has dimensionality "
+        << dimensionality;
+    throw std::invalid_argument(oss.str());
+  }
+
+  return metric.Transformation();
+}
+
+template<typename SortPolicy,
+         bool TakeRoot,
+         template<typename, typename, typename> class TreeType>
+void WhitenedNeighborSearch<SortPolicy, TakeRoot, TreeType>::ConvertDistances(
+    arma::mat& distances)
+{
+  // The Euclidean distances are the rooted Mahalanobis distances.  Points
+  // that were not found have the worst distance of the sort policy, which
+  // is left as it is.
+  if (!TakeRoot)
+  {
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      if (distances[i] != SortPolicy::WorstDistance())
+        distances[i] *= distances[i];
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file incremental_svd_method.hpp
+ *
+ * Implementation of the incremental SVD method for use in the Principal
+ * Components Analysis method, which updates the decomposition with batches of
+ * points so that the whole dataset never has to be in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+
+#ifndef MLPACK_METHODS_PCA_DECOMPOSITION_POLICIES_INCREMENTAL_SVD_METHOD_HPP
+#define MLPACK_METHODS_PCA_DECOMPOSITION_POLICIES_INCREMENTAL_SVD_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace pca {
+
+/**
+ * Implementation of the incremental SVD policy, which computes the principal
+ * components from successive batches of points (Ross et al., "Incremental
+ * Learning for Robust Visual Tracking", 2008).  Only the mean, the principal
+ * components and their singular values are kept; each batch is merged into
+ * them with the SVD of a matrix with one column per component, per point of
+ * the batch, and one for the change of the mean.  So memory usage depends on
+ * the dimensionality and the batch size, and not on the number of points.
+ * When all the components are kept (rank 0), the result is the same as with
+ * the exact SVD; otherwise the smallest components are dropped after each
+ * batch, which approximates the largest ones.
+ *
+ * As a PCA decomposition policy, this splits the data into batches of
+ * BatchSize() points; PCA then does not make a centered copy of the data
+ * (unless the data is scaled), since the policy centers each batch itself.
+ * It can also be used directly on data that does not fit in memory, for
+ * instance with data::BatchReader:
+ *
+ * @code
+ * data::BatchReader<> reader("data.csv", 10000);
+ * IncrementalSVDPolicy ipca(10000, 20); // Keep 20 components.
+ * arma::mat batch;
+ * while (reader.NextBatch(batch))
+ *   ipca.Update(batch);
+ *
+ * // Second pass: project each batch onto the components.
+ * reader.Reset();
+ * arma::mat transformed;
+ * while (reader.NextBatch(batch))
+ *   ipca.Transform(batch, transformed);
+ * @endcode
+ */
+class IncrementalSVDPolicy
+{
+ public:
+  /**
+   * Create the incremental SVD policy.
+   *
+   * @param batchSize Number of points of each batch, when used as a PCA
+   *     decomposition policy.
+   * @param rank Number of components to keep after each batch; if 0, all
+   *     the components are kept.
+   */
+  IncrementalSVDPolicy(const size_t batchSize = 1000,
+                       const size_t rank = 0) :
+      batchSize(batchSize),
+      rank(rank),
+      numPoints(0)
+  {
+    /* Nothing to do here */
+  }
+
+  /**
+   * Apply Principal Component Analysis to the provided data set using the
+   * incremental SVD, one batch of points at a time.  The centered data does
+   * not have to be centered: the policy computes its mean.
+   *
+   * @param data Data matrix.
+   * @param centeredData Centered (or original) data matrix.
+   * @param transformedData Matrix to put results of PCA into.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param rank Rank of the decomposition (unused; the rank given to the
+   *     constructor is used).
+   */
+  void Apply(const arma::mat& /* data */,
+             const arma::mat& centeredData,
+             arma::mat& transformedData,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             const size_t /* rank */)
+  {
+    if (batchSize == 0)
+    {
+      throw std::invalid_argument("IncrementalSVDPolicy::Apply(): the batch "
+          "size must be positive");
+    }
+
+    Reset();
+    for (size_t begin = 0; begin < centeredData.n_cols; begin += batchSize)
+    {
+      const size_t end = std::min((size_t) centeredData.n_cols,
+          begin + batchSize) - 1;
+      Update(centeredData.cols(begin, end));
+    }
+
+    eigVal = EigenValues();
+    eigvec = components;
+
+    // The projection is computed into a new matrix, since transformedData may
+    // be the same matrix as the data.
+    arma::mat transformed;
+    Transform(centeredData, transformed);
+    transformedData = std::move(transformed);
+  }
+
+  /**
+   * Update the mean and the principal components with the given batch of
+   * points.  A std::invalid_argument is thrown if the dimensionality of the
+   * points is not the same as the one of the earlier batches.
+   *
+   * @param batch Points to add, as columns.
+   */
+  void Update(const arma::mat& batch)
+  {
+    if (batch.n_cols == 0)
+      return;
+
+    if (numPoints > 0 && batch.n_rows != mean.n_elem)
+    {
+      std::ostringstream oss;
+      oss << "IncrementalSVDPolicy::Update(): the points have " << batch.n_rows
+          << " dimensions, but earlier points had " << mean.n_elem;
+      throw std::invalid_argument(oss.str());
+    }
+
+    const arma::vec batchMean = arma::mean(batch, 1);
+
+    // The scatter matrix of all the points is the one of the old points
+    // (components * diag(s^2) * components^T), plus the one of the batch
+    // around its mean, plus a term for the difference of the means; each is
+    // the product of a block of columns with its transpose.
+    arma::mat merged;
+    if (numPoints == 0)
+    {
+      merged = batch.each_col() - batchMean;
+      mean = batchMean;
+    }
+    else
+    {
+      const size_t k = components.n_cols;
+      const double scale = std::sqrt((double) numPoints * batch.n_cols /
+          (double) (numPoints + batch.n_cols));
+
+      merged.set_size(batch.n_rows, k + batch.n_cols + 1);
+      merged.cols(0, k - 1) = components * arma::diagmat(singularValues);
+      merged.cols(k, k + batch.n_cols - 1) = batch.each_col() - batchMean;
+      merged.col(k + batch.n_cols) = scale * (batchMean - mean);
+
+      mean += (batchMean - mean) * ((double) batch.n_cols /
+          (double) (numPoints + batch.n_cols));
+    }
+    numPoints += batch.n_cols;
+
+    // Only the left singular vectors are needed.
+    arma::mat u, v;
+    arma::vec s;
+    arma::svd_econ(u, s, v, merged, 'l');
+
+    const size_t keep = std::min((size_t) s.n_elem, (rank == 0) ?
+        (size_t) batch.n_rows : rank);
+    components = u.cols(0, keep - 1);
+    singularValues = s.subvec(0, keep - 1);
+  }
+
+  /**
+   * Project the given points onto the principal components found so far.
+   *
+   * @param points Points to project, as columns.
+   * @param transformed Matrix to store the projected points in.
+   */
+  void Transform(const arma::mat& points, arma::mat& transformed) const
+  {
+    if (points.n_rows != mean.n_elem)
+    {
+      std::ostringstream oss;
+      oss << "IncrementalSVDPolicy::Transform(): the points have "
+          << points.n_rows << " dimensions, but the model has " << mean.n_elem;
+      throw std::invalid_argument(oss.str());
+    }
+
+    // X^T (x - mean) = X^T x - X^T mean, without a centered copy.
+    transformed = arma::trans(components) * points;
+    transformed.each_col() -= arma::trans(components) * mean;
+  }
+
+  //! Forget all the points that were added.
+  void Reset()
+  {
+    numPoints = 0;
+    mean.reset();
+    components.reset();
+    singularValues.reset();
+  }
+
+  //! Get the eigenvalues of the covariance matrix of the points so far.
+  arma::vec EigenValues() const
+  {
+    // The covariance matrix is X * X' / (N - 1).
+    if (numPoints < 2)
+      return arma::zeros<arma::vec>(singularValues.n_elem);
+    return arma::square(singularValues) / (double) (numPoints - 1);
+  }
+
+  //! Get the principal components (eigenvectors) of the points so far.
+  const arma::mat& EigenVectors() const { return components; }
+  //! Get the mean of the points so far.
+  const arma::vec& Mean() const { return mean; }
+  //! Get the number of points so far.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the number of points of each batch.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points of each batch.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of components that are kept (0 means all of them).
+  size_t Rank() const { return rank; }
+  //! Modify the number of components that are kept (0 means all of them).
+  size_t& Rank() { return rank; }
+
+ private:
+  //! Number of points of each batch.
+  size_t batchSize;
+  //! Number of components to keep.
+  size_t rank;
+
+  //! Number of points so far.
+  size_t numPoints;
+  //! Mean of the points so far.
+  arma::vec mean;
+  //! Principal components of the points so far.
+  arma::mat components;
+  //! Singular values of the centered points for each component.
+  arma::vec singularValues;
+};
+
+/**
+ * Whether the given decomposition policy centers the data itself, so that PCA
+ * can pass the original data instead of making a centered copy of it (when the
+ * data is not scaled).
+ */
+template<typename DecompositionPolicy>
+struct DecompositionCentersData
+{
+  static const bool value = false;
+};
+
+//! The incremental SVD policy computes the mean of the batches.
+template<>
+struct DecompositionCentersData<IncrementalSVDPolicy>
+{
+  static const bool value = true;
+};
+
+} // namespace pca
+} // namespace mlpack
+
+#endif
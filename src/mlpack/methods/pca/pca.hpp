@@ -18,6 +18,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/pca/decomposition_policies/exact_svd_method.hpp>
+#include <mlpack/methods/pca/decomposition_policies/incremental_svd_method.hpp>
 
 namespace mlpack {
 namespace pca {
@@ -48,6 +48,15 @@ void PCAType<DecompositionPolicy>::Apply(const arma::mat& data,
 {
   Timer::Start("pca");
 
+  // A policy that centers the data itself does not need a centered copy.
+  if (DecompositionCentersData<DecompositionPolicy>::value && !scaleData)
+  {
+    decomposition.Apply(data, data, transformedData, eigVal, eigvec,
+        data.n_rows);
+    Timer::Stop("pca");
+    return;
+  }
+
   // Center the data into a temporary matrix.
   arma::mat centeredData;
   math::Center(data, centeredData);
@@ -106,14 +115,23 @@ double PCAType<DecompositionPolicy>::Apply(arma::mat& data,
 
   Timer::Start("pca");
 
-  // Center the data into a temporary matrix.
-  arma::mat centeredData;
-  math::Center(data, centeredData);
+  // A policy that centers the data itself does not need a centered copy.
+  if (DecompositionCentersData<DecompositionPolicy>::value && !scaleData)
+  {
+    decomposition.Apply(data, data, data, eigVal, eigvec, newDimension);
+  }
+  else
+  {
+    // Center the data into a temporary matrix.
+    arma::mat centeredData;
+    math::Center(data, centeredData);
 
-  // Scale the data if the user ask for.
-  ScaleData(centeredData);
+    // Scale the data if the user ask for.
+    ScaleData(centeredData);
 
-  decomposition.Apply(data, centeredData, data, eigVal, eigvec, newDimension);
+    decomposition.Apply(data, centeredData, data, eigVal, eigvec,
+        newDimension);
+  }
 
   if (newDimension < eigvec.n_rows)
     // Drop unnecessary rows.
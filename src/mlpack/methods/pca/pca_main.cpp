@@ -16,6 +16,7 @@
 
 #include "pca.hpp"
 #include <mlpack/methods/pca/decomposition_policies/exact_svd_method.hpp>
+#include <mlpack/methods/pca/decomposition_policies/incremental_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/quic_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_block_krylov_method.hpp>
@@ -27,7 +28,8 @@ using namespace std;
 // Document program.
 PROGRAM_INFO("Principal Components Analysis", "This program performs principal "
     "components analysis on the given dataset using the exact, randomized, "
-    "randomized block Krylov, or QUIC SVD method. It will transform the data "
+    "randomized block Krylov, QUIC, or incremental SVD method. It will "
+    "transform the data "
     "onto its principal components, optionally performing dimensionality "
     "reduction by ignoring the principal components with the smallest "
     "eigenvalues."
@@ -43,7 +45,11 @@ PROGRAM_INFO("Principal Components Analysis", "This program performs principal "
     "Multiple different decomposition techniques may be used.  The method to "
     "use may be specified with the " +
     PRINT_PARAM_STRING("decomposition_method") + " parameter, and it may take "
-    "the values 'exact', 'randomized', or 'quic'."
+    "the values 'exact', 'randomized', 'randomized-block-krylov', 'quic', or "
+    "'incremental'.  The incremental method updates the decomposition with "
+    "batches of points, whose size is given by the " +
+    PRINT_PARAM_STRING("batch_size") + " parameter, and does not make a "
+    "centered copy of the dataset."
     "\n\n"
     "For example, to reduce the dimensionality of the matrix " +
     PRINT_DATASET("data") + " to 5 dimensions using randomized SVD for the "
@@ -66,7 +72,9 @@ PARAM_FLAG("scale", "If set, the data will be scaled before running PCA, such "
 
 PARAM_STRING_IN("decomposition_method", "Method used for the principal "
     "components analysis: 'exact', 'randomized', 'randomized-block-krylov', "
-    "'quic'.", "c", "exact");
+    "'quic', 'incremental'.", "c", "exact");
+PARAM_INT_IN("batch_size", "Number of points of each batch for the "
+    "'incremental' decomposition method.", "b", 1000);
 
 
 //! Run RunPCA on the specified dataset with the given decomposition method.
@@ -74,9 +82,10 @@ template<typename DecompositionPolicy>
 void RunPCA(arma::mat& dataset,
             const size_t newDimension,
             const bool scale,
-            const double varToRetain)
+            const double varToRetain,
+            const DecompositionPolicy& decomposition = DecompositionPolicy())
 {
-  PCAType<DecompositionPolicy> p(scale);
+  PCAType<DecompositionPolicy> p(scale, decomposition);
 
   Log::Info << "Performing PCA on dataset..." << endl;
   double varRetained;
@@ -146,12 +155,25 @@ void mlpackMain()
   {
     RunPCA<QUICSVDPolicy>(dataset, newDimension, scale, varToRetain);
   }
+  else if (decompositionMethod == "incremental")
+  {
+    if (CLI::GetParam<int>("batch_size") <= 0)
+    {
+      Log::Fatal << "Batch size (--batch_size) must be positive (received "
+          << CLI::GetParam<int>("batch_size") << ")." << endl;
+    }
+
+    IncrementalSVDPolicy decomposition(
+        (size_t) CLI::GetParam<int>("batch_size"));
+    RunPCA<IncrementalSVDPolicy>(dataset, newDimension, scale, varToRetain,
+        decomposition);
+  }
   else
   {
     // Invalid decomposition method.
     Log::Fatal << "Invalid decomposition method ('" << decompositionMethod
         << "'); valid choices are 'exact', 'randomized', "
-        << "'randomized-block-krylov', 'quic'." << endl;
+        << "'randomized-block-krylov', 'quic', 'incremental'." << endl;
   }
 
   // Now save the results.
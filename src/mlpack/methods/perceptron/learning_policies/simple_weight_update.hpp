@@ -60,6 +60,31 @@ class SimpleWeightUpdate
     weights.col(correctClass) += instanceWeight * trainingPoint;
     biases(correctClass) += instanceWeight;
   }
+
+  /**
+   * Apply the updates of all the misclassified points of a block at once.
+   * Column j of the coefficients holds -instanceWeight at the class that point
+   * j was incorrectly classified as and +instanceWeight at its true class (and
+   * is zero if the point was correctly classified), so the update of the
+   * weights is a single matrix product.
+   *
+   * @tparam MatType Type of matrix (should be an Armadillo matrix or submatrix
+   *      like arma::mat or arma::sp_mat).
+   * @param points Points of the block.
+   * @param weights Matrix of weights.
+   * @param biases Vector of biases.
+   * @param coefficients Coefficients of the update of each class for each
+   *      point.
+   */
+  template<typename MatType>
+  void UpdateWeights(const MatType& points,
+                     arma::mat& weights,
+                     arma::vec& biases,
+                     const arma::mat& coefficients)
+  {
+    weights += points * coefficients.t();
+    biases += arma::sum(coefficients, 1);
+  }
 };
 
 } // namespace perceptron
@@ -26,6 +26,19 @@ namespace perceptron {
  * network).  It converges if the supplied training dataset is linearly
  * separable.
  *
+ * By default the weights are updated after each misclassified point.  With a
+ * BatchSize() larger than 1, the points are scored a block at a time with one
+ * matrix product, and the updates of all the misclassified points of a block
+ * are applied together (also with one matrix product) before the next block
+ * is scored.  With Average(), the averaged perceptron is trained: the final
+ * weights are the average of the weights after each point (or block), which
+ * generalizes better when the data is not separable.  Averaging requires the
+ * updates of the LearnPolicy to be proportional to the instance weights, as
+ * with SimpleWeightUpdate.
+ *
+ * These settings are copied by the constructor used by AdaBoost, so the weak
+ * learners train the same way as the given perceptron.
+ *
  * @tparam LearnPolicy Options of SimpleWeightUpdate and GradientDescent.
  * @tparam WeightInitializationPolicy Option of ZeroInitialization and
  *      RandomInitialization.
@@ -113,6 +126,9 @@ class Perceptron
    * @param test Testing data or data to classify.
    * @param predictedLabels Vector to store the predicted classes after
    *     classifying test.
+   *
+   * The points are scored in blocks, with one matrix product per block, and
+   * the blocks are classified in parallel.
    */
   void Classify(const MatType& test, arma::Row<size_t>& predictedLabels);
 
@@ -127,6 +143,16 @@ class Perceptron
   //! Modify the maximum number of iterations.
   size_t& MaxIterations() { return maxIterations; }
 
+  //! Get the number of points scored before the weights are updated.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points scored before the weights are updated.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get whether the averaged perceptron is trained.
+  bool Average() const { return average; }
+  //! Modify whether the averaged perceptron is trained.
+  bool& Average() { return average; }
+
   //! Get the number of classes this perceptron has been trained for.
   size_t NumClasses() const { return weights.n_cols; }
 
@@ -141,9 +167,18 @@ class Perceptron
   arma::vec& Biases() { return biases; }
 
  private:
+  //! Number of points that Classify() scores at once, in each thread.
+  static const size_t ClassifyBlockSize = 1024;
+
   //! The maximum number of iterations during training.
   size_t maxIterations;
 
+  //! The number of points scored before the weights are updated.
+  size_t batchSize;
+
+  //! Whether the averaged perceptron is trained.
+  bool average;
+
   /**
    * Stores the weights for each of the input class labels.  Each column
    * corresponds to the weights for one class label, and each row corresponds to
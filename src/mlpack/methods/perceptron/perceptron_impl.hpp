@@ -30,7 +30,9 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const size_t numClasses,
     const size_t dimensionality,
     const size_t maxIterations) :
-    maxIterations(maxIterations)
+    maxIterations(maxIterations),
+    batchSize(1),
+    average(false)
 {
   WeightInitializationPolicy wip;
   wip.Initialize(weights, biases, dimensionality, numClasses);
@@ -56,7 +58,9 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const arma::Row<size_t>& labels,
     const size_t numClasses,
     const size_t maxIterations) :
-    maxIterations(maxIterations)
+    maxIterations(maxIterations),
+    batchSize(1),
+    average(false)
 {
   // Start training.
   Train(data, labels, numClasses);
@@ -84,7 +88,9 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const arma::Row<size_t>& labels,
     const size_t numClasses,
     const arma::rowvec& instanceWeights) :
-    maxIterations(other.maxIterations)
+    maxIterations(other.maxIterations),
+    batchSize(other.batchSize),
+    average(other.average)
 {
   Train(data, labels, numClasses, instanceWeights);
 }
@@ -106,15 +112,28 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::vec tempLabelMat;
-  arma::uword maxIndex = 0;
+  predictedLabels.set_size(test.n_cols);
 
-  // Could probably be faster if done in batch.
-  for (size_t i = 0; i < test.n_cols; i++)
+  // Each block of points is scored with one matrix product.
+  const size_t numBlocks = (test.n_cols + ClassifyBlockSize - 1) /
+      ClassifyBlockSize;
+
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
-    tempLabelMat = weights.t() * test.col(i) + biases;
-    tempLabelMat.max(maxIndex);
-    predictedLabels(0, i) = maxIndex;
+    const size_t begin = b * ClassifyBlockSize;
+    const size_t end = std::min((size_t) test.n_cols,
+        begin + ClassifyBlockSize) - 1;
+
+    arma::mat scores = weights.t() * test.cols(begin, end);
+    scores.each_col() += biases;
+
+    arma::uword maxIndex = 0;
+    for (size_t j = 0; j < scores.n_cols; ++j)
+    {
+      scores.col(j).max(maxIndex);
+      predictedLabels[begin + j] = maxIndex;
+    }
   }
 }
 
@@ -155,6 +174,18 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
 
   const bool hasWeights = (instanceWeights.n_elem > 0);
 
+  // For the averaged perceptron, each update is also added to these sums,
+  // multiplied by the number of the step (point or block) it was made at; the
+  // average of the weights over the steps is then weights - sums / steps.
+  arma::mat weightSums;
+  arma::vec biasSums;
+  size_t steps = 1;
+  if (average)
+  {
+    weightSums.zeros(weights.n_rows, weights.n_cols);
+    biasSums.zeros(biases.n_elem);
+  }
+
   while ((i < maxIterations) && (!converged))
   {
     // This outer loop is for each iteration, and we use the 'converged'
@@ -162,8 +193,53 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
     i++;
     converged = true;
 
+    if (batchSize > 1)
+    {
+      // Score each block of points with one matrix product, then update the
+      // weights with all the misclassified points of the block.
+      for (size_t begin = 0; begin < data.n_cols; begin += batchSize, ++steps)
+      {
+        const size_t end = std::min((size_t) data.n_cols, begin + batchSize) -
+            1;
+
+        arma::mat scores = weights.t() * data.cols(begin, end);
+        scores.each_col() += biases;
+
+        arma::mat coefficients(weights.n_cols, scores.n_cols,
+            arma::fill::zeros);
+        bool updated = false;
+        for (j = 0; j < scores.n_cols; j++)
+        {
+          scores.col(j).max(maxIndexRow);
+          tempLabel = labels(0, begin + j);
+          if (maxIndexRow != tempLabel)
+          {
+            const double instanceWeight = hasWeights ?
+                instanceWeights(begin + j) : 1.0;
+            coefficients(maxIndexRow, j) -= instanceWeight;
+            coefficients(tempLabel, j) += instanceWeight;
+            updated = true;
+          }
+        }
+
+        if (updated)
+        {
+          converged = false;
+          LP.UpdateWeights(data.cols(begin, end), weights, biases,
+              coefficients);
+          if (average)
+          {
+            LP.UpdateWeights(data.cols(begin, end), weightSums, biasSums,
+                arma::mat(steps * coefficients));
+          }
+        }
+      }
+
+      continue;
+    }
+
     // Now this inner loop is for going through the dataset in each iteration.
-    for (j = 0; j < data.n_cols; j++)
+    for (j = 0; j < data.n_cols; j++, ++steps)
     {
       // Multiply for each variable and check whether the current weight vector
       // correctly classifies this.
@@ -181,15 +257,28 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
         // Send maxIndexRow for knowing which weight to update, send j to know
         // the value of the vector to update it with.  Send tempLabel to know
         // the correct class.
+        const double instanceWeight = hasWeights ? instanceWeights(j) : 1.0;
         if (hasWeights)
           LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow, tempLabel,
               instanceWeights(j));
         else
           LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow,
               tempLabel);
+
+        if (average)
+        {
+          LP.UpdateWeights(data.col(j), weightSums, biasSums, maxIndexRow,
+              tempLabel, steps * instanceWeight);
+        }
       }
     }
   }
+
+  if (average)
+  {
+    weights -= weightSums / (double) steps;
+    biases -= biasSums / (double) steps;
+  }
 }
 
 //! Serialize the perceptron.
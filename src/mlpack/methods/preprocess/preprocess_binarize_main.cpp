@@ -71,22 +71,28 @@ void mlpackMain()
     Log::Warn << "You did not specify --output_file, so no result will be "
         << "saved." << endl;
 
-  // Load the data.
+  // Load the data.  It is binarized in place, so no second matrix is needed.
   arma::mat input = std::move(CLI::GetParam<arma::mat>("input"));
-  arma::mat output;
+
+  if (CLI::HasParam("dimension") && (CLI::GetParam<int>("dimension") < 0 ||
+      dimension >= input.n_rows))
+  {
+    Log::Fatal << "Invalid dimension " << CLI::GetParam<int>("dimension")
+        << "; must be between 0 and " << input.n_rows << "." << endl;
+  }
 
   Timer::Start("binarize");
   if (CLI::HasParam("dimension"))
   {
-    data::Binarize<double>(input, output, threshold, dimension);
+    data::Binarize<double>(input, threshold, dimension);
   }
   else
   {
     // binarize the whole data
-    data::Binarize<double>(input, output, threshold);
+    data::Binarize<double>(input, threshold);
   }
   Timer::Stop("binarize");
 
   if (CLI::HasParam("output"))
-    CLI::GetParam<arma::mat>("output") = std::move(output);
+    CLI::GetParam<arma::mat>("output") = std::move(input);
 }
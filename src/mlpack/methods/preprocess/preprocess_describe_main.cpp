@@ -12,6 +12,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/core/math/moments.hpp>
 
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
@@ -61,85 +62,6 @@ PARAM_FLAG("row_major", "If specified, the program will calculate statistics "
     "across rows, not across columns.  (Remember that in mlpack, a column "
     "represents a point, so this option is generally not necessary.)", "r");
 
-/**
-* Calculates the sum of deviations to the Nth Power.
-*
-* @param input Vector that captures a dimension of a dataset.
-* @param rowMean Mean of the given vector.
-* @param n Degree of power.
-* @return sum of nth power deviations.
-*/
-double SumNthPowerDeviations(const arma::rowvec& input,
-                             const double& fMean,
-                             size_t n)
-{
-  return arma::sum(arma::pow(input - fMean, static_cast<double>(n)));
-}
-
-/**
- * Calculates Skewness of the given vector.
- *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Skewness of the given vector.
- */
-double Skewness(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
-                const bool population)
-{
-  double skewness = 0;
-  const double S3 = pow(fStd, 3);
-  const double M3 = SumNthPowerDeviations(input, fMean, 3);
-  const double n = input.n_elem;
-  if (population)
-  {
-    // Calculate population skewness
-    skewness = M3 / (n * S3);
-  }
-  else
-  {
-    // Calculate sample skewness.
-    skewness = n * M3 / ((n - 1) * (n - 2) * S3);
-  }
-  return skewness;
-}
-
-/**
- * Calculates excess kurtosis of the given vector.
- *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Kurtosis of the given vector.
- */
-double Kurtosis(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
-                const bool population)
-{
-  double kurtosis = 0;
-  const double M4 = SumNthPowerDeviations(input, fMean, 4);
-  const double n = input.n_elem;
-  if (population)
-  {
-    // Calculate population excess kurtosis.
-    const double M2 = SumNthPowerDeviations(input, fMean, 2);
-    kurtosis = n * (M4 / pow(M2, 2)) - 3;
-  }
-  else
-  {
-    // Calculate sample excess kurtosis.
-    const double S4 = pow(fStd, 4);
-    const double norm3 = (3 * (n - 1) * (n - 1)) / ((n - 2) * (n - 3));
-    const double normC = (n * (n + 1)) / ((n - 1) * (n - 2) * (n - 3));
-    const double normM = M4 / S4;
-    kurtosis = normC * normM - norm3;
-  }
-  return kurtosis;
-}
-
 /**
  * Calculates standard error of standard deviation.
  *
@@ -183,50 +105,69 @@ void mlpackMain()
       % "dim" % "var" % "mean" % "std" % "median" % "min" % "max"
       % "range" % "skew" % "kurt" % "SE" << endl;
 
-  // Lambda function to print out the results.
-  auto PrintStatResults = [&](size_t dim, bool rowMajor)
+  // Lambda function to print out the results, given the moments of the
+  // dimension.
+  auto PrintStatResults = [&](size_t dim, const math::Moments& moments)
   {
-    arma::rowvec feature;
-    if (rowMajor)
-      feature = arma::conv_to<arma::rowvec>::from(data.col(dim));
-    else
-      feature = data.row(dim);
-
     // f at the front of the variable names means "feature".
-    const double fMax = arma::max(feature);
-    const double fMin = arma::min(feature);
-    const double fMean = arma::mean(feature);
-    const double fStd = arma::stddev(feature, population);
+    const double fMedian = rowMajor ? arma::median(data.col(dim)) :
+        arma::median(data.row(dim));
+    const double fStd = moments.StandardDeviation(population);
 
     // Print statistics of the given dimension.
     Log::Info << boost::format(numberFormat)
         % dim
-        % arma::var(feature, population)
-        % fMean
+        % moments.Variance(population)
+        % moments.Mean()
         % fStd
-        % arma::median(feature)
-        % fMin
-        % fMax
-        % (fMax - fMin) // range
-        % Skewness(feature, fStd, fMean, population)
-        % Kurtosis(feature, fStd, fMean, population)
-        % StandardError(feature.n_elem, fStd)
+        % fMedian
+        % moments.Min()
+        % moments.Max()
+        % (moments.Max() - moments.Min()) // range
+        % moments.Skewness(population)
+        % moments.Kurtosis(population)
+        % StandardError(moments.Count(), fStd)
         << endl;
   };
 
   // If the user specified dimension, describe statistics of the given
-  // dimension. If a dimension is not specified, describe all dimensions.
+  // dimension. If a dimension is not specified, describe all dimensions.  The
+  // moments of all dimensions are computed in a single pass over the data.
   if (CLI::HasParam("dimension"))
   {
-    PrintStatResults(dimension, rowMajor);
+    math::Moments moments;
+    if (rowMajor)
+    {
+      for (size_t i = 0; i < data.n_rows; ++i)
+        moments.Add(data(i, dimension));
+    }
+    else
+    {
+      for (size_t i = 0; i < data.n_cols; ++i)
+        moments.Add(data(dimension, i));
+    }
+
+    PrintStatResults(dimension, moments);
   }
   else
   {
-    const size_t dimensions = rowMajor ? data.n_cols : data.n_rows;
-    for (size_t i = 0; i < dimensions; ++i)
+    std::vector<math::Moments> moments;
+    if (rowMajor)
     {
-      PrintStatResults(i, rowMajor);
+      // Each dimension is a column, so they are independent passes.
+      moments.resize(data.n_cols);
+      #pragma omp parallel for
+      for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+        for (size_t j = 0; j < data.n_rows; ++j)
+          moments[i].Add(data(j, i));
     }
+    else
+    {
+      math::DimensionMoments(data, moments);
+    }
+
+    for (size_t i = 0; i < moments.size(); ++i)
+      PrintStatResults(i, moments[i]);
   }
   Timer::Stop("statistics");
 }
@@ -23,16 +23,17 @@ QUIC_SVD::QUIC_SVD(const arma::mat& dataset,
                    arma::mat& v,
                    arma::mat& sigma,
                    const double epsilon,
-                   const double delta) :
+                   const double delta,
+                   const size_t batchSize) :
     dataset(dataset)
 {
   // Since columns are sample in the implementation, the matrix is transposed if
   // necessary for maximum speedup.
   CosineTree* ctree;
   if (dataset.n_cols > dataset.n_rows)
-    ctree = new CosineTree(dataset, epsilon, delta);
+    ctree = new CosineTree(dataset, epsilon, delta, batchSize);
   else
-    ctree = new CosineTree(dataset.t(), epsilon, delta);
+    ctree = new CosineTree(dataset.t(), epsilon, delta, batchSize);
 
   // Get subspace basis by creating the cosine tree.
   ctree->GetFinalBasis(basis);
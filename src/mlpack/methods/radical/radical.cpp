@@ -37,15 +37,20 @@ Radical::Radical(const double noiseStdDev,
 void Radical::CopyAndPerturb(mat& xNew, const mat& x) const
 {
   Timer::Start("radical_copy_and_perturb");
-  xNew = repmat(x, replicates, 1) + noiseStdDev * randn(replicates * x.n_rows,
-      x.n_cols);
+  // The noise is generated in place, so that the memory of xNew is reused.
+  xNew.set_size(replicates * x.n_rows, x.n_cols);
+  xNew.randn();
+  xNew *= noiseStdDev;
+  for (size_t i = 0; i < replicates; i++)
+    xNew.rows(i * x.n_rows, (i + 1) * x.n_rows - 1) += x;
   Timer::Stop("radical_copy_and_perturb");
 }
 
 
 double Radical::Vasicek(vec& z) const
 {
-  z = sort(z);
+  // Sort in place, without a temporary.
+  std::sort(z.begin(), z.end());
 
   // Apparently slower.
   /*
@@ -68,28 +73,36 @@ double Radical::Vasicek(vec& z) const
 
 double Radical::DoRadical2D(const mat& matX)
 {
-  CopyAndPerturb(perturbed, matX);
+  return DoRadical2D(matX, perturbed);
+}
+
 
-  mat::fixed<2, 2> matJacobi;
+double Radical::DoRadical2D(const mat& matX, mat& perturbed) const
+{
+  CopyAndPerturb(perturbed, matX);
 
   vec values(angles);
 
-  for (size_t i = 0; i < angles; i++)
+  // The angles are independent, so each thread rotates the replicates into its
+  // own vectors, which are then sorted in place by Vasicek().
+  #pragma omp parallel
   {
-    const double theta = (i / (double) angles) * M_PI / 2.0;
-    const double cosTheta = cos(theta);
-    const double sinTheta = sin(theta);
+    vec candidateY1(perturbed.n_rows);
+    vec candidateY2(perturbed.n_rows);
 
-    matJacobi(0, 0) = cosTheta;
-    matJacobi(1, 0) = -sinTheta;
-    matJacobi(0, 1) = sinTheta;
-    matJacobi(1, 1) = cosTheta;
+    #pragma omp for schedule(static)
+    for (omp_size_t i = 0; i < (omp_size_t) angles; i++)
+    {
+      const double theta = (i / (double) angles) * M_PI / 2.0;
+      const double cosTheta = cos(theta);
+      const double sinTheta = sin(theta);
 
-    candidate = perturbed * matJacobi;
-    vec candidateY1 = candidate.unsafe_col(0);
-    vec candidateY2 = candidate.unsafe_col(1);
+      // This is perturbed times the Jacobi rotation matrix.
+      candidateY1 = cosTheta * perturbed.col(0) - sinTheta * perturbed.col(1);
+      candidateY2 = sinTheta * perturbed.col(0) + cosTheta * perturbed.col(1);
 
-    values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+      values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+    }
   }
 
   uword indOpt = 0;
@@ -133,8 +146,7 @@ void Radical::DoRadical(const mat& matXT, mat& matY, mat& matW)
   matW = matWhitening;
 
   mat matYSubspace(nPoints, 2);
-
-  mat matJ = eye(nDims, nDims);
+  vec matYColumn(nPoints);
 
   for (size_t sweepNum = 0; sweepNum < sweeps; sweepNum++)
   {
@@ -155,19 +167,12 @@ void Radical::DoRadical(const mat& matXT, mat& matY, mat& matW)
         const double cosThetaOpt = cos(thetaOpt);
         const double sinThetaOpt = sin(thetaOpt);
 
-        // Set elements of transformation matrix.
-        matJ(i, i) = cosThetaOpt;
-        matJ(j, i) = -sinThetaOpt;
-        matJ(i, j) = sinThetaOpt;
-        matJ(j, j) = cosThetaOpt;
-
-        matY *= matJ;
-
-        // Unset elements of transformation matrix, so matJ = eye() again.
-        matJ(i, i) = 1;
-        matJ(j, i) = 0;
-        matJ(i, j) = 0;
-        matJ(j, j) = 1;
+        // The Jacobi rotation only changes dimensions i and j, so only those
+        // two columns of matY are rotated (instead of multiplying matY by the
+        // whole nDims x nDims rotation matrix).
+        matYColumn = matY.col(i);
+        matY.col(i) = cosThetaOpt * matYColumn - sinThetaOpt * matY.col(j);
+        matY.col(j) = sinThetaOpt * matYColumn + cosThetaOpt * matY.col(j);
       }
     }
   }
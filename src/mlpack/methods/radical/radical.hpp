@@ -84,11 +84,15 @@ class Radical
   /**
    * Make replicates of each data point (the number of replicates is set in
    * either the constructor or with Replicates()) and perturb data with Gaussian
-   * noise with standard deviation noiseStdDev.
+   * noise with standard deviation noiseStdDev.  xNew is only reallocated if
+   * it does not have the right size already.
    */
   void CopyAndPerturb(arma::mat& xNew, const arma::mat& x) const;
 
-  //! Two-dimensional version of RADICAL.
+  /**
+   * Two-dimensional version of RADICAL.  The candidate angles are evaluated in
+   * parallel.
+   */
   double DoRadical2D(const arma::mat& matX);
 
   //! Get the standard deviation of the additive Gaussian noise.
@@ -131,8 +135,12 @@ class Radical
 
   //! Internal matrix, held as member variable to prevent memory reallocations.
   arma::mat perturbed;
-  //! Internal matrix, held as member variable to prevent memory reallocations.
-  arma::mat candidate;
+
+  /**
+   * Two-dimensional version of RADICAL, with the given matrix to hold the
+   * perturbed replicates of the data.
+   */
+  double DoRadical2D(const arma::mat& matX, arma::mat& perturbed) const;
 };
 
 void WhitenFeatureMajorMatrix(const arma::mat& matX,
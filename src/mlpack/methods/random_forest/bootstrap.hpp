@@ -3,14 +3,33 @@
  * @author Ryan Curtin
  *
  * Implementation of the Bootstrap() function, which creates a bootstrapped
- * dataset from the given input dataset.
+ * dataset from the given input dataset, and of the BootstrapIndices() function,
+ * which only draws the indices of the points of a bootstrap sample.
  */
 #ifndef MLPACK_METHODS_RANDOM_FOREST_BOOTSTRAP_HPP
 #define MLPACK_METHODS_RANDOM_FOREST_BOOTSTRAP_HPP
 
+#include <mlpack/core/math/random.hpp>
+
 namespace mlpack {
 namespace tree {
 
+/**
+ * Draw the indices of the points of a bootstrap sample of a dataset with the
+ * given number of points: that many indices, sampled uniformly with
+ * replacement.  The random numbers are drawn with math::RandInt(), so a
+ * math::RandomStreamScope applies to them.
+ *
+ * @param numPoints Number of points in the dataset.
+ * @param indices Set to the indices of the sample.
+ */
+inline void BootstrapIndices(const size_t numPoints, arma::uvec& indices)
+{
+  indices.set_size(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    indices[i] = (arma::uword) math::RandInt(numPoints);
+}
+
 /**
  * Given a dataset, create another dataset via bootstrap sampling, with labels.
  */
@@ -0,0 +1,206 @@
+/**
+ * @file flat_forest.hpp
+ *
+ * Definition of the FlatForest class, which holds trained decision trees or
+ * random forests in contiguous node tables for fast classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/decision_tree.hpp>
+#include "random_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Whether the given numeric split type sends a point to its left child when
+ * its value is at most the split value held in the first element of the split
+ * information, and to its right child otherwise.  Only trees with such numeric
+ * splits can be flattened.
+ */
+template<typename SplitType>
+struct IsThresholdSplit
+{
+  static const bool value = false;
+};
+
+//! BestBinaryNumericSplit splits on a threshold.
+template<typename FitnessFunction>
+struct IsThresholdSplit<BestBinaryNumericSplit<FitnessFunction>>
+{
+  static const bool value = true;
+};
+
+//! HistogramNumericSplit splits on a threshold.
+template<typename FitnessFunction>
+struct IsThresholdSplit<HistogramNumericSplit<FitnessFunction>>
+{
+  static const bool value = true;
+};
+
+/**
+ * Whether the given categorical split type sends a point to the child whose
+ * index is the category of the point.  Only trees with such categorical splits
+ * can be flattened.
+ */
+template<typename SplitType>
+struct IsCategoryIndexSplit
+{
+  static const bool value = false;
+};
+
+//! AllCategoricalSplit has a child for each category.
+template<typename FitnessFunction>
+struct IsCategoryIndexSplit<AllCategoricalSplit<FitnessFunction>>
+{
+  static const bool value = true;
+};
+
+/**
+ * A FlatForest holds one or more trained DecisionTrees (for instance all the
+ * trees of a RandomForest) as contiguous tables of nodes, instead of as nodes
+ * scattered on the heap, and classifies points with them.  Each node is a
+ * position in the tables of split dimensions, thresholds and child positions;
+ * the children of a node are next to each other, and the class probabilities
+ * of all the leaves are in a single array.
+ *
+ * The points are classified in blocks: every tree takes all the points of a
+ * block down one level at a time, so the top nodes of the tree stay in the
+ * cache and the lookups of the different points do not wait for each other.
+ * The blocks are classified in parallel with OpenMP.  The predictions and
+ * probabilities are the same as those of the original tree or forest.
+ *
+ * @code
+ * RandomForest<> rf(data, labels, numClasses, 50);
+ * FlatForest flat(rf);
+ * flat.Classify(testData, predictions, probabilities);
+ * @endcode
+ *
+ * The trees must use threshold numeric splits (see IsThresholdSplit) and
+ * category index splits (see IsCategoryIndexSplit).  A FlatForest is not
+ * updated when the trees change, so it should be built again after training.
+ */
+class FlatForest
+{
+ public:
+  //! Create an empty FlatForest; Classify() will throw until trees are added.
+  FlatForest() : numClasses(0) { }
+
+  /**
+   * Flatten the given decision tree.
+   *
+   * @param tree Trained decision tree.
+   */
+  template<typename FitnessFunction,
+           template<typename> class NumericSplitType,
+           template<typename> class CategoricalSplitType,
+           typename DimensionSelectionType,
+           typename ElemType,
+           bool NoRecursion>
+  FlatForest(const DecisionTree<FitnessFunction, NumericSplitType,
+      CategoricalSplitType, DimensionSelectionType, ElemType, NoRecursion>&
+      tree);
+
+  /**
+   * Flatten all the trees of the given random forest.
+   *
+   * @param forest Trained random forest.
+   */
+  template<typename FitnessFunction,
+           typename DimensionSelectionType,
+           template<typename> class NumericSplitType,
+           template<typename> class CategoricalSplitType,
+           typename ElemType>
+  FlatForest(const RandomForest<FitnessFunction, DimensionSelectionType,
+      NumericSplitType, CategoricalSplitType, ElemType>& forest);
+
+  /**
+   * Add the given decision tree to the forest.  The class probabilities of the
+   * forest are the average of those of its trees.
+   *
+   * @param tree Trained decision tree, with as many classes as the others.
+   */
+  template<typename TreeType>
+  void AddTree(const TreeType& tree);
+
+  /**
+   * Classify the given points.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Classify the given points, and also return the probability of each class
+   * for each point.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   * @param probabilities This will be filled with class probabilities for each
+   *     point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of trees.
+  size_t NumTrees() const { return roots.size(); }
+  //! Get the total number of nodes of the trees.
+  size_t NumNodes() const { return types.size(); }
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+
+ private:
+  //! The kinds of nodes.
+  enum NodeType : unsigned char
+  {
+    LEAF,
+    NUMERIC,
+    CATEGORICAL
+  };
+
+  //! Number of points that are classified together.
+  static const size_t BlockSize = 64;
+
+  //! Append the given node and its descendants to the tables.
+  template<typename TreeType>
+  void AddNode(const TreeType& node, const size_t position);
+
+  //! Number of classes.
+  size_t numClasses;
+  //! The position of the root of each tree.
+  std::vector<size_t> roots;
+
+  //! The kind of each node.
+  std::vector<NodeType> types;
+  //! The split dimension of each node with children.
+  std::vector<size_t> dimensions;
+  //! The split value of each numeric node.
+  std::vector<double> thresholds;
+  //! The position of the first child of each node with children, or the
+  //! index of the leaf in leafProbabilities and leafClasses for a leaf.
+  std::vector<size_t> children;
+
+  //! The class probabilities of each leaf, numClasses values per leaf.
+  std::vector<double> leafProbabilities;
+  //! The majority class of each leaf.
+  std::vector<size_t> leafClasses;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_forest_impl.hpp"
+
+#endif
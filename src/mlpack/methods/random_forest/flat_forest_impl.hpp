@@ -0,0 +1,206 @@
+/**
+ * @file flat_forest_impl.hpp
+ *
+ * Implementation of the FlatForest class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+FlatForest::FlatForest(const DecisionTree<FitnessFunction, NumericSplitType,
+    CategoricalSplitType, DimensionSelectionType, ElemType, NoRecursion>&
+    tree) :
+    numClasses(0)
+{
+  AddTree(tree);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+FlatForest::FlatForest(const RandomForest<FitnessFunction,
+    DimensionSelectionType, NumericSplitType, CategoricalSplitType, ElemType>&
+    forest) :
+    numClasses(0)
+{
+  for (size_t i = 0; i < forest.NumTrees(); ++i)
+    AddTree(forest.Tree(i));
+}
+
+template<typename TreeType>
+void FlatForest::AddTree(const TreeType& tree)
+{
+  static_assert(IsThresholdSplit<typename TreeType::NumericSplit>::value,
+      "FlatForest: the numeric split type of the tree must be a threshold "
+      "split");
+  static_assert(
+      IsCategoryIndexSplit<typename TreeType::CategoricalSplit>::value,
+      "FlatForest: the categorical split type of the tree must be a category "
+      "index split");
+
+  if (roots.empty())
+  {
+    numClasses = tree.NumClasses();
+  }
+  else if (tree.NumClasses() != numClasses)
+  {
+    std::ostringstream oss;
+    oss << "FlatForest::AddTree(): the tree has " << tree.NumClasses()
+        << " classes, but the other trees have " << numClasses;
+    throw std::invalid_argument(oss.str());
+  }
+
+  roots.push_back(types.size());
+  types.push_back(LEAF);
+  dimensions.push_back(0);
+  thresholds.push_back(0.0);
+  children.push_back(0);
+  AddNode(tree, roots.back());
+}
+
+template<typename TreeType>
+void FlatForest::AddNode(const TreeType& node, const size_t position)
+{
+  if (node.NumChildren() == 0)
+  {
+    types[position] = LEAF;
+    children[position] = leafClasses.size();
+    leafClasses.push_back(node.MajorityClass());
+    leafProbabilities.insert(leafProbabilities.end(),
+        node.ClassProbabilities().begin(), node.ClassProbabilities().end());
+    return;
+  }
+
+  const bool categorical =
+      (node.SplitDimensionType() == data::Datatype::categorical);
+  types[position] = categorical ? CATEGORICAL : NUMERIC;
+  dimensions[position] = node.SplitDimension();
+  thresholds[position] = categorical ? 0.0 : node.ClassProbabilities()[0];
+
+  // The children are placed next to each other, so that the child of a point
+  // is found from its direction.
+  const size_t firstChild = types.size();
+  children[position] = firstChild;
+  types.resize(firstChild + node.NumChildren(), LEAF);
+  dimensions.resize(firstChild + node.NumChildren(), 0);
+  thresholds.resize(firstChild + node.NumChildren(), 0.0);
+  children.resize(firstChild + node.NumChildren(), 0);
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    AddNode(node.Child(i), firstChild + i);
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions,
+                          arma::mat& probabilities) const
+{
+  if (roots.empty())
+  {
+    predictions.clear();
+    probabilities.clear();
+    throw std::invalid_argument("FlatForest::Classify(): no trees have been "
+        "added!");
+  }
+
+  predictions.set_size(data.n_cols);
+  probabilities.zeros(numClasses, data.n_cols);
+
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t count = std::min((size_t) BlockSize,
+        (size_t) data.n_cols - begin);
+
+    size_t nodes[BlockSize];
+    for (size_t t = 0; t < roots.size(); ++t)
+    {
+      for (size_t k = 0; k < count; ++k)
+        nodes[k] = roots[t];
+
+      // Take every point of the block down one level at a time, until all of
+      // them are in leaves.
+      bool moved = true;
+      while (moved)
+      {
+        moved = false;
+        for (size_t k = 0; k < count; ++k)
+        {
+          const size_t node = nodes[k];
+          if (types[node] == LEAF)
+            continue;
+
+          const double value = data(dimensions[node], begin + k);
+          if (types[node] == NUMERIC)
+            nodes[k] = children[node] + ((value <= thresholds[node]) ? 0 : 1);
+          else
+            nodes[k] = children[node] + (size_t) value;
+          moved = true;
+        }
+      }
+
+      for (size_t k = 0; k < count; ++k)
+      {
+        const double* leaf = leafProbabilities.data() +
+            children[nodes[k]] * numClasses;
+        double* probs = probabilities.colptr(begin + k);
+        for (size_t c = 0; c < numClasses; ++c)
+          probs[c] += leaf[c];
+
+        // A single tree predicts the majority class of the leaf, like
+        // DecisionTree::Classify().
+        if (roots.size() == 1)
+          predictions[begin + k] = leafClasses[children[nodes[k]]];
+      }
+    }
+
+    // Like RandomForest::Classify(), a forest predicts the class with the
+    // largest average probability.
+    if (roots.size() > 1)
+    {
+      for (size_t k = 0; k < count; ++k)
+      {
+        arma::vec probs(probabilities.colptr(begin + k), numClasses, false,
+            true);
+        probs /= roots.size();
+        arma::uword maxIndex = 0;
+        probs.max(maxIndex);
+        predictions[begin + k] = (size_t) maxIndex;
+      }
+    }
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -235,6 +235,11 @@ class RandomForest
    * predicted class probabilities for each point.  If the random forest has not
    * been trained, this will throw an exception.
    *
+   * The points are classified in blocks, and every tree classifies every block
+   * as a separate task, in parallel with OpenMP; the probabilities of each
+   * point are then averaged over the trees.  The result is the same as when
+   * each point is classified on its own.
+   *
    * @param data Dataset to be classified.
    * @param predictions Output predictions for each point in the dataset.
    * @param probabilities Output matrix of class probabilities for each point.
@@ -252,6 +257,18 @@ class RandomForest
   //! Get the number of trees in the forest.
   size_t NumTrees() const { return trees.size(); }
 
+  /**
+   * Map the split values of a forest that was trained on the bins of the given
+   * binning to values of the dimensions (see DecisionTree::MapBinnedSplits()),
+   * so that the forest classifies the original data.  A forest can be trained
+   * on the arma::Mat<uint8_t> bins of a data::FeatureBinning, or on an
+   * arma::fmat, like on an arma::mat, because the trees are trained on the
+   * shared dataset.  This must only be called once.
+   *
+   * @param binning The binning of the training data.
+   */
+  void MapBinnedSplits(const data::FeatureBinning& binning);
+
   /**
    * Serialize the random forest.
    */
@@ -259,6 +276,9 @@ class RandomForest
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  //! Number of points that each tree classifies in one task.
+  static const size_t ClassifyBlockSize = 256;
+
   /**
    * Perform the training of the decision tree.  The template bool parameters
    * control whether or not the datasetInfo or weights arguments should be
@@ -326,11 +326,8 @@ void RandomForest<
         "trained!");
   }
 
-  predictions.set_size(data.n_cols);
-
-  #pragma omp parallel for
-  for (omp_size_t i = 0; i < data.n_cols; ++i)
-    predictions[i] = Classify(data.col(i));
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
 }
 
 template<
@@ -361,16 +358,76 @@ void RandomForest<
         "trained!");
   }
 
-  probabilities.set_size(trees[0].NumClasses(), data.n_cols);
+  const size_t numClasses = trees[0].NumClasses();
+  const size_t numBlocks = (data.n_cols + ClassifyBlockSize - 1) /
+      ClassifyBlockSize;
+  probabilities.zeros(numClasses, data.n_cols);
   predictions.set_size(data.n_cols);
-  #pragma omp parallel for
-  for (omp_size_t i = 0; i < data.n_cols; ++i)
+
+  // First find the leaf of every point in every tree.  Each (tree, block of
+  // points) pair is a separate task, so that the work is spread over the
+  // threads even for few points or few trees, and a tree stays in the cache
+  // while it classifies a block.
+  std::vector<const arma::vec*> leaves(trees.size() * data.n_cols);
+  #pragma omp parallel for num_threads(ParallelThreads()) schedule(dynamic)
+  for (omp_size_t t = 0; t < (omp_size_t) (trees.size() * numBlocks); ++t)
   {
-    arma::vec probs = probabilities.unsafe_col(i);
-    Classify(data.col(i), predictions[i], probs);
+    const size_t tree = t / numBlocks;
+    const size_t begin = (t % numBlocks) * ClassifyBlockSize;
+    const size_t end = std::min(begin + (size_t) ClassifyBlockSize,
+        (size_t) data.n_cols);
+    for (size_t i = begin; i < end; ++i)
+    {
+      const DecisionTreeType* node = &trees[tree];
+      while (node->NumChildren() != 0)
+        node = &node->Child(node->CalculateDirection(data.col(i)));
+      leaves[tree * data.n_cols + i] = &node->ClassProbabilities();
+    }
+  }
+
+  // Then average the probabilities of the leaves of each point, in the order
+  // of the trees, so that the result does not depend on the scheduling.
+  #pragma omp parallel for num_threads(ParallelThreads())
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    double* probs = probabilities.colptr(i);
+    for (size_t tree = 0; tree < trees.size(); ++tree)
+    {
+      const arma::vec& leaf = *leaves[tree * data.n_cols + i];
+      for (size_t c = 0; c < numClasses; ++c)
+        probs[c] += leaf[c];
+    }
+
+    size_t maxIndex = 0;
+    for (size_t c = 0; c < numClasses; ++c)
+    {
+      probs[c] /= trees.size();
+      if (probs[c] > probs[maxIndex])
+        maxIndex = c;
+    }
+    predictions[i] = maxIndex;
   }
 }
 
+template<
+    typename FitnessFunction,
+    typename DimensionSelectionType,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType,
+    typename ElemType
+>
+void RandomForest<
+    FitnessFunction,
+    DimensionSelectionType,
+    NumericSplitType,
+    CategoricalSplitType,
+    ElemType
+>::MapBinnedSplits(const data::FeatureBinning& binning)
+{
+  for (size_t i = 0; i < trees.size(); ++i)
+    trees[i].MapBinnedSplits(binning);
+}
+
 template<
     typename FitnessFunction,
     typename DimensionSelectionType,
@@ -432,40 +489,22 @@ void RandomForest<
   // Train each tree individually.
   trees.resize(numTrees); // This will fill the vector with untrained trees.
 
-  #pragma omp parallel for
+  // Each tree draws its bootstrap sample and its random dimensions from its own
+  // stream, so the forest does not depend on the number of threads.
+  const uint64_t seed = math::RandomStreamSeed();
+
+  #pragma omp parallel for num_threads(ParallelThreads())
   for (omp_size_t i = 0; i < numTrees; ++i)
   {
-    MatType bootstrapDataset;
-    arma::Row<size_t> bootstrapLabels;
-    arma::rowvec bootstrapWeights;
-    Bootstrap<UseWeights>(dataset, labels, weights, bootstrapDataset,
-        bootstrapLabels, bootstrapWeights);
-
-    // Now build the decision tree.
-    if (UseWeights)
-    {
-      if (UseDatasetInfo)
-      {
-        trees[i].Train(dataset, datasetInfo, labels, numClasses, weights,
-            minimumLeafSize);
-      }
-      else
-      {
-        trees[i].Train(dataset, labels, numClasses, weights, minimumLeafSize);
-      }
-    }
-    else
-    {
-      if (UseDatasetInfo)
-      {
-        trees[i].Train(dataset, datasetInfo, labels, numClasses,
-            minimumLeafSize);
-      }
-      else
-      {
-        trees[i].Train(dataset, labels, numClasses, minimumLeafSize);
-      }
-    }
+    math::RandomStream stream(seed, i);
+    math::RandomStreamScope scope(stream);
+
+    // The tree is trained on the shared dataset through the indices of its
+    // bootstrap sample, so the dataset is not copied for each tree.
+    arma::uvec indices;
+    BootstrapIndices(dataset.n_cols, indices);
+    trees[i].template Train<UseWeights, UseDatasetInfo>(dataset, indices,
+        datasetInfo, labels, numClasses, weights, minimumLeafSize);
   }
 }
 
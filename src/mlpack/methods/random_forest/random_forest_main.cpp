@@ -6,8 +6,11 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/random_forest/random_forest.hpp>
+#include <mlpack/methods/random_forest/flat_forest.hpp>
 #include <mlpack/methods/decision_tree/random_dimension_select.hpp>
 #include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/core/data/batch_writer.hpp>
+#include <mlpack/core/data/process_batches.hpp>
 
 using namespace mlpack;
 using namespace mlpack::tree;
@@ -34,11 +37,20 @@ PARAM_FLAG("print_training_accuracy", "If set, then the accuracy of the model "
 PARAM_INT_IN("num_trees", "Number of trees in the random forest.", "N", 10);
 PARAM_INT_IN("minimum_leaf_size", "Minimum number of points in each leaf "
     "node.", "n", 20);
+PARAM_FLAG("histogram_split", "Search numeric splits among the boundaries of "
+    "at most 256 quantile buckets of the points of each node, instead of every "
+    "possible split.", "H");
 
 PARAM_MATRIX_OUT("probabilities", "Predicted class probabilities for each "
     "point in the test set.", "P");
 PARAM_UROW_OUT("predictions", "Predicted classes for each point in the test "
     "set.", "p");
+PARAM_INT_IN("test_batch_size", "If greater than 0, the points of --test_file "
+    "are classified in batches of this many points, and the predictions and "
+    "probabilities are written batch by batch; the next batches are read and "
+    "the results of the previous batches are written while a batch is "
+    "classified, so neither the test set nor the results have to fit in "
+    "memory.  The output files must be CSV or raw ASCII files.", "", 0);
 
 /**
  * This is the class that we will serialize.  It is a pretty simple wrapper
@@ -48,25 +60,157 @@ PARAM_UROW_OUT("predictions", "Predicted classes for each point in the test "
 class RandomForestModel
 {
  public:
-  // The tree itself, left public for direct access by this program.
+  //! A random forest whose numeric splits are found with histograms.
+  typedef RandomForest<GiniGain, MultipleRandomDimensionSelect<>,
+      HistogramNumericSplit> HistogramRandomForest;
+
+  // Whether the forest was trained with histogram-based numeric splits.
+  bool histogram;
+  // The forests themselves, left public for direct access by this program;
+  // only the one given by histogram is used.
   RandomForest<> rf;
+  HistogramRandomForest histogramRF;
 
   // Create the model.
-  RandomForestModel() { /* Nothing to do. */ }
+  RandomForestModel() : histogram(false) { /* Nothing to do. */ }
+
+  // Flatten the forest that is used, which makes classification faster.
+  FlatForest Flatten() const
+  {
+    return histogram ? FlatForest(histogramRF) : FlatForest(rf);
+  }
+
+  // Classify the given points with the forest that is used.
+  void Classify(const arma::mat& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const
+  {
+    Flatten().Classify(data, predictions, probabilities);
+  }
+
+  // Classify the given points with the forest that is used.
+  void Classify(const arma::mat& data, arma::Row<size_t>& predictions) const
+  {
+    arma::mat probabilities;
+    Classify(data, predictions, probabilities);
+  }
 
   // Serialize the model.
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */)
+  void Serialize(Archive& ar, const unsigned int version)
   {
-    ar & data::CreateNVP(rf, "random_forest");
+    // Histogram-based splits were added in version 1.
+    if (version > 0)
+      ar & data::CreateNVP(histogram, "histogram");
+    else if (Archive::is_loading::value)
+      histogram = false;
+
+    if (histogram)
+      ar & data::CreateNVP(histogramRF, "random_forest");
+    else
+      ar & data::CreateNVP(rf, "random_forest");
   }
 };
 
+BOOST_CLASS_VERSION(RandomForestModel, 1);
+
 PARAM_MODEL_IN(RandomForestModel, "input_model", "Pre-trained random forest to "
     "use for classification.", "m");
 PARAM_MODEL_OUT(RandomForestModel, "output_model", "Model to save trained "
     "random forest to.", "M");
 
+// Classify the points given with --test_file in batches, reading the next
+// batches and writing the results of the previous ones while each batch is
+// classified.
+void ClassifyInBatches(const RandomForestModel& rfModel,
+                       const size_t batchSize)
+{
+  // The forest is only flattened once for all batches.
+  const FlatForest forest = rfModel.Flatten();
+
+  // The test points are only numeric, so no first pass over the file is needed
+  // to map strings.
+  const string testFile = CLI::GetPrintableParam<arma::mat>("test");
+  std::unique_ptr<data::BatchReader<double, data::MissingPolicy>> reader;
+  std::unique_ptr<data::BatchWriter<size_t>> predictionsWriter;
+  std::unique_ptr<data::BatchWriter<double>> probabilitiesWriter;
+  try
+  {
+    reader.reset(new data::BatchReader<double, data::MissingPolicy>(testFile,
+        batchSize));
+    if (CLI::HasParam("predictions"))
+      predictionsWriter.reset(new data::BatchWriter<size_t>(
+          CLI::GetPrintableParam<arma::Row<size_t>>("predictions"), 1));
+    if (CLI::HasParam("probabilities"))
+      probabilitiesWriter.reset(new data::BatchWriter<double>(
+          CLI::GetPrintableParam<arma::mat>("probabilities"),
+          forest.NumClasses()));
+  }
+  catch (std::exception& e)
+  {
+    Log::Fatal << "Cannot classify in batches: " << e.what() << endl;
+  }
+
+  arma::Row<size_t> testLabels;
+  if (CLI::HasParam("test_labels"))
+    testLabels = std::move(CLI::GetParam<arma::Row<size_t>>("test_labels"));
+
+  typedef std::pair<arma::Row<size_t>, arma::mat> ResultType;
+  size_t testPoints = 0;
+  size_t correct = 0;
+  try
+  {
+    testPoints = data::ProcessBatches(*reader,
+        [&](const arma::mat& batch, const size_t first)
+        {
+          ResultType results;
+          forest.Classify(batch, results.first, results.second);
+
+          if (CLI::HasParam("test_labels"))
+          {
+            if (first + batch.n_cols > testLabels.n_elem)
+              throw std::invalid_argument("there are more test points than "
+                  "test labels");
+
+            correct += arma::accu(results.first ==
+                testLabels.subvec(first, first + batch.n_cols - 1));
+          }
+
+          return results;
+        },
+        [&](ResultType& results)
+        {
+          if (predictionsWriter)
+            predictionsWriter->WriteBatch(results.first);
+          if (probabilitiesWriter)
+            probabilitiesWriter->WriteBatch(results.second);
+        });
+
+    if (predictionsWriter)
+      predictionsWriter->Close();
+    if (probabilitiesWriter)
+      probabilitiesWriter->Close();
+  }
+  catch (std::exception& e)
+  {
+    Log::Fatal << "Classification in batches failed: " << e.what() << endl;
+  }
+
+  Log::Info << "Classified " << testPoints << " test points from '" << testFile
+      << "' in batches of " << batchSize << " points." << endl;
+
+  if (CLI::HasParam("test_labels"))
+  {
+    if (testLabels.n_elem != testPoints)
+      Log::Fatal << "There are " << testLabels.n_elem << " test labels for "
+          << testPoints << " test points!" << endl;
+
+    Log::Info << correct << " of " << testLabels.n_elem << " correct on test"
+        << " set (" << (double(correct) / double(testLabels.n_elem) * 100)
+        << ")." << endl;
+  }
+}
+
 void mlpackMain()
 {
   // Check for incompatible input parameters.
@@ -76,6 +220,12 @@ void mlpackMain()
         << endl;
   }
 
+  if (CLI::HasParam("histogram_split") && !CLI::HasParam("training"))
+  {
+    Log::Warn << "--histogram_split ignored because no model is being "
+        << "trained." << endl;
+  }
+
   if (CLI::HasParam("print_training_accuracy") && !CLI::HasParam("training"))
   {
     Log::Warn << "--print_training_accuracy ignored because no model is being "
@@ -146,6 +296,42 @@ void mlpackMain()
         << "); must be greater than 0!" << endl;
   }
 
+  if (CLI::GetParam<int>("test_batch_size") < 0)
+  {
+    Log::Fatal << "Invalid test batch size ("
+        << CLI::GetParam<int>("test_batch_size") << "); must be 0 or greater!"
+        << endl;
+  }
+
+  if (CLI::GetParam<int>("test_batch_size") > 0)
+  {
+    if (!CLI::HasParam("test"))
+    {
+      Log::Warn << "--test_batch_size ignored because --test_file not "
+          << "specified." << endl;
+    }
+
+    // Binary files need the number of points before the first batch is
+    // written.
+    std::vector<string> outputFiles;
+    if (CLI::HasParam("predictions"))
+      outputFiles.push_back(CLI::GetPrintableParam<arma::Row<size_t>>(
+          "predictions"));
+    if (CLI::HasParam("probabilities"))
+      outputFiles.push_back(CLI::GetPrintableParam<arma::mat>(
+          "probabilities"));
+    for (const string& outputFile : outputFiles)
+    {
+      const string extension = data::Extension(outputFile);
+      if (extension != "csv" && extension != "txt")
+      {
+        Log::Fatal << "Cannot write '" << outputFile << "' in batches; the "
+            << "output files must be CSV or raw ASCII files (.csv or .txt) "
+            << "with --test_batch_size." << endl;
+      }
+    }
+  }
+
   RandomForestModel rfModel;
   if (CLI::HasParam("training"))
   {
@@ -163,13 +349,22 @@ void mlpackMain()
     const size_t numClasses = arma::max(labels) + 1;
 
     // Train the model.
-    rfModel.rf.Train(data, labels, numClasses, numTrees, minimumLeafSize);
+    rfModel.histogram = CLI::HasParam("histogram_split");
+    if (rfModel.histogram)
+    {
+      rfModel.histogramRF.Train(data, labels, numClasses, numTrees,
+          minimumLeafSize);
+    }
+    else
+    {
+      rfModel.rf.Train(data, labels, numClasses, numTrees, minimumLeafSize);
+    }
 
     // Did we want training accuracy?
     if (CLI::HasParam("print_training_accuracy"))
     {
       arma::Row<size_t> predictions;
-      rfModel.rf.Classify(data, predictions);
+      rfModel.Classify(data, predictions);
 
       const size_t correct = arma::accu(predictions == labels);
 
@@ -184,14 +379,18 @@ void mlpackMain()
     rfModel = std::move(CLI::GetParam<RandomForestModel>("input_model"));
   }
 
-  if (CLI::HasParam("test"))
+  if (CLI::HasParam("test") && CLI::GetParam<int>("test_batch_size") > 0)
+  {
+    ClassifyInBatches(rfModel, (size_t) CLI::GetParam<int>("test_batch_size"));
+  }
+  else if (CLI::HasParam("test"))
   {
     arma::mat testData = std::move(CLI::GetParam<arma::mat>("test"));
 
     // Get predictions and probabilities.
     arma::Row<size_t> predictions;
     arma::mat probabilities;
-    rfModel.rf.Classify(testData, predictions, probabilities);
+    rfModel.Classify(testData, predictions, probabilities);
 
     // Did we want to calculate test accuracy?
     if (CLI::HasParam("test_labels"))
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/column_blocks.hpp>
 
 namespace mlpack {
 namespace svd {
@@ -120,6 +121,28 @@ class RandomizedSVD
              arma::mat& v,
              const size_t rank);
 
+  /**
+   * Apply Principal Component Analysis to a data set that is given as blocks
+   * of columns (see data::MatrixColumnBlocks and data::HDF5ColumnBlocks), such
+   * as a memory-mapped matrix or an HDF5 dataset that does not fit in memory.
+   * Each product with the data is a parallel pass over the blocks, so only a
+   * few blocks (one per thread) are in memory at a time, besides matrices of
+   * iteratedPower columns with one row per row or column of the data.  The
+   * result is the same as with Apply().
+   *
+   * @param data Blocks of the data matrix.
+   * @param u First unitary matrix.
+   * @param v Second unitary matrix.
+   * @param sigma Diagonal matrix of singular values.
+   * @param rank Rank of the approximation.
+   */
+  template<typename BlocksType>
+  void ApplyBlocks(const BlocksType& data,
+                   arma::mat& u,
+                   arma::vec& s,
+                   arma::mat& v,
+                   const size_t rank);
+
   //! Get the size of the normalized power iterations.
   size_t IteratedPower() const { return iteratedPower; }
   //! Modify the size of the normalized power iterations.
@@ -149,4 +172,7 @@ class RandomizedSVD
 } // namespace svd
 } // namespace mlpack
 
+// Include implementation.
+#include "randomized_svd_impl.hpp"
+
 #endif
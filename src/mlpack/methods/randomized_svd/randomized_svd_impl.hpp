@@ -0,0 +1,124 @@
+/**
+ * @file randomized_svd_impl.hpp
+ *
+ * Implementation of the randomized SVD method on data given as blocks of
+ * columns.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_IMPL_HPP
+#define MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "randomized_svd.hpp"
+
+namespace mlpack {
+namespace svd {
+
+template<typename BlocksType>
+void RandomizedSVD::ApplyBlocks(const BlocksType& data,
+                                arma::mat& u,
+                                arma::vec& s,
+                                arma::mat& v,
+                                const size_t rank)
+{
+  if (iteratedPower == 0)
+    iteratedPower = rank + 2;
+
+  // The data is never centered: with the centered data C = data - mean * 1^T,
+  // C * x = data * x - mean * (1^T * x) and C^T * y = data^T * y -
+  // 1 * (mean^T * y).
+  arma::vec rowMean;
+  data::ColumnBlockSums(data, rowMean);
+  rowMean = rowMean / data.Cols() + eps;
+
+  arma::mat R, Q, Qdata;
+  const bool wide = (data.Cols() >= data.Rows());
+
+  // Apply the centered data matrix to a random matrix, obtaining Q.
+  if (wide)
+  {
+    R = arma::randn<arma::mat>(data.Rows(), iteratedPower);
+    data::ColumnBlockTransMultiply(data, R, Q);
+    Q.each_row() -= rowMean.t() * R;
+  }
+  else
+  {
+    R = arma::randn<arma::mat>(data.Cols(), iteratedPower);
+    data::ColumnBlockMultiply(data, R, Q);
+    Q -= rowMean * arma::sum(R, 0);
+  }
+
+  // Form a matrix Q whose columns constitute a
+  // well-conditioned basis for the columns of the earlier Q.
+  if (maxIterations == 0)
+  {
+    arma::qr_econ(Q, v, Q);
+  }
+  else
+  {
+    arma::lu(Q, v, Q);
+  }
+
+  // Perform normalized power iterations.
+  arma::mat product;
+  for (size_t i = 0; i < maxIterations; ++i)
+  {
+    if (wide)
+    {
+      data::ColumnBlockMultiply(data, Q, product);
+      Q = product - rowMean * arma::sum(Q, 0);
+      arma::lu(Q, v, Q);
+      data::ColumnBlockTransMultiply(data, Q, product);
+      product.each_row() -= rowMean.t() * Q;
+      Q = std::move(product);
+    }
+    else
+    {
+      data::ColumnBlockTransMultiply(data, Q, product);
+      product.each_row() -= rowMean.t() * Q;
+      Q = std::move(product);
+      arma::lu(Q, v, Q);
+      data::ColumnBlockMultiply(data, Q, product);
+      Q = product - rowMean * arma::sum(Q, 0);
+    }
+
+    // As in Apply(), only the last iteration uses the QR decomposition.
+    if (i < (maxIterations - 1))
+    {
+      arma::lu(Q, v, Q);
+    }
+    else
+    {
+      arma::qr_econ(Q, v, Q);
+    }
+  }
+
+  // Do economical singular value decomposition and compute only the
+  // approximations of the left singular vectors by using the centered data
+  // applied to Q.
+  if (wide)
+  {
+    data::ColumnBlockMultiply(data, Q, Qdata);
+    Qdata -= rowMean * arma::sum(Q, 0);
+    arma::svd_econ(u, s, v, Qdata);
+    v = Q * v;
+  }
+  else
+  {
+    // Q^T * C = (C^T * Q)^T.
+    data::ColumnBlockTransMultiply(data, Q, product);
+    product.each_row() -= rowMean.t() * Q;
+    Qdata = product.t();
+    arma::svd_econ(u, s, v, Qdata);
+    u = Q * u;
+  }
+}
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
@@ -30,6 +30,9 @@ class TrainVisitor;
  * algorithm; for more details on the actual algorithm, see the RangeSearchRules
  * class.
  *
+ * In naive and single-tree mode, the query points are divided between threads
+ * with OpenMP; dual-tree search uses only the calling thread.
+ *
  * @tparam MetricType Metric to use for range search calculations.
  * @tparam MatType Type of data to use.
  * @tparam TreeType Type of tree to use; must satisfy the TreeType policy API.
@@ -192,6 +195,19 @@ class RangeSearch
    */
   void Train(Tree* referenceTree);
 
+  /**
+   * Set the reference tree to a tree that uses the structure and the points
+   * held by the given SharedTree, so that no tree is built and the points are
+   * not copied.  The results are given in terms of the original indices of the
+   * points.  This object keeps a copy of the handle while it uses the tree.
+   *
+   * This is only available for BinarySpaceTree types, and the tree held by the
+   * handle must have the same bound and element type as this tree type.
+   *
+   * @param referenceTree Handle to the shared reference tree.
+   */
+  void Train(const tree::SharedTree& referenceTree);
+
   /**
    * Search for all reference points in the given range for each point in the
    * query set, returning the results in the neighbors and distances objects.
@@ -299,6 +315,76 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, and call the given callback with each result as soon as it is
+   * found, instead of storing the results.  This takes no memory for the
+   * results, so it is a good choice when there are very many of them.  The
+   * callback is called as
+   *
+   * @code
+   * callback(queryIndex, referenceIndex, distance);
+   * @endcode
+   *
+   * where the indices are the indices of the points in the query set and the
+   * reference set.  The results are found in no particular order.  In naive
+   * and single-tree mode, the callback is called from several threads at once
+   * (but never for the same query point at the same time), so it must be safe
+   * to call that way.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Callback to call with each result.
+   */
+  template<typename CallbackType>
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, and call the given callback with each result as soon as it is found,
+   * instead of storing the results.  The query set and the reference set are
+   * the same, and a point is not in its own results.  The callback is called
+   * as
+   *
+   * @code
+   * callback(queryIndex, referenceIndex, distance);
+   * @endcode
+   *
+   * As above, in naive and single-tree mode the callback is called from several
+   * threads at once.
+   *
+   * @param range Range of distances in which to search.
+   * @param callback Callback to call with each result.
+   */
+  template<typename CallbackType>
+  void Search(const math::Range& range, CallbackType& callback);
+
+  /**
+   * Count the reference points in the given range for each point in the query
+   * set, without storing the results.  Reference points that are known to be in
+   * the range because their entire node is do not need a distance evaluation.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param counts Will hold the number of reference points in the range of each
+   *      query point.
+   */
+  void Count(const MatType& querySet,
+             const math::Range& range,
+             arma::Col<size_t>& counts);
+
+  /**
+   * Count the points in the given range for each point in the reference set,
+   * without storing the results.  A point is not counted in its own range.
+   *
+   * @param range Range of distances in which to search.
+   * @param counts Will hold the number of points in the range of each point of
+   *      the reference set.
+   */
+  void Count(const math::Range& range, arma::Col<size_t>& counts);
+
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return singleMode; }
   //! Modify whether single-tree search is being used.
@@ -325,6 +411,42 @@ class RangeSearch
   Tree* ReferenceTree() { return referenceTree; }
 
  private:
+  /**
+   * Run the search of the given query set with the given output object, as
+   * naive, single-tree or dual-tree search.  The given indices are those after
+   * tree building; if a query tree is built, oldFromNewQueries is filled with
+   * the mapping of the query points (before the traversal).
+   */
+  template<typename OutputType>
+  void RunSearch(const MatType& querySet,
+                 const math::Range& range,
+                 const OutputType& output,
+                 std::vector<size_t>& oldFromNewQueries);
+
+  /**
+   * Run the monochromatic search with the given output object, as naive,
+   * single-tree or dual-tree search.  The given indices are those of the
+   * reference tree.
+   */
+  template<typename OutputType>
+  void RunSearch(const math::Range& range, const OutputType& output);
+
+  /**
+   * Compute the base cases of the given rules for the query points with
+   * indices in [0, numQueries) and every reference point, using several
+   * threads, and add them to the number of base cases.
+   */
+  template<typename RuleType>
+  void NaiveSearch(const RuleType& rules, const size_t numQueries);
+
+  /**
+   * Traverse the reference tree with the given rules for each of the query
+   * points with indices in [0, numQueries), using several threads, and add the
+   * base cases and scores to those of the search.
+   */
+  template<typename RuleType>
+  void SingleTreeSearch(const RuleType& rules, const size_t numQueries);
+
   //! Mappings to old reference indices (used when this object builds trees).
   std::vector<size_t> oldFromNewReferences;
   //! Reference tree.
@@ -337,6 +459,8 @@ class RangeSearch
   bool treeOwner;
   //! If true, we own the reference set.
   bool setOwner;
+  //! If the reference tree uses the data of a SharedTree, the handle to it.
+  tree::SharedTree sharedTree;
 
   //! If true, O(n^2) naive computation is used.
   bool naive;
@@ -352,7 +476,7 @@ class RangeSearch
   size_t scores;
 
   //! For access to mappings when building models.
-  friend class TrainVisitor;
+  template<typename> friend class TrainVisitor;
 };
 
 } // namespace range
@@ -175,6 +175,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
     referenceSet(other.referenceSet),
     treeOwner(other.treeOwner),
     setOwner(other.setOwner),
+    sharedTree(std::move(other.sharedTree)),
     naive(other.naive),
     singleMode(other.singleMode),
     metric(std::move(other.metric)),
@@ -208,7 +209,8 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(const RangeSearch& other)
   if (setOwner)
     delete referenceSet;
 
-  // Copy the other model.
+  // Copy the other model.  The copied tree owns its points.
+  sharedTree = tree::SharedTree();
   oldFromNewReferences = other.oldFromNewReferences;
   referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
@@ -244,6 +246,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
   referenceSet = other.referenceSet;
   treeOwner = other.treeOwner;
   setOwner = other.setOwner;
+  sharedTree = std::move(other.sharedTree);
   naive = other.naive;
   singleMode = other.singleMode;
   metric = std::move(other.metric);
@@ -289,6 +292,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
     delete referenceTree;
+  sharedTree = tree::SharedTree();
 
   // Rebuild the tree, if necessary.
   if (!naive)
@@ -324,6 +328,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
     delete referenceTree;
+  sharedTree = tree::SharedTree();
 
   // We may need to rebuild the tree.
   if (!naive)
@@ -367,6 +372,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
 
   if (treeOwner && referenceTree)
     delete this->referenceTree;
+  sharedTree = tree::SharedTree();
   if (setOwner && referenceSet)
     delete this->referenceSet;
 
@@ -376,6 +382,37 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   setOwner = false;
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Train(
+    const tree::SharedTree& referenceTree)
+{
+  if (naive)
+    throw std::invalid_argument("cannot train on given reference tree when "
+        "naive search (without trees) is desired");
+
+  // Load the new tree first, so nothing changes if the handle is not usable.
+  std::vector<size_t> oldFromNew;
+  Tree* newTree = referenceTree.Tree<Tree>(oldFromNew);
+
+  if (treeOwner && this->referenceTree)
+    delete this->referenceTree;
+  if (setOwner && referenceSet)
+    delete this->referenceSet;
+
+  // The handle is replaced only after the old tree is gone, since that tree may
+  // use the data of the old handle.
+  sharedTree = referenceTree;
+  oldFromNewReferences = std::move(oldFromNew);
+  this->referenceTree = newTree;
+  this->referenceSet = &newTree->Dataset();
+  treeOwner = true;
+  setOwner = false;
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -444,29 +481,16 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
   if (naive)
   {
+    // The naive brute-force solution.
     RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
         metric);
-
-    // The naive brute-force solution.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
-
-    baseCases += (querySet.n_cols * referenceSet->n_cols);
+    NaiveSearch(rules, querySet.n_cols);
   }
   else if (singleMode)
   {
-    // Create the traverser.
     RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
         metric);
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    SingleTreeSearch(rules, querySet.n_cols);
   }
   else // Dual-tree recursion.
   {
@@ -669,27 +693,18 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
       *distancePtr, metric, true /* don't return the query in the results */);
 
+  // Reset counts.
+  baseCases = 0;
+  scores = 0;
+
   if (naive)
   {
     // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
-
-    baseCases = (referenceSet->n_cols * referenceSet->n_cols);
-    scores = 0;
+    NaiveSearch(rules, referenceSet->n_cols);
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases = rules.BaseCases();
-    scores = rules.Scores();
+    SingleTreeSearch(rules, referenceSet->n_cols);
   }
   else // Dual-tree recursion.
   {
@@ -732,6 +747,299 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    CallbackType& callback)
+{
+  if (querySet.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "RangeSearch::Search(): dimensionalities of query set ("
+        << querySet.n_rows << ") and reference set (" << referenceSet->n_rows
+        << ") do not match!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
+
+  Timer::Start("range_search/computing_neighbors");
+
+  // The indices are mapped back to their original indices before they are
+  // given to the callback, if the trees we built rearranged the points.
+  std::vector<size_t> oldFromNewQueries;
+  const bool mapQueries = tree::TreeTraits<Tree>::RearrangesDataset &&
+      !singleMode && !naive;
+  const bool mapReferences = tree::TreeTraits<Tree>::RearrangesDataset &&
+      treeOwner;
+  RangeSearchCallback<CallbackType> output(callback,
+      mapQueries ? &oldFromNewQueries : NULL,
+      mapReferences ? &oldFromNewReferences : NULL);
+
+  RunSearch(querySet, range, output, oldFromNewQueries);
+
+  Timer::Stop("range_search/computing_neighbors");
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    CallbackType& callback)
+{
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
+
+  Timer::Start("range_search/computing_neighbors");
+
+  // Both the query and the reference indices are indices in the reference
+  // tree.
+  const std::vector<size_t>* mapping = (treeOwner &&
+      tree::TreeTraits<Tree>::RearrangesDataset) ? &oldFromNewReferences :
+      NULL;
+  RangeSearchCallback<CallbackType> output(callback, mapping, mapping);
+
+  RunSearch(range, output);
+
+  Timer::Stop("range_search/computing_neighbors");
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Count(
+    const MatType& querySet,
+    const math::Range& range,
+    arma::Col<size_t>& counts)
+{
+  if (querySet.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "RangeSearch::Count(): dimensionalities of query set ("
+        << querySet.n_rows << ") and reference set (" << referenceSet->n_rows
+        << ") do not match!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  counts.zeros(querySet.n_cols);
+
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
+
+  Timer::Start("range_search/computing_neighbors");
+
+  std::vector<size_t> oldFromNewQueries;
+  RunSearch(querySet, range, RangeSearchCounter(counts), oldFromNewQueries);
+
+  Timer::Stop("range_search/computing_neighbors");
+
+  // Map the counts back to the original query indices, if we built a query
+  // tree that rearranged the points.
+  if (!oldFromNewQueries.empty())
+  {
+    arma::Col<size_t> newCounts(counts.n_elem);
+    for (size_t i = 0; i < counts.n_elem; ++i)
+      newCounts[oldFromNewQueries[i]] = counts[i];
+    counts = std::move(newCounts);
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Count(
+    const math::Range& range,
+    arma::Col<size_t>& counts)
+{
+  counts.zeros(referenceSet->n_cols);
+
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
+
+  Timer::Start("range_search/computing_neighbors");
+
+  RunSearch(range, RangeSearchCounter(counts));
+
+  Timer::Stop("range_search/computing_neighbors");
+
+  // Map the counts back to the original indices, if necessary.
+  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
+  {
+    arma::Col<size_t> newCounts(counts.n_elem);
+    for (size_t i = 0; i < counts.n_elem; ++i)
+      newCounts[oldFromNewReferences[i]] = counts[i];
+    counts = std::move(newCounts);
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename OutputType>
+void RangeSearch<MetricType, MatType, TreeType>::RunSearch(
+    const MatType& querySet,
+    const math::Range& range,
+    const OutputType& output,
+    std::vector<size_t>& oldFromNewQueries)
+{
+  typedef RangeSearchRules<MetricType, Tree, OutputType> RuleType;
+
+  // Reset counts.
+  baseCases = 0;
+  scores = 0;
+
+  if (naive)
+  {
+    // The naive brute-force solution.
+    RuleType rules(*referenceSet, querySet, range, output, metric);
+    NaiveSearch(rules, querySet.n_cols);
+  }
+  else if (singleMode)
+  {
+    RuleType rules(*referenceSet, querySet, range, output, metric);
+    SingleTreeSearch(rules, querySet.n_cols);
+  }
+  else // Dual-tree recursion.
+  {
+    // Build the query tree.
+    Timer::Stop("range_search/computing_neighbors");
+    Timer::Start("range_search/tree_building");
+    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    Timer::Stop("range_search/tree_building");
+    Timer::Start("range_search/computing_neighbors");
+
+    // Create the traverser.
+    RuleType rules(*referenceSet, queryTree->Dataset(), range, output, metric);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+
+    traverser.Traverse(*queryTree, *referenceTree);
+
+    baseCases += rules.BaseCases();
+    scores += rules.Scores();
+
+    // Clean up tree memory.
+    delete queryTree;
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename OutputType>
+void RangeSearch<MetricType, MatType, TreeType>::RunSearch(
+    const math::Range& range,
+    const OutputType& output)
+{
+  typedef RangeSearchRules<MetricType, Tree, OutputType> RuleType;
+  RuleType rules(*referenceSet, *referenceSet, range, output, metric,
+      true /* don't return the query in the results */);
+
+  // Reset counts.
+  baseCases = 0;
+  scores = 0;
+
+  if (naive)
+  {
+    // The naive brute-force solution.
+    NaiveSearch(rules, referenceSet->n_cols);
+  }
+  else if (singleMode)
+  {
+    SingleTreeSearch(rules, referenceSet->n_cols);
+  }
+  else // Dual-tree recursion.
+  {
+    // Create the traverser.
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+
+    traverser.Traverse(*referenceTree, *referenceTree);
+
+    baseCases = rules.BaseCases();
+    scores = rules.Scores();
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+void RangeSearch<MetricType, MatType, TreeType>::NaiveSearch(
+    const RuleType& rules,
+    const size_t numQueries)
+{
+  // The query points are independent, so they are divided between threads,
+  // each of which has its own copy of the rules.
+  #pragma omp parallel
+  {
+    RuleType workerRules(rules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+      for (size_t j = 0; j < referenceSet->n_cols; ++j)
+        workerRules.BaseCase(i, j);
+  }
+
+  baseCases += numQueries * referenceSet->n_cols;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+void RangeSearch<MetricType, MatType, TreeType>::SingleTreeSearch(
+    const RuleType& rules,
+    const size_t numQueries)
+{
+  size_t ruleBaseCases = 0, ruleScores = 0;
+
+  // The traversals of the query points are independent and do not change the
+  // reference tree, so the query points are divided between threads, each of
+  // which has its own copy of the rules.
+  #pragma omp parallel reduction(+:ruleBaseCases, ruleScores)
+  {
+    RuleType workerRules(rules);
+    typename Tree::template SingleTreeTraverser<RuleType>
+        traverser(workerRules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    ruleBaseCases += workerRules.BaseCases();
+    ruleScores += workerRules.Scores();
+  }
+
+  baseCases += ruleBaseCases;
+  scores += ruleScores;
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -775,6 +1083,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Serialize(
     {
       if (treeOwner && referenceTree)
         delete referenceTree;
+      sharedTree = tree::SharedTree();
 
       referenceTree = NULL;
       oldFromNewReferences.clear();
@@ -788,6 +1097,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Serialize(
     {
       if (treeOwner && referenceTree)
         delete referenceTree;
+      sharedTree = tree::SharedTree();
 
       // After we load the tree, we will own it.
       treeOwner = true;
@@ -16,6 +16,10 @@
 #include <mlpack/core/util/mlpack_main.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/data/query_server.hpp>
+
+#include <memory>
+#include <sstream>
 
 #include "range_search.hpp"
 #include "rs_model.hpp"
@@ -83,6 +87,9 @@ PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, "
     "Hilbert R trees, R+ trees, R++ trees, and octrees).", "l", 20);
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_FLAG("single_precision", "If true, the reference set and the tree are "
+    "stored in single precision, which halves their memory footprint.  Only "
+    "available for kd-trees, ball trees and octrees.", "");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
@@ -90,6 +97,112 @@ PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "S");
 
+// Serving settings.
+PARAM_FLAG("serve", "If true, the program does not exit after the model is "
+    "built or loaded, but answers batches of query points (with the range "
+    "given by --min and --max) that are sent on standard input until the input "
+    "ends, writing the results to standard output.  All pending batches are "
+    "answered with a single search.  See the QueryServer class for the format "
+    "of requests and responses.", "");
+PARAM_STRING_IN("serve_socket", "If specified with --serve, batches of query "
+    "points are read from the clients of a Unix domain socket at this path "
+    "instead of standard input.", "", "");
+PARAM_INT_IN("serve_batch_size", "Maximum number of query points that --serve "
+    "searches at once.", "", 100000);
+
+// Answer batches of query points until no more arrive.
+void Serve(RSModel& rs, const math::Range& range)
+{
+  std::unique_ptr<data::QueryServer> server;
+  try
+  {
+    if (CLI::HasParam("serve_socket"))
+      server.reset(new data::QueryServer(
+          CLI::GetParam<string>("serve_socket")));
+    else
+      server.reset(new data::QueryServer());
+  }
+  catch (std::exception& e)
+  {
+    Log::Fatal << "Cannot serve queries: " << e.what() << endl;
+  }
+
+  const size_t referenceRows = rs.SinglePrecision() ?
+      rs.SinglePrecisionDataset().n_rows : rs.Dataset().n_rows;
+  const size_t maxPoints = (size_t) CLI::GetParam<int>("serve_batch_size");
+
+  std::vector<data::QueryServer::Request> requests;
+  while (server->Collect(requests, maxPoints))
+  {
+    // Requests with the wrong dimensionality are answered with an error.
+    std::vector<std::string> errors(requests.size());
+    size_t numPoints = 0;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+      if (requests[i].points.n_rows != referenceRows &&
+          requests[i].points.n_cols > 0)
+      {
+        std::ostringstream oss;
+        oss << "query points have " << requests[i].points.n_rows
+            << " dimensions, but the reference points have " << referenceRows;
+        errors[i] = oss.str();
+      }
+      else
+      {
+        numPoints += requests[i].points.n_cols;
+      }
+    }
+
+    // All other requests are answered with one search.
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    if (numPoints > 0)
+    {
+      arma::mat queryData(referenceRows, numPoints);
+      size_t col = 0;
+      for (size_t i = 0; i < requests.size(); ++i)
+      {
+        if (!errors[i].empty() || requests[i].points.n_cols == 0)
+          continue;
+
+        queryData.cols(col, col + requests[i].points.n_cols - 1) =
+            requests[i].points;
+        col += requests[i].points.n_cols;
+      }
+
+      try
+      {
+        rs.Search(std::move(queryData), range, neighbors, distances);
+      }
+      catch (std::exception& e)
+      {
+        for (size_t i = 0; i < requests.size(); ++i)
+          if (errors[i].empty())
+            errors[i] = e.what();
+      }
+    }
+
+    // Send the results in the order of the requests.
+    size_t col = 0;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+      if (!errors[i].empty())
+      {
+        server->RespondError(requests[i], errors[i]);
+        continue;
+      }
+
+      const size_t n = requests[i].points.n_cols;
+      server->Respond(requests[i],
+          vector<vector<size_t>>(neighbors.begin() + col,
+                                 neighbors.begin() + col + n),
+          vector<vector<double>>(distances.begin() + col,
+                                 distances.begin() + col + n));
+      col += n;
+    }
+  }
+}
+
 void mlpackMain()
 {
   if (CLI::GetParam<int>("seed") != 0)
@@ -97,6 +210,12 @@ void mlpackMain()
   else
     math::RandomSeed((size_t) std::time(NULL));
 
+  // When queries are served on standard input, the responses are written to
+  // standard output, so warnings and other messages go to standard error.
+  std::unique_ptr<data::StandardOutputRedirect> redirect;
+  if (CLI::HasParam("serve") && !CLI::HasParam("serve_socket"))
+    redirect.reset(new data::StandardOutputRedirect());
+
   // A user cannot specify both reference data and a model.
   if (CLI::HasParam("reference") && CLI::HasParam("input_model"))
     Log::Fatal << "Only one of --reference_file (-r) or --input_model_file (-m)"
@@ -124,6 +243,35 @@ void mlpackMain()
           << "specified." << endl;
   }
 
+  if (CLI::HasParam("serve"))
+  {
+    if (!CLI::HasParam("min") && !CLI::HasParam("max"))
+      Log::Fatal << "--serve requires a range to search (--min or --max)!"
+          << endl;
+    if (!CLI::HasParam("serve_socket") && CLI::HasParam("verbose"))
+      Log::Fatal << "--verbose (-v) can't be used with --serve on standard "
+          << "input, because the results are written to standard output!"
+          << endl;
+
+    // Notify the user of parameters that will be ignored.
+    if (CLI::HasParam("query"))
+      Log::Warn << "--query_file (-q) will be ignored because --serve is "
+          << "specified." << endl;
+    if (CLI::HasParam("neighbors_file") || CLI::HasParam("distances_file"))
+      Log::Warn << "--neighbors_file and --distances_file will be ignored "
+          << "because --serve is specified." << endl;
+  }
+  else if (CLI::HasParam("serve_socket") || CLI::HasParam("serve_batch_size"))
+  {
+    Log::Warn << "--serve_socket and --serve_batch_size will be ignored "
+        << "because --serve is not specified." << endl;
+  }
+
+  if (CLI::GetParam<int>("serve_batch_size") < 1)
+    Log::Fatal << "Invalid --serve_batch_size: "
+        << CLI::GetParam<int>("serve_batch_size") << "; must be greater than "
+        << "0." << endl;
+
   // The user must give something to do...
   if (!CLI::HasParam("min") && !CLI::HasParam("max") &&
       !CLI::HasParam("output_model"))
@@ -132,6 +280,7 @@ void mlpackMain()
 
   // If the user specifies a range but not output files, they should be warned.
   if ((CLI::HasParam("min") || CLI::HasParam("max")) &&
+      !CLI::HasParam("serve") &&
       !(CLI::HasParam("neighbors_file") || CLI::HasParam("distances_file")))
     Log::Warn << "Neither --neighbors_file nor --distances_file is specified, "
         << "so the range search results will not be saved!" << endl;
@@ -205,17 +354,41 @@ void mlpackMain()
 
     const size_t leafSize = size_t(lsInt);
 
-    rs.BuildModel(std::move(referenceSet), leafSize, naive, singleMode);
+    if (CLI::HasParam("single_precision"))
+    {
+      if (tree != RSModel::KD_TREE && tree != RSModel::BALL_TREE &&
+          tree != RSModel::OCTREE)
+        Log::Fatal << "--single_precision is only available for kd-trees, "
+            << "ball trees and octrees." << endl;
+
+      // Release the double-precision copy before the tree is built.
+      arma::fmat singleReferenceSet =
+          arma::conv_to<arma::fmat>::from(referenceSet);
+      referenceSet.reset();
+      rs.BuildModel(std::move(singleReferenceSet), leafSize, naive,
+          singleMode);
+    }
+    else
+    {
+      rs.BuildModel(std::move(referenceSet), leafSize, naive, singleMode);
+    }
   }
   else
   {
+    if (CLI::HasParam("single_precision"))
+      Log::Warn << "--single_precision will be ignored because --input_model "
+          << "is specified." << endl;
+
     // Load the model from file.
     rs = std::move(CLI::GetParam<RSModel>("input_model"));
 
+    const size_t rows = rs.SinglePrecision() ?
+        rs.SinglePrecisionDataset().n_rows : rs.Dataset().n_rows;
+    const size_t cols = rs.SinglePrecision() ?
+        rs.SinglePrecisionDataset().n_cols : rs.Dataset().n_cols;
     Log::Info << "Loaded range search model from '"
         << CLI::GetPrintableParam<RSModel>("input_model") << "' ("
-        << "trained on " << rs.Dataset().n_rows << "x" << rs.Dataset().n_cols
-        << " dataset)." << endl;
+        << "trained on " << rows << "x" << cols << " dataset)." << endl;
 
     // Adjust singleMode and naive if necessary.
     rs.SingleMode() = CLI::HasParam("single_mode");
@@ -223,8 +396,17 @@ void mlpackMain()
     rs.LeafSize() = size_t(lsInt);
   }
 
+  // Answer queries until no more arrive, if desired.
+  if (CLI::HasParam("serve"))
+  {
+    const double min = CLI::GetParam<double>("min");
+    const double max = CLI::HasParam("max") ? CLI::GetParam<double>("max") :
+        DBL_MAX;
+
+    Serve(rs, math::Range(min, max));
+  }
   // Perform search, if desired.
-  if (CLI::HasParam("min") || CLI::HasParam("max"))
+  else if (CLI::HasParam("min") || CLI::HasParam("max"))
   {
     const double min = CLI::GetParam<double>("min");
     const double max = CLI::HasParam("max") ? CLI::GetParam<double>("max") :
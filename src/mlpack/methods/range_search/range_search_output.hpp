@@ -0,0 +1,190 @@
+/**
+ * @file range_search_output.hpp
+ *
+ * Output policies for RangeSearchRules.  They decide what happens with each
+ * result of a range search: it can be stored in vectors (the default), only be
+ * counted, or be handed to a user-supplied callback.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_OUTPUT_HPP
+#define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_OUTPUT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace range {
+
+/**
+ * An output policy for RangeSearchRules must provide the following:
+ *
+ * - static const bool NeedsDistances: if false, the distance given to Add() is
+ *   not meaningful, so the rules do not compute the distances of points that
+ *   are known to be in the range.
+ *
+ * - void Reserve(const size_t queryIndex, const size_t count): called before
+ *   at most count results of the given query point are added at once, so that
+ *   storage can be reserved for them.
+ *
+ * - void Add(const size_t queryIndex, const size_t referenceIndex,
+ *            const double distance): called once for every reference point that
+ *   is in the range of a query point.
+ *
+ * The rules keep a copy of the output object, so an output object should only
+ * refer to the place where the results go.  In naive and single-tree search,
+ * each thread has its own copy of the rules, so Add() may be called from
+ * several threads at once, but never for the same query point at the same
+ * time.
+ */
+
+/**
+ * The default output policy: store the indices and distances of the results of
+ * each query point in vectors.
+ */
+class RangeSearchResults
+{
+ public:
+  //! The distances of the results are stored.
+  static const bool NeedsDistances = true;
+
+  /**
+   * Store the results in the given vectors, which must have an element for
+   * each query point.
+   *
+   * @param neighbors Vector to store resulting neighbors in.
+   * @param distances Vector to store resulting distances in.
+   */
+  RangeSearchResults(std::vector<std::vector<size_t>>& neighbors,
+                     std::vector<std::vector<double>>& distances) :
+      neighbors(&neighbors),
+      distances(&distances)
+  { }
+
+  //! Reserve space for count more results of the given query point.
+  void Reserve(const size_t queryIndex, const size_t count)
+  {
+    const size_t oldSize = (*neighbors)[queryIndex].size();
+    (*neighbors)[queryIndex].reserve(oldSize + count);
+    (*distances)[queryIndex].reserve(oldSize + count);
+  }
+
+  //! Store the given result.
+  void Add(const size_t queryIndex,
+           const size_t referenceIndex,
+           const double distance)
+  {
+    (*neighbors)[queryIndex].push_back(referenceIndex);
+    (*distances)[queryIndex].push_back(distance);
+  }
+
+ private:
+  //! The vector the resultant neighbor indices are stored in.
+  std::vector<std::vector<size_t>>* neighbors;
+  //! The vector the resultant neighbor distances are stored in.
+  std::vector<std::vector<double>>* distances;
+};
+
+/**
+ * An output policy that only counts the results of each query point.  This
+ * needs one counter per query point, no matter how many results there are.
+ */
+class RangeSearchCounter
+{
+ public:
+  //! The distances of the results are not needed.
+  static const bool NeedsDistances = false;
+
+  /**
+   * Count the results in the given vector, which must have an element for each
+   * query point.  The counts are added to the existing elements.
+   *
+   * @param counts Vector to count the results of each query point in.
+   */
+  RangeSearchCounter(arma::Col<size_t>& counts) : counts(&counts) { }
+
+  //! Nothing needs to be reserved.
+  void Reserve(const size_t /* queryIndex */, const size_t /* count */) { }
+
+  //! Count the given result.
+  void Add(const size_t queryIndex,
+           const size_t /* referenceIndex */,
+           const double /* distance */)
+  {
+    ++(*counts)[queryIndex];
+  }
+
+ private:
+  //! The counts of the results of each query point.
+  arma::Col<size_t>* counts;
+};
+
+/**
+ * An output policy that calls the given callback with each result, as soon as
+ * it is found, so the results are never stored.  The callback is called as
+ *
+ * @code
+ * callback(queryIndex, referenceIndex, distance);
+ * @endcode
+ *
+ * Optionally, the query and reference indices can be mapped before the
+ * callback is called, for instance to the indices the points had before a tree
+ * rearranged them.
+ *
+ * @tparam CallbackType Type of the callback; a function or function object.
+ */
+template<typename CallbackType>
+class RangeSearchCallback
+{
+ public:
+  //! The callback receives the distances.
+  static const bool NeedsDistances = true;
+
+  /**
+   * Call the given callback with each result.
+   *
+   * @param callback Callback to call.
+   * @param oldFromNewQueries If not NULL, query index i is given to the
+   *     callback as (*oldFromNewQueries)[i].
+   * @param oldFromNewReferences If not NULL, reference index i is given to the
+   *     callback as (*oldFromNewReferences)[i].
+   */
+  RangeSearchCallback(
+      CallbackType& callback,
+      const std::vector<size_t>* oldFromNewQueries = NULL,
+      const std::vector<size_t>* oldFromNewReferences = NULL) :
+      callback(&callback),
+      oldFromNewQueries(oldFromNewQueries),
+      oldFromNewReferences(oldFromNewReferences)
+  { }
+
+  //! Nothing needs to be reserved.
+  void Reserve(const size_t /* queryIndex */, const size_t /* count */) { }
+
+  //! Hand the given result to the callback.
+  void Add(const size_t queryIndex,
+           const size_t referenceIndex,
+           const double distance)
+  {
+    (*callback)(
+        oldFromNewQueries ? (*oldFromNewQueries)[queryIndex] : queryIndex,
+        oldFromNewReferences ? (*oldFromNewReferences)[referenceIndex] :
+            referenceIndex,
+        distance);
+  }
+
+ private:
+  //! The callback to call.
+  CallbackType* callback;
+  //! The mapping of the query indices, if any.
+  const std::vector<size_t>* oldFromNewQueries;
+  //! The mapping of the reference indices, if any.
+  const std::vector<size_t>* oldFromNewReferences;
+};
+
+} // namespace range
+} // namespace mlpack
+
+#endif
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include "range_search_output.hpp"
 
 namespace mlpack {
 namespace range {
@@ -21,10 +22,18 @@ namespace range {
  * The RangeSearchRules class is a template helper class used by RangeSearch
  * class when performing range searches.
  *
+ * What happens with each result is decided by the OutputType policy: by
+ * default the results are stored in vectors, but they may also only be counted
+ * (RangeSearchCounter) or be handed to a callback (RangeSearchCallback).  See
+ * range_search_output.hpp for the requirements of an output policy.
+ *
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ * @tparam OutputType The output policy to use.
  */
-template<typename MetricType, typename TreeType>
+template<typename MetricType,
+         typename TreeType,
+         typename OutputType = RangeSearchResults>
 class RangeSearchRules
 {
  public:
@@ -41,14 +50,33 @@ class RangeSearchRules
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
                    const math::Range& range,
                    std::vector<std::vector<size_t> >& neighbors,
                    std::vector<std::vector<double> >& distances,
                    MetricType& metric,
                    const bool sameSet = false);
 
+  /**
+   * Construct the RangeSearchRules object with the given output object, which
+   * receives the results.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param range Range to search for.
+   * @param output Output object to give the results to; it is copied.
+   * @param metric Instantiated metric.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   */
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
+                   const math::Range& range,
+                   const OutputType& output,
+                   MetricType& metric,
+                   const bool sameSet = false);
+
   /**
    * Compute the base case between the given query point and reference point.
    *
@@ -119,19 +147,16 @@ class RangeSearchRules
 
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const typename TreeType::Mat& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const typename TreeType::Mat& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
 
-  //! The vector the resultant neighbor indices should be stored in.
-  std::vector<std::vector<size_t> >& neighbors;
-
-  //! The vector the resultant neighbor distances should be stored in.
-  std::vector<std::vector<double> >& distances;
+  //! The object the results are given to.
+  OutputType output;
 
   //! The instantiated metric.
   MetricType& metric;
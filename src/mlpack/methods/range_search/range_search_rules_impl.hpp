@@ -18,10 +18,10 @@
 namespace mlpack {
 namespace range {
 
-template<typename MetricType, typename TreeType>
-RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+template<typename MetricType, typename TreeType, typename OutputType>
+RangeSearchRules<MetricType, TreeType, OutputType>::RangeSearchRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances,
@@ -30,8 +30,29 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
     referenceSet(referenceSet),
     querySet(querySet),
     range(range),
-    neighbors(neighbors),
-    distances(distances),
+    output(neighbors, distances),
+    metric(metric),
+    sameSet(sameSet),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename TreeType, typename OutputType>
+RangeSearchRules<MetricType, TreeType, OutputType>::RangeSearchRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    const math::Range& range,
+    const OutputType& output,
+    MetricType& metric,
+    const bool sameSet) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    range(range),
+    output(output),
     metric(metric),
     sameSet(sameSet),
     lastQueryIndex(querySet.n_cols),
@@ -44,9 +65,9 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
 
 //! The base case.  Evaluate the distance between the two points and add to the
 //! results if necessary.
-template<typename MetricType, typename TreeType>
+template<typename MetricType, typename TreeType, typename OutputType>
 inline force_inline
-double RangeSearchRules<MetricType, TreeType>::BaseCase(
+double RangeSearchRules<MetricType, TreeType, OutputType>::BaseCase(
     const size_t queryIndex,
     const size_t referenceIndex)
 {
@@ -67,18 +88,16 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   lastReferenceIndex = referenceIndex;
 
   if (range.Contains(distance))
-  {
-    neighbors[queryIndex].push_back(referenceIndex);
-    distances[queryIndex].push_back(distance);
-  }
+    output.Add(queryIndex, referenceIndex, distance);
 
   return distance;
 }
 
 //! Single-tree scoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
-                                                     TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename OutputType>
+double RangeSearchRules<MetricType, TreeType, OutputType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
 {
   // We must get the minimum and maximum distances and store them in this
   // object.
@@ -136,8 +155,8 @@ double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
 }
 
 //! Single-tree rescoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Rescore(
+template<typename MetricType, typename TreeType, typename OutputType>
+double RangeSearchRules<MetricType, TreeType, OutputType>::Rescore(
     const size_t /* queryIndex */,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -147,9 +166,10 @@ double RangeSearchRules<MetricType, TreeType>::Rescore(
 }
 
 //! Dual-tree scoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Score(TreeType& queryNode,
-                                                     TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename OutputType>
+double RangeSearchRules<MetricType, TreeType, OutputType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
 {
   math::Range distances;
   if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
@@ -209,8 +229,8 @@ double RangeSearchRules<MetricType, TreeType>::Score(TreeType& queryNode,
 }
 
 //! Dual-tree rescoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Rescore(
+template<typename MetricType, typename TreeType, typename OutputType>
+double RangeSearchRules<MetricType, TreeType, OutputType>::Rescore(
     TreeType& /* queryNode */,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -221,9 +241,10 @@ double RangeSearchRules<MetricType, TreeType>::Rescore(
 
 //! Add all the points in the given node to the results for the given query
 //! point.
-template<typename MetricType, typename TreeType>
-void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
-                                                       TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename OutputType>
+void RangeSearchRules<MetricType, TreeType, OutputType>::AddResult(
+    const size_t queryIndex,
+    TreeType& referenceNode)
 {
   // Some types of trees calculate the base case evaluation before Score() is
   // called, so if the base case has already been calculated, then we must avoid
@@ -236,14 +257,10 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
     baseCaseMod = 1;
   }
 
-  // Resize distances and neighbors vectors appropriately.  We have to use
-  // reserve() and not resize(), because we don't know if we will encounter the
-  // case where the datasets and points are the same (and we skip in that case).
-  const size_t oldSize = neighbors[queryIndex].size();
-  neighbors[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
-  distances[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
+  // Reserve space for the results.  We can only give an upper bound, because we
+  // don't know if we will encounter the case where the datasets and points are
+  // the same (and we skip in that case).
+  output.Reserve(queryIndex, referenceNode.NumDescendants() - baseCaseMod);
 
   for (size_t i = baseCaseMod; i < referenceNode.NumDescendants(); ++i)
   {
@@ -251,11 +268,13 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
         (queryIndex == referenceNode.Descendant(i)))
       continue;
 
-    const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
-        referenceNode.Dataset().unsafe_col(referenceNode.Descendant(i)));
+    // All of these points are in the range, so their distances are only
+    // computed if the output needs them.
+    const double distance = OutputType::NeedsDistances ?
+        metric.Evaluate(querySet.unsafe_col(queryIndex),
+        referenceNode.Dataset().unsafe_col(referenceNode.Descendant(i))) : 0.0;
 
-    neighbors[queryIndex].push_back(referenceNode.Descendant(i));
-    distances[queryIndex].push_back(distance);
+    output.Add(queryIndex, referenceNode.Descendant(i), distance);
   }
 }
 
@@ -30,8 +30,9 @@ namespace range {
  */
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-using RSType = RangeSearch<metric::EuclideanDistance, arma::mat, TreeType>;
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
+using RSType = RangeSearch<metric::EuclideanDistance, MatType, TreeType>;
 
 struct RSModelName
 {
@@ -72,12 +73,15 @@ class MonoSearchVisitor : public  boost::static_visitor<void>
  * We use template specialization to differentiate those tree types that
  * accept leafSize as a parameter. In these cases, before doing range search,
  * a query tree with proper leafSize is built from the querySet.
+ *
+ * @tparam MatType Type of the query set (and of the reference set).
  */
+template<typename MatType = arma::mat>
 class BiSearchVisitor : public boost::static_visitor<void>
 {
  private:
   //! The query set for the bichromatic search.
-  const arma::mat& querySet;
+  const MatType& querySet;
   //! Range to search neighbours for.
   const math::Range& range;
   //! The result vector for neighbors.
@@ -96,7 +100,7 @@ class BiSearchVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using RSTypeT = RSType<TreeType>;
+  using RSTypeT = RSType<TreeType, MatType>;
 
   //! Default Bichromatic range search on the given RSType instance.
   template<template<typename TreeMetricType,
@@ -114,7 +118,7 @@ class BiSearchVisitor : public boost::static_visitor<void>
   void operator()(RSTypeT<tree::Octree>* rs) const;
 
   //! Construct the BiSearchVisitor.
-  BiSearchVisitor(const arma::mat& querySet,
+  BiSearchVisitor(const MatType& querySet,
                   const math::Range& range,
                   std::vector<std::vector<size_t>>& neighbors,
                   std::vector<std::vector<double>>& distances,
@@ -126,12 +130,15 @@ class BiSearchVisitor : public boost::static_visitor<void>
  * RSType. We use template specialization to differentiate those tree types that
  * accept leafSize as a parameter. In these cases, a reference tree with proper
  * leafSize is built from the referenceSet.
+ *
+ * @tparam MatType Type of the reference set.
  */
+template<typename MatType = arma::mat>
 class TrainVisitor : public boost::static_visitor<void>
 {
  private:
   //! The reference set to use for training.
-  arma::mat&& referenceSet;
+  MatType&& referenceSet;
   //! The leaf size, used only by BinarySpaceTree.
   size_t leafSize;
   //! Train on the given RsType considering the leafSize.
@@ -143,7 +150,7 @@ class TrainVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using RSTypeT = RSType<TreeType>;
+  using RSTypeT = RSType<TreeType, MatType>;
 
   //! Default Train on the given RSType instance.
   template<template<typename TreeMetricType,
@@ -161,19 +168,22 @@ class TrainVisitor : public boost::static_visitor<void>
   void operator()(RSTypeT<tree::Octree>* rs) const;
 
   //! Construct the TrainVisitor object with the given reference set, leafSize
-  TrainVisitor(arma::mat&& referenceSet,
+  TrainVisitor(MatType&& referenceSet,
                const size_t leafSize);
 };
 
 /**
  * ReferenceSetVisitor exposes the referenceSet of the given RSType.
+ *
+ * @tparam MatType Type of the reference set.
  */
-class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
+template<typename MatType = arma::mat>
+class ReferenceSetVisitor : public boost::static_visitor<const MatType&>
 {
  public:
   //! Return the reference set.
   template<typename RSType>
-  const arma::mat& operator()(RSType* rs) const;
+  const MatType& operator()(RSType* rs) const;
 };
 
 /**
@@ -235,6 +245,17 @@ class NaiveVisitor : public boost::static_visitor<bool&>
   bool& operator()(RSType* rs) const;
 };
 
+/**
+ * The RSModel class provides an easy way to serialize a range search model,
+ * abstracts away the different types of trees, and reflects the RangeSearch
+ * API.
+ *
+ * A model may also be built in single precision, with BuildModel() on an
+ * arma::fmat; its reference set and tree then take half the memory.  This is
+ * only possible with kd-trees, ball trees and octrees.  Query sets are
+ * converted to the precision of the model, and distances are always returned
+ * as doubles.
+ */
 class RSModel
 {
  public:
@@ -285,6 +306,19 @@ class RSModel
                  RSType<tree::UBTree>*,
                  RSType<tree::Octree>*> rSearch;
 
+  //! If true, the model was built in single precision and rSearchSingle is
+  //! used instead of rSearch.
+  bool singlePrecision;
+
+  /**
+   * rSearchSingle holds the instance of the RangeSearch class for models built
+   * in single precision, which are only available for kd-trees, ball trees and
+   * octrees.
+   */
+  boost::variant<RSType<tree::KDTree, arma::fmat>*,
+                 RSType<tree::BallTree, arma::fmat>*,
+                 RSType<tree::Octree, arma::fmat>*> rSearchSingle;
+
  public:
   /**
    * Initialize the RSModel with the given type and whether or not a random
@@ -331,11 +365,19 @@ class RSModel
 
   //! Serialize the range search model.
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
-  //! Expose the dataset.
+  //! Expose the dataset.  If the model is in single precision, a
+  //! std::invalid_argument is thrown; use SinglePrecisionDataset() instead.
   const arma::mat& Dataset() const;
 
+  //! Expose the dataset of a model in single precision (if the model is not in
+  //! single precision, a std::invalid_argument is thrown).
+  const arma::fmat& SinglePrecisionDataset() const;
+
+  //! Get whether the model is in single precision.
+  bool SinglePrecision() const { return singlePrecision; }
+
   //! Get whether the model is in single-tree search mode.
   bool SingleMode() const;
   //! Modify whether the model is in single-tree search mode.
@@ -376,6 +418,21 @@ class RSModel
                   const bool naive,
                   const bool singleMode);
 
+  /**
+   * Build the reference tree in single precision.  Only kd-trees, ball trees
+   * and octrees can be built in single precision; for other tree types, a
+   * std::invalid_argument is thrown.
+   *
+   * @param referenceSet Set of reference points.
+   * @param leafSize Leaf size of tree.
+   * @param naive Whether naive search should be used.
+   * @param singleMode Whether single-tree search should be used.
+   */
+  void BuildModel(arma::fmat&& referenceSet,
+                  const size_t leafSize,
+                  const bool naive,
+                  const bool singleMode);
+
   /**
    * Perform range search.  This takes possession of the query set, so the query
    * set will not be usable after the search.  For more information on the
@@ -391,6 +448,21 @@ class RSModel
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Perform range search with a query set in single precision, which is
+   * converted to double precision if the model is not in single precision.
+   * This takes possession of the query set.
+   *
+   * @param querySet Set of query points.
+   * @param range Range to search for.
+   * @param neighbors Output: neighbors falling within the desired range.
+   * @param distances Output: distances of neighbors.
+   */
+  void Search(arma::fmat&& querySet,
+              const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances);
+
   /**
    * Perform monochromatic range search, with the reference set as the query
    * set.  For more information on the output format, see
@@ -420,6 +492,10 @@ class RSModel
 } // namespace range
 } // namespace mlpack
 
+//! Set the serialization version of the RSModel class.  Models in single
+//! precision were added in version 1.
+BOOST_CLASS_VERSION(mlpack::range::RSModel, 1);
+
 // Include implementation (of Serialize() and inline functions).
 #include "rs_model_impl.hpp"
 
@@ -27,7 +27,8 @@ namespace range {
 inline RSModel::RSModel(TreeTypes treeType, bool randomBasis) :
     treeType(treeType),
     leafSize(0),
-    randomBasis(randomBasis)
+    randomBasis(randomBasis),
+    singlePrecision(false)
 {
   // Nothing to do.
 }
@@ -37,7 +38,9 @@ inline RSModel::RSModel(const RSModel& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
-    rSearch(other.rSearch)
+    rSearch(other.rSearch),
+    singlePrecision(other.singlePrecision),
+    rSearchSingle(other.rSearchSingle)
 {
   // Nothing to do.
 }
@@ -47,24 +50,30 @@ inline RSModel::RSModel(RSModel&& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
-    rSearch(other.rSearch)
+    rSearch(other.rSearch),
+    singlePrecision(other.singlePrecision),
+    rSearchSingle(other.rSearchSingle)
 {
   // Reset other model.
   other.treeType = TreeTypes::KD_TREE;
   other.leafSize = 0;
   other.randomBasis = false;
   other.rSearch = decltype(other.rSearch)();
+  other.singlePrecision = false;
+  other.rSearchSingle = decltype(other.rSearchSingle)();
 }
 
 // Copy operator.
 inline RSModel& RSModel::operator=(const RSModel& other)
 {
-  boost::apply_visitor(DeleteVisitor(), rSearch);
+  CleanMemory();
 
   treeType = other.treeType;
   leafSize = other.leafSize;
   randomBasis = other.randomBasis;
   rSearch = other.rSearch;
+  singlePrecision = other.singlePrecision;
+  rSearchSingle = other.rSearchSingle;
 
   return *this;
 }
@@ -72,18 +81,22 @@ inline RSModel& RSModel::operator=(const RSModel& other)
 // Move operator.
 inline RSModel& RSModel::operator=(RSModel&& other)
 {
-  boost::apply_visitor(DeleteVisitor(), rSearch);
+  CleanMemory();
 
   treeType = other.treeType;
   leafSize = other.leafSize;
   randomBasis = other.randomBasis;
   rSearch = other.rSearch;
+  singlePrecision = other.singlePrecision;
+  rSearchSingle = other.rSearchSingle;
 
   // Reset other model.
   other.treeType = TreeTypes::KD_TREE;
   other.leafSize = 0;
   other.randomBasis = false;
   other.rSearch = decltype(other.rSearch)();
+  other.singlePrecision = false;
+  other.rSearchSingle = decltype(other.rSearchSingle)();
 
   return *this;
 }
@@ -91,7 +104,7 @@ inline RSModel& RSModel::operator=(RSModel&& other)
 // Clean memory, if necessary.
 inline RSModel::~RSModel()
 {
-  boost::apply_visitor(DeleteVisitor(), rSearch);
+  CleanMemory();
 }
 
 inline void RSModel::BuildModel(arma::mat&& referenceSet,
@@ -109,7 +122,8 @@ inline void RSModel::BuildModel(arma::mat&& referenceSet,
   this->leafSize = leafSize;
 
   // Clean memory, if necessary.
-  boost::apply_visitor(DeleteVisitor(), rSearch);
+  CleanMemory();
+  singlePrecision = false;
 
   // Do we need to modify the reference set?
   if (randomBasis)
@@ -180,7 +194,7 @@ inline void RSModel::BuildModel(arma::mat&& referenceSet,
       break;
   }
 
-  TrainVisitor tn(std::move(referenceSet), leafSize);
+  TrainVisitor<> tn(std::move(referenceSet), leafSize);
   boost::apply_visitor(tn, rSearch);
 
   if (!naive)
@@ -190,12 +204,71 @@ inline void RSModel::BuildModel(arma::mat&& referenceSet,
   }
 }
 
+// Build the reference tree in single precision.
+inline void RSModel::BuildModel(arma::fmat&& referenceSet,
+                                const size_t leafSize,
+                                const bool naive,
+                                const bool singleMode)
+{
+  if (treeType != KD_TREE && treeType != BALL_TREE && treeType != OCTREE)
+    throw std::invalid_argument("RSModel::BuildModel(): only kd-tree, ball "
+        "tree and octree models can be built in single precision");
+
+  // Initialize random basis if necessary.
+  if (randomBasis)
+  {
+    Log::Info << "Creating random basis..." << std::endl;
+    math::RandomBasis(q, referenceSet.n_rows);
+  }
+
+  this->leafSize = leafSize;
+
+  // Clean memory, if necessary.
+  CleanMemory();
+  singlePrecision = true;
+
+  // Do we need to modify the reference set?
+  if (randomBasis)
+    referenceSet = arma::conv_to<arma::fmat>::from(q) * referenceSet;
+
+  if (!naive)
+  {
+    Timer::Start("tree_building");
+    Log::Info << "Building single-precision reference tree..." << std::endl;
+  }
+
+  if (treeType == KD_TREE)
+    rSearchSingle = new RSType<tree::KDTree, arma::fmat>(naive, singleMode);
+  else if (treeType == BALL_TREE)
+    rSearchSingle = new RSType<tree::BallTree, arma::fmat>(naive, singleMode);
+  else
+    rSearchSingle = new RSType<tree::Octree, arma::fmat>(naive, singleMode);
+
+  TrainVisitor<arma::fmat> tn(std::move(referenceSet), leafSize);
+  boost::apply_visitor(tn, rSearchSingle);
+
+  if (!naive)
+  {
+    Timer::Stop("tree_building");
+    Log::Info << "Tree built." << std::endl;
+  }
+}
+
 // Perform range search.
 inline void RSModel::Search(arma::mat&& querySet,
                             const math::Range& range,
                             std::vector<std::vector<size_t>>& neighbors,
                             std::vector<std::vector<double>>& distances)
 {
+  if (singlePrecision)
+  {
+    // Convert the query set to the precision of the model.
+    arma::fmat singleQuerySet = arma::conv_to<arma::fmat>::from(querySet);
+    querySet.reset();
+    Search(std::move(singleQuerySet), range, neighbors, distances);
+    return;
+  }
+
   // We may need to map the query set randomly.
   if (randomBasis)
     querySet = q * querySet;
@@ -210,11 +283,44 @@ inline void RSModel::Search(arma::mat&& querySet,
     Log::Info << "brute-force (naive) search..." << std::endl;
 
 
-  BiSearchVisitor search(querySet, range, neighbors, distances,
+  BiSearchVisitor<> search(querySet, range, neighbors, distances,
       leafSize);
   boost::apply_visitor(search, rSearch);
 }
 
+// Perform range search in single precision.
+inline void RSModel::Search(arma::fmat&& querySet,
+                            const math::Range& range,
+                            std::vector<std::vector<size_t>>& neighbors,
+                            std::vector<std::vector<double>>& distances)
+{
+  if (!singlePrecision)
+  {
+    // Convert the query set to the precision of the model.
+    arma::mat doubleQuerySet = arma::conv_to<arma::mat>::from(querySet);
+    querySet.reset();
+    Search(std::move(doubleQuerySet), range, neighbors, distances);
+    return;
+  }
+
+  // We may need to map the query set randomly.
+  if (randomBasis)
+    querySet = arma::conv_to<arma::fmat>::from(q) * querySet;
+
+  Log::Info << "Search for points in the range [" << range.Lo() << ", "
+      << range.Hi() << "] with ";
+  if (!Naive() && !SingleMode())
+    Log::Info << "dual-tree " << TreeName() << " search..." << std::endl;
+  else if (!Naive())
+    Log::Info << "single-tree " << TreeName() << " search..." << std::endl;
+  else
+    Log::Info << "brute-force (naive) search..." << std::endl;
+
+  BiSearchVisitor<arma::fmat> search(querySet, range, neighbors, distances,
+      leafSize);
+  boost::apply_visitor(search, rSearchSingle);
+}
+
 // Perform range search (monochromatic case).
 inline void RSModel::Search(const math::Range& range,
                             std::vector<std::vector<size_t>>& neighbors,
@@ -230,7 +336,10 @@ inline void RSModel::Search(const math::Range& range,
     Log::Info << "brute-force (naive) search..." << std::endl;
 
   MonoSearchVisitor search(range, neighbors, distances);
-  boost::apply_visitor(search, rSearch);
+  if (singlePrecision)
+    boost::apply_visitor(search, rSearchSingle);
+  else
+    boost::apply_visitor(search, rSearch);
 }
 
 // Get the name of the tree type.
@@ -275,6 +384,9 @@ inline std::string RSModel::TreeName() const
 inline void RSModel::CleanMemory()
 {
   boost::apply_visitor(DeleteVisitor(), rSearch);
+  boost::apply_visitor(DeleteVisitor(), rSearchSingle);
+  rSearch = decltype(rSearch)();
+  rSearchSingle = decltype(rSearchSingle)();
 }
 
 //! Monochromatic range search on the given RSType instance.
@@ -287,11 +399,13 @@ void MonoSearchVisitor::operator()(RSType* rs) const
 }
 
 //! Save parameters for bichromatic range search.
-BiSearchVisitor::BiSearchVisitor(const arma::mat& querySet,
-                                 const math::Range& range,
-                                 std::vector<std::vector<size_t>>& neighbors,
-                                 std::vector<std::vector<double>>& distances,
-                                 const size_t leafSize):
+template<typename MatType>
+BiSearchVisitor<MatType>::BiSearchVisitor(
+    const MatType& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances,
+    const size_t leafSize):
     querySet(querySet),
     range(range),
     neighbors(neighbors),
@@ -300,10 +414,11 @@ BiSearchVisitor::BiSearchVisitor(const arma::mat& querySet,
 {}
 
 //! Default Bichromatic range search on the given RSType instance.
+template<typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void BiSearchVisitor::operator()(RSTypeT<TreeType>* rs) const
+void BiSearchVisitor<MatType>::operator()(RSTypeT<TreeType>* rs) const
 {
   if (rs)
     return rs->Search(querySet, range, neighbors, distances);
@@ -311,7 +426,8 @@ void BiSearchVisitor::operator()(RSTypeT<TreeType>* rs) const
 }
 
 //! Bichromatic range search on the given RSType specialized for KDTrees.
-void BiSearchVisitor::operator()(RSTypeT<tree::KDTree>* rs) const
+template<typename MatType>
+void BiSearchVisitor<MatType>::operator()(RSTypeT<tree::KDTree>* rs) const
 {
   if (rs)
     return SearchLeaf(rs);
@@ -319,7 +435,8 @@ void BiSearchVisitor::operator()(RSTypeT<tree::KDTree>* rs) const
 }
 
 //! Bichromatic range search on the given RSType specialized for BallTrees.
-void BiSearchVisitor::operator()(RSTypeT<tree::BallTree>* rs) const
+template<typename MatType>
+void BiSearchVisitor<MatType>::operator()(RSTypeT<tree::BallTree>* rs) const
 {
   if (rs)
     return SearchLeaf(rs);
@@ -327,7 +444,8 @@ void BiSearchVisitor::operator()(RSTypeT<tree::BallTree>* rs) const
 }
 
 //! Bichromatic range search specialized for Ocrees.
-void BiSearchVisitor::operator()(RSTypeT<tree::Octree>* rs) const
+template<typename MatType>
+void BiSearchVisitor<MatType>::operator()(RSTypeT<tree::Octree>* rs) const
 {
   if (rs)
     return SearchLeaf(rs);
@@ -335,8 +453,9 @@ void BiSearchVisitor::operator()(RSTypeT<tree::Octree>* rs) const
 }
 
 //! Bichromatic range search on the given RSType considering the leafSize.
+template<typename MatType>
 template<typename RSType>
-void BiSearchVisitor::SearchLeaf(RSType* rs) const
+void BiSearchVisitor<MatType>::SearchLeaf(RSType* rs) const
 {
   if (!rs->Naive() && !rs->SingleMode())
   {
@@ -367,17 +486,19 @@ void BiSearchVisitor::SearchLeaf(RSType* rs) const
 }
 
 //! Save parameters for Train.
-TrainVisitor::TrainVisitor(arma::mat&& referenceSet,
-                           const size_t leafSize) :
+template<typename MatType>
+TrainVisitor<MatType>::TrainVisitor(MatType&& referenceSet,
+                                    const size_t leafSize) :
     referenceSet(std::move(referenceSet)),
     leafSize(leafSize)
 {}
 
 //! Default Train on the given RSType instance.
+template<typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void TrainVisitor::operator()(RSTypeT<TreeType>* rs) const
+void TrainVisitor<MatType>::operator()(RSTypeT<TreeType>* rs) const
 {
   if (rs)
     return rs->Train(std::move(referenceSet));
@@ -385,7 +506,8 @@ void TrainVisitor::operator()(RSTypeT<TreeType>* rs) const
 }
 
 //! Train on the given RSType specialized for KDTrees.
-void TrainVisitor::operator()(RSTypeT<tree::KDTree>* rs) const
+template<typename MatType>
+void TrainVisitor<MatType>::operator()(RSTypeT<tree::KDTree>* rs) const
 {
   if (rs)
     return TrainLeaf(rs);
@@ -393,7 +515,8 @@ void TrainVisitor::operator()(RSTypeT<tree::KDTree>* rs) const
 }
 
 //! Train on the given RSType specialized for BallTrees.
-void TrainVisitor::operator()(RSTypeT<tree::BallTree>* rs) const
+template<typename MatType>
+void TrainVisitor<MatType>::operator()(RSTypeT<tree::BallTree>* rs) const
 {
   if (rs)
     return TrainLeaf(rs);
@@ -401,7 +524,8 @@ void TrainVisitor::operator()(RSTypeT<tree::BallTree>* rs) const
 }
 
 //! Train specialized for Octrees.
-void TrainVisitor::operator()(RSTypeT<tree::Octree>* rs) const
+template<typename MatType>
+void TrainVisitor<MatType>::operator()(RSTypeT<tree::Octree>* rs) const
 {
   if (rs)
     return TrainLeaf(rs);
@@ -409,8 +533,9 @@ void TrainVisitor::operator()(RSTypeT<tree::Octree>* rs) const
 }
 
 //! Train on the given RSType considering the leafSize.
+template<typename MatType>
 template<typename RSType>
-void TrainVisitor::TrainLeaf(RSType* rs) const
+void TrainVisitor<MatType>::TrainLeaf(RSType* rs) const
 {
   if (rs->Naive())
     rs->Train(std::move(referenceSet));
@@ -429,8 +554,9 @@ void TrainVisitor::TrainLeaf(RSType* rs) const
 }
 
 //! Expose the referenceSet of the given RSType.
+template<typename MatType>
 template<typename RSType>
-const arma::mat& ReferenceSetVisitor::operator()(RSType* rs) const
+const MatType& ReferenceSetVisitor<MatType>::operator()(RSType* rs) const
 {
   if (rs)
     return rs->ReferenceSet();
@@ -481,7 +607,7 @@ bool& NaiveVisitor::operator()(RSType* rs) const
 
 // Serialize the model.
 template<typename Archive>
-void RSModel::Serialize(Archive& ar, const unsigned int /* version */)
+void RSModel::Serialize(Archive& ar, const unsigned int version)
 {
   using data::CreateNVP;
 
@@ -491,36 +617,69 @@ void RSModel::Serialize(Archive& ar, const unsigned int /* version */)
 
   // This should never happen, but just in case...
   if (Archive::is_loading::value)
-    boost::apply_visitor(DeleteVisitor(), rSearch);
+    CleanMemory();
+
+  // Models in single precision were added in version 1.
+  if (version > 0)
+    ar & CreateNVP(singlePrecision, "singlePrecision");
+  else if (Archive::is_loading::value)
+    singlePrecision = false;
 
   // We'll only need to serialize one of the model objects, based on the type.
   const std::string& name = RSModelName::Name();
-  SerializeVisitor<Archive> s(ar, name);
-  boost::apply_visitor(s, rSearch);
+  if (singlePrecision)
+  {
+    ar & CreateNVP(rSearchSingle, name);
+  }
+  else
+  {
+    SerializeVisitor<Archive> s(ar, name);
+    boost::apply_visitor(s, rSearch);
+  }
 }
 
 inline const arma::mat& RSModel::Dataset() const
 {
-  return boost::apply_visitor(ReferenceSetVisitor(), rSearch);
+  if (singlePrecision)
+    throw std::invalid_argument("RSModel::Dataset(): the model is in single "
+        "precision; use SinglePrecisionDataset()");
+  return boost::apply_visitor(ReferenceSetVisitor<>(), rSearch);
+}
+
+inline const arma::fmat& RSModel::SinglePrecisionDataset() const
+{
+  if (!singlePrecision)
+    throw std::invalid_argument("RSModel::SinglePrecisionDataset(): the model "
+        "is not in single precision");
+  return boost::apply_visitor(ReferenceSetVisitor<arma::fmat>(),
+      rSearchSingle);
 }
 
 inline bool RSModel::SingleMode() const
 {
+  if (singlePrecision)
+    return boost::apply_visitor(SingleModeVisitor(), rSearchSingle);
   return boost::apply_visitor(SingleModeVisitor(), rSearch);
 }
 
 inline bool& RSModel::SingleMode()
 {
+  if (singlePrecision)
+    return boost::apply_visitor(SingleModeVisitor(), rSearchSingle);
   return boost::apply_visitor(SingleModeVisitor(), rSearch);
 }
 
 inline bool RSModel::Naive() const
 {
+  if (singlePrecision)
+    return boost::apply_visitor(NaiveVisitor(), rSearchSingle);
   return boost::apply_visitor(NaiveVisitor(), rSearch);
 }
 
 inline bool& RSModel::Naive()
 {
+  if (singlePrecision)
+    return boost::apply_visitor(NaiveVisitor(), rSearchSingle);
   return boost::apply_visitor(NaiveVisitor(), rSearch);
 }
 
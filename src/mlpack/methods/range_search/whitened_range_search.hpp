@@ -0,0 +1,136 @@
+/**
+ * @file whitened_range_search.hpp
+ *
+ * Defines the WhitenedRangeSearch class, which performs range searches with
+ * the Mahalanobis distance by transforming the points once and searching them
+ * with the Euclidean distance.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANGE_SEARCH_WHITENED_RANGE_SEARCH_HPP
+#define MLPACK_METHODS_RANGE_SEARCH_WHITENED_RANGE_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/mahalanobis_distance.hpp>
+
+#include "range_search.hpp"
+
+namespace mlpack {
+namespace range {
+
+/**
+ * The WhitenedRangeSearch class performs range searches with the Mahalanobis
+ * distance.  As with neighbor::WhitenedNeighborSearch, the reference set and
+ * each query set are transformed once by the matrix given by
+ * MahalanobisDistance::Transformation(), and searched with a RangeSearch
+ * object that uses the Euclidean distance (and, by default, a kd-tree), so
+ * each distance evaluation takes O(d) time instead of O(d^2).  The ranges and
+ * the distances that are returned are those of the given Mahalanobis
+ * distance, so with TakeRoot = false they are squared distances.
+ *
+ * @tparam TakeRoot Whether the distances of the Mahalanobis distance are
+ *     rooted.
+ * @tparam TreeType The tree type to use for the transformed points.
+ */
+template<bool TakeRoot = true,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class WhitenedRangeSearch
+{
+ public:
+  //! The metric of the ranges and distances.
+  typedef metric::MahalanobisDistance<TakeRoot> MetricType;
+  //! The type of the search of the transformed points.
+  typedef RangeSearch<metric::EuclideanDistance, arma::mat, TreeType>
+      SearchType;
+
+  /**
+   * Transform the given reference set and build the search of the transformed
+   * points.  If the covariance matrix of the metric is empty, the identity
+   * matrix is used.  A std::invalid_argument is thrown if the covariance
+   * matrix does not match the dimensionality of the reference set.
+   *
+   * @param referenceSet Reference dataset.
+   * @param naive Whether the computation should be done in O(n^2) naive mode.
+   * @param singleMode Whether single-tree computation should be used (as
+   *      opposed to dual-tree computation).
+   * @param metric Mahalanobis distance to search with.
+   */
+  WhitenedRangeSearch(const arma::mat& referenceSet,
+                      const bool naive = false,
+                      const bool singleMode = false,
+                      const MetricType& metric = MetricType());
+
+  /**
+   * Search for all reference points in the given range of Mahalanobis
+   * distances of each point of the query set.  A std::invalid_argument is
+   * thrown if the dimensionality of the query set is wrong.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range The range of distances in which to search.
+   * @param neighbors Object which will hold the list of neighbors for each
+   *      point which fell into the given range, for each query point.
+   * @param distances Object which will hold the list of distances for each
+   *      point which fell into the given range, for each query point.
+   */
+  void Search(const arma::mat& querySet,
+              const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances);
+
+  /**
+   * Search for all points of the reference set in the given range of
+   * Mahalanobis distances of each point of the reference set (excluding the
+   * point itself).
+   *
+   * @param range The range of distances in which to search.
+   * @param neighbors Object which will hold the list of neighbors for each
+   *      point which fell into the given range, for each point.
+   * @param distances Object which will hold the list of distances for each
+   *      point which fell into the given range, for each point.
+   */
+  void Search(const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances);
+
+  //! Get the Mahalanobis distance.
+  const MetricType& Metric() const { return metric; }
+
+  //! Get the transformation of the points.
+  const arma::mat& Transformation() const { return transformation; }
+
+  //! Get the search of the transformed points.
+  const SearchType& WhitenedSearch() const { return search; }
+  //! Modify the search of the transformed points.
+  SearchType& WhitenedSearch() { return search; }
+
+ private:
+  //! Compute the transformation for points of the given dimensionality.
+  static arma::mat ComputeTransformation(const MetricType& metric,
+                                         const size_t dimensionality);
+
+  //! Convert the range to the Euclidean distances of the search.
+  static math::Range ConvertRange(const math::Range& range);
+
+  //! Convert the Euclidean distances of the search to the given metric.
+  static void ConvertDistances(std::vector<std::vector<double>>& distances);
+
+  //! The Mahalanobis distance.
+  MetricType metric;
+  //! The transformation of the points.
+  arma::mat transformation;
+  //! The search of the transformed points.
+  SearchType search;
+}; // class WhitenedRangeSearch
+
+} // namespace range
+} // namespace mlpack
+
+// Include implementation.
+#include "whitened_range_search_impl.hpp"
+
+#endif
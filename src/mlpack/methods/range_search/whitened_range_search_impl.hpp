@@ -0,0 +1,111 @@
+/**
+ * @file whitened_range_search_impl.hpp
+ *
+ * Implementation of the WhitenedRangeSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANGE_SEARCH_WHITENED_RANGE_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_RANGE_SEARCH_WHITENED_RANGE_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "whitened_range_search.hpp"
+
+namespace mlpack {
+namespace range {
+
+template<bool TakeRoot, template<typename, typename, typename> class TreeType>
+WhitenedRangeSearch<TakeRoot, TreeType>::WhitenedRangeSearch(
+    const arma::mat& referenceSet,
+    const bool naive,
+    const bool singleMode,
+    const MetricType& metric) :
+    metric(metric),
+    transformation(ComputeTransformation(metric, referenceSet.n_rows)),
+    search(arma::mat(transformation * referenceSet), naive, singleMode)
+{
+  // Nothing to do.
+}
+
+template<bool TakeRoot, template<typename, typename, typename> class TreeType>
+void WhitenedRangeSearch<TakeRoot, TreeType>::Search(
+    const arma::mat& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
+{
+  if (querySet.n_rows != transformation.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "WhitenedRangeSearch::Search(): the query set has dimensionality "
+        << querySet.n_rows << ", but the reference set has dimensionality "
+        << transformation.n_cols;
+    throw std::invalid_argument(oss.str());
+  }
+
+  search.Search(arma::mat(transformation * querySet), ConvertRange(range),
+      neighbors, distances);
+  ConvertDistances(distances);
+}
+
+template<bool TakeRoot, template<typename, typename, typename> class TreeType>
+void WhitenedRangeSearch<TakeRoot, TreeType>::Search(
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
+{
+  search.Search(ConvertRange(range), neighbors, distances);
+  ConvertDistances(distances);
+}
+
+template<bool TakeRoot, template<typename, typename, typename> class TreeType>
+arma::mat WhitenedRangeSearch<TakeRoot, TreeType>::ComputeTransformation(
+    const MetricType& metric,
+    const size_t dimensionality)
+{
+  if (metric.Covariance().n_elem == 0)
+    return arma::eye<arma::mat>(dimensionality, dimensionality);
+
+  if (metric.Covariance().n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "WhitenedRangeSearch::WhitenedRangeSearch(): the covariance matrix "
+        << "of the metric has " << metric.Covariance().n_rows << " rows, but "
+        << "the reference set has dimensionality " << dimensionality;
+    throw std::invalid_argument(oss.str());
+  }
+
+  return metric.Transformation();
+}
+
+template<bool TakeRoot, template<typename, typename, typename> class TreeType>
+math::Range WhitenedRangeSearch<TakeRoot, TreeType>::ConvertRange(
+    const math::Range& range)
+{
+  if (TakeRoot)
+    return range;
+
+  // Squared distances are never negative.
+  return math::Range(std::sqrt(std::max(range.Lo(), 0.0)),
+      std::sqrt(std::max(range.Hi(), 0.0)));
+}
+
+template<bool TakeRoot, template<typename, typename, typename> class TreeType>
+void WhitenedRangeSearch<TakeRoot, TreeType>::ConvertDistances(
+    std::vector<std::vector<double>>& distances)
+{
+  if (TakeRoot)
+    return;
+
+  for (size_t i = 0; i < distances.size(); ++i)
+    for (size_t j = 0; j < distances[i].size(); ++j)
+      distances[i][j] *= distances[i][j];
+}
+
+} // namespace range
+} // namespace mlpack
+
+#endif
@@ -58,6 +58,12 @@ class TrainVisitor;
  *
  * RASearch is currently known to not work with ball trees (#356).
  *
+ * Naive and single-tree search divide the query points between the threads
+ * available to OpenMP.  The samples are drawn from a random number generator
+ * that is reseeded for each query point, from a seed that each call to Search()
+ * takes from the global generator (see math::RandomSeed()).  So for a given
+ * seed, the results do not depend on the number of threads.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use.
@@ -456,6 +462,31 @@ class RASearch
   //! Instantiation of kernel.
   MetricType metric;
 
+  /**
+   * Sample each of the given query points naively, and compute the base case of
+   * each query point with each of the given extra samples, using several
+   * threads.
+   *
+   * @param rules Rules to search with.
+   * @param numQueries Number of query points.
+   * @param samples Reference points to compute the base case with for every
+   *     query point, in addition to the query point's own samples.
+   */
+  template<typename RuleType>
+  void NaiveSearch(RuleType& rules,
+                   const size_t numQueries,
+                   const arma::uvec& samples);
+
+  /**
+   * Traverse the reference tree with each of the query points, using several
+   * threads.
+   *
+   * @param rules Rules to search with.
+   * @param numQueries Number of query points.
+   */
+  template<typename RuleType>
+  void SingleTreeSearch(RuleType& rules, const size_t numQueries);
+
   //! For access to mappings when building models.
   template<typename SortPol>
   friend class TrainVisitor;
@@ -17,6 +17,10 @@
 
 #include "ra_search_rules.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace neighbor {
 
@@ -361,31 +365,34 @@ Search(const MatType& querySet,
 
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
 
+  // All samples of this search are drawn from streams derived from this seed.
+  const size_t seed = (size_t) math::randGen();
+
   if (naive)
   {
-    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
-        sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+    // The samples of each query point are taken by NaiveSearch().
+    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, false,
+        sampleAtLeaves, firstLeafExact, singleSampleLimit, false, seed);
 
     // Find how many samples from the reference set we need and sample uniformly
     // from the reference set without replacement.
     const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
         k, tau, alpha);
     arma::uvec distinctSamples;
+    std::mt19937 sampleRNG((uint32_t) seed);
     math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
+        distinctSamples, sampleRNG);
 
     // Run the base case on each combination of query point and sampled
     // reference point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < distinctSamples.n_elem; ++j)
-        rules.BaseCase(i, (size_t) distinctSamples[j]);
+    NaiveSearch(rules, querySet.n_cols, distinctSamples);
 
     rules.GetResults(*neighborPtr, *distancePtr);
   }
   else if (singleMode)
   {
     RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
-        sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+        sampleAtLeaves, firstLeafExact, singleSampleLimit, false, seed);
 
     // If the reference root node is a leaf, then the sampling has already been
     // done in the RASearchRules constructor.  This happens when naive = true.
@@ -393,12 +400,7 @@ Search(const MatType& querySet,
     {
       Log::Info << "Performing single-tree traversal..." << std::endl;
 
-      // Create the traverser.
-      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      SingleTreeSearch(rules, querySet.n_cols);
 
       Log::Info << "Single-tree traversal complete." << std::endl;
       Log::Info << "Average number of distance calculations per query point: "
@@ -421,7 +423,7 @@ Search(const MatType& querySet,
     Timer::Start("computing_neighbors");
 
     RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
-        naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+        naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false, seed);
     typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
     Log::Info << "Query statistic pre-search: "
@@ -534,7 +536,8 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   // Create the helper object for the tree traversal.
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
-      naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+      naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false,
+      (size_t) math::randGen());
 
   // Create the traverser.
   typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
@@ -589,32 +592,21 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
 
   // Create the helper object for the tree traversal.
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, k, metric, tau, alpha, naive,
-      sampleAtLeaves, firstLeafExact, singleSampleLimit, true /* same sets */);
+  // The samples of each query point are taken by NaiveSearch() in naive mode.
+  RuleType rules(*referenceSet, *referenceSet, k, metric, tau, alpha, false,
+      sampleAtLeaves, firstLeafExact, singleSampleLimit, true /* same sets */,
+      (size_t) math::randGen());
 
   if (naive)
   {
-    // Find how many samples from the reference set we need and sample uniformly
-    // from the reference set without replacement.
-    const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
-        k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
-
     // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+    const arma::uvec allPoints = arma::linspace<arma::uvec>(0,
+        referenceSet->n_cols - 1, referenceSet->n_cols);
+    NaiveSearch(rules, referenceSet->n_cols, allPoints);
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    SingleTreeSearch(rules, referenceSet->n_cols);
   }
   else
   {
@@ -651,6 +643,77 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+void RASearch<SortPolicy, MetricType, MatType, TreeType>::NaiveSearch(
+    RuleType& rules,
+    const size_t numQueries,
+    const arma::uvec& samples)
+{
+  size_t distComputations = 0;
+
+  #pragma omp parallel reduction(+:distComputations)
+  {
+    // Each thread has its own rules object, which shares its results with the
+    // original rules object.
+    RuleType workerRules(rules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+    {
+      workerRules.SampleQuery(i);
+      for (size_t j = 0; j < samples.n_elem; ++j)
+        workerRules.BaseCase(i, (size_t) samples[j]);
+    }
+
+    distComputations += workerRules.NumDistComputations();
+  }
+
+  rules.NumDistComputations() += distComputations;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+void RASearch<SortPolicy, MetricType, MatType, TreeType>::SingleTreeSearch(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  size_t distComputations = 0;
+
+  #pragma omp parallel reduction(+:distComputations)
+  {
+    // Each thread has its own rules object and traverser.  The rules only read
+    // the reference tree in single-tree search, so it can be shared.
+    RuleType workerRules(rules);
+    typename Tree::template SingleTreeTraverser<RuleType>
+        traverser(workerRules);
+
+    // The cost of a query point depends on how soon it is approximated, so the
+    // query points are handed out in small chunks.
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+    {
+      // Reseeding makes the samples independent of the order of the queries.
+      workerRules.SeedQuery(i);
+      traverser.Traverse(i, *referenceTree);
+    }
+
+    distComputations += workerRules.NumDistComputations();
+  }
+
+  rules.NumDistComputations() += distComputations;
+}
+
 template<typename SortPolicy,
          typename MetricType,
          typename MatType,
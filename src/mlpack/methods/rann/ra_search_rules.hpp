@@ -17,6 +17,7 @@
 #include <mlpack/core/tree/traversal_info.hpp>
 
 #include <queue>
+#include <random>
 
 namespace mlpack {
 namespace neighbor {
@@ -53,6 +54,9 @@ class RASearchRules
    *     approximated by sampling.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param seed Seed for the samples.  The samples of each query point are
+   *      drawn from a generator seeded with this seed and the index of the
+   *      query point (see SeedQuery()).
    */
   RASearchRules(const arma::mat& referenceSet,
                 const arma::mat& querySet,
@@ -64,7 +68,39 @@ class RASearchRules
                 const bool sampleAtLeaves = false,
                 const bool firstLeafExact = false,
                 const size_t singleSampleLimit = 20,
-                const bool sameSet = false);
+                const bool sameSet = false,
+                const size_t seed = 0);
+
+  /**
+   * Construct a rules object for another thread.  It shares the candidate
+   * lists and the sample counts of the given rules object, so results found
+   * through either of them end up in the same place; the number of distance
+   * computations and the traversal information are its own.  Different copies
+   * must only be used for different query points at the same time.
+   *
+   * @param other Rules object to share the results of.
+   */
+  RASearchRules(const RASearchRules& other);
+
+  /**
+   * Reseed the random number generator for the given query point.  After this,
+   * the samples taken for the query point depend only on the seed and the
+   * query index, and not on which query points were searched before it (or on
+   * which thread).  This is meant for single-tree and naive search, where the
+   * query points are searched one at a time.
+   *
+   * @param queryIndex Index of query point.
+   */
+  void SeedQuery(const size_t queryIndex);
+
+  /**
+   * Reseed the generator for the given query point, then run the base case on
+   * enough uniformly sampled reference points to satisfy the rank guarantee.
+   * This is what naive search does for each query point.
+   *
+   * @param queryIndex Index of query point.
+   */
+  void SampleQuery(const size_t queryIndex);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -227,7 +263,11 @@ class RASearchRules
                  const double oldScore);
 
 
-  size_t NumDistComputations() { return numDistComputations; }
+  //! Get the number of distance computations performed by this object.
+  size_t NumDistComputations() const { return numDistComputations; }
+  //! Modify the number of distance computations performed by this object.
+  size_t& NumDistComputations() { return numDistComputations; }
+
   size_t NumEffectiveSamples()
   {
     if (numSamplesMade.n_elem == 0)
@@ -263,8 +303,12 @@ class RASearchRules
   typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
       CandidateList;
 
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! The candidate lists, if this object owns them.
+  std::vector<CandidateList> candidateStorage;
+
+  //! Set of candidate neighbors for each point; these may be shared with the
+  //! rules object this one was copied from.
+  std::vector<CandidateList>& candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -284,8 +328,12 @@ class RASearchRules
   //! The minimum number of samples required per query.
   size_t numSamplesReqd;
 
-  //! The number of samples made for every query.
-  arma::Col<size_t> numSamplesMade;
+  //! The sample counts, if this object owns them.
+  arma::Col<size_t> numSamplesMadeStorage;
+
+  //! The number of samples made for every query; this may be shared with the
+  //! rules object this one was copied from.
+  arma::Col<size_t>& numSamplesMade;
 
   //! The sampling ratio.
   double samplingRatio;
@@ -296,6 +344,12 @@ class RASearchRules
   //! If the query and reference set are identical, this is true.
   bool sameSet;
 
+  //! The seed the samples are drawn with.
+  size_t seed;
+
+  //! The random number generator the samples are drawn from.
+  std::mt19937 rng;
+
   TraversalInfoType traversalInfo;
 
   /**
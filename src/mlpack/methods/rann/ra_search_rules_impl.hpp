@@ -30,15 +30,20 @@ RASearchRules(const arma::mat& referenceSet,
               const bool sampleAtLeaves,
               const bool firstLeafExact,
               const size_t singleSampleLimit,
-              const bool sameSet) :
+              const bool sameSet,
+              const size_t seed) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(candidateStorage),
     k(k),
     metric(metric),
     sampleAtLeaves(sampleAtLeaves),
     firstLeafExact(firstLeafExact),
     singleSampleLimit(singleSampleLimit),
-    sameSet(sameSet)
+    numSamplesMade(numSamplesMadeStorage),
+    sameSet(sameSet),
+    seed(seed),
+    rng((uint32_t) seed)
 {
   // Validate tau to make sure that the rank approximation is greater than the
   // number of neighbors requested.
@@ -86,17 +91,55 @@ RASearchRules(const arma::mat& referenceSet,
 
   if (naive) // No tree traversal; just do naive sampling here.
   {
-    // Sample enough points.
-    arma::uvec distinctSamples;
     for (size_t i = 0; i < querySet.n_cols; ++i)
-    {
-      math::ObtainDistinctSamples(0, n, numSamplesReqd, distinctSamples);
-      for (size_t j = 0; j < distinctSamples.n_elem; j++)
-        BaseCase(i, (size_t) distinctSamples[j]);
-    }
+      SampleQuery(i);
   }
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+RASearchRules<SortPolicy, MetricType, TreeType>::RASearchRules(
+    const RASearchRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    metric(other.metric),
+    sampleAtLeaves(other.sampleAtLeaves),
+    firstLeafExact(other.firstLeafExact),
+    singleSampleLimit(other.singleSampleLimit),
+    numSamplesReqd(other.numSamplesReqd),
+    numSamplesMade(other.numSamplesMade),
+    samplingRatio(other.samplingRatio),
+    numDistComputations(0),
+    sameSet(other.sameSet),
+    seed(other.seed),
+    rng(other.rng)
+{ /* Nothing to do. */ }
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void RASearchRules<SortPolicy, MetricType, TreeType>::SeedQuery(
+    const size_t queryIndex)
+{
+  // Consecutive seeds give well-separated streams once they are mixed through
+  // a seed sequence.
+  std::seed_seq seq { (uint32_t) seed, (uint32_t) (seed >> 16 >> 16),
+      (uint32_t) queryIndex, (uint32_t) (queryIndex >> 16 >> 16) };
+  rng.seed(seq);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void RASearchRules<SortPolicy, MetricType, TreeType>::SampleQuery(
+    const size_t queryIndex)
+{
+  SeedQuery(queryIndex);
+
+  arma::uvec distinctSamples;
+  math::ObtainDistinctSamples(0, referenceSet.n_cols, numSamplesReqd,
+      distinctSamples, rng);
+  for (size_t j = 0; j < distinctSamples.n_elem; j++)
+    BaseCase(queryIndex, (size_t) distinctSamples[j]);
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 void RASearchRules<SortPolicy, MetricType, TreeType>::GetResults(
     arma::Mat<size_t>& neighbors,
@@ -205,7 +248,7 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           // Hence, approximate the node by sampling enough number of points.
           arma::uvec distinctSamples;
           math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
+              samplesReqd, distinctSamples, rng);
           for (size_t i = 0; i < distinctSamples.n_elem; i++)
             // The counting of the samples are done in the 'BaseCase' function
             // so no book-keeping is required here.
@@ -221,7 +264,7 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
             // Approximate node by sampling enough number of points.
             arma::uvec distinctSamples;
             math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
+                samplesReqd, distinctSamples, rng);
             for (size_t i = 0; i < distinctSamples.n_elem; i++)
               // The counting of the samples are done in the 'BaseCase' function
               // so no book-keeping is required here.
@@ -309,7 +352,7 @@ Rescore(const size_t queryIndex,
         // by sampling enough number of points.
         arma::uvec distinctSamples;
         math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-            samplesReqd, distinctSamples);
+            samplesReqd, distinctSamples, rng);
         for (size_t i = 0; i < distinctSamples.n_elem; i++)
           // The counting of the samples are done in the 'BaseCase' function so
           // no book-keeping is required here.
@@ -325,7 +368,7 @@ Rescore(const size_t queryIndex,
           // Approximate node by sampling enough points.
           arma::uvec distinctSamples;
           math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
+              samplesReqd, distinctSamples, rng);
           for (size_t i = 0; i < distinctSamples.n_elem; i++)
             // The counting of the samples are done in the 'BaseCase' function
             // so no book-keeping is required here.
@@ -512,7 +555,7 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           {
             const size_t queryIndex = queryNode.Descendant(i);
             math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
+                samplesReqd, distinctSamples, rng);
             for (size_t j = 0; j < distinctSamples.n_elem; j++)
               // The counting of the samples are done in the 'BaseCase' function
               // so no book-keeping is required here.
@@ -542,7 +585,7 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
             {
               const size_t queryIndex = queryNode.Descendant(i);
               math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                  samplesReqd, distinctSamples);
+                  samplesReqd, distinctSamples, rng);
               for (size_t j = 0; j < distinctSamples.n_elem; j++)
                 // The counting of the samples are done in the 'BaseCase'
                 // function so no book-keeping is required here.
@@ -717,7 +760,7 @@ Rescore(TreeType& queryNode,
         {
           const size_t queryIndex = queryNode.Descendant(i);
           math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
+              samplesReqd, distinctSamples, rng);
           for (size_t j = 0; j < distinctSamples.n_elem; j++)
             // The counting of the samples are done in the 'BaseCase'
             // function so no book-keeping is required here.
@@ -746,7 +789,7 @@ Rescore(TreeType& queryNode,
           {
             const size_t queryIndex = queryNode.Descendant(i);
             math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
+                samplesReqd, distinctSamples, rng);
             for (size_t j = 0; j < distinctSamples.n_elem; j++)
               // The counting of the samples are done in BaseCase() so no
               // book-keeping is required here.
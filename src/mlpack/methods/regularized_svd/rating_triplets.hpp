@@ -0,0 +1,114 @@
+/**
+ * @file rating_triplets.hpp
+ *
+ * Definition of the RatingTriplets class, a compact list of (user, item,
+ * rating) triplets.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_REGULARIZED_SVD_RATING_TRIPLETS_HPP
+#define MLPACK_METHODS_REGULARIZED_SVD_RATING_TRIPLETS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace svd {
+
+/**
+ * A list of ratings stored as three separate arrays: 32-bit user and item
+ * indices and single-precision ratings.  Each rating takes 12 bytes, instead
+ * of the 24 bytes of a column of a coordinate list in an arma::mat, and the
+ * indices do not have to be converted from doubles when they are used.
+ *
+ * @code
+ * arma::mat data; // Coordinate list: (user, item, rating) in each column.
+ * RatingTriplets triplets(data);
+ * for (size_t i = 0; i < triplets.NumRatings(); ++i)
+ *   std::cout << triplets.User(i) << " rated " << triplets.Item(i) << ": "
+ *       << triplets.Rating(i) << std::endl;
+ * @endcode
+ */
+class RatingTriplets
+{
+ public:
+  //! Create an empty list of ratings.
+  RatingTriplets() : numUsers(0), numItems(0) { }
+
+  /**
+   * Create the list from the given coordinate list, which has a column for
+   * each rating with the user, the item and the rating.  A
+   * std::invalid_argument is thrown if the coordinate list does not have
+   * three rows, or if a user or item index does not fit in 32 bits.
+   *
+   * @param data Coordinate list of the ratings.
+   */
+  template<typename MatType>
+  RatingTriplets(const MatType& data) : numUsers(0), numItems(0)
+  {
+    if (data.n_cols > 0 && data.n_rows != 3)
+    {
+      std::ostringstream oss;
+      oss << "RatingTriplets::RatingTriplets(): the coordinate list must have "
+          << "3 rows, but it has " << data.n_rows;
+      throw std::invalid_argument(oss.str());
+    }
+
+    users.resize(data.n_cols);
+    items.resize(data.n_cols);
+    ratings.resize(data.n_cols);
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      const double user = data(0, i);
+      const double item = data(1, i);
+      if (user < 0 || user > std::numeric_limits<uint32_t>::max() ||
+          item < 0 || item > std::numeric_limits<uint32_t>::max())
+      {
+        std::ostringstream oss;
+        oss << "RatingTriplets::RatingTriplets(): rating " << i << " has user "
+            << user << " and item " << item << "; indices must be between 0 "
+            << "and " << std::numeric_limits<uint32_t>::max();
+        throw std::invalid_argument(oss.str());
+      }
+
+      users[i] = (uint32_t) user;
+      items[i] = (uint32_t) item;
+      ratings[i] = (float) data(2, i);
+      numUsers = std::max(numUsers, (size_t) users[i] + 1);
+      numItems = std::max(numItems, (size_t) items[i] + 1);
+    }
+  }
+
+  //! Get the number of ratings.
+  size_t NumRatings() const { return ratings.size(); }
+  //! Get the number of users (the largest user index plus one).
+  size_t NumUsers() const { return numUsers; }
+  //! Get the number of items (the largest item index plus one).
+  size_t NumItems() const { return numItems; }
+
+  //! Get the user of the i'th rating.
+  size_t User(const size_t i) const { return users[i]; }
+  //! Get the item of the i'th rating.
+  size_t Item(const size_t i) const { return items[i]; }
+  //! Get the value of the i'th rating.
+  double Rating(const size_t i) const { return ratings[i]; }
+
+ private:
+  //! The user of each rating.
+  std::vector<uint32_t> users;
+  //! The item of each rating.
+  std::vector<uint32_t> items;
+  //! The value of each rating.
+  std::vector<float> ratings;
+  //! The number of users.
+  size_t numUsers;
+  //! The number of items.
+  size_t numItems;
+};
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
@@ -18,12 +18,17 @@
 #include <mlpack/core/optimizers/parallel_sgd/parallel_sgd.hpp>
 #include <mlpack/core/optimizers/parallel_sgd/decay_policies/exponential_backoff.hpp>
 
+#include "rating_triplets.hpp"
+
 namespace mlpack {
 namespace svd {
 
 /**
  * The data is stored in a matrix of type MatType, so that this class can be
- * used with both dense and sparse matrix types.
+ * used with both dense and sparse matrix types.  The functions that work on one
+ * training example at a time, which SGD-type optimizers call, read the ratings
+ * from compact RatingTriplets instead (in single precision); only the
+ * evaluation and gradient over all examples read the given matrix.
  *
  * @tparam MatType The matrix type of the dataset.
  */
@@ -53,7 +58,8 @@ class RegularizedSVDFunction
 
   /**
    * Evaluates the cost function for one training example. Useful for the SGD
-   * optimizer abstraction which uses one training example at a time.
+   * optimizer abstraction which uses one training example at a time.  The
+   * rating is read from the triplets.
    *
    * @param parameters Parameters(user/item matrices) of the decomposition.
    * @param i Index of the training example to be used.
@@ -75,7 +81,7 @@ class RegularizedSVDFunction
    * Evaluates the gradient of the cost function over one training example.
    * This function is useful for optimizers like SGD. The type of the gradient
    * parameter is a template argument to allow the computation of a sparse
-   * gradient.
+   * gradient.  The rating is read from the triplets.
    *
    * @tparam GradType The type of the gradient out-param.
    * @param parameters Parameters(user/item matrices) of the decomposition.
@@ -91,10 +97,16 @@ class RegularizedSVDFunction
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
   //! Return the dataset passed into the constructor.
-  const arma::mat& Dataset() const { return data; }
+  const MatType& Dataset() const { return data; }
+
+  /**
+   * Return the ratings as compact triplets, which the SGD optimizers use
+   * instead of the dataset.
+   */
+  const RatingTriplets& Triplets() const { return triplets; }
 
   //! Return the number of training examples. Useful for SGD optimizer.
-  size_t NumFunctions() const { return data.n_cols; }
+  size_t NumFunctions() const { return triplets.NumRatings(); }
 
   //! Return the number of users in the data.
   size_t NumUsers() const { return numUsers; }
@@ -111,6 +123,8 @@ class RegularizedSVDFunction
  private:
   //! Rating data.
   const MatType& data;
+  //! Rating data as triplets with 32-bit indices.
+  RatingTriplets triplets;
   //! Initial parameter point.
   arma::mat initialPoint;
   //! Rank used for matrix factorization.
@@ -24,6 +24,7 @@ RegularizedSVDFunction<MatType>::RegularizedSVDFunction(const MatType& data,
                                                         const size_t rank,
                                                         const double lambda) :
     data(data),
+    triplets(data),
     rank(rank),
     lambda(lambda)
 {
@@ -77,11 +78,11 @@ double RegularizedSVDFunction<MatType>::Evaluate(const arma::mat& parameters,
                                                  const size_t i) const
 {
   // Indices for accessing the the correct parameter columns.
-  const size_t user = data(0, i);
-  const size_t item = data(1, i) + numUsers;
+  const size_t user = triplets.User(i);
+  const size_t item = triplets.Item(i) + numUsers;
 
   // Calculate the squared error in the prediction.
-  const double rating = data(2, i);
+  const double rating = triplets.Rating(i);
   double ratingError = rating - arma::dot(parameters.col(user),
                                           parameters.col(item));
   double ratingErrorSquared = ratingError * ratingError;
@@ -138,11 +139,11 @@ void RegularizedSVDFunction<MatType>::Gradient(const arma::mat& parameters,
 {
   gradient.zeros(rank, numUsers + numItems);
 
-  const size_t user = data(0, id);
-  const size_t item = data(1, id) + numUsers;
+  const size_t user = triplets.User(id);
+  const size_t item = triplets.Item(id) + numUsers;
 
   // Prediction error for the example.
-  const double rating = data(2, id);
+  const double rating = triplets.Rating(id);
   double ratingError = rating - arma::dot(parameters.col(user),
                                           parameters.col(item));
 
@@ -178,7 +179,8 @@ double StandardSGD::Optimize(
   for (size_t i = 0; i < numFunctions; i++)
     overallObjective += function.Evaluate(parameters, i);
 
-  const arma::mat data = function.Dataset();
+  // The compact triplets are used rather than a copy of the dataset.
+  const mlpack::svd::RatingTriplets& triplets = function.Triplets();
 
   // Now iterate!
   for (size_t i = 1; i != maxIterations; i++, currentFunction++)
@@ -194,11 +196,11 @@ double StandardSGD::Optimize(
     const size_t numUsers = function.NumUsers();
 
     // Indices for accessing the the correct parameter columns.
-    const size_t user = data(0, currentFunction);
-    const size_t item = data(1, currentFunction) + numUsers;
+    const size_t user = triplets.User(currentFunction);
+    const size_t item = triplets.Item(currentFunction) + numUsers;
 
     // Prediction error for the example.
-    const double rating = data(2, currentFunction);
+    const double rating = triplets.Rating(currentFunction);
     double ratingError = rating - arma::dot(parameters.col(user),
                                             parameters.col(item));
 
@@ -232,7 +234,16 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
   arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
       (function.NumFunctions() - 1), function.NumFunctions());
 
-  const arma::mat data = function.Dataset();
+  // The compact triplets are used rather than a copy of the dataset.
+  const mlpack::svd::RatingTriplets& triplets = function.Triplets();
+  const size_t numUsers = function.NumUsers();
+  const size_t rank = iterate.n_rows;
+  const double lambda = function.Lambda();
+
+  // With deterministic reductions, the shares of all threads are processed in
+  // order by one thread, since unsynchronized updates cannot be reproduced.
+  const size_t threads = ParallelThreads();
+  const size_t updateThreads = DeterministicReductions() ? 1 : threads;
 
   // Iterate till the objective is within tolerance or the maximum number of
   // allowed iterations is reached. If maxIterations is 0, this will iterate
@@ -241,14 +252,19 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
   {
     // Calculate the overall objective.
     lastObjective = overallObjective;
-    overallObjective = 0;
+    ReductionPartials<double> partials(function.NumFunctions(), 0.0);
 
-    #pragma omp parallel for reduction(+:overallObjective)
-    for (omp_size_t j = 0; j < (omp_size_t) function.NumFunctions(); ++j)
+    #pragma omp parallel for num_threads(partials.Threads())
+    for (omp_size_t c = 0; c < (omp_size_t) partials.Chunks(); ++c)
     {
-      overallObjective += function.Evaluate(iterate, j);
+      double& objective = partials.Partial(c);
+      for (size_t j = partials.Begin(c); j < partials.End(c); ++j)
+        objective += function.Evaluate(iterate, j);
     }
 
+    partials.Reduce(overallObjective,
+        [](double& a, const double& b) { a += b; });
+
     // Output current objective function.
     Log::Info << "Parallel SGD: iteration " << i << ", objective "
       << overallObjective << "." << std::endl;
@@ -275,45 +291,39 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
       std::shuffle(visitationOrder.begin(), visitationOrder.end(),
           mlpack::math::randGen);
 
-    #pragma omp parallel
+    // The steps are taken without any synchronization (HOGWILD!): an update
+    // only touches one user and one item column, so two threads rarely write
+    // to the same column at once, and when they do, both steps are kept
+    // (mostly).  This avoids an atomic operation on every element.
+    #pragma omp parallel for num_threads(updateThreads) schedule(static, 1)
+    for (omp_size_t t = 0; t < (omp_size_t) threads; ++t)
     {
       // Each processor gets a subset of the instances.
       // Each subset is of size threadShareSize.
-      size_t threadId = 0;
-      #ifdef HAS_OPENMP
-        threadId = omp_get_thread_num();
-      #endif
+      const size_t threadId = (size_t) t;
 
       for (size_t j = threadId * threadShareSize;
           j < (threadId + 1) * threadShareSize && j < visitationOrder.n_elem;
           ++j)
       {
-        const size_t numUsers = function.NumUsers();
+        const size_t index = visitationOrder[j];
 
-        // Indices for accessing the the correct parameter columns.
-        const size_t user = data(0, visitationOrder[j]);
-        const size_t item = data(1, visitationOrder[j]) + numUsers;
+        // Columns of the user and the item of the example.
+        double* user = iterate.colptr(triplets.User(index));
+        double* item = iterate.colptr(triplets.Item(index) + numUsers);
 
         // Prediction error for the example.
-        const double rating = data(2, visitationOrder[j]);
-        double ratingError = rating - arma::dot(iterate.col(user),
-            iterate.col(item));
-
-        double lambda = function.Lambda();
-
-        arma::mat userUpdate = stepSize * (lambda * iterate.col(user) -
-            ratingError * iterate.col(item));
-        arma::mat itemUpdate = stepSize * (lambda * iterate.col(item) -
-            ratingError * iterate.col(user));
+        double ratingError = triplets.Rating(index);
+        for (size_t d = 0; d < rank; ++d)
+          ratingError -= user[d] * item[d];
 
         // Gradient is non-zero only for the parameter columns corresponding to
         // the example.
-        for (size_t i = 0; i < iterate.n_rows; ++i)
+        for (size_t d = 0; d < rank; ++d)
         {
-          #pragma omp atomic
-          iterate(i, user) -= userUpdate(i);
-          #pragma omp atomic
-          iterate(i, item) -= itemUpdate(i);
+          const double userValue = user[d];
+          user[d] -= stepSize * (lambda * userValue - ratingError * item[d]);
+          item[d] -= stepSize * (lambda * item[d] - ratingError * userValue);
         }
       }
     }
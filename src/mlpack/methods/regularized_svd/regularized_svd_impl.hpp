@@ -42,8 +42,8 @@ void RegularizedSVD<OptimizerType>::Apply(const arma::mat& data,
   optimizer.Optimize(rSVDFunc, parameters);
 
   // Constants for extracting user and item matrices.
-  const size_t numUsers = max(data.row(0)) + 1;
-  const size_t numItems = max(data.row(1)) + 1;
+  const size_t numUsers = rSVDFunc.NumUsers();
+  const size_t numItems = rSVDFunc.NumItems();
 
   // Extract user and item matrices from the optimized parameters.
   u = parameters.submat(0, numUsers, rank - 1, numUsers + numItems - 1).t();
@@ -0,0 +1,202 @@
+/**
+ * @file actor.hpp
+ *
+ * Definition of the Actor class, which generates transitions for a learner in
+ * an actor-learner architecture.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ACTOR_HPP
+#define MLPACK_METHODS_RL_ACTOR_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "replay/transition_batch.hpp"
+#include "training_config.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * An actor of an actor-learner architecture (as in Ape-X).  Each actor steps
+ * its own copy of the environment with its own behavior policy and a copy of
+ * the learner's network, which may be stale, and collects the transitions into
+ * a TransitionBatch.  The learner (a QLearning agent) trains on the batches
+ * with QLearning::Train(), and the actors are given its parameters from time
+ * to time with SetParameters().
+ *
+ * Both the batches and the parameters can be serialized, so the actors can
+ * run in other processes or on other nodes, with any transport between them
+ * and the learner.  For instance, in a single process:
+ *
+ * @code
+ * std::vector<Actor<CartPole, NetworkType, GreedyPolicy<CartPole>>> actors;
+ * // ... one actor per exploration rate ...
+ *
+ * TransitionBatch batch;
+ * for (size_t round = 0; round < 1000; ++round)
+ * {
+ *   for (size_t i = 0; i < actors.size(); ++i)
+ *   {
+ *     batch.Clear();
+ *     actors[i].Act(50, batch);
+ *     learner.Train(batch, 4);
+ *   }
+ *
+ *   if (round % 10 == 0)
+ *     for (size_t i = 0; i < actors.size(); ++i)
+ *       actors[i].SetParameters(learner.Parameters());
+ * }
+ * @endcode
+ *
+ * For more details, see the following:
+ * @code
+ * @inproceedings{horgan2018distributed,
+ *   title     = {Distributed Prioritized Experience Replay},
+ *   author    = {Horgan, Dan and Quan, John and Budden, David and
+ *                Barth-Maron, Gabriel and Hessel, Matteo and
+ *                van Hasselt, Hado and Silver, David},
+ *   booktitle = {International Conference on Learning Representations},
+ *   year      = {2018}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType The environment of the reinforcement learning task.
+ * @tparam NetworkType The network to compute action value.
+ * @tparam PolicyType Behavior policy of the actor.
+ */
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename PolicyType
+>
+class Actor
+{
+ public:
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  /**
+   * Create the actor with the given network, policy and environment.
+   *
+   * @param config Hyper-parameters (only the step limit is used).
+   * @param network The network to compute action value.
+   * @param policy Behavior policy of the actor.
+   * @param environment Reinforcement learning task.
+   */
+  Actor(TrainingConfig config,
+        NetworkType network,
+        PolicyType policy,
+        EnvironmentType environment = EnvironmentType()) :
+      config(std::move(config)),
+      network(std::move(network)),
+      policy(std::move(policy)),
+      environment(std::move(environment)),
+      episodes(0)
+  {
+    if (this->network.Parameters().is_empty())
+      this->network.ResetParameters();
+    Reset();
+  }
+
+  /**
+   * Execute the given number of steps, continuing the current episode (and
+   * starting new ones as needed), and add the transitions to the given batch.
+   *
+   * @param steps Number of steps to execute.
+   * @param batch Batch to add the transitions to.
+   * @return Total reward of the steps.
+   */
+  double Act(const size_t steps, TransitionBatch& batch)
+  {
+    double totalReward = 0.0;
+    arma::colvec actionValue;
+    for (size_t i = 0; i < steps; ++i)
+    {
+      network.Predict(state.Encode(), actionValue);
+      ActionType action = policy.Sample(actionValue);
+
+      StateType nextState;
+      const double reward = environment.Sample(state, action, nextState);
+      const bool terminal = environment.IsTerminal(nextState);
+      batch.Add(state.Encode(), action, reward, nextState.Encode(), terminal);
+
+      totalReward += reward;
+      episodeSteps++;
+      policy.Anneal();
+
+      if (terminal || (config.StepLimit() &&
+          episodeSteps >= config.StepLimit()))
+      {
+        episodes++;
+        Reset();
+      }
+      else
+      {
+        state = nextState;
+      }
+    }
+
+    return totalReward;
+  }
+
+  /**
+   * Replace the parameters of the network, for instance with the latest ones
+   * of the learner.
+   *
+   * @param parameters The new parameters.
+   */
+  void SetParameters(const arma::mat& parameters)
+  {
+    network.Parameters() = parameters;
+  }
+
+  //! Get the parameters of the network.
+  const arma::mat& Parameters() const { return network.Parameters(); }
+
+  //! Get the number of episodes finished so far.
+  size_t Episodes() const { return episodes; }
+
+  //! Get the behavior policy.
+  const PolicyType& Policy() const { return policy; }
+
+ private:
+  //! Start a new episode.
+  void Reset()
+  {
+    state = environment.InitialSample();
+    episodeSteps = 0;
+  }
+
+  //! Locally-stored hyper-parameters.
+  TrainingConfig config;
+
+  //! Locally-stored (possibly stale) copy of the network of the learner.
+  NetworkType network;
+
+  //! Locally-stored behavior policy.
+  PolicyType policy;
+
+  //! Locally-stored reinforcement learning task.
+  EnvironmentType environment;
+
+  //! Locally-stored current state of the actor.
+  StateType state;
+
+  //! The number of steps of the current episode.
+  size_t episodeSteps;
+
+  //! The number of episodes finished so far.
+  size_t episodes;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
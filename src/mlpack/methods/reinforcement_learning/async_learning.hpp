@@ -41,6 +41,12 @@ namespace rl {
  * }
  * @endcode
  *
+ * The workers share the parameters of the learning network and update them
+ * without locks (as in Hogwild!), each with its own optimizer state.  Each
+ * worker also keeps its own snapshot of the target network, refreshed once per
+ * sync interval of the shared step counter, so that no lock is needed to
+ * predict with it.
+ *
  * @tparam WorkerType The type of the worker.
  * @tparam EnvironmentType The type of reinforcement learning task.
  * @tparam NetworkType The type of the network model.
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_RL_ASYNC_LEARNING_IMPL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 #include "queue"
 
 namespace mlpack {
@@ -68,7 +69,6 @@ void AsyncLearning<
   NetworkType learningNetwork = std::move(this->learningNetwork);
   if (learningNetwork.Parameters().is_empty())
     learningNetwork.ResetParameters();
-  NetworkType targetNetwork = learningNetwork;
   size_t totalSteps = 0;
   PolicyType policy = this->policy;
   bool stop = false;
@@ -85,18 +85,23 @@ void AsyncLearning<
   for (size_t i = 0; i <= config.NumWorkers(); ++i)
     tasks.push(i);
 
+  // Each worker draws its random numbers (for instance the exploration of
+  // the policy) from its own stream, whichever thread runs it.
+  const uint64_t seed = math::RandomStreamSeed();
+  std::vector<math::RandomStream> streams;
+  for (size_t i = 0; i <= config.NumWorkers(); ++i)
+    streams.push_back(math::RandomStream(seed, i));
+
   /**
    * Compute the number of threads for the for-loop. In general, we should use
    * OpenMP task rather than for-loop, here we do so to be compatible with some
    * compiler. We can switch to OpenMP task once MSVC supports OpenMP 3.0.
    */
-  size_t numThreads = 0;
-  #pragma omp parallel reduction(+:numThreads)
-  numThreads++;
+  const size_t numThreads = ParallelThreads();
   Log::Debug << numThreads << " threads will be used in total." << std::endl;
 
-  #pragma omp parallel for shared(stop, workers, tasks, learningNetwork, \
-      targetNetwork, totalSteps, policy)
+  #pragma omp parallel for num_threads(numThreads) shared(stop, workers, \
+      tasks, learningNetwork, totalSteps, policy, streams)
   for (omp_size_t i = 0; i < numThreads; ++i)
   {
     #pragma omp critical
@@ -128,9 +133,10 @@ void AsyncLearning<
 
       // Get corresponding worker.
       WorkerType& worker = workers[task];
+      math::RandomStreamScope scope(streams[task]);
       double episodeReturn;
-      if (worker.Step(learningNetwork, targetNetwork, totalSteps,
-          policy, episodeReturn) && !task)
+      if (worker.Step(learningNetwork, totalSteps, policy, episodeReturn) &&
+          !task)
       {
         stop = measure(episodeReturn);
       }
@@ -171,6 +171,42 @@ class CartPole
     return Sample(state, action, nextState);
   }
 
+  /**
+   * Dynamics of several Cart Pole instances at once, with one vectorized
+   * operation per step of the dynamics.
+   *
+   * @param states The current encoded states, one per column.
+   * @param actions The current action of each state.
+   * @param nextStates The encoded next states.
+   * @param rewards The rewards, they are always 1.0.
+   */
+  void Sample(const arma::mat& states,
+              const arma::Col<size_t>& actions,
+              arma::mat& nextStates,
+              arma::rowvec& rewards) const
+  {
+    // Calculate acceleration.
+    const arma::rowvec force = arma::conv_to<arma::rowvec>::from(
+        actions.t()) * (2 * forceMag) - forceMag;
+    const arma::rowvec cosTheta = arma::cos(states.row(2));
+    const arma::rowvec sinTheta = arma::sin(states.row(2));
+    const arma::rowvec temp = (force + poleMassLength *
+        arma::square(states.row(3)) % sinTheta) / totalMass;
+    const arma::rowvec thetaAcc = (gravity * sinTheta - cosTheta % temp) /
+        (length * (4.0 / 3.0 - massPole * arma::square(cosTheta) / totalMass));
+    const arma::rowvec xAcc = temp - poleMassLength * thetaAcc % cosTheta /
+        totalMass;
+
+    // Update states.
+    nextStates.set_size(State::dimension, states.n_cols);
+    nextStates.row(0) = states.row(0) + tau * states.row(1);
+    nextStates.row(1) = states.row(1) + tau * xAcc;
+    nextStates.row(2) = states.row(2) + tau * states.row(3);
+    nextStates.row(3) = states.row(3) + tau * thetaAcc;
+
+    rewards.ones(states.n_cols);
+  }
+
   /**
    * Initial state representation is randomly generated within [-0.05, 0.05].
    *
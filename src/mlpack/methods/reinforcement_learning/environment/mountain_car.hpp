@@ -150,6 +150,41 @@ class MountainCar
     return Sample(state, action, nextState);
   }
 
+  /**
+   * Dynamics of several Mountain Car instances at once, with one vectorized
+   * operation per step of the dynamics.
+   *
+   * @param states The current encoded states, one per column.
+   * @param actions The current action of each state.
+   * @param nextStates The encoded next states.
+   * @param rewards The rewards, they are always -1.0.
+   */
+  void Sample(const arma::mat& states,
+              const arma::Col<size_t>& actions,
+              arma::mat& nextStates,
+              arma::rowvec& rewards) const
+  {
+    // Calculate acceleration.
+    const arma::rowvec direction = arma::conv_to<arma::rowvec>::from(
+        actions.t()) - 1.0;
+    nextStates.set_size(State::dimension, states.n_cols);
+    nextStates.row(0) = arma::clamp(states.row(0) + 0.001 * direction -
+        0.0025 * arma::cos(3 * states.row(1)), velocityMin, velocityMax);
+
+    // Update states.
+    nextStates.row(1) = arma::clamp(states.row(1) + nextStates.row(0),
+        positionMin, positionMax);
+
+    for (size_t i = 0; i < states.n_cols; ++i)
+    {
+      if (std::abs(nextStates(1, i) - positionMin) <= 1e-5)
+        nextStates(0, i) = 0.0;
+    }
+
+    rewards.set_size(states.n_cols);
+    rewards.fill(-1.0);
+  }
+
   /**
    * Initial position is randomly generated within [-0.6, -0.4].
    * Initial velocity is 0.
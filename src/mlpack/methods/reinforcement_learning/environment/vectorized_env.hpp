@@ -0,0 +1,181 @@
+/**
+ * @file vectorized_env.hpp
+ *
+ * Definition of the VectorizedEnvironment class, which steps several copies of
+ * an environment at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ENVIRONMENT_VECTORIZED_ENV_HPP
+#define MLPACK_METHODS_RL_ENVIRONMENT_VECTORIZED_ENV_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace rl {
+
+HAS_MEM_FUNC(Sample, HasBatchSampleCheck);
+
+/**
+ * A set of copies of an environment that are stepped together.  The current
+ * states of all the copies are kept as the columns of one matrix, so that an
+ * agent can compute the action values of all of them with one call to
+ * Predict(), and Step() advances every copy at once.  If the environment has a
+ * batch Sample() method (as CartPole and MountainCar do), with the signature
+ *
+ * @code
+ * void Sample(const arma::mat& states,
+ *             const arma::Col<size_t>& actions,
+ *             arma::mat& nextStates,
+ *             arma::rowvec& rewards) const;
+ * @endcode
+ *
+ * then all the copies are stepped with one vectorized operation; otherwise
+ * the copies are stepped one at a time.  A copy that reaches a terminal state
+ * (or whose episode is ended with Reset()) starts a new episode.
+ *
+ * @code
+ * VectorizedEnvironment<CartPole> environments(32);
+ * QLearning<CartPole, ...> agent(...);
+ * for (size_t i = 0; i < 1000; ++i)
+ *   agent.Step(environments);
+ * @endcode
+ *
+ * @tparam EnvironmentType The environment to make copies of.
+ */
+template<typename EnvironmentType>
+class VectorizedEnvironment
+{
+ public:
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  /**
+   * Create the given number of copies of the environment, each at an initial
+   * state.
+   *
+   * @param numEnvironments Number of copies.
+   * @param environment The environment (its parameters are shared by all the
+   *     copies).
+   */
+  VectorizedEnvironment(const size_t numEnvironments,
+                        EnvironmentType environment = EnvironmentType()) :
+      environment(std::move(environment)),
+      states(StateType::dimension, numEnvironments),
+      steps(numEnvironments, arma::fill::zeros)
+  {
+    for (size_t i = 0; i < numEnvironments; ++i)
+      Reset(i);
+  }
+
+  /**
+   * Start a new episode in the given copy.
+   *
+   * @param index Index of the copy.
+   */
+  void Reset(const size_t index)
+  {
+    states.col(index) = environment.InitialSample().Encode();
+    steps[index] = 0;
+  }
+
+  /**
+   * Step all the copies with the given actions.  The copies that reach a
+   * terminal state are reset afterwards, so States() always holds the states
+   * to act from next.
+   *
+   * @param actions The action of each copy.
+   * @param nextStates The encoded next state of each copy (before any of them
+   *     is reset).
+   * @param rewards The reward of each copy.
+   * @param isTerminal Whether the next state of each copy is terminal.
+   */
+  void Step(const arma::Col<size_t>& actions,
+            arma::mat& nextStates,
+            arma::rowvec& rewards,
+            arma::Row<size_t>& isTerminal)
+  {
+    Sample(actions, nextStates, rewards);
+
+    states = nextStates;
+    isTerminal.set_size(states.n_cols);
+    for (size_t i = 0; i < states.n_cols; ++i)
+    {
+      steps[i]++;
+      isTerminal[i] = environment.IsTerminal(
+          StateType(arma::colvec(nextStates.col(i))));
+      if (isTerminal[i])
+        Reset(i);
+    }
+  }
+
+  //! Get the number of copies.
+  size_t NumEnvironments() const { return states.n_cols; }
+
+  //! Get the encoded current states of the copies, one per column.
+  const arma::mat& States() const { return states; }
+
+  //! Get the current state of the given copy.
+  StateType State(const size_t index) const
+  { return StateType(arma::colvec(states.col(index))); }
+
+  //! Get the number of steps of the current episode of each copy.
+  const arma::Col<size_t>& Steps() const { return steps; }
+
+  //! Get the environment.
+  const EnvironmentType& Environment() const { return environment; }
+
+ private:
+  //! Step all the copies with one call to the batch Sample() method.
+  template<typename E = EnvironmentType>
+  typename std::enable_if<HasBatchSampleCheck<E,
+      void(E::*)(const arma::mat&, const arma::Col<size_t>&, arma::mat&,
+      arma::rowvec&) const>::value>::type
+  Sample(const arma::Col<size_t>& actions,
+         arma::mat& nextStates,
+         arma::rowvec& rewards) const
+  {
+    environment.Sample(states, actions, nextStates, rewards);
+  }
+
+  //! Step the copies one at a time.
+  template<typename E = EnvironmentType>
+  typename std::enable_if<!HasBatchSampleCheck<E,
+      void(E::*)(const arma::mat&, const arma::Col<size_t>&, arma::mat&,
+      arma::rowvec&) const>::value>::type
+  Sample(const arma::Col<size_t>& actions,
+         arma::mat& nextStates,
+         arma::rowvec& rewards) const
+  {
+    nextStates.set_size(states.n_rows, states.n_cols);
+    rewards.set_size(states.n_cols);
+    for (size_t i = 0; i < states.n_cols; ++i)
+    {
+      StateType nextState;
+      rewards[i] = environment.Sample(State(i), (ActionType) actions[i],
+          nextState);
+      nextStates.col(i) = nextState.Encode();
+    }
+  }
+
+  //! The environment.
+  EnvironmentType environment;
+
+  //! The encoded current states of the copies.
+  arma::mat states;
+
+  //! The number of steps of the current episode of each copy.
+  arma::Col<size_t> steps;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
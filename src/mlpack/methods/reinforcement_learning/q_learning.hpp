@@ -16,6 +16,9 @@
 #include <mlpack/prereqs.hpp>
 
 #include "replay/random_replay.hpp"
+#include "replay/prioritized_replay.hpp"
+#include "replay/transition_batch.hpp"
+#include "environment/vectorized_env.hpp"
 #include "training_config.hpp"
 
 namespace mlpack {
@@ -45,7 +48,9 @@ namespace rl {
  * @tparam NetworkType The network to compute action value.
  * @tparam UpdaterType How to apply gradients when training.
  * @tparam PolicyType Behavior policy of the agent.
- * @tparam ReplayType Experience replay method.
+ * @tparam ReplayType Experience replay method (RandomReplay or
+ *     PrioritizedReplay).  After the targets of a sampled batch are computed,
+ *     its Update() method is given the TD errors of the batch.
  */
 template <
   typename EnvironmentType,
@@ -89,12 +94,37 @@ class QLearning
    */
   double Step();
 
+  /**
+   * Execute a step in each copy of the given environments: the action values
+   * of all the copies are computed with one call to Predict(), and all the
+   * transitions are stored for replay before one batch is learned from.  The
+   * copies whose episode reaches the step limit are reset.
+   *
+   * @param environments The copies of the environment to step.
+   * @return Total reward of the steps.
+   */
+  double Step(VectorizedEnvironment<EnvironmentType>& environments);
+
   /**
    * Execute an episode.
    * @return Return of the episode.
    */
   double Episode();
 
+  /**
+   * Train on transitions generated elsewhere, as the learner of an
+   * actor-learner architecture (see Actor): the transitions are stored for
+   * replay, each counting as one step, and then the given number of batches
+   * are sampled and learned from (once the exploration steps are over).
+   *
+   * @param batch The transitions to store.
+   * @param updates The number of batches to learn from.
+   */
+  void Train(const TransitionBatch& batch, const size_t updates = 1);
+
+  //! Get the parameters of the learning network (to send to the actors).
+  const arma::mat& Parameters() const { return learningNetwork.Parameters(); }
+
   /**
    * @return Total steps from beginning.
    */
@@ -113,6 +143,15 @@ class QLearning
    */
   arma::Col<size_t> BestAction(const arma::mat& actionValues);
 
+  //! Sample a batch of experience and update the learning network with it.
+  void Learn();
+
+  /**
+   * Update the target network after a step: either a soft update, or a copy
+   * at the sync interval.  Only the parameters are updated, in place.
+   */
+  void UpdateTargetNetwork();
+
   //! Locally-stored hyper-parameters.
   TrainingConfig config;
 
@@ -142,6 +181,14 @@ class QLearning
 
   //! Locally-stored flag indicating training mode or test mode.
   bool deterministic;
+
+  //! Buffers for the sampled experience, kept between steps so that sampling
+  //! does not reallocate them.
+  arma::mat sampledStates;
+  arma::icolvec sampledActions;
+  arma::colvec sampledRewards;
+  arma::mat sampledNextStates;
+  arma::icolvec isTerminal;
 };
 
 } // namespace rl
@@ -114,26 +114,44 @@ double QLearning<
     return reward;
 
   // Start experience replay.
+  Learn();
 
-  // Sample from previous experience.
-  arma::mat sampledStates;
-  arma::icolvec sampledActions;
-  arma::colvec sampledRewards;
-  arma::mat sampledNextStates;
-  arma::icolvec isTerminal;
+  return reward;
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+void QLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  BehaviorPolicyType,
+  ReplayType
+>::Learn()
+{
+  // Sample from previous experience, into the buffers kept between steps.
   replayMethod.Sample(sampledStates, sampledActions, sampledRewards,
       sampledNextStates, isTerminal);
 
-  // Compute action value for next state with target network.
+  // Compute action value for next state with target network.  Forward()
+  // handles the whole batch at once, while Predict() would evaluate it one
+  // column at a time.
   arma::mat nextActionValues;
-  targetNetwork.Predict(sampledNextStates, nextActionValues);
+  targetNetwork.Forward(sampledNextStates, nextActionValues);
 
   arma::Col<size_t> bestActions;
   if (config.DoubleQLearning())
   {
     // If use double Q-Learning, use learning network to select the best action.
+    // This has to be done before the forward pass over sampledStates, which
+    // Backward() uses.
     arma::mat nextActionValues;
-    learningNetwork.Predict(sampledNextStates, nextActionValues);
+    learningNetwork.Forward(sampledNextStates, nextActionValues);
     bestActions = BestAction(nextActionValues);
   }
   else
@@ -144,18 +162,122 @@ double QLearning<
   // Compute the update target.
   arma::mat target;
   learningNetwork.Forward(sampledStates, target);
+  arma::colvec tdErrors(sampledNextStates.n_cols);
   for (size_t i = 0; i < sampledNextStates.n_cols; ++i)
   {
-    target(sampledActions[i], i) = sampledRewards[i] + config.Discount() *
+    const double targetValue = sampledRewards[i] + config.Discount() *
         (isTerminal[i] ? 0.0 : nextActionValues(bestActions[i], i));
+    tdErrors[i] = targetValue - target(sampledActions[i], i);
+    target(sampledActions[i], i) = targetValue;
   }
 
+  // Give the TD errors back to the replay method (prioritized replay updates
+  // its priorities and weights the targets with them).
+  replayMethod.Update(target, sampledActions, tdErrors);
+
   // Learn form experience.
   arma::mat gradients;
   learningNetwork.Backward(target, gradients);
   updater.Update(learningNetwork.Parameters(), config.StepSize(), gradients);
+}
 
-  return reward;
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+double QLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  BehaviorPolicyType,
+  ReplayType
+>::Step(VectorizedEnvironment<EnvironmentType>& environments)
+{
+  // Get the action values of all the copies at once.
+  arma::mat actionValues;
+  learningNetwork.Forward(environments.States(), actionValues);
+
+  // Select an action for each copy according to the behavior policy.
+  const size_t numEnvironments = environments.NumEnvironments();
+  arma::Col<size_t> actions(numEnvironments);
+  for (size_t i = 0; i < numEnvironments; ++i)
+  {
+    actions[i] = policy.Sample(actionValues.unsafe_col(i), deterministic);
+  }
+
+  // Interact with all the copies to advance to the next states.
+  const arma::mat states = environments.States();
+  arma::mat nextStates;
+  arma::rowvec rewards;
+  arma::Row<size_t> isTerminal;
+  environments.Step(actions, nextStates, rewards, isTerminal);
+
+  // Store the transitions for replay, and end the episodes that reached the
+  // step limit.
+  for (size_t i = 0; i < numEnvironments; ++i)
+  {
+    replayMethod.Store(StateType(arma::colvec(states.col(i))),
+        (ActionType) actions[i], rewards[i],
+        StateType(arma::colvec(nextStates.col(i))), isTerminal[i]);
+
+    if (!isTerminal[i] && config.StepLimit() &&
+        environments.Steps()[i] >= config.StepLimit())
+      environments.Reset(i);
+  }
+
+  const double totalReward = arma::accu(rewards);
+  if (deterministic)
+    return totalReward;
+
+  // Each copy made one step; the target network is synchronized and the policy
+  // is annealed as if the steps had been made one at a time.
+  for (size_t i = 0; i < numEnvironments; ++i)
+  {
+    totalSteps++;
+
+    UpdateTargetNetwork();
+
+    if (totalSteps > config.ExplorationSteps())
+      policy.Anneal();
+  }
+
+  if (totalSteps >= config.ExplorationSteps())
+    Learn();
+
+  return totalReward;
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+void QLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  BehaviorPolicyType,
+  ReplayType
+>::UpdateTargetNetwork()
+{
+  const double rate = config.TargetNetworkUpdateRate();
+  if (rate > 0.0)
+  {
+    // Polyak averaging, in place.
+    targetNetwork.Parameters() *= (1.0 - rate);
+    targetNetwork.Parameters() += rate * learningNetwork.Parameters();
+  }
+  else if (totalSteps % config.TargetNetworkSyncInterval() == 0)
+  {
+    // Copying the parameters into the existing storage is much cheaper than
+    // copying the whole network.
+    targetNetwork.Parameters() = learningNetwork.Parameters();
+  }
 }
 
 template <
@@ -197,8 +319,7 @@ double QLearning<
     totalSteps++;
 
     // Update target network
-    if (totalSteps % config.TargetNetworkSyncInterval() == 0)
-      targetNetwork = learningNetwork;
+    UpdateTargetNetwork();
 
     if (totalSteps > config.ExplorationSteps())
       policy.Anneal();
@@ -207,6 +328,38 @@ double QLearning<
   return totalReturn;
 }
 
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+void QLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  BehaviorPolicyType,
+  ReplayType
+>::Train(const TransitionBatch& batch, const size_t updates)
+{
+  for (size_t i = 0; i < batch.Size(); ++i)
+  {
+    replayMethod.Store(StateType(batch.State(i)),
+        (ActionType) batch.Action(i), batch.Reward(i),
+        StateType(batch.NextState(i)), batch.IsTerminal(i));
+
+    totalSteps++;
+    UpdateTargetNetwork();
+  }
+
+  if (totalSteps < config.ExplorationSteps())
+    return;
+
+  for (size_t i = 0; i < updates; ++i)
+    Learn();
+}
+
 } // namespace rl
 } // namespace mlpack
 
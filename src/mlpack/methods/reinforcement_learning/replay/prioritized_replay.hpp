@@ -0,0 +1,285 @@
+/**
+ * @file prioritized_replay.hpp
+ *
+ * This file is an implementation of prioritized experience replay.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+#include "sum_tree.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of prioritized experience replay.
+ *
+ * Instead of sampling the transitions uniformly, as RandomReplay does, each
+ * transition is sampled with probability proportional to p_i^alpha, where the
+ * priority p_i is the magnitude of its last temporal-difference (TD) error
+ * (plus a small epsilon), so that the agent learns more from the transitions it
+ * predicts badly.  New transitions get the largest priority seen so far, so
+ * that they are sampled at least once.  The priorities are kept in a SumTree,
+ * so sampling a batch and updating its priorities take O(batchSize log
+ * capacity) time.
+ *
+ * The bias of the non-uniform sampling is corrected with the importance
+ * sampling weights w_i = (N P(i))^-beta, divided by the largest weight of the
+ * batch.  QLearning calls Update() after computing the targets of a sampled
+ * batch, which sets the priorities of the batch from its TD errors, and scales
+ * the TD error of each target by its weight (for a squared error loss, this
+ * scales the gradient of each transition by its weight).
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @inproceedings{schaul2016prioritized,
+ *   title     = {Prioritized Experience Replay},
+ *   author    = {Schaul, Tom and Quan, John and Antonoglou, Ioannis and
+ *                Silver, David},
+ *   booktitle = {International Conference on Learning Representations},
+ *   year      = {2016}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType Desired task.
+ */
+template <typename EnvironmentType>
+class PrioritizedReplay
+{
+ public:
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of prioritized experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of examples.
+   * @param alpha How much prioritization is used (0 is uniform sampling).
+   * @param beta Exponent of the importance sampling weights (1 fully corrects
+   *        the bias of the sampling).
+   * @param epsilon Value added to the magnitude of the TD errors, so that no
+   *        transition has a zero priority.
+   * @param dimension The dimension of an encoded state.
+   */
+  PrioritizedReplay(const size_t batchSize,
+                    const size_t capacity,
+                    const double alpha = 0.6,
+                    const double beta = 0.4,
+                    const double epsilon = 1e-6,
+                    const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      position(0),
+      alpha(alpha),
+      beta(beta),
+      epsilon(epsilon),
+      maxPriority(1.0),
+      priorities(capacity),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      nextStates(dimension, capacity),
+      isTerminal(capacity),
+      full(false)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Store the given experience, with the largest priority so far.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    states.col(position) = state.Encode();
+    actions(position) = action;
+    rewards(position) = reward;
+    nextStates.col(position) = nextState.Encode();
+    isTerminal(position) = isEnd;
+    priorities.Set(position, std::pow(maxPriority, alpha));
+    position++;
+    if (position == capacity)
+    {
+      full = true;
+      position = 0;
+    }
+  }
+
+  /**
+   * Sample some experiences, with probability proportional to their
+   * priorities.  The batch is stratified: one transition is sampled from each
+   * of batchSize equal ranges of the total priority.  The indices and the
+   * importance sampling weights of the batch are kept for Update().
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *        state.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal)
+  {
+    const size_t size = Size();
+    const double total = priorities.Sum();
+    const double segment = total / batchSize;
+
+    sampledIndices.set_size(batchSize);
+    weights.set_size(batchSize);
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const double mass = (i + math::Random()) * segment;
+      sampledIndices[i] = std::min(priorities.FindPrefixSum(mass), size - 1);
+
+      const double probability = priorities.Get(sampledIndices[i]) / total;
+      weights[i] = std::pow(size * probability, -beta);
+    }
+    weights /= weights.max();
+
+    sampledStates = states.cols(sampledIndices);
+    sampledActions = actions.elem(sampledIndices);
+    sampledRewards = rewards.elem(sampledIndices);
+    sampledNextStates = nextStates.cols(sampledIndices);
+    isTerminal = this->isTerminal.elem(sampledIndices);
+  }
+
+  /**
+   * Set the priorities of the given transitions from their TD errors.
+   *
+   * @param indices Indices of the transitions.
+   * @param tdErrors TD errors of the transitions.
+   */
+  void UpdatePriorities(const arma::uvec& indices,
+                        const arma::colvec& tdErrors)
+  {
+    for (size_t i = 0; i < indices.n_elem; ++i)
+    {
+      const double priority = std::abs(tdErrors[i]) + epsilon;
+      maxPriority = std::max(maxPriority, priority);
+      priorities.Set(indices[i], std::pow(priority, alpha));
+    }
+  }
+
+  /**
+   * Update the priorities of the last sampled batch with its TD errors, and
+   * weight the targets of the batch: the TD error of each target is scaled by
+   * its importance sampling weight.
+   *
+   * @param target Targets of the sampled batch, which are modified.
+   * @param sampledActions Sampled actions, whose values are the targets.
+   * @param tdErrors TD errors of the sampled batch (the targets minus the
+   *        current action values).
+   */
+  void Update(arma::mat& target,
+              const arma::icolvec& sampledActions,
+              const arma::colvec& tdErrors)
+  {
+    UpdatePriorities(sampledIndices, tdErrors);
+
+    for (size_t i = 0; i < sampledActions.n_elem; ++i)
+      target(sampledActions[i], i) -= (1.0 - weights[i]) * tdErrors[i];
+  }
+
+  /**
+   * Get the number of transitions in the memory.
+   *
+   * @return Actual used memory size
+   */
+  const size_t& Size()
+  {
+    return full ? capacity : position;
+  }
+
+  //! Get the indices of the last sampled batch.
+  const arma::uvec& SampledIndices() const { return sampledIndices; }
+  //! Get the importance sampling weights of the last sampled batch.
+  const arma::colvec& Weights() const { return weights; }
+
+  //! Get the priority of the given transition (to the power alpha).
+  double Priority(const size_t index) const { return priorities.Get(index); }
+
+  //! Get the exponent of the priorities.
+  double Alpha() const { return alpha; }
+  //! Get the exponent of the importance sampling weights.
+  double Beta() const { return beta; }
+  //! Modify the exponent of the importance sampling weights (to anneal it).
+  double& Beta() { return beta; }
+
+ private:
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! Indicate the position to store new transition.
+  size_t position;
+
+  //! Locally-stored exponent of the priorities.
+  double alpha;
+
+  //! Locally-stored exponent of the importance sampling weights.
+  double beta;
+
+  //! Locally-stored value added to the magnitude of the TD errors.
+  double epsilon;
+
+  //! The largest priority so far, given to new transitions.
+  double maxPriority;
+
+  //! The priorities (to the power alpha) of the transitions.
+  SumTree<double> priorities;
+
+  //! Locally-stored encoded previous states.
+  arma::mat states;
+
+  //! Locally-stored previous actions.
+  arma::icolvec actions;
+
+  //! Locally-stored previous rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded previous next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information of previous experience.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored indicator that whether the memory is full or not
+  bool full;
+
+  //! The indices of the last sampled batch.
+  arma::uvec sampledIndices;
+
+  //! The importance sampling weights of the last sampled batch.
+  arma::colvec weights;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
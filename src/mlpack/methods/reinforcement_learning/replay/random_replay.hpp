@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_RL_REPLAY_RANDOM_REPLAY_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace rl {
@@ -37,9 +38,19 @@ namespace rl {
  * }
  * @endcode
  *
+ * The encoded states are stored once: the next state of a transition is
+ * usually the state of the transition stored after it, so its next state is
+ * only copied when it is not (at the end of an episode).  The states can also
+ * be stored as single-precision floats, which halves the memory of the replay.
+ * Sample() gathers the batch into the given matrices, which are only
+ * reallocated if they do not have the right size, so that keeping them between
+ * calls (as QLearning does) avoids allocations.
+ *
  * @tparam EnvironmentType Desired task.
+ * @tparam ElemType Type of the elements of the stored states (double or
+ *     float).
  */
-template <typename EnvironmentType>
+template <typename EnvironmentType, typename ElemType = double>
 class RandomReplay
 {
  public:
@@ -65,9 +76,12 @@ class RandomReplay
       states(dimension, capacity),
       actions(capacity),
       rewards(capacity),
-      nextStates(dimension, capacity),
+      nextStates(capacity),
+      chained(capacity, arma::fill::zeros),
+      lastNextState(dimension),
       isTerminal(capacity),
-      full(false)
+      full(false),
+      sampledIndices(batchSize)
   { /* Nothing to do here. */ }
 
   /**
@@ -85,10 +99,26 @@ class RandomReplay
              const StateType& nextState,
              bool isEnd)
   {
-    states.col(position) = state.Encode();
+    // If the state is not the next state of the last transition, that next
+    // state has to be copied, since it will not be stored as a state.
+    const arma::colvec& encodedState = state.Encode();
+    if (Size() > 0)
+    {
+      const size_t last = (position + capacity - 1) % capacity;
+      chained[last] = arma::all(arma::conv_to<arma::Col<ElemType>>::from(
+          encodedState) == lastNextState);
+      if (!chained[last])
+        nextStates(last) = lastNextState;
+    }
+
+    states.col(position) = arma::conv_to<arma::Col<ElemType>>::from(
+        encodedState);
     actions(position) = action;
     rewards(position) = reward;
-    nextStates.col(position) = nextState.Encode();
+    nextStates(position).reset();
+    chained[position] = 0;
+    lastNextState = arma::conv_to<arma::Col<ElemType>>::from(
+        nextState.Encode());
     isTerminal(position) = isEnd;
     position++;
     if (position == capacity)
@@ -114,17 +144,44 @@ class RandomReplay
               arma::mat& sampledNextStates,
               arma::icolvec& isTerminal)
   {
-    size_t upperBound = full ? capacity : position;
-    arma::uvec sampledIndices = arma::randi<arma::uvec>(
-        batchSize, arma::distr_param(0, upperBound - 1));
-
-    sampledStates = states.cols(sampledIndices);
-    sampledActions = actions.elem(sampledIndices);
-    sampledRewards = rewards.elem(sampledIndices);
-    sampledNextStates = nextStates.cols(sampledIndices);
-    isTerminal = this->isTerminal.elem(sampledIndices);
+    const size_t upperBound = full ? capacity : position;
+    for (size_t i = 0; i < batchSize; ++i)
+      sampledIndices[i] = math::RandInt(upperBound);
+
+    // None of these reallocate if the sizes are the same as the last time.
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledNextStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    isTerminal.set_size(batchSize);
+
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const size_t index = sampledIndices[i];
+      std::copy(states.colptr(index), states.colptr(index) + states.n_rows,
+          sampledStates.colptr(i));
+      const ElemType* next = NextState(index);
+      std::copy(next, next + states.n_rows, sampledNextStates.colptr(i));
+
+      sampledActions[i] = actions[index];
+      sampledRewards[i] = rewards[index];
+      isTerminal[i] = this->isTerminal[index];
+    }
   }
 
+  /**
+   * Use the TD errors of the last sampled batch.  Random replay does not need
+   * them, so this does nothing.
+   *
+   * @param target Targets of the sampled batch.
+   * @param sampledActions Sampled actions, whose values are the targets.
+   * @param tdErrors TD errors of the sampled batch.
+   */
+  void Update(arma::mat& /* target */,
+              const arma::icolvec& /* sampledActions */,
+              const arma::colvec& /* tdErrors */)
+  { /* Nothing to do here. */ }
+
   /**
    * Get the number of transitions in the memory.
    *
@@ -135,7 +192,27 @@ class RandomReplay
     return full ? capacity : position;
   }
 
+  //! Get the indices of the last sampled batch.
+  const arma::uvec& SampledIndices() const { return sampledIndices; }
+
  private:
+  /**
+   * Get the encoded next state of the given transition: the state of the
+   * following transition, the next state of the last transition, or the copy
+   * made at the end of an episode.
+   *
+   * @param index Index of the transition.
+   */
+  const ElemType* NextState(const size_t index) const
+  {
+    if (index == (position + capacity - 1) % capacity)
+      return lastNextState.memptr();
+    else if (chained[index])
+      return states.colptr((index + 1) % capacity);
+    else
+      return nextStates(index).memptr();
+  }
+
   //! Locally-stored number of examples of each sample.
   size_t batchSize;
 
@@ -146,7 +223,7 @@ class RandomReplay
   size_t position;
 
   //! Locally-stored encoded previous states.
-  arma::mat states;
+  arma::Mat<ElemType> states;
 
   //! Locally-stored previous actions.
   arma::icolvec actions;
@@ -154,14 +231,25 @@ class RandomReplay
   //! Locally-stored previous rewards.
   arma::colvec rewards;
 
-  //! Locally-stored encoded previous next states.
-  arma::mat nextStates;
+  //! Locally-stored copies of the encoded next states that are not the state
+  //! of the following transition (empty for the others).
+  arma::field<arma::Col<ElemType>> nextStates;
+
+  //! Whether the next state of each transition is the state of the following
+  //! one.
+  arma::Col<unsigned char> chained;
+
+  //! The encoded next state of the last transition.
+  arma::Col<ElemType> lastNextState;
 
   //! Locally-stored termination information of previous experience.
   arma::icolvec isTerminal;
 
   //! Locally-stored indicator that whether the memory is full or not
   bool full;
+
+  //! The indices of the last sampled batch.
+  arma::uvec sampledIndices;
 };
 
 } // namespace rl
@@ -0,0 +1,113 @@
+/**
+ * @file sum_tree.hpp
+ *
+ * Definition of the SumTree class, a segment tree of the sums of non-negative
+ * values, used to sample from priorities in logarithmic time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+#define MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A complete binary tree whose leaves hold non-negative values and whose
+ * internal nodes hold the sums of their children, stored in an array (node k
+ * has the children 2k and 2k + 1, and the root is node 1).  Setting a value and
+ * finding the index at which the prefix sum exceeds a given mass both take
+ * O(log n) time, so an index can be sampled with probability proportional to
+ * its value by finding the prefix sum of a uniform mass in [0, Sum()).
+ *
+ * @tparam T Type of the values.
+ */
+template<typename T = double>
+class SumTree
+{
+ public:
+  /**
+   * Create a tree of the given number of values, which are all zero.
+   *
+   * @param capacity Number of values.
+   */
+  SumTree(const size_t capacity) :
+      capacity(capacity),
+      leaves(1)
+  {
+    while (leaves < capacity)
+      leaves *= 2;
+    tree.zeros(2 * leaves);
+  }
+
+  /**
+   * Set the value at the given index, and update the sums above it.
+   *
+   * @param index Index of the value.
+   * @param value New value, which must be non-negative.
+   */
+  void Set(const size_t index, const T value)
+  {
+    size_t node = index + leaves;
+    tree[node] = value;
+    for (node /= 2; node >= 1; node /= 2)
+      tree[node] = tree[2 * node] + tree[2 * node + 1];
+  }
+
+  //! Get the value at the given index.
+  T Get(const size_t index) const { return tree[index + leaves]; }
+
+  //! Get the sum of all the values.
+  T Sum() const { return tree[1]; }
+
+  //! Get the number of values.
+  size_t Capacity() const { return capacity; }
+
+  /**
+   * Find the smallest index whose prefix sum (including its own value) is
+   * larger than the given mass.  The subtrees whose sum is zero are never
+   * entered, so that rounding errors never return an index with a zero value
+   * (unless all the values are zero).
+   *
+   * @param mass Mass to find, in [0, Sum()).
+   */
+  size_t FindPrefixSum(T mass) const
+  {
+    size_t node = 1;
+    while (node < leaves)
+    {
+      const size_t left = 2 * node;
+      if (mass < tree[left] || tree[left + 1] <= 0)
+      {
+        node = left;
+      }
+      else
+      {
+        mass -= tree[left];
+        node = left + 1;
+      }
+    }
+
+    return std::min(node - leaves, capacity - 1);
+  }
+
+ private:
+  //! The number of values.
+  size_t capacity;
+
+  //! The number of leaves (the smallest power of two at least capacity).
+  size_t leaves;
+
+  //! The nodes of the tree; tree[0] is unused.
+  arma::Col<T> tree;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file transition_batch.hpp
+ *
+ * Definition of the TransitionBatch class, a serializable batch of
+ * transitions, as sent by actors to a learner.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_TRANSITION_BATCH_HPP
+#define MLPACK_METHODS_RL_REPLAY_TRANSITION_BATCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A batch of transitions (state, action, reward, next state, whether the next
+ * state is terminal), with the states encoded as columns.  It can be
+ * serialized, so that actors in other processes can send the transitions they
+ * generate to a learner over any stream (see Actor and QLearning::Train()).
+ */
+class TransitionBatch
+{
+ public:
+  //! Create an empty batch.
+  TransitionBatch() : size(0) { /* Nothing to do here. */ }
+
+  /**
+   * Add a transition to the batch.
+   *
+   * @param state Encoded state.
+   * @param action Action.
+   * @param reward Reward.
+   * @param nextState Encoded next state.
+   * @param isEnd Whether the next state is terminal.
+   */
+  void Add(const arma::colvec& state,
+           const size_t action,
+           const double reward,
+           const arma::colvec& nextState,
+           const bool isEnd)
+  {
+    if (size == states.n_cols)
+      Reserve(std::max((size_t) 16, (size_t) 2 * states.n_cols), state.n_elem);
+
+    const size_t i = size++;
+    states.col(i) = state;
+    actions[i] = action;
+    rewards[i] = reward;
+    nextStates.col(i) = nextState;
+    isTerminal[i] = isEnd;
+  }
+
+  //! Remove all the transitions (the memory is kept).
+  void Clear() { size = 0; }
+
+  //! Get the number of transitions.
+  size_t Size() const { return size; }
+
+  //! Get the encoded state of the given transition.
+  arma::colvec State(const size_t i) const { return states.col(i); }
+  //! Get the action of the given transition.
+  size_t Action(const size_t i) const { return actions[i]; }
+  //! Get the reward of the given transition.
+  double Reward(const size_t i) const { return rewards[i]; }
+  //! Get the encoded next state of the given transition.
+  arma::colvec NextState(const size_t i) const { return nextStates.col(i); }
+  //! Get whether the next state of the given transition is terminal.
+  bool IsTerminal(const size_t i) const { return isTerminal[i]; }
+
+  //! Serialize the batch.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    // Only the used part of the storage is serialized.
+    if (Archive::is_saving::value)
+    {
+      arma::mat usedStates, usedNextStates;
+      arma::Col<size_t> usedActions, usedTerminal;
+      arma::colvec usedRewards;
+      if (size > 0)
+      {
+        usedStates = states.cols(0, size - 1);
+        usedNextStates = nextStates.cols(0, size - 1);
+        usedActions = actions.head(size);
+        usedRewards = rewards.head(size);
+        usedTerminal = isTerminal.head(size);
+      }
+      ar & data::CreateNVP(size, "size");
+      ar & data::CreateNVP(usedStates, "states");
+      ar & data::CreateNVP(usedActions, "actions");
+      ar & data::CreateNVP(usedRewards, "rewards");
+      ar & data::CreateNVP(usedNextStates, "nextStates");
+      ar & data::CreateNVP(usedTerminal, "isTerminal");
+    }
+    else
+    {
+      ar & data::CreateNVP(size, "size");
+      ar & data::CreateNVP(states, "states");
+      ar & data::CreateNVP(actions, "actions");
+      ar & data::CreateNVP(rewards, "rewards");
+      ar & data::CreateNVP(nextStates, "nextStates");
+      ar & data::CreateNVP(isTerminal, "isTerminal");
+    }
+  }
+
+ private:
+  //! Make room for the given number of transitions.
+  void Reserve(const size_t capacity, const size_t dimension)
+  {
+    states.resize(dimension, capacity);
+    nextStates.resize(dimension, capacity);
+    actions.resize(capacity);
+    rewards.resize(capacity);
+    isTerminal.resize(capacity);
+  }
+
+  //! The number of transitions.
+  size_t size;
+
+  //! The encoded states.
+  arma::mat states;
+  //! The actions.
+  arma::Col<size_t> actions;
+  //! The rewards.
+  arma::colvec rewards;
+  //! The encoded next states.
+  arma::mat nextStates;
+  //! Whether each next state is terminal.
+  arma::Col<size_t> isTerminal;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
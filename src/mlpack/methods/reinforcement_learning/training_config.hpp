@@ -19,7 +19,11 @@ namespace rl {
 class TrainingConfig
 {
  public:
-  TrainingConfig() : stepLimit(0), gradientLimit(40), doubleQLearning(false)
+  TrainingConfig() :
+      stepLimit(0),
+      gradientLimit(40),
+      doubleQLearning(false),
+      targetNetworkUpdateRate(0.0)
   { /* Nothing to do here. */ }
 
   TrainingConfig(
@@ -31,7 +35,8 @@ class TrainingConfig
       double stepSize,
       double discount,
       double gradientLimit,
-      bool doubleQLearning) :
+      bool doubleQLearning,
+      double targetNetworkUpdateRate = 0.0) :
       numWorkers(numWorkers),
       updateInterval(updateInterval),
       targetNetworkSyncInterval(targetNetworkSyncInterval),
@@ -40,7 +45,8 @@ class TrainingConfig
       stepSize(stepSize),
       discount(discount),
       gradientLimit(gradientLimit),
-      doubleQLearning(doubleQLearning)
+      doubleQLearning(doubleQLearning),
+      targetNetworkUpdateRate(targetNetworkUpdateRate)
   { /* Nothing to do here. */ }
 
   //! Get the amount of workers.
@@ -92,6 +98,15 @@ class TrainingConfig
   //! Modify the indicator of double q-learning.
   bool& DoubleQLearning() { return doubleQLearning; }
 
+  //! Get the rate of the soft (Polyak) updates of the target network.
+  double TargetNetworkUpdateRate() const { return targetNetworkUpdateRate; }
+  /**
+   * Modify the rate of the soft (Polyak) updates of the target network.
+   * Setting it to 0 means the target network is copied every
+   * TargetNetworkSyncInterval() steps instead.
+   */
+  double& TargetNetworkUpdateRate() { return targetNetworkUpdateRate; }
+
  private:
   /**
    * Locally-stored number of workers.
@@ -149,6 +164,13 @@ class TrainingConfig
    * This is valid only for q-learning agent.
    */
   bool doubleQLearning;
+
+  /**
+   * Locally-stored rate of the soft updates of the target network: after each
+   * step, target = (1 - rate) * target + rate * learning.
+   * This is valid only for q-learning agent.
+   */
+  double targetNetworkUpdateRate;
 };
 
 } // namespace rl
@@ -68,15 +68,16 @@ class NStepQLearningWorker
   {
     updater.Initialize(learningNetwork.Parameters().n_rows,
         learningNetwork.Parameters().n_cols);
-    // Build local network.
+    // Build local network and the local snapshot of the target network.
     network = learningNetwork;
+    targetNetwork = learningNetwork;
+    targetSyncs = 0;
   }
 
   /**
    * The agent will execute one step.
    *
    * @param learningNetwork The shared learning network.
-   * @param targetNetwork The shared target network.
    * @param totalSteps The shared counter for total steps.
    * @param policy The shared behavior policy.
    * @param totalReward This will be the episode return if the episode ends
@@ -84,7 +85,6 @@ class NStepQLearningWorker
    * @return Indicate whether current episode ends after this step.
    */
   bool Step(NetworkType& learningNetwork,
-            NetworkType& targetNetwork,
             size_t& totalSteps,
             PolicyType& policy,
             double& totalReward)
@@ -108,7 +108,7 @@ class NStepQLearningWorker
         totalReward = episodeReturn;
         Reset();
         // Sync with latest learning network.
-        network = learningNetwork;
+        network.Parameters() = learningNetwork.Parameters();
         return true;
       }
       state = nextState;
@@ -132,8 +132,7 @@ class NStepQLearningWorker
       double target = 0;
       if (!terminal)
       {
-        #pragma omp critical
-        { targetNetwork.Predict(nextState.Encode(), actionValue); };
+        targetNetwork.Predict(nextState.Encode(), actionValue);
         target = actionValue.max();
       }
 
@@ -165,17 +164,22 @@ class NStepQLearningWorker
       updater.Update(learningNetwork.Parameters(),
           config.StepSize(), totalGradients);
 
-      // Sync the local network with the global network.
-      network = learningNetwork;
+      // Sync the local network with the global network.  Only the parameters
+      // are copied, and without a lock: other workers may be updating them at
+      // the same time, which (as in Hogwild!) only adds a little noise.
+      network.Parameters() = learningNetwork.Parameters();
 
       pendingIndex = 0;
     }
 
-    // Update global target network.
-    if (totalSteps % config.TargetNetworkSyncInterval() == 0)
+    // Refresh the local snapshot of the target network once per sync
+    // interval of the shared step counter, so predicting with it needs no
+    // lock.
+    const size_t syncs = totalSteps / config.TargetNetworkSyncInterval();
+    if (syncs != targetSyncs)
     {
-      #pragma omp critical
-      { targetNetwork = learningNetwork; }
+      targetNetwork.Parameters() = learningNetwork.Parameters();
+      targetSyncs = syncs;
     }
 
     policy.Anneal();
@@ -229,6 +233,12 @@ class NStepQLearningWorker
   //! Local network of the worker.
   NetworkType network;
 
+  //! Local snapshot of the target network.
+  NetworkType targetNetwork;
+
+  //! Number of the sync interval the target network was last refreshed at.
+  size_t targetSyncs;
+
   //! Current state of the agent.
   StateType state;
 };
@@ -0,0 +1,125 @@
+/**
+ * @file search_benchmark.cpp
+ *
+ * Implementation of the non-template members of the SearchBenchmark class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "search_benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+SearchBenchmark::SearchBenchmark(const arma::mat& referenceSet,
+                                 const arma::mat& querySet,
+                                 const size_t k,
+                                 const size_t latencyQueries) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    k(k),
+    latencyQueries(std::min(latencyQueries, (size_t) querySet.n_cols))
+{
+  if (k == 0 || k >= referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SearchBenchmark::SearchBenchmark(): invalid k " << k << "; must "
+        << "be greater than 0 and less than the number of reference points ("
+        << referenceSet.n_cols << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (querySet.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "SearchBenchmark::SearchBenchmark(): the query set has "
+        << "dimensionality " << querySet.n_rows << ", but the reference set "
+        << "has dimensionality " << referenceSet.n_rows;
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+const arma::Mat<size_t>& SearchBenchmark::TrueNeighbors(const bool furthest)
+{
+  arma::Mat<size_t>& trueNeighbors = furthest ? trueFurthest : trueNearest;
+  if (trueNeighbors.n_cols == querySet.n_cols && trueNeighbors.n_rows == k)
+    return trueNeighbors;
+
+  Log::Info << "Computing exact " << (furthest ? "furthest" : "nearest")
+      << " neighbors..." << std::endl;
+  arma::mat distances;
+  if (furthest)
+  {
+    KFN kfn(referenceSet);
+    kfn.Search(querySet, k, trueNeighbors, distances);
+  }
+  else
+  {
+    KNN knn(referenceSet);
+    knn.Search(querySet, k, trueNeighbors, distances);
+  }
+
+  return trueNeighbors;
+}
+
+void SearchBenchmark::WriteCSV(std::ostream& stream) const
+{
+  stream << "method,parameters,k,recall,build_time,search_time,"
+      << "queries_per_second,mean_latency_ms,p50_latency_ms,p90_latency_ms,"
+      << "p99_latency_ms,index_bytes\n";
+
+  for (const BenchmarkResult& result : results)
+  {
+    stream << result.method << ",\"" << result.parameters << "\","
+        << result.k << "," << result.recall << "," << result.buildTime << ","
+        << result.searchTime << "," << result.queriesPerSecond << ","
+        << result.meanLatency << "," << result.p50Latency << ","
+        << result.p90Latency << "," << result.p99Latency << ",";
+    if (result.indexBytes >= 0)
+      stream << result.indexBytes;
+    stream << "\n";
+  }
+}
+
+void SearchBenchmark::WriteJSON(std::ostream& stream) const
+{
+  stream << "[";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& result = results[i];
+    stream << ((i == 0) ? "\n" : ",\n");
+    stream << "  { \"method\": \"" << result.method << "\", "
+        << "\"parameters\": \"" << result.parameters << "\", "
+        << "\"k\": " << result.k << ", "
+        << "\"recall\": " << result.recall << ", "
+        << "\"build_time\": " << result.buildTime << ", "
+        << "\"search_time\": " << result.searchTime << ", "
+        << "\"queries_per_second\": " << result.queriesPerSecond << ", "
+        << "\"mean_latency_ms\": " << result.meanLatency << ", "
+        << "\"p50_latency_ms\": " << result.p50Latency << ", "
+        << "\"p90_latency_ms\": " << result.p90Latency << ", "
+        << "\"p99_latency_ms\": " << result.p99Latency << ", "
+        << "\"index_bytes\": ";
+    if (result.indexBytes >= 0)
+      stream << result.indexBytes;
+    else
+      stream << "null";
+    stream << " }";
+  }
+  stream << (results.empty() ? "]\n" : "\n]\n");
+}
+
+double SearchBenchmark::Percentile(const std::vector<double>& sortedValues,
+                                   const double p)
+{
+  if (sortedValues.empty())
+    throw std::invalid_argument("SearchBenchmark::Percentile(): no values "
+        "given");
+
+  // The rank of the percentile, starting at 1.
+  size_t rank = (size_t) std::ceil(p * sortedValues.size() / 100.0);
+  rank = std::min(std::max(rank, (size_t) 1), sortedValues.size());
+  return sortedValues[rank - 1];
+}
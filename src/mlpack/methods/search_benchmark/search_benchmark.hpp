@@ -0,0 +1,202 @@
+/**
+ * @file search_benchmark.hpp
+ *
+ * Definition of the SearchBenchmark class, which measures the recall, the
+ * throughput, the latency, the build time and the memory of approximate
+ * neighbor search methods against the exact neighbors.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SEARCH_BENCHMARK_SEARCH_BENCHMARK_HPP
+#define MLPACK_METHODS_SEARCH_BENCHMARK_SEARCH_BENCHMARK_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/memory_tracker.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/lsh/lsh_search.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The measurements of one configuration of a search method, as made by
+ * SearchBenchmark::Run().  Times are in seconds, and latencies in
+ * milliseconds.
+ */
+struct BenchmarkResult
+{
+  //! Name of the method.
+  std::string method;
+  //! Values of the parameters of the method, as "name=value" pairs separated
+  //! by spaces.
+  std::string parameters;
+  //! Number of neighbors searched for.
+  size_t k;
+  //! Fraction of the true neighbors that were found, in [0, 1].
+  double recall;
+  //! Time taken to build the index.
+  double buildTime;
+  //! Time taken to search for all query points in one batch.
+  double searchTime;
+  //! Number of query points searched for per second, in one batch.
+  double queriesPerSecond;
+  //! Mean latency of a single query point.
+  double meanLatency;
+  //! Median latency of a single query point.
+  double p50Latency;
+  //! 90th percentile of the latency of a single query point.
+  double p90Latency;
+  //! 99th percentile of the latency of a single query point.
+  double p99Latency;
+  //! Memory held by the index after it was built, or -1 if it is not known
+  //! (see MemoryTracker).
+  int64_t indexBytes;
+};
+
+/**
+ * SearchBenchmark compares configurations of (approximate) nearest or
+ * furthest neighbor search methods, like LSHSearch, RASearch, spill trees,
+ * NeighborSearch with a nonzero epsilon, DrusillaSelect and QDAFN, on one
+ * reference set and one query set.  The exact neighbors are computed with
+ * NeighborSearch the first time they are needed, once for each sort policy,
+ * and every configuration given to Run() is measured against them:
+ *
+ *  - the recall at k (see LSHSearch::ComputeRecall());
+ *  - the time to build the index, and the memory it holds afterwards;
+ *  - the throughput, when all query points are searched for in one call;
+ *  - the mean, median, 90th and 99th percentile latency, when the first
+ *    query points are searched for one at a time.
+ *
+ * The memory of an index is the memory that Armadillo objects hold after it
+ * was built, minus the memory they held before; so it does not include the
+ * nodes of trees or other objects on the heap, and it is only known if mlpack
+ * was configured with -DMEMORY_TRACKING=ON (see MemoryTracker).
+ *
+ * The method is given as two functions: build() builds the index, and
+ * search(querySet, neighbors, distances) searches it for the k neighbors of
+ * the given query points.  The index should be released after Run(), so that
+ * the memory of the next index is measured correctly.
+ *
+ * @code
+ * SearchBenchmark benchmark(referenceSet, querySet, 10);
+ * for (const double epsilon : { 0.0, 0.1, 0.5 })
+ * {
+ *   std::unique_ptr<KNN> knn;
+ *   benchmark.Run("epsilon", "epsilon=" + std::to_string(epsilon), false,
+ *       [&]() { knn.reset(new KNN(referenceSet, DUAL_TREE_MODE, epsilon)); },
+ *       [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+ *           arma::mat& distances)
+ *       { knn->Search(queries, 10, neighbors, distances); });
+ * }
+ * benchmark.WriteCSV(std::cout);
+ * @endcode
+ */
+class SearchBenchmark
+{
+ public:
+  /**
+   * Prepare to benchmark search methods on the given sets, which must live as
+   * long as the object.  A std::invalid_argument is thrown if k is 0 or not
+   * less than the number of reference points, or if the sets have different
+   * dimensionalities.
+   *
+   * @param referenceSet Set of reference points.
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param latencyQueries Number of query points to search for one at a time,
+   *     to measure the latency (at most the number of query points).
+   */
+  SearchBenchmark(const arma::mat& referenceSet,
+                  const arma::mat& querySet,
+                  const size_t k,
+                  const size_t latencyQueries = 100);
+
+  /**
+   * Build and measure one configuration of a search method, and add its
+   * result to Results().
+   *
+   * @param method Name of the method.
+   * @param parameters Values of the parameters of the configuration.
+   * @param furthest If true, the method searches for furthest neighbors.
+   * @param build Function that builds the index.
+   * @param search Function that searches the index for the k neighbors of the
+   *     given query points.
+   * @return The result of the configuration.
+   */
+  template<typename BuildType, typename SearchType>
+  const BenchmarkResult& Run(const std::string& method,
+                             const std::string& parameters,
+                             const bool furthest,
+                             BuildType build,
+                             SearchType search);
+
+  /**
+   * Get the exact nearest (or furthest) neighbors of the query points,
+   * computing them if this was not done yet.
+   *
+   * @param furthest If true, get the furthest neighbors.
+   */
+  const arma::Mat<size_t>& TrueNeighbors(const bool furthest);
+
+  //! Get the results of all configurations so far.
+  const std::vector<BenchmarkResult>& Results() const { return results; }
+
+  //! Get the number of neighbors searched for.
+  size_t K() const { return k; }
+
+  /**
+   * Write the results as CSV, with a header line and one line per
+   * configuration.  An unknown index memory is left empty.
+   *
+   * @param stream Stream to write to.
+   */
+  void WriteCSV(std::ostream& stream) const;
+
+  /**
+   * Write the results as a JSON array with one object per configuration.  An
+   * unknown index memory is null.
+   *
+   * @param stream Stream to write to.
+   */
+  void WriteJSON(std::ostream& stream) const;
+
+  /**
+   * Get the given percentile of the given sorted values, with the nearest-rank
+   * method: the smallest value that is at least as large as p percent of the
+   * values.
+   *
+   * @param sortedValues Values, in increasing order (at least one).
+   * @param p Percentile, in (0, 100].
+   */
+  static double Percentile(const std::vector<double>& sortedValues,
+                           const double p);
+
+ private:
+  //! The reference set.
+  const arma::mat& referenceSet;
+  //! The query set.
+  const arma::mat& querySet;
+  //! The number of neighbors.
+  size_t k;
+  //! The number of query points searched for one at a time.
+  size_t latencyQueries;
+
+  //! The exact nearest neighbors, if they were computed.
+  arma::Mat<size_t> trueNearest;
+  //! The exact furthest neighbors, if they were computed.
+  arma::Mat<size_t> trueFurthest;
+
+  //! The results of all configurations.
+  std::vector<BenchmarkResult> results;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "search_benchmark_impl.hpp"
+
+#endif
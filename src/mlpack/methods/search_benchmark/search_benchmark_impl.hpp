@@ -0,0 +1,107 @@
+/**
+ * @file search_benchmark_impl.hpp
+ *
+ * Implementation of SearchBenchmark::Run().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SEARCH_BENCHMARK_SEARCH_BENCHMARK_IMPL_HPP
+#define MLPACK_METHODS_SEARCH_BENCHMARK_SEARCH_BENCHMARK_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "search_benchmark.hpp"
+
+#include <chrono>
+#include <numeric>
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename BuildType, typename SearchType>
+const BenchmarkResult& SearchBenchmark::Run(const std::string& method,
+                                            const std::string& parameters,
+                                            const bool furthest,
+                                            BuildType build,
+                                            SearchType search)
+{
+  typedef std::chrono::steady_clock Clock;
+  typedef std::chrono::duration<double> Seconds;
+
+  // Compute the exact neighbors first, so that their memory and time are not
+  // counted for the configuration.
+  const arma::Mat<size_t>& trueNeighbors = TrueNeighbors(furthest);
+
+  BenchmarkResult result;
+  result.method = method;
+  result.parameters = parameters;
+  result.k = k;
+
+  const int64_t bytesBefore = MemoryTracker::Bytes();
+  Clock::time_point start = Clock::now();
+  build();
+  result.buildTime = Seconds(Clock::now() - start).count();
+  result.indexBytes = MemoryTracker::Enabled() ?
+      (MemoryTracker::Bytes() - bytesBefore) : -1;
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  start = Clock::now();
+  search(querySet, neighbors, distances);
+  result.searchTime = Seconds(Clock::now() - start).count();
+  result.queriesPerSecond = (result.searchTime > 0.0) ?
+      (querySet.n_cols / result.searchTime) : 0.0;
+
+  if (neighbors.n_rows != k || neighbors.n_cols != querySet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SearchBenchmark::Run(): " << method << " (" << parameters << ") "
+        << "returned " << neighbors.n_rows << "x" << neighbors.n_cols
+        << " neighbors instead of " << k << "x" << querySet.n_cols;
+    throw std::runtime_error(oss.str());
+  }
+  result.recall = LSHSearch<>::ComputeRecall(neighbors, trueNeighbors);
+
+  // Each query point is copied before its search starts, so the copy is not
+  // part of its latency.
+  std::vector<double> latencies(latencyQueries);
+  arma::mat query(querySet.n_rows, 1);
+  arma::Mat<size_t> queryNeighbors;
+  arma::mat queryDistances;
+  for (size_t i = 0; i < latencyQueries; ++i)
+  {
+    query.col(0) = querySet.col(i);
+    start = Clock::now();
+    search(query, queryNeighbors, queryDistances);
+    latencies[i] = 1000.0 * Seconds(Clock::now() - start).count();
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  if (latencyQueries > 0)
+  {
+    result.meanLatency = std::accumulate(latencies.begin(), latencies.end(),
+        0.0) / latencyQueries;
+    result.p50Latency = Percentile(latencies, 50.0);
+    result.p90Latency = Percentile(latencies, 90.0);
+    result.p99Latency = Percentile(latencies, 99.0);
+  }
+  else
+  {
+    result.meanLatency = result.p50Latency = result.p90Latency =
+        result.p99Latency = 0.0;
+  }
+
+  Log::Info << method << " (" << parameters << "): recall " << result.recall
+      << ", " << result.queriesPerSecond << " queries per second, median "
+      << "latency " << result.p50Latency << "ms." << std::endl;
+
+  results.push_back(result);
+  return results.back();
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
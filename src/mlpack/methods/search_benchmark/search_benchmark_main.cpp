@@ -0,0 +1,327 @@
+/**
+ * @file search_benchmark_main.cpp
+ *
+ * Command-line program that measures the recall, throughput, latency, build
+ * time and memory of the approximate neighbor search methods of mlpack over a
+ * sweep of their parameters.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/core/data/extension.hpp>
+#include <mlpack/methods/neighbor_search/ns_model.hpp>
+#include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/rann/ra_search.hpp>
+#include <mlpack/methods/approx_kfn/drusilla_select.hpp>
+#include <mlpack/methods/approx_kfn/qdafn.hpp>
+
+#include "search_benchmark.hpp"
+
+#include <fstream>
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+// Information about the program itself.
+PROGRAM_INFO("Approximate neighbor search benchmark",
+    "This program compares the approximate neighbor search methods of mlpack "
+    "on a given dataset.  For every combination of the parameters given for "
+    "each method, an index is built on the reference set and the k neighbors "
+    "of each query point are searched for; the results are compared with the "
+    "exact neighbors, which are computed once (with the kNN or kFN dual-tree "
+    "algorithm).  For each configuration, the recall at k, the build time, the "
+    "number of queries per second (when all query points are searched for at "
+    "once), the mean, median, 90th and 99th percentile latency (when query "
+    "points are searched for one at a time) and the memory of the index (if "
+    "mlpack was built with -DMEMORY_TRACKING=ON) are reported."
+    "\n\n"
+    "The methods are given as a comma-separated list with " +
+    PRINT_PARAM_STRING("methods") + ":"
+    "\n\n"
+    " - 'lsh': locality-sensitive hashing (as in mlpack_lsh), with the "
+    "parameters " + PRINT_PARAM_STRING("lsh_projections") + ", " +
+    PRINT_PARAM_STRING("lsh_tables") + " and " +
+    PRINT_PARAM_STRING("lsh_probes") + "."
+    "\n"
+    " - 'ra': rank-approximate search (as in mlpack_krann), with the "
+    "parameters " + PRINT_PARAM_STRING("ra_tau") + " and " +
+    PRINT_PARAM_STRING("ra_alpha") + "."
+    "\n"
+    " - 'spill': defeatist search with spill trees (as in mlpack_knn), with "
+    "the parameter " + PRINT_PARAM_STRING("spill_tau") + "."
+    "\n"
+    " - 'epsilon': dual-tree search with a kd-tree that allows a relative "
+    "error (as in mlpack_knn), with the parameter " +
+    PRINT_PARAM_STRING("epsilon") + "."
+    "\n"
+    " - 'ds' and 'qdafn': approximate furthest neighbor search (as in "
+    "mlpack_approx_kfn), with the parameters " +
+    PRINT_PARAM_STRING("afn_tables") + " and " +
+    PRINT_PARAM_STRING("afn_projections") + "; these are compared with the "
+    "exact furthest neighbors."
+    "\n\n"
+    "Each parameter can be given several values, separated by commas, and all "
+    "combinations of the values of a method are measured.  The results are "
+    "written as CSV to " + PRINT_PARAM_STRING("output_file") + " (or as JSON, "
+    "if its extension is .json), or printed as CSV if no file is given."
+    "\n\n"
+    "For example, to compare LSH with 10 and 30 tables and kd-trees with an "
+    "epsilon of 0.1 and 0.5 when searching for 10 neighbors of the points in " +
+    PRINT_DATASET("queries") + " among the points of " +
+    PRINT_DATASET("reference") + ", saving the results to 'results.csv', one "
+    "could call"
+    "\n\n" +
+    PRINT_CALL("search_benchmark", "reference", "reference", "query",
+        "queries", "k", 10, "methods", "lsh,epsilon", "lsh_tables", "10,30",
+        "epsilon", "0.1,0.5", "output_file", "results.csv"));
+
+PARAM_MATRIX_IN_REQ("reference", "Matrix containing the reference dataset.",
+    "r");
+PARAM_MATRIX_IN("query", "Matrix containing query points (if not given, the "
+    "reference set is used).", "q");
+PARAM_INT_IN_REQ("k", "Number of neighbors to search for.", "k");
+
+PARAM_STRING_IN("methods", "Comma-separated list of the methods to benchmark: "
+    "'lsh', 'ra', 'spill', 'epsilon', 'ds' and 'qdafn'.", "m",
+    "lsh,ra,spill,epsilon,ds,qdafn");
+
+PARAM_VECTOR_IN(int, "lsh_projections", "Numbers of projections of each hash "
+    "table for 'lsh' (default 10).", "");
+PARAM_VECTOR_IN(int, "lsh_tables", "Numbers of hash tables for 'lsh' (default "
+    "10 and 30).", "");
+PARAM_VECTOR_IN(int, "lsh_probes", "Numbers of additional probes for 'lsh' "
+    "(default 0).", "");
+PARAM_VECTOR_IN(double, "ra_tau", "Rank-approximation percentiles for 'ra' "
+    "(default 5).", "");
+PARAM_VECTOR_IN(double, "ra_alpha", "Success probabilities for 'ra' (default "
+    "0.95).", "");
+PARAM_VECTOR_IN(double, "spill_tau", "Overlapping sizes of the spill trees "
+    "for 'spill' (default 0); these depend on the scale of the data.", "");
+PARAM_VECTOR_IN(double, "epsilon", "Relative errors for 'epsilon' (default "
+    "0.1 and 0.5).", "");
+PARAM_VECTOR_IN(int, "afn_tables", "Numbers of tables for 'ds' and 'qdafn' "
+    "(default 5).", "");
+PARAM_VECTOR_IN(int, "afn_projections", "Numbers of projections of each table "
+    "for 'ds' and 'qdafn' (default 5).", "");
+
+PARAM_INT_IN("leaf_size", "Leaf size of the trees of 'spill' and 'epsilon'.",
+    "l", 20);
+PARAM_DOUBLE_IN("rho", "Balance threshold of the spill trees of 'spill'.",
+    "b", 0.7);
+PARAM_INT_IN("latency_queries", "Number of query points to search for one at "
+    "a time, to measure the latency.", "L", 100);
+
+PARAM_STRING_IN("output_file", "File to write the results to, as CSV (or as "
+    "JSON, if its extension is .json).", "o", "");
+PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+
+// Get the values of the given parameter, or the defaults if none were given.
+template<typename T>
+vector<T> Values(const string& name, const vector<T>& defaults)
+{
+  const vector<T>& values = CLI::GetParam<vector<T>>(name);
+  for (const T& value : values)
+    if (value < 0)
+      Log::Fatal << "Invalid value " << value << " for --" << name << "; "
+          << "values must be non-negative." << endl;
+  return values.empty() ? defaults : values;
+}
+
+// Format the given parameter values for the results.
+string Parameters(const vector<pair<string, double>>& values)
+{
+  ostringstream oss;
+  for (size_t i = 0; i < values.size(); ++i)
+    oss << ((i == 0) ? "" : " ") << values[i].first << "=" << values[i].second;
+  return oss.str();
+}
+
+// Run one configuration, and only warn if it fails, so that the other
+// configurations are still measured.
+template<typename BuildType, typename SearchType>
+void Run(SearchBenchmark& benchmark,
+         const string& method,
+         const string& parameters,
+         const bool furthest,
+         BuildType build,
+         SearchType search)
+{
+  try
+  {
+    benchmark.Run(method, parameters, furthest, build, search);
+  }
+  catch (std::exception& e)
+  {
+    Log::Warn << method << " (" << parameters << ") skipped: " << e.what()
+        << endl;
+  }
+}
+
+void mlpackMain()
+{
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) time(NULL));
+
+  const arma::mat& referenceSet = CLI::GetParam<arma::mat>("reference");
+  const arma::mat& querySet = CLI::HasParam("query") ?
+      CLI::GetParam<arma::mat>("query") : referenceSet;
+
+  const int kInt = CLI::GetParam<int>("k");
+  if (kInt <= 0 || (size_t) kInt >= referenceSet.n_cols)
+    Log::Fatal << "Invalid k: " << kInt << "; must be greater than 0 and less "
+        << "than the number of reference points (" << referenceSet.n_cols
+        << ")." << endl;
+  const size_t k = (size_t) kInt;
+
+  const int leafSize = CLI::GetParam<int>("leaf_size");
+  if (leafSize <= 0)
+    Log::Fatal << "Invalid leaf size: " << leafSize << ".  Must be greater "
+        << "than 0." << endl;
+
+  const int latencyQueries = CLI::GetParam<int>("latency_queries");
+  if (latencyQueries < 0)
+    Log::Fatal << "Invalid latency_queries: " << latencyQueries << ".  Must be "
+        << "non-negative." << endl;
+
+  const double rho = CLI::GetParam<double>("rho");
+  if (rho < 0 || rho > 1)
+    Log::Fatal << "Invalid rho: " << rho << ".  Must be in the range [0,1]."
+        << endl;
+
+  // Parse the list of methods.
+  vector<string> methods;
+  istringstream methodStream(CLI::GetParam<string>("methods"));
+  string method;
+  while (getline(methodStream, method, ','))
+  {
+    if (method != "lsh" && method != "ra" && method != "spill" &&
+        method != "epsilon" && method != "ds" && method != "qdafn")
+      Log::Fatal << "Unknown method '" << method << "'; must be 'lsh', 'ra', "
+          << "'spill', 'epsilon', 'ds' or 'qdafn'." << endl;
+    methods.push_back(method);
+  }
+
+  SearchBenchmark benchmark(referenceSet, querySet, k,
+      (size_t) latencyQueries);
+
+  for (const string& method : methods)
+  {
+    if (method == "lsh")
+    {
+      for (const int projections : Values<int>("lsh_projections", { 10 }))
+      for (const int tables : Values<int>("lsh_tables", { 10, 30 }))
+      for (const int probes : Values<int>("lsh_probes", { 0 }))
+      {
+        unique_ptr<LSHSearch<>> lsh;
+        Run(benchmark, method, Parameters({ { "projections", projections },
+            { "tables", tables }, { "probes", probes } }), false,
+            [&]() { lsh.reset(new LSHSearch<>(referenceSet, projections,
+                tables)); },
+            [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+                arma::mat& distances)
+            {
+              lsh->Search(queries, k, neighbors, distances, 0,
+                  (size_t) probes);
+            });
+      }
+    }
+    else if (method == "ra")
+    {
+      for (const double tau : Values<double>("ra_tau", { 5.0 }))
+      for (const double alpha : Values<double>("ra_alpha", { 0.95 }))
+      {
+        unique_ptr<RASearch<>> ra;
+        Run(benchmark, method, Parameters({ { "tau", tau },
+            { "alpha", alpha } }), false,
+            [&]() { ra.reset(new RASearch<>(referenceSet, false, false, tau,
+                alpha)); },
+            [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+                arma::mat& distances)
+            { ra->Search(queries, k, neighbors, distances); });
+      }
+    }
+    else if (method == "spill" || method == "epsilon")
+    {
+      typedef NSModel<NearestNeighborSort> KNNModel;
+      const bool spill = (method == "spill");
+      for (const double value : spill ?
+          Values<double>("spill_tau", { 0.0 }) :
+          Values<double>("epsilon", { 0.1, 0.5 }))
+      {
+        unique_ptr<KNNModel> knn;
+        Run(benchmark, method, Parameters({ { spill ? "tau" : "epsilon",
+            value } }), false,
+            [&]()
+            {
+              knn.reset(new KNNModel(spill ? KNNModel::SPILL_TREE :
+                  KNNModel::KD_TREE));
+              if (spill)
+              {
+                knn->Tau() = value;
+                knn->Rho() = rho;
+              }
+              arma::mat referenceCopy(referenceSet);
+              knn->BuildModel(std::move(referenceCopy), (size_t) leafSize,
+                  DUAL_TREE_MODE, spill ? 0.0 : value);
+            },
+            [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+                arma::mat& distances)
+            {
+              arma::mat queryCopy(queries);
+              knn->Search(std::move(queryCopy), k, neighbors, distances);
+            });
+      }
+    }
+    else
+    {
+      const bool ds = (method == "ds");
+      for (const int tables : Values<int>("afn_tables", { 5 }))
+      for (const int projections : Values<int>("afn_projections", { 5 }))
+      {
+        unique_ptr<DrusillaSelect<>> drusilla;
+        unique_ptr<QDAFN<>> qdafn;
+        Run(benchmark, method, Parameters({ { "tables", tables },
+            { "projections", projections } }), true,
+            [&]()
+            {
+              if (ds)
+                drusilla.reset(new DrusillaSelect<>(referenceSet, tables,
+                    projections));
+              else
+                qdafn.reset(new QDAFN<>(referenceSet, tables, projections));
+            },
+            [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+                arma::mat& distances)
+            {
+              if (ds)
+                drusilla->Search(queries, k, neighbors, distances);
+              else
+                qdafn->Search(queries, k, neighbors, distances);
+            });
+      }
+    }
+  }
+
+  const string outputFile = CLI::GetParam<string>("output_file");
+  if (outputFile.empty())
+  {
+    benchmark.WriteCSV(cout);
+    return;
+  }
+
+  ofstream stream(outputFile.c_str());
+  if (!stream.is_open())
+    Log::Fatal << "Cannot open '" << outputFile << "' for writing." << endl;
+  if (data::Extension(outputFile) == "json")
+    benchmark.WriteJSON(stream);
+  else
+    benchmark.WriteCSV(stream);
+}
@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/cv/warm_start_traits.hpp>
 
 #include "softmax_regression_function.hpp"
 
@@ -58,6 +59,18 @@ namespace regression {
  * regressor1.Classify(test_data, predictions1);
  * regressor2.Classify(test_data, predictions2);
  * @endcode
+ *
+ * The data may also be sparse (arma::sp_mat), for instance for bag-of-words
+ * features; then the model is trained and used without densifying the data.
+ * For very large datasets, an optimizer of separable functions such as
+ * mini-batch SGD can be used instead of L-BFGS:
+ *
+ * @code
+ * arma::sp_mat sparseData; // Sparse training data.
+ * MiniBatchSGD optimizer(256, 0.01, 10 * sparseData.n_cols / 256);
+ * SoftmaxRegression regressor3(sparseData, labels, numClasses, 0.0001, true,
+ *     optimizer);
+ * @endcode
  */
 class SoftmaxRegression
 {
@@ -82,6 +95,7 @@ class SoftmaxRegression
    * function. By default, the model takes a small value.
    *
    * @tparam OptimizerType Desired optimizer type.
+   * @tparam MatType Type of the data (arma::mat or arma::sp_mat).
    * @param data Input training features. Each column associate with one sample
    * @param labels Labels associated with the feature data.
    * @param inputSize Size of the input feature vector.
@@ -90,8 +104,9 @@ class SoftmaxRegression
    * @param lambda L2-regularization constant.
    * @param fitIntercept add intercept term or not.
    */
-  template<typename OptimizerType = mlpack::optimization::L_BFGS>
-  SoftmaxRegression(const arma::mat& data,
+  template<typename OptimizerType = mlpack::optimization::L_BFGS,
+           typename MatType = arma::mat>
+  SoftmaxRegression(const MatType& data,
                     const arma::Row<size_t>& labels,
                     const size_t numClasses,
                     const double lambda = 0.0001,
@@ -118,10 +133,11 @@ class SoftmaxRegression
    * point. It then chooses the class which has the highest probability among
    * all.
    *
-   * @param dataset Set of points to classify.
+   * @param dataset Set of points to classify (dense or sparse).
    * @param labels Predicted labels for each point.
    */
-  void Classify(const arma::mat& dataset, arma::Row<size_t>& labels) const;
+  template<typename MatType>
+  void Classify(const MatType& dataset, arma::Row<size_t>& labels) const;
 
   /**
    * Classify the given point. The predicted class label is returned.
@@ -141,21 +157,23 @@ class SoftmaxRegression
    * point. It then chooses the class which has the highest probability among
    * all.
    *
-   * @param dataset Matrix of data points to be classified.
+   * @param dataset Matrix of data points to be classified (dense or sparse).
    * @param labels Predicted labels for each point.
    * @param probabilities Class probabilities for each point.
    */
-  void Classify(const arma::mat& dataset,
+  template<typename MatType>
+  void Classify(const MatType& dataset,
                 arma::Row<size_t>& labels,
                 arma::mat& probabilites) const;
 
   /**
    * Classify the given points, returning class probabilities for each point.
    *
-   * @param dataset Matrix of data points to be classified.
+   * @param dataset Matrix of data points to be classified (dense or sparse).
    * @param probabilities Class probabilities for each point.
    */
-  void Classify(const arma::mat& dataset,
+  template<typename MatType>
+  void Classify(const MatType& dataset,
                 arma::mat& probabilities) const;
 
   /**
@@ -166,21 +184,24 @@ class SoftmaxRegression
    * @param testData Matrix of data points using which predictions are made.
    * @param labels Vector of labels associated with the data.
    */
-  double ComputeAccuracy(const arma::mat& testData,
+  template<typename MatType>
+  double ComputeAccuracy(const MatType& testData,
                          const arma::Row<size_t>& labels) const;
 
   /**
    * Train the softmax regression with the given training data.
    *
    * @tparam OptimizerType Desired optimizer type.
+   * @tparam MatType Type of the data (arma::mat or arma::sp_mat).
    * @param data Input data with each column as one example.
    * @param labels Labels associated with the feature data.
    * @param numClasses Number of classes for classification.
    * @param optimizer Desired optimizer.
    * @return Objective value of the final point.
    */
-  template<typename OptimizerType = mlpack::optimization::L_BFGS>
-  double Train(const arma::mat& data,
+  template<typename OptimizerType = mlpack::optimization::L_BFGS,
+           typename MatType = arma::mat>
+  double Train(const MatType& data,
                const arma::Row<size_t>& labels,
                const size_t numClasses,
                OptimizerType optimizer = OptimizerType());
@@ -234,6 +255,43 @@ class SoftmaxRegression
 };
 
 } // namespace regression
+
+namespace cv {
+
+/**
+ * SoftmaxRegression can be trained starting from the parameters of a previous
+ * model (for example, one with a different lambda), as long as they have the
+ * same shape.  The arguments are the ones of the training constructor.
+ */
+template<>
+struct WarmStartTraits<regression::SoftmaxRegression>
+{
+  static const bool Supported = true;
+
+  template<typename MatType,
+           typename OptimizerType = mlpack::optimization::L_BFGS>
+  static regression::SoftmaxRegression Train(
+      const regression::SoftmaxRegression& previous,
+      const MatType& data,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const double lambda = 0.0001,
+      const bool fitIntercept = false,
+      OptimizerType optimizer = OptimizerType())
+  {
+    regression::SoftmaxRegression model(data.n_rows, numClasses,
+        fitIntercept);
+    model.Lambda() = lambda;
+    if (previous.Parameters().n_rows == model.Parameters().n_rows &&
+        previous.Parameters().n_cols == model.Parameters().n_cols)
+      model.Parameters() = previous.Parameters();
+
+    model.Train(data, labels, numClasses, optimizer);
+    return model;
+  }
+};
+
+} // namespace cv
 } // namespace mlpack
 
 // Include implementation.
@@ -18,7 +18,28 @@
 namespace mlpack {
 namespace regression {
 
-class SoftmaxRegressionFunction
+/**
+ * The objective function of softmax regression: the average negative log
+ * likelihood of the labels plus an L2 penalty on the parameters.  It can be
+ * optimized by the optimizers for differentiable functions, such as L-BFGS,
+ * and it is separable over the points, for the optimizers of separable
+ * functions, such as SGD, mini-batch SGD, and Adam.  The separable function
+ * of point i is
+ *
+ *   f_i(theta) = -log(p(y_i | x_i; theta)) + 0.5 * lambda * ||theta||^2,
+ *
+ * so the sum over all the points is NumFunctions() times the objective given
+ * by Evaluate(parameters).  Both have the same minimum; the separable one does
+ * not make the gradient of each point smaller as the dataset grows.
+ *
+ * The data may be dense (arma::mat) or sparse (arma::sp_mat).  With sparse
+ * data, neither the data nor the gradients are densified, except for the
+ * dense (numClasses x batch size) matrix of probabilities.
+ *
+ * @tparam MatType Type of the data matrix.
+ */
+template<typename MatType = arma::mat>
+class SoftmaxRegressionFunctionType
 {
  public:
   /**
@@ -32,11 +53,11 @@ class SoftmaxRegressionFunction
    * @param lambda L2-regularization constant.
    * @param fitIntercept Intercept term flag.
    */
-  SoftmaxRegressionFunction(const arma::mat& data,
-                            const arma::Row<size_t>& labels,
-                            const size_t numClasses,
-                            const double lambda = 0.0001,
-                            const bool fitIntercept = false);
+  SoftmaxRegressionFunctionType(const MatType& data,
+                                const arma::Row<size_t>& labels,
+                                const size_t numClasses,
+                                const double lambda = 0.0001,
+                                const bool fitIntercept = false);
 
   //! Initializes the parameters of the model to suitable values.
   const arma::mat InitializeWeights();
@@ -111,6 +132,86 @@ class SoftmaxRegressionFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the objective function and its gradient given the current set of
+   * parameters.  The class probabilities are only calculated once, so this is
+   * cheaper than calling Evaluate() and Gradient().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the separable objective function of the given point (see the
+   * class documentation).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i) const
+  { return Evaluate(parameters, i, 1); }
+
+  /**
+   * Evaluate the sum of the separable objective functions of the points
+   * [begin, begin + batchSize).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
+  /**
+   * Compute the gradient of the separable objective function of the given
+   * point.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient) const
+  { Gradient(parameters, i, gradient, 1); }
+
+  /**
+   * Compute the sum of the gradients of the separable objective functions of
+   * the points [begin, begin + batchSize).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const;
+
+  /**
+   * Evaluate the sum of the separable objective functions of the points
+   * [begin, begin + batchSize) and the sum of their gradients; the class
+   * probabilities are only calculated once.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   * @return The sum of the objective functions.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize) const;
+
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return data.n_cols; }
+
   /**
    * Evaluates the gradient values of the objective function given the current
    * set of parameters for a single feature indexed by j.
@@ -145,8 +246,30 @@ class SoftmaxRegressionFunction
   bool FitIntercept() const { return fitIntercept; }
 
  private:
+  /**
+   * Compute the class probabilities of the given points.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param points Points to compute the probabilities of.
+   * @param probabilities Matrix to store the probabilities in.
+   */
+  template<typename PointsType>
+  void Probabilities(const arma::mat& parameters,
+                     const PointsType& points,
+                     arma::mat& probabilities) const;
+
+  /**
+   * Compute the gradient of the log likelihood of the given points, given the
+   * difference between their probabilities and their ground truth, without
+   * the regularization.
+   */
+  template<typename PointsType>
+  void LikelihoodGradient(const arma::mat& inner,
+                          const PointsType& points,
+                          arma::mat& gradient) const;
+
   //! Training data matrix.
-  const arma::mat& data;
+  const MatType& data;
   //! Label matrix for the provided data.
   arma::sp_mat groundTruth;
   //! Initial parameter point.
@@ -159,7 +282,13 @@ class SoftmaxRegressionFunction
   bool fitIntercept;
 };
 
+//! The softmax regression function on dense data.
+typedef SoftmaxRegressionFunctionType<arma::mat> SoftmaxRegressionFunction;
+
 } // namespace regression
 } // namespace mlpack
 
+// Include implementation.
+#include "softmax_regression_function_impl.hpp"
+
 #endif
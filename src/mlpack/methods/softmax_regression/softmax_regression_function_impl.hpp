@@ -1,5 +1,5 @@
 /**
- * @file softmax_regression_function.cpp
+ * @file softmax_regression_function_impl.hpp
  * @author Siddharth Agrawal
  *
  * Implementation of function to be optimized for softmax regression.
@@ -9,13 +9,18 @@
  * 3-clause BSD license along with mlpack.  If not, see
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
 #include "softmax_regression_function.hpp"
 
-using namespace mlpack;
-using namespace mlpack::regression;
+namespace mlpack {
+namespace regression {
 
-SoftmaxRegressionFunction::SoftmaxRegressionFunction(
-    const arma::mat& data,
+template<typename MatType>
+SoftmaxRegressionFunctionType<MatType>::SoftmaxRegressionFunctionType(
+    const MatType& data,
     const arma::Row<size_t>& labels,
     const size_t numClasses,
     const double lambda,
@@ -37,12 +42,14 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(
  * normal distribution. The weights cannot be initialized to zero, as that will
  * lead to each class output being the same.
  */
-const arma::mat SoftmaxRegressionFunction::InitializeWeights()
+template<typename MatType>
+const arma::mat SoftmaxRegressionFunctionType<MatType>::InitializeWeights()
 {
   return InitializeWeights(data.n_rows, numClasses, fitIntercept);
 }
 
-const arma::mat SoftmaxRegressionFunction::InitializeWeights(
+template<typename MatType>
+const arma::mat SoftmaxRegressionFunctionType<MatType>::InitializeWeights(
     const size_t featureSize,
     const size_t numClasses,
     const bool fitIntercept)
@@ -52,7 +59,8 @@ const arma::mat SoftmaxRegressionFunction::InitializeWeights(
     return parameters;
 }
 
-void SoftmaxRegressionFunction::InitializeWeights(
+template<typename MatType>
+void SoftmaxRegressionFunctionType<MatType>::InitializeWeights(
     arma::mat &weights,
     const size_t featureSize,
     const size_t numClasses,
@@ -73,7 +81,8 @@ void SoftmaxRegressionFunction::InitializeWeights(
  * labels. The output is in the form of a matrix, which leads to simpler
  * calculations in the Evaluate() and Gradient() methods.
  */
-void SoftmaxRegressionFunction::GetGroundTruthMatrix(
+template<typename MatType>
+void SoftmaxRegressionFunctionType<MatType>::GetGroundTruthMatrix(
     const arma::Row<size_t>& labels, arma::sp_mat& groundTruth)
 {
   // Calculate the ground truth matrix according to the labels passed. The
@@ -106,9 +115,20 @@ void SoftmaxRegressionFunction::GetGroundTruthMatrix(
  * Evaluate the probabilities matrix. If fitIntercept flag is true,
  * it should consider the parameters.cols(0) intercept term.
  */
-void SoftmaxRegressionFunction::GetProbabilitiesMatrix(
+template<typename MatType>
+void SoftmaxRegressionFunctionType<MatType>::GetProbabilitiesMatrix(
     const arma::mat& parameters,
     arma::mat& probabilities) const
+{
+  Probabilities(parameters, data, probabilities);
+}
+
+template<typename MatType>
+template<typename PointsType>
+void SoftmaxRegressionFunctionType<MatType>::Probabilities(
+    const arma::mat& parameters,
+    const PointsType& points,
+    arma::mat& probabilities) const
 {
   arma::mat hypothesis;
 
@@ -120,22 +140,45 @@ void SoftmaxRegressionFunction::GetProbabilitiesMatrix(
     //
     // Since the cost of join maybe high due to the copy of original data,
     // split the hypothesis computation to two components.
-    hypothesis = arma::exp(arma::repmat(parameters.col(0), 1, data.n_cols) +
-                           parameters.cols(1, parameters.n_cols - 1) * data);
+    hypothesis = arma::exp(arma::repmat(parameters.col(0), 1, points.n_cols) +
+                           parameters.cols(1, parameters.n_cols - 1) * points);
   }
   else
   {
-    hypothesis = arma::exp(parameters * data);
+    hypothesis = arma::exp(parameters * points);
   }
 
   probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
                                             numClasses, 1);
 }
 
+template<typename MatType>
+template<typename PointsType>
+void SoftmaxRegressionFunctionType<MatType>::LikelihoodGradient(
+    const arma::mat& inner,
+    const PointsType& points,
+    arma::mat& gradient) const
+{
+  if (fitIntercept)
+  {
+    // Treating the intercept term parameters.col(0) seperately to avoid
+    // the cost of building matrix [1; data].
+    gradient.set_size(inner.n_rows, points.n_rows + 1);
+    gradient.col(0) = arma::sum(inner, 1);
+    gradient.cols(1, points.n_rows) = inner * points.t();
+  }
+  else
+  {
+    gradient = inner * points.t();
+  }
+}
+
 /**
  * Evaluates the objective function given the parameters.
  */
-double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
+template<typename MatType>
+double SoftmaxRegressionFunctionType<MatType>::Evaluate(
+    const arma::mat& parameters) const
 {
   // The objective function is the negative log likelihood of the model
   // calculated over all the training examples. Mathematically it is as follows:
@@ -173,8 +216,10 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
 /**
  * Calculates and stores the gradient values given a set of parameters.
  */
-void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
+template<typename MatType>
+void SoftmaxRegressionFunctionType<MatType>::Gradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
 {
   // Calculate the class probabilities for each training example. The
   // probabilities for each of the classes are given by:
@@ -186,29 +231,117 @@ void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
   GetProbabilitiesMatrix(parameters, probabilities);
 
   // Calculate the parameter gradients.
-  gradient.set_size(parameters.n_rows, parameters.n_cols);
-  if (fitIntercept)
-  {
-    // Treating the intercept term parameters.col(0) seperately to avoid
-    // the cost of building matrix [1; data].
-    arma::mat inner = probabilities - groundTruth;
-    gradient.col(0) =
-      inner * arma::ones<arma::mat>(data.n_cols, 1) / data.n_cols +
-      lambda * parameters.col(0);
-    gradient.cols(1, parameters.n_cols - 1) =
-      inner * data.t() / data.n_cols +
-      lambda * parameters.cols(1, parameters.n_cols - 1);
-  }
-  else
-  {
-    gradient = (probabilities - groundTruth) * data.t() / data.n_cols +
-               lambda * parameters;
-  }
+  LikelihoodGradient(probabilities - groundTruth, data, gradient);
+  gradient /= data.n_cols;
+  gradient += lambda * parameters;
+}
+
+/**
+ * Evaluates the objective function and calculates the gradient values given a
+ * set of parameters.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunctionType<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  // The class probabilities are shared between the objective and the
+  // gradient; see Evaluate() and Gradient() for the details of each.
+  arma::mat probabilities;
+  GetProbabilitiesMatrix(parameters, probabilities);
+
+  const double logLikelihood = arma::accu(groundTruth %
+      arma::log(probabilities)) / data.n_cols;
+  const double weightDecay = 0.5 * lambda * arma::accu(parameters %
+      parameters);
+
+  LikelihoodGradient(probabilities - groundTruth, data, gradient);
+  gradient /= data.n_cols;
+  gradient += lambda * parameters;
+
+  return -logLikelihood + weightDecay;
+}
+
+/**
+ * Evaluates the separable objective functions of a batch of points.  Unlike
+ * Evaluate(parameters), the log likelihood is not divided by the number of
+ * points, and each point has its own regularization term.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunctionType<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize) const
+{
+  const size_t end = begin + batchSize - 1;
+  const MatType points = data.cols(begin, end);
+  const arma::sp_mat truth = groundTruth.cols(begin, end);
+
+  arma::mat probabilities;
+  Probabilities(parameters, points, probabilities);
+
+  const double logLikelihood = arma::accu(truth % arma::log(probabilities));
+  const double weightDecay = 0.5 * lambda * arma::accu(parameters %
+      parameters);
+
+  return -logLikelihood + batchSize * weightDecay;
 }
 
-void SoftmaxRegressionFunction::PartialGradient(const arma::mat& parameters,
-                                                const size_t j,
-                                                arma::sp_mat& gradient) const
+/**
+ * Calculates the sum of the gradients of the separable objective functions
+ * of a batch of points.
+ */
+template<typename MatType>
+void SoftmaxRegressionFunctionType<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  const size_t end = begin + batchSize - 1;
+  const MatType points = data.cols(begin, end);
+  const arma::sp_mat truth = groundTruth.cols(begin, end);
+
+  arma::mat probabilities;
+  Probabilities(parameters, points, probabilities);
+
+  LikelihoodGradient(probabilities - truth, points, gradient);
+  gradient += (batchSize * lambda) * parameters;
+}
+
+/**
+ * Evaluates the separable objective functions of a batch of points and the
+ * sum of their gradients.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunctionType<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  const size_t end = begin + batchSize - 1;
+  const MatType points = data.cols(begin, end);
+  const arma::sp_mat truth = groundTruth.cols(begin, end);
+
+  arma::mat probabilities;
+  Probabilities(parameters, points, probabilities);
+
+  const double logLikelihood = arma::accu(truth % arma::log(probabilities));
+  const double weightDecay = 0.5 * lambda * arma::accu(parameters %
+      parameters);
+
+  LikelihoodGradient(probabilities - truth, points, gradient);
+  gradient += (batchSize * lambda) * parameters;
+
+  return -logLikelihood + batchSize * weightDecay;
+}
+
+template<typename MatType>
+void SoftmaxRegressionFunctionType<MatType>::PartialGradient(
+    const arma::mat& parameters,
+    const size_t j,
+    arma::sp_mat& gradient) const
 {
   gradient.zeros(arma::size(parameters));
 
@@ -237,3 +370,8 @@ void SoftmaxRegressionFunction::PartialGradient(const arma::mat& parameters,
         parameters.col(j);
   }
 }
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
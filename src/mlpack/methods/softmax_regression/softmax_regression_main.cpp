@@ -14,6 +14,7 @@
 
 #include <mlpack/methods/softmax_regression/softmax_regression.hpp>
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 
 #include <memory>
 #include <set>
@@ -40,6 +41,15 @@ PROGRAM_INFO("Softmax Regression", "This program performs softmax regression, "
     " parameter and if an intercept term is not desired in the model, the " +
     PRINT_PARAM_STRING("no_intercept") + " parameter can be specified."
     "\n\n"
+    "The model is trained with the L-BFGS optimizer by default; mini-batch SGD "
+    "can be used instead, for large datasets, by setting the " +
+    PRINT_PARAM_STRING("optimizer") + " parameter to 'minibatch-sgd'.  Then "
+    "the step size and the batch size are given with the " +
+    PRINT_PARAM_STRING("step_size") + " and " +
+    PRINT_PARAM_STRING("batch_size") + " parameters, and " +
+    PRINT_PARAM_STRING("max_iterations") + " is the maximum number of passes "
+    "over the training set."
+    "\n\n"
     "The trained model can be saved with the " +
     PRINT_PARAM_STRING("output_model") + " output parameter. If training is not"
     " desired, but only testing is, a model can be loaded with the " +
@@ -102,6 +112,13 @@ PARAM_DOUBLE_IN("lambda", "L2-regularization constant", "r", 0.0001);
 
 PARAM_FLAG("no_intercept", "Do not add the intercept term to the model.", "N");
 
+PARAM_STRING_IN("optimizer", "Optimizer to use for training ('lbfgs' or "
+    "'minibatch-sgd').", "O", "lbfgs");
+PARAM_DOUBLE_IN("step_size", "Step size for the mini-batch SGD optimizer.",
+    "s", 0.01);
+PARAM_INT_IN("batch_size", "Batch size for the mini-batch SGD optimizer.", "b",
+    256);
+
 // Count the number of classes in the given labels (if numClasses == 0).
 size_t CalculateNumberOfClasses(const size_t numClasses,
                                 const arma::Row<size_t>& trainLabels);
@@ -132,6 +149,25 @@ void mlpackMain()
     Log::Fatal << "Invalid value for maximum iterations (" << maxIterations
         << ")! Must be greater than or equal to 0." << endl;
 
+  const string optimizerType = CLI::GetParam<string>("optimizer");
+  if (optimizerType != "lbfgs" && optimizerType != "minibatch-sgd")
+    Log::Fatal << "--optimizer must be 'lbfgs' or 'minibatch-sgd'." << endl;
+
+  if (optimizerType == "minibatch-sgd")
+  {
+    if (CLI::GetParam<double>("step_size") <= 0.0)
+      Log::Fatal << "Step size (--step_size) must be positive (received "
+          << CLI::GetParam<double>("step_size") << ")." << endl;
+    if (CLI::GetParam<int>("batch_size") <= 0)
+      Log::Fatal << "Batch size (--batch_size) must be positive (received "
+          << CLI::GetParam<int>("batch_size") << ")." << endl;
+  }
+  else if (CLI::HasParam("step_size") || CLI::HasParam("batch_size"))
+  {
+    Log::Warn << "--step_size and --batch_size are ignored because the "
+        << "'minibatch-sgd' optimizer is not being used." << endl;
+  }
+
   // Make sure we have an output file of some sort.
   if (!CLI::HasParam("output_model") && !CLI::HasParam("predictions"))
     Log::Warn << "Neither --output_model_file nor --predictions_file are set; "
@@ -262,10 +298,27 @@ unique_ptr<Model> TrainSoftmax(const size_t maxIterations)
 
     const bool intercept = CLI::HasParam("no_intercept") ? false : true;
 
-    const size_t numBasis = 5;
-    optimization::L_BFGS optimizer(numBasis, maxIterations);
-    sm.reset(new Model(trainData, trainLabels, numClasses,
-        CLI::GetParam<double>("lambda"), intercept, std::move(optimizer)));
+    if (CLI::GetParam<string>("optimizer") == "minibatch-sgd")
+    {
+      // Each iteration of mini-batch SGD is one batch, so the maximum number of
+      // passes is turned into a number of batches.
+      const size_t batchSize = std::min(
+          (size_t) CLI::GetParam<int>("batch_size"), (size_t) trainData.n_cols);
+      const size_t numBatches = (trainData.n_cols + batchSize - 1) / batchSize;
+      optimization::MiniBatchSGD optimizer(batchSize,
+          CLI::GetParam<double>("step_size"), maxIterations * numBatches);
+      Log::Info << "Training model with mini-batch SGD optimizer (batch size "
+          << batchSize << ")." << endl;
+      sm.reset(new Model(trainData, trainLabels, numClasses,
+          CLI::GetParam<double>("lambda"), intercept, std::move(optimizer)));
+    }
+    else
+    {
+      const size_t numBasis = 5;
+      optimization::L_BFGS optimizer(numBasis, maxIterations);
+      sm.reset(new Model(trainData, trainLabels, numClasses,
+          CLI::GetParam<double>("lambda"), intercept, std::move(optimizer)));
+    }
   }
 
   return sm;
@@ -57,7 +57,12 @@ namespace nn {
  * @endcode
  *
  * This implementation allows the use of arbitrary mlpack optimizers via the
- * OptimizerType template parameter.
+ * OptimizerType template parameter.  Since SparseAutoencoderFunction is
+ * separable, optimizers like SGD, mini-batch SGD and Adam can be used too:
+ *
+ * @code
+ * SparseAutoencoder encoder3(data, vSize, hSize, 0.0001, 3, 0.01, Adam());
+ * @endcode
  *
  */
 class SparseAutoencoder
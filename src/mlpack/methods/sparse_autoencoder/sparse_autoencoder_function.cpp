@@ -15,18 +15,21 @@ using namespace mlpack;
 using namespace mlpack::nn;
 using namespace std;
 
-SparseAutoencoderFunction::SparseAutoencoderFunction(const arma::mat& data,
-                                                     const size_t visibleSize,
-                                                     const size_t hiddenSize,
-                                                     const double lambda,
-                                                     const double beta,
-                                                     const double rho) :
+SparseAutoencoderFunction::SparseAutoencoderFunction(
+    const arma::mat& data,
+    const size_t visibleSize,
+    const size_t hiddenSize,
+    const double lambda,
+    const double beta,
+    const double rho,
+    const double activationDecay) :
     data(data),
     visibleSize(visibleSize),
     hiddenSize(hiddenSize),
     lambda(lambda),
     beta(beta),
-    rho(rho)
+    rho(rho),
+    activationDecay(activationDecay)
 {
   // Initialize the parameters to suitable values.
   initialPoint = InitializeWeights();
@@ -208,3 +211,102 @@ void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
   gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
   gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
 }
+
+void SparseAutoencoderFunction::Forward(const arma::mat& parameters,
+                                        const size_t begin,
+                                        const size_t batchSize,
+                                        arma::mat& hiddenLayer,
+                                        arma::mat& outputLayer) const
+{
+  // The same representations of w1, w2, b1 and b2 as in Evaluate() are used.
+  const size_t l1 = hiddenSize;
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
+
+  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) *
+      data.cols(begin, begin + batchSize - 1) +
+      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, batchSize),
+      hiddenLayer);
+
+  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
+      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, batchSize),
+      outputLayer);
+}
+
+double SparseAutoencoderFunction::Penalty(const arma::mat& parameters,
+                                          const arma::vec& rhoCap) const
+{
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
+
+  const double wL2SquaredNorm = arma::accu(
+      parameters.submat(0, 0, l3 - 1, l2 - 1) %
+      parameters.submat(0, 0, l3 - 1, l2 - 1));
+
+  return 0.5 * lambda * wL2SquaredNorm + beta * arma::accu(rho *
+      arma::log(rho / rhoCap) + (1 - rho) * arma::log((1 - rho) /
+      (1 - rhoCap)));
+}
+
+double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters,
+                                           const size_t begin,
+                                           const size_t batchSize) const
+{
+  arma::mat hiddenLayer, outputLayer;
+  Forward(parameters, begin, batchSize, hiddenLayer, outputLayer);
+
+  const arma::vec rhoCap = (averageActivation.n_elem == hiddenSize) ?
+      averageActivation : arma::vec(arma::mean(hiddenLayer, 1));
+
+  const arma::mat diff = outputLayer - data.cols(begin, begin + batchSize - 1);
+
+  return 0.5 * arma::accu(diff % diff) + batchSize *
+      Penalty(parameters, rhoCap);
+}
+
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  const size_t l1 = hiddenSize;
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
+
+  arma::mat hiddenLayer, outputLayer;
+  Forward(parameters, begin, batchSize, hiddenLayer, outputLayer);
+
+  // Update the running estimate of the average activations; the first batch
+  // initializes it.
+  const arma::vec batchActivation = arma::mean(hiddenLayer, 1);
+  if (averageActivation.n_elem != hiddenSize)
+    averageActivation = batchActivation;
+  else
+    averageActivation = activationDecay * averageActivation +
+        (1 - activationDecay) * batchActivation;
+
+  const arma::mat batch = data.cols(begin, begin + batchSize - 1);
+  const arma::mat diff = outputLayer - batch;
+
+  // These are the deltas of Gradient(), where the estimate takes the place of
+  // the average activations over the dataset; the gradients are summed over
+  // the points instead of averaged.
+  const arma::vec klDivGrad = beta * (-(rho / averageActivation) +
+      (1 - rho) / (1 - averageActivation));
+  const arma::mat delOut = diff % outputLayer % (1 - outputLayer);
+  arma::mat delHid = parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut;
+  delHid.each_col() += klDivGrad;
+  delHid %= hiddenLayer % (1 - hiddenLayer);
+
+  gradient.zeros(2 * hiddenSize + 1, visibleSize + 1);
+  gradient.submat(0, 0, l1 - 1, l2 - 1) = delHid * batch.t() +
+      batchSize * lambda * parameters.submat(0, 0, l1 - 1, l2 - 1);
+  gradient.submat(l1, 0, l3 - 1, l2 - 1) = (delOut * hiddenLayer.t()).t() +
+      batchSize * lambda * parameters.submat(l1, 0, l3 - 1, l2 - 1);
+  gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1);
+  gradient.submat(l3, 0, l3, l2 - 1) = arma::sum(delOut, 1).t();
+
+  return 0.5 * arma::accu(diff % diff) + batchSize *
+      Penalty(parameters, averageActivation);
+}
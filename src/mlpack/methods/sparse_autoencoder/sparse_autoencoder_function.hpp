@@ -22,6 +22,17 @@ namespace nn {
  * This is a class for the sparse autoencoder objective function. It can be used
  * to create learning models like self-taught learning, stacked autoencoders,
  * conditional random fields (CRFs), and so forth.
+ *
+ * The function can be optimized over the whole dataset (for instance with
+ * L-BFGS), and it is also separable over the points, for optimizers of
+ * separable functions such as SGD, mini-batch SGD and Adam.  The separable
+ * function of point i is its squared reconstruction error plus the weight
+ * decay and KL divergence terms, so the sum over all the points is
+ * NumFunctions() times the objective given by Evaluate(parameters).  The KL
+ * divergence depends on the average activation of the hidden units over all
+ * the points, so the separable functions use a running estimate of it instead:
+ * an exponential moving average of the average activations of the batches,
+ * which is updated each time the gradient of a batch is computed.
  */
 class SparseAutoencoderFunction
 {
@@ -36,13 +47,16 @@ class SparseAutoencoderFunction
    * @param lambda L2-regularization parameter.
    * @param beta KL divergence parameter.
    * @param rho Sparsity parameter.
+   * @param activationDecay Weight of the previous running estimate of the
+   *     average activations when it is updated with a batch.
    */
   SparseAutoencoderFunction(const arma::mat& data,
                             const size_t visibleSize,
                             const size_t hiddenSize,
                             const double lambda = 0.0001,
                             const double beta = 3,
-                            const double rho = 0.01);
+                            const double rho = 0.01,
+                            const double activationDecay = 0.99);
 
   //! Initializes the parameters of the model to suitable values.
   const arma::mat InitializeWeights();
@@ -70,6 +84,110 @@ class SparseAutoencoderFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluate the separable objective function of the given point (see the
+   * class documentation).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i) const
+  { return Evaluate(parameters, i, 1); }
+
+  /**
+   * Evaluate the sum of the separable objective functions of the points
+   * [begin, begin + batchSize).  The running estimate of the average
+   * activations is not updated (if there is none yet, the average activations
+   * of the batch are used).
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
+  /**
+   * Compute the gradient of the separable objective function of the given
+   * point, after updating the running estimate of the average activations.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient) const
+  { Gradient(parameters, i, gradient, 1); }
+
+  /**
+   * Compute the sum of the gradients of the separable objective functions of
+   * the points [begin, begin + batchSize), after updating the running
+   * estimate of the average activations with the batch.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const
+  { EvaluateWithGradient(parameters, begin, gradient, batchSize); }
+
+  /**
+   * Evaluate the separable objective function of the given point and its
+   * gradient, after updating the running estimate of the average activations.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t i,
+                              arma::mat& gradient) const
+  { return EvaluateWithGradient(parameters, i, gradient, 1); }
+
+  /**
+   * Evaluate the sum of the separable objective functions of the points
+   * [begin, begin + batchSize) and the sum of their gradients, with a single
+   * feedforward pass, after updating the running estimate of the average
+   * activations with the batch.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   * @return The sum of the objective functions.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize) const;
+
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return data.n_cols; }
+
+  //! Get the running estimate of the average activations of the hidden units
+  //! (empty before the first gradient of a batch).
+  const arma::vec& AverageActivation() const { return averageActivation; }
+  //! Forget the running estimate of the average activations.
+  void ResetAverageActivation() { averageActivation.reset(); }
+
+  //! Sets the decay of the running estimate of the average activations.
+  void ActivationDecay(const double decay)
+  {
+    this->activationDecay = decay;
+  }
+
+  //! Gets the decay of the running estimate of the average activations.
+  double ActivationDecay() const
+  {
+    return activationDecay;
+  }
+
   /**
    * Returns the elementwise sigmoid of the passed matrix, where the sigmoid
    * function of a real number 'x' is [1 / (1 + exp(-x))].
@@ -159,6 +277,25 @@ class SparseAutoencoderFunction
   double beta;
   //! Sparsity parameter.
   double rho;
+  //! Decay of the running estimate of the average activations.
+  double activationDecay;
+  //! Running estimate of the average activations, for the separable
+  //! functions; it is updated by the const gradient functions, like the
+  //! statistics of an optimizer.
+  mutable arma::vec averageActivation;
+
+  /**
+   * Compute the activations of the hidden and output layers for the points
+   * [begin, begin + batchSize).
+   */
+  void Forward(const arma::mat& parameters,
+               const size_t begin,
+               const size_t batchSize,
+               arma::mat& hiddenLayer,
+               arma::mat& outputLayer) const;
+
+  //! Compute the weight decay and KL divergence terms of one point.
+  double Penalty(const arma::mat& parameters, const arma::vec& rhoCap) const;
 };
 
 } // namespace nn
@@ -40,23 +40,14 @@ void SparseCoding::Encode(const arma::mat& data, arma::mat& codes)
   // lambda2 > 0.
   arma::mat matGram = trans(dictionary) * dictionary;
 
-  codes.set_size(atoms, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    // Report progress.
-    if ((i % 100) == 0)
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-
-    bool useCholesky = true;
-    regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
-
-    // Create an alias of the code (using the same memory), and then LARS will
-    // place the result directly into that; then we will not need to have an
-    // extra copy.
-    arma::vec code = codes.unsafe_col(i);
-    arma::rowvec responses = data.unsafe_col(i).t();
-    lars.Train(dictionary, responses, code, false);
-  }
+  // Each point is one set of responses for the dictionary, so all the points
+  // are coded with a single call: the correlations of all the points with the
+  // atoms are computed with one matrix product, and each point then only takes
+  // time that depends on the number of atoms.  LARS codes the points in
+  // parallel.
+  bool useCholesky = true;
+  regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
+  lars.Train(dictionary, data, codes, false);
 }
 
 // Dictionary step for optimization.
@@ -185,7 +185,8 @@ class SparseCoding
 
   /**
    * Sparse code each point in the given dataset via LARS, using the current
-   * dictionary and store the encoded data in the codes matrix.
+   * dictionary and store the encoded data in the codes matrix.  The points are
+   * coded in parallel with OpenMP, sharing the Gram matrix of the dictionary.
    *
    * @param data Input data matrix to be encoded.
    * @param codes Output codes matrix.
@@ -105,6 +105,9 @@ or upgrade Boost to 1.59 or newer.
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/timers.hpp>
 
+// Parallel regions get their number of threads from ParallelThreads().
+#include <mlpack/core/util/parallel.hpp>
+
 // On Visual Studio, disable C4519 (default arguments for function templates)
 // since it's by default an error, which doesn't even make any sense because
 // it's part of the C++11 standard.
@@ -180,4 +180,58 @@ BOOST_AUTO_TEST_CASE(AdaMaxLogisticRegressionTest)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
 
+/**
+ * Check the lazy sparse Adam update: coordinates that are touched take the
+ * same steps as in the dense update, and coordinates that are not touched do
+ * not move.
+ */
+BOOST_AUTO_TEST_CASE(AdamSparseUpdateTest)
+{
+  AdamUpdate dense, sparse;
+  dense.Initialize(3, 1);
+  sparse.Initialize(3, 1);
+
+  arma::mat denseIterate("1.0; 2.0; 3.0");
+  arma::mat sparseIterate(denseIterate);
+
+  // The first two coordinates are touched in every step, the last one only in
+  // the third step.  As long as the moments of the last coordinate are zero,
+  // the dense update leaves it alone too.
+  for (size_t i = 0; i < 3; ++i)
+  {
+    arma::sp_mat gradient(3, 1);
+    gradient(0, 0) = 0.5 + i;
+    gradient(1, 0) = -1.0;
+    if (i == 2)
+      gradient(2, 0) = 2.0;
+
+    dense.Update(denseIterate, 0.01, arma::mat(gradient));
+    sparse.Update(sparseIterate, 0.01, gradient);
+  }
+
+  CheckMatrices(denseIterate, sparseIterate);
+
+  // Now the dense update moves the last coordinate with its moment, but the
+  // lazy update does not.
+  arma::sp_mat gradient(3, 1);
+  gradient(0, 0) = 1.0;
+  dense.Update(denseIterate, 0.01, arma::mat(gradient));
+  sparse.Update(sparseIterate, 0.01, gradient);
+
+  BOOST_REQUIRE_CLOSE(sparseIterate(0, 0), denseIterate(0, 0), 1e-5);
+  BOOST_REQUIRE_NE(denseIterate(2, 0), sparseIterate(2, 0));
+
+  // After the catch-up, the next step of the last coordinate uses the same
+  // moments as the dense update.
+  arma::mat before(sparseIterate);
+  arma::mat denseBefore(denseIterate);
+  gradient.zeros();
+  gradient(2, 0) = 1.0;
+  dense.Update(denseIterate, 0.01, arma::mat(gradient));
+  sparse.Update(sparseIterate, 0.01, gradient);
+
+  BOOST_REQUIRE_CLOSE(sparseIterate(2, 0) - before(2, 0),
+      denseIterate(2, 0) - denseBefore(2, 0), 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
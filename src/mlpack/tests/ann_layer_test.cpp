@@ -13,6 +13,7 @@
 
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/activation_functions/softplus_function.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
 #include <mlpack/methods/ann/init_rules/const_init.hpp>
 #include <mlpack/methods/ann/init_rules/nguyen_widrow_init.hpp>
@@ -22,6 +23,10 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::ann;
 
@@ -403,6 +408,139 @@ BOOST_AUTO_TEST_CASE(NoDropoutTest)
   BOOST_REQUIRE_EQUAL(arma::accu(output), arma::accu(input));
 }
 
+/**
+ * Make sure that the backward pass of the dropout layer uses the same mask as
+ * the forward pass, and that the mask does not depend on the number of
+ * threads.
+ */
+BOOST_AUTO_TEST_CASE(DropoutMaskTest)
+{
+  arma::mat input = arma::randu<arma::mat>(100, 1001) + 1.0;
+  Dropout<> module(0.3);
+  module.Deterministic() = false;
+
+  arma::mat output, delta;
+  module.Forward(std::move(input), std::move(output));
+  module.Backward(std::move(input), std::move(input), std::move(delta));
+  CheckMatrices(output, delta);
+
+  // About 30% of the elements are dropped.
+  const double dropped = (double) (input.n_elem -
+      arma::uvec(arma::find(output)).n_elem) / input.n_elem;
+  BOOST_REQUIRE_CLOSE(dropped, 0.3, 5.0);
+
+  DropoutMask mask;
+  mask.Reset(0.3);
+  arma::mat masked;
+  mask.Apply(input, masked, 2.0);
+  for (size_t i = 0; i < input.n_elem; i += 97)
+  {
+    if (mask.Keep(i))
+      BOOST_REQUIRE_CLOSE(masked[i], 2.0 * input[i], 1e-10);
+    else
+      BOOST_REQUIRE_EQUAL(masked[i], 0.0);
+  }
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    arma::mat serialMasked;
+    mask.Apply(input, serialMasked, 2.0);
+    omp_set_num_threads(oldThreads);
+    CheckMatrices(serialMasked, masked);
+  #endif
+
+  // Masking in place gives the same result.
+  arma::mat inPlace = input;
+  mask.Apply(inPlace, inPlace, 2.0);
+  CheckMatrices(inPlace, masked);
+}
+
+/**
+ * Get the largest relative error of the approximation of the given activation
+ * function to the given exact values, with the given accuracy.
+ */
+template<typename FunctionType>
+double ActivationError(const arma::mat& input,
+                       const arma::mat& exact,
+                       const ActivationAccuracy accuracy)
+{
+  arma::mat approximation;
+  {
+    ActivationAccuracyScope scope(accuracy);
+    FunctionType::Fn(input, approximation);
+  }
+
+  return arma::max(arma::vectorise(arma::abs(approximation - exact) /
+      arma::abs(exact)));
+}
+
+/**
+ * Make sure that the approximations of the activation functions stay within
+ * their error bounds, for large and small inputs, and that adding the bias
+ * while the activation function is applied gives the same result.
+ */
+BOOST_AUTO_TEST_CASE(FastActivationsTest)
+{
+  arma::mat input = 40.0 * arma::randu<arma::mat>(50, 400) - 20.0;
+  input.cols(0, 99) *= 0.001;
+  input(0, 0) = 700.0;
+  input(1, 0) = -700.0;
+
+  const arma::mat exactLogistic = 1.0 / (1.0 + arma::exp(-input));
+  const arma::mat exactTanh = arma::tanh(input);
+
+  // Without a scope, the exact functions are used.
+  arma::mat output;
+  LogisticFunction::Fn(input, output);
+  CheckMatrices(output, exactLogistic);
+
+  // SoftplusFunction loses accuracy for negative inputs, so the reference
+  // values are computed with log1p().
+  arma::mat exactSoftplus = input;
+  exactSoftplus.transform([](const double x)
+      { return std::max(x, 0.0) + std::log1p(std::exp(-std::fabs(x))); });
+
+  BOOST_REQUIRE_LE(ActivationError<LogisticFunction>(input, exactLogistic,
+      TRAINING_ACTIVATIONS), 2e-15);
+  BOOST_REQUIRE_LE(ActivationError<TanhFunction>(input, exactTanh,
+      TRAINING_ACTIVATIONS), 2e-15);
+  BOOST_REQUIRE_LE(ActivationError<SoftplusFunction>(input, exactSoftplus,
+      TRAINING_ACTIVATIONS), 2e-15);
+
+  BOOST_REQUIRE_LE(ActivationError<LogisticFunction>(input, exactLogistic,
+      INFERENCE_ACTIVATIONS), 1e-6);
+  BOOST_REQUIRE_LE(ActivationError<TanhFunction>(input, exactTanh,
+      INFERENCE_ACTIVATIONS), 1e-6);
+  BOOST_REQUIRE_LE(ActivationError<SoftplusFunction>(input, exactSoftplus,
+      INFERENCE_ACTIVATIONS), 1e-6);
+
+  // The log softmax layer uses the approximation of exp().
+  arma::mat softmaxInput = input.cols(100, 199);
+  arma::mat shifted = softmaxInput.each_row() - arma::max(softmaxInput);
+  arma::mat exactSoftmax = shifted.each_row() -
+      arma::log(arma::sum(arma::exp(shifted)));
+  arma::mat fastSoftmax;
+  {
+    ActivationAccuracyScope scope(TRAINING_ACTIVATIONS);
+    LogSoftMax<> module;
+    module.Forward(std::move(softmaxInput), std::move(fastSoftmax));
+  }
+  BOOST_REQUIRE_SMALL(arma::abs(fastSoftmax - exactSoftmax).max(), 1e-12);
+
+  // The bias is added to each column.
+  arma::vec bias = arma::randn<arma::vec>(input.n_rows);
+  arma::mat fused, separate = input;
+  FastActivation<FastTanh>(input, fused, INFERENCE_ACTIVATIONS, &bias);
+  separate.each_col() += bias;
+  FastActivation<FastTanh>(separate, separate, INFERENCE_ACTIVATIONS);
+  CheckMatrices(fused, separate);
+
+  arma::vec wrongBias(input.n_rows + 1);
+  BOOST_REQUIRE_THROW(FastActivation<FastTanh>(input, fused,
+      INFERENCE_ACTIVATIONS, &wrongBias), std::invalid_argument);
+}
+
 /**
  * Simple linear module test.
  */
@@ -779,6 +917,109 @@ BOOST_AUTO_TEST_CASE(GradientLSTMLayerTest)
   BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
 }
 
+/**
+ * FastLSTM layer numerically gradient test.
+ */
+BOOST_AUTO_TEST_CASE(GradientFastLSTMLayerTest)
+{
+  // FastLSTM function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 1);
+      target = arma::mat("1; 1; 1; 1; 1");
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<FastLSTM<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      arma::mat output;
+      double error = model->Evaluate(model->Parameters(), 0);
+      model->Gradient(model->Parameters(), 0, gradient);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * Make sure that the FastLSTM layer computes the same objective and gradient
+ * as the LSTM layer, given the same weights, also for a batch of sequences.
+ */
+BOOST_AUTO_TEST_CASE(FastLSTMLayerTest)
+{
+  const size_t rho = 5;
+  arma::mat input = arma::randu(2 * rho, 6);
+  arma::mat target = arma::randu(3 * rho, 6);
+
+  RNN<MeanSquaredError<> > model(input, target, rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(2, 10);
+  model.Add<LSTM<> >(10, 3, rho);
+  model.Add<SigmoidLayer<> >();
+
+  RNN<MeanSquaredError<> > fastModel(input, target, rho);
+  fastModel.Add<IdentityLayer<> >();
+  fastModel.Add<Linear<> >(2, 10);
+  fastModel.Add<FastLSTM<> >(10, 3, rho);
+  fastModel.Add<SigmoidLayer<> >();
+
+  model.Evaluate(model.Parameters(), 0);
+  fastModel.Evaluate(fastModel.Parameters(), 0);
+  BOOST_REQUIRE_EQUAL(model.Parameters().n_elem,
+      fastModel.Parameters().n_elem);
+
+  // The LSTM layer stores the input weights, the bias and the recurrent
+  // weights; the FastLSTM layer stores the input and the recurrent weights
+  // (one stacked matrix), then the bias.
+  const size_t linear = 2 * 10 + 10;
+  const size_t inputWeights = 4 * 3 * 10;
+  const size_t recurrentWeights = 4 * 3 * 3;
+  const size_t biases = 4 * 3;
+
+  arma::uvec order(model.Parameters().n_elem);
+  for (size_t i = 0; i < linear + inputWeights; ++i)
+    order[i] = i;
+  for (size_t i = 0; i < recurrentWeights; ++i)
+    order[linear + inputWeights + i] = linear + inputWeights + biases + i;
+  for (size_t i = 0; i < biases; ++i)
+  {
+    order[linear + inputWeights + recurrentWeights + i] =
+        linear + inputWeights + i;
+  }
+
+  fastModel.Parameters() = model.Parameters().rows(order);
+
+  for (size_t i = 0; i < input.n_cols; i += 3)
+  {
+    BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), i, size_t(3)),
+        fastModel.Evaluate(fastModel.Parameters(), i, size_t(3)), 1e-5);
+
+    arma::mat gradient, fastGradient;
+    model.Gradient(model.Parameters(), i, gradient, 3);
+    fastModel.Gradient(fastModel.Parameters(), i, fastGradient, 3);
+    CheckMatrices(gradient.rows(order), fastGradient);
+  }
+}
+
 /**
  * Check if the gradients computed by GRU cell are close enough to the
  * approximation of the gradients.
@@ -1002,6 +1243,38 @@ BOOST_AUTO_TEST_CASE(SimpleLookupLayerTest)
   BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-3);
 }
 
+/**
+ * Make sure that the sparse gradient of the lookup module only holds the
+ * columns that were looked up, and adds up the errors of repeated indices.
+ */
+BOOST_AUTO_TEST_CASE(LookupSparseGradientTest)
+{
+  Lookup<> module(10, 4);
+  module.Parameters().randu();
+
+  arma::mat input("7; 2; 7");
+  arma::mat error = arma::randu<arma::mat>(4, 3);
+
+  module.SparseGradient(std::move(input), std::move(error));
+
+  BOOST_REQUIRE_EQUAL(module.GradientColumns().n_elem, 2);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns()[0], 1);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns()[1], 6);
+  CheckMatrices(module.GradientValues().col(0), error.col(1));
+  CheckMatrices(module.GradientValues().col(1), error.col(0) + error.col(2));
+
+  // The dense gradient holds the same columns, and zeros elsewhere.
+  arma::mat gradient;
+  module.Gradient(std::move(input), std::move(error), std::move(gradient));
+
+  BOOST_REQUIRE_EQUAL(gradient.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(gradient.n_cols, 10);
+  CheckMatrices(gradient.col(1), error.col(1));
+  CheckMatrices(gradient.col(6), error.col(0) + error.col(2));
+  BOOST_REQUIRE_SMALL(arma::accu(arma::abs(gradient)) -
+      arma::accu(arma::abs(module.GradientValues())), 1e-10);
+}
+
 /**
  * Simple LogSoftMax module test.
  */
@@ -1104,4 +1377,161 @@ BOOST_AUTO_TEST_CASE(SimpleMeanSquaredErrorLayerTest)
 }
 
 
+/**
+ * Once their outputs and deltas have the right size, the Convolution,
+ * MaxPooling and MeanPooling layers must write into them in place instead of
+ * replacing them with newly allocated matrices.
+ */
+BOOST_AUTO_TEST_CASE(ImageLayerInPlaceTest)
+{
+  Convolution<> convolution(2, 3, 3, 3, 1, 1, 1, 1, 6, 6);
+  convolution.Parameters().randu();
+  convolution.Reset();
+
+  MaxPooling<> maxPooling(2, 2, 2, 2);
+  maxPooling.InputWidth() = 6;
+  maxPooling.InputHeight() = 6;
+
+  MeanPooling<> meanPooling(2, 2, 2, 2);
+  meanPooling.InputWidth() = 6;
+  meanPooling.InputHeight() = 6;
+
+  arma::mat input = arma::randu(6 * 6 * 2, 1);
+  arma::mat convOutput, maxOutput, meanOutput;
+  arma::mat convDelta, maxDelta, meanDelta;
+  const double* convOutputPtr = NULL;
+  const double* maxOutputPtr = NULL;
+  const double* meanOutputPtr = NULL;
+  const double* convDeltaPtr = NULL;
+  const double* maxDeltaPtr = NULL;
+  const double* meanDeltaPtr = NULL;
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    input.randu();
+    convolution.Forward(std::move(input), std::move(convOutput));
+    maxPooling.Forward(std::move(input), std::move(maxOutput));
+    meanPooling.Forward(std::move(input), std::move(meanOutput));
+
+    arma::mat convError = arma::randu(convOutput.n_rows, 1);
+    arma::mat maxError = arma::randu(maxOutput.n_rows, 1);
+    arma::mat meanError = arma::randu(meanOutput.n_rows, 1);
+    convolution.Backward(std::move(input), std::move(convError),
+        std::move(convDelta));
+    maxPooling.Backward(std::move(input), std::move(maxError),
+        std::move(maxDelta));
+    meanPooling.Backward(std::move(input), std::move(meanError),
+        std::move(meanDelta));
+
+    BOOST_REQUIRE_EQUAL(convDelta.n_elem, input.n_elem);
+    BOOST_REQUIRE_EQUAL(maxDelta.n_elem, input.n_elem);
+    BOOST_REQUIRE_EQUAL(meanDelta.n_elem, input.n_elem);
+
+    if (i > 0)
+    {
+      BOOST_REQUIRE_EQUAL(convOutput.memptr(), convOutputPtr);
+      BOOST_REQUIRE_EQUAL(maxOutput.memptr(), maxOutputPtr);
+      BOOST_REQUIRE_EQUAL(meanOutput.memptr(), meanOutputPtr);
+      BOOST_REQUIRE_EQUAL(convDelta.memptr(), convDeltaPtr);
+      BOOST_REQUIRE_EQUAL(maxDelta.memptr(), maxDeltaPtr);
+      BOOST_REQUIRE_EQUAL(meanDelta.memptr(), meanDeltaPtr);
+    }
+
+    convOutputPtr = convOutput.memptr();
+    maxOutputPtr = maxOutput.memptr();
+    meanOutputPtr = meanOutput.memptr();
+    convDeltaPtr = convDelta.memptr();
+    maxDeltaPtr = maxDelta.memptr();
+    meanDeltaPtr = meanDelta.memptr();
+  }
+}
+
+/**
+ * Pass the given input forward and an error of ones backward through a double
+ * precision layer and its single precision twin, and make sure both give the
+ * same results.
+ */
+template<typename LayerType, typename FloatLayerType>
+void CheckSinglePrecisionLayer(LayerType& layer,
+                               FloatLayerType& floatLayer,
+                               const arma::mat& input)
+{
+  arma::fmat floatInput = arma::conv_to<arma::fmat>::from(input);
+  arma::mat output, delta;
+  arma::fmat floatOutput, floatDelta;
+
+  layer.Forward(std::move(input), std::move(output));
+  floatLayer.Forward(std::move(floatInput), std::move(floatOutput));
+  CheckMatrices(output, arma::conv_to<arma::mat>::from(floatOutput), 1e-2);
+
+  arma::mat error = arma::ones(output.n_rows, output.n_cols);
+  arma::fmat floatError = arma::ones<arma::fmat>(output.n_rows,
+      output.n_cols);
+  layer.Backward(std::move(output), std::move(error), std::move(delta));
+  floatLayer.Backward(std::move(floatOutput), std::move(floatError),
+      std::move(floatDelta));
+  CheckMatrices(delta, arma::conv_to<arma::mat>::from(floatDelta), 1e-2);
+}
+
+/**
+ * Make sure the feedforward layers give the same results in single precision
+ * as in double precision.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionLayerTest)
+{
+  arma::mat input = arma::randu(36, 1);
+  arma::fmat floatInput = arma::conv_to<arma::fmat>::from(input);
+
+  Linear<> linear(36, 10);
+  Linear<arma::fmat, arma::fmat> floatLinear(36, 10);
+  linear.Parameters().randu();
+  floatLinear.Parameters() = arma::conv_to<arma::fmat>::from(
+      linear.Parameters());
+  linear.Reset();
+  floatLinear.Reset();
+  CheckSinglePrecisionLayer(linear, floatLinear, input);
+
+  // The gradients of the parameters must match too.
+  arma::mat error = arma::ones(10, 1);
+  arma::fmat floatError = arma::ones<arma::fmat>(10, 1);
+  arma::mat gradient(linear.Parameters().n_elem, 1);
+  arma::fmat floatGradient(linear.Parameters().n_elem, 1);
+  linear.Gradient(std::move(input), std::move(error), std::move(gradient));
+  floatLinear.Gradient(std::move(floatInput), std::move(floatError),
+      std::move(floatGradient));
+  CheckMatrices(gradient, arma::conv_to<arma::mat>::from(floatGradient),
+      1e-2);
+
+  Convolution<> convolution(1, 2, 3, 3, 1, 1, 1, 1, 6, 6);
+  Convolution<NaiveConvolution<ValidConvolution>,
+      NaiveConvolution<FullConvolution>, NaiveConvolution<ValidConvolution>,
+      arma::fmat, arma::fmat> floatConvolution(1, 2, 3, 3, 1, 1, 1, 1, 6, 6);
+  convolution.Parameters().randu();
+  floatConvolution.Parameters() = arma::conv_to<arma::fmat>::from(
+      convolution.Parameters());
+  convolution.Reset();
+  floatConvolution.Reset();
+  CheckSinglePrecisionLayer(convolution, floatConvolution, input);
+
+  MaxPooling<> maxPooling(2, 2, 2, 2);
+  MaxPooling<arma::fmat, arma::fmat> floatMaxPooling(2, 2, 2, 2);
+  maxPooling.InputWidth() = floatMaxPooling.InputWidth() = 6;
+  maxPooling.InputHeight() = floatMaxPooling.InputHeight() = 6;
+  CheckSinglePrecisionLayer(maxPooling, floatMaxPooling, input);
+
+  MeanPooling<> meanPooling(2, 2, 2, 2);
+  MeanPooling<arma::fmat, arma::fmat> floatMeanPooling(2, 2, 2, 2);
+  meanPooling.InputWidth() = floatMeanPooling.InputWidth() = 6;
+  meanPooling.InputHeight() = floatMeanPooling.InputHeight() = 6;
+  CheckSinglePrecisionLayer(meanPooling, floatMeanPooling, input);
+
+  SigmoidLayer<> sigmoid;
+  SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat> floatSigmoid;
+  CheckSinglePrecisionLayer(sigmoid, floatSigmoid, input);
+
+  LogSoftMax<> logSoftMax;
+  LogSoftMax<arma::fmat, arma::fmat> floatLogSoftMax;
+  CheckSinglePrecisionLayer(logSoftMax, floatLogSoftMax, input);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
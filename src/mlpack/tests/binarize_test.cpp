@@ -68,4 +68,23 @@ BOOST_AUTO_TEST_CASE(BinerizeAll)
   BOOST_REQUIRE_CLOSE(output(2, 2), 1.0, 1e-5); // 9
 }
 
+/**
+ * The in-place overloads give the same results as the others.
+ */
+BOOST_AUTO_TEST_CASE(BinarizeInPlace)
+{
+  mat input = randn<mat>(10, 500);
+
+  mat output;
+  Binarize<double>(input, output, 0.3);
+  mat data(input);
+  Binarize<double>(data, 0.3);
+  CheckMatrices(data, output);
+
+  Binarize<double>(input, output, 0.3, 4);
+  data = input;
+  Binarize<double>(data, 0.3, 4);
+  CheckMatrices(data, output);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -109,4 +109,28 @@ BOOST_AUTO_TEST_CASE(RandomizedBlockKrylovSVDNoisyLowRankTest)
   BOOST_REQUIRE_SMALL(error, 1e-2);
 }
 
+/**
+ * Make sure that the SVD computed over blocks of columns of the data is as
+ * accurate as the one computed with the whole matrix.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedBlockKrylovSVDBlocksTest)
+{
+  arma::mat data;
+  CreateNoisyLowRankMatrix(data, 200, 1000, 5, 0.5);
+
+  const size_t rank = 5;
+
+  arma::mat U1, U2, V1, V2;
+  arma::vec s1, s2;
+
+  arma::svd_econ(U1, s1, V1, data);
+
+  data::MatrixColumnBlocks<> blocks(data, 128);
+  svd::RandomizedBlockKrylovSVD rSVDB(10, 20);
+  rSVDB.ApplyBlocks(blocks, U2, s2, V2, rank);
+
+  double error = arma::max(arma::abs(s1.subvec(0, rank) - s2.subvec(0, rank)));
+  BOOST_REQUIRE_SMALL(error, 1e-2);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,7 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/cf/cf.hpp>
+#include <mlpack/methods/cf/cf_model.hpp>
 #include <iostream>
 
 #include <boost/test/unit_test.hpp>
@@ -325,6 +326,47 @@ BOOST_AUTO_TEST_CASE(CFBatchPredictTest)
   }
 }
 
+/**
+ * Make sure that the batch predictions are the same for any number of
+ * threads, when many combinations share a user, and when they are written to
+ * preallocated memory.
+ */
+BOOST_AUTO_TEST_CASE(CFBatchPredictGroupedTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF::CleanData(dataset, cleanedData);
+  CF c(cleanedData);
+
+  // Every item for a few users, in an interleaved order.
+  const size_t numItems = cleanedData.n_rows;
+  arma::Mat<size_t> combinations(2, 4 * numItems);
+  for (size_t i = 0; i < combinations.n_cols; ++i)
+  {
+    combinations(0, i) = 7 * (i % 4);
+    combinations(1, i) = i / 4;
+  }
+
+  arma::vec predictions, threadedPredictions;
+  c.Predict(combinations, predictions, 1);
+  c.Predict(combinations, threadedPredictions, 4);
+  std::vector<double> buffer(combinations.n_cols);
+  c.Predict(combinations, buffer.data());
+
+  for (size_t i = 0; i < combinations.n_cols; i += 37)
+  {
+    const double prediction = c.Predict(combinations(0, i), combinations(1, i));
+    BOOST_REQUIRE_CLOSE(prediction, predictions[i], 1e-8);
+  }
+  for (size_t i = 0; i < combinations.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], threadedPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], buffer[i]);
+  }
+}
+
 /**
  * Make sure we can train an already-trained model and it works okay.
  */
@@ -545,4 +587,370 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
 }
 
 
+/**
+ * Make sure the neighbor search index of the users is rebuilt when the model
+ * is retrained or loaded, so that the recommendations are the same as those
+ * of a freshly trained model.
+ */
+BOOST_AUTO_TEST_CASE(CFSimilarityIndexTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF::CleanData(dataset, cleanedData);
+
+  math::RandomSeed(42);
+  CF c(cleanedData);
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(5, recommendations);
+
+  // Repeated calls use the same index.
+  arma::Mat<size_t> repeatedRecommendations;
+  c.GetRecommendations(5, repeatedRecommendations);
+  CheckMatrices(recommendations, repeatedRecommendations);
+
+  // Retrain a model that was trained on other data.
+  arma::sp_mat randomData;
+  randomData.sprandu(100, 100, 0.3);
+  CF retrained(randomData);
+  arma::Mat<size_t> randomRecommendations;
+  retrained.GetRecommendations(5, randomRecommendations);
+
+  math::RandomSeed(42);
+  retrained.Train(cleanedData);
+  arma::Mat<size_t> retrainedRecommendations;
+  retrained.GetRecommendations(5, retrainedRecommendations);
+  CheckMatrices(recommendations, retrainedRecommendations);
+
+  // A loaded model has to give the same recommendations too.
+  CF cXml(randomData), cText(randomData), cBinary;
+  SerializeObjectAll(c, cXml, cText, cBinary);
+
+  arma::Mat<size_t> xmlRecommendations, textRecommendations,
+      binaryRecommendations;
+  cXml.GetRecommendations(5, xmlRecommendations);
+  cText.GetRecommendations(5, textRecommendations);
+  cBinary.GetRecommendations(5, binaryRecommendations);
+  CheckMatrices(recommendations, xmlRecommendations);
+  CheckMatrices(recommendations, textRecommendations);
+  CheckMatrices(recommendations, binaryRecommendations);
+
+  // The prediction of a single user uses the same neighbors as the batch
+  // prediction.
+  arma::Mat<size_t> combinations(2, 1);
+  combinations(0, 0) = 3;
+  combinations(1, 0) = 7;
+  arma::vec predictions;
+  c.Predict(combinations, predictions);
+  BOOST_REQUIRE_CLOSE(c.Predict(3, 7), predictions[0], 1e-5);
+}
+
+/**
+ * Make sure every type of neighbor search gives recommendations, that the
+ * exact searches agree, and that the type of search is kept by serialization.
+ */
+BOOST_AUTO_TEST_CASE(CFNeighborSearchTypesTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF::CleanData(dataset, cleanedData);
+
+  math::RandomSeed(42);
+  CF c(cleanedData);
+  BOOST_REQUIRE_EQUAL(c.NeighborSearchType(), CFNeighborSearch::KD_TREE_SEARCH);
+  arma::Mat<size_t> kdRecommendations;
+  c.GetRecommendations(5, kdRecommendations);
+
+  const CFNeighborSearch::SearchTypes types[] = {
+      CFNeighborSearch::COVER_TREE_SEARCH, CFNeighborSearch::SPILL_TREE_SEARCH,
+      CFNeighborSearch::LSH_SEARCH, CFNeighborSearch::RA_SEARCH };
+  for (size_t t = 0; t < 4; ++t)
+  {
+    c.NeighborSearchType(types[t]);
+    BOOST_REQUIRE_EQUAL(c.NeighborSearchType(), types[t]);
+
+    arma::Mat<size_t> recommendations;
+    c.GetRecommendations(5, recommendations);
+    BOOST_REQUIRE_EQUAL(recommendations.n_rows, 5);
+    BOOST_REQUIRE_EQUAL(recommendations.n_cols, cleanedData.n_cols);
+    for (size_t i = 0; i < recommendations.n_elem; ++i)
+      BOOST_REQUIRE_LE(recommendations[i], cleanedData.n_rows);
+
+    // The prediction is an average of the estimated ratings of the neighbors.
+    const double prediction = c.Predict(0, 0);
+    BOOST_REQUIRE(!std::isnan(prediction));
+
+    // Cover trees are exact, so the neighbors are the same.
+    if (types[t] == CFNeighborSearch::COVER_TREE_SEARCH)
+      CheckMatrices(kdRecommendations, recommendations);
+  }
+
+  // The last search type is kept by serialization and copies.
+  CF cXml, cText, cBinary;
+  SerializeObjectAll(c, cXml, cText, cBinary);
+  BOOST_REQUIRE_EQUAL(cXml.NeighborSearchType(), CFNeighborSearch::RA_SEARCH);
+  BOOST_REQUIRE_EQUAL(cText.NeighborSearchType(), CFNeighborSearch::RA_SEARCH);
+  BOOST_REQUIRE_EQUAL(cBinary.NeighborSearchType(),
+      CFNeighborSearch::RA_SEARCH);
+
+  CF copy(c);
+  BOOST_REQUIRE_EQUAL(copy.NeighborSearchType(), CFNeighborSearch::RA_SEARCH);
+  arma::Mat<size_t> copyRecommendations;
+  copy.GetRecommendations(5, copyRecommendations);
+  BOOST_REQUIRE_EQUAL(copyRecommendations.n_cols, cleanedData.n_cols);
+
+  BOOST_REQUIRE_THROW(CFNeighborSearch::ParseSearchType("ball"),
+      std::invalid_argument);
+  BOOST_REQUIRE_EQUAL(CFNeighborSearch::ParseSearchType("lsh"),
+      CFNeighborSearch::LSH_SEARCH);
+}
+
+/**
+ * Make sure the blocked computation of the recommendations gives the same
+ * items as estimating the ratings of all items for each neighbor, with any
+ * number of threads.
+ */
+BOOST_AUTO_TEST_CASE(CFRecommendationsBruteForceTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF::CleanData(dataset, cleanedData);
+
+  CF c(cleanedData);
+
+  // Some users cross the boundary of a block of users.
+  arma::Col<size_t> users = arma::linspace<arma::Col<size_t>>(50, 149, 100);
+  arma::Mat<size_t> recommendations, threadedRecommendations;
+  c.GetRecommendations(10, recommendations, users, 1);
+  c.GetRecommendations(10, threadedRecommendations, users, 4);
+  CheckMatrices(recommendations, threadedRecommendations);
+
+  // Find the neighborhoods the same way as CF.
+  arma::mat stretchedH = arma::chol(c.W().t() * c.W()) * c.H();
+  arma::mat query(stretchedH.n_rows, users.n_elem);
+  for (size_t i = 0; i < users.n_elem; ++i)
+    query.col(i) = stretchedH.col(users[i]);
+  neighbor::KNN knn(stretchedH);
+  arma::Mat<size_t> neighborhood;
+  arma::mat distances;
+  knn.Search(query, c.NumUsersForSimilarity(), neighborhood, distances);
+
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    arma::vec averages(cleanedData.n_rows, arma::fill::zeros);
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      averages += c.W() * c.H().col(neighborhood(j, i));
+    averages /= neighborhood.n_rows;
+
+    // Rated items cannot be recommended.
+    for (size_t j = 0; j < averages.n_elem; ++j)
+      if (cleanedData(j, users[i]) != 0.0)
+        averages[j] = -DBL_MAX;
+
+    arma::uvec order = arma::sort_index(averages, "descend");
+    for (size_t j = 0; j < 10; ++j)
+      BOOST_REQUIRE_EQUAL(recommendations(j, i), order[j]);
+  }
+}
+
+/**
+ * Fold new users and items into a trained model, and make sure their factors
+ * are the least squares solutions over their ratings and that the new users
+ * are found as neighbors before the index is rebuilt.
+ */
+BOOST_AUTO_TEST_CASE(CFFoldInTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF::CleanData(dataset, cleanedData);
+
+  // Hold out the last three users.
+  const size_t oldUsers = cleanedData.n_cols - 3;
+  const arma::sp_mat oldData = cleanedData.cols(0, oldUsers - 1);
+  const arma::sp_mat newData = cleanedData.cols(oldUsers,
+      cleanedData.n_cols - 1);
+
+  CF c(oldData);
+  const arma::mat oldW = c.W();
+  BOOST_REQUIRE_EQUAL(c.AddUsers(newData, 0.1), oldUsers);
+  BOOST_REQUIRE_EQUAL(c.H().n_cols, cleanedData.n_cols);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_cols, cleanedData.n_cols);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_nonzero, cleanedData.n_nonzero);
+  CheckMatrices(c.W(), oldW);
+
+  for (size_t i = 0; i < newData.n_cols; ++i)
+  {
+    arma::mat a = 0.1 * arma::eye<arma::mat>(c.Rank(), c.Rank());
+    arma::vec b(c.Rank(), arma::fill::zeros);
+    for (size_t j = 0; j < newData.n_rows; ++j)
+    {
+      if (newData(j, i) != 0.0)
+      {
+        a += c.W().row(j).t() * c.W().row(j);
+        b += newData(j, i) * c.W().row(j).t();
+      }
+    }
+
+    const arma::vec expected = arma::solve(a, b);
+    for (size_t k = 0; k < expected.n_elem; ++k)
+      BOOST_REQUIRE_CLOSE(c.H()(k, oldUsers + i), expected[k], 1e-5);
+  }
+
+  // Each new user is its own nearest neighbor, although it is not in the
+  // index yet.
+  const arma::mat stretchedH = arma::chol(c.W().t() * c.W()) * c.H();
+  neighbor::KNN knn(stretchedH);
+  arma::Mat<size_t> neighborhood;
+  arma::mat distances;
+  knn.Search(stretchedH.cols(oldUsers, cleanedData.n_cols - 1),
+      c.NumUsersForSimilarity(), neighborhood, distances);
+  arma::Mat<size_t> combinations(2, 3);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborhood(0, i), oldUsers + i);
+
+    double rating = 0.0;
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      rating += arma::dot(c.W().row(5), c.H().col(neighborhood(j, i)));
+    rating /= neighborhood.n_rows;
+    BOOST_REQUIRE_CLOSE(c.Predict(oldUsers + i, 5), rating, 1e-5);
+  }
+
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(5, recommendations);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, cleanedData.n_cols);
+
+  // Add an item that was rated by the first ten users.
+  arma::sp_mat itemRatings(1, cleanedData.n_cols);
+  for (size_t j = 0; j < 10; ++j)
+    itemRatings(0, j) = 4.0;
+  BOOST_REQUIRE_EQUAL(c.AddItems(itemRatings), cleanedData.n_rows);
+  BOOST_REQUIRE_EQUAL(c.W().n_rows, cleanedData.n_rows + 1);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_rows, cleanedData.n_rows + 1);
+  BOOST_REQUIRE_EQUAL(c.CleanedData()(cleanedData.n_rows, 3), 4.0);
+  c.GetRecommendations(5, recommendations);
+  for (size_t j = 0; j < 10; ++j)
+    for (size_t k = 0; k < 5; ++k)
+      BOOST_REQUIRE_NE(recommendations(k, j), cleanedData.n_rows);
+
+  // The dimensions of the ratings have to match the model.
+  BOOST_REQUIRE_THROW(c.AddUsers(arma::sp_mat(3, 1)), std::invalid_argument);
+  BOOST_REQUIRE_THROW(c.AddItems(arma::sp_mat(1, 3)), std::invalid_argument);
+  CF untrained;
+  BOOST_REQUIRE_THROW(untrained.AddUsers(newData), std::invalid_argument);
+}
+
+/**
+ * Make sure a model with factors in single precision holds the factors of the
+ * same factorization as a model in double precision, that it gives the same
+ * predictions up to the precision of floats, and that it can be saved in a
+ * CFModel.
+ */
+BOOST_AUTO_TEST_CASE(FloatCFTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF::CleanData(dataset, cleanedData);
+
+  math::RandomSeed(42);
+  CF c(cleanedData, amf::NMFALSFactorizer(), 5, 10);
+  math::RandomSeed(42);
+  FloatCF f(cleanedData, amf::NMFALSFactorizer(), 5, 10);
+
+  BOOST_REQUIRE_EQUAL(f.W().n_rows, c.W().n_rows);
+  BOOST_REQUIRE_EQUAL(f.H().n_cols, c.H().n_cols);
+  for (size_t i = 0; i < c.W().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(f.W()[i], c.W()[i], 1e-3);
+  for (size_t i = 0; i < c.H().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(f.H()[i], c.H()[i], 1e-3);
+
+  // The neighborhoods are found in double precision, so the predictions only
+  // differ by rounding.
+  arma::Mat<size_t> combinations(2, 20);
+  for (size_t i = 0; i < combinations.n_cols; ++i)
+  {
+    combinations(0, i) = i;
+    combinations(1, i) = 3 * i;
+  }
+  arma::vec predictions, floatPredictions;
+  c.Predict(combinations, predictions);
+  f.Predict(combinations, floatPredictions);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(floatPredictions[i], predictions[i], 1e-2);
+
+  arma::Mat<size_t> recommendations;
+  f.GetRecommendations(5, recommendations);
+  BOOST_REQUIRE_EQUAL(recommendations.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, cleanedData.n_cols);
+
+  // Save the model and load it back, as the cf program does.
+  CFModel model(true);
+  model.SinglePrecisionModel() = f;
+  BOOST_REQUIRE_THROW(model.Model(), std::invalid_argument);
+
+  CFModel xmlModel, textModel, binaryModel;
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+  BOOST_REQUIRE(xmlModel.SinglePrecision());
+  BOOST_REQUIRE(textModel.SinglePrecision());
+  BOOST_REQUIRE(binaryModel.SinglePrecision());
+
+  arma::vec xmlPredictions, textPredictions, binaryPredictions;
+  xmlModel.SinglePrecisionModel().Predict(combinations, xmlPredictions);
+  textModel.SinglePrecisionModel().Predict(combinations, textPredictions);
+  binaryModel.SinglePrecisionModel().Predict(combinations, binaryPredictions);
+  CheckMatrices(floatPredictions, xmlPredictions);
+  CheckMatrices(floatPredictions, textPredictions);
+  CheckMatrices(floatPredictions, binaryPredictions);
+}
+
+/**
+ * Make sure that a CF model saved on its own, as older versions of the cf
+ * program did, can be loaded into a CFModel.
+ */
+BOOST_AUTO_TEST_CASE(CFModelLoadOldFormatTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF::CleanData(dataset, cleanedData);
+  CF c(cleanedData, amf::NMFALSFactorizer(), 5, 10);
+
+  std::stringstream stream;
+  {
+    boost::archive::text_oarchive o(stream);
+    o << data::CreateNVP(c, "cf_model");
+  }
+
+  CFModel model(true);
+  {
+    boost::archive::text_iarchive i(stream);
+    i >> data::CreateNVP(model, "cf_model");
+  }
+
+  BOOST_REQUIRE(!model.SinglePrecision());
+  CheckMatrices(c.W(), model.Model().W());
+  CheckMatrices(c.H(), model.Model().H());
+
+  arma::Mat<size_t> combinations(2, 20);
+  for (size_t i = 0; i < combinations.n_cols; ++i)
+  {
+    combinations(0, i) = i;
+    combinations(1, i) = 3 * i;
+  }
+  arma::vec predictions, loadedPredictions;
+  c.Predict(combinations, predictions);
+  model.Model().Predict(combinations, loadedPredictions);
+  CheckMatrices(predictions, loadedPredictions);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -25,6 +25,9 @@ using Option = mlpack::bindings::cli::CLIOption<T>;
 #include <mlpack/core/util/param.hpp>
 #include <mlpack/bindings/cli/parse_command_line.hpp>
 #include <mlpack/bindings/cli/end_program.hpp>
+#include <mlpack/bindings/cli/run_batch.hpp>
+
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -63,6 +66,15 @@ void AddRequiredCLIOptions()
       "bool");
   CLIOption<bool> version(false, "version", "Display the version of mlpack.",
       "V", "bool");
+  CLIOption<string> profileFile("", "profile_file", "If specified, a profile "
+      "of the timers and method counters is written to this file at the end of "
+      "execution.", "", "string");
+  CLIOption<int> threads(0, "threads", "Maximum number of threads to use (0 "
+      "uses all available threads).", "", "int");
+  CLIOption<bool> deterministic(false, "deterministic", "If set, parallel sums "
+      "are computed in a fixed order.", "", "bool");
+  CLIOption<string> batchFile("", "batch_file", "If specified, the program is "
+      "run once for each line of this file.", "", "string");
 }
 
 /**
@@ -1120,4 +1132,121 @@ BOOST_AUTO_TEST_CASE(CppNameTest)
   BOOST_REQUIRE_EQUAL(CLI::Parameters().at("double").cppType, "double");
 }
 
+/**
+ * Make sure that the contexts of different threads do not share parameters.
+ */
+BOOST_AUTO_TEST_CASE(ThreadContextTest)
+{
+  AddRequiredCLIOptions();
+
+  PARAM_INT_IN("int", "Test int", "i", 0);
+  CLI::StoreSettings("context_test");
+
+  std::vector<int> results(4, -1);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.push_back(std::thread([i, &results]()
+    {
+      CLI::RestoreContext("context_test");
+      CLI::GetParam<int>("int") = i;
+      CLI::SetPassed("int");
+
+      // Give the other threads time to set their parameters.
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      if (CLI::HasParam("int"))
+        results[i] = CLI::GetParam<int>("int");
+      CLI::ClearContext();
+    }));
+  }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  for (int i = 0; i < 4; ++i)
+    BOOST_REQUIRE_EQUAL(results[i], i);
+
+  // The global settings were never changed.
+  BOOST_REQUIRE_EQUAL(CLI::Parameters().count("int"), 0);
+  CLI::RestoreSettings("context_test");
+  BOOST_REQUIRE(!CLI::HasParam("int"));
+  BOOST_REQUIRE_EQUAL(CLI::GetParam<int>("int"), 0);
+
+  BOOST_REQUIRE_THROW(CLI::RestoreContext("unknown_context_test"),
+      std::invalid_argument);
+}
+
+// The values seen by each run of BatchTest.
+static std::vector<int> batchInts;
+static std::vector<int> batchOffsets;
+static std::vector<bool> batchFlags;
+
+// Record the parameters of one run of the batch.
+static void RecordBatchRun()
+{
+  batchInts.push_back(CLI::GetParam<int>("int"));
+  batchOffsets.push_back(CLI::GetParam<int>("offset"));
+  batchFlags.push_back(CLI::HasParam("flag"));
+}
+
+/**
+ * Make sure that each line of a batch file is run with its own options (and
+ * those of the command line), starting from the default values.
+ */
+BOOST_AUTO_TEST_CASE(BatchTest)
+{
+  AddRequiredCLIOptions();
+
+  PARAM_INT_IN_REQ("int", "Test int", "i");
+  PARAM_INT_IN("offset", "Test offset", "o", 0);
+  PARAM_FLAG("flag", "Test flag", "f");
+
+  std::ofstream batch("batch_test.txt");
+  batch << "--int 3" << std::endl;
+  batch << "# A comment." << std::endl;
+  batch << std::endl;
+  batch << "-i 5 --flag" << std::endl;
+  batch << "--int=7" << std::endl;
+  batch.close();
+
+  const std::map<std::string, util::ParamData> defaults = CLI::Parameters();
+
+  // The required option is given by the lines.
+  int argc = 4;
+  const char* argv[4];
+  argv[0] = "./test";
+  argv[1] = "--batch_file";
+  argv[2] = "batch_test.txt";
+  argv[3] = "--offset=2";
+  ParseCommandLine(argc, const_cast<char**>(argv));
+  BOOST_REQUIRE(CLI::HasParam("batch_file"));
+
+  batchInts.clear();
+  batchOffsets.clear();
+  batchFlags.clear();
+  RunBatch(argc, const_cast<char**>(argv), defaults, RecordBatchRun);
+
+  BOOST_REQUIRE_EQUAL(batchInts.size(), 3);
+  BOOST_REQUIRE_EQUAL(batchInts[0], 3);
+  BOOST_REQUIRE_EQUAL(batchInts[1], 5);
+  BOOST_REQUIRE_EQUAL(batchInts[2], 7);
+  for (size_t i = 0; i < batchOffsets.size(); ++i)
+    BOOST_REQUIRE_EQUAL(batchOffsets[i], 2);
+  BOOST_REQUIRE(!batchFlags[0]);
+  BOOST_REQUIRE(batchFlags[1]);
+  BOOST_REQUIRE(!batchFlags[2]);
+
+  // A line without the required option is an error.
+  batch.open("batch_test.txt");
+  batch << "--flag" << std::endl;
+  batch.close();
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(RunBatch(argc, const_cast<char**>(argv), defaults,
+      RecordBatchRun), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+
+  remove("batch_test.txt");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -139,6 +139,44 @@ BOOST_AUTO_TEST_CASE(CNELogisticRegressionTest)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
 
+/**
+ * Make sure that evaluating the candidates in parallel gives the same result
+ * as evaluating them one after the other, for a thread-safe function.
+ */
+BOOST_AUTO_TEST_CASE(CNEParallelEvaluationTest)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 200);
+  arma::Row<size_t> responses(200);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 100; i < 200; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  LogisticRegressionFunction<> f(data, responses, 0.5);
+
+  math::RandomSeed(17);
+  CNE serial(30, 50, 0.2, 0.2, 0.3, -1, -1, 1);
+  arma::mat serialIterate = f.InitialPoint();
+  const double serialObjective = serial.Optimize(f, serialIterate);
+
+  math::RandomSeed(17);
+  CNE parallel(30, 50, 0.2, 0.2, 0.3, -1, -1, 0);
+  arma::mat parallelIterate = f.InitialPoint();
+  const double parallelObjective = parallel.Optimize(f, parallelIterate);
+
+  BOOST_REQUIRE_CLOSE(serialObjective, parallelObjective, 1e-5);
+  CheckMatrices(serialIterate, parallelIterate);
+}
+
 /**
  * Training a vanilla network on a larger dataset using CNE optimizer.
  */
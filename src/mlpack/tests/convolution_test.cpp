@@ -16,6 +16,8 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+#include <mlpack/methods/ann/layer/layer.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -149,6 +151,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<ValidConvolution> >(input, filter,
       output);
+
+  // Perform the convolution as a matrix product.
+  Convolution2DMethodTest<Im2ColConvolution<ValidConvolution> >(input, filter,
+      output);
 }
 
 /**
@@ -186,6 +192,10 @@ BOOST_AUTO_TEST_CASE(FullConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<FullConvolution> >(input, filter,
       output);
+
+  // Perform the convolution as a matrix product.
+  Convolution2DMethodTest<Im2ColConvolution<FullConvolution> >(input, filter,
+      output);
 }
 
 /**
@@ -231,6 +241,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<ValidConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product.
+  Convolution3DMethodTest<Im2ColConvolution<ValidConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
@@ -280,6 +294,10 @@ BOOST_AUTO_TEST_CASE(FullConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<FullConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product.
+  Convolution3DMethodTest<Im2ColConvolution<FullConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
@@ -322,6 +340,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolutionBatchTest)
   // speeded up the computation.
   ConvolutionMethodBatchTest<SVDConvolution<ValidConvolution> >(input,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product.
+  ConvolutionMethodBatchTest<Im2ColConvolution<ValidConvolution> >(input,
+      filterCube, outputCube);
 }
 
 /**
@@ -368,6 +390,88 @@ BOOST_AUTO_TEST_CASE(FullConvolutionBatchTest)
   // speeded up the computation.
   ConvolutionMethodBatchTest<SVDConvolution<FullConvolution> >(input,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product.
+  ConvolutionMethodBatchTest<Im2ColConvolution<FullConvolution> >(input,
+      filterCube, outputCube);
+}
+
+/**
+ * Make sure that a Convolution layer that uses Im2ColConvolution gives the same
+ * results as a Convolution layer that uses NaiveConvolution, with and without
+ * padding.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColConvolutionLayerTest)
+{
+  for (size_t pad = 0; pad < 2; ++pad)
+  {
+    Convolution<> naive(2, 3, 3, 3, 1, 1, pad, pad, 7, 6);
+    Convolution<Im2ColConvolution<ValidConvolution>,
+        Im2ColConvolution<FullConvolution>,
+        Im2ColConvolution<ValidConvolution> > im2col(2, 3, 3, 3, 1, 1, pad,
+        pad, 7, 6);
+
+    naive.Parameters().randu();
+    im2col.Parameters() = naive.Parameters();
+    naive.Reset();
+    im2col.Reset();
+
+    arma::mat input = arma::randu<arma::mat>(7 * 6 * 2, 1);
+    arma::mat naiveOutput, im2colOutput;
+    naive.Forward(std::move(input), std::move(naiveOutput));
+    im2col.Forward(std::move(input), std::move(im2colOutput));
+    CheckMatrices(naiveOutput, im2colOutput);
+
+    arma::mat error = arma::randu<arma::mat>(naiveOutput.n_rows, 1);
+    arma::mat naiveDelta, im2colDelta;
+    naive.Backward(std::move(input), std::move(error), std::move(naiveDelta));
+    im2col.Backward(std::move(input), std::move(error),
+        std::move(im2colDelta));
+    CheckMatrices(naiveDelta, im2colDelta);
+
+    arma::mat naiveGradient(naive.Parameters().n_elem, 1);
+    arma::mat im2colGradient(im2col.Parameters().n_elem, 1);
+    naive.Gradient(std::move(input), std::move(error),
+        std::move(naiveGradient));
+    im2col.Gradient(std::move(input), std::move(error),
+        std::move(im2colGradient));
+    CheckMatrices(naiveGradient, im2colGradient);
+  }
+}
+
+/**
+ * With strides, the backward pass and the gradient of an im2col Convolution
+ * layer must be the adjoints of its forward pass.  Without bias, the output y
+ * is linear in the input x and in the kernels w, so for any error e,
+ * <y, e> = <x, backward(e)> = <w, gradient(e)>.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColConvolutionLayerStrideTest)
+{
+  Convolution<Im2ColConvolution<ValidConvolution>,
+      Im2ColConvolution<FullConvolution>,
+      Im2ColConvolution<ValidConvolution> > layer(2, 3, 3, 2, 2, 3, 1, 0, 9,
+      8);
+  layer.Parameters().randu();
+  const size_t weightSize = 2 * 3 * 3 * 2;
+  layer.Parameters().rows(weightSize, layer.Parameters().n_elem - 1).zeros();
+  layer.Reset();
+
+  arma::mat input = arma::randu<arma::mat>(9 * 8 * 2, 1);
+  arma::mat output;
+  layer.Forward(std::move(input), std::move(output));
+
+  arma::mat error = arma::randu<arma::mat>(output.n_rows, 1);
+  arma::mat delta;
+  layer.Backward(std::move(input), std::move(error), std::move(delta));
+  BOOST_REQUIRE_EQUAL(delta.n_elem, input.n_elem);
+  BOOST_REQUIRE_CLOSE(arma::dot(output, error), arma::dot(input, delta),
+      1e-5);
+
+  arma::mat gradient(layer.Parameters().n_elem, 1);
+  layer.Gradient(std::move(input), std::move(error), std::move(gradient));
+  BOOST_REQUIRE_CLOSE(arma::dot(output, error), arma::dot(
+      layer.Parameters().rows(0, weightSize - 1),
+      gradient.rows(0, weightSize - 1)), 1e-5);
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -222,4 +222,42 @@ BOOST_AUTO_TEST_CASE(CosineTreeModifiedGramSchmidt)
   }
 }
 
+/**
+ * Make sure that the basis is orthonormal and reaches the error tolerance when
+ * several nodes are split in each round.
+ */
+BOOST_AUTO_TEST_CASE(CosineTreeBatchSplit)
+{
+  const double epsilon = 0.3;
+  const double delta = 0.1;
+
+  // A matrix of rank 40, so that the basis needs far fewer vectors than the
+  // rank.
+  arma::mat data = arma::randn(200, 40) * arma::randn(40, 1000);
+
+  CosineTree ctree(data, epsilon, delta, 6);
+  arma::mat basis;
+  ctree.GetFinalBasis(basis);
+
+  BOOST_REQUIRE_GT(basis.n_cols, 1);
+  arma::mat identity = arma::eye<arma::mat>(basis.n_cols, basis.n_cols);
+  arma::mat gram = basis.t() * basis;
+  for (size_t i = 0; i < gram.n_elem; ++i)
+  {
+    if (identity[i] == 0.0)
+      BOOST_REQUIRE_SMALL(gram[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(gram[i], 1.0, 1e-5);
+  }
+
+  // The projection of the data onto the basis should keep most of its norm.
+  const double residual = arma::norm(data - basis * (basis.t() * data),
+      "frob");
+  BOOST_REQUIRE_LT(residual * residual, 0.5 * std::pow(arma::norm(data,
+      "frob"), 2.0));
+
+  BOOST_REQUIRE_THROW(CosineTree(data, epsilon, delta, 0),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,183 @@
+/**
+ * @file curve_order_test.cpp
+ *
+ * Tests for the reordering of datasets along space-filling curves.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/curve_order.hpp>
+#include <mlpack/methods/kmeans/kmeans.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+BOOST_AUTO_TEST_SUITE(CurveOrderTest);
+
+/**
+ * Get the mean distance between consecutive points of the dataset.
+ */
+double MeanStep(const arma::mat& dataset)
+{
+  double sum = 0.0;
+  for (size_t i = 1; i < dataset.n_cols; ++i)
+    sum += arma::norm(dataset.col(i) - dataset.col(i - 1));
+  return sum / (dataset.n_cols - 1);
+}
+
+/**
+ * Make sure that the dataset is reordered with the returned permutation, that
+ * consecutive points are then close to each other, and that UnmapColumns()
+ * restores the original order.
+ */
+BOOST_AUTO_TEST_CASE(ReorderByCurveTest)
+{
+  const arma::mat original(2, 10000, arma::fill::randu);
+  const CurveType curves[] = { Z_ORDER_CURVE, HILBERT_CURVE };
+  for (size_t c = 0; c < 2; ++c)
+  {
+    arma::mat dataset(original);
+    std::vector<size_t> oldFromNew;
+    ReorderByCurve(dataset, oldFromNew, curves[c]);
+
+    BOOST_REQUIRE_EQUAL(oldFromNew.size(), original.n_cols);
+    std::vector<bool> found(original.n_cols, false);
+    for (size_t i = 0; i < original.n_cols; ++i)
+    {
+      BOOST_REQUIRE_LT(oldFromNew[i], original.n_cols);
+      BOOST_REQUIRE(!found[oldFromNew[i]]);
+      found[oldFromNew[i]] = true;
+
+      BOOST_REQUIRE_EQUAL(dataset(0, i), original(0, oldFromNew[i]));
+      BOOST_REQUIRE_EQUAL(dataset(1, i), original(1, oldFromNew[i]));
+    }
+
+    // The points are about 0.5 apart in random order, and about 1 / sqrt(n)
+    // apart along a curve.
+    BOOST_REQUIRE_LT(MeanStep(dataset), 0.05);
+
+    // The order is the same without the reordering.
+    std::vector<size_t> computed;
+    ComputeCurveOrder(original, computed, curves[c]);
+    for (size_t i = 0; i < original.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(computed[i], oldFromNew[i]);
+
+    UnmapColumns(dataset, oldFromNew);
+    CheckMatrices(dataset, original);
+  }
+}
+
+/**
+ * The Hilbert curve is continuous, so consecutive points of a dense grid that
+ * is aligned with the subdivisions of the curve are neighbors on the grid.
+ */
+BOOST_AUTO_TEST_CASE(HilbertCurveContinuityTest)
+{
+  // The bounding box is [0, 16)^2 (the last row and column of the grid are
+  // there to set it), and the curve is tested on the cells [0, 8)^2.
+  arma::mat dataset(2, 64);
+  for (size_t i = 0; i < 64; ++i)
+  {
+    dataset(0, i) = (double) (i % 8);
+    dataset(1, i) = (double) (i / 8);
+  }
+  dataset.insert_cols(64, arma::mat("16; 16"));
+
+  std::vector<size_t> oldFromNew;
+  ComputeCurveOrder(dataset, oldFromNew, HILBERT_CURVE);
+
+  std::vector<size_t> grid;
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    if (oldFromNew[i] < 64)
+      grid.push_back(oldFromNew[i]);
+
+  BOOST_REQUIRE_EQUAL(grid.size(), 64);
+  for (size_t i = 1; i < grid.size(); ++i)
+  {
+    const double step = arma::norm(dataset.col(grid[i]) -
+        dataset.col(grid[i - 1]));
+    BOOST_REQUIRE_CLOSE(step, 1.0, 1e-5);
+  }
+}
+
+/**
+ * The order does not depend on the number of threads, also for datasets large
+ * enough to be sorted in parallel.
+ */
+BOOST_AUTO_TEST_CASE(CurveOrderThreadsTest)
+{
+  arma::mat dataset(3, 150000, arma::fill::randu);
+  // Add duplicate points, which must keep their order.
+  dataset.cols(100000, 149999) = dataset.cols(0, 49999);
+
+  std::vector<size_t> order;
+  ComputeCurveOrder(dataset, order, HILBERT_CURVE);
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  std::vector<size_t> serialOrder;
+  ComputeCurveOrder(dataset, serialOrder, HILBERT_CURVE);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(order.size(), serialOrder.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    BOOST_REQUIRE_EQUAL(order[i], serialOrder[i]);
+}
+
+/**
+ * Cluster a reordered dataset and map the assignments back; the assignments
+ * should agree with the clusters of the original points, and UnmapIndices()
+ * should map indices of reordered points to the original ones.
+ */
+BOOST_AUTO_TEST_CASE(UnmapResultsTest)
+{
+  // Two well-separated clusters: the first 500 points and the last 500.
+  arma::mat original(2, 1000, arma::fill::randu);
+  original.cols(500, 999) += 10.0;
+
+  arma::mat dataset(original);
+  std::vector<size_t> oldFromNew;
+  ReorderByCurve(dataset, oldFromNew);
+
+  kmeans::KMeans<> kmeans;
+  arma::Row<size_t> assignments;
+  arma::mat centroids("0.5 10.5; 0.5 10.5");
+  kmeans.Cluster(dataset, 2, assignments, centroids, false, true);
+  UnmapColumns(assignments, oldFromNew);
+
+  for (size_t i = 0; i < 1000; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], (i < 500) ? 0 : 1);
+
+  arma::Mat<size_t> indices(1, 1000);
+  for (size_t i = 0; i < 1000; ++i)
+    indices[i] = i;
+  UnmapIndices(indices, oldFromNew);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(original(0, indices[i]), dataset(0, i));
+    BOOST_REQUIRE_EQUAL(original(1, indices[i]), dataset(1, i));
+  }
+
+  // Mappings of the wrong size are rejected.
+  arma::Row<size_t> wrongSize(999);
+  BOOST_REQUIRE_THROW(UnmapColumns(wrongSize, oldFromNew),
+      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
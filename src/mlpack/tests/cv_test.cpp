@@ -13,12 +13,15 @@
 
 #include <mlpack/core/cv/meta_info_extractor.hpp>
 #include <mlpack/core/cv/metrics/accuracy.hpp>
+#include <mlpack/core/cv/metrics/confusion_accumulator.hpp>
 #include <mlpack/core/cv/metrics/f1.hpp>
 #include <mlpack/core/cv/metrics/mse.hpp>
 #include <mlpack/core/cv/metrics/precision.hpp>
 #include <mlpack/core/cv/metrics/recall.hpp>
+#include <mlpack/core/cv/metrics/regression_accumulator.hpp>
 #include <mlpack/core/cv/simple_cv.hpp>
 #include <mlpack/core/cv/k_fold_cv.hpp>
+#include <mlpack/core/data/column_blocks.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
 #include <mlpack/methods/ann/init_rules/const_init.hpp>
@@ -143,6 +146,81 @@ BOOST_AUTO_TEST_CASE(MSETest)
   BOOST_REQUIRE_CLOSE(MSE::Evaluate(lr, data, responses), expectedMSE, 1e-5);
 }
 
+/**
+ * Test that the classification metrics computed from batches of test items,
+ * accumulated separately and merged, are the same as the metrics of all test
+ * items at once.
+ */
+BOOST_AUTO_TEST_CASE(ConfusionAccumulatorTest)
+{
+  // The same data as in MulticlassClassificationMetricsTest.
+  arma::mat data = arma::linspace<arma::rowvec>(1.0, 12.0, 12);
+  arma::Row<size_t> labels("0 1  0 1  2 2 1 2  3 3 3 3");
+  arma::Row<size_t> predictedLabels("0 0  1 1  2 2 2 2  3 3 3 3");
+  NaiveBayesClassifier<> nb(data, predictedLabels, 4);
+
+  // The second batch only has labels 2 and 3.
+  ConfusionAccumulator first, second;
+  first.Add(nb, data.cols(0, 3), labels.cols(0, 3));
+  second.Add(nb, data.cols(4, 11), labels.cols(4, 11));
+  BOOST_REQUIRE_EQUAL(first.NumClasses(), 2);
+
+  second.Merge(first);
+  BOOST_REQUIRE_EQUAL(second.Count(), 12);
+  BOOST_REQUIRE_EQUAL(second.Counts()(1, 2), 1);
+
+  BOOST_REQUIRE_CLOSE(second.Accuracy(),
+      Accuracy::Evaluate(nb, data, labels), 1e-5);
+  BOOST_REQUIRE_CLOSE(second.Precision<Macro>(),
+      Precision<Macro>::Evaluate(nb, data, labels), 1e-5);
+  BOOST_REQUIRE_CLOSE(second.Recall<Macro>(),
+      Recall<Macro>::Evaluate(nb, data, labels), 1e-5);
+  BOOST_REQUIRE_CLOSE(second.F1<Macro>(),
+      F1<Macro>::Evaluate(nb, data, labels), 1e-5);
+  BOOST_REQUIRE_CLOSE(second.Precision<Binary>(),
+      Precision<Binary>::Evaluate(nb, data, labels), 1e-5);
+  BOOST_REQUIRE_CLOSE(second.Recall<Binary, 2>(),
+      (Recall<Binary, 2>::Evaluate(nb, data, labels)), 1e-5);
+
+  // Accumulating blocks of columns in parallel gives the same counts.
+  data::MatrixColumnBlocks<> blocks(data, 5);
+  ConfusionAccumulator blockAccumulator;
+  AccumulateBlocks(blockAccumulator, nb, blocks, labels);
+  BOOST_REQUIRE_EQUAL(arma::accu(blockAccumulator.Counts() != second.Counts()),
+      0);
+
+  BOOST_REQUIRE_THROW(first.Add(labels, predictedLabels.cols(0, 3)),
+      std::invalid_argument);
+}
+
+/**
+ * Test that the MSE of merged batches is the MSE of all test items.
+ */
+BOOST_AUTO_TEST_CASE(RegressionAccumulatorTest)
+{
+  arma::mat trainingData = arma::randu<arma::mat>(3, 50);
+  arma::rowvec trainingResponses = arma::randu<arma::rowvec>(50);
+  LinearRegression lr(trainingData, trainingResponses);
+
+  arma::mat data = arma::randu<arma::mat>(3, 101);
+  arma::rowvec responses = arma::randu<arma::rowvec>(101);
+
+  RegressionAccumulator first, second;
+  first.Add(lr, data.cols(0, 39), arma::rowvec(responses.cols(0, 39)));
+  second.Add(lr, data.cols(40, 100), arma::rowvec(responses.cols(40, 100)));
+  first.Merge(second);
+
+  BOOST_REQUIRE_EQUAL(first.Count(), 101);
+  BOOST_REQUIRE_CLOSE(first.MSE(), MSE::Evaluate(lr, data, responses), 1e-5);
+
+  data::MatrixColumnBlocks<> blocks(data, 16);
+  RegressionAccumulator blockAccumulator;
+  AccumulateBlocks(blockAccumulator, lr, blocks, responses);
+  BOOST_REQUIRE_CLOSE(blockAccumulator.MSE(), first.MSE(), 1e-5);
+  BOOST_REQUIRE_CLOSE(blockAccumulator.MeanResidual(), first.MeanResidual(),
+      1e-5);
+}
+
 /**
  * Test the mean squared error with matrix responses.
  */
@@ -439,6 +517,61 @@ BOOST_AUTO_TEST_CASE(KFoldCVAccuracyTest)
   cv.Model();
 }
 
+/**
+ * Test that k-fold cross-validation gives the same results when the data is
+ * moved into it instead of copied.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVMovedDataTest)
+{
+  arma::mat data("0 1 2 3 100 101 102 103 104 5");
+  arma::Row<size_t> labels("0 0 0 0 1 1 1 1 1 1");
+  size_t numClasses = 2;
+
+  KFoldCV<NaiveBayesClassifier<>, Accuracy> cv(10, data, labels, numClasses);
+  const double copiedAccuracy = cv.Evaluate();
+
+  arma::mat movedData(data);
+  arma::Row<size_t> movedLabels(labels);
+  KFoldCV<NaiveBayesClassifier<>, Accuracy> movedCV(10, std::move(movedData),
+      std::move(movedLabels), numClasses);
+
+  // The data should have been taken over by the KFoldCV object.
+  BOOST_REQUIRE_EQUAL(movedData.n_elem, 0);
+  BOOST_REQUIRE_EQUAL(movedLabels.n_elem, 0);
+
+  BOOST_REQUIRE_CLOSE(movedCV.Evaluate(), copiedAccuracy, 1e-5);
+  BOOST_REQUIRE_CLOSE(movedCV.Evaluate(), (9 * 1.0 + 0.0) / 10, 1e-5);
+}
+
+/**
+ * Test that training the folds in parallel gives the same results as training
+ * them one after another.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVParallelFoldsTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 103);
+  arma::rowvec responses = arma::randu<arma::rowvec>(103);
+  arma::rowvec weights = arma::randu<arma::rowvec>(103);
+
+  KFoldCV<LinearRegression, MSE> cv(7, data, responses);
+  KFoldCV<LinearRegression, MSE> weightedCV(7, data, responses, weights);
+
+  cv.NumThreads() = 1;
+  weightedCV.NumThreads() = 1;
+  const double mse = cv.Evaluate();
+  const double weightedMSE = weightedCV.Evaluate();
+  const arma::vec parameters = cv.Model().Parameters();
+
+  cv.NumThreads() = 4;
+  weightedCV.NumThreads() = 4;
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(), mse, 1e-5);
+  BOOST_REQUIRE_CLOSE(weightedCV.Evaluate(), weightedMSE, 1e-5);
+
+  // The model of the last fold should be kept in both cases.
+  for (size_t i = 0; i < parameters.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(cv.Model().Parameters()[i], parameters[i], 1e-5);
+}
+
 /**
  * Test k-fold cross-validation with weighted linear regression.
  */
@@ -461,6 +594,78 @@ BOOST_AUTO_TEST_CASE(KFoldCVWithWeightedLRTest)
   BOOST_REQUIRE_CLOSE(1.0 - mse, 1.0, 1e-5);
 }
 
+/**
+ * Test k-fold cross-validation trains only on the given proportion of each
+ * training subset, and its copies work in the same way.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVTrainingFractionTest)
+{
+  // Each fold will be filled with this dataset; the first two points of it
+  // follow y = x.
+  arma::mat data("1 2 3 4");
+  arma::rowvec responses("1 2 30 40");
+
+  KFoldCV<LinearRegression, MSE> cv(2, arma::join_rows(data, data),
+      arma::join_rows(responses, responses));
+  cv.TrainingFraction() = 0.5;
+  double objective = cv.Evaluate();
+
+  arma::mat testData("3 4");
+  arma::rowvec testResponses("3 4");
+
+  double mse = MSE::Evaluate(cv.Model(), testData, testResponses);
+
+  BOOST_REQUIRE_CLOSE(1.0 - mse, 1.0, 1e-5);
+
+  KFoldCV<LinearRegression, MSE> copy(cv);
+  BOOST_REQUIRE_CLOSE(copy.TrainingFraction(), 0.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(copy.Evaluate(), objective, 1e-5);
+}
+
+/**
+ * Test that k-fold cross-validation uses the same folds as k-fold
+ * cross-validation on the data extended by its first k - 2 bins, including the
+ * points that do not fill a bin, also when it is run several times.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVFoldsTest)
+{
+  const size_t k = 3;
+  const size_t binSize = 3;
+  arma::mat data(2, 11, arma::fill::randu);
+  arma::rowvec responses(11, arma::fill::randu);
+
+  // The extended data wraps around to the first points.
+  arma::vec evaluations(k);
+  for (size_t i = 0; i < k; ++i)
+  {
+    const size_t validationFirst = (i < k - 1) ?
+        (binSize * i + binSize * (k - 1)) : (binSize * (i - 1));
+
+    arma::mat trainingData(2, binSize * (k - 1));
+    arma::rowvec trainingResponses(binSize * (k - 1));
+    for (size_t j = 0; j < binSize * (k - 1); ++j)
+    {
+      trainingData.col(j) = data.col((binSize * i + j) % 11);
+      trainingResponses[j] = responses[(binSize * i + j) % 11];
+    }
+
+    arma::mat validationData(2, binSize);
+    arma::rowvec validationResponses(binSize);
+    for (size_t j = 0; j < binSize; ++j)
+    {
+      validationData.col(j) = data.col((validationFirst + j) % 11);
+      validationResponses[j] = responses[(validationFirst + j) % 11];
+    }
+
+    LinearRegression lr(trainingData, trainingResponses);
+    evaluations[i] = MSE::Evaluate(lr, validationData, validationResponses);
+  }
+
+  KFoldCV<LinearRegression, MSE> cv(k, data, responses);
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(), arma::mean(evaluations), 1e-5);
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(), arma::mean(evaluations), 1e-5);
+}
+
 /**
  * Test k-fold cross-validation with decision trees constructed in multiple
  * ways.
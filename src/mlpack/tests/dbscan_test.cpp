@@ -11,13 +11,19 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/dbscan/dbscan.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::dbscan;
 using namespace mlpack::distribution;
+using namespace mlpack::tree;
 
 BOOST_AUTO_TEST_SUITE(DBSCANTest);
 
@@ -271,4 +277,220 @@ BOOST_AUTO_TEST_CASE(GaussiansSingleModeTest)
   }
 }
 
+/**
+ * The labels of the clusters are ordered by their first points, so every way of
+ * searching the neighborhoods must give exactly the same assignments, with any
+ * number of threads.
+ */
+BOOST_AUTO_TEST_CASE(StableLabelsTest)
+{
+  arma::mat points(2, 600, arma::fill::randu);
+  points.cols(200, 399) += 3.0;
+  points.cols(400, 599) -= 3.0;
+  // Some isolated points, which are noise.
+  for (size_t i = 0; i < 10; ++i)
+    points.col(50 * i) = arma::vec({ 20.0 + 5.0 * i, -20.0 });
+
+  DBSCAN<> dual(0.2, 4);
+  arma::Row<size_t> trueAssignments;
+  const size_t trueClusters = dual.Cluster(points, trueAssignments);
+  BOOST_REQUIRE_GE(trueClusters, 3);
+
+  // The first point that is not noise starts the first cluster.
+  size_t first = 0;
+  while (trueAssignments[first] == SIZE_MAX)
+    ++first;
+  BOOST_REQUIRE_EQUAL(trueAssignments[first], 0);
+
+  for (size_t threads = 1; threads <= 4; threads += 3)
+  {
+    #ifdef HAS_OPENMP
+      const int oldThreads = omp_get_max_threads();
+      omp_set_num_threads((int) threads);
+    #endif
+
+    DBSCAN<> pointwise(0.2, 4, false);
+    DBSCAN<> single(0.2, 4, true, range::RangeSearch<>(false, true));
+    DBSCAN<> naive(0.2, 4, true, range::RangeSearch<>(true));
+
+    arma::Row<size_t> pointwiseAssignments, singleAssignments,
+        naiveAssignments;
+    BOOST_REQUIRE_EQUAL(pointwise.Cluster(points, pointwiseAssignments),
+        trueClusters);
+    BOOST_REQUIRE_EQUAL(single.Cluster(points, singleAssignments),
+        trueClusters);
+    BOOST_REQUIRE_EQUAL(naive.Cluster(points, naiveAssignments),
+        trueClusters);
+
+    #ifdef HAS_OPENMP
+      omp_set_num_threads(oldThreads);
+    #endif
+
+    for (size_t i = 0; i < points.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(pointwiseAssignments[i], trueAssignments[i]);
+      BOOST_REQUIRE_EQUAL(singleAssignments[i], trueAssignments[i]);
+      BOOST_REQUIRE_EQUAL(naiveAssignments[i], trueAssignments[i]);
+    }
+  }
+
+  for (size_t i = 0; i < 10; ++i)
+    BOOST_REQUIRE_EQUAL(trueAssignments[50 * i], SIZE_MAX);
+}
+
+/**
+ * Make sure that DBSCAN on a SharedTree gives the same clusters as DBSCAN on
+ * the points themselves, and that the tree can also serve a k-nearest-neighbor
+ * search.
+ */
+BOOST_AUTO_TEST_CASE(SharedTreeTest)
+{
+  arma::mat points(3, 500, arma::fill::randu);
+  points.cols(250, 499) += 3.0;
+
+  std::vector<size_t> oldFromNew;
+  KDTree<metric::EuclideanDistance, EmptyStatistic, arma::mat> tree(points,
+      oldFromNew);
+  SharedTree shared(tree, oldFromNew);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    const bool batchMode = (mode == 0);
+
+    DBSCAN<> d(0.3, 3, batchMode);
+    arma::Row<size_t> trueAssignments;
+    const size_t trueClusters = d.Cluster(points, trueAssignments);
+
+    DBSCAN<> sharedD(0.3, 3, batchMode);
+    arma::Row<size_t> assignments;
+    const size_t clusters = sharedD.Cluster(shared, assignments);
+
+    // The clusters may be numbered differently.
+    BOOST_REQUIRE_EQUAL(clusters, trueClusters);
+    BOOST_REQUIRE_EQUAL(assignments.n_elem, points.n_cols);
+    std::map<size_t, size_t> labels, trueLabels;
+    for (size_t i = 0; i < points.n_cols; ++i)
+    {
+      if (labels.count(trueAssignments[i]) == 0)
+        labels[trueAssignments[i]] = assignments[i];
+      if (trueLabels.count(assignments[i]) == 0)
+        trueLabels[assignments[i]] = trueAssignments[i];
+
+      BOOST_REQUIRE_EQUAL(labels[trueAssignments[i]], assignments[i]);
+      BOOST_REQUIRE_EQUAL(trueLabels[assignments[i]], trueAssignments[i]);
+    }
+  }
+
+  neighbor::KNN knn;
+  knn.Train(shared);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(1, neighbors, distances);
+
+  neighbor::KNN trueKNN(points);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  trueKNN.Search(1, trueNeighbors, trueDistances);
+  CheckMatrices(neighbors, trueNeighbors);
+}
+
+/**
+ * The grid range search must find exactly the same results as RangeSearch,
+ * also for query points far away from the reference set.
+ */
+BOOST_AUTO_TEST_CASE(GridRangeSearchTest)
+{
+  for (size_t dims = 1; dims <= 3; ++dims)
+  {
+    arma::mat references(dims, 400, arma::fill::randu);
+    arma::mat queries(dims, 50, arma::fill::randu);
+    queries *= 3.0;
+    queries -= 1.0;
+    queries.col(0).fill(1e300);
+
+    const math::Range range(0.05, 0.25);
+    GridRangeSearch<> grid(references);
+    std::vector<std::vector<size_t>> neighbors, trueNeighbors;
+    std::vector<std::vector<double>> distances, trueDistances;
+    grid.Search(queries, range, neighbors, distances);
+
+    range::RangeSearch<> rs(references);
+    rs.Search(queries, range, trueNeighbors, trueDistances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.size(), queries.n_cols);
+    BOOST_REQUIRE_GT(grid.NumCells(), 0);
+    BOOST_REQUIRE_LE(grid.NumCells(), references.n_cols);
+    BOOST_REQUIRE_EQUAL(neighbors[0].size(), 0);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+    {
+      std::vector<size_t> sorted(neighbors[i]), trueSorted(trueNeighbors[i]);
+      std::sort(sorted.begin(), sorted.end());
+      std::sort(trueSorted.begin(), trueSorted.end());
+      BOOST_REQUIRE(sorted == trueSorted);
+      for (size_t j = 0; j < distances[i].size(); ++j)
+        BOOST_REQUIRE(range.Contains(distances[i][j]));
+    }
+  }
+}
+
+/**
+ * DBSCAN with the grid must give exactly the same assignments as DBSCAN with
+ * trees, in batch and pointwise mode and with any number of threads.
+ */
+BOOST_AUTO_TEST_CASE(GridDBSCANTest)
+{
+  for (size_t dims = 2; dims <= 3; ++dims)
+  {
+    arma::mat points(dims, 800, arma::fill::randu);
+    points.cols(300, 599) += 2.0;
+    points.cols(600, 699) *= 4.0;
+    // Some isolated points, which are noise.
+    for (size_t i = 0; i < 10; ++i)
+      points.col(80 * i).fill(10.0 + 3.0 * i);
+
+    DBSCAN<> d(0.15, 5);
+    arma::Row<size_t> trueAssignments;
+    const size_t trueClusters = d.Cluster(points, trueAssignments);
+    BOOST_REQUIRE_GE(trueClusters, 2);
+
+    for (size_t threads = 1; threads <= 4; threads += 3)
+    {
+      #ifdef HAS_OPENMP
+        const int oldThreads = omp_get_max_threads();
+        omp_set_num_threads((int) threads);
+      #endif
+
+      DBSCAN<GridRangeSearch<>> batch(0.15, 5);
+      DBSCAN<GridRangeSearch<>> pointwise(0.15, 5, false);
+      arma::Row<size_t> batchAssignments, pointwiseAssignments;
+      BOOST_REQUIRE_EQUAL(batch.Cluster(points, batchAssignments),
+          trueClusters);
+      BOOST_REQUIRE_EQUAL(pointwise.Cluster(points, pointwiseAssignments),
+          trueClusters);
+
+      #ifdef HAS_OPENMP
+        omp_set_num_threads(oldThreads);
+      #endif
+
+      for (size_t i = 0; i < points.n_cols; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(batchAssignments[i], trueAssignments[i]);
+        BOOST_REQUIRE_EQUAL(pointwiseAssignments[i], trueAssignments[i]);
+      }
+    }
+  }
+}
+
+/**
+ * The grid search must reject data with too many dimensions.
+ */
+BOOST_AUTO_TEST_CASE(GridHighDimensionalTest)
+{
+  arma::mat points(20, 100, arma::fill::randu);
+
+  DBSCAN<GridRangeSearch<>> d(0.5, 3);
+  arma::Row<size_t> assignments;
+  BOOST_REQUIRE_THROW(d.Cluster(points, assignments), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
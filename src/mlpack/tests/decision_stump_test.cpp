@@ -391,4 +391,28 @@ BOOST_AUTO_TEST_CASE(IntTest)
   BOOST_CHECK_EQUAL(predictedLabels(0, 7), 2);
 }
 
+/**
+ * On wide data whose dimensions are evaluated in parallel, the stump must
+ * choose the best dimension, and the first one of two equally good dimensions,
+ * with and without weights.
+ */
+BOOST_AUTO_TEST_CASE(WideDataTest)
+{
+  arma::mat dataset(100, 1000, arma::fill::randu);
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = (i < 500) ? 0 : 1;
+    dataset(40, i) = labels[i] + 0.5 * mlpack::math::Random();
+    dataset(70, i) = dataset(40, i);
+  }
+
+  DecisionStump<> ds(dataset, labels, 2, 10);
+  BOOST_REQUIRE_EQUAL(ds.SplitDimension(), 40);
+
+  arma::rowvec weights(dataset.n_cols, arma::fill::randu);
+  DecisionStump<> weighted(ds, dataset, labels, 2, weights);
+  BOOST_REQUIRE_EQUAL(weighted.SplitDimension(), 40);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
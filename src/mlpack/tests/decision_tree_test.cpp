@@ -21,6 +21,10 @@
 #include "serialization.hpp"
 #include "mock_categorical_data.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::tree;
 using namespace mlpack::distribution;
@@ -367,6 +371,118 @@ BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitNoGainTest)
   BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
 }
 
+/**
+ * Check that the HistogramNumericSplit finds the same gain as the
+ * BestBinaryNumericSplit when there are fewer points than buckets.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitSmallNodeTest)
+{
+  for (size_t trial = 0; trial < 5; ++trial)
+  {
+    arma::vec values = arma::round(100.0 * arma::randu<arma::vec>(200));
+    arma::Row<size_t> labels(200);
+    for (size_t i = 0; i < 200; ++i)
+      labels[i] = (values[i] > 40.0 && math::Random() < 0.8) ? 2 :
+          math::RandInt(2);
+    arma::rowvec weights = arma::randu<arma::rowvec>(200);
+
+    arma::vec classProbabilities, histogramProbabilities;
+    BestBinaryNumericSplit<GiniGain>::AuxiliarySplitInfo<double> aux;
+    HistogramNumericSplit<GiniGain>::AuxiliarySplitInfo<double> histogramAux;
+
+    const double bestGain = GiniGain::Evaluate<false>(labels, 3, weights);
+    const double gain = BestBinaryNumericSplit<GiniGain>::SplitIfBetter<false>(
+        bestGain, values, labels, 3, weights, 5, classProbabilities, aux);
+    const double histogramGain =
+        HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(bestGain, values,
+        labels, 3, weights, 5, histogramProbabilities, histogramAux);
+    BOOST_REQUIRE_GT(gain, bestGain);
+    BOOST_REQUIRE_CLOSE(histogramGain, gain, 1e-5);
+    BOOST_REQUIRE_EQUAL(histogramProbabilities.n_elem, 1);
+
+    const double weightedBestGain = GiniGain::Evaluate<true>(labels, 3,
+        weights);
+    const double weightedGain =
+        BestBinaryNumericSplit<GiniGain>::SplitIfBetter<true>(weightedBestGain,
+        values, labels, 3, weights, 5, classProbabilities, aux);
+    const double weightedHistogramGain =
+        HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(weightedBestGain,
+        values, labels, 3, weights, 5, histogramProbabilities, histogramAux);
+    BOOST_REQUIRE_CLOSE(weightedHistogramGain, weightedGain, 1e-5);
+  }
+}
+
+/**
+ * Check that the HistogramNumericSplit finds an obvious split of many points
+ * up to the width of a bucket, and respects the minimum leaf size.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitManyPointsTest)
+{
+  arma::vec values = arma::randu<arma::vec>(20000);
+  arma::Row<size_t> labels(20000);
+  for (size_t i = 0; i < values.n_elem; ++i)
+    labels[i] = (values[i] > 0.37) ? 1 : 0;
+  arma::rowvec weights;
+
+  arma::vec classProbabilities;
+  HistogramNumericSplit<InformationGain>::AuxiliarySplitInfo<double> aux;
+
+  const double bestGain = InformationGain::Evaluate<false>(labels, 2, weights);
+  const double gain =
+      HistogramNumericSplit<InformationGain>::SplitIfBetter<false>(bestGain,
+      values, labels, 2, weights, 10, classProbabilities, aux);
+
+  BOOST_REQUIRE_GT(gain, bestGain);
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_SMALL(classProbabilities[0] - 0.37, 0.02);
+
+  // With a minimum leaf size of more than half the points, no split can be
+  // made.
+  classProbabilities.clear();
+  const double noGain =
+      HistogramNumericSplit<InformationGain>::SplitIfBetter<false>(bestGain,
+      values, labels, 2, weights, 10001, classProbabilities, aux);
+  BOOST_REQUIRE_EQUAL(noGain, bestGain);
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
+}
+
+/**
+ * Make sure a decision tree with histogram-based numeric splits generalizes
+ * as well as one that searches every split.
+ */
+BOOST_AUTO_TEST_CASE(HistogramDecisionTreeTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+
+  arma::Mat<size_t> trueTestLabels;
+  if (!data::Load("vc2_test_labels.txt", trueTestLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  DecisionTree<GiniGain, HistogramNumericSplit> d(inputData, labels, 3, 10);
+
+  arma::Row<size_t> predictions;
+  d.Classify(testData, predictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testData.n_cols);
+
+  double correct = 0.0;
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    if (predictions[i] == trueTestLabels[i])
+      ++correct;
+  correct /= predictions.n_elem;
+
+  BOOST_REQUIRE_GT(correct, 0.75);
+}
+
 /**
  * Check that the AllCategoricalSplit will split when the split is obviously
  * better.
@@ -1082,4 +1198,123 @@ BOOST_AUTO_TEST_CASE(ConstDataTest)
       constWeights);
 }
 
+/**
+ * Training on indices into a dataset must give the same tree as training on the
+ * columns of the dataset with those indices.
+ */
+BOOST_AUTO_TEST_CASE(IndicesTrainingTest)
+{
+  arma::mat data;
+  arma::Row<size_t> labels;
+  data::DatasetInfo datasetInfo;
+  MockCategoricalData(data, labels, datasetInfo);
+  arma::rowvec weights(labels.n_elem, arma::fill::randu);
+
+  // A bootstrap sample, with repeated points.
+  arma::uvec indices = arma::randi<arma::uvec>(data.n_cols,
+      arma::distr_param(0, data.n_cols - 1));
+  arma::mat sampleData = data.cols(indices);
+  arma::Row<size_t> sampleLabels = labels.cols(indices);
+  arma::rowvec sampleWeights = weights.cols(indices);
+
+  DecisionTree<> tree(sampleData, datasetInfo, sampleLabels, 5, 10);
+  DecisionTree<> weightedTree(sampleData, datasetInfo, sampleLabels, 5,
+      sampleWeights, 10);
+  DecisionTree<> numericTree(sampleData, sampleLabels, 5, 10);
+
+  DecisionTree<> indicesTree, weightedIndicesTree, numericIndicesTree;
+  indicesTree.Train<false, true>(data, indices, datasetInfo, labels, 5,
+      weights, 10);
+  weightedIndicesTree.Train<true, true>(data, indices, datasetInfo, labels, 5,
+      weights, 10);
+  numericIndicesTree.Train<false, false>(data, indices, datasetInfo, labels,
+      5, weights, 10);
+
+  arma::Row<size_t> predictions, indicesPredictions;
+  arma::mat probabilities, indicesProbabilities;
+  tree.Classify(data, predictions, probabilities);
+  indicesTree.Classify(data, indicesPredictions, indicesProbabilities);
+  CheckMatrices(predictions, indicesPredictions);
+  CheckMatrices(probabilities, indicesProbabilities);
+
+  weightedTree.Classify(data, predictions, probabilities);
+  weightedIndicesTree.Classify(data, indicesPredictions, indicesProbabilities);
+  CheckMatrices(predictions, indicesPredictions);
+  CheckMatrices(probabilities, indicesProbabilities);
+
+  numericTree.Classify(data, predictions, probabilities);
+  numericIndicesTree.Classify(data, indicesPredictions, indicesProbabilities);
+  CheckMatrices(predictions, indicesPredictions);
+  CheckMatrices(probabilities, indicesProbabilities);
+
+  // Out-of-range indices are rejected.
+  indices[0] = data.n_cols;
+  BOOST_REQUIRE_THROW(indicesTree.Train<false, true>(data, indices,
+      datasetInfo, labels, 5, weights, 10), std::invalid_argument);
+}
+
+/**
+ * A tree trained with several threads (parallel split search and subtree
+ * growth) must be the same as one trained with a single thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainingTest)
+{
+  // Four overlapping Gaussians, so that the tree is deep.
+  arma::mat data(5, 20000);
+  arma::Row<size_t> labels(20000);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    labels[i] = i % 4;
+    data.col(i) = arma::randn<arma::vec>(5) + labels[i];
+  }
+
+  data::DatasetInfo datasetInfo(5);
+  arma::mat categoricalData(data);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    // Make one dimension categorical, with three categories.
+    const double value = std::floor(data(4, i));
+    categoricalData(4, i) = std::min(std::max(value + 1.0, 0.0), 2.0);
+  }
+  datasetInfo.Type(4) = data::Datatype::categorical;
+  datasetInfo.MapString<double>("0", 4);
+  datasetInfo.MapString<double>("1", 4);
+  datasetInfo.MapString<double>("2", 4);
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  DecisionTree<> serialTree(data, labels, 4, 2);
+  DecisionTree<> serialCategoricalTree(categoricalData, datasetInfo, labels, 4,
+      2);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  DecisionTree<> parallelTree(data, labels, 4, 2);
+  DecisionTree<> parallelCategoricalTree(categoricalData, datasetInfo, labels,
+      4, 2);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+
+  arma::Row<size_t> serialPredictions, parallelPredictions;
+  arma::mat serialProbabilities, parallelProbabilities;
+  serialTree.Classify(data, serialPredictions, serialProbabilities);
+  parallelTree.Classify(data, parallelPredictions, parallelProbabilities);
+  CheckMatrices(serialPredictions, parallelPredictions);
+  CheckMatrices(serialProbabilities, parallelProbabilities);
+
+  serialCategoricalTree.Classify(categoricalData, serialPredictions,
+      serialProbabilities);
+  parallelCategoricalTree.Classify(categoricalData, parallelPredictions,
+      parallelProbabilities);
+  CheckMatrices(serialPredictions, parallelPredictions);
+  CheckMatrices(serialProbabilities, parallelProbabilities);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -349,6 +349,48 @@ BOOST_AUTO_TEST_CASE(TestComputeValue)
   BOOST_REQUIRE_CLOSE(0.0, testDTree.ComputeValue(q4), 1e-10);
 }
 
+/**
+ * A tree grown on a dataset large enough to be grown in parallel must be the
+ * same every time, and the batched ComputeValue() must give the same densities
+ * as ComputeValue() on each point.
+ */
+BOOST_AUTO_TEST_CASE(TestBatchComputeValue)
+{
+  arma::mat data(5, 5000, arma::fill::randu);
+  data.row(2) *= 3.0;
+  arma::mat data2(data);
+
+  arma::Col<size_t> oldFromNew = arma::linspace<arma::Col<size_t>>(0,
+      data.n_cols - 1, data.n_cols);
+  arma::Col<size_t> oldFromNew2(oldFromNew);
+
+  DTree<arma::mat> tree(data);
+  DTree<arma::mat> tree2(data2);
+  tree.Grow(data, oldFromNew, false, 10, 5);
+  tree2.Grow(data2, oldFromNew2, false, 10, 5);
+  BOOST_REQUIRE_GT(tree.SubtreeLeaves(), 1);
+  BOOST_REQUIRE_EQUAL(tree.SubtreeLeaves(), tree2.SubtreeLeaves());
+  for (size_t i = 0; i < oldFromNew.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(oldFromNew[i], oldFromNew2[i]);
+
+  // Some queries are outside of the bounding box.
+  arma::mat queries(5, 1000, arma::fill::randu);
+  queries *= 1.2;
+
+  arma::rowvec values;
+  tree.ComputeValue(queries, values);
+  BOOST_REQUIRE_EQUAL(values.n_elem, queries.n_cols);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    const arma::vec query = queries.col(i);
+    const double value = tree.ComputeValue(query);
+    if (value == 0.0)
+      BOOST_REQUIRE_SMALL(values[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(values[i], value, 1e-10);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestVariableImportance)
 {
   arma::mat testData(3, 5);
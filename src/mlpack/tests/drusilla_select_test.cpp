@@ -148,6 +148,41 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   }
 }
 
+// Make sure a model saved as an index gives the same results once it is loaded,
+// and that it can be trained again.
+BOOST_AUTO_TEST_CASE(DrusillaSelectIndexTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 300);
+  DrusillaSelect<> ds(dataset, 4, 6);
+  ds.SaveIndex("drusilla_select_index.bin");
+
+  DrusillaSelect<> loaded(1, 1);
+  loaded.LoadIndex("drusilla_select_index.bin");
+  CheckMatrices(loaded.CandidateSet(), ds.CandidateSet());
+  CheckMatrices(loaded.CandidateIndices(), ds.CandidateIndices());
+
+  arma::Mat<size_t> neighbors, loadedNeighbors;
+  arma::mat distances, loadedDistances;
+  ds.Search(dataset, 5, neighbors, distances);
+  loaded.Search(dataset, 5, loadedNeighbors, loadedDistances);
+  CheckMatrices(loadedNeighbors, neighbors);
+  CheckMatrices(loadedDistances, distances);
+
+  // Training again must not write to the mapped file.
+  arma::mat newDataset = arma::randu<arma::mat>(5, 200);
+  loaded.Train(newDataset, 4, 6);
+  DrusillaSelect<> check(1, 1);
+  check.LoadIndex("drusilla_select_index.bin");
+  CheckMatrices(check.CandidateSet(), ds.CandidateSet());
+  remove("drusilla_select_index.bin");
+
+  // A file that isn't an index can't be loaded.
+  data::Save("drusilla_select_index.csv", dataset);
+  BOOST_REQUIRE_THROW(loaded.LoadIndex("drusilla_select_index.csv"),
+      std::runtime_error);
+  remove("drusilla_select_index.csv");
+}
+
 // Make sure we can create the object with a sparse matrix.
 BOOST_AUTO_TEST_CASE(SparseTest)
 {
@@ -278,4 +278,45 @@ BOOST_AUTO_TEST_CASE(BallTreeTest)
   }
 }
 
+/**
+ * Make sure that the rounds give the same spanning tree with several threads
+ * as with one, for the naive algorithm, for a tree with a parallel dual-tree
+ * traverser, and for a tree without one.
+ */
+template<typename DTBType>
+void CheckParallelMST(const arma::mat& dataset, const bool naive)
+{
+  DTBType serial(dataset, naive);
+  DTBType parallel(dataset, naive);
+  parallel.NumThreads() = 4;
+
+  arma::mat serialResults, parallelResults;
+  serial.ComputeMST(serialResults);
+  parallel.ComputeMST(parallelResults);
+
+  BOOST_REQUIRE_EQUAL(serialResults.n_cols, parallelResults.n_cols);
+  BOOST_REQUIRE_EQUAL(serialResults.n_rows, parallelResults.n_rows);
+
+  for (size_t i = 0; i < serialResults.n_cols; i++)
+  {
+    BOOST_REQUIRE_EQUAL(serialResults(0, i), parallelResults(0, i));
+    BOOST_REQUIRE_EQUAL(serialResults(1, i), parallelResults(1, i));
+    BOOST_REQUIRE_CLOSE(serialResults(2, i), parallelResults(2, i), 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParallelTest)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  CheckParallelMST<DualTreeBoruvka<>>(inputData, true);
+  CheckParallelMST<DualTreeBoruvka<>>(inputData, false);
+  CheckParallelMST<DualTreeBoruvka<EuclideanDistance, arma::mat, BallTree>>(
+      inputData, false);
+  CheckParallelMST<DualTreeBoruvka<EuclideanDistance, arma::mat,
+      StandardCoverTree>>(inputData, false);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
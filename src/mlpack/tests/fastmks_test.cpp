@@ -1082,4 +1082,76 @@ BOOST_AUTO_TEST_CASE(CopyAssignmentTest)
   }
 }
 
+/**
+ * Check that naive search, which evaluates the kernel in blocks, and
+ * single-tree search, which divides the query points between threads, give the
+ * same results as dual-tree search and as evaluating each kernel value by hand.
+ */
+template<typename KernelType>
+void CheckBlockAndParallelSearch(KernelType& kernel)
+{
+  // The sizes are chosen so that the blocks do not fit evenly.
+  arma::mat referenceData = arma::randu<arma::mat>(5, 2500);
+  arma::mat queryData = arma::randu<arma::mat>(5, 300);
+
+  FastMKS<KernelType> naive(referenceData, kernel, false, true);
+  FastMKS<KernelType> single(referenceData, kernel, true);
+  FastMKS<KernelType> dual(referenceData, kernel);
+
+  arma::Mat<size_t> naiveIndices, singleIndices, dualIndices;
+  arma::mat naiveKernels, singleKernels, dualKernels;
+  naive.Search(queryData, 5, naiveIndices, naiveKernels);
+  single.Search(queryData, 5, singleIndices, singleKernels);
+  dual.Search(queryData, 5, dualIndices, dualKernels);
+
+  for (size_t q = 0; q < queryData.n_cols; ++q)
+  {
+    for (size_t r = 0; r < 5; ++r)
+    {
+      BOOST_REQUIRE_EQUAL(naiveIndices(r, q), dualIndices(r, q));
+      BOOST_REQUIRE_EQUAL(singleIndices(r, q), dualIndices(r, q));
+      BOOST_REQUIRE_CLOSE(naiveKernels(r, q), dualKernels(r, q), 1e-5);
+      BOOST_REQUIRE_CLOSE(singleKernels(r, q), dualKernels(r, q), 1e-5);
+      BOOST_REQUIRE_CLOSE(naiveKernels(r, q), kernel.Evaluate(queryData.col(q),
+          referenceData.col(naiveIndices(r, q))), 1e-5);
+    }
+  }
+
+  // Now the monochromatic search, where a point is not its own result.
+  naive.Search(5, naiveIndices, naiveKernels);
+  single.Search(5, singleIndices, singleKernels);
+  dual.Search(5, dualIndices, dualKernels);
+
+  for (size_t q = 0; q < referenceData.n_cols; ++q)
+  {
+    for (size_t r = 0; r < 5; ++r)
+    {
+      BOOST_REQUIRE_NE(naiveIndices(r, q), q);
+      BOOST_REQUIRE_EQUAL(naiveIndices(r, q), dualIndices(r, q));
+      BOOST_REQUIRE_EQUAL(singleIndices(r, q), dualIndices(r, q));
+      BOOST_REQUIRE_CLOSE(naiveKernels(r, q), dualKernels(r, q), 1e-5);
+      BOOST_REQUIRE_CLOSE(singleKernels(r, q), dualKernels(r, q), 1e-5);
+    }
+  }
+}
+
+/**
+ * Test block and parallel search with the kernels that have block evaluation,
+ * and with one that does not.
+ */
+BOOST_AUTO_TEST_CASE(BlockAndParallelSearchTest)
+{
+  LinearKernel lk;
+  CheckBlockAndParallelSearch(lk);
+
+  PolynomialKernel pk(2.0, 1.0);
+  CheckBlockAndParallelSearch(pk);
+
+  CosineDistance cd;
+  CheckBlockAndParallelSearch(cd);
+
+  GaussianKernel gk(0.5);
+  CheckBlockAndParallelSearch(gk);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
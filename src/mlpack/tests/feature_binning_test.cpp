@@ -0,0 +1,144 @@
+/**
+ * @file feature_binning_test.cpp
+ *
+ * Tests for the FeatureBinning class, which stores datasets as the indices of
+ * the quantile bins of their dimensions.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/feature_binning.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+BOOST_AUTO_TEST_SUITE(FeatureBinningTest);
+
+/**
+ * Make sure that each value is in the bin given by the edges, and that the
+ * bins of a dimension with many values hold about as many points each.
+ */
+BOOST_AUTO_TEST_CASE(FeatureBinningEdgesTest)
+{
+  arma::mat dataset = arma::randn<arma::mat>(3, 20000);
+  dataset.row(1) = arma::exp(dataset.row(1));
+
+  FeatureBinning binning;
+  binning.Fit(dataset);
+  BOOST_REQUIRE_EQUAL(binning.Dimensionality(), 3);
+
+  arma::Mat<uint8_t> bins;
+  binning.Transform(dataset, bins);
+  BOOST_REQUIRE_EQUAL(bins.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(bins.n_cols, 20000);
+
+  for (size_t d = 0; d < 3; ++d)
+  {
+    const arma::Col<float>& edges = binning.Edges(d);
+    BOOST_REQUIRE_GT(binning.Bins(d), 200);
+    BOOST_REQUIRE_LE(binning.Bins(d), 256);
+    BOOST_REQUIRE_EQUAL(binning.Bins(d), edges.n_elem + 1);
+    for (size_t b = 1; b < edges.n_elem; ++b)
+      BOOST_REQUIRE_LT(edges[b - 1], edges[b]);
+
+    arma::Col<size_t> counts(binning.Bins(d), arma::fill::zeros);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      const size_t bin = bins(d, i);
+      ++counts[bin];
+      if (bin > 0)
+        BOOST_REQUIRE_GT(dataset(d, i), (double) edges[bin - 1]);
+      if (bin < edges.n_elem)
+        BOOST_REQUIRE_LE(dataset(d, i), binning.Threshold(d, bin));
+    }
+
+    // With quantile edges, no bin is much larger than the others.
+    BOOST_REQUIRE_LT(counts.max(), 4 * 20000 / binning.Bins(d));
+  }
+}
+
+/**
+ * A dimension with few distinct values has one bin for each value, and the
+ * categories of categorical dimensions are their bins.
+ */
+BOOST_AUTO_TEST_CASE(FeatureBinningDistinctValuesTest)
+{
+  arma::mat dataset(2, 1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    dataset(0, i) = 0.5 * (i % 7);
+    dataset(1, i) = (double) (i % 5);
+  }
+
+  DatasetInfo info(2);
+  info.Type(1) = Datatype::categorical;
+  for (size_t c = 0; c < 5; ++c)
+    info.MapString<size_t>(std::to_string(c), 1);
+
+  FeatureBinning binning(16);
+  binning.Fit(dataset, info);
+  BOOST_REQUIRE_EQUAL(binning.Bins(0), 7);
+  BOOST_REQUIRE(!binning.Categorical(0));
+  BOOST_REQUIRE(binning.Categorical(1));
+  BOOST_REQUIRE_EQUAL(binning.Bins(1), 5);
+
+  arma::Mat<uint8_t> bins;
+  binning.Transform(dataset, bins);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(bins(0, i), i % 7);
+    BOOST_REQUIRE_EQUAL(bins(1, i), i % 5);
+  }
+}
+
+/**
+ * Make sure that invalid parameters and data are rejected.
+ */
+BOOST_AUTO_TEST_CASE(FeatureBinningInvalidTest)
+{
+  BOOST_REQUIRE_THROW(FeatureBinning(1), std::invalid_argument);
+  BOOST_REQUIRE_THROW(FeatureBinning(257), std::invalid_argument);
+
+  arma::mat dataset = arma::randu<arma::mat>(4, 100);
+  FeatureBinning binning;
+  binning.Fit(dataset);
+
+  arma::Mat<uint8_t> bins;
+  arma::mat other = arma::randu<arma::mat>(3, 100);
+  BOOST_REQUIRE_THROW(binning.Transform(other, bins), std::invalid_argument);
+  BOOST_REQUIRE_THROW(binning.Fit(dataset, DatasetInfo(3)),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a binning gives the same bins after serialization.
+ */
+BOOST_AUTO_TEST_CASE(FeatureBinningSerializationTest)
+{
+  arma::fmat dataset = arma::randu<arma::fmat>(5, 2000);
+  FeatureBinning binning(64);
+  binning.Fit(dataset);
+
+  FeatureBinning xmlBinning, textBinning, binaryBinning;
+  SerializeObjectAll(binning, xmlBinning, textBinning, binaryBinning);
+
+  arma::Mat<uint8_t> bins, xmlBins, textBins, binaryBins;
+  binning.Transform(dataset, bins);
+  xmlBinning.Transform(dataset, xmlBins);
+  textBinning.Transform(dataset, textBins);
+  binaryBinning.Transform(dataset, binaryBins);
+
+  BOOST_REQUIRE_EQUAL(xmlBinning.MaxBins(), 64);
+  BOOST_REQUIRE(arma::all(arma::vectorise(xmlBins == bins)));
+  BOOST_REQUIRE(arma::all(arma::vectorise(textBins == bins)));
+  BOOST_REQUIRE(arma::all(arma::vectorise(binaryBins == bins)));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -12,10 +12,20 @@
  */
 #include <mlpack/core.hpp>
 
+#include <mlpack/core/optimizers/adam/adam.hpp>
+#include <mlpack/core/optimizers/function/sparse_gradient_function.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/frozen_ffn.hpp>
+#include <mlpack/methods/ann/quantized_ffn.hpp>
+#include <mlpack/methods/ann/static_ffn.hpp>
+#include <mlpack/methods/ann/data_source/file_data_source.hpp>
+#include <mlpack/methods/ann/data_source/matrix_data_source.hpp>
+#include <mlpack/methods/ann/data_source/prefetch_data_source.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -501,6 +511,142 @@ BOOST_AUTO_TEST_CASE(FFNMiscTest)
   movedModel = std::move(copiedModel);
 }
 
+/**
+ * Make sure that the batch versions of Evaluate() and Gradient() give the sums
+ * of the objectives and gradients of the single points.
+ */
+BOOST_AUTO_TEST_CASE(FFNBatchEvaluateGradientTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 20);
+  arma::mat labels(1, 20);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = math::RandInt(1, 4);
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  const size_t begin = 3;
+  const size_t batchSize = 10;
+
+  double objective = 0;
+  arma::mat gradient, pointGradient;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+  {
+    objective += model.Evaluate(model.Parameters(), i);
+    model.Gradient(model.Parameters(), i, pointGradient);
+    if (i == begin)
+      gradient = pointGradient;
+    else
+      gradient += pointGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), begin, batchSize),
+      objective, 1e-5);
+
+  arma::mat batchGradient;
+  model.Gradient(model.Parameters(), begin, batchGradient, batchSize);
+  CheckMatrices(batchGradient, gradient);
+}
+
+/**
+ * Make sure that splitting a batch between threads gives the same objective
+ * and gradient as a single thread, and that the split result is reproducible.
+ */
+BOOST_AUTO_TEST_CASE(FFNParallelEvaluateGradientTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 40);
+  arma::mat labels(1, 40);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = math::RandInt(1, 4);
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  const size_t begin = 5;
+  const size_t batchSize = 30;
+
+  arma::mat gradient;
+  model.Gradient(model.Parameters(), begin, gradient, batchSize);
+  const double objective = model.Evaluate(model.Parameters(), begin,
+      batchSize);
+
+  model.NumThreads() = 4;
+  arma::mat parallelGradient, parallelGradient2;
+  model.Gradient(model.Parameters(), begin, parallelGradient, batchSize);
+  model.Gradient(model.Parameters(), begin, parallelGradient2, batchSize);
+
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), begin, batchSize),
+      objective, 1e-5);
+  CheckMatrices(parallelGradient, gradient);
+
+  // The reduction is done in a fixed order.
+  for (size_t i = 0; i < parallelGradient.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(parallelGradient[i], parallelGradient2[i]);
+
+  // Changing the parameters must be seen by the threads.
+  model.Parameters() *= 0.5;
+  model.NumThreads() = 1;
+  model.Gradient(model.Parameters(), begin, gradient, batchSize);
+  model.NumThreads() = 4;
+  model.Gradient(model.Parameters(), begin, parallelGradient, batchSize);
+  CheckMatrices(parallelGradient, gradient);
+}
+
+/**
+ * Train the vanilla network with mini-batch SGD, which uses the batch versions
+ * of Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchVanillaNetworkTest)
+{
+  arma::mat dataset;
+  data::Load("thyroid_train.csv", dataset, true);
+
+  arma::mat trainData = dataset.submat(0, 0, dataset.n_rows - 4,
+      dataset.n_cols - 1);
+
+  arma::mat trainLabelsTemp = dataset.submat(dataset.n_rows - 3, 0,
+      dataset.n_rows - 1, dataset.n_cols - 1);
+  arma::mat trainLabels = arma::zeros<arma::mat>(1, trainLabelsTemp.n_cols);
+  for (size_t i = 0; i < trainLabelsTemp.n_cols; ++i)
+  {
+    trainLabels(i) = arma::as_scalar(arma::find(
+        arma::max(trainLabelsTemp.col(i)) == trainLabelsTemp.col(i), 1)) + 1;
+  }
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(trainData.n_rows, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  // 100 epochs with batches of 20 points.
+  const size_t batchSize = 20;
+  MiniBatchSGD opt(batchSize, 0.1, 100 * trainData.n_cols / batchSize, -1);
+  model.Train(trainData, trainLabels, opt);
+
+  arma::mat predictionTemp;
+  model.Predict(trainData, predictionTemp);
+
+  size_t correct = 0;
+  for (size_t i = 0; i < predictionTemp.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(predictionTemp.col(i)) == predictionTemp.col(i), 1)) + 1;
+    if (prediction == size_t(trainLabels(i)))
+      ++correct;
+  }
+
+  // About 92 percent of the patients are not hyperthyroid, so the network
+  // should do at least that well.
+  BOOST_REQUIRE_GE(double(correct) / trainData.n_cols, 0.92);
+}
+
 /**
  * Test that serialization works ok.
  */
@@ -567,4 +713,513 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
       binaryPredictions);
 }
 
+/**
+ * Make sure that a frozen network predicts the same results as the network it
+ * was frozen from, also after serialization, and that networks with layers
+ * that cannot be frozen are rejected.
+ */
+BOOST_AUTO_TEST_CASE(FrozenFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(6, 30);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(6, 10);
+  model.Add<ReLULayer<> >();
+  model.Add<Dropout<> >(0.3);
+  model.Add<Linear<> >(10, 8);
+  model.Add<Dropout<> >(0.2);
+  model.Add<TanHLayer<> >();
+  model.Add<LinearNoBias<> >(8, 5);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Dropout<> >(0.5);
+  model.Add<Linear<> >(5, 3);
+  model.Add<LogSoftMax<> >();
+
+  FrozenFFN frozen(model);
+
+  // The Dropout layers are folded into the weights, and each activation is
+  // fused with the linear layer before it.
+  BOOST_REQUIRE_EQUAL(frozen.Stages(), 4);
+  BOOST_REQUIRE_EQUAL(frozen.Activation(0), FrozenFFN::RECTIFIER);
+  BOOST_REQUIRE_EQUAL(frozen.Activation(1), FrozenFFN::TANH);
+  BOOST_REQUIRE_EQUAL(frozen.Activation(2), FrozenFFN::LOGISTIC);
+  BOOST_REQUIRE_EQUAL(frozen.Activation(3), FrozenFFN::LOG_SOFTMAX);
+  BOOST_REQUIRE(frozen.Bias(2).is_empty());
+
+  arma::mat predictions, frozenPredictions;
+  model.Predict(data, predictions);
+  frozen.Predict(data, frozenPredictions);
+  CheckMatrices(predictions, frozenPredictions, 1e-3);
+
+  // Predicting again reuses the buffers and gives the same results.
+  frozen.Predict(data, frozenPredictions);
+  CheckMatrices(predictions, frozenPredictions, 1e-3);
+
+  FrozenFFN xmlFrozen, textFrozen, binaryFrozen;
+  SerializeObjectAll(frozen, xmlFrozen, textFrozen, binaryFrozen);
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlFrozen.Predict(data, xmlPredictions);
+  textFrozen.Predict(data, textPredictions);
+  binaryFrozen.Predict(data, binaryPredictions);
+  CheckMatrices(frozenPredictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+
+  FFN<NegativeLogLikelihood<> > unsupportedModel;
+  unsupportedModel.Add<Linear<> >(6, 3);
+  unsupportedModel.Add<LeakyReLU<> >();
+  BOOST_REQUIRE_THROW(FrozenFFN unsupportedFrozen(unsupportedModel),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the approximations of the activation functions give nearly
+ * the same predictions as the exact functions, in a network and in the frozen
+ * network, where the biases are added by the approximations.
+ */
+BOOST_AUTO_TEST_CASE(ActivationModeTest)
+{
+  arma::mat data = arma::randu<arma::mat>(6, 30);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(6, 10);
+  model.Add<TanHLayer<> >();
+  model.Add<Linear<> >(10, 5);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(5, 3);
+  model.Add<LogSoftMax<> >();
+  BOOST_REQUIRE_EQUAL(model.ActivationMode(), EXACT_ACTIVATIONS);
+
+  arma::mat predictions, trainingPredictions, inferencePredictions;
+  model.Predict(data, predictions);
+  model.ActivationMode() = TRAINING_ACTIVATIONS;
+  model.Predict(data, trainingPredictions);
+  model.ActivationMode() = INFERENCE_ACTIVATIONS;
+  model.Predict(data, inferencePredictions);
+  CheckMatrices(predictions, trainingPredictions, 1e-3);
+  CheckMatrices(predictions, inferencePredictions, 1e-3);
+
+  // The frozen network has the accuracy of the network.
+  FrozenFFN frozen(model);
+  BOOST_REQUIRE_EQUAL(frozen.ActivationMode(), INFERENCE_ACTIVATIONS);
+
+  arma::mat frozenPredictions;
+  frozen.Predict(data, frozenPredictions);
+  CheckMatrices(inferencePredictions, frozenPredictions, 1e-3);
+
+  frozen.ActivationMode() = TRAINING_ACTIVATIONS;
+  frozen.Predict(data, frozenPredictions);
+  CheckMatrices(trainingPredictions, frozenPredictions, 1e-3);
+}
+
+/**
+ * Make sure that a quantized network predicts nearly the same results as the
+ * network it was quantized from, that it reports its error on the calibration
+ * points, and that serialization keeps the predictions.
+ */
+BOOST_AUTO_TEST_CASE(QuantizedFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(6, 200);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(6, 20);
+  model.Add<ReLULayer<> >();
+  model.Add<Dropout<> >(0.3);
+  model.Add<Linear<> >(20, 10);
+  model.Add<TanHLayer<> >();
+  model.Add<Linear<> >(10, 3);
+  model.Add<LogSoftMax<> >();
+
+  QuantizedFFN quantized(model, data);
+
+  // The Dropout layer is folded into the weights, and each activation is
+  // fused with the linear layer before it.
+  BOOST_REQUIRE_EQUAL(quantized.Stages(), 3);
+  BOOST_REQUIRE_EQUAL(quantized.Type(0), QuantizedFFN::LINEAR);
+  BOOST_REQUIRE_EQUAL(quantized.Activation(0), QuantizedFFN::RECTIFIER);
+  BOOST_REQUIRE_EQUAL(quantized.Activation(1), QuantizedFFN::TANH);
+  BOOST_REQUIRE_EQUAL(quantized.Activation(2), QuantizedFFN::LOG_SOFTMAX);
+  BOOST_REQUIRE_EQUAL(quantized.Weight(0).n_rows, 6);
+  BOOST_REQUIRE_EQUAL(quantized.Weight(0).n_cols, 20);
+
+  arma::mat predictions, quantizedPredictions;
+  model.Predict(data, predictions);
+  quantized.Predict(data, quantizedPredictions);
+  const double maxError = arma::abs(predictions - quantizedPredictions).max();
+  BOOST_REQUIRE_SMALL(maxError, 0.15);
+  BOOST_REQUIRE_CLOSE(quantized.CalibrationError(), maxError, 1e-5);
+  BOOST_REQUIRE_GE(quantized.CalibrationAgreement(), 0.95);
+
+  // Points outside of the calibration range are clamped, but still close.
+  arma::mat testData = arma::randu<arma::mat>(6, 50);
+  model.Predict(testData, predictions);
+  double testError, testAgreement;
+  quantized.Compare(testData, predictions, testError, testAgreement);
+  BOOST_REQUIRE_SMALL(testError, 0.15);
+  BOOST_REQUIRE_GE(testAgreement, 0.9);
+
+  QuantizedFFN xmlQuantized, textQuantized, binaryQuantized;
+  SerializeObjectAll(quantized, xmlQuantized, textQuantized, binaryQuantized);
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlQuantized.Predict(data, xmlPredictions);
+  textQuantized.Predict(data, textPredictions);
+  binaryQuantized.Predict(data, binaryPredictions);
+  CheckMatrices(quantizedPredictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+  BOOST_REQUIRE_EQUAL(xmlQuantized.CalibrationError(),
+      quantized.CalibrationError());
+
+  FFN<NegativeLogLikelihood<> > unsupportedModel;
+  unsupportedModel.Add<Linear<> >(6, 3);
+  unsupportedModel.Add<LeakyReLU<> >();
+  BOOST_REQUIRE_THROW(QuantizedFFN unsupportedQuantized(unsupportedModel,
+      data), std::invalid_argument);
+}
+
+/**
+ * Make sure that the quantized convolutions (with padding and strides) predict
+ * nearly the same results as the network.
+ */
+BOOST_AUTO_TEST_CASE(QuantizedFFNConvolutionTest)
+{
+  arma::mat data = arma::randu<arma::mat>(49, 100);
+
+  // 7x7 input, 3x3 filters with padding 1: two 7x7 maps.
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Convolution<> >(1, 2, 3, 3, 1, 1, 1, 1, 7, 7);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(98, 3);
+  model.Add<LogSoftMax<> >();
+
+  QuantizedFFN quantized(model, data);
+  BOOST_REQUIRE_EQUAL(quantized.Stages(), 2);
+  BOOST_REQUIRE_EQUAL(quantized.Type(0), QuantizedFFN::CONVOLUTION);
+  BOOST_REQUIRE_EQUAL(quantized.Weight(0).n_rows, 9);
+  BOOST_REQUIRE_EQUAL(quantized.Weight(0).n_cols, 2);
+
+  arma::mat predictions, quantizedPredictions;
+  model.Predict(data, predictions);
+  quantized.Predict(data, quantizedPredictions);
+  BOOST_REQUIRE_SMALL(arma::abs(predictions - quantizedPredictions).max(),
+      0.15);
+  BOOST_REQUIRE_GE(quantized.CalibrationAgreement(), 0.9);
+}
+
+/**
+ * Make sure that a static network with the parameters of a trained network
+ * predicts the same results as that network, also after copying and
+ * serialization.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(6, 30);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(6, 10);
+  model.Add<ReLULayer<> >();
+  model.Add<Dropout<> >(0.3);
+  model.Add<Linear<> >(10, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  typedef StaticFFN<Linear<>, ReLULayer<>, Dropout<>, Linear<>, LogSoftMax<> >
+      StaticNetwork;
+  StaticNetwork network(Linear<>(6, 10), ReLULayer<>(), Dropout<>(0.3),
+      Linear<>(10, 3), LogSoftMax<>());
+  BOOST_REQUIRE_EQUAL(StaticNetwork::Size(), 5);
+  BOOST_REQUIRE_EQUAL(network.Parameters().n_elem,
+      model.Parameters().n_elem);
+
+  network.Parameters() = model.Parameters();
+
+  arma::mat predictions, staticPredictions;
+  model.Predict(data, predictions);
+  network.Predict(data, staticPredictions);
+  CheckMatrices(predictions, staticPredictions);
+
+  // A copy uses its own parameters.
+  StaticNetwork copy(network);
+  network.Parameters().zeros();
+
+  arma::mat copyPredictions;
+  copy.Predict(data, copyPredictions);
+  CheckMatrices(predictions, copyPredictions);
+
+  StaticNetwork xmlNetwork, textNetwork, binaryNetwork;
+  SerializeObjectAll(copy, xmlNetwork, textNetwork, binaryNetwork);
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlNetwork.Predict(data, xmlPredictions);
+  textNetwork.Predict(data, textPredictions);
+  binaryNetwork.Predict(data, binaryPredictions);
+  CheckMatrices(predictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+}
+
+/**
+ * Make sure that the sparse gradient of a network with a lookup layer is the
+ * same as the dense gradient, and that it can be used for training.
+ */
+BOOST_AUTO_TEST_CASE(FFNSparseGradientTest)
+{
+  const size_t vocabulary = 50;
+  const size_t points = 200;
+
+  // The class of each word only depends on the word.
+  arma::mat data(1, points);
+  arma::mat labels(1, points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    data[i] = 1 + math::RandInt(vocabulary);
+    labels[i] = 1 + ((size_t) data[i] % 2);
+  }
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Lookup<> >(vocabulary, 8);
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat denseGradient;
+  arma::sp_mat sparseGradient;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    const double denseObjective = model.EvaluateWithGradient(
+        model.Parameters(), i, denseGradient);
+    const double sparseObjective = model.EvaluateWithGradient(
+        model.Parameters(), i, sparseGradient);
+
+    BOOST_REQUIRE_CLOSE(denseObjective, sparseObjective, 1e-8);
+    CheckMatrices(denseGradient, arma::mat(sparseGradient));
+
+    // Only one column of the embedding is in the sparse gradient.
+    BOOST_REQUIRE_LE(sparseGradient.n_nonzero, 8 + 8 * 2 + 2);
+  }
+
+  const double denseObjective = model.EvaluateWithGradient(
+      model.Parameters(), 0, denseGradient, 20);
+  const double sparseObjective = model.EvaluateWithGradient(
+      model.Parameters(), 0, sparseGradient, 20);
+  BOOST_REQUIRE_CLOSE(denseObjective, sparseObjective, 1e-8);
+  CheckMatrices(denseGradient, arma::mat(sparseGradient));
+
+  // Only the wrapper makes SGD use sparse gradients.
+  typedef SparseGradientFunction<FFN<NegativeLogLikelihood<> > > FunctionType;
+  BOOST_REQUIRE(!HasSparseGradient<FFN<NegativeLogLikelihood<> > >::value);
+  BOOST_REQUIRE(HasSparseGradient<FunctionType>::value);
+
+  FunctionType f(model);
+  Adam adam(0.05, 0.9, 0.999, 1e-8, 20 * points, 1e-10);
+  adam.Optimize(f, model.Parameters());
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+  size_t correct = 0;
+  for (size_t i = 0; i < points; ++i)
+  {
+    arma::uword label;
+    predictions.col(i).max(label);
+    if (label + 1 == labels[i])
+      ++correct;
+  }
+
+  BOOST_REQUIRE_GE(correct, points * 9 / 10);
+}
+
+/**
+ * Collect the batches of one epoch of the given data source, and make sure
+ * that they have the expected sizes and hold matching predictors and responses.
+ */
+template<typename DataSourceType>
+arma::mat CollectEpoch(DataSourceType& source,
+                       const size_t batchSize,
+                       const size_t points)
+{
+  arma::mat epoch, predictors, responses;
+  source.Reset();
+  while (source.NextBatch(predictors, responses))
+  {
+    BOOST_REQUIRE_LE(predictors.n_cols, batchSize);
+    BOOST_REQUIRE_GT(predictors.n_cols, 0);
+    CheckMatrices(predictors.row(0), responses);
+    epoch = arma::join_rows(epoch, predictors);
+  }
+
+  BOOST_REQUIRE_EQUAL(epoch.n_cols, points);
+  return epoch;
+}
+
+/**
+ * Make sure that the data sources pass every point once per epoch, that the
+ * prefetching data source passes the batches of its source in order and that
+ * it passes on the exceptions of its source.
+ */
+BOOST_AUTO_TEST_CASE(DataSourceTest)
+{
+  // The first row of the predictors and the responses hold the point index.
+  arma::mat predictors = arma::randu<arma::mat>(3, 23);
+  predictors.row(0) = arma::linspace<arma::rowvec>(0, 22, 23);
+  arma::mat responses = predictors.row(0);
+  const arma::rowvec indices = predictors.row(0);
+
+  MatrixDataSource source(predictors, responses, 5);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::mat epoch = CollectEpoch(source, 5, 23);
+    CheckMatrices(arma::sort(arma::rowvec(epoch.row(0))), indices);
+  }
+
+  MatrixDataSource orderedSource(predictors, responses, 5, false);
+  CheckMatrices(CollectEpoch(orderedSource, 5, 23), predictors);
+
+  PrefetchDataSource<MatrixDataSource> prefetch(orderedSource, 1);
+  for (size_t i = 0; i < 2; ++i)
+    CheckMatrices(CollectEpoch(prefetch, 5, 23), predictors);
+
+  // Abandoning an epoch and starting a new one is fine.
+  arma::mat batchPredictors, batchResponses;
+  prefetch.Reset();
+  BOOST_REQUIRE(prefetch.NextBatch(batchPredictors, batchResponses));
+  CheckMatrices(CollectEpoch(prefetch, 5, 23), predictors);
+
+  // Split the points into two chunks on disk.
+  data::Save("data_source_x0.csv", arma::mat(predictors.cols(0, 9)));
+  data::Save("data_source_y0.csv", arma::mat(responses.cols(0, 9)));
+  data::Save("data_source_x1.csv", arma::mat(predictors.cols(10, 22)));
+  data::Save("data_source_y1.csv", arma::mat(responses.cols(10, 22)));
+
+  FileDataSource fileSource({ "data_source_x0.csv", "data_source_x1.csv" },
+      { "data_source_y0.csv", "data_source_y1.csv" }, 4);
+  PrefetchDataSource<FileDataSource> filePrefetch(fileSource);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::mat epoch = CollectEpoch(filePrefetch, 4, 23);
+    CheckMatrices(arma::sort(arma::rowvec(epoch.row(0))), indices);
+  }
+
+  remove("data_source_x0.csv");
+  remove("data_source_y0.csv");
+  remove("data_source_x1.csv");
+  remove("data_source_y1.csv");
+
+  FileDataSource missingSource({ "data_source_missing.csv" },
+      { "data_source_missing.csv" });
+  PrefetchDataSource<FileDataSource> missingPrefetch(missingSource);
+  missingPrefetch.Reset();
+  BOOST_REQUIRE_THROW(missingPrefetch.NextBatch(batchPredictors,
+      batchResponses), std::runtime_error);
+
+  BOOST_REQUIRE_THROW(MatrixDataSource(predictors, responses.cols(0, 9)),
+      std::invalid_argument);
+}
+
+/**
+ * Train a network on batches that are prefetched in the background.
+ */
+BOOST_AUTO_TEST_CASE(DataSourceTrainTest)
+{
+  arma::mat dataset;
+  dataset.load("mnist_first250_training_4s_and_9s.arm");
+
+  // Normalize each point since these are images.
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) /= norm(dataset.col(i), 2);
+
+  arma::mat labels = arma::zeros(1, dataset.n_cols);
+  labels.submat(0, labels.n_cols / 2, 0, labels.n_cols - 1).fill(1);
+  labels += 1;
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(dataset.n_rows, 10);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(10, 2);
+  model.Add<LogSoftMax<> >();
+
+  MatrixDataSource source(dataset, labels, 10);
+  PrefetchDataSource<MatrixDataSource> prefetch(source);
+
+  // One step per batch, keeping the state of the update policy.
+  MiniBatchSGD opt(10, 0.1, 2, -1, false, VanillaUpdate(), NoDecay(), false);
+  model.Train(prefetch, opt, 30);
+
+  arma::mat predictions;
+  model.Predict(dataset, predictions);
+
+  size_t correct = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(predictions.col(i)) == predictions.col(i), 1)) + 1;
+    if (prediction == size_t(labels(i)))
+      correct++;
+  }
+
+  BOOST_REQUIRE_GE(double(correct) / dataset.n_cols, 0.8);
+}
+
+/**
+ * Train a network in single precision, and make sure that it classifies the
+ * data and that its predictions match a double precision network with the same
+ * weights.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionNetworkTest)
+{
+  arma::mat dataset;
+  dataset.load("mnist_first250_training_4s_and_9s.arm");
+
+  // Normalize each point since these are images.
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) /= norm(dataset.col(i), 2);
+
+  arma::mat labels = arma::zeros(1, dataset.n_cols);
+  labels.submat(0, labels.n_cols / 2, 0, labels.n_cols - 1).fill(1);
+  labels += 1;
+
+  const arma::fmat fDataset = arma::conv_to<arma::fmat>::from(dataset);
+  const arma::fmat fLabels = arma::conv_to<arma::fmat>::from(labels);
+
+  FFN<NegativeLogLikelihood<arma::fmat, arma::fmat>, RandomInitialization,
+      arma::fmat> model;
+  model.Add<Linear<arma::fmat, arma::fmat> >(dataset.n_rows, 10);
+  model.Add<SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat> >();
+  model.Add<Linear<arma::fmat, arma::fmat> >(10, 2);
+  model.Add<LogSoftMax<arma::fmat, arma::fmat> >();
+
+  StandardSGD opt(0.1, 30 * dataset.n_cols, -1);
+  model.Train(fDataset, fLabels, opt);
+
+  arma::fmat predictions;
+  model.Predict(fDataset, predictions);
+
+  size_t correct = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(predictions.col(i)) == predictions.col(i), 1)) + 1;
+    if (prediction == size_t(labels(i)))
+      correct++;
+  }
+
+  BOOST_REQUIRE_GE(double(correct) / dataset.n_cols, 0.8);
+
+  // The same network in double precision, with the trained weights.
+  FFN<NegativeLogLikelihood<> > doubleModel;
+  doubleModel.Add<Linear<> >(dataset.n_rows, 10);
+  doubleModel.Add<SigmoidLayer<> >();
+  doubleModel.Add<Linear<> >(10, 2);
+  doubleModel.Add<LogSoftMax<> >();
+  doubleModel.ResetParameters();
+  doubleModel.Parameters() = arma::conv_to<arma::mat>::from(
+      model.Parameters());
+
+  arma::mat doublePredictions;
+  doubleModel.Predict(dataset, doublePredictions);
+
+  BOOST_REQUIRE_EQUAL(doublePredictions.n_rows, predictions.n_rows);
+  BOOST_REQUIRE_EQUAL(doublePredictions.n_cols, predictions.n_cols);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(doublePredictions[i] - predictions[i], 1e-4);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
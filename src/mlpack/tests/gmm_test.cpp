@@ -13,6 +13,7 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/gmm/diagonal_gmm.hpp>
 
 #include <mlpack/methods/gmm/no_constraint.hpp>
 #include <mlpack/methods/gmm/positive_definite_constraint.hpp>
@@ -462,6 +463,53 @@ BOOST_AUTO_TEST_CASE(GMMClassifyTest)
   BOOST_REQUIRE_EQUAL(classes[12], 2);
 }
 
+/**
+ * Make sure that the batch log-probabilities and classifications of a GMM in
+ * higher dimensions, over several blocks of points, match the probabilities
+ * of each point.
+ */
+BOOST_AUTO_TEST_CASE(GMMBatchLogProbabilityTest)
+{
+  const size_t d = 16;
+  GMM gmm(4, d);
+  for (size_t i = 0; i < 4; ++i)
+  {
+    arma::mat factor = arma::randu<arma::mat>(d, d);
+    arma::mat covariance = factor * factor.t() + 0.5 * arma::eye(d, d);
+    gmm.Component(i) = distribution::GaussianDistribution(
+        arma::randu<arma::vec>(d), covariance);
+  }
+  gmm.Weights() = "0.1 0.2 0.3 0.4";
+
+  arma::mat observations = 2 * arma::randu<arma::mat>(d, 2500);
+
+  arma::vec logProbabilities;
+  gmm.LogProbability(observations, logProbabilities);
+  arma::Row<size_t> classes;
+  gmm.Classify(observations, classes);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, observations.n_cols);
+  BOOST_REQUIRE_EQUAL(classes.n_elem, observations.n_cols);
+  for (size_t j = 0; j < observations.n_cols; ++j)
+  {
+    BOOST_REQUIRE_CLOSE(logProbabilities[j],
+        std::log(gmm.Probability(observations.col(j))), 1e-5);
+
+    size_t bestComponent = 0;
+    double bestProbability = 0.0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+      const double p = gmm.Probability(observations.col(j), i);
+      if (p >= bestProbability)
+      {
+        bestProbability = p;
+        bestComponent = i;
+      }
+    }
+    BOOST_REQUIRE_EQUAL(classes[j], bestComponent);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(GMMLoadSaveTest)
 {
   // Create a GMM, save it, and load it.
@@ -857,4 +905,253 @@ BOOST_AUTO_TEST_CASE(DiagonalGMMTrainTest)
   }
 }
 
+/**
+ * The blocked E-step must give the same responsibilities and log-likelihood as
+ * computing the probability of each component directly, and must still give
+ * proper responsibilities for points whose probabilities underflow.
+ */
+BOOST_AUTO_TEST_CASE(GMMResponsibilitiesTest)
+{
+  std::vector<distribution::GaussianDistribution> dists;
+  dists.push_back(distribution::GaussianDistribution("0.0 0.0",
+      "1.0 0.3; 0.3 1.0"));
+  dists.push_back(distribution::GaussianDistribution("3.0 1.0",
+      "0.5 0.0; 0.0 2.0"));
+  dists.push_back(distribution::GaussianDistribution("-2.0 4.0",
+      "2.0 -0.5; -0.5 1.0"));
+  const arma::vec weights("0.5 0.3 0.2");
+
+  // More points than one block.
+  arma::mat points(2, 3000, arma::fill::randn);
+  points *= 3.0;
+
+  arma::mat responsibilities;
+  const double logLikelihood = ComputeResponsibilities(points, dists, weights,
+      &responsibilities);
+  BOOST_REQUIRE_EQUAL(responsibilities.n_rows, points.n_cols);
+  BOOST_REQUIRE_EQUAL(responsibilities.n_cols, dists.size());
+
+  double trueLogLikelihood = 0.0;
+  for (size_t j = 0; j < points.n_cols; ++j)
+  {
+    arma::vec probs(dists.size());
+    for (size_t i = 0; i < dists.size(); ++i)
+      probs[i] = weights[i] * dists[i].Probability(points.col(j));
+    trueLogLikelihood += std::log(arma::accu(probs));
+    probs /= arma::accu(probs);
+
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      if (probs[i] < 1e-10)
+        BOOST_REQUIRE_SMALL(responsibilities(j, i), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(responsibilities(j, i), probs[i], 1e-5);
+    }
+  }
+
+  BOOST_REQUIRE_CLOSE(logLikelihood, trueLogLikelihood, 1e-8);
+  BOOST_REQUIRE_CLOSE(ComputeLogLikelihood(points, dists, weights),
+      trueLogLikelihood, 1e-8);
+
+  // The density of every component underflows this far away, but the point
+  // still belongs to the widest component in its direction.
+  arma::mat farPoint("1000.0; 0.0");
+  ComputeResponsibilities(farPoint, dists, weights, &responsibilities);
+  BOOST_REQUIRE_CLOSE(arma::accu(responsibilities.row(0)), 1.0, 1e-8);
+  BOOST_REQUIRE_GT(responsibilities(0, 2), 0.99);
+}
+
+/**
+ * Mini-batch EM should recover well-separated Gaussians, also when the
+ * probabilities of the points are given.
+ */
+BOOST_AUTO_TEST_CASE(GMMTrainMiniBatchEMTest)
+{
+  distribution::GaussianDistribution g1("0.0 0.0 0.0", "1.0 0.2 0.0; "
+      "0.2 1.0 0.0; 0.0 0.0 1.0");
+  distribution::GaussianDistribution g2("10.0 10.0 0.0", "2.0 0.0 0.0; "
+      "0.0 0.5 0.0; 0.0 0.0 1.0");
+  distribution::GaussianDistribution g3("-10.0 5.0 5.0", "1.0 0.0 0.0; "
+      "0.0 1.0 0.0; 0.0 0.0 1.0");
+
+  arma::mat data(3, 6000);
+  for (size_t i = 0; i < 3000; ++i)
+    data.col(i) = g1.Random();
+  for (size_t i = 3000; i < 5000; ++i)
+    data.col(i) = g2.Random();
+  for (size_t i = 5000; i < 6000; ++i)
+    data.col(i) = g3.Random();
+
+  for (size_t weighted = 0; weighted < 2; ++weighted)
+  {
+    EMFit<> fitter(20, 1e-5);
+    fitter.BatchSize() = 500;
+
+    GMM gmm(3, 3);
+    if (weighted == 1)
+    {
+      const arma::vec probabilities(data.n_cols, arma::fill::ones);
+      gmm.Train(data, probabilities, 1, false, fitter);
+    }
+    else
+    {
+      gmm.Train(data, 1, false, fitter);
+    }
+
+    const arma::vec trueWeights("0.5 0.3333333 0.1666667");
+    const arma::uvec sortTry = arma::sort_index(gmm.Weights(), "descend");
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(sortTry[0]).Mean() -
+        g1.Mean()), 0.3);
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(sortTry[1]).Mean() -
+        g2.Mean()), 0.3);
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(sortTry[2]).Mean() -
+        g3.Mean()), 0.3);
+    for (size_t i = 0; i < 3; ++i)
+      BOOST_REQUIRE_SMALL(gmm.Weights()[sortTry[i]] - trueWeights[i], 0.03);
+  }
+}
+
+/**
+ * Training with several trials runs the trials in parallel; the model that is
+ * chosen must not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(GMMParallelTrialsTest)
+{
+  distribution::GaussianDistribution g1("0.0 0.0", "1.0 0.3; 0.3 1.0");
+  distribution::GaussianDistribution g2("4.0 4.0", "1.0 0.0; 0.0 2.0");
+  distribution::GaussianDistribution g3("-4.0 3.0", "0.5 0.0; 0.0 0.5");
+
+  arma::mat data(2, 1500);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    data.col(i + 500) = g2.Random();
+    data.col(i + 1000) = g3.Random();
+  }
+  const arma::vec probabilities = arma::randu<arma::vec>(data.n_cols);
+
+  for (size_t weighted = 0; weighted < 2; ++weighted)
+  {
+    std::vector<GMM> gmms;
+    std::vector<double> likelihoods;
+    for (size_t threads = 1; threads <= 4; threads += 3)
+    {
+      #ifdef HAS_OPENMP
+        const int oldThreads = omp_get_max_threads();
+        omp_set_num_threads((int) threads);
+      #endif
+
+      math::RandomSeed(42);
+      gmms.push_back(GMM(3, 2));
+      if (weighted == 1)
+        likelihoods.push_back(gmms.back().Train(data, probabilities, 5));
+      else
+        likelihoods.push_back(gmms.back().Train(data, 5));
+
+      #ifdef HAS_OPENMP
+        omp_set_num_threads(oldThreads);
+      #endif
+    }
+
+    BOOST_REQUIRE_EQUAL(likelihoods[0], likelihoods[1]);
+    for (size_t i = 0; i < 3; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(gmms[0].Weights()[i], gmms[1].Weights()[i]);
+      for (size_t d = 0; d < 2; ++d)
+      {
+        BOOST_REQUIRE_EQUAL(gmms[0].Component(i).Mean()[d],
+            gmms[1].Component(i).Mean()[d]);
+      }
+    }
+  }
+}
+
+/**
+ * A DiagonalGaussianDistribution must give the same log-probabilities as a
+ * GaussianDistribution with the corresponding diagonal covariance.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianLogProbabilityTest)
+{
+  const arma::vec mean("1.0 -2.0 0.5 3.0");
+  const arma::vec covariance("0.5 2.0 1.0 4.0");
+  distribution::DiagonalGaussianDistribution d(mean, covariance);
+  distribution::GaussianDistribution g(mean, arma::diagmat(covariance));
+
+  arma::mat points(4, 100, arma::fill::randn);
+  points *= 3.0;
+
+  arma::vec diagonalLogProbs, logProbs;
+  d.LogProbability(points, diagonalLogProbs);
+  g.LogProbability(points, logProbs);
+
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(diagonalLogProbs[i], logProbs[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.LogProbability(points.col(i)), logProbs[i], 1e-5);
+  }
+}
+
+/**
+ * A DiagonalGMM should recover well-separated diagonal Gaussians, both with
+ * regular and with mini-batch EM, and score points like the equivalent GMM.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMEMFitTest)
+{
+  distribution::DiagonalGaussianDistribution d1("0.0 0.0 0.0", "1.0 0.5 2.0");
+  distribution::DiagonalGaussianDistribution d2("10.0 10.0 0.0",
+      "2.0 1.0 0.5");
+  distribution::DiagonalGaussianDistribution d3("-10.0 5.0 5.0",
+      "1.0 1.0 1.0");
+
+  arma::mat data(3, 6000);
+  for (size_t i = 0; i < 3000; ++i)
+    data.col(i) = d1.Random();
+  for (size_t i = 3000; i < 5000; ++i)
+    data.col(i) = d2.Random();
+  for (size_t i = 5000; i < 6000; ++i)
+    data.col(i) = d3.Random();
+
+  for (size_t batchSize = 0; batchSize <= 500; batchSize += 500)
+  {
+    DiagonalGMM::DefaultFittingType fitter(100, 1e-5);
+    fitter.BatchSize() = batchSize;
+
+    DiagonalGMM gmm(3, 3);
+    gmm.Train(data, 1, false, fitter);
+
+    const arma::vec trueWeights("0.5 0.3333333 0.1666667");
+    const arma::uvec sortTry = arma::sort_index(gmm.Weights(), "descend");
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(sortTry[0]).Mean() -
+        d1.Mean()), 0.3);
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(sortTry[1]).Mean() -
+        d2.Mean()), 0.3);
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(sortTry[2]).Mean() -
+        d3.Mean()), 0.3);
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(sortTry[0]).Covariance() -
+        d1.Covariance()), 0.3);
+    for (size_t i = 0; i < 3; ++i)
+      BOOST_REQUIRE_SMALL(gmm.Weights()[sortTry[i]] - trueWeights[i], 0.03);
+
+    // The equivalent full-covariance GMM gives the same probabilities.
+    std::vector<distribution::GaussianDistribution> dists;
+    for (size_t i = 0; i < 3; ++i)
+    {
+      dists.push_back(distribution::GaussianDistribution(
+          gmm.Component(i).Mean(),
+          arma::diagmat(gmm.Component(i).Covariance())));
+    }
+    GMM fullGMM(dists, gmm.Weights());
+
+    arma::vec logProbabilities;
+    gmm.LogProbability(data.cols(0, 99), logProbabilities);
+    for (size_t i = 0; i < 100; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(std::exp(logProbabilities[i]),
+          fullGMM.Probability(data.col(i)), 1e-5);
+      BOOST_REQUIRE_CLOSE(gmm.Probability(data.col(i)),
+          fullGMM.Probability(data.col(i)), 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -54,4 +54,26 @@ BOOST_AUTO_TEST_CASE(RosenbrockTest)
     BOOST_REQUIRE_CLOSE(coordinates[j], (double) 1.0, 1e-3);
 }
 
+/**
+ * Test gradient descent takes the same steps when a separable function is
+ * evaluated in parallel with ParallelSeparableFunction.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSeparableFunctionTest)
+{
+  GeneralizedRosenbrockFunction f(16);
+  ParallelSeparableFunction<GeneralizedRosenbrockFunction> pf(f, 2, 4);
+
+  GradientDescent s(0.0001, 1000, 1e-15);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  const double result = s.Optimize(f, coordinates);
+
+  arma::mat parallelCoordinates = f.GetInitialPoint();
+  const double parallelResult = s.Optimize(pf, parallelCoordinates);
+
+  BOOST_REQUIRE_CLOSE(result, parallelResult, 1e-5);
+  for (size_t j = 0; j < coordinates.n_elem; ++j)
+    BOOST_REQUIRE_SMALL(coordinates[j] - parallelCoordinates[j], 1e-8);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
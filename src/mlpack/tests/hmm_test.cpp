@@ -10,11 +10,16 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/hmm_filter.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::hmm;
 using namespace mlpack::distribution;
@@ -217,6 +222,122 @@ BOOST_AUTO_TEST_CASE(SimpleBaumWelchDiscreteHMM)
   BOOST_REQUIRE_CLOSE(hmm.Initial()[0], 1.0, 1e-5);
 }
 
+/**
+ * Baum-Welch with the E-step split over several threads must give the same
+ * model as Baum-Welch on a single thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBaumWelchDiscreteHMM)
+{
+  std::vector<arma::mat> observations;
+  for (size_t i = 0; i < 37; i++)
+  {
+    arma::mat observation(1, 200);
+    size_t state = math::RandInt(2);
+    for (size_t obs = 0; obs < observation.n_cols; obs++)
+    {
+      if (math::Random() < 0.2)
+        state = 1 - state;
+      observation(0, obs) = (state == 0) ? math::RandInt(2) :
+          2 + math::RandInt(2);
+    }
+    observations.push_back(observation);
+  }
+
+  HMM<DiscreteDistribution> hmm(2, DiscreteDistribution(4));
+  hmm.Emission()[0].Probabilities() = "0.3 0.3 0.2 0.2";
+  hmm.Emission()[1].Probabilities() = "0.2 0.2 0.3 0.3";
+  HMM<DiscreteDistribution> serialHmm(hmm);
+
+  hmm.Train(observations);
+
+  #ifdef HAS_OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+  serialHmm.Train(observations);
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+  #endif
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(hmm.Initial()[i], serialHmm.Initial()[i], 1e-5);
+    for (size_t j = 0; j < 2; ++j)
+      BOOST_REQUIRE_CLOSE(hmm.Transition()(i, j), serialHmm.Transition()(i, j),
+          1e-5);
+    for (size_t e = 0; e < 4; ++e)
+    {
+      arma::vec observation(1);
+      observation[0] = e;
+      BOOST_REQUIRE_CLOSE(hmm.Emission()[i].Probability(observation),
+          serialHmm.Emission()[i].Probability(observation), 1e-5);
+    }
+  }
+}
+
+/**
+ * The emissions of the states are trained in parallel; make sure that this
+ * gives the same model as training them on a single thread, both for
+ * Baum-Welch with Gaussian emissions and for labeled training of GMM
+ * emissions, whose initialization is random.
+ */
+BOOST_AUTO_TEST_CASE(ParallelEmissionTrainingTest)
+{
+  std::vector<GaussianDistribution> gaussians(3);
+  gaussians[0] = GaussianDistribution("1.0 2.0", "1.0 0.2; 0.2 1.0");
+  gaussians[1] = GaussianDistribution("5.0 -2.0", "1.0 0.0; 0.0 2.0");
+  gaussians[2] = GaussianDistribution("-3.0 4.0", "2.0 0.5; 0.5 1.0");
+  const arma::vec initial("0.5 0.3 0.2");
+  const arma::mat trans("0.8 0.1 0.1; 0.1 0.8 0.1; 0.1 0.1 0.8");
+  HMM<GaussianDistribution> gaussianHmm(initial, trans, gaussians);
+
+  std::vector<arma::mat> observations(5);
+  std::vector<arma::Row<size_t>> states(5);
+  for (size_t i = 0; i < 5; ++i)
+    gaussianHmm.Generate(300, observations[i], states[i]);
+
+  HMM<GaussianDistribution> hmm(gaussianHmm);
+  HMM<GaussianDistribution> serialHmm(gaussianHmm);
+  hmm.Train(observations);
+  {
+    ScopedThreadLimit limit(1);
+    serialHmm.Train(observations);
+  }
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t d = 0; d < 2; ++d)
+      BOOST_REQUIRE_CLOSE(hmm.Emission()[i].Mean()[d],
+          serialHmm.Emission()[i].Mean()[d], 1e-5);
+    for (size_t d = 0; d < 4; ++d)
+      BOOST_REQUIRE_CLOSE(hmm.Emission()[i].Covariance()[d],
+          serialHmm.Emission()[i].Covariance()[d], 1e-5);
+  }
+
+  // Each state has a GMM with random initialization.
+  HMM<GMM> gmmHmm(3, GMM(2, 2));
+  HMM<GMM> serialGmmHmm(gmmHmm);
+  math::RandomSeed(7);
+  gmmHmm.Train(observations, states);
+  {
+    ScopedThreadLimit limit(1);
+    math::RandomSeed(7);
+    serialGmmHmm.Train(observations, states);
+  }
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t c = 0; c < 2; ++c)
+    {
+      BOOST_REQUIRE_CLOSE(gmmHmm.Emission()[i].Weights()[c],
+          serialGmmHmm.Emission()[i].Weights()[c], 1e-8);
+      for (size_t d = 0; d < 2; ++d)
+        BOOST_REQUIRE_CLOSE(gmmHmm.Emission()[i].Component(c).Mean()[d],
+            serialGmmHmm.Emission()[i].Component(c).Mean()[d], 1e-8);
+    }
+  }
+}
+
 /**
  * Increasing complexity, but still simple; 4 emissions, 2 states; the state can
  * be determined directly by the emission.
@@ -536,6 +657,62 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLogLikelihoodTest)
       -24.51556128368, 1e-5);
 }
 
+/**
+ * Make sure that decoding and scoring many sequences at once gives the same
+ * results as one sequence at a time.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteHMMBatchPredictLogLikelihoodTest)
+{
+  arma::vec initial("0.5 0.2 0.3");
+  arma::mat transition("0.5 0.0 0.1;"
+                       "0.2 0.6 0.2;"
+                       "0.3 0.4 0.7");
+  std::vector<DiscreteDistribution> emission(3);
+  emission[0].Probabilities() = "0.75 0.25 0.00 0.00";
+  emission[1].Probabilities() = "0.00 0.25 0.25 0.50";
+  emission[2].Probabilities() = "0.10 0.40 0.40 0.10";
+
+  HMM<DiscreteDistribution> hmm(initial, transition, emission);
+
+  // Sequences of different lengths, so that the workspaces are resized.
+  std::vector<arma::mat> sequences(300);
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    hmm.Generate(1 + math::RandInt(30), sequences[i], states,
+        math::RandInt(3));
+  }
+  sequences[17].set_size(1, 0);
+
+  std::vector<arma::Row<size_t>> stateSeqs;
+  arma::vec viterbiLogLikelihoods, logLikelihoods;
+  hmm.Predict(sequences, stateSeqs, viterbiLogLikelihoods);
+  hmm.LogLikelihood(sequences, logLikelihoods);
+
+  BOOST_REQUIRE_EQUAL(stateSeqs.size(), sequences.size());
+  BOOST_REQUIRE_EQUAL(viterbiLogLikelihoods.n_elem, sequences.size());
+  BOOST_REQUIRE_EQUAL(logLikelihoods.n_elem, sequences.size());
+
+  // The empty sequence has no states and probability 1.
+  BOOST_REQUIRE_EQUAL(stateSeqs[17].n_elem, 0);
+  BOOST_REQUIRE_SMALL(logLikelihoods[17], 1e-10);
+
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    if (i == 17)
+      continue;
+
+    arma::Row<size_t> states;
+    const double viterbiLogLikelihood = hmm.Predict(sequences[i], states);
+    BOOST_REQUIRE_EQUAL(stateSeqs[i].n_elem, states.n_elem);
+    for (size_t t = 0; t < states.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(stateSeqs[i][t], states[t]);
+    BOOST_REQUIRE_CLOSE(viterbiLogLikelihoods[i], viterbiLogLikelihood, 1e-5);
+    BOOST_REQUIRE_CLOSE(logLikelihoods[i], hmm.LogLikelihood(sequences[i]),
+        1e-5);
+  }
+}
+
 /**
  * A simple test to make sure HMMs with Gaussian output distributions work.
  */
@@ -852,6 +1029,73 @@ BOOST_AUTO_TEST_CASE(GMMHMMPredictTest)
     BOOST_REQUIRE_EQUAL(predictions[i], states[i]);
 }
 
+/**
+ * The forward-backward algorithm computes the emission probabilities of a
+ * GMM-based HMM in batches; make sure that the state probabilities and the
+ * log-likelihood are the same as with one call to GMM::Probability() for each
+ * state and observation.
+ */
+BOOST_AUTO_TEST_CASE(GMMHMMEstimateTest)
+{
+  // The components overlap, so the state probabilities are not all 0 or 1.
+  std::vector<GMM> gmms(2, GMM(2, 2));
+  gmms[0].Weights() = arma::vec("0.6 0.4");
+  gmms[0].Component(0) = GaussianDistribution("0.0 0.0", "1.0 0.2; 0.2 1.0");
+  gmms[0].Component(1) = GaussianDistribution("2.0 1.0", "1.0 0.0; 0.0 2.0");
+  gmms[1].Weights() = arma::vec("0.5 0.5");
+  gmms[1].Component(0) = GaussianDistribution("1.0 -1.0", "2.0 0.0; 0.0 1.0");
+  gmms[1].Component(1) = GaussianDistribution("-1.0 1.0", "1.0 0.5; 0.5 1.0");
+
+  const arma::vec initial("0.7 0.3");
+  const arma::mat trans("0.8 0.3; 0.2 0.7");
+  HMM<GMM> hmm(initial, trans, gmms);
+
+  arma::mat observations;
+  arma::Row<size_t> states;
+  hmm.Generate(300, observations, states);
+
+  // Compute the scaled forward and backward probabilities directly.
+  const size_t length = observations.n_cols;
+  arma::mat emission(2, length);
+  for (size_t t = 0; t < length; ++t)
+    for (size_t j = 0; j < 2; ++j)
+      emission(j, t) = gmms[j].Probability(observations.col(t));
+
+  arma::mat forward(2, length), backward(2, length);
+  arma::vec scales(length);
+  forward.col(0) = initial % emission.col(0);
+  scales[0] = arma::accu(forward.col(0));
+  forward.col(0) /= scales[0];
+  for (size_t t = 1; t < length; ++t)
+  {
+    forward.col(t) = (trans * forward.col(t - 1)) % emission.col(t);
+    scales[t] = arma::accu(forward.col(t));
+    forward.col(t) /= scales[t];
+  }
+  backward.col(length - 1).ones();
+  for (size_t t = length - 1; t > 0; --t)
+  {
+    backward.col(t - 1) = trans.t() * (backward.col(t) % emission.col(t)) /
+        scales[t];
+  }
+  const arma::mat trueStateProb = forward % backward;
+
+  arma::mat stateProb;
+  const double logLikelihood = hmm.Estimate(observations, stateProb);
+
+  BOOST_REQUIRE_CLOSE(logLikelihood, arma::accu(arma::log(scales)), 1e-7);
+  BOOST_REQUIRE_CLOSE(hmm.LogLikelihood(observations), logLikelihood, 1e-7);
+  BOOST_REQUIRE_EQUAL(stateProb.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(stateProb.n_cols, length);
+  for (size_t i = 0; i < stateProb.n_elem; ++i)
+  {
+    if (trueStateProb[i] < 1e-10)
+      BOOST_REQUIRE_SMALL(stateProb[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(stateProb[i], trueStateProb[i], 1e-6);
+  }
+}
+
 /**
  * Test that GMM-based HMMs can train on models correctly using labeled training
  * data.
@@ -1173,5 +1417,79 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLoadSaveTest)
           hmm2.Emission()[j].Probabilities()[i], 1e-3);
 }
 
+/**
+ * Make sure that filtering a stream one observation at a time gives the same
+ * expectations and log-likelihood as HMM::Filter() and HMM::LogLikelihood()
+ * on the whole sequence.
+ */
+BOOST_AUTO_TEST_CASE(HMMFilterStreamTest)
+{
+  // The Gaussians overlap, so the state probabilities are not all 0 or 1.
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(GaussianDistribution("1.0 0.0", "1.0 0.0; 0.0 1.0"));
+  emission.push_back(GaussianDistribution("-1.0 0.5", "1.0 0.0; 0.0 2.0"));
+  emission.push_back(GaussianDistribution("0.0 -1.0", "2.0 0.0; 0.0 1.0"));
+
+  arma::vec initial("0.2 0.5 0.3");
+  arma::mat transition("0.8 0.1 0.2;"
+                       "0.1 0.7 0.3;"
+                       "0.1 0.2 0.5");
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat observations;
+  arma::Row<size_t> states;
+  hmm.Generate(100, observations, states);
+
+  arma::mat filtered, filteredAhead;
+  hmm.Filter(observations, filtered);
+  hmm.Filter(observations, filteredAhead, 2);
+
+  HMMFilter<GaussianDistribution> filter(hmm);
+  BOOST_REQUIRE_EQUAL(filter.NumObservations(), 0);
+
+  // Feed the first half one observation at a time, and the second half in
+  // small batches.
+  for (size_t t = 0; t < observations.n_cols; ++t)
+  {
+    if (t < 50)
+    {
+      filter.Update(arma::vec(observations.col(t)));
+    }
+    else
+    {
+      filter.Update(arma::mat(observations.cols(t, t + 4)));
+      t += 4;
+    }
+
+    BOOST_REQUIRE_EQUAL(filter.NumObservations(), t + 1);
+    BOOST_REQUIRE_CLOSE(arma::accu(filter.StateProbabilities()), 1.0, 1e-5);
+
+    arma::vec expected, expectedAhead;
+    filter.PredictEmission(0, expected);
+    filter.PredictEmission(2, expectedAhead);
+    for (size_t d = 0; d < 2; ++d)
+    {
+      if (std::abs(filtered(d, t)) < 1e-8)
+        BOOST_REQUIRE_SMALL(expected[d], 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(expected[d], filtered(d, t), 1e-5);
+
+      if (std::abs(filteredAhead(d, t)) < 1e-8)
+        BOOST_REQUIRE_SMALL(expectedAhead[d], 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(expectedAhead[d], filteredAhead(d, t), 1e-5);
+    }
+
+    BOOST_REQUIRE_CLOSE(filter.LogLikelihood(),
+        hmm.LogLikelihood(observations.cols(0, t)), 1e-5);
+  }
+
+  // After a reset, the filter starts over.
+  filter.Reset();
+  BOOST_REQUIRE_EQUAL(filter.NumObservations(), 0);
+  BOOST_REQUIRE_CLOSE(filter.Update(arma::vec(observations.col(0))),
+      hmm.LogLikelihood(observations.cols(0, 0)), 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
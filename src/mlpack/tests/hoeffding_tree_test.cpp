@@ -569,6 +569,122 @@ BOOST_AUTO_TEST_CASE(HoeffdingTreeSimpleDatasetTest)
   }
 }
 
+/**
+ * Training on mini-batches in streaming mode must give the same tree as
+ * training on one point at a time, also when leaves split in the middle of a
+ * mini-batch.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchStreamingTest)
+{
+  data::DatasetInfo info(4);
+  info.Type(3) = data::Datatype::categorical;
+  info.MapString<double>("0", 3);
+  info.MapString<double>("1", 3);
+  info.MapString<double>("2", 3);
+
+  arma::mat dataset(4, 20000);
+  arma::Row<size_t> labels(20000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = mlpack::math::RandInt(3);
+    dataset(0, i) = labels[i] + mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = (labels[i] == 2) ? 1.0 + mlpack::math::Random() :
+        mlpack::math::Random();
+    dataset(3, i) = (mlpack::math::Random() < 0.8) ? labels[i] :
+        mlpack::math::RandInt(3);
+  }
+
+  HoeffdingTree<> streamTree(info, 3, 0.95, 5000, 50, 100);
+  HoeffdingTree<> miniBatchTree(info, 3, 0.95, 5000, 50, 100);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    streamTree.Train(dataset.col(i), labels[i]);
+  for (size_t i = 0; i < dataset.n_cols; i += 1234)
+  {
+    const size_t end = std::min(i + 1234, (size_t) dataset.n_cols) - 1;
+    const arma::mat batch = dataset.cols(i, end);
+    const arma::Row<size_t> batchLabels = labels.subvec(i, end);
+    miniBatchTree.Train(batch, batchLabels, false);
+  }
+
+  BOOST_REQUIRE_GT(streamTree.NumDescendants(), 0);
+  BOOST_REQUIRE_EQUAL(streamTree.NumDescendants(),
+      miniBatchTree.NumDescendants());
+
+  arma::Row<size_t> streamPredictions, miniBatchPredictions;
+  arma::rowvec streamProbabilities, miniBatchProbabilities;
+  streamTree.Classify(dataset, streamPredictions, streamProbabilities);
+  miniBatchTree.Classify(dataset, miniBatchPredictions,
+      miniBatchProbabilities);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(streamPredictions[i], miniBatchPredictions[i]);
+    BOOST_REQUIRE_CLOSE(streamProbabilities[i], miniBatchProbabilities[i],
+        1e-5);
+  }
+}
+
+/**
+ * Make sure that LimitMemory() keeps the tree under the budget by deactivating
+ * leaves, that inactive leaves keep their predictions and stop learning, and
+ * that they can be reactivated.
+ */
+BOOST_AUTO_TEST_CASE(MemoryLimitTest)
+{
+  data::DatasetInfo info(3);
+  arma::mat dataset(3, 20000);
+  arma::Row<size_t> labels(20000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = mlpack::math::RandInt(3);
+    dataset(0, i) = labels[i] + mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = (labels[i] == 2) ? 1.0 + mlpack::math::Random() :
+        mlpack::math::Random();
+  }
+
+  const arma::mat first = dataset.cols(0, 9999);
+  const arma::Row<size_t> firstLabels = labels.subvec(0, 9999);
+  const arma::mat second = dataset.cols(10000, 19999);
+  const arma::Row<size_t> secondLabels = labels.subvec(10000, 19999);
+
+  HoeffdingTree<> tree(info, 3, 0.95, 5000, 50, 100);
+  tree.Train(first, firstLabels, false);
+  BOOST_REQUIRE_GT(tree.NumDescendants(), 0);
+
+  arma::Row<size_t> predictions, inactivePredictions;
+  arma::rowvec probabilities, inactiveProbabilities;
+  tree.Classify(dataset, predictions, probabilities);
+  const size_t fullMemory = tree.MemoryUsage();
+
+  // With no memory, every leaf is deactivated.
+  HoeffdingTree<> inactiveTree(tree);
+  inactiveTree.LimitMemory(0);
+  const size_t minMemory = inactiveTree.MemoryUsage();
+  BOOST_REQUIRE_LT(minMemory, fullMemory);
+  BOOST_REQUIRE_EQUAL(inactiveTree.NumDescendants(), tree.NumDescendants());
+
+  // Inactive leaves predict as before, also after more training.
+  inactiveTree.Train(second, secondLabels, false);
+  BOOST_REQUIRE_EQUAL(inactiveTree.NumDescendants(), tree.NumDescendants());
+  BOOST_REQUIRE_EQUAL(inactiveTree.MemoryUsage(), minMemory);
+  inactiveTree.Classify(dataset, inactivePredictions, inactiveProbabilities);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], inactivePredictions[i]);
+    BOOST_REQUIRE_CLOSE(probabilities[i], inactiveProbabilities[i], 1e-5);
+  }
+
+  // With enough memory, every leaf is active again.
+  inactiveTree.LimitMemory(size_t(-1));
+  BOOST_REQUIRE_GT(inactiveTree.MemoryUsage(), minMemory);
+
+  // With a budget in between, only some leaves are active.
+  const size_t budget = (minMemory + fullMemory) / 2;
+  tree.LimitMemory(budget);
+  BOOST_REQUIRE_LE(tree.MemoryUsage(), budget);
+}
+
 /**
  * Make sure that a tree that does not split on anything.
  */
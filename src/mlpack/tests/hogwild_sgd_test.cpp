@@ -0,0 +1,104 @@
+/**
+ * @file hogwild_sgd_test.cpp
+ *
+ * Test file for HogwildSGD (lock-free parallel SGD with dense gradients).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/hogwild_sgd/hogwild_sgd.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/momentum_update.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(HogwildSGDTest);
+
+/**
+ * Create two well-separated Gaussian classes for logistic regression.
+ */
+void CreateGaussianData(arma::mat& data, arma::Row<size_t>& responses)
+{
+  data.randn(3, 1000);
+  responses.set_size(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) += arma::vec("1.0 1.0 1.0");
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) += arma::vec("7.0 7.0 7.0");
+    responses[i] = 1;
+  }
+}
+
+/**
+ * Train logistic regression with all threads updating the same coordinates.
+ */
+BOOST_AUTO_TEST_CASE(HogwildSGDLogisticRegressionTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateGaussianData(data, responses);
+
+  HogwildSGD<> optimizer(50, 1e-5, true, ConstantStep(0.01));
+  LogisticRegression<> lr(data, responses, optimizer, 0.001);
+
+  BOOST_REQUIRE_GT(lr.ComputeAccuracy(data, responses), 99.0);
+}
+
+/**
+ * Train logistic regression with a momentum update for each thread and
+ * averaged replicas of the coordinates.
+ */
+BOOST_AUTO_TEST_CASE(HogwildSGDReplicaMomentumTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateGaussianData(data, responses);
+
+  HogwildSGD<MomentumUpdate> optimizer(50, 1e-5, true, ConstantStep(0.005),
+      MomentumUpdate(0.5), 25);
+  LogisticRegression<> lr(data, responses, optimizer, 0.001);
+
+  BOOST_REQUIRE_GT(lr.ComputeAccuracy(data, responses), 99.0);
+}
+
+/**
+ * With a single thread and no shuffling, HogwildSGD takes the same steps as
+ * SGD, so the results have to match.
+ */
+BOOST_AUTO_TEST_CASE(HogwildSGDSingleThreadTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateGaussianData(data, responses);
+
+  LogisticRegressionFunction<> f(data, responses, 0.001);
+
+  HogwildSGD<> optimizer(4, 0, false, ConstantStep(0.01), VanillaUpdate(), 0,
+      1);
+  arma::mat coordinates = f.GetInitialPoint();
+  const double objective = optimizer.Optimize(f, coordinates);
+
+  // Three passes over the data.
+  StandardSGD sgd(0.01, 3 * data.n_cols + 1, 0, false);
+  arma::mat sgdCoordinates = f.GetInitialPoint();
+  const double sgdObjective = sgd.Optimize(f, sgdCoordinates);
+
+  BOOST_REQUIRE_CLOSE(objective, sgdObjective, 1e-5);
+  for (size_t i = 0; i < coordinates.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(coordinates[i], sgdCoordinates[i], 1e-5);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
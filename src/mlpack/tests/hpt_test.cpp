@@ -16,6 +16,7 @@
 #include <mlpack/core/hpt/fixed.hpp>
 #include <mlpack/core/hpt/hpt.hpp>
 #include <mlpack/core/optimizers/grid_search/grid_search.hpp>
+#include <mlpack/core/optimizers/successive_halving/successive_halving.hpp>
 #include <mlpack/core/optimizers/gradient_descent/gradient_descent.cpp>
 #include <mlpack/methods/lars/lars.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
@@ -343,4 +344,216 @@ BOOST_AUTO_TEST_CASE(HPTGradientDescentTest)
   BOOST_REQUIRE_CLOSE(zOptimized, zMin, 1e-4);
 }
 
+/**
+ * Test CVFunction trains on the given proportion of the training set when it
+ * is evaluated with a budget, and the best model is not changed then.
+ */
+BOOST_AUTO_TEST_CASE(CVFunctionBudgetTest)
+{
+  arma::mat xs = arma::randn(5, 100);
+  arma::vec beta = arma::randn(5, 1);
+  arma::rowvec ys = beta.t() * xs + 0.1 * arma::randn(1, 100);
+
+  bool transposeData = true;
+  bool useCholesky = false;
+  double lambda1 = 0.01;
+  double lambda2 = 0.02;
+
+  SimpleCV<LARS, MSE> cv(0.2, xs, ys);
+  CVFunction<decltype(cv), LARS, 4, FixedArg<bool, 0>, FixedArg<bool, 1>>
+      cvFun(cv, 0.0, 0.0, {transposeData}, {useCholesky});
+
+  arma::vec parameters(2);
+  parameters(0) = lambda1;
+  parameters(1) = lambda2;
+
+  // The first 40 of the 80 training points are used with the budget 0.5.
+  arma::mat halfXs = xs.cols(0, 39);
+  arma::rowvec halfYs = ys.cols(0, 39);
+  arma::mat validationXs = xs.cols(80, 99);
+  arma::rowvec validationYs = ys.cols(80, 99);
+  LARS halfModel(halfXs, halfYs, transposeData, useCholesky, lambda1, lambda2);
+  double expected = MSE::Evaluate(halfModel, validationXs, validationYs);
+
+  double fullObjective = cvFun.Evaluate(parameters);
+  BOOST_REQUIRE_CLOSE(cvFun.Evaluate(parameters, 0.5), expected, 1e-5);
+  BOOST_REQUIRE_CLOSE(cvFun.Evaluate(parameters, 1.0), fullObjective, 1e-5);
+
+  // The best model is still the one trained on the whole training set.
+  BOOST_REQUIRE_CLOSE(MSE::Evaluate(cvFun.BestModel(), validationXs,
+      validationYs), fullObjective, 1e-5);
+
+  BOOST_REQUIRE_THROW(cvFun.Evaluate(parameters, 0.0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(cvFun.Evaluate(parameters, 1.5), std::invalid_argument);
+}
+
+/**
+ * Test HyperParameterTuner finds the same hyper-parameters and model when
+ * GridSearch evaluates them in parallel.
+ */
+BOOST_AUTO_TEST_CASE(HPTParallelGridSearchTest)
+{
+  arma::mat xs;
+  arma::rowvec ys;
+  double validationSize;
+  InitProneToOverfittingData(xs, ys, validationSize);
+
+  bool transposeData = true;
+  bool useCholesky = false;
+  arma::vec lambda1Set("0 0.001 0.01 0.1 1.0 10.0 100.0");
+  arma::vec lambda2Set("0.0 0.05 0.5 5.0");
+
+  double expectedLambda1, expectedLambda2, expectedObjective;
+  FindLARSBestLambdas(xs, ys, validationSize, transposeData, useCholesky,
+      lambda1Set, lambda2Set, expectedLambda1, expectedLambda2,
+      expectedObjective);
+
+  double actualLambda1, actualLambda2;
+  HyperParameterTuner<LARS, MSE, SimpleCV, GridSearch>
+      hpt(validationSize, xs, ys);
+  hpt.Optimizer().NumThreads() = 4;
+  std::tie(actualLambda1, actualLambda2) = hpt.Optimize(Fixed(transposeData),
+      Fixed(useCholesky), lambda1Set, lambda2Set);
+
+  BOOST_REQUIRE_CLOSE(expectedObjective, hpt.BestObjective(), 1e-5);
+  BOOST_REQUIRE_CLOSE(expectedLambda1, actualLambda1, 1e-5);
+  BOOST_REQUIRE_CLOSE(expectedLambda2, actualLambda2, 1e-5);
+
+  // The model should be the one of the best hyper-parameters.
+  size_t validationFirstColumn = round(xs.n_cols * (1.0 - validationSize));
+  arma::mat validationXs = xs.cols(validationFirstColumn, xs.n_cols - 1);
+  arma::rowvec validationYs = ys.cols(validationFirstColumn, ys.n_cols - 1);
+  double objective = MSE::Evaluate(hpt.BestModel(), validationXs, validationYs);
+  BOOST_REQUIRE_CLOSE(expectedObjective, objective, 1e-5);
+}
+
+/**
+ * Test SuccessiveHalving is the same as GridSearch when the minimum budget is
+ * the full budget, and that its result is consistent otherwise, both serially
+ * and in parallel.
+ */
+BOOST_AUTO_TEST_CASE(HPTSuccessiveHalvingTest)
+{
+  arma::mat xs = arma::randn(5, 300);
+  arma::vec beta = arma::randn(5, 1);
+  arma::rowvec ys = beta.t() * xs + 0.1 * arma::randn(1, 300);
+  double validationSize = 0.2;
+
+  bool transposeData = true;
+  bool useCholesky = false;
+  arma::vec lambda1Set("0 0.001 0.01 0.1 1.0 10.0 100.0");
+  arma::vec lambda2Set("0.0 0.05 0.5 5.0");
+
+  double expectedLambda1, expectedLambda2, expectedObjective;
+  FindLARSBestLambdas(xs, ys, validationSize, transposeData, useCholesky,
+      lambda1Set, lambda2Set, expectedLambda1, expectedLambda2,
+      expectedObjective);
+
+  double lambda1, lambda2;
+  HyperParameterTuner<LARS, MSE, SimpleCV, SuccessiveHalving>
+      fullHpt(validationSize, xs, ys);
+  fullHpt.Optimizer().MinBudget() = 1.0;
+  std::tie(lambda1, lambda2) = fullHpt.Optimize(Fixed(transposeData),
+      Fixed(useCholesky), lambda1Set, lambda2Set);
+
+  BOOST_REQUIRE_CLOSE(expectedObjective, fullHpt.BestObjective(), 1e-5);
+  BOOST_REQUIRE_CLOSE(expectedLambda1, lambda1, 1e-5);
+  BOOST_REQUIRE_CLOSE(expectedLambda2, lambda2, 1e-5);
+
+  HyperParameterTuner<LARS, MSE, SimpleCV, SuccessiveHalving>
+      hpt(validationSize, xs, ys);
+  std::tie(lambda1, lambda2) = hpt.Optimize(Fixed(transposeData),
+      Fixed(useCholesky), lambda1Set, lambda2Set);
+
+  // The objective is the one of the found hyper-parameters with the full
+  // budget, so it cannot be better than the one of GridSearch.
+  SimpleCV<LARS, MSE> cv(validationSize, xs, ys);
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(transposeData, useCholesky, lambda1,
+      lambda2), hpt.BestObjective(), 1e-5);
+  BOOST_REQUIRE_GE(hpt.BestObjective(), expectedObjective * (1 - 1e-7));
+
+  HyperParameterTuner<LARS, MSE, SimpleCV, SuccessiveHalving>
+      parallelHpt(validationSize, xs, ys);
+  parallelHpt.Optimizer().NumThreads() = 4;
+  double parallelLambda1, parallelLambda2;
+  std::tie(parallelLambda1, parallelLambda2) = parallelHpt.Optimize(
+      Fixed(transposeData), Fixed(useCholesky), lambda1Set, lambda2Set);
+
+  BOOST_REQUIRE_CLOSE(hpt.BestObjective(), parallelHpt.BestObjective(), 1e-5);
+  BOOST_REQUIRE_CLOSE(lambda1 + 1.0, parallelLambda1 + 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(lambda2 + 1.0, parallelLambda2 + 1.0, 1e-5);
+
+  size_t validationFirstColumn = round(xs.n_cols * (1.0 - validationSize));
+  arma::mat validationXs = xs.cols(validationFirstColumn, xs.n_cols - 1);
+  arma::rowvec validationYs = ys.cols(validationFirstColumn, ys.n_cols - 1);
+  double objective = MSE::Evaluate(parallelHpt.BestModel(), validationXs,
+      validationYs);
+  BOOST_REQUIRE_CLOSE(parallelHpt.BestObjective(), objective, 1e-5);
+
+  BOOST_REQUIRE_THROW(SuccessiveHalving(0.0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(SuccessiveHalving(0.5, 1.0), std::invalid_argument);
+}
+
+/**
+ * Test that a warm-started model converges to the same solution as a model
+ * trained from scratch.
+ */
+BOOST_AUTO_TEST_CASE(CVWarmStartTest)
+{
+  arma::mat xs = arma::randn(3, 200);
+  arma::Row<size_t> ys =
+      arma::conv_to<arma::Row<size_t>>::from(xs.row(0) + arma::randn(1, 200) >
+      0.0);
+
+  SimpleCV<LogisticRegression<>, Accuracy> warmCV(0.2, xs, ys);
+  warmCV.WarmStart() = true;
+  warmCV.Evaluate(1.0);
+  const arma::rowvec first = warmCV.Model().Parameters();
+  warmCV.Evaluate(0.1);
+
+  SimpleCV<LogisticRegression<>, Accuracy> coldCV(0.2, xs, ys);
+  coldCV.Evaluate(0.1);
+
+  const arma::rowvec& warm = warmCV.Model().Parameters();
+  const arma::rowvec& cold = coldCV.Model().Parameters();
+  BOOST_REQUIRE_LT(arma::norm(warm - cold), 1e-3 * arma::norm(cold));
+  BOOST_REQUIRE_GT(arma::norm(first - cold), 1e-3 * arma::norm(cold));
+}
+
+/**
+ * Test HyperParameterTuner with warm starts, and that it refuses warm starts
+ * for models that do not support them.
+ */
+BOOST_AUTO_TEST_CASE(HPTWarmStartTest)
+{
+  // The same linearly separable dataset as in HPTMaximizationTest.
+  arma::mat xs = arma::linspace<arma::rowvec>(0.0, 10.0, 50);
+  arma::Row<size_t> ys = arma::join_rows(arma::zeros<arma::Row<size_t>>(25),
+      arma::ones<arma::Row<size_t>>(25));
+  arma::mat doubledXs = arma::join_rows(xs, xs);
+  arma::Row<size_t> doubledYs = arma::join_rows(ys, ys);
+
+  HyperParameterTuner<LogisticRegression<>, Accuracy, SimpleCV>
+      hpt(0.5, doubledXs, doubledYs);
+  hpt.WarmStart() = true;
+
+  // The largest lambda is evaluated first, and then the model with lambda = 0
+  // is trained from its solution.
+  double actualLambda;
+  arma::vec lambdas("0 1e12");
+  std::tie(actualLambda) = hpt.Optimize(lambdas);
+
+  BOOST_REQUIRE_CLOSE(hpt.BestObjective(), 1.0, 1e-5);
+  BOOST_REQUIRE_SMALL(actualLambda, 1e-5);
+
+  arma::mat larsXs = arma::randn(5, 100);
+  arma::rowvec larsYs = arma::randn(1, 100);
+  HyperParameterTuner<LARS, MSE, SimpleCV> larsHpt(0.2, larsXs, larsYs);
+  larsHpt.WarmStart() = true;
+  arma::vec lambda1Set("0.0 0.1");
+  arma::vec lambda2Set("0.0 0.1");
+  BOOST_REQUIRE_THROW(larsHpt.Optimize(Fixed(true), Fixed(false), lambda1Set,
+      lambda2Set), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
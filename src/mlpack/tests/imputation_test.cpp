@@ -266,6 +266,53 @@ BOOST_AUTO_TEST_CASE(ListwiseDeletionTest)
   BOOST_REQUIRE_CLOSE(rowWiseInput(1, 3), 8.0, 1e-5);
 }
 
+/**
+ * Make sure imputing several dimensions at once gives the same results as
+ * imputing them one at a time, with the given strategy.
+ */
+template<typename StrategyType>
+void CheckMultipleDimensionImputation(StrategyType strategy)
+{
+  for (size_t c = 0; c < 2; ++c)
+  {
+    const bool columnMajor = (c == 0);
+    arma::mat input = arma::round(5 * arma::randu<arma::mat>(6, 200));
+    if (!columnMajor)
+      arma::inplace_trans(input);
+    input(0, 0) = arma::datum::nan;
+    arma::mat expected(input);
+
+    // Each dimension has a different missing value.
+    const std::vector<size_t> dimensions = { 1, 3, 4 };
+    const std::vector<double> mappedValues = { 0.0, 1.0, 2.0 };
+    for (size_t d = 0; d < dimensions.size(); ++d)
+      strategy.Impute(expected, mappedValues[d], dimensions[d], columnMajor);
+
+    strategy.Impute(input, mappedValues, dimensions, columnMajor);
+
+    BOOST_REQUIRE_EQUAL(input.n_rows, expected.n_rows);
+    BOOST_REQUIRE_EQUAL(input.n_cols, expected.n_cols);
+    for (size_t i = 0; i < input.n_elem; ++i)
+    {
+      if (std::isnan(expected[i]))
+        BOOST_REQUIRE(std::isnan(input[i]));
+      else
+        BOOST_REQUIRE_CLOSE(input[i] + 1.0, expected[i] + 1.0, 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure each strategy imputes several dimensions at once correctly.
+ */
+BOOST_AUTO_TEST_CASE(MultipleDimensionImputationTest)
+{
+  CheckMultipleDimensionImputation(CustomImputation<double>(99.0));
+  CheckMultipleDimensionImputation(MeanImputation<double>());
+  CheckMultipleDimensionImputation(MedianImputation<double>());
+  CheckMultipleDimensionImputation(ListwiseDeletion<double>());
+}
+
 /**
  * Make sure we can map non-strings.
  */
@@ -0,0 +1,181 @@
+/**
+ * @file kde_test.cpp
+ *
+ * Tests for the KDE class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/kde/kde.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/tree/cover_tree.hpp>
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::kde;
+using namespace mlpack::kernel;
+using namespace mlpack::metric;
+using namespace mlpack::tree;
+
+BOOST_AUTO_TEST_SUITE(KDETest);
+
+/**
+ * Make sure that naive mode computes the mean of the kernel values.
+ */
+BOOST_AUTO_TEST_CASE(KDENaiveTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 50);
+  arma::mat query = arma::randu<arma::mat>(3, 20);
+
+  GaussianKernel kernel(0.3);
+  KDE<> kde(0.0, 0.0, kernel, EuclideanDistance(), true);
+  kde.Train(reference);
+
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+
+  BOOST_REQUIRE_EQUAL(estimations.n_elem, query.n_cols);
+  BOOST_REQUIRE_EQUAL(kde.BaseCases(), reference.n_cols * query.n_cols);
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    double sum = 0.0;
+    for (size_t j = 0; j < reference.n_cols; ++j)
+      sum += kernel.Evaluate(query.col(i), reference.col(j));
+
+    BOOST_REQUIRE_CLOSE(estimations[i], sum / reference.n_cols, 1e-5);
+  }
+}
+
+/**
+ * Check that the estimates of the given type of KDE, in single-tree and in
+ * dual-tree mode, are within the error tolerances of the naive estimates, and
+ * that the trees save kernel evaluations.
+ */
+template<typename KernelType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void CheckKDE(const KernelType& kernel,
+              const double relError,
+              const double absError)
+{
+  typedef KDE<KernelType, EuclideanDistance, arma::mat, TreeType> KDEType;
+
+  arma::mat reference = arma::randu<arma::mat>(2, 1000);
+  arma::mat query = arma::randu<arma::mat>(2, 300);
+
+  KDEType naive(0.0, 0.0, kernel, EuclideanDistance(), true);
+  naive.Train(reference);
+  arma::vec naiveEstimations;
+  naive.Evaluate(query, naiveEstimations);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    KDEType kde(relError, absError, kernel, EuclideanDistance(), false,
+        mode == 0);
+    kde.Train(reference);
+
+    arma::vec estimations;
+    kde.Evaluate(query, estimations);
+
+    BOOST_REQUIRE_EQUAL(estimations.n_elem, query.n_cols);
+    for (size_t i = 0; i < query.n_cols; ++i)
+    {
+      BOOST_REQUIRE_LE(std::abs(estimations[i] - naiveEstimations[i]),
+          absError + relError * naiveEstimations[i] + 1e-10);
+    }
+
+    BOOST_REQUIRE_LT(kde.BaseCases(), reference.n_cols * query.n_cols);
+  }
+}
+
+/**
+ * Test the Gaussian kernel with all of the tree types.
+ */
+BOOST_AUTO_TEST_CASE(KDEGaussianTreeTest)
+{
+  CheckKDE<GaussianKernel, KDTree>(GaussianKernel(0.1), 0.01, 1e-4);
+  CheckKDE<GaussianKernel, BallTree>(GaussianKernel(0.1), 0.01, 1e-4);
+  CheckKDE<GaussianKernel, StandardCoverTree>(GaussianKernel(0.1), 0.01,
+      1e-4);
+}
+
+/**
+ * Test the kernels with a bounded support, which are pruned exactly outside of
+ * the bandwidth, even without an error tolerance.
+ */
+BOOST_AUTO_TEST_CASE(KDEBoundedKernelTreeTest)
+{
+  CheckKDE<EpanechnikovKernel, KDTree>(EpanechnikovKernel(0.1), 0.0, 0.0);
+  CheckKDE<EpanechnikovKernel, BallTree>(EpanechnikovKernel(0.1), 0.05, 0.0);
+  CheckKDE<TriangularKernel, KDTree>(TriangularKernel(0.1), 0.0, 0.0);
+  CheckKDE<TriangularKernel, StandardCoverTree>(TriangularKernel(0.1), 0.05,
+      0.0);
+}
+
+/**
+ * Make sure that the absolute error tolerance bounds the error of each
+ * estimate.
+ */
+BOOST_AUTO_TEST_CASE(KDEAbsoluteErrorTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 500);
+  arma::mat query = arma::randu<arma::mat>(3, 100);
+  const double absError = 0.01;
+
+  KDE<> naive(0.0, 0.0, GaussianKernel(0.2), EuclideanDistance(), true);
+  naive.Train(reference);
+  arma::vec naiveEstimations;
+  naive.Evaluate(query, naiveEstimations);
+
+  KDE<> kde(0.0, absError, GaussianKernel(0.2));
+  kde.Train(reference);
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    BOOST_REQUIRE_LE(std::abs(estimations[i] - naiveEstimations[i]),
+        absError + 1e-10);
+  }
+}
+
+/**
+ * Make sure that a tree given to Train() is used, and that invalid arguments
+ * are rejected.
+ */
+BOOST_AUTO_TEST_CASE(KDETrainTreeTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 200);
+  arma::mat query = arma::randu<arma::mat>(3, 50);
+
+  KDE<> kde(0.01);
+  kde.Train(reference);
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+
+  KDE<>::Tree tree(reference);
+  KDE<> treeKDE(0.01);
+  treeKDE.Train(&tree);
+  BOOST_REQUIRE_EQUAL(treeKDE.ReferenceTree(), &tree);
+
+  arma::vec treeEstimations;
+  treeKDE.Evaluate(query, treeEstimations);
+  CheckMatrices(estimations, treeEstimations);
+
+  BOOST_REQUIRE_THROW(KDE<>(-0.1), std::invalid_argument);
+  BOOST_REQUIRE_THROW(kde.AbsoluteError(-1.0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(kde.Evaluate(arma::randu<arma::mat>(2, 10),
+      estimations), std::invalid_argument);
+
+  KDE<> untrained;
+  BOOST_REQUIRE_THROW(untrained.Evaluate(query, estimations),
+      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_pca.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -150,4 +151,46 @@ BOOST_AUTO_TEST_CASE(CircleTransformationTestNystroem)
   BOOST_REQUIRE_EQUAL(ranges[1].Contains(ranges[2]), false);
 }
 
+/**
+ * The randomized method, with the kernel matrix in several blocks, should find
+ * the same leading kernel principal components as the naive method.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedMatchesNaiveTest)
+{
+  // The spreads are different, so that the leading eigenvalues are distinct.
+  arma::mat dataset;
+  dataset.randn(3, 300);
+  dataset.row(0) *= 3.0;
+  dataset.row(2) *= 0.5;
+
+  GaussianKernel kernel(2.0);
+  arma::mat naiveTransformed, naiveEigvec;
+  arma::vec naiveEigval;
+  KernelPCA<GaussianKernel> naive(kernel);
+  naive.Apply(dataset, naiveTransformed, naiveEigval, naiveEigvec, 3);
+
+  arma::mat transformed, eigvec;
+  arma::vec eigval;
+  KernelPCA<GaussianKernel, RandomizedKernelRule<GaussianKernel, 4, 10, 64>>
+      randomized(kernel);
+  randomized.Apply(dataset, transformed, eigval, eigvec, 3);
+
+  BOOST_REQUIRE_EQUAL(eigval.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(eigvec.n_rows, dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(eigvec.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(transformed.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(transformed.n_cols, dataset.n_cols);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(eigval[i], naiveEigval[i], 0.1);
+
+    // The components are only defined up to their sign.
+    const double similarity = arma::dot(transformed.row(i),
+        naiveTransformed.row(i)) / (arma::norm(transformed.row(i), 2) *
+        arma::norm(naiveTransformed.row(i), 2));
+    BOOST_REQUIRE_GT(std::abs(similarity), 0.999);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
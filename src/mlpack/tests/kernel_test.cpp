@@ -18,7 +18,9 @@
 #include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/core/kernels/polynomial_kernel.hpp>
 #include <mlpack/core/kernels/spherical_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 
@@ -608,4 +610,124 @@ BOOST_AUTO_TEST_CASE(PSpectrumStringEvaluateTest)
   BOOST_REQUIRE_CLOSE(p.Evaluate(b, a), 11.0, 1e-5);
 }
 
+/**
+ * Make sure the kernel matrix of strings from two datasets matches the counts
+ * of shared substrings.
+ */
+BOOST_AUTO_TEST_CASE(PSpectrumStringKernelMatrixTest)
+{
+  std::vector<std::vector<std::string> > datasets(2);
+  datasets[0].push_back("hello");
+  datasets[0].push_back("jello");
+  datasets[1].push_back("mellow");
+  datasets[1].push_back("mellow jello");
+
+  PSpectrumStringKernel p(datasets, 3);
+
+  // Strings (dataset, index): (0, 0), (0, 1), (1, 0), (1, 1).
+  arma::mat strings("0 0 1 1; 0 1 0 1");
+  arma::mat kernelMatrix;
+  KernelMatrix(p, strings, kernelMatrix);
+
+  arma::mat expected("3 2 2 4; 2 3 2 5; 2 2 4 6; 4 5 6 11");
+  BOOST_REQUIRE_EQUAL(kernelMatrix.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(kernelMatrix.n_cols, 4);
+  for (size_t i = 0; i < 4; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      BOOST_REQUIRE_CLOSE(kernelMatrix(i, j), expected(i, j), 1e-5);
+
+  // Every string has its own histogram, sorted by substring identifier.
+  BOOST_REQUIRE_EQUAL(p.Histograms().size(), 2);
+  BOOST_REQUIRE_EQUAL(p.Histograms()[1][1].size(), p.Counts()[1][1].size());
+  for (size_t i = 1; i < p.Histograms()[1][1].size(); ++i)
+    BOOST_REQUIRE_LT(p.Histograms()[1][1][i - 1].first,
+        p.Histograms()[1][1][i].first);
+}
+
+/**
+ * Check that KernelMatrix() gives the same values as evaluating the kernel on
+ * each pair of points, for the rectangular and the symmetric versions.
+ */
+template<typename KernelType>
+void CheckKernelMatrix(KernelType& kernel)
+{
+  arma::mat a = arma::randu<arma::mat>(5, 40);
+  arma::mat b = arma::randu<arma::mat>(5, 30);
+  // A point that appears in both sets has distance zero to itself.
+  b.col(3) = a.col(7);
+
+  arma::mat result, symmetricResult;
+  KernelMatrix(kernel, a, b, result);
+  KernelMatrix(kernel, a, symmetricResult);
+
+  BOOST_REQUIRE_EQUAL(result.n_rows, a.n_cols);
+  BOOST_REQUIRE_EQUAL(result.n_cols, b.n_cols);
+  BOOST_REQUIRE_EQUAL(symmetricResult.n_rows, a.n_cols);
+  BOOST_REQUIRE_EQUAL(symmetricResult.n_cols, a.n_cols);
+
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      const double value = kernel.Evaluate(a.col(i), b.col(j));
+      BOOST_REQUIRE_SMALL(result(i, j) - value, 1e-8 * std::max(1.0,
+          std::abs(value)));
+    }
+  }
+
+  for (size_t j = 0; j < a.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      const double value = kernel.Evaluate(a.col(i), a.col(j));
+      BOOST_REQUIRE_SMALL(symmetricResult(i, j) - value, 1e-8 * std::max(1.0,
+          std::abs(value)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(KernelMatrixTest)
+{
+  // Inner product kernels.
+  LinearKernel linear;
+  CheckKernelMatrix(linear);
+  PolynomialKernel polynomial(3.0, 1.5);
+  CheckKernelMatrix(polynomial);
+  HyperbolicTangentKernel hyperbolicTangent(0.5, -1.0);
+  CheckKernelMatrix(hyperbolicTangent);
+  CosineDistance cosine;
+  CheckKernelMatrix(cosine);
+
+  // Squared distance kernels.
+  GaussianKernel gaussian(0.7);
+  CheckKernelMatrix(gaussian);
+  EpanechnikovKernel epanechnikov(1.2);
+  CheckKernelMatrix(epanechnikov);
+
+  // Kernels evaluated pair by pair.
+  LaplacianKernel laplacian(0.8);
+  CheckKernelMatrix(laplacian);
+  TriangularKernel triangular(1.5);
+  CheckKernelMatrix(triangular);
+}
+
+/**
+ * Make sure that the triangular kernel gives the same values for a distance as
+ * for the points.
+ */
+BOOST_AUTO_TEST_CASE(TriangularKernelDistanceTest)
+{
+  TriangularKernel triangular(2.5);
+  arma::vec a = "0.0 1.0 0.5";
+  arma::vec b = "1.0 0.0 1.5";
+
+  const double distance = metric::EuclideanDistance::Evaluate(a, b);
+  BOOST_REQUIRE_CLOSE(triangular.Evaluate(distance), triangular.Evaluate(a, b),
+      1e-5);
+  BOOST_REQUIRE_CLOSE(triangular.Evaluate(distance), 1 - distance / 2.5, 1e-5);
+  BOOST_REQUIRE_SMALL(triangular.Evaluate(3.0), 1e-5);
+  BOOST_REQUIRE_CLOSE(triangular.Gradient(1.0), -1.0 / 2.5, 1e-5);
+  BOOST_REQUIRE_SMALL(triangular.Gradient(3.0), 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
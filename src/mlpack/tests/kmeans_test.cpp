@@ -12,12 +12,17 @@
 #include <mlpack/methods/kmeans/kmeans.hpp>
 #include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
 #include <mlpack/methods/kmeans/refined_start.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel_initialization.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/yinyang_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
+#include <mlpack/methods/kmeans/sparse_kmeans.hpp>
 #include <mlpack/methods/kmeans/sample_initialization.hpp>
 #include <mlpack/methods/kmeans/random_partition.hpp>
+#include <mlpack/methods/kmeans/sharded_kmeans.hpp>
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -25,6 +30,10 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::kmeans;
 using namespace mlpack::metric;
@@ -497,6 +506,90 @@ BOOST_AUTO_TEST_CASE(SparseKMeansTest)
   BOOST_REQUIRE_EQUAL(assignments[11], clusterTwo);
 }
 
+/**
+ * Make sure that one iteration of SparseKMeans gives the same centroids and
+ * counts as one iteration of NaiveKMeans, for sparse and dense data.
+ */
+BOOST_AUTO_TEST_CASE(SparseKMeansIterateTest)
+{
+  arma::sp_mat dataset;
+  dataset.sprandu(200, 1000, 0.05);
+  const arma::mat denseDataset(dataset);
+
+  for (size_t k = 1; k < 20; k += 6)
+  {
+    arma::mat centroids(200, k);
+    for (size_t i = 0; i < k; ++i)
+      centroids.col(i) = denseDataset.col(math::RandInt(1000));
+
+    metric::EuclideanDistance metric;
+    NaiveKMeans<metric::EuclideanDistance, arma::sp_mat> naive(dataset,
+        metric);
+    SparseKMeans<metric::EuclideanDistance, arma::sp_mat> sparse(dataset,
+        metric);
+    SparseKMeans<metric::EuclideanDistance, arma::mat> dense(denseDataset,
+        metric);
+
+    arma::mat naiveCentroids, sparseCentroids, denseCentroids;
+    arma::Col<size_t> naiveCounts, sparseCounts, denseCounts;
+    const double naiveNorm = naive.Iterate(centroids, naiveCentroids,
+        naiveCounts);
+    const double sparseNorm = sparse.Iterate(centroids, sparseCentroids,
+        sparseCounts);
+    const double denseNorm = dense.Iterate(centroids, denseCentroids,
+        denseCounts);
+
+    CheckMatrices(sparseCounts, naiveCounts);
+    CheckMatrices(denseCounts, naiveCounts);
+    CheckMatrices(sparseCentroids, naiveCentroids);
+    CheckMatrices(denseCentroids, naiveCentroids);
+    BOOST_REQUIRE_CLOSE(sparseNorm, naiveNorm, 1e-5);
+    BOOST_REQUIRE_CLOSE(denseNorm, naiveNorm, 1e-5);
+    BOOST_REQUIRE_EQUAL(sparse.DistanceCalculations(),
+        naive.DistanceCalculations());
+  }
+}
+
+/**
+ * Make sure that KMeans with SparseKMeans finds the two clusters of a sparse
+ * dataset, and the same clustering as NaiveKMeans from the same initial
+ * centroids.
+ */
+BOOST_AUTO_TEST_CASE(SparseKMeansClusterTest)
+{
+  // Two groups of documents that use different words.
+  arma::sp_mat data(500, 100);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    const size_t first = (i < 50) ? 0 : 250;
+    for (size_t j = 0; j < 10; ++j)
+      data(first + math::RandInt(250), i) = math::Random(0.5, 1.0);
+  }
+
+  arma::Row<size_t> assignments;
+  KMeans<metric::EuclideanDistance, SampleInitialization,
+      MaxVarianceNewCluster, SparseKMeans, arma::sp_mat> kmeans;
+
+  arma::mat initialCentroids(500, 2);
+  initialCentroids.col(0) = arma::vec(data.col(0));
+  initialCentroids.col(1) = arma::vec(data.col(99));
+  arma::mat centroids = initialCentroids;
+  kmeans.Cluster(data, 2, assignments, centroids, false, true);
+
+  for (size_t i = 0; i < 100; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], (i < 50) ? 0 : 1);
+
+  KMeans<metric::EuclideanDistance, SampleInitialization,
+      MaxVarianceNewCluster, NaiveKMeans, arma::sp_mat> naiveKMeans;
+  arma::Row<size_t> naiveAssignments;
+  arma::mat naiveCentroids = initialCentroids;
+  naiveKMeans.Cluster(data, 2, naiveAssignments, naiveCentroids, false,
+      true);
+
+  CheckMatrices(assignments, naiveAssignments);
+  CheckMatrices(centroids, naiveCentroids);
+}
+
 #endif // ARMA_HAS_SPMAT
 
 BOOST_AUTO_TEST_CASE(ElkanTest)
@@ -568,6 +661,212 @@ BOOST_AUTO_TEST_CASE(HamerlyTest)
   }
 }
 
+/**
+ * Run a few iterations of the given Lloyd step type with the given number of
+ * threads, and return the centroids; the number of distance calculations is
+ * stored in distanceCalculations.
+ */
+template<template<class, class> class LloydStepType>
+arma::mat RunThreadedIterations(const arma::mat& dataset,
+                                const arma::mat& initialCentroids,
+                                const int threads,
+                                size_t& distanceCalculations)
+{
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(threads);
+  #else
+    (void) threads;
+  #endif
+
+  EuclideanDistance metric;
+  LloydStepType<EuclideanDistance, arma::mat> step(dataset, metric);
+  arma::mat centroids(initialCentroids), newCentroids;
+  arma::Col<size_t> counts;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    step.Iterate(centroids, newCentroids, counts);
+    centroids = newCentroids;
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+
+  distanceCalculations = step.DistanceCalculations();
+  return centroids;
+}
+
+/**
+ * The Elkan, Hamerly and Yinyang iterations must give the same results with
+ * any number of threads, and must compute the same distances, since the bounds
+ * of each point do not depend on the other points.
+ */
+template<template<class, class> class LloydStepType>
+void CheckThreadedIterations()
+{
+  arma::mat dataset(5, 2000);
+  dataset.randu();
+  arma::mat centroids(5, 20);
+  centroids.randu();
+
+  size_t singleCalculations, multiCalculations;
+  arma::mat singleCentroids = RunThreadedIterations<LloydStepType>(dataset,
+      centroids, 1, singleCalculations);
+  arma::mat multiCentroids = RunThreadedIterations<LloydStepType>(dataset,
+      centroids, 4, multiCalculations);
+
+  BOOST_REQUIRE_EQUAL(singleCalculations, multiCalculations);
+  for (size_t i = 0; i < singleCentroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(singleCentroids[i], multiCentroids[i], 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(ElkanThreadsTest)
+{
+  CheckThreadedIterations<ElkanKMeans>();
+}
+
+BOOST_AUTO_TEST_CASE(HamerlyThreadsTest)
+{
+  CheckThreadedIterations<HamerlyKMeans>();
+}
+
+BOOST_AUTO_TEST_CASE(YinyangThreadsTest)
+{
+  CheckThreadedIterations<YinyangKMeans>();
+}
+
+BOOST_AUTO_TEST_CASE(YinyangTest)
+{
+  const size_t trials = 5;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    arma::mat dataset(10, 1000);
+    dataset.randu();
+
+    const size_t k = 10 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    // Make sure Yinyang k-means and the naive method return the same clusters.
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Row<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        YinyangKMeans> yinyang;
+    arma::Row<size_t> yinyangAssignments;
+    arma::mat yinyangCentroids(centroids);
+    yinyang.Cluster(dataset, k, yinyangAssignments, yinyangCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], yinyangAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], yinyangCentroids[i], 1e-5);
+  }
+}
+
+/**
+ * Yinyang k-means must give the same iterations as naive k-means for any
+ * number of groups, from one group (like Hamerly's algorithm) to one group per
+ * centroid (like Elkan's algorithm).
+ */
+BOOST_AUTO_TEST_CASE(YinyangGroupsTest)
+{
+  arma::mat dataset(4, 1000);
+  dataset.randu();
+  arma::mat initialCentroids(4, 12);
+  initialCentroids.randu();
+
+  EuclideanDistance metric;
+  const size_t numGroups[] = { 1, 3, 5, 12 };
+  for (size_t g = 0; g < 4; ++g)
+  {
+    NaiveKMeans<EuclideanDistance, arma::mat> naive(dataset, metric);
+    YinyangKMeans<EuclideanDistance, arma::mat> yinyang(dataset, metric);
+    yinyang.NumGroups() = numGroups[g];
+
+    arma::mat naiveCentroids(initialCentroids), yinyangCentroids(
+        initialCentroids);
+    arma::mat newNaiveCentroids, newYinyangCentroids;
+    arma::Col<size_t> naiveCounts, yinyangCounts;
+    for (size_t i = 0; i < 10; ++i)
+    {
+      naive.Iterate(naiveCentroids, newNaiveCentroids, naiveCounts);
+      yinyang.Iterate(yinyangCentroids, newYinyangCentroids, yinyangCounts);
+
+      for (size_t c = 0; c < naiveCounts.n_elem; ++c)
+        BOOST_REQUIRE_EQUAL(naiveCounts[c], yinyangCounts[c]);
+      for (size_t j = 0; j < newNaiveCentroids.n_elem; ++j)
+        BOOST_REQUIRE_CLOSE(newNaiveCentroids[j], newYinyangCentroids[j],
+            1e-5);
+
+      naiveCentroids = newNaiveCentroids;
+      yinyangCentroids = newYinyangCentroids;
+    }
+  }
+}
+
+/**
+ * Make sure that NaiveKMeans on high-dimensional data, which estimates the
+ * distances to the centroids with matrix products, assigns each point to the
+ * same centroid as evaluating every distance, including the choice between
+ * identical centroids.
+ */
+BOOST_AUTO_TEST_CASE(HighDimensionalNaiveKMeansTest)
+{
+  arma::mat dataset(48, 1500);
+  dataset.randu();
+  arma::mat centroids(48, 20);
+  centroids.randu();
+  // Two identical centroids: the points go to the first one.
+  centroids.col(7) = centroids.col(3);
+
+  // Find the closest centroids by evaluating every distance.
+  arma::mat expectedCentroids(arma::size(centroids), arma::fill::zeros);
+  arma::Col<size_t> expectedCounts(centroids.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    size_t closest = 0;
+    double minDistance = DBL_MAX;
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = EuclideanDistance::Evaluate(dataset.col(i),
+          centroids.col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closest = j;
+      }
+    }
+
+    expectedCentroids.col(closest) += dataset.col(i);
+    ++expectedCounts[closest];
+  }
+
+  EuclideanDistance metric;
+  NaiveKMeans<EuclideanDistance, arma::mat> naive(dataset, metric);
+  arma::mat newCentroids;
+  arma::Col<size_t> counts;
+  naive.Iterate(centroids, newCentroids, counts);
+
+  BOOST_REQUIRE_EQUAL(counts[7], 0);
+  for (size_t j = 0; j < centroids.n_cols; ++j)
+  {
+    BOOST_REQUIRE_EQUAL(counts[j], expectedCounts[j]);
+    if (counts[j] == 0)
+      continue;
+
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_CLOSE(newCentroids(d, j), expectedCentroids(d, j) /
+          counts[j], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(PellegMooreTest)
 {
   const size_t trials = 5;
@@ -700,4 +999,411 @@ BOOST_AUTO_TEST_CASE(SampleInitializationTest)
   }
 }
 
+/**
+ * Make sure that k-means|| returns the right number of centroids, each of which
+ * is a point of the dataset.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  const size_t clusters = 10;
+  arma::mat centroids;
+
+  KMeansParallelInitialization kmpi;
+  kmpi.Cluster(dataset, clusters, centroids);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 10);
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 5);
+
+  for (size_t i = 0; i < clusters; ++i)
+  {
+    size_t j;
+    for (j = 0; j < dataset.n_cols; ++j)
+    {
+      const double distance = metric::EuclideanDistance::Evaluate(
+          centroids.col(i), dataset.col(j));
+      if (distance < 1e-10)
+        break;
+    }
+
+    BOOST_REQUIRE_LT(j, dataset.n_cols);
+  }
+}
+
+/**
+ * With well-separated clusters, k-means|| should choose exactly one centroid
+ * in each cluster, so that KMeans finds the right clusters.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationSeparatedTest)
+{
+  arma::mat centers("  0  100    0 -100  100;"
+                    "  0    0  100    0  100;"
+                    "  0   50  -50    0  -50");
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) += centers.col(i / 200);
+
+  arma::mat centroids;
+  KMeansParallelInitialization kmpi(3, 2.0);
+  kmpi.Cluster(dataset, 5, centroids);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 5);
+  arma::Col<size_t> centroidsPerCluster(5, arma::fill::zeros);
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    // Each cluster lies within the unit cube at its center.
+    for (size_t c = 0; c < centers.n_cols; ++c)
+    {
+      if (metric::EuclideanDistance::Evaluate(centroids.col(i),
+          centers.col(c)) < 2.0)
+        ++centroidsPerCluster[c];
+    }
+  }
+
+  for (size_t c = 0; c < centers.n_cols; ++c)
+    BOOST_REQUIRE_EQUAL(centroidsPerCluster[c], 1);
+
+  // Now use it as the initial partition policy.
+  KMeans<EuclideanDistance, KMeansParallelInitialization> kmeans;
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(dataset, 5, assignments);
+
+  for (size_t c = 0; c < centers.n_cols; ++c)
+  {
+    for (size_t i = c * 200 + 1; i < (c + 1) * 200; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], assignments[c * 200]);
+    for (size_t d = 0; d < c; ++d)
+      BOOST_REQUIRE_NE(assignments[c * 200], assignments[d * 200]);
+  }
+}
+
+/**
+ * Make sure that KMeans takes its centroids from a given k-means|| policy, with
+ * and without returning the centroids.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationKMeansTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 300);
+
+  KMeans<EuclideanDistance, KMeansParallelInitialization> kmeans(1000,
+      EuclideanDistance(), KMeansParallelInitialization(2, 3.0));
+  BOOST_REQUIRE_EQUAL(kmeans.Partitioner().Rounds(), 2);
+  BOOST_REQUIRE_CLOSE(kmeans.Partitioner().Oversampling(), 3.0, 1e-5);
+
+  arma::Row<size_t> assignments;
+  arma::mat centroids;
+  kmeans.Cluster(dataset, 6, assignments, centroids);
+
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 6);
+  for (size_t i = 0; i < assignments.n_elem; ++i)
+    BOOST_REQUIRE_LT(assignments[i], 6);
+
+  arma::mat onlyCentroids;
+  kmeans.Cluster(dataset, 6, onlyCentroids);
+  BOOST_REQUIRE_EQUAL(onlyCentroids.n_cols, 6);
+}
+
+/**
+ * When the dataset has fewer distinct points than clusters, k-means|| should
+ * still return the requested number of centroids.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationDuplicateTest)
+{
+  arma::mat dataset(2, 50);
+  dataset.cols(0, 24).fill(1.0);
+  dataset.cols(25, 49).fill(-1.0);
+
+  arma::mat centroids;
+  KMeansParallelInitialization kmpi;
+  kmpi.Cluster(dataset, 4, centroids);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 2);
+
+  // Both distinct points must have been chosen.
+  size_t positive = 0, negative = 0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    if (centroids(0, i) == 1.0 && centroids(1, i) == 1.0)
+      ++positive;
+    else if (centroids(0, i) == -1.0 && centroids(1, i) == -1.0)
+      ++negative;
+  }
+
+  BOOST_REQUIRE_GT(positive, 0);
+  BOOST_REQUIRE_GT(negative, 0);
+  BOOST_REQUIRE_EQUAL(positive + negative, 4);
+}
+
+/**
+ * Make sure that each iteration of mini-batch k-means makes each centroid the
+ * mean of all points it has been assigned so far.  The points lie at only
+ * three locations, so that mean is the location itself.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansIterateTest)
+{
+  arma::mat locations("0.0 10.0 -10.0; 0.0 10.0 5.0");
+  arma::mat dataset(2, 300);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = locations.col(i % 3);
+
+  arma::mat centroids = locations + 0.5;
+  arma::mat newCentroids;
+  arma::Col<size_t> counts;
+
+  EuclideanDistance metric;
+  MiniBatchKMeans<EuclideanDistance, arma::mat> step(dataset, metric, 50);
+  BOOST_REQUIRE_EQUAL(step.BatchSize(), 50);
+
+  step.Iterate(centroids, newCentroids, counts);
+
+  BOOST_REQUIRE_EQUAL(counts.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(arma::accu(counts), 50);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    // A centroid that was not assigned any point does not move.
+    const arma::vec expected = (counts[i] > 0) ?
+        arma::vec(locations.col(i)) : arma::vec(centroids.col(i));
+    BOOST_REQUIRE_SMALL(arma::norm(newCentroids.col(i) - expected), 1e-10);
+  }
+
+  // The counts are accumulated over the iterations.
+  step.BatchSize() = 100;
+  step.Iterate(newCentroids, centroids, counts);
+  BOOST_REQUIRE_EQUAL(arma::accu(counts), 150);
+  BOOST_REQUIRE_EQUAL(step.DistanceCalculations(), 3 * (50 + 100) + 2 * 3);
+}
+
+/**
+ * Make sure mini-batch k-means finds the clusters of the simple dataset, with
+ * the batch size given to KMeans.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansSimpleTest)
+{
+  const arma::mat data = trans(kMeansData);
+
+  // Start with one point of each class.
+  arma::mat centroids(2, 3);
+  centroids.col(0) = data.col(0);
+  centroids.col(1) = data.col(13);
+  centroids.col(2) = data.col(20);
+
+  KMeans<EuclideanDistance, SampleInitialization, AllowEmptyClusters,
+      MiniBatchKMeans> kmeans(100);
+  kmeans.BatchSize() = 10;
+
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(data, 3, assignments, centroids, false, true);
+
+  for (size_t i = 0; i < 13; i++)
+    BOOST_REQUIRE_EQUAL(assignments(i), 0);
+  for (size_t i = 13; i < 20; i++)
+    BOOST_REQUIRE_EQUAL(assignments(i), 1);
+  for (size_t i = 20; i < 30; i++)
+    BOOST_REQUIRE_EQUAL(assignments(i), 2);
+}
+
+/**
+ * Make sure mini-batch k-means gets close to the centroids found by naive
+ * k-means on well-separated clusters, while looking at only a part of the
+ * dataset.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansApproximationTest)
+{
+  const size_t k = 5;
+  arma::mat centers("0.0 20.0  0.0  0.0 20.0;"
+                    "0.0  0.0 20.0  0.0 20.0;"
+                    "0.0  0.0  0.0 20.0 20.0");
+
+  arma::mat dataset(3, 10000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = centers.col(i % k) + arma::randn<arma::vec>(3);
+
+  arma::mat initialCentroids = centers + 2.0 * arma::randu<arma::mat>(3, k);
+
+  arma::mat naiveCentroids(initialCentroids);
+  KMeans<> naive;
+  naive.Cluster(dataset, k, naiveCentroids, true);
+
+  // 50 iterations of 100 points each only look at half the dataset.
+  arma::mat miniBatchCentroids(initialCentroids);
+  KMeans<EuclideanDistance, SampleInitialization, AllowEmptyClusters,
+      MiniBatchKMeans> miniBatch(50);
+  miniBatch.BatchSize() = 100;
+  miniBatch.Cluster(dataset, k, miniBatchCentroids, true);
+
+  for (size_t i = 0; i < k; ++i)
+  {
+    BOOST_REQUIRE_LT(arma::norm(naiveCentroids.col(i) -
+        miniBatchCentroids.col(i)), 0.5);
+  }
+}
+
+/**
+ * With deterministic reductions, the centroids of the naive and Hamerly
+ * algorithms should not depend on the number of threads at all.
+ */
+BOOST_AUTO_TEST_CASE(KMeansDeterministicReductionsTest)
+{
+  const size_t k = 5;
+  arma::mat dataset = 10.0 * arma::randu<arma::mat>(4, 20000);
+  arma::mat initialCentroids = 10.0 * arma::randu<arma::mat>(4, k);
+
+  SetDeterministicReductions(true);
+
+  arma::mat naiveSerial(initialCentroids), naiveParallel(initialCentroids);
+  arma::mat hamerlySerial(initialCentroids), hamerlyParallel(initialCentroids);
+  KMeans<> naive(20);
+  KMeans<EuclideanDistance, SampleInitialization, MaxVarianceNewCluster,
+      HamerlyKMeans> hamerly(20);
+  {
+    ScopedThreadLimit limit(1);
+    naive.Cluster(dataset, k, naiveSerial, true);
+    hamerly.Cluster(dataset, k, hamerlySerial, true);
+  }
+  naive.Cluster(dataset, k, naiveParallel, true);
+  hamerly.Cluster(dataset, k, hamerlyParallel, true);
+
+  SetDeterministicReductions(false);
+
+  for (size_t i = 0; i < naiveSerial.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(naiveSerial[i], naiveParallel[i]);
+    BOOST_REQUIRE_EQUAL(hamerlySerial[i], hamerlyParallel[i]);
+  }
+}
+
+/**
+ * Split the given dataset into shards of 300, 0, 50 and the rest of the
+ * points.
+ */
+std::vector<arma::mat> SplitShards(const arma::mat& dataset)
+{
+  std::vector<arma::mat> shards(4);
+  shards[0] = dataset.cols(0, 299);
+  shards[1].set_size(dataset.n_rows, 0);
+  shards[2] = dataset.cols(300, 349);
+  shards[3] = dataset.cols(350, dataset.n_cols - 1);
+  return shards;
+}
+
+/**
+ * Make sure that ShardedKMeans finds the same centroids as KMeans on the whole
+ * dataset, with each empty cluster policy, and with an initial centroid that
+ * gets no points.
+ */
+BOOST_AUTO_TEST_CASE(ShardedKMeansTest)
+{
+  arma::mat centers("  0  100    0 -100  100;"
+                    "  0    0  100    0  100;"
+                    "  0   50  -50    0  -50");
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) += centers.col(i / 200);
+  const std::vector<arma::mat> shards = SplitShards(dataset);
+
+  // The last centroid is far from all points, so it is empty after the first
+  // iteration.
+  arma::mat initialCentroids = dataset.cols(arma::uvec("0 1 400 401 2"));
+  initialCentroids.col(4).fill(1000.0);
+
+  for (size_t p = 0; p < 3; ++p)
+  {
+    arma::mat centroids(initialCentroids), shardedCentroids(initialCentroids);
+    if (p == 0)
+    {
+      KMeans<> kmeans(50);
+      ShardedKMeans<> sharded(50);
+      kmeans.Cluster(dataset, 5, centroids, true);
+      sharded.Cluster(shards, 5, shardedCentroids, true);
+    }
+    else if (p == 1)
+    {
+      KMeans<EuclideanDistance, SampleInitialization, KillEmptyClusters>
+          kmeans(50);
+      ShardedKMeans<EuclideanDistance, KillEmptyClusters> sharded(50);
+      kmeans.Cluster(dataset, 5, centroids, true);
+      sharded.Cluster(shards, 5, shardedCentroids, true);
+    }
+    else
+    {
+      KMeans<EuclideanDistance, SampleInitialization, AllowEmptyClusters>
+          kmeans(50);
+      ShardedKMeans<EuclideanDistance, AllowEmptyClusters> sharded(50);
+      kmeans.Cluster(dataset, 5, centroids, true);
+      sharded.Cluster(shards, 5, shardedCentroids, true);
+    }
+
+    BOOST_REQUIRE_EQUAL(shardedCentroids.n_rows, centroids.n_rows);
+    BOOST_REQUIRE_EQUAL(shardedCentroids.n_cols, centroids.n_cols);
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+    {
+      if (centroids[i] == DBL_MAX)
+        BOOST_REQUIRE_EQUAL(shardedCentroids[i], DBL_MAX);
+      else
+        BOOST_REQUIRE_SMALL(shardedCentroids[i] - centroids[i], 1e-8);
+    }
+  }
+
+  // With the initial centroids chosen by k-means||, each cluster is found.
+  ShardedKMeans<> sharded;
+  arma::mat centroids;
+  std::vector<arma::Row<size_t>> assignments;
+  sharded.Cluster(shards, 5, assignments, centroids);
+
+  BOOST_REQUIRE_EQUAL(assignments.size(), shards.size());
+  arma::Row<size_t> allAssignments(dataset.n_cols);
+  for (size_t s = 0, i = 0; s < shards.size(); ++s)
+  {
+    BOOST_REQUIRE_EQUAL(assignments[s].n_elem, shards[s].n_cols);
+    for (size_t j = 0; j < assignments[s].n_elem; ++j)
+      allAssignments[i++] = assignments[s][j];
+  }
+
+  for (size_t c = 0; c < centers.n_cols; ++c)
+  {
+    for (size_t i = c * 200 + 1; i < (c + 1) * 200; ++i)
+      BOOST_REQUIRE_EQUAL(allAssignments[i], allAssignments[c * 200]);
+    for (size_t d = 0; d < c; ++d)
+      BOOST_REQUIRE_NE(allAssignments[c * 200], allAssignments[d * 200]);
+  }
+
+  std::vector<arma::mat> wrongShards(shards);
+  wrongShards[2] = arma::randu<arma::mat>(2, 10);
+  BOOST_REQUIRE_THROW(sharded.Cluster(wrongShards, 5, centroids),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(sharded.Cluster(shards, 1001, centroids),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that k-means|| on a single shard chooses the same centroids as on
+ * the whole dataset, and that on several shards each centroid is a point.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationShardsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+  KMeansParallelInitialization kmpi;
+
+  arma::mat centroids, shardCentroids;
+  math::RandomSeed(17);
+  kmpi.Cluster(dataset, 5, centroids);
+  math::RandomSeed(17);
+  kmpi.ClusterShards(std::vector<arma::mat>(1, dataset), 5, shardCentroids);
+  CheckMatrices(centroids, shardCentroids);
+
+  kmpi.ClusterShards(SplitShards(dataset), 5, shardCentroids);
+  BOOST_REQUIRE_EQUAL(shardCentroids.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(shardCentroids.n_cols, 5);
+  for (size_t c = 0; c < shardCentroids.n_cols; ++c)
+  {
+    bool found = false;
+    for (size_t i = 0; i < dataset.n_cols && !found; ++i)
+      found = arma::all(dataset.col(i) == shardCentroids.col(c));
+    BOOST_REQUIRE(found);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
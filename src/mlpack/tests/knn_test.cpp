@@ -12,10 +12,18 @@
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
+#include <mlpack/methods/neighbor_search/nn_descent.hpp>
+#include <mlpack/methods/neighbor_search/sharded_neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/whitened_neighbor_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 using namespace mlpack;
 using namespace mlpack::neighbor;
@@ -719,6 +727,165 @@ BOOST_AUTO_TEST_CASE(DualTreeVsNaive2)
   }
 }
 
+/**
+ * Test the dual-tree nearest-neighbors method with the naive method on
+ * high-dimensional data, where the base cases between two leaves are computed
+ * as a block.  This uses both a query and reference dataset, and also the
+ * squared Euclidean distance.
+ *
+ * Errors are produced if the results are not identical.
+ */
+BOOST_AUTO_TEST_CASE(HighDimensionalDualTreeVsNaive)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(100, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(100, 300);
+
+  KNN knn(referenceData);
+  KNN naive(referenceData, NAIVE_MODE);
+
+  arma::Mat<size_t> neighborsTree, neighborsNaive;
+  arma::mat distancesTree, distancesNaive;
+  knn.Search(queryData, 10, neighborsTree, distancesTree);
+  naive.Search(queryData, 10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+
+  knn.Search(10, neighborsTree, distancesTree);
+  naive.Search(10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+
+  typedef NeighborSearch<NearestNeighborSort, SquaredEuclideanDistance>
+      SquaredKNN;
+  SquaredKNN squaredKnn(referenceData);
+  SquaredKNN squaredNaive(referenceData, NAIVE_MODE);
+
+  squaredKnn.Search(queryData, 10, neighborsTree, distancesTree);
+  squaredNaive.Search(queryData, 10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that naive search on high-dimensional data, whose base cases are
+ * computed in tiles of query and reference points, finds the same neighbors as
+ * evaluating every distance, both with a separate query set and with only a
+ * reference set.
+ */
+BOOST_AUTO_TEST_CASE(HighDimensionalNaiveTilesTest)
+{
+  // There are several tiles of query points and of reference points.
+  arma::mat referenceData = arma::randu<arma::mat>(64, 2500);
+  arma::mat queryData = arma::randu<arma::mat>(64, 600);
+  const size_t k = 7;
+
+  KNN naive(referenceData, NAIVE_MODE);
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    const bool monochromatic = (trial == 1);
+    const arma::mat& querySet = monochromatic ? referenceData : queryData;
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    if (monochromatic)
+      naive.Search(k, neighbors, distances);
+    else
+      naive.Search(queryData, k, neighbors, distances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+    {
+      std::vector<std::pair<double, size_t>> all;
+      for (size_t r = 0; r < referenceData.n_cols; ++r)
+      {
+        if (monochromatic && r == q)
+          continue;
+        all.push_back(std::make_pair(EuclideanDistance::Evaluate(
+            querySet.col(q), referenceData.col(r)), r));
+      }
+      std::sort(all.begin(), all.end());
+
+      for (size_t i = 0; i < k; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors(i, q), all[i].second);
+        BOOST_REQUIRE_CLOSE(distances(i, q), all[i].first, 1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Test the multithreaded dual-tree nearest-neighbors method with the naive
+ * method, both with a separate query set and with only a reference set.  The
+ * search uses four threads, so that the query tree is really split between
+ * threads even on machines with a single core.
+ *
+ * Errors are produced if the results are not identical.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeVsNaive)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    BOOST_REQUIRE_GE(ParallelThreads(), 2);
+  #endif
+
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      KDTree, KDTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat>::ParallelDualTreeTraverser> ParallelKNN;
+
+  ParallelKNN knn(dataset);
+  KNN naive(dataset, NAIVE_MODE);
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 300);
+
+  arma::Mat<size_t> neighborsTree, neighborsNaive;
+  arma::mat distancesTree, distancesNaive;
+  knn.Search(querySet, 10, neighborsTree, distancesTree);
+  naive.Search(querySet, 10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+
+  // Run the monochromatic search twice, to make sure that the statistics of the
+  // reference tree are reset correctly.
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    knn.Search(10, neighborsTree, distancesTree);
+    naive.Search(10, neighborsNaive, distancesNaive);
+
+    for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+      BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+    }
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+}
+
 /**
  * Test the single-tree nearest-neighbors method with the naive method.  This
  * uses only a reference dataset.
@@ -888,6 +1055,41 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest)
   }
 }
 
+/**
+ * Make sure that dual-tree and single-tree search give the same results as the
+ * naive method when the kd-tree has been frozen into a contiguous layout.
+ */
+BOOST_AUTO_TEST_CASE(FrozenTreeTest)
+{
+  arma::mat data;
+  data.randu(5, 1000);
+
+  KNN::Tree tree(data);
+  tree.Freeze(VAN_EMDE_BOAS_LAYOUT);
+  BOOST_REQUIRE(tree.IsFrozen());
+
+  KNN naive(tree.Dataset(), NAIVE_MODE);
+  KNN::Tree singleTree(tree);
+  singleTree.Freeze(DEPTH_FIRST_LAYOUT);
+
+  KNN dualTreeSearch(std::move(tree));
+  KNN singleTreeSearch(std::move(singleTree), SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, dualNeighbors, singleNeighbors;
+  arma::mat naiveDistances, dualDistances, singleDistances;
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  dualTreeSearch.Search(5, dualNeighbors, dualDistances);
+  singleTreeSearch.Search(5, singleNeighbors, singleDistances);
+
+  for (size_t i = 0; i < naiveNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(dualNeighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(dualDistances[i], naiveDistances[i], 1e-5);
+    BOOST_REQUIRE_EQUAL(singleNeighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(singleDistances[i], naiveDistances[i], 1e-5);
+  }
+}
+
 /**
  * Test the spill tree hybrid sp-tree search (defeatist search on overlapping
  * nodes, and backtracking in non-overlapping nodes) against the naive method.
@@ -1020,6 +1222,49 @@ BOOST_AUTO_TEST_CASE(SparseKNNKDTreeTest)
   }
 }
 
+/**
+ * Make sure sparse nearest neighbors works with ball trees, in single-tree and
+ * dual-tree mode.
+ */
+BOOST_AUTO_TEST_CASE(SparseKNNBallTreeTest)
+{
+  // See SparseKNNKDTreeTest for the choice of dimensionality.
+  arma::sp_mat queryDataset;
+  queryDataset.sprandu(70, 200, 0.2);
+  arma::sp_mat referenceDataset;
+  referenceDataset.sprandu(70, 500, 0.1);
+  arma::mat denseQuery(queryDataset);
+  arma::mat denseReference(referenceDataset);
+
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::sp_mat,
+      BallTree> SparseKNN;
+
+  KNN naive(denseReference, NAIVE_MODE);
+  arma::mat naiveDistances;
+  arma::Mat<size_t> naiveNeighbors;
+  naive.Search(denseQuery, 10, naiveNeighbors, naiveDistances);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    SparseKNN a(referenceDataset, (mode == 0) ? SINGLE_TREE_MODE :
+        DUAL_TREE_MODE);
+
+    arma::mat sparseDistances;
+    arma::Mat<size_t> sparseNeighbors;
+    a.Search(queryDataset, 10, sparseNeighbors, sparseDistances);
+
+    for (size_t i = 0; i < naiveNeighbors.n_cols; ++i)
+    {
+      for (size_t j = 0; j < naiveNeighbors.n_rows; ++j)
+      {
+        BOOST_REQUIRE_EQUAL(naiveNeighbors(j, i), sparseNeighbors(j, i));
+        BOOST_REQUIRE_CLOSE(naiveDistances(j, i), sparseDistances(j, i),
+            1e-5);
+      }
+    }
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SparseKNNCoverTreeTest)
 {
@@ -1230,6 +1475,161 @@ BOOST_AUTO_TEST_CASE(KNNModelMonochromaticTest)
  * before the second search.  This test ensures that that happens, by making
  * sure the number of scores and base cases are equivalent for each search.
  */
+/**
+ * Make sure that a kd-tree or ball tree NSModel saved as an index gives the
+ * same results when it is loaded again, and that other models are rejected.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelIndexTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 500);
+
+  KNNModel models[4];
+  models[0] = KNNModel(KNNModel::TreeTypes::KD_TREE, true);
+  models[1] = KNNModel(KNNModel::TreeTypes::KD_TREE, false);
+  models[2] = KNNModel(KNNModel::TreeTypes::BALL_TREE, true);
+  models[3] = KNNModel(KNNModel::TreeTypes::BALL_TREE, false);
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    arma::mat referenceCopy(referenceData);
+    models[i].BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+
+    models[i].SaveIndex("knn_index.bin");
+    KNNModel loaded;
+    loaded.LoadIndex("knn_index.bin");
+
+    BOOST_REQUIRE_EQUAL(loaded.TreeType(), models[i].TreeType());
+    BOOST_REQUIRE_EQUAL(loaded.RandomBasis(), models[i].RandomBasis());
+    BOOST_REQUIRE_EQUAL(loaded.LeafSize(), models[i].LeafSize());
+    CheckMatrices(loaded.Dataset(), models[i].Dataset());
+
+    arma::Mat<size_t> neighbors, loadedNeighbors;
+    arma::mat distances, loadedDistances;
+
+    // Bichromatic search.
+    arma::mat queryCopy(queryData);
+    arma::mat loadedQueryCopy(queryData);
+    models[i].Search(std::move(queryCopy), 3, neighbors, distances);
+    loaded.Search(std::move(loadedQueryCopy), 3, loadedNeighbors,
+        loadedDistances);
+    CheckMatrices(loadedNeighbors, neighbors);
+    CheckMatrices(loadedDistances, distances);
+
+    // Monochromatic search, with single-tree search too.
+    models[i].Search(3, neighbors, distances);
+    loaded.Search(3, loadedNeighbors, loadedDistances);
+    CheckMatrices(loadedNeighbors, neighbors);
+    CheckMatrices(loadedDistances, distances);
+
+    loaded.SearchMode() = SINGLE_TREE_MODE;
+    loaded.Search(3, loadedNeighbors, loadedDistances);
+    CheckMatrices(loadedNeighbors, neighbors);
+    CheckMatrices(loadedDistances, distances);
+  }
+
+  remove("knn_index.bin");
+
+  // Other tree types can't be saved as an index.
+  KNNModel coverModel(KNNModel::TreeTypes::COVER_TREE, false);
+  arma::mat referenceCopy(referenceData);
+  coverModel.BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+  BOOST_REQUIRE_THROW(coverModel.SaveIndex("knn_index.bin"),
+      std::invalid_argument);
+
+  // A file that isn't an index can't be loaded.
+  data::Save("knn_index.csv", referenceData);
+  KNNModel loaded;
+  BOOST_REQUIRE_THROW(loaded.LoadIndex("knn_index.csv"), std::runtime_error);
+  remove("knn_index.csv");
+}
+
+/**
+ * Make sure that an NSModel saved as an index without its reference set can
+ * be loaded with the reference set, and gives the same results.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelIndexWithoutReferenceTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 500);
+
+  KNNModel models[5];
+  models[0] = KNNModel(KNNModel::TreeTypes::KD_TREE, true);
+  models[1] = KNNModel(KNNModel::TreeTypes::KD_TREE, false);
+  models[2] = KNNModel(KNNModel::TreeTypes::BALL_TREE, true);
+  models[3] = KNNModel(KNNModel::TreeTypes::BALL_TREE, false);
+  models[4] = KNNModel(KNNModel::TreeTypes::KD_TREE, false);
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    if (i < 4)
+    {
+      arma::mat referenceCopy(referenceData);
+      models[i].BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+    }
+    else
+    {
+      arma::fmat referenceCopy = arma::conv_to<arma::fmat>::from(referenceData);
+      models[i].BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+    }
+
+    models[i].SaveIndex("knn_index.bin");
+    models[i].SaveIndex("knn_index_tree.bin", false);
+
+    // The index without the reference set is smaller, and can't be loaded on
+    // its own.
+    data::MappedFile full("knn_index.bin");
+    data::MappedFile treeOnly("knn_index_tree.bin");
+    BOOST_REQUIRE_GE(full.Size() - treeOnly.Size(), referenceData.n_elem *
+        (i < 4 ? sizeof(double) : sizeof(float)));
+
+    KNNModel loaded;
+    BOOST_REQUIRE_THROW(loaded.LoadIndex("knn_index_tree.bin"),
+        std::runtime_error);
+    BOOST_REQUIRE_THROW(loaded.LoadIndex("knn_index_tree.bin",
+        arma::mat(referenceData.cols(0, 99))), std::invalid_argument);
+
+    loaded.LoadIndex("knn_index_tree.bin", referenceData);
+    BOOST_REQUIRE_EQUAL(loaded.TreeType(), models[i].TreeType());
+    BOOST_REQUIRE_EQUAL(loaded.RandomBasis(), models[i].RandomBasis());
+    if (i < 4)
+      CheckMatrices(loaded.Dataset(), models[i].Dataset());
+    else
+      CheckMatrices(loaded.SinglePrecisionDataset(),
+          models[i].SinglePrecisionDataset());
+
+    arma::Mat<size_t> neighbors, loadedNeighbors;
+    arma::mat distances, loadedDistances;
+
+    arma::mat queryCopy(queryData);
+    arma::mat loadedQueryCopy(queryData);
+    models[i].Search(std::move(queryCopy), 3, neighbors, distances);
+    loaded.Search(std::move(loadedQueryCopy), 3, loadedNeighbors,
+        loadedDistances);
+    CheckMatrices(loadedNeighbors, neighbors);
+    CheckMatrices(loadedDistances, distances);
+
+    models[i].Search(3, neighbors, distances);
+    loaded.Search(3, loadedNeighbors, loadedDistances);
+    CheckMatrices(loadedNeighbors, neighbors);
+    CheckMatrices(loadedDistances, distances);
+
+    // A full index can be loaded with the reference set too.
+    KNNModel loadedFull;
+    loadedFull.LoadIndex("knn_index.bin", referenceData);
+    loadedFull.Search(3, loadedNeighbors, loadedDistances);
+    CheckMatrices(loadedNeighbors, neighbors);
+    CheckMatrices(loadedDistances, distances);
+  }
+
+  remove("knn_index.bin");
+  remove("knn_index_tree.bin");
+}
+
 BOOST_AUTO_TEST_CASE(DoubleReferenceSearchTest)
 {
   arma::mat dataset = arma::randu<arma::mat>(5, 500);
@@ -1434,4 +1834,993 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Insert points into and remove points from an R* tree NeighborSearch object,
+ * and make sure that the results match naive search on the updated reference
+ * set.
+ */
+BOOST_AUTO_TEST_CASE(InsertRemoveTest)
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      RStarTree> KNNType;
+
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::mat newPoints = arma::randu<arma::mat>(5, 200);
+  arma::mat querySet = arma::randu<arma::mat>(5, 100);
+
+  KNNType knn(dataset);
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+
+  // Run a search first, so that the statistics of the tree are used.
+  knn.Search(5, neighbors, distances);
+
+  knn.Insert(newPoints);
+  dataset.insert_cols(dataset.n_cols, newPoints);
+  BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, 1200);
+  BOOST_REQUIRE_EQUAL(knn.ReferenceTree().NumDescendants(), 1200);
+
+  arma::Col<size_t> removed = { 3, 17, 17, 500, 999, 1000, 1199 };
+  knn.Remove(removed);
+  dataset.shed_col(1199);
+  dataset.shed_col(1000);
+  dataset.shed_col(999);
+  dataset.shed_col(500);
+  dataset.shed_col(17);
+  dataset.shed_col(3);
+  BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, 1194);
+  BOOST_REQUIRE_EQUAL(knn.ReferenceTree().NumDescendants(), 1194);
+  CheckMatrices(knn.ReferenceSet(), dataset);
+
+  KNNType naive(dataset, NAIVE_MODE);
+
+  // Monochromatic and bichromatic search, in dual-tree and single-tree mode.
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  knn.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  knn.SearchMode() = SINGLE_TREE_MODE;
+  knn.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+  knn.Search(querySet, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  knn.SearchMode() = DUAL_TREE_MODE;
+  knn.Search(querySet, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  // Naive search on a reference set we own can be updated too.
+  naive.Insert(newPoints);
+  BOOST_REQUIRE_EQUAL(naive.ReferenceSet().n_cols, 1394);
+
+  // Invalid updates.
+  BOOST_REQUIRE_THROW(knn.Remove(arma::Col<size_t>({ 1194 })),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(knn.Insert(arma::randu<arma::mat>(4, 10)),
+      std::invalid_argument);
+
+  // A kd-tree can't be updated.
+  KNN kdKNN(dataset);
+  BOOST_REQUIRE_THROW(kdKNN.Insert(newPoints), std::invalid_argument);
+  BOOST_REQUIRE_THROW(kdKNN.Remove(removed), std::invalid_argument);
+}
+
+/**
+ * Make sure that NSModel can update R tree models, with or without a random
+ * basis.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelInsertRemoveTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  arma::mat newPoints = arma::randu<arma::mat>(5, 100);
+  arma::Col<size_t> removed = { 0, 250, 599 };
+
+  arma::mat finalDataset(dataset);
+  finalDataset.insert_cols(finalDataset.n_cols, newPoints);
+  finalDataset.shed_col(599);
+  finalDataset.shed_col(250);
+  finalDataset.shed_col(0);
+
+  KNN knn(finalDataset);
+  arma::Mat<size_t> neighbors, baselineNeighbors;
+  arma::mat distances, baselineDistances;
+  knn.Search(3, baselineNeighbors, baselineDistances);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    KNNModel model(KNNModel::TreeTypes::R_TREE, (i == 1));
+    arma::mat referenceCopy(dataset);
+    model.BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+
+    model.Insert(newPoints);
+    model.Remove(removed);
+    BOOST_REQUIRE_EQUAL(model.Dataset().n_cols, finalDataset.n_cols);
+
+    model.Search(3, neighbors, distances);
+    CheckMatrices(neighbors, baselineNeighbors);
+    CheckMatrices(distances, baselineDistances);
+  }
+}
+
+/**
+ * Make sure that the work budget of single-tree search bounds the number of base
+ * cases per query point, and that query points that stay within the budget get
+ * exact results.
+ */
+BOOST_AUTO_TEST_CASE(MaxBaseCasesTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(5, 100);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  arma::Mat<size_t> trueNeighbors, trueMonoNeighbors;
+  arma::mat trueDistances, trueMonoDistances;
+  naive.Search(queryData, 5, trueNeighbors, trueDistances);
+  naive.Search(5, trueMonoNeighbors, trueMonoDistances);
+
+  KNN knn(referenceData, SINGLE_TREE_MODE);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  // Without a budget, the search is exact and never truncated.
+  knn.Search(queryData, 5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(knn.Truncated().size(), queryData.n_cols);
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+    BOOST_REQUIRE(!knn.Truncated()[i]);
+  CheckMatrices(neighbors, trueNeighbors);
+
+  // A tiny budget truncates the search.
+  knn.MaxBaseCases() = 25;
+  knn.Search(queryData, 5, neighbors, distances);
+  BOOST_REQUIRE_LE(knn.BaseCases(), 25 * queryData.n_cols);
+  BOOST_REQUIRE_EQUAL(knn.Truncated().size(), queryData.n_cols);
+
+  size_t numTruncated = 0;
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+  {
+    if (knn.Truncated()[i])
+    {
+      ++numTruncated;
+      continue;
+    }
+
+    CheckMatrices(neighbors.col(i), trueNeighbors.col(i));
+    CheckMatrices(distances.col(i), trueDistances.col(i));
+  }
+  BOOST_REQUIRE_GT(numTruncated, 0);
+
+  // The same holds for monochromatic search.
+  knn.Search(5, neighbors, distances);
+  BOOST_REQUIRE_LE(knn.BaseCases(), 25 * referenceData.n_cols);
+  BOOST_REQUIRE_EQUAL(knn.Truncated().size(), referenceData.n_cols);
+  for (size_t i = 0; i < referenceData.n_cols; ++i)
+  {
+    if (!knn.Truncated()[i])
+    {
+      CheckMatrices(neighbors.col(i), trueMonoNeighbors.col(i));
+      CheckMatrices(distances.col(i), trueMonoDistances.col(i));
+    }
+  }
+
+  // A budget large enough for the whole reference set changes nothing.
+  knn.MaxBaseCases() = referenceData.n_cols;
+  knn.Search(queryData, 5, neighbors, distances);
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+    BOOST_REQUIRE(!knn.Truncated()[i]);
+  CheckMatrices(neighbors, trueNeighbors);
+
+  // Dual-tree search ignores the budget.
+  knn.MaxBaseCases() = 25;
+  knn.SearchMode() = DUAL_TREE_MODE;
+  knn.Search(queryData, 5, neighbors, distances);
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+    BOOST_REQUIRE(!knn.Truncated()[i]);
+  CheckMatrices(neighbors, trueNeighbors);
+}
+
+/**
+ * Make sure that k-nearest-neighbor and k-furthest-neighbor search on one
+ * SharedTree give the same results as searches that build their own trees.
+ */
+BOOST_AUTO_TEST_CASE(SharedTreeTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(4, 200);
+
+  std::vector<size_t> oldFromNew;
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(referenceData,
+      oldFromNew);
+  SharedTree shared(tree, oldFromNew);
+
+  KNN knn;
+  knn.Train(shared);
+  KFN kfn(SINGLE_TREE_MODE);
+  kfn.Train(shared);
+  BOOST_REQUIRE_EQUAL(shared.UseCount(), 3);
+
+  KNN trueKNN(referenceData);
+  KFN trueKFN(referenceData);
+
+  arma::Mat<size_t> neighbors, trueNeighbors;
+  arma::mat distances, trueDistances;
+
+  knn.Search(queryData, 5, neighbors, distances);
+  trueKNN.Search(queryData, 5, trueNeighbors, trueDistances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+
+  knn.Search(5, neighbors, distances);
+  trueKNN.Search(5, trueNeighbors, trueDistances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+
+  kfn.Search(queryData, 5, neighbors, distances);
+  trueKFN.Search(queryData, 5, trueNeighbors, trueDistances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+
+  // The points are shared, so they can't be changed.
+  BOOST_REQUIRE_THROW(knn.Insert(queryData), std::invalid_argument);
+
+  // A copy owns its points.
+  KNN copy(knn);
+  copy.Insert(queryData);
+  BOOST_REQUIRE_EQUAL(copy.ReferenceSet().n_cols, 1200);
+
+  // Training on something else releases the handle.
+  kfn.Train(referenceData);
+  BOOST_REQUIRE_EQUAL(shared.UseCount(), 2);
+
+  // A tree with another bound type can't use the shared tree.
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, BallTree>
+      ballKNN;
+  BOOST_REQUIRE_THROW(ballKNN.Train(shared), std::runtime_error);
+}
+
+/**
+ * Make sure that kd-tree and ball tree models built in single precision find
+ * the same neighbors as models in double precision, also after saving them as
+ * an index.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelSinglePrecisionTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 500);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> baselineNeighbors, baselineMonoNeighbors;
+  arma::mat baselineDistances, baselineMonoDistances;
+  knn.Search(queryData, 3, baselineNeighbors, baselineDistances);
+  knn.Search(3, baselineMonoNeighbors, baselineMonoDistances);
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    KNNModel model((i < 2) ? KNNModel::TreeTypes::KD_TREE :
+        KNNModel::TreeTypes::BALL_TREE, (i % 2 == 1));
+    arma::fmat referenceCopy = arma::conv_to<arma::fmat>::from(referenceData);
+    model.BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+
+    BOOST_REQUIRE(model.SinglePrecision());
+    BOOST_REQUIRE_EQUAL(model.SinglePrecisionDataset().n_cols, 500);
+    BOOST_REQUIRE_THROW(model.Dataset(), std::invalid_argument);
+
+    model.SaveIndex("knn_index.bin");
+    KNNModel loaded;
+    loaded.LoadIndex("knn_index.bin");
+    BOOST_REQUIRE(loaded.SinglePrecision());
+
+    for (KNNModel* m : { &model, &loaded })
+    {
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+
+      // Query sets in either precision are accepted.
+      arma::mat queryCopy(queryData);
+      m->Search(std::move(queryCopy), 3, neighbors, distances);
+      CheckMatrices(neighbors, baselineNeighbors);
+      CheckMatrices(distances, baselineDistances, 1e-3);
+
+      arma::fmat singleQueryCopy = arma::conv_to<arma::fmat>::from(queryData);
+      m->Search(std::move(singleQueryCopy), 3, neighbors, distances);
+      CheckMatrices(neighbors, baselineNeighbors);
+      CheckMatrices(distances, baselineDistances, 1e-3);
+
+      m->Search(3, neighbors, distances);
+      CheckMatrices(neighbors, baselineMonoNeighbors);
+      CheckMatrices(distances, baselineMonoDistances, 1e-3);
+    }
+  }
+
+  remove("knn_index.bin");
+
+  // Other tree types can't be built in single precision.
+  KNNModel coverModel(KNNModel::TreeTypes::COVER_TREE, false);
+  arma::fmat referenceCopy = arma::conv_to<arma::fmat>::from(referenceData);
+  BOOST_REQUIRE_THROW(coverModel.BuildModel(std::move(referenceCopy), 20,
+      DUAL_TREE_MODE), std::invalid_argument);
+
+  // A single-precision query set can be used with a double-precision model.
+  KNNModel model(KNNModel::TreeTypes::KD_TREE, false);
+  arma::mat doubleReferenceCopy(referenceData);
+  model.BuildModel(std::move(doubleReferenceCopy), 20, DUAL_TREE_MODE);
+  BOOST_REQUIRE(!model.SinglePrecision());
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  arma::fmat singleQueryCopy = arma::conv_to<arma::fmat>::from(queryData);
+  model.Search(std::move(singleQueryCopy), 3, neighbors, distances);
+  CheckMatrices(neighbors, baselineNeighbors);
+  CheckMatrices(distances, baselineDistances, 1e-3);
+}
+
+/**
+ * Make sure that octree models built in single precision on 3-dimensional data
+ * find the same neighbors as models in double precision.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelSinglePrecisionOctreeTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+  arma::mat referenceData = arma::randu<arma::mat>(3, 2000);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> baselineNeighbors, baselineMonoNeighbors;
+  arma::mat baselineDistances, baselineMonoDistances;
+  knn.Search(queryData, 3, baselineNeighbors, baselineDistances);
+  knn.Search(3, baselineMonoNeighbors, baselineMonoDistances);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    KNNModel model(KNNModel::TreeTypes::OCTREE, false);
+    arma::fmat referenceCopy = arma::conv_to<arma::fmat>::from(referenceData);
+    model.BuildModel(std::move(referenceCopy), 10, (mode == 0) ?
+        DUAL_TREE_MODE : SINGLE_TREE_MODE);
+    BOOST_REQUIRE(model.SinglePrecision());
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    arma::fmat singleQueryCopy = arma::conv_to<arma::fmat>::from(queryData);
+    model.Search(std::move(singleQueryCopy), 3, neighbors, distances);
+    CheckMatrices(neighbors, baselineNeighbors);
+    CheckMatrices(distances, baselineDistances, 1e-3);
+
+    model.Search(3, neighbors, distances);
+    CheckMatrices(neighbors, baselineMonoNeighbors);
+    CheckMatrices(distances, baselineMonoDistances, 1e-3);
+  }
+}
+
+/**
+ * Make sure that kd-tree and ball tree models built on sparse reference sets
+ * find the same neighbors as dense models, for sparse and dense query sets.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelSparseTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::sp_mat queryData, referenceData;
+  queryData.sprandu(70, 50, 0.2);
+  referenceData.sprandu(70, 500, 0.1);
+
+  KNN knn((arma::mat(referenceData)));
+  arma::Mat<size_t> baselineNeighbors, baselineMonoNeighbors;
+  arma::mat baselineDistances, baselineMonoDistances;
+  knn.Search(arma::mat(queryData), 3, baselineNeighbors, baselineDistances);
+  knn.Search(3, baselineMonoNeighbors, baselineMonoDistances);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    KNNModel model((i == 1) ? KNNModel::TreeTypes::BALL_TREE :
+        KNNModel::TreeTypes::KD_TREE, false);
+    arma::sp_mat referenceCopy(referenceData);
+    model.BuildModel(std::move(referenceCopy), 20, (i == 2) ? NAIVE_MODE :
+        DUAL_TREE_MODE);
+
+    BOOST_REQUIRE(model.Sparse());
+    BOOST_REQUIRE_EQUAL(model.SparseDataset().n_cols, 500);
+    BOOST_REQUIRE_THROW(model.Dataset(), std::invalid_argument);
+    BOOST_REQUIRE_THROW(model.SaveIndex("knn_index.bin"),
+        std::invalid_argument);
+
+    // Serialization keeps the model sparse.
+    KNNModel xmlModel, textModel, binaryModel;
+    SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+    BOOST_REQUIRE(xmlModel.Sparse());
+    BOOST_REQUIRE(textModel.Sparse());
+    BOOST_REQUIRE(binaryModel.Sparse());
+
+    for (KNNModel* m : { &model, &binaryModel })
+    {
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+
+      arma::sp_mat queryCopy(queryData);
+      m->Search(std::move(queryCopy), 3, neighbors, distances);
+      CheckMatrices(neighbors, baselineNeighbors);
+      CheckMatrices(distances, baselineDistances);
+
+      // Dense query sets are converted.
+      arma::mat denseQueryCopy(queryData);
+      m->Search(std::move(denseQueryCopy), 3, neighbors, distances);
+      CheckMatrices(neighbors, baselineNeighbors);
+      CheckMatrices(distances, baselineDistances);
+
+      m->Search(3, neighbors, distances);
+      CheckMatrices(neighbors, baselineMonoNeighbors);
+      CheckMatrices(distances, baselineMonoDistances);
+    }
+  }
+
+  // Other tree types and random bases can't be used with sparse data.
+  KNNModel coverModel(KNNModel::TreeTypes::COVER_TREE, false);
+  arma::sp_mat referenceCopy(referenceData);
+  BOOST_REQUIRE_THROW(coverModel.BuildModel(std::move(referenceCopy), 20,
+      DUAL_TREE_MODE), std::invalid_argument);
+  KNNModel randomModel(KNNModel::TreeTypes::KD_TREE, true);
+  BOOST_REQUIRE_THROW(randomModel.BuildModel(std::move(referenceCopy), 20,
+      DUAL_TREE_MODE), std::invalid_argument);
+}
+
+/**
+ * Make sure that single-tree search with the cover tree's
+ * ParallelSingleTreeTraverser finds the same neighbors with the same amount of
+ * work as single-tree search with the regular cover tree traverser.
+ */
+BOOST_AUTO_TEST_CASE(ParallelCoverTreeSingleTreeTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(4, 500);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> serial(referenceData, SINGLE_TREE_MODE);
+  CoverTreeNSType<NearestNeighborSort> parallel(referenceData,
+      SINGLE_TREE_MODE);
+  KNN naive(referenceData, NAIVE_MODE);
+
+  arma::Mat<size_t> neighbors, serialNeighbors, naiveNeighbors;
+  arma::mat distances, serialDistances, naiveDistances;
+
+  // Bichromatic search.
+  serial.Search(queryData, 5, serialNeighbors, serialDistances);
+  parallel.Search(queryData, 5, neighbors, distances);
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+  BOOST_REQUIRE_EQUAL(parallel.BaseCases(), serial.BaseCases());
+  BOOST_REQUIRE_EQUAL(parallel.Scores(), serial.Scores());
+
+  // Monochromatic search.
+  serial.Search(5, serialNeighbors, serialDistances);
+  parallel.Search(5, neighbors, distances);
+  naive.Search(5, naiveNeighbors, naiveDistances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+  BOOST_REQUIRE_EQUAL(parallel.BaseCases(), serial.BaseCases());
+  BOOST_REQUIRE_EQUAL(parallel.Scores(), serial.Scores());
+
+  // With a work budget, the query points are traversed one after another, so
+  // the truncation flags are kept.
+  serial.MaxBaseCases() = 20;
+  parallel.MaxBaseCases() = 20;
+  serial.Search(queryData, 5, serialNeighbors, serialDistances);
+  parallel.Search(queryData, 5, neighbors, distances);
+
+  CheckMatrices(neighbors, serialNeighbors);
+  CheckMatrices(distances, serialDistances);
+  BOOST_REQUIRE(parallel.Truncated() == serial.Truncated());
+}
+
+/**
+ * Make sure that defeatist single-tree search with the multithreaded spill tree
+ * traverser (as SpillKNN does) gives the same results with the same amount of
+ * work as with the regular defeatist traverser.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSpillSingleTreeTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(10, 3000);
+  arma::mat queryData = arma::randu<arma::mat>(10, 700);
+
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      SPTree, SPTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat>::DefeatistDualTreeTraverser, SPTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat>::DefeatistSingleTreeTraverser> SerialSpillKNN;
+
+  SerialSpillKNN::Tree serialTree(referenceData, 0.05);
+  SerialSpillKNN serial(std::move(serialTree), SINGLE_TREE_MODE);
+  SpillKNN::Tree parallelTree(referenceData, 0.05);
+  SpillKNN parallel(std::move(parallelTree), SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors, serialNeighbors;
+  arma::mat distances, serialDistances;
+
+  serial.Search(queryData, 8, serialNeighbors, serialDistances);
+  parallel.Search(queryData, 8, neighbors, distances);
+
+  CheckMatrices(neighbors, serialNeighbors);
+  CheckMatrices(distances, serialDistances);
+  BOOST_REQUIRE_EQUAL(parallel.BaseCases(), serial.BaseCases());
+  BOOST_REQUIRE_EQUAL(parallel.Scores(), serial.Scores());
+
+  serial.Search(8, serialNeighbors, serialDistances);
+  parallel.Search(8, neighbors, distances);
+
+  CheckMatrices(neighbors, serialNeighbors);
+  CheckMatrices(distances, serialDistances);
+  BOOST_REQUIRE_EQUAL(parallel.BaseCases(), serial.BaseCases());
+  BOOST_REQUIRE_EQUAL(parallel.Scores(), serial.Scores());
+}
+
+/**
+ * Make sure that NN-Descent finds the exact neighbors when k is the number of
+ * other points, in the same format as monochromatic search.
+ */
+BOOST_AUTO_TEST_CASE(NNDescentAllNeighborsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 40);
+
+  KNN knn(dataset);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(39, trueNeighbors, trueDistances);
+
+  NNDescent<> nnDescent;
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  nnDescent.Compute(dataset, 39, neighbors, distances);
+
+  CheckMatrices(distances, trueDistances);
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 39);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 40);
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      BOOST_REQUIRE_NE(neighbors(j, i), i);
+      BOOST_REQUIRE_CLOSE(distances(j, i), EuclideanDistance::Evaluate(
+          dataset.col(i), dataset.col(neighbors(j, i))), 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that NN-Descent finds most of the nearest neighbors of
+ * high-dimensional data, with another metric too.
+ */
+BOOST_AUTO_TEST_CASE(NNDescentRecallTest)
+{
+  // The points lie close to a five-dimensional subspace.
+  arma::mat dataset = arma::randn<arma::mat>(60, 5) *
+      arma::randu<arma::mat>(5, 2000) + 0.01 * arma::randu<arma::mat>(60, 2000);
+
+  KNN knn(dataset);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(10, trueNeighbors, trueDistances);
+
+  NNDescent<> nnDescent;
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  nnDescent.Compute(dataset, 10, neighbors, distances);
+
+  BOOST_REQUIRE_GT(KNN::Recall(neighbors, trueNeighbors), 0.9);
+  BOOST_REQUIRE_LE(nnDescent.Iterations(), nnDescent.MaxIterations());
+  for (size_t i = 0; i < distances.n_cols; ++i)
+    for (size_t j = 1; j < distances.n_rows; ++j)
+      BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+
+  NeighborSearch<NearestNeighborSort, ManhattanDistance> manhattanKNN(dataset);
+  manhattanKNN.Search(10, trueNeighbors, trueDistances);
+
+  NNDescent<ManhattanDistance> manhattanNNDescent;
+  manhattanNNDescent.Compute(dataset, 10, neighbors, distances);
+
+  BOOST_REQUIRE_GT(KNN::Recall(neighbors, trueNeighbors), 0.9);
+}
+
+/**
+ * Make sure that NN-Descent rejects invalid parameters.
+ */
+BOOST_AUTO_TEST_CASE(NNDescentInvalidParametersTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 20);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  NNDescent<> nnDescent;
+  BOOST_REQUIRE_THROW(nnDescent.Compute(dataset, 0, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(nnDescent.Compute(dataset, 20, neighbors, distances),
+      std::invalid_argument);
+
+  nnDescent.SampleRate() = 0.0;
+  BOOST_REQUIRE_THROW(nnDescent.Compute(dataset, 5, neighbors, distances),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the breadth-first dual-tree traverser gives exact results when
+ * its frame budget is small enough that most frames are expanded depth-first,
+ * and that the queues never hold more frames than the budget.
+ */
+BOOST_AUTO_TEST_CASE(BreadthFirstTraverserBudgetTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(4, 500);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(queryData, 5, trueNeighbors, trueDistances);
+
+  typedef KNN::Tree TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+
+  // Budgets of no limit, 16 frames, and the smallest possible budget.
+  const size_t frameSize =
+      sizeof(TreeType::BreadthFirstDualTreeTraverser<RuleType>::QueueFrameType);
+  const size_t budgets[] = { 0, 16 * frameSize, 1 };
+  for (size_t b = 0; b < 3; ++b)
+  {
+    std::vector<size_t> oldFromNewReferences, oldFromNewQueries;
+    TreeType referenceTree(referenceData, oldFromNewReferences);
+    TreeType queryTree(queryData, oldFromNewQueries);
+
+    EuclideanDistance metric;
+    RuleType rules(referenceTree.Dataset(), queryTree.Dataset(), 5, metric);
+    TreeType::BreadthFirstDualTreeTraverser<RuleType> traverser(rules,
+        budgets[b]);
+    traverser.Traverse(queryTree, referenceTree);
+
+    arma::Mat<size_t> treeNeighbors, neighbors;
+    arma::mat treeDistances, distances;
+    rules.GetResults(treeNeighbors, treeDistances);
+    Unmap(treeNeighbors, treeDistances, oldFromNewReferences,
+        oldFromNewQueries, neighbors, distances);
+
+    CheckMatrices(neighbors, trueNeighbors);
+    CheckMatrices(distances, trueDistances);
+
+    if (budgets[b] == 0)
+    {
+      BOOST_REQUIRE_EQUAL(traverser.NumDepthFirstFrames(), 0);
+    }
+    else
+    {
+      BOOST_REQUIRE_LE(traverser.PeakQueueFrames(),
+          std::max((size_t) 2, budgets[b] / frameSize));
+      BOOST_REQUIRE_GT(traverser.NumDepthFirstFrames(), 0);
+    }
+  }
+}
+
+/**
+ * Run greedy search with GreedySingleTreeTraverser and with
+ * GreedyBatchSingleTreeTraverser on the same tree, and make sure that the
+ * results and the number of prunes are the same.
+ */
+template<typename TreeType>
+void CheckGreedyBatchResults(TreeType& referenceTree,
+                             const arma::mat& queryData)
+{
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+
+  EuclideanDistance metric;
+  RuleType rules(referenceTree.Dataset(), queryData, 5, metric);
+  GreedySingleTreeTraverser<TreeType, RuleType> traverser(rules);
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+    traverser.Traverse(i, referenceTree);
+
+  // Use a batch size that does not divide the number of query points.
+  RuleType batchRules(referenceTree.Dataset(), queryData, 5, metric);
+  GreedyBatchSingleTreeTraverser<TreeType, RuleType> batchTraverser(
+      batchRules, 64);
+  batchTraverser.Traverse(0, queryData.n_cols, referenceTree);
+
+  arma::Mat<size_t> neighbors, batchNeighbors;
+  arma::mat distances, batchDistances;
+  rules.GetResults(neighbors, distances);
+  batchRules.GetResults(batchNeighbors, batchDistances);
+
+  CheckMatrices(batchNeighbors, neighbors);
+  CheckMatrices(batchDistances, distances);
+  BOOST_REQUIRE_EQUAL(batchTraverser.NumPrunes(), traverser.NumPrunes());
+}
+
+/**
+ * Make sure that the batched greedy traverser gives the same results as the
+ * greedy traverser on spill trees (with and without overlapping nodes) and
+ * kd-trees, in low dimensions and in enough dimensions that the base cases are
+ * computed with a matrix product.
+ */
+BOOST_AUTO_TEST_CASE(GreedyBatchTraverserTest)
+{
+  const size_t dimensions[] = { 3, 20 };
+  for (size_t d = 0; d < 2; ++d)
+  {
+    arma::mat referenceData = arma::randu<arma::mat>(dimensions[d], 3000);
+    arma::mat queryData = arma::randu<arma::mat>(dimensions[d], 500);
+
+    SpillKNN::Tree spillTree(referenceData, 0.1 /* tau */);
+    CheckGreedyBatchResults(spillTree, queryData);
+
+    SpillKNN::Tree nonOverlappingTree(referenceData);
+    CheckGreedyBatchResults(nonOverlappingTree, queryData);
+
+    KNN::Tree kdTree(referenceData);
+    CheckGreedyBatchResults(kdTree, queryData);
+  }
+}
+
+/**
+ * Make sure that the fixed-dimension kd-tree and metric find the same
+ * neighbors as the default kd-tree on three-dimensional data, with dual-tree
+ * and single-tree search.
+ */
+BOOST_AUTO_TEST_CASE(KDTree3DTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(queryData, 5, trueNeighbors, trueDistances);
+
+  NeighborSearch<NearestNeighborSort, FixedEuclideanDistance<3>, arma::mat,
+      KDTree3D> fixedKnn(referenceData);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  fixedKnn.Search(queryData, 5, neighbors, distances);
+
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+
+  fixedKnn.SearchMode() = SINGLE_TREE_MODE;
+  fixedKnn.Search(queryData, 5, neighbors, distances);
+
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+}
+
+/**
+ * With more neighbors than NeighborSearchRules keeps sorted, the candidates are
+ * kept in heaps; make sure the results are still the k nearest neighbors, in
+ * order, for both the nearest and the furthest neighbor search.
+ */
+BOOST_AUTO_TEST_CASE(LargeKCandidateHeapTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 50);
+  const size_t k = 40;
+
+  KNN knn(referenceData);
+  KFN kfn(referenceData);
+  for (size_t furthest = 0; furthest < 2; ++furthest)
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    if (furthest == 1)
+      kfn.Search(queryData, k, neighbors, distances);
+    else
+      knn.Search(queryData, k, neighbors, distances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, queryData.n_cols);
+    for (size_t i = 0; i < queryData.n_cols; ++i)
+    {
+      arma::vec allDistances(referenceData.n_cols);
+      for (size_t j = 0; j < referenceData.n_cols; ++j)
+      {
+        allDistances[j] = EuclideanDistance::Evaluate(queryData.col(i),
+            referenceData.col(j));
+      }
+      const arma::vec sortedDistances = arma::sort(allDistances,
+          (furthest == 1) ? "descend" : "ascend");
+
+      for (size_t j = 0; j < k; ++j)
+      {
+        BOOST_REQUIRE_CLOSE(distances(j, i), sortedDistances[j], 1e-5);
+        BOOST_REQUIRE_CLOSE(allDistances[neighbors(j, i)], distances(j, i),
+            1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that ShardedNeighborSearch returns the same neighbors as a search
+ * of the whole reference set, for nearest and furthest neighbors, with every
+ * search mode, and with shards that are smaller than k.
+ */
+BOOST_AUTO_TEST_CASE(ShardedNeighborSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+  const size_t k = 10;
+
+  KNN knn(referenceData);
+  KFN kfn(referenceData);
+  arma::Mat<size_t> trueNeighbors, trueFurthestNeighbors;
+  arma::mat trueDistances, trueFurthestDistances;
+  knn.Search(queryData, k, trueNeighbors, trueDistances);
+  kfn.Search(queryData, k, trueFurthestNeighbors, trueFurthestDistances);
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE };
+  for (size_t m = 0; m < 3; ++m)
+  {
+    ShardedNeighborSearch<> shardedKnn(referenceData, 7, modes[m]);
+    ShardedNeighborSearch<FurthestNeighborSort> shardedKfn(referenceData, 4,
+        modes[m]);
+    BOOST_REQUIRE_EQUAL(shardedKnn.NumShards(), 7);
+    BOOST_REQUIRE_EQUAL(shardedKnn.NumReferencePoints(), 1000);
+
+    arma::Mat<size_t> neighbors, furthestNeighbors;
+    arma::mat distances, furthestDistances;
+    shardedKnn.Search(queryData, k, neighbors, distances);
+    shardedKfn.Search(queryData, k, furthestNeighbors, furthestDistances);
+
+    CheckMatrices(neighbors, trueNeighbors);
+    CheckMatrices(distances, trueDistances);
+    CheckMatrices(furthestNeighbors, trueFurthestNeighbors);
+    CheckMatrices(furthestDistances, trueFurthestDistances);
+  }
+
+  // Add shards of 3, 500 and 497 points by hand.
+  ShardedNeighborSearch<> sharded;
+  sharded.AddShard(KNN(arma::mat(referenceData.cols(0, 2))));
+  sharded.AddShard(KNN(arma::mat(referenceData.cols(3, 502))));
+  sharded.AddShard(KNN(arma::mat(referenceData.cols(503, 999))));
+  BOOST_REQUIRE_EQUAL(sharded.ShardOffset(2), 503);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  sharded.Search(queryData, k, neighbors, distances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+
+  BOOST_REQUIRE_THROW(sharded.Search(queryData, 1001, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(ShardedNeighborSearch<>(referenceData, 0),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the bounds given to NeighborSearch::Search() only keep the
+ * neighbors that are better than them.
+ */
+BOOST_AUTO_TEST_CASE(NeighborSearchBoundsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 50);
+  const size_t k = 5;
+
+  KNN naive(referenceData, NAIVE_MODE);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(queryData, k, trueNeighbors, trueDistances);
+
+  // Only the two nearest neighbors are better than the bounds.
+  arma::vec bounds = 0.5 * (trueDistances.row(1) + trueDistances.row(2)).t();
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE, GREEDY_SINGLE_TREE_MODE };
+  for (size_t m = 0; m < 4; ++m)
+  {
+    KNN knn(referenceData, modes[m]);
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    knn.Search(queryData, k, neighbors, distances, bounds);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, queryData.n_cols);
+    for (size_t q = 0; q < queryData.n_cols; ++q)
+    {
+      for (size_t i = 0; i < k; ++i)
+      {
+        // The greedy search is approximate, so it may miss neighbors.
+        if (i < 2 && modes[m] != GREEDY_SINGLE_TREE_MODE)
+        {
+          BOOST_REQUIRE_EQUAL(neighbors(i, q), trueNeighbors(i, q));
+          BOOST_REQUIRE_CLOSE(distances(i, q), trueDistances(i, q), 1e-5);
+        }
+        else if (i >= 2)
+        {
+          BOOST_REQUIRE_EQUAL(neighbors(i, q), size_t() - 1);
+          BOOST_REQUIRE_EQUAL(distances(i, q), DBL_MAX);
+        }
+      }
+    }
+  }
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  BOOST_REQUIRE_THROW(naive.Search(queryData, k, neighbors, distances,
+      arma::vec(3)), std::invalid_argument);
+}
+
+/**
+ * Make sure that WhitenedNeighborSearch finds the same neighbors and distances
+ * as a brute-force search with the Mahalanobis distance, for positive definite
+ * and singular covariance matrices.
+ */
+BOOST_AUTO_TEST_CASE(WhitenedMahalanobisSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 200);
+  arma::mat queryData = arma::randu<arma::mat>(4, 50);
+  const size_t k = 5;
+
+  arma::mat a = arma::randu<arma::mat>(4, 4);
+  arma::mat b = arma::randu<arma::mat>(4, 2);
+  std::vector<arma::mat> covariances;
+  covariances.push_back(a * a.t() + 0.1 * arma::eye<arma::mat>(4, 4));
+  covariances.push_back(b * b.t());
+
+  for (size_t c = 0; c < covariances.size(); ++c)
+  {
+    MahalanobisDistance<true> mahalanobis(covariances[c]);
+    MahalanobisDistance<false> squared(covariances[c]);
+
+    // Compute the true neighbors and distances.
+    arma::mat trueDistances(k, queryData.n_cols);
+    for (size_t q = 0; q < queryData.n_cols; ++q)
+    {
+      arma::vec d(referenceData.n_cols);
+      for (size_t r = 0; r < referenceData.n_cols; ++r)
+        d[r] = mahalanobis.Evaluate(queryData.col(q), referenceData.col(r));
+      arma::vec sorted = arma::sort(d);
+      trueDistances.col(q) = sorted.subvec(0, k - 1);
+    }
+
+    WhitenedNeighborSearch<> knn(referenceData, DUAL_TREE_MODE, 0,
+        mahalanobis);
+    WhitenedNeighborSearch<NearestNeighborSort, false> squaredKnn(
+        referenceData, SINGLE_TREE_MODE, 0, squared);
+
+    arma::Mat<size_t> neighbors, squaredNeighbors;
+    arma::mat distances, squaredDistances;
+    knn.Search(queryData, k, neighbors, distances);
+    squaredKnn.Search(queryData, k, squaredNeighbors, squaredDistances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, queryData.n_cols);
+    for (size_t q = 0; q < queryData.n_cols; ++q)
+    {
+      for (size_t i = 0; i < k; ++i)
+      {
+        BOOST_REQUIRE_CLOSE(distances(i, q) + 1.0, trueDistances(i, q) + 1.0,
+            1e-5);
+        BOOST_REQUIRE_CLOSE(squaredDistances(i, q) + 1.0,
+            std::pow(trueDistances(i, q), 2.0) + 1.0, 1e-5);
+
+        // The distances must be those of the returned neighbors.
+        BOOST_REQUIRE_CLOSE(mahalanobis.Evaluate(queryData.col(q),
+            referenceData.col(neighbors(i, q))) + 1.0, distances(i, q) + 1.0,
+            1e-5);
+      }
+    }
+  }
+
+  // The dimensionality of the covariance must match the data.
+  MahalanobisDistance<true> wrong(arma::eye<arma::mat>(3, 3));
+  BOOST_REQUIRE_THROW(WhitenedNeighborSearch<>(referenceData, DUAL_TREE_MODE,
+      0, wrong), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
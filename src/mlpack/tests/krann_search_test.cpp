@@ -20,6 +20,10 @@
 #include <mlpack/methods/rann/ra_search.hpp>
 #include <mlpack/methods/rann/ra_model.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::neighbor;
@@ -715,4 +719,83 @@ BOOST_AUTO_TEST_CASE(RAModelTest)
   }
 }
 
+/**
+ * Run the given search twice with the same seed, and (if OpenMP is available)
+ * once more with a single thread, and make sure the results are the same each
+ * time.
+ */
+template<typename SearchType>
+void CheckReproducibleSearch(SearchType& search,
+                             const arma::mat& querySet,
+                             const bool monochromatic)
+{
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+
+  math::RandomSeed(42);
+  if (monochromatic)
+    search.Search(3, neighbors1, distances1);
+  else
+    search.Search(querySet, 3, neighbors1, distances1);
+
+  math::RandomSeed(42);
+  if (monochromatic)
+    search.Search(3, neighbors2, distances2);
+  else
+    search.Search(querySet, 3, neighbors2, distances2);
+
+  BOOST_REQUIRE(arma::all(arma::vectorise(neighbors1 == neighbors2)));
+  BOOST_REQUIRE(arma::approx_equal(distances1, distances2, "absdiff", 0.0));
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+
+    math::RandomSeed(42);
+    if (monochromatic)
+      search.Search(3, neighbors2, distances2);
+    else
+      search.Search(querySet, 3, neighbors2, distances2);
+
+    omp_set_num_threads(oldThreads);
+
+    BOOST_REQUIRE(arma::all(arma::vectorise(neighbors1 == neighbors2)));
+    BOOST_REQUIRE(arma::approx_equal(distances1, distances2, "absdiff", 0.0));
+  #endif
+}
+
+/**
+ * Make sure that naive and single-tree search give the same results for the
+ * same seed, no matter how many threads are used.
+ */
+BOOST_AUTO_TEST_CASE(ReproducibleParallelSearchTest)
+{
+  arma::mat referenceSet(5, 2000);
+  referenceSet.randu();
+  arma::mat querySet(5, 500);
+  querySet.randu();
+
+  RASearch<> naive(referenceSet, true);
+  naive.Tau() = 2.0;
+  CheckReproducibleSearch(naive, querySet, false);
+  CheckReproducibleSearch(naive, querySet, true);
+
+  RASearch<> single(referenceSet, false, true);
+  single.Tau() = 2.0;
+  single.SingleSampleLimit() = 5;
+  CheckReproducibleSearch(single, querySet, false);
+  CheckReproducibleSearch(single, querySet, true);
+
+  RASearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> cover(referenceSet, false, true);
+  cover.Tau() = 2.0;
+  CheckReproducibleSearch(cover, querySet, false);
+  CheckReproducibleSearch(cover, querySet, true);
+
+  // Dual-tree search is not parallel, but is seeded in the same way.
+  RASearch<> dual(referenceSet);
+  dual.Tau() = 2.0;
+  CheckReproducibleSearch(dual, querySet, false);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -18,6 +18,10 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::regression;
 
@@ -352,4 +356,126 @@ BOOST_AUTO_TEST_CASE(TrainingConstructorWithNonDefaultsTest)
     BOOST_REQUIRE_CLOSE(beta[i], lars2.Beta()[i], 1e-5);
 }
 
+/**
+ * Make sure that training on several sets of responses at once, with a cached
+ * Gram matrix, gives the same solutions as training on each of them.
+ */
+BOOST_AUTO_TEST_CASE(MultipleResponsesTest)
+{
+  // The dictionary is row-major: each of its 20 rows is a point.
+  const arma::mat dictionary = arma::randn<arma::mat>(20, 8);
+  const arma::mat responses = arma::randn<arma::mat>(20, 30);
+  const arma::mat gram = trans(dictionary) * dictionary;
+
+  for (size_t useCholesky = 0; useCholesky < 2; ++useCholesky)
+  {
+    LARS lars(useCholesky == 1, gram, 0.5, 0.1);
+    arma::mat betas;
+    lars.Train(dictionary, responses, betas, false);
+
+    BOOST_REQUIRE_EQUAL(betas.n_rows, 8);
+    BOOST_REQUIRE_EQUAL(betas.n_cols, 30);
+    for (size_t i = 0; i < responses.n_cols; ++i)
+    {
+      LARS singleLars(useCholesky == 1, gram, 0.5, 0.1);
+      arma::vec beta;
+      const arma::rowvec y = trans(responses.col(i));
+      singleLars.Train(dictionary, y, beta, false);
+
+      // The solution from X^T y alone is the same.
+      LARS solveLars(useCholesky == 1, gram, 0.5, 0.1);
+      arma::vec solveBeta;
+      solveLars.Solve(trans(dictionary) * responses.col(i), solveBeta);
+
+      for (size_t j = 0; j < beta.n_elem; ++j)
+      {
+        if (std::abs(beta[j]) < 1e-10)
+        {
+          BOOST_REQUIRE_SMALL(betas(j, i), 1e-10);
+          BOOST_REQUIRE_SMALL(solveBeta[j], 1e-10);
+        }
+        else
+        {
+          BOOST_REQUIRE_CLOSE(beta[j], betas(j, i), 1e-5);
+          BOOST_REQUIRE_CLOSE(beta[j], solveBeta[j], 1e-5);
+        }
+      }
+    }
+
+    // The solution of the last problem is the one held by the model.
+    BOOST_REQUIRE_EQUAL(lars.Beta().n_elem, 8);
+    for (size_t j = 0; j < 8; ++j)
+      BOOST_REQUIRE_CLOSE(lars.Beta()[j] + 1.0, betas(j, 29) + 1.0, 1e-5);
+  }
+}
+
+/**
+ * Make sure that the problems of a batched Train() that are solved by several
+ * threads have the same solutions as solving each column of the responses on
+ * its own.
+ */
+BOOST_AUTO_TEST_CASE(MultipleResponsesParallelTest)
+{
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    BOOST_REQUIRE_GE(ParallelThreads(), 2);
+  #endif
+
+  // There are enough problems that each thread gets some of them.
+  const arma::mat dictionary = arma::randn<arma::mat>(30, 10);
+  const arma::mat responses = arma::randn<arma::mat>(30, 200);
+
+  for (size_t useCholesky = 0; useCholesky < 2; ++useCholesky)
+  {
+    LARS lars(useCholesky == 1, 0.3, 0.05);
+    arma::mat betas;
+    lars.Train(dictionary, responses, betas, false);
+
+    BOOST_REQUIRE_EQUAL(betas.n_rows, 10);
+    BOOST_REQUIRE_EQUAL(betas.n_cols, 200);
+    for (size_t i = 0; i < responses.n_cols; ++i)
+    {
+      LARS singleLars(useCholesky == 1, 0.3, 0.05);
+      arma::vec beta;
+      const arma::rowvec y = trans(responses.col(i));
+      singleLars.Train(dictionary, y, beta, false);
+
+      BOOST_REQUIRE_EQUAL(beta.n_elem, 10);
+      for (size_t j = 0; j < beta.n_elem; ++j)
+      {
+        if (std::abs(beta[j]) < 1e-10)
+          BOOST_REQUIRE_SMALL(betas(j, i), 1e-10);
+        else
+          BOOST_REQUIRE_CLOSE(beta[j], betas(j, i), 1e-5);
+      }
+    }
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+}
+
+/**
+ * A Gram matrix of the wrong size should be rejected.
+ */
+BOOST_AUTO_TEST_CASE(WrongGramSizeTest)
+{
+  arma::mat X;
+  arma::rowvec y;
+  GenerateProblem(X, y, 100, 10);
+
+  const arma::mat gram = arma::eye<arma::mat>(5, 5);
+  LARS lars(true, gram, 0.1);
+  arma::vec beta;
+  BOOST_REQUIRE_THROW(lars.Train(X, y, beta), std::invalid_argument);
+  BOOST_REQUIRE_THROW(lars.Solve(arma::vec(10, arma::fill::ones), beta),
+      std::invalid_argument);
+
+  arma::mat betas;
+  BOOST_REQUIRE_THROW(lars.Train(X, arma::mat(50, 3, arma::fill::ones), betas,
+      true), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -42,6 +42,64 @@ BOOST_AUTO_TEST_CASE(RosenbrockFunctionTest)
   BOOST_REQUIRE_CLOSE(coords[1], 1.0, 1e-5);
 }
 
+/**
+ * The Rosenbrock function with an EvaluateWithGradient() method, which counts
+ * how often each of the methods is called.
+ */
+class FusedRosenbrockFunction : public RosenbrockFunction
+{
+ public:
+  FusedRosenbrockFunction() : evaluations(0), gradients(0), fused(0) { }
+
+  double Evaluate(const arma::mat& coordinates)
+  {
+    ++evaluations;
+    return RosenbrockFunction::Evaluate(coordinates);
+  }
+
+  void Gradient(const arma::mat& coordinates, arma::mat& gradient)
+  {
+    ++gradients;
+    RosenbrockFunction::Gradient(coordinates, gradient);
+  }
+
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              arma::mat& gradient)
+  {
+    ++fused;
+    RosenbrockFunction::Gradient(coordinates, gradient);
+    return RosenbrockFunction::Evaluate(coordinates);
+  }
+
+  size_t evaluations;
+  size_t gradients;
+  size_t fused;
+};
+
+/**
+ * Make sure L-BFGS uses EvaluateWithGradient() instead of separate calls to
+ * Gradient() when the function provides it.
+ */
+BOOST_AUTO_TEST_CASE(FusedRosenbrockFunctionTest)
+{
+  FusedRosenbrockFunction f;
+  L_BFGS lbfgs;
+  lbfgs.MaxIterations() = 10000;
+
+  arma::mat coords = f.GetInitialPoint();
+  if (!lbfgs.Optimize(f, coords))
+    BOOST_FAIL("L-BFGS optimization reported failure.");
+
+  BOOST_REQUIRE_GT(f.fused, 0);
+  BOOST_REQUIRE_EQUAL(f.gradients, 0);
+
+  double finalValue = f.Evaluate(coords);
+
+  BOOST_REQUIRE_SMALL(finalValue, 1e-5);
+  BOOST_REQUIRE_CLOSE(coords[0], 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(coords[1], 1.0, 1e-5);
+}
+
 /**
  * Tests the L-BFGS optimizer using the Wood Function.
  */
@@ -93,6 +151,53 @@ BOOST_AUTO_TEST_CASE(GeneralizedRosenbrockFunctionTest)
   }
 }
 
+/**
+ * Tests that ParallelSeparableFunction evaluates the generalized Rosenbrock
+ * function correctly and independently of the number of threads, and that
+ * L-BFGS can optimize it.
+ */
+BOOST_AUTO_TEST_CASE(ParallelGeneralizedRosenbrockFunctionTest)
+{
+  const size_t dim = 64;
+  GeneralizedRosenbrockFunction f(dim);
+
+  // The 63 separable functions are split into 16 blocks.
+  ParallelSeparableFunction<GeneralizedRosenbrockFunction> serial(f, 4, 1);
+  ParallelSeparableFunction<GeneralizedRosenbrockFunction> parallel(f, 4, 4);
+
+  arma::mat coords = f.GetInitialPoint();
+  coords += 0.1 * arma::randu<arma::mat>(arma::size(coords));
+
+  arma::mat gradient, serialGradient, parallelGradient;
+  f.Gradient(coords, gradient);
+  const double serialObjective = serial.EvaluateWithGradient(coords,
+      serialGradient);
+  const double parallelObjective = parallel.EvaluateWithGradient(coords,
+      parallelGradient);
+
+  BOOST_REQUIRE_CLOSE(serialObjective, f.Evaluate(coords), 1e-8);
+  BOOST_REQUIRE_EQUAL(serialObjective, parallelObjective);
+  BOOST_REQUIRE_EQUAL(serialObjective, parallel.Evaluate(coords));
+
+  parallel.Gradient(coords, parallelGradient);
+  for (size_t j = 0; j < dim; ++j)
+  {
+    BOOST_REQUIRE_CLOSE(serialGradient[j], gradient[j], 1e-8);
+    BOOST_REQUIRE_EQUAL(serialGradient[j], parallelGradient[j]);
+  }
+
+  L_BFGS lbfgs(20);
+  lbfgs.MaxIterations() = 10000;
+
+  coords = f.GetInitialPoint();
+  if (!lbfgs.Optimize(parallel, coords))
+    BOOST_FAIL("L-BFGS optimization reported failure.");
+
+  BOOST_REQUIRE_SMALL(f.Evaluate(coords), 1e-5);
+  for (size_t j = 0; j < dim; ++j)
+    BOOST_REQUIRE_CLOSE(coords[j], 1.0, 1e-5);
+}
+
 /**
  * Tests the L-BFGS optimizer using the Rosenbrock-Wood combined function.  This
  * is a test on optimizing a matrix of coordinates.
@@ -199,4 +199,90 @@ BOOST_AUTO_TEST_CASE(LinearRegressionTrainTest)
     BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrTrain.Parameters()[i], 1e-5);
 }
 
+/**
+ * Training from normal equations accumulated in batches should give the same
+ * model as training on the whole dataset, with or without intercept, weights
+ * and regularization.
+ */
+BOOST_AUTO_TEST_CASE(LinearRegressionNormalEquationsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 10000);
+  arma::rowvec responses = arma::randu<arma::rowvec>(10000);
+  arma::rowvec weights = arma::randu<arma::rowvec>(10000) + 0.5;
+
+  for (size_t intercept = 0; intercept < 2; ++intercept)
+  {
+    for (size_t weighted = 0; weighted < 2; ++weighted)
+    {
+      const double lambda = (weighted == 0) ? 0.0 : 0.3;
+      LinearRegression lr = (weighted == 0) ?
+          LinearRegression(dataset, responses, lambda, intercept == 1) :
+          LinearRegression(dataset, responses, weights, lambda,
+              intercept == 1);
+
+      // Add the points in batches of different sizes.
+      NormalEquations equations(dataset.n_rows, intercept == 1);
+      size_t begin = 0;
+      for (size_t batchSize = 1; begin < dataset.n_cols; batchSize *= 3)
+      {
+        const size_t end = std::min((size_t) dataset.n_cols,
+            begin + batchSize) - 1;
+        if (weighted == 0)
+        {
+          equations.Add(dataset.cols(begin, end),
+              responses.subvec(begin, end));
+        }
+        else
+        {
+          equations.Add(dataset.cols(begin, end),
+              responses.subvec(begin, end), weights.subvec(begin, end));
+        }
+        begin = end + 1;
+      }
+      BOOST_REQUIRE_EQUAL(equations.NumPoints(), dataset.n_cols);
+
+      LinearRegression lrEquations(equations, lambda);
+      BOOST_REQUIRE_EQUAL(lrEquations.Intercept(), intercept == 1);
+      BOOST_REQUIRE_EQUAL(lr.Parameters().n_elem,
+          lrEquations.Parameters().n_elem);
+      for (size_t i = 0; i < lr.Parameters().n_elem; ++i)
+      {
+        BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrEquations.Parameters()[i],
+            1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Merged normal equations should be the same as the normal equations of all
+ * the points, and equations of different sizes should not be merged.
+ */
+BOOST_AUTO_TEST_CASE(NormalEquationsMergeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 3000);
+  arma::rowvec responses = arma::randu<arma::rowvec>(3000);
+
+  NormalEquations all(4), first(4), second(4);
+  all.Add(dataset, responses);
+  first.Add(dataset.cols(0, 999), responses.subvec(0, 999));
+  second.Add(dataset.cols(1000, 2999), responses.subvec(1000, 2999));
+  first.Merge(second);
+
+  BOOST_REQUIRE_EQUAL(first.NumPoints(), all.NumPoints());
+  CheckMatrices(first.Gram(), all.Gram());
+  CheckMatrices(first.Moment(), all.Moment());
+
+  NormalEquations other(3), noIntercept(4, false);
+  BOOST_REQUIRE_THROW(all.Merge(other), std::invalid_argument);
+  BOOST_REQUIRE_THROW(all.Merge(noIntercept), std::invalid_argument);
+  BOOST_REQUIRE_THROW(other.Add(dataset, responses), std::invalid_argument);
+  BOOST_REQUIRE_THROW(all.Add(dataset, responses.subvec(0, 10)),
+      std::invalid_argument);
+
+  all.Reset();
+  BOOST_REQUIRE_EQUAL(all.NumPoints(), 0);
+  BOOST_REQUIRE_SMALL(arma::accu(arma::abs(all.Gram())), 1e-10);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -9,11 +9,32 @@
  * 3-clause BSD license along with mlpack.  If not, see
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
+#include <cstring>
 #include <sstream>
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/data/batch_reader.hpp>
+#include <mlpack/core/data/batch_writer.hpp>
+#include <mlpack/core/data/column_blocks.hpp>
+#include <mlpack/core/data/hdf5_dataset.hpp>
 #include <mlpack/core/data/load_arff.hpp>
+#include <mlpack/core/data/map_policies/intern_policy.hpp>
+#include <mlpack/core/data/mapped_matrix.hpp>
 #include <mlpack/core/data/map_policies/missing_policy.hpp>
+#include <mlpack/core/data/model_container.hpp>
+#include <mlpack/core/data/process_batches.hpp>
+#include <mlpack/core/data/query_server.hpp>
+
+#ifdef HAS_ARROW
+  #include <arrow/io/file.h>
+  #include <parquet/arrow/writer.h>
+#endif
+
+#ifndef _WIN32
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -766,6 +787,87 @@ BOOST_AUTO_TEST_CASE(SaveHDF5Test)
   remove("test_file.he5");
 }
 
+/**
+ * Make sure points written in chunks by HDF5Dataset from several threads are
+ * loaded by data::Load(), and that ranges of points of a file saved by
+ * data::Save() are read correctly.
+ */
+BOOST_AUTO_TEST_CASE(HDF5DatasetTest)
+{
+  arma::mat data(5, 103, arma::fill::randu);
+
+  {
+    HDF5Dataset<> output("test.h5", 5, 103, "dataset", true, 16);
+    BOOST_REQUIRE_EQUAL(output.Dimensionality(), 5);
+    BOOST_REQUIRE_EQUAL(output.NumPoints(), 103);
+
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < 11; ++i)
+    {
+      const size_t first = i * 10;
+      const size_t last = std::min(first + 10, (size_t) 103) - 1;
+      output.WritePoints(first, data.cols(first, last));
+    }
+
+    // Too many points do not fit.
+    BOOST_REQUIRE_THROW(output.WritePoints(100, data.cols(0, 3)),
+        std::invalid_argument);
+  }
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test.h5", loaded));
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 103);
+  for (size_t i = 0; i < data.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], data[i]);
+
+  // Now read ranges of points of the same matrix saved by data::Save(), with
+  // and without transposing.
+  arma::mat points;
+  for (size_t t = 0; t < 2; ++t)
+  {
+    const bool transpose = (t == 0);
+    BOOST_REQUIRE(data::Save("test.h5", data, true, transpose));
+
+    HDF5Dataset<> input("test.h5", "dataset", transpose);
+    BOOST_REQUIRE_EQUAL(input.Dimensionality(), 5);
+    BOOST_REQUIRE_EQUAL(input.NumPoints(), 103);
+
+    input.ReadPoints(37, 29, points);
+    BOOST_REQUIRE_EQUAL(points.n_rows, 5);
+    BOOST_REQUIRE_EQUAL(points.n_cols, 29);
+    for (size_t i = 0; i < 29; ++i)
+      for (size_t d = 0; d < 5; ++d)
+        BOOST_REQUIRE_EQUAL(points(d, i), data(d, 37 + i));
+
+    input.ReadPoints(103, 0, points);
+    BOOST_REQUIRE_EQUAL(points.n_cols, 0);
+
+    BOOST_REQUIRE_THROW(input.ReadPoints(100, 4, points),
+        std::invalid_argument);
+    // The file was not opened for writing.
+    BOOST_REQUIRE_THROW(input.WritePoints(0, data.cols(0, 1)),
+        std::invalid_argument);
+  }
+
+  // The batches of BatchReader are the same points too.
+  BOOST_REQUIRE(data::Save("test.h5", data));
+  BatchReader<> reader("test.h5", 40);
+  BOOST_REQUIRE_EQUAL(reader.Dimensionality(), 5);
+  arma::mat batch;
+  size_t count = 0;
+  while (reader.NextBatch(batch))
+  {
+    for (size_t i = 0; i < batch.n_cols; ++i)
+      for (size_t d = 0; d < 5; ++d)
+        BOOST_REQUIRE_EQUAL(batch(d, i), data(d, count + i));
+    count += batch.n_cols;
+  }
+  BOOST_REQUIRE_EQUAL(count, 103);
+
+  remove("test.h5");
+}
+
 #endif
 
 /**
@@ -1803,6 +1905,65 @@ BOOST_AUTO_TEST_CASE(BadDatasetInfoARFFTest)
   remove("test.arff");
 }
 
+/**
+ * Make sure sparse ARFF lines are loaded into dense and sparse matrices, also
+ * mixed with dense lines.
+ */
+BOOST_AUTO_TEST_CASE(SparseARFFTest)
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute one numeric" << endl;
+  f << "@attribute two string" << endl;
+  f << "@attribute three numeric" << endl;
+  f << "@attribute four numeric" << endl;
+  f << "@data" << endl;
+  f << "{0 1.5, 3 -2}" << endl;
+  f << "% comment" << endl;
+  f << "{1 'a b', 2 4}" << endl;
+  f << "{}" << endl;
+  f << endl;
+  f << "0, c, 0, 7" << endl;
+  f.close();
+
+  arma::mat dense;
+  DatasetInfo denseInfo;
+  data::LoadARFF("test.arff", dense, denseInfo);
+
+  BOOST_REQUIRE_EQUAL(dense.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(dense.n_cols, 4);
+  BOOST_REQUIRE(denseInfo.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(denseInfo.UnmapString(0, 1), "a b");
+  BOOST_REQUIRE_EQUAL(denseInfo.UnmapString(1, 1), "c");
+
+  arma::mat expected("1.5 0 0 -2; 0 0 4 0; 0 0 0 0; 0 1 0 7");
+  CheckMatrices(dense, expected.t());
+
+  arma::sp_mat sparse;
+  DatasetInfo sparseInfo;
+  data::LoadARFF("test.arff", sparse, sparseInfo);
+
+  BOOST_REQUIRE_EQUAL(sparse.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(sparse.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(sparse.n_nonzero, 5);
+  CheckMatrices(arma::mat(sparse), expected.t());
+
+  // Indices have to be within the dimensionality.
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute one numeric" << endl;
+  f << "@data" << endl;
+  f << "{1 2}" << endl;
+  f.close();
+
+  DatasetInfo badInfo;
+  BOOST_REQUIRE_THROW(data::LoadARFF("test.arff", sparse, badInfo),
+      std::runtime_error);
+
+  remove("test.arff");
+}
+
 /**
  * A test to check whether the arff loader is case insensitive to declarations:
  * @relation, @attribute, @data.
@@ -1971,6 +2132,631 @@ BOOST_AUTO_TEST_CASE(LoadCSVNoTransposeTXTTest)
   remove("test.txt");
 }
 
+/**
+ * Make sure the parallel CSV parser gives the same matrix and mappings as the
+ * serial one, for a file with categorical dimensions.
+ */
+BOOST_AUTO_TEST_CASE(ParallelCategoricalCSVLoadTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    f << i << ", " << char('a' + (7 * i) % 13) << ", " << (i % 17) * 0.5
+        << ", " << ((i > 600) ? "x" : "5") << ", c" << (i % 300) << endl;
+  }
+  f.close();
+
+  for (size_t transpose = 0; transpose < 2; ++transpose)
+  {
+    arma::mat serial, parallel;
+    DatasetInfo serialInfo, parallelInfo;
+
+    LoadCSV serialLoader("test.csv", 1);
+    serialLoader.Load(serial, serialInfo, transpose == 1);
+    LoadCSV parallelLoader("test.csv", 4);
+    parallelLoader.Load(parallel, parallelInfo, transpose == 1);
+
+    BOOST_REQUIRE_EQUAL(serial.n_rows, parallel.n_rows);
+    BOOST_REQUIRE_EQUAL(serial.n_cols, parallel.n_cols);
+    for (size_t i = 0; i < serial.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(serial[i], parallel[i]);
+
+    BOOST_REQUIRE_EQUAL(serialInfo.Dimensionality(),
+        parallelInfo.Dimensionality());
+    for (size_t d = 0; d < serialInfo.Dimensionality(); ++d)
+    {
+      BOOST_REQUIRE(serialInfo.Type(d) == parallelInfo.Type(d));
+      BOOST_REQUIRE_EQUAL(serialInfo.NumMappings(d),
+          parallelInfo.NumMappings(d));
+      for (size_t i = 0; i < serialInfo.NumMappings(d); ++i)
+      {
+        BOOST_REQUIRE_EQUAL(serialInfo.UnmapString(i, d),
+            parallelInfo.UnmapString(i, d));
+      }
+    }
+  }
+
+  // The transposed matrix has a categorical dimension only where a string is.
+  arma::mat dataset;
+  DatasetInfo info;
+  LoadCSV loader("test.csv", 4);
+  loader.Load(dataset, info);
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE(info.Type(2) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(3) == Datatype::categorical);
+  BOOST_REQUIRE(info.Type(4) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(3), 2);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(4), 300);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure the parallel CSV parser finds a malformed line near the end of the
+ * file.
+ */
+BOOST_AUTO_TEST_CASE(ParallelMalformedCSVTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 1000; ++i)
+    f << i << ", " << 2 * i << ", " << 3 * i << endl;
+  f << "1, 2" << endl;
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  LoadCSV loader("test.csv", 4);
+  BOOST_REQUIRE_THROW(loader.Load(dataset, info), std::runtime_error);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure the batches of a CSV file with categorical dimensions are the
+ * columns data::Load() gives, with the same mappings.
+ */
+BOOST_AUTO_TEST_CASE(BatchReaderCSVTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 105; ++i)
+  {
+    f << i << ", " << char('a' + (3 * i) % 7) << ", " << ((i > 50) ? "x" : "5")
+        << endl;
+  }
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.csv", dataset, info));
+
+  BatchReader<> reader("test.csv", 10);
+  BOOST_REQUIRE_EQUAL(reader.Dimensionality(), 3);
+  for (size_t d = 0; d < 3; ++d)
+    BOOST_REQUIRE(reader.Info().Type(d) == info.Type(d));
+
+  // Read the file twice, to make sure Reset() works.
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    arma::mat batch;
+    size_t batches = 0;
+    while (reader.NextBatch(batch))
+    {
+      BOOST_REQUIRE_EQUAL(batch.n_rows, 3);
+      BOOST_REQUIRE_EQUAL(batch.n_cols, (batches < 10) ? 10 : 5);
+      for (size_t i = 0; i < batch.n_cols; ++i)
+        for (size_t d = 0; d < 3; ++d)
+          BOOST_REQUIRE_EQUAL(batch(d, i), dataset(d, 10 * batches + i));
+      ++batches;
+    }
+
+    BOOST_REQUIRE_EQUAL(batch.n_cols, 0);
+    BOOST_REQUIRE_EQUAL(batches, 11);
+    BOOST_REQUIRE_EQUAL(reader.PointsRead(), 105);
+    reader.Reset();
+  }
+
+  for (size_t d = 0; d < 3; ++d)
+    BOOST_REQUIRE_EQUAL(reader.Info().NumMappings(d), info.NumMappings(d));
+
+  // A DatasetInfo of the wrong dimensionality is not accepted.
+  BOOST_REQUIRE_THROW(BatchReader<>("test.csv", 10, DatasetInfo(2)),
+      std::invalid_argument);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure an ARFF file can be read in batches.
+ */
+BOOST_AUTO_TEST_CASE(BatchReaderARFFTest)
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute one STRING" << endl;
+  f << "@attribute two REAL" << endl;
+  f << "@data" << endl;
+  f << "hello, 1" << endl;
+  f << "cheese, 2.34" << endl;
+  f << "% a comment line " << endl;
+  f << "seven, 1.03e+5" << endl;
+  f << "hello, -1.3" << endl;
+  f.close();
+
+  arma::mat dataset;
+  BatchReader<> reader("test.arff", 3);
+
+  BOOST_REQUIRE(reader.NextBatch(dataset));
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 3);
+  BOOST_REQUIRE(reader.Info().Type(0) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(dataset(0, 0), 0);
+  BOOST_REQUIRE_EQUAL(dataset(0, 1), 1);
+  BOOST_REQUIRE_EQUAL(dataset(0, 2), 2);
+  BOOST_REQUIRE_CLOSE(dataset(1, 1), 2.34, 1e-5);
+  BOOST_REQUIRE_CLOSE(dataset(1, 2), 1.03e5, 1e-5);
+
+  BOOST_REQUIRE(reader.NextBatch(dataset));
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 1);
+  BOOST_REQUIRE_EQUAL(dataset(0, 0), 0);
+  BOOST_REQUIRE_CLOSE(dataset(1, 0), -1.3, 1e-5);
+
+  BOOST_REQUIRE(!reader.NextBatch(dataset));
+
+  remove("test.arff");
+}
+
+/**
+ * Make sure the batches of an Armadillo binary file are the columns
+ * data::Load() gives.
+ */
+BOOST_AUTO_TEST_CASE(BatchReaderBinaryTest)
+{
+  arma::mat data(4, 53, arma::fill::randu);
+  BOOST_REQUIRE(data::Save("test.bin", data));
+
+  BatchReader<> reader("test.bin", 20);
+  BOOST_REQUIRE_EQUAL(reader.Dimensionality(), 4);
+
+  arma::mat batch;
+  size_t points = 0;
+  while (reader.NextBatch(batch))
+  {
+    for (size_t i = 0; i < batch.n_cols; ++i)
+      for (size_t d = 0; d < 4; ++d)
+        BOOST_REQUIRE_EQUAL(batch(d, i), data(d, points + i));
+    points += batch.n_cols;
+  }
+
+  BOOST_REQUIRE_EQUAL(points, 53);
+
+  remove("test.bin");
+}
+
+/**
+ * Make sure that the text files written by BatchWriter in batches can be
+ * loaded by data::Load(), and hold exactly the same values.
+ */
+BOOST_AUTO_TEST_CASE(BatchWriterTextTest)
+{
+  arma::mat data(5, 83, arma::fill::randn);
+  data(2, 7) = 1e-300;
+  data(3, 9) = -123456789.125;
+  arma::Mat<size_t> indices = arma::randi<arma::Mat<size_t>>(3, 83,
+      arma::distr_param(0, 1000000));
+
+  const std::vector<std::string> filenames = { "test.csv", "test.txt" };
+  for (const std::string& filename : filenames)
+  {
+    BatchWriter<> writer(filename, 5);
+    for (size_t i = 0; i < 83; i += 20)
+      writer.WriteBatch(data.cols(i, std::min(i + 19, (size_t) 82)));
+    BOOST_REQUIRE_EQUAL(writer.PointsWritten(), 83);
+    writer.Close();
+
+    arma::mat loaded;
+    BOOST_REQUIRE(data::Load(filename, loaded));
+    BOOST_REQUIRE_EQUAL(loaded.n_rows, 5);
+    BOOST_REQUIRE_EQUAL(loaded.n_cols, 83);
+    for (size_t i = 0; i < data.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(loaded[i], data[i]);
+
+    BatchWriter<size_t> indexWriter(filename, 3);
+    indexWriter.WriteBatch(indices.cols(0, 49));
+    indexWriter.WriteBatch(indices.cols(50, 82));
+    indexWriter.Close();
+
+    arma::Mat<size_t> loadedIndices;
+    BOOST_REQUIRE(data::Load(filename, loadedIndices));
+    BOOST_REQUIRE_EQUAL(loadedIndices.n_rows, 3);
+    BOOST_REQUIRE_EQUAL(loadedIndices.n_cols, 83);
+    for (size_t i = 0; i < indices.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(loadedIndices[i], indices[i]);
+
+    // Batches of the wrong dimensionality are rejected.
+    BatchWriter<> badWriter(filename, 4);
+    BOOST_REQUIRE_THROW(badWriter.WriteBatch(data), std::invalid_argument);
+
+    remove(filename.c_str());
+  }
+}
+
+/**
+ * Make sure that Armadillo binary files written by BatchWriter in batches can
+ * be loaded by data::Load().
+ */
+BOOST_AUTO_TEST_CASE(BatchWriterBinaryTest)
+{
+  arma::mat data(4, 53, arma::fill::randu);
+
+  BatchWriter<> writer("test.bin", 4, 53);
+  writer.WriteBatch(data.cols(0, 19));
+  writer.WriteBatch(data.cols(20, 39));
+  writer.WriteBatch(data.cols(40, 52));
+  BOOST_REQUIRE_THROW(writer.WriteBatch(data.cols(0, 0)),
+      std::invalid_argument);
+  writer.Close();
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test.bin", loaded));
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 53);
+  for (size_t i = 0; i < data.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], data[i]);
+
+  // The number of points must be known for binary files, and must be reached.
+  BOOST_REQUIRE_THROW(BatchWriter<>("test.bin", 4), std::invalid_argument);
+  BatchWriter<> incompleteWriter("test.bin", 4, 53);
+  incompleteWriter.WriteBatch(data.cols(0, 19));
+  BOOST_REQUIRE_THROW(incompleteWriter.Close(), std::runtime_error);
+
+  remove("test.bin");
+}
+
+/**
+ * Make sure that ProcessBatches() computes the results of all batches and
+ * writes them in order, and passes on the exceptions of each stage.
+ */
+BOOST_AUTO_TEST_CASE(ProcessBatchesTest)
+{
+  arma::mat data(3, 1000, arma::fill::randu);
+  BOOST_REQUIRE(data::Save("test.csv", data));
+
+  BatchReader<> reader("test.csv", 64);
+  arma::rowvec sums;
+  std::vector<size_t> firsts;
+  const size_t points = data::ProcessBatches(reader,
+      [&](arma::mat& batch, const size_t first)
+      {
+        firsts.push_back(first);
+        return arma::rowvec(arma::sum(batch));
+      },
+      [&](arma::rowvec& batchSums)
+      {
+        sums = arma::join_rows(sums, batchSums);
+      }, 3);
+
+  BOOST_REQUIRE_EQUAL(points, 1000);
+  BOOST_REQUIRE_EQUAL(firsts.size(), 16);
+  for (size_t i = 0; i < firsts.size(); ++i)
+    BOOST_REQUIRE_EQUAL(firsts[i], 64 * i);
+
+  const arma::rowvec expected = arma::sum(data);
+  BOOST_REQUIRE_EQUAL(sums.n_elem, 1000);
+  for (size_t i = 0; i < 1000; ++i)
+    BOOST_REQUIRE_CLOSE(sums[i], expected[i], 1e-5);
+
+  // An exception of the computation or of the writing stops the pipeline and
+  // is passed on.
+  reader.Reset();
+  BOOST_REQUIRE_THROW(data::ProcessBatches(reader,
+      [&](arma::mat& batch, const size_t first)
+      {
+        if (first >= 256)
+          throw std::runtime_error("compute");
+        return batch.n_cols;
+      },
+      [&](size_t& /* result */) { }), std::runtime_error);
+
+  reader.Reset();
+  size_t written = 0;
+  BOOST_REQUIRE_THROW(data::ProcessBatches(reader,
+      [&](arma::mat& batch, const size_t /* first */)
+      {
+        return batch.n_cols;
+      },
+      [&](size_t& result)
+      {
+        if (written > 0)
+          throw std::runtime_error("write");
+        written += result;
+      }), std::runtime_error);
+  BOOST_REQUIRE_EQUAL(written, 64);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure a matrix saved by MappedMatrix::Save() is mapped in place, and can
+ * be loaded by data::Load() too.
+ */
+BOOST_AUTO_TEST_CASE(MappedMatrixTest)
+{
+  arma::mat data(7, 31, arma::fill::randu);
+  MappedMatrix<>::Save("test.bin", data);
+
+  MappedMatrix<> mapped("test.bin");
+  BOOST_REQUIRE(mapped.IsMapped());
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_rows, 7);
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_cols, 31);
+  for (size_t i = 0; i < data.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(mapped.Matrix()[i], data[i]);
+
+  // A copy uses the same memory.
+  MappedMatrix<> copy(mapped);
+  BOOST_REQUIRE_EQUAL(copy.Matrix().memptr(), mapped.Matrix().memptr());
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test.bin", loaded, false, false));
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 7);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 31);
+  for (size_t i = 0; i < data.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], data[i]);
+
+  // The element type has to match.
+  BOOST_REQUIRE_THROW(MappedMatrix<float>("test.bin"), std::runtime_error);
+
+  remove("test.bin");
+}
+
+/**
+ * Make sure the products computed over the column blocks of a mapped matrix
+ * are the ones of the matrix, with a last block that is not full.
+ */
+BOOST_AUTO_TEST_CASE(ColumnBlocksTest)
+{
+  arma::mat data(6, 53, arma::fill::randu);
+  MappedMatrix<>::Save("test.bin", data);
+  MappedMatrix<> mapped("test.bin");
+
+  MatrixColumnBlocks<> blocks(mapped.Matrix(), 10);
+  BOOST_REQUIRE_EQUAL(blocks.Rows(), 6);
+  BOOST_REQUIRE_EQUAL(blocks.Cols(), 53);
+  BOOST_REQUIRE_EQUAL(blocks.NumBlocks(), 6);
+
+  arma::vec sums;
+  ColumnBlockSums(blocks, sums);
+  CheckMatrices(sums, arma::vec(arma::sum(data, 1)));
+
+  const arma::mat x(53, 3, arma::fill::randu);
+  const arma::mat y(6, 3, arma::fill::randu);
+  arma::mat result;
+  ColumnBlockMultiply(blocks, x, result);
+  CheckMatrices(result, data * x);
+  ColumnBlockTransMultiply(blocks, y, result);
+  CheckMatrices(result, data.t() * y);
+  ColumnBlockGramMultiply(blocks, y, result);
+  CheckMatrices(result, data * (data.t() * y));
+
+  BOOST_REQUIRE_THROW(ColumnBlockMultiply(blocks, y, result),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(ColumnBlockTransMultiply(blocks, x, result),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(MatrixColumnBlocks<>(data, 0), std::invalid_argument);
+
+  remove("test.bin");
+}
+
+/**
+ * Make sure the products over column blocks work in single precision too.
+ */
+BOOST_AUTO_TEST_CASE(FloatColumnBlocksTest)
+{
+  const arma::fmat data(6, 53, arma::fill::randu);
+  MatrixColumnBlocks<float> blocks(data, 10);
+
+  arma::fvec sums;
+  ColumnBlockSums(blocks, sums);
+  CheckMatrices(arma::conv_to<arma::mat>::from(sums),
+      arma::conv_to<arma::mat>::from(arma::sum(data, 1)), 1e-3);
+
+  const arma::fmat x(53, 3, arma::fill::randu);
+  const arma::fmat y(6, 3, arma::fill::randu);
+  arma::fmat result;
+  ColumnBlockMultiply(blocks, x, result);
+  CheckMatrices(arma::conv_to<arma::mat>::from(result),
+      arma::conv_to<arma::mat>::from(data * x), 1e-3);
+  ColumnBlockTransMultiply(blocks, y, result);
+  CheckMatrices(arma::conv_to<arma::mat>::from(result),
+      arma::conv_to<arma::mat>::from(data.t() * y), 1e-3);
+  ColumnBlockGramMultiply(blocks, y, result);
+  CheckMatrices(arma::conv_to<arma::mat>::from(result),
+      arma::conv_to<arma::mat>::from(data * (data.t() * y)), 1e-3);
+}
+
+/**
+ * Make sure raw binary files and files saved by data::Save() can be mapped.
+ */
+BOOST_AUTO_TEST_CASE(MappedMatrixRawBinaryTest)
+{
+  arma::mat data(5, 12, arma::fill::randu);
+  data.save("test.bin", arma::raw_binary);
+
+  MappedMatrix<> mapped("test.bin", 5);
+  BOOST_REQUIRE(mapped.IsMapped());
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_rows, 5);
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_cols, 12);
+  for (size_t i = 0; i < data.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(mapped.Matrix()[i], data[i]);
+
+  // The file does not hold whole columns of 7 rows.
+  BOOST_REQUIRE_THROW(MappedMatrix<>("test.bin", 7), std::runtime_error);
+
+  // The header of data::Save() is not padded, so the elements may be copied.
+  BOOST_REQUIRE(data::Save("test.bin", data, false, false));
+  MappedMatrix<> saved("test.bin");
+  BOOST_REQUIRE_EQUAL(saved.Matrix().n_rows, 5);
+  BOOST_REQUIRE_EQUAL(saved.Matrix().n_cols, 12);
+  for (size_t i = 0; i < data.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(saved.Matrix()[i], data[i]);
+
+  remove("test.bin");
+}
+
+/**
+ * Make sure the entries of a model container are loaded as they were added,
+ * with the matrices and blobs used from the mapped file.
+ */
+BOOST_AUTO_TEST_CASE(ModelContainerTest)
+{
+  arma::mat data(6, 25, arma::fill::randu);
+  arma::Mat<size_t> labels = arma::randi<arma::Mat<size_t>>(1, 25,
+      arma::distr_param(0, 4));
+  const std::string blob = "some bytes";
+
+  arma::mat categorical;
+  DatasetInfo info;
+  {
+    std::fstream f;
+    f.open("test.csv", std::fstream::out);
+    f << "1,a,3" << std::endl;
+    f << "4,b,6" << std::endl;
+    f << "7,a,9" << std::endl;
+    f.close();
+  }
+  BOOST_REQUIRE(data::Load("test.csv", categorical, info, false, true));
+  remove("test.csv");
+
+  {
+    ModelContainerWriter writer("test.mlpk");
+    writer.AddMatrix("data", data);
+    writer.AddObject("info", info);
+    writer.AddBlob("blob", blob);
+    writer.AddMatrix("labels", labels);
+
+    // Names have to be unique.
+    BOOST_REQUIRE_THROW(writer.AddBlob("data", blob), std::invalid_argument);
+    writer.Close();
+  }
+
+  ModelContainer model("test.mlpk");
+  const std::vector<std::string> names = model.Names();
+  BOOST_REQUIRE_EQUAL(names.size(), 4);
+  BOOST_REQUIRE_EQUAL(names[0], "data");
+  BOOST_REQUIRE_EQUAL(names[1], "info");
+  BOOST_REQUIRE_EQUAL(names[2], "blob");
+  BOOST_REQUIRE_EQUAL(names[3], "labels");
+  BOOST_REQUIRE(model.HasEntry("info"));
+  BOOST_REQUIRE(!model.HasEntry("forest"));
+
+  const arma::mat& mappedData = model.Matrix<double>("data");
+  BOOST_REQUIRE_EQUAL(mappedData.n_rows, 6);
+  BOOST_REQUIRE_EQUAL(mappedData.n_cols, 25);
+  for (size_t i = 0; i < data.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(mappedData[i], data[i]);
+  BOOST_REQUIRE_GE((const char*) mappedData.memptr(), model.File().Data());
+  BOOST_REQUIRE_LT((const char*) mappedData.memptr(), model.File().Data() +
+      model.File().Size());
+  BOOST_REQUIRE_EQUAL(&model.Matrix<double>("data"), &mappedData);
+
+  const arma::Mat<size_t>& mappedLabels = model.Matrix<size_t>("labels");
+  BOOST_REQUIRE_EQUAL(mappedLabels.n_elem, labels.n_elem);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(mappedLabels[i], labels[i]);
+
+  const char* blobData;
+  size_t blobSize;
+  model.Blob("blob", blobData, blobSize);
+  BOOST_REQUIRE_EQUAL(std::string(blobData, blobSize), blob);
+  BOOST_REQUIRE_EQUAL((blobData - model.File().Data()) % 4096, 0);
+
+  DatasetInfo& loadedInfo = model.Object<DatasetInfo>("info");
+  BOOST_REQUIRE_EQUAL(loadedInfo.Dimensionality(), 3);
+  BOOST_REQUIRE(loadedInfo.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(loadedInfo.UnmapString(0, 1), "a");
+  BOOST_REQUIRE_EQUAL(loadedInfo.UnmapString(1, 1), "b");
+  BOOST_REQUIRE_EQUAL(&model.Object<DatasetInfo>("info"), &loadedInfo);
+
+  // The kind and element type of the entries have to match.
+  BOOST_REQUIRE_THROW(model.Matrix<float>("data"), std::runtime_error);
+  BOOST_REQUIRE_THROW(model.Matrix<double>("info"), std::runtime_error);
+  BOOST_REQUIRE_THROW(model.Blob("forest", blobData, blobSize),
+      std::runtime_error);
+
+  remove("test.mlpk");
+
+  // Other files are not model containers.
+  data.save("test.bin", arma::raw_binary);
+  BOOST_REQUIRE_THROW(ModelContainer("test.bin"), std::runtime_error);
+  remove("test.bin");
+}
+
+#ifdef HAS_ARROW
+/**
+ * Make sure a Parquet file with a numeric and a string column is loaded
+ * correctly, both at once and in batches across row groups.
+ */
+BOOST_AUTO_TEST_CASE(LoadParquetTest)
+{
+  arrow::DoubleBuilder doubles;
+  arrow::StringBuilder strings;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    BOOST_REQUIRE(doubles.Append(0.5 * i).ok());
+    BOOST_REQUIRE(strings.Append((i % 3 == 0) ? "a" : "b").ok());
+  }
+
+  std::shared_ptr<arrow::Array> doubleArray, stringArray;
+  BOOST_REQUIRE(doubles.Finish(&doubleArray).ok());
+  BOOST_REQUIRE(strings.Finish(&stringArray).ok());
+  std::shared_ptr<arrow::Table> table = arrow::Table::Make(
+      arrow::schema({ arrow::field("x", arrow::float64()),
+                      arrow::field("s", arrow::utf8()) }),
+      { doubleArray, stringArray });
+
+  // Write row groups of 4 rows.
+  std::shared_ptr<arrow::io::FileOutputStream> out =
+      arrow::io::FileOutputStream::Open("test.parquet").ValueOrDie();
+  BOOST_REQUIRE(parquet::arrow::WriteTable(*table,
+      arrow::default_memory_pool(), out, 4).ok());
+  BOOST_REQUIRE(out->Close().ok());
+
+  arma::mat dataset;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.parquet", dataset, info));
+
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 10);
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 2);
+  for (size_t i = 0; i < 10; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(dataset(0, i), 0.5 * i, 1e-5);
+    BOOST_REQUIRE_EQUAL(dataset(1, i), (i % 3 == 0) ? 0 : 1);
+  }
+
+  BatchReader<> reader("test.parquet", 3);
+  arma::mat batch;
+  size_t points = 0;
+  while (reader.NextBatch(batch))
+  {
+    BOOST_REQUIRE_EQUAL(batch.n_rows, 2);
+    for (size_t i = 0; i < batch.n_cols; ++i)
+      for (size_t d = 0; d < 2; ++d)
+        BOOST_REQUIRE_EQUAL(batch(d, i), dataset(d, points + i));
+    points += batch.n_cols;
+  }
+  BOOST_REQUIRE_EQUAL(points, 10);
+
+  remove("test.parquet");
+}
+#endif
+
 /**
  * Make sure DatasetMapper properly unmaps from non-unique strings.
  */
@@ -1994,4 +2780,236 @@ BOOST_AUTO_TEST_CASE(DatasetMapperNonUniqueTest)
   BOOST_REQUIRE_EQUAL(dm.UnmapString(nan, 0, 2), "cheese");
 }
 
+/**
+ * Make sure InternPolicy maps the same way as IncrementPolicy when loading a
+ * dataset, and unmaps its mappings.
+ */
+BOOST_AUTO_TEST_CASE(InternPolicyLoadTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 1000; ++i)
+    f << "user" << (i * 7919) % 613 << ", " << i << ", " << (i % 3) << endl;
+  f.close();
+
+  arma::mat incrementData, internData;
+  DatasetMapper<IncrementPolicy> incrementInfo;
+  DatasetMapper<InternPolicy> internInfo;
+  BOOST_REQUIRE(data::Load("test.csv", incrementData, incrementInfo, true));
+  BOOST_REQUIRE(data::Load("test.csv", internData, internInfo, true));
+
+  BOOST_REQUIRE_EQUAL(internData.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(internData.n_cols, 1000);
+  for (size_t i = 0; i < internData.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(internData[i], incrementData[i]);
+
+  BOOST_REQUIRE(internInfo.Type(0) == Datatype::categorical);
+  BOOST_REQUIRE(internInfo.Type(1) == Datatype::numeric);
+  BOOST_REQUIRE(internInfo.Type(2) == Datatype::numeric);
+  BOOST_REQUIRE_EQUAL(internInfo.NumMappings(0), 613);
+  BOOST_REQUIRE_EQUAL(internInfo.NumMappings(1), 0);
+
+  for (size_t v = 0; v < 613; ++v)
+  {
+    const std::string user = internInfo.UnmapString(v, 0);
+    BOOST_REQUIRE_EQUAL(user, incrementInfo.UnmapString(v, 0));
+    BOOST_REQUIRE_EQUAL(internInfo.UnmapValue(user, 0), v);
+    BOOST_REQUIRE_EQUAL(internInfo.NumUnmappings(v, 0), 1);
+  }
+
+  BOOST_REQUIRE_THROW(internInfo.UnmapString(613, 0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(internInfo.UnmapValue("nobody", 0),
+      std::invalid_argument);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure DatasetMapper::Merge() maps the new inputs of the other mapper and
+ * returns the remappings of its values, with both IncrementPolicy and
+ * InternPolicy.
+ */
+template<typename PolicyType>
+void CheckDatasetMapperMerge()
+{
+  DatasetMapper<PolicyType> first(2), second(2);
+  first.template MapString<double>("a", 0);
+  first.template MapString<double>("b", 0);
+  second.template MapString<double>("c", 0);
+  second.template MapString<double>("a", 0);
+  // A number is not mapped while the dimension is numeric.
+  second.template MapString<double>("1.5", 1);
+  second.template MapString<double>("x", 1);
+
+  std::vector<std::vector<size_t>> remappings;
+  first.Merge(second, remappings);
+
+  BOOST_REQUIRE_EQUAL(remappings.size(), 2);
+  BOOST_REQUIRE_EQUAL(remappings[0].size(), 2);
+  BOOST_REQUIRE_EQUAL(remappings[0][0], 2); // "c" is new.
+  BOOST_REQUIRE_EQUAL(remappings[0][1], 0); // "a".
+  BOOST_REQUIRE_EQUAL(remappings[1].size(), 1);
+  BOOST_REQUIRE_EQUAL(remappings[1][0], 0); // "x" is new.
+
+  BOOST_REQUIRE_EQUAL(first.NumMappings(0), 3);
+  BOOST_REQUIRE_EQUAL(first.NumMappings(1), 1);
+  BOOST_REQUIRE(first.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(first.UnmapString(2, 0), "c");
+  BOOST_REQUIRE_EQUAL(first.UnmapString(0, 1), "x");
+
+  DatasetMapper<PolicyType> wrong(3);
+  BOOST_REQUIRE_THROW(first.Merge(wrong, remappings), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(DatasetMapperMergeTest)
+{
+  CheckDatasetMapperMerge<IncrementPolicy>();
+  CheckDatasetMapperMerge<InternPolicy>();
+}
+
+#ifndef _WIN32
+
+// Connect to the Unix domain socket at the given path.
+int ConnectToSocket(const std::string& path)
+{
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, path.c_str());
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  BOOST_REQUIRE_NE(fd, -1);
+  BOOST_REQUIRE_EQUAL(connect(fd, (struct sockaddr*) &address,
+      sizeof(address)), 0);
+  return fd;
+}
+
+// Send a request with the given id and points.
+void SendRequest(const int fd, const uint64_t id, const arma::mat& points)
+{
+  const uint64_t header[3] = { id, points.n_rows, points.n_cols };
+  BOOST_REQUIRE_EQUAL((size_t) write(fd, header, sizeof(header)),
+      sizeof(header));
+  BOOST_REQUIRE_EQUAL((size_t) write(fd, points.memptr(), points.n_elem *
+      sizeof(double)), points.n_elem * sizeof(double));
+}
+
+// Read the given number of bytes.
+void ReadBytes(const int fd, void* data, const size_t size)
+{
+  size_t done = 0;
+  while (done < size)
+  {
+    const ssize_t bytes = read(fd, (char*) data + done, size - done);
+    BOOST_REQUIRE_GT(bytes, 0);
+    done += bytes;
+  }
+}
+
+/**
+ * Make sure that the QueryServer hands out the pending requests of several
+ * clients together, and sends each client its own responses.
+ */
+BOOST_AUTO_TEST_CASE(QueryServerSocketTest)
+{
+  const std::string path = "query_server_test.sock";
+  QueryServer server(path);
+
+  const int first = ConnectToSocket(path);
+  const int second = ConnectToSocket(path);
+
+  arma::mat a(3, 2, arma::fill::randu);
+  arma::mat b(3, 1, arma::fill::randu);
+  arma::mat c(3, 4, arma::fill::randu);
+  SendRequest(first, 10, a);
+  SendRequest(first, 11, b);
+  SendRequest(second, 20, c);
+
+  // The requests reach the server in any order, but one call to Collect()
+  // returns all of them once they are there.
+  std::vector<QueryServer::Request> requests, all;
+  while (all.size() < 3)
+  {
+    BOOST_REQUIRE(server.Collect(requests, 1000));
+    all.insert(all.end(), requests.begin(), requests.end());
+  }
+  BOOST_REQUIRE_EQUAL(all.size(), 3);
+
+  for (size_t i = 0; i < all.size(); ++i)
+  {
+    const arma::mat& expected = (all[i].id == 10) ? a :
+        (all[i].id == 11) ? b : c;
+    CheckMatrices(all[i].points, expected);
+
+    if (all[i].id == 11)
+    {
+      server.RespondError(all[i], "error");
+    }
+    else
+    {
+      arma::Mat<size_t> neighbors(2, all[i].points.n_cols);
+      neighbors.fill(all[i].id);
+      arma::mat distances(2, all[i].points.n_cols);
+      distances.fill(0.5);
+      server.Respond(all[i], neighbors, distances);
+    }
+  }
+
+  // The first client gets the response to request 10 first.
+  uint64_t header[4];
+  ReadBytes(first, header, sizeof(header));
+  BOOST_REQUIRE_EQUAL(header[0], 10);
+  BOOST_REQUIRE_EQUAL(header[1], 0);
+  BOOST_REQUIRE_EQUAL(header[2], 2);
+  BOOST_REQUIRE_EQUAL(header[3], 2);
+  uint64_t neighbors[4];
+  double distances[4];
+  ReadBytes(first, neighbors, sizeof(neighbors));
+  ReadBytes(first, distances, sizeof(distances));
+  for (size_t i = 0; i < 4; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], 10);
+    BOOST_REQUIRE_CLOSE(distances[i], 0.5, 1e-5);
+  }
+
+  ReadBytes(first, header, 3 * sizeof(uint64_t));
+  BOOST_REQUIRE_EQUAL(header[0], 11);
+  BOOST_REQUIRE_EQUAL(header[1], 1);
+  BOOST_REQUIRE_EQUAL(header[2], 5);
+  char message[5];
+  ReadBytes(first, message, 5);
+  BOOST_REQUIRE_EQUAL(std::string(message, 5), "error");
+
+  ReadBytes(second, header, sizeof(header));
+  BOOST_REQUIRE_EQUAL(header[0], 20);
+  BOOST_REQUIRE_EQUAL(header[1], 0);
+  BOOST_REQUIRE_EQUAL(header[3], 4);
+
+  close(first);
+  close(second);
+}
+
+#endif
+
+/**
+ * Make sure that StandardOutputRedirect sends std::cout (and so Log::Warn) to
+ * standard error, and restores it afterwards.
+ */
+BOOST_AUTO_TEST_CASE(StandardOutputRedirectTest)
+{
+  std::ostringstream err;
+  std::streambuf* errBuffer = std::cerr.rdbuf(err.rdbuf());
+  std::streambuf* outBuffer = std::cout.rdbuf();
+
+  {
+    StandardOutputRedirect redirect;
+    BOOST_REQUIRE(std::cout.rdbuf() == err.rdbuf());
+    Log::Warn << "redirected" << std::endl;
+  }
+
+  BOOST_REQUIRE(std::cout.rdbuf() == outBuffer);
+  std::cerr.rdbuf(errBuffer);
+  BOOST_REQUIRE_NE(err.str().find("redirected"), std::string::npos);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -18,6 +18,10 @@
 #include "test_tools.hpp"
 #include "serialization.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace arma;
 using namespace mlpack;
 using namespace mlpack::regression;
@@ -122,6 +126,42 @@ BOOST_AUTO_TEST_CASE(LocalCoordinateCodingTestDictionaryStep)
   BOOST_REQUIRE_SMALL(norm(grad, "fro"), tol);
 }
 
+/**
+ * Make sure that encoding the points with several threads gives the same codes
+ * as encoding them with one thread.
+ */
+BOOST_AUTO_TEST_CASE(LocalCoordinateCodingParallelEncodeTest)
+{
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+  for (uword i = 0; i < X.n_cols; i++)
+    X.col(i) /= norm(X.col(i), 2);
+
+  LocalCoordinateCoding lcc(X, 10, 0.1, 2);
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  mat serialCodes;
+  lcc.Encode(X, serialCodes);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(4);
+    BOOST_REQUIRE_GE(ParallelThreads(), 2);
+  #endif
+
+  mat parallelCodes;
+  lcc.Encode(X, parallelCodes);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+
+  CheckMatrices(serialCodes, parallelCodes);
+}
+
 BOOST_AUTO_TEST_CASE(SerializationTest)
 {
   mat X = randu<mat>(100, 100);
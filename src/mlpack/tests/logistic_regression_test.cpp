@@ -181,6 +181,46 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionGradient)
   BOOST_REQUIRE_GE(gradient[0], 0.0);
 }
 
+/**
+ * Make sure EvaluateWithGradient() gives the same objective and gradient as
+ * Evaluate() and Gradient(), both for the full function and for each point.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluateWithGradient)
+{
+  arma::mat data("1 2 3 4;"
+                 "1 2 3 -1");
+  arma::Row<size_t> responses("1 1 0 1");
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.6);
+  const arma::mat parameters("150 -30 -35");
+
+  arma::mat gradient, fusedGradient;
+  lrf.Gradient(parameters, gradient);
+  const double objective = lrf.EvaluateWithGradient(parameters, fusedGradient);
+
+  BOOST_REQUIRE_CLOSE(objective, lrf.Evaluate(parameters), 1e-5);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_elem, gradient.n_elem);
+  for (size_t j = 0; j < gradient.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(fusedGradient[j], gradient[j], 1e-5);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    lrf.Gradient(parameters, i, gradient);
+    const double pointObjective = lrf.EvaluateWithGradient(parameters, i,
+        fusedGradient);
+
+    BOOST_REQUIRE_CLOSE(pointObjective, lrf.Evaluate(parameters, i), 1e-5);
+    BOOST_REQUIRE_EQUAL(fusedGradient.n_elem, gradient.n_elem);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+    {
+      if (std::abs(gradient[j]) < 1e-10)
+        BOOST_REQUIRE_SMALL(fusedGradient[j], 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(fusedGradient[j], gradient[j], 1e-5);
+    }
+  }
+}
+
 /**
  * Test individual Evaluate() functions for SGD.
  */
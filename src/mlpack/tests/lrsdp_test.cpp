@@ -314,4 +314,93 @@ BOOST_AUTO_TEST_CASE(Keller4LovaszThetaSDP)
   }
 }*/
 
+/**
+ * Make sure that the augmented Lagrangian of an LRSDP, which is computed from
+ * the packed sparse constraints without forming R R^T, and its gradient are the
+ * same as when they are computed directly.  After a constraint is modified, the
+ * new constraint must be used.
+ */
+BOOST_AUTO_TEST_CASE(LRSDPPackedConstraintsTest)
+{
+  const size_t n = 15;
+  const size_t numSparse = 30;
+  const size_t numDense = 2;
+  arma::mat coordinates = arma::randn<arma::mat>(n, 4);
+
+  LRSDP<SDP<arma::sp_mat>> sdp(numSparse, numDense, coordinates);
+  sdp.SDP().C() = arma::sprandu<arma::sp_mat>(n, n, 0.2);
+  sdp.SDP().C() += trans(sdp.SDP().C());
+  sdp.SDP().SparseB().randn(numSparse);
+  sdp.SDP().DenseB().randn(numDense);
+  for (size_t i = 0; i < numSparse; ++i)
+  {
+    // Some constraints share entries.
+    sdp.SDP().SparseA()[i].zeros(n, n);
+    const size_t j = i % n;
+    const size_t k = (3 * i + 1) % n;
+    sdp.SDP().SparseA()[i](j, k) += 0.5 + i;
+    sdp.SDP().SparseA()[i](k, j) += 0.5 + i;
+    sdp.SDP().SparseA()[i](j, j) -= 1.0;
+  }
+  for (size_t i = 0; i < numDense; ++i)
+  {
+    sdp.SDP().DenseA()[i].randu(n, n);
+    sdp.SDP().DenseA()[i] += trans(sdp.SDP().DenseA()[i]);
+  }
+
+  arma::vec lambda = arma::randn<arma::vec>(numSparse + numDense);
+  const double sigma = 3.0;
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    if (trial == 1)
+    {
+      // Modify a constraint; the packed constraints must be updated.
+      sdp.SDP().SparseA()[4](2, 7) = 3.0;
+      sdp.SDP().SparseA()[4](7, 2) = 3.0;
+    }
+
+    // Compute the augmented Lagrangian and its gradient directly.
+    const arma::mat rrt = coordinates * trans(coordinates);
+    arma::mat s(sdp.SDP().C());
+    double objective = accu(sdp.SDP().C() % rrt);
+    for (size_t i = 0; i < numSparse + numDense; ++i)
+    {
+      const double constraint = (i < numSparse) ?
+          accu(sdp.SDP().SparseA()[i] % rrt) - sdp.SDP().SparseB()[i] :
+          accu(sdp.SDP().DenseA()[i - numSparse] % rrt) -
+          sdp.SDP().DenseB()[i - numSparse];
+      objective -= lambda[i] * constraint;
+      objective += (sigma / 2.) * constraint * constraint;
+
+      const double y = lambda[i] - sigma * constraint;
+      if (i < numSparse)
+        s -= y * arma::mat(sdp.SDP().SparseA()[i]);
+      else
+        s -= y * sdp.SDP().DenseA()[i - numSparse];
+
+      BOOST_REQUIRE_SMALL(sdp.Function().EvaluateConstraint(i, coordinates) -
+          constraint, 1e-8);
+    }
+    const arma::mat gradient = 2 * s * coordinates;
+
+    AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>> augLag(
+        sdp.Function(), lambda, sigma);
+    BOOST_REQUIRE_CLOSE(augLag.Evaluate(coordinates), objective, 1e-8);
+
+    arma::mat packedGradient;
+    augLag.Gradient(coordinates, packedGradient);
+    BOOST_REQUIRE_EQUAL(packedGradient.n_rows, n);
+    BOOST_REQUIRE_EQUAL(packedGradient.n_cols, 4);
+    for (size_t i = 0; i < gradient.n_elem; ++i)
+      BOOST_REQUIRE_SMALL(packedGradient[i] - gradient[i], 1e-8);
+
+    arma::mat combinedGradient;
+    BOOST_REQUIRE_CLOSE(augLag.EvaluateWithGradient(coordinates,
+        combinedGradient), objective, 1e-8);
+    for (size_t i = 0; i < gradient.n_elem; ++i)
+      BOOST_REQUIRE_SMALL(combinedGradient[i] - gradient[i], 1e-8);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,7 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 #include <mlpack/methods/lsh/lsh_search.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -912,4 +913,167 @@ BOOST_AUTO_TEST_CASE(MoveOperatorTest)
   CheckMatrices(distances, distances2);
 }
 
+// Make sure that the compact second hash table holds every point once for each
+// table when the bucket size is not limited, and that SecondHashTable() gives
+// the same rows.
+BOOST_AUTO_TEST_CASE(CompactHashTableTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 2000);
+  const size_t numTables = 6;
+
+  LSHSearch<> lsh(dataset, 4, numTables, 0.0, 99901, 0 /* unlimited */);
+
+  const arma::Col<size_t>& offsets = lsh.BucketOffsets();
+  BOOST_REQUIRE_EQUAL(offsets.n_elem, lsh.NumBuckets() + 1);
+  BOOST_REQUIRE_EQUAL(offsets[0], 0);
+  BOOST_REQUIRE_EQUAL(offsets[lsh.NumBuckets()], numTables * dataset.n_cols);
+
+  arma::Col<size_t> counts(dataset.n_cols, arma::fill::zeros);
+  const std::vector<arma::Col<size_t>> rows = lsh.SecondHashTable();
+  BOOST_REQUIRE_EQUAL(rows.size(), lsh.NumBuckets());
+  for (size_t i = 0; i < rows.size(); ++i)
+  {
+    BOOST_REQUIRE_GT(rows[i].n_elem, 0);
+    BOOST_REQUIRE_EQUAL(rows[i].n_elem, offsets[i + 1] - offsets[i]);
+    for (size_t j = 0; j < rows[i].n_elem; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(rows[i][j], lsh.BucketPoint(offsets[i] + j));
+      counts[rows[i][j]]++;
+    }
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], numTables);
+
+  // With a limited bucket size, no row is longer than the limit.
+  LSHSearch<> limited(dataset, 4, numTables, 0.0, 99901, 3);
+  for (size_t i = 0; i < limited.NumBuckets(); ++i)
+    BOOST_REQUIRE_LE(limited.BucketOffsets()[i + 1] -
+        limited.BucketOffsets()[i], 3);
+}
+
+// Make sure that inserting points into a trained model gives the same results
+// as training the model on all points with the same random parameters.
+BOOST_AUTO_TEST_CASE(InsertTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(6, 1500);
+  arma::mat queries = arma::randu<arma::mat>(6, 100);
+  arma::mat first = dataset.cols(0, 999);
+  arma::mat second = dataset.cols(1000, 1499);
+
+  // With the same seed and a fixed hash width, both models draw the same
+  // projections, offsets and weights.  The bucket size is not limited, so that
+  // the order of insertion does not matter.
+  math::RandomSeed(42);
+  LSHSearch<> full(dataset, 5, 8, 1.0, 99901, 0);
+  math::RandomSeed(42);
+  LSHSearch<> inserted(first, 5, 8, 1.0, 99901, 0);
+  inserted.Insert(second);
+
+  BOOST_REQUIRE_EQUAL(inserted.ReferenceSet().n_cols, 1500);
+  BOOST_REQUIRE_EQUAL(first.n_cols, 1000);
+  BOOST_REQUIRE_EQUAL(inserted.NumBuckets(), full.NumBuckets());
+
+  arma::Mat<size_t> neighbors, fullNeighbors;
+  arma::mat distances, fullDistances;
+  full.Search(queries, 5, fullNeighbors, fullDistances, 0, 2);
+  inserted.Search(queries, 5, neighbors, distances, 0, 2);
+  CheckMatrices(neighbors, fullNeighbors);
+  CheckMatrices(distances, fullDistances);
+
+  full.Search(5, fullNeighbors, fullDistances);
+  inserted.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, fullNeighbors);
+  CheckMatrices(distances, fullDistances);
+
+  // The model can be serialized after insertion.
+  LSHSearch<> xmlLsh, textLsh, binaryLsh;
+  SerializeObjectAll(inserted, xmlLsh, textLsh, binaryLsh);
+  binaryLsh.Search(queries, 5, neighbors, distances, 0, 2);
+  inserted.Search(queries, 5, fullNeighbors, fullDistances, 0, 2);
+  CheckMatrices(neighbors, fullNeighbors);
+  CheckMatrices(distances, fullDistances);
+
+  // Points of the wrong dimensionality are rejected.
+  arma::mat wrong = arma::randu<arma::mat>(5, 10);
+  BOOST_REQUIRE_THROW(inserted.Insert(wrong), std::invalid_argument);
+  LSHSearch<> untrained;
+  BOOST_REQUIRE_THROW(untrained.Insert(second), std::invalid_argument);
+}
+
+/**
+ * Make sure that searching many queries at once, which projects them in blocks,
+ * gives the same results as searching them one at a time.
+ */
+BOOST_AUTO_TEST_CASE(BlockProjectionTest)
+{
+  math::RandomSeed(7);
+  arma::mat rdata = arma::randu<arma::mat>(3, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(3, 5000);
+
+  LSHSearch<> lsh(rdata, 5, 8, 0.5);
+
+  for (size_t t = 0; t <= 2; t += 2)
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    lsh.Search(qdata, 3, neighbors, distances, 6, t);
+
+    // Only check some of the queries, in both blocks.
+    for (size_t i = 0; i < qdata.n_cols; i += 97)
+    {
+      arma::Mat<size_t> queryNeighbors;
+      arma::mat queryDistances;
+      lsh.Search(qdata.col(i), 3, queryNeighbors, queryDistances, 6, t);
+
+      CheckMatrices(queryNeighbors, neighbors.col(i));
+      CheckMatrices(queryDistances, distances.col(i));
+    }
+  }
+}
+
+/**
+ * With one or two additional probes, the probing sequence of template probing
+ * gives the same bins as the heap of each query: the bins across the closest
+ * and the second closest boundaries.  With more probes, template probing must
+ * find neighbors at least as close as single-probe LSH, since it searches more
+ * bins.
+ */
+BOOST_AUTO_TEST_CASE(TemplateProbingTest)
+{
+  math::RandomSeed(11);
+  arma::mat rdata = arma::randu<arma::mat>(4, 2000);
+  arma::mat qdata = arma::randu<arma::mat>(4, 300);
+
+  LSHSearch<> lsh(rdata, 6, 5, 0.4);
+
+  for (size_t t = 1; t <= 2; ++t)
+  {
+    arma::Mat<size_t> heapNeighbors, templateNeighbors;
+    arma::mat heapDistances, templateDistances;
+    lsh.Search(qdata, 4, heapNeighbors, heapDistances, 0, t);
+    lsh.Search(qdata, 4, templateNeighbors, templateDistances, 0, t, true);
+
+    CheckMatrices(heapNeighbors, templateNeighbors);
+    CheckMatrices(heapDistances, templateDistances);
+  }
+
+  arma::Mat<size_t> singleNeighbors, templateNeighbors;
+  arma::mat singleDistances, templateDistances;
+  lsh.Search(qdata, 4, singleNeighbors, singleDistances, 0, 0);
+  lsh.Search(qdata, 4, templateNeighbors, templateDistances, 0, 20, true);
+  size_t improved = 0;
+  for (size_t i = 0; i < templateDistances.n_elem; ++i)
+  {
+    BOOST_REQUIRE_LE(templateDistances[i], singleDistances[i]);
+    if (templateDistances[i] < singleDistances[i])
+      ++improved;
+  }
+  BOOST_REQUIRE_GT(improved, 0);
+
+  // The monochromatic search uses the same sequence.
+  lsh.Search(4, singleNeighbors, singleDistances, 0, 20, true);
+  BOOST_REQUIRE_EQUAL(singleNeighbors.n_cols, rdata.n_cols);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
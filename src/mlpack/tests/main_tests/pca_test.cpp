@@ -132,4 +132,56 @@ BOOST_AUTO_TEST_CASE(PCATooHighNewDimensionalityTest)
   Log::Fatal.ignoreInput = false;
 }
 
+/**
+ * Make sure that the incremental decomposition method gives the same output
+ * as the exact one (up to the signs of the components).
+ */
+BOOST_AUTO_TEST_CASE(PCAIncrementalMethodTest)
+{
+  arma::mat x = arma::randu<arma::mat>(4, 50);
+
+  SetInputParam("input", x);
+  SetInputParam("new_dimensionality", (int) 2);
+
+  mlpackMain();
+  const arma::mat exactOutput = CLI::GetParam<arma::mat>("output");
+
+  CLI::ClearSettings();
+  CLI::RestoreSettings(mlpack::bindings::tests::programName);
+
+  SetInputParam("input", std::move(x));
+  SetInputParam("new_dimensionality", (int) 2);
+  SetInputParam("decomposition_method", std::string("incremental"));
+  SetInputParam("batch_size", (int) 7);
+
+  mlpackMain();
+  const arma::mat& output = CLI::GetParam<arma::mat>("output");
+
+  BOOST_REQUIRE_EQUAL(output.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(output.n_cols, 50);
+  for (size_t i = 0; i < output.n_rows; ++i)
+  {
+    const double sign = (arma::dot(output.row(i), exactOutput.row(i)) < 0) ?
+        -1.0 : 1.0;
+    for (size_t j = 0; j < output.n_cols; ++j)
+      BOOST_REQUIRE_SMALL(sign * output(i, j) - exactOutput(i, j), 1e-5);
+  }
+}
+
+/**
+ * Check that the batch size of the incremental method must be positive.
+ */
+BOOST_AUTO_TEST_CASE(PCAIncrementalInvalidBatchSizeTest)
+{
+  arma::mat x = arma::randu<arma::mat>(5, 5);
+
+  SetInputParam("input", std::move(x));
+  SetInputParam("decomposition_method", std::string("incremental"));
+  SetInputParam("batch_size", (int) 0);
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
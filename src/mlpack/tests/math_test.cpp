@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core/math/clamp.hpp>
+#include <mlpack/core/math/moments.hpp>
 #include <mlpack/core/math/random.hpp>
 #include <mlpack/core/math/range.hpp>
 #include <boost/test/unit_test.hpp>
@@ -583,4 +584,74 @@ BOOST_AUTO_TEST_CASE(RangeContainsRange)
   BOOST_REQUIRE_EQUAL(b.Contains(a), true);
 }
 
+/**
+ * Make sure the moments computed one value at a time match the two-pass
+ * definitions, and that merged moments match the moments of the whole
+ * sequence.
+ */
+BOOST_AUTO_TEST_CASE(MomentsTest)
+{
+  arma::rowvec values(1000, arma::fill::randn);
+  values = arma::exp(values); // Make the distribution skewed.
+
+  Moments moments, first, second;
+  for (size_t i = 0; i < values.n_elem; ++i)
+  {
+    moments.Add(values[i]);
+    if (i < 317)
+      first.Add(values[i]);
+    else
+      second.Add(values[i]);
+  }
+  first.Merge(second);
+
+  const double mean = arma::mean(values);
+  const double m2 = arma::accu(arma::pow(values - mean, 2));
+  const double m3 = arma::accu(arma::pow(values - mean, 3));
+  const double m4 = arma::accu(arma::pow(values - mean, 4));
+  const double n = values.n_elem;
+
+  for (const Moments& m : { moments, first })
+  {
+    BOOST_REQUIRE_EQUAL(m.Count(), 1000);
+    BOOST_REQUIRE_CLOSE(m.Mean(), mean, 1e-8);
+    BOOST_REQUIRE_CLOSE(m.M2(), m2, 1e-8);
+    BOOST_REQUIRE_CLOSE(m.M3(), m3, 1e-8);
+    BOOST_REQUIRE_CLOSE(m.M4(), m4, 1e-8);
+    BOOST_REQUIRE_EQUAL(m.Min(), arma::min(values));
+    BOOST_REQUIRE_EQUAL(m.Max(), arma::max(values));
+
+    BOOST_REQUIRE_CLOSE(m.Variance(), arma::var(values), 1e-8);
+    BOOST_REQUIRE_CLOSE(m.Variance(true), arma::var(values, 1), 1e-8);
+    BOOST_REQUIRE_CLOSE(m.Skewness(true),
+        m3 / (n * std::pow(arma::stddev(values, 1), 3)), 1e-8);
+    BOOST_REQUIRE_CLOSE(m.Kurtosis(true), n * m4 / (m2 * m2) - 3, 1e-8);
+  }
+}
+
+/**
+ * Make sure DimensionMoments() gives the moments of each dimension for any
+ * number of threads.
+ */
+BOOST_AUTO_TEST_CASE(DimensionMomentsTest)
+{
+  arma::mat data(4, 503, arma::fill::randu);
+
+  for (size_t threads = 1; threads < 5; ++threads)
+  {
+    std::vector<Moments> moments;
+    DimensionMoments(data, moments, threads);
+    BOOST_REQUIRE_EQUAL(moments.size(), 4);
+
+    for (size_t d = 0; d < 4; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(moments[d].Count(), 503);
+      BOOST_REQUIRE_CLOSE(moments[d].Mean(), arma::mean(data.row(d)), 1e-8);
+      BOOST_REQUIRE_CLOSE(moments[d].Variance(), arma::var(data.row(d)), 1e-8);
+      BOOST_REQUIRE_EQUAL(moments[d].Min(), arma::min(data.row(d)));
+      BOOST_REQUIRE_EQUAL(moments[d].Max(), arma::max(data.row(d)));
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
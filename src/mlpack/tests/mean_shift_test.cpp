@@ -15,6 +15,10 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::meanshift;
 using namespace mlpack::distribution;
@@ -144,4 +148,66 @@ BOOST_AUTO_TEST_CASE(GaussianClustering)
       BOOST_REQUIRE_NE(minIndices[i], minIndices[j]);
 }
 
+// Each seed is shifted the same way however the seeds are divided between
+// threads, so the results must not depend on the number of threads, with or
+// without a kernel.
+template<bool UseKernel>
+void CheckThreadedMeanShift()
+{
+  GaussianDistribution g1("0.0 0.0", arma::eye<arma::mat>(2, 2));
+  GaussianDistribution g2("8.0 8.0", arma::eye<arma::mat>(2, 2));
+  GaussianDistribution g3("-6.0 6.0", arma::eye<arma::mat>(2, 2));
+
+  arma::mat dataset(2, 1500);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    dataset.col(i) = g1.Random();
+    dataset.col(i + 500) = g2.Random();
+    dataset.col(i + 1000) = g3.Random();
+  }
+
+  MeanShift<UseKernel> meanShift(2.0);
+  arma::Col<size_t> assignments, threadedAssignments;
+  arma::mat centroids, threadedCentroids;
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  meanShift.Cluster(dataset, assignments, centroids);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(4);
+  #endif
+
+  meanShift.Cluster(dataset, threadedAssignments, threadedCentroids);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(threadedCentroids.n_cols, centroids.n_cols);
+  CheckMatrices(threadedCentroids, centroids);
+  for (size_t i = 0; i < assignments.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(threadedAssignments[i], assignments[i]);
+
+  // No two centroids may be closer than the radius.
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    for (size_t j = i + 1; j < centroids.n_cols; ++j)
+      BOOST_REQUIRE_GE(metric::EuclideanDistance::Evaluate(centroids.col(i),
+          centroids.col(j)), 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(MeanShiftThreadsTest)
+{
+  CheckThreadedMeanShift<false>();
+}
+
+BOOST_AUTO_TEST_CASE(KernelMeanShiftThreadsTest)
+{
+  CheckThreadedMeanShift<true>();
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -87,4 +87,111 @@ BOOST_AUTO_TEST_CASE(LINFMetricTest)
                       lMetric.Evaluate(a2, b2), 1e-5);
 }
 
+/**
+ * Check that the given metric gives the same distances between sparse vectors,
+ * between sparse and dense vectors, and between dense vectors.
+ */
+template<typename MetricType>
+void CheckSparseMetric()
+{
+  arma::sp_mat a, b;
+  a.sprandu(100, 5, 0.1);
+  b.sprandu(100, 5, 0.1);
+  // Make sure some nonzeros are at the same positions, and the vectors may
+  // also be empty.
+  b.col(0) = a.col(0) * 2.0;
+  a.col(1).zeros();
+
+  const arma::mat denseA(a), denseB(b);
+  for (size_t i = 0; i < a.n_cols; ++i)
+  {
+    const double distance = MetricType::Evaluate(denseA.col(i),
+        denseB.col(i));
+
+    if (distance == 0.0)
+    {
+      BOOST_REQUIRE_SMALL(MetricType::Evaluate(a.col(i), b.col(i)), 1e-10);
+      continue;
+    }
+
+    BOOST_REQUIRE_CLOSE(MetricType::Evaluate(a.col(i), b.col(i)), distance,
+        1e-5);
+    BOOST_REQUIRE_CLOSE(MetricType::Evaluate(denseA.col(i), b.col(i)),
+        distance, 1e-5);
+    BOOST_REQUIRE_CLOSE(MetricType::Evaluate(a.col(i), denseB.col(i)),
+        distance, 1e-5);
+
+    const arma::sp_vec va(a.col(i)), vb(b.col(i));
+    BOOST_REQUIRE_CLOSE(MetricType::Evaluate(va, vb), distance, 1e-5);
+  }
+}
+
+/**
+ * Distances between sparse vectors are computed from their nonzeros; make sure
+ * they match the distances between the dense vectors.
+ */
+BOOST_AUTO_TEST_CASE(SparseLMetricTest)
+{
+  CheckSparseMetric<ManhattanDistance>();
+  CheckSparseMetric<SquaredEuclideanDistance>();
+  CheckSparseMetric<EuclideanDistance>();
+  CheckSparseMetric<LMetric<3, true>>();
+  CheckSparseMetric<LMetric<3, false>>();
+  CheckSparseMetric<LMetric<4, true>>();
+  CheckSparseMetric<ChebyshevDistance>();
+}
+
+/**
+ * Check that the distances between columns of a matrix, which are computed
+ * from their memory, match Armadillo and stop early only above the bound.
+ */
+template<typename MetricType, typename ElemType>
+void CheckContiguousMetric()
+{
+  // The dimensionalities go below and above the size of the blocks.
+  const size_t dims[] = { 1, 3, 16, 21, 64, 100 };
+  for (size_t d = 0; d < 6; ++d)
+  {
+    arma::Mat<ElemType> data = arma::randn<arma::Mat<ElemType>>(dims[d], 2);
+    const arma::Col<ElemType> diff = arma::abs(data.col(0) - data.col(1));
+
+    double expected;
+    if (MetricType::Power == INT_MAX)
+      expected = arma::max(diff);
+    else if (MetricType::Power == 1)
+      expected = arma::accu(diff);
+    else
+      expected = arma::accu(arma::square(diff));
+    if (MetricType::Power == 2 && MetricType::TakeRoot)
+      expected = std::sqrt(expected);
+
+    const double distance = MetricType::Evaluate(data.col(0), data.col(1));
+    BOOST_REQUIRE_CLOSE(distance, expected, 1e-3);
+
+    // Above the distance, the exact distance is returned.
+    BOOST_REQUIRE_CLOSE(MetricType::EvaluateBounded(data.col(0), data.col(1),
+        2.0 * expected + 1.0), expected, 1e-3);
+
+    // Below the distance, something above the bound and at most the distance
+    // is returned.
+    const double bound = 0.5 * expected;
+    const double bounded = MetricType::EvaluateBounded(data.col(0),
+        data.col(1), bound);
+    BOOST_REQUIRE_GT(bounded, bound);
+    BOOST_REQUIRE_LE(bounded, expected * (1 + 1e-3));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ContiguousLMetricTest)
+{
+  CheckContiguousMetric<ManhattanDistance, double>();
+  CheckContiguousMetric<SquaredEuclideanDistance, double>();
+  CheckContiguousMetric<EuclideanDistance, double>();
+  CheckContiguousMetric<ChebyshevDistance, double>();
+  CheckContiguousMetric<ManhattanDistance, float>();
+  CheckContiguousMetric<SquaredEuclideanDistance, float>();
+  CheckContiguousMetric<EuclideanDistance, float>();
+  CheckContiguousMetric<ChebyshevDistance, float>();
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,106 @@
+/**
+ * @file model_averaging_test.cpp
+ *
+ * Test file for ModelAveraging (distributed optimization by periodic model
+ * averaging).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/model_averaging/model_averaging.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(ModelAveragingTest);
+
+/**
+ * Create two well-separated Gaussian classes for logistic regression.
+ */
+void CreateAveragingData(arma::mat& data, arma::Row<size_t>& responses)
+{
+  data.randn(3, 1000);
+  responses.set_size(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) += arma::vec("1.0 1.0 1.0");
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) += arma::vec("7.0 7.0 7.0");
+    responses[i] = 1;
+  }
+}
+
+/**
+ * A communicator of two nodes that always have the same state, so that the
+ * sums are twice the matrices of this node.
+ */
+class MirroredCommunicator
+{
+ public:
+  size_t Rank() const { return 0; }
+  size_t Size() const { return 2; }
+  void AllReduceSum(arma::mat& m) { m *= 2; }
+  void Broadcast(arma::mat& /* m */) { }
+};
+
+/**
+ * Train logistic regression with SGD rounds of one pass each on a single node.
+ */
+BOOST_AUTO_TEST_CASE(ModelAveragingLogisticRegressionTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateAveragingData(data, responses);
+
+  StandardSGD sgd(0.01, data.n_cols, 1e-5);
+  sgd.ResetPolicy() = false;
+  ModelAveraging<StandardSGD> optimizer(sgd, 50);
+  LogisticRegression<> lr(data, responses, optimizer, 0.001);
+
+  BOOST_REQUIRE_GT(lr.ComputeAccuracy(data, responses), 99.0);
+}
+
+/**
+ * The average of identical models is the same model, so two nodes with the
+ * same state have to take the same steps as a single one.
+ */
+BOOST_AUTO_TEST_CASE(ModelAveragingMirroredNodesTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  CreateAveragingData(data, responses);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.001);
+  StandardSGD sgd(0.01, data.n_cols, 1e-5);
+
+  // With a tolerance of 0, exactly the maximum number of rounds is run.
+  ModelAveraging<StandardSGD> local(sgd, 5, 0.0);
+  ModelAveraging<StandardSGD, MirroredCommunicator> mirrored(sgd, 5, 0.0);
+
+  math::RandomSeed(42);
+  arma::mat localCoordinates = lrf.GetInitialPoint();
+  const double localObjective = local.Optimize(lrf, localCoordinates);
+
+  math::RandomSeed(42);
+  arma::mat mirroredCoordinates = lrf.GetInitialPoint();
+  const double mirroredObjective = mirrored.Optimize(lrf, mirroredCoordinates);
+
+  // The objective over both nodes is twice the one of a single node.
+  BOOST_REQUIRE_CLOSE(2 * localObjective, mirroredObjective, 1e-5);
+  for (size_t i = 0; i < localCoordinates.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(localCoordinates[i] - mirroredCoordinates[i], 1e-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
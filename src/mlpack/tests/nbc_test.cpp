@@ -314,4 +314,75 @@ BOOST_AUTO_TEST_CASE(SeparateTrainIndividualIncrementalTest)
   }
 }
 
+/**
+ * Training incrementally on mini-batches must give the same model as training
+ * on every point in turn, and the batched classification must agree with the
+ * classification of each point.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchIncrementalTest)
+{
+  const char* trainFilename = "trainSet.csv";
+  size_t classes = 2;
+
+  arma::mat trainData;
+  data::Load(trainFilename, trainData, true);
+
+  // Get the labels out.
+  arma::Row<size_t> labels(trainData.n_cols);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+    labels[i] = trainData(trainData.n_rows - 1, i);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  NaiveBayesClassifier<> nbc(trainData.n_rows, classes);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+    nbc.Train(trainData.col(i), labels[i]);
+
+  NaiveBayesClassifier<> nbcBatch(trainData.n_rows, classes);
+  for (size_t i = 0; i < trainData.n_cols; i += 7)
+  {
+    const size_t end = std::min(i + 7, (size_t) trainData.n_cols) - 1;
+    nbcBatch.Train(trainData.cols(i, end), labels.subvec(i, end), classes,
+        true);
+  }
+
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+  {
+    if (std::abs(nbc.Means()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcBatch.Means()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Means()[i], nbcBatch.Means()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Variances().n_elem; ++i)
+  {
+    if (std::abs(nbc.Variances()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcBatch.Variances()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Variances()[i], nbcBatch.Variances()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Probabilities().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Probabilities()[i], nbcBatch.Probabilities()[i],
+        1e-5);
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  nbcBatch.Classify(trainData, predictions, probabilities);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+  {
+    size_t prediction;
+    arma::vec probs;
+    nbcBatch.Classify(trainData.col(i), prediction, probs);
+
+    BOOST_REQUIRE_EQUAL(predictions[i], prediction);
+    for (size_t j = 0; j < classes; ++j)
+    {
+      if (probs[j] < 1e-5)
+        BOOST_REQUIRE_SMALL(probabilities(j, i), 1e-5);
+      else
+        BOOST_REQUIRE_CLOSE(probabilities(j, i), probs[j], 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -322,4 +322,105 @@ BOOST_AUTO_TEST_CASE(NCALBFGSSimpleDataset)
   BOOST_REQUIRE_LT(arma::norm(finalGradient, 2), 1e-6);
 }
 
+/**
+ * With a cutoff that keeps all pairs, the approximate softmax error function
+ * is the exact one; with the default cutoff, it is very close.
+ */
+BOOST_AUTO_TEST_CASE(ApproxSoftmaxErrorFunctionTest)
+{
+  arma::mat data = 5 * arma::randu<arma::mat>(3, 200);
+  arma::Row<size_t> labels = arma::randi<arma::Row<size_t>>(200,
+      arma::distr_param(0, 2));
+  arma::mat coordinates = arma::eye<arma::mat>(3, 3);
+  coordinates(0, 1) = 0.3;
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  const double objective = sef.Evaluate(coordinates);
+  arma::mat gradient, approxGradient;
+  sef.Gradient(coordinates, gradient);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    const double cutoff = (trial == 0) ? 1e10 : 20.0;
+    const double tolerance = (trial == 0) ? 1e-8 : 1e-4;
+    ApproxSoftmaxErrorFunction<SquaredEuclideanDistance> asef(data, labels,
+        SquaredEuclideanDistance(), cutoff);
+
+    BOOST_REQUIRE_CLOSE(asef.Evaluate(coordinates), objective, tolerance);
+    asef.Gradient(coordinates, approxGradient);
+    CheckMatrices(approxGradient, gradient, tolerance);
+
+    for (size_t i = 0; i < 200; i += 17)
+    {
+      BOOST_REQUIRE_CLOSE(asef.Evaluate(coordinates, i),
+          sef.Evaluate(coordinates, i), tolerance);
+
+      arma::mat pointGradient, approxPointGradient;
+      sef.Gradient(coordinates, i, pointGradient);
+      asef.Gradient(coordinates, i, approxPointGradient);
+      CheckMatrices(approxPointGradient, pointGradient, tolerance);
+    }
+
+    // The candidates were only searched for once.
+    BOOST_REQUIRE_EQUAL(asef.NumSearches(), 1);
+  }
+}
+
+/**
+ * The candidates of the approximate softmax error function are only searched
+ * for again when the coordinates change enough.
+ */
+BOOST_AUTO_TEST_CASE(ApproxSoftmaxErrorFunctionSearchTest)
+{
+  arma::mat data = arma::randu<arma::mat>(2, 100);
+  arma::Row<size_t> labels = arma::randi<arma::Row<size_t>>(100,
+      arma::distr_param(0, 1));
+
+  ApproxSoftmaxErrorFunction<SquaredEuclideanDistance> asef(data, labels,
+      SquaredEuclideanDistance(), 5.0, 0.5);
+
+  arma::mat coordinates = arma::eye<arma::mat>(2, 2);
+  asef.Evaluate(coordinates);
+  BOOST_REQUIRE_EQUAL(asef.NumSearches(), 1);
+
+  // A small change moves no pair by more than the margin.
+  coordinates(0, 0) += 0.01;
+  asef.Evaluate(coordinates);
+  asef.Evaluate(coordinates, 3);
+  BOOST_REQUIRE_EQUAL(asef.NumSearches(), 1);
+
+  coordinates *= 3;
+  asef.Evaluate(coordinates);
+  BOOST_REQUIRE_EQUAL(asef.NumSearches(), 2);
+
+  // Changing the cutoff searches again.
+  asef.Cutoff() = 4.0;
+  asef.Evaluate(coordinates);
+  BOOST_REQUIRE_EQUAL(asef.NumSearches(), 3);
+}
+
+/**
+ * NCA with the approximate error function separates the simple dataset.
+ */
+BOOST_AUTO_TEST_CASE(NCALBFGSApproxSimpleDataset)
+{
+  arma::mat data           = "-0.1 -0.1 -0.1  0.1  0.1  0.1;"
+                             " 1.0  0.0 -1.0  1.0  0.0 -1.0 ";
+  arma::Row<size_t> labels = " 0    0    0    1    1    1   ";
+
+  NCA<SquaredEuclideanDistance, L_BFGS, ApproxSoftmaxErrorFunction> nca(data,
+      labels);
+  nca.Optimizer().NumBasis() = 5;
+
+  arma::mat outputMatrix;
+  nca.LearnDistance(outputMatrix);
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  const double initObj = sef.Evaluate(arma::eye<arma::mat>(2, 2));
+  const double finalObj = sef.Evaluate(outputMatrix);
+
+  BOOST_REQUIRE_LT(finalObj, initObj);
+  BOOST_REQUIRE_CLOSE(finalObj, -6.0, 1e-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,9 +13,12 @@
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/init_rules/random_acol_init.hpp>
 #include <mlpack/methods/amf/init_rules/given_init.hpp>
+#include <mlpack/methods/amf/update_rules/implicit_als.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_mult_div.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_mult_dist.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_als.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_products.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -222,4 +225,143 @@ BOOST_AUTO_TEST_CASE(SparseNMFALSTest)
       1e-5);
 }
 
+/**
+ * Make sure the parallel products with a sparse matrix are the same as the
+ * ones Armadillo computes.
+ */
+BOOST_AUTO_TEST_CASE(SparseProductsTest)
+{
+  sp_mat v;
+  v.sprandu(50, 30, 0.2);
+  const mat w = randu<mat>(50, 4);
+  const mat h = randu<mat>(4, 30);
+
+  mat product;
+  ProductWithTranspose(v, h, product);
+  BOOST_REQUIRE_EQUAL(product.n_rows, 50);
+  BOOST_REQUIRE_EQUAL(product.n_cols, 4);
+  BOOST_REQUIRE_SMALL(arma::norm(product - mat(v) * h.t(), "fro"), 1e-10);
+
+  TransposeProduct(w, v, product);
+  BOOST_REQUIRE_EQUAL(product.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(product.n_cols, 30);
+  BOOST_REQUIRE_SMALL(arma::norm(product - w.t() * mat(v), "fro"), 1e-10);
+}
+
+/**
+ * Factorize the observed entries of a low-rank matrix with SparseALSUpdate,
+ * and make sure that both the observed and the held out entries are
+ * recovered.
+ */
+BOOST_AUTO_TEST_CASE(SparseALSObservedEntriesTest)
+{
+  const mat w = randu<mat>(60, 3) + 0.5;
+  const mat h = randu<mat>(3, 40) + 0.5;
+  const mat full = w * h;
+
+  // Observe about half of the entries, and at least one in each row and
+  // column.
+  sp_mat v(60, 40);
+  for (size_t j = 0; j < 40; ++j)
+    for (size_t i = 0; i < 60; ++i)
+      if (i % 40 == j || math::Random() < 0.5)
+        v(i, j) = full(i, j);
+
+  SimpleResidueTermination srt(1e-10, 200);
+  AMF<SimpleResidueTermination, RandomAcolInitialization<>, SparseALSUpdate>
+      als(srt, RandomAcolInitialization<>(), SparseALSUpdate(1e-6));
+  mat ow, oh;
+  als.Apply(v, 3, ow, oh);
+
+  const mat reconstruction = ow * oh;
+  double observedError = 0.0, heldOutError = 0.0;
+  size_t heldOut = 0;
+  for (size_t j = 0; j < 40; ++j)
+  {
+    for (size_t i = 0; i < 60; ++i)
+    {
+      const double error = std::pow(reconstruction(i, j) - full(i, j), 2.0);
+      if (v(i, j) != 0.0)
+      {
+        observedError += error;
+      }
+      else
+      {
+        heldOutError += error;
+        ++heldOut;
+      }
+    }
+  }
+
+  BOOST_REQUIRE_SMALL(std::sqrt(observedError / v.n_nonzero), 0.01);
+  BOOST_REQUIRE_SMALL(std::sqrt(heldOutError / heldOut), 0.05);
+}
+
+/**
+ * The systems of SparseALSUpdate are independent, so the factorization must
+ * not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(SparseALSThreadsTest)
+{
+  sp_mat v;
+  v.sprandu(80, 50, 0.3);
+  size_t r = 4;
+
+  arma::mat iw, ih;
+  RandomAcolInitialization<>::Initialize(v, r, iw, ih);
+
+  mat w1, h1, w4, h4;
+  SimpleResidueTermination srt(1e-10, 20);
+  AMF<SimpleResidueTermination, GivenInitialization, SparseALSUpdate> als1(srt,
+      GivenInitialization(iw, ih), SparseALSUpdate(0.05, true, 1));
+  als1.Apply(v, r, w1, h1);
+  AMF<SimpleResidueTermination, GivenInitialization, SparseALSUpdate> als4(srt,
+      GivenInitialization(iw, ih), SparseALSUpdate(0.05, true, 4));
+  als4.Apply(v, r, w4, h4);
+
+  BOOST_REQUIRE_SMALL(arma::norm(w1 - w4, "fro"), 1e-10);
+  BOOST_REQUIRE_SMALL(arma::norm(h1 - h4, "fro"), 1e-10);
+}
+
+/**
+ * Make sure that the updates of ImplicitALSUpdate solve the weighted least
+ * squares problems over all the entries, with the confidences and preferences
+ * of the implicit feedback.
+ */
+BOOST_AUTO_TEST_CASE(ImplicitALSUpdateTest)
+{
+  sp_mat v;
+  v.sprandu(30, 20, 0.2);
+  v *= 5.0;
+  const mat w = randu<mat>(30, 3);
+  const mat h = randu<mat>(3, 20);
+
+  ImplicitALSUpdate update(2.0, 0.1);
+  update.Initialize(v, 3);
+  mat newH(h), newW(w);
+  update.HUpdate(v, w, newH);
+  update.WUpdate(v, newW, h);
+
+  const mat dense(v);
+  for (size_t j = 0; j < v.n_cols; ++j)
+  {
+    const vec confidence = 1.0 + 2.0 * dense.col(j);
+    const vec preference = conv_to<vec>::from(dense.col(j) > 0.0);
+    const mat a = w.t() * diagmat(confidence) * w + 0.1 * eye<mat>(3, 3);
+    const vec expected = solve(a, w.t() * (confidence % preference));
+    for (size_t k = 0; k < 3; ++k)
+      BOOST_REQUIRE_CLOSE(newH(k, j), expected[k], 1e-5);
+  }
+
+  for (size_t i = 0; i < v.n_rows; ++i)
+  {
+    const vec confidence = 1.0 + 2.0 * dense.row(i).t();
+    const vec preference = conv_to<vec>::from(dense.row(i).t() > 0.0);
+    const mat a = h * diagmat(confidence) * h.t() + 0.1 * eye<mat>(3, 3);
+    const vec expected = solve(a, h * (confidence % preference));
+    for (size_t k = 0; k < 3; ++k)
+      BOOST_REQUIRE_CLOSE(newW(i, k), expected[k], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
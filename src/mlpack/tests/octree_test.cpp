@@ -16,6 +16,10 @@
 #include "test_tools.hpp"
 #include "serialization.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::math;
 using namespace mlpack::tree;
@@ -346,4 +350,98 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   delete textTree;
 }
 
+/**
+ * Make sure that two trees have the same structure, the same points in each
+ * node and the same bounds.
+ */
+template<typename TreeType>
+void CheckSameTree(TreeType& node1, TreeType& node2)
+{
+  BOOST_REQUIRE_EQUAL(node1.NumChildren(), node2.NumChildren());
+  BOOST_REQUIRE_EQUAL(node1.NumPoints(), node2.NumPoints());
+  BOOST_REQUIRE_EQUAL(node1.NumDescendants(), node2.NumDescendants());
+  for (size_t i = 0; i < node1.NumDescendants(); ++i)
+    BOOST_REQUIRE_EQUAL(node1.Descendant(i), node2.Descendant(i));
+
+  for (size_t d = 0; d < node1.Bound().Dim(); ++d)
+  {
+    BOOST_REQUIRE_EQUAL(node1.Bound()[d].Lo(), node2.Bound()[d].Lo());
+    BOOST_REQUIRE_EQUAL(node1.Bound()[d].Hi(), node2.Bound()[d].Hi());
+  }
+
+  for (size_t i = 0; i < node1.NumChildren(); ++i)
+    CheckSameTree(node1.Child(i), node2.Child(i));
+}
+
+/**
+ * Make sure that each point of the node is inside of its bound and that the
+ * descendants of the children are those of the node.
+ */
+template<typename TreeType>
+void CheckBounds(TreeType& node)
+{
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+    BOOST_REQUIRE(node.Bound().Contains(
+        node.Dataset().col(node.Descendant(i))));
+
+  size_t descendants = node.NumPoints();
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(node.Child(i).Descendant(0),
+        node.Descendant(descendants));
+    descendants += node.Child(i).NumDescendants();
+    CheckBounds(node.Child(i));
+  }
+
+  BOOST_REQUIRE_EQUAL(descendants, node.NumDescendants());
+}
+
+/**
+ * Build a large 3-dimensional single-precision octree, which is built in
+ * parallel, and make sure that the mappings and the bounds are right and that
+ * the tree is the same as with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelFloatOctreeTest)
+{
+  // Points in a few dense clusters, so that the tree is unbalanced.
+  arma::fmat dataset(3, 200000, arma::fill::randu);
+  dataset.cols(0, 99999) *= 0.01;
+  dataset.cols(100000, 149999) = 0.5 + 0.001 * dataset.cols(100000, 149999);
+
+  std::vector<size_t> oldFromNew;
+  Octree<EuclideanDistance, EmptyStatistic, arma::fmat> t(dataset, oldFromNew,
+      10);
+
+  // Each point should be moved to the position given by the mappings.
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), dataset.n_cols);
+  std::vector<bool> found(dataset.n_cols, false);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_LT(oldFromNew[i], dataset.n_cols);
+    BOOST_REQUIRE(!found[oldFromNew[i]]);
+    found[oldFromNew[i]] = true;
+    for (size_t d = 0; d < 3; ++d)
+      BOOST_REQUIRE_EQUAL(t.Dataset()(d, i), dataset(d, oldFromNew[i]));
+  }
+
+  CheckBounds(t);
+
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  std::vector<size_t> serialOldFromNew;
+  Octree<EuclideanDistance, EmptyStatistic, arma::fmat> serial(dataset,
+      serialOldFromNew, 10);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(oldFromNew[i], serialOldFromNew[i]);
+  CheckSameTree(t, serial);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,186 @@
+/**
+ * @file parallel_test.cpp
+ *
+ * Tests for the control of the number of threads of the parallel regions.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+using namespace mlpack;
+
+BOOST_AUTO_TEST_SUITE(ParallelTest);
+
+#ifdef HAS_OPENMP
+
+/**
+ * Make sure that the global thread limit caps the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(GlobalThreadLimitTest)
+{
+  SetThreadLimit(2);
+  BOOST_REQUIRE_EQUAL(ThreadLimit(), 2);
+  BOOST_REQUIRE_LE(ParallelThreads(), 2);
+  BOOST_REQUIRE_EQUAL(ParallelThreads(1), 1);
+  BOOST_REQUIRE_EQUAL(ParallelThreads(8), 2);
+  BOOST_REQUIRE_LE(omp_get_max_threads(), 2);
+
+  SetThreadLimit(0);
+  BOOST_REQUIRE_EQUAL(ThreadLimit(), 0);
+  BOOST_REQUIRE_EQUAL(ParallelThreads(8), 8);
+  BOOST_REQUIRE_EQUAL(ParallelThreads(), (size_t) omp_get_max_threads());
+}
+
+/**
+ * Make sure that nested scoped limits are restored when they go out of scope.
+ */
+BOOST_AUTO_TEST_CASE(ScopedThreadLimitTest)
+{
+  const int defaultThreads = omp_get_max_threads();
+  {
+    ScopedThreadLimit outer(3);
+    BOOST_REQUIRE_EQUAL(ThreadLimit(), 3);
+    BOOST_REQUIRE_EQUAL(ParallelThreads(8), 3);
+    {
+      ScopedThreadLimit inner(1);
+      BOOST_REQUIRE_EQUAL(ThreadLimit(), 1);
+      BOOST_REQUIRE_EQUAL(ParallelThreads(8), 1);
+      BOOST_REQUIRE_EQUAL(omp_get_max_threads(), 1);
+    }
+    BOOST_REQUIRE_EQUAL(ThreadLimit(), 3);
+    BOOST_REQUIRE_EQUAL(ParallelThreads(8), 3);
+  }
+
+  BOOST_REQUIRE_EQUAL(ThreadLimit(), 0);
+  BOOST_REQUIRE_EQUAL(omp_get_max_threads(), defaultThreads);
+}
+
+/**
+ * Make sure that a scoped limit takes precedence over the global limit.
+ */
+BOOST_AUTO_TEST_CASE(ScopedThreadLimitOverridesGlobalTest)
+{
+  SetThreadLimit(2);
+  {
+    ScopedThreadLimit limit(4);
+    BOOST_REQUIRE_EQUAL(ParallelThreads(8), 4);
+  }
+  BOOST_REQUIRE_EQUAL(ParallelThreads(8), 2);
+  SetThreadLimit(0);
+}
+
+/**
+ * Make sure that no nested teams are started inside of a parallel region.
+ */
+BOOST_AUTO_TEST_CASE(NestedParallelThreadsTest)
+{
+  size_t maxThreads = 0;
+  #pragma omp parallel num_threads(2) reduction(max:maxThreads)
+  {
+    maxThreads = ParallelThreads(8);
+  }
+
+  BOOST_REQUIRE_EQUAL(maxThreads, 1);
+}
+
+#else
+
+/**
+ * Without OpenMP, everything runs in one thread.
+ */
+BOOST_AUTO_TEST_CASE(SerialParallelThreadsTest)
+{
+  SetThreadLimit(4);
+  BOOST_REQUIRE_EQUAL(ParallelThreads(), 1);
+  BOOST_REQUIRE_EQUAL(ParallelThreads(8), 1);
+  SetThreadLimit(0);
+}
+
+#endif
+
+/**
+ * Make sure that ReductionPartials covers every item once, and gives the right
+ * sum with and without deterministic reductions.
+ */
+BOOST_AUTO_TEST_CASE(ReductionPartialsSumTest)
+{
+  const size_t n = 10000;
+  arma::vec values = arma::randu<arma::vec>(n);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    SetDeterministicReductions(mode == 1);
+    BOOST_REQUIRE_EQUAL(DeterministicReductions(), mode == 1);
+
+    ReductionPartials<arma::vec> partials(n, arma::vec(2, arma::fill::zeros));
+    BOOST_REQUIRE_LE(partials.Chunks(),
+        ReductionPartials<arma::vec>::MaxChunks);
+    BOOST_REQUIRE_EQUAL(partials.Begin(0), 0);
+    BOOST_REQUIRE_EQUAL(partials.End(partials.Chunks() - 1), n);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads())
+    for (omp_size_t c = 0; c < (omp_size_t) partials.Chunks(); ++c)
+    {
+      arma::vec& partial = partials.Partial(c);
+      for (size_t i = partials.Begin(c); i < partials.End(c); ++i)
+      {
+        partial[0] += values[i];
+        partial[1] += 1;
+      }
+    }
+
+    arma::vec result;
+    partials.Reduce(result, [](arma::vec& a, const arma::vec& b) { a += b; });
+
+    BOOST_REQUIRE_EQUAL(result[1], (double) n);
+    BOOST_REQUIRE_CLOSE(result[0], arma::accu(values), 1e-8);
+  }
+
+  SetDeterministicReductions(false);
+}
+
+/**
+ * Make sure that deterministic reductions give the same bits for any number of
+ * threads.
+ */
+BOOST_AUTO_TEST_CASE(DeterministicReductionsThreadsTest)
+{
+  const size_t n = 50000;
+  arma::vec values = 1e6 * arma::randn<arma::vec>(n);
+
+  SetDeterministicReductions(true);
+  std::vector<double> sums;
+  for (size_t threads = 1; threads <= 4; ++threads)
+  {
+    ScopedThreadLimit limit(threads);
+    ReductionPartials<double> partials(n, 0.0);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(partials.Threads())
+    for (omp_size_t c = 0; c < (omp_size_t) partials.Chunks(); ++c)
+    {
+      double& partial = partials.Partial(c);
+      for (size_t i = partials.Begin(c); i < partials.End(c); ++i)
+        partial += values[i];
+    }
+
+    double sum;
+    partials.Reduce(sum, [](double& a, const double& b) { a += b; });
+    sums.push_back(sum);
+  }
+  SetDeterministicReductions(false);
+
+  for (size_t i = 1; i < sums.size(); ++i)
+    BOOST_REQUIRE_EQUAL(sums[i], sums[0]);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -13,6 +13,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/pca/pca.hpp>
 #include <mlpack/methods/pca/decomposition_policies/exact_svd_method.hpp>
+#include <mlpack/methods/pca/decomposition_policies/incremental_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/quic_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_block_krylov_method.hpp>
@@ -191,6 +192,15 @@ BOOST_AUTO_TEST_CASE(ArmaComparisonRandomizedPCATest)
   ArmaComparisonPCA<RandomizedSVDPolicy>();
 }
 
+/**
+ * Compare the output of our incremental PCA implementation with Armadillo's.
+ */
+BOOST_AUTO_TEST_CASE(ArmaComparisonIncrementalPCATest)
+{
+  IncrementalSVDPolicy decomposition(64);
+  ArmaComparisonPCA<IncrementalSVDPolicy>(false, decomposition);
+}
+
 /**
  * Test that dimensionality reduction with exact-svd PCA works the same way
  * MATLAB does (which should be correct!).
@@ -220,6 +230,16 @@ BOOST_AUTO_TEST_CASE(RandomizedPCADimensionalityReductionTest)
   PCADimensionalityReduction<RandomizedSVDPolicy>();
 }
 
+/**
+ * Test that dimensionality reduction with incremental PCA, in batches of two
+ * points, works the same way MATLAB does.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalPCADimensionalityReductionTest)
+{
+  IncrementalSVDPolicy decomposition(2);
+  PCADimensionalityReduction<IncrementalSVDPolicy>(false, decomposition);
+}
+
 /**
  * Test that dimensionality reduction with QUIC-SVD PCA works the same way
  * as the Exact-SVD PCA method.
@@ -266,6 +286,66 @@ BOOST_AUTO_TEST_CASE(ExactPCAVarianceRetainedTest)
   PCAVarianceRetained<ExactSVDPolicy>();
 }
 
+/**
+ * Test that setting the variance retained parameter to perform dimensionality
+ * reduction works using the incremental svd PCA method.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalPCAVarianceRetainedTest)
+{
+  PCAVarianceRetained<IncrementalSVDPolicy>();
+}
+
+/**
+ * Feed batches of points to the incremental SVD policy directly, keeping only
+ * a few components, and make sure that the mean, the largest eigenvalues and
+ * the projections are those of the exact PCA.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalPCAStreamingTest)
+{
+  // Points near a 3-dimensional subspace of a 10-dimensional space.
+  arma::mat basis = arma::randn<arma::mat>(10, 3);
+  arma::mat data = basis * (arma::randn<arma::mat>(3, 2000) %
+      arma::repmat(arma::vec("10.0 5.0 2.0"), 1, 2000)) +
+      0.01 * arma::randn<arma::mat>(10, 2000);
+  data.each_col() += arma::linspace<arma::vec>(1, 10, 10);
+
+  IncrementalSVDPolicy ipca(0, 5);
+  for (size_t begin = 0; begin < data.n_cols; begin += 150)
+    ipca.Update(data.cols(begin, std::min(begin + 149,
+        (size_t) data.n_cols - 1)));
+
+  BOOST_REQUIRE_EQUAL(ipca.NumPoints(), 2000);
+  BOOST_REQUIRE_EQUAL(ipca.EigenVectors().n_cols, 5);
+  CheckMatrices(ipca.Mean(), arma::mean(data, 1), 1e-8);
+
+  PCA exact;
+  arma::mat exactTransformed, exactEigvec;
+  arma::vec exactEigval;
+  exact.Apply(data, exactTransformed, exactEigval, exactEigvec);
+
+  const arma::vec eigval = ipca.EigenValues();
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(eigval[i], exactEigval[i], 0.01);
+
+  // The projections onto the main components are the same up to the sign.
+  arma::mat transformed;
+  ipca.Transform(data, transformed);
+  BOOST_REQUIRE_EQUAL(transformed.n_rows, 5);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    const double sign = (arma::dot(transformed.row(i),
+        exactTransformed.row(i)) < 0) ? -1.0 : 1.0;
+    for (size_t j = 0; j < data.n_cols; j += 100)
+    {
+      BOOST_REQUIRE_SMALL(sign * transformed(i, j) - exactTransformed(i, j),
+          0.01);
+    }
+  }
+
+  BOOST_REQUIRE_THROW(ipca.Update(arma::mat(4, 10, arma::fill::randu)),
+      std::invalid_argument);
+}
+
 /**
  * Test that scaling PCA works.
  */
@@ -255,4 +255,149 @@ BOOST_AUTO_TEST_CASE(SecondaryConstructor)
   Perceptron<> p2(p1);
 }
 
+/**
+ * The block update of SimpleWeightUpdate should be the same as the updates of
+ * each point.
+ */
+BOOST_AUTO_TEST_CASE(SimpleWeightUpdateBlock)
+{
+  SimpleWeightUpdate wip;
+
+  mat points(5, 10, fill::randu);
+  mat weights(5, 3, fill::randu);
+  vec biases(3, fill::randu);
+  mat blockWeights(weights);
+  vec blockBiases(biases);
+
+  mat coefficients(3, 10, fill::zeros);
+  for (size_t j = 0; j < points.n_cols; j += 2)
+  {
+    const size_t incorrectClass = j % 3;
+    const size_t correctClass = (j + 1) % 3;
+    const double instanceWeight = 0.5 + j;
+    wip.UpdateWeights(points.col(j), weights, biases, incorrectClass,
+        correctClass, instanceWeight);
+    coefficients(incorrectClass, j) -= instanceWeight;
+    coefficients(correctClass, j) += instanceWeight;
+  }
+
+  wip.UpdateWeights(points, blockWeights, blockBiases, coefficients);
+
+  CheckMatrices(weights, blockWeights);
+  CheckMatrices(biases, blockBiases);
+}
+
+/**
+ * Train the perceptron in blocks on a linearly separable dataset, with and
+ * without averaging.
+ */
+BOOST_AUTO_TEST_CASE(BatchPerceptronSeparableDataset)
+{
+  mat trainData(2, 400);
+  Row<size_t> labels(400);
+  for (size_t i = 0; i < 400; ++i)
+  {
+    labels[i] = i % 2;
+    trainData.col(i) = randu<vec>(2) + 2.0 * labels[i];
+  }
+
+  for (size_t average = 0; average < 2; ++average)
+  {
+    Perceptron<> p(2, 2, 1000);
+    p.BatchSize() = 32;
+    p.Average() = (average == 1);
+    p.Train(trainData, labels, 2);
+
+    BOOST_REQUIRE_EQUAL(p.BatchSize(), 32);
+
+    Row<size_t> predictedLabels;
+    p.Classify(trainData, predictedLabels);
+    BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, labels.n_elem);
+    for (size_t i = 0; i < labels.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(predictedLabels[i], labels[i]);
+  }
+}
+
+/**
+ * The averaged perceptron should still do well on a non-linearly separable
+ * dataset.
+ */
+BOOST_AUTO_TEST_CASE(AveragedPerceptronNonLinearlySeparableDataset)
+{
+  mat trainData;
+  trainData << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8
+            << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << endr
+            << 1 << 1 << 1 << 1 << 1 << 1 << 1 << 1
+            << 2 << 2 << 2 << 2 << 2 << 2 << 2 << 2 << endr;
+
+  Mat<size_t> labels;
+  labels << 0 << 0 << 0 << 1 << 0 << 1 << 1 << 1
+         << 0 << 0 << 0 << 1 << 0 << 1 << 1 << 1;
+
+  Perceptron<> p(2, 2, 1000);
+  p.Average() = true;
+  p.Train(trainData, labels.row(0), 2);
+
+  mat testData;
+  testData << 1 << 2 << 7 << 8 << endr
+           << 1 << 2 << 1 << 2 << endr;
+  Row<size_t> predictedLabels;
+  p.Classify(testData, predictedLabels);
+
+  BOOST_CHECK_EQUAL(predictedLabels(0, 0), 0);
+  BOOST_CHECK_EQUAL(predictedLabels(0, 1), 0);
+  BOOST_CHECK_EQUAL(predictedLabels(0, 2), 1);
+  BOOST_CHECK_EQUAL(predictedLabels(0, 3), 1);
+}
+
+/**
+ * Classify() in blocks should give the same labels as scoring each point.
+ */
+BOOST_AUTO_TEST_CASE(PerceptronBlockClassify)
+{
+  mat trainData(4, 100, fill::randu);
+  Row<size_t> labels(100);
+  for (size_t i = 0; i < 100; ++i)
+    labels[i] = i % 3;
+
+  Perceptron<> p(trainData, labels, 3, 10);
+
+  // More points than a single block.
+  mat testData(4, 2500, fill::randu);
+  Row<size_t> predictedLabels;
+  p.Classify(testData, predictedLabels);
+
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, testData.n_cols);
+  for (size_t i = 0; i < testData.n_cols; ++i)
+  {
+    const vec scores = p.Weights().t() * testData.col(i) + p.Biases();
+    uword maxIndex;
+    scores.max(maxIndex);
+    BOOST_REQUIRE_EQUAL(predictedLabels[i], maxIndex);
+  }
+}
+
+/**
+ * The constructor used by AdaBoost should keep the batch settings.
+ */
+BOOST_AUTO_TEST_CASE(PerceptronWeakLearnerBatchSettings)
+{
+  mat trainData(2, 100, fill::randu);
+  Row<size_t> labels(100);
+  for (size_t i = 0; i < 100; ++i)
+    labels[i] = (trainData(0, i) > 0.5) ? 1 : 0;
+
+  Perceptron<> p(2, 2, 100);
+  p.BatchSize() = 16;
+  p.Average() = true;
+
+  rowvec instanceWeights(100);
+  instanceWeights.fill(0.01);
+  Perceptron<> weak(p, trainData, labels, 2, instanceWeights);
+
+  BOOST_REQUIRE_EQUAL(weak.BatchSize(), 16);
+  BOOST_REQUIRE_EQUAL(weak.Average(), true);
+  BOOST_REQUIRE_EQUAL(weak.Weights().n_cols, 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
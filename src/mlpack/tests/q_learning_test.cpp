@@ -16,6 +16,7 @@
 #include <mlpack/methods/ann/init_rules/gaussian_init.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/reinforcement_learning/q_learning.hpp>
+#include <mlpack/methods/reinforcement_learning/actor.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/mountain_car.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/cart_pole.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
@@ -170,4 +171,238 @@ BOOST_AUTO_TEST_CASE(CartPoleWithDoubleDQN)
   BOOST_REQUIRE(converged);
 }
 
+//! Test DQN with prioritized replay in Cart Pole task.
+BOOST_AUTO_TEST_CASE(CartPoleWithPrioritizedReplay)
+{
+  // As with Double DQN, it is enough if this works 1 of 4 times.
+  size_t episodes = 0;
+  bool converged = false;
+  for (size_t trial = 0; trial < 4; ++trial)
+  {
+    // Set up the network.
+    FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+        GaussianInitialization(0, 0.001));
+    model.Add<Linear<>>(4, 128);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(128, 128);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(128, 2);
+
+    // Set up the policy and replay method.
+    GreedyPolicy<CartPole> policy(1.0, 1000, 0.1);
+    PrioritizedReplay<CartPole> replayMethod(10, 10000, 0.6);
+
+    TrainingConfig config;
+    config.StepSize() = 0.01;
+    config.Discount() = 0.9;
+    config.TargetNetworkSyncInterval() = 100;
+    config.ExplorationSteps() = 100;
+    config.DoubleQLearning() = false;
+    config.StepLimit() = 200;
+
+    // Set up the DQN agent.
+    QLearning<CartPole, decltype(model), AdamUpdate, decltype(policy),
+        decltype(replayMethod)> agent(std::move(config), std::move(model),
+        std::move(policy), std::move(replayMethod));
+
+    arma::running_stat<double> averageReturn;
+
+    for (episodes = 0; episodes <= 1000; ++episodes)
+    {
+      double episodeReturn = agent.Episode();
+      averageReturn(episodeReturn);
+
+      Log::Debug << "Average return: " << averageReturn.mean()
+          << " Episode return: " << episodeReturn << std::endl;
+      if (averageReturn.mean() > 35)
+      {
+        agent.Deterministic() = true;
+        arma::running_stat<double> testReturn;
+        for (size_t i = 0; i < 10; ++i)
+          testReturn(agent.Episode());
+        Log::Debug << "Average return in deterministic test: "
+            << testReturn.mean() << std::endl;
+        break;
+      }
+    }
+
+    if (episodes < 1000)
+    {
+      converged = true;
+      break;
+    }
+  }
+
+  BOOST_REQUIRE(converged);
+}
+
+//! Test DQN with soft updates of the target network in Cart Pole task.
+BOOST_AUTO_TEST_CASE(CartPoleWithSoftTargetUpdates)
+{
+  // As with Double DQN, it is enough if this works 1 of 4 times.
+  size_t episodes = 0;
+  bool converged = false;
+  for (size_t trial = 0; trial < 4; ++trial)
+  {
+    // Set up the network.
+    FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+        GaussianInitialization(0, 0.001));
+    model.Add<Linear<>>(4, 128);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(128, 128);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(128, 2);
+
+    // Set up the policy and replay method.
+    GreedyPolicy<CartPole> policy(1.0, 1000, 0.1);
+    RandomReplay<CartPole> replayMethod(10, 10000);
+
+    TrainingConfig config;
+    config.StepSize() = 0.01;
+    config.Discount() = 0.9;
+    config.TargetNetworkSyncInterval() = 100;
+    config.TargetNetworkUpdateRate() = 0.01;
+    config.ExplorationSteps() = 100;
+    config.DoubleQLearning() = true;
+    config.StepLimit() = 200;
+
+    // Set up the DQN agent.
+    QLearning<CartPole, decltype(model), AdamUpdate, decltype(policy)>
+        agent(std::move(config), std::move(model), std::move(policy),
+            std::move(replayMethod));
+
+    arma::running_stat<double> averageReturn;
+
+    for (episodes = 0; episodes <= 1000; ++episodes)
+    {
+      double episodeReturn = agent.Episode();
+      averageReturn(episodeReturn);
+
+      Log::Debug << "Average return: " << averageReturn.mean()
+          << " Episode return: " << episodeReturn << std::endl;
+      if (averageReturn.mean() > 35)
+        break;
+    }
+
+    if (episodes < 1000)
+    {
+      converged = true;
+      break;
+    }
+  }
+
+  BOOST_REQUIRE(converged);
+}
+
+//! Act in several copies of Cart Pole at once.
+BOOST_AUTO_TEST_CASE(CartPoleWithVectorizedEnvironment)
+{
+  // Set up the network.
+  FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+      GaussianInitialization(0, 0.001));
+  model.Add<Linear<>>(4, 20);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(20, 2);
+
+  // Set up the policy and replay method.
+  GreedyPolicy<CartPole> policy(1.0, 1000, 0.1);
+  RandomReplay<CartPole> replayMethod(10, 10000);
+
+  TrainingConfig config;
+  config.StepSize() = 0.01;
+  config.Discount() = 0.9;
+  config.TargetNetworkSyncInterval() = 100;
+  config.ExplorationSteps() = 100;
+  config.DoubleQLearning() = false;
+  config.StepLimit() = 200;
+
+  QLearning<CartPole, decltype(model), AdamUpdate, decltype(policy)>
+      agent(std::move(config), std::move(model), std::move(policy),
+          std::move(replayMethod));
+
+  VectorizedEnvironment<CartPole> environments(8);
+  double totalReward = 0.0;
+  for (size_t i = 0; i < 50; ++i)
+    totalReward += agent.Step(environments);
+
+  // Each call makes one step in each copy, and each step has reward 1.
+  BOOST_REQUIRE_EQUAL(agent.TotalSteps(), 400);
+  BOOST_REQUIRE_CLOSE(totalReward, 400.0, 1e-5);
+  for (size_t i = 0; i < 8; ++i)
+    BOOST_REQUIRE_LT(environments.Steps()[i], 200);
+}
+
+//! Train a learner on the transitions of several actors in Cart Pole task.
+BOOST_AUTO_TEST_CASE(CartPoleWithActorLearner)
+{
+  // As with Double DQN, it is enough if this works 1 of 4 times.
+  bool converged = false;
+  for (size_t trial = 0; trial < 4 && !converged; ++trial)
+  {
+    // Set up the network.
+    FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+        GaussianInitialization(0, 0.001));
+    model.Add<Linear<>>(4, 128);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(128, 128);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(128, 2);
+    model.ResetParameters();
+
+    TrainingConfig config;
+    config.StepSize() = 0.01;
+    config.Discount() = 0.9;
+    config.TargetNetworkSyncInterval() = 100;
+    config.ExplorationSteps() = 100;
+    config.DoubleQLearning() = false;
+    config.StepLimit() = 200;
+
+    // Each actor explores with its own final exploration rate.
+    typedef Actor<CartPole, decltype(model), GreedyPolicy<CartPole>> ActorType;
+    std::vector<ActorType> actors;
+    for (size_t i = 0; i < 4; ++i)
+    {
+      actors.push_back(ActorType(config, model,
+          GreedyPolicy<CartPole>(1.0, 1000, 0.05 + 0.1 * i)));
+    }
+
+    // The learner does not explore itself.
+    GreedyPolicy<CartPole> policy(0.0, 1, 0.0);
+    RandomReplay<CartPole> replayMethod(32, 10000);
+    QLearning<CartPole, decltype(model), AdamUpdate, decltype(policy)>
+        learner(config, model, std::move(policy), std::move(replayMethod));
+    learner.Deterministic() = true;
+
+    TransitionBatch batch;
+    for (size_t round = 0; round < 500 && !converged; ++round)
+    {
+      for (size_t i = 0; i < actors.size(); ++i)
+      {
+        batch.Clear();
+        actors[i].Act(10, batch);
+        learner.Train(batch, 2);
+      }
+
+      // Broadcast the parameters of the learner.
+      if (round % 5 == 0)
+      {
+        for (size_t i = 0; i < actors.size(); ++i)
+          actors[i].SetParameters(learner.Parameters());
+      }
+
+      if (round % 50 == 49)
+      {
+        arma::running_stat<double> testReturn;
+        for (size_t i = 0; i < 5; ++i)
+          testReturn(learner.Episode());
+        Log::Debug << "Average return in deterministic test: "
+            << testReturn.mean() << std::endl;
+        converged = (testReturn.mean() > 35);
+      }
+    }
+  }
+
+  BOOST_REQUIRE(converged);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
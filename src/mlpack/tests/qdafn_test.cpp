@@ -188,6 +188,43 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
 }
 
 // Make sure QDAFN works with sparse data.
+// Make sure a model saved as an index gives the same results once it is loaded,
+// and that it can be trained again.
+BOOST_AUTO_TEST_CASE(QDAFNIndexTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 300);
+  QDAFN<> qdafn(dataset, 8, 20);
+  qdafn.SaveIndex("qdafn_index.bin");
+
+  QDAFN<> loaded(1, 1);
+  loaded.LoadIndex("qdafn_index.bin");
+  BOOST_REQUIRE_EQUAL(loaded.NumProjections(), qdafn.NumProjections());
+  for (size_t i = 0; i < qdafn.NumProjections(); ++i)
+    CheckMatrices(loaded.CandidateSet(i), qdafn.CandidateSet(i));
+
+  arma::Mat<size_t> neighbors, loadedNeighbors;
+  arma::mat distances, loadedDistances;
+  qdafn.Search(dataset, 5, neighbors, distances);
+  loaded.Search(dataset, 5, loadedNeighbors, loadedDistances);
+  CheckMatrices(loadedNeighbors, neighbors);
+  CheckMatrices(loadedDistances, distances);
+
+  // Training again must not write to the mapped file.
+  arma::mat newDataset = arma::randu<arma::mat>(5, 200);
+  loaded.Train(newDataset, 8, 20);
+  QDAFN<> check(1, 1);
+  check.LoadIndex("qdafn_index.bin");
+  for (size_t i = 0; i < qdafn.NumProjections(); ++i)
+    CheckMatrices(check.CandidateSet(i), qdafn.CandidateSet(i));
+  remove("qdafn_index.bin");
+
+  // A file that isn't an index can't be loaded.
+  data::Save("qdafn_index.csv", dataset);
+  BOOST_REQUIRE_THROW(loaded.LoadIndex("qdafn_index.csv"),
+      std::runtime_error);
+  remove("qdafn_index.csv");
+}
+
 BOOST_AUTO_TEST_CASE(SparseTest)
 {
   arma::sp_mat dataset;
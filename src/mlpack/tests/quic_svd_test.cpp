@@ -83,4 +83,23 @@ BOOST_AUTO_TEST_CASE(QUICSVDSameDimensionTest)
   svd::QUIC_SVD quicsvd(dataset, u, v, sigma);
 }
 
+/**
+ * The reconstruction error should still be small when several nodes of the
+ * cosine tree are split at once.
+ */
+BOOST_AUTO_TEST_CASE(QUICSVDBatchReconstructionError)
+{
+  arma::mat dataset;
+  data::Load("test_data_3_1000.csv", dataset);
+
+  arma::mat u, v, sigma;
+  svd::QUIC_SVD quicsvd(dataset, u, v, sigma, 0.03, 0.1, 8);
+
+  arma::mat reconstruct = u * sigma * v.t();
+
+  double relativeError = arma::norm(dataset - reconstruct, "frob") /
+                         arma::norm(dataset, "frob");
+  BOOST_REQUIRE_SMALL(relativeError, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
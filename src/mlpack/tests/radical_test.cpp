@@ -57,4 +57,52 @@ BOOST_AUTO_TEST_CASE(Radical_Test_Radical3D)
   BOOST_REQUIRE_CLOSE(valBest, valEst, 0.25);
 }
 
+/**
+ * CopyAndPerturb() without noise should stack copies of the data, and should
+ * reuse a matrix that already has the right size.
+ */
+BOOST_AUTO_TEST_CASE(RadicalCopyAndPerturbTest)
+{
+  Radical rad(0.0, 4);
+
+  mat x(50, 2, fill::randu);
+  mat xNew(200, 2);
+  const double* memory = xNew.memptr();
+  rad.CopyAndPerturb(xNew, x);
+
+  BOOST_REQUIRE_EQUAL(xNew.memptr(), memory);
+  BOOST_REQUIRE_EQUAL(xNew.n_rows, 200);
+  BOOST_REQUIRE_EQUAL(xNew.n_cols, 2);
+  for (size_t i = 0; i < 4; ++i)
+    CheckMatrices(mat(xNew.rows(i * 50, (i + 1) * 50 - 1)), x);
+}
+
+/**
+ * Radical2D should find the rotation that separates two rotated uniform
+ * sources.
+ */
+BOOST_AUTO_TEST_CASE(Radical2DRotationTest)
+{
+  mat sources(1000, 2, fill::randu);
+  sources -= 0.5;
+
+  // Rotate the sources by 0.3 radians.
+  const double angle = 0.3;
+  mat rotation(2, 2);
+  rotation(0, 0) = cos(angle);
+  rotation(1, 0) = sin(angle);
+  rotation(0, 1) = -sin(angle);
+  rotation(1, 1) = cos(angle);
+  const mat mixed = sources * rotation;
+
+  // m is only set automatically by DoRadical(), so it is given here (it is
+  // sqrt() of the number of replicated points).
+  Radical rad(0.05, 10, 150, 0, 100);
+  const double theta = rad.DoRadical2D(mixed);
+
+  // The sources are recovered up to a rotation by a multiple of pi / 2.
+  const double error = std::fabs(theta - angle);
+  BOOST_REQUIRE_LT(std::min(error, M_PI / 2 - error), 0.05);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/random_forest/random_forest.hpp>
+#include <mlpack/methods/random_forest/flat_forest.hpp>
 #include <mlpack/methods/decision_tree/random_dimension_select.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -96,6 +97,25 @@ BOOST_AUTO_TEST_CASE(BootstrapWeightsTest)
   }
 }
 
+/**
+ * Make sure the bootstrap indices are in the dataset, and that they are a
+ * sample with replacement.
+ */
+BOOST_AUTO_TEST_CASE(BootstrapIndicesTest)
+{
+  arma::uvec indices;
+  BootstrapIndices(1000, indices);
+
+  BOOST_REQUIRE_EQUAL(indices.n_elem, 1000);
+  for (size_t i = 0; i < indices.n_elem; ++i)
+    BOOST_REQUIRE_LT(indices[i], 1000);
+
+  // A sample of 1000 out of 1000 points has about 632 distinct points.
+  const size_t distinct = arma::unique(indices).eval().n_elem;
+  BOOST_REQUIRE_GT(distinct, 550);
+  BOOST_REQUIRE_LT(distinct, 700);
+}
+
 /**
  * Make sure an empty forest cannot predict.
  */
@@ -153,6 +173,32 @@ BOOST_AUTO_TEST_CASE(UnweightedNumericLearningTest)
   BOOST_REQUIRE_GE(rfCorrect, size_t(0.7 * testDataset.n_cols));
 }
 
+/**
+ * Test numeric learning with histogram-based splits.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericLearningTest)
+{
+  // Load the vc2 dataset.
+  arma::mat dataset;
+  data::Load("vc2.csv", dataset);
+  arma::Row<size_t> labels;
+  data::Load("vc2_labels.txt", labels);
+
+  RandomForest<GiniGain, RandomDimensionSelect, HistogramNumericSplit> rf(
+      dataset, labels, 3, 10 /* 10 trees */, 5);
+
+  arma::mat testDataset;
+  data::Load("vc2_test.csv", testDataset);
+  arma::Row<size_t> testLabels;
+  data::Load("vc2_test_labels.txt", testLabels);
+
+  arma::Row<size_t> rfPredictions;
+  rf.Classify(testDataset, rfPredictions);
+
+  const size_t rfCorrect = arma::accu(rfPredictions == testLabels);
+  BOOST_REQUIRE_GE(rfCorrect, size_t(0.7 * testDataset.n_cols));
+}
+
 /**
  * Test weighted numeric learning, making sure that we get better performance
  * than a single decision tree.
@@ -300,8 +346,9 @@ BOOST_AUTO_TEST_CASE(WeightedCategoricalLearningTest)
 }
 
 /**
- * Test that learning with a leaf size of 1 successfully memorizes the training
- * set.
+ * Test that learning with a leaf size of 1 nearly memorizes the training set.
+ * Each tree only sees its bootstrap sample, so a point may be misclassified if
+ * few trees saw it.
  */
 BOOST_AUTO_TEST_CASE(LeafSize1Test)
 {
@@ -319,11 +366,13 @@ BOOST_AUTO_TEST_CASE(LeafSize1Test)
   rf.Classify(dataset, predictions);
 
   const size_t correct = arma::accu(predictions == labels);
-  BOOST_REQUIRE_EQUAL(correct, dataset.n_cols);
+  BOOST_REQUIRE_GE(correct, size_t(0.95 * dataset.n_cols));
 }
 
 /**
- * Test that a leaf size equal to the dataset size learns nothing.
+ * Test that a leaf size equal to the dataset size learns nothing.  The leaf of
+ * each tree holds the class proportions of its bootstrap sample, so the
+ * averaged probabilities are only close to those of the dataset.
  */
 BOOST_AUTO_TEST_CASE(LeafSizeDatasetTest)
 {
@@ -358,7 +407,7 @@ BOOST_AUTO_TEST_CASE(LeafSizeDatasetTest)
   {
     BOOST_REQUIRE_EQUAL(predictions[i], majorityClass);
     for (size_t j = 0; j < probabilities.n_rows; ++j)
-      BOOST_REQUIRE_CLOSE(probabilities(j, i), majorityProbs[j], 1e-5);
+      BOOST_REQUIRE_SMALL(probabilities(j, i) - majorityProbs[j], 0.05);
   }
 }
 
@@ -395,4 +444,194 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
       binaryProbabilities);
 }
 
+/**
+ * Classifying a set of points in blocks must give the same predictions and
+ * probabilities as classifying each point on its own.
+ */
+BOOST_AUTO_TEST_CASE(BatchClassifyTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  arma::mat trainingData = d.cols(0, 1999);
+  arma::mat testData = d.cols(2000, 3999);
+  arma::Row<size_t> trainingLabels = l.subvec(0, 1999);
+
+  RandomForest<> rf(trainingData, di, trainingLabels, 5, 7 /* 7 trees */, 5);
+
+  arma::Row<size_t> predictions, labelsOnly;
+  arma::mat probabilities;
+  rf.Classify(testData, predictions, probabilities);
+  rf.Classify(testData, labelsOnly);
+  BOOST_REQUIRE_EQUAL(probabilities.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(probabilities.n_cols, testData.n_cols);
+
+  for (size_t i = 0; i < testData.n_cols; ++i)
+  {
+    size_t prediction;
+    arma::vec probs;
+    rf.Classify(testData.col(i), prediction, probs);
+
+    BOOST_REQUIRE_EQUAL(predictions[i], prediction);
+    BOOST_REQUIRE_EQUAL(labelsOnly[i], prediction);
+    for (size_t c = 0; c < probs.n_elem; ++c)
+      BOOST_REQUIRE_CLOSE(probabilities(c, i), probs[c], 1e-5);
+  }
+}
+
+/**
+ * A FlatForest must give the same predictions and probabilities as the random
+ * forest and the decision tree it is built from, on categorical data.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  arma::mat trainingData = d.cols(0, 1999);
+  arma::mat testData = d.cols(2000, 3999);
+  arma::Row<size_t> trainingLabels = l.subvec(0, 1999);
+
+  RandomForest<> rf(trainingData, di, trainingLabels, 5, 10 /* 10 trees */, 5);
+  DecisionTree<> dt(trainingData, di, trainingLabels, 5, 5);
+
+  FlatForest flatRF(rf);
+  FlatForest flatDT(dt);
+  BOOST_REQUIRE_EQUAL(flatRF.NumTrees(), 10);
+  BOOST_REQUIRE_EQUAL(flatDT.NumTrees(), 1);
+  BOOST_REQUIRE_EQUAL(flatRF.NumClasses(), 5);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+  rf.Classify(testData, predictions, probabilities);
+  flatRF.Classify(testData, flatPredictions, flatProbabilities);
+  CheckMatrices(predictions, flatPredictions);
+  CheckMatrices(probabilities, flatProbabilities);
+
+  dt.Classify(testData, predictions, probabilities);
+  flatDT.Classify(testData, flatPredictions, flatProbabilities);
+  CheckMatrices(predictions, flatPredictions);
+  CheckMatrices(probabilities, flatProbabilities);
+}
+
+/**
+ * A FlatForest must give the same predictions as a random forest with
+ * histogram-based numeric splits.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestNumericTest)
+{
+  arma::mat dataset;
+  if (!data::Load("vc2.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  RandomForest<GiniGain, MultipleRandomDimensionSelect<>,
+      HistogramNumericSplit> rf(dataset, labels, 3, 20 /* 20 trees */, 1);
+  FlatForest flat(rf);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  rf.Classify(dataset, predictions);
+  flat.Classify(dataset, flatPredictions);
+  CheckMatrices(predictions, flatPredictions);
+
+  // An empty FlatForest can't classify.
+  FlatForest empty;
+  BOOST_REQUIRE_THROW(empty.Classify(dataset, flatPredictions),
+      std::invalid_argument);
+}
+
+/**
+ * A random forest trained on the bins of a FeatureBinning must classify the
+ * original data, after its splits are mapped, as it classifies the bins.
+ */
+BOOST_AUTO_TEST_CASE(BinnedTrainingTest)
+{
+  arma::mat dataset;
+  if (!data::Load("vc2.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+  arma::mat testDataset;
+  if (!data::Load("vc2_test.csv", testDataset))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+  arma::Row<size_t> testLabels;
+  if (!data::Load("vc2_test_labels.txt", testLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  data::FeatureBinning binning(32);
+  binning.Fit(dataset);
+  arma::Mat<uint8_t> bins, testBins;
+  binning.Transform(dataset, bins);
+  binning.Transform(testDataset, testBins);
+
+  RandomForest<GiniGain, RandomDimensionSelect, HistogramNumericSplit> rf(
+      bins, labels, 3, 10 /* 10 trees */, 5);
+
+  arma::Row<size_t> binPredictions, binTestPredictions;
+  rf.Classify(bins, binPredictions);
+  rf.Classify(testBins, binTestPredictions);
+
+  rf.MapBinnedSplits(binning);
+  arma::Row<size_t> predictions, testPredictions;
+  rf.Classify(dataset, predictions);
+  rf.Classify(testDataset, testPredictions);
+  CheckMatrices(predictions, binPredictions);
+  CheckMatrices(testPredictions, binTestPredictions);
+
+  const size_t correct = arma::accu(testPredictions == testLabels);
+  BOOST_REQUIRE_GE(correct, size_t(0.7 * testDataset.n_cols));
+
+  // The flattened forest gives the same predictions.
+  FlatForest flat(rf);
+  arma::Row<size_t> flatPredictions;
+  flat.Classify(testDataset, flatPredictions);
+  CheckMatrices(flatPredictions, testPredictions);
+}
+
+/**
+ * Test numeric learning on single-precision data.
+ */
+BOOST_AUTO_TEST_CASE(FloatNumericLearningTest)
+{
+  arma::mat dataset;
+  data::Load("vc2.csv", dataset);
+  arma::Row<size_t> labels;
+  data::Load("vc2_labels.txt", labels);
+  arma::mat testDataset;
+  data::Load("vc2_test.csv", testDataset);
+  arma::Row<size_t> testLabels;
+  data::Load("vc2_test_labels.txt", testLabels);
+
+  const arma::fmat floatDataset = arma::conv_to<arma::fmat>::from(dataset);
+  const arma::fmat floatTestDataset =
+      arma::conv_to<arma::fmat>::from(testDataset);
+
+  RandomForest<> rf(floatDataset, labels, 3, 10 /* 10 trees */, 5);
+
+  arma::Row<size_t> predictions;
+  rf.Classify(floatTestDataset, predictions);
+  const size_t correct = arma::accu(predictions == testLabels);
+  BOOST_REQUIRE_GE(correct, size_t(0.7 * testDataset.n_cols));
+
+  // A decision tree trained on the indices of the points gives the same
+  // predictions for single- and double-precision points of the same values.
+  arma::uvec indices = arma::regspace<arma::uvec>(0, dataset.n_cols - 1);
+  DecisionTree<> tree;
+  tree.Train<false, false>(floatDataset, indices, data::DatasetInfo(),
+      labels, 3, arma::rowvec(), 5);
+  arma::Row<size_t> floatPredictions;
+  tree.Classify(floatTestDataset, floatPredictions);
+  tree.Classify(arma::conv_to<arma::mat>::from(floatTestDataset),
+      predictions);
+  CheckMatrices(floatPredictions, predictions);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
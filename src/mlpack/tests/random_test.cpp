@@ -97,4 +97,83 @@ BOOST_AUTO_TEST_CASE(WeightedRandomTest)
   }
 }
 
+/**
+ * Make sure that a RandomStream depends only on its seed and stream index, and
+ * that different streams differ.
+ */
+BOOST_AUTO_TEST_CASE(RandomStreamTest)
+{
+  RandomStream a(42, 3), b(42, 3), c(42, 4), d(43, 3);
+  bool differentStream = false, differentSeed = false;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    const uint64_t x = a();
+    BOOST_REQUIRE_EQUAL(x, b());
+    differentStream |= (x != c());
+    differentSeed |= (x != d());
+  }
+  BOOST_REQUIRE(differentStream);
+  BOOST_REQUIRE(differentSeed);
+
+  // Discard() skips numbers without generating them.
+  RandomStream e(42, 3);
+  e.Discard(100);
+  BOOST_REQUIRE_EQUAL(e(), a());
+
+  // The uniform and normal numbers have the right moments.
+  RandomStream f(7, 0);
+  arma::vec uniform(20000), normal(20000);
+  for (size_t i = 0; i < uniform.n_elem; ++i)
+  {
+    uniform[i] = f.Random();
+    normal[i] = f.RandNormal();
+    BOOST_REQUIRE_GE(uniform[i], 0.0);
+    BOOST_REQUIRE_LT(uniform[i], 1.0);
+  }
+  BOOST_REQUIRE_SMALL(arma::mean(uniform) - 0.5, 0.02);
+  BOOST_REQUIRE_SMALL(arma::mean(normal), 0.05);
+  BOOST_REQUIRE_SMALL(arma::var(normal) - 1.0, 0.05);
+}
+
+/**
+ * Make sure that the random functions draw from the stream of an active
+ * RandomStreamScope, in parallel regions too, so the numbers of each task do
+ * not depend on the thread that runs it.
+ */
+BOOST_AUTO_TEST_CASE(RandomStreamScopeTest)
+{
+  const size_t tasks = 64;
+  arma::mat numbers(10, tasks);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) tasks; ++i)
+  {
+    RandomStream stream(5, i);
+    RandomStreamScope scope(stream);
+    for (size_t j = 0; j < numbers.n_rows; ++j)
+      numbers(j, i) = Random();
+  }
+
+  for (size_t i = 0; i < tasks; ++i)
+  {
+    RandomStream stream(5, i);
+    for (size_t j = 0; j < numbers.n_rows; ++j)
+      BOOST_REQUIRE_EQUAL(numbers(j, i), stream.Random());
+  }
+
+  // A scope does not draw from the global generator, which is used again
+  // after the scope.
+  RandomSeed(10);
+  Random();
+  const double x = Random();
+  RandomSeed(10);
+  Random();
+  {
+    RandomStream stream(5, 0);
+    RandomStreamScope scope(stream);
+    Random();
+  }
+  BOOST_REQUIRE_EQUAL(Random(), x);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -64,4 +64,38 @@ BOOST_AUTO_TEST_CASE(RandomizedSVDReconstructionError)
   BOOST_REQUIRE_SMALL(error, 1e-5);
 }
 
+/**
+ * Make sure that the SVD computed over blocks of columns of the data is the
+ * one computed with the whole matrix, for a wide and a tall matrix.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedSVDBlocksTest)
+{
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    arma::mat data = arma::randn<arma::mat>(20, 5) *
+        arma::randn<arma::mat>(5, 60);
+    if (trial == 1)
+      data = arma::mat(data.t());
+
+    data::MatrixColumnBlocks<> blocks(data, 7);
+
+    arma::mat U1, U2, V1, V2;
+    arma::vec s1, s2;
+
+    // With the same random matrix, the results are the same.
+    svd::RandomizedSVD rSVD(0, 3);
+    math::RandomSeed(42);
+    rSVD.Apply(data, U1, s1, V1, 5);
+    math::RandomSeed(42);
+    rSVD.ApplyBlocks(blocks, U2, s2, V2, 5);
+
+    BOOST_REQUIRE_EQUAL(s1.n_elem, s2.n_elem);
+    for (size_t i = 0; i < s1.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(s1[i], s2[i], 1e-5);
+
+    CheckMatrices(U1 * arma::diagmat(s1) * V1.t(),
+        U2 * arma::diagmat(s2) * V2.t(), 1e-4);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
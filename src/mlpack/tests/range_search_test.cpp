@@ -13,6 +13,7 @@
 #include <mlpack/methods/range_search/range_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/methods/range_search/rs_model.hpp>
+#include <mlpack/methods/range_search/whitened_range_search.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -1334,6 +1335,106 @@ BOOST_AUTO_TEST_CASE(RSModelTest)
   }
 }
 
+/**
+ * Check range search results in single precision against the exact distances,
+ * allowing for the rounding of distances that are close to the ends of the
+ * range.
+ */
+void CheckSinglePrecisionResults(const arma::mat& querySet,
+                                 const arma::mat& referenceSet,
+                                 const math::Range& range,
+                                 const bool sameSet,
+                                 const vector<vector<size_t>>& neighbors,
+                                 const vector<vector<double>>& distances)
+{
+  const double tolerance = 1e-5;
+  BOOST_REQUIRE_EQUAL(neighbors.size(), querySet.n_cols);
+  BOOST_REQUIRE_EQUAL(distances.size(), querySet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[q].size(), distances[q].size());
+    vector<bool> found(referenceSet.n_cols, false);
+    for (size_t j = 0; j < neighbors[q].size(); ++j)
+    {
+      const size_t r = neighbors[q][j];
+      BOOST_REQUIRE_LT(r, referenceSet.n_cols);
+      BOOST_REQUIRE(!found[r]);
+      found[r] = true;
+
+      const double distance = EuclideanDistance::Evaluate(querySet.col(q),
+          referenceSet.col(r));
+      BOOST_REQUIRE_SMALL(distances[q][j] - distance, tolerance);
+      BOOST_REQUIRE_GE(distance, range.Lo() - tolerance);
+      BOOST_REQUIRE_LE(distance, range.Hi() + tolerance);
+    }
+
+    for (size_t r = 0; r < referenceSet.n_cols; ++r)
+    {
+      if (sameSet && r == q)
+        continue;
+      const double distance = EuclideanDistance::Evaluate(querySet.col(q),
+          referenceSet.col(r));
+      if (distance > range.Lo() + tolerance &&
+          distance < range.Hi() - tolerance)
+        BOOST_REQUIRE(found[r]);
+    }
+  }
+}
+
+/**
+ * Make sure that kd-tree, ball tree and octree models built in single
+ * precision find the right points.
+ */
+BOOST_AUTO_TEST_CASE(RSModelSinglePrecisionTest)
+{
+  arma::fmat singleQueryData = arma::randu<arma::fmat>(3, 100);
+  arma::fmat singleReferenceData = arma::randu<arma::fmat>(3, 1000);
+  const arma::mat queryData = arma::conv_to<arma::mat>::from(singleQueryData);
+  const arma::mat referenceData =
+      arma::conv_to<arma::mat>::from(singleReferenceData);
+  const math::Range range(0.1, 0.3);
+
+  const RSModel::TreeTypes treeTypes[] = { RSModel::TreeTypes::KD_TREE,
+      RSModel::TreeTypes::BALL_TREE, RSModel::TreeTypes::OCTREE };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t singleMode = 0; singleMode < 2; ++singleMode)
+    {
+      RSModel model(treeTypes[i], false);
+      arma::fmat referenceCopy(singleReferenceData);
+      model.BuildModel(std::move(referenceCopy), 10, false, singleMode == 1);
+
+      BOOST_REQUIRE(model.SinglePrecision());
+      BOOST_REQUIRE_EQUAL(model.SinglePrecisionDataset().n_cols, 1000);
+      BOOST_REQUIRE_THROW(model.Dataset(), std::invalid_argument);
+
+      vector<vector<size_t>> neighbors;
+      vector<vector<double>> distances;
+
+      // Query sets in either precision are accepted.
+      arma::mat queryCopy(queryData);
+      model.Search(std::move(queryCopy), range, neighbors, distances);
+      CheckSinglePrecisionResults(queryData, referenceData, range, false,
+          neighbors, distances);
+
+      arma::fmat singleQueryCopy(singleQueryData);
+      model.Search(std::move(singleQueryCopy), range, neighbors, distances);
+      CheckSinglePrecisionResults(queryData, referenceData, range, false,
+          neighbors, distances);
+
+      model.Search(range, neighbors, distances);
+      CheckSinglePrecisionResults(referenceData, referenceData, range, true,
+          neighbors, distances);
+    }
+  }
+
+  // Other tree types can't be built in single precision.
+  RSModel coverModel(RSModel::TreeTypes::COVER_TREE, false);
+  arma::fmat referenceCopy(singleReferenceData);
+  BOOST_REQUIRE_THROW(coverModel.BuildModel(std::move(referenceCopy), 10,
+      false, false), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(RSModelMonochromaticTest)
 {
   // Ensure that we can build an RSModel and get correct results.
@@ -1696,4 +1797,150 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+/**
+ * Check that the callback and count-only searches of the given RangeSearch
+ * object find the same results as the regular search, for both the
+ * bichromatic and the monochromatic case.
+ */
+template<typename RangeSearchType>
+void CheckCallbackAndCount(RangeSearchType& rs,
+                           const arma::mat& queries,
+                           const math::Range& range)
+{
+  for (size_t mono = 0; mono < 2; ++mono)
+  {
+    const size_t numQueries = mono ? rs.ReferenceSet().n_cols : queries.n_cols;
+
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    if (mono)
+      rs.Search(range, neighbors, distances);
+    else
+      rs.Search(queries, range, neighbors, distances);
+
+    // Collect the results given to the callback.
+    vector<vector<size_t>> callbackNeighbors(numQueries);
+    vector<vector<double>> callbackDistances(numQueries);
+    auto collect = [&](const size_t q, const size_t r, const double d)
+    {
+      callbackNeighbors[q].push_back(r);
+      callbackDistances[q].push_back(d);
+    };
+    if (mono)
+      rs.Search(range, collect);
+    else
+      rs.Search(queries, range, collect);
+
+    arma::Col<size_t> counts;
+    if (mono)
+      rs.Count(range, counts);
+    else
+      rs.Count(queries, range, counts);
+
+    vector<vector<pair<double, size_t>>> sorted, callbackSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(callbackNeighbors, callbackDistances, callbackSorted);
+
+    BOOST_REQUIRE_EQUAL(sorted.size(), numQueries);
+    BOOST_REQUIRE_EQUAL(callbackSorted.size(), numQueries);
+    BOOST_REQUIRE_EQUAL(counts.n_elem, numQueries);
+    for (size_t i = 0; i < numQueries; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(callbackSorted[i].size(), sorted[i].size());
+      BOOST_REQUIRE_EQUAL(counts[i], sorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(callbackSorted[i][j].second, sorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(callbackSorted[i][j].first, sorted[i][j].first,
+            1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that the callback and count-only searches give the same results as
+ * the regular search, with different trees and search modes.
+ */
+BOOST_AUTO_TEST_CASE(CallbackAndCountTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 400);
+  arma::mat queries = arma::randu<arma::mat>(3, 200);
+  const math::Range range(0.1, 0.35);
+
+  RangeSearch<> dual(data);
+  CheckCallbackAndCount(dual, queries, range);
+
+  RangeSearch<> single(data, false, true);
+  CheckCallbackAndCount(single, queries, range);
+
+  RangeSearch<> naive(data, true);
+  CheckCallbackAndCount(naive, queries, range);
+
+  RangeSearch<EuclideanDistance, arma::mat, StandardCoverTree> cover(data);
+  CheckCallbackAndCount(cover, queries, range);
+
+  RangeSearch<EuclideanDistance, arma::mat, BallTree> ball(data);
+  CheckCallbackAndCount(ball, queries, range);
+
+  // A range that contains every point is handled by the node-level results.
+  CheckCallbackAndCount(dual, queries, math::Range(0.0, 10.0));
+}
+
+/**
+ * Make sure that WhitenedRangeSearch finds the same points as a brute-force
+ * search with the Mahalanobis distance, with rooted and squared distances.
+ */
+BOOST_AUTO_TEST_CASE(WhitenedMahalanobisRangeSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 200);
+  arma::mat queryData = arma::randu<arma::mat>(3, 40);
+  arma::mat a = arma::randu<arma::mat>(3, 3);
+  arma::mat covariance = a * a.t() + 0.1 * arma::eye<arma::mat>(3, 3);
+
+  MahalanobisDistance<true> mahalanobis(covariance);
+  MahalanobisDistance<false> squared(covariance);
+  const math::Range range(0.2, 0.6);
+  const math::Range squaredRange(0.04, 0.36);
+
+  WhitenedRangeSearch<> rs(referenceData, false, false, mahalanobis);
+  WhitenedRangeSearch<false> squaredRs(referenceData, false, true, squared);
+
+  vector<vector<size_t>> neighbors, squaredNeighbors;
+  vector<vector<double>> distances, squaredDistances;
+  rs.Search(queryData, range, neighbors, distances);
+  squaredRs.Search(queryData, squaredRange, squaredNeighbors,
+      squaredDistances);
+
+  vector<vector<pair<double, size_t>>> sorted, squaredSorted;
+  SortResults(neighbors, distances, sorted);
+  SortResults(squaredNeighbors, squaredDistances, squaredSorted);
+
+  BOOST_REQUIRE_EQUAL(sorted.size(), queryData.n_cols);
+  BOOST_REQUIRE_EQUAL(squaredSorted.size(), queryData.n_cols);
+  for (size_t q = 0; q < queryData.n_cols; ++q)
+  {
+    vector<pair<double, size_t>> expected;
+    for (size_t r = 0; r < referenceData.n_cols; ++r)
+    {
+      const double d = mahalanobis.Evaluate(queryData.col(q),
+          referenceData.col(r));
+      if (range.Contains(d))
+        expected.push_back(make_pair(d, r));
+    }
+    sort(expected.begin(), expected.end());
+
+    BOOST_REQUIRE_EQUAL(sorted[q].size(), expected.size());
+    BOOST_REQUIRE_EQUAL(squaredSorted[q].size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(sorted[q][i].second, expected[i].second);
+      BOOST_REQUIRE_CLOSE(sorted[q][i].first, expected[i].first, 1e-5);
+      BOOST_REQUIRE_EQUAL(squaredSorted[q][i].second, expected[i].second);
+      BOOST_REQUIRE_CLOSE(squaredSorted[q][i].first,
+          expected[i].first * expected[i].first, 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1384,4 +1384,181 @@ BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * A function to count the leaves of a tree.
+ */
+template<typename TreeType>
+size_t CountLeaves(const TreeType& tree)
+{
+  if (tree.IsLeaf())
+    return 1;
+
+  size_t numLeaves = 0;
+  for (size_t i = 0; i < tree.NumChildren(); i++)
+    numLeaves += CountLeaves(tree.Child(i));
+
+  return numLeaves;
+}
+
+/**
+ * Bulk load a tree of the given type, check that it is valid, and check that
+ * nearest neighbor search with the tree gives the same results as naive
+ * search.  If packed is true, the tree must have as few leaves as possible.
+ */
+template<template<typename, typename, typename> class TreeType>
+void CheckBulkLoadedTree(const bool packed)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1003); // 1003 points in 8 dimensions.
+
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+  Tree tree(dataset, BulkLoadTag(), 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1003);
+
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+  BOOST_REQUIRE_EQUAL(tree.TreeDepth(), GetMinLevel(tree));
+
+  if (packed)
+  {
+    // 1003 points need 51 leaves of at most 20 points.
+    CheckFills(tree);
+    BOOST_REQUIRE_EQUAL(CountLeaves(tree), 51);
+  }
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      TreeType> knn1(std::move(tree), SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
+// Test that bulk loading gives valid, packed trees for the tree types that
+// allow overlapping nodes.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadTest)
+{
+  CheckBulkLoadedTree<RTree>(true);
+  CheckBulkLoadedTree<RStarTree>(true);
+  CheckBulkLoadedTree<XTree>(true);
+}
+
+// Bulk loading Hilbert R trees, R+ trees and R++ trees only orders the points
+// before inserting them, so the trees must keep their own properties.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadOrderedTest)
+{
+  CheckBulkLoadedTree<HilbertRTree>(false);
+  CheckBulkLoadedTree<RPlusTree>(false);
+  CheckBulkLoadedTree<RPlusPlusTree>(false);
+
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> HilbertTreeType;
+  HilbertTreeType hilbertRTree(dataset, BulkLoadTag(), 20, 6, 5, 2);
+
+  CheckHilbertOrdering(hilbertRTree);
+  CheckDiscreteHilbertValueSync(hilbertRTree);
+  CheckHilbertValue(hilbertRTree);
+
+  typedef RPlusTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> RPlusTreeType;
+  RPlusTreeType rPlusTree(dataset, BulkLoadTag(), 20, 6, 5, 2);
+
+  CheckOverlap(rPlusTree);
+
+  typedef RPlusPlusTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> RPlusPlusTreeType;
+  RPlusPlusTreeType rPlusPlusTree(dataset, BulkLoadTag(), 20, 6, 5, 2);
+
+  CheckRPlusPlusTreeBound(rPlusPlusTree);
+}
+
+// Points can be deleted from a bulk loaded tree as usual.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadDeletionTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  arma::mat querySet;
+  querySet.randu(8, 200);
+
+  const int numIter = 50;
+
+  typedef RTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, BulkLoadTag(), 20, 6, 5, 2);
+
+  for (int i = 0; i < numIter; i++)
+    tree.DeletePoint(999 - i);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000 - numIter);
+
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckNumDescendants(tree);
+  CheckFills(tree);
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      RTree> knn1(std::move(tree), SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  knn1.Search(querySet, 5, neighbors1, distances1);
+
+  arma::mat newDataset;
+  newDataset = dataset;
+  newDataset.resize(8, 1000 - numIter);
+
+  KNN knn2(newDataset, NAIVE_MODE);
+
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+  knn2.Search(querySet, 5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+  }
+}
+
+// Bulk loading an empty dataset or a dataset that fits in one leaf should give
+// a single leaf.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadSmallTest)
+{
+  typedef RTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(3, 15);
+  TreeType tree(dataset, BulkLoadTag());
+
+  BOOST_REQUIRE(tree.IsLeaf());
+  BOOST_REQUIRE_EQUAL(tree.NumPoints(), 15);
+  CheckExactContainment(tree);
+
+  arma::mat empty(3, 0);
+  TreeType emptyTree(empty, BulkLoadTag());
+
+  BOOST_REQUIRE(emptyTree.IsLeaf());
+  BOOST_REQUIRE_EQUAL(emptyTree.NumDescendants(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -742,6 +742,208 @@ BOOST_AUTO_TEST_CASE(GRUDistractedSequenceRecallTest)
   DistractedSequenceRecallTestNetwork<GRU<>>();
 }
 
+/**
+ * Make sure that the batch versions of Evaluate() and Gradient() of an LSTM
+ * network give the sums of the objectives and gradients of the single
+ * sequences.
+ */
+BOOST_AUTO_TEST_CASE(RNNBatchEvaluateGradientTest)
+{
+  const size_t rho = 5;
+  arma::mat input = arma::randu<arma::mat>(2 * rho, 12);
+  arma::mat target = arma::randu<arma::mat>(3 * rho, 12);
+
+  RNN<MeanSquaredError<> > model(input, target, rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(2, 6);
+  model.Add<LSTM<> >(6, 4);
+  model.Add<Linear<> >(4, 3);
+  model.Add<SigmoidLayer<> >();
+
+  const size_t begin = 2;
+  const size_t batchSize = 8;
+
+  double objective = 0;
+  arma::mat gradient, pointGradient;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+  {
+    objective += model.Evaluate(model.Parameters(), i);
+    model.Gradient(model.Parameters(), i, pointGradient);
+    if (i == begin)
+      gradient = pointGradient;
+    else
+      gradient += pointGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), begin, batchSize),
+      objective, 1e-5);
+
+  arma::mat batchGradient;
+  model.Gradient(model.Parameters(), begin, batchGradient, batchSize);
+  CheckMatrices(batchGradient, gradient);
+
+  // Going back to single sequences must work too.
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), begin),
+      model.Evaluate(model.Parameters(), begin, size_t(1)), 1e-5);
+}
+
+/**
+ * Make sure that the padding of sequences of different lengths does not
+ * change the objective or the gradient, and that batches of such sequences
+ * give the same results as the sequences on their own.
+ */
+BOOST_AUTO_TEST_CASE(RNNVariableLengthTest)
+{
+  const size_t rho = 6;
+  arma::mat input = arma::randu<arma::mat>(2 * rho, 8);
+  arma::mat target = arma::randu<arma::mat>(3 * rho, 8);
+  arma::Row<size_t> lengths("2 6 3 1 4 6 5 2");
+
+  // The same data with other padding.
+  arma::mat otherInput = input;
+  arma::mat otherTarget = target;
+  for (size_t i = 0; i < lengths.n_elem; ++i)
+  {
+    if (lengths[i] == rho)
+      continue;
+
+    otherInput.submat(2 * lengths[i], i, 2 * rho - 1, i).randu();
+    otherTarget.submat(3 * lengths[i], i, 3 * rho - 1, i).randu();
+  }
+
+  RNN<MeanSquaredError<> > model(input, target, rho);
+  RNN<MeanSquaredError<> > otherModel(otherInput, otherTarget, rho);
+  for (RNN<MeanSquaredError<> >* m : { &model, &otherModel })
+  {
+    m->Add<IdentityLayer<> >();
+    m->Add<Linear<> >(2, 6);
+    m->Add<LSTM<> >(6, 4, rho);
+    m->Add<Linear<> >(4, 3);
+    m->Add<SigmoidLayer<> >();
+  }
+
+  // Initialize the parameters of the second model, then use the same ones.
+  otherModel.Evaluate(otherModel.Parameters(), 0);
+  model.Evaluate(model.Parameters(), 0);
+  otherModel.Parameters() = model.Parameters();
+
+  model.SequenceLengths() = lengths;
+  otherModel.SequenceLengths() = lengths;
+
+  const size_t begin = 0;
+  const size_t batchSize = 8;
+
+  double objective = 0;
+  arma::mat gradient, pointGradient;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+  {
+    objective += model.Evaluate(model.Parameters(), i);
+    model.Gradient(model.Parameters(), i, pointGradient);
+    if (i == begin)
+      gradient = pointGradient;
+    else
+      gradient += pointGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), begin, batchSize),
+      objective, 1e-5);
+  BOOST_REQUIRE_CLOSE(otherModel.Evaluate(otherModel.Parameters(), begin,
+      batchSize), objective, 1e-5);
+
+  arma::mat batchGradient, otherGradient;
+  model.Gradient(model.Parameters(), begin, batchGradient, batchSize);
+  otherModel.Gradient(otherModel.Parameters(), begin, otherGradient,
+      batchSize);
+  CheckMatrices(batchGradient, gradient);
+  CheckMatrices(otherGradient, gradient);
+
+  // Sequences that span all time steps give the same results as without
+  // lengths.
+  const size_t fullIndex = 1;
+  const double fullObjective = model.Evaluate(model.Parameters(), fullIndex);
+  model.SequenceLengths().reset();
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), fullIndex),
+      fullObjective, 1e-5);
+
+  // Lengths that do not fit the data are rejected.
+  StandardSGD opt;
+  BOOST_REQUIRE_THROW(model.Train(input, target, arma::Row<size_t>("1 2"),
+      opt), std::invalid_argument);
+  lengths[3] = rho + 1;
+  BOOST_REQUIRE_THROW(model.Train(input, target, lengths, opt),
+      std::invalid_argument);
+}
+
+/**
+ * Check that the gradient of the given model does not change if the
+ * activations are recomputed during the backward pass.
+ */
+void CheckRecomputeGradient(RNN<MeanSquaredError<> >& model)
+{
+  const size_t begin = 1;
+  const size_t batchSize = 4;
+
+  arma::mat gradient, recomputeGradient;
+  model.Gradient(model.Parameters(), begin, gradient, batchSize);
+
+  model.Recompute() = true;
+  model.Gradient(model.Parameters(), begin, recomputeGradient, batchSize);
+  CheckMatrices(recomputeGradient, gradient);
+
+  // Single sequences must work too.
+  model.Gradient(model.Parameters(), begin, recomputeGradient);
+  model.Recompute() = false;
+  model.Gradient(model.Parameters(), begin, gradient);
+  CheckMatrices(recomputeGradient, gradient);
+}
+
+/**
+ * Make sure that recomputing the activations during the backward pass gives
+ * the same gradient as storing them, for all of the recurrent layers.
+ */
+BOOST_AUTO_TEST_CASE(RNNRecomputeGradientTest)
+{
+  const size_t rho = 5;
+  arma::mat input = arma::randu<arma::mat>(2 * rho, 6);
+  arma::mat target = arma::randu<arma::mat>(3 * rho, 6);
+
+  RNN<MeanSquaredError<> > lstmModel(input, target, rho);
+  lstmModel.Add<IdentityLayer<> >();
+  lstmModel.Add<Linear<> >(2, 6);
+  lstmModel.Add<LSTM<> >(6, 4, rho);
+  lstmModel.Add<Linear<> >(4, 3);
+  lstmModel.Add<SigmoidLayer<> >();
+  CheckRecomputeGradient(lstmModel);
+
+  RNN<MeanSquaredError<> > gruModel(input, target, rho);
+  gruModel.Add<IdentityLayer<> >();
+  gruModel.Add<Linear<> >(2, 6);
+  gruModel.Add<GRU<> >(6, 4, rho);
+  gruModel.Add<Linear<> >(4, 3);
+  gruModel.Add<SigmoidLayer<> >();
+  CheckRecomputeGradient(gruModel);
+
+  RNN<MeanSquaredError<> > fastModel(input, target, rho);
+  fastModel.Add<IdentityLayer<> >();
+  fastModel.Add<FastLSTM<> >(2, 4, rho);
+  fastModel.Add<Linear<> >(4, 3);
+  fastModel.Add<SigmoidLayer<> >();
+  CheckRecomputeGradient(fastModel);
+
+  Add<> add(4);
+  Linear<> lookup(2, 4);
+  SigmoidLayer<> sigmoidLayer;
+  Linear<> linear(4, 4);
+  Recurrent<> recurrent(add, lookup, linear, sigmoidLayer, rho);
+
+  RNN<MeanSquaredError<> > recurrentModel(input, target, rho);
+  recurrentModel.Add<IdentityLayer<> >();
+  recurrentModel.Add(recurrent);
+  recurrentModel.Add<Linear<> >(4, 3);
+  recurrentModel.Add<SigmoidLayer<> >();
+  CheckRecomputeGradient(recurrentModel);
+}
+
 /**
  * Make sure the RNN can be properly serialized.
  */
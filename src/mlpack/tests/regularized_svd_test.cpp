@@ -251,6 +251,42 @@ BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimize)
   BOOST_REQUIRE_SMALL(relativeError, 1e-2);
 }
 
+/**
+ * Make sure the compact triplets hold the same ratings as the coordinate list,
+ * and that invalid coordinate lists are rejected.
+ */
+BOOST_AUTO_TEST_CASE(RatingTripletsTest)
+{
+  arma::mat data = arma::randu(3, 200);
+  data.row(0) = floor(data.row(0) * 30);
+  data.row(1) = floor(data.row(1) * 40);
+  data(0, 10) = 29;
+  data(1, 20) = 39;
+
+  RatingTriplets triplets(data);
+  BOOST_REQUIRE_EQUAL(triplets.NumRatings(), 200);
+  BOOST_REQUIRE_EQUAL(triplets.NumUsers(), 30);
+  BOOST_REQUIRE_EQUAL(triplets.NumItems(), 40);
+  for (size_t i = 0; i < 200; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(triplets.User(i), (size_t) data(0, i));
+    BOOST_REQUIRE_EQUAL(triplets.Item(i), (size_t) data(1, i));
+    BOOST_REQUIRE_CLOSE(triplets.Rating(i), data(2, i), 1e-4);
+  }
+
+  // The function keeps the triplets of its dataset.
+  RegularizedSVDFunction<arma::mat> rSVDFunc(data, 5, 0.1);
+  BOOST_REQUIRE_EQUAL(rSVDFunc.Triplets().NumRatings(), 200);
+
+  BOOST_REQUIRE_THROW(RatingTriplets(arma::mat(2, 5, arma::fill::zeros)),
+      std::invalid_argument);
+  data(1, 3) = -1;
+  BOOST_REQUIRE_THROW(RatingTriplets t(data), std::invalid_argument);
+  data(1, 3) = 1e10;
+  BOOST_REQUIRE_THROW(RatingTriplets t(data), std::invalid_argument);
+}
+
+
 // The test is only compiled if the user has specified OpenMP to be
 // used.
 #ifdef HAS_OPENMP
@@ -316,6 +352,53 @@ BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimizeHOGWILD)
   BOOST_REQUIRE_SMALL(relativeError, 1e-2);
 }
 
+// Test Regularized SVD with the lock-free parallel SGD specialization, which
+// is used with the exponential backoff decay policy.
+BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimizeLockFree)
+{
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t rank = 10;
+  const double alpha = 0.01;
+  const double lambda = 0.01;
+
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    data(2, i) = arma::dot(parameters.col(data(0, i)),
+                           parameters.col(numUsers + data(1, i)));
+  }
+
+  RegularizedSVDFunction<arma::mat> rSVDFunc(data, rank, lambda);
+
+  // The step size is only decayed after many iterations.
+  ExponentialBackoff decayPolicy(100000, alpha, 0.9);
+  ParallelSGD<ExponentialBackoff> optimizer(0,
+      std::ceil((float) rSVDFunc.NumFunctions() / omp_get_max_threads()), 1e-5,
+      true, decayPolicy);
+
+  arma::mat optParameters = arma::randu(rank, numUsers + numItems);
+  optimizer.Optimize(rSVDFunc, optParameters);
+
+  arma::mat predictedData(1, numRatings);
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    predictedData(0, i) = arma::dot(optParameters.col(data(0, i)),
+                                    optParameters.col(numUsers + data(1, i)));
+  }
+
+  const double relativeError = arma::norm(data.row(2) - predictedData, "frob") /
+                               arma::norm(data, "frob");
+  BOOST_REQUIRE_SMALL(relativeError, 1e-2);
+}
+
 #endif
 
 BOOST_AUTO_TEST_SUITE_END();
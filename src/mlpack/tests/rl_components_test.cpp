@@ -14,11 +14,15 @@
 
 #include <mlpack/methods/reinforcement_learning/environment/mountain_car.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/cart_pole.hpp>
+#include <mlpack/methods/reinforcement_learning/environment/vectorized_env.hpp>
 #include <mlpack/methods/reinforcement_learning/replay/random_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/prioritized_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/transition_batch.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::rl;
@@ -59,6 +63,105 @@ BOOST_AUTO_TEST_CASE(SimpleCartPoleTest)
   BOOST_REQUIRE_EQUAL(2, CartPole::Action::size);
 }
 
+/**
+ * The batch dynamics of MountainCar and CartPole should match the dynamics of
+ * each state.
+ */
+BOOST_AUTO_TEST_CASE(BatchEnvironmentSampleTest)
+{
+  const MountainCar mountainCar;
+  arma::mat states(2, 30);
+  arma::Col<size_t> actions(30);
+  for (size_t i = 0; i < 30; ++i)
+  {
+    states.col(i) = mountainCar.InitialSample().Encode();
+    states(0, i) = 0.14 * math::Random() - 0.07;
+    actions[i] = i % 3;
+  }
+  // Check the clamping at the minimum position.
+  states(1, 0) = -1.2;
+  states(0, 0) = -0.07;
+
+  arma::mat nextStates;
+  arma::rowvec rewards;
+  mountainCar.Sample(states, actions, nextStates, rewards);
+  for (size_t i = 0; i < 30; ++i)
+  {
+    MountainCar::State nextState;
+    const double reward = mountainCar.Sample(
+        MountainCar::State(arma::colvec(states.col(i))),
+        (MountainCar::Action) actions[i], nextState);
+    CheckMatrices(nextState.Encode(), arma::mat(nextStates.col(i)));
+    BOOST_REQUIRE_EQUAL(reward, rewards[i]);
+  }
+
+  const CartPole cartPole;
+  states.set_size(4, 30);
+  for (size_t i = 0; i < 30; ++i)
+  {
+    states.col(i) = cartPole.InitialSample().Encode() * 10;
+    actions[i] = i % 2;
+  }
+
+  cartPole.Sample(states, actions, nextStates, rewards);
+  for (size_t i = 0; i < 30; ++i)
+  {
+    CartPole::State nextState;
+    const double reward = cartPole.Sample(
+        CartPole::State(arma::colvec(states.col(i))),
+        (CartPole::Action) actions[i], nextState);
+    CheckMatrices(nextState.Encode(), arma::mat(nextStates.col(i)));
+    BOOST_REQUIRE_EQUAL(reward, rewards[i]);
+  }
+}
+
+/**
+ * Step several copies of CartPole together, and check that the copies that
+ * fail start a new episode.
+ */
+BOOST_AUTO_TEST_CASE(VectorizedEnvironmentTest)
+{
+  VectorizedEnvironment<CartPole> environments(16);
+  BOOST_REQUIRE_EQUAL(environments.NumEnvironments(), 16);
+  BOOST_REQUIRE_EQUAL(environments.States().n_cols, 16);
+
+  // Always pushing forward makes the pole fall after a few dozen steps.
+  arma::Col<size_t> actions(16);
+  actions.fill(CartPole::Action::forward);
+  arma::mat nextStates;
+  arma::rowvec rewards;
+  arma::Row<size_t> isTerminal;
+  size_t terminals = 0;
+  for (size_t step = 0; step < 200; ++step)
+  {
+    const arma::mat states = environments.States();
+    environments.Step(actions, nextStates, rewards, isTerminal);
+
+    BOOST_REQUIRE_EQUAL(nextStates.n_cols, 16);
+    for (size_t i = 0; i < 16; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(rewards[i], 1.0);
+      if (isTerminal[i])
+      {
+        ++terminals;
+        BOOST_REQUIRE(environments.Environment().IsTerminal(
+            CartPole::State(arma::colvec(nextStates.col(i)))));
+        // The copy was reset to an initial state.
+        BOOST_REQUIRE_EQUAL(environments.Steps()[i], 0);
+        BOOST_REQUIRE(!environments.Environment().IsTerminal(
+            environments.State(i)));
+      }
+      else
+      {
+        CheckMatrices(arma::mat(environments.States().col(i)),
+            arma::mat(nextStates.col(i)));
+      }
+    }
+  }
+
+  BOOST_REQUIRE_GT(terminals, 16);
+}
+
 /**
  * Construct a random replay instance and check if it works as
  * it should be.
@@ -107,6 +210,210 @@ BOOST_AUTO_TEST_CASE(RandomReplayTest)
   }
 }
 
+/**
+ * Store whole episodes in a random replay with float states, and check that
+ * the next states are found, both when they are the state of the following
+ * transition and when they are not.
+ */
+BOOST_AUTO_TEST_CASE(RandomReplayNextStateTest)
+{
+  RandomReplay<MountainCar, float> replay(20, 7);
+  MountainCar env;
+
+  // Keep every transition that was stored, to check the samples against.
+  std::vector<std::pair<arma::colvec, arma::colvec>> transitions;
+  for (size_t episode = 0; episode < 4; ++episode)
+  {
+    MountainCar::State state = env.InitialSample();
+    for (size_t step = 0; step < 3; ++step)
+    {
+      MountainCar::State nextState;
+      MountainCar::Action action = MountainCar::Action::forward;
+      double reward = env.Sample(state, action, nextState);
+      replay.Store(state, action, reward, nextState, step == 2);
+      transitions.push_back(std::make_pair(state.Encode(), nextState.Encode()));
+      state = nextState;
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(7, replay.Size());
+
+  arma::mat sampledState;
+  arma::icolvec sampledAction;
+  arma::colvec sampledReward;
+  arma::mat sampledNextState;
+  arma::icolvec sampledTerminal;
+  for (size_t trial = 0; trial < 10; ++trial)
+  {
+    replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+        sampledTerminal);
+
+    BOOST_REQUIRE_EQUAL(sampledState.n_cols, 20);
+    BOOST_REQUIRE_EQUAL(sampledNextState.n_cols, 20);
+    for (size_t i = 0; i < 20; ++i)
+    {
+      // The 12 transitions were stored in slots 0, ..., 6, 0, ..., 4.
+      const size_t slot = replay.SampledIndices()[i];
+      const size_t stored = (slot < 5) ? slot + 7 : slot;
+
+      for (size_t d = 0; d < sampledState.n_rows; ++d)
+      {
+        BOOST_REQUIRE_CLOSE(sampledState(d, i), transitions[stored].first[d],
+            1e-4);
+        BOOST_REQUIRE_CLOSE(sampledNextState(d, i),
+            transitions[stored].second[d], 1e-4);
+      }
+      BOOST_REQUIRE_EQUAL(sampledTerminal[i], (stored % 3 == 2) ? 1 : 0);
+    }
+  }
+}
+
+/**
+ * Fill a batch of transitions, and check that it survives serialization.
+ */
+BOOST_AUTO_TEST_CASE(TransitionBatchTest)
+{
+  CartPole env;
+  TransitionBatch batch;
+  std::vector<CartPole::State> states;
+  CartPole::State state = env.InitialSample();
+  for (size_t i = 0; i < 40; ++i)
+  {
+    CartPole::State nextState;
+    CartPole::Action action = (CartPole::Action) (i % 2);
+    const double reward = env.Sample(state, action, nextState);
+    batch.Add(state.Encode(), action, reward, nextState.Encode(), i == 39);
+    states.push_back(state);
+    state = nextState;
+  }
+
+  BOOST_REQUIRE_EQUAL(batch.Size(), 40);
+
+  TransitionBatch xmlBatch, textBatch, binaryBatch;
+  SerializeObjectAll(batch, xmlBatch, textBatch, binaryBatch);
+
+  const TransitionBatch* batches[4] = { &batch, &xmlBatch, &textBatch,
+      &binaryBatch };
+  for (size_t b = 0; b < 4; ++b)
+  {
+    BOOST_REQUIRE_EQUAL(batches[b]->Size(), 40);
+    for (size_t i = 0; i < 40; ++i)
+    {
+      CheckMatrices(batches[b]->State(i), states[i].Encode());
+      if (i < 39)
+        CheckMatrices(batches[b]->NextState(i), states[i + 1].Encode());
+      BOOST_REQUIRE_EQUAL(batches[b]->Action(i), i % 2);
+      BOOST_REQUIRE_EQUAL(batches[b]->Reward(i), 1.0);
+      BOOST_REQUIRE_EQUAL(batches[b]->IsTerminal(i), i == 39);
+    }
+  }
+
+  // Clearing keeps the storage, and the batch can be filled again.
+  batch.Clear();
+  BOOST_REQUIRE_EQUAL(batch.Size(), 0);
+  batch.Add(state.Encode(), 1, 2.0, state.Encode(), false);
+  BOOST_REQUIRE_EQUAL(batch.Size(), 1);
+  BOOST_REQUIRE_EQUAL(batch.Reward(0), 2.0);
+}
+
+/**
+ * Check the sums and the prefix sum search of SumTree.
+ */
+BOOST_AUTO_TEST_CASE(SumTreeTest)
+{
+  SumTree<double> tree(5);
+  tree.Set(0, 1.0);
+  tree.Set(1, 2.0);
+  tree.Set(2, 0.0);
+  tree.Set(3, 3.0);
+  tree.Set(4, 4.0);
+
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 10.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(tree.Get(3), 3.0, 1e-5);
+
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(0.0), 0);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(0.5), 0);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(1.5), 1);
+  // Index 2 has a zero value, so it is never found.
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(3.0), 3);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(5.9), 3);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(6.1), 4);
+  // Past the sum, the last non-zero value is found.
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(12.0), 4);
+
+  tree.Set(4, 1.0);
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 7.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(6.5), 4);
+}
+
+/**
+ * Construct a prioritized replay instance, and check that it samples the
+ * transitions in proportion to their priorities.
+ */
+BOOST_AUTO_TEST_CASE(PrioritizedReplayTest)
+{
+  PrioritizedReplay<MountainCar> replay(100, 4, 1.0, 1.0);
+  MountainCar env;
+  MountainCar::State state = env.InitialSample();
+  MountainCar::Action action = MountainCar::Action::forward;
+  MountainCar::State nextState;
+  double reward = env.Sample(state, action, nextState);
+  for (size_t i = 0; i < 4; ++i)
+    replay.Store(state, action, reward, nextState, false);
+
+  BOOST_REQUIRE_EQUAL(4, replay.Size());
+
+  arma::mat sampledState;
+  arma::icolvec sampledAction;
+  arma::colvec sampledReward;
+  arma::mat sampledNextState;
+  arma::icolvec sampledTerminal;
+
+  //! Set the priorities to 1, 2, 3 and 4.
+  replay.UpdatePriorities(arma::uvec("0 1 2 3"),
+      arma::colvec("1 2 3 4") - 1e-6);
+
+  arma::vec counts(4, arma::fill::zeros);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+        sampledTerminal);
+    BOOST_REQUIRE_EQUAL(replay.SampledIndices().n_elem, 100);
+    for (size_t j = 0; j < 100; ++j)
+      counts[replay.SampledIndices()[j]]++;
+
+    //! With beta = 1, the weights are inversely proportional to the
+    //! priorities, and the largest one is 1.
+    for (size_t j = 0; j < 100; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(replay.Weights()[j] *
+          replay.Priority(replay.SampledIndices()[j]), 1.0, 1e-3);
+    }
+  }
+
+  //! The batches are stratified, so the counts are almost exact.
+  counts /= arma::accu(counts);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_CLOSE(counts[i], (i + 1) / 10.0, 2.0);
+
+  //! Update() sets the priorities of the last batch, and scales the TD errors
+  //! of the targets by the weights.
+  replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+      sampledTerminal);
+  arma::mat target(3, 100, arma::fill::zeros);
+  arma::colvec tdErrors(100);
+  tdErrors.fill(2.0);
+  const arma::colvec weights = replay.Weights();
+  replay.Update(target, sampledAction, tdErrors);
+  for (size_t j = 0; j < 100; ++j)
+  {
+    BOOST_REQUIRE_CLOSE(target(sampledAction[j], j),
+        -(1.0 - weights[j]) * 2.0, 1e-3);
+    BOOST_REQUIRE_CLOSE(replay.Priority(replay.SampledIndices()[j]), 2.0,
+        1e-3);
+  }
+}
+
 /**
  * Construct a greedy policy instance and check if it works as
  * it should be.
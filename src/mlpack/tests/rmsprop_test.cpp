@@ -103,4 +103,28 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionTest)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 0.6); // 0.6% error tolerance.
 }
 
+/**
+ * Make sure the sparse RMSProp update, which catches up with the decay of
+ * untouched coordinates lazily, gives the same result as the dense update.
+ */
+BOOST_AUTO_TEST_CASE(RMSPropSparseUpdateTest)
+{
+  RMSPropUpdate dense, sparse;
+  dense.Initialize(4, 3);
+  sparse.Initialize(4, 3);
+
+  arma::mat denseIterate(4, 3, arma::fill::randu);
+  arma::mat sparseIterate(denseIterate);
+  for (size_t i = 0; i < 10; ++i)
+  {
+    arma::sp_mat gradient;
+    gradient.sprandu(4, 3, 0.3);
+
+    dense.Update(denseIterate, 0.1, arma::mat(gradient));
+    sparse.Update(sparseIterate, 0.1, gradient);
+  }
+
+  CheckMatrices(denseIterate, sparseIterate);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -73,6 +73,37 @@ BOOST_AUTO_TEST_CASE(RosenbrockTest)
   BOOST_REQUIRE_CLOSE(coordinates[1], 1.0, 1e-2);
 }
 
+/**
+ * Run several chains with state exchanges on the Rosenbrock function, and make
+ * sure the result only depends on the random seed.
+ */
+BOOST_AUTO_TEST_CASE(RosenbrockParallelTemperingTest)
+{
+  RosenbrockFunction f;
+  ExponentialSchedule schedule;
+  SA<> sa(schedule, 1000000, 1000., 1000, 100, 1e-11, 3, 1.5, 0.3, 0.3, 4,
+      1000, 2.0);
+
+  math::RandomSeed(42);
+  arma::mat coordinates = f.GetInitialPoint();
+  const double result = sa.Optimize(f, coordinates);
+
+  BOOST_REQUIRE_SMALL(result, 1e-5);
+  BOOST_REQUIRE_CLOSE(coordinates[0], 1.0, 1e-2);
+  BOOST_REQUIRE_CLOSE(coordinates[1], 1.0, 1e-2);
+
+  // The chains have their own generators, so the threads do not matter.
+  SA<> sa2(schedule, 1000000, 1000., 1000, 100, 1e-11, 3, 1.5, 0.3, 0.3, 4,
+      1000, 2.0);
+  math::RandomSeed(42);
+  arma::mat coordinates2 = f.GetInitialPoint();
+  const double result2 = sa2.Optimize(f, coordinates2);
+
+  BOOST_REQUIRE_EQUAL(result, result2);
+  BOOST_REQUIRE_EQUAL(coordinates[0], coordinates2[0]);
+  BOOST_REQUIRE_EQUAL(coordinates[1], coordinates2[1]);
+}
+
 /**
  * The Rastrigrin function, a (not very) simple nonconvex function.  It is
  * defined by
@@ -74,6 +74,45 @@ BOOST_AUTO_TEST_CASE(DisjointFeatureTest)
   BOOST_REQUIRE_CLOSE(iterate[3], 4, 0.02);
 }
 
+/**
+ * Make sure the SCD optimizer still reaches the known minimum when several
+ * coordinates are updated in parallel in each iteration.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDisjointFeatureTest)
+{
+  SparseTestFunction f;
+  SCD<CyclicDescent> s(0.4, 100000, 1e-5, 1e3, CyclicDescent(), 4);
+
+  arma::mat iterate = f.GetInitialPoint();
+
+  double result = s.Optimize(f, iterate);
+
+  BOOST_REQUIRE_CLOSE(result, 123.75, 0.01);
+  BOOST_REQUIRE_CLOSE(iterate[0], 2, 0.02);
+  BOOST_REQUIRE_CLOSE(iterate[1], 1, 0.02);
+  BOOST_REQUIRE_CLOSE(iterate[2], 1.5, 0.02);
+  BOOST_REQUIRE_CLOSE(iterate[3], 4, 0.02);
+}
+
+/**
+ * Test parallel updates of randomly chosen coordinates on a logistic
+ * regression problem.
+ */
+BOOST_AUTO_TEST_CASE(ParallelPreCalcSCDTest)
+{
+  arma::mat predictors("0 0 0.4; 0 0 0.6; 0 0.3 0; 0.2 0 0; 0.2 -0.5 0;");
+  arma::Row<size_t> responses("1  1  0;");
+
+  LogisticRegressionFunction<arma::mat> f(predictors, responses, 0.0001);
+
+  SCD<> s(0.02, 30000, 1e-5, 1e3, RandomDescent(), 3);
+  arma::mat iterate = f.InitialPoint();
+
+  double objective = s.Optimize(f, iterate);
+
+  BOOST_REQUIRE_LE(objective, 0.055);
+}
+
 /**
  * Test the greedy descent policy.
  */
@@ -0,0 +1,165 @@
+/**
+ * @file search_benchmark_test.cpp
+ *
+ * Test the SearchBenchmark class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/search_benchmark/search_benchmark.hpp>
+#include <mlpack/methods/approx_kfn/drusilla_select.hpp>
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+BOOST_AUTO_TEST_SUITE(SearchBenchmarkTest);
+
+/**
+ * Make sure that exact search has a recall of 1, that a method that returns
+ * wrong neighbors has a recall of 0, and that the other measurements are
+ * consistent.
+ */
+BOOST_AUTO_TEST_CASE(SearchBenchmarkRecallTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(4, 300);
+  arma::mat querySet = arma::randu<arma::mat>(4, 40);
+
+  SearchBenchmark benchmark(referenceSet, querySet, 5, 20);
+
+  std::unique_ptr<KNN> knn;
+  const BenchmarkResult& exact = benchmark.Run("exact", "epsilon=0", false,
+      [&]() { knn.reset(new KNN(referenceSet)); },
+      [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+          arma::mat& distances)
+      { knn->Search(queries, 5, neighbors, distances); });
+
+  BOOST_REQUIRE_EQUAL(exact.method, "exact");
+  BOOST_REQUIRE_EQUAL(exact.parameters, "epsilon=0");
+  BOOST_REQUIRE_EQUAL(exact.k, 5);
+  BOOST_REQUIRE_CLOSE(exact.recall, 1.0, 1e-10);
+  BOOST_REQUIRE_GE(exact.buildTime, 0.0);
+  BOOST_REQUIRE_GE(exact.queriesPerSecond, 0.0);
+  BOOST_REQUIRE_LE(exact.p50Latency, exact.p90Latency);
+  BOOST_REQUIRE_LE(exact.p90Latency, exact.p99Latency);
+
+  // The furthest neighbors are never the nearest ones.
+  std::unique_ptr<KFN> kfn;
+  benchmark.Run("wrong", "", false,
+      [&]() { kfn.reset(new KFN(referenceSet)); },
+      [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+          arma::mat& distances)
+      { kfn->Search(queries, 5, neighbors, distances); });
+  BOOST_REQUIRE_SMALL(benchmark.Results()[1].recall, 1e-10);
+
+  // But they are the right ones for a furthest neighbor method.
+  benchmark.Run("furthest", "", true,
+      [&]() { kfn.reset(new KFN(referenceSet)); },
+      [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+          arma::mat& distances)
+      { kfn->Search(queries, 5, neighbors, distances); });
+  BOOST_REQUIRE_CLOSE(benchmark.Results()[2].recall, 1.0, 1e-10);
+
+  // An approximate method finds at most all of them.
+  std::unique_ptr<DrusillaSelect<>> ds;
+  benchmark.Run("ds", "tables=5 projections=5", true,
+      [&]() { ds.reset(new DrusillaSelect<>(referenceSet, 5, 5)); },
+      [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+          arma::mat& distances)
+      { ds->Search(queries, 5, neighbors, distances); });
+  BOOST_REQUIRE_EQUAL(benchmark.Results().size(), 4);
+  BOOST_REQUIRE_GE(benchmark.Results()[3].recall, 0.0);
+  BOOST_REQUIRE_LE(benchmark.Results()[3].recall, 1.0);
+
+  // A method that returns the wrong number of neighbors is an error.
+  BOOST_REQUIRE_THROW(benchmark.Run("short", "", false, []() { },
+      [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+          arma::mat& distances)
+      { knn->Search(queries, 3, neighbors, distances); }), std::runtime_error);
+  BOOST_REQUIRE_EQUAL(benchmark.Results().size(), 4);
+
+  // Invalid sizes can't be benchmarked.
+  BOOST_REQUIRE_THROW(SearchBenchmark(referenceSet, querySet, 0),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(SearchBenchmark(referenceSet, querySet, 300),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(SearchBenchmark(referenceSet,
+      arma::randu<arma::mat>(3, 10), 5), std::invalid_argument);
+}
+
+/**
+ * Check the nearest-rank percentiles.
+ */
+BOOST_AUTO_TEST_CASE(SearchBenchmarkPercentileTest)
+{
+  std::vector<double> values;
+  for (size_t i = 1; i <= 10; ++i)
+    values.push_back(i);
+
+  BOOST_REQUIRE_EQUAL(SearchBenchmark::Percentile(values, 50.0), 5.0);
+  BOOST_REQUIRE_EQUAL(SearchBenchmark::Percentile(values, 90.0), 9.0);
+  BOOST_REQUIRE_EQUAL(SearchBenchmark::Percentile(values, 99.0), 10.0);
+  BOOST_REQUIRE_EQUAL(SearchBenchmark::Percentile(values, 100.0), 10.0);
+  BOOST_REQUIRE_EQUAL(SearchBenchmark::Percentile(values, 1.0), 1.0);
+
+  BOOST_REQUIRE_EQUAL(SearchBenchmark::Percentile(
+      std::vector<double>(1, 3.0), 99.0), 3.0);
+  BOOST_REQUIRE_THROW(SearchBenchmark::Percentile(std::vector<double>(), 50.0),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure the results are written with one CSV line or one JSON object for
+ * each configuration.
+ */
+BOOST_AUTO_TEST_CASE(SearchBenchmarkOutputTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 100);
+  SearchBenchmark benchmark(referenceSet, referenceSet, 2, 5);
+
+  std::ostringstream emptyJson;
+  benchmark.WriteJSON(emptyJson);
+  BOOST_REQUIRE_EQUAL(emptyJson.str(), "[]\n");
+
+  std::unique_ptr<KNN> knn;
+  for (const double epsilon : { 0.0, 0.5 })
+  {
+    benchmark.Run("epsilon", "epsilon=" + std::to_string(epsilon), false,
+        [&]() { knn.reset(new KNN(referenceSet, DUAL_TREE_MODE, epsilon)); },
+        [&](const arma::mat& queries, arma::Mat<size_t>& neighbors,
+            arma::mat& distances)
+        { knn->Search(queries, 2, neighbors, distances); });
+    knn.reset();
+  }
+
+  std::ostringstream csv;
+  benchmark.WriteCSV(csv);
+  std::istringstream lines(csv.str());
+  std::string line;
+  size_t numLines = 0;
+  while (std::getline(lines, line))
+  {
+    if (numLines == 0)
+      BOOST_REQUIRE_EQUAL(line.substr(0, 25), "method,parameters,k,recal");
+    else
+      BOOST_REQUIRE_EQUAL(line.substr(0, 8), "epsilon,");
+    ++numLines;
+  }
+  BOOST_REQUIRE_EQUAL(numLines, 3);
+
+  std::ostringstream json;
+  benchmark.WriteJSON(json);
+  const std::string jsonString = json.str();
+  size_t objects = 0;
+  for (size_t pos = jsonString.find("\"method\""); pos != std::string::npos;
+       pos = jsonString.find("\"method\"", pos + 1))
+    ++objects;
+  BOOST_REQUIRE_EQUAL(objects, 2);
+  BOOST_REQUIRE_EQUAL(jsonString[0], '[');
+}
+
+BOOST_AUTO_TEST_SUITE_END();
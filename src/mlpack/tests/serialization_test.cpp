@@ -16,6 +16,7 @@
 #include "serialization.hpp"
 
 #include <mlpack/core/dists/regression_distribution.hpp>
+#include <mlpack/core/data/map_policies/intern_policy.hpp>
 #include <mlpack/core/tree/ballbound.hpp>
 #include <mlpack/core/tree/hrectbound.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
@@ -416,6 +417,35 @@ BOOST_AUTO_TEST_CASE(HRectBoundTest)
   BOOST_REQUIRE_CLOSE(b.MinWidth(), binaryB.MinWidth(), 1e-8);
 }
 
+BOOST_AUTO_TEST_CASE(FixedHRectBoundTest)
+{
+  HRectBound2D<> b(2);
+
+  arma::mat points("0.0, 1.1; 5.0, 2.2");
+  points = points.t();
+  b |= points; // [0.0, 5.0]; [1.1, 2.2];
+
+  HRectBound2D<> xmlB, textB, binaryB;
+
+  SerializeObjectAll(b, xmlB, textB, binaryB);
+
+  // Check the bounds.
+  for (size_t i = 0; i < b.Dim(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(b[i].Lo(), xmlB[i].Lo(), 1e-8);
+    BOOST_REQUIRE_CLOSE(b[i].Hi(), xmlB[i].Hi(), 1e-8);
+    BOOST_REQUIRE_CLOSE(b[i].Lo(), textB[i].Lo(), 1e-8);
+    BOOST_REQUIRE_CLOSE(b[i].Hi(), textB[i].Hi(), 1e-8);
+    BOOST_REQUIRE_CLOSE(b[i].Lo(), binaryB[i].Lo(), 1e-8);
+    BOOST_REQUIRE_CLOSE(b[i].Hi(), binaryB[i].Hi(), 1e-8);
+  }
+
+  // Check the minimum width.
+  BOOST_REQUIRE_CLOSE(b.MinWidth(), xmlB.MinWidth(), 1e-8);
+  BOOST_REQUIRE_CLOSE(b.MinWidth(), textB.MinWidth(), 1e-8);
+  BOOST_REQUIRE_CLOSE(b.MinWidth(), binaryB.MinWidth(), 1e-8);
+}
+
 template<typename TreeType>
 void CheckTrees(TreeType& tree,
                 TreeType& xmlTree,
@@ -1494,6 +1524,36 @@ BOOST_AUTO_TEST_CASE(HoeffdingCategoricalSplitTest)
   }
 }
 
+/**
+ * Make sure a DatasetMapper with InternPolicy serializes its mappings.
+ */
+BOOST_AUTO_TEST_CASE(InternPolicySerializationTest)
+{
+  using MapperType = data::DatasetMapper<data::InternPolicy>;
+  MapperType info(3);
+  for (size_t i = 0; i < 100; ++i)
+    info.MapString<double>("id" + std::to_string(i % 37), 1);
+
+  MapperType xmlInfo(2), textInfo, binaryInfo(5);
+  xmlInfo.MapString<double>("other", 0);
+
+  SerializeObjectAll(info, xmlInfo, textInfo, binaryInfo);
+
+  for (const MapperType* m : { &xmlInfo, &textInfo, &binaryInfo })
+  {
+    BOOST_REQUIRE_EQUAL(m->Dimensionality(), 3);
+    BOOST_REQUIRE(m->Type(1) == data::Datatype::categorical);
+    BOOST_REQUIRE_EQUAL(m->NumMappings(0), 0);
+    BOOST_REQUIRE_EQUAL(m->NumMappings(1), 37);
+    for (size_t v = 0; v < 37; ++v)
+    {
+      BOOST_REQUIRE_EQUAL(m->UnmapString(v, 1), "id" + std::to_string(v));
+      BOOST_REQUIRE_EQUAL(m->Policy().UnmapValue("id" + std::to_string(v), 1),
+          v);
+    }
+  }
+}
+
 /**
  * Make sure the HoeffdingTree object serializes correctly before a split has
  * occured.
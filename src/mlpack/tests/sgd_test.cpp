@@ -39,6 +39,24 @@ BOOST_AUTO_TEST_CASE(SimpleSGDTestFunction)
   BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
 }
 
+/**
+ * Make sure SGD still converges when the objective is only estimated from the
+ * gradient steps, and that the estimate is reasonable.
+ */
+BOOST_AUTO_TEST_CASE(SimpleSGDTestFunctionInexactObjective)
+{
+  SGDTestFunction f;
+  StandardSGD s(0.0003, 5000000, 1e-9, true, VanillaUpdate(), true, false);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(f, coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
 BOOST_AUTO_TEST_CASE(GeneralizedRosenbrockTest)
 {
   // Loop over several variants.
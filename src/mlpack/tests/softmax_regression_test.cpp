@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/softmax_regression/softmax_regression.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -669,4 +670,139 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionComputeProbabilitiesAndLabelsTest)
   }
 }
 
+/**
+ * Make sure that the separable objective and gradient of the points, summed in
+ * batches, are the number of points times the full objective and gradient.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionSeparableTest)
+{
+  const size_t points = 100;
+  const size_t numClasses = 3;
+  const double lambda = 0.3;
+
+  arma::mat data = arma::randu<arma::mat>(4, points);
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+    labels(i) = math::RandInt(0, numClasses);
+
+  SoftmaxRegressionFunction srf(data, labels, numClasses, lambda);
+  arma::mat parameters = arma::randn<arma::mat>(srf.GetInitialPoint().n_rows,
+      srf.GetInitialPoint().n_cols);
+
+  arma::mat gradient;
+  srf.Gradient(parameters, gradient);
+  const double objective = srf.Evaluate(parameters);
+
+  // Sum in batches of 30, with a smaller last batch.
+  double batchObjective = 0.0, batchObjective2 = 0.0;
+  arma::mat batchGradient, sumGradient, sumGradient2;
+  sumGradient.zeros(parameters.n_rows, parameters.n_cols);
+  sumGradient2.zeros(parameters.n_rows, parameters.n_cols);
+  for (size_t begin = 0; begin < points; begin += 30)
+  {
+    const size_t batchSize = std::min((size_t) 30, points - begin);
+    batchObjective += srf.Evaluate(parameters, begin, batchSize);
+    srf.Gradient(parameters, begin, batchGradient, batchSize);
+    sumGradient += batchGradient;
+
+    batchObjective2 += srf.EvaluateWithGradient(parameters, begin,
+        batchGradient, batchSize);
+    sumGradient2 += batchGradient;
+  }
+
+  // The single-point versions give the same sums.
+  double pointObjective = 0.0;
+  arma::mat pointGradient, sumPointGradient;
+  sumPointGradient.zeros(parameters.n_rows, parameters.n_cols);
+  for (size_t i = 0; i < srf.NumFunctions(); ++i)
+  {
+    pointObjective += srf.Evaluate(parameters, i);
+    srf.Gradient(parameters, i, pointGradient);
+    sumPointGradient += pointGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(batchObjective, points * objective, 1e-5);
+  BOOST_REQUIRE_CLOSE(batchObjective2, points * objective, 1e-5);
+  BOOST_REQUIRE_CLOSE(pointObjective, points * objective, 1e-5);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) < 1e-8)
+    {
+      BOOST_REQUIRE_SMALL(sumGradient[i], 1e-5);
+      BOOST_REQUIRE_SMALL(sumGradient2[i], 1e-5);
+      BOOST_REQUIRE_SMALL(sumPointGradient[i], 1e-5);
+    }
+    else
+    {
+      BOOST_REQUIRE_CLOSE(sumGradient[i], points * gradient[i], 1e-5);
+      BOOST_REQUIRE_CLOSE(sumGradient2[i], points * gradient[i], 1e-5);
+      BOOST_REQUIRE_CLOSE(sumPointGradient[i], points * gradient[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * Training on sparse data should give the same model as training on the same
+ * data stored in a dense matrix.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionSparseTest)
+{
+  const size_t points = 500;
+  arma::sp_mat sparseData;
+  sparseData.sprandu(20, points, 0.2);
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+    labels(i) = (arma::accu(sparseData.col(i)) > 2.0) ? 1 : 0;
+  const arma::mat denseData(sparseData);
+
+  SoftmaxRegression sr(denseData, labels, 2, 0.001);
+  SoftmaxRegression sparseSr(sparseData, labels, 2, 0.001);
+
+  BOOST_REQUIRE_EQUAL(sr.Parameters().n_elem, sparseSr.Parameters().n_elem);
+  for (size_t i = 0; i < sr.Parameters().n_elem; ++i)
+  {
+    if (std::abs(sr.Parameters()[i]) < 1e-4)
+      BOOST_REQUIRE_SMALL(sparseSr.Parameters()[i], 1e-4);
+    else
+      BOOST_REQUIRE_CLOSE(sr.Parameters()[i], sparseSr.Parameters()[i], 1e-3);
+  }
+
+  arma::Row<size_t> predictions, sparsePredictions;
+  sr.Classify(denseData, predictions);
+  sparseSr.Classify(sparseData, sparsePredictions);
+  for (size_t i = 0; i < points; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], sparsePredictions[i]);
+
+  BOOST_REQUIRE_CLOSE(sparseSr.ComputeAccuracy(sparseData, labels),
+      sr.ComputeAccuracy(denseData, labels), 1e-5);
+}
+
+/**
+ * Train with mini-batch SGD on a two-Gaussian dataset, dense and sparse.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionMiniBatchSGDTest)
+{
+  const size_t points = 1000;
+
+  GaussianDistribution g1(arma::vec("1.0 9.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("4.0 3.0 4.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, points);
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; i++)
+  {
+    data.col(i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    labels(i) = i % 2;
+  }
+
+  MiniBatchSGD sgd(50, 0.1, 100 * points / 50, 1e-9);
+  SoftmaxRegression sr(data, labels, 2, 0.0001, false, sgd);
+  BOOST_REQUIRE_GT(sr.ComputeAccuracy(data, labels), 99.0);
+
+  MiniBatchSGD sparseSgd(50, 0.1, 100 * points / 50, 1e-9);
+  const arma::sp_mat sparseData(data);
+  SoftmaxRegression sparseSr(sparseData, labels, 2, 0.0001, false, sparseSgd);
+  BOOST_REQUIRE_GT(sparseSr.ComputeAccuracy(sparseData, labels), 99.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/sparse_autoencoder/sparse_autoencoder.hpp>
+#include <mlpack/core/optimizers/adam/adam.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -268,4 +269,72 @@ BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionGradient)
   }
 }
 
+/**
+ * Over a single batch of all the points, the separable objective function and
+ * its gradient are NumFunctions() times the full-batch ones, since the running
+ * estimate of the average activations starts as the one of the batch.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionSeparableTest)
+{
+  const size_t points = 200;
+  const size_t vSize = 12;
+  const size_t hSize = 5;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 0.5, 3, 0.1);
+  BOOST_REQUIRE_EQUAL(saf.NumFunctions(), points);
+
+  const arma::mat parameters = saf.GetInitialPoint();
+  const double objective = saf.Evaluate(parameters);
+  arma::mat gradient, batchGradient;
+  saf.Gradient(parameters, gradient);
+
+  BOOST_REQUIRE_CLOSE(saf.Evaluate(parameters, 0, points), points * objective,
+      1e-5);
+  BOOST_REQUIRE_EQUAL(saf.AverageActivation().n_elem, 0);
+
+  const double batchObjective = saf.EvaluateWithGradient(parameters, 0,
+      batchGradient, points);
+  BOOST_REQUIRE_CLOSE(batchObjective, points * objective, 1e-5);
+  CheckMatrices(batchGradient, points * gradient, 1e-5);
+  BOOST_REQUIRE_EQUAL(saf.AverageActivation().n_elem, hSize);
+
+  // The sum of the separable objectives with the same estimate is the same.
+  double sum = 0;
+  for (size_t i = 0; i < points; i += 50)
+    sum += saf.Evaluate(parameters, i, 50);
+  BOOST_REQUIRE_CLOSE(sum, points * objective, 1e-5);
+
+  // The gradient of a batch moves the estimate towards the batch activations.
+  const arma::vec before = saf.AverageActivation();
+  saf.ActivationDecay(0.5);
+  saf.Gradient(parameters, 3, batchGradient);
+  BOOST_REQUIRE_GT(arma::norm(saf.AverageActivation() - before, 2), 0.0);
+  saf.ResetAverageActivation();
+  BOOST_REQUIRE_EQUAL(saf.AverageActivation().n_elem, 0);
+}
+
+/**
+ * Training with Adam lowers the full-batch objective.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderAdamTest)
+{
+  const size_t vSize = 10;
+  const size_t hSize = 4;
+
+  arma::mat data;
+  data.randu(vSize, 500);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize);
+  arma::mat parameters = saf.GetInitialPoint();
+  const double initialObjective = saf.Evaluate(parameters);
+
+  optimization::Adam adam(0.01, 0.9, 0.999, 1e-8, 10 * data.n_cols, 1e-8);
+  adam.Optimize(saf, parameters);
+
+  BOOST_REQUIRE_LT(saf.Evaluate(parameters), initialObjective);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
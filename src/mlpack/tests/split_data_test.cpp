@@ -170,4 +170,54 @@ BOOST_AUTO_TEST_CASE(SplitLabeledDataLargerTest)
   CheckDuplication(std::get<2>(value), std::get<3>(value));
 }
 
+/**
+ * Make sure SplitInPlace() only permutes the points and the labels together.
+ */
+BOOST_AUTO_TEST_CASE(SplitLabeledDataInPlaceTest)
+{
+  mat input(10, 497);
+  input.randu();
+  const mat original = input;
+
+  // Set the labels to the column ID.
+  Row<size_t> labels = arma::linspace<Row<size_t>>(0, input.n_cols - 1,
+      input.n_cols);
+
+  const size_t trainSize = SplitInPlace(input, labels, 0.3);
+  BOOST_REQUIRE_EQUAL(trainSize, 497 - size_t(0.3 * 497));
+  BOOST_REQUIRE_EQUAL(input.n_cols, 497);
+
+  // Check aliases of the two parts, as they would be used.
+  const mat trainData(input.memptr(), input.n_rows, trainSize, false, true);
+  const mat testData(input.colptr(trainSize), input.n_rows,
+      input.n_cols - trainSize, false, true);
+  const Row<size_t> trainLabels(labels.memptr(), trainSize, false, true);
+  const Row<size_t> testLabels(labels.colptr(trainSize),
+      labels.n_elem - trainSize, false, true);
+
+  CompareData(original, trainData, trainLabels);
+  CompareData(original, testData, testLabels);
+  CheckDuplication(trainLabels, testLabels);
+
+  // Mismatched labels are rejected.
+  Row<size_t> shortLabels(10);
+  BOOST_REQUIRE_THROW(SplitInPlace(input, shortLabels, 0.3),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure SplitInPlace() without labels keeps all the points.
+ */
+BOOST_AUTO_TEST_CASE(SplitDataInPlaceTest)
+{
+  size_t count = 0;
+  mat input(10, 497);
+  input.imbue([&count] () { return ++count; });
+  const mat original = input;
+
+  const size_t trainSize = SplitInPlace(input, 0.3);
+  BOOST_REQUIRE_EQUAL(trainSize, 497 - size_t(0.3 * 497));
+  CheckMatEqual(original, input);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
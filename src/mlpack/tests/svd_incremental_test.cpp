@@ -14,6 +14,7 @@
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/svd_incomplete_incremental_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_complete_incremental_learning.hpp>
+#include <mlpack/methods/amf/update_rules/svd_parallel_incremental_learning.hpp>
 #include <mlpack/methods/amf/init_rules/random_init.hpp>
 #include <mlpack/methods/amf/termination_policies/incomplete_incremental_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/complete_incremental_termination.hpp>
@@ -146,4 +147,78 @@ BOOST_AUTO_TEST_CASE(SVDIncompleteIncrementalRegularizationTest)
   BOOST_REQUIRE_LT(regularizedRMSE, regularRMSE + 0.075);
 }
 
+/**
+ * Factorize the nonzero entries of a low-rank matrix with parallel incremental
+ * learning and a validation set, and make sure the validation RMSE is low.
+ */
+BOOST_AUTO_TEST_CASE(SVDParallelIncrementalValidationTest)
+{
+  const mat w = randu<mat>(200, 2) + 0.5;
+  const mat h = randu<mat>(2, 150) + 0.5;
+
+  // Keep about 30% of the entries.
+  sp_mat data(200, 150);
+  for (size_t j = 0; j < 150; ++j)
+    for (size_t i = 0; i < 200; ++i)
+      if (math::Random() < 0.3)
+        data(i, j) = dot(w.row(i), h.col(j));
+
+  ValidationRMSETermination<sp_mat> vrt(data, 500, 1e-5, 500);
+  SVDParallelIncrementalLearning svd(0.02, 0.001, 0.001, 4);
+  AMF<ValidationRMSETermination<sp_mat>,
+      RandomInitialization,
+      SVDParallelIncrementalLearning> amf(vrt, RandomInitialization(), svd);
+
+  mat m1, m2;
+  const double rmse = amf.Apply(data, 2, m1, m2);
+
+  BOOST_REQUIRE_LT(rmse, 0.1);
+}
+
+/**
+ * With a single thread, the parallel incremental learning has to take the
+ * same steps as a straightforward pass over the shuffled entries.
+ */
+BOOST_AUTO_TEST_CASE(SVDParallelIncrementalSingleThreadTest)
+{
+  sp_mat data;
+  data.sprandu(50, 40, 0.2);
+  const mat w = randu<mat>(50, 3);
+  const mat h = randu<mat>(3, 40);
+
+  SVDParallelIncrementalLearning svd(0.01, 0.0, 0.0, 1);
+  svd.Initialize(data, 3);
+  mat w1 = w;
+  math::RandomSeed(7);
+  svd.WUpdate(data, w1, h);
+
+  // Repeat the shuffle of the steps by hand.
+  arma::Col<size_t> order(data.n_nonzero);
+  for (size_t i = 0; i < order.n_elem; ++i)
+    order[i] = i;
+  math::RandomSeed(7);
+  std::shuffle(order.begin(), order.end(), math::randGen);
+
+  umat locations(2, data.n_nonzero);
+  vec values(data.n_nonzero);
+  size_t k = 0;
+  for (sp_mat::const_iterator it = data.begin(); it != data.end(); ++it, ++k)
+  {
+    locations(0, k) = it.row();
+    locations(1, k) = it.col();
+    values[k] = *it;
+  }
+
+  mat w2 = w;
+  for (size_t e = 0; e < order.n_elem; ++e)
+  {
+    const size_t i = locations(0, order[e]);
+    const size_t j = locations(1, order[e]);
+    const double error = values[order[e]] - dot(w2.row(i), h.col(j));
+    w2.row(i) += 0.01 * error * h.col(j).t();
+  }
+
+  BOOST_REQUIRE_SMALL(arma::norm(w1 - w2, "fro"), 1e-10);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -147,4 +147,212 @@ BOOST_AUTO_TEST_CASE(DisabledTimingTest)
   BOOST_REQUIRE(Timer::Get("test_timer") == std::chrono::microseconds(0));
 }
 
+// Sleep in a scoped timer for the given number of milliseconds.
+static void ScopedSleep(const size_t milliseconds)
+{
+  MLPACK_SCOPED_TIMER("scoped_timer");
+
+  #ifdef _WIN32
+  Sleep(milliseconds);
+  #else
+  int restarts = 0;
+  // Catch occasional EINTR failures.
+  while (usleep(1000 * milliseconds) != 0 && restarts < 3)
+    ++restarts;
+  #endif
+}
+
+/**
+ * A scoped timer should add the time of each of its scopes.
+ */
+BOOST_AUTO_TEST_CASE(ScopedTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  ScopedSleep(10);
+  BOOST_REQUIRE_GE(Timer::Get("scoped_timer").count(), 10000);
+
+  ScopedSleep(10);
+  BOOST_REQUIRE_GE(Timer::Get("scoped_timer").count(), 20000);
+  std::map<std::string, std::chrono::microseconds> timers =
+      CLI::GetSingleton().timer.GetAllTimers();
+  BOOST_REQUIRE_GE(timers["scoped_timer"].count(), 20000);
+
+  // The time is also merged with the Start()/Stop() timer of the same name.
+  Timer::Start("scoped_timer");
+  Timer::Stop("scoped_timer");
+  BOOST_REQUIRE_GE(Timer::Get("scoped_timer").count(), 20000);
+
+  Timer::ResetAll();
+  BOOST_REQUIRE_EQUAL(Timer::Get("scoped_timer").count(), 0);
+  Timer::DisableTiming();
+}
+
+/**
+ * The time of scoped timers in several threads should be summed.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadScopedTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  std::thread threads[3];
+  for (size_t i = 0; i < 3; ++i)
+    threads[i] = std::thread([]() { ScopedSleep(20); });
+
+  for (size_t i = 0; i < 3; ++i)
+    threads[i].join();
+
+  BOOST_REQUIRE(Timer::Get("scoped_timer") > std::chrono::microseconds(50000));
+
+  Timer::ResetAll();
+  Timer::DisableTiming();
+}
+
+/**
+ * A scoped timer created while timing is disabled should not measure anything.
+ */
+BOOST_AUTO_TEST_CASE(DisabledScopedTimerTest)
+{
+  Timer::ResetAll();
+  Timer::DisableTiming();
+
+  ScopedSleep(20);
+
+  Timer::EnableTiming();
+  BOOST_REQUIRE_EQUAL(Timer::Get("scoped_timer").count(), 0);
+  Timer::DisableTiming();
+}
+
+/**
+ * Method counters should add the given values, and only while timing.
+ */
+BOOST_AUTO_TEST_CASE(MethodCounterTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  Timer::Count("test_counter", 3);
+  Timer::Count("test_counter", 4);
+  BOOST_REQUIRE_EQUAL(Timer::GetCount("test_counter"), 7);
+  BOOST_REQUIRE_EQUAL(Timer::GetCount("other_counter"), 0);
+
+  Timer::DisableTiming();
+  Timer::Count("test_counter", 5);
+  BOOST_REQUIRE_EQUAL(Timer::GetCount("test_counter"), 7);
+
+  Timer::ResetAll();
+  BOOST_REQUIRE_EQUAL(Timer::GetCount("test_counter"), 0);
+}
+
+/**
+ * The profile should contain a span for each run of the timers, and the
+ * counters and totals.
+ */
+BOOST_AUTO_TEST_CASE(WriteProfileTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+  Timer::EnableTracing();
+
+  Timer::Start("test_timer");
+  Timer::Stop("test_timer");
+  Timer::Start("test_timer");
+  Timer::Stop("test_timer");
+  ScopedSleep(1);
+  Timer::Count("test_counter", 12);
+
+  Timer::DisableTracing();
+
+  // This run should not be in the timeline.
+  Timer::Start("test_timer");
+  Timer::Stop("test_timer");
+
+  std::ostringstream stream;
+  CLI::GetSingleton().timer.WriteProfile(stream);
+  const std::string profile = stream.str();
+
+  // Count the occurrences of the given string in the profile.
+  auto count = [&profile](const std::string& str)
+  {
+    size_t n = 0;
+    for (size_t pos = profile.find(str); pos != std::string::npos;
+         pos = profile.find(str, pos + 1))
+      ++n;
+    return n;
+  };
+
+  BOOST_REQUIRE_EQUAL(count("\"traceEvents\""), 1);
+  const std::string span = "\", \"ph\": \"X\"";
+  BOOST_REQUIRE_EQUAL(count("{ \"name\": \"test_timer" + span), 2);
+  BOOST_REQUIRE_EQUAL(count("{ \"name\": \"scoped_timer" + span), 1);
+  BOOST_REQUIRE_EQUAL(count("\"ph\": \"C\""), 1);
+  BOOST_REQUIRE_EQUAL(count("\"test_counter\": 12"), 1);
+  BOOST_REQUIRE_EQUAL(count("\"counters\""), 1);
+
+  Timer::ResetAll();
+  Timer::DisableTiming();
+}
+
+/**
+ * MemoryTracker should count what is allocated through it, and the peak.
+ */
+BOOST_AUTO_TEST_CASE(MemoryTrackerTest)
+{
+  const int64_t bytes = MemoryTracker::Bytes();
+  const uint64_t totalBytes = MemoryTracker::TotalBytes();
+  const uint64_t allocations = MemoryTracker::Allocations();
+
+  void* memory = MemoryTracker::Allocate(100000);
+  BOOST_REQUIRE(memory != NULL);
+  BOOST_REQUIRE_EQUAL(((size_t) memory) % 32, 0);
+  BOOST_REQUIRE_GE(MemoryTracker::Bytes() - bytes, 100000);
+  BOOST_REQUIRE_GE(MemoryTracker::PeakBytes(), MemoryTracker::Bytes());
+  BOOST_REQUIRE_GE(MemoryTracker::TotalBytes() - totalBytes, 100000);
+  BOOST_REQUIRE_GE(MemoryTracker::Allocations() - allocations, 1);
+
+  MemoryTracker::Free(memory);
+  MemoryTracker::Free(NULL);
+  if (!MemoryTracker::Enabled())
+    BOOST_REQUIRE_EQUAL(MemoryTracker::Bytes(), bytes);
+}
+
+/**
+ * The timers should record the memory allocated while they run.
+ */
+BOOST_AUTO_TEST_CASE(TimerMemoryTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    Timer::Start("memory_timer");
+    void* first = MemoryTracker::Allocate(200000);
+    void* second = MemoryTracker::Allocate(300000);
+    MemoryTracker::Free(first);
+    MemoryTracker::Free(second);
+    Timer::Stop("memory_timer");
+  }
+
+  const MemoryUsage usage = Timer::GetMemory("memory_timer");
+  BOOST_REQUIRE_GE(usage.peakBytes, 500000);
+  BOOST_REQUIRE_GE(usage.allocatedBytes, 1000000);
+  BOOST_REQUIRE_GE(usage.allocations, 4);
+
+  const MemoryUsage unknown = Timer::GetMemory("unknown_timer");
+  BOOST_REQUIRE_EQUAL(unknown.peakBytes, 0);
+  BOOST_REQUIRE_EQUAL(unknown.allocations, 0);
+
+  std::ostringstream stream;
+  CLI::GetSingleton().timer.WriteProfile(stream);
+  BOOST_REQUIRE_NE(stream.str().find("\"memory_timer\": { \"peak_bytes\": "),
+      std::string::npos);
+
+  Timer::ResetAll();
+  BOOST_REQUIRE_EQUAL(Timer::GetMemory("memory_timer").allocations, 0);
+  Timer::DisableTiming();
+}
+
 BOOST_AUTO_TEST_SUITE_END();
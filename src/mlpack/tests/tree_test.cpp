@@ -1041,6 +1041,127 @@ BOOST_AUTO_TEST_CASE(HRectBoundDiameter)
   BOOST_REQUIRE_SMALL(d.Diameter(), 1e-5);
 }
 
+/**
+ * Make sure that FixedHRectBound gives the same results as HRectBound, for
+ * random boxes and points.
+ */
+template<typename MetricType>
+void CheckFixedHRectBound()
+{
+  for (size_t trial = 0; trial < 50; ++trial)
+  {
+    HRectBound<MetricType> a(3), b(3);
+    HRectBound3D<MetricType> fixedA(3), fixedB(3);
+
+    arma::mat pointsA = arma::randn<arma::mat>(3, 4);
+    arma::mat pointsB = arma::randn<arma::mat>(3, 4) + 1.0;
+    a |= pointsA;
+    b |= pointsB;
+    fixedA |= pointsA;
+    fixedB |= pointsB;
+
+    BOOST_REQUIRE_CLOSE(fixedA.MinWidth(), a.MinWidth(), 1e-10);
+    BOOST_REQUIRE_CLOSE(fixedA.Volume(), a.Volume(), 1e-10);
+    BOOST_REQUIRE_CLOSE(fixedA.Diameter(), a.Diameter(), 1e-10);
+    BOOST_REQUIRE_EQUAL(fixedA.MinDistance(fixedB), a.MinDistance(b));
+    BOOST_REQUIRE_EQUAL(fixedA.MaxDistance(fixedB), a.MaxDistance(b));
+    BOOST_REQUIRE_EQUAL(fixedA.RangeDistance(fixedB).Lo(),
+        a.RangeDistance(b).Lo());
+    BOOST_REQUIRE_EQUAL(fixedA.RangeDistance(fixedB).Hi(),
+        a.RangeDistance(b).Hi());
+    BOOST_REQUIRE_CLOSE(fixedA.Overlap(fixedB) + 1.0, a.Overlap(b) + 1.0,
+        1e-10);
+
+    arma::vec point = 2.0 * arma::randn<arma::vec>(3);
+    BOOST_REQUIRE_EQUAL(fixedA.MinDistance(point), a.MinDistance(point));
+    BOOST_REQUIRE_EQUAL(fixedA.MaxDistance(point), a.MaxDistance(point));
+    BOOST_REQUIRE_EQUAL(fixedA.RangeDistance(point).Lo(),
+        a.RangeDistance(point).Lo());
+    BOOST_REQUIRE_EQUAL(fixedA.RangeDistance(point).Hi(),
+        a.RangeDistance(point).Hi());
+    BOOST_REQUIRE_EQUAL(fixedA.Contains(point), a.Contains(point));
+    BOOST_REQUIRE_EQUAL(fixedA.Contains(fixedB), a.Contains(b));
+
+    arma::vec center, fixedCenter;
+    a.Center(center);
+    fixedA.Center(fixedCenter);
+    CheckMatrices(fixedCenter, center);
+
+    fixedA |= fixedB;
+    a |= b;
+    for (size_t d = 0; d < 3; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(fixedA[d].Lo(), a[d].Lo());
+      BOOST_REQUIRE_EQUAL(fixedA[d].Hi(), a[d].Hi());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FixedHRectBoundTest)
+{
+  CheckFixedHRectBound<LMetric<2, true>>();
+  CheckFixedHRectBound<LMetric<2, false>>();
+  CheckFixedHRectBound<LMetric<1, true>>();
+  CheckFixedHRectBound<FixedLMetric<3, 2, true>>();
+}
+
+/**
+ * Make sure that a FixedHRectBound can't be created for points with another
+ * number of dimensions, and that a kd-tree with fixed bounds can't be built on
+ * them either.
+ */
+BOOST_AUTO_TEST_CASE(FixedHRectBoundDimensionTest)
+{
+  BOOST_REQUIRE_THROW(HRectBound2D<>(3), std::invalid_argument);
+  BOOST_REQUIRE_NO_THROW(HRectBound2D<>(2));
+
+  arma::mat dataset = arma::randu<arma::mat>(4, 100);
+  typedef KDTree3D<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  BOOST_REQUIRE_THROW(TreeType tree(dataset), std::invalid_argument);
+}
+
+/**
+ * Make sure that a kd-tree on three-dimensional data has the same structure
+ * and the same bounds with fixed-dimension bounds.
+ */
+BOOST_AUTO_TEST_CASE(KDTree3DStructureTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 500);
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  typedef KDTree3D<EuclideanDistance, EmptyStatistic, arma::mat> FixedTreeType;
+
+  TreeType tree(dataset);
+  FixedTreeType fixedTree(dataset);
+  CheckMatrices(fixedTree.Dataset(), tree.Dataset());
+
+  std::stack<TreeType*> nodes;
+  std::stack<FixedTreeType*> fixedNodes;
+  nodes.push(&tree);
+  fixedNodes.push(&fixedTree);
+  while (!nodes.empty())
+  {
+    TreeType* node = nodes.top();
+    FixedTreeType* fixedNode = fixedNodes.top();
+    nodes.pop();
+    fixedNodes.pop();
+
+    BOOST_REQUIRE_EQUAL(fixedNode->Begin(), node->Begin());
+    BOOST_REQUIRE_EQUAL(fixedNode->Count(), node->Count());
+    BOOST_REQUIRE_EQUAL(fixedNode->NumChildren(), node->NumChildren());
+    for (size_t d = 0; d < 3; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(fixedNode->Bound()[d].Lo(), node->Bound()[d].Lo());
+      BOOST_REQUIRE_EQUAL(fixedNode->Bound()[d].Hi(), node->Bound()[d].Hi());
+    }
+
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+    {
+      nodes.push(&node->Child(i));
+      fixedNodes.push(&fixedNode->Child(i));
+    }
+  }
+}
+
 /**
  * It seems as though Bill has stumbled across a bug where
  * BinarySpaceTree<>::count() returns something different than
@@ -1224,6 +1345,59 @@ BOOST_AUTO_TEST_CASE(ParentDistanceTest)
   }
 }
 
+/**
+ * After the points of a kd-tree have moved, RefitBounds() must give every node
+ * the bound of its points and correct parent distances, as a new tree with the
+ * same structure would have.
+ */
+BOOST_AUTO_TEST_CASE(RefitBoundsTest)
+{
+  arma::mat dataset;
+  dataset.randu(4, 500);
+
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(dataset);
+
+  tree.Dataset() += 0.2 * arma::randn<arma::mat>(4, 500);
+  tree.RefitBounds();
+
+  std::stack<TreeType*> nodeStack;
+  nodeStack.push(&tree);
+  while (!nodeStack.empty())
+  {
+    TreeType* node = nodeStack.top();
+    nodeStack.pop();
+
+    const arma::mat points = tree.Dataset().cols(node->Begin(),
+        node->Begin() + node->Count() - 1);
+    const arma::vec minima = arma::min(points, 1);
+    const arma::vec maxima = arma::max(points, 1);
+    for (size_t d = 0; d < 4; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(node->Bound()[d].Lo(), minima[d]);
+      BOOST_REQUIRE_EQUAL(node->Bound()[d].Hi(), maxima[d]);
+    }
+    BOOST_REQUIRE_CLOSE(node->FurthestDescendantDistance(),
+        0.5 * node->Bound().Diameter(), 1e-10);
+
+    if (node->NumChildren() == 0)
+      continue;
+
+    arma::vec center, leftCenter, rightCenter;
+    node->Center(center);
+    node->Left()->Center(leftCenter);
+    node->Right()->Center(rightCenter);
+
+    BOOST_REQUIRE_CLOSE(LMetric<2>::Evaluate(center, leftCenter),
+        node->Left()->ParentDistance(), 1e-5);
+    BOOST_REQUIRE_CLOSE(LMetric<2>::Evaluate(center, rightCenter),
+        node->Right()->ParentDistance(), 1e-5);
+
+    nodeStack.push(node->Left());
+    nodeStack.push(node->Right());
+  }
+}
+
 BOOST_AUTO_TEST_CASE(ParentDistanceTestWithMapping)
 {
   arma::mat dataset;
@@ -1359,6 +1533,127 @@ BOOST_AUTO_TEST_CASE(KdTreeTest)
   TreeType root(dataset);
 }
 
+/**
+ * Recursively make sure that two trees have the same shape and hold the same
+ * points in each node.
+ */
+template<typename TreeType>
+void CheckSameTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Make sure that a tree built with several threads is the same as a tree built
+ * with one thread, for both of the split types that support parallel builds.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBuildTest)
+{
+  arma::mat dataset(5, 50000);
+  dataset.randu();
+
+  std::vector<size_t> oldFromNewSerial, oldFromNewParallel;
+
+#ifdef HAS_OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> kdSerial(dataset,
+      oldFromNewSerial);
+  MeanSplitKDTree<EuclideanDistance, EmptyStatistic, arma::mat> meanSerial(
+      dataset);
+#ifdef HAS_OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> kdParallel(dataset,
+      oldFromNewParallel);
+  MeanSplitKDTree<EuclideanDistance, EmptyStatistic, arma::mat> meanParallel(
+      dataset);
+
+  BOOST_REQUIRE_EQUAL(oldFromNewSerial.size(), oldFromNewParallel.size());
+  for (size_t i = 0; i < oldFromNewSerial.size(); ++i)
+    BOOST_REQUIRE_EQUAL(oldFromNewSerial[i], oldFromNewParallel[i]);
+
+  CheckMatrices(kdSerial.Dataset(), kdParallel.Dataset());
+  CheckMatrices(meanSerial.Dataset(), meanParallel.Dataset());
+
+  CheckSameTree(kdSerial, kdParallel);
+  CheckSameTree(meanSerial, meanParallel);
+}
+
+/**
+ * Make sure that freezing a tree keeps its structure and bounds, and that the
+ * depth-first layout puts each left child right after its parent.
+ */
+BOOST_AUTO_TEST_CASE(FreezeTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(4, 5000);
+  dataset.randu();
+
+  TreeType tree(dataset);
+  TreeType depthFirst(tree);
+  TreeType vanEmdeBoas(tree);
+
+  BOOST_REQUIRE(!depthFirst.IsFrozen());
+  depthFirst.Freeze(DEPTH_FIRST_LAYOUT);
+  vanEmdeBoas.Freeze(VAN_EMDE_BOAS_LAYOUT);
+  BOOST_REQUIRE(depthFirst.IsFrozen());
+  BOOST_REQUIRE(vanEmdeBoas.IsFrozen());
+
+  CheckSameTree(tree, depthFirst);
+  CheckSameTree(tree, vanEmdeBoas);
+
+  std::vector<TreeType*> original, frozen;
+  GenerateVectorOfTree(&tree, 1, original);
+  GenerateVectorOfTree(&vanEmdeBoas, 1, frozen);
+  BOOST_REQUIRE_EQUAL(original.size(), frozen.size());
+  for (size_t i = 0; i < original.size(); ++i)
+  {
+    if (original[i] == NULL)
+      continue;
+
+    BOOST_REQUIRE(frozen[i] != NULL);
+    BOOST_REQUIRE(frozen[i]->Parent() == ((i == 1) ? NULL : frozen[i / 2]));
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(original[i]->Bound()[d].Lo(),
+          frozen[i]->Bound()[d].Lo());
+      BOOST_REQUIRE_EQUAL(original[i]->Bound()[d].Hi(),
+          frozen[i]->Bound()[d].Hi());
+    }
+  }
+
+  // In the depth-first layout, the left child of every non-root node directly
+  // follows it in memory.
+  std::stack<TreeType*> stack;
+  stack.push(depthFirst.Left());
+  stack.push(depthFirst.Right());
+  while (!stack.empty())
+  {
+    TreeType* node = stack.top();
+    stack.pop();
+
+    if (node->IsLeaf())
+      continue;
+
+    BOOST_REQUIRE(node->Left() == node + 1);
+    stack.push(node->Left());
+    stack.push(node->Right());
+  }
+
+  // Freezing again with a different layout must also work.
+  depthFirst.Freeze(VAN_EMDE_BOAS_LAYOUT);
+  CheckSameTree(tree, depthFirst);
+}
+
 BOOST_AUTO_TEST_CASE(MaxRPTreeTest)
 {
   typedef MaxRPTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
@@ -2252,4 +2547,39 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+/**
+ * Make sure that loading a flat tree index whose root has lost its children
+ * (so that both of them are never reached) throws, and cleans up the partly
+ * built tree without deleting the dataset more than once.
+ */
+BOOST_AUTO_TEST_CASE(FlatTreeIndexMalformedTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(3, 100);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 5);
+
+  std::ostringstream stream;
+  FlatTreeIndex<TreeType>::Save(tree, oldFromNew, stream);
+  std::string block = stream.str();
+
+  std::vector<size_t> loadedOldFromNew;
+  TreeType* loaded = FlatTreeIndex<TreeType>::Load(block.data(), block.size(),
+      loadedOldFromNew);
+  BOOST_REQUIRE_EQUAL(loaded->NumDescendants(), tree.NumDescendants());
+  delete loaded;
+
+  // The offset of the node records is the eleventh field of the header, and
+  // the indices of the children are the third and fourth fields of a record.
+  uint64_t nodesOffset;
+  std::memcpy(&nodesOffset, block.data() + 80, sizeof(uint64_t));
+  const uint64_t noChild = uint64_t(-1);
+  std::memcpy(&block[nodesOffset + 16], &noChild, sizeof(uint64_t));
+  std::memcpy(&block[nodesOffset + 24], &noChild, sizeof(uint64_t));
+
+  BOOST_REQUIRE_THROW(FlatTreeIndex<TreeType>::Load(block.data(),
+      block.size(), loadedOldFromNew), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/methods/emst/union_find.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
 
 #include <mlpack/core.hpp>
 #include <boost/test/unit_test.hpp>
@@ -51,4 +52,57 @@ BOOST_AUTO_TEST_CASE(TestUnion)
   BOOST_REQUIRE(testUnionFind.Find(6) == testUnionFind.Find(3));
 }
 
+BOOST_AUTO_TEST_CASE(TestConcurrentUnion)
+{
+  static const size_t testSize = 10;
+  ConcurrentUnionFind testUnionFind(testSize);
+
+  for (size_t i = 0; i < testSize; i++)
+    BOOST_REQUIRE(testUnionFind.Find(i) == i);
+
+  BOOST_REQUIRE(testUnionFind.Union(0, 1));
+  BOOST_REQUIRE(testUnionFind.Union(2, 3));
+  BOOST_REQUIRE(testUnionFind.Union(0, 2));
+  BOOST_REQUIRE(testUnionFind.Union(5, 0));
+  BOOST_REQUIRE(testUnionFind.Union(0, 6));
+  // These are already in the same component.
+  BOOST_REQUIRE(!testUnionFind.Union(3, 6));
+
+  BOOST_REQUIRE(testUnionFind.Find(0) == testUnionFind.Find(1));
+  BOOST_REQUIRE(testUnionFind.Find(2) == testUnionFind.Find(3));
+  BOOST_REQUIRE(testUnionFind.Find(1) == testUnionFind.Find(5));
+  BOOST_REQUIRE(testUnionFind.Find(6) == testUnionFind.Find(3));
+  BOOST_REQUIRE(testUnionFind.Find(4) == 4);
+  BOOST_REQUIRE(testUnionFind.Find(7) != testUnionFind.Find(0));
+}
+
+/**
+ * Unite many pairs from several threads at once, so that the elements with
+ * even and odd indices end up in two components.
+ */
+BOOST_AUTO_TEST_CASE(TestConcurrentParallelUnion)
+{
+  static const size_t testSize = 100000;
+  ConcurrentUnionFind testUnionFind(testSize);
+
+  size_t successes = 0;
+  #pragma omp parallel for reduction(+:successes)
+  for (omp_size_t i = 0; i < (omp_size_t) testSize - 2; ++i)
+  {
+    // Visit the pairs in a scrambled order; 7919 is coprime to testSize - 2.
+    const size_t j = ((size_t) i * 7919) % (testSize - 2);
+    if (testUnionFind.Union(j + 2, j))
+      ++successes;
+  }
+
+  // Each successful union removes one component.
+  BOOST_REQUIRE_EQUAL(successes, testSize - 2);
+
+  const size_t even = testUnionFind.Find(0);
+  const size_t odd = testUnionFind.Find(1);
+  BOOST_REQUIRE(even != odd);
+  for (size_t i = 0; i < testSize; ++i)
+    BOOST_REQUIRE_EQUAL(testUnionFind.Find(i), (i % 2 == 0) ? even : odd);
+}
+
 BOOST_AUTO_TEST_SUITE_END();